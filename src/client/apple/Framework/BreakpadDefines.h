@@ -63,6 +63,7 @@
 #define BREAKPAD_SERVER_TYPE           "BreakpadServerType"
 #define BREAKPAD_SERVER_PARAMETER_DICT "BreakpadServerParameters"
 #define BREAKPAD_IN_PROCESS            "BreakpadInProcess"
+#define BREAKPAD_PRELAUNCH_INSPECTOR   "BreakpadPrelaunchInspector"
 
 // The keys below are NOT user supplied, and are used internally.
 #define BREAKPAD_PROCESS_START_TIME       "BreakpadProcStartTime"
@@ -55,6 +55,10 @@
   // Whether or not crash reports should be uploaded.
   BOOL enableUploads_;
 
+  // Whether looking for, reading and uploading crash reports is done at
+  // background QoS.
+  BOOL backgroundUploads_;
+
   // Whether the controller has been started on the main thread. This is only
   // used to assert the initialization order is correct.
   BOOL started_;
@@ -91,6 +95,13 @@
 // will prevent uploads.
 - (void)setUploadInterval:(int)intervalInSeconds;
 
+// Run the work of sending crash reports -- finding them, reading them and
+// uploading them -- at background QoS, starting only after the current run
+// loop iteration, so that reports that accumulated while the app was not
+// running do not compete with its launch. The crash handler itself is not
+// affected.
+- (void)setBackgroundUploads:(BOOL)backgroundUploads;
+
 // Set additional server parameters to send when uploading crash reports.
 - (void)setParametersToAddAtUploadTime:(NSDictionary*)uploadTimeParameters;
 
@@ -49,6 +49,10 @@
 // Load a crash report and send it to the server.
 - (void)sendStoredCrashReports;
 
+// Runs |block| on the breakpad queue after |seconds| seconds, at background
+// QoS if |backgroundUploads_| is set.
+- (void)dispatchUploadBlock:(dispatch_block_t)block afterDelay:(int)seconds;
+
 // Returns when a report can be sent. |-1| means never, |0| means that a report
 // can be sent immediately, a positive number is the number of seconds to wait
 // before being allowed to upload a report.
@@ -110,6 +114,7 @@ NSString* GetPlatform() {
   if (self) {
     queue_ = dispatch_queue_create("com.google.BreakpadQueue", NULL);
     enableUploads_ = NO;
+    backgroundUploads_ = NO;
     started_ = NO;
     [self resetConfiguration];
   }
@@ -182,7 +187,17 @@ NSString* GetPlatform() {
         // Set this before calling doSendStoredCrashReport, because that
         // calls sendDelay, which in turn checks this flag.
         enableUploads_ = YES;
-        [self sendStoredCrashReports];
+        if (backgroundUploads_) {
+          // Uploading is typically enabled during launch; leave the reports
+          // alone until the main queue has had a chance to run.
+          dispatch_async(dispatch_get_main_queue(), ^{
+              [self dispatchUploadBlock:^{
+                  [self sendStoredCrashReports];
+              } afterDelay:0];
+          });
+        } else {
+          [self sendStoredCrashReports];
+        }
       } else {
         // disable the enableUpload_ flag.
         // sendDelay checks this flag and disables the upload of logs by sendStoredCrashReports
@@ -227,6 +242,13 @@ NSString* GetPlatform() {
     uploadIntervalInSeconds_ = 0;
 }
 
+- (void)setBackgroundUploads:(BOOL)backgroundUploads {
+  NSAssert(!started_,
+      @"The controller must not be started when setBackgroundUploads is "
+       "called");
+  backgroundUploads_ = backgroundUploads;
+}
+
 - (void)setParametersToAddAtUploadTime:(NSDictionary*)uploadTimeParameters {
   NSAssert(!started_, @"The controller must not be started when "
                       "setParametersToAddAtUploadTime is called");
@@ -364,11 +386,30 @@ NSString* GetPlatform() {
 
   // A report must be sent later.
   if (timeToWait > 0) {
-    dispatch_time_t delay = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeToWait * NSEC_PER_SEC));
-    dispatch_after(delay, queue_, ^{
+    [self dispatchUploadBlock:^{
         [self sendStoredCrashReports];
-    });
+    } afterDelay:timeToWait];
+  }
+}
+
+- (void)dispatchUploadBlock:(dispatch_block_t)block afterDelay:(int)seconds {
+  dispatch_block_t uploadBlock = NULL;
+  if (backgroundUploads_) {
+    // Blocks queued behind this one at a higher QoS raise it as needed, so
+    // the background QoS never holds up other work on the breakpad queue.
+    uploadBlock = dispatch_block_create_with_qos_class(
+        DISPATCH_BLOCK_ENFORCE_QOS_CLASS, QOS_CLASS_BACKGROUND, 0, block);
+  } else {
+    uploadBlock = Block_copy(block);
+  }
+  if (seconds > 0) {
+    dispatch_time_t delay =
+        dispatch_time(DISPATCH_TIME_NOW, (int64_t)(seconds * NSEC_PER_SEC));
+    dispatch_after(delay, queue_, uploadBlock);
+  } else {
+    dispatch_async(queue_, uploadBlock);
   }
+  Block_release(uploadBlock);
 }
 
 @end
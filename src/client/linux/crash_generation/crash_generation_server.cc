@@ -39,6 +39,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <map>
 #include <vector>
 
 #include "client/linux/crash_generation/crash_generation_server.h"
@@ -51,8 +52,18 @@
 
 static const char kCommandQuit = 'x';
 
+// The most dump requests a client may have queued; later ones are refused.
+static const size_t kMaxQueuedDumpsPerClient = 4;
+
 namespace google_breakpad {
 
+struct CrashGenerationServer::DumpRequest {
+  pid_t crashing_pid;
+  // Closed to tell the client its dump is done.
+  int signal_fd;
+  char crash_context[sizeof(ExceptionHandler::CrashContext)];
+};
+
 CrashGenerationServer::CrashGenerationServer(
   const int listen_fd,
   OnClientDumpRequestCallback dump_callback,
@@ -67,18 +78,24 @@ CrashGenerationServer::CrashGenerationServer(
     exit_callback_(exit_callback),
     exit_context_(exit_context),
     generate_dumps_(generate_dumps),
-    started_(false)
+    started_(false),
+    max_concurrent_dumps_(1),
+    stopping_(false)
 {
   if (dump_path)
     dump_dir_ = *dump_path;
   else
     dump_dir_ = "/tmp";
+  pthread_mutex_init(&dump_mutex_, NULL);
+  pthread_cond_init(&dump_cond_, NULL);
 }
 
 CrashGenerationServer::~CrashGenerationServer()
 {
   if (started_)
     Stop();
+  pthread_cond_destroy(&dump_cond_);
+  pthread_mutex_destroy(&dump_mutex_);
 }
 
 bool
@@ -102,9 +119,29 @@ CrashGenerationServer::Start()
   control_pipe_in_ = control_pipe[0];
   control_pipe_out_ = control_pipe[1];
 
-  if (pthread_create(&thread_, NULL,
-                     ThreadMain, reinterpret_cast<void*>(this)))
+  stopping_ = false;
+  const int num_dump_threads =
+      max_concurrent_dumps_ > 0 ? max_concurrent_dumps_ : 1;
+  for (int i = 0; i < num_dump_threads; ++i) {
+    pthread_t dump_thread;
+    if (pthread_create(&dump_thread, NULL,
+                       DumpThreadMain, reinterpret_cast<void*>(this)))
+      break;
+    dump_threads_.push_back(dump_thread);
+  }
+
+  if (dump_threads_.size() != static_cast<size_t>(num_dump_threads) ||
+      pthread_create(&thread_, NULL,
+                     ThreadMain, reinterpret_cast<void*>(this))) {
+    pthread_mutex_lock(&dump_mutex_);
+    stopping_ = true;
+    pthread_cond_broadcast(&dump_cond_);
+    pthread_mutex_unlock(&dump_mutex_);
+    for (size_t i = 0; i < dump_threads_.size(); ++i)
+      pthread_join(dump_threads_[i], NULL);
+    dump_threads_.clear();
     return false;
+  }
 
   started_ = true;
   return true;
@@ -126,6 +163,26 @@ CrashGenerationServer::Stop()
   close(control_pipe_in_);
   close(control_pipe_out_);
 
+  // Let the dumps in progress finish, and release the clients still waiting
+  // for theirs.
+  pthread_mutex_lock(&dump_mutex_);
+  stopping_ = true;
+  pthread_cond_broadcast(&dump_cond_);
+  pthread_mutex_unlock(&dump_mutex_);
+  for (size_t i = 0; i < dump_threads_.size(); ++i)
+    pthread_join(dump_threads_[i], NULL);
+  dump_threads_.clear();
+
+  for (std::map<pid_t, ClientQueue>::iterator it = client_queues_.begin();
+       it != client_queues_.end(); ++it) {
+    for (size_t i = 0; i < it->second.requests.size(); ++i) {
+      close(it->second.requests[i]->signal_fd);
+      delete it->second.requests[i];
+    }
+  }
+  client_queues_.clear();
+  ready_clients_.clear();
+
   started_ = false;
 }
 
@@ -260,28 +317,97 @@ CrashGenerationServer::ClientEvent(short revents)
     return true;
   }
 
+  // Leave the dump to a dump thread, so that we can take the next request
+  // straight away.
+  DumpRequest* request = new DumpRequest;
+  request->crashing_pid = crashing_pid;
+  request->signal_fd = signal_fd;
+  memcpy(request->crash_context, crash_context, kCrashContextSize);
+  if (!QueueDumpRequest(request)) {
+    close(signal_fd);
+    delete request;
+  }
+
+  return true;
+}
+
+bool
+CrashGenerationServer::QueueDumpRequest(DumpRequest* request)
+{
+  pthread_mutex_lock(&dump_mutex_);
+  ClientQueue& queue = client_queues_[request->crashing_pid];
+  if (queue.requests.size() >= kMaxQueuedDumpsPerClient) {
+    pthread_mutex_unlock(&dump_mutex_);
+    return false;
+  }
+  queue.requests.push_back(request);
+  if (!queue.dumping && queue.requests.size() == 1) {
+    ready_clients_.push_back(request->crashing_pid);
+    pthread_cond_signal(&dump_cond_);
+  }
+  pthread_mutex_unlock(&dump_mutex_);
+  return true;
+}
+
+void
+CrashGenerationServer::WriteDump(DumpRequest* request)
+{
   string minidump_filename;
-  if (!MakeMinidumpFilename(minidump_filename))
-    return true;
+  if (!MakeMinidumpFilename(minidump_filename)) {
+    close(request->signal_fd);
+    return;
+  }
 
   if (!google_breakpad::WriteMinidump(minidump_filename.c_str(),
-                                      crashing_pid, crash_context,
-                                      kCrashContextSize)) {
-    close(signal_fd);
-    return true;
+                                      request->crashing_pid,
+                                      request->crash_context,
+                                      sizeof(request->crash_context))) {
+    close(request->signal_fd);
+    return;
   }
 
   if (dump_callback_) {
-    ClientInfo info(crashing_pid, this);
+    ClientInfo info(request->crashing_pid, this);
 
     dump_callback_(dump_context_, &info, &minidump_filename);
   }
 
   // Send the done signal to the process: it can exit now.
   // (Closing this will make the child's sys_read unblock and return 0.)
-  close(signal_fd);
+  close(request->signal_fd);
+}
 
-  return true;
+void
+CrashGenerationServer::RunDumpThread()
+{
+  pthread_mutex_lock(&dump_mutex_);
+  while (true) {
+    while (!stopping_ && ready_clients_.empty())
+      pthread_cond_wait(&dump_cond_, &dump_mutex_);
+    if (stopping_)
+      break;
+
+    // Take the next client's oldest request. Its other requests wait until
+    // this dump is done and every other ready client has had a turn.
+    const pid_t pid = ready_clients_.front();
+    ready_clients_.pop_front();
+    ClientQueue& queue = client_queues_[pid];
+    DumpRequest* request = queue.requests.front();
+    queue.requests.pop_front();
+    queue.dumping = true;
+    pthread_mutex_unlock(&dump_mutex_);
+
+    WriteDump(request);
+    delete request;
+
+    pthread_mutex_lock(&dump_mutex_);
+    queue.dumping = false;
+    if (queue.requests.empty())
+      client_queues_.erase(pid);
+    else
+      ready_clients_.push_back(pid);
+  }
+  pthread_mutex_unlock(&dump_mutex_);
 }
 
 bool
@@ -330,4 +456,12 @@ CrashGenerationServer::ThreadMain(void* arg)
   return NULL;
 }
 
+// static
+void*
+CrashGenerationServer::DumpThreadMain(void* arg)
+{
+  reinterpret_cast<CrashGenerationServer*>(arg)->RunDumpThread();
+  return NULL;
+}
+
 }  // namespace google_breakpad
@@ -31,8 +31,12 @@
 #define CLIENT_LINUX_CRASH_GENERATION_CRASH_GENERATION_SERVER_H_
 
 #include <pthread.h>
+#include <sys/types.h>
 
+#include <deque>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "common/using_std_string.h"
 
@@ -75,6 +79,14 @@ public:
 
   ~CrashGenerationServer();
 
+  // Set the most minidumps to write at once, each on a thread of its own;
+  // the default is 1. Requests are received on another thread, so a dump in
+  // progress never holds up the next request. Clients take turns, and each
+  // client gets one dump at a time. Must be called before Start().
+  void set_max_concurrent_dumps(int max_concurrent_dumps) {
+    max_concurrent_dumps_ = max_concurrent_dumps;
+  }
+
   // Perform initialization steps needed to start listening to clients.
   //
   // Return true if initialization is successful; false otherwise.
@@ -104,9 +116,32 @@ private:
   // Return a unique filename at which a minidump can be written
   bool MakeMinidumpFilename(string& outFilename);
 
+  // A dump request received from a client, waiting for a dump thread.
+  struct DumpRequest;
+
+  // The requests of one client, and whether one of them is being dumped.
+  struct ClientQueue {
+    ClientQueue() : dumping(false) {}
+    std::deque<DumpRequest*> requests;
+    bool dumping;
+  };
+
+  // Queue |request| for a dump thread. Returns false if its client has too
+  // many requests queued already.
+  bool QueueDumpRequest(DumpRequest* request);
+
+  // Write the minidump |request| asks for, and tell its client.
+  void WriteDump(DumpRequest* request);
+
+  // Run a dump thread, taking requests until the server stops.
+  void RunDumpThread();
+
   // Trampoline to |Run()|
   static void* ThreadMain(void* arg);
 
+  // Trampoline to |RunDumpThread()|
+  static void* DumpThreadMain(void* arg);
+
   int server_fd_;
 
   OnClientDumpRequestCallback dump_callback_;
@@ -125,6 +160,19 @@ private:
   int control_pipe_in_;
   int control_pipe_out_;
 
+  int max_concurrent_dumps_;
+  std::vector<pthread_t> dump_threads_;
+
+  // Guards the members below, which |dump_cond_| signals changes to.
+  pthread_mutex_t dump_mutex_;
+  pthread_cond_t dump_cond_;
+  // The queued requests of each client that has any, or a dump in progress.
+  std::map<pid_t, ClientQueue> client_queues_;
+  // The clients with requests queued and no dump in progress, in the order
+  // they are to be served.
+  std::deque<pid_t> ready_clients_;
+  bool stopping_;
+
   // disable these
   CrashGenerationServer(const CrashGenerationServer&);
   CrashGenerationServer& operator=(const CrashGenerationServer&);
@@ -0,0 +1,578 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_latency_benchmark.cc: How long the Linux client takes to write
+// the minidump of a crash, and how long it keeps the crashed process's
+// threads suspended.
+//
+// Usage: crash_latency_benchmark [-t <threads>] [-m <mappings>]
+//                                [-d <depth>] [-r <runs>] [-o <directory>]
+//                                [-p] [-i]
+//
+// Each run starts a process with <threads> threads besides its main one
+// (8 by default), each <depth> calls deep (64) in frames of 256 bytes,
+// and <mappings> extra read-only mappings of its executable (32). Dumps
+// are written to <directory> (/tmp) and deleted.
+//
+// The process is dumped two ways:
+//
+//  - It crashes with an ExceptionHandler installed, with the dumper
+//    prespawned if -p is given and module identifiers precomputed if -i
+//    is. Its filter and minidump callbacks time the signal's delivery to
+//    the handler, and the rest of the handler until the dump is complete.
+//  - This process writes a minidump of it through a LinuxPtraceDumper, as
+//    the dumper the handler starts would, timing thread and mapping
+//    enumeration, suspending the threads, reading their registers, copying
+//    memory, identifying modules and writing the file, and how long the
+//    threads stay suspended.
+//
+// Times are the median and the longest of <runs> runs (5), in
+// milliseconds.
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "client/linux/dump_writer_common/thread_info.h"
+#include "client/linux/handler/exception_handler.h"
+#include "client/linux/handler/minidump_descriptor.h"
+#include "client/linux/minidump_writer/linux_ptrace_dumper.h"
+#include "client/linux/minidump_writer/minidump_writer.h"
+#include "common/linux/eintr_wrapper.h"
+#include "common/linux/file_id.h"
+#include "common/memory_allocator.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/common/minidump_exception_linux.h"
+
+namespace {
+
+using google_breakpad::AppMemoryList;
+using google_breakpad::ExceptionHandler;
+using google_breakpad::LinuxPtraceDumper;
+using google_breakpad::MappingInfo;
+using google_breakpad::MappingList;
+using google_breakpad::MinidumpDescriptor;
+using google_breakpad::ThreadInfo;
+
+struct Parameters {
+  int threads;
+  int mappings;
+  int depth;
+  int runs;
+  string directory;
+  bool prespawn;
+  bool precompute_module_ids;
+};
+
+// CLOCK_MONOTONIC is the same in every process, and clock_gettime() may
+// be called from a signal handler.
+int64_t NowNanoseconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+double Milliseconds(int64_t nanoseconds) {
+  return nanoseconds / 1e6;
+}
+
+// The synthetic process.
+
+// Where the crashing process records when things happened. It is shared
+// with the benchmark, which maps it before forking.
+struct CrashTimes {
+  int64_t crash;
+  int64_t handler;
+  int64_t dumped;
+  bool succeeded;
+};
+
+int g_ready_fd = -1;
+
+void WaitForever() {
+  char ready = 0;
+  if (HANDLE_EINTR(write(g_ready_fd, &ready, 1)) != 1)
+    _exit(1);
+  for (;;)
+    pause();
+}
+
+// Calls itself |depth| times in frames of 256 bytes, then calls |bottom|.
+void __attribute__((noinline)) Recurse(int depth, void (*bottom)()) {
+  volatile char frame[256];
+  frame[0] = static_cast<char>(depth);
+  if (depth > 0)
+    Recurse(depth - 1, bottom);
+  else
+    bottom();
+  frame[1] = frame[0];
+}
+
+void* ThreadMain(void* depth) {
+  Recurse(static_cast<int>(reinterpret_cast<intptr_t>(depth)), WaitForever);
+  return NULL;
+}
+
+// Maps all of |path| |count| times, a page apart so that the mappings
+// aren't merged.
+bool AddMappings(const char* path, int count) {
+  if (count == 0)
+    return true;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  const size_t page_size = getpagesize();
+  const size_t size = (st.st_size + page_size - 1) & ~(page_size - 1);
+  const size_t stride = size + page_size;
+  char* base = static_cast<char*>(mmap(NULL, stride * count, PROT_NONE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (base == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  for (int i = 0; i < count; ++i) {
+    if (mmap(base + i * stride, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd,
+             0) == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+  }
+  close(fd);
+  return true;
+}
+
+CrashTimes* g_crash_times;
+
+bool FilterCallback(void* context) {
+  g_crash_times->handler = NowNanoseconds();
+  return true;
+}
+
+bool MinidumpCallback(const MinidumpDescriptor& descriptor, void* context,
+                      bool succeeded) {
+  g_crash_times->dumped = NowNanoseconds();
+  g_crash_times->succeeded = succeeded;
+  unlink(descriptor.path());
+  return true;
+}
+
+// Runs the synthetic process: starts its threads and mappings, and then
+// either crashes, if |crash_times| is given, or waits to be killed.
+// Writes a byte to |ready_fd| for each thread that is in place.
+void RunSyntheticProcess(const Parameters& parameters, int ready_fd,
+                         int crash_read_fd, CrashTimes* crash_times) {
+  if (!AddMappings("/proc/self/exe", parameters.mappings))
+    _exit(1);
+
+  g_ready_fd = ready_fd;
+  void* depth = reinterpret_cast<void*>(
+      static_cast<intptr_t>(parameters.depth));
+  for (int i = 0; i < parameters.threads; ++i) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, ThreadMain, depth) != 0)
+      _exit(1);
+  }
+
+  if (!crash_times) {
+    Recurse(parameters.depth, WaitForever);
+    _exit(1);
+  }
+
+  // The crashing thread waits for the others before crashing.
+  for (int i = 0; i < parameters.threads; ) {
+    char ready;
+    if (HANDLE_EINTR(read(crash_read_fd, &ready, 1)) == 1)
+      ++i;
+  }
+  g_crash_times = crash_times;
+  ExceptionHandler handler(MinidumpDescriptor(parameters.directory),
+                           FilterCallback, MinidumpCallback, NULL, true, -1);
+  if (parameters.precompute_module_ids)
+    handler.PrecomputeModuleIdentifiers();
+  if (parameters.prespawn && !handler.PrespawnDumper())
+    _exit(1);
+  crash_times->crash = NowNanoseconds();
+  *reinterpret_cast<volatile int*>(NULL) = 0;
+  _exit(1);
+}
+
+// The benchmark.
+
+// A LinuxPtraceDumper that times the work MinidumpWriter has it do.
+class TimingDumper : public LinuxPtraceDumper {
+ public:
+  explicit TimingDumper(pid_t pid)
+      : LinuxPtraceDumper(pid),
+        enumerate_(0), suspend_(0), resume_(0), thread_info_(0),
+        copy_(0), suspended_at_(0), suspended_(0), in_call_(false) {}
+
+  bool Init() {
+    int64_t start = NowNanoseconds();
+    bool result = LinuxPtraceDumper::Init();
+    enumerate_ += NowNanoseconds() - start;
+    return result;
+  }
+
+  bool ThreadsSuspend() {
+    suspended_at_ = NowNanoseconds();
+    bool result = LinuxPtraceDumper::ThreadsSuspend();
+    suspend_ += NowNanoseconds() - suspended_at_;
+    return result;
+  }
+
+  bool ThreadsResume() {
+    int64_t start = NowNanoseconds();
+    bool result = LinuxPtraceDumper::ThreadsResume();
+    int64_t end = NowNanoseconds();
+    resume_ += end - start;
+    if (suspended_at_) {
+      suspended_ += end - suspended_at_;
+      suspended_at_ = 0;
+    }
+    return result;
+  }
+
+  bool GetThreadInfoByIndex(size_t index, ThreadInfo* info) {
+    int64_t start = NowNanoseconds();
+    in_call_ = true;
+    bool result = LinuxPtraceDumper::GetThreadInfoByIndex(index, info);
+    in_call_ = false;
+    thread_info_ += NowNanoseconds() - start;
+    return result;
+  }
+
+  // Copies made within another timed call, or by CopyFromProcessBatch()'s
+  // helper threads, are counted there.
+  bool CopyFromProcess(void* dest, pid_t child, const void* src,
+                       size_t length) {
+    if (in_call_)
+      return LinuxPtraceDumper::CopyFromProcess(dest, child, src, length);
+    int64_t start = NowNanoseconds();
+    bool result = LinuxPtraceDumper::CopyFromProcess(dest, child, src, length);
+    copy_ += NowNanoseconds() - start;
+    return result;
+  }
+
+  void CopyFromProcessBatch(const CopyRequest* requests, size_t count) {
+    int64_t start = NowNanoseconds();
+    in_call_ = true;
+    LinuxPtraceDumper::CopyFromProcessBatch(requests, count);
+    in_call_ = false;
+    copy_ += NowNanoseconds() - start;
+  }
+
+  int64_t enumerate() const { return enumerate_; }
+  int64_t suspend() const { return suspend_; }
+  int64_t resume() const { return resume_; }
+  int64_t thread_info() const { return thread_info_; }
+  int64_t copy() const { return copy_; }
+  int64_t suspended() const { return suspended_; }
+
+ private:
+  int64_t enumerate_;
+  int64_t suspend_;
+  int64_t resume_;
+  int64_t thread_info_;
+  int64_t copy_;
+  int64_t suspended_at_;
+  int64_t suspended_;
+  bool in_call_;
+};
+
+enum Measurement {
+  SIGNAL_TO_HANDLER,
+  HANDLER_TO_DUMPED,
+  CRASH_TO_DUMPED,
+  ENUMERATE,
+  SUSPEND,
+  THREAD_INFO,
+  MEMORY_COPY,
+  MODULE_IDS,
+  WRITE,
+  RESUME,
+  DUMP_TOTAL,
+  THREADS_SUSPENDED,
+  MEASUREMENT_COUNT
+};
+
+const char* const kMeasurementNames[MEASUREMENT_COUNT] = {
+  "signal to handler",
+  "handler to dump complete",
+  "crash to dump complete",
+  "enumerate threads, mappings",
+  "suspend threads",
+  "read thread registers",
+  "copy memory",
+  "identify modules",
+  "write file, other",
+  "resume threads",
+  "dump total",
+  "threads suspended",
+};
+
+typedef std::vector<int64_t> Samples[MEASUREMENT_COUNT];
+
+// Starts the synthetic process, returning its pid once its threads are in
+// place, or -1.
+pid_t StartSyntheticProcess(const Parameters& parameters,
+                            CrashTimes* crash_times) {
+  int ready[2];
+  if (pipe(ready) != 0)
+    return -1;
+  pid_t child = fork();
+  if (child < 0) {
+    close(ready[0]);
+    close(ready[1]);
+    return -1;
+  }
+  if (child == 0) {
+    // The crashing process waits for its own threads.
+    RunSyntheticProcess(parameters, ready[1], ready[0], crash_times);
+    _exit(1);
+  }
+  close(ready[1]);
+  if (crash_times) {
+    close(ready[0]);
+    return child;
+  }
+  for (int i = 0; i <= parameters.threads; ) {
+    char byte;
+    ssize_t n = HANDLE_EINTR(read(ready[0], &byte, 1));
+    if (n != 1) {
+      close(ready[0]);
+      kill(child, SIGKILL);
+      HANDLE_EINTR(waitpid(child, NULL, 0));
+      return -1;
+    }
+    ++i;
+  }
+  close(ready[0]);
+  return child;
+}
+
+bool MeasureCrash(const Parameters& parameters, CrashTimes* crash_times,
+                  Samples* samples) {
+  memset(crash_times, 0, sizeof(*crash_times));
+  pid_t child = StartSyntheticProcess(parameters, crash_times);
+  if (child < 0)
+    return false;
+  int status;
+  if (HANDLE_EINTR(waitpid(child, &status, 0)) != child)
+    return false;
+  if (!crash_times->succeeded || !crash_times->handler ||
+      !crash_times->dumped) {
+    return false;
+  }
+  (*samples)[SIGNAL_TO_HANDLER].push_back(
+      crash_times->handler - crash_times->crash);
+  (*samples)[HANDLER_TO_DUMPED].push_back(
+      crash_times->dumped - crash_times->handler);
+  (*samples)[CRASH_TO_DUMPED].push_back(
+      crash_times->dumped - crash_times->crash);
+  return true;
+}
+
+bool ShouldIdentifyMapping(const MappingInfo& mapping) {
+  // As MinidumpWriter decides which mappings to list.
+  return mapping.name[0] != '\0' && (mapping.offset == 0 || mapping.exec) &&
+      mapping.size >= 4096;
+}
+
+bool MeasureDump(const Parameters& parameters, Samples* samples) {
+  pid_t child = StartSyntheticProcess(parameters, NULL);
+  if (child < 0)
+    return false;
+  string path = parameters.directory + "/crash_latency_benchmark.dmp";
+
+  TimingDumper dumper(child);
+  dumper.set_crash_signal(MD_EXCEPTION_CODE_LIN_DUMP_REQUESTED);
+  dumper.set_crash_thread(child);
+  int64_t start = NowNanoseconds();
+  bool written = google_breakpad::WriteMinidump(
+      path.c_str(), MappingList(), AppMemoryList(), &dumper);
+  int64_t total = NowNanoseconds() - start;
+  unlink(path.c_str());
+
+  // MinidumpWriter identifies modules as it writes them, so this times
+  // the same work again on the mappings it found.
+  int64_t identify = 0;
+  if (written) {
+    start = NowNanoseconds();
+    for (size_t i = 0; i < dumper.mappings().size(); ++i) {
+      const MappingInfo& mapping = *dumper.mappings()[i];
+      if (!ShouldIdentifyMapping(mapping))
+        continue;
+      google_breakpad::auto_wasteful_vector<
+          uint8_t, google_breakpad::kDefaultBuildIdSize>
+          identifier(dumper.allocator());
+      dumper.ElfFileIdentifierForMapping(mapping, true, i, identifier);
+    }
+    identify = NowNanoseconds() - start;
+  }
+
+  kill(child, SIGKILL);
+  HANDLE_EINTR(waitpid(child, NULL, 0));
+  if (!written)
+    return false;
+
+  int64_t write = total - dumper.enumerate() - dumper.suspend() -
+      dumper.thread_info() - dumper.copy() - identify - dumper.resume();
+  (*samples)[ENUMERATE].push_back(dumper.enumerate());
+  (*samples)[SUSPEND].push_back(dumper.suspend());
+  (*samples)[THREAD_INFO].push_back(dumper.thread_info());
+  (*samples)[MEMORY_COPY].push_back(dumper.copy());
+  (*samples)[MODULE_IDS].push_back(identify);
+  (*samples)[WRITE].push_back(std::max<int64_t>(write, 0));
+  (*samples)[RESUME].push_back(dumper.resume());
+  (*samples)[DUMP_TOTAL].push_back(total);
+  (*samples)[THREADS_SUSPENDED].push_back(dumper.suspended());
+  return true;
+}
+
+void PrintSamples(Samples* samples, Measurement first, Measurement last) {
+  for (int i = first; i <= last; ++i) {
+    std::vector<int64_t>& values = (*samples)[i];
+    if (values.empty())
+      continue;
+    std::sort(values.begin(), values.end());
+    printf("  %-28s %10.3f %10.3f\n", kMeasurementNames[i],
+           Milliseconds(values[values.size() / 2]),
+           Milliseconds(values.back()));
+  }
+}
+
+void Usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [-t <threads>] [-m <mappings>] [-d <depth>]\n"
+          "          [-r <runs>] [-o <directory>] [-p] [-i]\n",
+          program);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Parameters parameters;
+  parameters.threads = 8;
+  parameters.mappings = 32;
+  parameters.depth = 64;
+  parameters.runs = 5;
+  parameters.directory = "/tmp";
+  parameters.prespawn = false;
+  parameters.precompute_module_ids = false;
+
+  int ch;
+  while ((ch = getopt(argc, argv, "d:im:o:pr:t:")) != -1) {
+    bool valid = true;
+    switch (ch) {
+      case 'd':
+        parameters.depth = atoi(optarg);
+        valid = parameters.depth >= 0;
+        break;
+      case 'i':
+        parameters.precompute_module_ids = true;
+        break;
+      case 'm':
+        parameters.mappings = atoi(optarg);
+        valid = parameters.mappings >= 0;
+        break;
+      case 'o':
+        parameters.directory = optarg;
+        break;
+      case 'p':
+        parameters.prespawn = true;
+        break;
+      case 'r':
+        parameters.runs = atoi(optarg);
+        valid = parameters.runs > 0;
+        break;
+      case 't':
+        parameters.threads = atoi(optarg);
+        valid = parameters.threads >= 0;
+        break;
+      default:
+        valid = false;
+        break;
+    }
+    if (!valid) {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  if (optind != argc) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  CrashTimes* crash_times = static_cast<CrashTimes*>(
+      mmap(NULL, sizeof(CrashTimes), PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  if (crash_times == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+
+  Samples samples;
+  int failures = 0;
+  for (int run = 0; run < parameters.runs; ++run) {
+    if (!MeasureCrash(parameters, crash_times, &samples))
+      ++failures;
+    if (!MeasureDump(parameters, &samples))
+      ++failures;
+  }
+
+  printf("%d threads, %d extra mappings, %d frames deep, %d runs\n",
+         parameters.threads + 1, parameters.mappings, parameters.depth,
+         parameters.runs);
+  printf("  %-28s %10s %10s\n", "ExceptionHandler (ms)", "median", "max");
+  PrintSamples(&samples, SIGNAL_TO_HANDLER, CRASH_TO_DUMPED);
+  printf("  %-28s %10s %10s\n", "LinuxPtraceDumper (ms)", "median", "max");
+  PrintSamples(&samples, ENUMERATE, THREADS_SUSPENDED);
+  if (failures)
+    printf("%d measurements failed\n", failures);
+  return failures ? 1 : 0;
+}
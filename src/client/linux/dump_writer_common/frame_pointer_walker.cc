@@ -0,0 +1,80 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "client/linux/dump_writer_common/frame_pointer_walker.h"
+
+#include <fcntl.h>
+
+#include "client/linux/dump_writer_common/ucontext_reader.h"
+#include "third_party/lss/linux_syscall_support.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The largest gap between a frame pointer and its caller's that the walk
+// accepts.
+const uintptr_t kMaxFrameSize = 1 << 20;
+
+}  // namespace
+
+size_t WalkFramePointers(const ucontext_t* uc,
+                         uintptr_t* pcs,
+                         size_t max_frames) {
+  if (max_frames == 0)
+    return 0;
+  size_t count = 0;
+  pcs[count++] = UContextReader::GetInstructionPointer(uc);
+#if defined(__i386__) || defined(__x86_64__) || defined(__aarch64__)
+  // Each frame pointer points at the caller's frame pointer, followed by
+  // the return address.
+  uintptr_t fp = UContextReader::GetFramePointer(uc);
+  if (fp < UContextReader::GetStackPointer(uc))
+    return count;
+  const int mem_fd = sys_open("/proc/self/mem", O_RDONLY, 0);
+  if (mem_fd < 0)
+    return count;
+  while (count < max_frames && fp % sizeof(uintptr_t) == 0) {
+    uintptr_t frame[2];
+    if (sys_pread64(mem_fd, frame, sizeof(frame), fp) !=
+            static_cast<ssize_t>(sizeof(frame)) ||
+        !frame[1]) {
+      break;
+    }
+    pcs[count++] = frame[1];
+    if (frame[0] <= fp || frame[0] - fp > kMaxFrameSize)
+      break;
+    fp = frame[0];
+  }
+  sys_close(mem_fd);
+#endif
+  return count;
+}
+
+}  // namespace google_breakpad
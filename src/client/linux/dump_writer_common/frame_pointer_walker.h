@@ -0,0 +1,55 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// frame_pointer_walker.h: Unwinds a thread of the calling process by
+// following its chain of frame pointers.
+
+#ifndef CLIENT_LINUX_DUMP_WRITER_COMMON_FRAME_POINTER_WALKER_H_
+#define CLIENT_LINUX_DUMP_WRITER_COMMON_FRAME_POINTER_WALKER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/ucontext.h>
+
+namespace google_breakpad {
+
+// Fills |pcs| with the instruction pointer of the thread of the calling
+// process whose registers are |uc|, followed by the return addresses
+// found by walking its frame pointers, up to |max_frames| in all. Returns
+// how many there are. Memory is read through /proc/self/mem, so a corrupt
+// frame chain ends the walk rather than faulting, and the walk can run in
+// a compromised context. Only the instruction pointer is found on
+// architectures without a standard frame layout.
+size_t WalkFramePointers(const ucontext_t* uc,
+                         uintptr_t* pcs,
+                         size_t max_frames);
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_DUMP_WRITER_COMMON_FRAME_POINTER_WALKER_H_
@@ -48,6 +48,10 @@ uintptr_t UContextReader::GetInstructionPointer(const ucontext_t* uc) {
   return uc->uc_mcontext.gregs[REG_EIP];
 }
 
+uintptr_t UContextReader::GetFramePointer(const ucontext_t* uc) {
+  return uc->uc_mcontext.gregs[REG_EBP];
+}
+
 void UContextReader::FillCPUContext(RawContextCPU* out, const ucontext_t* uc,
                                     const fpstate_t* fp) {
   const greg_t* regs = uc->uc_mcontext.gregs;
@@ -96,6 +100,10 @@ uintptr_t UContextReader::GetInstructionPointer(const ucontext_t* uc) {
   return uc->uc_mcontext.gregs[REG_RIP];
 }
 
+uintptr_t UContextReader::GetFramePointer(const ucontext_t* uc) {
+  return uc->uc_mcontext.gregs[REG_RBP];
+}
+
 void UContextReader::FillCPUContext(RawContextCPU* out, const ucontext_t* uc,
                                     const fpstate_t* fpregs) {
   const greg_t* regs = uc->uc_mcontext.gregs;
@@ -153,6 +161,10 @@ uintptr_t UContextReader::GetInstructionPointer(const ucontext_t* uc) {
   return uc->uc_mcontext.arm_pc;
 }
 
+uintptr_t UContextReader::GetFramePointer(const ucontext_t* uc) {
+  return uc->uc_mcontext.arm_fp;
+}
+
 void UContextReader::FillCPUContext(RawContextCPU* out, const ucontext_t* uc) {
   out->context_flags = MD_CONTEXT_ARM_FULL;
 
@@ -192,6 +204,10 @@ uintptr_t UContextReader::GetInstructionPointer(const ucontext_t* uc) {
   return uc->uc_mcontext.pc;
 }
 
+uintptr_t UContextReader::GetFramePointer(const ucontext_t* uc) {
+  return uc->uc_mcontext.regs[29];
+}
+
 void UContextReader::FillCPUContext(RawContextCPU* out, const ucontext_t* uc,
                                     const struct fpsimd_context* fpregs) {
   out->context_flags = MD_CONTEXT_ARM64_FULL_OLD;
@@ -218,6 +234,10 @@ uintptr_t UContextReader::GetInstructionPointer(const ucontext_t* uc) {
   return uc->uc_mcontext.pc;
 }
 
+uintptr_t UContextReader::GetFramePointer(const ucontext_t* uc) {
+  return uc->uc_mcontext.gregs[MD_CONTEXT_MIPS_REG_FP];
+}
+
 void UContextReader::FillCPUContext(RawContextCPU* out, const ucontext_t* uc) {
 #if _MIPS_SIM == _ABI64
   out->context_flags = MD_CONTEXT_MIPS64_FULL;
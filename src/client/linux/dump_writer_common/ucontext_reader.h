@@ -46,6 +46,9 @@ struct UContextReader {
 
   static uintptr_t GetInstructionPointer(const ucontext_t* uc);
 
+  // The register the ABI uses as the frame pointer, if it has one.
+  static uintptr_t GetFramePointer(const ucontext_t* uc);
+
   // Juggle a arch-specific ucontext_t into a minidump format
   //   out: the minidump structure
   //   info: the collection of register structures.
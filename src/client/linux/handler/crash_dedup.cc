@@ -0,0 +1,167 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "client/linux/handler/crash_dedup.h"
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "client/linux/dump_writer_common/frame_pointer_walker.h"
+#include "client/linux/minidump_writer/line_reader.h"
+#include "common/basictypes.h"
+#include "common/linux/linux_libc_support.h"
+#include "common/memory_allocator.h"
+#include "third_party/lss/linux_syscall_support.h"
+
+namespace google_breakpad {
+
+namespace {
+
+const uint64_t kFnv1aBasis = 14695981039346656037ULL;
+
+uint64_t Fnv1a(uint64_t hash, const void* data, size_t length) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// The most frames a signature covers.
+const size_t kMaxSignatureFrames = 16;
+
+// A crash signature in the file IsRepeatedCrash() keeps.
+struct CrashRecord {
+  uint64_t signature;
+  // When the last minidump for it was written, in seconds since the epoch.
+  int64_t last_dump_time;
+  // How many crashes since then were not dumped.
+  uint64_t suppressed;
+};
+
+// How many signatures the file holds. The least recently dumped one makes
+// way for a new one.
+const size_t kMaxCrashRecords = 32;
+
+}  // namespace
+
+uint64_t ComputeCrashSignature(int signal, const ucontext_t* uc) {
+  uintptr_t pcs[kMaxSignatureFrames];
+  const size_t count = WalkFramePointers(uc, pcs, kMaxSignatureFrames);
+
+  // Frames outside any mapped file, such as in generated code, count as
+  // unresolved wherever they are.
+  uint64_t frame_hashes[kMaxSignatureFrames];
+  my_memset(frame_hashes, 0, sizeof(frame_hashes));
+  const int maps_fd = sys_open("/proc/self/maps", O_RDONLY, 0);
+  if (maps_fd >= 0) {
+    PageAllocator allocator;
+    LineReader* const line_reader = new(allocator) LineReader(maps_fd);
+    const char* line;
+    unsigned line_len;
+    while (line_reader->GetNextLine(&line, &line_len)) {
+      uintptr_t start_addr, end_addr, offset;
+      const char* i1 = my_read_hex_ptr(&start_addr, line);
+      const char* name = my_strchr(line, '/');
+      if (*i1 == '-' && name) {
+        const char* i2 = my_read_hex_ptr(&end_addr, i1 + 1);
+        if (*i2 == ' ') {
+          const char* i3 =
+              my_read_hex_ptr(&offset, i2 + 6 /* skip ' rwxp ' */);
+          if (*i3 == ' ') {
+            for (size_t i = 0; i < count; ++i) {
+              if (frame_hashes[i] || pcs[i] < start_addr ||
+                  pcs[i] >= end_addr) {
+                continue;
+              }
+              const uintptr_t file_offset = pcs[i] - start_addr + offset;
+              frame_hashes[i] = Fnv1a(kFnv1aBasis, name, my_strlen(name));
+              frame_hashes[i] =
+                  Fnv1a(frame_hashes[i], &file_offset, sizeof(file_offset));
+            }
+          }
+        }
+      }
+      line_reader->PopLine(line_len);
+    }
+    sys_close(maps_fd);
+  }
+
+  uint64_t signature = Fnv1a(kFnv1aBasis, &signal, sizeof(signal));
+  return Fnv1a(signature, frame_hashes, count * sizeof(frame_hashes[0]));
+}
+
+bool IsRepeatedCrash(const char* path, uint64_t signature, int window) {
+  const int fd = sys_open(path, O_RDWR | O_CREAT, 0600);
+  if (fd < 0)
+    return false;
+
+  CrashRecord records[kMaxCrashRecords];
+  my_memset(records, 0, sizeof(records));
+  size_t used = 0;
+  while (used < sizeof(records)) {
+    const ssize_t n = sys_read(fd, reinterpret_cast<char*>(records) + used,
+                               sizeof(records) - used);
+    if (n <= 0)
+      break;
+    used += n;
+  }
+
+  // The record for |signature|, or else the least recently dumped one.
+  size_t slot = 0;
+  bool found = false;
+  for (size_t i = 0; i < kMaxCrashRecords; ++i) {
+    if (records[i].signature == signature) {
+      slot = i;
+      found = true;
+      break;
+    }
+    if (records[i].last_dump_time < records[slot].last_dump_time)
+      slot = i;
+  }
+
+  const int64_t now = time(NULL);
+  const bool repeated = found && now >= records[slot].last_dump_time &&
+                        now - records[slot].last_dump_time < window;
+  if (repeated) {
+    ++records[slot].suppressed;
+  } else {
+    records[slot].signature = signature;
+    records[slot].last_dump_time = now;
+    records[slot].suppressed = 0;
+  }
+  if (sys_lseek(fd, 0, SEEK_SET) == 0)
+    ignore_result(sys_write(fd, records, sizeof(records)));
+  sys_close(fd);
+  return repeated;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,64 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_dedup.h: Recognizes repeats of a crash, so that a process that
+// crash-loops writes one minidump per crash site and time window rather
+// than one per restart. Both functions can run in a compromised context.
+
+#ifndef CLIENT_LINUX_HANDLER_CRASH_DEDUP_H_
+#define CLIENT_LINUX_HANDLER_CRASH_DEDUP_H_
+
+#include <stdint.h>
+#include <sys/ucontext.h>
+
+namespace google_breakpad {
+
+// Returns a hash of where the calling process crashed with |signal| in
+// the context |uc|: the signal and, for each frame of a frame pointer
+// walk of the crashing thread, the path of the file mapped where the
+// frame's address is and the address's offset in that file. The hash is
+// the same across runs of the same binaries wherever they are loaded.
+// Memory is read through /proc/self/mem, so a corrupt frame chain ends
+// the walk rather than faulting. Only the crashing instruction is
+// hashed on architectures without a standard frame layout.
+uint64_t ComputeCrashSignature(int signal, const ucontext_t* uc);
+
+// Records a crash with |signature| in the file at |path|, which holds
+// the most recent signatures and when a minidump was last written for
+// each. Returns true if one was written for |signature| less than
+// |window| seconds ago, in which case the crash is counted against it in
+// the file and no minidump should be written. Otherwise, or if the file
+// can't be used, returns false and records now as the time of the last
+// minidump for |signature|. Crashes of several processes sharing the file
+// at the same moment may miss each other.
+bool IsRepeatedCrash(const char* path, uint64_t signature, int window);
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_HANDLER_CRASH_DEDUP_H_
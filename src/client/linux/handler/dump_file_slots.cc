@@ -0,0 +1,149 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "client/linux/handler/dump_file_slots.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace google_breakpad {
+
+namespace {
+
+// fallocate() mode that allocates blocks without changing the file's size.
+const int kFallocKeepSize = 1;
+
+const char kSlotPrefix[] = ".slot-";
+
+// Renames and removes files with raw system calls, which are safe in a
+// compromised context. The *at() forms are the ones every architecture
+// has.
+bool RenameFile(const char* from, const char* to) {
+#if defined(__NR_renameat)
+  return syscall(__NR_renameat, AT_FDCWD, from, AT_FDCWD, to) == 0;
+#else
+  return syscall(__NR_renameat2, AT_FDCWD, from, AT_FDCWD, to, 0) == 0;
+#endif
+}
+
+void RemoveFile(const char* path) {
+  syscall(__NR_unlinkat, AT_FDCWD, path, 0);
+}
+
+// Removes the slot files in |directory| of processes that have gone.
+void RemoveStaleSlots(const string& directory) {
+  DIR* dir = opendir(directory.c_str());
+  if (!dir)
+    return;
+  const size_t prefix_length = sizeof(kSlotPrefix) - 1;
+  while (struct dirent* entry = readdir(dir)) {
+    if (strncmp(entry->d_name, kSlotPrefix, prefix_length) != 0)
+      continue;
+    char* end;
+    const long pid = strtol(entry->d_name + prefix_length, &end, 10);
+    if (end == entry->d_name + prefix_length || *end != '-' || pid <= 0)
+      continue;
+    if (kill(pid, 0) == -1 && errno == ESRCH)
+      unlink((directory + "/" + entry->d_name).c_str());
+  }
+  closedir(dir);
+}
+
+}  // namespace
+
+DumpFileSlots::DumpFileSlots(const string& directory, int count, off_t size)
+    : size_(size), ready_(count > 0 ? count : 0, 0) {
+  RemoveStaleSlots(directory);
+  for (size_t i = 0; i < ready_.size(); ++i) {
+    char name[64];
+    snprintf(name, sizeof(name), "/%s%d-%zu", kSlotPrefix, getpid(), i);
+    paths_.push_back(directory + name);
+  }
+}
+
+DumpFileSlots::~DumpFileSlots() {
+  for (size_t i = 0; i < ready_.size(); ++i) {
+    if (ready_[i])
+      unlink(paths_[i].c_str());
+  }
+}
+
+int DumpFileSlots::Refill() {
+  int ready = 0;
+  for (size_t i = 0; i < ready_.size(); ++i) {
+    // A minidump written by a process cloned without this one's memory
+    // takes its slot in its own copy of |ready_|, so check that a slot
+    // still marked ready has its file.
+    struct stat st;
+    if (ready_[i] && stat(paths_[i].c_str(), &st) == 0) {
+      ++ready;
+      continue;
+    }
+    const int fd = open(paths_[i].c_str(),
+                        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1)
+      continue;
+    // A file system without fallocate() still saves creating the file.
+    if (size_ > 0)
+      fallocate(fd, kFallocKeepSize, 0, size_);
+    close(fd);
+    __sync_lock_test_and_set(&ready_[i], 1);
+    ++ready;
+  }
+  return ready;
+}
+
+int DumpFileSlots::Take() {
+  for (size_t i = 0; i < ready_.size(); ++i) {
+    if (__sync_bool_compare_and_swap(&ready_[i], 1, 0))
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+bool DumpFileSlots::Commit(int slot, const char* path) {
+  if (RenameFile(paths_[slot].c_str(), path))
+    return true;
+  RemoveFile(paths_[slot].c_str());
+  return false;
+}
+
+void DumpFileSlots::Discard(int slot) {
+  RemoveFile(paths_[slot].c_str());
+}
+
+}  // namespace google_breakpad
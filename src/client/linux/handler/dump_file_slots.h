@@ -0,0 +1,97 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dump_file_slots.h: Minidump files created, and their space allocated,
+// ahead of a crash, so that writing a minidump to a directory neither
+// creates an inode nor allocates disk blocks while the crashed process's
+// threads are suspended. On a busy ext4 or XFS volume either can stall
+// for a long time.
+
+#ifndef CLIENT_LINUX_HANDLER_DUMP_FILE_SLOTS_H_
+#define CLIENT_LINUX_HANDLER_DUMP_FILE_SLOTS_H_
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+// A ring of |count| files in a directory, each with |size| bytes
+// allocated past its end (fallocate() with FALLOC_FL_KEEP_SIZE), so that
+// a minidump writer growing it with ftruncate() and writing into it
+// finds the blocks already there. A minidump is written into a slot's
+// file and the file renamed to the minidump's path; nothing is fsync()ed.
+// A minidump that fails leaves its slot's file removed.
+//
+// The files are named ".slot-<pid>-<n>" so that those left behind by a
+// process that has gone, which are of no use to anyone, can be removed.
+class DumpFileSlots {
+ public:
+  // Runs in a normal context. Removes the slot files of processes that
+  // have gone from |directory|; call Refill() to create this process's.
+  DumpFileSlots(const string& directory, int count, off_t size);
+
+  // Removes the slot files not used. Runs in a normal context.
+  ~DumpFileSlots();
+
+  // Creates and allocates the slot files that are missing, because they
+  // were never created or a minidump used them. Returns how many are
+  // ready. Runs in a normal context.
+  int Refill();
+
+  // Takes a ready slot and returns its index, or -1 if none is ready.
+  // Can run in a compromised context.
+  int Take();
+
+  // The path of |slot|'s file, for opening it O_WRONLY.
+  const char* path(int slot) const { return paths_[slot].c_str(); }
+
+  // Renames |slot|'s file, with a minidump written to it, to |path|.
+  // If it can't be renamed, the file is removed. Returns whether it was
+  // renamed. Can run in a compromised context.
+  bool Commit(int slot, const char* path);
+
+  // Removes |slot|'s file, when writing a minidump to it has failed. Can
+  // run in a compromised context.
+  void Discard(int slot);
+
+ private:
+  const off_t size_;
+  std::vector<string> paths_;
+  // Whether each slot's file is created and not yet taken. Changed with
+  // atomic operations.
+  std::vector<int> ready_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_HANDLER_DUMP_FILE_SLOTS_H_
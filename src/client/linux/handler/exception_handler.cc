@@ -67,6 +67,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <link.h>
 #include <linux/limits.h>
 #include <pthread.h>
 #include <sched.h>
@@ -74,6 +75,7 @@
 #include <stdio.h>
 #include <sys/mman.h>
 #include <sys/prctl.h>
+#include <sys/socket.h>
 #include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -88,8 +90,12 @@
 
 #include "common/basictypes.h"
 #include "common/linux/breakpad_getcontext.h"
+#include "common/linux/file_id.h"
 #include "common/linux/linux_libc_support.h"
+#include "common/linux/memory_mapped_file.h"
 #include "common/memory_allocator.h"
+#include "common/trace_probes.h"
+#include "client/linux/handler/crash_dedup.h"
 #include "client/linux/log/log.h"
 #include "client/linux/microdump_writer/microdump_writer.h"
 #include "client/linux/minidump_writer/linux_dumper.h"
@@ -213,6 +219,11 @@ pthread_mutex_t g_handler_stack_mutex_ = PTHREAD_MUTEX_INITIALIZER;
 ExceptionHandler::CrashContext g_crash_context_;
 
 FirstChanceHandler g_first_chance_handler_ = nullptr;
+
+// The stack of the process that writes a minidump. Allocating too much stack
+// isn't a problem, and better to err on the side of caution than smash it
+// into random locations.
+const unsigned kChildStackSize = 16000;
 }  // namespace
 
 // Runs before crashing: normal context.
@@ -261,6 +272,14 @@ ExceptionHandler::~ExceptionHandler() {
   std::vector<ExceptionHandler*>::iterator handler =
       std::find(g_handler_stack_->begin(), g_handler_stack_->end(), this);
   g_handler_stack_->erase(handler);
+  if (module_id_cache_.get() &&
+      FileIdCache::process_cache() == module_id_cache_.get()) {
+    FileIdCache::SetProcessCache(NULL);
+  }
+  if (cpu_info_cache_.get() &&
+      CpuInfoCache::process_cache() == cpu_info_cache_.get()) {
+    CpuInfoCache::SetProcessCache(NULL);
+  }
   if (g_handler_stack_->empty()) {
     delete g_handler_stack_;
     g_handler_stack_ = NULL;
@@ -268,6 +287,7 @@ ExceptionHandler::~ExceptionHandler() {
     RestoreHandlersLocked();
   }
   pthread_mutex_unlock(&g_handler_stack_mutex_);
+  StopDumper();
 }
 
 // Runs before crashing: normal context.
@@ -437,7 +457,7 @@ int ExceptionHandler::ThreadEntry(void* arg) {
 
 // This function runs in a compromised context: see the top of the file.
 // Runs on the crashing thread.
-bool ExceptionHandler::HandleSignal(int /*sig*/, siginfo_t* info, void* uc) {
+bool ExceptionHandler::HandleSignal(int sig, siginfo_t* info, void* uc) {
   if (filter_ && !filter_(callback_context_))
     return false;
 
@@ -478,6 +498,18 @@ bool ExceptionHandler::HandleSignal(int /*sig*/, siginfo_t* info, void* uc) {
       return true;
     }
   }
+
+  // Leave out repeats of a recent crash (see set_crash_dedup()).
+  minidump_descriptor_.set_crash_deduplicated(false);
+  const char* const dedup_path = minidump_descriptor_.crash_dedup_path();
+  if (!IsOutOfProcess() && dedup_path &&
+      IsRepeatedCrash(dedup_path,
+                      ComputeCrashSignature(sig, &g_crash_context_.context),
+                      minidump_descriptor_.crash_dedup_window())) {
+    minidump_descriptor_.set_crash_deduplicated(true);
+    return callback_ &&
+           callback_(minidump_descriptor_, callback_context_, false);
+  }
   return GenerateDump(&g_crash_context_);
 }
 
@@ -496,12 +528,17 @@ bool ExceptionHandler::SimulateSignalDelivery(int sig) {
 
 // This function may run in a compromised context: see the top of the file.
 bool ExceptionHandler::GenerateDump(CrashContext* context) {
+  BREAKPAD_PROBE_SCOPE(generate_dump);
   if (IsOutOfProcess())
     return crash_generation_client_->RequestDump(context, sizeof(*context));
 
-  // Allocating too much stack isn't a problem, and better to err on the side
-  // of caution than smash it into random locations.
-  static const unsigned kChildStackSize = 16000;
+  bool success = false;
+  if (DumpWithPrespawnedDumper(context, &success)) {
+    if (callback_)
+      success = callback_(minidump_descriptor_, callback_context_, success);
+    return success;
+  }
+
   PageAllocator allocator;
   uint8_t* stack = reinterpret_cast<uint8_t*>(allocator.Alloc(kChildStackSize));
   if (!stack)
@@ -561,12 +598,131 @@ bool ExceptionHandler::GenerateDump(CrashContext* context) {
     logger::write("\n", 1);
   }
 
-  bool success = r != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  success = r != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
   if (callback_)
     success = callback_(minidump_descriptor_, callback_context_, success);
   return success;
 }
 
+struct ForkArgument {
+  ExceptionHandler* handler;
+  ExceptionHandler::CrashContext* context;  // the asking thread's
+  uint8_t* copy_stack;  // the top of the stack CopyEntry runs on
+};
+
+// Runs on the first fork, which only starts the copy that is dumped and
+// exits, leaving the copy to init.
+// static
+int ExceptionHandler::ForkEntry(void* arg) {
+  const ForkArgument* fork_arg = reinterpret_cast<ForkArgument*>(arg);
+  const pid_t copy = sys_clone(CopyEntry, fork_arg->copy_stack, SIGCHLD, arg,
+                               NULL, NULL, NULL);
+  return copy == -1;
+}
+
+// Runs on the copy that is dumped.
+// static
+int ExceptionHandler::CopyEntry(void* arg) {
+  const ForkArgument* fork_arg = reinterpret_cast<ForkArgument*>(arg);
+  // The copy's one thread stands in for the thread that asked for the dump,
+  // whose registers the context holds and whose stack the copy holds.
+  fork_arg->context->tid = sys_gettid();
+  return fork_arg->handler->GenerateDump(fork_arg->context) == false;
+}
+
+bool ExceptionHandler::GenerateDumpFromFork(CrashContext* context) {
+  PageAllocator allocator;
+  uint8_t* stacks =
+      reinterpret_cast<uint8_t*>(allocator.Alloc(2 * kChildStackSize));
+  if (!stacks)
+    return false;
+  // clone() needs the top-most addresses. (scrub just to be safe)
+  uint8_t* fork_stack = stacks + kChildStackSize;
+  my_memset(fork_stack - 16, 0, 16);
+  ForkArgument fork_arg;
+  fork_arg.handler = this;
+  fork_arg.context = context;
+  fork_arg.copy_stack = fork_stack + kChildStackSize;
+  my_memset(fork_arg.copy_stack - 16, 0, 16);
+
+  const pid_t child = sys_clone(ForkEntry, fork_stack, CLONE_UNTRACED,
+                                &fork_arg, NULL, NULL, NULL);
+  if (child == -1)
+    return false;
+  int status = 0;
+  const int r = HANDLE_EINTR(sys_waitpid(child, &status, __WALL));
+  return r != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// This function runs in a compromised context: see the top of the file.
+// Runs on the crashing thread.
+bool ExceptionHandler::DumpWithPrespawnedDumper(CrashContext* context,
+                                                bool* succeeded) {
+  // A process forked from the one that started the dumper can't use it.
+  if (dumper_pid_ == -1 || sys_getpid() != dumper_parent_)
+    return false;
+  if (__atomic_exchange_n(&dumper_busy_, 1, __ATOMIC_ACQUIRE))
+    return false;
+
+  dumper_context_ = context;
+  // Allow the dumper to ptrace us
+  sys_prctl(PR_SET_PTRACER, dumper_pid_, 0, 0, 0);
+
+  // Send with MSG_NOSIGNAL so that a dead dumper fails the send, rather than
+  // raising SIGPIPE.
+  char request = 'd';
+  struct kernel_iovec iov;
+  iov.iov_base = &request;
+  iov.iov_len = sizeof(request);
+  struct kernel_msghdr msg = { 0 };
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  char result = 0;
+  if (HANDLE_EINTR(sys_sendmsg(dumper_fds_[0], &msg, MSG_NOSIGNAL)) != 1 ||
+      HANDLE_EINTR(sys_read(dumper_fds_[0], &result, sizeof(result))) != 1) {
+    static const char no_answer_msg[] =
+        "ExceptionHandler::DumpWithPrespawnedDumper dumper didn't answer\n";
+    logger::write(no_answer_msg, sizeof(no_answer_msg) - 1);
+    // Leave the dumper busy, so the next dump doesn't try it either.
+    return false;
+  }
+
+  *succeeded = result == 1;
+  __atomic_store_n(&dumper_busy_, 0, __ATOMIC_RELEASE);
+  return true;
+}
+
+// This is the entry function for the dumper PrespawnDumper() starts. It
+// shares the memory of the process it dumps, but not its file descriptors or
+// signal handlers, and has no thread-local storage of its own: errno it sets
+// is that of the thread that started it. We are in a compromised context
+// here: see the top of the file.
+// static
+int ExceptionHandler::DumperEntry(void* arg) {
+  ExceptionHandler* const handler = reinterpret_cast<ExceptionHandler*>(arg);
+
+  // Signals meant for the process, such as SIGINT from a terminal, mustn't
+  // kill the dumper while the process still needs it; it exits when the
+  // process closes its end of the socket pair.
+  kernel_sigset_t signals;
+  sys_sigfillset(&signals);
+  sys_sigprocmask(SIG_BLOCK, &signals, NULL);
+  sys_close(handler->dumper_fds_[0]);
+
+  char request;
+  while (HANDLE_EINTR(sys_read(handler->dumper_fds_[1], &request,
+                               sizeof(request))) == 1) {
+    const char result =
+        handler->DoDump(handler->dumper_parent_, handler->dumper_context_,
+                        sizeof(*handler->dumper_context_)) ? 1 : 0;
+    if (HANDLE_EINTR(sys_write(handler->dumper_fds_[1], &result,
+                               sizeof(result))) != 1) {
+      break;
+    }
+  }
+  return 0;
+}
+
 // This function runs in a compromised context: see the top of the file.
 void ExceptionHandler::SendContinueSignalToChild() {
   static const char okToContinueMessage = 'a';
@@ -596,6 +752,63 @@ void ExceptionHandler::WaitForContinueSignal() {
   }
 }
 
+// Runs before crashing: normal context.
+bool ExceptionHandler::PrespawnDumper() {
+  if (dumper_pid_ != -1)
+    return true;
+  if (IsOutOfProcess())
+    return false;
+
+  void* stack = mmap(NULL, kChildStackSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (stack == MAP_FAILED)
+    return false;
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, dumper_fds_) == -1) {
+    munmap(stack, kChildStackSize);
+    return false;
+  }
+
+  // The dumper shares our memory, so it needs no copy of a crash's context
+  // and sees the current MinidumpDescriptor, mappings and app memory. It
+  // keeps its own file descriptor table, so that it sees its end of the
+  // socket pair close when we're gone.
+  dumper_stack_ = reinterpret_cast<uint8_t*>(stack);
+  dumper_parent_ = getpid();
+  const pid_t dumper = sys_clone(DumperEntry, dumper_stack_ + kChildStackSize,
+                                 CLONE_VM | CLONE_FS | CLONE_UNTRACED, this,
+                                 NULL, NULL, NULL);
+  close(dumper_fds_[1]);
+  if (dumper == -1) {
+    close(dumper_fds_[0]);
+    dumper_fds_[0] = dumper_fds_[1] = -1;
+    munmap(dumper_stack_, kChildStackSize);
+    dumper_stack_ = NULL;
+    return false;
+  }
+  dumper_pid_ = dumper;
+  return true;
+}
+
+// static
+bool ExceptionHandler::ReserveDumpMemory(size_t bytes) {
+  return PageAllocator::Reserve(bytes);
+}
+
+// Runs before crashing: normal context.
+void ExceptionHandler::StopDumper() {
+  if (dumper_pid_ == -1)
+    return;
+  // Shut the socket down rather than just closing it, in case a process
+  // forked from this one holds a copy.
+  shutdown(dumper_fds_[0], SHUT_RDWR);
+  close(dumper_fds_[0]);
+  HANDLE_EINTR(waitpid(dumper_pid_, NULL, __WALL));
+  munmap(dumper_stack_, kChildStackSize);
+  dumper_pid_ = -1;
+  dumper_fds_[0] = dumper_fds_[1] = -1;
+  dumper_stack_ = NULL;
+}
+
 // This function runs in a compromised context: see the top of the file.
 // Runs on the cloned process.
 bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
@@ -605,6 +818,11 @@ bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
   const uintptr_t principal_mapping_address =
       minidump_descriptor_.address_within_principal_mapping();
   const bool sanitize_stacks = minidump_descriptor_.sanitize_stacks();
+  StackCaptureLimits stack_limits;
+  stack_limits.thread_stack_len = minidump_descriptor_.thread_stack_limit();
+  stack_limits.total_stack_len = minidump_descriptor_.total_stack_limit();
+  const ThreadSelection& thread_selection =
+      minidump_descriptor_.thread_selection();
   if (minidump_descriptor_.IsMicrodumpOnConsole()) {
     return google_breakpad::WriteMicrodump(
         crashing_process,
@@ -616,6 +834,32 @@ bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
         sanitize_stacks,
         *minidump_descriptor_.microdump_extra_info());
   }
+  // Write into a preallocated file, if one is left, and name it after.
+  int slot = -1;
+  int slot_fd = -1;
+  if (dump_file_slots_.get() && !minidump_descriptor_.IsFD()) {
+    slot = dump_file_slots_->Take();
+    if (slot != -1) {
+      slot_fd = sys_open(dump_file_slots_->path(slot), O_WRONLY, 0);
+      if (slot_fd < 0) {
+        dump_file_slots_->Discard(slot);
+        slot = -1;
+      }
+    }
+  }
+  if (slot != -1) {
+    const bool success = google_breakpad::WriteMinidump(
+        slot_fd, minidump_descriptor_.size_limit(), crashing_process, context,
+        context_size, mapping_list_, app_memory_list_, may_skip_dump,
+        principal_mapping_address, sanitize_stacks, stack_limits,
+        minidump_descriptor_.compress(), thread_selection);
+    sys_close(slot_fd);
+    if (!success) {
+      dump_file_slots_->Discard(slot);
+      return false;
+    }
+    return dump_file_slots_->Commit(slot, minidump_descriptor_.path());
+  }
   if (minidump_descriptor_.IsFD()) {
     return google_breakpad::WriteMinidump(minidump_descriptor_.fd(),
                                           minidump_descriptor_.size_limit(),
@@ -626,7 +870,10 @@ bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
                                           app_memory_list_,
                                           may_skip_dump,
                                           principal_mapping_address,
-                                          sanitize_stacks);
+                                          sanitize_stacks,
+                                          stack_limits,
+                                          minidump_descriptor_.compress(),
+                                          thread_selection);
   }
   return google_breakpad::WriteMinidump(minidump_descriptor_.path(),
                                         minidump_descriptor_.size_limit(),
@@ -637,7 +884,10 @@ bool ExceptionHandler::DoDump(pid_t crashing_process, const void* context,
                                         app_memory_list_,
                                         may_skip_dump,
                                         principal_mapping_address,
-                                        sanitize_stacks);
+                                        sanitize_stacks,
+                                        stack_limits,
+                                        minidump_descriptor_.compress(),
+                                        thread_selection);
 }
 
 // static
@@ -730,7 +980,15 @@ bool ExceptionHandler::WriteMinidump() {
 #error "This code has not been ported to your platform yet."
 #endif
 
-  return GenerateDump(&context);
+  bool success;
+  if (minidump_descriptor_.dump_from_fork() && !IsOutOfProcess())
+    success = GenerateDumpFromFork(&context);
+  else
+    success = GenerateDump(&context);
+  // Replace the preallocated file the minidump used, if it used one.
+  if (dump_file_slots_.get())
+    dump_file_slots_->Refill();
+  return success;
 }
 
 void ExceptionHandler::AddMappingInfo(const string& name,
@@ -751,6 +1009,75 @@ void ExceptionHandler::AddMappingInfo(const string& name,
   mapping_list_.push_back(mapping);
 }
 
+namespace {
+
+// The number of identifiers PrecomputeModuleIdentifiers() has room for.
+const size_t kModuleIdCacheSize = 512;
+
+// Runs before crashing: normal context.
+// Called by dl_iterate_phdr() for each loaded object: caches its identifier
+// in the FileIdCache |data|, keyed as LinuxDumper looks it up.
+int CacheModuleIdentifier(struct dl_phdr_info* info, size_t, void* data) {
+  FileIdCache* cache = static_cast<FileIdCache*>(data);
+  // The main program has no name; its mapping names the file
+  // /proc/self/exe links to, which has the same key.
+  const char* path = info->dlpi_name[0] ? info->dlpi_name : "/proc/self/exe";
+
+  FileIdCache::Key key;
+  if (!FileIdCache::GetKey(path, 0, &key))
+    return 0;
+  PageAllocator allocator;
+  auto_wasteful_vector<uint8_t, kDefaultBuildIdSize> identifier(&allocator);
+  if (cache->Lookup(key, identifier))
+    return 0;
+
+  MemoryMappedFile mapped_file(path, 0);
+  if (!mapped_file.data() || mapped_file.size() < SELFMAG)
+    return 0;
+  if (FileID::ElfFileIdentifierFromMappedFile(mapped_file.data(), identifier))
+    cache->Insert(key, identifier);
+  return 0;
+}
+
+}  // namespace
+
+// Runs before crashing: normal context.
+void ExceptionHandler::PrecomputeModuleIdentifiers() {
+  FileIdCache* cache = FileIdCache::process_cache();
+  if (!cache) {
+    if (!module_id_cache_.get())
+      module_id_cache_.reset(new FileIdCache(kModuleIdCacheSize));
+    cache = module_id_cache_.get();
+    FileIdCache::SetProcessCache(cache);
+  }
+  dl_iterate_phdr(CacheModuleIdentifier, cache);
+}
+
+// Runs before crashing: normal context.
+bool ExceptionHandler::PrecaptureCpuInfo(bool compact) {
+  const CpuInfoCache* installed = CpuInfoCache::process_cache();
+  if (installed && installed != cpu_info_cache_.get())
+    return installed->captured();
+  scoped_ptr<CpuInfoCache> cache(new CpuInfoCache);
+  if (!cache->Capture(compact))
+    return false;
+  CpuInfoCache::SetProcessCache(cache.get());
+  cpu_info_cache_.swap(cache);
+  return true;
+}
+
+// Runs before crashing: normal context.
+int ExceptionHandler::PreallocateDumpFiles(int count, off_t size) {
+  if (IsOutOfProcess() || minidump_descriptor_.IsFD() ||
+      minidump_descriptor_.IsMicrodumpOnConsole() ||
+      minidump_descriptor_.directory().empty()) {
+    return 0;
+  }
+  dump_file_slots_.reset(
+      new DumpFileSlots(minidump_descriptor_.directory(), count, size));
+  return dump_file_slots_->Refill();
+}
+
 void ExceptionHandler::RegisterAppMemory(void* ptr, size_t length) {
   AppMemoryList::iterator iter =
     std::find(app_memory_list_.begin(), app_memory_list_.end(), ptr);
@@ -38,7 +38,10 @@
 #include <string>
 
 #include "client/linux/crash_generation/crash_generation_client.h"
+#include "client/linux/handler/dump_file_slots.h"
 #include "client/linux/handler/minidump_descriptor.h"
+#include "client/linux/minidump_writer/cpu_info_cache.h"
+#include "client/linux/minidump_writer/file_id_cache.h"
 #include "client/linux/minidump_writer/minidump_writer.h"
 #include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
@@ -214,6 +217,51 @@ class ExceptionHandler {
                       size_t mapping_size,
                       size_t file_offset);
 
+  // Compute the identifiers of the modules loaded into the process now, so
+  // that a dump written in the signal handler only stat()s each module and
+  // looks its identifier up, rather than reading and perhaps hashing the
+  // file. The identifiers are kept in a FileIdCache installed for the
+  // process, unless one is installed already. Call this again after loading
+  // libraries with dlopen() to add them; libraries missing from the cache
+  // are still identified at crash time.
+  void PrecomputeModuleIdentifiers();
+
+  // Read /proc/cpuinfo now, so that a dump written in the signal handler
+  // copies it from memory rather than reading it, and parsing it again,
+  // while the crashed process's threads are suspended. If |compact| is
+  // true, only what sets each processor apart from the first is kept
+  // (see CpuInfoCache::Compact()). The copy is kept in a CpuInfoCache
+  // installed for the process, unless one is installed already; calling
+  // this again replaces the copy this handler installed. Returns false if
+  // /proc/cpuinfo can't be read.
+  bool PrecaptureCpuInfo(bool compact);
+
+  // Start the process that will write the minidump of a crash now, so that
+  // the signal handler only has to wake it, rather than clone() a process
+  // and wait for it to start. This makes a dump quicker, and possible even
+  // when the process is at its memory or process limits. The dumper shares
+  // this process's memory, but has copies of its file descriptors as of
+  // this call: a file descriptor in the MinidumpDescriptor must be open by
+  // then. If the dumper is busy or has died, the signal handler clones a
+  // process as usual. Has no effect on out-of-process dumps.
+  // Returns true if the dumper is running.
+  bool PrespawnDumper();
+
+  // Create |count| files of |size| bytes allocated in the MinidumpDescriptor's
+  // directory now, so that a minidump written there is written into one
+  // of them and renamed to its path, rather than created and grown while
+  // the crashed process's threads are suspended (see DumpFileSlots).
+  // WriteMinidump() replaces the file it used; without a file left, a
+  // minidump is written as usual. Has no effect on out-of-process dumps or
+  // a descriptor without a directory. Returns how many files are ready.
+  int PreallocateDumpFiles(int count, off_t size);
+
+  // Maps |bytes| up front for writing dumps, so that a dump doesn't call
+  // mmap() until it has used them all. Every dump in the process reuses
+  // them, and they are never unmapped. See PageAllocator::Reserve().
+  // Returns false if they can't be mapped or were reserved already.
+  static bool ReserveDumpMemory(size_t bytes);
+
   // Register a block of memory of length bytes starting at address ptr
   // to be copied to the minidump when a crash happens.
   void RegisterAppMemory(void* ptr, size_t length);
@@ -235,11 +283,17 @@ class ExceptionHandler {
 
   void PreresolveSymbols();
   bool GenerateDump(CrashContext* context);
+  bool GenerateDumpFromFork(CrashContext* context);
   void SendContinueSignalToChild();
   void WaitForContinueSignal();
 
   static void SignalHandler(int sig, siginfo_t* info, void* uc);
   static int ThreadEntry(void* arg);
+  static int ForkEntry(void* arg);
+  static int CopyEntry(void* arg);
+  static int DumperEntry(void* arg);
+  bool DumpWithPrespawnedDumper(CrashContext* context, bool* succeeded);
+  void StopDumper();
   bool DoDump(pid_t crashing_process, const void* context,
               size_t context_size);
 
@@ -264,10 +318,30 @@ class ExceptionHandler {
   // ptrace. This is used to store the file descriptors for the pipe
   int fdes[2] = {-1, -1};
 
+  // The dumper PrespawnDumper() started, if any: its pid, the process it
+  // dumps, the socket pair it waits on (this process's end first), its
+  // stack, the context of the crash it's asked to dump, and whether it is
+  // busy. It stays busy for good once it fails to answer.
+  pid_t dumper_pid_ = -1;
+  pid_t dumper_parent_ = -1;
+  int dumper_fds_[2] = {-1, -1};
+  uint8_t* dumper_stack_ = NULL;
+  const CrashContext* dumper_context_ = NULL;
+  int dumper_busy_ = 0;
+
   // Callers can add extra info about mappings for cases where the
   // dumper code cannot extract enough information from /proc/<pid>/maps.
   MappingList mapping_list_;
 
+  // The cache PrecomputeModuleIdentifiers() installed, if it did.
+  scoped_ptr<FileIdCache> module_id_cache_;
+
+  // The cache PrecaptureCpuInfo() installed, if it did.
+  scoped_ptr<CpuInfoCache> cpu_info_cache_;
+
+  // The files PreallocateDumpFiles() created, if it was called.
+  scoped_ptr<DumpFileSlots> dump_file_slots_;
+
   // Callers can request additional memory regions to be included in
   // the dump.
   AppMemoryList app_memory_list_;
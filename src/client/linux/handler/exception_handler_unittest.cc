@@ -40,14 +40,17 @@
 #include <sys/cachectl.h>
 #endif
 
+#include <algorithm>
 #include <string>
 
 #include "breakpad_googletest_includes.h"
 #include "client/linux/handler/exception_handler.h"
 #include "client/linux/minidump_writer/minidump_writer.h"
 #include "common/linux/eintr_wrapper.h"
+#include "common/linux/file_id.h"
 #include "common/linux/ignore_ret.h"
 #include "common/linux/linux_libc_support.h"
+#include "common/linux/memory_mapped_file.h"
 #include "common/tests/auto_tempdir.h"
 #include "common/using_std_string.h"
 #include "third_party/lss/linux_syscall_support.h"
@@ -207,7 +210,7 @@ static void DoNullPointerDereference() {
   *p_null = 1;
 }
 
-void ChildCrash(bool use_fd) {
+void ChildCrash(bool use_fd, bool prespawn_dumper = false) {
   AutoTempDir temp_dir;
   int fds[2] = {0};
   int minidump_fd = -1;
@@ -232,6 +235,8 @@ void ChildCrash(bool use_fd) {
                                            NULL, DoneCallback, fd_param,
                                            true, -1));
       }
+      if (prespawn_dumper)
+        ASSERT_TRUE(handler->PrespawnDumper());
       // Crash with the exception handler in scope.
       DoNullPointerDereference();
     }
@@ -258,6 +263,11 @@ TEST(ExceptionHandlerTest, ChildCrashWithFD) {
   ASSERT_NO_FATAL_FAILURE(ChildCrash(true));
 }
 
+TEST(ExceptionHandlerTest, ChildCrashWithPrespawnedDumper) {
+  ASSERT_NO_FATAL_FAILURE(ChildCrash(false, true));
+  ASSERT_NO_FATAL_FAILURE(ChildCrash(true, true));
+}
+
 #if !defined(__ANDROID_API__) || __ANDROID_API__ >= __ANDROID_API_N__
 static void* SleepFunction(void* unused) {
   while (true) usleep(1000000);
@@ -273,6 +283,32 @@ static void* CrashFunction(void* b_ptr) {
 
 // Tests that concurrent crashes do not enter a loop by alternately triggering
 // the signal handler.
+TEST(ExceptionHandlerTest, ChildCrashDeduplicated) {
+  AutoTempDir temp_dir;
+  const string dedup_path = temp_dir.path() + "/crashes";
+  // The same crash twice: only the first is dumped.
+  for (int i = 0; i < 2; ++i) {
+    string minidump_path;
+    const int minidump_fd = CreateTMPFile(temp_dir.path(), &minidump_path);
+    const pid_t child = fork();
+    if (child == 0) {
+      MinidumpDescriptor descriptor(minidump_fd);
+      descriptor.set_crash_dedup(dedup_path, 3600);
+      ExceptionHandler handler(descriptor, NULL, NULL, NULL, true, -1);
+      DoNullPointerDereference();
+    }
+    ASSERT_NO_FATAL_FAILURE(WaitForProcessToTerminate(child, SIGSEGV));
+
+    struct stat st;
+    ASSERT_EQ(0, fstat(minidump_fd, &st));
+    if (i == 0)
+      EXPECT_GT(st.st_size, 0);
+    else
+      EXPECT_EQ(0, st.st_size);
+    close(minidump_fd);
+  }
+}
+
 TEST(ExceptionHandlerTest, ParallelChildCrashesDontHang) {
   AutoTempDir temp_dir;
   const pid_t child = fork();
@@ -1129,6 +1165,24 @@ TEST(ExceptionHandlerTest, GenerateMultipleDumpsWithFD) {
   ASSERT_GT(size, 0);
 }
 
+TEST(ExceptionHandlerTest, GenerateMultipleDumpsInMemory) {
+  MinidumpDescriptor descriptor(MinidumpDescriptor::kMinidumpInMemory);
+  // Kernels before 3.17 can't create the file.
+  if (!descriptor.IsFD())
+    return;
+  ExceptionHandler handler(descriptor, NULL, NULL, NULL, false, -1);
+  const int fd = handler.minidump_descriptor().fd();
+  ASSERT_TRUE(handler.WriteMinidump());
+  ASSERT_GT(lseek(fd, 0, SEEK_CUR), 0);
+
+  // The second minidump replaces the first, and reads back through the
+  // path an uploader would be given.
+  ASSERT_TRUE(handler.WriteMinidump());
+  Minidump minidump(handler.minidump_descriptor().fd_path());
+  ASSERT_TRUE(minidump.Read());
+  EXPECT_TRUE(minidump.GetException());
+}
+
 TEST(ExceptionHandlerTest, GenerateMultipleDumpsWithPath) {
   AutoTempDir temp_dir;
   ExceptionHandler handler(MinidumpDescriptor(temp_dir.path()), NULL, NULL,
@@ -1160,6 +1214,134 @@ TEST(ExceptionHandlerTest, GenerateMultipleDumpsWithPath) {
   ASSERT_STRNE(minidump_1_path.c_str(), minidump_2_path.c_str());
 }
 
+TEST(ExceptionHandlerTest, GenerateMultipleDumpsWithPreallocatedFiles) {
+  AutoTempDir temp_dir;
+  string slot_paths[2];
+  for (int i = 0; i < 2; ++i) {
+    char name[64];
+    snprintf(name, sizeof(name), "/.slot-%d-%d", getpid(), i);
+    slot_paths[i] = temp_dir.path() + name;
+  }
+  {
+    ExceptionHandler handler(MinidumpDescriptor(temp_dir.path()), NULL, NULL,
+                             NULL, false, -1);
+    ASSERT_EQ(2, handler.PreallocateDumpFiles(2, 1 << 20));
+    struct stat st;
+    for (int i = 0; i < 2; ++i)
+      ASSERT_EQ(0, stat(slot_paths[i].c_str(), &st));
+
+    // Each minidump is renamed from a slot's file, which is replaced.
+    string paths[3];
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_TRUE(handler.WriteMinidump());
+      paths[i] = handler.minidump_descriptor().path();
+      Minidump minidump(paths[i]);
+      ASSERT_TRUE(minidump.Read());
+      MinidumpThreadList* thread_list = minidump.GetThreadList();
+      ASSERT_TRUE(thread_list);
+      EXPECT_GT(thread_list->thread_count(), 0U);
+      for (int j = 0; j < 2; ++j)
+        EXPECT_EQ(0, stat(slot_paths[j].c_str(), &st));
+    }
+    ASSERT_NE(paths[0], paths[1]);
+    ASSERT_NE(paths[1], paths[2]);
+    for (int i = 0; i < 3; ++i)
+      unlink(paths[i].c_str());
+  }
+  // The handler removes the files it didn't use.
+  struct stat st;
+  for (int i = 0; i < 2; ++i)
+    EXPECT_NE(0, stat(slot_paths[i].c_str(), &st));
+}
+
+TEST(ExceptionHandlerTest, PrecomputeModuleIdentifiers) {
+  AutoTempDir temp_dir;
+  {
+    ExceptionHandler handler(MinidumpDescriptor(temp_dir.path()), NULL, NULL,
+                             NULL, false, -1);
+    handler.PrecomputeModuleIdentifiers();
+    FileIdCache* cache = FileIdCache::process_cache();
+    ASSERT_TRUE(cache);
+
+    // The cache holds the identifier of this executable.
+    FileIdCache::Key key;
+    ASSERT_TRUE(FileIdCache::GetKey("/proc/self/exe", 0, &key));
+    PageAllocator allocator;
+    wasteful_vector<uint8_t> cached(&allocator);
+    ASSERT_TRUE(cache->Lookup(key, cached));
+    MemoryMappedFile mapped_file("/proc/self/exe", 0);
+    ASSERT_TRUE(mapped_file.data());
+    wasteful_vector<uint8_t> expected(&allocator);
+    ASSERT_TRUE(FileID::ElfFileIdentifierFromMappedFile(mapped_file.data(),
+                                                        expected));
+    ASSERT_EQ(expected.size(), cached.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), cached.begin()));
+
+    ASSERT_TRUE(handler.WriteMinidump());
+    Minidump minidump(handler.minidump_descriptor().path());
+    ASSERT_TRUE(minidump.Read());
+    MinidumpModuleList* module_list = minidump.GetModuleList();
+    ASSERT_TRUE(module_list);
+    EXPECT_GT(module_list->module_count(), 0U);
+  }
+  // The handler removes the cache it installed.
+  EXPECT_FALSE(FileIdCache::process_cache());
+}
+
+TEST(ExceptionHandlerTest, GenerateMultipleDumpsWithPrespawnedDumper) {
+  AutoTempDir temp_dir;
+  ExceptionHandler handler(MinidumpDescriptor(temp_dir.path()), NULL, NULL,
+                           NULL, false, -1);
+  ASSERT_TRUE(handler.PrespawnDumper());
+
+  // The dumper writes each minidump to the path current at the time.
+  string paths[2];
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(handler.WriteMinidump());
+    paths[i] = handler.minidump_descriptor().path();
+    Minidump minidump(paths[i]);
+    ASSERT_TRUE(minidump.Read());
+    MinidumpThreadList* thread_list = minidump.GetThreadList();
+    ASSERT_TRUE(thread_list);
+    EXPECT_GT(thread_list->thread_count(), 0U);
+    unlink(paths[i].c_str());
+  }
+  ASSERT_NE(paths[0], paths[1]);
+}
+
+TEST(ExceptionHandlerTest, WriteMinidumpFromFork) {
+  AutoTempDir temp_dir;
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+  MinidumpDescriptor descriptor(temp_dir.path());
+  descriptor.set_dump_from_fork(true);
+  ExceptionHandler handler(descriptor, NULL, DoneCallback,
+                           reinterpret_cast<void*>(fds[1]), false, -1);
+  ASSERT_TRUE(handler.WriteMinidump());
+  close(fds[1]);
+
+  // The fork that is dumped runs the callback once its minidump is written.
+  uint32_t len = 0;
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(len)),
+            HANDLE_EINTR(read(fds[0], &len, sizeof(len))));
+  string path(len, '\0');
+  ASSERT_EQ(static_cast<ssize_t>(len),
+            HANDLE_EINTR(read(fds[0], &path[0], len)));
+  close(fds[0]);
+  ASSERT_EQ(string(handler.minidump_descriptor().path()), path);
+
+  Minidump minidump(path);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpException* exception = minidump.GetException();
+  ASSERT_TRUE(exception);
+  EXPECT_EQ(MD_EXCEPTION_CODE_LIN_DUMP_REQUESTED,
+            exception->exception()->exception_record.exception_code);
+  MinidumpThreadList* thread_list = minidump.GetThreadList();
+  ASSERT_TRUE(thread_list);
+  EXPECT_EQ(1U, thread_list->thread_count());
+  unlink(path.c_str());
+}
+
 // Test that an additional memory region can be added to the minidump.
 TEST(ExceptionHandlerTest, AdditionalMemory) {
   const uint32_t kMemorySize = sysconf(_SC_PAGESIZE);
@@ -40,11 +40,17 @@ struct MicrodumpExtraInfo {
   const char* gpu_fingerprint;
   const char* process_type;
 
+  // Whether to write the stack base64-encoded ("S64" lines) rather than
+  // hex-encoded ("S" lines), which is a third smaller but needs a
+  // processor that understands it.
+  bool base64_stack;
+
   MicrodumpExtraInfo()
       : build_fingerprint(NULL),
         product_info(NULL),
         gpu_fingerprint(NULL),
-        process_type(NULL) {}
+        process_type(NULL),
+        base64_stack(false) {}
 };
 
 }
@@ -28,6 +28,8 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "client/linux/handler/minidump_descriptor.h"
 
@@ -39,17 +41,54 @@ namespace google_breakpad {
 const MinidumpDescriptor::MicrodumpOnConsole
     MinidumpDescriptor::kMicrodumpOnConsole = {};
 
+//static
+const MinidumpDescriptor::MinidumpInMemory
+    MinidumpDescriptor::kMinidumpInMemory = {};
+
+MinidumpDescriptor::MinidumpDescriptor(const MinidumpInMemory&)
+    : mode_(kUninitialized),
+      fd_(-1),
+      c_path_(NULL),
+      size_limit_(-1),
+      thread_stack_limit_(-1),
+      total_stack_limit_(-1),
+      address_within_principal_mapping_(0),
+      skip_dump_if_principal_mapping_not_referenced_(false),
+      sanitize_stacks_(false),
+      compress_(false),
+      dump_from_fork_(false),
+      crash_dedup_window_(0),
+      crash_deduplicated_(false) {
+#if defined(__NR_memfd_create)
+  // MFD_CLOEXEC, which older headers lack.
+  static const unsigned int kMemfdCloexec = 1;
+  fd_ = syscall(__NR_memfd_create, "minidump", kMemfdCloexec);
+  if (fd_ >= 0)
+    mode_ = kWriteMinidumpToFd;
+  else
+    fd_ = -1;
+#endif
+}
+
 MinidumpDescriptor::MinidumpDescriptor(const MinidumpDescriptor& descriptor)
     : mode_(descriptor.mode_),
       fd_(descriptor.fd_),
       directory_(descriptor.directory_),
       c_path_(NULL),
       size_limit_(descriptor.size_limit_),
+      thread_stack_limit_(descriptor.thread_stack_limit_),
+      total_stack_limit_(descriptor.total_stack_limit_),
+      thread_selection_(descriptor.thread_selection_),
       address_within_principal_mapping_(
           descriptor.address_within_principal_mapping_),
       skip_dump_if_principal_mapping_not_referenced_(
           descriptor.skip_dump_if_principal_mapping_not_referenced_),
       sanitize_stacks_(descriptor.sanitize_stacks_),
+      compress_(descriptor.compress_),
+      dump_from_fork_(descriptor.dump_from_fork_),
+      crash_dedup_path_(descriptor.crash_dedup_path_),
+      crash_dedup_window_(descriptor.crash_dedup_window_),
+      crash_deduplicated_(descriptor.crash_deduplicated_),
       microdump_extra_info_(descriptor.microdump_extra_info_) {
   // The copy constructor is not allowed to be called on a MinidumpDescriptor
   // with a valid path_, as getting its c_path_ would require the heap which
@@ -71,15 +110,30 @@ MinidumpDescriptor& MinidumpDescriptor::operator=(
     UpdatePath();
   }
   size_limit_ = descriptor.size_limit_;
+  thread_stack_limit_ = descriptor.thread_stack_limit_;
+  total_stack_limit_ = descriptor.total_stack_limit_;
+  thread_selection_ = descriptor.thread_selection_;
   address_within_principal_mapping_ =
       descriptor.address_within_principal_mapping_;
   skip_dump_if_principal_mapping_not_referenced_ =
       descriptor.skip_dump_if_principal_mapping_not_referenced_;
   sanitize_stacks_ = descriptor.sanitize_stacks_;
+  compress_ = descriptor.compress_;
+  dump_from_fork_ = descriptor.dump_from_fork_;
+  crash_dedup_path_ = descriptor.crash_dedup_path_;
+  crash_dedup_window_ = descriptor.crash_dedup_window_;
+  crash_deduplicated_ = descriptor.crash_deduplicated_;
   microdump_extra_info_ = descriptor.microdump_extra_info_;
   return *this;
 }
 
+string MinidumpDescriptor::fd_path() const {
+  assert(IsFD());
+  char path[32];
+  snprintf(path, sizeof(path), "/proc/self/fd/%d", fd_);
+  return path;
+}
+
 void MinidumpDescriptor::UpdatePath() {
   assert(mode_ == kWriteMinidumpToFile && !directory_.empty());
 
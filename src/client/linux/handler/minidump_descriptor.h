@@ -36,12 +36,14 @@
 #include <string>
 
 #include "client/linux/handler/microdump_extra_info.h"
+#include "client/linux/minidump_writer/thread_selection.h"
 #include "common/using_std_string.h"
 
 // This class describes how a crash dump should be generated, either:
 // - Writing a full minidump to a file in a given directory (the actual path,
 //   inside the directory, is determined by this class).
 // - Writing a full minidump to a given fd.
+// - Writing a full minidump to an anonymous file in memory.
 // - Writing a reduced microdump to the console (logcat on Android).
 namespace google_breakpad {
 
@@ -49,13 +51,21 @@ class MinidumpDescriptor {
  public:
   struct MicrodumpOnConsole {};
   static const MicrodumpOnConsole kMicrodumpOnConsole;
+  struct MinidumpInMemory {};
+  static const MinidumpInMemory kMinidumpInMemory;
 
   MinidumpDescriptor()
       : mode_(kUninitialized),
         fd_(-1),
         size_limit_(-1),
+        thread_stack_limit_(-1),
+        total_stack_limit_(-1),
         address_within_principal_mapping_(0),
-        skip_dump_if_principal_mapping_not_referenced_(false) {}
+        skip_dump_if_principal_mapping_not_referenced_(false),
+        compress_(false),
+        dump_from_fork_(false),
+        crash_dedup_window_(0),
+        crash_deduplicated_(false) {}
 
   explicit MinidumpDescriptor(const string& directory)
       : mode_(kWriteMinidumpToFile),
@@ -63,9 +73,15 @@ class MinidumpDescriptor {
         directory_(directory),
         c_path_(NULL),
         size_limit_(-1),
+        thread_stack_limit_(-1),
+        total_stack_limit_(-1),
         address_within_principal_mapping_(0),
         skip_dump_if_principal_mapping_not_referenced_(false),
-        sanitize_stacks_(false) {
+        sanitize_stacks_(false),
+        compress_(false),
+        dump_from_fork_(false),
+        crash_dedup_window_(0),
+        crash_deduplicated_(false) {
     assert(!directory.empty());
   }
 
@@ -74,9 +90,15 @@ class MinidumpDescriptor {
         fd_(fd),
         c_path_(NULL),
         size_limit_(-1),
+        thread_stack_limit_(-1),
+        total_stack_limit_(-1),
         address_within_principal_mapping_(0),
         skip_dump_if_principal_mapping_not_referenced_(false),
-        sanitize_stacks_(false) {
+        sanitize_stacks_(false),
+        compress_(false),
+        dump_from_fork_(false),
+        crash_dedup_window_(0),
+        crash_deduplicated_(false) {
     assert(fd != -1);
   }
 
@@ -84,9 +106,23 @@ class MinidumpDescriptor {
       : mode_(kWriteMicrodumpToConsole),
         fd_(-1),
         size_limit_(-1),
+        thread_stack_limit_(-1),
+        total_stack_limit_(-1),
         address_within_principal_mapping_(0),
         skip_dump_if_principal_mapping_not_referenced_(false),
-        sanitize_stacks_(false) {}
+        sanitize_stacks_(false),
+        compress_(false),
+        dump_from_fork_(false),
+        crash_dedup_window_(0),
+        crash_deduplicated_(false) {}
+
+  // Writes the minidump to a new anonymous file in memory, from
+  // memfd_create(), for systems with no writable disk; it is then written
+  // to as an fd (IsFD() is true). The file is never closed, and is emptied
+  // whenever ExceptionHandler::WriteMinidump() starts a new minidump. If
+  // the kernel can't create the file, IsFD() is false and the descriptor
+  // must not be used.
+  explicit MinidumpDescriptor(const MinidumpInMemory&);
 
   explicit MinidumpDescriptor(const MinidumpDescriptor& descriptor);
   MinidumpDescriptor& operator=(const MinidumpDescriptor& descriptor);
@@ -97,6 +133,12 @@ class MinidumpDescriptor {
 
   int fd() const { return fd_; }
 
+  // A path that opens the file an fd descriptor writes to from its start,
+  // "/proc/self/fd/<fd>". It can be given to GoogleCrashdumpUploader or
+  // HTTPUpload in the MinidumpCallback to upload a minidump written in
+  // memory with no copy of it on disk. Uses the heap.
+  string fd_path() const;
+
   string directory() const { return directory_; }
 
   const char* path() const { return c_path_; }
@@ -112,6 +154,24 @@ class MinidumpDescriptor {
   off_t size_limit() const { return size_limit_; }
   void set_size_limit(off_t limit) { size_limit_ = limit; }
 
+  // The most bytes of each non-crashing thread's stack to dump, from its
+  // stack pointer up, or -1 for no limit.
+  int thread_stack_limit() const { return thread_stack_limit_; }
+  void set_thread_stack_limit(int limit) { thread_stack_limit_ = limit; }
+
+  // The most bytes of stack to dump over all threads, or -1 for no limit.
+  // The crashing thread's stack is always dumped whole; the other threads
+  // share what it leaves.
+  off_t total_stack_limit() const { return total_stack_limit_; }
+  void set_total_stack_limit(off_t limit) { total_stack_limit_ = limit; }
+
+  // The threads a minidump holds; the default is all of them. Any names
+  // it points to must outlive the descriptor.
+  const ThreadSelection& thread_selection() const { return thread_selection_; }
+  void set_thread_selection(const ThreadSelection& selection) {
+    thread_selection_ = selection;
+  }
+
   uintptr_t address_within_principal_mapping() const {
     return address_within_principal_mapping_;
   }
@@ -134,6 +194,41 @@ class MinidumpDescriptor {
     sanitize_stacks_ = sanitize_stacks;
   }
 
+  // If set, the minidump is written compressed (see MDRawCompressedHeader).
+  bool compress() const { return compress_; }
+  void set_compress(bool compress) { compress_ = compress; }
+
+  // If set, ExceptionHandler::WriteMinidump() dumps a copy-on-write fork of
+  // the process rather than the process itself, which carries on as soon
+  // as the fork exists. A fork has only the thread that forked it, so the
+  // minidump holds only the thread that asked for it. Has no effect on
+  // crashes or out-of-process dumps.
+  bool dump_from_fork() const { return dump_from_fork_; }
+  void set_dump_from_fork(bool dump_from_fork) {
+    dump_from_fork_ = dump_from_fork;
+  }
+
+  // If set, a crash at the same place as one dumped less than
+  // |window_seconds| earlier, by this process or an earlier run of it, is
+  // not dumped; the callback is told it failed, and crash_deduplicated()
+  // is true. The crashes are recorded in the file at |path| (see
+  // crash_dedup.h). Has no effect on WriteMinidump() or out-of-process
+  // dumps.
+  void set_crash_dedup(const string& path, int window_seconds) {
+    crash_dedup_path_ = path;
+    crash_dedup_window_ = window_seconds;
+  }
+  const char* crash_dedup_path() const {
+    return crash_dedup_path_.empty() ? NULL : crash_dedup_path_.c_str();
+  }
+  int crash_dedup_window() const { return crash_dedup_window_; }
+
+  // Whether the last crash was left undumped as a repeat.
+  bool crash_deduplicated() const { return crash_deduplicated_; }
+  void set_crash_deduplicated(bool deduplicated) {
+    crash_deduplicated_ = deduplicated;
+  }
+
   MicrodumpExtraInfo* microdump_extra_info() {
     assert(IsMicrodumpOnConsole());
     return &microdump_extra_info_;
@@ -165,6 +260,11 @@ class MinidumpDescriptor {
 
   off_t size_limit_;
 
+  int thread_stack_limit_;
+  off_t total_stack_limit_;
+
+  ThreadSelection thread_selection_;
+
   // This member points somewhere into the main module for this
   // process (the module that is considerered interesting for the
   // purposes of debugging crashes).
@@ -182,6 +282,16 @@ class MinidumpDescriptor {
   // register values, but elides strings and other program data.
   bool sanitize_stacks_;
 
+  bool compress_;
+
+  bool dump_from_fork_;
+
+  // The file recording recent crashes, if crash deduplication is on, and
+  // how long a dumped crash's repeats are left out for.
+  string crash_dedup_path_;
+  int crash_dedup_window_;
+  bool crash_deduplicated_;
+
   // The extra microdump data (e.g. product name/version, build
   // fingerprint, gpu fingerprint) that should be appended to the dump
   // (microdump only). Microdumps don't have the ability of appending
@@ -0,0 +1,227 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compact_report_writer.cc: Writes compact reports.
+//
+// See compact_report_writer.h for documentation.
+
+#include "client/linux/microdump_writer/compact_report_writer.h"
+
+#include <elf.h>
+#include <limits.h>
+#include <link.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "client/linux/dump_writer_common/frame_pointer_walker.h"
+#include "client/linux/dump_writer_common/ucontext_reader.h"
+#include "common/linux/breakpad_getcontext.h"
+#include "common/linux/eintr_wrapper.h"
+#include "google_breakpad/common/compact_report_format.h"
+#include "google_breakpad/common/minidump_format.h"
+#include "third_party/lss/linux_syscall_support.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The most frames a report holds, and so the most modules.
+const size_t kMaxFrames = 32;
+
+#if defined(__i386__)
+const uint32_t kArchitecture = MD_CPU_ARCHITECTURE_X86;
+#elif defined(__x86_64__)
+const uint32_t kArchitecture = MD_CPU_ARCHITECTURE_AMD64;
+#elif defined(__aarch64__)
+const uint32_t kArchitecture = MD_CPU_ARCHITECTURE_ARM64_OLD;
+#elif defined(__arm__)
+const uint32_t kArchitecture = MD_CPU_ARCHITECTURE_ARM;
+#elif defined(__mips__) && _MIPS_SIM == _ABIO32
+const uint32_t kArchitecture = MD_CPU_ARCHITECTURE_MIPS;
+#elif defined(__mips__)
+const uint32_t kArchitecture = MD_CPU_ARCHITECTURE_MIPS64;
+#else
+const uint32_t kArchitecture = MD_CPU_ARCHITECTURE_UNKNOWN;
+#endif
+
+#if defined(__ANDROID__)
+const uint32_t kPlatform = MD_OS_ANDROID;
+#else
+const uint32_t kPlatform = MD_OS_LINUX;
+#endif
+
+struct FindModulesContext {
+  const uintptr_t* pcs;
+  size_t pc_count;
+  MDCompactReportModule* modules;
+  size_t module_count;
+};
+
+// Copies the GNU build ID note of the module described by |info|, if it
+// has one, into |module|.
+void CopyBuildId(const struct dl_phdr_info* info,
+                 MDCompactReportModule* module) {
+  for (int i = 0; i < info->dlpi_phnum; ++i) {
+    const ElfW(Phdr)& phdr = info->dlpi_phdr[i];
+    if (phdr.p_type != PT_NOTE)
+      continue;
+    const char* note =
+        reinterpret_cast<const char*>(info->dlpi_addr + phdr.p_vaddr);
+    const char* const end = note + phdr.p_memsz;
+    while (note + sizeof(ElfW(Nhdr)) <= end) {
+      const ElfW(Nhdr)* nhdr = reinterpret_cast<const ElfW(Nhdr)*>(note);
+      const char* const name = note + sizeof(*nhdr);
+      const char* const desc = name + ((nhdr->n_namesz + 3) & ~3);
+      if (desc + nhdr->n_descsz > end)
+        break;
+      if (nhdr->n_type == NT_GNU_BUILD_ID && nhdr->n_namesz == 4 &&
+          memcmp(name, "GNU", 4) == 0) {
+        module->build_id_size = nhdr->n_descsz;
+        if (module->build_id_size > sizeof(module->build_id))
+          module->build_id_size = sizeof(module->build_id);
+        memcpy(module->build_id, desc, module->build_id_size);
+        return;
+      }
+      note = desc + ((nhdr->n_descsz + 3) & ~3);
+    }
+  }
+}
+
+// Copies the file name of the module described by |info| into |module|.
+void CopyName(const struct dl_phdr_info* info, MDCompactReportModule* module) {
+  char path[PATH_MAX];
+  const char* name = info->dlpi_name;
+  if (!name || !*name) {
+    // The main executable is listed without a name.
+    const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0)
+      return;
+    path[length] = '\0';
+    name = path;
+  }
+  const char* const slash = strrchr(name, '/');
+  if (slash)
+    name = slash + 1;
+  strncpy(module->name, name, sizeof(module->name) - 1);
+}
+
+// Adds the module described by |info| to the report if any of the frames
+// are in it.
+int FindModulesCallback(struct dl_phdr_info* info, size_t, void* data) {
+  FindModulesContext* const context = static_cast<FindModulesContext*>(data);
+  uintptr_t low = UINTPTR_MAX;
+  uintptr_t high = 0;
+  for (int i = 0; i < info->dlpi_phnum; ++i) {
+    const ElfW(Phdr)& phdr = info->dlpi_phdr[i];
+    if (phdr.p_type != PT_LOAD)
+      continue;
+    if (phdr.p_vaddr < low)
+      low = phdr.p_vaddr;
+    if (phdr.p_vaddr + phdr.p_memsz > high)
+      high = phdr.p_vaddr + phdr.p_memsz;
+  }
+  if (low >= high)
+    return 0;
+  low = (info->dlpi_addr + low) & ~static_cast<uintptr_t>(getpagesize() - 1);
+  high += info->dlpi_addr;
+
+  for (size_t i = 0; i < context->pc_count; ++i) {
+    if (context->pcs[i] >= low && context->pcs[i] < high) {
+      MDCompactReportModule* const module =
+          &context->modules[context->module_count++];
+      module->base_address = low;
+      module->size = high - low;
+      CopyBuildId(info, module);
+      CopyName(info, module);
+      break;
+    }
+  }
+  // Stop once every frame could have its own module.
+  return context->module_count == context->pc_count;
+}
+
+}  // namespace
+
+bool WriteCompactReport(int fd) {
+  ucontext_t context;
+  if (getcontext(&context) != 0)
+    return false;
+  return WriteCompactReport(fd, &context);
+}
+
+bool WriteCompactReport(int fd, const ucontext_t* uc) {
+  uintptr_t pcs[kMaxFrames];
+  const size_t pc_count = WalkFramePointers(uc, pcs, kMaxFrames);
+
+  // The report is put together in one buffer so that it is written with a
+  // single call.
+  char buffer[sizeof(MDCompactReportHeader) +
+              kMaxFrames * (sizeof(MDCompactReportModule) + sizeof(uint64_t))];
+  memset(buffer, 0, sizeof(buffer));
+  MDCompactReportHeader* const header =
+      reinterpret_cast<MDCompactReportHeader*>(buffer);
+  MDCompactReportModule* const modules =
+      reinterpret_cast<MDCompactReportModule*>(header + 1);
+
+  FindModulesContext context = { pcs, pc_count, modules, 0 };
+  dl_iterate_phdr(FindModulesCallback, &context);
+
+  header->signature = MD_COMPACT_REPORT_SIGNATURE;
+  header->version = MD_COMPACT_REPORT_VERSION;
+  header->processor_architecture = kArchitecture;
+  header->platform_id = kPlatform;
+  header->process_id = getpid();
+  header->thread_id = sys_gettid();
+  header->time = time(NULL);
+  header->instruction_pointer = UContextReader::GetInstructionPointer(uc);
+  header->stack_pointer = UContextReader::GetStackPointer(uc);
+  header->frame_pointer = UContextReader::GetFramePointer(uc);
+  header->module_count = context.module_count;
+  header->frame_count = pc_count;
+
+  uint64_t* const frames =
+      reinterpret_cast<uint64_t*>(modules + context.module_count);
+  for (size_t i = 0; i < pc_count; ++i)
+    frames[i] = pcs[i];
+
+  const size_t size = reinterpret_cast<char*>(frames + pc_count) - buffer;
+  size_t written = 0;
+  while (written < size) {
+    const ssize_t n =
+        HANDLE_EINTR(write(fd, buffer + written, size - written));
+    if (n <= 0)
+      return false;
+    written += n;
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,56 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compact_report_writer.h: Writes compact reports (see
+// google_breakpad/common/compact_report_format.h) of threads of the
+// calling process, for frequent non-fatal reports where even a microdump
+// is too much.
+
+#ifndef CLIENT_LINUX_MICRODUMP_WRITER_COMPACT_REPORT_WRITER_H_
+#define CLIENT_LINUX_MICRODUMP_WRITER_COMPACT_REPORT_WRITER_H_
+
+#include <sys/ucontext.h>
+
+namespace google_breakpad {
+
+// Writes a compact report of the calling thread, as of the call, to |fd|.
+// The stack is unwound by its frame pointers, so frames of code built
+// without them are missed. Only the modules the frames are in are
+// recorded. Unlike WriteMicrodump(), this uses the dynamic loader to find
+// modules and so must not be called from a signal handler or a context
+// where the heap may be corrupt. Returns true iff successful.
+bool WriteCompactReport(int fd);
+
+// As above, but of the calling thread in the context |uc|, such as one
+// filled by getcontext().
+bool WriteCompactReport(int fd, const ucontext_t* uc);
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_MICRODUMP_WRITER_COMPACT_REPORT_WRITER_H_
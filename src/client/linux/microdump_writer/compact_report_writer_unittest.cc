@@ -0,0 +1,107 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Unit test for WriteCompactReport.
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "client/linux/microdump_writer/compact_report_writer.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/common/compact_report_format.h"
+
+using namespace google_breakpad;
+
+namespace {
+
+// Reads the report in |path| into |report|.
+bool ReadReport(const string& path, std::vector<char>* report) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+    report->insert(report->end(), buffer, buffer + n);
+  close(fd);
+  return n == 0;
+}
+
+TEST(CompactReportWriterTest, WritesCallingThread) {
+  AutoTempDir temp_dir;
+  const string path = temp_dir.path() + "/report";
+  const int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  ASSERT_GE(fd, 0);
+  ASSERT_TRUE(WriteCompactReport(fd));
+  close(fd);
+
+  std::vector<char> report;
+  ASSERT_TRUE(ReadReport(path, &report));
+  ASSERT_GE(report.size(), sizeof(MDCompactReportHeader));
+  MDCompactReportHeader header;
+  memcpy(&header, &report[0], sizeof(header));
+  EXPECT_EQ(static_cast<uint32_t>(MD_COMPACT_REPORT_SIGNATURE),
+            header.signature);
+  EXPECT_EQ(static_cast<uint32_t>(MD_COMPACT_REPORT_VERSION), header.version);
+  EXPECT_EQ(static_cast<uint32_t>(getpid()), header.process_id);
+  ASSERT_GE(header.frame_count, 1U);
+  ASSERT_GE(header.module_count, 1U);
+  ASSERT_EQ(sizeof(header) +
+                header.module_count * sizeof(MDCompactReportModule) +
+                header.frame_count * sizeof(uint64_t),
+            report.size());
+
+  // The first frame is in WriteCompactReport, which is in a module of
+  // the report.
+  std::vector<MDCompactReportModule> modules(header.module_count);
+  memcpy(&modules[0], &report[sizeof(header)],
+         modules.size() * sizeof(modules[0]));
+  uint64_t first_frame;
+  memcpy(&first_frame,
+         &report[sizeof(header) + modules.size() * sizeof(modules[0])],
+         sizeof(first_frame));
+  EXPECT_EQ(header.instruction_pointer, first_frame);
+  bool found = false;
+  for (size_t i = 0; i < modules.size(); ++i) {
+    if (first_frame >= modules[i].base_address &&
+        first_frame - modules[i].base_address < modules[i].size) {
+      found = true;
+      EXPECT_NE('\0', modules[i].name[0]);
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
+}  // namespace
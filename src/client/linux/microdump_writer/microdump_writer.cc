@@ -60,7 +60,23 @@ using google_breakpad::RawContextCPU;
 using google_breakpad::ThreadInfo;
 using google_breakpad::UContextReader;
 
-const size_t kLineBufferSize = 2048;
+// Large enough for a full stack line below, and within the payload limit
+// of a single logcat entry.
+const size_t kLineBufferSize = 4096;
+
+#if !defined(__ANDROID__)
+// Lines are gathered here and written to the console in one go.
+const size_t kOutputBufferSize = 32 * 1024;
+#endif
+
+// Bytes of stack per hex-encoded and base64-encoded stack line.  The latter
+// is a multiple of 3 so that only the last line needs padding.
+const size_t kStackDumpChunkSize = 1024;
+const size_t kStackDumpBase64ChunkSize = 1536;
+
+const char kHexDigits[] = "0123456789ABCDEF";
+const char kBase64Digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
 #if !defined(__LP64__)
 // The following are only used by DumpFreeSpace, so need to be compiled
@@ -149,6 +165,11 @@ class MicrodumpWriter {
         sanitize_stack_(sanitize_stack),
         microdump_extra_info_(microdump_extra_info),
         log_line_(NULL),
+        log_line_len_(0),
+#if !defined(__ANDROID__)
+        output_(NULL),
+        output_len_(0),
+#endif
         stack_copy_(NULL),
         stack_len_(0),
         stack_lower_bound_(0),
@@ -156,9 +177,15 @@ class MicrodumpWriter {
     log_line_ = reinterpret_cast<char*>(Alloc(kLineBufferSize));
     if (log_line_)
       log_line_[0] = '\0';  // Clear out the log line buffer.
+#if !defined(__ANDROID__)
+    output_ = reinterpret_cast<char*>(Alloc(kOutputBufferSize));
+#endif
   }
 
-  ~MicrodumpWriter() { dumper_->ThreadsResume(); }
+  ~MicrodumpWriter() {
+    FlushOutput();
+    dumper_->ThreadsResume();
+  }
 
   bool Init() {
     // In the exceptional case where the system was out of memory and there
@@ -191,24 +218,65 @@ class MicrodumpWriter {
     DumpCPUState();
     DumpMappings();
     LogLine("-----END BREAKPAD MICRODUMP-----");
+    FlushOutput();
   }
 
  private:
   enum CaptureResult { CAPTURE_OK, CAPTURE_FAILED, CAPTURE_UNINTERESTING };
 
-  // Writes one line to the system log.
+  // Writes one line to the system log.  On Android every line is its own
+  // log entry; elsewhere lines are gathered and written by FlushOutput().
   void LogLine(const char* msg) {
 #if defined(__ANDROID__)
     logger::writeToCrashLog(msg);
 #else
-    logger::write(msg, my_strlen(msg));
-    logger::write("\n", 1);
+    const size_t length = my_strlen(msg);
+    if (!output_) {
+      logger::write(msg, length);
+      logger::write("\n", 1);
+      return;
+    }
+    if (output_len_ + length + 1 > kOutputBufferSize)
+      FlushOutput();
+    if (length + 1 > kOutputBufferSize) {
+      logger::write(msg, length);
+      logger::write("\n", 1);
+      return;
+    }
+    my_memcpy(output_ + output_len_, msg, length);
+    output_len_ += length;
+    output_[output_len_++] = '\n';
 #endif
   }
 
+  // Writes out the lines gathered by LogLine().
+  void FlushOutput() {
+#if !defined(__ANDROID__)
+    if (output_len_) {
+      logger::write(output_, output_len_);
+      output_len_ = 0;
+    }
+#endif
+  }
+
+  // Returns room for length more characters in the current line buffer,
+  // which the caller must fill, or NULL if the line is full.
+  char* LogReserve(size_t length) {
+    if (log_line_len_ + length >= kLineBufferSize)
+      return NULL;
+    char* reserved = log_line_ + log_line_len_;
+    log_line_len_ += length;
+    log_line_[log_line_len_] = '\0';
+    return reserved;
+  }
+
   // Stages the given string in the current line buffer.
   void LogAppend(const char* str) {
-    my_strlcat(log_line_, str, kLineBufferSize);
+    log_line_len_ +=
+        my_strlcpy(log_line_ + log_line_len_, str,
+                   kLineBufferSize - log_line_len_);
+    if (log_line_len_ >= kLineBufferSize)
+      log_line_len_ = kLineBufferSize - 1;
   }
 
   // As above (required to take precedence over template specialization below).
@@ -219,27 +287,55 @@ class MicrodumpWriter {
   // Stages the hex repr. of the given int type in the current line buffer.
   template<typename T>
   void LogAppend(T value) {
-    // Make enough room to hex encode the largest int type + NUL.
-    static const char HEX[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
-                               'A', 'B', 'C', 'D', 'E', 'F'};
-    char hexstr[sizeof(T) * 2 + 1];
+    char* hexstr = LogReserve(sizeof(T) * 2);
+    if (!hexstr)
+      return;
     for (int i = sizeof(T) * 2 - 1; i >= 0; --i, value >>= 4)
-      hexstr[i] = HEX[static_cast<uint8_t>(value) & 0x0F];
-    hexstr[sizeof(T) * 2] = '\0';
-    LogAppend(hexstr);
+      hexstr[i] = kHexDigits[static_cast<uint8_t>(value) & 0x0F];
   }
 
   // Stages the buffer content hex-encoded in the current line buffer.
   void LogAppend(const void* buf, size_t length) {
     const uint8_t* ptr = reinterpret_cast<const uint8_t*>(buf);
-    for (size_t i = 0; i < length; ++i, ++ptr)
-      LogAppend(*ptr);
+    char* hexstr = LogReserve(length * 2);
+    if (!hexstr)
+      return;
+    for (size_t i = 0; i < length; ++i) {
+      *hexstr++ = kHexDigits[ptr[i] >> 4];
+      *hexstr++ = kHexDigits[ptr[i] & 0x0F];
+    }
+  }
+
+  // Stages the buffer content base64-encoded, with padding, in the current
+  // line buffer.
+  void LogAppendBase64(const void* buf, size_t length) {
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(buf);
+    char* out = LogReserve((length + 2) / 3 * 4);
+    if (!out)
+      return;
+    size_t i = 0;
+    for (; i + 3 <= length; i += 3) {
+      const uint32_t triple = ptr[i] << 16 | ptr[i + 1] << 8 | ptr[i + 2];
+      *out++ = kBase64Digits[(triple >> 18) & 0x3F];
+      *out++ = kBase64Digits[(triple >> 12) & 0x3F];
+      *out++ = kBase64Digits[(triple >> 6) & 0x3F];
+      *out++ = kBase64Digits[triple & 0x3F];
+    }
+    if (i < length) {
+      const uint32_t triple =
+          ptr[i] << 16 | (i + 1 < length ? ptr[i + 1] << 8 : 0);
+      *out++ = kBase64Digits[(triple >> 18) & 0x3F];
+      *out++ = kBase64Digits[(triple >> 12) & 0x3F];
+      *out++ = i + 1 < length ? kBase64Digits[(triple >> 6) & 0x3F] : '=';
+      *out++ = '=';
+    }
   }
 
   // Writes out the current line buffer on the system log.
   void LogCommitLine() {
     LogLine(log_line_);
     log_line_[0] = 0;
+    log_line_len_ = 0;
   }
 
   CaptureResult CaptureCrashingThreadStack(int max_stack_len) {
@@ -394,14 +490,21 @@ class MicrodumpWriter {
     LogAppend(stack_len_);
     LogCommitLine();
 
-    const size_t STACK_DUMP_CHUNK_SIZE = 384;
+    // Base64 takes two thirds of the space of hex, in lines of their own
+    // kind so that older processors skip rather than misread them.
+    const bool base64 = microdump_extra_info_.base64_stack;
+    const size_t chunk_size =
+        base64 ? kStackDumpBase64ChunkSize : kStackDumpChunkSize;
     for (size_t stack_off = 0; stack_off < stack_len_;
-         stack_off += STACK_DUMP_CHUNK_SIZE) {
-      LogAppend("S ");
+         stack_off += chunk_size) {
+      const size_t length = std::min(chunk_size, stack_len_ - stack_off);
+      LogAppend(base64 ? "S64 " : "S ");
       LogAppend(stack_lower_bound_ + stack_off);
       LogAppend(" ");
-      LogAppend(stack_copy_ + stack_off,
-                std::min(STACK_DUMP_CHUNK_SIZE, stack_len_ - stack_off));
+      if (base64)
+        LogAppendBase64(stack_copy_ + stack_off, length);
+      else
+        LogAppend(stack_copy_ + stack_off, length);
       LogCommitLine();
     }
   }
@@ -615,6 +718,13 @@ class MicrodumpWriter {
   bool sanitize_stack_;
   const MicrodumpExtraInfo microdump_extra_info_;
   char* log_line_;
+  size_t log_line_len_;  // my_strlen(log_line_)
+#if !defined(__ANDROID__)
+  // Lines not yet written to the console, or NULL if there wasn't room to
+  // allocate the buffer.
+  char* output_;
+  size_t output_len_;
+#endif
 
   // The local copy of crashed process stack memory, beginning at
   // |stack_lower_bound_|.
@@ -156,7 +156,28 @@ void ExtractMicrodumpStackContents(const string& microdump_content,
   std::istringstream iss(microdump_content);
   result->clear();
   for (string line; std::getline(iss, line);) {
-    if (line.find("S ") == 0) {
+    if (line.find("S64 ") == 0) {
+      std::istringstream stack_data(line);
+      std::string key;
+      std::string addr;
+      std::string data;
+      stack_data >> key >> addr >> data;
+      EXPECT_TRUE((data.size() & 3u) == 0u);
+      static const char kDigits[] =
+          "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      uint32_t bits = 0;
+      int bit_count = 0;
+      for (size_t i = 0; i < data.size() && data[i] != '='; ++i) {
+        const char* digit = strchr(kDigits, data[i]);
+        ASSERT_TRUE(digit != NULL);
+        bits = bits << 6 | static_cast<uint32_t>(digit - kDigits);
+        bit_count += 6;
+        if (bit_count >= 8) {
+          bit_count -= 8;
+          result->push_back(static_cast<char>(bits >> bit_count));
+        }
+      }
+    } else if (line.find("S ") == 0) {
       std::istringstream stack_data(line);
       std::string key;
       std::string addr;
@@ -352,6 +373,20 @@ TEST(MicrodumpWriterTest, StringPresentIfNotSanitized) {
   ASSERT_TRUE(MicrodumpStackContains(buf, kIdentifiableString));
 }
 
+// Ensure that the stack can be written base64-encoded.
+TEST(MicrodumpWriterTest, Base64Stack) {
+  MicrodumpExtraInfo microdump_extra_info;
+  microdump_extra_info.base64_stack = true;
+
+  std::string buf;
+  MappingList no_mappings;
+
+  CrashAndGetMicrodump(no_mappings, microdump_extra_info, &buf);
+  ASSERT_TRUE(ContainsMicrodump(buf));
+  ASSERT_NE(std::string::npos, buf.find("\nS64 "));
+  ASSERT_TRUE(MicrodumpStackContains(buf, kIdentifiableString));
+}
+
 // Ensure that output occurs if the interest region is set, and
 // does overlap something on the stack.
 TEST(MicrodumpWriterTest, OutputIfInteresting) {
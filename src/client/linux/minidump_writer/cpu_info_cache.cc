@@ -0,0 +1,124 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// See cpu_info_cache.h for details.
+
+#include "client/linux/minidump_writer/cpu_info_cache.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <set>
+
+#include "client/linux/minidump_writer/minidump_writer.h"
+#include "common/linux/eintr_wrapper.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Whether |line| is a processor block's "processor : <n>" line.
+bool IsProcessorLine(const string& line) {
+  static const char kProcessor[] = "processor";
+  static const size_t kProcessorLen = sizeof(kProcessor) - 1;
+  if (line.compare(0, kProcessorLen, kProcessor) != 0)
+    return false;
+  return line.size() > kProcessorLen &&
+      (line[kProcessorLen] == ' ' || line[kProcessorLen] == '\t' ||
+       line[kProcessorLen] == ':');
+}
+
+}  // namespace
+
+const CpuInfoCache* CpuInfoCache::process_cache_ = NULL;
+
+CpuInfoCache::CpuInfoCache()
+    : system_info_complete_(false),
+      captured_(false) {
+  memset(&system_info_, 0, sizeof(system_info_));
+}
+
+bool CpuInfoCache::Capture(bool compact) {
+  captured_ = false;
+  const int fd = HANDLE_EINTR(open("/proc/cpuinfo", O_RDONLY));
+  if (fd < 0)
+    return false;
+  string text;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = HANDLE_EINTR(read(fd, buffer, sizeof(buffer)))) > 0)
+    text.append(buffer, n);
+  close(fd);
+  if (n < 0 || text.empty())
+    return false;
+
+  text_ = compact ? Compact(text) : text;
+  memset(&system_info_, 0, sizeof(system_info_));
+  system_info_complete_ = ReadCPUInformation(&system_info_);
+  captured_ = true;
+  return true;
+}
+
+// static
+string CpuInfoCache::Compact(const string& text) {
+  string compacted;
+  compacted.reserve(text.size());
+  std::set<string> first_block;
+  bool in_first_block = true;
+  for (size_t pos = 0; pos < text.size();) {
+    size_t end = text.find('\n', pos);
+    end = end == string::npos ? text.size() : end + 1;
+    const string line(text, pos, end - pos);
+    pos = end;
+
+    const bool blank = line == "\n";
+    if (in_first_block) {
+      compacted += line;
+      if (blank)
+        in_first_block = false;
+      else
+        first_block.insert(line);
+    } else if (blank || IsProcessorLine(line) || !first_block.count(line)) {
+      compacted += line;
+    }
+  }
+  return compacted;
+}
+
+bool CpuInfoCache::GetSystemInfo(MDRawSystemInfo* sys_info) const {
+  sys_info->processor_architecture = system_info_.processor_architecture;
+  sys_info->processor_level = system_info_.processor_level;
+  sys_info->processor_revision = system_info_.processor_revision;
+  sys_info->number_of_processors = system_info_.number_of_processors;
+  sys_info->cpu = system_info_.cpu;
+  return system_info_complete_;
+}
+
+}  // namespace google_breakpad
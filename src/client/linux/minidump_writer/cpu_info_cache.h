@@ -0,0 +1,106 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// cpu_info_cache.h: A copy of /proc/cpuinfo taken before a crash, for
+// MinidumpWriter to use instead of reading the file.
+
+#ifndef CLIENT_LINUX_MINIDUMP_WRITER_CPU_INFO_CACHE_H_
+#define CLIENT_LINUX_MINIDUMP_WRITER_CPU_INFO_CACHE_H_
+
+#include <stddef.h>
+
+#include <string>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/minidump_format.h"
+
+namespace google_breakpad {
+
+// CpuInfoCache holds /proc/cpuinfo as read by Capture(), together with
+// the CPU fields of the system info stream parsed from it. On a machine
+// with hundreds of CPUs the file runs to hundreds of kilobytes, and the
+// kernel generates it slowly; a dump that reads it, twice, does so while
+// the crashed process's threads are suspended. Nothing in the cache
+// changes after Capture(), so it can be used from a compromised context.
+//
+// A process installs a cache with SetProcessCache(), which every
+// MinidumpWriter created after that uses for the MD_LINUX_CPU_INFO stream
+// and the system info stream:
+//
+//   static CpuInfoCache cache;
+//   if (cache.Capture(true))
+//     CpuInfoCache::SetProcessCache(&cache);
+class CpuInfoCache {
+ public:
+  CpuInfoCache();
+
+  // Reads /proc/cpuinfo and parses the CPU fields of the system info
+  // stream from it, replacing anything captured before. If |compact| is
+  // true, the copy kept is compacted (see Compact()). Returns false if
+  // /proc/cpuinfo can't be read. Runs in a normal context.
+  bool Capture(bool compact);
+
+  // Returns |text|, a /proc/cpuinfo listing, with each line of the
+  // second and later processors' blocks left out if it is in the first
+  // processor's block too, other than the "processor" line. What is left
+  // of each block is what sets that processor apart: on x86, its clock
+  // speed and APIC and core identifiers.
+  static string Compact(const string& text);
+
+  // Whether Capture() has succeeded.
+  bool captured() const { return captured_; }
+
+  // The captured copy of /proc/cpuinfo.
+  const char* text() const { return text_.data(); }
+  size_t text_size() const { return text_.size(); }
+
+  // Sets the CPU fields of |sys_info|: the architecture, processor level,
+  // revision and count, and |cpu|, as parsed by Capture(). Returns false
+  // if some of them couldn't be parsed, as MinidumpWriter would when
+  // reading /proc/cpuinfo itself.
+  bool GetSystemInfo(MDRawSystemInfo* sys_info) const;
+
+  // The cache installed for the process, or NULL.
+  static const CpuInfoCache* process_cache() { return process_cache_; }
+  static void SetProcessCache(const CpuInfoCache* cache) {
+    process_cache_ = cache;
+  }
+
+ private:
+  string text_;
+  MDRawSystemInfo system_info_;
+  bool system_info_complete_;
+  bool captured_;
+
+  static const CpuInfoCache* process_cache_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_MINIDUMP_WRITER_CPU_INFO_CACHE_H_
@@ -0,0 +1,150 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string.h>
+
+#include <string>
+
+#include "client/linux/minidump_writer/cpu_info_cache.h"
+#include "client/linux/minidump_writer/minidump_writer.h"
+#include "breakpad_googletest_includes.h"
+
+using namespace google_breakpad;
+
+namespace {
+
+size_t CountProcessors(const string& text) {
+  size_t count = 0;
+  for (size_t pos = 0; (pos = text.find("processor", pos)) != string::npos;
+       pos++) {
+    if (pos == 0 || text[pos - 1] == '\n')
+      count++;
+  }
+  return count;
+}
+
+typedef testing::Test CpuInfoCacheTest;
+
+TEST(CpuInfoCacheTest, CompactLeavesOutRepeatedLines) {
+  const string text =
+      "processor\t: 0\n"
+      "vendor_id\t: GenuineIntel\n"
+      "model\t\t: 85\n"
+      "cpu MHz\t\t: 2000.000\n"
+      "apicid\t\t: 0\n"
+      "\n"
+      "processor\t: 1\n"
+      "vendor_id\t: GenuineIntel\n"
+      "model\t\t: 85\n"
+      "cpu MHz\t\t: 2000.000\n"
+      "apicid\t\t: 2\n"
+      "\n"
+      "processor\t: 2\n"
+      "vendor_id\t: GenuineIntel\n"
+      "model\t\t: 85\n"
+      "cpu MHz\t\t: 1200.000\n"
+      "apicid\t\t: 4\n"
+      "\n";
+  const string expected =
+      "processor\t: 0\n"
+      "vendor_id\t: GenuineIntel\n"
+      "model\t\t: 85\n"
+      "cpu MHz\t\t: 2000.000\n"
+      "apicid\t\t: 0\n"
+      "\n"
+      "processor\t: 1\n"
+      "apicid\t\t: 2\n"
+      "\n"
+      "processor\t: 2\n"
+      "cpu MHz\t\t: 1200.000\n"
+      "apicid\t\t: 4\n"
+      "\n";
+  EXPECT_EQ(expected, CpuInfoCache::Compact(text));
+}
+
+TEST(CpuInfoCacheTest, CompactKeepsTrailingBlocks) {
+  // The layout of ARM kernels, with a block about the machine at the end.
+  const string text =
+      "processor\t: 0\n"
+      "Features\t: fp asimd\n"
+      "\n"
+      "processor\t: 1\n"
+      "Features\t: fp asimd\n"
+      "\n"
+      "Hardware\t: Qualcomm\n"
+      "Revision\t: 0000";
+  const string expected =
+      "processor\t: 0\n"
+      "Features\t: fp asimd\n"
+      "\n"
+      "processor\t: 1\n"
+      "\n"
+      "Hardware\t: Qualcomm\n"
+      "Revision\t: 0000";
+  EXPECT_EQ(expected, CpuInfoCache::Compact(text));
+}
+
+TEST(CpuInfoCacheTest, CompactLeavesSingleBlockAlone) {
+  const string text = "processor\t: 0\nmodel\t\t: 85\n";
+  EXPECT_EQ(text, CpuInfoCache::Compact(text));
+  EXPECT_EQ("", CpuInfoCache::Compact(""));
+}
+
+TEST(CpuInfoCacheTest, Capture) {
+  CpuInfoCache cache;
+  EXPECT_FALSE(cache.captured());
+  ASSERT_TRUE(cache.Capture(false));
+  EXPECT_TRUE(cache.captured());
+  ASSERT_GT(cache.text_size(), 0U);
+  const string full(cache.text(), cache.text_size());
+
+  MDRawSystemInfo expected;
+  memset(&expected, 0, sizeof(expected));
+  const bool complete = ReadCPUInformation(&expected);
+  MDRawSystemInfo sys_info;
+  memset(&sys_info, 0, sizeof(sys_info));
+  EXPECT_EQ(complete, cache.GetSystemInfo(&sys_info));
+  EXPECT_EQ(expected.processor_architecture, sys_info.processor_architecture);
+  EXPECT_EQ(expected.number_of_processors, sys_info.number_of_processors);
+  EXPECT_EQ(expected.processor_level, sys_info.processor_level);
+  EXPECT_EQ(expected.processor_revision, sys_info.processor_revision);
+  EXPECT_EQ(0, memcmp(&expected.cpu, &sys_info.cpu, sizeof(sys_info.cpu)));
+
+  // Compacting changes only the copy of the file, which still lists every
+  // processor.
+  ASSERT_TRUE(cache.Capture(true));
+  const string compacted(cache.text(), cache.text_size());
+  EXPECT_LE(compacted.size(), full.size());
+  EXPECT_EQ(CountProcessors(full), CountProcessors(compacted));
+  memset(&sys_info, 0, sizeof(sys_info));
+  EXPECT_EQ(complete, cache.GetSystemInfo(&sys_info));
+  EXPECT_EQ(expected.number_of_processors, sys_info.number_of_processors);
+}
+
+}  // namespace
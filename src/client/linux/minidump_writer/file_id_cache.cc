@@ -0,0 +1,145 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// file_id_cache.cc: Implement google_breakpad::FileIdCache.
+// See file_id_cache.h for details.
+
+#include "client/linux/minidump_writer/file_id_cache.h"
+
+#include <string.h>
+
+#include "common/linux/linux_libc_support.h"
+#include "third_party/lss/linux_syscall_support.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// How many times Lock() yields before giving up.
+const int kMaxLockAttempts = 10000;
+
+}  // namespace
+
+FileIdCache* FileIdCache::process_cache_ = NULL;
+
+FileIdCache::FileIdCache(size_t capacity)
+    : entries_(NULL),
+      capacity_(capacity),
+      size_(0),
+      next_(0),
+      lock_(0) {
+  if (capacity_) {
+    entries_ = reinterpret_cast<Entry*>(
+        allocator_.Alloc(capacity_ * sizeof(Entry)));
+  }
+  if (!entries_)
+    capacity_ = 0;
+}
+
+// static
+bool FileIdCache::GetKey(const char* path, uint64_t offset, Key* key) {
+#if defined(__x86_64__) || defined(__aarch64__) || \
+   (defined(__mips__) && _MIPS_SIM == _ABI64)
+  struct kernel_stat st;
+  if (sys_stat(path, &st) != 0)
+    return false;
+#else
+  struct kernel_stat64 st;
+  if (sys_stat64(path, &st) != 0)
+    return false;
+#endif
+  key->device = st.st_dev;
+  key->inode = st.st_ino;
+  key->mtime_sec = st.st_mtime_;
+  key->mtime_nsec = st.st_mtime_nsec_;
+  key->offset = offset;
+  return true;
+}
+
+bool FileIdCache::Lookup(const Key& key,
+                         wasteful_vector<uint8_t>& identifier) {
+  if (!Lock())
+    return false;
+  const Entry* entry = Find(key);
+  if (entry) {
+    identifier.resize(entry->identifier_size);
+    my_memcpy(&identifier[0], entry->identifier, entry->identifier_size);
+  }
+  Unlock();
+  return entry != NULL;
+}
+
+void FileIdCache::Insert(const Key& key,
+                         const wasteful_vector<uint8_t>& identifier) {
+  if (!capacity_ || identifier.empty() ||
+      identifier.size() > kMaxIdentifierSize)
+    return;
+
+  if (!Lock())
+    return;
+  Entry* entry = Find(key);
+  if (!entry) {
+    if (size_ < capacity_) {
+      entry = &entries_[size_++];
+    } else {
+      entry = &entries_[next_];
+      next_ = (next_ + 1) % capacity_;
+    }
+    entry->key = key;
+  }
+  entry->identifier_size = identifier.size();
+  my_memcpy(entry->identifier, &identifier[0], identifier.size());
+  Unlock();
+}
+
+FileIdCache::Entry* FileIdCache::Find(const Key& key) {
+  for (size_t i = 0; i < size_; ++i) {
+    const Key& k = entries_[i].key;
+    if (k.device == key.device && k.inode == key.inode &&
+        k.mtime_sec == key.mtime_sec && k.mtime_nsec == key.mtime_nsec &&
+        k.offset == key.offset)
+      return &entries_[i];
+  }
+  return NULL;
+}
+
+bool FileIdCache::Lock() {
+  for (int i = 0; __atomic_exchange_n(&lock_, 1, __ATOMIC_ACQUIRE); ++i) {
+    if (i == kMaxLockAttempts)
+      return false;
+    sys_sched_yield();
+  }
+  return true;
+}
+
+void FileIdCache::Unlock() {
+  __atomic_store_n(&lock_, 0, __ATOMIC_RELEASE);
+}
+
+}  // namespace google_breakpad
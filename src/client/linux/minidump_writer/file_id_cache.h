@@ -0,0 +1,118 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// file_id_cache.h: A cache of the identifiers LinuxDumper computes for the
+// ELF files mapped into a process.
+
+#ifndef CLIENT_LINUX_MINIDUMP_WRITER_FILE_ID_CACHE_H_
+#define CLIENT_LINUX_MINIDUMP_WRITER_FILE_ID_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/memory_allocator.h"
+
+namespace google_breakpad {
+
+// FileIdCache remembers the identifier of each mapped file, keyed by the
+// file's device, inode and modification time and the offset at which it
+// is mapped, so that later dumps needn't read the file again; without a
+// build ID note, that means hashing its text section. The entries are
+// allocated up front, so the cache can be used from a compromised
+// context, and it may be shared by dumps running on several threads. When
+// it is full, the oldest entry makes way for a new one.
+//
+// A process that writes several dumps, from the exception handler or as a
+// crash server, installs a cache with SetProcessCache(), which every
+// LinuxDumper created after that consults:
+//
+//   static FileIdCache cache(256);
+//   FileIdCache::SetProcessCache(&cache);
+class FileIdCache {
+ public:
+  // The longest identifier the cache holds. Longer ones aren't cached.
+  static const size_t kMaxIdentifierSize = 64;
+
+  // Identifies the contents of a mapped file.
+  struct Key {
+    uint64_t device;
+    uint64_t inode;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t offset;
+  };
+
+  // Creates a cache with room for |capacity| identifiers.
+  explicit FileIdCache(size_t capacity);
+
+  // Fills in |key| for the file at |path| mapped at |offset|. Returns false
+  // if the file can't be stat'ed.
+  static bool GetKey(const char* path, uint64_t offset, Key* key);
+
+  // Sets |identifier| to the identifier cached for |key|. Returns false if
+  // there is none.
+  bool Lookup(const Key& key, wasteful_vector<uint8_t>& identifier);
+
+  // Caches |identifier| for |key|.
+  void Insert(const Key& key, const wasteful_vector<uint8_t>& identifier);
+
+  // The cache installed for the process, or NULL.
+  static FileIdCache* process_cache() { return process_cache_; }
+  static void SetProcessCache(FileIdCache* cache) { process_cache_ = cache; }
+
+ private:
+  struct Entry {
+    Key key;
+    size_t identifier_size;
+    uint8_t identifier[kMaxIdentifierSize];
+  };
+
+  // Finds the entry for |key|, or returns NULL. The lock must be held.
+  Entry* Find(const Key& key);
+
+  // Returns false if the lock stays held too long, as it would forever in a
+  // dumping process cloned while another thread held it.
+  bool Lock();
+  void Unlock();
+
+  PageAllocator allocator_;
+  Entry* entries_;
+  size_t capacity_;
+  // The number of entries in use, and the one to replace next when full.
+  size_t size_;
+  size_t next_;
+  // A spin lock, as mutexes aren't safe to use in a compromised context.
+  int lock_;
+
+  static FileIdCache* process_cache_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_MINIDUMP_WRITER_FILE_ID_CACHE_H_
@@ -0,0 +1,129 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "client/linux/minidump_writer/file_id_cache.h"
+#include "breakpad_googletest_includes.h"
+#include "common/memory_allocator.h"
+
+using namespace google_breakpad;
+
+namespace {
+
+typedef testing::Test FileIdCacheTest;
+
+FileIdCache::Key MakeKey(uint64_t inode, uint64_t offset) {
+  FileIdCache::Key key = {0x801, inode, 1700000000, 123456789, offset};
+  return key;
+}
+
+void MakeIdentifier(uint8_t seed, size_t size,
+                    wasteful_vector<uint8_t>* identifier) {
+  identifier->resize(size);
+  for (size_t i = 0; i < size; ++i)
+    (*identifier)[i] = static_cast<uint8_t>(seed + i);
+}
+
+}  // namespace
+
+TEST(FileIdCacheTest, LookupMissing) {
+  PageAllocator allocator;
+  FileIdCache cache(4);
+  wasteful_vector<uint8_t> identifier(&allocator);
+  EXPECT_FALSE(cache.Lookup(MakeKey(1, 0), identifier));
+}
+
+TEST(FileIdCacheTest, InsertAndLookup) {
+  PageAllocator allocator;
+  FileIdCache cache(4);
+  wasteful_vector<uint8_t> expected(&allocator);
+  MakeIdentifier(0x10, 20, &expected);
+  cache.Insert(MakeKey(1, 0), expected);
+
+  wasteful_vector<uint8_t> identifier(&allocator);
+  ASSERT_TRUE(cache.Lookup(MakeKey(1, 0), identifier));
+  EXPECT_EQ(expected.size(), identifier.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+                         identifier.begin()));
+
+  // Every field of the key counts.
+  EXPECT_FALSE(cache.Lookup(MakeKey(2, 0), identifier));
+  EXPECT_FALSE(cache.Lookup(MakeKey(1, 4096), identifier));
+  FileIdCache::Key modified = MakeKey(1, 0);
+  modified.mtime_nsec++;
+  EXPECT_FALSE(cache.Lookup(modified, identifier));
+  FileIdCache::Key other_device = MakeKey(1, 0);
+  other_device.device++;
+  EXPECT_FALSE(cache.Lookup(other_device, identifier));
+}
+
+TEST(FileIdCacheTest, InsertReplacesIdentifier) {
+  PageAllocator allocator;
+  FileIdCache cache(4);
+  wasteful_vector<uint8_t> first(&allocator);
+  MakeIdentifier(0x10, 20, &first);
+  cache.Insert(MakeKey(1, 0), first);
+  wasteful_vector<uint8_t> second(&allocator);
+  MakeIdentifier(0x80, 16, &second);
+  cache.Insert(MakeKey(1, 0), second);
+
+  wasteful_vector<uint8_t> identifier(&allocator);
+  ASSERT_TRUE(cache.Lookup(MakeKey(1, 0), identifier));
+  ASSERT_EQ(16U, identifier.size());
+  EXPECT_EQ(0x80, identifier[0]);
+}
+
+TEST(FileIdCacheTest, EvictsOldestWhenFull) {
+  PageAllocator allocator;
+  FileIdCache cache(2);
+  wasteful_vector<uint8_t> id(&allocator);
+  MakeIdentifier(1, 20, &id);
+  cache.Insert(MakeKey(1, 0), id);
+  cache.Insert(MakeKey(2, 0), id);
+  cache.Insert(MakeKey(3, 0), id);
+
+  wasteful_vector<uint8_t> identifier(&allocator);
+  EXPECT_FALSE(cache.Lookup(MakeKey(1, 0), identifier));
+  EXPECT_TRUE(cache.Lookup(MakeKey(2, 0), identifier));
+  EXPECT_TRUE(cache.Lookup(MakeKey(3, 0), identifier));
+}
+
+TEST(FileIdCacheTest, IgnoresOversizedIdentifiers) {
+  PageAllocator allocator;
+  FileIdCache cache(2);
+  wasteful_vector<uint8_t> id(&allocator);
+  MakeIdentifier(1, FileIdCache::kMaxIdentifierSize + 1, &id);
+  cache.Insert(MakeKey(1, 0), id);
+
+  wasteful_vector<uint8_t> identifier(&allocator);
+  EXPECT_FALSE(cache.Lookup(MakeKey(1, 0), identifier));
+}
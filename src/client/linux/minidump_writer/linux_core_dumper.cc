@@ -37,6 +37,7 @@
 #include <elf.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/procfs.h>
 #if defined(__mips__) && defined(__ANDROID__)
 // To get register definitions.
@@ -136,6 +137,13 @@ bool LinuxCoreDumper::EnumerateThreads() {
     fprintf(stderr, "Could not map core dump file into memory\n");
     return false;
   }
+  // Most reads from the core are small and scattered, so readahead on the
+  // whole mapping only wastes page cache.  ElfCoreDump::CopyData asks for
+  // readahead on large copies such as thread stacks.
+  if (mapped_core_file_.size() > 0) {
+    madvise(const_cast<void*>(mapped_core_file_.data()),
+            mapped_core_file_.size(), MADV_RANDOM);
+  }
 
   char proc_mem_path[NAME_MAX];
   if (BuildProcPath(proc_mem_path, pid_, "mem")) {
@@ -43,8 +43,13 @@
 #include <limits.h>
 #include <stddef.h>
 #include <string.h>
+#include <sys/ioctl.h>
 
-#include "client/linux/minidump_writer/line_reader.h"
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "client/linux/minidump_writer/file_id_cache.h"
 #include "common/linux/elfutils.h"
 #include "common/linux/file_id.h"
 #include "common/linux/linux_libc_support.h"
@@ -92,6 +97,169 @@ bool MappingContainsAddress(const MappingInfo& mapping, uintptr_t address) {
          address < mapping.system_mapping_info.end_addr;
 }
 
+// The magnitude below which integers are considered to be to be
+// 'small', and not constitute a PII risk. These are included to
+// avoid eliding useful register values.
+const uintptr_t kSmallIntMagnitude = 4096;
+
+// Returns how many of the |count| words at |words|, counting from the
+// first, are either small integers or addresses in the range of
+// |stack_size| bytes at |stack_start|. These are the words that
+// SanitizeStackCopy keeps without looking at any other mapping, and
+// runs of them are checked a block at a time here. |words| need not be
+// aligned.
+//
+// A word w is a small integer when w + kSmallIntMagnitude is at most
+// 2 * kSmallIntMagnitude as an unsigned value, and is in the stack when
+// w - stack_start is below stack_size, so both tests are one unsigned
+// compare per word.
+size_t CountSmallOrStackWords(const uint8_t* words, size_t count,
+                              uintptr_t stack_start, uintptr_t stack_size) {
+  size_t i = 0;
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+  const uint64x2_t small_bias = vdupq_n_u64(kSmallIntMagnitude);
+  const uint64x2_t small_limit = vdupq_n_u64(2 * kSmallIntMagnitude);
+  const uint64x2_t start = vdupq_n_u64(stack_start);
+  const uint64x2_t size = vdupq_n_u64(stack_size);
+  for (; i + 4 <= count; i += 4) {
+    const uint64x2_t w0 =
+        vreinterpretq_u64_u8(vld1q_u8(words + i * sizeof(uintptr_t)));
+    const uint64x2_t w1 =
+        vreinterpretq_u64_u8(vld1q_u8(words + (i + 2) * sizeof(uintptr_t)));
+    const uint64x2_t kept0 =
+        vorrq_u64(vcleq_u64(vaddq_u64(w0, small_bias), small_limit),
+                  vcltq_u64(vsubq_u64(w0, start), size));
+    const uint64x2_t kept1 =
+        vorrq_u64(vcleq_u64(vaddq_u64(w1, small_bias), small_limit),
+                  vcltq_u64(vsubq_u64(w1, start), size));
+    const uint64x2_t kept = vandq_u64(kept0, kept1);
+    if (!(vgetq_lane_u64(kept, 0) & vgetq_lane_u64(kept, 1)))
+      break;
+  }
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__arm__)
+  const uint32x4_t small_bias = vdupq_n_u32(kSmallIntMagnitude);
+  const uint32x4_t small_limit = vdupq_n_u32(2 * kSmallIntMagnitude);
+  const uint32x4_t start = vdupq_n_u32(stack_start);
+  const uint32x4_t size = vdupq_n_u32(stack_size);
+  for (; i + 4 <= count; i += 4) {
+    const uint32x4_t w =
+        vreinterpretq_u32_u8(vld1q_u8(words + i * sizeof(uintptr_t)));
+    const uint32x4_t kept =
+        vorrq_u32(vcleq_u32(vaddq_u32(w, small_bias), small_limit),
+                  vcltq_u32(vsubq_u32(w, start), size));
+    const uint32x2_t halves =
+        vand_u32(vget_low_u32(kept), vget_high_u32(kept));
+    if (!(vget_lane_u32(halves, 0) & vget_lane_u32(halves, 1)))
+      break;
+  }
+#else
+  for (; i + 4 <= count; i += 4) {
+    uintptr_t w[4];
+    my_memcpy(w, words + i * sizeof(uintptr_t), sizeof(w));
+    bool kept = true;
+    for (size_t j = 0; j < 4; ++j) {
+      kept &= (w[j] + kSmallIntMagnitude <= 2 * kSmallIntMagnitude) |
+              (w[j] - stack_start < stack_size);
+    }
+    if (!kept)
+      break;
+  }
+#endif
+  for (; i < count; ++i) {
+    uintptr_t w;
+    my_memcpy(&w, words + i * sizeof(uintptr_t), sizeof(w));
+    if (w + kSmallIntMagnitude > 2 * kSmallIntMagnitude &&
+        w - stack_start >= stack_size) {
+      break;
+    }
+  }
+  return i;
+}
+
+// Returns whether any of the |count| words at |words| lies in
+// [low, low + span], checking a block of words at a time. |words| need
+// not be aligned.
+bool AnyWordInRange(const uint8_t* words, size_t count,
+                    uintptr_t low, uintptr_t span) {
+  size_t i = 0;
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+  const uint64x2_t low_v = vdupq_n_u64(low);
+  const uint64x2_t span_v = vdupq_n_u64(span);
+  for (; i + 4 <= count; i += 4) {
+    const uint64x2_t w0 =
+        vreinterpretq_u64_u8(vld1q_u8(words + i * sizeof(uintptr_t)));
+    const uint64x2_t w1 =
+        vreinterpretq_u64_u8(vld1q_u8(words + (i + 2) * sizeof(uintptr_t)));
+    const uint64x2_t hit = vorrq_u64(vcleq_u64(vsubq_u64(w0, low_v), span_v),
+                                     vcleq_u64(vsubq_u64(w1, low_v), span_v));
+    if (vgetq_lane_u64(hit, 0) | vgetq_lane_u64(hit, 1))
+      return true;
+  }
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__arm__)
+  const uint32x4_t low_v = vdupq_n_u32(low);
+  const uint32x4_t span_v = vdupq_n_u32(span);
+  for (; i + 4 <= count; i += 4) {
+    const uint32x4_t w =
+        vreinterpretq_u32_u8(vld1q_u8(words + i * sizeof(uintptr_t)));
+    const uint32x4_t hit = vcleq_u32(vsubq_u32(w, low_v), span_v);
+    const uint32x2_t halves = vorr_u32(vget_low_u32(hit), vget_high_u32(hit));
+    if (vget_lane_u32(halves, 0) | vget_lane_u32(halves, 1))
+      return true;
+  }
+#else
+  for (; i + 4 <= count; i += 4) {
+    uintptr_t w[4];
+    my_memcpy(w, words + i * sizeof(uintptr_t), sizeof(w));
+    bool hit = false;
+    for (size_t j = 0; j < 4; ++j)
+      hit |= w[j] - low <= span;
+    if (hit)
+      return true;
+  }
+#endif
+  for (; i < count; ++i) {
+    uintptr_t w;
+    my_memcpy(&w, words + i * sizeof(uintptr_t), sizeof(w));
+    if (w - low <= span)
+      return true;
+  }
+  return false;
+}
+
+// Returns whether mappings[first..] are in address order and do not
+// overlap, as EnumerateMappings leaves all but the first mapping.
+bool MappingsSortedFrom(const wasteful_vector<MappingInfo*>& mappings,
+                        size_t first) {
+  for (size_t i = first + 1; i < mappings.size(); ++i) {
+    if (mappings[i - 1]->system_mapping_info.end_addr >
+        mappings[i]->system_mapping_info.start_addr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Finds the mapping containing |address| among mappings[first..], which
+// MappingsSortedFrom must accept, by binary search on the unbiased
+// ranges.
+const MappingInfo* FindSortedMappingNoBias(
+    const wasteful_vector<MappingInfo*>& mappings, size_t first,
+    uintptr_t address) {
+  size_t lo = first;
+  size_t hi = mappings.size();
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (mappings[mid]->system_mapping_info.end_addr <= address) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo < mappings.size() && MappingContainsAddress(*mappings[lo], address))
+    return mappings[lo];
+  return nullptr;
+}
+
 #if defined(__CHROMEOS__)
 
 // Recover memory mappings before writing dump on ChromeOS
@@ -273,6 +441,95 @@ void CrOSPostProcessMappings(wasteful_vector<MappingInfo*>& mappings) {
 
 #endif  // __CHROMEOS__
 
+// The argument of the PROCMAP_QUERY ioctl on /proc/<pid>/maps, added in
+// Linux 6.11, which older <linux/fs.h> headers lack.  The kernel tells
+// versions of the structure apart by |size|.
+struct ProcmapQuery {
+  uint64_t size;
+  uint64_t query_flags;
+  uint64_t query_addr;
+  uint64_t vma_start;
+  uint64_t vma_end;
+  uint64_t vma_flags;
+  uint64_t vma_page_size;
+  uint64_t vma_offset;
+  uint64_t inode;
+  uint32_t dev_major;
+  uint32_t dev_minor;
+  uint32_t vma_name_size;
+  uint32_t build_id_size;
+  uint64_t vma_name_addr;
+  uint64_t build_id_addr;
+};
+
+const unsigned int kProcmapQuery = _IOWR('f', 17, ProcmapQuery);
+
+// The largest build ID the kernel reports.
+const size_t kMaxKernelBuildIdSize = 20;
+
+// Reads /proc/<pid>/task/<tid>/<file>, as |dumper| locates it, into
+// |buffer| of |size| bytes, truncating it and NUL-terminating it. Returns
+// false if the file can't be read.
+bool ReadTaskFile(const LinuxDumper& dumper, pid_t pid, pid_t tid,
+                  const char* file, char* buffer, size_t size) {
+  static const char kTaskPrefix[] = "task/";
+  static const size_t kTaskPrefixLen = sizeof(kTaskPrefix) - 1;
+  char node[NAME_MAX];
+  const unsigned tid_len = my_uint_len(tid);
+  const size_t file_len = my_strlen(file);
+  if (kTaskPrefixLen + tid_len + 1 + file_len >= sizeof(node))
+    return false;
+  my_memcpy(node, kTaskPrefix, kTaskPrefixLen);
+  my_uitos(node + kTaskPrefixLen, tid, tid_len);
+  node[kTaskPrefixLen + tid_len] = '/';
+  my_memcpy(node + kTaskPrefixLen + tid_len + 1, file, file_len + 1);
+
+  char path[NAME_MAX];
+  if (!dumper.BuildProcPath(path, pid, node))
+    return false;
+  const int fd = sys_open(path, O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+  size_t used = 0;
+  while (used < size - 1) {
+    const ssize_t n = sys_read(fd, buffer + used, size - 1 - used);
+    if (n <= 0)
+      break;
+    used += n;
+  }
+  sys_close(fd);
+  buffer[used] = '\0';
+  return used > 0;
+}
+
+// Returns the CPU time, in clock ticks, used by the thread whose
+// /proc/<pid>/task/<tid>/stat is |stat|: the sum of its utime and stime,
+// the 14th and 15th fields. The thread's name, the 2nd field, is in
+// parentheses and may hold spaces and parentheses itself, so fields are
+// counted from the last ')'.
+uint64_t ThreadCpuTime(const char* stat) {
+  const char* p = NULL;
+  for (const char* c = stat; *c; ++c) {
+    if (*c == ')')
+      p = c + 1;
+  }
+  if (!p)
+    return 0;
+  uint64_t total = 0;
+  for (int field = 3; field <= 15; ++field) {
+    while (*p == ' ')
+      ++p;
+    uint64_t value = 0;
+    for (; *p && *p != ' '; ++p) {
+      if (*p >= '0' && *p <= '9')
+        value = value * 10 + (*p - '0');
+    }
+    if (field >= 14)
+      total += value;
+  }
+  return total;
+}
+
 }  // namespace
 
 // All interesting auvx entry types are below AT_SYSINFO_EHDR
@@ -313,6 +570,78 @@ bool LinuxDumper::LateInit() {
   return true;
 }
 
+void LinuxDumper::SelectThreads(const ThreadSelection& selection) {
+  if (selection.max_other_threads < 0)
+    return;
+
+  const size_t num_threads = threads_.size();
+  wasteful_vector<uint8_t> keep(&allocator_, num_threads);
+  keep.resize(num_threads, 0);
+  for (size_t i = 0; i < num_threads; ++i) {
+    if (threads_[i] == crash_thread_) {
+      keep[i] = 1;
+      continue;
+    }
+    if (!selection.names && !selection.callback)
+      continue;
+    char name[32];
+    if (ReadTaskFile(*this, pid_, threads_[i], "comm", name, sizeof(name))) {
+      const size_t name_len = my_strlen(name);
+      if (name[name_len - 1] == '\n')
+        name[name_len - 1] = '\0';
+    } else {
+      name[0] = '\0';
+    }
+    for (const char* const* n = selection.names; n && *n; ++n) {
+      if (my_strncmp(name, *n, sizeof(name)) == 0) {
+        keep[i] = 1;
+        break;
+      }
+    }
+    if (!keep[i] && selection.callback &&
+        selection.callback(threads_[i], name, selection.callback_context)) {
+      keep[i] = 1;
+    }
+  }
+
+  if (selection.busiest_threads > 0) {
+    wasteful_vector<uint64_t> cpu_time(&allocator_, num_threads);
+    cpu_time.resize(num_threads, 0);
+    for (size_t i = 0; i < num_threads; ++i) {
+      char stat[512];
+      if (!keep[i] &&
+          ReadTaskFile(*this, pid_, threads_[i], "stat", stat, sizeof(stat))) {
+        cpu_time[i] = ThreadCpuTime(stat);
+      }
+    }
+    // Threads that have never run are left to max_other_threads.
+    for (int picked = 0; picked < selection.busiest_threads; ++picked) {
+      size_t busiest = num_threads;
+      for (size_t i = 0; i < num_threads; ++i) {
+        if (!keep[i] && cpu_time[i] > 0 &&
+            (busiest == num_threads || cpu_time[i] > cpu_time[busiest])) {
+          busiest = i;
+        }
+      }
+      if (busiest == num_threads)
+        break;
+      keep[busiest] = 1;
+    }
+  }
+
+  int others = selection.max_other_threads;
+  size_t kept = 0;
+  for (size_t i = 0; i < num_threads; ++i) {
+    if (!keep[i] && others > 0) {
+      keep[i] = 1;
+      --others;
+    }
+    if (keep[i])
+      threads_[kept++] = threads_[i];
+  }
+  threads_.resize(kept);
+}
+
 bool
 LinuxDumper::ElfFileIdentifierForMapping(const MappingInfo& mapping,
                                          bool member,
@@ -341,12 +670,28 @@ LinuxDumper::ElfFileIdentifierForMapping(const MappingInfo& mapping,
     return false;
   bool filename_modified = HandleDeletedFileInMapping(filename);
 
-  MemoryMappedFile mapped_file(filename, mapping.offset);
-  if (!mapped_file.data() || mapped_file.size() < SELFMAG)
-    return false;
-
-  bool success =
-      FileID::ElfFileIdentifierFromMappedFile(mapped_file.data(), identifier);
+  // The kernel can tell the build ID of an ELF file mapped from its start
+  // without the file being opened and mapped here.
+  bool success = mapping.offset == 0 && QueryBuildId(mapping, identifier);
+
+  // Identifying a file without a build ID means hashing its text section,
+  // so a process writing many dumps keeps the identifiers it has computed.
+  FileIdCache* cache = FileIdCache::process_cache();
+  FileIdCache::Key key;
+  if (!success && cache && FileIdCache::GetKey(filename, mapping.offset, &key))
+    success = cache->Lookup(key, identifier);
+  if (!success) {
+    MemoryMappedFile mapped_file(filename, mapping.offset);
+    if (!mapped_file.data() || mapped_file.size() < SELFMAG)
+      return false;
+
+    success =
+        FileID::ElfFileIdentifierFromMappedFile(mapped_file.data(), identifier);
+    if (success && cache &&
+        FileIdCache::GetKey(filename, mapping.offset, &key)) {
+      cache->Insert(key, identifier);
+    }
+  }
   if (success && member && filename_modified) {
     mappings_[mapping_id]->name[my_strlen(mapping.name) -
                                 sizeof(kDeletedSuffix) + 1] = '\0';
@@ -355,6 +700,37 @@ LinuxDumper::ElfFileIdentifierForMapping(const MappingInfo& mapping,
   return success;
 }
 
+bool LinuxDumper::QueryBuildId(const MappingInfo& mapping,
+                               wasteful_vector<uint8_t>& identifier) const {
+  char maps_path[NAME_MAX];
+  if (!BuildProcPath(maps_path, pid_, "maps"))
+    return false;
+  const int fd = sys_open(maps_path, O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+
+  uint8_t build_id[kMaxKernelBuildIdSize];
+  ProcmapQuery query;
+  my_memset(&query, 0, sizeof(query));
+  query.size = sizeof(query);
+  query.query_addr = mapping.system_mapping_info.start_addr;
+  query.build_id_addr = reinterpret_cast<uintptr_t>(build_id);
+  query.build_id_size = sizeof(build_id);
+  // Kernels without the ioctl fail it, as does a post-mortem dumper's copy
+  // of the maps file; the kernel reports a size of 0 for a file without a
+  // build ID, or one it couldn't read without blocking.
+  const bool success = sys_ioctl(fd, kProcmapQuery, &query) == 0 &&
+                       query.build_id_size > 0;
+  sys_close(fd);
+  if (!success)
+    return false;
+
+  identifier.clear();
+  identifier.insert(identifier.end(), build_id,
+                    build_id + query.build_id_size);
+  return true;
+}
+
 void LinuxDumper::SetCrashInfoFromSigInfo(const siginfo_t& siginfo) {
   set_crash_address(reinterpret_cast<uintptr_t>(siginfo.si_addr));
   set_crash_signal(siginfo.si_signo);
@@ -560,65 +936,37 @@ bool LinuxDumper::EnumerateMappings() {
   const int fd = sys_open(maps_path, O_RDONLY, 0);
   if (fd < 0)
     return false;
-  LineReader* const line_reader = new(allocator_) LineReader(fd);
-
-  const char* line;
-  unsigned line_len;
-  while (line_reader->GetNextLine(&line, &line_len)) {
-    uintptr_t start_addr, end_addr, offset;
-
-    const char* i1 = my_read_hex_ptr(&start_addr, line);
-    if (*i1 == '-') {
-      const char* i2 = my_read_hex_ptr(&end_addr, i1 + 1);
-      if (*i2 == ' ') {
-        bool exec = (*(i2 + 3) == 'x');
-        const char* i3 = my_read_hex_ptr(&offset, i2 + 6 /* skip ' rwxp ' */);
-        if (*i3 == ' ') {
-          const char* name = NULL;
-          // Only copy name if the name is a valid path name, or if
-          // it's the VDSO image.
-          if (((name = my_strchr(line, '/')) == NULL) &&
-              linux_gate_loc &&
-              reinterpret_cast<void*>(start_addr) == linux_gate_loc) {
-            name = kLinuxGateLibraryName;
-            offset = 0;
-          }
-          // Merge adjacent mappings into one module, assuming they're a single
-          // library mapped by the dynamic linker. Do this only if their name
-          // matches and either they have the same +x protection flag, or if the
-          // previous mapping is not executable and the new one is, to handle
-          // lld's output (see crbug.com/716484).
-          if (name && !mappings_.empty()) {
-            MappingInfo* module = mappings_.back();
-            if ((start_addr == module->start_addr + module->size) &&
-                (my_strlen(name) == my_strlen(module->name)) &&
-                (my_strncmp(name, module->name, my_strlen(name)) == 0) &&
-                ((exec == module->exec) || (!module->exec && exec))) {
-              module->system_mapping_info.end_addr = end_addr;
-              module->size = end_addr - module->start_addr;
-              module->exec |= exec;
-              line_reader->PopLine(line_len);
-              continue;
-            }
-          }
-          MappingInfo* const module = new(allocator_) MappingInfo;
-          mappings_.push_back(module);
-          my_memset(module, 0, sizeof(MappingInfo));
-          module->system_mapping_info.start_addr = start_addr;
-          module->system_mapping_info.end_addr = end_addr;
-          module->start_addr = start_addr;
-          module->size = end_addr - start_addr;
-          module->offset = offset;
-          module->exec = exec;
-          if (name != NULL) {
-            const unsigned l = my_strlen(name);
-            if (l < sizeof(module->name))
-              my_memcpy(module->name, name, l);
-          }
-        }
-      }
+
+  // Read the file in large chunks, parsing all the whole lines in each,
+  // rather than a line at a time: processes can have tens of thousands of
+  // mappings.  One byte is kept free to end an unterminated last line.
+  const size_t kBufferSize = 64 * 1024;
+  char* const buffer = static_cast<char*>(allocator_.Alloc(kBufferSize));
+  size_t used = 0;
+  for (;;) {
+    const ssize_t n = sys_read(fd, buffer + used, kBufferSize - 1 - used);
+    if (n < 0 || (n == 0 && used == 0))
+      break;
+    if (n == 0)
+      buffer[used++] = '\n';
+    else
+      used += n;
+
+    char* line = buffer;
+    char* const end = buffer + used;
+    char* newline;
+    while ((newline = static_cast<char*>(
+                my_memchr(line, '\n', end - line))) != NULL) {
+      *newline = '\0';
+      ParseMapsLine(line, linux_gate_loc);
+      line = newline + 1;
     }
-    line_reader->PopLine(line_len);
+
+    // A line that fills the whole buffer is too long to process.
+    if (line == buffer && used == kBufferSize - 1)
+      break;
+    used = end - line;
+    my_memmove(buffer, line, used);
   }
 
   if (entry_point_loc) {
@@ -646,6 +994,61 @@ bool LinuxDumper::EnumerateMappings() {
   return !mappings_.empty();
 }
 
+void LinuxDumper::ParseMapsLine(const char* line, const void* linux_gate_loc) {
+  uintptr_t start_addr, end_addr, offset;
+
+  const char* i1 = my_read_hex_ptr(&start_addr, line);
+  if (*i1 == '-') {
+    const char* i2 = my_read_hex_ptr(&end_addr, i1 + 1);
+    if (*i2 == ' ') {
+      bool exec = (*(i2 + 3) == 'x');
+      const char* i3 = my_read_hex_ptr(&offset, i2 + 6 /* skip ' rwxp ' */);
+      if (*i3 == ' ') {
+        const char* name = NULL;
+        // Only copy name if the name is a valid path name, or if
+        // it's the VDSO image.
+        if (((name = my_strchr(line, '/')) == NULL) &&
+            linux_gate_loc &&
+            reinterpret_cast<void*>(start_addr) == linux_gate_loc) {
+          name = kLinuxGateLibraryName;
+          offset = 0;
+        }
+        // Merge adjacent mappings into one module, assuming they're a single
+        // library mapped by the dynamic linker. Do this only if their name
+        // matches and either they have the same +x protection flag, or if the
+        // previous mapping is not executable and the new one is, to handle
+        // lld's output (see crbug.com/716484).
+        if (name && !mappings_.empty()) {
+          MappingInfo* module = mappings_.back();
+          if ((start_addr == module->start_addr + module->size) &&
+              (my_strlen(name) == my_strlen(module->name)) &&
+              (my_strncmp(name, module->name, my_strlen(name)) == 0) &&
+              ((exec == module->exec) || (!module->exec && exec))) {
+            module->system_mapping_info.end_addr = end_addr;
+            module->size = end_addr - module->start_addr;
+            module->exec |= exec;
+            return;
+          }
+        }
+        MappingInfo* const module = new(allocator_) MappingInfo;
+        mappings_.push_back(module);
+        my_memset(module, 0, sizeof(MappingInfo));
+        module->system_mapping_info.start_addr = start_addr;
+        module->system_mapping_info.end_addr = end_addr;
+        module->start_addr = start_addr;
+        module->size = end_addr - start_addr;
+        module->offset = offset;
+        module->exec = exec;
+        if (name != NULL) {
+          const unsigned l = my_strlen(name);
+          if (l < sizeof(module->name))
+            my_memcpy(module->name, name, l);
+        }
+      }
+    }
+  }
+}
+
 #if defined(__ANDROID__)
 
 bool LinuxDumper::GetLoadedElfHeader(uintptr_t start_addr, ElfW(Ehdr)* ehdr) {
@@ -753,6 +1156,14 @@ void LinuxDumper::LatePostprocessMappings() {
 
 #endif  // __ANDROID__
 
+void LinuxDumper::CopyFromProcessBatch(const CopyRequest* requests,
+                                       size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    CopyFromProcess(requests[i].dest, requests[i].child, requests[i].src,
+                    requests[i].length);
+  }
+}
+
 // Get information about the stack, given the stack pointer. We don't try to
 // walk the stack since we might not have all the information needed to do
 // unwind. So we just grab, up to, 32k of stack.
@@ -791,6 +1202,9 @@ void LinuxDumper::SanitizeStackCopy(uint8_t* stack_copy, size_t stack_len,
   // 3) We precompute a bitfield based upon bits 32:32-n of the start and
   //    stop addresses, and use that to short circuit any values that can
   //    not be pointers. (n=11)
+  // Runs of small integers and stack pointers are skipped a block of
+  // words at a time, and the remaining candidates are looked up by
+  // binary search when the mappings are in address order.
   const uintptr_t defaced =
 #if defined(__LP64__)
       0x0defaced0defaced;
@@ -809,10 +1223,16 @@ void LinuxDumper::SanitizeStackCopy(uint8_t* stack_copy, size_t stack_len,
   const MappingInfo* last_hit_mapping = nullptr;
   const MappingInfo* hit_mapping = nullptr;
   const MappingInfo* stack_mapping = FindMappingNoBias(stack_pointer);
-  // The magnitude below which integers are considered to be to be
-  // 'small', and not constitute a PII risk. These are included to
-  // avoid eliding useful register values.
-  const ssize_t small_int_magnitude = 4096;
+  const uintptr_t stack_start =
+      stack_mapping ? stack_mapping->system_mapping_info.start_addr : 0;
+  const uintptr_t stack_size =
+      stack_mapping ? stack_mapping->system_mapping_info.end_addr -
+                          stack_mapping->system_mapping_info.start_addr
+                    : 0;
+  // All but the first mapping are normally sorted (see EnumerateMappings),
+  // in which case the first is tested alone and the rest are searched.
+  const bool mappings_sorted =
+      !mappings_.empty() && MappingsSortedFrom(mappings_, 1);
 
   char could_hit_mapping[array_size];
   my_memset(could_hit_mapping, 0, array_size);
@@ -843,30 +1263,37 @@ void LinuxDumper::SanitizeStackCopy(uint8_t* stack_copy, size_t stack_len,
 
   // Apply sanitization to each complete pointer-aligned word in the
   // stack.
-  uint8_t* sp;
-  for (sp = stack_copy + offset;
-       sp <= stack_copy + stack_len - sizeof(uintptr_t);
-       sp += sizeof(uintptr_t)) {
+  uint8_t* sp = stack_copy + offset;
+  uint8_t* const end = stack_copy + stack_len;
+  while (sp <= end - sizeof(uintptr_t)) {
+    sp += sizeof(uintptr_t) *
+          CountSmallOrStackWords(sp, (end - sp) / sizeof(uintptr_t),
+                                 stack_start, stack_size);
+    if (sp > end - sizeof(uintptr_t))
+      break;
     uintptr_t addr;
     my_memcpy(&addr, sp, sizeof(uintptr_t));
-    if (static_cast<intptr_t>(addr) <= small_int_magnitude &&
-        static_cast<intptr_t>(addr) >= -small_int_magnitude) {
-      continue;
-    }
-    if (stack_mapping && MappingContainsAddress(*stack_mapping, addr)) {
-      continue;
-    }
     if (last_hit_mapping && MappingContainsAddress(*last_hit_mapping, addr)) {
+      sp += sizeof(uintptr_t);
       continue;
     }
     uintptr_t test = addr >> shift;
-    if (could_hit_mapping[(test >> 3) & array_mask] & (1 << (test & 7)) &&
-        (hit_mapping = FindMappingNoBias(addr)) != nullptr &&
-        hit_mapping->exec) {
-      last_hit_mapping = hit_mapping;
-      continue;
+    if (could_hit_mapping[(test >> 3) & array_mask] & (1 << (test & 7))) {
+      if (!mappings_sorted) {
+        hit_mapping = FindMappingNoBias(addr);
+      } else if (MappingContainsAddress(*mappings_[0], addr)) {
+        hit_mapping = mappings_[0];
+      } else {
+        hit_mapping = FindSortedMappingNoBias(mappings_, 1, addr);
+      }
+      if (hit_mapping && hit_mapping->exec) {
+        last_hit_mapping = hit_mapping;
+        sp += sizeof(uintptr_t);
+        continue;
+      }
     }
     my_memcpy(sp, &defaced, sizeof(uintptr_t));
+    sp += sizeof(uintptr_t);
   }
   // Zero any partial word at the top of the stack, if alignment is
   // such that that is required.
@@ -889,15 +1316,11 @@ bool LinuxDumper::StackHasPointerToMapping(const uint8_t* stack_copy,
   const uintptr_t offset =
       (sp_offset + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
 
-  for (const uint8_t* sp = stack_copy + offset;
-       sp <= stack_copy + stack_len - sizeof(uintptr_t);
-       sp += sizeof(uintptr_t)) {
-    uintptr_t addr;
-    my_memcpy(&addr, sp, sizeof(uintptr_t));
-    if (low_addr <= addr && addr <= high_addr)
-      return true;
-  }
-  return false;
+  if (offset > stack_len || low_addr > high_addr)
+    return false;
+  return AnyWordInRange(stack_copy + offset,
+                        (stack_len - offset) / sizeof(uintptr_t),
+                        low_addr, high_addr - low_addr);
 }
 
 // Find the mapping which the given memory address falls in.
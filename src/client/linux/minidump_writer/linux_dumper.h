@@ -52,6 +52,8 @@
 
 #include "client/linux/dump_writer_common/mapping_info.h"
 #include "client/linux/dump_writer_common/thread_info.h"
+#include "client/linux/minidump_writer/file_id_cache.h"
+#include "client/linux/minidump_writer/thread_selection.h"
 #include "common/linux/file_id.h"
 #include "common/memory_allocator.h"
 #include "google_breakpad/common/minidump_format.h"
@@ -94,6 +96,10 @@ class LinuxDumper {
   // Return true if the dumper performs a post-mortem dump.
   virtual bool IsPostMortem() const = 0;
 
+  // Drops the threads that |selection| leaves out from |threads_|. Must
+  // be called after Init() and before ThreadsSuspend().
+  void SelectThreads(const ThreadSelection& selection);
+
   // Suspend/resume all threads in the given process.
   virtual bool ThreadsSuspend() = 0;
   virtual bool ThreadsResume() = 0;
@@ -159,6 +165,21 @@ class LinuxDumper {
   virtual bool CopyFromProcess(void* dest, pid_t child, const void* src,
                                size_t length) = 0;
 
+  // A request to copy |length| bytes from a given process |child|,
+  // starting from |src|, into |dest|.
+  struct CopyRequest {
+    void* dest;
+    pid_t child;
+    const void* src;
+    size_t length;
+  };
+
+  // Carries out the |count| |requests| as CopyFromProcess() would. They may
+  // be carried out in any order, or at the same time. This implementation
+  // copies them one after another.
+  virtual void CopyFromProcessBatch(const CopyRequest* requests,
+                                    size_t count);
+
   // Builds a proc path for a certain pid for a node (/proc/<pid>/<node>).
   // |path| is a character array of at least NAME_MAX bytes to return the
   // result.|node| is the final node without any slashes. Returns true on
@@ -168,6 +189,8 @@ class LinuxDumper {
   // Generate a File ID from the .text section of a mapped entry.
   // If not a member, mapping_id is ignored. This method can also manipulate the
   // |mapping|.name to truncate "(deleted)" from the file name if necessary.
+  // If a FileIdCache is installed for the process, the ID is looked up in it
+  // first, and added to it once computed.
   bool ElfFileIdentifierForMapping(const MappingInfo& mapping,
                                    bool member,
                                    unsigned int mapping_id,
@@ -232,6 +255,16 @@ class LinuxDumper {
   // Returns true if |path| is modified.
   bool HandleDeletedFileInMapping(char* path) const;
 
+  // Sets |identifier| to the build ID of the ELF file |mapping| maps, as
+  // the kernel reports it through the PROCMAP_QUERY ioctl, and returns
+  // true.  Returns false if the kernel can't.
+  bool QueryBuildId(const MappingInfo& mapping,
+                    wasteful_vector<uint8_t>& identifier) const;
+
+  // Adds the mapping described by |line|, a line of /proc/<pid>/maps, to
+  // |mappings_|, merging it into the last one if it continues it.
+  void ParseMapsLine(const char* line, const void* linux_gate_loc);
+
    // ID of the crashed process.
   const pid_t pid_;
 
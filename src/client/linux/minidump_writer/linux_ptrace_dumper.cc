@@ -48,7 +48,9 @@
 #include <string.h>
 #include <sys/ptrace.h>
 #include <sys/uio.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
 #if defined(__i386)
 #include <cpuid.h>
@@ -57,22 +59,12 @@
 #include "client/linux/minidump_writer/directory_reader.h"
 #include "client/linux/minidump_writer/line_reader.h"
 #include "common/linux/linux_libc_support.h"
+#include "common/trace_probes.h"
 #include "third_party/lss/linux_syscall_support.h"
 
-// Suspends a thread by attaching to it.
-static bool SuspendThread(pid_t pid) {
-  // This may fail if the thread has just died or debugged.
-  errno = 0;
-  if (sys_ptrace(PTRACE_ATTACH, pid, NULL, NULL) != 0 &&
-      errno != 0) {
-    return false;
-  }
-  while (sys_waitpid(pid, NULL, __WALL) < 0) {
-    if (errno != EINTR) {
-      sys_ptrace(PTRACE_DETACH, pid, NULL, NULL);
-      return false;
-    }
-  }
+// Decides whether to keep |pid|, a thread that has just been stopped,
+// detaching from it if not.
+static bool KeepStoppedThread(pid_t pid) {
 #if defined(__i386) || defined(__x86_64)
   // On x86, the stack pointer is NULL or -1, when executing trusted code in
   // the seccomp sandbox. Not only does this cause difficulties down the line
@@ -96,16 +88,249 @@ static bool SuspendThread(pid_t pid) {
   return true;
 }
 
+// Suspends a thread by attaching to it.
+static bool SuspendThread(pid_t pid) {
+  // This may fail if the thread has just died or debugged.
+  errno = 0;
+  if (sys_ptrace(PTRACE_ATTACH, pid, NULL, NULL) != 0 &&
+      errno != 0) {
+    return false;
+  }
+  while (sys_waitpid(pid, NULL, __WALL) < 0) {
+    if (errno != EINTR) {
+      sys_ptrace(PTRACE_DETACH, pid, NULL, NULL);
+      return false;
+    }
+  }
+  return KeepStoppedThread(pid);
+}
+
+#if defined(PTRACE_SEIZE) && defined(PTRACE_INTERRUPT)
+// Suspends all of |threads| by seizing and interrupting every one of them
+// before waiting for any to stop, so that they stop at the same time
+// rather than one after another, as attaching to each in turn makes them.
+// Threads that can't be suspended, or that KeepStoppedThread() rejects,
+// are dropped from |threads|. Returns false, having suspended none, if
+// the kernel doesn't support PTRACE_SEIZE (before Linux 3.4).
+static bool SeizeThreads(google_breakpad::wasteful_vector<pid_t>* threads) {
+  const size_t count = threads->size();
+  // Threads that can't be seized or interrupted are marked with -1 here,
+  // and dropped all at once at the end.
+  for (size_t i = 0; i < count; ++i) {
+    pid_t tid = (*threads)[i];
+    if (sys_ptrace(PTRACE_SEIZE, tid, NULL, NULL) != 0) {
+      if (i == 0 && errno == EIO)
+        return false;
+      (*threads)[i] = -1;
+    }
+  }
+  for (size_t i = 0; i < count; ++i) {
+    pid_t tid = (*threads)[i];
+    if (tid != -1 && sys_ptrace(PTRACE_INTERRUPT, tid, NULL, NULL) != 0) {
+      // The thread has exited, and is no longer traced.
+      (*threads)[i] = -1;
+    }
+  }
+
+  // Every remaining thread has been asked to stop, so by the time one has
+  // been waited for, most of the rest have stopped too.
+  for (size_t i = 0; i < count; ++i) {
+    pid_t tid = (*threads)[i];
+    if (tid == -1)
+      continue;
+    int status;
+    while (sys_waitpid(tid, &status, __WALL) < 0) {
+      if (errno != EINTR) {
+        status = 0;
+        break;
+      }
+    }
+    if (!WIFSTOPPED(status)) {
+      // The thread exited before it stopped.
+      (*threads)[i] = -1;
+      continue;
+    }
+    if (!KeepStoppedThread(tid))
+      (*threads)[i] = -1;
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if ((*threads)[i] != -1)
+      (*threads)[kept++] = (*threads)[i];
+  }
+  threads->resize(kept);
+  return true;
+}
+#endif  // PTRACE_SEIZE && PTRACE_INTERRUPT
+
 // Resumes a thread by detaching from it.
 static bool ResumeThread(pid_t pid) {
   return sys_ptrace(PTRACE_DETACH, pid, NULL, NULL) >= 0;
 }
 
+// Copies |length| bytes from |child| at |src| into |dest| with
+// process_vm_readv, reading a batch of pages per call, until a page can't be
+// read. Returns the number of bytes copied. Sets |*usable| to false if
+// process_vm_readv fails in a way showing that it can't be used at all.
+static size_t CopyWithProcessVmReadv(uint8_t* dest, pid_t child,
+                                     uintptr_t src, size_t length,
+                                     bool* usable) {
+#if defined(__NR_process_vm_readv)
+  // process_vm_readv doesn't split an iovec on a partial transfer, so give
+  // it one remote iovec per page; it then stops at the first page that
+  // can't be read.
+  static const size_t kMaxPages = 64;
+  const uintptr_t page_size = getpagesize();
+  size_t done = 0;
+
+  while (done < length) {
+    struct iovec remote_iov[kMaxPages];
+    size_t remote_count = 0;
+    size_t batch = 0;
+    while (remote_count < kMaxPages && done + batch < length) {
+      const uintptr_t address = src + done + batch;
+      const size_t page_left = page_size - (address & (page_size - 1));
+      const size_t l = (length - done - batch > page_left) ?
+          page_left : (length - done - batch);
+      remote_iov[remote_count].iov_base = (void*) address;
+      remote_iov[remote_count].iov_len = l;
+      ++remote_count;
+      batch += l;
+    }
+    struct iovec local_iov;
+    local_iov.iov_base = dest + done;
+    local_iov.iov_len = batch;
+
+    const long r = syscall(__NR_process_vm_readv, child, &local_iov, 1,
+                           remote_iov, remote_count, 0);
+    if (r < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno != EFAULT)
+        *usable = false;
+      break;
+    }
+    done += r;
+    if ((size_t) r < batch)
+      break;
+  }
+  return done;
+#else
+  *usable = false;
+  return 0;
+#endif
+}
+
+// Copies |length| bytes at |src| into |dest| by reading |mem_fd|, a
+// descriptor for /proc/<pid>/mem, until a byte can't be read. Returns the
+// number of bytes copied.
+static size_t CopyWithProcMem(int mem_fd, uint8_t* dest, uintptr_t src,
+                              size_t length) {
+  size_t done = 0;
+  while (done < length) {
+    const ssize_t r = sys_pread64(mem_fd, dest + done, length - done,
+                                  src + done);
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r <= 0)
+      break;
+    done += r;
+  }
+  return done;
+}
+
+// Copies |length| bytes from |child| at |src| into |dest| with
+// PTRACE_PEEKDATA, a word at a time, zeroing the words that can't be read.
+// Only the thread that attached to |child| may do this.
+static void CopyWithPeekData(uint8_t* dest, pid_t child, uintptr_t src,
+                             size_t length) {
+  unsigned long tmp = 55;
+  size_t done = 0;
+  static const size_t word_size = sizeof(tmp);
+
+  while (done < length) {
+    const size_t l = (length - done > word_size) ? word_size : (length - done);
+    if (sys_ptrace(PTRACE_PEEKDATA, child, (void*) (src + done), &tmp) == -1) {
+      tmp = 0;
+    }
+    my_memcpy(dest + done, &tmp, l);
+    done += l;
+  }
+}
+
+// A LinuxPtraceDumper::CopyFromProcessBatch() call, shared by the threads
+// carrying it out.
+struct CopyBatch {
+  const google_breakpad::LinuxDumper::CopyRequest* requests;
+  size_t count;
+  // The number of bytes copied from the start of each request.
+  size_t* copied;
+  // A descriptor for /proc/<pid>/mem, or -1.
+  int mem_fd;
+  bool process_vm_readv_usable;
+  // The next request to take, and the number of helper threads that have
+  // finished, both updated atomically.
+  size_t next;
+  size_t finished;
+};
+
+// The most threads, including the calling one, that a batch of copies is
+// shared among, the fewest requests worth starting another thread for, and
+// the stack size of the helper threads.
+static const size_t kMaxCopyThreads = 8;
+static const size_t kCopyRequestsPerThread = 16;
+static const size_t kCopyThreadStackSize = 16 * 1024;
+
+// Takes requests from |batch| until there are none left, copying what can
+// be copied without ptrace.
+static void RunCopyBatch(CopyBatch* batch) {
+  bool process_vm_readv_usable = batch->process_vm_readv_usable;
+  while (true) {
+    const size_t i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+    if (i >= batch->count)
+      break;
+
+    const google_breakpad::LinuxDumper::CopyRequest& request =
+        batch->requests[i];
+    uint8_t* const dest = reinterpret_cast<uint8_t*>(request.dest);
+    const uintptr_t src = reinterpret_cast<uintptr_t>(request.src);
+    size_t done = 0;
+    if (process_vm_readv_usable) {
+      done = CopyWithProcessVmReadv(dest, request.child, src, request.length,
+                                    &process_vm_readv_usable);
+    }
+    if (done < request.length && batch->mem_fd >= 0) {
+      done += CopyWithProcMem(batch->mem_fd, dest + done, src + done,
+                              request.length - done);
+    }
+    batch->copied[i] = done;
+  }
+}
+
+// The entry point of a helper thread of CopyFromProcessBatch(). It shares
+// the caller's address space, and uses nothing but syscalls and memory set
+// aside for it.
+static int CopyBatchThread(void* arg) {
+  CopyBatch* const batch = reinterpret_cast<CopyBatch*>(arg);
+  RunCopyBatch(batch);
+  __atomic_add_fetch(&batch->finished, 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
 namespace google_breakpad {
 
 LinuxPtraceDumper::LinuxPtraceDumper(pid_t pid)
     : LinuxDumper(pid),
-      threads_suspended_(false) {
+      threads_suspended_(false),
+      process_vm_readv_usable_(true),
+      mem_fd_(-1),
+      mem_fd_unusable_(false) {
+}
+
+LinuxPtraceDumper::~LinuxPtraceDumper() {
+  if (mem_fd_ >= 0)
+    sys_close(mem_fd_);
 }
 
 bool LinuxPtraceDumper::BuildProcPath(char* path, pid_t pid,
@@ -132,23 +357,106 @@ bool LinuxPtraceDumper::BuildProcPath(char* path, pid_t pid,
 
 bool LinuxPtraceDumper::CopyFromProcess(void* dest, pid_t child,
                                         const void* src, size_t length) {
-  unsigned long tmp = 55;
-  size_t done = 0;
-  static const size_t word_size = sizeof(tmp);
   uint8_t* const local = (uint8_t*) dest;
-  uint8_t* const remote = (uint8_t*) src;
+  const uintptr_t remote = (uintptr_t) src;
+  const uintptr_t page_size = getpagesize();
+  size_t done = 0;
 
   while (done < length) {
-    const size_t l = (length - done > word_size) ? word_size : (length - done);
-    if (sys_ptrace(PTRACE_PEEKDATA, child, remote + done, &tmp) == -1) {
-      tmp = 0;
+    if (process_vm_readv_usable_) {
+      done += CopyWithProcessVmReadv(local + done, child, remote + done,
+                                     length - done,
+                                     &process_vm_readv_usable_);
+      if (done == length)
+        break;
     }
-    my_memcpy(local + done, &tmp, l);
+    if (OpenMemFile()) {
+      done += CopyWithProcMem(mem_fd_, local + done, remote + done,
+                              length - done);
+      if (done == length)
+        break;
+    }
+
+    // Neither bulk read could get past this page; peek at what is left of
+    // it and carry on with the next one.
+    const size_t page_left = page_size - ((remote + done) & (page_size - 1));
+    const size_t l = (length - done > page_left) ? page_left : (length - done);
+    CopyWithPeekData(local + done, child, remote + done, l);
     done += l;
   }
   return true;
 }
 
+void LinuxPtraceDumper::CopyFromProcessBatch(const CopyRequest* requests,
+                                             size_t count) {
+  size_t num_helpers = count / kCopyRequestsPerThread;
+  if (num_helpers > kMaxCopyThreads - 1)
+    num_helpers = kMaxCopyThreads - 1;
+
+  CopyBatch batch;
+  batch.requests = requests;
+  batch.count = count;
+  batch.copied = NULL;
+  batch.mem_fd = OpenMemFile() ? mem_fd_ : -1;
+  batch.process_vm_readv_usable = process_vm_readv_usable_;
+  batch.next = 0;
+  batch.finished = 0;
+  if (num_helpers > 0 &&
+      (batch.process_vm_readv_usable || batch.mem_fd >= 0)) {
+    batch.copied =
+        reinterpret_cast<size_t*>(allocator_.Alloc(count * sizeof(size_t)));
+  }
+  if (!batch.copied) {
+    LinuxDumper::CopyFromProcessBatch(requests, count);
+    return;
+  }
+
+  size_t started = 0;
+  for (; started < num_helpers; ++started) {
+    uint8_t* stack =
+        reinterpret_cast<uint8_t*>(allocator_.Alloc(kCopyThreadStackSize));
+    if (!stack)
+      break;
+    // clone() needs the top-most address. (scrub just to be safe)
+    stack += kCopyThreadStackSize;
+    my_memset(stack - 16, 0, 16);
+    if (sys_clone(CopyBatchThread, stack,
+                  CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND |
+                  CLONE_THREAD | CLONE_SYSVSEM | CLONE_UNTRACED,
+                  &batch, NULL, NULL, NULL) == -1) {
+      break;
+    }
+  }
+
+  RunCopyBatch(&batch);
+  while (__atomic_load_n(&batch.finished, __ATOMIC_ACQUIRE) < started)
+    sys_sched_yield();
+
+  for (size_t i = 0; i < count; ++i) {
+    const size_t copied = batch.copied[i];
+    if (copied < requests[i].length) {
+      CopyFromProcess(
+          reinterpret_cast<uint8_t*>(requests[i].dest) + copied,
+          requests[i].child,
+          reinterpret_cast<const uint8_t*>(requests[i].src) + copied,
+          requests[i].length - copied);
+    }
+  }
+}
+
+bool LinuxPtraceDumper::OpenMemFile() {
+  if (mem_fd_ >= 0)
+    return true;
+  if (mem_fd_unusable_)
+    return false;
+
+  char mem_path[NAME_MAX];
+  if (BuildProcPath(mem_path, pid_, "mem"))
+    mem_fd_ = sys_open(mem_path, O_RDONLY, 0);
+  mem_fd_unusable_ = mem_fd_ < 0;
+  return !mem_fd_unusable_;
+}
+
 bool LinuxPtraceDumper::ReadRegisterSet(ThreadInfo* info, pid_t tid)
 {
 #ifdef PTRACE_GETREGSET
@@ -313,6 +621,13 @@ bool LinuxPtraceDumper::IsPostMortem() const {
 bool LinuxPtraceDumper::ThreadsSuspend() {
   if (threads_suspended_)
     return true;
+  BREAKPAD_PROBE_SCOPE(threads_suspend);
+#if defined(PTRACE_SEIZE) && defined(PTRACE_INTERRUPT)
+  if (SeizeThreads(&threads_)) {
+    threads_suspended_ = true;
+    return threads_.size() > 0;
+  }
+#endif
   for (size_t i = 0; i < threads_.size(); ++i) {
     if (!SuspendThread(threads_[i])) {
       // If the thread either disappeared before we could attach to it, or if
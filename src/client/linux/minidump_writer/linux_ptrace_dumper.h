@@ -45,6 +45,8 @@ class LinuxPtraceDumper : public LinuxDumper {
   // with a process ID of |pid|.
   explicit LinuxPtraceDumper(pid_t pid);
 
+  virtual ~LinuxPtraceDumper();
+
   // Implements LinuxDumper::BuildProcPath().
   // Builds a proc path for a certain pid for a node (/proc/<pid>/<node>).
   // |path| is a character array of at least NAME_MAX bytes to return the
@@ -54,11 +56,22 @@ class LinuxPtraceDumper : public LinuxDumper {
 
   // Implements LinuxDumper::CopyFromProcess().
   // Copies content of |length| bytes from a given process |child|,
-  // starting from |src|, into |dest|. This method uses ptrace to extract
-  // the content from the target process. Always returns true.
+  // starting from |src|, into |dest|. This method reads as many pages as it
+  // can at once with process_vm_readv, falling back to reading
+  // /proc/<pid>/mem and then to ptrace a word at a time. Bytes that can't
+  // be read are zeroed. Always returns true.
   virtual bool CopyFromProcess(void* dest, pid_t child, const void* src,
                                size_t length);
 
+  // Implements LinuxDumper::CopyFromProcessBatch().
+  // Only the thread that suspended the process may use ptrace on it, but
+  // any thread may read its memory with process_vm_readv or through
+  // /proc/<pid>/mem. So given enough requests, this starts helper threads
+  // that copy what they can that way alongside this thread, which then
+  // copies whatever they couldn't.
+  virtual void CopyFromProcessBatch(const CopyRequest* requests,
+                                    size_t count);
+
   // Implements LinuxDumper::GetThreadInfoByIndex().
   // Reads information about the |index|-th thread of |threads_|.
   // Returns true on success. One must have called |ThreadsSuspend| first.
@@ -70,7 +83,10 @@ class LinuxPtraceDumper : public LinuxDumper {
   virtual bool IsPostMortem() const;
 
   // Implements LinuxDumper::ThreadsSuspend().
-  // Suspends all threads in the given process. Returns true on success.
+  // Suspends all threads in the given process. Where the kernel supports
+  // PTRACE_SEIZE, every thread is seized and interrupted before any is
+  // waited for, so that they all stop at once; otherwise each is attached
+  // to in turn. Returns true on success.
   virtual bool ThreadsSuspend();
 
   // Implements LinuxDumper::ThreadsResume().
@@ -86,6 +102,18 @@ class LinuxPtraceDumper : public LinuxDumper {
   // Set to true if all threads of the crashed process are suspended.
   bool threads_suspended_;
 
+  // Set to false once process_vm_readv fails in a way showing that it
+  // can't be used at all.
+  bool process_vm_readv_usable_;
+
+  // A descriptor for /proc/<pid>/mem, opened on first use, or -1.
+  // |mem_fd_unusable_| is true if it can't be opened.
+  int mem_fd_;
+  bool mem_fd_unusable_;
+
+  // Opens |mem_fd_| if it isn't open yet. Returns true if it is open.
+  bool OpenMemFile();
+
   // Read the tracee's registers on kernel with PTRACE_GETREGSET support.
   // Returns false if PTRACE_GETREGSET is not defined.
   // Returns true on success.
@@ -483,6 +483,170 @@ TEST(LinuxPtraceDumperTest, VerifyStackReadWithMultipleThreads) {
   ASSERT_EQ(SIGKILL, WTERMSIG(status));
 }
 
+namespace {
+
+bool KeepThread(pid_t tid, const char* name, void* context) {
+  return tid == *reinterpret_cast<pid_t*>(context);
+}
+
+}  // namespace
+
+TEST(LinuxPtraceDumperTest, SelectThreads) {
+  static const size_t kNumberOfThreadsInHelperProgram = 5;
+
+  pid_t child_pid = SetupChildProcess(kNumberOfThreadsInHelperProgram);
+  ASSERT_NE(child_pid, -1);
+
+  LinuxPtraceDumper dumper(child_pid);
+  ASSERT_TRUE(dumper.Init());
+  ASSERT_GE(dumper.threads().size(), kNumberOfThreadsInHelperProgram);
+  const pid_t last_thread = dumper.threads()[dumper.threads().size() - 1];
+  dumper.set_crash_thread(child_pid);
+
+  // The crashing thread, the one the callback picks and one other.
+  ThreadSelection selection;
+  selection.max_other_threads = 1;
+  selection.callback = KeepThread;
+  selection.callback_context = const_cast<pid_t*>(&last_thread);
+  dumper.SelectThreads(selection);
+  ASSERT_EQ(3U, dumper.threads().size());
+  EXPECT_NE(-1U, dumper.GetMainThreadIndex());
+  EXPECT_EQ(last_thread, dumper.threads()[2]);
+
+  // Only the threads kept are suspended.
+  EXPECT_TRUE(dumper.ThreadsSuspend());
+  ThreadInfo one_thread;
+  for (size_t i = 0; i < dumper.threads().size(); ++i)
+    EXPECT_TRUE(dumper.GetThreadInfoByIndex(i, &one_thread));
+  EXPECT_TRUE(dumper.ThreadsResume());
+  kill(child_pid, SIGKILL);
+
+  // Reap child
+  int status;
+  ASSERT_NE(-1, HANDLE_EINTR(waitpid(child_pid, &status, 0)));
+  ASSERT_TRUE(WIFSIGNALED(status));
+  ASSERT_EQ(SIGKILL, WTERMSIG(status));
+}
+
+TEST(LinuxPtraceDumperTest, CopyFromProcessAcrossUnmappedPage) {
+  // Map five pages and copy all of them from a child that inherits the
+  // mapping and unmaps the middle one. (A PROT_NONE page won't do:
+  // /proc/<pid>/mem and PTRACE_PEEKDATA can read it.)
+  const size_t page_size = getpagesize();
+  const size_t kPages = 5;
+  uint8_t* pages = reinterpret_cast<uint8_t*>(
+      mmap(NULL, kPages * page_size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  ASSERT_NE(MAP_FAILED, pages);
+  for (size_t i = 0; i < kPages * page_size; ++i)
+    pages[i] = static_cast<uint8_t>(i % 251 + 1);
+
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+  pid_t child_pid = fork();
+  if (child_pid == 0) {
+    close(fds[0]);
+    munmap(pages + 2 * page_size, page_size);
+    IGNORE_RET(write(fds[1], "a", 1));
+    while (true)
+      pause();
+  }
+  ASSERT_NE(child_pid, -1);
+  close(fds[1]);
+  char b;
+  ASSERT_EQ(1, HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+  close(fds[0]);
+
+  LinuxPtraceDumper dumper(child_pid);
+  ASSERT_TRUE(dumper.Init());
+  EXPECT_TRUE(dumper.ThreadsSuspend());
+
+  // Start and end part way through a page.
+  const size_t offset = page_size / 2;
+  const size_t length = (kPages - 1) * page_size;
+  uint8_t* copy = new uint8_t[length];
+  memset(copy, 0xff, length);
+  EXPECT_TRUE(dumper.CopyFromProcess(copy, child_pid, pages + offset,
+                                     length));
+  for (size_t i = 0; i < length; ++i) {
+    const size_t page = (offset + i) / page_size;
+    const uint8_t expected = (page == 2) ?
+        0 : static_cast<uint8_t>((offset + i) % 251 + 1);
+    ASSERT_EQ(expected, copy[i]) << "at offset " << offset + i;
+  }
+  delete[] copy;
+
+  EXPECT_TRUE(dumper.ThreadsResume());
+  kill(child_pid, SIGKILL);
+  int status;
+  ASSERT_NE(-1, HANDLE_EINTR(waitpid(child_pid, &status, 0)));
+  munmap(pages, kPages * page_size);
+}
+
+TEST(LinuxPtraceDumperTest, CopyFromProcessBatch) {
+  // Enough requests for the dumper to share them among helper threads,
+  // some of them reaching into a page the child unmaps.
+  const size_t page_size = getpagesize();
+  const size_t kPages = 5;
+  uint8_t* pages = reinterpret_cast<uint8_t*>(
+      mmap(NULL, kPages * page_size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  ASSERT_NE(MAP_FAILED, pages);
+  for (size_t i = 0; i < kPages * page_size; ++i)
+    pages[i] = static_cast<uint8_t>(i % 251 + 1);
+
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+  pid_t child_pid = fork();
+  if (child_pid == 0) {
+    close(fds[0]);
+    munmap(pages + 2 * page_size, page_size);
+    IGNORE_RET(write(fds[1], "a", 1));
+    while (true)
+      pause();
+  }
+  ASSERT_NE(child_pid, -1);
+  close(fds[1]);
+  char b;
+  ASSERT_EQ(1, HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+  close(fds[0]);
+
+  LinuxPtraceDumper dumper(child_pid);
+  ASSERT_TRUE(dumper.Init());
+  EXPECT_TRUE(dumper.ThreadsSuspend());
+
+  const size_t kRequests = 200;
+  const size_t length = page_size;
+  LinuxDumper::CopyRequest requests[kRequests];
+  uint8_t* copies = new uint8_t[kRequests * length];
+  memset(copies, 0xff, kRequests * length);
+  for (size_t i = 0; i < kRequests; ++i) {
+    requests[i].dest = copies + i * length;
+    requests[i].child = child_pid;
+    requests[i].src = pages + i * (kPages - 1) * page_size / kRequests;
+    requests[i].length = length;
+  }
+  dumper.CopyFromProcessBatch(requests, kRequests);
+
+  for (size_t i = 0; i < kRequests; ++i) {
+    const size_t start = i * (kPages - 1) * page_size / kRequests;
+    for (size_t j = 0; j < length; ++j) {
+      const size_t offset = start + j;
+      const uint8_t expected = (offset / page_size == 2) ?
+          0 : static_cast<uint8_t>(offset % 251 + 1);
+      ASSERT_EQ(expected, copies[i * length + j])
+          << "request " << i << ", offset " << offset;
+    }
+  }
+  delete[] copies;
+
+  EXPECT_TRUE(dumper.ThreadsResume());
+  kill(child_pid, SIGKILL);
+  int status;
+  ASSERT_NE(-1, HANDLE_EINTR(waitpid(child_pid, &status, 0)));
+  munmap(pages, kPages * page_size);
+}
+
 TEST_F(LinuxPtraceDumperTest, SanitizeStackCopy) {
   static const size_t kNumberOfThreadsInHelperProgram = 1;
 
@@ -50,6 +50,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <link.h>
 #include <stdio.h>
 #if defined(__ANDROID__)
@@ -67,6 +68,7 @@
 #include "client/linux/dump_writer_common/thread_info.h"
 #include "client/linux/dump_writer_common/ucontext_reader.h"
 #include "client/linux/handler/exception_handler.h"
+#include "client/linux/minidump_writer/cpu_info_cache.h"
 #include "client/linux/minidump_writer/cpu_set.h"
 #include "client/linux/minidump_writer/line_reader.h"
 #include "client/linux/minidump_writer/linux_dumper.h"
@@ -74,8 +76,10 @@
 #include "client/linux/minidump_writer/proc_cpuinfo_reader.h"
 #include "client/minidump_file_writer.h"
 #include "common/linux/file_id.h"
+#include "common/linux/guid_creator.h"
 #include "common/linux/linux_libc_support.h"
 #include "common/minidump_type_helper.h"
+#include "common/trace_probes.h"
 #include "google_breakpad/common/minidump_format.h"
 #include "third_party/lss/linux_syscall_support.h"
 
@@ -84,9 +88,11 @@ namespace {
 using google_breakpad::AppMemoryList;
 using google_breakpad::auto_wasteful_vector;
 using google_breakpad::ExceptionHandler;
+using google_breakpad::CpuInfoCache;
 using google_breakpad::CpuSet;
 using google_breakpad::kDefaultBuildIdSize;
 using google_breakpad::LineReader;
+using google_breakpad::LiveSnapshotState;
 using google_breakpad::LinuxDumper;
 using google_breakpad::LinuxPtraceDumper;
 using google_breakpad::MDTypeHelper;
@@ -97,7 +103,9 @@ using google_breakpad::MinidumpFileWriter;
 using google_breakpad::PageAllocator;
 using google_breakpad::ProcCpuInfoReader;
 using google_breakpad::RawContextCPU;
+using google_breakpad::StackCaptureLimits;
 using google_breakpad::ThreadInfo;
+using google_breakpad::ThreadSelection;
 using google_breakpad::TypedMDRVA;
 using google_breakpad::UContextReader;
 using google_breakpad::UntypedMDRVA;
@@ -148,7 +156,13 @@ class MinidumpWriter {
             skip_stacks_if_mapping_unreferenced),
         principal_mapping_address_(principal_mapping_address),
         principal_mapping_(nullptr),
-    sanitize_stacks_(sanitize_stacks) {
+    sanitize_stacks_(sanitize_stacks),
+    resume_threads_early_(false),
+    compress_(false),
+    snapshot_state_(NULL),
+    snapshot_dump_id_(),
+    snapshot_is_base_(false),
+    snapshot_stacks_(dumper_->allocator()) {
     // Assert there should be either a valid fd or a valid path, not both.
     assert(fd_ != -1 || minidump_path);
     assert(fd_ == -1 || !minidump_path);
@@ -158,6 +172,7 @@ class MinidumpWriter {
     if (!dumper_->Init())
       return false;
 
+    dumper_->SelectThreads(thread_selection_);
     if (!dumper_->ThreadsSuspend() || !dumper_->LateInit())
       return false;
 
@@ -172,6 +187,8 @@ class MinidumpWriter {
       minidump_writer_.SetFile(fd_);
     else if (!minidump_writer_.Open(path_))
       return false;
+    if (compress_ && !minidump_writer_.EnableCompression())
+      return false;
 
     return true;
   }
@@ -217,6 +234,10 @@ class MinidumpWriter {
   }
 
   bool Dump() {
+    BREAKPAD_PROBE_SCOPE(minidump_write);
+    if (snapshot_state_)
+      return DumpLiveSnapshot();
+
     // A minidump file contains a number of tagged streams. This is the number
     // of stream which we write.
     unsigned kNumWriters = 13;
@@ -249,12 +270,21 @@ class MinidumpWriter {
       return false;
     dir.CopyIndex(dir_index++, &dirent);
 
-    if (!WriteMappings(&dirent))
+    if (!WriteAppMemory())
       return false;
-    dir.CopyIndex(dir_index++, &dirent);
 
-    if (!WriteAppMemory())
+    // The DSO debug stream comes last in the directory, but it is read
+    // from the process's memory, so write it now if the threads are to be
+    // resumed early.
+    MDRawDirectory dso_debug_dirent;
+    if (resume_threads_early_) {
+      WriteDSODebugEntry(&dso_debug_dirent);
+      dumper_->ThreadsResume();
+    }
+
+    if (!WriteMappings(&dirent))
       return false;
+    dir.CopyIndex(dir_index++, &dirent);
 
     if (!WriteMemoryListStream(&dirent))
       return false;
@@ -268,106 +298,326 @@ class MinidumpWriter {
       return false;
     dir.CopyIndex(dir_index++, &dirent);
 
+    WriteProcStreams(&dir, &dir_index);
+
+    if (!resume_threads_early_)
+      WriteDSODebugEntry(&dso_debug_dirent);
+    dir.CopyIndex(dir_index++, &dso_debug_dirent);
+
+    // If you add more directory entries, don't forget to update kNumWriters,
+    // above.
+
+    dumper_->ThreadsResume();
+    return minidump_writer_.Flush();
+  }
+
+  // The part of a thread's stack to dump, and the copy of it.
+  struct ThreadStack {
+    const void* stack;
+    size_t stack_len;
+    uint8_t* copy;
+  };
+
+  // The number of streams WriteProcStreams() writes.
+  static const unsigned kNumProcStreams = 7;
+
+  // Writes the /proc files and /etc/lsb-release to the next
+  // kNumProcStreams entries of |dir|, from |*dir_index| on.
+  void WriteProcStreams(TypedMDRVA<MDRawDirectory>* dir,
+                        unsigned* dir_index) {
+    MDRawDirectory dirent;
+
     dirent.stream_type = MD_LINUX_CPU_INFO;
-    if (!WriteFile(&dirent.location, "/proc/cpuinfo"))
+    if (!WriteCpuInfo(&dirent.location))
       NullifyDirectoryEntry(&dirent);
-    dir.CopyIndex(dir_index++, &dirent);
+    dir->CopyIndex((*dir_index)++, &dirent);
 
     dirent.stream_type = MD_LINUX_PROC_STATUS;
     if (!WriteProcFile(&dirent.location, GetCrashThread(), "status"))
       NullifyDirectoryEntry(&dirent);
-    dir.CopyIndex(dir_index++, &dirent);
+    dir->CopyIndex((*dir_index)++, &dirent);
 
     dirent.stream_type = MD_LINUX_LSB_RELEASE;
     if (!WriteFile(&dirent.location, "/etc/lsb-release"))
       NullifyDirectoryEntry(&dirent);
-    dir.CopyIndex(dir_index++, &dirent);
+    dir->CopyIndex((*dir_index)++, &dirent);
 
     dirent.stream_type = MD_LINUX_CMD_LINE;
     if (!WriteProcFile(&dirent.location, GetCrashThread(), "cmdline"))
       NullifyDirectoryEntry(&dirent);
-    dir.CopyIndex(dir_index++, &dirent);
+    dir->CopyIndex((*dir_index)++, &dirent);
 
     dirent.stream_type = MD_LINUX_ENVIRON;
     if (!WriteProcFile(&dirent.location, GetCrashThread(), "environ"))
       NullifyDirectoryEntry(&dirent);
-    dir.CopyIndex(dir_index++, &dirent);
+    dir->CopyIndex((*dir_index)++, &dirent);
 
     dirent.stream_type = MD_LINUX_AUXV;
     if (!WriteProcFile(&dirent.location, GetCrashThread(), "auxv"))
       NullifyDirectoryEntry(&dirent);
-    dir.CopyIndex(dir_index++, &dirent);
+    dir->CopyIndex((*dir_index)++, &dirent);
 
     dirent.stream_type = MD_LINUX_MAPS;
     if (!WriteProcFile(&dirent.location, GetCrashThread(), "maps"))
       NullifyDirectoryEntry(&dirent);
+    dir->CopyIndex((*dir_index)++, &dirent);
+  }
+
+  // Writes a live snapshot (see WriteLiveSnapshot()) in place of a full
+  // minidump, and advances snapshot_state_.
+  bool DumpLiveSnapshot() {
+    const uint64_t module_list_id = ModuleListId();
+    snapshot_is_base_ = module_list_id != snapshot_state_->module_list_id;
+    // Threads, memory, snapshot info and base dump, and for a base snapshot
+    // the modules, system info and /proc files.
+    const unsigned kNumWriters =
+        snapshot_is_base_ ? 6 + kNumProcStreams : 4;
+
+    TypedMDRVA<MDRawDirectory> dir(&minidump_writer_);
+    {
+      TypedMDRVA<MDRawHeader> header(&minidump_writer_);
+      if (!header.Allocate())
+        return false;
+
+      if (!dir.AllocateArray(kNumWriters))
+        return false;
+
+      my_memset(header.get(), 0, sizeof(MDRawHeader));
+
+      header.get()->signature = MD_HEADER_SIGNATURE;
+      header.get()->version = MD_HEADER_VERSION;
+      header.get()->time_date_stamp = time(NULL);
+      header.get()->stream_count = kNumWriters;
+      header.get()->stream_directory_rva = dir.position();
+    }
+
+    unsigned dir_index = 0;
+    MDRawDirectory dirent;
+
+    if (!WriteThreadListStream(&dirent))
+      return false;
     dir.CopyIndex(dir_index++, &dirent);
 
-    dirent.stream_type = MD_LINUX_DSO_DEBUG;
-    if (!WriteDSODebugStream(&dirent))
-      NullifyDirectoryEntry(&dirent);
+    // Nothing else is read from the process's memory.
+    dumper_->ThreadsResume();
+
+    if (snapshot_is_base_) {
+      if (!WriteMappings(&dirent))
+        return false;
+      dir.CopyIndex(dir_index++, &dirent);
+    }
+
+    if (!WriteMemoryListStream(&dirent))
+      return false;
     dir.CopyIndex(dir_index++, &dirent);
 
-    // If you add more directory entries, don't forget to update kNumWriters,
-    // above.
+    if (snapshot_is_base_) {
+      if (!WriteSystemInfoStream(&dirent))
+        return false;
+      dir.CopyIndex(dir_index++, &dirent);
+      WriteProcStreams(&dir, &dir_index);
+    }
 
-    dumper_->ThreadsResume();
+    TypedMDRVA<MDRawLinuxSnapshotInfo> info(&minidump_writer_);
+    if (!info.Allocate())
+      return false;
+    info.get()->sequence = snapshot_state_->sequence;
+    info.get()->flags =
+        snapshot_is_base_ ? MD_LINUX_SNAPSHOT_HAS_MODULE_LIST : 0;
+    info.get()->module_list_id = module_list_id;
+    dirent.stream_type = MD_LINUX_SNAPSHOT_INFO;
+    dirent.location = info.location();
+    dir.CopyIndex(dir_index++, &dirent);
+
+    TypedMDRVA<MDRawBaseDump> base_dump(&minidump_writer_);
+    if (!base_dump.Allocate())
+      return false;
+    my_memset(base_dump.get(), 0, sizeof(MDRawBaseDump));
+    base_dump.get()->dump_id = snapshot_dump_id_;
+    if (!snapshot_is_base_)
+      base_dump.get()->base_dump_id = snapshot_state_->base_dump_id;
+    dirent.stream_type = MD_BASE_DUMP_STREAM;
+    dirent.location = base_dump.location();
+    dir.CopyIndex(dir_index++, &dirent);
+
+    if (!minidump_writer_.Flush())
+      return false;
+    snapshot_state_->sequence++;
+    snapshot_state_->module_list_id = module_list_id;
+    snapshot_state_->dump_id = snapshot_dump_id_;
+    if (snapshot_is_base_) {
+      snapshot_state_->base_dump_id = snapshot_dump_id_;
+      snapshot_state_->base_stacks.assign(snapshot_stacks_.begin(),
+                                          snapshot_stacks_.end());
+    }
     return true;
   }
 
-  bool FillThreadStack(MDRawThread* thread, uintptr_t stack_pointer,
-                       uintptr_t pc, int max_stack_len, uint8_t** stack_copy) {
-    *stack_copy = NULL;
-    const void* stack;
-    size_t stack_len;
+  // In a live snapshot, if |stack| of |thread| is unchanged since the base
+  // snapshot, describes it in |thread| without writing it and returns true.
+  // Records |stack| if this is a base snapshot.
+  bool ReuseBaseStack(MDRawThread* thread, const ThreadStack& stack) {
+    LiveSnapshotState::StackDigest digest;
+    digest.thread_id = thread->thread_id;
+    digest.start = reinterpret_cast<uintptr_t>(stack.stack);
+    digest.length = stack.stack_len;
+    digest.hash = Fnv1a(kFnv1aBasis, stack.copy, stack.stack_len);
+    if (snapshot_is_base_) {
+      snapshot_stacks_.push_back(digest);
+      return false;
+    }
+    for (size_t i = 0; i < snapshot_state_->base_stacks.size(); ++i) {
+      const LiveSnapshotState::StackDigest& base =
+          snapshot_state_->base_stacks[i];
+      if (base.thread_id == digest.thread_id && base.start == digest.start &&
+          base.length == digest.length && base.hash == digest.hash) {
+        thread->stack.start_of_memory_range = digest.start;
+        thread->stack.memory.data_size = digest.length;
+        thread->stack.memory.rva = 0;
+        return true;
+      }
+    }
+    return false;
+  }
 
-    thread->stack.start_of_memory_range = stack_pointer;
-    thread->stack.memory.data_size = 0;
-    thread->stack.memory.rva = minidump_writer_.position();
+  static const uint64_t kFnv1aBasis = 14695981039346656037ULL;
 
-    if (dumper_->GetStackInfo(&stack, &stack_len, stack_pointer)) {
-      if (max_stack_len >= 0 &&
-          stack_len > static_cast<unsigned int>(max_stack_len)) {
-        stack_len = max_stack_len;
-        // Skip empty chunks of length max_stack_len.
-        uintptr_t int_stack = reinterpret_cast<uintptr_t>(stack);
-        if (max_stack_len > 0) {
-          while (int_stack + max_stack_len < stack_pointer) {
-            int_stack += max_stack_len;
-          }
-        }
-        stack = reinterpret_cast<const void*>(int_stack);
-      }
-      *stack_copy = reinterpret_cast<uint8_t*>(Alloc(stack_len));
-      dumper_->CopyFromProcess(*stack_copy, thread->thread_id, stack,
-                               stack_len);
+  static uint64_t Fnv1a(uint64_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; ++i) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
 
-      uintptr_t stack_pointer_offset =
-          stack_pointer - reinterpret_cast<uintptr_t>(stack);
-      if (skip_stacks_if_mapping_unreferenced_) {
-        if (!principal_mapping_) {
-          return true;
-        }
-        uintptr_t low_addr = principal_mapping_->system_mapping_info.start_addr;
-        uintptr_t high_addr = principal_mapping_->system_mapping_info.end_addr;
-        if ((pc < low_addr || pc > high_addr) &&
-            !dumper_->StackHasPointerToMapping(*stack_copy, stack_len,
-                                               stack_pointer_offset,
-                                               *principal_mapping_)) {
-          return true;
+  // Returns a hash of the mappings WriteMappings() would write, which
+  // changes whenever a module is loaded, unloaded or replaced. Never 0.
+  uint64_t ModuleListId() const {
+    uint64_t hash = kFnv1aBasis;
+    for (unsigned i = 0; i < dumper_->mappings().size(); ++i) {
+      const MappingInfo& mapping = *dumper_->mappings()[i];
+      if (!ShouldIncludeMapping(mapping))
+        continue;
+      hash = Fnv1a(hash, &mapping.start_addr, sizeof(mapping.start_addr));
+      hash = Fnv1a(hash, &mapping.size, sizeof(mapping.size));
+      hash = Fnv1a(hash, &mapping.offset, sizeof(mapping.offset));
+      hash = Fnv1a(hash, mapping.name, my_strlen(mapping.name) + 1);
+    }
+    return hash ? hash : 1;
+  }
+
+  // Works out which part of the stack around |stack_pointer| to dump, at
+  // most |max_stack_len| bytes if that isn't negative, and allocates
+  // |stack->copy| for it. Leaves |stack->copy| NULL if there is no stack to
+  // dump.
+  void LocateThreadStack(uintptr_t stack_pointer, int max_stack_len,
+                         ThreadStack* stack) {
+    stack->copy = NULL;
+    if (max_stack_len == 0)
+      return;
+    if (!dumper_->GetStackInfo(&stack->stack, &stack->stack_len,
+                               stack_pointer))
+      return;
+
+    if (max_stack_len >= 0 &&
+        stack->stack_len > static_cast<unsigned int>(max_stack_len)) {
+      stack->stack_len = max_stack_len;
+      // Skip empty chunks of length max_stack_len.
+      uintptr_t int_stack = reinterpret_cast<uintptr_t>(stack->stack);
+      if (max_stack_len > 0) {
+        while (int_stack + max_stack_len < stack_pointer) {
+          int_stack += max_stack_len;
         }
       }
+      stack->stack = reinterpret_cast<const void*>(int_stack);
+    }
+    stack->copy = reinterpret_cast<uint8_t*>(Alloc(stack->stack_len));
+  }
 
+  // Returns false if |stack|, which has been copied, is to be left out
+  // because skip_stacks_if_mapping_unreferenced_ is set and neither |pc| nor
+  // the stack refers to the principal mapping.
+  bool ShouldDumpStack(uintptr_t stack_pointer, uintptr_t pc,
+                       const ThreadStack& stack) {
+    if (!skip_stacks_if_mapping_unreferenced_)
+      return true;
+    if (!principal_mapping_)
+      return false;
+    uintptr_t low_addr = principal_mapping_->system_mapping_info.start_addr;
+    uintptr_t high_addr = principal_mapping_->system_mapping_info.end_addr;
+    if (pc >= low_addr && pc <= high_addr)
+      return true;
+    uintptr_t stack_pointer_offset =
+        stack_pointer - reinterpret_cast<uintptr_t>(stack.stack);
+    return dumper_->StackHasPointerToMapping(stack.copy, stack.stack_len,
+                                             stack_pointer_offset,
+                                             *principal_mapping_);
+  }
+
+  // Shortens the stacks of all but the crashing thread, |crashing_index|,
+  // to fit what its stack leaves of stack_limits_.total_stack_len. The
+  // threads share the budget equally, except that a thread whose stack is
+  // smaller than its share passes the rest on. Each stack keeps the bytes
+  // nearest its stack pointer. Stacks cut to nothing are dropped.
+  void ApplyStackBudget(ThreadStack* stacks, unsigned num_threads,
+                        unsigned crashing_index) {
+    if (stack_limits_.total_stack_len < 0)
+      return;
+    size_t budget = stack_limits_.total_stack_len;
+    if (crashing_index < num_threads && stacks[crashing_index].copy) {
+      const size_t crashing_len = stacks[crashing_index].stack_len;
+      budget = crashing_len < budget ? budget - crashing_len : 0;
+    }
+
+    unsigned* const order =
+        reinterpret_cast<unsigned*>(Alloc(num_threads * sizeof(unsigned)));
+    if (!order)
+      return;
+    unsigned num_others = 0;
+    for (unsigned i = 0; i < num_threads; ++i) {
+      if (i != crashing_index && stacks[i].copy)
+        order[num_others++] = i;
+    }
+    std::sort(order, order + num_others, [stacks](unsigned a, unsigned b) {
+      return stacks[a].stack_len < stacks[b].stack_len;
+    });
+
+    for (unsigned i = 0; i < num_others; ++i) {
+      ThreadStack& stack = stacks[order[i]];
+      const size_t share = budget / (num_others - i);
+      if (stack.stack_len > share)
+        stack.stack_len = share;
+      budget -= stack.stack_len;
+      if (!stack.stack_len)
+        stack.copy = NULL;
+    }
+  }
+
+  // Writes |stack|, which LocateThreadStack() found and which has since
+  // been copied, as the stack of |thread|.
+  bool FillThreadStack(MDRawThread* thread, uintptr_t stack_pointer,
+                       const ThreadStack& stack) {
+    thread->stack.start_of_memory_range = stack_pointer;
+    thread->stack.memory.data_size = 0;
+    thread->stack.memory.rva = minidump_writer_.position();
+
+    if (stack.copy) {
+      uintptr_t stack_pointer_offset =
+          stack_pointer - reinterpret_cast<uintptr_t>(stack.stack);
       if (sanitize_stacks_) {
-        dumper_->SanitizeStackCopy(*stack_copy, stack_len, stack_pointer,
+        dumper_->SanitizeStackCopy(stack.copy, stack.stack_len, stack_pointer,
                                    stack_pointer_offset);
       }
+      if (snapshot_state_ && ReuseBaseStack(thread, stack))
+        return true;
 
       UntypedMDRVA memory(&minidump_writer_);
-      if (!memory.Allocate(stack_len))
+      if (!memory.Allocate(stack.stack_len))
         return false;
-      memory.Copy(*stack_copy, stack_len);
-      thread->stack.start_of_memory_range = reinterpret_cast<uintptr_t>(stack);
+      memory.Copy(stack.copy, stack.stack_len);
+      thread->stack.start_of_memory_range =
+          reinterpret_cast<uintptr_t>(stack.stack);
       thread->stack.memory = memory.location();
       memory_blocks_.push_back(thread->stack);
     }
@@ -402,23 +652,77 @@ class MinidumpWriter {
         extra_thread_stack_len = kLimitMaxExtraThreadStackLen;
     }
 
+    // Read every thread's registers and find its stack first, then copy all
+    // the stacks in one batch, which the dumper may share among threads of
+    // its own. Drop the stacks that aren't wanted, fit the rest to the stack
+    // budget, and finally write the threads out in order.
+    ThreadInfo* const infos =
+        reinterpret_cast<ThreadInfo*>(Alloc(num_threads * sizeof(ThreadInfo)));
+    ThreadStack* const stacks = reinterpret_cast<ThreadStack*>(
+        Alloc(num_threads * sizeof(ThreadStack)));
+    LinuxDumper::CopyRequest* const requests =
+        reinterpret_cast<LinuxDumper::CopyRequest*>(
+            Alloc(num_threads * sizeof(LinuxDumper::CopyRequest)));
+    if (!infos || !stacks || !requests)
+      return false;
+    size_t num_requests = 0;
+    unsigned crashing_index = num_threads;
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+      const pid_t thread_id = dumper_->threads()[i];
+      uintptr_t stack_pointer;
+      int max_stack_len = -1;  // default to no maximum for this thread
+      if (HasCrashContext(thread_id)) {
+        stack_pointer = UContextReader::GetStackPointer(ucontext_);
+      } else {
+        if (!dumper_->GetThreadInfoByIndex(i, &infos[i]))
+          return false;
+        stack_pointer = infos[i].stack_pointer;
+        if (minidump_size_limit_ >= 0 && i >= kLimitBaseThreadCount)
+          max_stack_len = extra_thread_stack_len;
+      }
+      if (thread_id == GetCrashThread() && !snapshot_state_) {
+        crashing_index = i;
+      } else if (stack_limits_.thread_stack_len >= 0 &&
+                 (max_stack_len < 0 ||
+                  stack_limits_.thread_stack_len < max_stack_len)) {
+        max_stack_len = stack_limits_.thread_stack_len;
+      }
+
+      LocateThreadStack(stack_pointer, max_stack_len, &stacks[i]);
+      if (stacks[i].copy) {
+        LinuxDumper::CopyRequest& request = requests[num_requests++];
+        request.dest = stacks[i].copy;
+        request.child = thread_id;
+        request.src = stacks[i].stack;
+        request.length = stacks[i].stack_len;
+      }
+    }
+
+    dumper_->CopyFromProcessBatch(requests, num_requests);
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+      if (!stacks[i].copy)
+        continue;
+      const bool has_context = HasCrashContext(dumper_->threads()[i]);
+      const uintptr_t stack_pointer = has_context ?
+          UContextReader::GetStackPointer(ucontext_) : infos[i].stack_pointer;
+      const uintptr_t pc = has_context ?
+          UContextReader::GetInstructionPointer(ucontext_) :
+          infos[i].GetInstructionPointer();
+      if (!ShouldDumpStack(stack_pointer, pc, stacks[i]))
+        stacks[i].copy = NULL;
+    }
+    ApplyStackBudget(stacks, num_threads, crashing_index);
+
     for (unsigned i = 0; i < num_threads; ++i) {
       MDRawThread thread;
       my_memset(&thread, 0, sizeof(thread));
       thread.thread_id = dumper_->threads()[i];
 
-      // We have a different source of information for the crashing thread. If
-      // we used the actual state of the thread we would find it running in the
-      // signal handler with the alternative stack, which would be deeply
-      // unhelpful.
-      if (static_cast<pid_t>(thread.thread_id) == GetCrashThread() &&
-          ucontext_ &&
-          !dumper_->IsPostMortem()) {
-        uint8_t* stack_copy;
+      if (HasCrashContext(thread.thread_id)) {
         const uintptr_t stack_ptr = UContextReader::GetStackPointer(ucontext_);
-        if (!FillThreadStack(&thread, stack_ptr,
-                             UContextReader::GetInstructionPointer(ucontext_),
-                             -1, &stack_copy))
+        if (!FillThreadStack(&thread, stack_ptr, stacks[i]))
           return false;
 
         // Copy 256 bytes around crashing instruction pointer to minidump.
@@ -476,17 +780,8 @@ class MinidumpWriter {
         thread.thread_context = cpu.location();
         crashing_thread_context_ = cpu.location();
       } else {
-        ThreadInfo info;
-        if (!dumper_->GetThreadInfoByIndex(i, &info))
-          return false;
-
-        uint8_t* stack_copy;
-        int max_stack_len = -1;  // default to no maximum for this thread
-        if (minidump_size_limit_ >= 0 && i >= kLimitBaseThreadCount)
-          max_stack_len = extra_thread_stack_len;
-        if (!FillThreadStack(&thread, info.stack_pointer,
-                             info.GetInstructionPointer(), max_stack_len,
-                             &stack_copy))
+        ThreadInfo& info = infos[i];
+        if (!FillThreadStack(&thread, info.stack_pointer, stacks[i]))
           return false;
 
         TypedMDRVA<RawContextCPU> cpu(&minidump_writer_);
@@ -739,6 +1034,14 @@ class MinidumpWriter {
     return true;
   }
 
+  // Fills in |dirent| with the DSO debug stream, or nullifies it if the
+  // stream can't be written.
+  void WriteDSODebugEntry(MDRawDirectory* dirent) {
+    dirent->stream_type = MD_LINUX_DSO_DEBUG;
+    if (!WriteDSODebugStream(dirent))
+      NullifyDirectoryEntry(dirent);
+  }
+
   bool WriteDSODebugStream(MDRawDirectory* dirent) {
     ElfW(Phdr)* phdr = reinterpret_cast<ElfW(Phdr)*>(dumper_->auxv()[AT_PHDR]);
     char* base;
@@ -749,12 +1052,18 @@ class MinidumpWriter {
     // Assume the program base is at the beginning of the same page as the PHDR
     base = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(phdr) & ~0xfff);
 
-    // Search for the program PT_DYNAMIC segment
+    // Search for the program PT_DYNAMIC segment. The program headers are
+    // copied with a single read.
+    wasteful_vector<ElfW(Phdr)> phdrs(dumper_->allocator(), phnum);
+    phdrs.resize(phnum);
+    if (!dumper_->CopyFromProcess(&phdrs[0], GetCrashThread(), phdr,
+                                  phnum * sizeof(ElfW(Phdr)))) {
+      return false;
+    }
     ElfW(Addr) dyn_addr = 0;
-    for (; phnum >= 0; phnum--, phdr++) {
-      ElfW(Phdr) ph;
-      if (!dumper_->CopyFromProcess(&ph, GetCrashThread(), phdr, sizeof(ph)))
-        return false;
+    size_t dyn_size = 0;
+    for (int i = 0; i < phnum; ++i) {
+      const ElfW(Phdr)& ph = phdrs[i];
 
       // Adjust base address with the virtual address of the PT_LOAD segment
       // corresponding to offset 0
@@ -763,6 +1072,7 @@ class MinidumpWriter {
       }
       if (ph.p_type == PT_DYNAMIC) {
         dyn_addr = ph.p_vaddr;
+        dyn_size = ph.p_memsz;
       }
     }
     if (!dyn_addr)
@@ -773,14 +1083,30 @@ class MinidumpWriter {
     // The dynamic linker makes information available that helps gdb find all
     // DSOs loaded into the program. If this information is indeed available,
     // dump it to a MD_LINUX_DSO_DEBUG stream.
+    //
+    // The whole dynamic section is copied at once when its size is known,
+    // and the entries are copied one at a time otherwise.
+    const size_t max_dyn_count = dyn_size / sizeof(ElfW(Dyn));
+    wasteful_vector<ElfW(Dyn)> dyns(dumper_->allocator(),
+                                    max_dyn_count ? max_dyn_count : 1);
+    if (max_dyn_count) {
+      dyns.resize(max_dyn_count);
+      if (!dumper_->CopyFromProcess(&dyns[0], GetCrashThread(), dynamic,
+                                    max_dyn_count * sizeof(ElfW(Dyn)))) {
+        dyns.clear();
+      }
+    }
+
     struct r_debug* r_debug = NULL;
     uint32_t dynamic_length = 0;
 
-    for (int i = 0; ; ++i) {
+    for (size_t i = 0; ; ++i) {
       ElfW(Dyn) dyn;
       dynamic_length += sizeof(dyn);
-      if (!dumper_->CopyFromProcess(&dyn, GetCrashThread(), dynamic + i,
-                                    sizeof(dyn))) {
+      if (i < dyns.size()) {
+        dyn = dyns[i];
+      } else if (!dumper_->CopyFromProcess(&dyn, GetCrashThread(), dynamic + i,
+                                           sizeof(dyn))) {
         return false;
       }
 
@@ -805,52 +1131,67 @@ class MinidumpWriter {
     // See <link.h> for a more detailed discussion of the how the dynamic
     // loader communicates with debuggers.
 
-    // Count the number of loaded DSOs
-    int dso_count = 0;
+    // Collect the loaded DSOs. The list has to be followed one node at a
+    // time, but each node is only copied once.
     struct r_debug debug_entry;
     if (!dumper_->CopyFromProcess(&debug_entry, GetCrashThread(), r_debug,
                                   sizeof(debug_entry))) {
       return false;
     }
+    wasteful_vector<struct link_map> maps(dumper_->allocator());
     for (struct link_map* ptr = debug_entry.r_map; ptr; ) {
       struct link_map map;
       if (!dumper_->CopyFromProcess(&map, GetCrashThread(), ptr, sizeof(map)))
         return false;
 
       ptr = map.l_next;
-      dso_count++;
+      maps.push_back(map);
     }
+    const int dso_count = static_cast<int>(maps.size());
 
     MDRVA linkmap_rva = minidump_writer_.kInvalidMDRVA;
     if (dso_count > 0) {
       // If we have at least one DSO, create an array of MDRawLinkMap
-      // entries in the minidump file.
+      // entries in the mini dump file.
       TypedMDRVA<MDRawLinkMap> linkmap(&minidump_writer_);
       if (!linkmap.AllocateArray(dso_count))
         return false;
       linkmap_rva = linkmap.location().rva;
-      int idx = 0;
+
+      // Copy all of the DSO names in one batch. Each name gets a zeroed slot
+      // one byte longer than what is copied, so it stays terminated even if
+      // the copy fails.
+      static const size_t kNameSlotSize = 257;
+      wasteful_vector<char> names(dumper_->allocator(),
+                                  dso_count * kNameSlotSize);
+      names.resize(dso_count * kNameSlotSize, 0);
+      wasteful_vector<LinuxDumper::CopyRequest> requests(dumper_->allocator(),
+                                                         dso_count);
+      for (int idx = 0; idx < dso_count; ++idx) {
+        if (!maps[idx].l_name)
+          continue;
+        LinuxDumper::CopyRequest request;
+        request.dest = &names[idx * kNameSlotSize];
+        request.child = GetCrashThread();
+        request.src = maps[idx].l_name;
+        request.length = kNameSlotSize - 1;
+        requests.push_back(request);
+      }
+      if (!requests.empty())
+        dumper_->CopyFromProcessBatch(&requests[0], requests.size());
 
       // Iterate over DSOs and write their information to mini dump
-      for (struct link_map* ptr = debug_entry.r_map; ptr; ) {
-        struct link_map map;
-        if (!dumper_->CopyFromProcess(&map, GetCrashThread(), ptr, sizeof(map)))
-          return  false;
-
-        ptr = map.l_next;
-        char filename[257] = { 0 };
-        if (map.l_name) {
-          dumper_->CopyFromProcess(filename, GetCrashThread(), map.l_name,
-                                   sizeof(filename) - 1);
-        }
+      for (int idx = 0; idx < dso_count; ++idx) {
+        const struct link_map& map = maps[idx];
         MDLocationDescriptor location;
-        if (!minidump_writer_.WriteString(filename, 0, &location))
+        if (!minidump_writer_.WriteString(&names[idx * kNameSlotSize], 0,
+                                          &location))
           return false;
         MDRawLinkMap entry;
         entry.name = location.rva;
         entry.addr = map.l_addr;
         entry.ld = reinterpret_cast<uintptr_t>(map.l_ld);
-        linkmap.CopyIndex(idx++, &entry);
+        linkmap.CopyIndex(idx, &entry);
       }
     }
 
@@ -869,24 +1210,63 @@ class MinidumpWriter {
     debug.get()->ldbase = debug_entry.r_ldbase;
     debug.get()->dynamic = reinterpret_cast<uintptr_t>(dynamic);
 
-    wasteful_vector<char> dso_debug_data(dumper_->allocator(), dynamic_length);
-    // The passed-in size to the constructor (above) is only a hint.
-    // Must call .resize() to do actual initialization of the elements.
-    dso_debug_data.resize(dynamic_length);
-    dumper_->CopyFromProcess(&dso_debug_data[0], GetCrashThread(), dynamic,
-                             dynamic_length);
-    debug.CopyIndexAfterObject(0, &dso_debug_data[0], dynamic_length);
+    if (dynamic_length <= dyns.size() * sizeof(ElfW(Dyn))) {
+      // The dynamic section was already copied above.
+      debug.CopyIndexAfterObject(0, &dyns[0], dynamic_length);
+    } else {
+      wasteful_vector<char> dso_debug_data(dumper_->allocator(),
+                                           dynamic_length);
+      // The passed-in size to the constructor (above) is only a hint.
+      // Must call .resize() to do actual initialization of the elements.
+      dso_debug_data.resize(dynamic_length);
+      dumper_->CopyFromProcess(&dso_debug_data[0], GetCrashThread(), dynamic,
+                               dynamic_length);
+      debug.CopyIndexAfterObject(0, &dso_debug_data[0], dynamic_length);
+    }
 
     return true;
   }
 
   void set_minidump_size_limit(off_t limit) { minidump_size_limit_ = limit; }
+  void set_stack_limits(const StackCaptureLimits& limits) {
+    stack_limits_ = limits;
+  }
+  void set_compress(bool compress) { compress_ = compress; }
+  void set_thread_selection(const ThreadSelection& selection) {
+    thread_selection_ = selection;
+  }
+
+  // Resume the process's threads once their registers, their stacks and
+  // the rest of the process's memory have been copied, rather than once
+  // the whole minidump has been written. The mappings' file identifiers
+  // and the /proc files are then read while the process runs.
+  void set_resume_threads_early(bool resume) {
+    resume_threads_early_ = resume;
+  }
+
+  // Write a live snapshot identified by |dump_id|, continuing the series
+  // in |state|, instead of a full minidump. Every thread's stack is held to
+  // stack_limits_.thread_stack_len.
+  void set_snapshot_state(LiveSnapshotState* state, const MDGUID& dump_id) {
+    snapshot_state_ = state;
+    snapshot_dump_id_ = dump_id;
+  }
 
  private:
   void* Alloc(unsigned bytes) {
     return dumper_->allocator()->Alloc(bytes);
   }
 
+  // Whether |thread_id| is the crashing thread and its context at the time
+  // of the crash is known. We then have a different source of information
+  // for it: if we used the actual state of the thread we would find it
+  // running in the signal handler with the alternative stack, which would
+  // be deeply unhelpful.
+  bool HasCrashContext(pid_t thread_id) const {
+    return thread_id == GetCrashThread() && ucontext_ &&
+           !dumper_->IsPostMortem();
+  }
+
   pid_t GetCrashThread() const {
     return dumper_->crash_thread();
   }
@@ -897,8 +1277,37 @@ class MinidumpWriter {
     dirent->location.rva = 0;
   }
 
-#if defined(__i386__) || defined(__x86_64__) || defined(__mips__)
+  // Fills in the CPU fields of |sys_info| from the installed CpuInfoCache,
+  // if there is one, or else from /proc/cpuinfo.
   bool WriteCPUInformation(MDRawSystemInfo* sys_info) {
+    const CpuInfoCache* cache = CpuInfoCache::process_cache();
+    if (cache)
+      return cache->GetSystemInfo(sys_info);
+    return ReadCPUInformation(sys_info);
+  }
+
+  // Writes the copy of /proc/cpuinfo in the installed CpuInfoCache, if
+  // there is one, or else the file.
+  bool WriteCpuInfo(MDLocationDescriptor* result) {
+    const CpuInfoCache* cache = CpuInfoCache::process_cache();
+    if (!cache)
+      return WriteFile(result, "/proc/cpuinfo");
+    if (cache->text_size() == 0)
+      return false;
+
+    UntypedMDRVA memory(&minidump_writer_);
+    if (!memory.Allocate(cache->text_size()))
+      return false;
+    memory.Copy(memory.position(), cache->text(), cache->text_size());
+    *result = memory.location();
+    return true;
+  }
+
+ public:
+  // Fills in the CPU fields of |sys_info| from /proc/cpuinfo and, on ARM,
+  // sysfs. Used by CpuInfoCache too, through ReadCPUInformation().
+#if defined(__i386__) || defined(__x86_64__) || defined(__mips__)
+  static bool ReadCPUInformation(MDRawSystemInfo* sys_info) {
     char vendor_id[sizeof(sys_info->cpu.x86_cpu_info.vendor_id) + 1] = {0};
     static const char vendor_id_name[] = "vendor_id";
 
@@ -998,7 +1407,7 @@ class MinidumpWriter {
     return true;
   }
 #elif defined(__arm__) || defined(__aarch64__)
-  bool WriteCPUInformation(MDRawSystemInfo* sys_info) {
+  static bool ReadCPUInformation(MDRawSystemInfo* sys_info) {
     // The CPUID value is broken up in several entries in /proc/cpuinfo.
     // This table is used to rebuild it from the entries.
     const struct CpuIdEntry {
@@ -1209,11 +1618,19 @@ class MinidumpWriter {
 #  error "Unsupported CPU"
 #endif
 
+ private:
   bool WriteFile(MDLocationDescriptor* result, const char* filename) {
     const int fd = sys_open(filename, O_RDONLY, 0);
     if (fd < 0)
       return false;
 
+    // The kernel can send most files, even /proc ones, straight into the
+    // minidump.
+    if (minidump_writer_.WriteFromFile(fd, result)) {
+      sys_close(fd);
+      return true;
+    }
+
     // We can't stat the files because several of the files that we want to
     // read are kernel seqfiles, which always have a length of zero. So we have
     // to read as much as we can into a buffer.
@@ -1339,6 +1756,9 @@ class MinidumpWriter {
   LinuxDumper* dumper_;
   MinidumpFileWriter minidump_writer_;
   off_t minidump_size_limit_;
+  StackCaptureLimits stack_limits_;
+  // The threads to suspend and dump; the default is all of them.
+  ThreadSelection thread_selection_;
   MDLocationDescriptor crashing_thread_context_;
   // Blocks of memory written to the dump. These are all currently
   // written while writing the thread list stream, but saved here
@@ -1356,9 +1776,38 @@ class MinidumpWriter {
   const MappingInfo* principal_mapping_;
   // If true, apply stack sanitization to stored stack data.
   bool sanitize_stacks_;
+  // If true, resume the process's threads as soon as everything that reads
+  // its memory has been written.
+  bool resume_threads_early_;
+  // Whether to write a compressed minidump.
+  bool compress_;
+  // If not NULL, write a live snapshot continuing this series, with this
+  // ID, and whether it is a base snapshot. A base snapshot records its
+  // stacks for the state.
+  LiveSnapshotState* snapshot_state_;
+  MDGUID snapshot_dump_id_;
+  bool snapshot_is_base_;
+  wasteful_vector<LiveSnapshotState::StackDigest> snapshot_stacks_;
 };
 
 
+bool WriteLiveSnapshotImpl(const char* minidump_path, int minidump_fd,
+                           const MDGUID& dump_id, pid_t process,
+                           int stack_len, LiveSnapshotState* state) {
+  LinuxPtraceDumper dumper(process);
+  MappingList mapping_list;
+  AppMemoryList app_memory_list;
+  MinidumpWriter writer(minidump_path, minidump_fd, NULL, mapping_list,
+                        app_memory_list, false, 0, false, &dumper);
+  StackCaptureLimits stack_limits;
+  stack_limits.thread_stack_len = stack_len;
+  writer.set_stack_limits(stack_limits);
+  writer.set_snapshot_state(state, dump_id);
+  if (!writer.Init())
+    return false;
+  return writer.Dump();
+}
+
 bool WriteMinidumpImpl(const char* minidump_path,
                        int minidump_fd,
                        off_t minidump_size_limit,
@@ -1368,7 +1817,10 @@ bool WriteMinidumpImpl(const char* minidump_path,
                        const AppMemoryList& appmem,
                        bool skip_stacks_if_mapping_unreferenced,
                        uintptr_t principal_mapping_address,
-                       bool sanitize_stacks) {
+                       bool sanitize_stacks,
+                       const StackCaptureLimits& stack_limits,
+                       bool compress,
+                       const ThreadSelection& thread_selection) {
   LinuxPtraceDumper dumper(crashing_process);
   const ExceptionHandler::CrashContext* context = NULL;
   if (blob) {
@@ -1383,6 +1835,9 @@ bool WriteMinidumpImpl(const char* minidump_path,
                         principal_mapping_address, sanitize_stacks, &dumper);
   // Set desired limit for file size of minidump (-1 means no limit).
   writer.set_minidump_size_limit(minidump_size_limit);
+  writer.set_stack_limits(stack_limits);
+  writer.set_compress(compress);
+  writer.set_thread_selection(thread_selection);
   if (!writer.Init())
     return false;
   return writer.Dump();
@@ -1392,6 +1847,10 @@ bool WriteMinidumpImpl(const char* minidump_path,
 
 namespace google_breakpad {
 
+bool ReadCPUInformation(MDRawSystemInfo* sys_info) {
+  return MinidumpWriter::ReadCPUInformation(sys_info);
+}
+
 bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
                    const void* blob, size_t blob_size,
                    bool skip_stacks_if_mapping_unreferenced,
@@ -1402,7 +1861,8 @@ bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
                            MappingList(), AppMemoryList(),
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, StackCaptureLimits(), false,
+                           ThreadSelection());
 }
 
 bool WriteMinidump(int minidump_fd, pid_t crashing_process,
@@ -1415,7 +1875,8 @@ bool WriteMinidump(int minidump_fd, pid_t crashing_process,
                            MappingList(), AppMemoryList(),
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, StackCaptureLimits(), false,
+                           ThreadSelection());
 }
 
 bool WriteMinidump(const char* minidump_path, pid_t process,
@@ -1428,11 +1889,40 @@ bool WriteMinidump(const char* minidump_path, pid_t process,
   AppMemoryList app_memory_list;
   MinidumpWriter writer(minidump_path, -1, NULL, mapping_list,
                         app_memory_list, false, 0, false, &dumper);
+  // The process hasn't crashed and will carry on, so stop it only as long
+  // as it takes to copy its threads and memory.
+  writer.set_resume_threads_early(true);
   if (!writer.Init())
     return false;
   return writer.Dump();
 }
 
+bool WriteLiveSnapshot(int minidump_fd, pid_t process, int stack_len,
+                       LiveSnapshotState* state) {
+  MDGUID dump_id;
+  if (!CreateGUID(&dump_id))
+    return false;
+  return WriteLiveSnapshotImpl(NULL, minidump_fd, dump_id, process,
+                               stack_len, state);
+}
+
+bool WriteLiveSnapshot(const char* directory, pid_t process, int stack_len,
+                       LiveSnapshotState* state) {
+  MDGUID dump_id;
+  char dump_id_str[kGUIDStringLength + 1];
+  if (!CreateGUID(&dump_id) ||
+      !GUIDToString(&dump_id, dump_id_str, sizeof(dump_id_str))) {
+    return false;
+  }
+  char path[PATH_MAX];
+  const int path_len = snprintf(path, sizeof(path), "%s/%s.dmp", directory,
+                                dump_id_str);
+  if (path_len < 0 || static_cast<size_t>(path_len) >= sizeof(path))
+    return false;
+  return WriteLiveSnapshotImpl(path, -1, dump_id, process, stack_len,
+                               state);
+}
+
 bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
                    const void* blob, size_t blob_size,
                    const MappingList& mappings,
@@ -1445,7 +1935,8 @@ bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
                            mappings, appmem,
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, StackCaptureLimits(), false,
+                           ThreadSelection());
 }
 
 bool WriteMinidump(int minidump_fd, pid_t crashing_process,
@@ -1460,7 +1951,8 @@ bool WriteMinidump(int minidump_fd, pid_t crashing_process,
                            mappings, appmem,
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, StackCaptureLimits(), false,
+                           ThreadSelection());
 }
 
 bool WriteMinidump(const char* minidump_path, off_t minidump_size_limit,
@@ -1470,13 +1962,17 @@ bool WriteMinidump(const char* minidump_path, off_t minidump_size_limit,
                    const AppMemoryList& appmem,
                    bool skip_stacks_if_mapping_unreferenced,
                    uintptr_t principal_mapping_address,
-                   bool sanitize_stacks) {
+                   bool sanitize_stacks,
+                   const StackCaptureLimits& stack_limits,
+                   bool compress,
+                   const ThreadSelection& thread_selection) {
   return WriteMinidumpImpl(minidump_path, -1, minidump_size_limit,
                            crashing_process, blob, blob_size,
                            mappings, appmem,
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, stack_limits, compress,
+                           thread_selection);
 }
 
 bool WriteMinidump(int minidump_fd, off_t minidump_size_limit,
@@ -1486,13 +1982,17 @@ bool WriteMinidump(int minidump_fd, off_t minidump_size_limit,
                    const AppMemoryList& appmem,
                    bool skip_stacks_if_mapping_unreferenced,
                    uintptr_t principal_mapping_address,
-                   bool sanitize_stacks) {
+                   bool sanitize_stacks,
+                   const StackCaptureLimits& stack_limits,
+                   bool compress,
+                   const ThreadSelection& thread_selection) {
   return WriteMinidumpImpl(NULL, minidump_fd, minidump_size_limit,
                            crashing_process, blob, blob_size,
                            mappings, appmem,
                            skip_stacks_if_mapping_unreferenced,
                            principal_mapping_address,
-                           sanitize_stacks);
+                           sanitize_stacks, stack_limits, compress,
+                           thread_selection);
 }
 
 bool WriteMinidump(const char* filename,
@@ -38,6 +38,7 @@
 #include <list>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "client/linux/minidump_writer/linux_dumper.h"
 #include "google_breakpad/common/minidump_format.h"
@@ -68,6 +69,22 @@ struct AppMemory {
 };
 typedef std::list<AppMemory> AppMemoryList;
 
+// Limits on how much stack memory a minidump captures. The crashing
+// thread's stack is always captured whole.
+struct StackCaptureLimits {
+  StackCaptureLimits() : thread_stack_len(-1), total_stack_len(-1) {}
+
+  // The most bytes of each other thread's stack to capture, from its stack
+  // pointer up, or -1 for no limit.
+  int thread_stack_len;
+  // The most bytes of stack to capture over all threads, or -1 for no
+  // limit. What the crashing thread's stack leaves is shared equally by the
+  // other threads, each dumping at least the bytes nearest its stack
+  // pointer. Stacks left out by skip_stacks_if_mapping_unreferenced don't
+  // count.
+  off_t total_stack_len;
+};
+
 // Writes a minidump to the filesystem. These functions do not malloc nor use
 // libc functions which may. Thus, it can be used in contexts where the state
 // of the heap may be corrupt.
@@ -94,10 +111,62 @@ bool WriteMinidump(int minidump_fd, pid_t crashing_process,
 // are not expected to have crashed.  If |process_blamed_thread| is
 // meaningful, it will be the one from which a crash signature is
 // extracted.  It is not expected that this function will be called
-// from a compromised context, but it is safe to do so.
+// from a compromised context, but it is safe to do so.  The process's
+// threads are resumed as soon as their registers, their stacks and any
+// other memory needed have been copied; the rest of the minidump, such as
+// the module identifiers and the /proc files, is written while the process
+// runs.
 bool WriteMinidump(const char* minidump_path, pid_t process,
                    pid_t process_blamed_thread);
 
+// What WriteLiveSnapshot() carries from one snapshot of a process to the
+// next.  A fresh state starts a new series.
+struct LiveSnapshotState {
+  LiveSnapshotState()
+      : sequence(0), module_list_id(0), dump_id(), base_dump_id() {}
+
+  // A thread's stack in the base snapshot.
+  struct StackDigest {
+    pid_t thread_id;
+    uintptr_t start;
+    size_t length;
+    uint64_t hash;
+  };
+
+  // The sequence number of the next snapshot.
+  uint32_t sequence;
+  // The MDRawLinuxSnapshotInfo::module_list_id of the last snapshot, or 0.
+  uint64_t module_list_id;
+  // The ID of the last snapshot written.
+  MDGUID dump_id;
+  // The ID of the last base snapshot, and the stacks it holds.
+  MDGUID base_dump_id;
+  std::vector<StackDigest> base_stacks;
+};
+
+// Writes a lightweight minidump of a live process, for sampling the stacks
+// of a hung process every few seconds, to a file in |directory| named
+// after its ID, "<id>.dmp". The threads are resumed as soon as their
+// registers and stacks have been copied, and at most |stack_len| bytes of
+// each stack are written, from its stack pointer up.
+//
+// The first snapshot of a series, and any taken after the process's
+// mappings have changed, is a base snapshot. It holds the module list,
+// whose file identifiers are the costly part of a dump, the system info and
+// the /proc files as well as the threads. The others are deltas against the
+// last base snapshot (see MDRawBaseDump): they only hold the threads,
+// leaving out the stacks that are unchanged since the base snapshot, and
+// Minidump takes the rest from the base snapshot. Every snapshot has a
+// MD_LINUX_SNAPSHOT_INFO stream. |state| is updated if the snapshot is
+// written.
+bool WriteLiveSnapshot(const char* directory, pid_t process, int stack_len,
+                       LiveSnapshotState* state);
+// Same as above but takes an open file descriptor instead of a directory.
+// The caller should name the file after |state->dump_id| for deltas
+// against it to be readable.
+bool WriteLiveSnapshot(int minidump_fd, pid_t process, int stack_len,
+                       LiveSnapshotState* state);
+
 // These overloads also allow passing a list of known mappings and
 // a list of additional memory regions to be included in the minidump.
 bool WriteMinidump(const char* minidump_path, pid_t crashing_process,
@@ -115,7 +184,11 @@ bool WriteMinidump(int minidump_fd, pid_t crashing_process,
                    uintptr_t principal_mapping_address = 0,
                    bool sanitize_stacks = false);
 
-// These overloads also allow passing a file size limit for the minidump.
+// These overloads also allow passing a file size limit for the minidump,
+// and limits on the stack memory it captures. If |compress| is true, the
+// minidump is written compressed (see MDRawCompressedHeader); Minidump in
+// the processor reads it either way. Only the threads |thread_selection|
+// picks are suspended and dumped.
 bool WriteMinidump(const char* minidump_path, off_t minidump_size_limit,
                    pid_t crashing_process,
                    const void* blob, size_t blob_size,
@@ -123,7 +196,12 @@ bool WriteMinidump(const char* minidump_path, off_t minidump_size_limit,
                    const AppMemoryList& appdata,
                    bool skip_stacks_if_mapping_unreferenced = false,
                    uintptr_t principal_mapping_address = 0,
-                   bool sanitize_stacks = false);
+                   bool sanitize_stacks = false,
+                   const StackCaptureLimits& stack_limits =
+                       StackCaptureLimits(),
+                   bool compress = false,
+                   const ThreadSelection& thread_selection =
+                       ThreadSelection());
 bool WriteMinidump(int minidump_fd, off_t minidump_size_limit,
                    pid_t crashing_process,
                    const void* blob, size_t blob_size,
@@ -131,13 +209,24 @@ bool WriteMinidump(int minidump_fd, off_t minidump_size_limit,
                    const AppMemoryList& appdata,
                    bool skip_stacks_if_mapping_unreferenced = false,
                    uintptr_t principal_mapping_address = 0,
-                   bool sanitize_stacks = false);
+                   bool sanitize_stacks = false,
+                   const StackCaptureLimits& stack_limits =
+                       StackCaptureLimits(),
+                   bool compress = false,
+                   const ThreadSelection& thread_selection =
+                       ThreadSelection());
 
 bool WriteMinidump(const char* filename,
                    const MappingList& mappings,
                    const AppMemoryList& appdata,
                    LinuxDumper* dumper);
 
+// Fills in the CPU fields of |sys_info| (the architecture, processor
+// level, revision and count, and |cpu|) the way a minidump's system info
+// stream has them, from /proc/cpuinfo and, on ARM, sysfs. Returns false if
+// some of them couldn't be read.
+bool ReadCPUInformation(MDRawSystemInfo* sys_info);
+
 }  // namespace google_breakpad
 
 #endif  // CLIENT_LINUX_MINIDUMP_WRITER_MINIDUMP_WRITER_H_
@@ -35,6 +35,7 @@
 #include <ucontext.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <string>
 
 #include "breakpad_googletest_includes.h"
@@ -45,6 +46,7 @@
 #include "common/linux/breakpad_getcontext.h"
 #include "common/linux/eintr_wrapper.h"
 #include "common/linux/file_id.h"
+#include "common/linux/guid_creator.h"
 #include "common/linux/ignore_ret.h"
 #include "common/linux/safe_readlink.h"
 #include "common/scoped_ptr.h"
@@ -931,4 +933,244 @@ TEST(MinidumpWriterTest, MinidumpSizeLimit) {
   IGNORE_EINTR(waitpid(child_pid, nullptr, 0));
 }
 
+TEST(MinidumpWriterTest, StackCaptureLimits) {
+  static const int kNumberOfThreadsInHelperProgram = 10;
+  static const int kThreadStackLimit = 4096;
+  static const off_t kTotalStackLimit = 8 * kThreadStackLimit;
+
+  char number_of_threads_arg[3];
+  sprintf(number_of_threads_arg, "%d", kNumberOfThreadsInHelperProgram);
+
+  string helper_path(GetHelperBinary());
+  if (helper_path.empty()) {
+    FAIL() << "Couldn't find helper binary";
+    exit(1);
+  }
+
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  pid_t child_pid = fork();
+  if (child_pid == 0) {
+    // In child process.
+    close(fds[0]);
+
+    // Pass the pipe fd and the number of threads as arguments.
+    char pipe_fd_string[8];
+    sprintf(pipe_fd_string, "%d", fds[1]);
+    execl(helper_path.c_str(),
+          helper_path.c_str(),
+          pipe_fd_string,
+          number_of_threads_arg,
+          NULL);
+  }
+  close(fds[1]);
+
+  // Wait for all child threads to indicate that they have started
+  for (int threads = 0; threads < kNumberOfThreadsInHelperProgram; threads++) {
+    struct pollfd pfd;
+    memset(&pfd, 0, sizeof(pfd));
+    pfd.fd = fds[0];
+    pfd.events = POLLIN | POLLERR;
+
+    const int r = HANDLE_EINTR(poll(&pfd, 1, 1000));
+    ASSERT_EQ(1, r);
+    ASSERT_TRUE(pfd.revents & POLLIN);
+    uint8_t junk;
+    ASSERT_EQ(read(fds[0], &junk, sizeof(junk)),
+              static_cast<ssize_t>(sizeof(junk)));
+  }
+  close(fds[0]);
+
+  // See MinidumpSizeLimit.
+  usleep(100000);
+
+  AutoTempDir temp_dir;
+  string dump_path = temp_dir.path() + kMDWriterUnitTestFileName;
+  StackCaptureLimits stack_limits;
+  stack_limits.thread_stack_len = kThreadStackLimit;
+  stack_limits.total_stack_len = kTotalStackLimit;
+  ASSERT_TRUE(WriteMinidump(dump_path.c_str(), -1, child_pid, NULL, 0,
+                            MappingList(), AppMemoryList(), false, 0, false,
+                            stack_limits));
+
+  // With no crash context the main thread counts as the crashing one, whose
+  // stack is dumped whole; every other thread is held to both limits.
+  Minidump minidump(dump_path);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpThreadList* dump_thread_list = minidump.GetThreadList();
+  ASSERT_TRUE(dump_thread_list);
+  ASSERT_GT(dump_thread_list->thread_count(), 1U);
+  off_t main_stack_size = 0;
+  off_t total_stack_size = 0;
+  int threads_with_stacks = 0;
+  for (unsigned int i = 0; i < dump_thread_list->thread_count(); i++) {
+    MinidumpThread* thread = dump_thread_list->GetThreadAtIndex(i);
+    uint32_t thread_id;
+    ASSERT_TRUE(thread->GetThreadID(&thread_id));
+    MinidumpMemoryRegion* memory = thread->GetMemory();
+    if (!memory)
+      continue;
+    if (thread_id == static_cast<uint32_t>(child_pid)) {
+      main_stack_size = memory->GetSize();
+      continue;
+    }
+    ++threads_with_stacks;
+    EXPECT_LE(memory->GetSize(), static_cast<uint32_t>(kThreadStackLimit));
+    total_stack_size += memory->GetSize();
+  }
+  EXPECT_GT(threads_with_stacks, 0);
+  EXPECT_LE(total_stack_size + main_stack_size,
+            std::max(kTotalStackLimit, main_stack_size));
+
+  kill(child_pid, SIGKILL);
+  IGNORE_EINTR(waitpid(child_pid, nullptr, 0));
+}
+
+// Test that a compressed minidump reads back the same as an uncompressed
+// one of the same process.
+TEST(MinidumpWriterTest, CompressedMinidump) {
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char b;
+    IGNORE_RET(HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+    close(fds[0]);
+    syscall(__NR_exit_group);
+  }
+  close(fds[0]);
+
+  ExceptionHandler::CrashContext context;
+  memset(&context, 0, sizeof(context));
+  // Set a non-zero tid to avoid tripping asserts.
+  context.tid = child;
+
+  AutoTempDir temp_dir;
+  string plain_path = temp_dir.path() + kMDWriterUnitTestFileName;
+  string compressed_path = plain_path + "-compressed";
+  ASSERT_TRUE(WriteMinidump(plain_path.c_str(), -1, child, &context,
+                            sizeof(context), MappingList(), AppMemoryList()));
+  ASSERT_TRUE(WriteMinidump(compressed_path.c_str(), -1, child, &context,
+                            sizeof(context), MappingList(), AppMemoryList(),
+                            false, 0, false, StackCaptureLimits(), true));
+
+  struct stat plain_st, compressed_st;
+  ASSERT_EQ(0, stat(plain_path.c_str(), &plain_st));
+  ASSERT_EQ(0, stat(compressed_path.c_str(), &compressed_st));
+  EXPECT_LT(compressed_st.st_size, plain_st.st_size);
+
+  Minidump plain(plain_path);
+  ASSERT_TRUE(plain.Read());
+  Minidump compressed(compressed_path);
+  ASSERT_TRUE(compressed.Read());
+  MinidumpThreadList* plain_threads = plain.GetThreadList();
+  MinidumpThreadList* compressed_threads = compressed.GetThreadList();
+  ASSERT_TRUE(plain_threads);
+  ASSERT_TRUE(compressed_threads);
+  ASSERT_EQ(plain_threads->thread_count(), compressed_threads->thread_count());
+  MinidumpModuleList* plain_modules = plain.GetModuleList();
+  MinidumpModuleList* compressed_modules = compressed.GetModuleList();
+  ASSERT_TRUE(plain_modules);
+  ASSERT_TRUE(compressed_modules);
+  EXPECT_EQ(plain_modules->module_count(), compressed_modules->module_count());
+  ASSERT_TRUE(compressed.GetException());
+
+  close(fds[1]);
+  IGNORE_EINTR(waitpid(child, nullptr, 0));
+}
+
+// Reads the MD_LINUX_SNAPSHOT_INFO stream of |minidump|.
+static void ReadSnapshotInfo(Minidump* minidump, MDRawLinuxSnapshotInfo* info) {
+  uint32_t length;
+  ASSERT_TRUE(minidump->SeekToStreamType(MD_LINUX_SNAPSHOT_INFO, &length));
+  ASSERT_EQ(sizeof(*info), length);
+  ASSERT_TRUE(minidump->ReadBytes(info, sizeof(*info)));
+}
+
+// Test that a series of live snapshots holds every thread's registers and
+// the top of its stack, and that the delta snapshots after the first read
+// back with what they leave out taken from it.
+TEST(MinidumpWriterTest, LiveSnapshots) {
+  static const int kStackLen = 4096;
+
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  const pid_t child = fork();
+  if (child == 0) {
+    close(fds[1]);
+    char b;
+    IGNORE_RET(HANDLE_EINTR(read(fds[0], &b, sizeof(b))));
+    close(fds[0]);
+    syscall(__NR_exit_group);
+  }
+  close(fds[0]);
+
+  // Let the child block in read(), so that its stack stays the same.
+  usleep(100000);
+
+  AutoTempDir temp_dir;
+  LiveSnapshotState state;
+  string paths[2];
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(WriteLiveSnapshot(temp_dir.path().c_str(), child, kStackLen,
+                                  &state));
+    char dump_id[kGUIDStringLength + 1];
+    ASSERT_TRUE(GUIDToString(&state.dump_id, dump_id, sizeof(dump_id)));
+    paths[i] = temp_dir.path() + "/" + dump_id + ".dmp";
+  }
+  EXPECT_EQ(2U, state.sequence);
+
+  Minidump base(paths[0]);
+  ASSERT_TRUE(base.Read());
+  EXPECT_FALSE(base.GetBaseDump());
+  MDRawLinuxSnapshotInfo base_info;
+  ASSERT_NO_FATAL_FAILURE(ReadSnapshotInfo(&base, &base_info));
+  EXPECT_EQ(0U, base_info.sequence);
+  EXPECT_EQ(static_cast<uint32_t>(MD_LINUX_SNAPSHOT_HAS_MODULE_LIST),
+            base_info.flags);
+  EXPECT_EQ(state.module_list_id, base_info.module_list_id);
+  MinidumpModuleList* modules = base.GetModuleList();
+  ASSERT_TRUE(modules);
+  EXPECT_GT(modules->module_count(), 0U);
+  EXPECT_FALSE(base.GetException());
+
+  // The child's stack is unchanged, so the delta leaves it out.
+  struct stat base_st, delta_st;
+  ASSERT_EQ(0, stat(paths[0].c_str(), &base_st));
+  ASSERT_EQ(0, stat(paths[1].c_str(), &delta_st));
+  EXPECT_LT(delta_st.st_size, base_st.st_size / 4);
+
+  Minidump delta(paths[1]);
+  ASSERT_TRUE(delta.Read());
+  ASSERT_TRUE(delta.GetBaseDump());
+  MDRawLinuxSnapshotInfo delta_info;
+  ASSERT_NO_FATAL_FAILURE(ReadSnapshotInfo(&delta, &delta_info));
+  EXPECT_EQ(1U, delta_info.sequence);
+  EXPECT_EQ(0U, delta_info.flags);
+  EXPECT_EQ(base_info.module_list_id, delta_info.module_list_id);
+  uint32_t length;
+  EXPECT_FALSE(delta.SeekToStreamType(MD_MODULE_LIST_STREAM, &length));
+  ASSERT_TRUE(delta.GetModuleList());
+  EXPECT_EQ(modules->module_count(), delta.GetModuleList()->module_count());
+  EXPECT_TRUE(delta.GetSystemInfo());
+
+  MinidumpThreadList* threads = delta.GetThreadList();
+  ASSERT_TRUE(threads);
+  ASSERT_EQ(1U, threads->thread_count());
+  MinidumpThread* thread = threads->GetThreadAtIndex(0);
+  ASSERT_TRUE(thread->GetContext());
+  MinidumpMemoryRegion* memory = thread->GetMemory();
+  ASSERT_TRUE(memory);
+  EXPECT_GT(memory->GetSize(), 0U);
+  EXPECT_LE(memory->GetSize(), static_cast<uint32_t>(kStackLen));
+  EXPECT_TRUE(memory->GetMemory());
+
+  close(fds[1]);
+  IGNORE_EINTR(waitpid(child, nullptr, 0));
+}
+
 }  // namespace
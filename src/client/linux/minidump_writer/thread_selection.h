@@ -0,0 +1,77 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// thread_selection.h: Define the google_breakpad::ThreadSelection
+// struct, which chooses the threads a Linux minidump holds.
+
+#ifndef CLIENT_LINUX_MINIDUMP_WRITER_THREAD_SELECTION_H_
+#define CLIENT_LINUX_MINIDUMP_WRITER_THREAD_SELECTION_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+
+namespace google_breakpad {
+
+// Chooses which threads of a process a minidump holds, for processes
+// with far more threads than are worth dumping. The threads left out are
+// neither suspended nor copied. The crashing thread is always kept, as
+// are the threads that any of the filters below pick; after them, up to
+// |max_other_threads| of the rest are kept, in the order the process
+// lists them. The default keeps every thread.
+struct ThreadSelection {
+  ThreadSelection()
+      : max_other_threads(-1),
+        names(NULL),
+        busiest_threads(0),
+        callback(NULL),
+        callback_context(NULL) {}
+
+  // Called for each thread with its ID and name; returns true to keep
+  // it. It runs in the same compromised context as the rest of the dump
+  // writer, so it must not allocate or take locks.
+  typedef bool (*Callback)(pid_t tid, const char* name, void* context);
+
+  // How many threads no filter picks are kept, or -1 for all of them.
+  int max_other_threads;
+  // A NULL-terminated array of thread names, as in
+  // /proc/<pid>/task/<tid>/comm. Threads with one of these names are kept.
+  const char* const* names;
+  // How many more threads are kept: those not otherwise picked that have
+  // used the most CPU time, according to /proc/<pid>/task/<tid>/stat.
+  // Threads that have used none are not picked.
+  int busiest_threads;
+  // If set, threads |callback| returns true for are kept. It is passed
+  // |callback_context|.
+  Callback callback;
+  void* callback_context;
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_LINUX_MINIDUMP_WRITER_THREAD_SELECTION_H_
@@ -163,6 +163,14 @@ typedef bool (*BreakpadFilterCallback)(int exception_type,
 //                                will write the dump file in-process and then
 //                                launch the reporter executable as a child
 //                                process.
+//
+// BREAKPAD_PRELAUNCH_INSPECTOR   A boolean NSNumber value. If YES, the
+//                                Inspector is launched when Breakpad is
+//                                initialized rather than when a crash
+//                                occurs, and waits for the crash message.
+//                                This keeps process startup off the crash
+//                                path at the cost of a resident process.
+//                                Ignored with BREAKPAD_IN_PROCESS.
 //=============================================================================
 // The BREAKPAD_PRODUCT, BREAKPAD_VERSION and BREAKPAD_URL are
 // required to have non-NULL values.  By default, the BREAKPAD_PRODUCT
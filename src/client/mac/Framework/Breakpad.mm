@@ -214,6 +214,8 @@ class Breakpad {
 
   bool                    send_and_exit_;  // Exit after sending, if true
 
+  bool                    inspector_prelaunched_;
+
   BreakpadFilterCallback  filter_callback_;
   void*                   filter_callback_context_;
 };
@@ -344,6 +346,7 @@ bool Breakpad::Initialize(NSDictionary* parameters) {
   // Initialize
   config_params_ = NULL;
   handler_ = NULL;
+  inspector_prelaunched_ = false;
 
   // Check for debugger
   if (IsDebuggerActive()) {
@@ -411,6 +414,21 @@ bool Breakpad::InitializeOutOfProcess(NSDictionary* parameters) {
     return false;
   }
 
+  if ([[parameters objectForKey:@BREAKPAD_PRELAUNCH_INSPECTOR] boolValue]) {
+    // Launch the Inspector now so that it is already waiting when we crash.
+    // It checks the service out itself once we exit, so nothing is leaked
+    // when there is never a crash.
+    inspector_.LaunchOnDemand();
+
+    InspectorPrelaunchInfo info;
+    info.pid = getpid();
+    MachSendMessage message(kMsgType_InspectorPrelaunch);
+    message.SetData(&info, sizeof(info));
+
+    MachPortSender sender(inspector_.GetServicePort());
+    inspector_prelaunched_ = sender.SendMessage(message, 2000) == KERN_SUCCESS;
+  }
+
   // Create the handler (allocating it in our special protected pool)
   handler_ =
       new (gBreakpadAllocator->Allocate(
@@ -688,15 +706,17 @@ bool Breakpad::HandleException(int exception_type,
     if (!should_handle) return false;
   }
 
-  // We need to reset the memory protections to be read/write,
-  // since LaunchOnDemand() requires changing state.
-  gBreakpadAllocator->Unprotect();
-  // Configure the server to launch when we message the service port.
-  // The reason we do this here, rather than at startup, is that we
-  // can leak a bootstrap service entry if this method is called and
-  // there never ends up being a crash.
-  inspector_.LaunchOnDemand();
-  gBreakpadAllocator->Protect();
+  if (!inspector_prelaunched_) {
+    // We need to reset the memory protections to be read/write,
+    // since LaunchOnDemand() requires changing state.
+    gBreakpadAllocator->Unprotect();
+    // Configure the server to launch when we message the service port.
+    // The reason we do this here, rather than at startup, is that we
+    // can leak a bootstrap service entry if this method is called and
+    // there never ends up being a crash.
+    inspector_.LaunchOnDemand();
+    gBreakpadAllocator->Protect();
+  }
 
   // The Inspector should send a message to this port to verify it
   // received our information and has finished the inspection.
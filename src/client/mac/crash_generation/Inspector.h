@@ -37,13 +37,15 @@
 
 #import "client/mac/crash_generation/ConfigFile.h"
 #import "client/mac/handler/minidump_generator.h"
+#import "common/mac/MachIPC.h"
 
 
 // Types of mach messsages (message IDs)
 enum {
   kMsgType_InspectorInitialInfo = 0,    // data is InspectorInfo
   kMsgType_InspectorKeyValuePair = 1,   // data is KeyValueMessageData
-  kMsgType_InspectorAcknowledgement = 2 // no data sent
+  kMsgType_InspectorAcknowledgement = 2, // no data sent
+  kMsgType_InspectorPrelaunch = 3       // data is InspectorPrelaunchInfo
 };
 
 // Initial information sent from the crashed process by
@@ -58,6 +60,13 @@ struct InspectorInfo {
   unsigned int  parameter_count;  // key-value pairs
 };
 
+// Sent by Breakpad.framework at initialization time when the Inspector is
+// prelaunched. The Inspector then waits for kMsgType_InspectorInitialInfo
+// until the crash happens or the process exits.
+struct InspectorPrelaunchInfo {
+  pid_t         pid;
+};
+
 // Key/value message data to be sent to the Inspector
 struct KeyValueMessageData {
  public:
@@ -111,7 +120,7 @@ class MinidumpLocation {
 //=============================================================================
 class Inspector {
  public:
-  Inspector() {}
+  Inspector() : prelaunch_pid_(0) {}
 
   // given a bootstrap service name, receives mach messages
   // from a crashed process, then inspects it, creates a minidump file
@@ -136,6 +145,12 @@ class Inspector {
 
   kern_return_t   ReadMessages();
 
+  // Waits for the initial crash message. If the Inspector was prelaunched,
+  // this waits until the crash happens, and returns MACH_RCV_TIMED_OUT once
+  // the prelaunching process has exited without crashing.
+  kern_return_t   WaitForInitialInfo(ReceivePort* receive_port,
+                                     MachReceiveMessage* message);
+
   bool            InspectTask();
   kern_return_t   SendAcknowledgement();
 
@@ -152,6 +167,7 @@ class Inspector {
   mach_port_t     crashing_thread_;
   mach_port_t     handler_thread_;
   mach_port_t     ack_port_;
+  pid_t           prelaunch_pid_;  // 0 unless prelaunched
 
   SimpleStringDictionary config_params_;
 
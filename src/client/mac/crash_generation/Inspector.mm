@@ -30,8 +30,10 @@
 // Utility that can inspect another process and write a crash dump
 
 #include <cstdio>
+#include <errno.h>
 #include <iostream>
 #include <servers/bootstrap.h>
+#include <signal.h>
 #include <stdio.h>
 #include <string.h>
 #include <string>
@@ -91,6 +93,9 @@ void Inspector::Inspect(const char* receive_port_name) {
       if (exception_code_) {
         ServiceCheckOut(receive_port_name);
       }
+    } else if (prelaunch_pid_ && result == MACH_RCV_TIMED_OUT) {
+      // The process that prelaunched us exited without crashing.
+      ServiceCheckOut(receive_port_name);
     } else {
         PRINT_MACH_RESULT(result, "Inspector: WaitForMessage()");
     }
@@ -195,7 +200,7 @@ kern_return_t Inspector::ReadMessages() {
   ReceivePort receive_port(service_rcv_port_);
 
   MachReceiveMessage message;
-  kern_return_t result = receive_port.WaitForMessage(&message, 1000);
+  kern_return_t result = WaitForInitialInfo(&receive_port, &message);
 
   if (result == KERN_SUCCESS) {
     InspectorInfo& info = (InspectorInfo&)*message.GetData();
@@ -262,6 +267,32 @@ kern_return_t Inspector::ReadMessages() {
   return result;
 }
 
+//=============================================================================
+kern_return_t Inspector::WaitForInitialInfo(ReceivePort* receive_port,
+                                            MachReceiveMessage* message) {
+  kern_return_t result = receive_port->WaitForMessage(message, 1000);
+
+  if (result != KERN_SUCCESS ||
+      message->GetMessageID() != kMsgType_InspectorPrelaunch) {
+    return result;
+  }
+
+  prelaunch_pid_ = ((InspectorPrelaunchInfo&)*message->GetData()).pid;
+
+#if VERBOSE
+  printf("prelaunched by pid %d\n", prelaunch_pid_);
+#endif
+
+  // Wake up once a second to find out whether the process is still alive;
+  // if it exits normally nobody will ever send the crash message.
+  do {
+    result = receive_port->WaitForMessage(message, 1000);
+  } while (result == MACH_RCV_TIMED_OUT &&
+           (kill(prelaunch_pid_, 0) == 0 || errno != ESRCH));
+
+  return result;
+}
+
 //=============================================================================
 bool Inspector::InspectTask() {
   // keep the task quiet while we're looking at it
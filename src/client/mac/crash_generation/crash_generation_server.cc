@@ -29,9 +29,12 @@
 
 #include "client/mac/crash_generation/crash_generation_server.h"
 
+#include <errno.h>
 #include <pthread.h>
+#include <signal.h>
 
 #include "client/mac/crash_generation/client_info.h"
+#include "client/mac/handler/dynamic_images.h"
 #include "client/mac/handler/minidump_generator.h"
 #include "common/mac/scoped_task_suspend-inl.h"
 
@@ -63,6 +66,11 @@ CrashGenerationServer::CrashGenerationServer(
 CrashGenerationServer::~CrashGenerationServer() {
   if (started_)
     Stop();
+
+  for (std::map<pid_t, DynamicImages*>::iterator it = client_images_.begin();
+       it != client_images_.end(); ++it) {
+    delete it->second;
+  }
 }
 
 bool CrashGenerationServer::Start() {
@@ -119,7 +127,9 @@ bool CrashGenerationServer::WaitForOneMessage() {
         if (generate_dumps_ && (!filter_ || filter_(filter_context_))) {
           ScopedTaskSuspend suspend(remote_task);
 
-          MinidumpGenerator generator(remote_task, handler_thread);
+          MinidumpGenerator generator(
+              remote_task, handler_thread,
+              GetClientImages(remote_pid, remote_task));
           dump_path = generator.UniqueNameInDirectory(dump_dir_, NULL);
         
           if (info.exception_type && info.exception_code) {
@@ -163,4 +173,29 @@ bool CrashGenerationServer::WaitForOneMessage() {
   return true;
 }
 
+DynamicImages* CrashGenerationServer::GetClientImages(
+    pid_t remote_pid,
+    mach_port_t remote_task) {
+  for (std::map<pid_t, DynamicImages*>::iterator it = client_images_.begin();
+       it != client_images_.end();) {
+    if (it->first != remote_pid && kill(it->first, 0) == -1 &&
+        errno == ESRCH) {
+      delete it->second;
+      client_images_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+
+  DynamicImages*& images = client_images_[remote_pid];
+  if (images && images->GetTask() == remote_task) {
+    images->Refresh();
+  } else {
+    // Either a new client, or a new process reusing an old client's pid.
+    delete images;
+    images = new DynamicImages(remote_task);
+  }
+  return images;
+}
+
 }  // namespace google_breakpad
@@ -31,7 +31,9 @@
 #define GOOGLE_BREAKPAD_CLIENT_MAC_CRASH_GENERATION_CRASH_GENERATION_SERVER_H_
 
 #include <stdint.h>
+#include <sys/types.h>
 
+#include <map>
 #include <string>
 
 #include "common/mac/MachIPC.h"
@@ -39,6 +41,7 @@
 namespace google_breakpad {
 
 class ClientInfo;
+class DynamicImages;
 
 // Messages the server can read via its mach port
 enum {
@@ -115,6 +118,11 @@ class CrashGenerationServer {
   // if a quit message was received or if an error occurred.
   bool WaitForOneMessage();
 
+  // Return the images loaded in the suspended task remote_task of the
+  // client remote_pid, reusing what was read for an earlier dump of the
+  // same client, and forget the clients that have since exited.
+  DynamicImages* GetClientImages(pid_t remote_pid, mach_port_t remote_task);
+
   FilterCallback filter_;
   void* filter_context_;
 
@@ -140,6 +148,11 @@ class CrashGenerationServer {
   // The thread that waits on the receive port.
   pthread_t server_thread_;
 
+  // The images loaded in each client a dump has been written for, so a
+  // client that asks for several dumps has its images read only once.
+  // Only touched on server_thread_.
+  std::map<pid_t, DynamicImages*> client_images_;
+
   // Disable copy constructor and operator=.
   CrashGenerationServer(const CrashGenerationServer&);
   CrashGenerationServer& operator=(const CrashGenerationServer&);
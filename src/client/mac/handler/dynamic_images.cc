@@ -44,6 +44,7 @@ extern "C" { // needed to compile on Leopard
 #include <unistd.h>
 
 #include <algorithm>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -212,6 +213,49 @@ kern_return_t ReadTaskMemory(task_port_t target_task,
   return KERN_SUCCESS;
 }
 
+//==============================================================================
+// Reads sizes[i] bytes at addresses[i], for each i, from another task into
+// (*contents)[i], making one call into the kernel for up to
+// VM_MAP_ENTRY_MAX ranges.  (*contents)[i] is left empty if sizes[i] is
+// zero or the range can't be read.
+static void ReadTaskMemoryList(task_port_t target_task,
+                               const vector<uint64_t>& addresses,
+                               const vector<size_t>& sizes,
+                               vector<vector<uint8_t> >* contents) {
+  const mach_vm_address_t page_mask = getpagesize() - 1;
+  contents->clear();
+  contents->resize(addresses.size());
+
+  for (size_t start = 0; start < addresses.size(); start += VM_MAP_ENTRY_MAX) {
+    const size_t count = std::min(addresses.size() - start,
+                                  static_cast<size_t>(VM_MAP_ENTRY_MAX));
+    mach_vm_read_entry_t entries;
+    for (size_t i = 0; i < count; ++i) {
+      const mach_vm_address_t address = addresses[start + i];
+      entries[i].address = address & ~page_mask;
+      entries[i].size = sizes[start + i] == 0 ? 0 :
+          ((address + sizes[start + i] + page_mask) & ~page_mask) -
+          entries[i].address;
+    }
+
+    // The kernel reads every range it can, zeroing the entries of those it
+    // can't, and returns the last error; the entries tell the whole story.
+    mach_vm_read_list(target_task, entries, static_cast<natural_t>(count));
+
+    for (size_t i = 0; i < count; ++i) {
+      if (entries[i].address == 0 || entries[i].size == 0)
+        continue;
+      const uint8_t* local_start =
+          reinterpret_cast<const uint8_t*>(entries[i].address);
+      const size_t offset = addresses[start + i] & page_mask;
+      (*contents)[start + i].assign(local_start + offset,
+                                    local_start + offset + sizes[start + i]);
+      mach_vm_deallocate(mach_task_self(), entries[i].address,
+                         entries[i].size);
+    }
+  }
+}
+
 #pragma mark -
 
 //==============================================================================
@@ -445,14 +489,70 @@ void ReadImageInfo(DynamicImages& images,
 
     dyld_image_info* infoArray =
         reinterpret_cast<dyld_image_info*>(&dyld_info_array_bytes[0]);
+
+    // Keep the images already read that are still loaded at the same
+    // address from the same path, and read only the others.
+    std::map<uint64_t, DynamicImage*> previous_images;
+    for (int i = 0; i < images.GetImageCount(); ++i) {
+      DynamicImage* image = images.image_list_[i];
+      previous_images[image->GetLoadAddress()] = image;
+    }
+    images.image_list_.clear();
     images.image_list_.reserve(count);
 
+    vector<dyld_image_info*> new_infos;
     for (int i = 0; i < count; ++i) {
       dyld_image_info& info = infoArray[i];
+      std::map<uint64_t, DynamicImage*>::iterator previous =
+          previous_images.find(info.load_address_);
+      if (previous != previous_images.end() &&
+          previous->second->file_path_address_ == info.file_path_ &&
+          previous->second->GetModDate() ==
+              static_cast<uintptr_t>(info.file_mod_date_)) {
+        images.image_list_.push_back(DynamicImageRef(previous->second));
+        previous_images.erase(previous);
+      } else {
+        new_infos.push_back(&info);
+      }
+    }
+    for (std::map<uint64_t, DynamicImage*>::iterator it =
+             previous_images.begin();
+         it != previous_images.end(); ++it) {
+      delete it->second;
+    }
 
-      // First read just the mach_header from the image in the task.
-      vector<uint8_t> mach_header_bytes;
-      if (ReadTaskMemory(images.task_,
+    // Read the first page of each new image, which almost always holds the
+    // mach_header and all of the load commands, and the rest of the page
+    // holding each file name, all at once.  Whatever doesn't fit is read
+    // separately below.
+    const size_t page_size = getpagesize();
+    vector<uint64_t> addresses;
+    vector<size_t> sizes;
+    for (size_t i = 0; i < new_infos.size(); ++i) {
+      addresses.push_back(new_infos[i]->load_address_);
+      sizes.push_back(page_size);
+    }
+    vector<vector<uint8_t> > header_contents;
+    ReadTaskMemoryList(images.task_, addresses, sizes, &header_contents);
+
+    addresses.clear();
+    sizes.clear();
+    for (size_t i = 0; i < new_infos.size(); ++i) {
+      const uint64_t file_path_address = new_infos[i]->file_path_;
+      addresses.push_back(file_path_address);
+      sizes.push_back(file_path_address ?
+          std::min(page_size - (file_path_address & (page_size - 1)),
+                   static_cast<size_t>(kMaxStringLength)) : 0);
+    }
+    vector<vector<uint8_t> > file_path_contents;
+    ReadTaskMemoryList(images.task_, addresses, sizes, &file_path_contents);
+
+    for (size_t i = 0; i < new_infos.size(); ++i) {
+      dyld_image_info& info = *new_infos[i];
+
+      vector<uint8_t>& mach_header_bytes = header_contents[i];
+      if (mach_header_bytes.size() < sizeof(mach_header_type) &&
+          ReadTaskMemory(images.task_,
                          info.load_address_,
                          sizeof(mach_header_type),
                          mach_header_bytes) != KERN_SUCCESS)
@@ -466,7 +566,8 @@ void ReadImageInfo(DynamicImages& images,
       size_t header_size =
           sizeof(mach_header_type) + header->sizeofcmds;
 
-      if (ReadTaskMemory(images.task_,
+      if (mach_header_bytes.size() < header_size &&
+          ReadTaskMemory(images.task_,
                          info.load_address_,
                          header_size,
                          mach_header_bytes) != KERN_SUCCESS)
@@ -475,10 +576,20 @@ void ReadImageInfo(DynamicImages& images,
       // Read the file name from the task's memory space.
       string file_path;
       if (info.file_path_) {
-        // Although we're reading kMaxStringLength bytes, it's copied in the
-        // the DynamicImage constructor below with the correct string length,
-        // so it's not really wasting memory.
-        file_path = ReadTaskString(images.task_, info.file_path_);
+        const vector<uint8_t>& file_path_bytes = file_path_contents[i];
+        const void* terminator = file_path_bytes.empty() ? NULL :
+            memchr(&file_path_bytes[0], '\0', file_path_bytes.size());
+        if (terminator) {
+          file_path.assign(
+              reinterpret_cast<const char*>(&file_path_bytes[0]),
+              reinterpret_cast<const uint8_t*>(terminator) -
+                  &file_path_bytes[0]);
+        } else {
+          // Although we're reading kMaxStringLength bytes, it's copied in
+          // the DynamicImage constructor below with the correct string
+          // length, so it's not really wasting memory.
+          file_path = ReadTaskString(images.task_, info.file_path_);
+        }
       }
 
       // Create an object representing this image and add it to our list.
@@ -490,6 +601,7 @@ void ReadImageInfo(DynamicImages& images,
                                    static_cast<uintptr_t>(info.file_mod_date_),
                                    images.task_,
                                    images.cpu_type_);
+      new_image->file_path_address_ = info.file_path_;
 
       if (new_image->IsValid()) {
         images.image_list_.push_back(DynamicImageRef(new_image));
@@ -98,9 +98,13 @@ typedef segment_command breakpad_mach_segment_command;
 
 // Helper functions to deal with 32-bit/64-bit Mach-O differences.
 class DynamicImage;
+class DynamicImages;
 template<typename MachBits>
 bool FindTextSection(DynamicImage& image);
 
+template<typename MachBits>
+void ReadImageInfo(DynamicImages& images, uint64_t image_list_address);
+
 template<typename MachBits>
 uint32_t GetFileTypeFromHeader(DynamicImage& image);
 
@@ -124,6 +128,7 @@ class DynamicImage {
       version_(0),
       file_path_(file_path),
       file_mod_date_(image_mod_date),
+      file_path_address_(0),
       task_(task),
       cpu_type_(cpu_type) {
     CalculateMemoryAndVersionInfo();
@@ -179,6 +184,9 @@ class DynamicImage {
   friend bool FindTextSection(DynamicImage& image);
   template<typename MachBits>
   friend uint32_t GetFileTypeFromHeader(DynamicImage& image);
+  template<typename MachBits>
+  friend void ReadImageInfo(DynamicImages& images,
+                            uint64_t image_list_address);
 
   // Initializes vmaddr_, vmsize_, and slide_
   void CalculateMemoryAndVersionInfo();
@@ -192,6 +200,7 @@ class DynamicImage {
   uint32_t                version_;        // Dylib version
   string                  file_path_;     // path dyld used to load the image
   uintptr_t               file_mod_date_;  // time_t of image file
+  uint64_t                file_path_address_;  // file_path_ in task_
 
   mach_port_t             task_;
   cpu_type_t              cpu_type_;        // CPU type of task_
@@ -228,11 +237,6 @@ class DynamicImageRef {
   DynamicImage* p;
 };
 
-// Helper function to deal with 32-bit/64-bit Mach-O differences.
-class DynamicImages;
-template<typename MachBits>
-void ReadImageInfo(DynamicImages& images, uint64_t image_list_address);
-
 //==============================================================================
 // An object of type DynamicImages may be created to allow introspection of
 // an arbitrary task's dynamically loaded mach-o binaries.  This makes the
@@ -247,6 +251,11 @@ class DynamicImages {
     }
   }
 
+  // Re-reads the list of images loaded in the task.  Images still loaded
+  // at the same address from the same path are kept rather than read
+  // again, so this is much cheaper than reading a new DynamicImages.
+  void Refresh() { ReadImageInfoForTask(); }
+
   // Returns the number of dynamically loaded mach-o images.
   int GetImageCount() const {return static_cast<int>(image_list_.size());}
 
@@ -245,6 +245,10 @@ ExceptionHandler::ExceptionHandler(const string& dump_path,
   if (port_name)
     crash_generation_client_.reset(new CrashGenerationClient(port_name));
 #endif
+  // Dumps written in this process copy the module list kept up to date as
+  // images are loaded, rather than building it while handling a crash.
+  if (!IsOutOfProcess())
+    LoadedImageTracker::Start();
   Setup(install_handler);
 }
 
@@ -39,6 +39,8 @@
 #define mach_vm_address_t vm_address_t
 #define mach_vm_deallocate vm_deallocate
 #define mach_vm_read vm_read
+#define mach_vm_read_entry_t vm_read_entry_t
+#define mach_vm_read_list vm_read_list
 #define mach_vm_region_recurse vm_region_recurse_64
 #define mach_vm_size_t vm_size_t
 #else
@@ -33,6 +33,7 @@
 #include <mach/host_info.h>
 #include <mach/machine.h>
 #include <mach/vm_statistics.h>
+#include <dlfcn.h>
 #include <mach-o/dyld.h>
 #include <mach-o/loader.h>
 #include <sys/sysctl.h>
@@ -68,6 +69,103 @@ namespace google_breakpad {
 #define LC_SEGMENT_ARCH LC_SEGMENT
 #endif
 
+pthread_once_t LoadedImageTracker::once_ = PTHREAD_ONCE_INIT;
+LoadedImageTracker* LoadedImageTracker::tracker_ = NULL;
+
+LoadedImageTracker::LoadedImageTracker() {
+  pthread_mutex_init(&mutex_, NULL);
+}
+
+// static
+LoadedImageTracker* LoadedImageTracker::Start() {
+  pthread_once(&once_, Create);
+  return tracker_;
+}
+
+// static
+void LoadedImageTracker::Create() {
+  tracker_ = new LoadedImageTracker();
+  _dyld_register_func_for_add_image(ImageAdded);
+  _dyld_register_func_for_remove_image(ImageRemoved);
+}
+
+// static
+void LoadedImageTracker::ImageAdded(const struct mach_header* header,
+                                    intptr_t slide) {
+  const breakpad_mach_header* image_header =
+      reinterpret_cast<const breakpad_mach_header*>(header);
+#ifdef __LP64__
+  if (image_header->magic != MH_MAGIC_64)
+    return;
+#else
+  if (image_header->magic != MH_MAGIC)
+    return;
+#endif
+
+  Image image;
+  memset(&image.module, 0, sizeof(image.module));
+  const struct load_command* cmd =
+      reinterpret_cast<const struct load_command*>(image_header + 1);
+  for (unsigned int i = 0; i < image_header->ncmds; ++i) {
+    if (cmd->cmd == LC_SEGMENT_ARCH) {
+      const breakpad_mach_segment_command* seg =
+          reinterpret_cast<const breakpad_mach_segment_command*>(cmd);
+      if (!strcmp(seg->segname, "__TEXT")) {
+        image.module.base_of_image = seg->vmaddr + slide;
+        image.module.size_of_image = static_cast<uint32_t>(seg->vmsize);
+        break;
+      }
+    }
+    cmd = reinterpret_cast<const struct load_command*>(
+        reinterpret_cast<const char*>(cmd) + cmd->cmdsize);
+  }
+  if (!image.module.base_of_image)
+    return;
+
+  Dl_info info;
+  image.header = header;
+  image.path = dladdr(header, &info) && info.dli_fname ? info.dli_fname : "";
+  image.cpu_type = image_header->cputype;
+  image.is_executable = image_header->filetype == MH_EXECUTE;
+
+  MacFileUtilities::MachoID macho(image.path.c_str(),
+      reinterpret_cast<void*>(image.module.base_of_image),
+      static_cast<size_t>(image.module.size_of_image));
+  image.has_identifier = macho.UUIDCommand(image.cpu_type,
+                                           CPU_SUBTYPE_MULTIPLE,
+                                           image.identifier);
+#if TARGET_OS_IPHONE
+  if (!image.has_identifier) {
+    image.has_identifier = macho.MD5(image.cpu_type, CPU_SUBTYPE_MULTIPLE,
+                                     image.identifier);
+  }
+#endif
+  if (!image.has_identifier && !image.path.empty()) {
+    FileID file_id(image.path.c_str());
+    image.has_identifier = file_id.MachoIdentifier(image.cpu_type,
+                                                   CPU_SUBTYPE_MULTIPLE,
+                                                   image.identifier);
+  }
+
+  pthread_mutex_lock(&tracker_->mutex_);
+  tracker_->images_.push_back(image);
+  pthread_mutex_unlock(&tracker_->mutex_);
+}
+
+// static
+void LoadedImageTracker::ImageRemoved(const struct mach_header* header,
+                                      intptr_t slide) {
+  pthread_mutex_lock(&tracker_->mutex_);
+  for (std::vector<Image>::iterator it = tracker_->images_.begin();
+       it != tracker_->images_.end(); ++it) {
+    if (it->header == header) {
+      tracker_->images_.erase(it);
+      break;
+    }
+  }
+  pthread_mutex_unlock(&tracker_->mutex_);
+}
+
 // constructor when generating from within the crashed process
 MinidumpGenerator::MinidumpGenerator()
     : writer_(),
@@ -80,6 +178,7 @@ MinidumpGenerator::MinidumpGenerator()
       cpu_type_(DynamicImages::GetNativeCPUType()),
       task_context_(NULL),
       dynamic_images_(NULL),
+      owns_dynamic_images_(true),
       memory_blocks_(&allocator_) {
   GatherSystemInformation();
 }
@@ -98,6 +197,7 @@ MinidumpGenerator::MinidumpGenerator(mach_port_t crashing_task,
       cpu_type_(DynamicImages::GetNativeCPUType()),
       task_context_(NULL),
       dynamic_images_(NULL),
+      owns_dynamic_images_(true),
       memory_blocks_(&allocator_) {
   if (crashing_task != mach_task_self()) {
     dynamic_images_ = new DynamicImages(crashing_task_);
@@ -110,8 +210,30 @@ MinidumpGenerator::MinidumpGenerator(mach_port_t crashing_task,
   GatherSystemInformation();
 }
 
+// constructor when generating from a different process than the
+// crashed process, with its images already read
+MinidumpGenerator::MinidumpGenerator(mach_port_t crashing_task,
+                                     mach_port_t handler_thread,
+                                     DynamicImages* dynamic_images)
+    : writer_(),
+      exception_type_(0),
+      exception_code_(0),
+      exception_subcode_(0),
+      exception_thread_(0),
+      crashing_task_(crashing_task),
+      handler_thread_(handler_thread),
+      cpu_type_(dynamic_images ? dynamic_images->GetCPUType() :
+                                 DynamicImages::GetNativeCPUType()),
+      task_context_(NULL),
+      dynamic_images_(dynamic_images),
+      owns_dynamic_images_(false),
+      memory_blocks_(&allocator_) {
+  GatherSystemInformation();
+}
+
 MinidumpGenerator::~MinidumpGenerator() {
-  delete dynamic_images_;
+  if (owns_dynamic_images_)
+    delete dynamic_images_;
 }
 
 char MinidumpGenerator::build_string_[16];
@@ -1421,6 +1543,30 @@ int MinidumpGenerator::FindExecutableModule() {
 
 bool MinidumpGenerator::WriteCVRecord(MDRawModule* module, int cpu_type,
                                       const char* module_path, bool in_memory) {
+  // Get the module identifier
+  unsigned char identifier[16];
+  bool result = false;
+  if (in_memory) {
+    MacFileUtilities::MachoID macho(module_path,
+        reinterpret_cast<void*>(module->base_of_image),
+        static_cast<size_t>(module->size_of_image));
+    result = macho.UUIDCommand(cpu_type, CPU_SUBTYPE_MULTIPLE, identifier);
+    if (!result)
+      result = macho.MD5(cpu_type, CPU_SUBTYPE_MULTIPLE, identifier);
+  }
+
+  if (!result) {
+     FileID file_id(module_path);
+     result = file_id.MachoIdentifier(cpu_type, CPU_SUBTYPE_MULTIPLE,
+                                      identifier);
+  }
+
+  return WriteCVRecord(module, module_path, result ? identifier : NULL);
+}
+
+bool MinidumpGenerator::WriteCVRecord(MDRawModule* module,
+                                      const char* module_path,
+                                      const unsigned char* identifier) {
   TypedMDRVA<MDCVInfoPDB70> cv(&writer_);
 
   // Only return the last path component of the full module path
@@ -1445,25 +1591,7 @@ bool MinidumpGenerator::WriteCVRecord(MDRawModule* module, int cpu_type,
   cv_ptr->cv_signature = MD_CVINFOPDB70_SIGNATURE;
   cv_ptr->age = 0;
 
-  // Get the module identifier
-  unsigned char identifier[16];
-  bool result = false;
-  if (in_memory) {
-    MacFileUtilities::MachoID macho(module_path,
-        reinterpret_cast<void*>(module->base_of_image),
-        static_cast<size_t>(module->size_of_image));
-    result = macho.UUIDCommand(cpu_type, CPU_SUBTYPE_MULTIPLE, identifier);
-    if (!result)
-      result = macho.MD5(cpu_type, CPU_SUBTYPE_MULTIPLE, identifier);
-  }
-
-  if (!result) {
-     FileID file_id(module_path);
-     result = file_id.MachoIdentifier(cpu_type, CPU_SUBTYPE_MULTIPLE,
-                                      identifier);
-  }
-
-  if (result) {
+  if (identifier) {
     cv_ptr->signature.data1 =
         static_cast<uint32_t>(identifier[0]) << 24 |
         static_cast<uint32_t>(identifier[1]) << 16 |
@@ -1488,6 +1616,13 @@ bool MinidumpGenerator::WriteCVRecord(MDRawModule* module, int cpu_type,
 
 bool MinidumpGenerator::WriteModuleListStream(
     MDRawDirectory* module_list_stream) {
+  LoadedImageTracker* tracker = LoadedImageTracker::Get();
+  if (!dynamic_images_ && tracker && tracker->TryLock()) {
+    bool result = WriteTrackedModuleListStream(*tracker, module_list_stream);
+    tracker->Unlock();
+    return result;
+  }
+
   TypedMDRVA<MDRawModuleList> list(&writer_);
 
   uint32_t image_count = dynamic_images_ ?
@@ -1525,6 +1660,49 @@ bool MinidumpGenerator::WriteModuleListStream(
   return true;
 }
 
+bool MinidumpGenerator::WriteTrackedModuleListStream(
+    const LoadedImageTracker& tracker,
+    MDRawDirectory* module_list_stream) {
+  const std::vector<LoadedImageTracker::Image>& images = tracker.images();
+  TypedMDRVA<MDRawModuleList> list(&writer_);
+
+  if (!list.AllocateObjectAndArray(images.size(), MD_MODULE_SIZE))
+    return false;
+
+  module_list_stream->stream_type = MD_MODULE_LIST_STREAM;
+  module_list_stream->location = list.location();
+  list.get()->number_of_modules = static_cast<uint32_t>(images.size());
+
+  // Write out the executable module as the first one, as above.
+  size_t executable_index = 0;
+  for (size_t i = 0; i < images.size(); ++i) {
+    if (images[i].is_executable) {
+      executable_index = i;
+      break;
+    }
+  }
+
+  int destination_index = 1;
+  for (size_t i = 0; i < images.size(); ++i) {
+    const LoadedImageTracker::Image& image = images[i];
+    MDRawModule module = image.module;
+    MDLocationDescriptor string_location;
+    if (!writer_.WriteString(image.path.c_str(), 0, &string_location))
+      return false;
+    module.module_name_rva = string_location.rva;
+
+    if (!WriteCVRecord(&module, image.path.c_str(),
+                       image.has_identifier ? image.identifier : NULL)) {
+      return false;
+    }
+
+    list.CopyIndexAfterObject(i == executable_index ? 0 : destination_index++,
+                              &module, MD_MODULE_SIZE);
+  }
+
+  return true;
+}
+
 bool MinidumpGenerator::WriteMiscInfoStream(MDRawDirectory* misc_info_stream) {
   TypedMDRVA<MDRawMiscInfo> info(&writer_);
 
@@ -33,9 +33,11 @@
 #define CLIENT_MAC_GENERATOR_MINIDUMP_GENERATOR_H__
 
 #include <mach/mach.h>
+#include <pthread.h>
 #include <TargetConditionals.h>
 
 #include <string>
+#include <vector>
 
 #include "client/mac/handler/ucontext_compat.h"
 #include "client/minidump_file_writer.h"
@@ -90,6 +92,56 @@ using std::string;
   REGISTER_FROM_THREADSTATE(a, b[i])
 #endif
 
+// Keeps a module list entry for each image loaded in the current process,
+// maintained from dyld's add and remove image callbacks, so that an
+// in-process dump copies the entries rather than walking every image's
+// load commands and reading its identifier while handling a crash.
+class LoadedImageTracker {
+ public:
+  struct Image {
+    const struct mach_header* header;
+    // base_of_image and size_of_image are filled in; the rest is written
+    // with the dump.
+    MDRawModule module;
+    cpu_type_t cpu_type;
+    bool is_executable;
+    bool has_identifier;
+    unsigned char identifier[16];
+    string path;
+  };
+
+  // Registers the dyld callbacks, which are first called for every image
+  // already loaded, if that hasn't been done yet, and returns the tracker.
+  // The callbacks can't be unregistered, so the tracker is never
+  // destroyed.
+  static LoadedImageTracker* Start();
+
+  // Returns the tracker if Start() has been called, or NULL.
+  static LoadedImageTracker* Get() { return tracker_; }
+
+  // While the dump is written the task's other threads are suspended, and
+  // one of them may be in a dyld callback, so the lock is only tried.
+  // Returns false, and the images must be read from dyld instead, if it is
+  // held.  On success images() may be read until Unlock().
+  bool TryLock() { return pthread_mutex_trylock(&mutex_) == 0; }
+  void Unlock() { pthread_mutex_unlock(&mutex_); }
+
+  const std::vector<Image>& images() const { return images_; }
+
+ private:
+  LoadedImageTracker();
+
+  static void Create();
+  static void ImageAdded(const struct mach_header* header, intptr_t slide);
+  static void ImageRemoved(const struct mach_header* header, intptr_t slide);
+
+  static pthread_once_t once_;
+  static LoadedImageTracker* tracker_;
+
+  pthread_mutex_t mutex_;
+  std::vector<Image> images_;
+};
+
 // Creates a minidump file of the current process.  If there is exception data,
 // use SetExceptionInformation() to add this to the minidump.  The minidump
 // file is generated by the Write() function.
@@ -101,6 +153,11 @@ class MinidumpGenerator {
  public:
   MinidumpGenerator();
   MinidumpGenerator(mach_port_t crashing_task, mach_port_t handler_thread);
+  // As above, but using dynamic_images, which must describe crashing_task
+  // and outlive the generator, rather than reading the task's images anew.
+  // dynamic_images may be NULL when crashing_task is the current task.
+  MinidumpGenerator(mach_port_t crashing_task, mach_port_t handler_thread,
+                    DynamicImages* dynamic_images);
 
   virtual ~MinidumpGenerator();
 
@@ -161,6 +218,10 @@ class MinidumpGenerator {
                     MDLocationDescriptor* register_location);
   bool WriteCVRecord(MDRawModule* module, int cpu_type,
                      const char* module_path, bool in_memory);
+  bool WriteCVRecord(MDRawModule* module, const char* module_path,
+                     const unsigned char* identifier);
+  bool WriteTrackedModuleListStream(const LoadedImageTracker& tracker,
+                                    MDRawDirectory* module_list_stream);
   bool WriteModuleStream(unsigned int index, MDRawModule* module);
   size_t CalculateStackSize(mach_vm_address_t start_addr);
   int  FindExecutableModule();
@@ -237,6 +298,9 @@ class MinidumpGenerator {
   // Information about dynamically loaded code
   DynamicImages* dynamic_images_;
 
+  // Whether dynamic_images_ is deleted with the generator.
+  bool owns_dynamic_images_;
+
   // PageAllocator makes it possible to allocate memory
   // directly from the system, even while handling an exception.
   mutable PageAllocator allocator_;
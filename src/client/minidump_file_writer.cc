@@ -36,6 +36,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#if defined(__linux__) && __linux__
+#include <errno.h>
+#include <sys/sendfile.h>
+#endif
 
 #include "client/minidump_file_writer-inl.h"
 #include "common/linux/linux_libc_support.h"
@@ -85,6 +89,111 @@ bool NeedsFTruncateWorkAround() {
 }  // namespace
 #endif  // defined(__ANDROID__)
 
+#if defined(__linux__) && __linux__
+namespace {
+
+// The hash table CompressBlock() uses to find matches has
+// 1 << kCompressionHashLog entries.
+const int kCompressionHashLog = 12;
+const size_t kCompressionTableSize = sizeof(uint32_t) << kCompressionHashLog;
+
+inline uint32_t Read32(const uint8_t* p) {
+  uint32_t value;
+  my_memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint32_t HashSequence(uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - kCompressionHashLog);
+}
+
+// Writes the part of |length| that doesn't fit in a token, as LZ4 does.
+uint8_t* WriteLength(uint8_t* out, size_t length) {
+  for (; length >= 255; length -= 255)
+    *out++ = 255;
+  *out++ = static_cast<uint8_t>(length);
+  return out;
+}
+
+// Writes a sequence of |literal_length| literals at |literals| followed by
+// a match of |match_length| bytes |offset| bytes back, or by nothing if
+// |match_length| is 0. Returns NULL if it doesn't fit before |out_end|.
+uint8_t* WriteSequence(uint8_t* out, uint8_t* out_end,
+                       const uint8_t* literals, size_t literal_length,
+                       size_t offset, size_t match_length) {
+  const size_t kMinMatch = 4;
+  if (static_cast<size_t>(out_end - out) <
+      1 + literal_length / 255 + 1 + literal_length + 2 +
+      match_length / 255 + 1)
+    return NULL;
+
+  uint8_t* const token = out++;
+  *token = (literal_length < 15 ? literal_length : 15) << 4;
+  if (literal_length >= 15)
+    out = WriteLength(out, literal_length - 15);
+  my_memcpy(out, literals, literal_length);
+  out += literal_length;
+  if (match_length) {
+    *out++ = offset & 0xff;
+    *out++ = offset >> 8;
+    const size_t extra_length = match_length - kMinMatch;
+    *token |= extra_length < 15 ? extra_length : 15;
+    if (extra_length >= 15)
+      out = WriteLength(out, extra_length - 15);
+  }
+  return out;
+}
+
+// Compresses the |size| bytes at |src| into an LZ4 block at |dst|, using
+// |table| of kCompressionTableSize bytes as scratch space. Returns the
+// size of the block, or 0 if it would be larger than |capacity|.
+size_t CompressBlock(const uint8_t* src, size_t size,
+                     uint8_t* dst, size_t capacity, uint32_t* table) {
+  // LZ4 requires matches to start at least 12 bytes before the end of the
+  // block and to end at least 5 bytes before it.
+  const size_t kMinMatch = 4;
+  const size_t kMatchStartMargin = 12;
+  const size_t kLastLiterals = 5;
+
+  my_memset(table, 0, kCompressionTableSize);
+  uint8_t* out = dst;
+  uint8_t* const out_end = dst + capacity;
+  size_t anchor = 0;
+  if (size > kMatchStartMargin) {
+    const size_t match_start_limit = size - kMatchStartMargin;
+    const size_t match_end_limit = size - kLastLiterals;
+    size_t in = 0;
+    while (in < match_start_limit) {
+      const uint32_t sequence = Read32(src + in);
+      const uint32_t hash = HashSequence(sequence);
+      const size_t candidate = table[hash];
+      table[hash] = in;
+      if (candidate >= in || in - candidate > 0xffff ||
+          Read32(src + candidate) != sequence) {
+        ++in;
+        continue;
+      }
+
+      size_t match_length = kMinMatch;
+      while (in + match_length < match_end_limit &&
+             src[candidate + match_length] == src[in + match_length]) {
+        ++match_length;
+      }
+      out = WriteSequence(out, out_end, src + anchor, in - anchor,
+                          in - candidate, match_length);
+      if (!out)
+        return 0;
+      in += match_length;
+      anchor = in;
+    }
+  }
+  out = WriteSequence(out, out_end, src + anchor, size - anchor, 0, 0);
+  return out ? out - dst : 0;
+}
+
+}  // namespace
+#endif  // defined(__linux__) && __linux__
+
 namespace google_breakpad {
 
 const MDRVA MinidumpFileWriter::kInvalidMDRVA = static_cast<MDRVA>(-1);
@@ -93,12 +202,24 @@ MinidumpFileWriter::MinidumpFileWriter()
     : file_(-1),
       close_file_when_destroyed_(true),
       position_(0),
-      size_(0) {
+      size_(0)
+#if defined(__linux__) && __linux__
+      , write_buffer_(NULL),
+      write_buffer_position_(0),
+      write_buffer_used_(0),
+      compress_(false),
+      compressed_buffer_(NULL),
+      compression_table_(NULL),
+      compressed_size_(0)
+#endif
+{
 }
 
 MinidumpFileWriter::~MinidumpFileWriter() {
   if (close_file_when_destroyed_)
     Close();
+  else if (file_ != -1)
+    Flush();
 }
 
 bool MinidumpFileWriter::Open(const char* path) {
@@ -125,12 +246,19 @@ bool MinidumpFileWriter::Close() {
   bool result = true;
 
   if (file_ != -1) {
+    if (!Flush())
+      return false;
+    off_t file_size = position_;
+#if defined(__linux__) && __linux__
+    if (compress_)
+      file_size = compressed_size_;
+#endif
 #if defined(__ANDROID__)
-    if (!NeedsFTruncateWorkAround() && ftruncate(file_, position_)) {
+    if (!NeedsFTruncateWorkAround() && ftruncate(file_, file_size)) {
        return false;
     }
 #else
-    if (ftruncate(file_, position_)) {
+    if (ftruncate(file_, file_size)) {
        return false;
     }
 #endif
@@ -286,6 +414,17 @@ MDRVA MinidumpFileWriter::Allocate(size_t size) {
 #endif
   size_t aligned_size = (size + 7) & ~7;  // 64-bit alignment
 
+#if defined(__linux__) && __linux__
+  if (compress_) {
+    // Nothing is written at |position_| in a compressed file, so there is
+    // no need to grow it.
+    MDRVA current_position = position_;
+    position_ += static_cast<MDRVA>(aligned_size);
+    size_ = position_;
+    return current_position;
+  }
+#endif
+
   if (position_ + aligned_size > size_) {
     size_t growth = aligned_size;
     size_t minimal_growth = getpagesize();
@@ -316,14 +455,52 @@ bool MinidumpFileWriter::Copy(MDRVA position, const void* src, ssize_t size) {
   if (static_cast<size_t>(size + position) > size_)
     return false;
 
-  // Seek and write the data
 #if defined(__linux__) && __linux__
+  if (!write_buffer_) {
+    write_buffer_ =
+        reinterpret_cast<uint8_t*>(allocator_.Alloc(kWriteBufferSize));
+  }
+  if (write_buffer_) {
+    // Copy into the buffer if the data lies within or just after what it
+    // holds and fits.
+    const MDRVA buffer_end = write_buffer_position_ + write_buffer_used_;
+    if (write_buffer_used_ && position >= write_buffer_position_ &&
+        position <= buffer_end &&
+        position - write_buffer_position_ + static_cast<size_t>(size) <=
+            kWriteBufferSize) {
+      const size_t offset = position - write_buffer_position_;
+      my_memcpy(write_buffer_ + offset, src, size);
+      if (offset + size > write_buffer_used_)
+        write_buffer_used_ = offset + size;
+      return true;
+    }
+
+    // Data too large for the buffer that directly follows what it holds
+    // goes out with it.
+    if (write_buffer_used_ && position == buffer_end)
+      return FlushWith(src, size);
+
+    if (!Flush())
+      return false;
+    if (static_cast<size_t>(size) <= kWriteBufferSize) {
+      my_memcpy(write_buffer_, src, size);
+      write_buffer_position_ = position;
+      write_buffer_used_ = size;
+      return true;
+    }
+  }
+
+  if (compress_)
+    return WriteCompressed(position, src, size);
+
+  // Seek and write the data
   if (sys_lseek(file_, position, SEEK_SET) == static_cast<off_t>(position)) {
     if (sys_write(file_, src, size) == size) {
       return true;
     }
   }
 #else
+  // Seek and write the data
   if (lseek(file_, position, SEEK_SET) == static_cast<off_t>(position)) {
     if (write(file_, src, size) == size) {
       return true;
@@ -333,6 +510,153 @@ bool MinidumpFileWriter::Copy(MDRVA position, const void* src, ssize_t size) {
   return false;
 }
 
+bool MinidumpFileWriter::Flush() {
+#if defined(__linux__) && __linux__
+  return FlushWith(NULL, 0);
+#else
+  return true;
+#endif
+}
+
+#if defined(__linux__) && __linux__
+bool MinidumpFileWriter::FlushWith(const void* extra, size_t extra_size) {
+  if (!write_buffer_used_ && !extra_size)
+    return true;
+
+  const MDRVA position = write_buffer_position_;
+  struct kernel_iovec iov[2];
+  iov[0].iov_base = write_buffer_;
+  iov[0].iov_len = write_buffer_used_;
+  iov[1].iov_base = const_cast<void*>(extra);
+  iov[1].iov_len = extra_size;
+  const size_t total = write_buffer_used_ + extra_size;
+  write_buffer_used_ = 0;
+
+  if (compress_) {
+    return WriteCompressed(position, iov[0].iov_base, iov[0].iov_len) &&
+           WriteCompressed(position + iov[0].iov_len, extra, extra_size);
+  }
+
+  if (sys_lseek(file_, position, SEEK_SET) != static_cast<off_t>(position))
+    return false;
+  // Writes to a regular file are only cut short by errors, so a short
+  // writev is as good as a failure.
+  return sys_writev(file_, iov, extra_size ? 2 : 1) ==
+         static_cast<ssize_t>(total);
+}
+
+bool MinidumpFileWriter::WriteFromFile(int fd, MDLocationDescriptor* location) {
+  assert(file_ != -1);
+  if (compress_)
+    return false;
+  if (!write_buffer_) {
+    write_buffer_ =
+        reinterpret_cast<uint8_t*>(allocator_.Alloc(kWriteBufferSize));
+    if (!write_buffer_)
+      return false;
+  }
+  if (!Flush() ||
+      sys_lseek(file_, position_, SEEK_SET) != static_cast<off_t>(position_)) {
+    return false;
+  }
+
+  // The kernel can't send from most of /proc/<pid>, which the first
+  // sendfile() reports before reading anything. The data is then read
+  // through the empty write buffer instead, a buffer at a time. Any other
+  // failure to read just ends the data, as the end of the file does.
+  bool send = true;
+  size_t total = 0;
+  for (;;) {
+    ssize_t count;
+    if (send) {
+      do {
+        count = sendfile(file_, fd, NULL, kWriteBufferSize);
+      } while (count == -1 && errno == EINTR);
+      if (count == -1 && total == 0 && (errno == EINVAL || errno == ENOSYS)) {
+        send = false;
+        continue;
+      }
+    } else {
+      do {
+        count = sys_read(fd, write_buffer_, kWriteBufferSize);
+      } while (count == -1 && errno == EINTR);
+      if (count > 0 && sys_write(file_, write_buffer_, count) != count)
+        return false;
+    }
+    if (count < 1)
+      break;
+    total += count;
+  }
+  if (!total)
+    return false;
+
+  // The data already lies at |position_|, where this allocates its space.
+  UntypedMDRVA data(this);
+  if (!data.Allocate(total))
+    return false;
+  *location = data.location();
+  return true;
+}
+
+bool MinidumpFileWriter::EnableCompression() {
+  assert(file_ != -1);
+  assert(position_ == 0);
+  compressed_buffer_ = reinterpret_cast<uint8_t*>(
+      allocator_.Alloc(MD_COMPRESSED_RECORD_MAX_DATA_SIZE));
+  compression_table_ =
+      reinterpret_cast<uint32_t*>(allocator_.Alloc(kCompressionTableSize));
+  if (!compressed_buffer_ || !compression_table_)
+    return false;
+
+  MDRawCompressedHeader header;
+  header.signature = MD_COMPRESSED_HEADER_SIGNATURE;
+  header.version = MD_COMPRESSED_HEADER_VERSION;
+  if (sys_lseek(file_, 0, SEEK_SET) != 0 ||
+      sys_write(file_, &header, sizeof(header)) !=
+          static_cast<ssize_t>(sizeof(header))) {
+    return false;
+  }
+  compressed_size_ = sizeof(header);
+  compress_ = true;
+  return true;
+}
+
+bool MinidumpFileWriter::WriteCompressed(MDRVA position, const void* src,
+                                         size_t size) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(src);
+  while (size) {
+    const size_t data_size = size < MD_COMPRESSED_RECORD_MAX_DATA_SIZE ?
+        size : MD_COMPRESSED_RECORD_MAX_DATA_SIZE;
+    // Store the data as it is unless compressing it saves something.
+    MDRawCompressedRecord record;
+    record.rva = position;
+    record.data_size = data_size;
+    record.compressed_size = CompressBlock(data, data_size,
+                                           compressed_buffer_, data_size - 1,
+                                           compression_table_);
+
+    struct kernel_iovec iov[2];
+    iov[0].iov_base = &record;
+    iov[0].iov_len = sizeof(record);
+    iov[1].iov_base = record.compressed_size ?
+        compressed_buffer_ : const_cast<uint8_t*>(data);
+    iov[1].iov_len = record.compressed_size ?
+        record.compressed_size : data_size;
+    const size_t total = iov[0].iov_len + iov[1].iov_len;
+    if (sys_lseek(file_, compressed_size_, SEEK_SET) != compressed_size_ ||
+        sys_writev(file_, iov, 2) != static_cast<ssize_t>(total)) {
+      return false;
+    }
+
+    compressed_size_ += total;
+    position += data_size;
+    data += data_size;
+    size -= data_size;
+  }
+  return true;
+}
+#endif
+
 bool UntypedMDRVA::Allocate(size_t size) {
   assert(size_ == 0);
   size_ = size;
@@ -37,6 +37,9 @@
 #include <string>
 
 #include "google_breakpad/common/minidump_format.h"
+#if defined(__linux__) && __linux__
+#include "common/memory_allocator.h"
+#endif
 
 namespace google_breakpad {
 
@@ -111,11 +114,37 @@ public:
 
   // Copies |size| bytes from |src| to |position|
   // Return true on success, or false on failure
+  // On Linux, small copies are gathered in a buffer while they fall within
+  // or just after the data it holds, and written out together; see Flush().
   bool Copy(MDRVA position, const void* src, ssize_t size);
 
+  // Writes out any data Copy() is holding. Close() and the destructor call
+  // this, but a caller that passed its own file to SetFile() should call it
+  // to learn whether the writes succeeded.
+  // Return true on success, or false on failure
+  bool Flush();
+
   // Return the current position for writing to the minidump
   inline MDRVA position() const { return position_; }
 
+#if defined(__linux__) && __linux__
+  // Appends everything that can be read from |fd| to the minidump and sets
+  // |location| to it. The kernel sends it with sendfile() if it can, which
+  // moves it from file to file without copying it through memory, and it
+  // is read and written a buffer at a time otherwise. The data goes to the
+  // end of the minidump before the space for it is allocated, so it ends
+  // up where an allocation made beforehand would have put it.
+  // Returns false if |fd| is empty, the minidump is compressed, or writing
+  // fails.
+  bool WriteFromFile(int fd, MDLocationDescriptor* location);
+
+  // Writes a compressed minidump (see MDRawCompressedHeader) from now on,
+  // compressing each run of data as it is written out. Must be called after
+  // Open() or SetFile(), before anything else is written.
+  // Return true on success, or false on failure
+  bool EnableCompression();
+#endif
+
  private:
   friend class UntypedMDRVA;
 
@@ -136,6 +165,37 @@ public:
   // Current allocated size
   size_t size_;
 
+#if defined(__linux__) && __linux__
+  // Size of the buffer in which Copy() gathers writes.
+  static const size_t kWriteBufferSize = 64 * 1024;
+
+  // Writes the buffered data, followed by |extra_size| bytes at |extra|,
+  // with a single writev, and empties the buffer.
+  bool FlushWith(const void* extra, size_t extra_size);
+
+  // Appends |size| bytes at |src|, destined for |position| in the minidump,
+  // to the compressed file as records of at most
+  // MD_COMPRESSED_RECORD_MAX_DATA_SIZE bytes each.
+  bool WriteCompressed(MDRVA position, const void* src, size_t size);
+
+  // Allocates |write_buffer_| when first needed, so that it comes from
+  // fresh pages even if the heap is corrupt.
+  PageAllocator allocator_;
+
+  // Data copied but not yet written: |write_buffer_used_| bytes, to be
+  // written at |write_buffer_position_|.
+  uint8_t* write_buffer_;
+  MDRVA write_buffer_position_;
+  size_t write_buffer_used_;
+
+  // Whether EnableCompression() was called, the scratch space compression
+  // needs, and the end of the compressed file so far.
+  bool compress_;
+  uint8_t* compressed_buffer_;
+  uint32_t* compression_table_;
+  off_t compressed_size_;
+#endif
+
   // Copy |length| characters from |str| to |mdstring|.  These are distinct
   // because the underlying MDString is a UTF-16 based string.  The wchar_t
   // variant may need to create a MDString that has more characters than the
@@ -66,6 +66,7 @@ class ClientInfo {
   HANDLE dump_requested_handle() const { return dump_requested_handle_; }
   HANDLE dump_generated_handle() const { return dump_generated_handle_; }
   DWORD crash_id() const { return crash_id_; }
+  int dump_count() const { return dump_count_; }
   const CustomClientInfo& custom_client_info() const {
     return custom_client_info_;
   }
@@ -78,6 +79,8 @@ class ClientInfo {
     process_exit_wait_handle_ = value;
   }
 
+  void increment_dump_count() { ++dump_count_; }
+
   // Unregister the dump request wait operation and wait for all callbacks
   // that might already be running to complete before returning.
   void UnregisterDumpRequestWaitAndBlockUntilNoPending();
@@ -167,6 +170,9 @@ class ClientInfo {
   // being dumped.
   DWORD crash_id_;
 
+  // The number of dump requests the server has handled for this client.
+  int dump_count_;
+
   // Disallow copy ctor and operator=.
   ClientInfo(const ClientInfo& client_info);
   ClientInfo& operator=(const ClientInfo& client_info);
@@ -38,10 +38,12 @@
         'client_info.cc',
         'crash_generation_server.cc',
         'minidump_generator.cc',
+        'native_minidump_writer.cc',
         'client_info.h',
         'crash_generation_client.h',
         'crash_generation_server.h',
         'minidump_generator.h',
+        'native_minidump_writer.h',
       ],
       'dependencies': [
         '../breakpad_client.gyp:common'
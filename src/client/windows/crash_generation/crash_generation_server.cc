@@ -31,6 +31,7 @@
 #include <windows.h>
 #include <cassert>
 #include <list>
+#include <vector>
 #include "client/windows/common/auto_critical_section.h"
 #include "common/scoped_ptr.h"
 
@@ -54,9 +55,10 @@ static const DWORD kDumpGeneratedEventAccess = EVENT_MODIFY_STATE |
 // Access flags for the client on the mutex.
 static const DWORD kMutexAccess = SYNCHRONIZE;
 
-// Attribute flags for the pipe.
-static const DWORD kPipeAttr = FILE_FLAG_FIRST_PIPE_INSTANCE |
-                               PIPE_ACCESS_DUPLEX |
+// Attribute flags for the pipe. The first instance is also created with
+// FILE_FLAG_FIRST_PIPE_INSTANCE so that Start fails if another server
+// already owns the pipe name.
+static const DWORD kPipeAttr = PIPE_ACCESS_DUPLEX |
                                FILE_FLAG_OVERLAPPED;
 
 // Mode for the pipe.
@@ -66,9 +68,10 @@ static const DWORD kPipeMode = PIPE_TYPE_MESSAGE |
 
 // For pipe I/O, execute the callback in the wait thread itself,
 // since the callback does very little work. The callback executes
-// the code for one of the states of the server state machine and
-// the code for all of the states perform async I/O and hence
-// finish very quickly.
+// the code for one of the states of a pipe instance's state machine
+// and the code for all of the states perform async I/O and hence
+// finish very quickly. The waits for all pipe instances share the
+// thread pool's wait threads, so instances make progress concurrently.
 static const ULONG kPipeIOThreadFlags = WT_EXECUTEINWAITTHREAD;
 
 // Dump request threads will, most likely, generate dumps. That may
@@ -109,8 +112,6 @@ CrashGenerationServer::CrashGenerationServer(
     const std::wstring* dump_path)
     : pipe_name_(pipe_name),
       pipe_sec_attrs_(pipe_sec_attrs),
-      pipe_(NULL),
-      pipe_wait_handle_(NULL),
       server_alive_handle_(NULL),
       connect_callback_(connect_callback),
       connect_context_(connect_context),
@@ -122,12 +123,16 @@ CrashGenerationServer::CrashGenerationServer(
       upload_context_(upload_context),
       generate_dumps_(generate_dumps),
       pre_fetch_custom_info_(true),
+      use_native_writer_(false),
       dump_path_(dump_path ? *dump_path : L""),
-      server_state_(IPC_SERVER_STATE_UNINITIALIZED),
+      started_(false),
       shutting_down_(false),
-      overlapped_(),
-      client_info_(NULL) {
+      pipe_instance_count_(1),
+      max_concurrent_dumps_(0),
+      active_dumps_(0) {
   InitializeCriticalSection(&sync_);
+  InitializeCriticalSection(&dump_sync_);
+  InitializeCriticalSection(&full_dump_sync_);
 }
 
 // This should never be called from the OnPipeConnected callback.
@@ -149,28 +154,48 @@ CrashGenerationServer::~CrashGenerationServer() {
   // not even from another thread.
 
   // Even if there are no current worker threads running, it is possible that
-  // an I/O request is pending on the pipe right now but not yet done.
-  // In fact, it's very likely this is the case unless we are in an ERROR
-  // state. If we don't wait for the pending I/O to be done, then when the I/O
-  // completes, it may write to invalid memory. AppVerifier will flag this
-  // problem too. So we disconnect from the pipe and then wait for the server
-  // to get into error state so that the pending I/O will fail and get
+  // an I/O request is pending on a pipe instance right now but not yet done.
+  // In fact, it's very likely this is the case unless the instance is in an
+  // ERROR state. If we don't wait for the pending I/O to be done, then when
+  // the I/O completes, it may write to invalid memory. AppVerifier will flag
+  // this problem too. So we disconnect every pipe instance and then wait for
+  // them to get into error state so that the pending I/O will fail and get
   // cleared.
-  DisconnectNamedPipe(pipe_);
+  std::vector<PipeInstance*>::iterator instance_iter;
+  for (instance_iter = pipes_.begin(); instance_iter != pipes_.end();
+       ++instance_iter) {
+    DisconnectNamedPipe((*instance_iter)->pipe);
+  }
   int num_tries = 100;
-  while (num_tries-- && server_state_ != IPC_SERVER_STATE_ERROR) {
-    Sleep(10);
+  for (instance_iter = pipes_.begin(); instance_iter != pipes_.end();
+       ++instance_iter) {
+    while (num_tries > 0 &&
+           (*instance_iter)->state != IPC_SERVER_STATE_ERROR) {
+      Sleep(10);
+      --num_tries;
+    }
   }
 
-  // Unregister wait on the pipe.
-  if (pipe_wait_handle_) {
-    // Wait for already executing callbacks to finish.
-    UnregisterWaitEx(pipe_wait_handle_, INVALID_HANDLE_VALUE);
-  }
+  for (instance_iter = pipes_.begin(); instance_iter != pipes_.end();
+       ++instance_iter) {
+    PipeInstance* instance = *instance_iter;
+
+    // Unregister wait on the pipe.
+    if (instance->wait_handle) {
+      // Wait for already executing callbacks to finish.
+      UnregisterWaitEx(instance->wait_handle, INVALID_HANDLE_VALUE);
+    }
 
-  // Close the pipe to avoid further client connections.
-  if (pipe_) {
-    CloseHandle(pipe_);
+    // Close the pipe to avoid further client connections.
+    if (instance->pipe && instance->pipe != INVALID_HANDLE_VALUE) {
+      CloseHandle(instance->pipe);
+    }
+
+    if (instance->overlapped.hEvent) {
+      CloseHandle(instance->overlapped.hEvent);
+    }
+
+    delete instance;
   }
 
   // Request all ClientInfo objects to unregister all waits.
@@ -201,64 +226,85 @@ CrashGenerationServer::~CrashGenerationServer() {
     CloseHandle(server_alive_handle_);
   }
 
-  if (overlapped_.hEvent) {
-    CloseHandle(overlapped_.hEvent);
-  }
-
+  DeleteCriticalSection(&full_dump_sync_);
+  DeleteCriticalSection(&dump_sync_);
   DeleteCriticalSection(&sync_);
 }
 
 bool CrashGenerationServer::Start() {
-  if (server_state_ != IPC_SERVER_STATE_UNINITIALIZED) {
+  if (started_) {
     return false;
   }
 
-  server_state_ = IPC_SERVER_STATE_INITIAL;
+  started_ = true;
 
   server_alive_handle_ = CreateMutex(NULL, TRUE, NULL);
   if (!server_alive_handle_) {
     return false;
   }
 
+  for (int i = 0; i < pipe_instance_count_; ++i) {
+    PipeInstance* instance = new PipeInstance(this);
+    pipes_.push_back(instance);
+    if (!StartPipeInstance(instance, i == 0)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool CrashGenerationServer::StartPipeInstance(PipeInstance* instance,
+                                              bool first_instance) {
+  instance->state = IPC_SERVER_STATE_INITIAL;
+
   // Event to signal the client connection and pipe reads and writes.
-  overlapped_.hEvent = CreateEvent(NULL,   // Security descriptor.
-                                   TRUE,   // Manual reset.
-                                   FALSE,  // Initially nonsignaled.
-                                   NULL);  // Name.
-  if (!overlapped_.hEvent) {
+  instance->overlapped.hEvent = CreateEvent(NULL,   // Security descriptor.
+                                            TRUE,   // Manual reset.
+                                            FALSE,  // Initially nonsignaled.
+                                            NULL);  // Name.
+  if (!instance->overlapped.hEvent) {
+    instance->state = IPC_SERVER_STATE_ERROR;
     return false;
   }
 
   // Register a callback with the thread pool for the client connection.
-  if (!RegisterWaitForSingleObject(&pipe_wait_handle_,
-                                   overlapped_.hEvent,
+  if (!RegisterWaitForSingleObject(&instance->wait_handle,
+                                   instance->overlapped.hEvent,
                                    OnPipeConnected,
-                                   this,
+                                   instance,
                                    INFINITE,
                                    kPipeIOThreadFlags)) {
+    instance->wait_handle = NULL;
+    instance->state = IPC_SERVER_STATE_ERROR;
     return false;
   }
 
-  pipe_ = CreateNamedPipe(pipe_name_.c_str(),
-                          kPipeAttr,
-                          kPipeMode,
-                          1,
-                          kOutBufferSize,
-                          kInBufferSize,
-                          0,
-                          pipe_sec_attrs_);
-  if (pipe_ == INVALID_HANDLE_VALUE) {
+  DWORD pipe_attr = kPipeAttr;
+  if (first_instance) {
+    pipe_attr |= FILE_FLAG_FIRST_PIPE_INSTANCE;
+  }
+  instance->pipe = CreateNamedPipe(pipe_name_.c_str(),
+                                   pipe_attr,
+                                   kPipeMode,
+                                   pipe_instance_count_,
+                                   kOutBufferSize,
+                                   kInBufferSize,
+                                   0,
+                                   pipe_sec_attrs_);
+  if (instance->pipe == INVALID_HANDLE_VALUE) {
+    instance->pipe = NULL;
+    instance->state = IPC_SERVER_STATE_ERROR;
     return false;
   }
 
   // Kick-start the state machine. This will initiate an asynchronous wait
   // for client connections.
-  if (!SetEvent(overlapped_.hEvent)) {
-    server_state_ = IPC_SERVER_STATE_ERROR;
+  if (!SetEvent(instance->overlapped.hEvent)) {
+    instance->state = IPC_SERVER_STATE_ERROR;
     return false;
   }
 
-  // If we are in error state, it's because we failed to start listening.
   return true;
 }
 
@@ -267,8 +313,8 @@ bool CrashGenerationServer::Start() {
 // in the error state forever. Error state means something
 // that we didn't account for has happened, and it's dangerous
 // to do anything unknowingly.
-void CrashGenerationServer::HandleErrorState() {
-  assert(server_state_ == IPC_SERVER_STATE_ERROR);
+void CrashGenerationServer::HandleErrorState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_ERROR);
 
   // If the server is shutting down anyway, don't clean up
   // here since shut down process will clean up.
@@ -276,19 +322,19 @@ void CrashGenerationServer::HandleErrorState() {
     return;
   }
 
-  if (pipe_wait_handle_) {
-    UnregisterWait(pipe_wait_handle_);
-    pipe_wait_handle_ = NULL;
+  if (instance->wait_handle) {
+    UnregisterWait(instance->wait_handle);
+    instance->wait_handle = NULL;
   }
 
-  if (pipe_) {
-    CloseHandle(pipe_);
-    pipe_ = NULL;
+  if (instance->pipe) {
+    CloseHandle(instance->pipe);
+    instance->pipe = NULL;
   }
 
-  if (overlapped_.hEvent) {
-    CloseHandle(overlapped_.hEvent);
-    overlapped_.hEvent = NULL;
+  if (instance->overlapped.hEvent) {
+    CloseHandle(instance->overlapped.hEvent);
+    instance->overlapped.hEvent = NULL;
   }
 }
 
@@ -297,15 +343,16 @@ void CrashGenerationServer::HandleErrorState() {
 // finishes synchronously, directly go into the CONNECTED state;
 // otherwise go into the CONNECTING state. For any problems, go
 // into the ERROR state.
-void CrashGenerationServer::HandleInitialState() {
-  assert(server_state_ == IPC_SERVER_STATE_INITIAL);
+void CrashGenerationServer::HandleInitialState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_INITIAL);
 
-  if (!ResetEvent(overlapped_.hEvent)) {
-    EnterErrorState();
+  if (!ResetEvent(instance->overlapped.hEvent)) {
+    EnterErrorState(instance);
     return;
   }
 
-  bool success = ConnectNamedPipe(pipe_, &overlapped_) != FALSE;
+  bool success = ConnectNamedPipe(instance->pipe,
+                                  &instance->overlapped) != FALSE;
   DWORD error_code = success ? ERROR_SUCCESS : GetLastError();
 
   // From MSDN, it is not clear that when ConnectNamedPipe is used
@@ -315,15 +362,15 @@ void CrashGenerationServer::HandleInitialState() {
 
   switch (error_code) {
     case ERROR_IO_PENDING:
-      EnterStateWhenSignaled(IPC_SERVER_STATE_CONNECTING);
+      EnterStateWhenSignaled(instance, IPC_SERVER_STATE_CONNECTING);
       break;
 
     case ERROR_PIPE_CONNECTED:
-      EnterStateImmediately(IPC_SERVER_STATE_CONNECTED);
+      EnterStateImmediately(instance, IPC_SERVER_STATE_CONNECTED);
       break;
 
     default:
-      EnterErrorState();
+      EnterErrorState(instance);
       break;
   }
 }
@@ -334,20 +381,20 @@ void CrashGenerationServer::HandleInitialState() {
 // go into the CONNECTED state. If the result indicates I/O is still
 // INCOMPLETE, remain in the CONNECTING state. For any problems,
 // go into the DISCONNECTING state.
-void CrashGenerationServer::HandleConnectingState() {
-  assert(server_state_ == IPC_SERVER_STATE_CONNECTING);
+void CrashGenerationServer::HandleConnectingState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_CONNECTING);
 
   DWORD bytes_count = 0;
-  bool success = GetOverlappedResult(pipe_,
-                                     &overlapped_,
+  bool success = GetOverlappedResult(instance->pipe,
+                                     &instance->overlapped,
                                      &bytes_count,
                                      FALSE) != FALSE;
   DWORD error_code = success ? ERROR_SUCCESS : GetLastError();
 
   if (success) {
-    EnterStateImmediately(IPC_SERVER_STATE_CONNECTED);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_CONNECTED);
   } else if (error_code != ERROR_IO_INCOMPLETE) {
-    EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
   } else {
     // remain in CONNECTING state
   }
@@ -357,16 +404,16 @@ void CrashGenerationServer::HandleConnectingState() {
 // try to issue an asynchronous read from the pipe. If read completes
 // synchronously or if I/O is pending then go into the READING state.
 // For any problems, go into the DISCONNECTING state.
-void CrashGenerationServer::HandleConnectedState() {
-  assert(server_state_ == IPC_SERVER_STATE_CONNECTED);
+void CrashGenerationServer::HandleConnectedState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_CONNECTED);
 
   DWORD bytes_count = 0;
-  memset(&msg_, 0, sizeof(msg_));
-  bool success = ReadFile(pipe_,
-                          &msg_,
-                          sizeof(msg_),
+  memset(&instance->msg, 0, sizeof(instance->msg));
+  bool success = ReadFile(instance->pipe,
+                          &instance->msg,
+                          sizeof(instance->msg),
                           &bytes_count,
-                          &overlapped_) != FALSE;
+                          &instance->overlapped) != FALSE;
   DWORD error_code = success ? ERROR_SUCCESS : GetLastError();
 
   // Note that the asynchronous read issued above can finish before the
@@ -375,9 +422,9 @@ void CrashGenerationServer::HandleConnectedState() {
   // is done, the callback for it would not be executed until the current
   // thread finishes its execution.
   if (success || error_code == ERROR_IO_PENDING) {
-    EnterStateWhenSignaled(IPC_SERVER_STATE_READING);
+    EnterStateWhenSignaled(instance, IPC_SERVER_STATE_READING);
   } else {
-    EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
   }
 }
 
@@ -385,21 +432,21 @@ void CrashGenerationServer::HandleConnectedState() {
 // try to get the result of the async read. If async read is done,
 // go into the READ_DONE state. For any problems, go into the
 // DISCONNECTING state.
-void CrashGenerationServer::HandleReadingState() {
-  assert(server_state_ == IPC_SERVER_STATE_READING);
+void CrashGenerationServer::HandleReadingState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_READING);
 
   DWORD bytes_count = 0;
-  bool success = GetOverlappedResult(pipe_,
-                                     &overlapped_,
+  bool success = GetOverlappedResult(instance->pipe,
+                                     &instance->overlapped,
                                      &bytes_count,
                                      FALSE) != FALSE;
   if (success && bytes_count == sizeof(ProtocolMessage)) {
-    EnterStateImmediately(IPC_SERVER_STATE_READ_DONE);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_READ_DONE);
     return;
   }
 
   assert(!CheckForIOIncomplete(success));
-  EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+  EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
 }
 
 // When the server thread serving the client is in the READ_DONE state,
@@ -408,107 +455,107 @@ void CrashGenerationServer::HandleReadingState() {
 // write the response to the pipe asynchronously. If that succeeds,
 // go into the WRITING state. For any problems, go into the DISCONNECTING
 // state.
-void CrashGenerationServer::HandleReadDoneState() {
-  assert(server_state_ == IPC_SERVER_STATE_READ_DONE);
+void CrashGenerationServer::HandleReadDoneState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_READ_DONE);
 
-  if (!IsClientRequestValid(msg_)) {
-    EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+  if (!IsClientRequestValid(instance->msg)) {
+    EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
     return;
   }
 
-  if (msg_.tag == MESSAGE_TAG_UPLOAD_REQUEST) {
+  if (instance->msg.tag == MESSAGE_TAG_UPLOAD_REQUEST) {
     if (upload_request_callback_)
-      upload_request_callback_(upload_context_, msg_.id);
-    EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+      upload_request_callback_(upload_context_, instance->msg.id);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
     return;
   }
 
   scoped_ptr<ClientInfo> client_info(
       new ClientInfo(this,
-                     msg_.id,
-                     msg_.dump_type,
-                     msg_.thread_id,
-                     msg_.exception_pointers,
-                     msg_.assert_info,
-                     msg_.custom_client_info));
+                     instance->msg.id,
+                     instance->msg.dump_type,
+                     instance->msg.thread_id,
+                     instance->msg.exception_pointers,
+                     instance->msg.assert_info,
+                     instance->msg.custom_client_info));
 
   if (!client_info->Initialize()) {
-    EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
     return;
   }
 
   // Issues an asynchronous WriteFile call if successful.
   // Iff successful, assigns ownership of the client_info pointer to the server
   // instance, in which case we must be sure not to free it in this function.
-  if (!RespondToClient(client_info.get())) {
-    EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+  if (!RespondToClient(instance, client_info.get())) {
+    EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
     return;
   }
 
   // This is only valid as long as it can be found in the clients_ list
-  client_info_ = client_info.release();
+  instance->client_info = client_info.release();
 
   // Note that the asynchronous write issued by RespondToClient function
   // can finish before  the code below executes. But it is okay to change
   // state after issuing the asynchronous write. This is because even if
   // the asynchronous write is done, the callback for it would not be
   // executed until the current thread finishes its execution.
-  EnterStateWhenSignaled(IPC_SERVER_STATE_WRITING);
+  EnterStateWhenSignaled(instance, IPC_SERVER_STATE_WRITING);
 }
 
 // When the server thread serving the clients is in the WRITING state,
 // try to get the result of the async write. If the async write is done,
 // go into the WRITE_DONE state. For any problems, go into the
 // DISONNECTING state.
-void CrashGenerationServer::HandleWritingState() {
-  assert(server_state_ == IPC_SERVER_STATE_WRITING);
+void CrashGenerationServer::HandleWritingState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_WRITING);
 
   DWORD bytes_count = 0;
-  bool success = GetOverlappedResult(pipe_,
-                                     &overlapped_,
+  bool success = GetOverlappedResult(instance->pipe,
+                                     &instance->overlapped,
                                      &bytes_count,
                                      FALSE) != FALSE;
   if (success) {
-    EnterStateImmediately(IPC_SERVER_STATE_WRITE_DONE);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_WRITE_DONE);
     return;
   }
 
   assert(!CheckForIOIncomplete(success));
-  EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+  EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
 }
 
 // When the server thread serving the clients is in the WRITE_DONE state,
 // try to issue an async read on the pipe. If the read completes synchronously
 // or if I/O is still pending then go into the READING_ACK state. For any
 // issues, go into the DISCONNECTING state.
-void CrashGenerationServer::HandleWriteDoneState() {
-  assert(server_state_ == IPC_SERVER_STATE_WRITE_DONE);
+void CrashGenerationServer::HandleWriteDoneState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_WRITE_DONE);
 
   DWORD bytes_count = 0;
-  bool success = ReadFile(pipe_,
-                           &msg_,
-                           sizeof(msg_),
+  bool success = ReadFile(instance->pipe,
+                           &instance->msg,
+                           sizeof(instance->msg),
                            &bytes_count,
-                           &overlapped_) != FALSE;
+                           &instance->overlapped) != FALSE;
   DWORD error_code = success ? ERROR_SUCCESS : GetLastError();
 
   if (success) {
-    EnterStateImmediately(IPC_SERVER_STATE_READING_ACK);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_READING_ACK);
   } else if (error_code == ERROR_IO_PENDING) {
-    EnterStateWhenSignaled(IPC_SERVER_STATE_READING_ACK);
+    EnterStateWhenSignaled(instance, IPC_SERVER_STATE_READING_ACK);
   } else {
-    EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+    EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
   }
 }
 
 // When the server thread serving the clients is in the READING_ACK state,
 // try to get result of async read. Go into the DISCONNECTING state.
-void CrashGenerationServer::HandleReadingAckState() {
-  assert(server_state_ == IPC_SERVER_STATE_READING_ACK);
+void CrashGenerationServer::HandleReadingAckState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_READING_ACK);
 
   DWORD bytes_count = 0;
-  bool success = GetOverlappedResult(pipe_,
-                                     &overlapped_,
+  bool success = GetOverlappedResult(instance->pipe,
+                                     &instance->overlapped,
                                      &bytes_count,
                                      FALSE) != FALSE;
   if (success) {
@@ -516,15 +563,15 @@ void CrashGenerationServer::HandleReadingAckState() {
     // the callback.
     if (connect_callback_) {
       // Note that there is only a single copy of the ClientInfo of the
-      // currently connected client.  However it is being referenced from
-      // two different places:
-      //  - the client_info_ member
+      // client connected to this pipe instance.  However it is being
+      // referenced from two different places:
+      //  - the client_info member of the pipe instance
       //  - the clients_ list
       // The lifetime of this ClientInfo depends on the lifetime of the
       // client process - basically it can go away at any time.
       // However, as long as it is referenced by the clients_ list it
       // is guaranteed to be valid. Enter the critical section and check
-      // to see whether the client_info_ can be found in the list.
+      // to see whether the instance's client_info can be found in the list.
       // If found, execute the callback and only then leave the critical
       // section.
       AutoCriticalSection lock(&sync_);
@@ -532,46 +579,46 @@ void CrashGenerationServer::HandleReadingAckState() {
       bool client_is_still_alive = false;
       std::list<ClientInfo*>::iterator iter;
       for (iter = clients_.begin(); iter != clients_.end(); ++iter) {
-        if (client_info_ == *iter) {
+        if (instance->client_info == *iter) {
           client_is_still_alive = true;
           break;
         }
       }
 
       if (client_is_still_alive) {
-        connect_callback_(connect_context_, client_info_);
+        connect_callback_(connect_context_, instance->client_info);
       }
     }
   } else {
     assert(!CheckForIOIncomplete(success));
   }
 
-  EnterStateImmediately(IPC_SERVER_STATE_DISCONNECTING);
+  EnterStateImmediately(instance, IPC_SERVER_STATE_DISCONNECTING);
 }
 
 // When the server thread serving the client is in the DISCONNECTING state,
 // disconnect from the pipe and reset the event. If anything fails, go into
 // the ERROR state. If it goes well, go into the INITIAL state and set the
 // event to start all over again.
-void CrashGenerationServer::HandleDisconnectingState() {
-  assert(server_state_ == IPC_SERVER_STATE_DISCONNECTING);
+void CrashGenerationServer::HandleDisconnectingState(PipeInstance* instance) {
+  assert(instance->state == IPC_SERVER_STATE_DISCONNECTING);
 
   // Done serving the client.
-  client_info_ = NULL;
+  instance->client_info = NULL;
 
-  overlapped_.Internal = NULL;
-  overlapped_.InternalHigh = NULL;
-  overlapped_.Offset = 0;
-  overlapped_.OffsetHigh = 0;
-  overlapped_.Pointer = NULL;
+  instance->overlapped.Internal = NULL;
+  instance->overlapped.InternalHigh = NULL;
+  instance->overlapped.Offset = 0;
+  instance->overlapped.OffsetHigh = 0;
+  instance->overlapped.Pointer = NULL;
 
-  if (!ResetEvent(overlapped_.hEvent)) {
-    EnterErrorState();
+  if (!ResetEvent(instance->overlapped.hEvent)) {
+    EnterErrorState(instance);
     return;
   }
 
-  if (!DisconnectNamedPipe(pipe_)) {
-    EnterErrorState();
+  if (!DisconnectNamedPipe(instance->pipe)) {
+    EnterErrorState(instance);
     return;
   }
 
@@ -581,23 +628,25 @@ void CrashGenerationServer::HandleDisconnectingState() {
     return;
   }
 
-  EnterStateImmediately(IPC_SERVER_STATE_INITIAL);
+  EnterStateImmediately(instance, IPC_SERVER_STATE_INITIAL);
 }
 
-void CrashGenerationServer::EnterErrorState() {
-  SetEvent(overlapped_.hEvent);
-  server_state_ = IPC_SERVER_STATE_ERROR;
+void CrashGenerationServer::EnterErrorState(PipeInstance* instance) {
+  SetEvent(instance->overlapped.hEvent);
+  instance->state = IPC_SERVER_STATE_ERROR;
 }
 
-void CrashGenerationServer::EnterStateWhenSignaled(IPCServerState state) {
-  server_state_ = state;
+void CrashGenerationServer::EnterStateWhenSignaled(PipeInstance* instance,
+                                                   IPCServerState state) {
+  instance->state = state;
 }
 
-void CrashGenerationServer::EnterStateImmediately(IPCServerState state) {
-  server_state_ = state;
+void CrashGenerationServer::EnterStateImmediately(PipeInstance* instance,
+                                                  IPCServerState state) {
+  instance->state = state;
 
-  if (!SetEvent(overlapped_.hEvent)) {
-    server_state_ = IPC_SERVER_STATE_ERROR;
+  if (!SetEvent(instance->overlapped.hEvent)) {
+    instance->state = IPC_SERVER_STATE_ERROR;
   }
 }
 
@@ -684,18 +733,19 @@ bool CrashGenerationServer::CreateClientHandles(const ClientInfo& client_info,
   return true;
 }
 
-bool CrashGenerationServer::RespondToClient(ClientInfo* client_info) {
+bool CrashGenerationServer::RespondToClient(PipeInstance* instance,
+                                            ClientInfo* client_info) {
   ProtocolMessage reply;
   if (!PrepareReply(*client_info, &reply)) {
     return false;
   }
 
   DWORD bytes_count = 0;
-  bool success = WriteFile(pipe_,
+  bool success = WriteFile(instance->pipe,
                             &reply,
                             sizeof(reply),
                             &bytes_count,
-                            &overlapped_) != FALSE;
+                            &instance->overlapped) != FALSE;
   DWORD error_code = success ? ERROR_SUCCESS : GetLastError();
 
   if (!success && error_code != ERROR_IO_PENDING) {
@@ -710,61 +760,61 @@ bool CrashGenerationServer::RespondToClient(ClientInfo* client_info) {
 // The server thread servicing the clients runs this method. The method
 // implements the state machine described in ReadMe.txt along with the
 // helper methods HandleXXXState.
-void CrashGenerationServer::HandleConnectionRequest() {
+void CrashGenerationServer::HandleConnectionRequest(PipeInstance* instance) {
   // If the server is shutting down, get into ERROR state, reset the event so
   // more workers don't run and return immediately.
   if (shutting_down_) {
-    server_state_ = IPC_SERVER_STATE_ERROR;
-    ResetEvent(overlapped_.hEvent);
+    instance->state = IPC_SERVER_STATE_ERROR;
+    ResetEvent(instance->overlapped.hEvent);
     return;
   }
 
-  switch (server_state_) {
+  switch (instance->state) {
     case IPC_SERVER_STATE_ERROR:
-      HandleErrorState();
+      HandleErrorState(instance);
       break;
 
     case IPC_SERVER_STATE_INITIAL:
-      HandleInitialState();
+      HandleInitialState(instance);
       break;
 
     case IPC_SERVER_STATE_CONNECTING:
-      HandleConnectingState();
+      HandleConnectingState(instance);
       break;
 
     case IPC_SERVER_STATE_CONNECTED:
-      HandleConnectedState();
+      HandleConnectedState(instance);
       break;
 
     case IPC_SERVER_STATE_READING:
-      HandleReadingState();
+      HandleReadingState(instance);
       break;
 
     case IPC_SERVER_STATE_READ_DONE:
-      HandleReadDoneState();
+      HandleReadDoneState(instance);
       break;
 
     case IPC_SERVER_STATE_WRITING:
-      HandleWritingState();
+      HandleWritingState(instance);
       break;
 
     case IPC_SERVER_STATE_WRITE_DONE:
-      HandleWriteDoneState();
+      HandleWriteDoneState(instance);
       break;
 
     case IPC_SERVER_STATE_READING_ACK:
-      HandleReadingAckState();
+      HandleReadingAckState(instance);
       break;
 
     case IPC_SERVER_STATE_DISCONNECTING:
-      HandleDisconnectingState();
+      HandleDisconnectingState(instance);
       break;
 
     default:
       assert(false);
       // This indicates that we added one more state without
       // adding handling code.
-      server_state_ = IPC_SERVER_STATE_ERROR;
+      instance->state = IPC_SERVER_STATE_ERROR;
       break;
   }
 }
@@ -812,9 +862,8 @@ bool CrashGenerationServer::AddClient(ClientInfo* client_info) {
 void CALLBACK CrashGenerationServer::OnPipeConnected(void* context, BOOLEAN) {
   assert(context);
 
-  CrashGenerationServer* obj =
-      reinterpret_cast<CrashGenerationServer*>(context);
-  obj->HandleConnectionRequest();
+  PipeInstance* instance = reinterpret_cast<PipeInstance*>(context);
+  instance->server->HandleConnectionRequest(instance);
 }
 
 // static
@@ -828,6 +877,7 @@ void CALLBACK CrashGenerationServer::OnDumpRequest(void* context, BOOLEAN) {
     client_info->PopulateCustomInfo();
   }
   crash_server->HandleDumpRequest(*client_info);
+  client_info->increment_dump_count();
 
   ResetEvent(client_info->dump_requested_handle());
 }
@@ -882,10 +932,22 @@ void CrashGenerationServer::HandleDumpRequest(const ClientInfo& client_info) {
   // dump in the callback.
   std::wstring dump_path;
   if (generate_dumps_) {
+    // Full memory dumps take a lot of disk I/O; write one at a time, without
+    // holding a dump slot while waiting for the previous one.
+    const bool full_memory =
+        (client_info.dump_type() & MiniDumpWithFullMemory) != 0;
+    if (full_memory) {
+      EnterCriticalSection(&full_dump_sync_);
+    }
+    AcquireDumpSlot(client_info);
     if (!GenerateDump(client_info, &dump_path)) {
       // client proccess terminated or some other error
       execute_callback = false;
     }
+    ReleaseDumpSlot();
+    if (full_memory) {
+      LeaveCriticalSection(&full_dump_sync_);
+    }
   }
 
   if (dump_callback_ && execute_callback) {
@@ -896,6 +958,49 @@ void CrashGenerationServer::HandleDumpRequest(const ClientInfo& client_info) {
   SetEvent(client_info.dump_generated_handle());
 }
 
+void CrashGenerationServer::AcquireDumpSlot(const ClientInfo& client_info) {
+  DumpWaiter waiter;
+  {
+    AutoCriticalSection lock(&dump_sync_);
+    if (max_concurrent_dumps_ <= 0 ||
+        (active_dumps_ < max_concurrent_dumps_ && dump_waiters_.empty())) {
+      ++active_dumps_;
+      return;
+    }
+
+    waiter.dump_count = client_info.dump_count();
+    waiter.ready_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (!waiter.ready_event) {
+      // Write the dump over the limit rather than not at all.
+      ++active_dumps_;
+      return;
+    }
+
+    std::list<DumpWaiter*>::iterator iter = dump_waiters_.begin();
+    while (iter != dump_waiters_.end() &&
+           (*iter)->dump_count <= waiter.dump_count) {
+      ++iter;
+    }
+    dump_waiters_.insert(iter, &waiter);
+  }
+
+  // ReleaseDumpSlot passes its slot on without changing active_dumps_.
+  WaitForSingleObject(waiter.ready_event, INFINITE);
+  CloseHandle(waiter.ready_event);
+}
+
+void CrashGenerationServer::ReleaseDumpSlot() {
+  AutoCriticalSection lock(&dump_sync_);
+  if (dump_waiters_.empty()) {
+    --active_dumps_;
+    return;
+  }
+
+  DumpWaiter* waiter = dump_waiters_.front();
+  dump_waiters_.pop_front();
+  SetEvent(waiter->ready_event);
+}
+
 bool CrashGenerationServer::GenerateDump(const ClientInfo& client,
                                          std::wstring* dump_path) {
   assert(client.pid() != 0);
@@ -922,6 +1027,7 @@ bool CrashGenerationServer::GenerateDump(const ClientInfo& client,
                                    client.assert_info(),
                                    client.dump_type(),
                                    true);
+  dump_generator.SetUseNativeWriter(use_native_writer_);
 
   if (!dump_generator.GenerateDumpFile(dump_path)) {
     return false;
@@ -32,6 +32,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 #include "client/windows/common/ipc_protocol.h"
 #include "client/windows/crash_generation/minidump_generator.h"
 #include "common/scoped_ptr.h"
@@ -43,8 +44,8 @@ class ClientInfo;
 // generation protocol for Windows platform only. It generates Windows
 // minidump files for client processes that request dump generation. When
 // the server is requested to start listening for clients (by calling the
-// Start method), it creates a named pipe and waits for the clients to
-// register. In response, it hands them event handles that the client can
+// Start method), it creates one or more instances of a named pipe and waits
+// for the clients to register. In response, it hands them event handles that the client can
 // signal to request dump generation. When the clients request dump
 // generation in this way, the server generates Windows minidump files.
 class CrashGenerationServer {
@@ -106,9 +107,35 @@ class CrashGenerationServer {
     pre_fetch_custom_info_ = do_pre_fetch;
   }
 
+  // Writes the normal dumps with NativeMinidumpWriter rather than
+  // dbghelp.dll where MinidumpGenerator can; see
+  // MinidumpGenerator::SetUseNativeWriter.
+  void set_use_native_writer(bool use_native_writer) {
+    use_native_writer_ = use_native_writer;
+  }
+
+  // Sets the most dumps the server writes at a time; zero, the default,
+  // means no limit. Requests over the limit wait, and those from clients
+  // that have had the fewest dumps written go first. Dumps that include
+  // full memory are always written one at a time. Must be called before
+  // Start().
+  void set_max_concurrent_dumps(int max_dumps) {
+    max_concurrent_dumps_ = max_dumps;
+  }
+
+  // Sets the number of instances of the pipe the server creates, and so the
+  // number of clients that can register at the same time; the default is
+  // one and the most is PIPE_UNLIMITED_INSTANCES. Clients that connect while
+  // every instance is busy wait for one to free up. Must be called before
+  // Start().
+  void set_pipe_instance_count(int count) {
+    pipe_instance_count_ = count < 1 ? 1 :
+        (count > PIPE_UNLIMITED_INSTANCES ? PIPE_UNLIMITED_INSTANCES : count);
+  }
+
  private:
-  // Various states the client can be in during the handshake with
-  // the server.
+  // Various states a pipe instance can be in during the handshake with
+  // a client.
   enum IPCServerState {
     // Server starts in this state.
     IPC_SERVER_STATE_UNINITIALIZED,
@@ -149,19 +176,58 @@ class CrashGenerationServer {
     IPC_SERVER_STATE_DISCONNECTING
   };
 
+  // One instance of the server's named pipe. Each instance runs its own
+  // copy of the handshake state machine, so as many clients can register
+  // at once as there are instances.
+  struct PipeInstance {
+    explicit PipeInstance(CrashGenerationServer* owner)
+        : server(owner),
+          pipe(NULL),
+          wait_handle(NULL),
+          state(IPC_SERVER_STATE_UNINITIALIZED),
+          overlapped(),
+          msg(),
+          client_info(NULL) {}
+
+    // The server that owns this instance.
+    CrashGenerationServer* server;
+
+    // Handle to the pipe instance used for handshake with clients.
+    HANDLE pipe;
+
+    // Wait handle for overlapped.hEvent.
+    HANDLE wait_handle;
+
+    // State of the instance in performing the IPC with the client.
+    IPCServerState state;
+
+    // Overlapped instance for async I/O on the pipe.
+    OVERLAPPED overlapped;
+
+    // Message object used in IPC with the client.
+    ProtocolMessage msg;
+
+    // Client Info for the client that's connecting on this instance.
+    ClientInfo* client_info;
+  };
+
+  // Creates the pipe instance and starts its state machine. The first
+  // instance is created with FILE_FLAG_FIRST_PIPE_INSTANCE.
+  bool StartPipeInstance(PipeInstance* instance, bool first_instance);
+
   //
-  // Helper methods to handle various server IPC states.
+  // Helper methods to handle various server IPC states of a pipe instance.
   //
-  void HandleErrorState();
-  void HandleInitialState();
-  void HandleConnectingState();
-  void HandleConnectedState();
-  void HandleReadingState();
-  void HandleReadDoneState();
-  void HandleWritingState();
-  void HandleWriteDoneState();
-  void HandleReadingAckState();
-  void HandleDisconnectingState();
+  void HandleErrorState(PipeInstance* instance);
+  void HandleInitialState(PipeInstance* instance);
+  void HandleConnectingState(PipeInstance* instance);
+  void HandleConnectedState(PipeInstance* instance);
+  void HandleReadingState(PipeInstance* instance);
+  void HandleReadDoneState(PipeInstance* instance);
+  void HandleWritingState(PipeInstance* instance);
+  void HandleWriteDoneState(PipeInstance* instance);
+  void HandleReadingAckState(PipeInstance* instance);
+  void HandleDisconnectingState(PipeInstance* instance);
 
   // Prepares reply for a client from the given parameters.
   bool PrepareReply(const ClientInfo& client_info,
@@ -174,17 +240,17 @@ class CrashGenerationServer {
   bool CreateClientHandles(const ClientInfo& client_info,
                            ProtocolMessage* reply) const;
 
-  // Response to the given client. Return true if all steps of
-  // responding to the client succeed, false otherwise.
-  bool RespondToClient(ClientInfo* client_info);
+  // Response to the given client over the given pipe instance. Return true
+  // if all steps of responding to the client succeed, false otherwise.
+  bool RespondToClient(PipeInstance* instance, ClientInfo* client_info);
 
-  // Handles a connection request from the client.
-  void HandleConnectionRequest();
+  // Handles a connection request from the client on the given pipe instance.
+  void HandleConnectionRequest(PipeInstance* instance);
 
   // Handles a dump request from the client.
   void HandleDumpRequest(const ClientInfo& client_info);
 
-  // Callback for pipe connected event.
+  // Callback for pipe connected event. The context is the PipeInstance.
   static void CALLBACK OnPipeConnected(void* context, BOOLEAN timer_or_wait);
 
   // Callback for a dump request.
@@ -202,20 +268,37 @@ class CrashGenerationServer {
   // Generates dump for the given client.
   bool GenerateDump(const ClientInfo& client, std::wstring* dump_path);
 
-  // Puts the server in a permanent error state and sets a signal such that
-  // the state will be immediately entered after the current state transition
-  // is complete.
-  void EnterErrorState();
+  // A dump request waiting for one of the dumps in progress to finish.
+  struct DumpWaiter {
+    // The dump count of the requesting client.
+    int dump_count;
+
+    // Set when the request may go ahead.
+    HANDLE ready_event;
+  };
+
+  // Blocks until fewer than max_concurrent_dumps_ dumps are in progress
+  // and no client with fewer dumps is waiting, then counts the caller's
+  // dump as in progress.
+  void AcquireDumpSlot(const ClientInfo& client_info);
+
+  // Hands the caller's dump slot to the first waiting request, if any.
+  void ReleaseDumpSlot();
 
-  // Puts the server in the specified state and sets a signal such that the
-  // state is immediately entered after the current state transition is
+  // Puts the pipe instance in a permanent error state and sets a signal such
+  // that the state will be immediately entered after the current state
+  // transition is complete.
+  void EnterErrorState(PipeInstance* instance);
+
+  // Puts the pipe instance in the specified state and sets a signal such that
+  // the state is immediately entered after the current state transition is
   // complete.
-  void EnterStateImmediately(IPCServerState state);
+  void EnterStateImmediately(PipeInstance* instance, IPCServerState state);
 
-  // Puts the server in the specified state. No signal will be set, so the state
-  // transition will only occur when signaled manually or by completion of an
-  // asynchronous IO operation.
-  void EnterStateWhenSignaled(IPCServerState state);
+  // Puts the pipe instance in the specified state. No signal will be set, so
+  // the state transition will only occur when signaled manually or by
+  // completion of an asynchronous IO operation.
+  void EnterStateWhenSignaled(PipeInstance* instance, IPCServerState state);
 
   // Sync object for thread-safe access to the shared list of clients.
   CRITICAL_SECTION sync_;
@@ -229,11 +312,8 @@ class CrashGenerationServer {
   // Pipe security attributes
   SECURITY_ATTRIBUTES* pipe_sec_attrs_;
 
-  // Handle to the pipe used for handshake with clients.
-  HANDLE pipe_;
-
-  // Pipe wait handle.
-  HANDLE pipe_wait_handle_;
+  // The pipe instances, created by Start.
+  std::vector<PipeInstance*> pipes_;
 
   // Handle to server-alive mutex.
   HANDLE server_alive_handle_;
@@ -268,26 +348,36 @@ class CrashGenerationServer {
   // Wether to populate custom information up-front.
   bool pre_fetch_custom_info_;
 
+  // Whether to write dumps with NativeMinidumpWriter where possible.
+  bool use_native_writer_;
+
   // The dump path for the server.
   const std::wstring dump_path_;
 
-  // State of the server in performing the IPC with the client.
-  // Note that since we restrict the pipe to one instance, we
-  // only need to keep one state of the server. Otherwise, server
-  // would have one state per client it is talking to.
-  IPCServerState server_state_;
+  // Whether Start has been called.
+  bool started_;
 
   // Whether the server is shutting down.
   bool shutting_down_;
 
-  // Overlapped instance for async I/O on the pipe.
-  OVERLAPPED overlapped_;
+  // The number of pipe instances Start creates.
+  int pipe_instance_count_;
+
+  // Sync object guarding active_dumps_ and dump_waiters_.
+  CRITICAL_SECTION dump_sync_;
+
+  // Held while writing a dump that includes full memory.
+  CRITICAL_SECTION full_dump_sync_;
+
+  // The most dumps written at a time, or zero for no limit.
+  int max_concurrent_dumps_;
 
-  // Message object used in IPC with the client.
-  ProtocolMessage msg_;
+  // The number of dumps in progress.
+  int active_dumps_;
 
-  // Client Info for the client that's connecting to the server.
-  ClientInfo* client_info_;
+  // Requests waiting for a dump slot, ordered by client dump count and
+  // then by arrival.
+  std::list<DumpWaiter*> dump_waiters_;
 
   // Disable copy ctor and operator=.
   CrashGenerationServer(const CrashGenerationServer& crash_server);
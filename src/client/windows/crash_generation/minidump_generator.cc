@@ -38,6 +38,7 @@
 #include <vector>
 
 #include "client/windows/common/auto_critical_section.h"
+#include "client/windows/crash_generation/native_minidump_writer.h"
 #include "common/scoped_ptr.h"
 #include "common/windows/guid_string.h"
 
@@ -277,7 +278,8 @@ MinidumpGenerator::MinidumpGenerator(
       dump_file_is_internal_(false),
       full_dump_file_is_internal_(false),
       additional_streams_(NULL),
-      callback_info_(NULL) {
+      callback_info_(NULL),
+      use_native_writer_(false) {
   uuid_ = {0};
   InitializeCriticalSection(&module_load_sync_);
   InitializeCriticalSection(&get_proc_address_sync_);
@@ -311,9 +313,16 @@ bool MinidumpGenerator::WriteMinidump() {
     return false;
   }
 
-  MiniDumpWriteDumpType write_dump = GetWriteDump();
-  if (!write_dump) {
-    return false;
+  // Only load dbghelp.dll if the native writer can't do without it.
+  const bool native_minidump =
+      use_native_writer_ && !callback_info_ &&
+      (dump_type_ & ~MiniDumpWithFullMemory) == MiniDumpNormal;
+  MiniDumpWriteDumpType write_dump = NULL;
+  if (full_memory_dump || !native_minidump) {
+    write_dump = GetWriteDump();
+    if (!write_dump) {
+      return false;
+    }
   }
 
   MINIDUMP_EXCEPTION_INFORMATION* dump_exception_pointers = NULL;
@@ -443,15 +452,30 @@ bool MinidumpGenerator::WriteMinidump() {
     ++user_streams.UserStreamCount;
   }
 
-  bool result_minidump = write_dump(
-      process_handle_,
-      process_id_,
-      dump_file_,
-      static_cast<MINIDUMP_TYPE>((dump_type_ & (~MiniDumpWithFullMemory))
-                                  | MiniDumpNormal),
-      dump_exception_pointers,
-      &user_streams,
-      callback_info_) != FALSE;
+  bool result_minidump = false;
+  if (native_minidump) {
+    NativeMinidumpWriter native_writer(process_handle_,
+                                       process_id_,
+                                       thread_id_,
+                                       exception_pointers_,
+                                       is_client_pointers_);
+    result_minidump = native_writer.WriteMinidump(dump_file_, &user_streams);
+  }
+
+  if (!result_minidump) {
+    if (!write_dump) {
+      write_dump = GetWriteDump();
+    }
+    result_minidump = write_dump && write_dump(
+        process_handle_,
+        process_id_,
+        dump_file_,
+        static_cast<MINIDUMP_TYPE>((dump_type_ & (~MiniDumpWithFullMemory))
+                                    | MiniDumpNormal),
+        dump_exception_pointers,
+        &user_streams,
+        callback_info_) != FALSE;
+  }
 
   return result_minidump && result_full_memory;
 }
@@ -90,6 +90,15 @@ class MinidumpGenerator {
     callback_info_ = callback_info;
   }
 
+  // Writes the normal dump with NativeMinidumpWriter rather than dbghelp.dll
+  // when no callback is set and dump_type asks for nothing beyond
+  // MiniDumpNormal and MiniDumpWithFullMemory. The full memory dump is
+  // always written by dbghelp.dll, and so is the normal dump if the native
+  // writer fails.
+  void SetUseNativeWriter(bool use_native_writer) {
+    use_native_writer_ = use_native_writer;
+  }
+
   // Writes the minidump with the given parameters. Stores the
   // dump file path in the dump_path parameter if dump generation
   // succeeds.
@@ -190,6 +199,9 @@ class MinidumpGenerator {
   // The user defined callback for the various stages of the dump process.
   MINIDUMP_CALLBACK_INFORMATION* callback_info_;
 
+  // Whether to try NativeMinidumpWriter for the normal dump.
+  bool use_native_writer_;
+
   // Critical section to sychronize action of loading modules dynamically.
   CRITICAL_SECTION module_load_sync_;
 
@@ -0,0 +1,747 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "client/windows/crash_generation/native_minidump_writer.h"
+
+#include <intrin.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <tlhelp32.h>
+
+#include <algorithm>
+#include <string>
+
+namespace google_breakpad {
+
+namespace {
+
+// The dump is built in a single reservation of this size.
+#if defined(_WIN64)
+const size_t kMaxDumpSize = 256 * 1024 * 1024;
+#else
+const size_t kMaxDumpSize = 64 * 1024 * 1024;
+#endif
+
+// The reservation is committed this much at a time.
+const size_t kCommitSize = 64 * 1024;
+
+// The most of each thread's stack included, counted up from its stack
+// pointer.
+const ULONG64 kMaxStackSize = 1024 * 1024;
+
+// The memory included around the exception address.
+const ULONG64 kIPMemorySize = 256;
+
+// The largest CodeView record copied from a module.
+const DWORD kMaxCodeViewRecordSize = 4096;
+
+// The most debug directory entries looked at in a module.
+const DWORD kMaxDebugDirectoryEntries = 16;
+
+const MDRVA kInvalidRVA = static_cast<MDRVA>(-1);
+
+// Thread access needed to capture a thread.
+const DWORD kThreadAccess = THREAD_GET_CONTEXT |
+                            THREAD_SUSPEND_RESUME |
+                            THREAD_QUERY_INFORMATION;
+
+// THREAD_BASIC_INFORMATION from the DDK, as returned by
+// NtQueryInformationThread.
+struct ThreadBasicInformation {
+  LONG exit_status;
+  PVOID teb_base_address;
+  HANDLE unique_process;
+  HANDLE unique_thread;
+  ULONG_PTR affinity_mask;
+  LONG priority;
+  LONG base_priority;
+};
+
+const int kThreadBasicInformationClass = 0;
+
+typedef LONG (WINAPI* NtQueryInformationThreadType)(HANDLE thread,
+                                                    int information_class,
+                                                    PVOID information,
+                                                    ULONG length,
+                                                    PULONG return_length);
+
+typedef LONG (WINAPI* RtlGetVersionType)(OSVERSIONINFOEXW* version);
+
+#if defined(_M_IX86)
+ULONG64 GetStackPointer(const CONTEXT& context) { return context.Esp; }
+#elif defined(_M_AMD64)
+ULONG64 GetStackPointer(const CONTEXT& context) { return context.Rsp; }
+#endif
+
+// Builds the dump in memory reserved with VirtualAlloc rather than taken
+// from the heap, so that it can grow while threads of the current process,
+// any of which may hold the heap lock, are suspended.  Allocations never
+// move.
+class DumpBuffer {
+ public:
+  DumpBuffer() : base_(NULL), committed_(0), size_(0) {}
+
+  ~DumpBuffer() {
+    if (base_) {
+      VirtualFree(base_, 0, MEM_RELEASE);
+    }
+  }
+
+  bool Reserve() {
+    base_ = static_cast<uint8_t*>(
+        VirtualAlloc(NULL, kMaxDumpSize, MEM_RESERVE, PAGE_READWRITE));
+    return base_ != NULL;
+  }
+
+  // Returns the position of size zeroed bytes, aligned to 8 bytes, or
+  // kInvalidRVA if the buffer is full.
+  MDRVA Allocate(size_t size) {
+    const size_t position = (size_ + 7) & ~static_cast<size_t>(7);
+    if (!base_ || position > kMaxDumpSize || size > kMaxDumpSize - position) {
+      return kInvalidRVA;
+    }
+    const size_t end = position + size;
+    if (end > committed_) {
+      const size_t commit_end =
+          (std::min)(kMaxDumpSize,
+                     (end + kCommitSize - 1) / kCommitSize * kCommitSize);
+      if (!VirtualAlloc(base_ + committed_, commit_end - committed_,
+                        MEM_COMMIT, PAGE_READWRITE)) {
+        return kInvalidRVA;
+      }
+      committed_ = commit_end;
+    }
+    size_ = end;
+    return static_cast<MDRVA>(position);
+  }
+
+  // Gives back everything allocated from position on, which must have been
+  // returned by the last call to Allocate.  The bytes are zeroed again.
+  void Truncate(MDRVA position) {
+    memset(base_ + position, 0, size_ - position);
+    size_ = position;
+  }
+
+  template <typename T>
+  T* At(MDRVA position) {
+    return reinterpret_cast<T*>(base_ + position);
+  }
+
+  const uint8_t* data() const { return base_; }
+  size_t size() const { return size_; }
+
+ private:
+  uint8_t* base_;
+  size_t committed_;
+  size_t size_;
+};
+
+bool ReadMemory(HANDLE process, ULONG64 address, size_t size, void* dest) {
+  SIZE_T bytes_read = 0;
+  return ReadProcessMemory(process,
+                           reinterpret_cast<LPCVOID>(
+                               static_cast<ULONG_PTR>(address)),
+                           dest,
+                           size,
+                           &bytes_read) && bytes_read == size;
+}
+
+// Copies size bytes at address in process to the dump and describes them in
+// *descriptor.  Returns false, copying nothing, if any of them can't be
+// read.
+bool CopyMemory(HANDLE process,
+                ULONG64 address,
+                size_t size,
+                DumpBuffer* dump,
+                MDMemoryDescriptor* descriptor) {
+  const MDRVA rva = dump->Allocate(size);
+  if (rva == kInvalidRVA) {
+    return false;
+  }
+  if (!ReadMemory(process, address, size, dump->At<uint8_t>(rva))) {
+    dump->Truncate(rva);
+    return false;
+  }
+  descriptor->start_of_memory_range = address;
+  descriptor->memory.data_size = static_cast<uint32_t>(size);
+  descriptor->memory.rva = rva;
+  return true;
+}
+
+// Writes str to the dump as an MDString.  Returns its position, or
+// kInvalidRVA on failure.
+MDRVA WriteString(const wchar_t* str, DumpBuffer* dump) {
+  const size_t length = wcslen(str);
+  const MDRVA rva =
+      dump->Allocate(MDString_minsize + (length + 1) * sizeof(uint16_t));
+  if (rva == kInvalidRVA) {
+    return kInvalidRVA;
+  }
+  MDString* string = dump->At<MDString>(rva);
+  string->length = static_cast<uint32_t>(length * sizeof(uint16_t));
+  memcpy(string->buffer, str, length * sizeof(uint16_t));
+  return rva;
+}
+
+// Converts a FILETIME interval in 100ns units to seconds.
+uint32_t FileTimeToSeconds(const FILETIME& file_time) {
+  ULARGE_INTEGER value;
+  value.LowPart = file_time.dwLowDateTime;
+  value.HighPart = file_time.dwHighDateTime;
+  return static_cast<uint32_t>(value.QuadPart / 10000000);
+}
+
+// Converts a FILETIME date to a time_t.
+uint32_t FileTimeToTimeT(const FILETIME& file_time) {
+  // The FILETIME of the Unix epoch.
+  const ULONGLONG kUnixEpoch = 116444736000000000ULL;
+  ULARGE_INTEGER value;
+  value.LowPart = file_time.dwLowDateTime;
+  value.HighPart = file_time.dwHighDateTime;
+  if (value.QuadPart < kUnixEpoch) {
+    return 0;
+  }
+  return static_cast<uint32_t>((value.QuadPart - kUnixEpoch) / 10000000);
+}
+
+// A thread to capture, and what capturing it found.
+struct Thread {
+  DWORD thread_id;
+  HANDLE handle;
+  DWORD suspend_count;
+  bool suspended;
+};
+
+// A module to describe.
+struct Module {
+  ULONG64 base;
+  DWORD size;
+  std::wstring path;
+};
+
+}  // namespace
+
+NativeMinidumpWriter::NativeMinidumpWriter(
+    HANDLE process_handle,
+    DWORD process_id,
+    DWORD thread_id,
+    EXCEPTION_POINTERS* exception_pointers,
+    bool is_client_pointers)
+    : process_handle_(process_handle),
+      process_id_(process_id),
+      thread_id_(thread_id),
+      exception_pointers_(exception_pointers),
+      is_client_pointers_(is_client_pointers) {
+}
+
+void NativeMinidumpWriter::AddMemoryRange(ULONG64 base, ULONG size) {
+  MemoryRange range = { base, size };
+  memory_ranges_.push_back(range);
+}
+
+bool NativeMinidumpWriter::WriteMinidump(
+    HANDLE dump_file,
+    const MINIDUMP_USER_STREAM_INFORMATION* user_streams) {
+#if !defined(_M_IX86) && !defined(_M_AMD64)
+  // Only the x86 and x64 CONTEXT structures have the layout of the
+  // corresponding MDRawContext.
+  return false;
+#else
+  // The CONTEXT and image headers read from the process must have the
+  // layout this code was compiled with.
+  BOOL current_is_wow64 = FALSE;
+  BOOL process_is_wow64 = FALSE;
+  if (!IsWow64Process(GetCurrentProcess(), &current_is_wow64) ||
+      !IsWow64Process(process_handle_, &process_is_wow64) ||
+      current_is_wow64 != process_is_wow64) {
+    return false;
+  }
+
+  // Gather what needs the heap before any thread is suspended.
+  EXCEPTION_RECORD exception_record = {0};
+  CONTEXT exception_context = {0};
+  if (exception_pointers_) {
+    if (is_client_pointers_) {
+      EXCEPTION_POINTERS pointers;
+      if (!ReadMemory(process_handle_,
+                      reinterpret_cast<ULONG64>(exception_pointers_),
+                      sizeof(pointers), &pointers) ||
+          !ReadMemory(process_handle_,
+                      reinterpret_cast<ULONG64>(pointers.ExceptionRecord),
+                      sizeof(exception_record), &exception_record) ||
+          !ReadMemory(process_handle_,
+                      reinterpret_cast<ULONG64>(pointers.ContextRecord),
+                      sizeof(exception_context), &exception_context)) {
+        return false;
+      }
+    } else {
+      exception_record = *exception_pointers_->ExceptionRecord;
+      exception_context = *exception_pointers_->ContextRecord;
+    }
+  }
+
+  const bool is_current_process = process_id_ == GetCurrentProcessId();
+  std::vector<Thread> threads;
+  HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+  if (snapshot == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  THREADENTRY32 thread_entry;
+  thread_entry.dwSize = sizeof(thread_entry);
+  for (BOOL more = Thread32First(snapshot, &thread_entry); more;
+       more = Thread32Next(snapshot, &thread_entry)) {
+    if (thread_entry.th32OwnerProcessID != process_id_ ||
+        (is_current_process &&
+         thread_entry.th32ThreadID == GetCurrentThreadId())) {
+      continue;
+    }
+    HANDLE handle = OpenThread(kThreadAccess, FALSE,
+                               thread_entry.th32ThreadID);
+    if (handle) {
+      Thread thread = { thread_entry.th32ThreadID, handle, 0, false };
+      threads.push_back(thread);
+    }
+  }
+  CloseHandle(snapshot);
+
+  std::vector<Module> modules;
+  // The module snapshot fails with ERROR_BAD_LENGTH while the process is
+  // loading or unloading a module; try again.
+  for (int tries = 0; tries < 5; ++tries) {
+    snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE, process_id_);
+    if (snapshot != INVALID_HANDLE_VALUE ||
+        GetLastError() != ERROR_BAD_LENGTH) {
+      break;
+    }
+  }
+  if (snapshot != INVALID_HANDLE_VALUE) {
+    MODULEENTRY32W module_entry;
+    module_entry.dwSize = sizeof(module_entry);
+    for (BOOL more = Module32FirstW(snapshot, &module_entry); more;
+         more = Module32NextW(snapshot, &module_entry)) {
+      Module module;
+      module.base = reinterpret_cast<ULONG64>(module_entry.modBaseAddr);
+      module.size = module_entry.modBaseSize;
+      module.path = module_entry.szExePath;
+      modules.push_back(module);
+    }
+    CloseHandle(snapshot);
+  }
+
+  NtQueryInformationThreadType query_information_thread =
+      reinterpret_cast<NtQueryInformationThreadType>(
+          GetProcAddress(GetModuleHandleW(L"ntdll.dll"),
+                         "NtQueryInformationThread"));
+  const DWORD priority_class = GetPriorityClass(process_handle_);
+
+  std::vector<MDMemoryDescriptor> memory_list;
+  memory_list.reserve(threads.size() + memory_ranges_.size() + 1);
+
+  DumpBuffer dump;
+  if (!dump.Reserve()) {
+    for (size_t i = 0; i < threads.size(); ++i) {
+      CloseHandle(threads[i].handle);
+    }
+    return false;
+  }
+
+  // Thread list, module list, memory list, system info, misc info, and the
+  // exception and user streams if any.
+  const uint32_t user_stream_count =
+      user_streams ? user_streams->UserStreamCount : 0;
+  const uint32_t stream_count =
+      5 + (exception_pointers_ ? 1 : 0) + user_stream_count;
+  const MDRVA header_rva = dump.Allocate(sizeof(MDRawHeader));
+  const MDRVA directory_rva =
+      dump.Allocate(stream_count * sizeof(MDRawDirectory));
+  const MDRVA thread_list_rva =
+      dump.Allocate(sizeof(uint32_t) + threads.size() * sizeof(MDRawThread));
+  if (header_rva == kInvalidRVA || directory_rva == kInvalidRVA ||
+      thread_list_rva == kInvalidRVA) {
+    for (size_t i = 0; i < threads.size(); ++i) {
+      CloseHandle(threads[i].handle);
+    }
+    return false;
+  }
+
+  // Capture every thread with all of them suspended, so that the stacks
+  // are consistent with each other.  Nothing below may touch the heap until
+  // they are resumed; memory_list has the capacity it needs.
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].suspend_count = SuspendThread(threads[i].handle);
+    threads[i].suspended = threads[i].suspend_count != static_cast<DWORD>(-1);
+  }
+
+  uint32_t thread_count = 0;
+  MDRawThread* thread_list = reinterpret_cast<MDRawThread*>(
+      dump.At<uint8_t>(thread_list_rva) + sizeof(uint32_t));
+  for (size_t i = 0; i < threads.size(); ++i) {
+    if (!threads[i].suspended) {
+      continue;
+    }
+    CONTEXT context;
+    memset(&context, 0, sizeof(context));
+    context.ContextFlags = CONTEXT_ALL;
+    if (!GetThreadContext(threads[i].handle, &context)) {
+      continue;
+    }
+    const MDRVA context_rva = dump.Allocate(sizeof(context));
+    if (context_rva == kInvalidRVA) {
+      continue;
+    }
+    memcpy(dump.At<uint8_t>(context_rva), &context, sizeof(context));
+
+    MDRawThread& thread = thread_list[thread_count++];
+    thread.thread_id = threads[i].thread_id;
+    thread.suspend_count = threads[i].suspend_count;
+    thread.priority_class = priority_class;
+    thread.priority = GetThreadPriority(threads[i].handle);
+    thread.thread_context.data_size = sizeof(context);
+    thread.thread_context.rva = context_rva;
+
+    ThreadBasicInformation basic_information;
+    if (query_information_thread &&
+        query_information_thread(threads[i].handle,
+                                 kThreadBasicInformationClass,
+                                 &basic_information,
+                                 sizeof(basic_information),
+                                 NULL) >= 0) {
+      thread.teb = reinterpret_cast<ULONG64>(
+          basic_information.teb_base_address);
+    }
+
+    // Copy the stack from the stack pointer to the end of the committed
+    // region holding it, which is the base of the stack.
+    const ULONG64 stack_pointer = GetStackPointer(context);
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQueryEx(process_handle_,
+                       reinterpret_cast<LPCVOID>(
+                           static_cast<ULONG_PTR>(stack_pointer)),
+                       &info, sizeof(info)) != 0 &&
+        info.State == MEM_COMMIT) {
+      const ULONG64 region_end =
+          reinterpret_cast<ULONG64>(info.BaseAddress) + info.RegionSize;
+      const ULONG64 stack_size =
+          (std::min)(region_end - stack_pointer, kMaxStackSize);
+      if (CopyMemory(process_handle_, stack_pointer,
+                     static_cast<size_t>(stack_size), &dump,
+                     &thread.stack)) {
+        memory_list.push_back(thread.stack);
+      }
+    }
+  }
+  *dump.At<uint32_t>(thread_list_rva) = thread_count;
+
+  for (size_t i = 0; i < threads.size(); ++i) {
+    if (threads[i].suspended) {
+      ResumeThread(threads[i].handle);
+    }
+    CloseHandle(threads[i].handle);
+  }
+
+  std::vector<MDRawDirectory> directory;
+  MDRawDirectory entry;
+  entry.stream_type = MD_THREAD_LIST_STREAM;
+  entry.location.data_size = static_cast<uint32_t>(
+      sizeof(uint32_t) + thread_count * sizeof(MDRawThread));
+  entry.location.rva = thread_list_rva;
+  directory.push_back(entry);
+
+  if (exception_pointers_) {
+    const MDRVA exception_rva = dump.Allocate(sizeof(MDRawExceptionStream));
+    const MDRVA context_rva = dump.Allocate(sizeof(exception_context));
+    if (exception_rva == kInvalidRVA || context_rva == kInvalidRVA) {
+      return false;
+    }
+    memcpy(dump.At<uint8_t>(context_rva), &exception_context,
+           sizeof(exception_context));
+
+    MDRawExceptionStream* stream = dump.At<MDRawExceptionStream>(
+        exception_rva);
+    stream->thread_id = thread_id_;
+    MDException& record = stream->exception_record;
+    record.exception_code = exception_record.ExceptionCode;
+    record.exception_flags = exception_record.ExceptionFlags;
+    record.exception_record =
+        reinterpret_cast<ULONG64>(exception_record.ExceptionRecord);
+    record.exception_address =
+        reinterpret_cast<ULONG64>(exception_record.ExceptionAddress);
+    record.number_parameters =
+        (std::min)(static_cast<uint32_t>(exception_record.NumberParameters),
+                   MD_EXCEPTION_MAXIMUM_PARAMETERS);
+    for (uint32_t i = 0; i < record.number_parameters; ++i) {
+      record.exception_information[i] =
+          exception_record.ExceptionInformation[i];
+    }
+    stream->thread_context.data_size = sizeof(exception_context);
+    stream->thread_context.rva = context_rva;
+
+    entry.stream_type = MD_EXCEPTION_STREAM;
+    entry.location.data_size = sizeof(MDRawExceptionStream);
+    entry.location.rva = exception_rva;
+    directory.push_back(entry);
+
+    // Include the code around the exception address, within its region.
+    const ULONG64 address = record.exception_address;
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQueryEx(process_handle_,
+                       reinterpret_cast<LPCVOID>(
+                           static_cast<ULONG_PTR>(address)),
+                       &info, sizeof(info)) != 0 &&
+        info.State == MEM_COMMIT) {
+      const ULONG64 region_base = reinterpret_cast<ULONG64>(info.BaseAddress);
+      const ULONG64 region_end = region_base + info.RegionSize;
+      const ULONG64 base =
+          address - region_base > kIPMemorySize / 2 ?
+          address - kIPMemorySize / 2 : region_base;
+      const ULONG64 end =
+          (std::min)(address + kIPMemorySize / 2, region_end);
+      MDMemoryDescriptor descriptor;
+      if (CopyMemory(process_handle_, base, static_cast<size_t>(end - base),
+                     &dump, &descriptor)) {
+        memory_list.push_back(descriptor);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < memory_ranges_.size(); ++i) {
+    MDMemoryDescriptor descriptor;
+    if (CopyMemory(process_handle_, memory_ranges_[i].base,
+                   memory_ranges_[i].size, &dump, &descriptor)) {
+      memory_list.push_back(descriptor);
+    }
+  }
+
+  const MDRVA memory_list_rva = dump.Allocate(
+      sizeof(uint32_t) + memory_list.size() * sizeof(MDMemoryDescriptor));
+  if (memory_list_rva == kInvalidRVA) {
+    return false;
+  }
+  *dump.At<uint32_t>(memory_list_rva) =
+      static_cast<uint32_t>(memory_list.size());
+  if (!memory_list.empty()) {
+    memcpy(dump.At<uint8_t>(memory_list_rva) + sizeof(uint32_t),
+           &memory_list[0], memory_list.size() * sizeof(MDMemoryDescriptor));
+  }
+  entry.stream_type = MD_MEMORY_LIST_STREAM;
+  entry.location.data_size = static_cast<uint32_t>(
+      sizeof(uint32_t) + memory_list.size() * sizeof(MDMemoryDescriptor));
+  entry.location.rva = memory_list_rva;
+  directory.push_back(entry);
+
+  const MDRVA module_list_rva =
+      dump.Allocate(sizeof(uint32_t) + modules.size() * MD_MODULE_SIZE);
+  if (module_list_rva == kInvalidRVA) {
+    return false;
+  }
+  *dump.At<uint32_t>(module_list_rva) = static_cast<uint32_t>(modules.size());
+  for (size_t i = 0; i < modules.size(); ++i) {
+    MDRawModule module;
+    memset(&module, 0, sizeof(module));
+    module.base_of_image = modules[i].base;
+    module.size_of_image = modules[i].size;
+    module.module_name_rva = WriteString(modules[i].path.c_str(), &dump);
+    if (module.module_name_rva == kInvalidRVA) {
+      return false;
+    }
+
+    // The processor finds symbols by the CodeView record in the image's
+    // debug directory.
+    IMAGE_DOS_HEADER dos_header;
+    IMAGE_NT_HEADERS nt_headers;
+    if (ReadMemory(process_handle_, modules[i].base,
+                   sizeof(dos_header), &dos_header) &&
+        dos_header.e_magic == IMAGE_DOS_SIGNATURE &&
+        ReadMemory(process_handle_, modules[i].base + dos_header.e_lfanew,
+                   sizeof(nt_headers), &nt_headers) &&
+        nt_headers.Signature == IMAGE_NT_SIGNATURE) {
+      module.checksum = nt_headers.OptionalHeader.CheckSum;
+      module.time_date_stamp = nt_headers.FileHeader.TimeDateStamp;
+
+      const IMAGE_DATA_DIRECTORY& debug_directory =
+          nt_headers.OptionalHeader.DataDirectory[
+              IMAGE_DIRECTORY_ENTRY_DEBUG];
+      const DWORD entry_count =
+          nt_headers.OptionalHeader.NumberOfRvaAndSizes >
+              IMAGE_DIRECTORY_ENTRY_DEBUG ?
+          (std::min)(debug_directory.Size /
+                         static_cast<DWORD>(sizeof(IMAGE_DEBUG_DIRECTORY)),
+                     kMaxDebugDirectoryEntries) : 0;
+      for (DWORD j = 0; j < entry_count; ++j) {
+        IMAGE_DEBUG_DIRECTORY debug_entry;
+        if (!ReadMemory(process_handle_,
+                        modules[i].base + debug_directory.VirtualAddress +
+                            j * sizeof(debug_entry),
+                        sizeof(debug_entry), &debug_entry)) {
+          break;
+        }
+        if (debug_entry.Type != IMAGE_DEBUG_TYPE_CODEVIEW ||
+            debug_entry.AddressOfRawData == 0 ||
+            debug_entry.SizeOfData == 0 ||
+            debug_entry.SizeOfData > kMaxCodeViewRecordSize) {
+          continue;
+        }
+        MDMemoryDescriptor descriptor;
+        if (CopyMemory(process_handle_,
+                       modules[i].base + debug_entry.AddressOfRawData,
+                       debug_entry.SizeOfData, &dump, &descriptor)) {
+          module.cv_record = descriptor.memory;
+        }
+        break;
+      }
+    }
+
+    memcpy(dump.At<uint8_t>(module_list_rva) + sizeof(uint32_t) +
+               i * MD_MODULE_SIZE,
+           &module, MD_MODULE_SIZE);
+  }
+  entry.stream_type = MD_MODULE_LIST_STREAM;
+  entry.location.data_size = static_cast<uint32_t>(
+      sizeof(uint32_t) + modules.size() * MD_MODULE_SIZE);
+  entry.location.rva = module_list_rva;
+  directory.push_back(entry);
+
+  const MDRVA system_info_rva = dump.Allocate(sizeof(MDRawSystemInfo));
+  if (system_info_rva == kInvalidRVA) {
+    return false;
+  }
+  {
+    // The writer and the process have the same bitness, so GetSystemInfo
+    // describes the processor as the process sees it.
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    MDRawSystemInfo* info = dump.At<MDRawSystemInfo>(system_info_rva);
+    info->processor_architecture = system_info.wProcessorArchitecture;
+    info->processor_level = system_info.wProcessorLevel;
+    info->processor_revision = system_info.wProcessorRevision;
+    info->number_of_processors = static_cast<uint8_t>(
+        (std::min)(system_info.dwNumberOfProcessors, static_cast<DWORD>(255)));
+
+    // RtlGetVersion reports the real version, whatever the manifest says.
+    OSVERSIONINFOEXW version;
+    memset(&version, 0, sizeof(version));
+    version.dwOSVersionInfoSize = sizeof(version);
+    RtlGetVersionType get_version = reinterpret_cast<RtlGetVersionType>(
+        GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "RtlGetVersion"));
+    if (get_version && get_version(&version) >= 0) {
+      info->product_type = version.wProductType;
+      info->major_version = version.dwMajorVersion;
+      info->minor_version = version.dwMinorVersion;
+      info->build_number = version.dwBuildNumber;
+      info->platform_id = version.dwPlatformId;
+      info->suite_mask = version.wSuiteMask;
+    }
+    info->csd_version_rva = WriteString(version.szCSDVersion, &dump);
+    if (info->csd_version_rva == kInvalidRVA) {
+      return false;
+    }
+
+    int registers[4];
+    __cpuid(registers, 0);
+    const int max_function = registers[0];
+    info->cpu.x86_cpu_info.vendor_id[0] = registers[1];
+    info->cpu.x86_cpu_info.vendor_id[1] = registers[3];
+    info->cpu.x86_cpu_info.vendor_id[2] = registers[2];
+    if (max_function >= 1) {
+      __cpuid(registers, 1);
+      info->cpu.x86_cpu_info.version_information = registers[0];
+      info->cpu.x86_cpu_info.feature_information = registers[3];
+    }
+    __cpuid(registers, 0x80000000);
+    if (static_cast<unsigned int>(registers[0]) >= 0x80000001) {
+      __cpuid(registers, 0x80000001);
+      info->cpu.x86_cpu_info.amd_extended_cpu_features = registers[1];
+    }
+  }
+  entry.stream_type = MD_SYSTEM_INFO_STREAM;
+  entry.location.data_size = sizeof(MDRawSystemInfo);
+  entry.location.rva = system_info_rva;
+  directory.push_back(entry);
+
+  const MDRVA misc_info_rva = dump.Allocate(MD_MISCINFO_SIZE);
+  if (misc_info_rva == kInvalidRVA) {
+    return false;
+  }
+  {
+    MDRawMiscInfo* info = dump.At<MDRawMiscInfo>(misc_info_rva);
+    info->size_of_info = MD_MISCINFO_SIZE;
+    info->flags1 = MD_MISCINFO_FLAGS1_PROCESS_ID;
+    info->process_id = process_id_;
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (GetProcessTimes(process_handle_, &creation_time, &exit_time,
+                        &kernel_time, &user_time)) {
+      info->flags1 |= MD_MISCINFO_FLAGS1_PROCESS_TIMES;
+      info->process_create_time = FileTimeToTimeT(creation_time);
+      info->process_user_time = FileTimeToSeconds(user_time);
+      info->process_kernel_time = FileTimeToSeconds(kernel_time);
+    }
+  }
+  entry.stream_type = MD_MISC_INFO_STREAM;
+  entry.location.data_size = MD_MISCINFO_SIZE;
+  entry.location.rva = misc_info_rva;
+  directory.push_back(entry);
+
+  for (uint32_t i = 0; i < user_stream_count; ++i) {
+    const MINIDUMP_USER_STREAM& user_stream =
+        user_streams->UserStreamArray[i];
+    const MDRVA rva = dump.Allocate(user_stream.BufferSize);
+    if (rva == kInvalidRVA) {
+      return false;
+    }
+    memcpy(dump.At<uint8_t>(rva), user_stream.Buffer, user_stream.BufferSize);
+    entry.stream_type = user_stream.Type;
+    entry.location.data_size = user_stream.BufferSize;
+    entry.location.rva = rva;
+    directory.push_back(entry);
+  }
+
+  memcpy(dump.At<uint8_t>(directory_rva), &directory[0],
+         directory.size() * sizeof(MDRawDirectory));
+  MDRawHeader* header = dump.At<MDRawHeader>(header_rva);
+  header->signature = MD_HEADER_SIGNATURE;
+  header->version = MD_HEADER_VERSION;
+  header->stream_count = static_cast<uint32_t>(directory.size());
+  header->stream_directory_rva = directory_rva;
+  header->time_date_stamp = static_cast<uint32_t>(time(NULL));
+  header->flags = MD_NORMAL;
+
+  DWORD bytes_written = 0;
+  if (!WriteFile(dump_file, dump.data(), static_cast<DWORD>(dump.size()),
+                 &bytes_written, NULL) ||
+      bytes_written != dump.size()) {
+    SetFilePointer(dump_file, 0, NULL, FILE_BEGIN);
+    SetEndOfFile(dump_file);
+    return false;
+  }
+  return true;
+#endif
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,107 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CLIENT_WINDOWS_CRASH_GENERATION_NATIVE_MINIDUMP_WRITER_H_
+#define CLIENT_WINDOWS_CRASH_GENERATION_NATIVE_MINIDUMP_WRITER_H_
+
+#include <windows.h>
+#include <dbghelp.h>
+
+#include <vector>
+
+#include "google_breakpad/common/minidump_format.h"
+
+namespace google_breakpad {
+
+// Writes a minidump equivalent to MiniDumpWriteDump's MiniDumpNormal type
+// without dbghelp.dll: thread, module, exception, memory, system info and
+// misc info streams, followed by any user streams.  Threads and modules
+// are enumerated with toolhelp snapshots, and each stack is copied with a
+// single ReadProcessMemory call.  Only x86 and x64 processes of the same
+// bitness as the writer are supported; WriteMinidump fails otherwise, and
+// callers should fall back to MiniDumpWriteDump.
+//
+// The process may be the current one.  The thread calling WriteMinidump
+// is then left out of the dump, and no heap memory is allocated while the
+// other threads are suspended.
+class NativeMinidumpWriter {
+ public:
+  // exception_pointers may be NULL for a dump without an exception stream.
+  // is_client_pointers specifies whether it points into process_handle's
+  // address space rather than the current one.
+  NativeMinidumpWriter(HANDLE process_handle,
+                       DWORD process_id,
+                       DWORD thread_id,
+                       EXCEPTION_POINTERS* exception_pointers,
+                       bool is_client_pointers);
+
+  // Includes size bytes at base in the process's memory in the dump's
+  // memory list.
+  void AddMemoryRange(ULONG64 base, ULONG size);
+
+  // Writes the minidump, with user_streams if not NULL, to dump_file,
+  // which must be empty.  Returns false, leaving dump_file empty, on
+  // failure.
+  bool WriteMinidump(HANDLE dump_file,
+                     const MINIDUMP_USER_STREAM_INFORMATION* user_streams);
+
+ private:
+  struct MemoryRange {
+    ULONG64 base;
+    ULONG size;
+  };
+
+  // Handle for the process to dump.
+  HANDLE process_handle_;
+
+  // Process ID for the process to dump.
+  DWORD process_id_;
+
+  // The crashing thread ID.
+  DWORD thread_id_;
+
+  // Pointer to the exception information for the crash.  This may point to
+  // an address in the crashing process so it should not be dereferenced.
+  EXCEPTION_POINTERS* exception_pointers_;
+
+  // Specifies whether exception_pointers_ references memory in the crashing
+  // process.
+  bool is_client_pointers_;
+
+  // Memory to include besides the thread stacks.
+  std::vector<MemoryRange> memory_ranges_;
+
+  // Disallow copy ctor and operator=.
+  NativeMinidumpWriter(const NativeMinidumpWriter&);
+  NativeMinidumpWriter& operator=(const NativeMinidumpWriter&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // CLIENT_WINDOWS_CRASH_GENERATION_NATIVE_MINIDUMP_WRITER_H_
@@ -36,6 +36,7 @@
 #include "common/windows/string_utils-inl.h"
 
 #include "client/windows/common/ipc_protocol.h"
+#include "client/windows/crash_generation/native_minidump_writer.h"
 #include "client/windows/handler/exception_handler.h"
 #include "common/windows/guid_string.h"
 
@@ -64,7 +65,8 @@ ExceptionHandler::ExceptionHandler(const wstring& dump_path,
                                    int handler_types,
                                    MINIDUMP_TYPE dump_type,
                                    const wchar_t* pipe_name,
-                                   const CustomClientInfo* custom_info) {
+                                   const CustomClientInfo* custom_info,
+                                   bool register_async) {
   Initialize(dump_path,
              filter,
              callback,
@@ -74,7 +76,8 @@ ExceptionHandler::ExceptionHandler(const wstring& dump_path,
              pipe_name,
              NULL,  // pipe_handle
              NULL,  // crash_generation_client
-             custom_info);
+             custom_info,
+             register_async);
 }
 
 ExceptionHandler::ExceptionHandler(const wstring& dump_path,
@@ -84,7 +87,8 @@ ExceptionHandler::ExceptionHandler(const wstring& dump_path,
                                    int handler_types,
                                    MINIDUMP_TYPE dump_type,
                                    HANDLE pipe_handle,
-                                   const CustomClientInfo* custom_info) {
+                                   const CustomClientInfo* custom_info,
+                                   bool register_async) {
   Initialize(dump_path,
              filter,
              callback,
@@ -94,7 +98,8 @@ ExceptionHandler::ExceptionHandler(const wstring& dump_path,
              NULL,  // pipe_name
              pipe_handle,
              NULL,  // crash_generation_client
-             custom_info);
+             custom_info,
+             register_async);
 }
 
 ExceptionHandler::ExceptionHandler(
@@ -115,7 +120,8 @@ ExceptionHandler::ExceptionHandler(
              NULL,                     // pipe_name - not used
              NULL,                     // pipe_handle
              crash_generation_client,
-             NULL);                    // custom_info - not used
+             NULL,                     // custom_info - not used
+             false);                   // register_async
 }
 
 ExceptionHandler::ExceptionHandler(const wstring& dump_path,
@@ -131,8 +137,9 @@ ExceptionHandler::ExceptionHandler(const wstring& dump_path,
              MiniDumpNormal,
              NULL,   // pipe_name
              NULL,   // pipe_handle
-             NULL,   // crash_generation_client
-             NULL);  // custom_info
+             NULL,    // crash_generation_client
+             NULL,    // custom_info
+             false);  // register_async
 }
 
 void ExceptionHandler::Initialize(
@@ -145,7 +152,8 @@ void ExceptionHandler::Initialize(
     const wchar_t* pipe_name,
     HANDLE pipe_handle,
     CrashGenerationClient* crash_generation_client,
-    const CustomClientInfo* custom_info) {
+    const CustomClientInfo* custom_info,
+    bool register_async) {
   LONG instance_count = InterlockedIncrement(&instance_count_);
   filter_ = filter;
   callback_ = callback;
@@ -174,6 +182,10 @@ void ExceptionHandler::Initialize(
   handler_return_value_ = false;
   handle_debug_exceptions_ = false;
   consume_invalid_handle_exceptions_ = false;
+  use_native_writer_ = false;
+  out_of_process_ = 0;
+  in_process_ = false;
+  registration_thread_ = NULL;
 
   // Attempt to use out-of-process if user has specified a pipe or a
   // crash generation client.
@@ -189,17 +201,23 @@ void ExceptionHandler::Initialize(
   }
 
   if (client.get() != NULL) {
-    // If successful in registering with the monitoring process,
-    // there is no need to setup in-process crash generation.
-    if (client->Register()) {
+    if (register_async) {
+      // Registration is done by registration_thread_ once the handler is
+      // fully set up.  In-process crash generation is used until then.
       crash_generation_client_.reset(client.release());
+    } else if (client->Register()) {
+      // If successful in registering with the monitoring process,
+      // there is no need to setup in-process crash generation.
+      crash_generation_client_.reset(client.release());
+      out_of_process_ = 1;
     }
   }
 
   if (!IsOutOfProcess()) {
-    // Either client did not ask for out-of-process crash generation
-    // or registration with the server process failed. In either case,
-    // setup to do in-process crash generation.
+    // Either client did not ask for out-of-process crash generation,
+    // registration with the server process failed, or it has not happened
+    // yet. In each case, setup to do in-process crash generation.
+    in_process_ = true;
 
     // Set synchronization primitives and the handler thread.  Each
     // ExceptionHandler object gets its own handler thread because that's the
@@ -290,9 +308,31 @@ void ExceptionHandler::Initialize(
 
     LeaveCriticalSection(&handler_stack_critical_section_);
   }
+
+  if (crash_generation_client_.get() != NULL && !IsOutOfProcess()) {
+    registration_thread_ = CreateThread(NULL,  // lpThreadAttributes
+                                        0,     // dwStackSize
+                                        RegistrationThreadMain,
+                                        this,  // lpParameter
+                                        0,     // dwCreationFlags
+                                        NULL);  // lpThreadId
+    assert(registration_thread_ != NULL);
+  }
 }
 
 ExceptionHandler::~ExceptionHandler() {
+  if (registration_thread_) {
+    // The registration thread may be blocked waiting for the server.  Don't
+    // let it finish registering a client that is about to be destroyed.
+#ifdef BREAKPAD_NO_TERMINATE_THREAD
+    WaitForSingleObject(registration_thread_, INFINITE);
+#else
+    TerminateThread(registration_thread_, 1);
+#endif  // BREAKPAD_NO_TERMINATE_THREAD
+    CloseHandle(registration_thread_);
+    registration_thread_ = NULL;
+  }
+
   if (dbghelp_module_) {
     FreeLibrary(dbghelp_module_);
   }
@@ -342,8 +382,8 @@ ExceptionHandler::~ExceptionHandler() {
   }
 
   // Some of the objects were only initialized if out of process
-  // registration was not done.
-  if (!IsOutOfProcess()) {
+  // registration was not done when the handler was created.
+  if (in_process_) {
 #ifdef BREAKPAD_NO_TERMINATE_THREAD
     // Clean up the handler thread and synchronization primitives. The handler
     // thread is either waiting on the semaphore to handle a crash or it is
@@ -412,6 +452,25 @@ DWORD ExceptionHandler::ExceptionHandlerThreadMain(void* lpParameter) {
   return 0;
 }
 
+// static
+DWORD ExceptionHandler::RegistrationThreadMain(void* lpParameter) {
+  ExceptionHandler* self = reinterpret_cast<ExceptionHandler*>(lpParameter);
+  assert(self);
+  assert(self->crash_generation_client_.get() != NULL);
+
+  if (!self->crash_generation_client_->Register()) {
+    // Keep using in-process crash generation.
+    return 1;
+  }
+
+  // The interlocked write is a full barrier, so a thread that sees
+  // out_of_process_ set also sees the client's registration state.  The
+  // in-process handler thread is left running; it is cleaned up by the
+  // destructor.
+  InterlockedExchange(&self->out_of_process_, 1);
+  return 0;
+}
+
 // HandleException and HandleInvalidParameter must create an
 // AutoExceptionHandler object to maintain static state and to determine which
 // ExceptionHandler instance to use.  The constructor locates the correct
@@ -916,7 +975,9 @@ bool ExceptionHandler::WriteMinidumpWithExceptionForProcess(
     HANDLE process,
     bool write_requester_stream) {
   bool success = false;
-  if (minidump_write_dump_) {
+  const bool use_native_writer =
+      use_native_writer_ && dump_type_ == MiniDumpNormal;
+  if (minidump_write_dump_ || use_native_writer) {
     HANDLE dump_file = CreateFile(next_minidump_path_c_,
                                   GENERIC_WRITE,
                                   0,  // no sharing
@@ -1021,14 +1082,31 @@ bool ExceptionHandler::WriteMinidumpWithExceptionForProcess(
       callback.CallbackRoutine = MinidumpWriteDumpCallback;
       callback.CallbackParam = reinterpret_cast<void*>(&context);
 
-      // The explicit comparison to TRUE avoids a warning (C4800).
-      success = (minidump_write_dump_(process,
-                                      GetProcessId(process),
-                                      dump_file,
-                                      dump_type_,
-                                      exinfo ? &except_info : NULL,
-                                      &user_streams,
-                                      &callback) == TRUE);
+      if (use_native_writer) {
+        // The native writer includes the memory around the instruction
+        // pointer itself, so only the registered app memory is passed on.
+        NativeMinidumpWriter native_writer(process,
+                                           GetProcessId(process),
+                                           requesting_thread_id,
+                                           exinfo,
+                                           false);
+        AppMemoryList::const_iterator iter = app_memory_info_.begin();
+        for (++iter; iter != app_memory_info_.end(); ++iter) {
+          native_writer.AddMemoryRange(iter->ptr, iter->length);
+        }
+        success = native_writer.WriteMinidump(dump_file, &user_streams);
+      }
+
+      if (!success && minidump_write_dump_) {
+        // The explicit comparison to TRUE avoids a warning (C4800).
+        success = (minidump_write_dump_(process,
+                                        GetProcessId(process),
+                                        dump_file,
+                                        dump_type_,
+                                        exinfo ? &except_info : NULL,
+                                        &user_streams,
+                                        &callback) == TRUE);
+      }
 
       CloseHandle(dump_file);
     }
@@ -175,6 +175,12 @@ class ExceptionHandler {
   // NULL, or if out-of-process dump generation registration step fails,
   // in-process dump generation will be used. This also allows specifying
   // the dump type to generate.
+  //
+  // Registering with the server may block for several seconds if the server
+  // is busy or still starting.  If register_async is true, the constructor
+  // returns at once with in-process dump generation set up, registration
+  // happens on a background thread, and dumps are generated out-of-process
+  // from the moment it succeeds.  A crash before then is handled in-process.
   ExceptionHandler(const wstring& dump_path,
                    FilterCallback filter,
                    MinidumpCallback callback,
@@ -182,7 +188,8 @@ class ExceptionHandler {
                    int handler_types,
                    MINIDUMP_TYPE dump_type,
                    const wchar_t* pipe_name,
-                   const CustomClientInfo* custom_info);
+                   const CustomClientInfo* custom_info,
+                   bool register_async = false);
 
   // As above, creates a new ExceptionHandler instance to perform
   // out-of-process dump generation if the given pipe_handle is not NULL.
@@ -193,7 +200,8 @@ class ExceptionHandler {
                    int handler_types,
                    MINIDUMP_TYPE dump_type,
                    HANDLE pipe_handle,
-                   const CustomClientInfo* custom_info);
+                   const CustomClientInfo* custom_info,
+                   bool register_async = false);
 
   // ExceptionHandler that ENSURES out-of-process dump generation.  Expects a
   // crash generation client that is already registered with a crash generation
@@ -274,8 +282,17 @@ class ExceptionHandler {
     consume_invalid_handle_exceptions_ = consume_invalid_handle_exceptions;
   }
 
-  // Returns whether out-of-process dump generation is used or not.
-  bool IsOutOfProcess() const { return crash_generation_client_.get() != NULL; }
+  // Controls whether in-process MiniDumpNormal dumps are written by
+  // NativeMinidumpWriter rather than dbghelp.dll, which is then only used
+  // if the native writer fails.  Such dumps leave out the handler thread.
+  bool get_use_native_writer() const { return use_native_writer_; }
+  void set_use_native_writer(bool use_native_writer) {
+    use_native_writer_ = use_native_writer;
+  }
+
+  // Returns whether out-of-process dump generation is used or not.  With
+  // asynchronous registration this turns true once registration succeeds.
+  bool IsOutOfProcess() const { return out_of_process_ != 0; }
 
   // Calling RegisterAppMemory(p, len) causes len bytes starting
   // at address p to be copied to the minidump when a crash happens.
@@ -295,7 +312,8 @@ class ExceptionHandler {
                   const wchar_t* pipe_name,
                   HANDLE pipe_handle,
                   CrashGenerationClient* crash_generation_client,
-                  const CustomClientInfo* custom_info);
+                  const CustomClientInfo* custom_info,
+                  bool register_async);
 
   // Function pointer type for MiniDumpWriteDump, which is looked up
   // dynamically.
@@ -314,6 +332,11 @@ class ExceptionHandler {
   // Runs the main loop for the exception handler thread.
   static DWORD WINAPI ExceptionHandlerThreadMain(void* lpParameter);
 
+  // Registers crash_generation_client_ with the server and switches the
+  // handler to out-of-process dump generation if that succeeds.  Runs on
+  // registration_thread_.
+  static DWORD WINAPI RegistrationThreadMain(void* lpParameter);
+
   // Called on the exception thread when an unhandled exception occurs.
   // Signals the exception handler thread to handle the exception.
   static LONG WINAPI HandleException(EXCEPTION_POINTERS* exinfo);
@@ -388,6 +411,19 @@ class ExceptionHandler {
 
   scoped_ptr<CrashGenerationClient> crash_generation_client_;
 
+  // Nonzero once crash_generation_client_ is registered with the server.
+  // Set with InterlockedExchange so that a crashing thread sees either the
+  // in-process handler or a fully registered client.
+  volatile LONG out_of_process_;
+
+  // True if the handler thread and the rest of the in-process dump
+  // generation state were set up.
+  bool in_process_;
+
+  // The thread registering crash_generation_client_ with the server when
+  // registration is asynchronous, or NULL.
+  HANDLE registration_thread_;
+
   // The directory in which a minidump will be written, set by the dump_path
   // argument to the constructor, or set_dump_path.
   wstring dump_path_;
@@ -487,6 +523,11 @@ class ExceptionHandler {
   // Leave this false (the default) to handle these exceptions as normal.
   bool consume_invalid_handle_exceptions_;
 
+  // If true, in-process MiniDumpNormal dumps are written by
+  // NativeMinidumpWriter.  Leave this false (the default) to write every
+  // dump with dbghelp.dll.
+  bool use_native_writer_;
+
   // Callers can request additional memory regions to be included in
   // the dump.
   AppMemoryList app_memory_info_;
@@ -300,4 +300,53 @@ TEST_F(CrashGenerationServerTest, SendInvalidAck) {
   ASSERT_NO_FATAL_FAILURE(FaultyClient(CLOSE_AFTER_CONNECT));
 }
 
+// A server with several pipe instances accepts that many connections at
+// once, and the next client finds the pipe busy.
+TEST_F(CrashGenerationServerTest, MultiplePipeInstances) {
+  const wchar_t kMultiPipeName[] =
+      L"\\\\.\\pipe\\CrashGenerationServerTest\\MultiInstanceServer";
+  const int kInstanceCount = 4;
+  google_breakpad::CrashGenerationServer server(kMultiPipeName,
+                                                NULL,
+                                                NULL, NULL,
+                                                NULL, NULL,
+                                                NULL, NULL,
+                                                NULL, NULL,
+                                                false,
+                                                NULL);
+  server.set_pipe_instance_count(kInstanceCount);
+  ASSERT_TRUE(server.Start());
+
+  HANDLE pipes[kInstanceCount];
+  for (int i = 0; i < kInstanceCount; ++i) {
+    pipes[i] = CreateFile(kMultiPipeName,
+                          kPipeDesiredAccess,
+                          0,
+                          NULL,
+                          OPEN_EXISTING,
+                          kPipeFlagsAndAttributes,
+                          NULL);
+    EXPECT_NE(pipes[i], INVALID_HANDLE_VALUE);
+  }
+
+  HANDLE extra_pipe = CreateFile(kMultiPipeName,
+                                 kPipeDesiredAccess,
+                                 0,
+                                 NULL,
+                                 OPEN_EXISTING,
+                                 kPipeFlagsAndAttributes,
+                                 NULL);
+  EXPECT_EQ(extra_pipe, INVALID_HANDLE_VALUE);
+  EXPECT_EQ(ERROR_PIPE_BUSY, GetLastError());
+
+  for (int i = 0; i < kInstanceCount; ++i) {
+    if (pipes[i] != INVALID_HANDLE_VALUE) {
+      CloseHandle(pipes[i]);
+    }
+  }
+  if (extra_pipe != INVALID_HANDLE_VALUE) {
+    CloseHandle(extra_pipe);
+  }
+}
+
 }  // anonymous namespace
@@ -395,6 +395,47 @@ TEST_F(ExceptionHandlerTest, WriteMinidumpTest) {
   // TODO(ted): more comprehensive tests...
 }
 
+// Test that with asynchronous registration the handler writes dumps
+// in-process until it is registered, then switches to out-of-process.
+TEST_F(ExceptionHandlerTest, AsyncRegistration) {
+  wstring dump_path(temp_path_);
+  google_breakpad::CrashGenerationServer server(
+      kPipeName, NULL, NULL, NULL, ClientDumpCallback, NULL, NULL, NULL, NULL,
+      NULL, true, &dump_path);
+
+  // Without a server the handler stays in-process.
+  {
+    ExceptionHandler handler(temp_path_, NULL, DumpCallback, NULL,
+                             ExceptionHandler::HANDLER_NONE, MiniDumpNormal,
+                             kPipeName, NULL, true);
+    Sleep(100);
+    EXPECT_FALSE(handler.IsOutOfProcess());
+
+    // Disable GTest SEH handler
+    testing::DisableExceptionHandlerInScope disable_exception_handler;
+    ASSERT_TRUE(handler.WriteMinidump());
+    ASSERT_FALSE(dump_file.empty());
+    EXPECT_TRUE(DoesPathExist(dump_file.c_str()));
+    ::DeleteFile(dump_file.c_str());
+    dump_file = L"";
+  }
+
+  ASSERT_TRUE(server.Start());
+  ExceptionHandler handler(temp_path_, NULL, NULL, NULL,
+                           ExceptionHandler::HANDLER_NONE, MiniDumpNormal,
+                           kPipeName, NULL, true);
+  for (int i = 0; i < 100 && !handler.IsOutOfProcess(); ++i) {
+    Sleep(50);
+  }
+  ASSERT_TRUE(handler.IsOutOfProcess());
+
+  // Disable GTest SEH handler
+  testing::DisableExceptionHandlerInScope disable_exception_handler;
+  ASSERT_TRUE(handler.WriteMinidump());
+  ASSERT_FALSE(dump_file.empty());
+  EXPECT_TRUE(DoesPathExist(dump_file.c_str()));
+}
+
 // Test that an additional memory region can be included in the minidump.
 TEST_F(ExceptionHandlerTest, AdditionalMemory) {
   SYSTEM_INFO si;
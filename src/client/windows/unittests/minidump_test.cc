@@ -85,7 +85,7 @@ class MinidumpTest: public testing::Test {
     }
   }
 
-  bool WriteDump(ULONG flags) {
+  bool WriteDump(ULONG flags, bool use_native_writer = false) {
     using google_breakpad::MinidumpGenerator;
 
     // Fake exception is access violation on write to this.
@@ -112,6 +112,7 @@ class MinidumpTest: public testing::Test {
                                 NULL,
                                 static_cast<MINIDUMP_TYPE>(flags),
                                 TRUE);
+    generator.SetUseNativeWriter(use_native_writer);
     generator.GenerateDumpFile(&dump_file_);
     generator.GenerateFullDumpFile(&full_dump_file_);
     // And write a dump
@@ -208,6 +209,32 @@ TEST_F(MinidumpTest, Normal) {
   EXPECT_FALSE(mini.HasMemory(this));
 }
 
+TEST_F(MinidumpTest, NativeNormal) {
+  EXPECT_TRUE(WriteDump(MiniDumpNormal, true));
+  DumpAnalysis mini(dump_file_);
+
+  // We expect the same streams as from dbghelp.dll.
+  EXPECT_TRUE(mini.HasStream(ThreadListStream));
+  EXPECT_TRUE(mini.HasStream(ModuleListStream));
+  EXPECT_TRUE(mini.HasStream(MemoryListStream));
+  EXPECT_TRUE(mini.HasStream(ExceptionStream));
+  EXPECT_TRUE(mini.HasStream(SystemInfoStream));
+  EXPECT_TRUE(mini.HasStream(MiscInfoStream));
+
+  EXPECT_FALSE(mini.HasStream(ThreadExListStream));
+  EXPECT_FALSE(mini.HasStream(Memory64ListStream));
+  EXPECT_FALSE(mini.HasStream(HandleDataStream));
+  EXPECT_FALSE(mini.HasStream(UnloadedModuleListStream));
+  EXPECT_FALSE(mini.HasStream(MemoryInfoListStream));
+
+  // We expect no PEB nor TEBs in this dump.
+  EXPECT_FALSE(mini.HasTebs());
+  EXPECT_FALSE(mini.HasPeb());
+
+  // We expect no off-stack memory in this dump.
+  EXPECT_FALSE(mini.HasMemory(this));
+}
+
 TEST_F(MinidumpTest, SmallDump) {
   ASSERT_TRUE(WriteDump(kSmallDumpType));
   DumpAnalysis mini(dump_file_);
@@ -0,0 +1,231 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef COMMON_ANNOTATION_TABLE_H_
+#define COMMON_ANNOTATION_TABLE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "common/simple_string_dictionary.h"
+
+namespace google_breakpad {
+
+// AnnotationTable is a fixed-size map of crash annotations that many
+// threads can update at once without a lock, and that a crash handler can
+// read from a signal handler.
+//
+// A key is hashed to a slot and probes linearly from there. Once a slot
+// holds a key it keeps it. Removing a key only empties its value, and
+// setting the key again reuses the slot. At most NumEntries distinct keys
+// can ever be set. Each slot's value is guarded by a sequence lock: a
+// writer makes the sequence odd while it copies the value in, and a reader
+// copies the value out and tries again if the sequence was odd or changed.
+// Writers of the same key wait for each other; writers of different keys
+// never do. A writer can wait for the thread it interrupted, so signal
+// handlers may only read.
+//
+// KeySize and ValueSize include space for a \0 byte, as in
+// NonAllocatingMap. Keys and values are truncated to fit.
+template <size_t KeySize, size_t ValueSize, size_t NumEntries>
+class AnnotationTable {
+ public:
+  static const size_t key_size = KeySize;
+  static const size_t value_size = ValueSize;
+  static const size_t num_entries = NumEntries;
+
+  AnnotationTable() : slots_() {}
+
+  // Stores |value| into |key|, replacing the existing value if |key| is
+  // already present. A NULL |value| removes the key. Returns an index that
+  // SetValueAtIndex() takes, or |num_entries| if |key| is empty or the table
+  // is full, or |value| is NULL.
+  size_t SetKeyValue(const char* key, const char* value) {
+    if (!value) {
+      RemoveKey(key);
+      return num_entries;
+    }
+    if (!key || key[0] == '\0')
+      return num_entries;
+    const size_t index = FindSlot(key, true);
+    if (index != num_entries)
+      SetValueAtIndex(index, value);
+    return index;
+  }
+
+  // Sets a value for a key using the index SetKeyValue() returned for it.
+  void SetValueAtIndex(size_t index, const char* value) {
+    if (index >= num_entries)
+      return;
+    Slot* slot = &slots_[index];
+    uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    do {
+      while (sequence & 1)
+        sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&slot->sequence, &sequence,
+                                          sequence + 1, true, __ATOMIC_ACQUIRE,
+                                          __ATOMIC_RELAXED));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    size_t length = 0;
+    if (value) {
+      while (length < ValueSize - 1 && value[length])
+        ++length;
+      memcpy(slot->value, value, length);
+    }
+    slot->value[length] = '\0';
+
+    __atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+  }
+
+  // Empties the value of |key|, if it is present.
+  void RemoveKey(const char* key) {
+    if (key)
+      SetValueAtIndex(FindSlot(key, false), NULL);
+  }
+
+  // Copies the value of |key| into |value|, which must hold ValueSize
+  // bytes. Returns false if |key| has no value, or if a writer held the
+  // value for the whole of the read. Safe in a signal handler.
+  bool GetValueForKey(const char* key, char* value) const {
+    if (!key)
+      return false;
+    const size_t index = FindSlot(key, false);
+    return index != num_entries && ReadValue(slots_[index], value) &&
+        value[0] != '\0';
+  }
+
+  // Copies every key with a value into |map|, replacing what it held. A
+  // value a writer holds for the whole of the read is left out. Safe in a
+  // signal handler.
+  void Snapshot(NonAllocatingMap<KeySize, ValueSize, NumEntries>* map) const {
+    for (size_t i = 0; i < num_entries; ++i)
+      map->RemoveAtIndex(i);
+    char value[ValueSize];
+    for (size_t i = 0; i < num_entries; ++i) {
+      const Slot& slot = slots_[i];
+      if (__atomic_load_n(&slot.key_hash, __ATOMIC_ACQUIRE) < kFirstHash)
+        continue;
+      if (ReadValue(slot, value) && value[0] != '\0')
+        map->SetKeyValue(slot.key, value);
+    }
+  }
+
+ private:
+  // The values of a slot's |key_hash| before its key is published. Hashes
+  // are kept clear of them.
+  enum {
+    kEmpty = 0,
+    kClaimed = 1,
+    kFirstHash = 2
+  };
+
+  // How many times a reader tries for a consistent copy of a value.
+  static const int kReadAttempts = 1000;
+
+  struct Slot {
+    uint32_t key_hash;
+    uint32_t sequence;  // odd while a writer is changing |value|
+    char key[KeySize];
+    char value[ValueSize];
+  };
+
+  // FNV-1a of the part of |key| a slot keeps.
+  static uint32_t Hash(const char* key) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < KeySize - 1 && key[i]; ++i) {
+      hash ^= static_cast<uint8_t>(key[i]);
+      hash *= 16777619u;
+    }
+    return hash < kFirstHash ? hash + kFirstHash : hash;
+  }
+
+  // Returns the index of the slot holding |key|, claiming an empty one for
+  // it if |claim|, or |num_entries|. A reader skips slots whose key isn't
+  // published yet, and a claiming writer waits for it.
+  size_t FindSlot(const char* key, bool claim) const {
+    const uint32_t hash = Hash(key);
+    for (size_t probe = 0; probe < num_entries; ++probe) {
+      const size_t index = (hash + probe) % num_entries;
+      Slot* slot = const_cast<Slot*>(&slots_[index]);
+      uint32_t state = __atomic_load_n(&slot->key_hash, __ATOMIC_ACQUIRE);
+      if (state == kEmpty) {
+        if (!claim)
+          return num_entries;
+        if (__atomic_compare_exchange_n(&slot->key_hash, &state, kClaimed,
+                                        false, __ATOMIC_ACQUIRE,
+                                        __ATOMIC_ACQUIRE)) {
+          size_t length = 0;
+          while (length < KeySize - 1 && key[length])
+            ++length;
+          memcpy(slot->key, key, length);
+          slot->key[length] = '\0';
+          __atomic_store_n(&slot->key_hash, hash, __ATOMIC_RELEASE);
+          return index;
+        }
+      }
+      while (claim && state == kClaimed)
+        state = __atomic_load_n(&slot->key_hash, __ATOMIC_ACQUIRE);
+      if (state == hash && strncmp(slot->key, key, KeySize - 1) == 0)
+        return index;
+    }
+    return num_entries;
+  }
+
+  static bool ReadValue(const Slot& slot, char* value) {
+    for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+      const uint32_t sequence =
+          __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+      if (sequence & 1)
+        continue;
+      memcpy(value, slot.value, ValueSize);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) == sequence) {
+        value[ValueSize - 1] = '\0';
+        return true;
+      }
+    }
+    return false;
+  }
+
+  Slot slots_[NumEntries];
+
+  DISALLOW_COPY_AND_ASSIGN(AnnotationTable);
+};
+
+template <size_t KeySize, size_t ValueSize, size_t NumEntries>
+const size_t AnnotationTable<KeySize, ValueSize, NumEntries>::key_size;
+template <size_t KeySize, size_t ValueSize, size_t NumEntries>
+const size_t AnnotationTable<KeySize, ValueSize, NumEntries>::value_size;
+template <size_t KeySize, size_t ValueSize, size_t NumEntries>
+const size_t AnnotationTable<KeySize, ValueSize, NumEntries>::num_entries;
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_ANNOTATION_TABLE_H_
@@ -0,0 +1,162 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdio.h>
+
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/annotation_table.h"
+
+namespace google_breakpad {
+
+TEST(AnnotationTableTest, SetGetRemove) {
+  typedef AnnotationTable<8, 16, 4> TestTable;
+  TestTable table;
+  char value[TestTable::value_size];
+
+  EXPECT_FALSE(table.GetValueForKey("url", value));
+  const size_t index = table.SetKeyValue("url", "example.com");
+  ASSERT_LT(index, TestTable::num_entries);
+  ASSERT_TRUE(table.GetValueForKey("url", value));
+  EXPECT_STREQ("example.com", value);
+
+  // A key keeps its slot.
+  EXPECT_EQ(index, table.SetKeyValue("url", "example.org/a/long/path"));
+  ASSERT_TRUE(table.GetValueForKey("url", value));
+  EXPECT_STREQ("example.org/a/l", value);
+  table.SetValueAtIndex(index, "b");
+  ASSERT_TRUE(table.GetValueForKey("url", value));
+  EXPECT_STREQ("b", value);
+
+  table.RemoveKey("url");
+  EXPECT_FALSE(table.GetValueForKey("url", value));
+  EXPECT_EQ(index, table.SetKeyValue("url", "c"));
+  EXPECT_EQ(TestTable::num_entries, table.SetKeyValue("url", NULL));
+  EXPECT_FALSE(table.GetValueForKey("url", value));
+
+  EXPECT_EQ(TestTable::num_entries, table.SetKeyValue("", "d"));
+  EXPECT_EQ(TestTable::num_entries, table.SetKeyValue(NULL, "d"));
+}
+
+TEST(AnnotationTableTest, LongKeys) {
+  AnnotationTable<4, 8, 4> table;
+  char value[8];
+  table.SetKeyValue("abcdef", "1");
+  // Keys are compared as they are kept.
+  ASSERT_TRUE(table.GetValueForKey("abc", value));
+  EXPECT_STREQ("1", value);
+  ASSERT_TRUE(table.GetValueForKey("abcxyz", value));
+  EXPECT_FALSE(table.GetValueForKey("ab", value));
+}
+
+TEST(AnnotationTableTest, Full) {
+  typedef AnnotationTable<8, 8, 4> TestTable;
+  TestTable table;
+  char key[8];
+  for (size_t i = 0; i < TestTable::num_entries; ++i) {
+    snprintf(key, sizeof(key), "key%zu", i);
+    EXPECT_LT(table.SetKeyValue(key, "v"), TestTable::num_entries);
+  }
+  EXPECT_EQ(TestTable::num_entries, table.SetKeyValue("more", "v"));
+  // A removed key's slot stays with it.
+  table.RemoveKey("key0");
+  EXPECT_EQ(TestTable::num_entries, table.SetKeyValue("more", "v"));
+  char value[8];
+  for (size_t i = 1; i < TestTable::num_entries; ++i) {
+    snprintf(key, sizeof(key), "key%zu", i);
+    ASSERT_TRUE(table.GetValueForKey(key, value));
+    EXPECT_STREQ("v", value);
+  }
+}
+
+TEST(AnnotationTableTest, Snapshot) {
+  typedef AnnotationTable<8, 8, 8> TestTable;
+  TestTable table;
+  table.SetKeyValue("a", "1");
+  table.SetKeyValue("b", "2");
+  table.SetKeyValue("c", "3");
+  table.RemoveKey("b");
+
+  NonAllocatingMap<8, 8, 8> map;
+  map.SetKeyValue("stale", "x");
+  table.Snapshot(&map);
+  EXPECT_EQ(2u, map.GetCount());
+  EXPECT_STREQ("1", map.GetValueForKey("a"));
+  EXPECT_STREQ("3", map.GetValueForKey("c"));
+  EXPECT_FALSE(map.GetValueForKey("b"));
+  EXPECT_FALSE(map.GetValueForKey("stale"));
+}
+
+TEST(AnnotationTableTest, Threads) {
+  typedef AnnotationTable<16, 32, 64> TestTable;
+  static TestTable table;
+  const int kThreads = 8;
+  const int kUpdates = 20000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.push_back(std::thread([t]() {
+      char key[16];
+      char value[32];
+      for (int i = 0; i < kUpdates; ++i) {
+        // Each thread writes its own key and one that all of them share.
+        snprintf(key, sizeof(key), "thread%d", t);
+        snprintf(value, sizeof(value), "%d-%d-%d", t, i, t);
+        table.SetKeyValue(key, value);
+        table.SetKeyValue("shared", value);
+      }
+    }));
+  }
+
+  // Every value read is one that was written whole.
+  char value[32];
+  for (int i = 0; i < kUpdates; ++i) {
+    if (table.GetValueForKey("shared", value)) {
+      int t1, n, t2;
+      ASSERT_EQ(3, sscanf(value, "%d-%d-%d", &t1, &n, &t2));
+      ASSERT_EQ(t1, t2);
+    }
+  }
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  NonAllocatingMap<16, 32, 64> map;
+  table.Snapshot(&map);
+  EXPECT_EQ(static_cast<size_t>(kThreads + 1), map.GetCount());
+  char key[16];
+  char expected[32];
+  for (int t = 0; t < kThreads; ++t) {
+    snprintf(key, sizeof(key), "thread%d", t);
+    snprintf(expected, sizeof(expected), "%d-%d-%d", t, kUpdates - 1, t);
+    EXPECT_STREQ(expected, map.GetValueForKey(key));
+  }
+}
+
+}  // namespace google_breakpad
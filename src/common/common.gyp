@@ -33,8 +33,8 @@
         'defines': ['HAVE_MACH_O_NLIST_H'],
       }],
       ['OS=="linux"', {
-        # Assume glibc.
-        'defines': ['HAVE_A_OUT_H', 'HAVE_GETCONTEXT'],
+        # Assume glibc, and zlib for compressed debug sections.
+        'defines': ['HAVE_A_OUT_H', 'HAVE_GETCONTEXT', 'HAVE_LIBZ'],
         'sources!': [
           'linux/breakpad_getcontext.S',
           'linux/breakpad_getcontext.h',
@@ -62,6 +62,7 @@
         'android/testing/mkdtemp.h',
         'android/testing/pthread_fixes.h',
         'android/ucontext_constants.h',
+        'annotation_table.h',
         'basictypes.h',
         'byte_cursor.h',
         'convert_UTF.cc',
@@ -85,14 +86,22 @@
         'dwarf/types.h',
         'dwarf_cfi_to_module.cc',
         'dwarf_cfi_to_module.h',
+        'dwarf_cu_cache.cc',
+        'dwarf_cu_cache.h',
         'dwarf_cu_to_module.cc',
         'dwarf_cu_to_module.h',
         'dwarf_line_to_module.cc',
         'dwarf_line_to_module.h',
+        'fast_module_writer.cc',
+        'fast_module_writer.h',
         'language.cc',
         'language.h',
         'linux/breakpad_getcontext.S',
         'linux/breakpad_getcontext.h',
+        'linux/compressed_section.cc',
+        'linux/compressed_section.h',
+        'linux/crashdump_upload_queue.cc',
+        'linux/crashdump_upload_queue.h',
         'linux/crc32.cc',
         'linux/crc32.h',
         'linux/dump_symbols.cc',
@@ -184,6 +193,7 @@
         'test_assembler.h',
         'unordered.h',
         'using_std_string.h',
+        'utf16_ascii.h',
         'windows/common_windows.gyp',
         'windows/dia_util.cc',
         'windows/dia_util.h',
@@ -194,28 +204,46 @@
         'windows/omap.cc',
         'windows/omap.h',
         'windows/omap_internal.h',
+        'windows/pdb_reader.cc',
+        'windows/pdb_reader.h',
         'windows/pdb_source_line_writer.cc',
         'windows/pdb_source_line_writer.h',
+        'windows/pe_unwind_reader.cc',
+        'windows/pe_unwind_reader.h',
         'windows/string_utils-inl.h',
         'windows/string_utils.cc',
       ],
       'include_dirs': [
         '..',
       ],
+      'conditions': [
+        ['OS=="linux"', {
+          'link_settings': {
+            'libraries': [
+              '-lz',
+            ],
+          },
+        }],
+      ],
     },
     {
       'target_name': 'common_unittests',
       'type': 'executable',
       'sources': [
+        'annotation_table_unittest.cc',
         'byte_cursor_unittest.cc',
         'dwarf/bytereader_unittest.cc',
         'dwarf/dwarf2diehandler_unittest.cc',
         'dwarf/dwarf2reader_cfi_unittest.cc',
         'dwarf/dwarf2reader_die_unittest.cc',
         'dwarf_cfi_to_module_unittest.cc',
+        'dwarf_cu_cache_unittest.cc',
         'dwarf_cu_to_module_unittest.cc',
         'dwarf_line_to_module_unittest.cc',
+        'fast_module_writer_unittest.cc',
         'linux/breakpad_getcontext_unittest.cc',
+        'linux/compressed_section_unittest.cc',
+        'linux/crashdump_upload_queue_test.cc',
         'linux/dump_symbols_unittest.cc',
         'linux/elf_core_dump_unittest.cc',
         'linux/elf_symbols_to_module_unittest.cc',
@@ -242,12 +270,15 @@
         'tests/file_utils.cc',
         'tests/file_utils.h',
         'windows/omap_unittest.cc',
+        'windows/pdb_reader_unittest.cc',
+        'windows/pe_unwind_reader_unittest.cc',
       ],
       'include_dirs': [
         '..',
       ],
       'dependencies': [
         'common',
+        '../processor/processor.gyp:processor',
         '../build/testing.gyp:gmock_main',
         '../build/testing.gyp:gmock',
         '../build/testing.gyp:gtest',
@@ -97,6 +97,12 @@ inline uint64_t ByteReader::ReadEightBytes(const uint8_t* buffer) const {
 
 inline uint64_t ByteReader::ReadUnsignedLEB128(const uint8_t* buffer,
                                              size_t* len) const {
+  // Most numbers in DWARF data fit in a single byte.
+  if (!(*buffer & 0x80)) {
+    *len = 1;
+    return *buffer;
+  }
+
   uint64_t result = 0;
   size_t num_read = 0;
   unsigned int shift = 0;
@@ -122,6 +128,12 @@ inline uint64_t ByteReader::ReadUnsignedLEB128(const uint8_t* buffer,
 
 inline int64_t ByteReader::ReadSignedLEB128(const uint8_t* buffer,
                                           size_t* len) const {
+  // Most numbers in DWARF data fit in a single byte.
+  if (!(*buffer & 0x80)) {
+    *len = 1;
+    return (*buffer & 0x40) ? static_cast<int64_t>(*buffer) - 0x80 : *buffer;
+  }
+
   int64_t result = 0;
   unsigned int shift = 0;
   size_t num_read = 0;
@@ -88,6 +88,41 @@ TEST_F(Reader, SimpleConstructor) {
   EXPECT_EQ(0xfec319c9, reader.ReadAddress(data + 35));
 }
 
+// Numbers that fit in one byte, and those just too big to, read the same
+// as any other.
+TEST_F(Reader, ShortLEB128) {
+  ByteReader reader(ENDIANNESS_LITTLE);
+  CFISection section(kLittleEndian, 4);
+  section
+    .ULEB128(0)
+    .ULEB128(0x7f)
+    .ULEB128(0x80)
+    .LEB128(0x3f)
+    .LEB128(-0x40)
+    .LEB128(-1)
+    .LEB128(0x40)
+    .LEB128(-0x41);
+  ASSERT_TRUE(section.GetContents(&contents));
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(contents.data());
+  size_t leb128_size;
+  EXPECT_EQ(0U, reader.ReadUnsignedLEB128(data, &leb128_size));
+  EXPECT_EQ(1U, leb128_size);
+  EXPECT_EQ(0x7fU, reader.ReadUnsignedLEB128(data + 1, &leb128_size));
+  EXPECT_EQ(1U, leb128_size);
+  EXPECT_EQ(0x80U, reader.ReadUnsignedLEB128(data + 2, &leb128_size));
+  EXPECT_EQ(2U, leb128_size);
+  EXPECT_EQ(0x3f, reader.ReadSignedLEB128(data + 4, &leb128_size));
+  EXPECT_EQ(1U, leb128_size);
+  EXPECT_EQ(-0x40, reader.ReadSignedLEB128(data + 5, &leb128_size));
+  EXPECT_EQ(1U, leb128_size);
+  EXPECT_EQ(-1, reader.ReadSignedLEB128(data + 6, &leb128_size));
+  EXPECT_EQ(1U, leb128_size);
+  EXPECT_EQ(0x40, reader.ReadSignedLEB128(data + 7, &leb128_size));
+  EXPECT_EQ(2U, leb128_size);
+  EXPECT_EQ(-0x41, reader.ReadSignedLEB128(data + 9, &leb128_size));
+  EXPECT_EQ(2U, leb128_size);
+}
+
 TEST_F(Reader, ValidEncodings) {
   ByteReader reader(ENDIANNESS_LITTLE);
   EXPECT_TRUE(reader.ValidEncoding(
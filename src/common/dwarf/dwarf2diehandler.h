@@ -284,6 +284,14 @@ class RootDIEHandler : public DIEHandler {
   //
   // The default definition elects to visit the root DIE.
   virtual bool StartRootDIE(uint64_t offset, enum DwarfTag tag) { return true; }
+
+  // Return false if no handler for a DIE in the compilation unit would
+  // return a handler from FindChildHandler for a child tagged TAG.  Such
+  // DIEs, and everything within them, are then stepped over without
+  // being visited at all.
+  //
+  // The default definition wants DIEs with every tag.
+  virtual bool WantsTag(enum DwarfTag tag) { return true; }
 };
 
 class DIEDispatcher: public Dwarf2Handler {
@@ -299,6 +307,11 @@ class DIEDispatcher: public Dwarf2Handler {
                             uint8_t offset_size, uint64_t cu_length,
                             uint8_t dwarf_version);
   bool StartDIE(uint64_t offset, enum DwarfTag tag);
+  bool WantsDIEsTagged(enum DwarfTag tag) {
+    return root_handler_->WantsTag(tag);
+  }
+  // A DIE without a handler has none of its children visited.
+  bool SkipsChildrenOfSkippedDIEs() { return true; }
   void ProcessAttributeUnsigned(uint64_t offset,
                                 enum DwarfAttribute attr,
                                 enum DwarfForm form,
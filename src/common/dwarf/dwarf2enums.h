@@ -574,6 +574,15 @@ enum DwarfOpcode {
   DW_OP_GNU_const_index              =0xfc
 };
 
+// Name index entry attributes, in .debug_names abbreviations (DWARF 5).
+enum DwarfNameIndexAttribute {
+  DW_IDX_compile_unit = 1,
+  DW_IDX_type_unit = 2,
+  DW_IDX_die_offset = 3,
+  DW_IDX_parent = 4,
+  DW_IDX_type_hash = 5
+};
+
 // Section identifiers for DWP files
 enum DwarfSectionId {
   DW_SECT_INFO = 1,
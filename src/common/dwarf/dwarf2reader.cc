@@ -37,6 +37,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <stack>
@@ -70,14 +71,15 @@ CompilationUnit::CompilationUnit(const string& path,
                                  ByteReader* reader, Dwarf2Handler* handler)
     : path_(path), offset_from_section_start_(offset), reader_(reader),
       sections_(sections), handler_(handler), abbrevs_(),
+      abbrev_cache_(NULL), split_dwarf_files_(NULL),
+      own_split_dwarf_files_(), root_die_only_(false), die_offsets_(NULL),
       string_buffer_(NULL), string_buffer_length_(0),
       line_string_buffer_(NULL), line_string_buffer_length_(0),
       str_offsets_buffer_(NULL), str_offsets_buffer_length_(0),
       addr_buffer_(NULL), addr_buffer_length_(0),
       is_split_dwarf_(false), is_type_unit_(false), dwo_id_(0), dwo_name_(),
       skeleton_dwo_id_(0), ranges_base_(0), addr_base_(0),
-      str_offsets_base_(0), have_checked_for_dwp_(false), dwp_path_(),
-      dwp_byte_reader_(), dwp_reader_() {}
+      str_offsets_base_(0) {}
 
 // Initialize a compilation unit from a .dwo or .dwp file.
 // In this case, we need the .debug_addr section from the
@@ -107,6 +109,66 @@ void CompilationUnit::SetSplitDwarf(const uint8_t* addr_buffer,
 // zero for the form.  The entire abbreviation section is terminated
 // by a zero for the code.
 
+// Account for an attribute of FORM in ABBREV's skip sizes, or note that
+// the attribute's size can only be found by reading it.
+static void AddToSkipSize(enum DwarfForm form,
+                          CompilationUnit::Abbrev* abbrev) {
+  switch (form) {
+    case DW_FORM_flag_present:
+    case DW_FORM_implicit_const:
+      return;
+    case DW_FORM_addrx1:
+    case DW_FORM_data1:
+    case DW_FORM_flag:
+    case DW_FORM_ref1:
+    case DW_FORM_strx1:
+      abbrev->skip_bytes += 1;
+      return;
+    case DW_FORM_addrx2:
+    case DW_FORM_ref2:
+    case DW_FORM_data2:
+    case DW_FORM_strx2:
+      abbrev->skip_bytes += 2;
+      return;
+    case DW_FORM_addrx3:
+    case DW_FORM_strx3:
+      abbrev->skip_bytes += 3;
+      return;
+    case DW_FORM_addrx4:
+    case DW_FORM_ref4:
+    case DW_FORM_data4:
+    case DW_FORM_strx4:
+    case DW_FORM_ref_sup4:
+      abbrev->skip_bytes += 4;
+      return;
+    case DW_FORM_ref8:
+    case DW_FORM_data8:
+    case DW_FORM_ref_sig8:
+    case DW_FORM_ref_sup8:
+      abbrev->skip_bytes += 8;
+      return;
+    case DW_FORM_data16:
+      abbrev->skip_bytes += 16;
+      return;
+    case DW_FORM_addr:
+      abbrev->skip_addresses++;
+      return;
+    case DW_FORM_ref_addr:
+      abbrev->skip_ref_addrs++;
+      return;
+    case DW_FORM_strp:
+    case DW_FORM_line_strp:
+    case DW_FORM_strp_sup:
+    case DW_FORM_sec_offset:
+      abbrev->skip_offsets++;
+      return;
+    default:
+      // Strings, LEB128 numbers, blocks, indirect and unknown forms.
+      abbrev->skip_by_size = false;
+      return;
+  }
+}
+
 void CompilationUnit::ReadAbbrevs() {
   if (abbrevs_)
     return;
@@ -116,14 +178,19 @@ void CompilationUnit::ReadAbbrevs() {
       GetSectionByName(sections_, ".debug_abbrev");
   assert(iter != sections_.end());
 
-  abbrevs_ = new std::vector<Abbrev>;
-  abbrevs_->resize(1);
-
   // The only way to check whether we are reading over the end of the
   // buffer would be to first compute the size of the leb128 data by
   // reading it, then go back and read it again.
   const uint8_t* abbrev_start = iter->second.first +
                                       header_.abbrev_offset;
+  if (abbrev_cache_) {
+    abbrevs_ = abbrev_cache_->Find(abbrev_start);
+    if (abbrevs_)
+      return;
+  }
+
+  std::shared_ptr<std::vector<Abbrev>> abbrevs(new std::vector<Abbrev>);
+  abbrevs->resize(1);
   const uint8_t* abbrevptr = abbrev_start;
 #ifndef NDEBUG
   const uint64_t abbrev_length = iter->second.second - header_.abbrev_offset;
@@ -147,6 +214,12 @@ void CompilationUnit::ReadAbbrevs() {
     assert(abbrevptr < abbrev_start + abbrev_length);
     abbrev.has_children = reader_->ReadOneByte(abbrevptr);
     abbrevptr += 1;
+    abbrev.skip_by_size = true;
+    abbrev.skip_bytes = 0;
+    abbrev.skip_addresses = 0;
+    abbrev.skip_offsets = 0;
+    abbrev.skip_ref_addrs = 0;
+    abbrev.has_sibling = false;
 
     assert(abbrevptr < abbrev_start + abbrev_length);
 
@@ -169,15 +242,53 @@ void CompilationUnit::ReadAbbrevs() {
                            static_cast<enum DwarfForm>(formtemp),
                            value);
       abbrev.attributes.push_back(abbrev_attr);
+      AddToSkipSize(abbrev_attr.form_, &abbrev);
+      if (abbrev_attr.attr_ == DW_AT_sibling)
+        abbrev.has_sibling = true;
     }
-    assert(abbrev.number == abbrevs_->size());
-    abbrevs_->push_back(abbrev);
+    assert(abbrev.number == abbrevs->size());
+    abbrevs->push_back(abbrev);
   }
+
+  if (abbrev_cache_)
+    abbrevs_ = abbrev_cache_->Add(abbrev_start, abbrevs);
+  else
+    abbrevs_ = abbrevs;
+}
+
+std::shared_ptr<const std::vector<CompilationUnit::Abbrev>>
+CompilationUnit::AbbrevCache::Find(const uint8_t* table) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = tables_.find(table);
+  if (iter == tables_.end())
+    return NULL;
+  return iter->second;
+}
+
+std::shared_ptr<const std::vector<CompilationUnit::Abbrev>>
+CompilationUnit::AbbrevCache::Add(
+    const uint8_t* table,
+    std::shared_ptr<const std::vector<Abbrev>> abbrevs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tables_.insert(std::make_pair(table, abbrevs)).first->second;
 }
 
 // Skips a single DIE's attributes.
 const uint8_t* CompilationUnit::SkipDIE(const uint8_t* start,
                                         const Abbrev& abbrev) {
+  // Most DIEs that are skipped, like those of types and variables, have
+  // only attributes of known sizes, and can be stepped over in one go.
+  // DWARF2 and 3/4 differ on whether ref_addr is address size or offset
+  // size.
+  if (abbrev.skip_by_size &&
+      (abbrev.skip_ref_addrs == 0 || header_.version >= 2)) {
+    const uint64_t ref_addr_size = header_.version == 2 ?
+        reader_->AddressSize() : reader_->OffsetSize();
+    return start + abbrev.skip_bytes +
+           abbrev.skip_addresses * reader_->AddressSize() +
+           abbrev.skip_offsets * reader_->OffsetSize() +
+           abbrev.skip_ref_addrs * ref_addr_size;
+  }
   for (AttributeList::const_iterator i = abbrev.attributes.begin();
        i != abbrev.attributes.end();
        i++)  {
@@ -186,6 +297,77 @@ const uint8_t* CompilationUnit::SkipDIE(const uint8_t* start,
   return start;
 }
 
+// Skips a DIE and everything within it.
+const uint8_t* CompilationUnit::SkipDIETree(const uint8_t* start,
+                                            const Abbrev& abbrev,
+                                            const uint8_t* end) {
+  const uint8_t* after_attributes = SkipDIE(start, abbrev);
+  if (!abbrev.has_children)
+    return after_attributes;
+
+  // Producers usually give DIEs with children a DW_AT_sibling attribute,
+  // which lets us jump straight past them.  Only trust it if it points
+  // past the DIE's attributes and within the unit.
+  if (abbrev.has_sibling) {
+    const uint8_t* attribute = start;
+    for (AttributeList::const_iterator i = abbrev.attributes.begin();
+         i != abbrev.attributes.end();
+         i++) {
+      if (i->attr_ != DW_AT_sibling) {
+        attribute = SkipAttribute(attribute, i->form_);
+        continue;
+      }
+      uint64_t unit_offset;
+      switch (i->form_) {
+        case DW_FORM_ref1:
+          unit_offset = reader_->ReadOneByte(attribute);
+          break;
+        case DW_FORM_ref2:
+          unit_offset = reader_->ReadTwoBytes(attribute);
+          break;
+        case DW_FORM_ref4:
+          unit_offset = reader_->ReadFourBytes(attribute);
+          break;
+        case DW_FORM_ref8:
+          unit_offset = reader_->ReadEightBytes(attribute);
+          break;
+        case DW_FORM_ref_udata: {
+          size_t len;
+          unit_offset = reader_->ReadUnsignedLEB128(attribute, &len);
+          break;
+        }
+        default:
+          unit_offset = 0;
+          break;
+      }
+      if (unit_offset > static_cast<uint64_t>(after_attributes - buffer_) &&
+          unit_offset <= static_cast<uint64_t>(end - buffer_)) {
+        return buffer_ + unit_offset;
+      }
+      break;
+    }
+  }
+
+  // Otherwise, step over the descendants one by one, without reading
+  // their attributes.
+  const uint8_t* dieptr = after_attributes;
+  int depth = 1;
+  while (depth > 0 && dieptr < end) {
+    size_t len;
+    const uint64_t abbrev_num = reader_->ReadUnsignedLEB128(dieptr, &len);
+    dieptr += len;
+    if (abbrev_num == 0) {
+      --depth;
+      continue;
+    }
+    const Abbrev& child = abbrevs_->at(static_cast<size_t>(abbrev_num));
+    dieptr = SkipDIE(dieptr, child);
+    if (child.has_children)
+      ++depth;
+  }
+  return dieptr;
+}
+
 // Skips a single attribute form's data.
 const uint8_t* CompilationUnit::SkipAttribute(const uint8_t* start,
                                               enum DwarfForm form) {
@@ -440,12 +622,17 @@ uint64_t CompilationUnit::Start() {
   }
 
   // Now that we have our abbreviations, start processing DIE's.
+  if (die_offsets_) {
+    ProcessListedDIEs();
+    return ourlength;
+  }
   ProcessDIEs();
 
   // If this is a skeleton compilation unit generated with split DWARF,
   // and the client needs the full debug info, we need to find the full
   // compilation unit in a .dwo or .dwp file.
   if (!is_split_dwarf_
+      && !root_die_only_
       && dwo_name_ != NULL
       && handler_->NeedSplitDebugInfo())
     ProcessSplitDwarf();
@@ -914,9 +1101,16 @@ void CompilationUnit::ProcessDIEs() {
   else
     lengthstart += 4;
 
+  const uint8_t* end = lengthstart + header_.length;
+
   std::stack<uint64_t> die_stack;
-  
-  while (dieptr < (lengthstart + header_.length)) {
+
+  // Whether the handler wants DIEs below the root with each abbreviation's
+  // tag: 1 if so, 0 if not, and -1 if it hasn't been asked yet.
+  std::vector<int8_t> wanted(abbrevs_->size(), -1);
+  const bool skip_children = handler_->SkipsChildrenOfSkippedDIEs();
+
+  while (dieptr < end) {
     // We give the user the absolute offset from the beginning of
     // debug_info, since they need it to deal with ref_addr forms.
     uint64_t absolute_offset = (dieptr - buffer_) + offset_from_section_start_;
@@ -939,18 +1133,79 @@ void CompilationUnit::ProcessDIEs() {
 
     const Abbrev& abbrev = abbrevs_->at(static_cast<size_t>(abbrev_num));
     const enum DwarfTag tag = abbrev.tag;
+    if (!die_stack.empty()) {
+      int8_t& wants_tag = wanted[static_cast<size_t>(abbrev_num)];
+      if (wants_tag < 0)
+        wants_tag = handler_->WantsDIEsTagged(tag);
+      if (!wants_tag) {
+        dieptr = SkipDIETree(dieptr, abbrev, end);
+        continue;
+      }
+    }
     if (!handler_->StartDIE(absolute_offset, tag)) {
+      if (skip_children && !root_die_only_) {
+        dieptr = SkipDIETree(dieptr, abbrev, end);
+        handler_->EndDIE(absolute_offset);
+        continue;
+      }
       dieptr = SkipDIE(dieptr, abbrev);
     } else {
       dieptr = ProcessDIE(absolute_offset, dieptr, abbrev);
     }
 
-    if (abbrev.has_children) {
+    if (abbrev.has_children && !root_die_only_) {
       die_stack.push(absolute_offset);
     } else {
       handler_->EndDIE(absolute_offset);
     }
+    if (root_die_only_)
+      return;
+  }
+}
+
+void CompilationUnit::ProcessListedDIEs() {
+  const uint8_t* lengthstart = buffer_;
+  if (reader_->OffsetSize() == 8)
+    lengthstart += 12;
+  else
+    lengthstart += 4;
+  const uint8_t* end = lengthstart + header_.length;
+
+  // Read the root DIE as ProcessDIEs would, but without its children.
+  const uint8_t* dieptr = after_header_;
+  const uint64_t root_offset =
+      (dieptr - buffer_) + offset_from_section_start_;
+  size_t len;
+  uint64_t abbrev_num = reader_->ReadUnsignedLEB128(dieptr, &len);
+  if (abbrev_num == 0 || abbrev_num >= abbrevs_->size())
+    return;
+  dieptr += len;
+  const Abbrev& root_abbrev = abbrevs_->at(static_cast<size_t>(abbrev_num));
+  if (!handler_->StartDIE(root_offset, root_abbrev.tag)) {
+    handler_->EndDIE(root_offset);
+    return;
+  }
+  if (!ProcessDIE(root_offset, dieptr, root_abbrev)) {
+    handler_->EndDIE(root_offset);
+    return;
+  }
+
+  // Visit each listed DIE as though it were a child of the root.
+  const uint64_t unit_end = (end - buffer_) + offset_from_section_start_;
+  for (uint64_t offset : *die_offsets_) {
+    if (offset <= root_offset || offset >= unit_end)
+      continue;
+    dieptr = buffer_ + (offset - offset_from_section_start_);
+    abbrev_num = reader_->ReadUnsignedLEB128(dieptr, &len);
+    if (abbrev_num == 0 || abbrev_num >= abbrevs_->size())
+      continue;
+    dieptr += len;
+    const Abbrev& abbrev = abbrevs_->at(static_cast<size_t>(abbrev_num));
+    if (handler_->StartDIE(offset, abbrev.tag))
+      ProcessDIE(offset, dieptr, abbrev);
+    handler_->EndDIE(offset);
   }
+  handler_->EndDIE(root_offset);
 }
 
 // Check for a valid ELF file and return the Address size.
@@ -963,65 +1218,157 @@ inline int GetElfWidth(const ElfReader& elf) {
   return 0;
 }
 
-void CompilationUnit::ProcessSplitDwarf() {
+// A .dwo file, mapped, with the locations of its debug sections.
+struct CompilationUnit::SplitDwarfFiles::DwoFile {
+  std::unique_ptr<ElfReader> elf;
+  SectionMap sections;
+  // The file's address size, or zero if it isn't an ELF file.
+  int width;
+};
+
+// A .dwp file, mapped and indexed.
+struct CompilationUnit::SplitDwarfFiles::DwpFile {
+  string path;
+  // The ByteReader the DwpReader reads the index with; it must outlive
+  // the DwpReader.
+  std::unique_ptr<ByteReader> byte_reader;
+  std::unique_ptr<DwpReader> reader;
+  int width;
+};
+
+CompilationUnit::SplitDwarfFiles::SplitDwarfFiles() {}
+
+CompilationUnit::SplitDwarfFiles::~SplitDwarfFiles() {}
+
+bool CompilationUnit::SplitDwarfFiles::OpenDwo(const string& name) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = dwo_files_.find(name);
+    if (iter != dwo_files_.end())
+      return iter->second->width != 0;
+  }
+  // Open the file without holding the lock, so that other threads can
+  // open other files meanwhile.  Reading the sections' locations here
+  // leaves nothing in the ElfReader to change once it is shared.
+  std::unique_ptr<DwoFile> file(new DwoFile);
+  file->width = 0;
   struct stat statbuf;
-  if (!have_checked_for_dwp_) {
-    // Look for a .dwp file in the same directory as the executable.
-    have_checked_for_dwp_ = true;
-    string dwp_suffix(".dwp");
-    dwp_path_ = path_ + dwp_suffix;
-    if (stat(dwp_path_.c_str(), &statbuf) != 0) {
-      // Fall back to a split .debug file in the same directory.
-      string debug_suffix(".debug");
-      dwp_path_ = path_;
-      size_t found = path_.rfind(debug_suffix);
-      if (found + debug_suffix.length() == path_.length())
-        dwp_path_ = dwp_path_.replace(found, debug_suffix.length(), dwp_suffix);
-    }
-    if (stat(dwp_path_.c_str(), &statbuf) == 0) {
-      ElfReader* elf = new ElfReader(dwp_path_);
-      int width = GetElfWidth(*elf);
-      if (width != 0) {
-        dwp_byte_reader_.reset(new ByteReader(reader_->GetEndianness()));
-        dwp_byte_reader_->SetAddressSize(width);
-        dwp_reader_.reset(new DwpReader(*dwp_byte_reader_, elf));
-        dwp_reader_->Initialize();
-      } else {
-        delete elf;
-      }
+  if (stat(name.c_str(), &statbuf) == 0) {
+    file->elf.reset(new ElfReader(name));
+    file->width = GetElfWidth(*file->elf);
+    if (file->width != 0)
+      ReadDebugSectionsFromDwo(file->elf.get(), &file->sections);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // If another thread opened NAME meanwhile, keep its copy.
+  auto iter = dwo_files_.insert(std::make_pair(name, std::move(file))).first;
+  return iter->second->width != 0;
+}
+
+bool CompilationUnit::SplitDwarfFiles::FindDwo(const string& name,
+                                               SectionMap* sections,
+                                               int* address_size) {
+  if (!OpenDwo(name))
+    return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  const DwoFile& file = *dwo_files_.find(name)->second;
+  *sections = file.sections;
+  *address_size = file.width;
+  return true;
+}
+
+CompilationUnit::SplitDwarfFiles::DwpFile*
+CompilationUnit::SplitDwarfFiles::GetDwp(const string& path,
+                                         Endianness endianness) {
+  auto iter = dwp_files_.find(path);
+  if (iter != dwp_files_.end())
+    return iter->second.get();
+  std::unique_ptr<DwpFile>& file = dwp_files_[path];
+
+  // Look for a .dwp file in the same directory as the executable.
+  struct stat statbuf;
+  string dwp_suffix(".dwp");
+  string dwp_path = path + dwp_suffix;
+  if (stat(dwp_path.c_str(), &statbuf) != 0) {
+    // Fall back to a split .debug file in the same directory.
+    string debug_suffix(".debug");
+    dwp_path = path;
+    size_t found = path.rfind(debug_suffix);
+    if (found != string::npos &&
+        found + debug_suffix.length() == path.length())
+      dwp_path = dwp_path.replace(found, debug_suffix.length(), dwp_suffix);
+  }
+  if (stat(dwp_path.c_str(), &statbuf) == 0) {
+    ElfReader* elf = new ElfReader(dwp_path);
+    int width = GetElfWidth(*elf);
+    if (width != 0) {
+      file.reset(new DwpFile);
+      file->path = dwp_path;
+      file->width = width;
+      file->byte_reader.reset(new ByteReader(endianness));
+      file->byte_reader->SetAddressSize(width);
+      file->reader.reset(new DwpReader(*file->byte_reader, elf));
+      file->reader->Initialize();
+    } else {
+      delete elf;
     }
   }
-  bool found_in_dwp = false;
-  if (dwp_reader_) {
+  return file.get();
+}
+
+bool CompilationUnit::SplitDwarfFiles::HasDwp(const string& path,
+                                              Endianness endianness) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return GetDwp(path, endianness) != NULL;
+}
+
+bool CompilationUnit::SplitDwarfFiles::FindInDwp(const string& path,
+                                                 Endianness endianness,
+                                                 uint64_t dwo_id,
+                                                 SectionMap* sections,
+                                                 string* dwp_path,
+                                                 int* address_size) {
+  // The DwpReader and its ElfReader look sections up lazily, so they are
+  // only used with the lock held.
+  std::lock_guard<std::mutex> lock(mutex_);
+  DwpFile* file = GetDwp(path, endianness);
+  if (!file)
+    return false;
+  file->reader->ReadDebugSectionsForCU(dwo_id, sections);
+  if (sections->empty())
+    return false;
+  *dwp_path = file->path;
+  *address_size = file->width;
+  return true;
+}
+
+void CompilationUnit::ProcessSplitDwarf() {
+  SplitDwarfFiles* files = split_dwarf_files_;
+  if (!files) {
+    if (!own_split_dwarf_files_)
+      own_split_dwarf_files_.reset(new SplitDwarfFiles);
+    files = own_split_dwarf_files_.get();
+  }
+  SectionMap sections;
+  string dwp_path;
+  int width;
+  if (files->FindInDwp(path_, reader_->GetEndianness(), dwo_id_, &sections,
+                       &dwp_path, &width)) {
     // If we have a .dwp file, read the debug sections for the requested CU.
-    SectionMap sections;
-    dwp_reader_->ReadDebugSectionsForCU(dwo_id_, &sections);
-    if (!sections.empty()) {
-      found_in_dwp = true;
-      CompilationUnit dwp_comp_unit(dwp_path_, sections, 0,
-                                    dwp_byte_reader_.get(), handler_);
-      dwp_comp_unit.SetSplitDwarf(addr_buffer_, addr_buffer_length_, addr_base_,
-                                  ranges_base_, dwo_id_);
-      dwp_comp_unit.Start();
-    }
-  }
-  if (!found_in_dwp) {
-    // If no .dwp file, try to open the .dwo file.
-    if (stat(dwo_name_, &statbuf) == 0) {
-      ElfReader elf(dwo_name_);
-      int width = GetElfWidth(elf);
-      if (width != 0) {
-        ByteReader reader(ENDIANNESS_LITTLE);
-        reader.SetAddressSize(width);
-        SectionMap sections;
-        ReadDebugSectionsFromDwo(&elf, &sections);
-        CompilationUnit dwo_comp_unit(dwo_name_, sections, 0, &reader,
-                                      handler_);
-        dwo_comp_unit.SetSplitDwarf(addr_buffer_, addr_buffer_length_,
-                                    addr_base_, ranges_base_, dwo_id_);
-        dwo_comp_unit.Start();
-      }
-    }
+    ByteReader reader(reader_->GetEndianness());
+    reader.SetAddressSize(width);
+    CompilationUnit dwp_comp_unit(dwp_path, sections, 0, &reader, handler_);
+    dwp_comp_unit.SetSplitDwarf(addr_buffer_, addr_buffer_length_, addr_base_,
+                                ranges_base_, dwo_id_);
+    dwp_comp_unit.Start();
+  } else if (files->FindDwo(dwo_name_, &sections, &width)) {
+    // If no .dwp file, try the .dwo file.
+    ByteReader reader(ENDIANNESS_LITTLE);
+    reader.SetAddressSize(width);
+    CompilationUnit dwo_comp_unit(dwo_name_, sections, 0, &reader, handler_);
+    dwo_comp_unit.SetSplitDwarf(addr_buffer_, addr_buffer_length_,
+                                addr_base_, ranges_base_, dwo_id_);
+    dwo_comp_unit.Start();
   }
 }
 
@@ -1048,6 +1395,239 @@ void CompilationUnit::ReadDebugSectionsFromDwo(ElfReader* elf_reader,
   }
 }
 
+bool NameIndexReader::ReadEntries(std::vector<Entry>* entries,
+                                  std::vector<uint64_t>* unit_offsets) {
+  const uint8_t* ptr = buffer_;
+  const uint8_t* end = buffer_ + size_;
+  while (ptr < end) {
+    ptr = ReadTable(ptr, entries, unit_offsets);
+    if (ptr == NULL)
+      return false;
+  }
+  return true;
+}
+
+const uint8_t* NameIndexReader::ReadTable(
+    const uint8_t* start,
+    std::vector<Entry>* entries,
+    std::vector<uint64_t>* unit_offsets) {
+  const uint8_t* section_end = buffer_ + size_;
+  // A table header is longer than the longest initial length.
+  if (section_end - start < 12)
+    return NULL;
+  size_t initial_length_size;
+  const uint64_t unit_length =
+      reader_->ReadInitialLength(start, &initial_length_size);
+  const uint8_t* ptr = start + initial_length_size;
+  if (unit_length > static_cast<uint64_t>(section_end - ptr))
+    return NULL;
+  const uint8_t* end = ptr + unit_length;
+  const uint64_t offset_size = reader_->OffsetSize();
+
+  // version, padding, and seven four-byte counts and sizes.
+  if (end - ptr < 32)
+    return NULL;
+  if (reader_->ReadTwoBytes(ptr) != 5)
+    return NULL;
+  ptr += 4;
+  const uint64_t comp_unit_count = reader_->ReadFourBytes(ptr);
+  const uint64_t local_type_unit_count = reader_->ReadFourBytes(ptr + 4);
+  const uint64_t foreign_type_unit_count = reader_->ReadFourBytes(ptr + 8);
+  const uint64_t bucket_count = reader_->ReadFourBytes(ptr + 12);
+  const uint64_t name_count = reader_->ReadFourBytes(ptr + 16);
+  const uint64_t abbrev_table_size = reader_->ReadFourBytes(ptr + 20);
+  const uint64_t augmentation_string_size = reader_->ReadFourBytes(ptr + 24);
+  ptr += 28;
+
+  // Every count is a four-byte value, so none of these sums overflow.
+  const uint64_t lists_size =
+      augmentation_string_size +
+      (comp_unit_count + local_type_unit_count) * offset_size +
+      foreign_type_unit_count * 8 +
+      bucket_count * 4 +
+      (bucket_count > 0 ? name_count * 4 : 0) +
+      name_count * offset_size * 2 +
+      abbrev_table_size;
+  if (lists_size > static_cast<uint64_t>(end - ptr))
+    return NULL;
+  ptr += augmentation_string_size;
+
+  std::vector<uint64_t> units;
+  for (uint64_t i = 0; i < comp_unit_count; ++i) {
+    units.push_back(reader_->ReadOffset(ptr));
+    ptr += offset_size;
+  }
+  unit_offsets->insert(unit_offsets->end(), units.begin(), units.end());
+
+  // Skip the type unit lists, the buckets and the hashes; a reader
+  // that wants every entry has no use for the hash lookup.
+  ptr += local_type_unit_count * offset_size;
+  ptr += foreign_type_unit_count * 8;
+  ptr += bucket_count * 4;
+  if (bucket_count > 0)
+    ptr += name_count * 4;
+
+  const uint8_t* string_offsets = ptr;
+  ptr += name_count * offset_size;
+  const uint8_t* entry_offsets = ptr;
+  ptr += name_count * offset_size;
+
+  const uint8_t* abbrev_end = ptr + abbrev_table_size;
+  const uint8_t* entry_pool = abbrev_end;
+  std::map<uint64_t, Abbrev> abbrevs;
+  size_t len;
+  while (ptr < abbrev_end) {
+    const uint64_t code = reader_->ReadUnsignedLEB128(ptr, &len);
+    ptr += len;
+    if (code == 0)
+      break;
+    Abbrev& abbrev = abbrevs[code];
+    if (ptr >= abbrev_end)
+      return NULL;
+    abbrev.tag = static_cast<enum DwarfTag>(
+        reader_->ReadUnsignedLEB128(ptr, &len));
+    ptr += len;
+    while (true) {
+      if (ptr >= abbrev_end)
+        return NULL;
+      const uint64_t index = reader_->ReadUnsignedLEB128(ptr, &len);
+      ptr += len;
+      if (ptr >= abbrev_end)
+        return NULL;
+      const uint64_t form = reader_->ReadUnsignedLEB128(ptr, &len);
+      ptr += len;
+      if (index == 0 && form == 0)
+        break;
+      abbrev.attributes.push_back(
+          std::make_pair(index, static_cast<enum DwarfForm>(form)));
+    }
+  }
+
+  for (uint64_t i = 0; i < name_count; ++i) {
+    const uint64_t string_offset =
+        reader_->ReadOffset(string_offsets + i * offset_size);
+    if (string_offset >= string_buffer_size_)
+      return NULL;
+    const char* name =
+        reinterpret_cast<const char*>(string_buffer_ + string_offset);
+    const uint64_t entry_offset =
+        reader_->ReadOffset(entry_offsets + i * offset_size);
+    if (entry_offset >= static_cast<uint64_t>(end - entry_pool))
+      return NULL;
+
+    // The entries for a name run until a zero abbreviation code.
+    const uint8_t* entry = entry_pool + entry_offset;
+    while (true) {
+      if (entry >= end)
+        return NULL;
+      const uint64_t code = reader_->ReadUnsignedLEB128(entry, &len);
+      entry += len;
+      if (code == 0)
+        break;
+      std::map<uint64_t, Abbrev>::const_iterator abbrev = abbrevs.find(code);
+      if (abbrev == abbrevs.end())
+        return NULL;
+
+      bool has_unit = false, in_type_unit = false, has_die = false;
+      uint64_t unit = 0, die_offset = 0;
+      for (size_t j = 0; j < abbrev->second.attributes.size(); ++j) {
+        uint64_t value;
+        if (!ReadValue(&entry, end, abbrev->second.attributes[j].second,
+                       &value))
+          return NULL;
+        switch (abbrev->second.attributes[j].first) {
+          case DW_IDX_compile_unit:
+            has_unit = true;
+            unit = value;
+            break;
+          case DW_IDX_type_unit:
+            in_type_unit = true;
+            break;
+          case DW_IDX_die_offset:
+            has_die = true;
+            die_offset = value;
+            break;
+          default:
+            break;
+        }
+      }
+      if (in_type_unit || !has_die)
+        continue;
+      // A table covering a single compilation unit may leave it implicit.
+      if (!has_unit) {
+        if (units.size() != 1)
+          continue;
+        unit = 0;
+      }
+      if (unit >= units.size())
+        return NULL;
+      Entry result;
+      result.name = name;
+      result.tag = abbrev->second.tag;
+      result.unit_offset = units[unit];
+      result.die_offset = units[unit] + die_offset;
+      entries->push_back(result);
+    }
+  }
+
+  return end;
+}
+
+bool NameIndexReader::ReadValue(const uint8_t** ptr, const uint8_t* end,
+                                enum DwarfForm form, uint64_t* value) {
+  const uint8_t* start = *ptr;
+  if (start > end)
+    return false;
+  const uint64_t available = end - start;
+  size_t len;
+  switch (form) {
+    case DW_FORM_flag_present:
+      *value = 1;
+      return true;
+    case DW_FORM_data1:
+    case DW_FORM_ref1:
+    case DW_FORM_flag:
+      if (available < 1)
+        return false;
+      *value = reader_->ReadOneByte(start);
+      *ptr += 1;
+      return true;
+    case DW_FORM_data2:
+    case DW_FORM_ref2:
+      if (available < 2)
+        return false;
+      *value = reader_->ReadTwoBytes(start);
+      *ptr += 2;
+      return true;
+    case DW_FORM_data4:
+    case DW_FORM_ref4:
+      if (available < 4)
+        return false;
+      *value = reader_->ReadFourBytes(start);
+      *ptr += 4;
+      return true;
+    case DW_FORM_data8:
+    case DW_FORM_ref8:
+    case DW_FORM_ref_sig8:
+      if (available < 8)
+        return false;
+      *value = reader_->ReadEightBytes(start);
+      *ptr += 8;
+      return true;
+    case DW_FORM_udata:
+    case DW_FORM_ref_udata:
+      if (available < 1)
+        return false;
+      *value = reader_->ReadUnsignedLEB128(start, &len);
+      if (len > available)
+        return false;
+      *ptr += len;
+      return true;
+    default:
+      return false;
+  }
+}
+
 DwpReader::DwpReader(const ByteReader& byte_reader, ElfReader* elf_reader)
     : elf_reader_(elf_reader), byte_reader_(byte_reader),
       cu_index_(NULL), cu_index_size_(0), string_buffer_(NULL),
@@ -1757,16 +2337,35 @@ void LineInfo::ReadLines() {
   uint64_t pending_address = 0;
   uint32_t pending_file_num = 0, pending_line_num = 0, pending_column_num = 0;
 
+  // Lines are gathered into ROWS and handed over a batch at a time.  A
+  // batch is handed over before each extended opcode too, since one may
+  // define a file that the lines after it refer to.
+  const size_t kMaxRows = 256;
+  LineInfoHandler::Row rows[kMaxRows];
+  size_t row_count = 0;
+
   while (lineptr < lengthstart + header_.total_length) {
+    if (*lineptr == 0 && row_count > 0) {
+      handler_->AddLines(rows, row_count);
+      row_count = 0;
+    }
     size_t oplength;
     bool add_row = ProcessOneOpcode(reader_, handler_, header_,
                                     lineptr, &lsm, &oplength, (uintptr)-1,
                                     NULL);
     if (add_row) {
-      if (have_pending_line)
-        handler_->AddLine(pending_address, lsm.address - pending_address,
-                          pending_file_num, pending_line_num,
-                          pending_column_num);
+      if (have_pending_line) {
+        LineInfoHandler::Row& row = rows[row_count++];
+        row.address = pending_address;
+        row.length = lsm.address - pending_address;
+        row.file_num = pending_file_num;
+        row.line_num = pending_line_num;
+        row.column_num = pending_column_num;
+        if (row_count == kMaxRows) {
+          handler_->AddLines(rows, row_count);
+          row_count = 0;
+        }
+      }
       if (lsm.end_sequence) {
         lsm.Reset(header_.default_is_stmt);      
         have_pending_line = false;
@@ -1780,6 +2379,8 @@ void LineInfo::ReadLines() {
     }
     lineptr += oplength;
   }
+  if (row_count > 0)
+    handler_->AddLines(rows, row_count);
 
   after_header_ = lengthstart + header_.total_length;
 }
@@ -3139,15 +3740,20 @@ bool CallFrameInfo::ReadFDEFields(FDE* fde) {
 }
   
 bool CallFrameInfo::Start() {
+  return Start(0, buffer_length_);
+}
+
+bool CallFrameInfo::Start(size_t begin, size_t end) {
   const uint8_t* buffer_end = buffer_ + buffer_length_;
+  const uint8_t* range_end = buffer_ + std::min(end, buffer_length_);
   const uint8_t* cursor;
   bool all_ok = true;
   const uint8_t* entry_end;
   bool ok;
 
-  // Traverse all the entries in buffer_, skipping CIEs and offering
+  // Traverse the entries in the range, skipping CIEs and offering
   // FDEs to the handler.
-  for (cursor = buffer_; cursor < buffer_end;
+  for (cursor = buffer_ + begin; cursor < range_end;
        cursor = entry_end, all_ok = all_ok && ok) {
     FDE fde;
 
@@ -3273,6 +3879,24 @@ bool CallFrameInfo::Start() {
   return all_ok;
 }
 
+void CallFrameInfo::GetEntryOffsets(std::vector<size_t>* offsets) {
+  size_t offset = 0;
+  while (offset < buffer_length_) {
+    size_t remaining = buffer_length_ - offset;
+    if (remaining < 4)
+      break;
+    size_t length_size;
+    uint64_t length = reader_->ReadInitialLength(buffer_ + offset,
+                                                 &length_size);
+    if (length_size > remaining)
+      break;
+    offsets->push_back(offset);
+    if ((length == 0 && eh_frame_) || length > remaining - length_size)
+      break;
+    offset += length_size + length;
+  }
+}
+
 const char* CallFrameInfo::KindName(EntryKind kind) {
   if (kind == CallFrameInfo::kUnknown)
     return "entry";
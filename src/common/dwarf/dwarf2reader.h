@@ -49,6 +49,7 @@
 #include <utility>
 #include <vector>
 #include <memory>
+#include <mutex>
 
 #include "common/dwarf/bytereader.h"
 #include "common/dwarf/dwarf2enums.h"
@@ -234,6 +235,26 @@ class LineInfoHandler {
   // if we know it (0 otherwise).
   virtual void AddLine(uint64_t address, uint64_t length,
                        uint32_t file_num, uint32_t line_num, uint32_t column_num) { }
+
+  // A line, as AddLine reports it.
+  struct Row {
+    uint64_t address;
+    uint64_t length;
+    uint32_t file_num;
+    uint32_t line_num;
+    uint32_t column_num;
+  };
+
+  // Called with COUNT consecutive lines at ROWS, decoded as a batch.
+  // The line info reader reports lines this way rather than one
+  // AddLine call at a time; the default implementation calls AddLine
+  // for each row in turn.  Lines come after the DefineFile calls for the
+  // files they refer to.
+  virtual void AddLines(const Row* rows, size_t count) {
+    for (size_t i = 0; i < count; i++)
+      AddLine(rows[i].address, rows[i].length, rows[i].file_num,
+              rows[i].line_num, rows[i].column_num);
+  }
 };
 
 class RangeListHandler {
@@ -350,6 +371,20 @@ class Dwarf2Handler {
   // section. Return false if you would like to skip this DIE.
   virtual bool StartDIE(uint64_t offset, enum DwarfTag tag) { return false; }
 
+  // Return false if StartDIE would return false for every DIE tagged TAG
+  // below a compilation unit's root DIE, and no DIE within such a DIE is
+  // wanted either.  The reader then steps over those DIEs and everything
+  // within them without calling StartDIE or EndDIE for any of them.  The
+  // reader asks once per abbreviation in each compilation unit, not once
+  // per DIE.
+  virtual bool WantsDIEsTagged(enum DwarfTag tag) { return true; }
+
+  // Return true if, whenever StartDIE returns false for a DIE, no DIE
+  // within it is wanted either.  The reader then steps over the DIE's
+  // children, using its DW_AT_sibling attribute if it has one, without
+  // calling StartDIE or EndDIE for any of them.
+  virtual bool SkipsChildrenOfSkippedDIEs() { return false; }
+
   // Called when we have an attribute with unsigned data to give to our
   // handler. The attribute is for the DIE at OFFSET from the beginning of the
   // .debug_info section. Its name is ATTR, its form is FORM, and its value is
@@ -453,14 +488,136 @@ class Dwarf2Handler {
 
 class CompilationUnit {
  public:
+  // This struct represents a single DWARF2/3 abbreviation
+  // The abbreviation tells how to read a DWARF2/3 DIE, and consist of a
+  // tag and a list of attributes, as well as the data form of each attribute.
+  struct Abbrev {
+    uint64_t number;
+    enum DwarfTag tag;
+    bool has_children;
+    AttributeList attributes;
+
+    // How to skip a DIE with this abbreviation without reading its
+    // attributes one by one, worked out when the abbreviation is read.
+    // If SKIP_BY_SIZE is true, every attribute has a size known from its
+    // form and the unit alone: SKIP_BYTES bytes in all, plus
+    // SKIP_ADDRESSES addresses, SKIP_OFFSETS section offsets, and
+    // SKIP_REF_ADDRS DW_FORM_ref_addr references.  Otherwise, some
+    // attribute's size can only be found by reading it.
+    bool skip_by_size;
+    uint64_t skip_bytes;
+    uint32_t skip_addresses;
+    uint32_t skip_offsets;
+    uint32_t skip_ref_addrs;
+
+    // True if DIEs with this abbreviation have a DW_AT_sibling attribute,
+    // giving the offset of the DIE after their children.
+    bool has_sibling;
+  };
+
+  // A set of abbreviation tables, each decoded once and shared by all the
+  // compilation units that use it.  Compilation units of one file may
+  // refer to the same table in .debug_abbrev; giving them all the same
+  // cache saves decoding it anew for each.  A cache may be shared by
+  // compilation units being read on several threads.
+  class AbbrevCache {
+   public:
+    // Return the table that starts at TABLE, or NULL if it hasn't been
+    // decoded.
+    std::shared_ptr<const std::vector<Abbrev>> Find(const uint8_t* table);
+
+    // Add ABBREVS, decoded from the table that starts at TABLE, and
+    // return the table to use: ABBREVS, or one that another compilation
+    // unit added for TABLE in the meantime.
+    std::shared_ptr<const std::vector<Abbrev>> Add(
+        const uint8_t* table,
+        std::shared_ptr<const std::vector<Abbrev>> abbrevs);
+
+   private:
+    std::mutex mutex_;
+    std::map<const uint8_t*, std::shared_ptr<const std::vector<Abbrev>>>
+        tables_;
+  };
+
+  // The .dwo and .dwp files holding the split DWARF of one executable's
+  // skeleton compilation units, each opened and mapped once and shared by
+  // all the units that refer to it.  Without one, each compilation unit
+  // opens the split DWARF file it needs itself, so a .dwp file is opened
+  // and indexed anew for every skeleton unit.  A SplitDwarfFiles may be
+  // shared by compilation units being read on several threads.
+  class SplitDwarfFiles {
+   public:
+    SplitDwarfFiles();
+    ~SplitDwarfFiles();
+
+    // Open and map the .dwo file NAME and find its debug sections, unless
+    // that has been done already.  Return true if NAME is an ELF file.
+    // Several threads may open different files at once.
+    bool OpenDwo(const string& name);
+
+    // Set *SECTIONS to the debug sections of the .dwo file NAME, opening
+    // it if need be, and *ADDRESS_SIZE to its address size.  Return false
+    // if NAME can't be read.
+    bool FindDwo(const string& name, SectionMap* sections, int* address_size);
+
+    // Return true if there is a .dwp file for the executable at PATH,
+    // whose byte order is ENDIANNESS.  The .dwp file is opened and
+    // indexed the first time it is asked for.
+    bool HasDwp(const string& path, Endianness endianness);
+
+    // Set *SECTIONS to the debug sections of the unit with DWO_ID in the
+    // .dwp file for the executable at PATH, *DWP_PATH to the .dwp file's
+    // path, and *ADDRESS_SIZE to its address size.  Return false if there
+    // is no .dwp file or it has no such unit.
+    bool FindInDwp(const string& path, Endianness endianness, uint64_t dwo_id,
+                   SectionMap* sections, string* dwp_path, int* address_size);
+
+   private:
+    struct DwoFile;
+    struct DwpFile;
+
+    // Return the .dwp file for PATH, opening it if need be, or NULL if
+    // there is none.  MUTEX_ must be held.
+    DwpFile* GetDwp(const string& path, Endianness endianness);
+
+    std::mutex mutex_;
+    std::map<string, std::unique_ptr<DwoFile>> dwo_files_;
+    std::map<string, std::unique_ptr<DwpFile>> dwp_files_;
+  };
+
 
   // Initialize a compilation unit.  This requires a map of sections,
   // the offset of this compilation unit in the .debug_info section, a
   // ByteReader, and a Dwarf2Handler class to call callbacks in.
   CompilationUnit(const string& path, const SectionMap& sections,
                   uint64_t offset, ByteReader* reader, Dwarf2Handler* handler);
-  virtual ~CompilationUnit() {
-    if (abbrevs_) delete abbrevs_;
+  virtual ~CompilationUnit() { }
+
+  // Use CACHE to find the abbreviation table for this compilation unit,
+  // and add it to CACHE if it isn't there yet.  CACHE must outlive this
+  // CompilationUnit.
+  void SetAbbrevCache(AbbrevCache* cache) { abbrev_cache_ = cache; }
+
+  // Find the .dwo or .dwp file holding this compilation unit's split
+  // DWARF, if it is a skeleton unit, in FILES, opening it there if it
+  // isn't open yet.  FILES must outlive this CompilationUnit.
+  void SetSplitDwarfFiles(SplitDwarfFiles* files) {
+    split_dwarf_files_ = files;
+  }
+
+  // Read only the root DIE of this compilation unit, skipping its
+  // children and any split DWARF.  That is all a reader wanting only
+  // the unit's own attributes, such as the name of its .dwo file, needs.
+  void SetRootDIEOnly() { root_die_only_ = true; }
+
+  // Read the root DIE of this compilation unit and then, in place of its
+  // children, only the DIEs at OFFSETS, given from the start of
+  // .debug_info, each without its own children, skipping any split DWARF.
+  // A reader that has found the DIEs it wants in an index such as
+  // .debug_names need not walk the rest.  OFFSETS must outlive this
+  // CompilationUnit.
+  void SetDIEOffsets(const std::vector<uint64_t>* offsets) {
+    die_offsets_ = offsets;
   }
 
   // Initialize a compilation unit from a .dwo or .dwp file.
@@ -483,16 +640,6 @@ class CompilationUnit {
 
  private:
 
-  // This struct represents a single DWARF2/3 abbreviation
-  // The abbreviation tells how to read a DWARF2/3 DIE, and consist of a
-  // tag and a list of attributes, as well as the data form of each attribute.
-  struct Abbrev {
-    uint64_t number;
-    enum DwarfTag tag;
-    bool has_children;
-    AttributeList attributes;
-  };
-
   // A DWARF2/3 compilation unit header.  This is not the same size as
   // in the actual file, as the one in the file may have a 32 bit or
   // 64 bit length.
@@ -639,10 +786,19 @@ class CompilationUnit {
   // Processes all DIEs for this compilation unit
   void ProcessDIEs();
 
+  // Processes the root DIE and those at die_offsets_, for SetDIEOffsets.
+  void ProcessListedDIEs();
+
   // Skips the die with attributes specified in ABBREV starting at
   // START, and return the new place to position the stream to.
   const uint8_t* SkipDIE(const uint8_t* start, const Abbrev& abbrev);
 
+  // Skips the DIE with attributes specified in ABBREV starting at START,
+  // along with all its descendants, and return the position of its next
+  // sibling, or END if the unit ends first.
+  const uint8_t* SkipDIETree(const uint8_t* start, const Abbrev& abbrev,
+                             const uint8_t* end);
+
   // Skips the attribute starting at START, with FORM, and return the
   // new place to position the stream to.
   const uint8_t* SkipAttribute(const uint8_t* start, enum DwarfForm form);
@@ -651,8 +807,8 @@ class CompilationUnit {
   void ProcessSplitDwarf();
 
   // Read the debug sections from a .dwo file.
-  void ReadDebugSectionsFromDwo(ElfReader* elf_reader,
-                                SectionMap* sections);
+  static void ReadDebugSectionsFromDwo(ElfReader* elf_reader,
+                                       SectionMap* sections);
 
   // Path of the file containing the debug information.
   const string path_;
@@ -680,7 +836,21 @@ class CompilationUnit {
   // Set of DWARF2/3 abbreviations for this compilation unit.  Indexed
   // by abbreviation number, which means that abbrevs_[0] is not
   // valid.
-  std::vector<Abbrev>* abbrevs_;
+  std::shared_ptr<const std::vector<Abbrev>> abbrevs_;
+
+  // The cache of abbreviation tables to use, if any.
+  AbbrevCache* abbrev_cache_;
+
+  // The split DWARF files to use, if any, and the ones this unit opened
+  // itself if not.
+  SplitDwarfFiles* split_dwarf_files_;
+  std::unique_ptr<SplitDwarfFiles> own_split_dwarf_files_;
+
+  // True if only the root DIE is to be read.
+  bool root_die_only_;
+
+  // If not NULL, the offsets of the only DIEs besides the root to read.
+  const std::vector<uint64_t>* die_offsets_;
 
   // String section buffer and length, if we have a string section.
   // This is here to avoid doing a section lookup for strings in
@@ -740,17 +910,67 @@ class CompilationUnit {
   // The value of DW_AT_str_offsets_base attribute, if any.
   uint64_t str_offsets_base_;
 
-  // True if we have already looked for a .dwp file.
-  bool have_checked_for_dwp_;
+};
+
+// A reader for a DWARF 5 .debug_names section: one or more name tables,
+// each mapping the names of the DIEs in a set of units to the DIEs that
+// bear them.  Clients that want only certain DIEs, such as every function,
+// can find them through the index rather than by walking every unit.
+class NameIndexReader {
+ public:
+  // An index entry for a DIE in a compilation unit.
+  struct Entry {
+    // The indexed name, in .debug_str.
+    const char* name;
+    enum DwarfTag tag;
+    // The .debug_info offsets of the DIE's compilation unit, and of the
+    // DIE itself.
+    uint64_t unit_offset;
+    uint64_t die_offset;
+  };
+
+  // Create a reader for the .debug_names section of SIZE bytes at BUFFER,
+  // whose names lie in the .debug_str section of STRING_BUFFER_SIZE bytes
+  // at STRING_BUFFER.  READER's offset size is set for each table read.
+  NameIndexReader(const uint8_t* buffer, uint64_t size,
+                  const uint8_t* string_buffer, uint64_t string_buffer_size,
+                  ByteReader* reader)
+      : buffer_(buffer), size_(size), string_buffer_(string_buffer),
+        string_buffer_size_(string_buffer_size), reader_(reader) { }
+
+  // Append to ENTRIES every entry in the section for a DIE in a
+  // compilation unit, skipping those for DIEs in type units, and to
+  // UNIT_OFFSETS the offset of every compilation unit the section's
+  // tables cover.  Return false if the section is malformed or uses a
+  // form this reader doesn't know; what was read before the problem was
+  // found is left in ENTRIES and UNIT_OFFSETS.
+  bool ReadEntries(std::vector<Entry>* entries,
+                   std::vector<uint64_t>* unit_offsets);
+
+ private:
+  // An abbreviation from a name table's abbreviation table.
+  struct Abbrev {
+    enum DwarfTag tag;
+    std::vector<std::pair<uint64_t, enum DwarfForm>> attributes;
+  };
 
-  // Path to the .dwp file.
-  string dwp_path_;
+  // Read the name table that starts at START, and return a pointer just
+  // past it, or NULL if it is malformed.
+  const uint8_t* ReadTable(const uint8_t* start,
+                           std::vector<Entry>* entries,
+                           std::vector<uint64_t>* unit_offsets);
 
-  // ByteReader for the DWP file.
-  std::unique_ptr<ByteReader> dwp_byte_reader_;
+  // Read a value of FORM at *PTR, no further than END, into *VALUE, and
+  // advance *PTR past it.  Return false if FORM is unknown or the value
+  // runs past END.
+  bool ReadValue(const uint8_t** ptr, const uint8_t* end,
+                 enum DwarfForm form, uint64_t* value);
 
-  // DWP reader.
-   std::unique_ptr<DwpReader> dwp_reader_;
+  const uint8_t* buffer_;
+  uint64_t size_;
+  const uint8_t* string_buffer_;
+  uint64_t string_buffer_size_;
+  ByteReader* reader_;
 };
 
 // A Reader for a .dwp file.  Supports the fetching of DWARF debug
@@ -1082,6 +1302,21 @@ class CallFrameInfo {
   // false if we encounter an error.
   bool Start();
 
+  // Parse the entries in BUFFER that start at or after offset BEGIN and
+  // before offset END, reporting what we find to HANDLER. BEGIN must be
+  // the offset of an entry. Entries refer to their CIEs wherever those
+  // are in BUFFER, so separate CallFrameInfo objects, each with its own
+  // READER and HANDLER, can parse disjoint ranges of one section
+  // concurrently. Return true if we reach END successfully, or false if
+  // we encounter an error.
+  bool Start(size_t begin, size_t end);
+
+  // Append to OFFSETS the offset of each entry in BUFFER, as found from
+  // the entries' initial lengths alone. Stop at an .eh_frame terminator
+  // or at the first entry whose extent can't be determined; the entries
+  // from there on are parsed along with the last one found.
+  void GetEntryOffsets(std::vector<size_t>* offsets);
+
   // Return the textual name of KIND. For error reporting.
   static const char* KindName(EntryKind kind);
 
@@ -449,6 +449,51 @@ TEST_F(CFI, TwoFDEsTwoCIEs) {
   EXPECT_TRUE(parser.Start());
 }
 
+// Parse only the entries in part of a section, whose FDE cites a CIE
+// outside that part.
+TEST_F(CFI, EntryRange) {
+  CFISection section(kLittleEndian, 8);
+  Label cie1, cie2, fde1, fde2;
+  section
+      .Mark(&cie1)
+      .CIEHeader(0x694d5d45, 0x4233221b, 0xbf45e65a, 3, "")
+      .FinishEntry()
+      .Mark(&fde1)
+      .FDEHeader(cie2, 0x778b27dfe5871f05ULL, 0x324ace3448070926ULL)
+      .FinishEntry()
+      .Mark(&fde2)
+      .FDEHeader(cie1, 0xf6054ca18b10bf5fULL, 0x45fdb970d8bca342ULL)
+      .FinishEntry()
+      .Mark(&cie2)
+      .CIEHeader(0xfba3fad7, 0x6287e1fd, 0x61d2c581, 2, "")
+      .FinishEntry();
+
+  {
+    InSequence s;
+    EXPECT_CALL(handler,
+                Entry(_, 0xf6054ca18b10bf5fULL, 0x45fdb970d8bca342ULL, 3,
+                      "", 0xbf45e65a))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, End()).WillOnce(Return(true));
+  }
+
+  string contents;
+  EXPECT_TRUE(section.GetContents(&contents));
+  ByteReader byte_reader(ENDIANNESS_LITTLE);
+  byte_reader.SetAddressSize(8);
+  CallFrameInfo parser(reinterpret_cast<const uint8_t*>(contents.data()),
+                       contents.size(),
+                       &byte_reader, &handler, &reporter);
+  vector<size_t> offsets;
+  parser.GetEntryOffsets(&offsets);
+  ASSERT_EQ(4U, offsets.size());
+  EXPECT_EQ(cie1.Value(), offsets[0]);
+  EXPECT_EQ(fde1.Value(), offsets[1]);
+  EXPECT_EQ(fde2.Value(), offsets[2]);
+  EXPECT_EQ(cie2.Value(), offsets[3]);
+  EXPECT_TRUE(parser.Start(offsets[2], offsets[3]));
+}
+
 // An FDE whose CIE specifies a version we don't recognize.
 TEST_F(CFI, BadVersion) {
   CFISection section(kBigEndian, 4);
@@ -2169,6 +2214,31 @@ TEST_F(EHFrame, Terminator) {
   ParseEHFrameSection(&section);
 }
 
+// GetEntryOffsets stops at an .eh_frame terminator.
+TEST_F(EHFrame, EntryOffsetsTerminator) {
+  Label cie;
+  section
+      .Mark(&cie)
+      .CIEHeader(9968, 2466, 67, 1, "")
+      .FinishEntry()
+      .FDEHeader(cie, 0x848037a1, 0x7b30475e)
+      .FinishEntry()
+      .D32(0)                           // Terminate the sequence.
+      .FDEHeader(cie, 0xf19629fe, 0x439fb09b)
+      .FinishEntry();
+
+  string contents;
+  EXPECT_TRUE(section.GetContents(&contents));
+  ByteReader byte_reader(ENDIANNESS_BIG);
+  byte_reader.SetAddressSize(4);
+  CallFrameInfo parser(reinterpret_cast<const uint8_t*>(contents.data()),
+                       contents.size(),
+                       &byte_reader, &handler, &reporter, true);
+  vector<size_t> offsets;
+  parser.GetEntryOffsets(&offsets);
+  EXPECT_EQ(3U, offsets.size());
+}
+
 // The parser should recognize the Linux Standards Base 'z' augmentations.
 TEST_F(EHFrame, SimpleFDE) {
   DwarfPointerEncoding lsda_encoding =
@@ -31,6 +31,7 @@
 
 // dwarf2reader_die_unittest.cc: Unit tests for google_breakpad::CompilationUnit
 
+#include <elf.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -42,9 +43,14 @@
 #include "common/dwarf/bytereader-inl.h"
 #include "common/dwarf/dwarf2reader_test_common.h"
 #include "common/dwarf/dwarf2reader.h"
+#include "common/linux/synth_elf.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/tests/file_utils.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 
+using google_breakpad::AutoTempDir;
+using google_breakpad::synth_elf::ELF;
 using google_breakpad::test_assembler::Endianness;
 using google_breakpad::test_assembler::Label;
 using google_breakpad::test_assembler::Section;
@@ -63,6 +69,7 @@ using google_breakpad::ENDIANNESS_LITTLE;
 using google_breakpad::SectionMap;
 
 using std::vector;
+using testing::AnyNumber;
 using testing::InSequence;
 using testing::Pointee;
 using testing::Return;
@@ -78,6 +85,8 @@ class MockDwarf2Handler: public Dwarf2Handler {
                                           uint64_t cu_length,
                                           uint8_t dwarf_version));
   MOCK_METHOD2(StartDIE, bool(uint64_t offset, enum DwarfTag tag));
+  MOCK_METHOD1(WantsDIEsTagged, bool(enum DwarfTag tag));
+  MOCK_METHOD0(SkipsChildrenOfSkippedDIEs, bool());
   MOCK_METHOD4(ProcessAttributeUnsigned, void(uint64_t offset,
                                               DwarfAttribute attr,
                                               enum DwarfForm form,
@@ -122,6 +131,14 @@ struct DIEFixture {
     EXPECT_CALL(handler, ProcessAttributeBuffer(_, _, _, _, _)).Times(0);
     EXPECT_CALL(handler, ProcessAttributeString(_, _, _, _)).Times(0);
     EXPECT_CALL(handler, EndDIE(_)).Times(0);
+
+    // By default, visit every DIE the handler asks for, as the base class
+    // does.
+    ON_CALL(handler, WantsDIEsTagged(_)).WillByDefault(Return(true));
+    EXPECT_CALL(handler, WantsDIEsTagged(_)).Times(AnyNumber());
+    ON_CALL(handler, SkipsChildrenOfSkippedDIEs())
+        .WillByDefault(Return(false));
+    EXPECT_CALL(handler, SkipsChildrenOfSkippedDIEs()).Times(AnyNumber());
   }
 
   // Return a reference to a section map whose .debug_info section refers
@@ -250,6 +267,406 @@ TEST_P(DwarfHeader, TypeUnitHeader) {
   EXPECT_EQ(parser.Start(), info_contents.size());
 }
 
+// Compilation units sharing an AbbrevCache decode their abbreviation
+// table once, and read their DIEs with it just the same.
+TEST_P(DwarfHeader, SharedAbbrevCache) {
+  Label abbrev_table = abbrevs.Here();
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .EndTable();
+
+  info.set_format_size(GetParam().format_size);
+  info.set_endianness(GetParam().endianness);
+
+  info.Header(GetParam().version, abbrev_table, GetParam().address_size,
+              google_breakpad::DW_UT_compile)
+      .ULEB128(1)                     // DW_TAG_compile_unit, with children
+      .AppendCString("sam")           // DW_AT_name, DW_FORM_string
+      .D8(0);                         // end of children
+  info.Finish();
+
+  EXPECT_CALL(handler,
+              StartCompilationUnit(0, GetParam().address_size,
+                                   GetParam().format_size, _,
+                                   GetParam().version))
+      .Times(2)
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_compile_unit))
+      .Times(2)
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(handler, ProcessAttributeString(_, google_breakpad::DW_AT_name,
+                                              google_breakpad::DW_FORM_string,
+                                              "sam"))
+      .Times(2)
+      .WillRepeatedly(Return());
+  EXPECT_CALL(handler, EndDIE(_))
+      .Times(2)
+      .WillRepeatedly(Return());
+
+  ByteReader byte_reader(GetParam().endianness == kLittleEndian ?
+                         ENDIANNESS_LITTLE : ENDIANNESS_BIG);
+  const SectionMap& sections = MakeSectionMap();
+  const uint8_t* table = sections.find(".debug_abbrev")->second.first;
+  CompilationUnit::AbbrevCache cache;
+  EXPECT_FALSE(cache.Find(table));
+
+  CompilationUnit parser1("", sections, 0, &byte_reader, &handler);
+  parser1.SetAbbrevCache(&cache);
+  EXPECT_EQ(parser1.Start(), info_contents.size());
+  std::shared_ptr<const std::vector<CompilationUnit::Abbrev>> abbrevs =
+      cache.Find(table);
+  ASSERT_TRUE(abbrevs);
+  EXPECT_EQ(2U, abbrevs->size());
+
+  CompilationUnit parser2("", sections, 0, &byte_reader, &handler);
+  parser2.SetAbbrevCache(&cache);
+  EXPECT_EQ(parser2.Start(), info_contents.size());
+  EXPECT_EQ(abbrevs, cache.Find(table));
+}
+
+// DIEs the handler declines are skipped, whether their attributes all
+// have sizes known from their forms or not.
+TEST_P(DwarfHeader, SkipDIEs) {
+  Label abbrev_table = abbrevs.Here();
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(2, google_breakpad::DW_TAG_variable,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_decl_file,
+                 google_breakpad::DW_FORM_data1)
+      .Attribute(google_breakpad::DW_AT_decl_line,
+                 google_breakpad::DW_FORM_data2)
+      .Attribute(google_breakpad::DW_AT_byte_size,
+                 google_breakpad::DW_FORM_data4)
+      .Attribute(google_breakpad::DW_AT_const_value,
+                 google_breakpad::DW_FORM_data8)
+      .Attribute(google_breakpad::DW_AT_low_pc, google_breakpad::DW_FORM_addr)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_strp)
+      .Attribute(google_breakpad::DW_AT_location,
+                 google_breakpad::DW_FORM_sec_offset)
+      .Attribute(google_breakpad::DW_AT_type, google_breakpad::DW_FORM_ref_addr)
+      .Attribute(google_breakpad::DW_AT_external,
+                 google_breakpad::DW_FORM_flag_present)
+      .Attribute(google_breakpad::DW_AT_specification,
+                 google_breakpad::DW_FORM_ref_sig8)
+      .Attribute(google_breakpad::DW_AT_entry_pc,
+                 google_breakpad::DW_FORM_data16)
+      .EndAbbrev()
+      .Abbrev(3, google_breakpad::DW_TAG_variable,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .Attribute(google_breakpad::DW_AT_decl_line,
+                 google_breakpad::DW_FORM_udata)
+      .EndAbbrev()
+      .Abbrev(4, google_breakpad::DW_TAG_subprogram,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .EndTable();
+
+  info.set_format_size(GetParam().format_size);
+  info.set_endianness(GetParam().endianness);
+
+  info.Header(GetParam().version, abbrev_table, GetParam().address_size,
+              google_breakpad::DW_UT_compile)
+      .ULEB128(1)                     // DW_TAG_compile_unit, with children
+      .AppendCString("sam")           // DW_AT_name, DW_FORM_string
+      .ULEB128(2)                     // DW_TAG_variable, fixed sizes
+      .D8(0x01)                       // DW_AT_decl_file, DW_FORM_data1
+      .D16(0x0202)                    // DW_AT_decl_line, DW_FORM_data2
+      .D32(0x03030303)                // DW_AT_byte_size, DW_FORM_data4
+      .D64(0x0404040404040404ULL)     // DW_AT_const_value, DW_FORM_data8
+      .Append(GetParam().address_size, 0x05);  // DW_AT_low_pc, DW_FORM_addr
+  info.SectionOffset(0x06);           // DW_AT_name, DW_FORM_strp
+  info.SectionOffset(0x07);           // DW_AT_location, DW_FORM_sec_offset
+  if (GetParam().version == 2)        // DW_AT_type, DW_FORM_ref_addr
+    info.Append(GetParam().address_size, 0x08);
+  else
+    info.SectionOffset(0x08);
+  info.D64(0x0909090909090909ULL)     // DW_AT_specification, DW_FORM_ref_sig8
+      .Append(16, 0x0a)               // DW_AT_entry_pc, DW_FORM_data16
+      .ULEB128(3)                     // DW_TAG_variable, variable sizes
+      .AppendCString("skipped")       // DW_AT_name, DW_FORM_string
+      .ULEB128(0x12345)               // DW_AT_decl_line, DW_FORM_udata
+      .ULEB128(4)                     // DW_TAG_subprogram
+      .AppendCString("mary")          // DW_AT_name, DW_FORM_string
+      .D8(0);                         // end of children
+  info.Finish();
+
+  {
+    InSequence s;
+    EXPECT_CALL(handler,
+                StartCompilationUnit(0, GetParam().address_size,
+                                     GetParam().format_size, _,
+                                     GetParam().version))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_compile_unit))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, ProcessAttributeString(_, google_breakpad::DW_AT_name,
+                                                google_breakpad::DW_FORM_string,
+                                                "sam"))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_variable))
+        .WillOnce(Return(false));
+    EXPECT_CALL(handler, EndDIE(_))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_variable))
+        .WillOnce(Return(false));
+    EXPECT_CALL(handler, EndDIE(_))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_subprogram))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, ProcessAttributeString(_, google_breakpad::DW_AT_name,
+                                                google_breakpad::DW_FORM_string,
+                                                "mary"))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, EndDIE(_))
+        .Times(2)
+        .WillRepeatedly(Return());
+  }
+
+  ByteReader byte_reader(GetParam().endianness == kLittleEndian ?
+                         ENDIANNESS_LITTLE : ENDIANNESS_BIG);
+  CompilationUnit parser("", MakeSectionMap(), 0, &byte_reader, &handler);
+  EXPECT_EQ(parser.Start(), info_contents.size());
+}
+
+// A handler can have DIEs with tags it never wants stepped over unseen,
+// and the children of DIEs it skips stepped over with them.  The struct's
+// children are jumped over using its DW_AT_sibling attribute, so the
+// bogus abbreviation among them is never read; the enumeration's are
+// stepped over one by one.
+TEST_P(DwarfHeader, SkipSubtrees) {
+  Label abbrev_table = abbrevs.Here();
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(2, google_breakpad::DW_TAG_structure_type,
+              google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .Attribute(google_breakpad::DW_AT_sibling, google_breakpad::DW_FORM_ref4)
+      .EndAbbrev()
+      .Abbrev(3, google_breakpad::DW_TAG_member,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(4, google_breakpad::DW_TAG_enumeration_type,
+              google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(5, google_breakpad::DW_TAG_enumerator,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_const_value,
+                 google_breakpad::DW_FORM_udata)
+      .EndAbbrev()
+      .Abbrev(6, google_breakpad::DW_TAG_base_type,
+              google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(7, google_breakpad::DW_TAG_subprogram,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .EndTable();
+
+  info.set_format_size(GetParam().format_size);
+  info.set_endianness(GetParam().endianness);
+
+  Label after_struct;
+  info.Header(GetParam().version, abbrev_table, GetParam().address_size,
+              google_breakpad::DW_UT_compile)
+      .ULEB128(1)                     // DW_TAG_compile_unit, with children
+      .AppendCString("sam")           // DW_AT_name, DW_FORM_string
+      .ULEB128(2)                     // DW_TAG_structure_type, with children
+      .AppendCString("s")             // DW_AT_name, DW_FORM_string
+      .D32(after_struct)              // DW_AT_sibling, DW_FORM_ref4
+      .ULEB128(3)                     // DW_TAG_member
+      .AppendCString("m")             // DW_AT_name, DW_FORM_string
+      .ULEB128(0x7f)                  // no such abbreviation
+      .D8(0);                         // end of children
+  info.Mark(&after_struct);
+  info.ULEB128(4)                     // DW_TAG_enumeration_type
+      .AppendCString("e")             // DW_AT_name, DW_FORM_string
+      .ULEB128(5)                     // DW_TAG_enumerator
+      .ULEB128(0x12345)               // DW_AT_const_value, DW_FORM_udata
+      .D8(0)                          // end of children
+      .ULEB128(6)                     // DW_TAG_base_type, never wanted
+      .AppendCString("int")           // DW_AT_name, DW_FORM_string
+      .ULEB128(3)                     // DW_TAG_member
+      .AppendCString("n")             // DW_AT_name, DW_FORM_string
+      .D8(0)                          // end of children
+      .ULEB128(7)                     // DW_TAG_subprogram
+      .AppendCString("mary")          // DW_AT_name, DW_FORM_string
+      .D8(0);                         // end of children
+  info.Finish();
+
+  EXPECT_CALL(handler, SkipsChildrenOfSkippedDIEs())
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(handler, WantsDIEsTagged(google_breakpad::DW_TAG_base_type))
+      .WillRepeatedly(Return(false));
+  {
+    InSequence s;
+    EXPECT_CALL(handler,
+                StartCompilationUnit(0, GetParam().address_size,
+                                     GetParam().format_size, _,
+                                     GetParam().version))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_compile_unit))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, ProcessAttributeString(_, google_breakpad::DW_AT_name,
+                                                google_breakpad::DW_FORM_string,
+                                                "sam"))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_structure_type))
+        .WillOnce(Return(false));
+    EXPECT_CALL(handler, EndDIE(_))
+        .WillOnce(Return());
+    EXPECT_CALL(handler,
+                StartDIE(_, google_breakpad::DW_TAG_enumeration_type))
+        .WillOnce(Return(false));
+    EXPECT_CALL(handler, EndDIE(_))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_subprogram))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, ProcessAttributeString(_, google_breakpad::DW_AT_name,
+                                                google_breakpad::DW_FORM_string,
+                                                "mary"))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, EndDIE(_))
+        .Times(2)
+        .WillRepeatedly(Return());
+  }
+
+  ByteReader byte_reader(GetParam().endianness == kLittleEndian ?
+                         ENDIANNESS_LITTLE : ENDIANNESS_BIG);
+  CompilationUnit parser("", MakeSectionMap(), 0, &byte_reader, &handler);
+  EXPECT_EQ(parser.Start(), info_contents.size());
+}
+
+// A compilation unit told to read only its root DIE passes that to the
+// handler, and none of its children.
+TEST_P(DwarfHeader, RootDIEOnly) {
+  Label abbrev_table = abbrevs.Here();
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(2, google_breakpad::DW_TAG_subprogram,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .EndTable();
+
+  info.set_format_size(GetParam().format_size);
+  info.set_endianness(GetParam().endianness);
+
+  info.Header(GetParam().version, abbrev_table, GetParam().address_size,
+              google_breakpad::DW_UT_compile)
+      .ULEB128(1)                     // DW_TAG_compile_unit, with children
+      .AppendCString("sam")           // DW_AT_name, DW_FORM_string
+      .ULEB128(2)                     // DW_TAG_subprogram, no children
+      .AppendCString("mary")          // DW_AT_name, DW_FORM_string
+      .D8(0);                         // end of children
+  info.Finish();
+
+  {
+    InSequence s;
+    EXPECT_CALL(handler,
+                StartCompilationUnit(0, GetParam().address_size,
+                                     GetParam().format_size, _,
+                                     GetParam().version))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_compile_unit))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, ProcessAttributeString(_, google_breakpad::DW_AT_name,
+                                                google_breakpad::DW_FORM_string,
+                                                "sam"))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, EndDIE(_))
+        .WillOnce(Return());
+  }
+  EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_subprogram))
+      .Times(0);
+
+  ByteReader byte_reader(GetParam().endianness == kLittleEndian ?
+                         ENDIANNESS_LITTLE : ENDIANNESS_BIG);
+  CompilationUnit parser("", MakeSectionMap(), 0, &byte_reader, &handler);
+  parser.SetRootDIEOnly();
+  EXPECT_EQ(parser.Start(), info_contents.size());
+}
+
+// A compilation unit given a list of DIE offsets passes the handler its
+// root DIE and then only the listed DIEs, as though they were the root's
+// children.
+TEST_P(DwarfHeader, ListedDIEsOnly) {
+  Label abbrev_table = abbrevs.Here();
+  abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                 google_breakpad::DW_children_yes)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .Abbrev(2, google_breakpad::DW_TAG_subprogram,
+              google_breakpad::DW_children_no)
+      .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_string)
+      .EndAbbrev()
+      .EndTable();
+
+  info.set_format_size(GetParam().format_size);
+  info.set_endianness(GetParam().endianness);
+
+  info.Header(GetParam().version, abbrev_table, GetParam().address_size,
+              google_breakpad::DW_UT_compile)
+      .ULEB128(1)                     // DW_TAG_compile_unit, with children
+      .AppendCString("sam")           // DW_AT_name, DW_FORM_string
+      .ULEB128(2)                     // DW_TAG_subprogram, no children
+      .AppendCString("mary");         // DW_AT_name, DW_FORM_string
+  const uint64_t tom = info.Size();
+  info.ULEB128(2)                     // DW_TAG_subprogram, no children
+      .AppendCString("tom")           // DW_AT_name, DW_FORM_string
+      .D8(0);                         // end of children
+  info.Finish();
+
+  {
+    InSequence s;
+    EXPECT_CALL(handler,
+                StartCompilationUnit(0, GetParam().address_size,
+                                     GetParam().format_size, _,
+                                     GetParam().version))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, StartDIE(_, google_breakpad::DW_TAG_compile_unit))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, ProcessAttributeString(_, google_breakpad::DW_AT_name,
+                                                google_breakpad::DW_FORM_string,
+                                                "sam"))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, StartDIE(tom, google_breakpad::DW_TAG_subprogram))
+        .WillOnce(Return(true));
+    EXPECT_CALL(handler, ProcessAttributeString(tom,
+                                                google_breakpad::DW_AT_name,
+                                                google_breakpad::DW_FORM_string,
+                                                "tom"))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, EndDIE(tom))
+        .WillOnce(Return());
+    EXPECT_CALL(handler, EndDIE(_))
+        .WillOnce(Return());
+  }
+
+  // Offsets outside the unit are ignored.
+  vector<uint64_t> offsets;
+  offsets.push_back(tom);
+  offsets.push_back(info_contents.size() + 10);
+  ByteReader byte_reader(GetParam().endianness == kLittleEndian ?
+                         ENDIANNESS_LITTLE : ENDIANNESS_BIG);
+  CompilationUnit parser("", MakeSectionMap(), 0, &byte_reader, &handler);
+  parser.SetDIEOffsets(&offsets);
+  EXPECT_EQ(parser.Start(), info_contents.size());
+}
+
 INSTANTIATE_TEST_SUITE_P(
     HeaderVariants, DwarfHeader,
     ::testing::Values(DwarfHeaderParams(kLittleEndian, 4, 2, 4, 1),
@@ -962,3 +1379,226 @@ TEST(RangeList, Dwarf5ReadRangeList_sec_offset) {
   EXPECT_FALSE(range_list_reader.ReadRanges(DW_FORM_sec_offset,
                                             rnglists_contents.size()));
 }
+
+// A .debug_names table's entries are read for every name, with each
+// entry's unit and DIE offsets resolved, and entries for DIEs in type
+// units left out.
+TEST(NameIndex, ReadEntries) {
+  using google_breakpad::NameIndexReader;
+
+  Section str(kLittleEndian);
+  str.D8(0);
+  const uint64_t foo = str.Size();
+  str.AppendCString("foo");
+  const uint64_t foo_linkage = str.Size();
+  str.AppendCString("_ZN2ns3fooEv");
+  const uint64_t int_name = str.Size();
+  str.AppendCString("int");
+  string str_contents;
+  ASSERT_TRUE(str.GetContents(&str_contents));
+
+  Section names(kLittleEndian);
+  Label table_length, abbrevs_size;
+  Label foo_entries, foo_linkage_entries, int_entries;
+  names.Append(kLittleEndian, 4, table_length);
+  const uint64_t table_start = names.Size();
+  names.D16(5).D16(0);                // version, padding
+  names.D32(2);                       // comp_unit_count
+  names.D32(1);                       // local_type_unit_count
+  names.D32(0);                       // foreign_type_unit_count
+  names.D32(1);                       // bucket_count
+  names.D32(3);                       // name_count
+  names.Append(kLittleEndian, 4, abbrevs_size);
+  names.D32(4).Append("LLVM");        // augmentation string
+  names.D32(0).D32(0x40);             // compilation units
+  names.D32(0x80);                    // type units
+  names.D32(1);                       // bucket
+  names.D32(0).D32(0).D32(0);         // hashes
+  names.D32(foo).D32(foo_linkage).D32(int_name);
+  names.Append(kLittleEndian, 4, foo_entries);
+  names.Append(kLittleEndian, 4, foo_linkage_entries);
+  names.Append(kLittleEndian, 4, int_entries);
+
+  const uint64_t abbrevs_start = names.Size();
+  names.ULEB128(1).ULEB128(google_breakpad::DW_TAG_subprogram)
+      .ULEB128(google_breakpad::DW_IDX_compile_unit)
+      .ULEB128(google_breakpad::DW_FORM_data1)
+      .ULEB128(google_breakpad::DW_IDX_die_offset)
+      .ULEB128(google_breakpad::DW_FORM_ref4)
+      .ULEB128(0).ULEB128(0);
+  names.ULEB128(2).ULEB128(google_breakpad::DW_TAG_base_type)
+      .ULEB128(google_breakpad::DW_IDX_type_unit)
+      .ULEB128(google_breakpad::DW_FORM_data1)
+      .ULEB128(google_breakpad::DW_IDX_die_offset)
+      .ULEB128(google_breakpad::DW_FORM_ref4)
+      .ULEB128(0).ULEB128(0);
+  names.ULEB128(3).ULEB128(google_breakpad::DW_TAG_variable)
+      .ULEB128(google_breakpad::DW_IDX_compile_unit)
+      .ULEB128(google_breakpad::DW_FORM_udata)
+      .ULEB128(google_breakpad::DW_IDX_die_offset)
+      .ULEB128(google_breakpad::DW_FORM_ref_udata)
+      .ULEB128(google_breakpad::DW_IDX_parent)
+      .ULEB128(google_breakpad::DW_FORM_flag_present)
+      .ULEB128(0).ULEB128(0);
+  names.ULEB128(0);
+  const uint64_t pool = names.Size();
+  abbrevs_size = pool - abbrevs_start;
+
+  foo_entries = names.Size() - pool;
+  names.ULEB128(1).D8(1).D32(0x20);   // subprogram in the second unit
+  names.ULEB128(3).ULEB128(0).ULEB128(0x30);  // variable in the first
+  names.ULEB128(0);
+  foo_linkage_entries = names.Size() - pool;
+  names.ULEB128(1).D8(1).D32(0x20);
+  names.ULEB128(0);
+  int_entries = names.Size() - pool;
+  names.ULEB128(2).D8(0).D32(0x18);   // base type in the type unit
+  names.ULEB128(0);
+  table_length = names.Size() - table_start;
+  string names_contents;
+  ASSERT_TRUE(names.GetContents(&names_contents));
+
+  ByteReader byte_reader(ENDIANNESS_LITTLE);
+  NameIndexReader reader(
+      reinterpret_cast<const uint8_t*>(names_contents.data()),
+      names_contents.size(),
+      reinterpret_cast<const uint8_t*>(str_contents.data()),
+      str_contents.size(), &byte_reader);
+  vector<NameIndexReader::Entry> entries;
+  vector<uint64_t> units;
+  ASSERT_TRUE(reader.ReadEntries(&entries, &units));
+
+  ASSERT_EQ(2U, units.size());
+  EXPECT_EQ(0U, units[0]);
+  EXPECT_EQ(0x40U, units[1]);
+  ASSERT_EQ(3U, entries.size());
+  EXPECT_STREQ("foo", entries[0].name);
+  EXPECT_EQ(google_breakpad::DW_TAG_subprogram, entries[0].tag);
+  EXPECT_EQ(0x40U, entries[0].unit_offset);
+  EXPECT_EQ(0x60U, entries[0].die_offset);
+  EXPECT_STREQ("foo", entries[1].name);
+  EXPECT_EQ(google_breakpad::DW_TAG_variable, entries[1].tag);
+  EXPECT_EQ(0U, entries[1].unit_offset);
+  EXPECT_EQ(0x30U, entries[1].die_offset);
+  EXPECT_STREQ("_ZN2ns3fooEv", entries[2].name);
+  EXPECT_EQ(google_breakpad::DW_TAG_subprogram, entries[2].tag);
+  EXPECT_EQ(0x40U, entries[2].unit_offset);
+  EXPECT_EQ(0x60U, entries[2].die_offset);
+}
+
+// A table that indexes a single compilation unit may leave the unit out
+// of its entries; a table with a version other than 5 can't be read.
+TEST(NameIndex, SingleUnitAndBadVersion) {
+  using google_breakpad::NameIndexReader;
+
+  const string str_contents("\0main\0", 6);
+  for (int version = 5; version <= 6; ++version) {
+    Section names(kBigEndian);
+    Label table_length, abbrevs_size;
+    names.Append(kBigEndian, 4, table_length);
+    const uint64_t table_start = names.Size();
+    names.D16(version).D16(0);
+    names.D32(1).D32(0).D32(0);       // one compilation unit
+    names.D32(0);                     // no buckets, and so no hashes
+    names.D32(1);                     // name_count
+    names.Append(kBigEndian, 4, abbrevs_size);
+    names.D32(0);                     // no augmentation string
+    names.D32(0x100);                 // compilation unit
+    names.D32(1);                     // string offset of "main"
+    names.D32(0);                     // entry offset
+    const uint64_t abbrevs_start = names.Size();
+    names.ULEB128(7).ULEB128(google_breakpad::DW_TAG_subprogram)
+        .ULEB128(google_breakpad::DW_IDX_die_offset)
+        .ULEB128(google_breakpad::DW_FORM_ref2)
+        .ULEB128(0).ULEB128(0);
+    names.ULEB128(0);
+    abbrevs_size = names.Size() - abbrevs_start;
+    names.ULEB128(7).D16(0x2a);
+    names.ULEB128(0);
+    table_length = names.Size() - table_start;
+    string names_contents;
+    ASSERT_TRUE(names.GetContents(&names_contents));
+
+    ByteReader byte_reader(ENDIANNESS_BIG);
+    NameIndexReader reader(
+        reinterpret_cast<const uint8_t*>(names_contents.data()),
+        names_contents.size(),
+        reinterpret_cast<const uint8_t*>(str_contents.data()),
+        str_contents.size(), &byte_reader);
+    vector<NameIndexReader::Entry> entries;
+    vector<uint64_t> units;
+    if (version != 5) {
+      EXPECT_FALSE(reader.ReadEntries(&entries, &units));
+      continue;
+    }
+    ASSERT_TRUE(reader.ReadEntries(&entries, &units));
+    ASSERT_EQ(1U, units.size());
+    ASSERT_EQ(1U, entries.size());
+    EXPECT_STREQ("main", entries[0].name);
+    EXPECT_EQ(0x100U, entries[0].unit_offset);
+    EXPECT_EQ(0x12aU, entries[0].die_offset);
+  }
+}
+
+// A .dwo file is opened once, and its debug sections found under the
+// names they have in an executable.
+TEST(SplitDwarfFiles, Dwo) {
+  ELF elf(EM_X86_64, ELFCLASS64, kLittleEndian);
+  Section abbrev(kLittleEndian);
+  abbrev.Append("abbrev");
+  Section info(kLittleEndian);
+  info.Append("information");
+  elf.AddSection(".debug_abbrev.dwo", abbrev, SHT_PROGBITS);
+  elf.AddSection(".debug_info.dwo", info, SHT_PROGBITS);
+  elf.Finish();
+  string contents;
+  ASSERT_TRUE(elf.GetContents(&contents));
+
+  AutoTempDir temp_dir;
+  const string dwo_path = temp_dir.path() + "/unit.dwo";
+  ASSERT_TRUE(google_breakpad::WriteFile(dwo_path.c_str(), contents.data(),
+                                         contents.size()));
+
+  CompilationUnit::SplitDwarfFiles files;
+  EXPECT_TRUE(files.OpenDwo(dwo_path));
+  EXPECT_TRUE(files.OpenDwo(dwo_path));
+  SectionMap sections;
+  int address_size = 0;
+  ASSERT_TRUE(files.FindDwo(dwo_path, &sections, &address_size));
+  EXPECT_EQ(8, address_size);
+  ASSERT_EQ(2U, sections.size());
+  ASSERT_TRUE(sections.count(".debug_abbrev"));
+  EXPECT_EQ("abbrev",
+            string(reinterpret_cast<const char*>(
+                       sections[".debug_abbrev"].first),
+                   sections[".debug_abbrev"].second));
+  ASSERT_TRUE(sections.count(".debug_info"));
+  EXPECT_EQ("information",
+            string(reinterpret_cast<const char*>(
+                       sections[".debug_info"].first),
+                   sections[".debug_info"].second));
+
+  // There is no .dwp file beside the executable.
+  const string executable = temp_dir.path() + "/unit";
+  string dwp_path;
+  EXPECT_FALSE(files.HasDwp(executable, ENDIANNESS_LITTLE));
+  EXPECT_FALSE(files.FindInDwp(executable, ENDIANNESS_LITTLE, 0x1234,
+                               &sections, &dwp_path, &address_size));
+}
+
+// Files that don't exist, or aren't ELF files, aren't found.
+TEST(SplitDwarfFiles, Missing) {
+  AutoTempDir temp_dir;
+  const string missing = temp_dir.path() + "/missing.dwo";
+  const string not_elf = temp_dir.path() + "/not-elf.dwo";
+  ASSERT_TRUE(google_breakpad::WriteFile(not_elf.c_str(), "text", 4));
+
+  CompilationUnit::SplitDwarfFiles files;
+  SectionMap sections;
+  int address_size;
+  EXPECT_FALSE(files.OpenDwo(missing));
+  EXPECT_FALSE(files.FindDwo(missing, &sections, &address_size));
+  EXPECT_FALSE(files.OpenDwo(not_elf));
+  EXPECT_FALSE(files.FindDwo(not_elf, &sections, &address_size));
+  EXPECT_TRUE(sections.empty());
+}
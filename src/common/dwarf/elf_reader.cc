@@ -32,6 +32,7 @@
 
 #include <fcntl.h>
 #include <limits.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -42,12 +43,10 @@
 #include <map>
 #include <string>
 #include <vector>
-// TODO(saugustine): Add support for compressed debug.
-// Also need to add configure tests for zlib.
-//#include "zlib.h"
 
 #include "third_party/musl/include/elf.h"
 #include "elf_reader.h"
+#include "common/linux/compressed_section.h"
 #include "common/using_std_string.h"
 
 // EM_AARCH64 is not defined by elf.h of GRTE v3 on x86.
@@ -203,17 +202,26 @@ class ElfSectionReader {
                 (header_.sh_offset - offset_aligned);
 
     // Check for and handle any compressed contents.
-    //if (strncmp(name, ".zdebug_", strlen(".zdebug_")) == 0)
-    //  DecompressZlibContents();
-    // TODO(saugustine): Add support for proposed elf-section flag
-    // "SHF_COMPRESS".
+    if (header_.sh_flags & SHF_COMPRESSED) {
+      uint64_t uncompressed_size = 0;
+      if (!google_breakpad::DecompressSection(
+              ElfArch::kElfClass == ELFCLASS64,
+              reinterpret_cast<const uint8_t*>(contents_), section_size_,
+              &uncompressed_, &uncompressed_size)) {
+        fprintf(stderr, "%s: failed to decompress section %s\n",
+                path.c_str(), name);
+        uncompressed_size = 0;
+      }
+      munmap(contents_aligned_, size_aligned_);
+      contents_aligned_ = NULL;
+      contents_ = reinterpret_cast<char*>(uncompressed_.get());
+      section_size_ = uncompressed_size;
+    }
   }
 
   ~ElfSectionReader() {
     if (contents_aligned_ != NULL)
       munmap(contents_aligned_, size_aligned_);
-    else
-      delete[] contents_;
   }
 
   // Return the section header for this section.
@@ -239,6 +247,8 @@ class ElfSectionReader {
   size_t size_aligned_;
   // size of contents.
   size_t section_size_;
+  // the decompressed contents of a compressed section.
+  std::unique_ptr<uint8_t[]> uncompressed_;
   const typename ElfArch::Shdr header_;
 };
 
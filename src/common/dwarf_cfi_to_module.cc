@@ -164,7 +164,8 @@ bool DwarfCFIToModule::Entry(size_t offset, uint64_t address, uint64_t length,
   // address on entry to the function. So establish an initial .ra
   // rule citing the return address register.
   if (return_address_ < register_names_.size())
-    entry_->initial_rules[ra_name_] = register_names_[return_address_];
+    entry_->initial_rules[Share(ra_name_)] =
+        Share(register_names_[return_address_]);
 
   return true;
 }
@@ -193,20 +194,20 @@ void DwarfCFIToModule::Record(Module::Address address, int reg,
                               const string& rule) {
   assert(entry_);
 
-  // Place the name in our global set of strings, and then use the string
-  // from the set. Even though the assignment looks like a copy, all the
-  // major string implementations use reference counting internally,
-  // so the effect is to have all our data structures share copies of rules
-  // whenever possible. Since register names are drawn from a
-  // vector<string>, register names are already shared.
-  string shared_rule = *common_strings_.insert(rule).first;
-
   // Is this one of this entry's initial rules?
   if (address == entry_->address)
-    entry_->initial_rules[RegisterName(reg)] = shared_rule;
+    entry_->initial_rules[Share(RegisterName(reg))] = Share(rule);
   // File it under the appropriate address.
   else
-    entry_->rule_changes[address][RegisterName(reg)] = shared_rule;
+    entry_->rule_changes[address][Share(RegisterName(reg))] = Share(rule);
+}
+
+Module::RuleString DwarfCFIToModule::Share(const string& str) {
+  map<string, Module::RuleString>::iterator shared =
+      rule_strings_.lower_bound(str);
+  if (shared == rule_strings_.end() || shared->first != str)
+    shared = rule_strings_.insert(shared, std::make_pair(str, str));
+  return shared->second;
 }
 
 bool DwarfCFIToModule::UndefinedRule(uint64_t address, int reg) {
@@ -42,6 +42,7 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <map>
 #include <set>
 #include <string>
 #include <vector>
@@ -53,6 +54,7 @@
 namespace google_breakpad {
 
 using google_breakpad::Module;
+using std::map;
 using std::set;
 using std::vector;
 
@@ -159,6 +161,9 @@ class DwarfCFIToModule: public CallFrameInfo::Handler {
   // Record RULE for register REG at ADDRESS.
   void Record(Module::Address address, int reg, const string& rule);
 
+  // Return STR as a Module::RuleString.
+  Module::RuleString Share(const string& str);
+
   // The module to which we should add entries.
   Module* module_;
 
@@ -184,16 +189,11 @@ class DwarfCFIToModule: public CallFrameInfo::Handler {
   // popular ones). Many, many rules cite these strings.
   string cfa_name_, ra_name_;
 
-  // A set of strings used by this CFI. Before storing a string in one of
-  // our data structures, insert it into this set, and then use the string
-  // from the set.
-  //
-  // Because string uses reference counting internally, simply using
-  // strings from this set, even if passed by value, assigned, or held
-  // directly in structures and containers (map<string, ...>, for example),
-  // causes those strings to share a single instance of each distinct piece
-  // of text.
-  set<string> common_strings_;
+  // The RuleStrings for the register names and rules this CFI has used.
+  // Looking them up here, rather than making a RuleString of each anew,
+  // saves taking the lock on the process-wide set of RuleStrings, which
+  // other threads converting CFI may be holding.
+  map<string, Module::RuleString> rule_strings_;
 };
 
 } // namespace google_breakpad
@@ -0,0 +1,662 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dwarf_cu_cache.cc: Implement DwarfCUCache.  See dwarf_cu_cache.h for
+// details.
+
+#include "common/dwarf_cu_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/md5.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The version of the entries' layout, which is part of every key, so
+// that entries written by other versions are never read.
+const char kEntryVersion[] = "breakpad-dwarf-cu-cache-1";
+
+// The first and last words of every entry.
+const uint32_t kEntryBegin = 0x42504355;  // "BPCU"
+const uint32_t kEntryEnd = 0x454e4443;    // "ENDC"
+
+// A marker for a missing file in an entry.
+const uint64_t kNoFile = ~static_cast<uint64_t>(0);
+
+// Hashes what a conversion of a compilation unit would read, as a
+// CompilationUnit reports it.  Offsets into other sections aren't hashed
+// themselves; what they refer to is.
+class KeyHandler : public Dwarf2Handler {
+ public:
+  KeyHandler()
+      : unit_offset_(0), version_(0), depth_(0), low_pc_(0),
+        ranges_base_(0), addr_base_(0), has_lines_(false), line_offset_(0),
+        split_(false) {
+    MD5Init(&context_);
+  }
+
+  bool StartCompilationUnit(uint64_t offset, uint8_t address_size,
+                            uint8_t offset_size, uint64_t cu_length,
+                            uint8_t dwarf_version) {
+    unit_offset_ = offset;
+    version_ = dwarf_version;
+    AddKind('U');
+    AddNumber(address_size);
+    AddNumber(offset_size);
+    AddNumber(cu_length);
+    AddNumber(dwarf_version);
+    return true;
+  }
+
+  bool NeedSplitDebugInfo() { return false; }
+
+  bool StartDIE(uint64_t offset, enum DwarfTag tag) {
+    AddKind('D');
+    AddNumber(tag);
+    AddNumber(offset - unit_offset_);
+    ++depth_;
+    return true;
+  }
+
+  void ProcessAttributeUnsigned(uint64_t offset, enum DwarfAttribute attr,
+                                enum DwarfForm form, uint64_t data) {
+    AddAttribute(attr, form);
+    if (form != DW_FORM_sec_offset && !IsSectionOffset(attr))
+      AddNumber(data);
+    if (attr == DW_AT_ranges) {
+      ranges_.push_back(std::make_pair(form, data));
+    } else if (depth_ == 1) {
+      // The root DIE's attributes that locate the unit's other data.
+      switch (attr) {
+        case DW_AT_stmt_list:
+          has_lines_ = true;
+          line_offset_ = data;
+          break;
+        case DW_AT_low_pc:
+          low_pc_ = data;
+          break;
+        case DW_AT_rnglists_base:
+          ranges_base_ = data;
+          break;
+        case DW_AT_addr_base:
+        case DW_AT_GNU_addr_base:
+          addr_base_ = data;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  void ProcessAttributeSigned(uint64_t offset, enum DwarfAttribute attr,
+                              enum DwarfForm form, int64_t data) {
+    AddAttribute(attr, form);
+    AddNumber(data);
+  }
+
+  void ProcessAttributeReference(uint64_t offset, enum DwarfAttribute attr,
+                                 enum DwarfForm form, uint64_t data) {
+    AddAttribute(attr, form);
+    AddNumber(data - unit_offset_);
+  }
+
+  void ProcessAttributeBuffer(uint64_t offset, enum DwarfAttribute attr,
+                              enum DwarfForm form, const uint8_t* data,
+                              uint64_t len) {
+    AddAttribute(attr, form);
+    AddBytes(data, len);
+  }
+
+  void ProcessAttributeString(uint64_t offset, enum DwarfAttribute attr,
+                              enum DwarfForm form, const string& data) {
+    if (attr == DW_AT_GNU_dwo_name || attr == DW_AT_dwo_name)
+      split_ = true;
+    AddAttribute(attr, form);
+    AddString(data);
+  }
+
+  void ProcessAttributeSignature(uint64_t offset, enum DwarfAttribute attr,
+                                 enum DwarfForm form, uint64_t signature) {
+    AddAttribute(attr, form);
+    AddNumber(signature);
+  }
+
+  void EndDIE(uint64_t offset) {
+    AddKind('E');
+    --depth_;
+  }
+
+  // Add the lines of the unit's line number program and the ranges its
+  // DIEs refer to, reading them from SECTIONS with READER.
+  void AddLinesAndRanges(const SectionMap& sections, ByteReader* reader);
+
+  // True if the unit refers to split DWARF.
+  bool split() const { return split_; }
+
+  // Add NUMBER, as a ULEB128 number, so that the small numbers most
+  // attributes hold take little hashing.
+  void AddNumber(uint64_t number) {
+    do {
+      uint8_t byte = number & 0x7f;
+      number >>= 7;
+      if (number)
+        byte |= 0x80;
+      buffer_.push_back(static_cast<char>(byte));
+    } while (number);
+    if (buffer_.size() >= kBufferSize)
+      Flush();
+  }
+
+  void AddBytes(const uint8_t* data, uint64_t length) {
+    AddNumber(length);
+    buffer_.append(reinterpret_cast<const char*>(data), length);
+    if (buffer_.size() >= kBufferSize)
+      Flush();
+  }
+
+  void AddString(const string& data) {
+    AddBytes(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  }
+
+  // Set DIGEST to the hash of everything added.
+  void Finish(unsigned char digest[16]) {
+    Flush();
+    MD5Final(digest, &context_);
+  }
+
+ private:
+  // Adds each line and file the line number program defines.
+  class LineHandler : public LineInfoHandler {
+   public:
+    explicit LineHandler(KeyHandler* key) : key_(key) {}
+    void DefineDir(const string& name, uint32_t dir_num) {
+      key_->AddNumber(dir_num);
+      key_->AddString(name);
+    }
+    void DefineFile(const string& name, int32_t file_num, uint32_t dir_num,
+                    uint64_t mod_time, uint64_t length) {
+      key_->AddNumber(file_num);
+      key_->AddNumber(dir_num);
+      key_->AddString(name);
+    }
+    void AddLine(uint64_t address, uint64_t length, uint32_t file_num,
+                 uint32_t line_num, uint32_t column_num) {
+      key_->AddNumber(address);
+      key_->AddNumber(length);
+      key_->AddNumber(file_num);
+      key_->AddNumber(line_num);
+    }
+
+   private:
+    KeyHandler* key_;
+  };
+
+  // Adds each range of a range list.
+  class RangeHandler : public RangeListHandler {
+   public:
+    explicit RangeHandler(KeyHandler* key) : key_(key) {}
+    void AddRange(uint64_t begin, uint64_t end) {
+      key_->AddNumber(begin);
+      key_->AddNumber(end);
+    }
+
+   private:
+    KeyHandler* key_;
+  };
+
+  // The size past which the buffer is hashed.
+  static const size_t kBufferSize = 64 * 1024;
+
+  // True if ATTR's value is an offset into another section.
+  static bool IsSectionOffset(enum DwarfAttribute attr) {
+    switch (attr) {
+      case DW_AT_stmt_list:
+      case DW_AT_ranges:
+      case DW_AT_rnglists_base:
+      case DW_AT_addr_base:
+      case DW_AT_GNU_addr_base:
+      case DW_AT_str_offsets_base:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  void AddKind(char kind) { buffer_.push_back(kind); }
+
+  void AddAttribute(enum DwarfAttribute attr, enum DwarfForm form) {
+    AddKind('A');
+    AddNumber(attr);
+    AddNumber(form);
+  }
+
+  void Flush() {
+    MD5Update(&context_, reinterpret_cast<const unsigned char*>(
+                             buffer_.data()), buffer_.size());
+    buffer_.clear();
+  }
+
+  MD5Context context_;
+  string buffer_;
+  uint64_t unit_offset_;
+  uint8_t version_;
+  int depth_;
+
+  // The root DIE's low_pc, range list and address bases.
+  uint64_t low_pc_, ranges_base_, addr_base_;
+
+  // Whether the unit has a line number program, and its offset.
+  bool has_lines_;
+  uint64_t line_offset_;
+
+  // The forms and values of the DW_AT_ranges attributes seen.
+  std::vector<std::pair<enum DwarfForm, uint64_t>> ranges_;
+
+  bool split_;
+};
+
+void KeyHandler::AddLinesAndRanges(const SectionMap& sections,
+                                   ByteReader* reader) {
+  SectionMap::const_iterator lines = GetSectionByName(sections, ".debug_line");
+  if (has_lines_ && lines != sections.end() &&
+      line_offset_ < lines->second.second) {
+    const uint8_t* str = nullptr;
+    uint64_t str_length = 0;
+    SectionMap::const_iterator section =
+        GetSectionByName(sections, ".debug_str");
+    if (section != sections.end()) {
+      str = section->second.first;
+      str_length = section->second.second;
+    }
+    const uint8_t* line_str = nullptr;
+    uint64_t line_str_length = 0;
+    section = GetSectionByName(sections, ".debug_line_str");
+    if (section != sections.end()) {
+      line_str = section->second.first;
+      line_str_length = section->second.second;
+    }
+    LineHandler handler(this);
+    LineInfo parser(lines->second.first + line_offset_,
+                    lines->second.second - line_offset_, reader, str,
+                    str_length, line_str, line_str_length, &handler);
+    AddNumber(parser.Start());
+  }
+
+  if (ranges_.empty())
+    return;
+  RangeListReader::CURangesInfo info;
+  info.version_ = version_;
+  info.base_address_ = low_pc_;
+  info.ranges_base_ = ranges_base_;
+  SectionMap::const_iterator section = GetSectionByName(
+      sections, version_ <= 4 ? ".debug_ranges" : ".debug_rnglists");
+  if (section == sections.end())
+    return;
+  info.buffer_ = section->second.first;
+  info.size_ = section->second.second;
+  if (version_ > 4) {
+    section = GetSectionByName(sections, ".debug_addr");
+    if (section == sections.end())
+      return;
+    info.addr_buffer_ = section->second.first;
+    info.addr_buffer_size_ = section->second.second;
+    info.addr_base_ = addr_base_;
+  }
+  for (const auto& range : ranges_) {
+    RangeHandler handler(this);
+    RangeListReader range_list_reader(reader, &info, &handler);
+    AddNumber(range_list_reader.ReadRanges(range.first, range.second));
+  }
+}
+
+// Writes the numbers and strings of an entry to a file, noting whether
+// all went well.
+class EntryWriter {
+ public:
+  explicit EntryWriter(FILE* file) : file_(file), ok_(true) {}
+
+  void WriteNumber(uint64_t number) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++)
+      bytes[i] = static_cast<uint8_t>(number >> (8 * i));
+    Write(bytes, sizeof(bytes));
+  }
+
+  void WriteString(StringView str) {
+    WriteNumber(str.size());
+    Write(str.data(), str.size());
+  }
+
+  void WriteRanges(const vector<Module::Range>& ranges) {
+    WriteNumber(ranges.size());
+    for (const Module::Range& range : ranges) {
+      WriteNumber(range.address);
+      WriteNumber(range.size);
+    }
+  }
+
+  bool ok() const { return ok_; }
+
+ private:
+  void Write(const void* data, size_t length) {
+    if (ok_ && length && fwrite(data, length, 1, file_) != 1)
+      ok_ = false;
+  }
+
+  FILE* file_;
+  bool ok_;
+};
+
+// Reads the numbers and strings of an entry from a file, noting whether
+// all went well.  Once a read fails, the rest read as zeros or empty.
+class EntryReader {
+ public:
+  explicit EntryReader(FILE* file) : file_(file), ok_(true), remaining_(0) {
+    long end;
+    if (fseek(file_, 0, SEEK_END) != 0 || (end = ftell(file_)) < 0 ||
+        fseek(file_, 0, SEEK_SET) != 0) {
+      ok_ = false;
+    } else {
+      remaining_ = end;
+    }
+  }
+
+  uint64_t ReadNumber() {
+    uint8_t bytes[8];
+    if (!Read(bytes, sizeof(bytes)))
+      return 0;
+    uint64_t number = 0;
+    for (int i = 0; i < 8; i++)
+      number |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    return number;
+  }
+
+  string ReadString() {
+    uint64_t length = ReadNumber();
+    // Don't trust a length that would run past the end of the file.
+    if (!ok_ || length > remaining_) {
+      ok_ = false;
+      return string();
+    }
+    string str(length, '\0');
+    Read(&str[0], length);
+    return str;
+  }
+
+  // Read a count of items, each at least ITEM_SIZE bytes long.
+  uint64_t ReadCount(uint64_t item_size) {
+    uint64_t count = ReadNumber();
+    if (!ok_ || count > remaining_ / item_size) {
+      ok_ = false;
+      return 0;
+    }
+    return count;
+  }
+
+  void ReadRanges(vector<Module::Range>* ranges) {
+    uint64_t count = ReadCount(16);
+    for (uint64_t i = 0; i < count; i++) {
+      Module::Address address = ReadNumber();
+      ranges->push_back(Module::Range(address, ReadNumber()));
+    }
+  }
+
+  bool ok() const { return ok_; }
+
+ private:
+  bool Read(void* data, size_t length) {
+    if (ok_ && length > remaining_)
+      ok_ = false;
+    if (ok_ && length && fread(data, length, 1, file_) != 1)
+      ok_ = false;
+    if (ok_)
+      remaining_ -= length;
+    return ok_;
+  }
+
+  FILE* file_;
+  bool ok_;
+
+  // The number of bytes left in the file.
+  uint64_t remaining_;
+};
+
+// Write INLINES and their children to WRITER, referring to files and
+// origins by their indices in FILES and ORIGINS.
+void WriteInlines(const vector<std::unique_ptr<Module::Inline>>& inlines,
+                  const std::map<Module::File*, uint64_t>& files,
+                  const std::map<Module::InlineOrigin*, uint64_t>& origins,
+                  EntryWriter* writer) {
+  writer->WriteNumber(inlines.size());
+  for (const std::unique_ptr<Module::Inline>& in : inlines) {
+    writer->WriteNumber(origins.find(in->origin)->second);
+    writer->WriteRanges(in->ranges);
+    writer->WriteNumber(in->call_site_line);
+    writer->WriteNumber(in->call_site_file_id);
+    writer->WriteNumber(in->call_site_file ?
+                        files.find(in->call_site_file)->second : kNoFile);
+    writer->WriteNumber(in->inline_nest_level);
+    WriteInlines(in->child_inlines, files, origins, writer);
+  }
+}
+
+// Read inlines written by WriteInlines from READER into INLINES.
+void ReadInlines(const vector<Module::File*>& files,
+                 const vector<Module::InlineOrigin*>& origins,
+                 EntryReader* reader,
+                 vector<std::unique_ptr<Module::Inline>>* inlines) {
+  uint64_t count = reader->ReadCount(56);
+  for (uint64_t i = 0; i < count && reader->ok(); i++) {
+    uint64_t origin = reader->ReadNumber();
+    vector<Module::Range> ranges;
+    reader->ReadRanges(&ranges);
+    int call_site_line = static_cast<int>(reader->ReadNumber());
+    int call_site_file_id = static_cast<int>(reader->ReadNumber());
+    uint64_t call_site_file = reader->ReadNumber();
+    int inline_nest_level = static_cast<int>(reader->ReadNumber());
+    vector<std::unique_ptr<Module::Inline>> child_inlines;
+    ReadInlines(files, origins, reader, &child_inlines);
+    if (origin >= origins.size() ||
+        (call_site_file != kNoFile && call_site_file >= files.size())) {
+      return;
+    }
+    std::unique_ptr<Module::Inline> in(new Module::Inline(
+        origins[origin], ranges, call_site_line, call_site_file_id,
+        inline_nest_level, std::move(child_inlines)));
+    if (call_site_file != kNoFile)
+      in->call_site_file = files[call_site_file];
+    inlines->push_back(std::move(in));
+  }
+}
+
+}  // namespace
+
+bool DwarfCUCache::ComputeKey(const SectionMap& sections, uint64_t offset,
+                              ByteReader* reader,
+                              CompilationUnit::AbbrevCache* abbrev_cache,
+                              const string& conversion, string* key) {
+  KeyHandler handler;
+  handler.AddString(kEntryVersion);
+  handler.AddString(conversion);
+  CompilationUnit unit("", sections, offset, reader, &handler);
+  unit.SetAbbrevCache(abbrev_cache);
+  if (unit.Start() == 0 || handler.split())
+    return false;
+  handler.AddLinesAndRanges(sections, reader);
+
+  unsigned char digest[16];
+  handler.Finish(digest);
+  key->clear();
+  for (size_t i = 0; i < sizeof(digest); i++) {
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02x", digest[i]);
+    key->append(hex);
+  }
+  return true;
+}
+
+bool DwarfCUCache::Load(const string& key, uint64_t unit_offset,
+                        Module* module) const {
+  FILE* file = fopen(Path(key).c_str(), "rb");
+  if (!file)
+    return false;
+  EntryReader reader(file);
+  if (reader.ReadNumber() != kEntryBegin) {
+    fclose(file);
+    return false;
+  }
+
+  vector<Module::File*> files;
+  uint64_t file_count = reader.ReadCount(8);
+  for (uint64_t i = 0; i < file_count && reader.ok(); i++)
+    files.push_back(module->FindFile(reader.ReadString()));
+
+  vector<Module::InlineOrigin*> origins;
+  uint64_t origin_count = reader.ReadCount(8);
+  for (uint64_t i = 0; i < origin_count && reader.ok(); i++) {
+    StringView name = module->AddStringToPool(reader.ReadString());
+    module->inline_origin_map.SetReference(unit_offset + i, unit_offset + i);
+    origins.push_back(module->inline_origin_map.GetOrCreateInlineOrigin(
+        unit_offset + i, name));
+  }
+
+  uint64_t function_count = reader.ReadCount(48);
+  for (uint64_t i = 0; i < function_count && reader.ok(); i++) {
+    StringView name = module->AddStringToPool(reader.ReadString());
+    Module::Address address = reader.ReadNumber();
+    std::unique_ptr<Module::Function> function(
+        new Module::Function(name, address));
+    function->parameter_size = reader.ReadNumber();
+    reader.ReadRanges(&function->ranges);
+    uint64_t line_count = reader.ReadCount(32);
+    for (uint64_t j = 0; j < line_count && reader.ok(); j++) {
+      Module::Line line;
+      line.address = reader.ReadNumber();
+      line.size = reader.ReadNumber();
+      uint64_t line_file = reader.ReadNumber();
+      line.number = static_cast<int>(reader.ReadNumber());
+      if (line_file != kNoFile && line_file >= files.size()) {
+        fclose(file);
+        return false;
+      }
+      line.file = line_file == kNoFile ? NULL : files[line_file];
+      function->lines.push_back(line);
+    }
+    ReadInlines(files, origins, &reader, &function->inlines);
+    if (reader.ok() && !function->name.empty() &&
+        module->AddFunction(function.get())) {
+      function.release();
+    }
+  }
+
+  bool ok = reader.ReadNumber() == kEntryEnd && reader.ok();
+  fclose(file);
+  return ok;
+}
+
+bool DwarfCUCache::Save(const string& key, Module* module) const {
+  vector<Module::Function*> functions;
+  module->GetFunctions(&functions, functions.end());
+
+  // Number the files and origins the functions use.
+  std::map<Module::File*, uint64_t> files;
+  vector<Module::File*> file_list;
+  std::map<Module::InlineOrigin*, uint64_t> origins;
+  vector<Module::InlineOrigin*> origin_list;
+  auto note_file = [&](Module::File* file) {
+    if (file && files.insert(std::make_pair(file, file_list.size())).second)
+      file_list.push_back(file);
+  };
+  for (Module::Function* function : functions) {
+    for (const Module::Line& line : function->lines)
+      note_file(line.file);
+    Module::Inline::InlineDFS(
+        function->inlines, [&](std::unique_ptr<Module::Inline>& in) {
+          note_file(in->call_site_file);
+          if (origins.insert(
+                  std::make_pair(in->origin, origin_list.size())).second) {
+            origin_list.push_back(in->origin);
+          }
+        });
+  }
+
+  // Write the entry to a file of its own, and move that into place once
+  // it's complete, so that no process reads a partial entry.
+  string temporary = Path(key) + ".XXXXXX";
+  int fd = mkstemp(&temporary[0]);
+  if (fd < 0)
+    return false;
+  FILE* file = fdopen(fd, "wb");
+  if (!file) {
+    close(fd);
+    unlink(temporary.c_str());
+    return false;
+  }
+  EntryWriter writer(file);
+  writer.WriteNumber(kEntryBegin);
+  writer.WriteNumber(file_list.size());
+  for (Module::File* file : file_list)
+    writer.WriteString(file->name);
+  writer.WriteNumber(origin_list.size());
+  for (Module::InlineOrigin* origin : origin_list)
+    writer.WriteString(origin->name);
+  writer.WriteNumber(functions.size());
+  for (Module::Function* function : functions) {
+    writer.WriteString(function->name);
+    writer.WriteNumber(function->address);
+    writer.WriteNumber(function->parameter_size);
+    writer.WriteRanges(function->ranges);
+    writer.WriteNumber(function->lines.size());
+    for (const Module::Line& line : function->lines) {
+      writer.WriteNumber(line.address);
+      writer.WriteNumber(line.size);
+      writer.WriteNumber(line.file ? files.find(line.file)->second : kNoFile);
+      writer.WriteNumber(line.number);
+    }
+    WriteInlines(function->inlines, files, origins, &writer);
+  }
+  writer.WriteNumber(kEntryEnd);
+  bool ok = fclose(file) == 0 && writer.ok();
+  if (!ok || rename(temporary.c_str(), Path(key).c_str()) != 0) {
+    unlink(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
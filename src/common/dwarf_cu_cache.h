@@ -0,0 +1,93 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dwarf_cu_cache.h: Define DwarfCUCache, a directory of the functions
+// converted from DWARF compilation units, each stored under a hash of
+// everything its conversion reads, so that a unit that hasn't changed
+// since an earlier dump needn't be converted again.
+
+#ifndef COMMON_DWARF_CU_CACHE_H__
+#define COMMON_DWARF_CU_CACHE_H__
+
+#include <stdint.h>
+
+#include <string>
+
+#include "common/module.h"
+#include "common/dwarf/bytereader.h"
+#include "common/dwarf/dwarf2reader.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class DwarfCUCache {
+ public:
+  // Create a cache that keeps its entries in DIRECTORY, which must
+  // exist.  Several processes may share a directory.
+  explicit DwarfCUCache(const string& directory) : directory_(directory) {}
+
+  // Set *KEY to the key of the compilation unit at OFFSET in the
+  // .debug_info section in SECTIONS, using READER to read it, and looking
+  // its abbreviation table up in ABBREV_CACHE, if that isn't NULL.  The
+  // key covers the unit's DIEs, with their strings and addresses
+  // resolved and their references relative to the unit, the lines of its
+  // line number program, the ranges its DIEs refer to, and CONVERSION, a
+  // string describing how the unit is converted.  Since addresses are
+  // covered, a unit whose code has moved gets a new key.  Return false if
+  // the unit can't be cached: if it refers to split DWARF, or can't be
+  // read.
+  static bool ComputeKey(const SectionMap& sections, uint64_t offset,
+                         ByteReader* reader,
+                         CompilationUnit::AbbrevCache* abbrev_cache,
+                         const string& conversion, string* key);
+
+  // Add the functions stored under KEY to MODULE, which should be a new
+  // module of its own, together with their lines, inlines, and the files
+  // and inline origins those use.  The origins are given offsets from
+  // UNIT_OFFSET on, so the unit's should be at UNIT_OFFSET in .debug_info
+  // to keep them apart from other units' origins.  Return false if
+  // nothing is stored under KEY or it can't be read, in which case
+  // MODULE may hold part of it and should be discarded.
+  bool Load(const string& key, uint64_t unit_offset, Module* module) const;
+
+  // Store the functions in MODULE, which must hold those of one
+  // compilation unit and nothing else, under KEY.  Return false if the
+  // entry can't be written.
+  bool Save(const string& key, Module* module) const;
+
+ private:
+  // The path of KEY's entry.
+  string Path(const string& key) const { return directory_ + "/" + key; }
+
+  const string directory_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_DWARF_CU_CACHE_H__
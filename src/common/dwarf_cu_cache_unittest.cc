@@ -0,0 +1,275 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dwarf_cu_cache_unittest.cc: Unit tests for google_breakpad::DwarfCUCache.
+
+#include <stdio.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/dwarf_cu_cache.h"
+#include "common/module.h"
+#include "common/dwarf/bytereader.h"
+#include "common/dwarf/dwarf2reader_test_common.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::ByteReader;
+using google_breakpad::DwarfCUCache;
+using google_breakpad::ENDIANNESS_LITTLE;
+using google_breakpad::Module;
+using google_breakpad::SectionMap;
+using google_breakpad::test_assembler::Label;
+using google_breakpad::test_assembler::Section;
+using google_breakpad::test_assembler::kLittleEndian;
+using std::vector;
+
+namespace {
+
+// Add a function with lines and nested inlines to MODULE.
+void AddFunctions(Module* module) {
+  Module::File* file1 = module->FindFile("file1.cc");
+  Module::File* file2 = module->FindFile("file2.h");
+  module->inline_origin_map.SetReference(0x10, 0x10);
+  Module::InlineOrigin* origin1 =
+      module->inline_origin_map.GetOrCreateInlineOrigin(
+          0x10, module->AddStringToPool("inlined1"));
+  module->inline_origin_map.SetReference(0x20, 0x20);
+  Module::InlineOrigin* origin2 =
+      module->inline_origin_map.GetOrCreateInlineOrigin(
+          0x20, module->AddStringToPool("inlined2"));
+
+  Module::Function* function = new Module::Function(
+      module->AddStringToPool("function1"), 0x1000);
+  function->ranges.push_back(Module::Range(0x1000, 0x100));
+  function->parameter_size = 8;
+  Module::Line line1 = { 0x1000, 0x80, file1, 10 };
+  Module::Line line2 = { 0x1080, 0x80, file2, 20 };
+  function->lines.push_back(line1);
+  function->lines.push_back(line2);
+  vector<std::unique_ptr<Module::Inline>> children;
+  children.emplace_back(new Module::Inline(
+      origin2, vector<Module::Range>(1, Module::Range(0x1090, 0x10)), 30, 2,
+      1, vector<std::unique_ptr<Module::Inline>>()));
+  children[0]->call_site_file = file2;
+  function->inlines.emplace_back(new Module::Inline(
+      origin1, vector<Module::Range>(1, Module::Range(0x1080, 0x40)), 11, 1,
+      0, std::move(children)));
+  function->inlines[0]->call_site_file = file1;
+  module->AddFunction(function);
+
+  function = new Module::Function(module->AddStringToPool("function2"),
+                                  0x2000);
+  function->ranges.push_back(Module::Range(0x2000, 0x10));
+  module->AddFunction(function);
+}
+
+// Return MODULE's symbol file, with inlines.
+string SymbolFile(Module* module) {
+  std::stringstream s;
+  EXPECT_TRUE(module->Write(s, ALL_SYMBOL_DATA));
+  return s.str();
+}
+
+}  // namespace
+
+TEST(DwarfCUCache, SaveAndLoad) {
+  AutoTempDir temp_dir;
+  DwarfCUCache cache(temp_dir.path());
+  Module saved("name", "os", "arch", "id");
+  AddFunctions(&saved);
+  ASSERT_TRUE(cache.Save("key", &saved));
+
+  Module loaded("name", "os", "arch", "id");
+  ASSERT_TRUE(cache.Load("key", 0x1000, &loaded));
+  EXPECT_EQ(SymbolFile(&saved), SymbolFile(&loaded));
+
+  Module missing("name", "os", "arch", "id");
+  EXPECT_FALSE(cache.Load("other-key", 0x1000, &missing));
+}
+
+TEST(DwarfCUCache, TruncatedEntry) {
+  AutoTempDir temp_dir;
+  DwarfCUCache cache(temp_dir.path());
+  Module saved("name", "os", "arch", "id");
+  AddFunctions(&saved);
+  ASSERT_TRUE(cache.Save("key", &saved));
+
+  string path = temp_dir.path() + "/key";
+  FILE* file = fopen(path.c_str(), "rb");
+  ASSERT_TRUE(file);
+  string contents(4096, '\0');
+  contents.resize(fread(&contents[0], 1, contents.size(), file));
+  fclose(file);
+  ASSERT_GT(contents.size(), 16U);
+
+  // Every proper prefix of the entry is rejected.
+  for (size_t length = 0; length < contents.size(); length += 7) {
+    file = fopen(path.c_str(), "wb");
+    ASSERT_TRUE(file);
+    fwrite(contents.data(), 1, length, file);
+    fclose(file);
+    Module loaded("name", "os", "arch", "id");
+    EXPECT_FALSE(cache.Load("key", 0x1000, &loaded)) << length;
+  }
+}
+
+class ComputeKey : public testing::Test {
+ public:
+  ComputeKey() : byte_reader(ENDIANNESS_LITTLE) {
+    info.set_endianness(kLittleEndian);
+    strings.set_endianness(kLittleEndian);
+    abbrevs.set_endianness(kLittleEndian);
+    abbrevs.Abbrev(1, google_breakpad::DW_TAG_compile_unit,
+                   google_breakpad::DW_children_yes)
+        .Attribute(google_breakpad::DW_AT_name, google_breakpad::DW_FORM_strp)
+        .EndAbbrev()
+        .Abbrev(2, google_breakpad::DW_TAG_subprogram,
+                google_breakpad::DW_children_no)
+        .Attribute(google_breakpad::DW_AT_name,
+                   google_breakpad::DW_FORM_string)
+        .Attribute(google_breakpad::DW_AT_low_pc,
+                   google_breakpad::DW_FORM_addr)
+        .EndAbbrev()
+        .Abbrev(3, google_breakpad::DW_TAG_compile_unit,
+                google_breakpad::DW_children_no)
+        .Attribute(google_breakpad::DW_AT_dwo_name,
+                   google_breakpad::DW_FORM_string)
+        .EndAbbrev()
+        .EndTable();
+  }
+
+  // Append a compilation unit naming itself with the string at offset 0,
+  // with a function at ADDRESS, and return its offset.
+  uint64_t AddUnit(uint64_t address) {
+    uint64_t offset = info.Size();
+    TestCompilationUnit unit;
+    unit.set_format_size(4);
+    unit.set_endianness(kLittleEndian);
+    unit.Header(4, Label(0), 8, google_breakpad::DW_UT_compile)
+        .ULEB128(1).D32(0)
+        .ULEB128(2).AppendCString("function").D64(address)
+        .D8(0);
+    unit.Finish();
+    string contents;
+    EXPECT_TRUE(unit.GetContents(&contents));
+    info.Append(contents);
+    return offset;
+  }
+
+  // Append a skeleton unit referring to split DWARF, and return its
+  // offset.
+  uint64_t AddSkeletonUnit() {
+    uint64_t offset = info.Size();
+    TestCompilationUnit unit;
+    unit.set_format_size(4);
+    unit.set_endianness(kLittleEndian);
+    unit.Header(4, Label(0), 8, google_breakpad::DW_UT_compile)
+        .ULEB128(3).AppendCString("unit.dwo");
+    unit.Finish();
+    string contents;
+    EXPECT_TRUE(unit.GetContents(&contents));
+    info.Append(contents);
+    return offset;
+  }
+
+  // Return the key of the unit at OFFSET.  Sections appended to since
+  // the last call are read anew; GetContents leaves them empty.
+  string Key(uint64_t offset, const string& conversion = "") {
+    if (info.Size())
+      EXPECT_TRUE(info.GetContents(&info_contents));
+    if (abbrevs.Size())
+      EXPECT_TRUE(abbrevs.GetContents(&abbrevs_contents));
+    if (strings.Size())
+      EXPECT_TRUE(strings.GetContents(&strings_contents));
+    SectionMap sections;
+    sections[".debug_info"] = std::make_pair(
+        reinterpret_cast<const uint8_t*>(info_contents.data()),
+        info_contents.size());
+    sections[".debug_abbrev"] = std::make_pair(
+        reinterpret_cast<const uint8_t*>(abbrevs_contents.data()),
+        abbrevs_contents.size());
+    sections[".debug_str"] = std::make_pair(
+        reinterpret_cast<const uint8_t*>(strings_contents.data()),
+        strings_contents.size());
+    string key;
+    if (!DwarfCUCache::ComputeKey(sections, offset, &byte_reader, NULL,
+                                  conversion, &key)) {
+      return "none";
+    }
+    return key;
+  }
+
+  Section info, strings;
+  TestAbbrevTable abbrevs;
+  string info_contents, abbrevs_contents, strings_contents;
+  ByteReader byte_reader;
+};
+
+TEST_F(ComputeKey, SameUnitSameKey) {
+  strings.AppendCString("unit");
+  uint64_t first = AddUnit(0x1000);
+  uint64_t second = AddUnit(0x1000);
+  string key = Key(first);
+  EXPECT_EQ(32U, key.size());
+  // A unit's place in .debug_info doesn't matter.
+  EXPECT_EQ(key, Key(second));
+}
+
+TEST_F(ComputeKey, DifferentAddress) {
+  strings.AppendCString("unit");
+  uint64_t first = AddUnit(0x1000);
+  uint64_t second = AddUnit(0x2000);
+  EXPECT_NE(Key(first), Key(second));
+}
+
+TEST_F(ComputeKey, DifferentString) {
+  // The unit's bytes are the same, but the string they refer to isn't.
+  strings.AppendCString("unit");
+  uint64_t offset = AddUnit(0x1000);
+  string key = Key(offset);
+  strings = Section(kLittleEndian);
+  strings.AppendCString("tinu");
+  EXPECT_NE(key, Key(offset));
+}
+
+TEST_F(ComputeKey, DifferentConversion) {
+  strings.AppendCString("unit");
+  uint64_t offset = AddUnit(0x1000);
+  EXPECT_NE(Key(offset, "i"), Key(offset, ""));
+}
+
+TEST_F(ComputeKey, SplitDwarf) {
+  uint64_t offset = AddSkeletonUnit();
+  EXPECT_EQ("none", Key(offset));
+}
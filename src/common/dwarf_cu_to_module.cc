@@ -44,9 +44,12 @@
 #include <stdio.h>
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <numeric>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/string_view.h"
 #include "common/dwarf_line_to_module.h"
@@ -90,6 +93,183 @@ struct DwarfCUToModule::Specification {
   StringView unqualified_name;
 };
 
+// The Specifications gathered from a file's declaration DIEs.  With
+// inter-CU references handled, a table holds those of every compilation
+// unit in the file, and for large files there are hundreds of millions
+// of them, so rather than a map from offsets to Specifications, this is a
+// vector of entries sorted by offset, each holding just the offset and
+// indices into a table of the distinct names the entries use.  Most
+// entries share their enclosing names with many others.  Find may be
+// called from several threads at once, as long as none is changing the
+// table.
+class DwarfCUToModule::SpecificationTable {
+ public:
+  // If there is a Specification for the DIE at OFFSET, set *SPEC to it and
+  // return true.  Otherwise, return false.
+  bool Find(uint64_t offset, Specification* spec) const;
+
+  // Make SPEC the Specification for the DIE at OFFSET.  This is cheapest
+  // when OFFSET follows every offset already in the table, as it does
+  // when compilation units are read in order.
+  void Set(uint64_t offset, const Specification& spec);
+
+  // Add the Specifications in OTHER for DIEs that have none here.  This
+  // is cheapest when OTHER's offsets all follow those in this table.
+  void AddFrom(const SpecificationTable& other);
+
+  // Remove all the Specifications.
+  void Clear();
+
+ private:
+  // The value of Entry::unqualified_name for an entry whose name is the
+  // qualified name.
+  static const uint32_t kQualified = UINT32_MAX;
+
+  struct Entry {
+    // The offset of the declaration DIE.
+    uint64_t offset;
+
+    // The index in names_ of the qualified name if unqualified_name is
+    // kQualified, or of the enclosing name otherwise.
+    uint32_t name;
+
+    // The index in names_ of the unqualified name, or kQualified.
+    uint32_t unqualified_name;
+
+    bool operator<(uint64_t other_offset) const {
+      return offset < other_offset;
+    }
+  };
+
+  // Names are mostly StringViews of the Module's string pool or of the
+  // string section, which hold each distinct name once, so names are told
+  // apart by where they are rather than by what they say.  A name held in
+  // two places may be interned twice, which costs a little space but no
+  // hashing of long qualified names.
+  struct NameHash {
+    size_t operator()(StringView name) const {
+      return std::hash<const char*>()(name.data()) ^ name.size();
+    }
+  };
+  struct SameName {
+    bool operator()(StringView a, StringView b) const {
+      return a.data() == b.data() && a.size() == b.size();
+    }
+  };
+
+  // Return the index of NAME in names_, adding it if it isn't there.
+  uint32_t Intern(StringView name);
+
+  // Return the entry recording SPEC for the DIE at OFFSET.
+  Entry MakeEntry(uint64_t offset, const Specification& spec);
+
+  vector<Entry> entries_;
+  vector<StringView> names_;
+  std::unordered_map<StringView, uint32_t, NameHash, SameName>
+      name_indices_;
+};
+
+bool DwarfCUToModule::SpecificationTable::Find(uint64_t offset,
+                                               Specification* spec) const {
+  vector<Entry>::const_iterator entry =
+      std::lower_bound(entries_.begin(), entries_.end(), offset);
+  if (entry == entries_.end() || entry->offset != offset)
+    return false;
+  if (entry->unqualified_name == kQualified) {
+    spec->qualified_name = names_[entry->name];
+    spec->enclosing_name = StringView();
+    spec->unqualified_name = StringView();
+  } else {
+    spec->qualified_name = StringView();
+    spec->enclosing_name = names_[entry->name];
+    spec->unqualified_name = names_[entry->unqualified_name];
+  }
+  return true;
+}
+
+void DwarfCUToModule::SpecificationTable::Set(uint64_t offset,
+                                              const Specification& spec) {
+  Entry new_entry = MakeEntry(offset, spec);
+  if (entries_.empty() || entries_.back().offset < offset) {
+    entries_.push_back(new_entry);
+    return;
+  }
+  vector<Entry>::iterator entry =
+      std::lower_bound(entries_.begin(), entries_.end(), offset);
+  if (entry->offset == offset)
+    *entry = new_entry;
+  else
+    entries_.insert(entry, new_entry);
+}
+
+void DwarfCUToModule::SpecificationTable::AddFrom(
+    const SpecificationTable& other) {
+  if (other.entries_.empty())
+    return;
+  vector<uint32_t> indices(other.names_.size());
+  for (size_t i = 0; i < other.names_.size(); ++i)
+    indices[i] = Intern(other.names_[i]);
+  auto translate = [&](Entry entry) {
+    entry.name = indices[entry.name];
+    if (entry.unqualified_name != kQualified)
+      entry.unqualified_name = indices[entry.unqualified_name];
+    return entry;
+  };
+
+  if (entries_.empty() ||
+      entries_.back().offset < other.entries_.front().offset) {
+    entries_.reserve(entries_.size() + other.entries_.size());
+    for (const Entry& entry : other.entries_)
+      entries_.push_back(translate(entry));
+    return;
+  }
+
+  vector<Entry> merged;
+  merged.reserve(entries_.size() + other.entries_.size());
+  vector<Entry>::const_iterator ours = entries_.begin();
+  vector<Entry>::const_iterator theirs = other.entries_.begin();
+  while (ours != entries_.end() || theirs != other.entries_.end()) {
+    if (theirs == other.entries_.end() ||
+        (ours != entries_.end() && ours->offset <= theirs->offset)) {
+      if (theirs != other.entries_.end() && ours->offset == theirs->offset)
+        ++theirs;
+      merged.push_back(*ours++);
+    } else {
+      merged.push_back(translate(*theirs++));
+    }
+  }
+  entries_.swap(merged);
+}
+
+void DwarfCUToModule::SpecificationTable::Clear() {
+  entries_.clear();
+  names_.clear();
+  name_indices_.clear();
+}
+
+uint32_t DwarfCUToModule::SpecificationTable::Intern(StringView name) {
+  auto inserted = name_indices_.insert(
+      std::make_pair(name, static_cast<uint32_t>(names_.size())));
+  if (inserted.second)
+    names_.push_back(name);
+  return inserted.first->second;
+}
+
+DwarfCUToModule::SpecificationTable::Entry
+DwarfCUToModule::SpecificationTable::MakeEntry(uint64_t offset,
+                                               const Specification& spec) {
+  Entry entry;
+  entry.offset = offset;
+  if (!spec.qualified_name.empty()) {
+    entry.name = Intern(spec.qualified_name);
+    entry.unqualified_name = kQualified;
+  } else {
+    entry.name = Intern(spec.enclosing_name);
+    entry.unqualified_name = Intern(spec.unqualified_name);
+  }
+  return entry;
+}
+
 // An abstract origin -- base definition of an inline function.
 struct AbstractOrigin {
   explicit AbstractOrigin(StringView name) : name(name) {}
@@ -105,7 +285,7 @@ struct DwarfCUToModule::FilePrivate {
   // A map from offsets of DIEs within the .debug_info section to
   // Specifications describing those DIEs. Specification references can
   // cross compilation unit boundaries.
-  SpecificationByOffset specifications;
+  SpecificationTable specifications;
 
   AbstractOriginByOffset origins;
 
@@ -114,12 +294,43 @@ struct DwarfCUToModule::FilePrivate {
   std::map<uint64_t, Module::Function*> forward_ref_die_to_func;
 };
 
+bool DwarfCUToModule::DemangleCache::Find(const Language* language,
+                                          const string& mangled,
+                                          Language::DemangleResult* result,
+                                          string* demangled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<const Language*, NameMap>::const_iterator names =
+      names_.find(language);
+  if (names == names_.end())
+    return false;
+  NameMap::const_iterator iter = names->second.find(mangled);
+  if (iter == names->second.end())
+    return false;
+  *result = iter->second.first;
+  demangled->assign(iter->second.second);
+  return true;
+}
+
+void DwarfCUToModule::DemangleCache::Add(const Language* language,
+                                         const string& mangled,
+                                         Language::DemangleResult result,
+                                         const string& demangled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  names_[language].insert(
+      std::make_pair(mangled, std::make_pair(result, demangled)));
+}
+
 DwarfCUToModule::FileContext::FileContext(const string& filename,
                                           Module* module,
                                           bool handle_inter_cu_refs)
     : filename_(filename),
       module_(module),
       handle_inter_cu_refs_(handle_inter_cu_refs),
+      track_outside_references_(false),
+      tracked_begin_(0),
+      tracked_end_(0),
+      has_outside_references_(false),
+      demangle_cache_(NULL),
       file_private_(new FilePrivate()) {
 }
 
@@ -140,9 +351,24 @@ DwarfCUToModule::FileContext::section_map() const {
   return section_map_;
 }
 
+void DwarfCUToModule::FileContext::TrackOutsideReferences(uint64_t begin,
+                                                          uint64_t end) {
+  track_outside_references_ = true;
+  tracked_begin_ = begin;
+  tracked_end_ = end;
+  has_outside_references_ = false;
+}
+
+void DwarfCUToModule::FileContext::AddFileDataFrom(const FileContext& other) {
+  if (handle_inter_cu_refs_)
+    file_private_->specifications.AddFrom(other.file_private_->specifications);
+  file_private_->origins.insert(other.file_private_->origins.begin(),
+                                other.file_private_->origins.end());
+}
+
 void DwarfCUToModule::FileContext::ClearSpecifications() {
   if (!handle_inter_cu_refs_)
-    file_private_->specifications.clear();
+    file_private_->specifications.Clear();
 }
 
 bool DwarfCUToModule::FileContext::IsUnhandledInterCUReference(
@@ -285,7 +511,7 @@ class DwarfCUToModule::GenericDIEHandler: public DIEHandler {
         parent_context_(parent_context),
         offset_(offset),
         declaration_(false),
-        specification_(NULL),
+        has_specification_(false),
         abstract_origin_(NULL),
         forward_ref_die_offset_(0), specification_offset_(0) { }
 
@@ -326,10 +552,11 @@ class DwarfCUToModule::GenericDIEHandler: public DIEHandler {
   // It is false on DIEs with no DW_AT_declaration attribute.
   bool declaration_;
 
-  // If this DIE has a DW_AT_specification attribute, this is the
-  // Specification structure for the DIE the attribute refers to.
-  // Otherwise, this is NULL.
-  Specification* specification_;
+  // True if this DIE has a DW_AT_specification attribute referring to a
+  // DIE whose Specification we have, in which case specification_ is a
+  // copy of it.
+  bool has_specification_;
+  Specification specification_;
 
   // If this DIE has a DW_AT_abstract_origin attribute, this is the
   // AbstractOrigin structure for the DIE the attribute refers to.
@@ -380,16 +607,15 @@ void DwarfCUToModule::GenericDIEHandler::ProcessAttributeReference(
         cu_context_->reporter->UnhandledInterCUReference(offset_, data);
         break;
       }
+      file_context->NoteReference(data);
       // Find the Specification to which this attribute refers, and
       // set specification_ appropriately. We could do more processing
       // here, but it's better to leave the real work to our
       // EndAttribute member function, at which point we know we have
       // seen all the DIE's attributes.
-      SpecificationByOffset* specifications =
-          &file_context->file_private_->specifications;
-      SpecificationByOffset::iterator spec = specifications->find(data);
-      if (spec != specifications->end()) {
-        specification_ = &spec->second;
+      if (file_context->file_private_->specifications.Find(
+              data, &specification_)) {
+        has_specification_ = true;
       } else if (data > offset_) {
         forward_ref_die_offset_ = data;
       } else {
@@ -399,6 +625,7 @@ void DwarfCUToModule::GenericDIEHandler::ProcessAttributeReference(
       break;
     }
     case DW_AT_abstract_origin: {
+      cu_context_->file_context->NoteReference(data);
       const AbstractOriginByOffset& origins =
           cu_context_->file_context->file_private_->origins;
       AbstractOriginByOffset::const_iterator origin = origins.find(data);
@@ -426,8 +653,14 @@ void DwarfCUToModule::GenericDIEHandler::ProcessAttributeString(
     case DW_AT_MIPS_linkage_name:
     case DW_AT_linkage_name: {
       string demangled;
-      Language::DemangleResult result =
-          cu_context_->language->DemangleName(data, &demangled);
+      Language::DemangleResult result;
+      DemangleCache* cache = cu_context_->file_context->demangle_cache_;
+      if (!cache ||
+          !cache->Find(cu_context_->language, data, &result, &demangled)) {
+        result = cu_context_->language->DemangleName(data, &demangled);
+        if (cache)
+          cache->Add(cu_context_->language, data, result, demangled);
+      }
       switch (result) {
         case Language::kDemangleSuccess:
           demangled_name_ =
@@ -456,9 +689,10 @@ StringView DwarfCUToModule::GenericDIEHandler::ComputeQualifiedName() {
   if (!demangled_name_.empty()) {
     // Found it is this DIE.
     qualified_name = &demangled_name_;
-  } else if (specification_ && !specification_->qualified_name.empty()) {
+  } else if (has_specification_ &&
+             !specification_.qualified_name.empty()) {
     // Found it on the specification.
-    qualified_name = &specification_->qualified_name;
+    qualified_name = &specification_.qualified_name;
   }
 
   StringView* unqualified_name = nullptr;
@@ -468,8 +702,8 @@ StringView DwarfCUToModule::GenericDIEHandler::ComputeQualifiedName() {
     // attribute, then use that; otherwise, check the specification.
     if (!name_attribute_.empty()) {
       unqualified_name = &name_attribute_;
-    } else if (specification_) {
-      unqualified_name = &specification_->unqualified_name;
+    } else if (has_specification_) {
+      unqualified_name = &specification_.unqualified_name;
     } else if (!raw_name_.empty()) {
       unqualified_name = &raw_name_;
     }
@@ -477,8 +711,8 @@ StringView DwarfCUToModule::GenericDIEHandler::ComputeQualifiedName() {
     // Find the name of the enclosing context. If this DIE has a
     // specification, it's the specification's enclosing context that
     // counts; otherwise, use this DIE's context.
-    if (specification_) {
-      enclosing_name = &specification_->enclosing_name;
+    if (has_specification_) {
+      enclosing_name = &specification_.enclosing_name;
     } else {
       enclosing_name = &parent_context_->name;
     }
@@ -507,7 +741,8 @@ StringView DwarfCUToModule::GenericDIEHandler::ComputeQualifiedName() {
       spec.enclosing_name = *enclosing_name;
       spec.unqualified_name = *unqualified_name;
     }
-    cu_context_->file_context->file_private_->specifications[offset_] = spec;
+    cu_context_->file_context->file_private_->specifications.Set(offset_,
+                                                                 spec);
   }
 
   return cu_context_->file_context->module_->AddStringToPool(return_value);
@@ -1080,7 +1315,8 @@ void DwarfCUToModule::ProcessAttributeString(enum DwarfAttribute attr,
       cu_context_->reporter->SetCUName(data);
       break;
     case DW_AT_comp_dir:
-      line_reader_->StartCompilationUnit(data);
+      if (line_reader_)
+        line_reader_->StartCompilationUnit(data);
       break;
     default:
       break;
@@ -1110,6 +1346,25 @@ DIEHandler* DwarfCUToModule::FindChildHandler(
   }
 }
 
+bool DwarfCUToModule::WantsTag(enum DwarfTag tag) {
+  // The tags FindChildHandler and the handlers it creates accept.  Types,
+  // members, parameters, variables and the like, which make up most of a
+  // C++ unit's DIEs, can all be stepped over.
+  switch (tag) {
+    case DW_TAG_subprogram:
+    case DW_TAG_namespace:
+    case DW_TAG_class_type:
+    case DW_TAG_structure_type:
+    case DW_TAG_union_type:
+    case DW_TAG_module:
+      return true;
+    case DW_TAG_inlined_subroutine:
+      return handle_inline;
+    default:
+      return false;
+  }
+}
+
 void DwarfCUToModule::SetLanguage(DwarfLanguage language) {
   switch (language) {
     case DW_LANG_Java:
@@ -1468,7 +1723,7 @@ void DwarfCUToModule::Finish() {
     return;
 
   // Read source line info, if we have any.
-  if (has_source_line_info_)
+  if (has_source_line_info_ && line_reader_)
     ReadSourceLines(source_line_offset_);
 
   vector<Module::Function*>* functions = &cu_context_->functions;
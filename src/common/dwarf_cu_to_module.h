@@ -41,7 +41,11 @@
 
 #include <stdint.h>
 
+#include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "common/language.h"
 #include "common/module.h"
@@ -62,6 +66,32 @@ namespace google_breakpad {
 class DwarfCUToModule: public RootDIEHandler {
   struct FilePrivate;
  public:
+  // A set of demangled linkage names, each demangled once and shared by
+  // all the compilation units that name it.  Compilation units of one
+  // file instantiate the same templates over and over, so they tend to
+  // repeat the same mangled names.  A cache may be shared by compilation
+  // units being read on several threads.
+  class DemangleCache {
+   public:
+    // If MANGLED has been demangled as LANGUAGE's name, set *RESULT and
+    // *DEMANGLED as LANGUAGE::DemangleName did, and return true.
+    // Otherwise, return false.
+    bool Find(const Language* language, const string& mangled,
+              Language::DemangleResult* result, string* demangled);
+
+    // Note that LANGUAGE::DemangleName produced RESULT and DEMANGLED for
+    // MANGLED.
+    void Add(const Language* language, const string& mangled,
+             Language::DemangleResult result, const string& demangled);
+
+   private:
+    typedef std::pair<Language::DemangleResult, string> Demangling;
+    typedef std::unordered_map<string, Demangling> NameMap;
+
+    std::mutex mutex_;
+    std::map<const Language*, NameMap> names_;
+  };
+
   // Information global to the DWARF-bearing file we are processing,
   // for use by DwarfCUToModule. Each DwarfCUToModule instance deals
   // with a single compilation unit within the file, but information
@@ -88,9 +118,40 @@ class DwarfCUToModule: public RootDIEHandler {
 
     const SectionMap& section_map() const;
 
+    // Has the handlers note whether any DIE they read refers to a DIE
+    // outside [BEGIN, END), the range of .debug_info offsets holding the
+    // compilation units read with this context.  Used when a file's
+    // compilation units are read in parts, each with its own context.
+    void TrackOutsideReferences(uint64_t begin, uint64_t end);
+
+    // True if, since TrackOutsideReferences was called, a DIE referred to
+    // one outside the given range.
+    bool HasOutsideReferences() const { return has_outside_references_; }
+
+    // Add the specifications and abstract origins gathered by OTHER, a
+    // context for other compilation units of the same file, to those of
+    // this context, so that references to OTHER's DIEs can be resolved
+    // here.  The names OTHER gathered belong to OTHER's Module, which
+    // must outlive their use through this context.  Specifications are
+    // only shared if this context handles inter-CU references.
+    void AddFileDataFrom(const FileContext& other);
+
+    // Look linkage names up in CACHE before demangling them, and add
+    // those that aren't there yet.  CACHE must outlive this context.
+    void SetDemangleCache(DemangleCache* cache) { demangle_cache_ = cache; }
+
    private:
     friend class DwarfCUToModule;
 
+    // Note a reference to the DIE at OFFSET, if outside references are
+    // being tracked.
+    void NoteReference(uint64_t offset) {
+      if (track_outside_references_ &&
+          (offset < tracked_begin_ || offset >= tracked_end_)) {
+        has_outside_references_ = true;
+      }
+    }
+
     // Clears all the Specifications if HANDLE_INTER_CU_REFS_ is false.
     void ClearSpecifications();
 
@@ -113,6 +174,15 @@ class DwarfCUToModule: public RootDIEHandler {
     // True if we are handling references between compilation units.
     const bool handle_inter_cu_refs_;
 
+    // The range of offsets outside which references are noted, if
+    // track_outside_references_ is set, and whether any were.
+    bool track_outside_references_;
+    uint64_t tracked_begin_, tracked_end_;
+    bool has_outside_references_;
+
+    // The cache of demangled names to consult, or NULL.
+    DemangleCache* demangle_cache_;
+
     // Inter-compilation unit data used internally by the handlers.
     scoped_ptr<FilePrivate> file_private_;
   };
@@ -253,7 +323,8 @@ class DwarfCUToModule: public RootDIEHandler {
   // within FILE_CONTEXT. This uses information received from the
   // CompilationUnit DWARF parser to populate
   // FILE_CONTEXT->module. Use LINE_READER to handle the compilation
-  // unit's line number data. Use REPORTER to report problems with the
+  // unit's line number data, or, if LINE_READER is NULL, read no line
+  // number data at all. Use REPORTER to report problems with the
   // data we find.
   DwarfCUToModule(FileContext* file_context,
                   LineToModuleHandler* line_reader,
@@ -282,6 +353,7 @@ class DwarfCUToModule: public RootDIEHandler {
                             uint8_t offset_size, uint64_t cu_length,
                             uint8_t dwarf_version);
   bool StartRootDIE(uint64_t offset, enum DwarfTag tag);
+  bool WantsTag(enum DwarfTag tag);
 
  private:
   // Used internally by the handler. Full definitions are in
@@ -289,14 +361,12 @@ class DwarfCUToModule: public RootDIEHandler {
   struct CUContext;
   struct DIEContext;
   struct Specification;
+  class SpecificationTable;
   class GenericDIEHandler;
   class FuncHandler;
   class InlineHandler;
   class NamedScopeHandler;
 
-  // A map from section offsets to specifications.
-  typedef map<uint64_t, Specification> SpecificationByOffset;
-
   // Set this compilation unit's source language to LANGUAGE.
   void SetLanguage(DwarfLanguage language);
 
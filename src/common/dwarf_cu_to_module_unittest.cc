@@ -50,6 +50,7 @@ using google_breakpad::DwarfAttribute;
 using google_breakpad::DwarfForm;
 using google_breakpad::DwarfInline;
 using google_breakpad::DwarfCUToModule;
+using google_breakpad::Language;
 using google_breakpad::Module;
 
 using ::testing::_;
@@ -704,6 +705,37 @@ TEST_F(SimpleCU, MangledName) {
   TestFunction(0, "n::f(int)", 0x938cf8c07def4d34ULL, 0x55592d727f6cd01fLL);
 }
 
+TEST_F(SimpleCU, DemangleCache) {
+  PushLine(0x938cf8c07def4d34ULL, 0x1000, "line-file", 246571772);
+  PushLine(0x938cf8c07def5d34ULL, 0x1000, "line-file", 246571773);
+
+  // Names found in the cache aren't demangled again, and names that
+  // aren't are added to it.
+  DwarfCUToModule::DemangleCache cache;
+  cache.Add(Language::CPlusPlus, "_ZN1n1fEi", Language::kDemangleSuccess,
+            "cached::f(int)");
+  file_context_.SetDemangleCache(&cache);
+
+  StartCU();
+  DefineFunction(&root_handler_, "function1",
+                 0x938cf8c07def4d34ULL, 0x1000, "_ZN1n1fEi");
+  DefineFunction(&root_handler_, "function2",
+                 0x938cf8c07def5d34ULL, 0x1000, "_ZN1n1gEv");
+  root_handler_.Finish();
+
+  TestFunctionCount(2);
+  TestFunction(0, "cached::f(int)", 0x938cf8c07def4d34ULL, 0x1000);
+  TestFunction(1, "n::g()", 0x938cf8c07def5d34ULL, 0x1000);
+
+  Language::DemangleResult result;
+  string demangled;
+  EXPECT_TRUE(cache.Find(Language::CPlusPlus, "_ZN1n1gEv", &result,
+                         &demangled));
+  EXPECT_EQ(Language::kDemangleSuccess, result);
+  EXPECT_EQ("n::g()", demangled);
+  EXPECT_FALSE(cache.Find(Language::Rust, "_ZN1n1gEv", &result, &demangled));
+}
+
 TEST_F(SimpleCU, IrrelevantRootChildren) {
   StartCU();
   EXPECT_FALSE(root_handler_
@@ -78,15 +78,15 @@ void DwarfLineToModule::DefineFile(const string& name, int32_t file_num,
   else if (file_num > highest_file_number_)
     highest_file_number_ = file_num;
 
-  string dir_name;
+  const string* dir_name = NULL;
   if (dir_num == 0) {
     // Directory number zero is the compilation directory, and is stored as
     // an attribute on the compilation unit, rather than in the program table.
-    dir_name = compilation_dir_;
+    dir_name = &compilation_dir_;
   } else {
     DirectoryTable::const_iterator directory_it = directories_.find(dir_num);
     if (directory_it != directories_.end()) {
-      dir_name = directory_it->second;
+      dir_name = &directory_it->second;
     } else {
       if (!warned_bad_directory_number_) {
         fprintf(stderr, "warning: DWARF line number data refers to undefined"
@@ -96,11 +96,12 @@ void DwarfLineToModule::DefineFile(const string& name, int32_t file_num,
     }
   }
 
-  string full_name = ExpandPath(name, dir_name);
+  string full_name = dir_name ? ExpandPath(name, *dir_name) : name;
 
   // Find a Module::File object of the given name, and add it to the
   // file table.
   (*files_)[file_num] = module_->FindFile(full_name);
+  last_file_ = NULL;
 }
 
 void DwarfLineToModule::AddLine(uint64_t address, uint64_t length,
@@ -122,7 +123,12 @@ void DwarfLineToModule::AddLine(uint64_t address, uint64_t length,
   }
 
   // Find the source file being referred to.
-  Module::File *file = (*files_)[file_num];
+  Module::File *file = last_file_;
+  if (!file || file_num != last_file_num_) {
+    file = (*files_)[file_num];
+    last_file_num_ = file_num;
+    last_file_ = file;
+  }
   if (!file) {
     if (!warned_bad_file_number_) {
       fprintf(stderr, "warning: DWARF line number data refers to "
@@ -140,4 +146,12 @@ void DwarfLineToModule::AddLine(uint64_t address, uint64_t length,
   lines_->push_back(line);
 }
 
+void DwarfLineToModule::AddLines(const Row* rows, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    DwarfLineToModule::AddLine(rows[i].address, rows[i].length,
+                               rows[i].file_num, rows[i].line_num,
+                               rows[i].column_num);
+  }
+}
+
 } // namespace google_breakpad
@@ -129,6 +129,8 @@ class DwarfLineToModule: public LineInfoHandler {
         lines_(lines),
         files_(files),
         highest_file_number_(-1),
+        last_file_num_(0),
+        last_file_(NULL),
         omitted_line_end_(0),
         warned_bad_file_number_(false),
         warned_bad_directory_number_(false) { }
@@ -141,6 +143,7 @@ class DwarfLineToModule: public LineInfoHandler {
                   uint64_t length);
   void AddLine(uint64_t address, uint64_t length,
                uint32_t file_num, uint32_t line_num, uint32_t column_num);
+  void AddLines(const Row* rows, size_t count);
 
  private:
 
@@ -176,6 +179,12 @@ class DwarfLineToModule: public LineInfoHandler {
   // none.  Used for dynamically defined file numbers.
   int32_t highest_file_number_;
 
+  // The file number of the last line added, and its file, or NULL if
+  // there is none.  Runs of lines usually come from the same file, so
+  // this saves looking most of them up in files_.
+  uint32_t last_file_num_;
+  Module::File* last_file_;
+
   // This is the ending address of the last line we omitted, or zero if we
   // didn't omit the previous line. It is zero before we have received any
   // AddLine calls.
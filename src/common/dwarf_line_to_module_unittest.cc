@@ -125,6 +125,49 @@ TEST(SimpleModule, Many) {
   EXPECT_EQ(0x75047044, lines[4].number);
 }
 
+// Lines added as a batch are the same as lines added one at a time, and
+// refer to the file a number was given most recently.
+TEST(SimpleModule, Batch) {
+  Module m("name", "os", "architecture", "id");
+  vector<Module::Line> lines;
+  std::map<uint32_t, Module::File*> cu_files;
+  DwarfLineToModule h(&m, "/", &lines, &cu_files);
+
+  h.DefineFile("file1", 1, 0, 0, 0);
+  h.DefineFile("file2", 2, 0, 0, 0);
+  const DwarfLineToModule::Row rows[] = {
+    { 0x1000, 0x10, 1, 10, 0 },
+    { 0x1010, 0x08, 1, 11, 0 },
+    { 0x1018, 0x04, 2, 20, 0 },
+    { 0x101c, 0x04, 1, 12, 0 },
+  };
+  h.AddLines(rows, sizeof(rows) / sizeof(rows[0]));
+  h.DefineFile("file3", 1, 0, 0, 0);
+  const DwarfLineToModule::Row more_rows[] = {
+    { 0x1020, 0x04, 1, 30, 0 },
+  };
+  h.AddLines(more_rows, 1);
+
+  Module::File* file1 = m.FindExistingFile("/file1");
+  Module::File* file2 = m.FindExistingFile("/file2");
+  Module::File* file3 = m.FindExistingFile("/file3");
+  ASSERT_TRUE(file1 && file2 && file3);
+  ASSERT_EQ(5U, lines.size());
+  EXPECT_EQ(0x1000U, lines[0].address);
+  EXPECT_EQ(0x10U, lines[0].size);
+  EXPECT_EQ(file1, lines[0].file);
+  EXPECT_EQ(10, lines[0].number);
+  EXPECT_EQ(file1, lines[1].file);
+  EXPECT_EQ(11, lines[1].number);
+  EXPECT_EQ(file2, lines[2].file);
+  EXPECT_EQ(20, lines[2].number);
+  EXPECT_EQ(file1, lines[3].file);
+  EXPECT_EQ(12, lines[3].number);
+  EXPECT_EQ(0x1020U, lines[4].address);
+  EXPECT_EQ(file3, lines[4].file);
+  EXPECT_EQ(30, lines[4].number);
+}
+
 TEST(Filenames, Absolute) {
   Module m("name", "os", "architecture", "id");
   vector<Module::Line> lines;
@@ -0,0 +1,453 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_module_writer.cc: Implement google_breakpad::FastModuleWriter.
+// See fast_module_writer.h for details.
+
+#include "common/fast_module_writer.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "processor/basic_source_line_resolver_types.h"
+#include "processor/contained_range_map-inl.h"
+#include "processor/fast_source_line_resolver_types.h"
+#include "processor/linked_ptr.h"
+#include "processor/map_serializers-inl.h"
+#include "processor/range_map-inl.h"
+#include "processor/simple_serializer-inl.h"
+#include "processor/windows_frame_info.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// BasicSourceLineResolver reads at most this many address ranges of an
+// INLINE record, the rest of its kMaxInlineTokens tokens going to the
+// record's other fields.
+const size_t kMaxInlineRanges = (512 - 4) / 2;
+
+// Return true if BasicSourceLineResolver would read PARAMETER_SIZE, which
+// it parses as a long.
+bool IsValidParameterSize(Module::Address parameter_size) {
+  return parameter_size < static_cast<Module::Address>(LONG_MAX);
+}
+
+// Return true if BasicSourceLineResolver would read LINE, in a module
+// loaded at LOAD_ADDRESS.
+bool IsValidLine(const Module::Line& line, Module::Address load_address) {
+  return line.address - load_address != Module::kMaxAddress &&
+      line.size != Module::kMaxAddress && line.number >= 0 &&
+      line.file->source_id >= 0;
+}
+
+// Call CALLBACK on each of FUNCTION's lines that Module::Write writes after
+// the FUNC record for range RANGE: those following the previous range's
+// that start within the range.
+template<typename Callback>
+void ForEachRangeLine(const Module::Function* function, size_t range,
+                      Callback callback) {
+  vector<Module::Line>::const_iterator line_it = function->lines.begin();
+  for (size_t i = 0; i <= range; ++i) {
+    const Module::Range& r = function->ranges[i];
+    while (line_it != function->lines.end() &&
+           line_it->address >= r.address &&
+           line_it->address < r.address + r.size) {
+      if (i == range)
+        callback(*line_it);
+      ++line_it;
+    }
+  }
+}
+
+}  // namespace
+
+// A rule map is serialized as the string a 'STACK CFI' record holds for it.
+template<>
+class SimpleSerializer<const Module::RuleMap*> {
+ public:
+  static size_t SizeOf(const Module::RuleMap* rule_map) {
+    string rules;
+    Module::AppendRuleMap(*rule_map, &rules);
+    return SimpleSerializer<string>::SizeOf(rules);
+  }
+
+  static char* Write(const Module::RuleMap* rule_map, char* dest) {
+    string rules;
+    Module::AppendRuleMap(*rule_map, &rules);
+    return SimpleSerializer<string>::Write(rules, dest);
+  }
+};
+
+template<>
+class SimpleSerializer<FastModuleWriter::FunctionRange> {
+ public:
+  static size_t SizeOf(const FastModuleWriter::FunctionRange& range) {
+    return range.writer->SizeOfFunction(range);
+  }
+
+  static char* Write(const FastModuleWriter::FunctionRange& range,
+                     char* dest) {
+    return range.writer->WriteFunction(range, dest);
+  }
+};
+
+FastModuleWriter::FastModuleWriter(Module* module)
+    : module_(module), build_search_index_(false), is_corrupt_(false),
+      ok_(true) {}
+
+bool FastModuleWriter::Write(std::ostream& stream, SymbolData symbol_data) {
+  typedef BasicSourceLineResolver::InlineOrigin InlineOrigin;
+  typedef BasicSourceLineResolver::PublicSymbol PublicSymbol;
+  typedef FastSourceLineResolver::Module FastModule;
+  typedef FastSourceLineResolver::Module::SerializedHeader SerializedHeader;
+  const Module::Address load_address = module_->load_address_;
+  const Module::Address kMaxAddress = Module::kMaxAddress;
+  is_corrupt_ = false;
+  ok_ = true;
+
+  // Gather the records BasicSourceLineResolver would store, in the maps it
+  // would store them in.
+  std::map<int, const char*> files;
+  std::map<int, InlineOrigin> inline_origins;
+  vector<string> inline_origin_names;
+  RangeMap<MemAddr, FunctionRange> functions;
+  std::map<MemAddr, PublicSymbol> public_symbols;
+  RangeMap<MemAddr, const Module::RuleMap*> cfi_initial_rules;
+  std::map<MemAddr, const Module::RuleMap*> cfi_delta_rules;
+  inline_origins_.clear();
+  if (symbol_data & SYMBOLS_AND_FILES) {
+    module_->CreateInlineOrigins(inline_origins_);
+    module_->AssignSourceIds(inline_origins_);
+
+    for (const auto& file : module_->files_) {
+      if (file.second->source_id < 0)
+        continue;
+      if (file.second->name.empty())
+        is_corrupt_ = true;
+      else
+        files.emplace(file.second->source_id, file.second->name.c_str());
+    }
+
+    // Names may not be null-terminated where the module keeps them.
+    inline_origin_names.reserve(inline_origins_.size());
+    for (Module::InlineOrigin* origin : inline_origins_) {
+      if (origin->id < 0 || origin->name.empty())
+        continue;
+      inline_origin_names.push_back(origin->name.str());
+      inline_origins.emplace(
+          origin->id,
+          InlineOrigin(false, -1, inline_origin_names.back().c_str()));
+    }
+
+    // Each range of a function becomes a function of its own, storing which
+    // may fail where it overlaps an earlier one.  The lines of a range that
+    // isn't stored are still parsed, so still check them.
+    vector<FunctionRange> unstored;
+    for (Module::Function* function : module_->functions_) {
+      if (function->name.empty() ||
+          !IsValidParameterSize(function->parameter_size)) {
+        is_corrupt_ = true;
+        continue;
+      }
+      for (size_t i = 0; i < function->ranges.size(); ++i) {
+        const Module::Range& range = function->ranges[i];
+        MemAddr address = range.address - load_address;
+        if (address == kMaxAddress || range.size == kMaxAddress) {
+          is_corrupt_ = true;
+          continue;
+        }
+        if (!functions.StoreRange(address, range.size,
+                                  FunctionRange(this, function, i)))
+          unstored.push_back(FunctionRange(this, function, i));
+      }
+    }
+    for (const FunctionRange& function_range : unstored) {
+      if (!RestoreFunction(function_range.function))
+        break;
+      ForEachRangeLine(function_range.function, function_range.range,
+                       [&](const Module::Line& line) {
+        if (!IsValidLine(line, load_address))
+          is_corrupt_ = true;
+      });
+      FreeFunction(function_range.function);
+    }
+
+    // Public symbols at address zero are dropped, as are duplicates.
+    for (Module::Extern* ext : module_->externs_) {
+      MemAddr address = ext->address - load_address;
+      if (address == kMaxAddress ||
+          !IsValidParameterSize(ext->parameter_size) || ext->name.empty()) {
+        is_corrupt_ = true;
+        continue;
+      }
+      if (address == 0)
+        continue;
+      if (!public_symbols.emplace(
+              address,
+              PublicSymbol(ext->name.c_str(), address,
+                           static_cast<int32_t>(ext->parameter_size),
+                           ext->is_multiple)).second) {
+        is_corrupt_ = true;
+      }
+    }
+  }
+
+  if (symbol_data & CFI) {
+    for (Module::StackFrameEntry* entry : module_->stack_frame_entries_) {
+      if (entry->initial_rules.empty()) {
+        is_corrupt_ = true;
+      } else {
+        cfi_initial_rules.StoreRange(entry->address - load_address,
+                                     entry->size, &entry->initial_rules);
+      }
+      for (const auto& delta : entry->rule_changes) {
+        if (delta.second.empty())
+          is_corrupt_ = true;
+        else
+          cfi_delta_rules[delta.first - load_address] = &delta.second;
+      }
+    }
+  }
+
+  // Lay the maps out as ModuleSerializer does.
+  StdMapSerializer<int, const char*> files_serializer;
+  RangeMapSerializer<MemAddr, FunctionRange> functions_serializer;
+  StdMapSerializer<MemAddr, PublicSymbol> public_symbols_serializer;
+  ContainedRangeMapSerializer<MemAddr, linked_ptr<WindowsFrameInfo>>
+      windows_frame_info_serializer;
+  RangeMapSerializer<MemAddr, const Module::RuleMap*>
+      cfi_initial_rules_serializer;
+  StdMapSerializer<MemAddr, const Module::RuleMap*> cfi_delta_rules_serializer;
+  StdMapSerializer<int, InlineOrigin> inline_origins_serializer;
+  files_serializer.set_build_search_index(build_search_index_);
+  functions_serializer.set_build_search_index(build_search_index_);
+  public_symbols_serializer.set_build_search_index(build_search_index_);
+  windows_frame_info_serializer.set_build_search_index(build_search_index_);
+  cfi_initial_rules_serializer.set_build_search_index(build_search_index_);
+  cfi_delta_rules_serializer.set_build_search_index(build_search_index_);
+  inline_origins_serializer.set_build_search_index(build_search_index_);
+  // Modules never have Windows frame info.
+  ContainedRangeMap<MemAddr, linked_ptr<WindowsFrameInfo>> windows_frame_info;
+
+  const int kNumberMaps = FastSourceLineResolver::Module::kNumberMaps_;
+  uint32_t map_sizes[kNumberMaps];
+  int map_index = 0;
+  map_sizes[map_index++] = files_serializer.SizeOf(files);
+  map_sizes[map_index++] = functions_serializer.SizeOf(functions);
+  map_sizes[map_index++] = public_symbols_serializer.SizeOf(public_symbols);
+  for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i) {
+    map_sizes[map_index++] =
+        windows_frame_info_serializer.SizeOf(&windows_frame_info);
+  }
+  map_sizes[map_index++] =
+      cfi_initial_rules_serializer.SizeOf(cfi_initial_rules);
+  map_sizes[map_index++] = cfi_delta_rules_serializer.SizeOf(cfi_delta_rules);
+  map_sizes[map_index++] = inline_origins_serializer.SizeOf(inline_origins);
+  if (!ok_) {
+    fprintf(stderr, "error reading spilled functions\n");
+    return false;
+  }
+
+  // Each map is padded out to the next's alignment; see kMapAlignment.
+  size_t size = FastModule::AlignMapOffset(
+      sizeof(SerializedHeader) + SimpleSerializer<bool>::SizeOf(false) +
+      sizeof(map_sizes));
+  for (int i = 0; i < kNumberMaps; ++i) {
+    map_sizes[i] =
+        static_cast<uint32_t>(FastModule::AlignMapOffset(map_sizes[i]));
+    size += map_sizes[i];
+  }
+  size += SimpleSerializer<char>::SizeOf(0);
+  vector<char> buffer(size);
+  char* start = buffer.data();
+  auto pad = [start](char* end) {
+    return FastModule::PadToMapAlignment(start, end);
+  };
+  char* dest = start + sizeof(SerializedHeader);
+  dest = SimpleSerializer<bool>::Write(is_corrupt_, dest);
+  memcpy(dest, map_sizes, sizeof(map_sizes));
+  dest = pad(dest + sizeof(map_sizes));
+  dest = pad(files_serializer.Write(files, dest));
+  dest = pad(functions_serializer.Write(functions, dest));
+  dest = pad(public_symbols_serializer.Write(public_symbols, dest));
+  for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i)
+    dest = pad(windows_frame_info_serializer.Write(&windows_frame_info, dest));
+  dest = pad(cfi_initial_rules_serializer.Write(cfi_initial_rules, dest));
+  dest = pad(cfi_delta_rules_serializer.Write(cfi_delta_rules, dest));
+  dest = pad(inline_origins_serializer.Write(inline_origins, dest));
+  dest = SimpleSerializer<char>::Write(0, dest);
+  if (!ok_) {
+    fprintf(stderr, "error reading spilled functions\n");
+    return false;
+  }
+  assert(dest == start + size);
+
+  SerializedHeader header;
+  header.magic = FastSourceLineResolver::Module::kSerializedMagic;
+  header.version = FastSourceLineResolver::Module::kSerializedVersion;
+  header.size = static_cast<uint32_t>(size);
+  header.checksum = FastSourceLineResolver::Module::Checksum(
+      start + sizeof(header), size - sizeof(header));
+  memcpy(start, &header, sizeof(header));
+
+  stream.write(start, size);
+  if (!stream.good())
+    return Module::ReportError();
+  return true;
+}
+
+size_t FastModuleWriter::SizeOfFunction(const FunctionRange& function_range) {
+  vector<char> body;
+  EncodeFunctionBody(function_range, &body);
+  return function_range.function->name.size() + 1
+      + SimpleSerializer<MemAddr>::SizeOf(0)   // address
+      + SimpleSerializer<MemAddr>::SizeOf(0)   // size
+      + SimpleSerializer<int32_t>::SizeOf(0)   // parameter size
+      + SimpleSerializer<bool>::SizeOf(false)  // is_multiple
+      + body.size();
+}
+
+char* FastModuleWriter::WriteFunction(const FunctionRange& function_range,
+                                      char* dest) {
+  const Module::Function* function = function_range.function;
+  const Module::Range& range = function->ranges[function_range.range];
+  memcpy(dest, function->name.data(), function->name.size());
+  dest += function->name.size();
+  dest = SimpleSerializer<char>::Write(0, dest);
+  dest = SimpleSerializer<MemAddr>::Write(
+      range.address - module_->load_address_, dest);
+  dest = SimpleSerializer<MemAddr>::Write(range.size, dest);
+  dest = SimpleSerializer<int32_t>::Write(
+      static_cast<int32_t>(function->parameter_size), dest);
+  dest = SimpleSerializer<bool>::Write(function->is_multiple, dest);
+  vector<char> body;
+  EncodeFunctionBody(function_range, &body);
+  memcpy(dest, body.data(), body.size());
+  return dest + body.size();
+}
+
+void FastModuleWriter::EncodeFunctionBody(const FunctionRange& function_range,
+                                          vector<char>* buffer) {
+  typedef BasicSourceLineResolver::Inline Inline;
+  typedef BasicSourceLineResolver::Line Line;
+  Module::Function* function = function_range.function;
+  const Module::Address load_address = module_->load_address_;
+  const Module::Address kMaxAddress = Module::kMaxAddress;
+
+  if (!RestoreFunction(function)) {
+    buffer->clear();
+    return;
+  }
+
+  // The range's FUNC record would be followed by all of the function's
+  // INLINE records, which BasicSourceLineResolver::Function::AppendInline
+  // skips where an enclosing one was skipped.
+  ContainedRangeMap<MemAddr, linked_ptr<Inline>> inlines(true);
+  int last_nest_level = 0;
+  auto add_inline = [&](std::unique_ptr<Module::Inline>& in) {
+    if (in->ranges.empty() || in->inline_nest_level < 0 ||
+        in->call_site_line < 0 || in->getCallSiteFileID() < -1 ||
+        in->origin->id < 0)
+      return;
+    vector<std::pair<MemAddr, MemAddr>> ranges;
+    for (const Module::Range& range : in->ranges) {
+      if (ranges.size() == kMaxInlineRanges)
+        break;
+      MemAddr address = range.address - load_address;
+      if (address == kMaxAddress || range.size == kMaxAddress)
+        return;
+      ranges.push_back(std::make_pair(address, range.size));
+    }
+    if (in->inline_nest_level > last_nest_level + 1)
+      return;
+    last_nest_level = in->inline_nest_level;
+    linked_ptr<Inline> stored(new Inline(true, in->inline_nest_level,
+                                         in->call_site_line,
+                                         in->getCallSiteFileID(),
+                                         in->origin->id, ranges));
+    for (const std::pair<MemAddr, MemAddr>& range : ranges)
+      inlines.StoreRange(range.first, range.second, stored);
+  };
+  Module::Inline::InlineDFS(function->inlines, add_inline);
+
+  // It would then be followed by its lines.
+  RangeMap<MemAddr, Line> lines;
+  ForEachRangeLine(function, function_range.range,
+                   [&](const Module::Line& line) {
+    if (!IsValidLine(line, load_address)) {
+      is_corrupt_ = true;
+      return;
+    }
+    MemAddr address = line.address - load_address;
+    lines.StoreRange(address, line.size,
+                     Line(address, line.size, line.file->source_id,
+                          line.number));
+  });
+  FreeFunction(function);
+
+  // The inline map is preceded by its size, as
+  // SimpleSerializer<BasicSourceLineResolver::Function> writes it.
+  ContainedRangeMapSerializer<MemAddr, linked_ptr<Inline>> inline_serializer;
+  LineTableSerializer<MemAddr, Line> line_serializer;
+  size_t inlines_size = inline_serializer.SizeOf(&inlines);
+  buffer->resize(sizeof(int32_t) + inlines_size +
+                 line_serializer.SizeOf(lines));
+  char* dest = buffer->data();
+  dest = SimpleSerializer<int32_t>::Write(inlines_size, dest);
+  dest = inline_serializer.Write(&inlines, dest);
+  line_serializer.Write(lines, dest);
+}
+
+bool FastModuleWriter::RestoreFunction(Module::Function* function) {
+  if (module_->spilled_functions_.count(function) &&
+      !module_->RestoreFunction(function, inline_origins_)) {
+    ok_ = false;
+    return false;
+  }
+  return true;
+}
+
+void FastModuleWriter::FreeFunction(Module::Function* function) {
+  if (module_->spilled_functions_.count(function)) {
+    vector<Module::Line>().swap(function->lines);
+    vector<std::unique_ptr<Module::Inline>>().swap(function->inlines);
+  }
+}
+
+}  // namespace google_breakpad
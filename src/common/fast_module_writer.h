@@ -0,0 +1,134 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_module_writer.h: Define google_breakpad::FastModuleWriter, which
+// writes a Module in the serialized symbol format FastSourceLineResolver
+// loads, without going through a text symbol file.
+
+#ifndef COMMON_FAST_MODULE_WRITER_H__
+#define COMMON_FAST_MODULE_WRITER_H__
+
+#include <stddef.h>
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "common/module.h"
+#include "common/symbol_data.h"
+
+namespace google_breakpad {
+
+template<class Type> class SimpleSerializer;
+
+// FastModuleWriter serializes a Module directly, producing the same data as
+// writing the module as a text symbol file with Module::Write, loading that
+// into BasicSourceLineResolver and serializing it with ModuleSerializer
+// (as sym_to_fast does), except that names the text format can't hold are
+// kept as they are.  Records BasicSourceLineResolver would reject, or drop
+// for overlapping others, are left out the same way, and the data is marked
+// corrupt if any record would have failed to parse; BasicSourceLineResolver
+// would also give up after too many such records, which this doesn't.
+//
+// The serialized data is laid out in a buffer the size of the result, and
+// each function's lines and inlines are encoded on their own, so no text is
+// formatted or parsed and the module itself is all else that is kept in
+// memory.  Functions whose lines and inlines have been spilled (see
+// Module::SetMaxFunctionsInMemory) are read back one at a time.
+class FastModuleWriter {
+ public:
+  // Write MODULE, which must outlive this writer.  MODULE is not changed,
+  // other than in the ways Module::Write changes it.
+  explicit FastModuleWriter(Module* module);
+
+  // If BUILD_SEARCH_INDEX is true, large maps are written with a search
+  // index, as ModuleSerializer::set_build_search_index does.  Off by
+  // default.
+  void set_build_search_index(bool build_search_index) {
+    build_search_index_ = build_search_index;
+  }
+
+  // Write the parts of the module selected by SYMBOL_DATA to STREAM in
+  // serialized form.  Return true on success, or report an error and return
+  // false.
+  bool Write(std::ostream& stream, SymbolData symbol_data);
+
+ private:
+  template<class> friend class SimpleSerializer;
+
+  // One range of a function, which becomes one function in the serialized
+  // data, as it would be one FUNC record in a text symbol file.
+  struct FunctionRange {
+    FunctionRange() : writer(NULL), function(NULL), range(0) {}
+    FunctionRange(FastModuleWriter* writer, Module::Function* function,
+                  size_t range)
+        : writer(writer), function(function), range(range) {}
+    FastModuleWriter* writer;
+    Module::Function* function;
+    // The index of the range in FUNCTION->ranges.
+    size_t range;
+  };
+
+  // Return the number of bytes FUNCTION_RANGE takes in the serialized
+  // functions map, or write it to DEST and return the address following
+  // it.
+  size_t SizeOfFunction(const FunctionRange& function_range);
+  char* WriteFunction(const FunctionRange& function_range, char* dest);
+
+  // Encode FUNCTION_RANGE's inlines and lines into BUFFER the way
+  // WriteFunction writes them, setting is_corrupt_ if a line is invalid.
+  // Spilled lines and inlines are read back for the duration of the call.
+  void EncodeFunctionBody(const FunctionRange& function_range,
+                          std::vector<char>* buffer);
+
+  // If FUNCTION's lines and inlines were spilled, read them back, or
+  // clear ok_ and return false if they can't be.
+  bool RestoreFunction(Module::Function* function);
+
+  // If FUNCTION's lines and inlines were spilled, free them again.
+  void FreeFunction(Module::Function* function);
+
+  Module* module_;
+  bool build_search_index_;
+
+  // The module's inline origins, as Module::Write numbers them.
+  std::set<Module::InlineOrigin*, Module::InlineOriginCompare>
+      inline_origins_;
+
+  // True once a record BasicSourceLineResolver would fail to parse has
+  // been found.
+  bool is_corrupt_;
+
+  // False once spilled functions could not be read back.
+  bool ok_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_FAST_MODULE_WRITER_H__
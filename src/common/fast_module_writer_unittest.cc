@@ -0,0 +1,321 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// fast_module_writer_unittest.cc: Unit tests for
+// google_breakpad::FastModuleWriter.
+
+#include <limits.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/fast_module_writer.h"
+#include "common/module.h"
+#include "common/using_std_string.h"
+#include "processor/module_serializer.h"
+
+using google_breakpad::FastModuleWriter;
+using google_breakpad::Module;
+using google_breakpad::ModuleSerializer;
+using std::stringstream;
+using std::vector;
+
+namespace {
+
+// Return what sym_to_fast makes of the symbol file M writes.
+string SerializeSymbolFile(Module* m, SymbolData symbol_data,
+                           bool build_search_index) {
+  stringstream s;
+  EXPECT_TRUE(m->Write(s, symbol_data));
+  ModuleSerializer serializer;
+  serializer.set_build_search_index(build_search_index);
+  unsigned int size = 0;
+  char* serialized = serializer.SerializeSymbolFileData(s.str(), &size);
+  string result(serialized, size);
+  delete[] serialized;
+  return result;
+}
+
+string WriteFast(Module* m, SymbolData symbol_data,
+                 bool build_search_index) {
+  stringstream s;
+  FastModuleWriter writer(m);
+  writer.set_build_search_index(build_search_index);
+  EXPECT_TRUE(writer.Write(s, symbol_data));
+  return s.str();
+}
+
+// Expect FastModuleWriter to write what sym_to_fast makes of M's symbol
+// file, for several kinds of symbol data and with and without search
+// indexes.
+void ExpectSameAsSymbolFile(Module* m) {
+  const SymbolData kSymbolData[] = {
+    ALL_SYMBOL_DATA, CFI, SYMBOLS_AND_FILES, NO_DATA
+  };
+  for (SymbolData symbol_data : kSymbolData) {
+    for (bool build_search_index : { false, true }) {
+      SCOPED_TRACE(testing::Message() << "symbol data " << symbol_data
+                                      << ", search index "
+                                      << build_search_index);
+      string expected = SerializeSymbolFile(m, symbol_data,
+                                            build_search_index);
+      ASSERT_FALSE(expected.empty());
+      EXPECT_TRUE(WriteFast(m, symbol_data, build_search_index) == expected);
+    }
+  }
+}
+
+Module::Function* MakeFunction(Module* m, const string& name,
+                               Module::Address address,
+                               Module::Address size) {
+  Module::Function* function =
+      new Module::Function(m->AddStringToPool(name), address);
+  function->ranges.push_back(Module::Range(address, size));
+  return function;
+}
+
+void AddStackFrameEntry(Module* m, Module::Address address,
+                        Module::Address size, const string& cfa) {
+  Module::StackFrameEntry* entry = new Module::StackFrameEntry();
+  entry->address = address;
+  entry->size = size;
+  if (!cfa.empty())
+    entry->initial_rules[".cfa"] = cfa;
+  entry->initial_rules[".ra"] = ".cfa 8 - ^";
+  entry->rule_changes[address + 1][".cfa"] = "$rsp 16 +";
+  entry->rule_changes[address + 2][".cfa"] = "$rsp 24 +";
+  m->AddStackFrameEntry(entry);
+}
+
+// Add three functions with lines and nested inlines to M, in decreasing
+// address order, the middle one citing a file and origin that nothing
+// else does.
+void AddInlinedFunctions(Module* m) {
+  Module::File* file1 = m->FindFile("file1.cc");
+  Module::File* file2 = m->FindFile("file2.cc");
+  m->FindFile("unused.cc");
+  m->inline_origin_map.SetReference(1, 1);
+  m->inline_origin_map.SetReference(2, 2);
+  Module::InlineOrigin* origin1 =
+      m->inline_origin_map.GetOrCreateInlineOrigin(1, "origin1");
+  Module::InlineOrigin* origin2 =
+      m->inline_origin_map.GetOrCreateInlineOrigin(2, "origin2");
+  for (int i = 3; i > 0; --i) {
+    Module::Address address = 0x11000 * i;
+    Module::Function* function =
+        MakeFunction(m, "function" + std::to_string(i), address, 0x100);
+    Module::File* file = i == 2 ? file2 : file1;
+    Module::Line line1 = { address, 0x10, file, 10 * i };
+    Module::Line line2 = { address + 0x10, 0x20, file1, 10 * i + 1 };
+    function->lines.push_back(line1);
+    function->lines.push_back(line2);
+    vector<std::unique_ptr<Module::Inline>> children;
+    children.push_back(std::unique_ptr<Module::Inline>(new Module::Inline(
+        origin1, vector<Module::Range>(1, Module::Range(address + 4, 4)),
+        7, 0, 1, vector<std::unique_ptr<Module::Inline>>())));
+    std::unique_ptr<Module::Inline> in(new Module::Inline(
+        i == 2 ? origin2 : origin1,
+        vector<Module::Range>(1, Module::Range(address, 0x10)),
+        5 * i, 0, 0, std::move(children)));
+    in->call_site_file = file;
+    in->child_inlines[0]->call_site_file = file1;
+    function->inlines.push_back(std::move(in));
+    m->AddFunction(function);
+  }
+}
+
+}  // namespace
+
+TEST(FastModuleWriter, Empty) {
+  Module m("name", "os", "architecture", "id");
+  ExpectSameAsSymbolFile(&m);
+}
+
+TEST(FastModuleWriter, Records) {
+  Module m("name", "os", "architecture", "id");
+  m.SetLoadAddress(0x10000);
+  Module::File* file1 = m.FindFile("file1.cc");
+  Module::File* file2 = m.FindFile("file 2.cc");
+  m.FindFile("unused.cc");
+
+  Module::Function* function = MakeFunction(&m, "f(int)", 0x11000, 0x100);
+  function->parameter_size = 0x10;
+  Module::Line lines[] = {
+    { 0x11000, 0x10, file1, 10 },
+    { 0x11010, 0x30, file2, 20 },
+    { 0x11040, 0xc0, file1, 11 },
+  };
+  function->lines.assign(lines, lines + 3);
+  m.AddFunction(function);
+  function = MakeFunction(&m, "g with spaces", 0x12000, 0x40);
+  Module::Line line = { 0x12000, 0x40, file2, 5 };
+  function->lines.push_back(line);
+  function->is_multiple = true;
+  m.AddFunction(function);
+
+  Module::Extern* ext = new Module::Extern(0x13000);
+  ext->name = "public";
+  ext->parameter_size = 4;
+  ext->is_multiple = true;
+  m.AddExtern(ext);
+  ext = new Module::Extern(0x13100);
+  ext->name = "another public";
+  m.AddExtern(ext);
+
+  AddStackFrameEntry(&m, 0x11000, 0x100, "$rsp 8 +");
+  AddStackFrameEntry(&m, 0x12000, 0x40, "$rbp 16 +");
+  ExpectSameAsSymbolFile(&m);
+}
+
+// Records BasicSourceLineResolver rejects, or doesn't store for
+// overlapping others, are left out the same way.
+TEST(FastModuleWriter, RejectedRecords) {
+  Module m("name", "os", "architecture", "id");
+  m.SetLoadAddress(0x10000);
+  Module::File* file = m.FindFile("file.cc");
+
+  // Overlapping functions: the latter can't be stored.
+  Module::Function* function = MakeFunction(&m, "first", 0x11000, 0x100);
+  Module::Line lines[] = {
+    { 0x11000, 0x10, file, 10 },
+    // Overlaps the line before it.
+    { 0x11008, 0x10, file, 11 },
+    { 0x11020, 0x10, file, -1 },
+    { 0x11030, 0, file, 12 },
+  };
+  function->lines.assign(lines, lines + 4);
+  m.AddFunction(function);
+  function = MakeFunction(&m, "overlapping", 0x11080, 0x100);
+  Module::Line line = { 0x11080, 0x10, file, 20 };
+  function->lines.push_back(line);
+  m.AddFunction(function);
+  m.AddFunction(MakeFunction(&m, "empty", 0x12000, 0));
+  function = MakeFunction(&m, "huge parameters", 0x13000, 0x10);
+  function->parameter_size = Module::Address(LONG_MAX);
+  m.AddFunction(function);
+  function = MakeFunction(&m, "truncated parameters", 0x14000, 0x10);
+  function->parameter_size = 0x123456789ULL;
+  m.AddFunction(function);
+
+  // At the load address, so at address zero once relative.
+  Module::Extern* ext = new Module::Extern(0x10000);
+  ext->name = "at zero";
+  m.AddExtern(ext);
+  ext = new Module::Extern(0x15000);
+  ext->name = "huge parameters";
+  ext->parameter_size = Module::Address(LONG_MAX) + 1;
+  m.AddExtern(ext);
+
+  AddStackFrameEntry(&m, 0x11000, 0x100, "$rsp 8 +");
+  AddStackFrameEntry(&m, 0x11080, 0x100, "$rsp 16 +");
+  AddStackFrameEntry(&m, 0x12000, 0, "$rsp 8 +");
+  Module::StackFrameEntry* entry = new Module::StackFrameEntry();
+  entry->address = 0x13000;
+  entry->size = 0x10;
+  entry->rule_changes[0x13004][".cfa"] = "$rsp 16 +";
+  entry->rule_changes[0x13008];
+  m.AddStackFrameEntry(entry);
+  ExpectSameAsSymbolFile(&m);
+}
+
+TEST(FastModuleWriter, Inlines) {
+  Module m("name", "os", "architecture", "id");
+  m.SetLoadAddress(0x10000);
+  AddInlinedFunctions(&m);
+
+  // BasicSourceLineResolver skips an inline nested deeper than the one
+  // before it allows, and each range of a function gets all of its inlines.
+  Module::File* file = m.FindFile("file1.cc");
+  Module::InlineOrigin* origin =
+      m.inline_origin_map.GetOrCreateInlineOrigin(1, "origin1");
+  Module::Function* function = MakeFunction(&m, "ranges", 0x40000, 0x20);
+  function->ranges.push_back(Module::Range(0x40100, 0x20));
+  Module::Line lines[] = {
+    { 0x40000, 0x20, file, 1 },
+    { 0x40100, 0x10, file, 2 },
+    { 0x40110, 0x10, file, 3 },
+  };
+  function->lines.assign(lines, lines + 3);
+  vector<Module::Range> ranges;
+  ranges.push_back(Module::Range(0x40000, 0x10));
+  ranges.push_back(Module::Range(0x40100, 0x10));
+  function->inlines.push_back(std::unique_ptr<Module::Inline>(
+      new Module::Inline(origin, ranges, 3, 0, 0,
+                         vector<std::unique_ptr<Module::Inline>>())));
+  function->inlines.push_back(std::unique_ptr<Module::Inline>(
+      new Module::Inline(origin,
+                         vector<Module::Range>(1, Module::Range(0x40004, 4)),
+                         4, 0, 2, vector<std::unique_ptr<Module::Inline>>())));
+  m.AddFunction(function);
+  ExpectSameAsSymbolFile(&m);
+}
+
+// Spilled lines and inlines are read back as they are written.
+TEST(FastModuleWriter, SpilledFunctions) {
+  Module expected_module("name", "os", "architecture", "id");
+  AddInlinedFunctions(&expected_module);
+  string expected = SerializeSymbolFile(&expected_module, ALL_SYMBOL_DATA,
+                                        false);
+
+  Module m("name", "os", "architecture", "id");
+  m.SetMaxFunctionsInMemory(1);
+  AddInlinedFunctions(&m);
+  EXPECT_TRUE(WriteFast(&m, ALL_SYMBOL_DATA, false) == expected);
+  // The functions are spilled again afterwards.
+  vector<Module::Function*> functions;
+  m.GetFunctions(&functions, functions.end());
+  ASSERT_EQ(3U, functions.size());
+  EXPECT_EQ(0U, functions[1]->lines.size());
+  EXPECT_EQ(0U, functions[2]->lines.size());
+  EXPECT_TRUE(WriteFast(&m, ALL_SYMBOL_DATA, false) == expected);
+}
+
+// Enough records for every address map to get a search index.
+TEST(FastModuleWriter, ManyRecords) {
+  Module m("name", "os", "architecture", "id");
+  Module::File* file = m.FindFile("file.cc");
+  for (int i = 0; i < 300; ++i) {
+    Module::Address address = 0x1000 + 0x100 * i;
+    Module::Function* function =
+        MakeFunction(&m, "function" + std::to_string(i), address, 0x80);
+    for (int j = 0; j < 20; ++j) {
+      Module::Line line = { address + 4 * j, 4, file, i + j };
+      function->lines.push_back(line);
+    }
+    m.AddFunction(function);
+    Module::Extern* ext = new Module::Extern(address + 0x80);
+    ext->name = "extern" + std::to_string(i);
+    m.AddExtern(ext);
+    AddStackFrameEntry(&m, address, 0x80, "$rsp 8 +");
+  }
+  ExpectSameAsSymbolFile(&m);
+}
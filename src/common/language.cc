@@ -59,6 +59,33 @@ string MakeQualifiedNameWithSeparator(const string& parent_name,
   return parent_name + separator + name;
 }
 
+#if !defined(__ANDROID__)
+// A buffer for abi::__cxa_demangle to write demangled names into, which
+// it grows with realloc as needed.  Each thread keeps its own, so that
+// demangling a name doesn't allocate once the buffer is large enough.
+class DemangleBuffer {
+ public:
+  DemangleBuffer() : buffer_(NULL), size_(0) {}
+  ~DemangleBuffer() { free(buffer_); }
+
+  // Demangle MANGLED, returning the demangled name, or NULL if it can't
+  // be demangled.  The name is valid until the next call.
+  const char* Demangle(const char* mangled) {
+    int status;
+    char* demangled = abi::__cxa_demangle(mangled, buffer_, &size_, &status);
+    if (demangled)
+      buffer_ = demangled;
+    return status == 0 ? demangled : NULL;
+  }
+
+ private:
+  char* buffer_;
+  size_t size_;
+};
+
+thread_local DemangleBuffer demangle_buffer;
+#endif
+
 }  // namespace
 
 namespace google_breakpad {
@@ -87,24 +114,13 @@ class CPPLanguage: public Language {
       return kDontDemangle;
     }
 
-    int status;
-    char* demangled_c =
-        abi::__cxa_demangle(mangled.c_str(), NULL, NULL, &status);
-
-    DemangleResult result;
-    if (status == 0) {
-      result = kDemangleSuccess;
-      demangled->assign(demangled_c);
-    } else {
-      result = kDemangleFailure;
+    const char* demangled_c = demangle_buffer.Demangle(mangled.c_str());
+    if (!demangled_c) {
       demangled->clear();
+      return kDemangleFailure;
     }
-
-    if (demangled_c) {
-      free(reinterpret_cast<void*>(demangled_c));
-    }
-
-    return result;
+    demangled->assign(demangled_c);
+    return kDemangleSuccess;
 #endif
   }
 
@@ -0,0 +1,172 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compressed_section.cc: Implement google_breakpad::DecompressSection.
+
+#include "common/linux/compressed_section.h"
+
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
+namespace google_breakpad {
+
+namespace {
+
+// The compression headers of 32-bit and 64-bit ELF files, laid out as
+// Elf32_Chdr and Elf64_Chdr are; not all elf.h headers define those.
+struct CompressionHeader32 {
+  uint32_t ch_type;
+  uint32_t ch_size;
+  uint32_t ch_addralign;
+};
+
+struct CompressionHeader64 {
+  uint32_t ch_type;
+  uint32_t ch_reserved;
+  uint64_t ch_size;
+  uint64_t ch_addralign;
+};
+
+#ifdef HAVE_LIBZ
+// Inflate the COMPRESSED_SIZE bytes of zlib data at COMPRESSED into the
+// UNCOMPRESSED_SIZE bytes at UNCOMPRESSED, which it must fill exactly.
+bool InflateZlib(const uint8_t* compressed, uint64_t compressed_size,
+                 uint8_t* uncompressed, uint64_t uncompressed_size) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit(&stream) != Z_OK)
+    return false;
+  // zlib counts bytes in uInts, so feed it sections over 4GiB in pieces.
+  uint64_t in_left = compressed_size;
+  uint64_t out_left = uncompressed_size;
+  stream.next_in = const_cast<Bytef*>(compressed);
+  stream.next_out = uncompressed;
+  int result = Z_OK;
+  while (result == Z_OK) {
+    if (stream.avail_in == 0 && in_left > 0) {
+      stream.avail_in =
+          static_cast<uInt>(std::min<uint64_t>(in_left, UINT_MAX));
+      in_left -= stream.avail_in;
+    }
+    if (stream.avail_out == 0 && out_left > 0) {
+      stream.avail_out =
+          static_cast<uInt>(std::min<uint64_t>(out_left, UINT_MAX));
+      out_left -= stream.avail_out;
+    }
+    result = inflate(&stream, Z_NO_FLUSH);
+  }
+  const bool finished = result == Z_STREAM_END && stream.avail_out == 0 &&
+                        out_left == 0;
+  inflateEnd(&stream);
+  return finished;
+}
+#endif  // HAVE_LIBZ
+
+#ifdef HAVE_LIBZSTD
+// Decompress the COMPRESSED_SIZE bytes of zstd data at COMPRESSED into
+// the UNCOMPRESSED_SIZE bytes at UNCOMPRESSED, which it must fill
+// exactly.
+bool DecompressZstd(const uint8_t* compressed, uint64_t compressed_size,
+                    uint8_t* uncompressed, uint64_t uncompressed_size) {
+  size_t result = ZSTD_decompress(uncompressed, uncompressed_size,
+                                  compressed, compressed_size);
+  return !ZSTD_isError(result) && result == uncompressed_size;
+}
+#endif  // HAVE_LIBZSTD
+
+}  // namespace
+
+bool DecompressSection(bool elf64,
+                       const uint8_t* contents,
+                       uint64_t size,
+                       std::unique_ptr<uint8_t[]>* uncompressed,
+                       uint64_t* uncompressed_size) {
+  uint32_t type;
+  uint64_t data_size;
+  size_t header_size;
+  if (elf64) {
+    CompressionHeader64 header;
+    if (size < sizeof(header))
+      return false;
+    memcpy(&header, contents, sizeof(header));
+    type = header.ch_type;
+    data_size = header.ch_size;
+    header_size = sizeof(header);
+  } else {
+    CompressionHeader32 header;
+    if (size < sizeof(header))
+      return false;
+    memcpy(&header, contents, sizeof(header));
+    type = header.ch_type;
+    data_size = header.ch_size;
+    header_size = sizeof(header);
+  }
+
+  bool (*decompress)(const uint8_t*, uint64_t, uint8_t*, uint64_t) = NULL;
+  switch (type) {
+#ifdef HAVE_LIBZ
+    case ELFCOMPRESS_ZLIB:
+      decompress = InflateZlib;
+      break;
+#endif
+#ifdef HAVE_LIBZSTD
+    case ELFCOMPRESS_ZSTD:
+      decompress = DecompressZstd;
+      break;
+#endif
+    default:
+      return false;
+  }
+
+  // A corrupt header may give any size at all; don't let that abort.
+  if (data_size > SIZE_MAX)
+    return false;
+  std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[data_size]);
+  if (!buffer ||
+      !decompress(contents + header_size, size - header_size, buffer.get(),
+                  data_size)) {
+    return false;
+  }
+  *uncompressed = std::move(buffer);
+  *uncompressed_size = data_size;
+  return true;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,71 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compressed_section.h: Decompress the contents of SHF_COMPRESSED ELF
+// sections, such as debug sections compressed by the linker or by
+// objcopy --compress-debug-sections.
+
+#ifndef COMMON_LINUX_COMPRESSED_SECTION_H_
+#define COMMON_LINUX_COMPRESSED_SECTION_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+// Some systems' elf.h predate compressed sections.
+#ifndef SHF_COMPRESSED
+#define SHF_COMPRESSED (1 << 11)
+#endif
+#ifndef ELFCOMPRESS_ZLIB
+#define ELFCOMPRESS_ZLIB 1
+#endif
+#ifndef ELFCOMPRESS_ZSTD
+#define ELFCOMPRESS_ZSTD 2
+#endif
+
+namespace google_breakpad {
+
+// Decompress the SIZE bytes at CONTENTS of an SHF_COMPRESSED section,
+// which start with the section's compression header, from a 64-bit
+// ELF file if ELF64 is true or a 32-bit one if not.  On success, set
+// *UNCOMPRESSED to a buffer holding the section's uncompressed
+// contents, set *UNCOMPRESSED_SIZE to their size, and return true.
+// Return false if the header is truncated, the section is compressed
+// in a format this build can't decompress, or the compressed data is
+// corrupt.  The decompressed data is written straight into a buffer of
+// the size the header gives, with no intermediate copies.
+bool DecompressSection(bool elf64,
+                       const uint8_t* contents,
+                       uint64_t size,
+                       std::unique_ptr<uint8_t[]>* uncompressed,
+                       uint64_t* uncompressed_size);
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_LINUX_COMPRESSED_SECTION_H_
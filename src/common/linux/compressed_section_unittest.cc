@@ -0,0 +1,198 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compressed_section_unittest.cc: Unit tests for
+// google_breakpad::DecompressSection.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#include "breakpad_googletest_includes.h"
+#include "common/linux/compressed_section.h"
+#include "common/using_std_string.h"
+
+using google_breakpad::DecompressSection;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+// Append VALUE to SECTION in the host's byte order.
+template<typename T>
+void AppendNumber(vector<uint8_t>* section, T value) {
+  uint8_t bytes[sizeof(value)];
+  memcpy(bytes, &value, sizeof(value));
+  section->insert(section->end(), bytes, bytes + sizeof(bytes));
+}
+
+// Return the compression header of a section of a 64-bit ELF file if
+// ELF64 is true or a 32-bit one if not, giving TYPE and SIZE.
+vector<uint8_t> CompressionHeader(bool elf64, uint32_t type,
+                                  uint64_t size) {
+  vector<uint8_t> header;
+  AppendNumber<uint32_t>(&header, type);
+  if (elf64) {
+    AppendNumber<uint32_t>(&header, 0);  // ch_reserved
+    AppendNumber<uint64_t>(&header, size);
+    AppendNumber<uint64_t>(&header, 1);  // ch_addralign
+  } else {
+    AppendNumber<uint32_t>(&header, size);
+    AppendNumber<uint32_t>(&header, 1);  // ch_addralign
+  }
+  return header;
+}
+
+}  // namespace
+
+TEST(CompressedSectionTest, TruncatedHeader) {
+  vector<uint8_t> section = CompressionHeader(true, ELFCOMPRESS_ZLIB, 16);
+  unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size = 0;
+  EXPECT_FALSE(DecompressSection(true, section.data(), section.size() - 1,
+                                 &uncompressed, &uncompressed_size));
+  EXPECT_FALSE(uncompressed);
+}
+
+TEST(CompressedSectionTest, UnknownType) {
+  vector<uint8_t> section = CompressionHeader(false, 0x1234, 4);
+  section.resize(section.size() + 4);
+  unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size = 0;
+  EXPECT_FALSE(DecompressSection(false, section.data(), section.size(),
+                                 &uncompressed, &uncompressed_size));
+  EXPECT_FALSE(uncompressed);
+}
+
+#ifdef HAVE_LIBZ
+namespace {
+
+// Return an SHF_COMPRESSED section holding CONTENTS compressed with zlib,
+// whose header gives SIZE as their size.
+vector<uint8_t> ZlibSection(bool elf64, const string& contents,
+                            uint64_t size) {
+  vector<uint8_t> section = CompressionHeader(elf64, ELFCOMPRESS_ZLIB, size);
+  uLongf compressed_size = compressBound(contents.size());
+  vector<uint8_t> compressed(compressed_size);
+  EXPECT_EQ(Z_OK, compress(compressed.data(), &compressed_size,
+                           reinterpret_cast<const Bytef*>(contents.data()),
+                           contents.size()));
+  section.insert(section.end(), compressed.begin(),
+                 compressed.begin() + compressed_size);
+  return section;
+}
+
+// Contents that compress well, as debug sections do.
+string Contents() {
+  string contents;
+  for (int i = 0; i < 1000; i++)
+    contents += "DW_TAG_subprogram " + std::to_string(i % 7) + "\n";
+  return contents;
+}
+
+}  // namespace
+
+TEST(CompressedSectionTest, Zlib64) {
+  const string contents = Contents();
+  vector<uint8_t> section = ZlibSection(true, contents, contents.size());
+  unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size = 0;
+  ASSERT_TRUE(DecompressSection(true, section.data(), section.size(),
+                                &uncompressed, &uncompressed_size));
+  ASSERT_EQ(contents.size(), uncompressed_size);
+  EXPECT_EQ(0, memcmp(contents.data(), uncompressed.get(), contents.size()));
+}
+
+TEST(CompressedSectionTest, Zlib32) {
+  const string contents = Contents();
+  vector<uint8_t> section = ZlibSection(false, contents, contents.size());
+  unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size = 0;
+  ASSERT_TRUE(DecompressSection(false, section.data(), section.size(),
+                                &uncompressed, &uncompressed_size));
+  ASSERT_EQ(contents.size(), uncompressed_size);
+  EXPECT_EQ(0, memcmp(contents.data(), uncompressed.get(), contents.size()));
+}
+
+// The header of a 32-bit file's section must not be read as a 64-bit one.
+TEST(CompressedSectionTest, WrongClass) {
+  const string contents = Contents();
+  vector<uint8_t> section = ZlibSection(false, contents, contents.size());
+  unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size = 0;
+  EXPECT_FALSE(DecompressSection(true, section.data(), section.size(),
+                                 &uncompressed, &uncompressed_size));
+}
+
+// The data must fill the size the header gives exactly.
+TEST(CompressedSectionTest, WrongSize) {
+  const string contents = Contents();
+  unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size = 0;
+  vector<uint8_t> longer = ZlibSection(true, contents, contents.size() + 1);
+  EXPECT_FALSE(DecompressSection(true, longer.data(), longer.size(),
+                                 &uncompressed, &uncompressed_size));
+  vector<uint8_t> shorter = ZlibSection(true, contents, contents.size() - 1);
+  EXPECT_FALSE(DecompressSection(true, shorter.data(), shorter.size(),
+                                 &uncompressed, &uncompressed_size));
+  EXPECT_FALSE(uncompressed);
+}
+
+TEST(CompressedSectionTest, Corrupt) {
+  const string contents = Contents();
+  vector<uint8_t> section = ZlibSection(true, contents, contents.size());
+  unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size = 0;
+  // Cut the stream short.
+  EXPECT_FALSE(DecompressSection(true, section.data(), section.size() - 8,
+                                 &uncompressed, &uncompressed_size));
+  // Damage the zlib stream header.
+  section[24] ^= 0xff;
+  EXPECT_FALSE(DecompressSection(true, section.data(), section.size(),
+                                 &uncompressed, &uncompressed_size));
+  EXPECT_FALSE(uncompressed);
+}
+
+// A header giving an impossibly large size must fail cleanly.
+TEST(CompressedSectionTest, HugeSize) {
+  const string contents = Contents();
+  vector<uint8_t> section = ZlibSection(true, contents, UINT64_MAX);
+  unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size = 0;
+  EXPECT_FALSE(DecompressSection(true, section.data(), section.size(),
+                                 &uncompressed, &uncompressed_size));
+}
+#endif  // HAVE_LIBZ
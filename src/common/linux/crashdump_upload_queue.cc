@@ -0,0 +1,232 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "common/linux/crashdump_upload_queue.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "common/linux/eintr_wrapper.h"
+#include "common/linux/google_crashdump_uploader.h"
+#include "common/linux/ignore_ret.h"
+#include "common/linux/libcurl_wrapper.h"
+
+namespace google_breakpad {
+
+namespace {
+
+const char kMinidumpSuffix[] = ".dmp";
+const char kRetrySuffix[] = ".retry";
+
+bool HasSuffix(const string& name, const char* suffix) {
+  size_t length = strlen(suffix);
+  return name.size() > length &&
+      name.compare(name.size() - length, length, suffix) == 0;
+}
+
+}  // namespace
+
+CrashdumpUploadQueue::CrashdumpUploadQueue(const string& directory,
+                                           const string& product,
+                                           const string& version,
+                                           const string& guid,
+                                           const string& crash_server,
+                                           const string& proxy_host,
+                                           const string& proxy_userpassword)
+    : directory_(directory),
+      product_(product),
+      version_(version),
+      guid_(guid),
+      crash_server_(crash_server),
+      proxy_host_(proxy_host),
+      proxy_userpassword_(proxy_userpassword),
+      initial_retry_delay_(60),
+      max_retry_delay_(24 * 60 * 60),
+      max_send_speed_(0),
+      stopping_(false) {
+  if (pipe2(wake_fds_, O_CLOEXEC | O_NONBLOCK) != 0)
+    wake_fds_[0] = wake_fds_[1] = -1;
+}
+
+CrashdumpUploadQueue::~CrashdumpUploadQueue() {
+  Stop();
+  if (wake_fds_[0] >= 0) {
+    close(wake_fds_[0]);
+    close(wake_fds_[1]);
+  }
+}
+
+int CrashdumpUploadQueue::Drain() {
+  // The lock file keeps two processes from uploading the same dump.
+  string lock_path = directory_ + "/.lock";
+  int lock_fd = open(lock_path.c_str(), O_RDONLY | O_CREAT | O_CLOEXEC, 0600);
+  if (lock_fd < 0)
+    return -1;
+  if (flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+    close(lock_fd);
+    return initial_retry_delay_;
+  }
+
+  std::vector<string> minidumps;
+  std::vector<string> retry_files;
+  DIR* dir = opendir(directory_.c_str());
+  if (dir) {
+    while (struct dirent* entry = readdir(dir)) {
+      string name = entry->d_name;
+      if (name[0] == '.')
+        continue;
+      if (HasSuffix(name, kMinidumpSuffix))
+        minidumps.push_back(name);
+      else if (HasSuffix(name, kRetrySuffix))
+        retry_files.push_back(name);
+    }
+    closedir(dir);
+  }
+  std::sort(minidumps.begin(), minidumps.end());
+
+  // Retry files left behind by a dump that was deleted are removed.
+  for (size_t i = 0; i < retry_files.size(); ++i) {
+    string name = retry_files[i].substr(
+        0, retry_files[i].size() - strlen(kRetrySuffix));
+    if (!std::binary_search(minidumps.begin(), minidumps.end(), name))
+      unlink((directory_ + "/" + retry_files[i]).c_str());
+  }
+
+  int next_due = -1;
+  for (size_t i = 0; i < minidumps.size() && !stopping_; ++i) {
+    int due = DrainMinidump(directory_ + "/" + minidumps[i], time(NULL));
+    if (due >= 0 && (next_due < 0 || due < next_due))
+      next_due = due;
+  }
+
+  close(lock_fd);
+  return next_due;
+}
+
+int CrashdumpUploadQueue::DrainMinidump(const string& path, time_t now) {
+  string retry_path = path + kRetrySuffix;
+  int attempts = 0;
+  long long next_attempt = 0;
+  if (FILE* retry_file = fopen(retry_path.c_str(), "r")) {
+    if (fscanf(retry_file, "%d %lld", &attempts, &next_attempt) != 2)
+      attempts = 0;
+    fclose(retry_file);
+  }
+  if (attempts > 0 && next_attempt > now)
+    return static_cast<int>(std::min<long long>(next_attempt - now, INT_MAX));
+
+  if (UploadMinidump(path)) {
+    unlink(path.c_str());
+    unlink(retry_path.c_str());
+    return -1;
+  }
+
+  ++attempts;
+  int delay = initial_retry_delay_;
+  for (int i = 1; i < attempts && delay < max_retry_delay_; ++i)
+    delay = delay > max_retry_delay_ / 2 ? max_retry_delay_ : delay * 2;
+  delay = std::min(delay, max_retry_delay_);
+  if (FILE* retry_file = fopen(retry_path.c_str(), "w")) {
+    fprintf(retry_file, "%d %lld\n", attempts,
+            static_cast<long long>(now) + delay);
+    fclose(retry_file);
+  }
+  return delay;
+}
+
+bool CrashdumpUploadQueue::UploadMinidump(const string& path) {
+  LibcurlWrapper* http_layer = new LibcurlWrapper();
+  http_layer->set_max_send_speed(max_send_speed_);
+  GoogleCrashdumpUploader uploader(product_,
+                                   version_,
+                                   guid_,
+                                   /*ptime=*/"",
+                                   /*ctime=*/"",
+                                   /*email=*/"",
+                                   /*comments=*/"",
+                                   path,
+                                   crash_server_,
+                                   proxy_host_,
+                                   proxy_userpassword_,
+                                   http_layer);
+  int http_status_code = 0;
+  return uploader.Upload(&http_status_code, NULL, NULL) &&
+      http_status_code >= 200 && http_status_code < 300;
+}
+
+bool CrashdumpUploadQueue::Start() {
+  if (thread_.joinable())
+    return true;
+  if (wake_fds_[0] < 0)
+    return false;
+  stopping_ = false;
+  thread_ = std::thread(&CrashdumpUploadQueue::Run, this);
+  return true;
+}
+
+void CrashdumpUploadQueue::Poke() {
+  if (wake_fds_[1] >= 0) {
+    char c = 0;
+    IGNORE_RET(write(wake_fds_[1], &c, 1));
+  }
+}
+
+void CrashdumpUploadQueue::Stop() {
+  if (!thread_.joinable())
+    return;
+  stopping_ = true;
+  Poke();
+  thread_.join();
+}
+
+void CrashdumpUploadQueue::Run() {
+  while (!stopping_) {
+    int next_due = Drain();
+    if (stopping_)
+      break;
+    struct pollfd wake = { wake_fds_[0], POLLIN, 0 };
+    int timeout_ms = next_due < 0 ? -1 :
+        next_due >= INT_MAX / 1000 ? INT_MAX : std::max(next_due, 1) * 1000;
+    if (HANDLE_EINTR(poll(&wake, 1, timeout_ms)) > 0) {
+      char buffer[64];
+      while (read(wake_fds_[0], buffer, sizeof(buffer)) > 0) {}
+    }
+  }
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,139 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// A directory of minidumps waiting to be uploaded with
+// GoogleCrashdumpUploader, drained on a background thread and retried
+// with exponential backoff until the upload succeeds.
+//
+// Every "*.dmp" file in the directory is queued, so pointing an
+// ExceptionHandler's MinidumpDescriptor at the directory queues each dump
+// as it is written, and the MinidumpCallback need not do anything. If the
+// process survives the dump, the callback may call Poke() to have it
+// uploaded at once. Dumps written by other processes should be written
+// elsewhere and renamed into the directory, so that an incomplete dump is
+// never uploaded.
+//
+// Each failed dump has a "<name>.dmp.retry" file beside it recording its
+// attempts so far and when to try it again, so the backoff carries over
+// to the next process using the queue. Several processes may share a
+// directory: only one drains it at a time.
+
+#ifndef COMMON_LINUX_CRASHDUMP_UPLOAD_QUEUE_H_
+#define COMMON_LINUX_CRASHDUMP_UPLOAD_QUEUE_H_
+
+#include <time.h>
+
+#include <atomic>
+#include <thread>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class CrashdumpUploadQueue {
+ public:
+  // The arguments are those of GoogleCrashdumpUploader.
+  CrashdumpUploadQueue(const string& directory,
+                       const string& product,
+                       const string& version,
+                       const string& guid,
+                       const string& crash_server,
+                       const string& proxy_host,
+                       const string& proxy_userpassword);
+  // Stops the background thread.
+  virtual ~CrashdumpUploadQueue();
+
+  // The delay before the first retry of a dump, which doubles with each
+  // further attempt up to |max_seconds|. The defaults are a minute and a
+  // day.
+  void set_retry_delays(int initial_seconds, int max_seconds) {
+    initial_retry_delay_ = initial_seconds;
+    max_retry_delay_ = max_seconds;
+  }
+
+  // Caps the upload bandwidth, or doesn't if 0, the default.
+  void set_max_send_speed(long bytes_per_second) {
+    max_send_speed_ = bytes_per_second;
+  }
+
+  // Uploads every queued dump that is due, one after another, unless
+  // another process is draining the queue. Returns the number of seconds
+  // until the next failed dump is due, or -1 if none are left.
+  int Drain();
+
+  // Starts a thread that drains the queue now, whenever a failed dump is
+  // due and whenever Poke() is called. Returns false if the thread could
+  // not be started.
+  bool Start();
+
+  // Has the background thread drain the queue now. This is
+  // async-signal-safe, so it may be called from a MinidumpCallback.
+  void Poke();
+
+  // Stops the background thread, after the upload in progress.
+  void Stop();
+
+ protected:
+  // Uploads the minidump at |path|, returning true if the server accepted
+  // it. Overridden by tests.
+  virtual bool UploadMinidump(const string& path);
+
+ private:
+  // Handles the dump at |path| if it is due at |now|. Returns the number of
+  // seconds until it is next due, or -1 if it is done with.
+  int DrainMinidump(const string& path, time_t now);
+
+  void Run();
+
+  string directory_;
+  string product_;
+  string version_;
+  string guid_;
+  string crash_server_;
+  string proxy_host_;
+  string proxy_userpassword_;
+
+  int initial_retry_delay_;
+  int max_retry_delay_;
+  long max_send_speed_;
+
+  // Poke() and Stop() write to wake_fds_[1] to wake the background thread,
+  // which polls wake_fds_[0].
+  int wake_fds_[2];
+  std::atomic<bool> stopping_;
+  std::thread thread_;
+
+  // Disallow copy ctor and operator=.
+  CrashdumpUploadQueue(const CrashdumpUploadQueue&);
+  CrashdumpUploadQueue& operator=(const CrashdumpUploadQueue&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_LINUX_CRASHDUMP_UPLOAD_QUEUE_H_
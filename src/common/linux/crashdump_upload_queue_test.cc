@@ -0,0 +1,171 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Unit test for the crash dump upload queue.
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/linux/crashdump_upload_queue.h"
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// A queue whose uploads succeed or fail as the test says, and are recorded.
+class TestQueue : public CrashdumpUploadQueue {
+ public:
+  explicit TestQueue(const string& directory)
+      : CrashdumpUploadQueue(directory, "product", "1.0", "AAA-BBB",
+                             "http://foo.com", "", ""),
+        succeed_(true) {}
+  ~TestQueue() { Stop(); }
+
+  void set_succeed(bool succeed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    succeed_ = succeed;
+  }
+
+  std::vector<string> uploads() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return uploads_;
+  }
+
+ protected:
+  bool UploadMinidump(const string& path) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uploads_.push_back(path);
+    return succeed_;
+  }
+
+ private:
+  std::mutex mutex_;
+  bool succeed_;
+  std::vector<string> uploads_;
+};
+
+void WriteFile(const string& path) {
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file);
+  fputs("MDMP", file);
+  fclose(file);
+}
+
+bool FileExists(const string& path) {
+  return access(path.c_str(), F_OK) == 0;
+}
+
+}  // namespace
+
+TEST(CrashdumpUploadQueueTest, UploadsAndRemovesDumps) {
+  AutoTempDir temp_dir;
+  WriteFile(temp_dir.path() + "/b.dmp");
+  WriteFile(temp_dir.path() + "/a.dmp");
+  WriteFile(temp_dir.path() + "/notes.txt");
+
+  TestQueue queue(temp_dir.path());
+  EXPECT_EQ(-1, queue.Drain());
+  std::vector<string> uploads = queue.uploads();
+  ASSERT_EQ(2U, uploads.size());
+  EXPECT_EQ(temp_dir.path() + "/a.dmp", uploads[0]);
+  EXPECT_EQ(temp_dir.path() + "/b.dmp", uploads[1]);
+  EXPECT_FALSE(FileExists(temp_dir.path() + "/a.dmp"));
+  EXPECT_FALSE(FileExists(temp_dir.path() + "/b.dmp"));
+  EXPECT_TRUE(FileExists(temp_dir.path() + "/notes.txt"));
+}
+
+TEST(CrashdumpUploadQueueTest, BacksOffFailedDumps) {
+  AutoTempDir temp_dir;
+  string dump = temp_dir.path() + "/a.dmp";
+  WriteFile(dump);
+
+  TestQueue queue(temp_dir.path());
+  queue.set_retry_delays(100, 250);
+  queue.set_succeed(false);
+  EXPECT_EQ(100, queue.Drain());
+  EXPECT_EQ(1U, queue.uploads().size());
+  EXPECT_TRUE(FileExists(dump));
+  EXPECT_TRUE(FileExists(dump + ".retry"));
+
+  // The dump isn't due yet.
+  int due = queue.Drain();
+  EXPECT_GT(due, 0);
+  EXPECT_LE(due, 100);
+  EXPECT_EQ(1U, queue.uploads().size());
+
+  // Make it due; each failure doubles the delay, up to the maximum.
+  FILE* retry_file = fopen((dump + ".retry").c_str(), "w");
+  ASSERT_TRUE(retry_file);
+  fputs("1 0\n", retry_file);
+  fclose(retry_file);
+  EXPECT_EQ(200, queue.Drain());
+  retry_file = fopen((dump + ".retry").c_str(), "w");
+  ASSERT_TRUE(retry_file);
+  fputs("2 0\n", retry_file);
+  fclose(retry_file);
+  EXPECT_EQ(250, queue.Drain());
+  EXPECT_EQ(3U, queue.uploads().size());
+
+  // A new queue, as in the next process, keeps to the backoff.
+  TestQueue next_queue(temp_dir.path());
+  EXPECT_GT(next_queue.Drain(), 0);
+  EXPECT_TRUE(next_queue.uploads().empty());
+}
+
+TEST(CrashdumpUploadQueueTest, RemovesStaleRetryFiles) {
+  AutoTempDir temp_dir;
+  WriteFile(temp_dir.path() + "/gone.dmp.retry");
+
+  TestQueue queue(temp_dir.path());
+  EXPECT_EQ(-1, queue.Drain());
+  EXPECT_FALSE(FileExists(temp_dir.path() + "/gone.dmp.retry"));
+}
+
+TEST(CrashdumpUploadQueueTest, DrainsInBackground) {
+  AutoTempDir temp_dir;
+  TestQueue queue(temp_dir.path());
+  ASSERT_TRUE(queue.Start());
+
+  WriteFile(temp_dir.path() + "/a.dmp");
+  queue.Poke();
+  for (int i = 0; i < 500 && queue.uploads().empty(); ++i)
+    usleep(10000);
+  queue.Stop();
+  ASSERT_EQ(1U, queue.uploads().size());
+  EXPECT_EQ(temp_dir.path() + "/a.dmp", queue.uploads()[0]);
+}
+
+}  // namespace google_breakpad
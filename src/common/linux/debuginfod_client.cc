@@ -0,0 +1,219 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// debuginfod_client.cc: Fetch debug files from debuginfod servers.
+//
+// See debuginfod_client.h for documentation.
+
+#include "common/linux/debuginfod_client.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include "common/linux/libcurl_wrapper.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Create the directory PATH and any of its parents that don't exist.
+// Return false if one can't be created.
+bool MakeDirectories(const string& path) {
+  for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+    string directory = path.substr(0, slash);
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+      fprintf(stderr, "Failed to create directory %s: %s\n",
+              directory.c_str(), strerror(errno));
+      return false;
+    }
+    if (slash == string::npos)
+      return true;
+  }
+}
+
+// Return true if BUILD_ID is a plausible build ID, safe to use in a path.
+bool IsBuildId(const string& build_id) {
+  if (build_id.empty())
+    return false;
+  for (char c : build_id) {
+    if (!isxdigit(static_cast<unsigned char>(c)))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+DebuginfodClient::DebuginfodClient(const std::vector<string>& server_urls,
+                                   const string& cache_directory)
+    : server_urls_(server_urls),
+      cache_directory_(cache_directory),
+      next_prefetch_(0),
+      download_count_(0) {
+}
+
+DebuginfodClient::~DebuginfodClient() {
+  Finish();
+}
+
+// static
+std::vector<string> DebuginfodClient::SplitServerURLs(const string& urls) {
+  std::vector<string> server_urls;
+  size_t start = urls.find_first_not_of(' ');
+  while (start != string::npos) {
+    size_t end = urls.find(' ', start);
+    server_urls.push_back(urls.substr(start, end - start));
+    start = urls.find_first_not_of(' ', end);
+  }
+  return server_urls;
+}
+
+void DebuginfodClient::Prefetch(const std::vector<string>& build_ids,
+                                int threads) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  prefetch_queue_.insert(prefetch_queue_.end(),
+                         build_ids.begin(), build_ids.end());
+  for (int i = 0; i < threads && static_cast<size_t>(i) < build_ids.size();
+       ++i) {
+    prefetch_threads_.push_back(
+        std::thread(&DebuginfodClient::PrefetchThread, this));
+  }
+}
+
+string DebuginfodClient::FetchDebugFile(const string& build_id) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::map<string, Fetch>::iterator fetch = fetches_.find(build_id);
+    if (fetch != fetches_.end()) {
+      fetch_finished_.wait(lock, [&]() { return fetch->second.done; });
+      return fetch->second.path;
+    }
+    fetches_[build_id];
+  }
+  const string path = FetchFromServers(build_id);
+  FinishFetch(build_id, path);
+  return path;
+}
+
+void DebuginfodClient::Finish() {
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    next_prefetch_ = prefetch_queue_.size();
+    threads.swap(prefetch_threads_);
+  }
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+}
+
+bool DebuginfodClient::Download(const string& url, const string& path) {
+  LibcurlWrapper curl;
+  if (!curl.Init())
+    return false;
+  // Debug files are large, and compress well.
+  curl.set_accept_encoding(true);
+  long status = 0;
+  string contents;
+  if (!curl.SendGetRequest(url, &status, NULL, &contents))
+    return false;
+  // A file: URL, as for a local mirror of a server, has no HTTP status.
+  if (status != 200 && !(status == 0 && url.compare(0, 7, "file://") == 0))
+    return false;
+  std::ofstream file(path.c_str(), std::ios::binary);
+  file.write(contents.data(), contents.size());
+  file.close();
+  return !file.fail();
+}
+
+string DebuginfodClient::FetchFromServers(const string& build_id) {
+  if (!IsBuildId(build_id))
+    return string();
+  const string directory = cache_directory_ + "/" + build_id;
+  const string path = directory + "/debuginfo";
+  if (access(path.c_str(), R_OK) == 0)
+    return path;
+  if (!MakeDirectories(directory))
+    return string();
+
+  for (const string& server_url : server_urls_) {
+    string url = server_url;
+    while (!url.empty() && url[url.size() - 1] == '/')
+      url.erase(url.size() - 1);
+    url += "/buildid/" + build_id + "/debuginfo";
+
+    // Download to a file of this fetch's own, and rename it into place, so
+    // that no other process sharing the cache sees it half-written.
+    int download;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      download = download_count_++;
+    }
+    const string temporary_path = path + ".tmp" + std::to_string(getpid()) +
+        "." + std::to_string(download);
+    if (Download(url, temporary_path) &&
+        rename(temporary_path.c_str(), path.c_str()) == 0) {
+      return path;
+    }
+    unlink(temporary_path.c_str());
+  }
+  fprintf(stderr, "No debuginfod server has the debug file for build ID %s\n",
+          build_id.c_str());
+  return string();
+}
+
+void DebuginfodClient::FinishFetch(const string& build_id,
+                                   const string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Fetch& fetch = fetches_[build_id];
+  fetch.done = true;
+  fetch.path = path;
+  fetch_finished_.notify_all();
+}
+
+void DebuginfodClient::PrefetchThread() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (next_prefetch_ < prefetch_queue_.size()) {
+    const string build_id = prefetch_queue_[next_prefetch_++];
+    if (fetches_.count(build_id))
+      continue;
+    fetches_[build_id];
+    lock.unlock();
+    const string path = FetchFromServers(build_id);
+    FinishFetch(build_id, path);
+    lock.lock();
+  }
+}
+
+}  // namespace google_breakpad
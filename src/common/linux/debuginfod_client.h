@@ -0,0 +1,125 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// debuginfod_client.h: Fetch debug files from debuginfod servers.
+//
+// A debuginfod server serves the debug file of each binary it knows, by the
+// binary's build ID, at <server>/buildid/<build id>/debuginfo. The files
+// fetched are kept in a local cache directory, laid out as debuginfod's own
+// client lays out its cache, so that each is only fetched once.
+
+#ifndef COMMON_LINUX_DEBUGINFOD_CLIENT_H__
+#define COMMON_LINUX_DEBUGINFOD_CLIENT_H__
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/linux/dump_symbols.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class DebuginfodClient : public DebugFileFetcher {
+ public:
+  // Fetch debug files from the servers at |server_urls|, trying each in
+  // turn, into |cache_directory|.
+  DebuginfodClient(const std::vector<string>& server_urls,
+                   const string& cache_directory);
+  virtual ~DebuginfodClient();
+
+  // Split |urls|, a space-separated list as in the DEBUGINFOD_URLS
+  // environment variable, into its server URLs.
+  static std::vector<string> SplitServerURLs(const string& urls);
+
+  // Start fetching the debug files for |build_ids|, in order, on up to
+  // |threads| threads of their own, and return at once. A later
+  // FetchDebugFile for one of them waits for its fetch to finish rather
+  // than starting another, so that the debug files of a batch of binaries
+  // download while the earlier binaries are dumped.
+  void Prefetch(const std::vector<string>& build_ids, int threads);
+
+  // Return the path of the debug file for |build_id| in the cache,
+  // fetching it first if it isn't there, or the empty string if no server
+  // has it.
+  string FetchDebugFile(const string& build_id);
+
+  // Drop the prefetches not yet started, and wait for those in progress to
+  // finish. A subclass that overrides Download must call this in its
+  // destructor.
+  void Finish();
+
+ protected:
+  // Download |url| to the file |path|. Return true on success. This uses
+  // libcurl, loaded when first needed; tests override it.
+  virtual bool Download(const string& url, const string& path);
+
+ private:
+  // Whether each build ID's debug file is being fetched, or has been.
+  struct Fetch {
+    Fetch() : done(false) { }
+    bool done;
+    // Once done, the path of the debug file, or empty if none was found.
+    string path;
+  };
+
+  // Fetch the debug file for |build_id| from the servers into the cache,
+  // if it isn't there already. Return its path, or the empty string.
+  string FetchFromServers(const string& build_id);
+
+  // Record that the fetch of |build_id|'s debug file has finished, with
+  // |path|, and wake the threads waiting for it.
+  void FinishFetch(const string& build_id, const string& path);
+
+  // The body of each prefetching thread.
+  void PrefetchThread();
+
+  const std::vector<string> server_urls_;
+  const string cache_directory_;
+
+  // Guards everything below.
+  std::mutex mutex_;
+  // Signalled whenever a fetch finishes.
+  std::condition_variable fetch_finished_;
+  // The fetches started, by build ID.
+  std::map<string, Fetch> fetches_;
+  // The build IDs to prefetch, and the index of the next to start.
+  std::vector<string> prefetch_queue_;
+  size_t next_prefetch_;
+  std::vector<std::thread> prefetch_threads_;
+  // A number to make temporary download files' names unique.
+  int download_count_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_LINUX_DEBUGINFOD_CLIENT_H__
@@ -0,0 +1,154 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// debuginfod_client_unittest.cc:
+// Unit tests for google_breakpad::DebuginfodClient.
+
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/linux/debuginfod_client.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::DebuginfodClient;
+using std::vector;
+
+namespace {
+
+// A DebuginfodClient whose servers are a map from URLs to contents.
+class FakeDebuginfodClient : public DebuginfodClient {
+ public:
+  FakeDebuginfodClient(const vector<string>& server_urls,
+                       const string& cache_directory,
+                       const std::map<string, string>& files)
+      : DebuginfodClient(server_urls, cache_directory),
+        files_(files),
+        downloads_(0) { }
+  ~FakeDebuginfodClient() { Finish(); }
+
+  int downloads() const { return downloads_; }
+
+ protected:
+  bool Download(const string& url, const string& path) {
+    ++downloads_;
+    std::map<string, string>::const_iterator file = files_.find(url);
+    if (file == files_.end())
+      return false;
+    std::ofstream stream(path.c_str());
+    stream << file->second;
+    return true;
+  }
+
+ private:
+  const std::map<string, string> files_;
+  std::atomic<int> downloads_;
+};
+
+string ReadContents(const string& path) {
+  std::ifstream stream(path.c_str());
+  std::stringstream contents;
+  contents << stream.rdbuf();
+  return contents.str();
+}
+
+TEST(DebuginfodClientTest, SplitServerURLs) {
+  vector<string> urls = DebuginfodClient::SplitServerURLs(
+      "  https://debuginfod.example.org/ http://mirror.example.com  ");
+  ASSERT_EQ(2U, urls.size());
+  EXPECT_EQ("https://debuginfod.example.org/", urls[0]);
+  EXPECT_EQ("http://mirror.example.com", urls[1]);
+  EXPECT_TRUE(DebuginfodClient::SplitServerURLs("").empty());
+}
+
+TEST(DebuginfodClientTest, FetchesEachFileOnce) {
+  AutoTempDir cache;
+  vector<string> servers;
+  servers.push_back("http://first/");
+  servers.push_back("http://second");
+  std::map<string, string> files;
+  files["http://second/buildid/0a1b2c/debuginfo"] = "debug file";
+  {
+    FakeDebuginfodClient client(servers, cache.path() + "/cache", files);
+    // The first server lacks the file, and the second has it.
+    string path = client.FetchDebugFile("0a1b2c");
+    EXPECT_EQ(cache.path() + "/cache/0a1b2c/debuginfo", path);
+    EXPECT_EQ("debug file", ReadContents(path));
+    EXPECT_EQ(2, client.downloads());
+    EXPECT_EQ(path, client.FetchDebugFile("0a1b2c"));
+    EXPECT_EQ(2, client.downloads());
+  }
+
+  // Another client finds it in the cache.
+  FakeDebuginfodClient client(servers, cache.path() + "/cache", files);
+  EXPECT_EQ(cache.path() + "/cache/0a1b2c/debuginfo",
+            client.FetchDebugFile("0a1b2c"));
+  EXPECT_EQ(0, client.downloads());
+}
+
+TEST(DebuginfodClientTest, Missing) {
+  AutoTempDir cache;
+  FakeDebuginfodClient client(vector<string>(1, "http://server"),
+                              cache.path(), std::map<string, string>());
+  EXPECT_EQ("", client.FetchDebugFile("0a1b2c"));
+  EXPECT_NE(0, access((cache.path() + "/0a1b2c/debuginfo").c_str(), F_OK));
+  // Nor is what isn't a build ID taken as part of a path.
+  EXPECT_EQ("", client.FetchDebugFile("../0a1b2c"));
+}
+
+TEST(DebuginfodClientTest, Prefetch) {
+  AutoTempDir cache;
+  std::map<string, string> files;
+  vector<string> build_ids;
+  for (int i = 0; i < 20; ++i) {
+    string build_id = "beef" + std::to_string(i);
+    build_ids.push_back(build_id);
+    files["http://server/buildid/" + build_id + "/debuginfo"] = build_id;
+  }
+  FakeDebuginfodClient client(vector<string>(1, "http://server"),
+                              cache.path(), files);
+  client.Prefetch(build_ids, 4);
+  // Fetching waits for the prefetch of the same file, rather than
+  // downloading it again.
+  for (const string& build_id : build_ids) {
+    string path = client.FetchDebugFile(build_id);
+    EXPECT_EQ(build_id, ReadContents(path));
+  }
+  EXPECT_EQ(20, client.downloads());
+}
+
+}  // namespace
@@ -48,18 +48,27 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "common/dwarf/bytereader-inl.h"
 #include "common/dwarf/dwarf2diehandler.h"
 #include "common/dwarf_cfi_to_module.h"
+#include "common/dwarf_cu_cache.h"
 #include "common/dwarf_cu_to_module.h"
 #include "common/dwarf_line_to_module.h"
 #include "common/dwarf_range_list_handler.h"
+#include "common/language.h"
+#include "common/linux/compressed_section.h"
 #include "common/linux/crc32.h"
 #include "common/linux/eintr_wrapper.h"
 #include "common/linux/elfutils.h"
@@ -88,6 +97,7 @@ using google_breakpad::ElfClass;
 using google_breakpad::ElfClass32;
 using google_breakpad::ElfClass64;
 using google_breakpad::FileID;
+using google_breakpad::FindElfSection;
 using google_breakpad::FindElfSectionByName;
 using google_breakpad::GetOffset;
 using google_breakpad::IsValidElf;
@@ -282,12 +292,686 @@ class DumperLineToModule: public DwarfCUToModule::LineToModuleHandler {
   google_breakpad::ByteReader* byte_reader_;
 };
 
+// Read the compilation unit at OFFSET in FILE_CONTEXT's .debug_info
+// section into FILE_CONTEXT's module, and return its length.  Its
+// abbreviation table is looked up in, or added to, ABBREV_CACHE, and its
+// split DWARF, if any, is read from SPLIT_DWARF_FILES.  If LINE_TO_MODULE
+// is NULL, the unit's line numbers aren't read.
+uint64_t LoadDwarfCompilationUnit(
+    DwarfCUToModule::FileContext* file_context,
+    const string& dwarf_filename,
+    google_breakpad::ByteReader* byte_reader,
+    DumperRangesHandler* ranges_handler,
+    DumperLineToModule* line_to_module,
+    google_breakpad::CompilationUnit::AbbrevCache* abbrev_cache,
+    google_breakpad::CompilationUnit::SplitDwarfFiles* split_dwarf_files,
+    bool handle_inline,
+    uint64_t offset) {
+  // Make a handler for the root DIE that populates the module with the
+  // data that was found.
+  DwarfCUToModule::WarningReporter reporter(dwarf_filename, offset);
+  DwarfCUToModule root_handler(file_context, line_to_module,
+                               ranges_handler, &reporter, handle_inline);
+  // Make a Dwarf2Handler that drives the DIEHandler.
+  google_breakpad::DIEDispatcher die_dispatcher(&root_handler);
+  // Make a DWARF parser for the compilation unit at OFFSET.
+  google_breakpad::CompilationUnit reader(dwarf_filename,
+                                       file_context->section_map(),
+                                       offset,
+                                       byte_reader,
+                                       &die_dispatcher);
+  reader.SetAbbrevCache(abbrev_cache);
+  reader.SetSplitDwarfFiles(split_dwarf_files);
+  // Process the entire compilation unit; get the offset of the next.
+  return reader.Start();
+}
+
+// A run of consecutive compilation units in .debug_info, read on its own
+// into a module of its own.
+struct DwarfCompilationUnits {
+  DwarfCompilationUnits(uint64_t begin_arg, uint64_t end_arg)
+      : begin(begin_arg), end(end_arg), cacheable(false), cached(false) {}
+
+  // The .debug_info offsets of the first unit and of the end of the last.
+  uint64_t begin, end;
+  std::unique_ptr<Module> module;
+  std::unique_ptr<DwarfCUToModule::FileContext> file_context;
+
+  // When units are cached, each run is a single unit: whether it has a
+  // key, the key, and whether its module was loaded from the cache
+  // rather than read.
+  bool cacheable;
+  string key;
+  bool cached;
+};
+
+// Divide the .debug_info section of LENGTH bytes at CONTENTS into runs of
+// whole compilation units of about TARGET_SIZE bytes each, found from the
+// units' headers alone, and add them to RUNS.  If a header is malformed,
+// the runs stop short of it; return the offset at which they stop.
+uint64_t SplitDwarfCompilationUnits(const uint8_t* contents,
+                                    uint64_t length,
+                                    google_breakpad::ByteReader* byte_reader,
+                                    uint64_t target_size,
+                                    std::vector<DwarfCompilationUnits>* runs) {
+  uint64_t run_begin = 0;
+  uint64_t offset = 0;
+  while (offset < length) {
+    if (length - offset < 4)
+      break;
+    size_t initial_length_size;
+    uint64_t unit_length =
+        byte_reader->ReadInitialLength(contents + offset,
+                                       &initial_length_size);
+    if (initial_length_size > length - offset ||
+        unit_length == 0 ||
+        unit_length > length - offset - initial_length_size) {
+      break;
+    }
+    offset += initial_length_size + unit_length;
+    if (offset - run_begin >= target_size) {
+      runs->push_back(DwarfCompilationUnits(run_begin, offset));
+      run_begin = offset;
+    }
+  }
+  if (offset > run_begin)
+    runs->push_back(DwarfCompilationUnits(run_begin, offset));
+  return offset;
+}
+
+// A Dwarf2Handler that notes the .dwo file each root DIE it is given
+// names, and nothing else.
+class DwoNameHandler: public google_breakpad::Dwarf2Handler {
+ public:
+  explicit DwoNameHandler(std::vector<string>* names) : names_(names) { }
+  bool StartCompilationUnit(uint64_t offset, uint8_t address_size,
+                            uint8_t offset_size, uint64_t cu_length,
+                            uint8_t dwarf_version) {
+    return true;
+  }
+  bool StartDIE(uint64_t offset, enum google_breakpad::DwarfTag tag) {
+    return true;
+  }
+  void ProcessAttributeString(uint64_t offset,
+                              enum google_breakpad::DwarfAttribute attr,
+                              enum google_breakpad::DwarfForm form,
+                              const string& data) {
+    if (attr == google_breakpad::DW_AT_dwo_name ||
+        attr == google_breakpad::DW_AT_GNU_dwo_name)
+      names_->push_back(data);
+  }
+ private:
+  std::vector<string>* names_;
+};
+
+// Open the .dwo files named by the skeleton compilation units in RUNS of
+// FILE_CONTEXT's .debug_info section in SPLIT_DWARF_FILES, on up to
+// THREADS threads, so that the units find their files mapped already
+// when they are read.  Only the units' root DIEs are read to list the
+// files.  If there is a .dwp file, the units are read from that instead,
+// and no .dwo file is opened.
+void OpenSplitDwarfFiles(
+    const DwarfCUToModule::FileContext& file_context,
+    const string& dwarf_filename,
+    google_breakpad::Endianness endianness,
+    const std::vector<DwarfCompilationUnits>& runs,
+    google_breakpad::CompilationUnit::AbbrevCache* abbrev_cache,
+    google_breakpad::CompilationUnit::SplitDwarfFiles* split_dwarf_files,
+    int threads) {
+  if (split_dwarf_files->HasDwp(dwarf_filename, endianness))
+    return;
+  std::vector<string> names;
+  DwoNameHandler handler(&names);
+  google_breakpad::ByteReader byte_reader(endianness);
+  for (const DwarfCompilationUnits& run : runs) {
+    for (uint64_t offset = run.begin; offset < run.end;) {
+      google_breakpad::CompilationUnit reader(dwarf_filename,
+                                           file_context.section_map(),
+                                           offset, &byte_reader, &handler);
+      reader.SetAbbrevCache(abbrev_cache);
+      reader.SetRootDIEOnly();
+      offset += reader.Start();
+    }
+  }
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+
+  std::atomic<size_t> next_name(0);
+  auto open_files = [&]() {
+    size_t i;
+    while ((i = next_name++) < names.size())
+      split_dwarf_files->OpenDwo(names[i]);
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads && static_cast<size_t>(i) < names.size(); ++i)
+    workers.push_back(std::thread(open_files));
+  open_files();
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+}
+
+// Read the compilation units in FILE_CONTEXT's .debug_info section into
+// its module on THREADS threads.  The section is divided into runs of
+// units, each read with its own FileContext into a Module of its own; the
+// runs' modules are then merged into FILE_CONTEXT's module in order.  A
+// run with a DIE that refers to a DIE outside it, which its own context
+// couldn't resolve, is read again instead, in order, with a context
+// holding what every run gathered, so that inter-CU references are
+// resolved as when the units are read one after another.  All the units
+// share the abbreviation tables in ABBREV_CACHE, the demangled names in
+// DEMANGLE_CACHE and the split DWARF files in SPLIT_DWARF_FILES.
+//
+// If READ_LINES is false, the units' line numbers aren't read.
+//
+// If CU_CACHE isn't NULL, each run is a single unit, whose functions are
+// loaded from CU_CACHE if they are there, and stored there once read if
+// the unit has no outside references.  Since a unit loaded from the
+// cache contributes nothing for other units to refer to, if any unit
+// does have outside references, the units loaded from the cache are
+// read after all.
+void LoadDwarfInParallel(DwarfCUToModule::FileContext* file_context,
+                         Module* module,
+                         const string& dwarf_filename,
+                         google_breakpad::Endianness endianness,
+                         google_breakpad::CompilationUnit::AbbrevCache*
+                             abbrev_cache,
+                         DwarfCUToModule::DemangleCache* demangle_cache,
+                         google_breakpad::CompilationUnit::SplitDwarfFiles*
+                             split_dwarf_files,
+                         google_breakpad::DwarfCUCache* cu_cache,
+                         bool handle_inter_cu_refs,
+                         bool handle_inline,
+                         bool read_lines,
+                         int threads) {
+  const std::pair<const uint8_t*, uint64_t>& debug_info_section =
+      file_context->section_map().find(".debug_info")->second;
+  uint64_t debug_info_length = debug_info_section.second;
+
+  // Make several runs per thread, so that threads that finish early have
+  // others to take on.
+  const int kRunsPerThread = 8;
+  google_breakpad::ByteReader scan_reader(endianness);
+  std::vector<DwarfCompilationUnits> runs;
+  uint64_t split_end = SplitDwarfCompilationUnits(
+      debug_info_section.first, debug_info_length, &scan_reader,
+      cu_cache ? 1 : std::max<uint64_t>(
+          1, debug_info_length / (threads * kRunsPerThread)),
+      &runs);
+
+  // Map the split DWARF files the units need ahead of reading them, so
+  // that runs don't wait on one another to open them.
+  OpenSplitDwarfFiles(*file_context, dwarf_filename, endianness, runs,
+                      abbrev_cache, split_dwarf_files, threads);
+
+  // The conversion options a cached unit's key covers.
+  const string conversion = string(handle_inter_cu_refs ? "r" : "") +
+                            (handle_inline ? "i" : "") +
+                            (read_lines ? "" : "n");
+
+  // Give RUN a module and context of its own.
+  auto start_run = [&](DwarfCompilationUnits* run) {
+    run->module.reset(new Module(module->name(), module->os(),
+                                 module->architecture(),
+                                 module->identifier(),
+                                 module->code_identifier()));
+    // Give inlines of the same function in different runs one origin.
+    run->module->inline_origin_map.ShareTableWith(module->inline_origin_map);
+    run->file_context.reset(new DwarfCUToModule::FileContext(
+        dwarf_filename, run->module.get(), handle_inter_cu_refs));
+    for (const auto& section : file_context->section_map()) {
+      run->file_context->AddSectionToSectionMap(
+          section.first, section.second.first, section.second.second);
+    }
+    run->file_context->TrackOutsideReferences(run->begin, run->end);
+    run->file_context->SetDemangleCache(demangle_cache);
+  };
+
+  std::atomic<size_t> next_run(0);
+  auto load_runs = [&]() {
+    google_breakpad::ByteReader byte_reader(endianness);
+    DumperRangesHandler ranges_handler(&byte_reader);
+    DumperLineToModule line_to_module(&byte_reader);
+    DumperLineToModule* lines = read_lines ? &line_to_module : NULL;
+    size_t i;
+    while ((i = next_run++) < runs.size()) {
+      DwarfCompilationUnits* run = &runs[i];
+      start_run(run);
+      if (cu_cache) {
+        run->cacheable = google_breakpad::DwarfCUCache::ComputeKey(
+            file_context->section_map(), run->begin, &byte_reader,
+            abbrev_cache, conversion, &run->key);
+        if (run->cacheable) {
+          Module::ScopedArena arena(run->module.get());
+          run->cached =
+              cu_cache->Load(run->key, run->begin, run->module.get());
+        }
+        if (run->cached)
+          continue;
+        // Start over in case part of an entry was loaded.
+        if (run->cacheable)
+          start_run(run);
+      }
+      Module::ScopedArena arena(run->module.get());
+      for (uint64_t offset = run->begin; offset < run->end;) {
+        offset += LoadDwarfCompilationUnit(
+            run->file_context.get(), dwarf_filename, &byte_reader,
+            &ranges_handler, lines, abbrev_cache,
+            split_dwarf_files, handle_inline, offset);
+      }
+      if (run->cacheable && !run->file_context->HasOutsideReferences())
+        cu_cache->Save(run->key, run->module.get());
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads && static_cast<size_t>(i) < runs.size(); ++i)
+    workers.push_back(std::thread(load_runs));
+  load_runs();
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+
+  // Read the units loaded from the cache after all if other units may
+  // refer to them.
+  bool outside_references = false;
+  for (const DwarfCompilationUnits& run : runs)
+    outside_references |= run.file_context->HasOutsideReferences();
+  if (outside_references) {
+    google_breakpad::ByteReader byte_reader(endianness);
+    DumperRangesHandler ranges_handler(&byte_reader);
+    DumperLineToModule line_to_module(&byte_reader);
+    DumperLineToModule* lines = read_lines ? &line_to_module : NULL;
+    for (DwarfCompilationUnits& run : runs) {
+      if (!run.cached)
+        continue;
+      start_run(&run);
+      Module::ScopedArena arena(run.module.get());
+      LoadDwarfCompilationUnit(run.file_context.get(), dwarf_filename,
+                               &byte_reader, &ranges_handler, lines,
+                               abbrev_cache, split_dwarf_files,
+                               handle_inline, run.begin);
+      run.cached = false;
+    }
+  }
+
+  // Merge the runs in order, reading those with outside references again.
+  for (const DwarfCompilationUnits& run : runs)
+    file_context->AddFileDataFrom(*run.file_context);
+  google_breakpad::ByteReader byte_reader(endianness);
+  DumperRangesHandler ranges_handler(&byte_reader);
+  DumperLineToModule line_to_module(&byte_reader);
+  DumperLineToModule* lines = read_lines ? &line_to_module : NULL;
+  for (DwarfCompilationUnits& run : runs) {
+    if (!run.file_context->HasOutsideReferences()) {
+      module->MergeFrom(run.module.get());
+      continue;
+    }
+    for (uint64_t offset = run.begin; offset < run.end;) {
+      offset += LoadDwarfCompilationUnit(
+          file_context, dwarf_filename, &byte_reader, &ranges_handler,
+          lines, abbrev_cache, split_dwarf_files, handle_inline, offset);
+    }
+  }
+
+  // Whatever follows a malformed header is read as it would be serially.
+  for (uint64_t offset = split_end; offset < debug_info_length;) {
+    offset += LoadDwarfCompilationUnit(
+        file_context, dwarf_filename, &byte_reader, &ranges_handler,
+        lines, abbrev_cache, split_dwarf_files, handle_inline, offset);
+  }
+}
+
+// An SHF_COMPRESSED section LoadDwarf reads, and its contents once
+// decompressed.
+struct CompressedSection {
+  string name;
+  const uint8_t* contents;
+  uint64_t size;
+  std::unique_ptr<uint8_t[]> uncompressed;
+  uint64_t uncompressed_size;
+};
+
+// Return true if NAME is a section the DWARF reader uses, and so is
+// worth decompressing.
+bool IsDwarfReaderSection(const string& name) {
+  static const char* const kSections[] = {
+    ".debug_abbrev", ".debug_addr", ".debug_info", ".debug_line",
+    ".debug_line_str", ".debug_names", ".debug_ranges", ".debug_rnglists",
+    ".debug_str", ".debug_str_offsets"
+  };
+  for (const char* section : kSections) {
+    if (name == section)
+      return true;
+  }
+  return false;
+}
+
+// Decompress the compressed sections in SECTIONS, from a 64-bit ELF file
+// if ELF64 is true, on up to THREADS threads.  A zlib or zstd stream can
+// only be inflated from its start, so the sections, rather than pieces of
+// them, are shared out among the threads; .debug_info is usually the
+// largest, and is taken first.  Leave a section's uncompressed member
+// null if it couldn't be decompressed.
+void DecompressSections(const string& dwarf_filename, bool elf64,
+                        int threads,
+                        std::vector<CompressedSection>* sections) {
+  std::stable_sort(sections->begin(), sections->end(),
+                   [](const CompressedSection& a, const CompressedSection& b) {
+                     return a.size > b.size;
+                   });
+  std::atomic<size_t> next_section(0);
+  auto decompress = [&]() {
+    size_t i;
+    while ((i = next_section++) < sections->size()) {
+      CompressedSection& section = (*sections)[i];
+      if (!google_breakpad::DecompressSection(elf64, section.contents,
+                                              section.size,
+                                              &section.uncompressed,
+                                              &section.uncompressed_size)) {
+        fprintf(stderr, "%s: failed to decompress section %s\n",
+                dwarf_filename.c_str(), section.name.c_str());
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads && static_cast<size_t>(i) < sections->size();
+       ++i) {
+    workers.push_back(std::thread(decompress));
+  }
+  decompress();
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+}
+
+// A Dwarf2Handler for a compilation unit read with
+// CompilationUnit::SetDIEOffsets, given only its root DIE and the
+// function DIEs an index lists, that notes the unit's and the functions'
+// addresses and nothing else.
+class IndexedFunctionHandler: public google_breakpad::Dwarf2Handler {
+ public:
+  // The address attributes of a function DIE.
+  struct Function {
+    Function()
+        : low_pc(0), high_pc(0),
+          high_pc_form(google_breakpad::DW_FORM_addr),
+          ranges_form(google_breakpad::DW_FORM_sec_offset), ranges_data(0) { }
+    uint64_t low_pc, high_pc;
+    enum google_breakpad::DwarfForm high_pc_form;
+    enum google_breakpad::DwarfForm ranges_form;
+    uint64_t ranges_data;
+  };
+
+  IndexedFunctionHandler()
+      : version(0), low_pc(0), ranges_base(0), addr_base(0),
+        language(google_breakpad::DW_LANG_C_plus_plus), split(false),
+        root_(true), current_(NULL) { }
+
+  bool StartCompilationUnit(uint64_t offset, uint8_t address_size,
+                            uint8_t offset_size, uint64_t cu_length,
+                            uint8_t dwarf_version) {
+    version = dwarf_version;
+    return true;
+  }
+  bool StartDIE(uint64_t offset, enum google_breakpad::DwarfTag tag) {
+    current_ = NULL;
+    if (root_) {
+      root_ = false;
+      return true;
+    }
+    if (tag != google_breakpad::DW_TAG_subprogram)
+      return false;
+    current_ = &functions[offset];
+    return true;
+  }
+  void ProcessAttributeUnsigned(uint64_t offset,
+                                enum google_breakpad::DwarfAttribute attr,
+                                enum google_breakpad::DwarfForm form,
+                                uint64_t data) {
+    if (current_) {
+      switch (attr) {
+        case google_breakpad::DW_AT_low_pc:
+          current_->low_pc = data;
+          break;
+        case google_breakpad::DW_AT_high_pc:
+          current_->high_pc = data;
+          current_->high_pc_form = form;
+          break;
+        case google_breakpad::DW_AT_ranges:
+          current_->ranges_data = data;
+          current_->ranges_form = form;
+          break;
+        default:
+          break;
+      }
+      return;
+    }
+    switch (attr) {
+      case google_breakpad::DW_AT_low_pc:
+        low_pc = data;
+        break;
+      case google_breakpad::DW_AT_rnglists_base:
+        ranges_base = data;
+        break;
+      case google_breakpad::DW_AT_addr_base:
+      case google_breakpad::DW_AT_GNU_addr_base:
+        addr_base = data;
+        break;
+      case google_breakpad::DW_AT_language:
+        language = static_cast<google_breakpad::DwarfLanguage>(data);
+        break;
+      default:
+        break;
+    }
+  }
+  void ProcessAttributeString(uint64_t offset,
+                              enum google_breakpad::DwarfAttribute attr,
+                              enum google_breakpad::DwarfForm form,
+                              const string& data) {
+    if (!current_ && (attr == google_breakpad::DW_AT_dwo_name ||
+                      attr == google_breakpad::DW_AT_GNU_dwo_name))
+      split = true;
+  }
+
+  // What the root DIE gave: the unit's DWARF version, base address,
+  // range list and address table bases, and language, and whether the
+  // unit is the skeleton of a split DWARF unit.
+  uint8_t version;
+  uint64_t low_pc, ranges_base, addr_base;
+  google_breakpad::DwarfLanguage language;
+  bool split;
+
+  // The function DIEs read, by offset.
+  std::map<uint64_t, Function> functions;
+
+ private:
+  bool root_;
+  Function* current_;
+};
+
+// Return the Language a compilation unit in LANGUAGE is read as; see
+// DwarfCUToModule::SetLanguage.
+const google_breakpad::Language* IndexedUnitLanguage(
+    google_breakpad::DwarfLanguage language) {
+  switch (language) {
+    case google_breakpad::DW_LANG_Java:
+      return google_breakpad::Language::Java;
+    case google_breakpad::DW_LANG_Swift:
+      return google_breakpad::Language::Swift;
+    case google_breakpad::DW_LANG_Rust:
+      return google_breakpad::Language::Rust;
+    case google_breakpad::DW_LANG_Mips_Assembler:
+      return google_breakpad::Language::Assembler;
+    default:
+      return google_breakpad::Language::CPlusPlus;
+  }
+}
+
+// Read into MODULE the functions of the compilation units FILE_CONTEXT's
+// .debug_names section indexes, finding their DIEs through the index
+// rather than by walking every unit, and naming each by the index's
+// names for it: a linkage name, demangled, if it has one, or else its
+// plain name.  Only the units' root DIEs and the function DIEs themselves
+// are read, and no line numbers.  Add the offsets of the units read to
+// INDEXED_UNITS; the skeletons of split DWARF units are left out, to be
+// read in full.  Return false, reading nothing, if there is no index or
+// it can't be read.
+bool LoadIndexedFunctions(const DwarfCUToModule::FileContext& file_context,
+                          const string& dwarf_filename,
+                          google_breakpad::ByteReader* byte_reader,
+                          Module* module,
+                          std::set<uint64_t>* indexed_units) {
+  const google_breakpad::SectionMap& section_map = file_context.section_map();
+  google_breakpad::SectionMap::const_iterator names =
+      section_map.find(".debug_names");
+  google_breakpad::SectionMap::const_iterator strings =
+      section_map.find(".debug_str");
+  if (names == section_map.end() || strings == section_map.end())
+    return false;
+  google_breakpad::NameIndexReader index(names->second.first,
+                                         names->second.second,
+                                         strings->second.first,
+                                         strings->second.second,
+                                         byte_reader);
+  std::vector<google_breakpad::NameIndexReader::Entry> entries;
+  std::vector<uint64_t> units;
+  if (!index.ReadEntries(&entries, &units)) {
+    fprintf(stderr, "%s: malformed .debug_names section; reading every "
+            "compilation unit\n", dwarf_filename.c_str());
+    return false;
+  }
+  if (units.empty())
+    return false;
+
+  // The names the index gives each function DIE, by unit.
+  std::map<uint64_t, std::map<uint64_t, std::vector<const char*>>>
+      unit_functions;
+  for (const google_breakpad::NameIndexReader::Entry& entry : entries) {
+    if (entry.tag == google_breakpad::DW_TAG_subprogram)
+      unit_functions[entry.unit_offset][entry.die_offset].push_back(
+          entry.name);
+  }
+
+  google_breakpad::CompilationUnit::AbbrevCache abbrev_cache;
+  DumperRangesHandler ranges_handler(byte_reader);
+  std::sort(units.begin(), units.end());
+  units.erase(std::unique(units.begin(), units.end()), units.end());
+  for (uint64_t unit : units) {
+    const std::map<uint64_t, std::vector<const char*>>& functions =
+        unit_functions[unit];
+    std::vector<uint64_t> offsets;
+    for (const auto& function : functions)
+      offsets.push_back(function.first);
+
+    IndexedFunctionHandler handler;
+    google_breakpad::CompilationUnit reader(dwarf_filename, section_map,
+                                         unit, byte_reader, &handler);
+    reader.SetAbbrevCache(&abbrev_cache);
+    reader.SetDIEOffsets(&offsets);
+    reader.Start();
+    if (handler.split)
+      continue;
+    indexed_units->insert(unit);
+
+    const google_breakpad::Language* language =
+        IndexedUnitLanguage(handler.language);
+    if (!language->HasFunctions())
+      continue;
+
+    // Find the unit's range lists as DwarfCUToModule would.
+    google_breakpad::RangeListReader::CURangesInfo cu_info;
+    bool have_ranges = false;
+    google_breakpad::SectionMap::const_iterator ranges_section =
+        section_map.find(handler.version <= 4 ? ".debug_ranges"
+                                              : ".debug_rnglists");
+    if (ranges_section != section_map.end()) {
+      cu_info.version_ = handler.version;
+      cu_info.base_address_ = handler.low_pc;
+      cu_info.ranges_base_ = handler.ranges_base;
+      cu_info.buffer_ = ranges_section->second.first;
+      cu_info.size_ = ranges_section->second.second;
+      have_ranges = true;
+      if (handler.version > 4) {
+        google_breakpad::SectionMap::const_iterator addr_section =
+            section_map.find(".debug_addr");
+        if (addr_section != section_map.end()) {
+          cu_info.addr_buffer_ = addr_section->second.first;
+          cu_info.addr_buffer_size_ = addr_section->second.second;
+          cu_info.addr_base_ = handler.addr_base;
+        } else {
+          have_ranges = false;
+        }
+      }
+    }
+
+    for (const auto& function : handler.functions) {
+      const IndexedFunctionHandler::Function& attributes = function.second;
+      vector<Module::Range> ranges;
+      if (!attributes.ranges_data) {
+        uint64_t high_pc = attributes.high_pc;
+        // Make high_pc an address, if it isn't already.
+        switch (attributes.high_pc_form) {
+          case google_breakpad::DW_FORM_addr:
+          case google_breakpad::DW_FORM_GNU_addr_index:
+          case google_breakpad::DW_FORM_addrx:
+          case google_breakpad::DW_FORM_addrx1:
+          case google_breakpad::DW_FORM_addrx2:
+          case google_breakpad::DW_FORM_addrx3:
+          case google_breakpad::DW_FORM_addrx4:
+            break;
+          default:
+            high_pc += attributes.low_pc;
+            break;
+        }
+        ranges.push_back(Module::Range(attributes.low_pc,
+                                       high_pc - attributes.low_pc));
+      } else if (have_ranges) {
+        if (!ranges_handler.ReadRanges(attributes.ranges_form,
+                                       attributes.ranges_data, &cu_info,
+                                       &ranges)) {
+          ranges.clear();
+        }
+      }
+      // Skip functions that cover no bytes, or that start at address
+      // zero, which DwarfCUToModule also treats as empty debug data.
+      uint64_t size = 0;
+      for (const Module::Range& range : ranges)
+        size += range.size;
+      if (size == 0 || ranges.front().address == 0)
+        continue;
+
+      // Prefer a name that demangles, as a linkage name does.
+      const std::vector<const char*>& candidates =
+          functions.find(function.first)->second;
+      string name = candidates.front();
+      for (const char* candidate : candidates) {
+        string demangled;
+        if (language->DemangleName(candidate, &demangled) ==
+                google_breakpad::Language::kDemangleSuccess) {
+          name = demangled;
+          break;
+        }
+      }
+      if (name.empty())
+        name = "<name omitted>";
+
+      Module::Function* func =
+          new Module::Function(module->AddStringToPool(name),
+                               ranges.front().address);
+      func->ranges = ranges;
+      if (!module->AddFunction(func))
+        delete func;
+    }
+  }
+  return true;
+}
+
 template<typename ElfClass>
 bool LoadDwarf(const string& dwarf_filename,
                const typename ElfClass::Ehdr* elf_header,
                const bool big_endian,
                bool handle_inter_cu_refs,
                bool handle_inline,
+               bool functions_only,
+               int threads,
+               const string& cu_cache_directory,
                Module* module) {
   typedef typename ElfClass::Shdr Shdr;
 
@@ -295,16 +979,22 @@ bool LoadDwarf(const string& dwarf_filename,
       google_breakpad::ENDIANNESS_BIG : google_breakpad::ENDIANNESS_LITTLE;
   google_breakpad::ByteReader byte_reader(endianness);
 
+  // Allocate the functions and inlines read in bulk.
+  Module::ScopedArena arena(module);
+
   // Construct a context for this file.
   DwarfCUToModule::FileContext file_context(dwarf_filename,
                                             module,
                                             handle_inter_cu_refs);
 
-  // Build a map of the ELF file's sections.
+  // Build a map of the ELF file's sections.  Compressed sections are
+  // decompressed into buffers that last until the units have been read,
+  // and only if the DWARF reader uses them.
   const Shdr* sections =
       GetOffset<ElfClass, Shdr>(elf_header, elf_header->e_shoff);
   int num_sections = elf_header->e_shnum;
   const Shdr* section_names = sections + elf_header->e_shstrndx;
+  std::vector<CompressedSection> compressed_sections;
   for (int i = 0; i < num_sections; i++) {
     const Shdr* section = &sections[i];
     string name = GetOffset<ElfClass, char>(elf_header,
@@ -312,39 +1002,93 @@ bool LoadDwarf(const string& dwarf_filename,
                   section->sh_name;
     const uint8_t* contents = GetOffset<ElfClass, uint8_t>(elf_header,
                                                            section->sh_offset);
+    if (section->sh_flags & SHF_COMPRESSED) {
+      if (IsDwarfReaderSection(name)) {
+        compressed_sections.push_back(
+            CompressedSection{name, contents, section->sh_size, NULL, 0});
+      }
+      continue;
+    }
     file_context.AddSectionToSectionMap(name, contents, section->sh_size);
   }
+  DecompressSections(dwarf_filename, ElfClass::kClass == ELFCLASS64, threads,
+                     &compressed_sections);
+  for (const CompressedSection& section : compressed_sections) {
+    if (section.uncompressed) {
+      file_context.AddSectionToSectionMap(section.name,
+                                          section.uncompressed.get(),
+                                          section.uncompressed_size);
+    }
+  }
 
   // .debug_ranges and .debug_rnglists reader
   DumperRangesHandler ranges_handler(&byte_reader);
 
-  // Parse all the compilation units in the .debug_info section.
+  // Parse all the compilation units in the .debug_info section, decoding
+  // each abbreviation table they use and demangling each linkage name they
+  // give only once.
   DumperLineToModule line_to_module(&byte_reader);
+  google_breakpad::CompilationUnit::AbbrevCache abbrev_cache;
+  DwarfCUToModule::DemangleCache demangle_cache;
+  file_context.SetDemangleCache(&demangle_cache);
+  // Open each .dwo or .dwp file the units refer to only once.
+  google_breakpad::CompilationUnit::SplitDwarfFiles split_dwarf_files;
   google_breakpad::SectionMap::const_iterator debug_info_entry =
       file_context.section_map().find(".debug_info");
-  assert(debug_info_entry != file_context.section_map().end());
+  // Without .debug_info, which may have failed to decompress, there is
+  // nothing to read.
+  if (debug_info_entry == file_context.section_map().end())
+    return false;
   const std::pair<const uint8_t*, uint64_t>& debug_info_section =
       debug_info_entry->second;
   // This should never have been called if the file doesn't have a
   // .debug_info section.
   assert(debug_info_section.first);
   uint64_t debug_info_length = debug_info_section.second;
+  DumperLineToModule* lines = functions_only ? NULL : &line_to_module;
+  // With only functions wanted, read those of the units .debug_names
+  // indexes through the index, and walk only the units it doesn't cover.
+  std::set<uint64_t> indexed_units;
+  if (functions_only &&
+      LoadIndexedFunctions(file_context, dwarf_filename, &byte_reader,
+                           module, &indexed_units)) {
+    std::vector<DwarfCompilationUnits> units;
+    uint64_t split_end = SplitDwarfCompilationUnits(
+        debug_info_section.first, debug_info_length, &byte_reader, 1,
+        &units);
+    for (const DwarfCompilationUnits& unit : units) {
+      if (indexed_units.find(unit.begin) == indexed_units.end()) {
+        LoadDwarfCompilationUnit(&file_context, dwarf_filename,
+                                 &byte_reader, &ranges_handler, lines,
+                                 &abbrev_cache, &split_dwarf_files,
+                                 handle_inline, unit.begin);
+      }
+    }
+    for (uint64_t offset = split_end; offset < debug_info_length;) {
+      offset += LoadDwarfCompilationUnit(&file_context, dwarf_filename,
+                                         &byte_reader, &ranges_handler,
+                                         lines, &abbrev_cache,
+                                         &split_dwarf_files,
+                                         handle_inline, offset);
+    }
+    return true;
+  }
+  if (threads > 1 || !cu_cache_directory.empty()) {
+    std::unique_ptr<google_breakpad::DwarfCUCache> cu_cache;
+    if (!cu_cache_directory.empty())
+      cu_cache.reset(new google_breakpad::DwarfCUCache(cu_cache_directory));
+    LoadDwarfInParallel(&file_context, module, dwarf_filename, endianness,
+                        &abbrev_cache, &demangle_cache, &split_dwarf_files,
+                        cu_cache.get(), handle_inter_cu_refs, handle_inline,
+                        !functions_only, threads);
+    return true;
+  }
   for (uint64_t offset = 0; offset < debug_info_length;) {
-    // Make a handler for the root DIE that populates MODULE with the
-    // data that was found.
-    DwarfCUToModule::WarningReporter reporter(dwarf_filename, offset);
-    DwarfCUToModule root_handler(&file_context, &line_to_module,
-                                 &ranges_handler, &reporter, handle_inline);
-    // Make a Dwarf2Handler that drives the DIEHandler.
-    google_breakpad::DIEDispatcher die_dispatcher(&root_handler);
-    // Make a DWARF parser for the compilation unit at OFFSET.
-    google_breakpad::CompilationUnit reader(dwarf_filename,
-                                         file_context.section_map(),
-                                         offset,
-                                         &byte_reader,
-                                         &die_dispatcher);
-    // Process the entire compilation unit; get the offset of the next.
-    offset += reader.Start();
+    offset += LoadDwarfCompilationUnit(&file_context, dwarf_filename,
+                                       &byte_reader, &ranges_handler,
+                                       lines, &abbrev_cache,
+                                       &split_dwarf_files,
+                                       handle_inline, offset);
   }
   return true;
 }
@@ -378,6 +1122,82 @@ bool DwarfCFIRegisterNames(const typename ElfClass::Ehdr* elf_header,
   }
 }
 
+// Convert the call frame information in the CFI_SIZE bytes at CFI to
+// stack frame entries in MODULE on THREADS threads.  The section's entries
+// are divided into runs, each parsed on a worker thread with its own
+// ByteReader, set up by INIT_BYTE_READER, and its own handler, producing
+// the stack frame entries of a Module of its own.  The runs' entries are
+// then appended to MODULE in section order, as a single parser would have
+// added them.
+void LoadDwarfCFIInParallel(
+    const string& dwarf_filename,
+    const char* section_name,
+    const uint8_t* cfi,
+    size_t cfi_size,
+    bool eh_frame,
+    google_breakpad::Endianness endianness,
+    const std::function<void(google_breakpad::ByteReader*)>& init_byte_reader,
+    const std::vector<string>& register_names,
+    int threads,
+    Module* module) {
+  // Find where the entries start, to divide them into runs of about equal
+  // size; make several runs per thread, so that threads that finish early
+  // have others to take on.
+  const int kRunsPerThread = 8;
+  std::vector<size_t> entry_offsets;
+  {
+    google_breakpad::ByteReader byte_reader(endianness);
+    init_byte_reader(&byte_reader);
+    google_breakpad::CallFrameInfo parser(cfi, cfi_size, &byte_reader,
+                                       NULL, NULL, eh_frame);
+    parser.GetEntryOffsets(&entry_offsets);
+  }
+  size_t target_size =
+      std::max<size_t>(1, cfi_size / (threads * kRunsPerThread));
+  std::vector<std::pair<size_t, size_t>> runs;
+  size_t run_begin = 0;
+  for (size_t offset : entry_offsets) {
+    if (offset - run_begin >= target_size) {
+      runs.push_back(std::make_pair(run_begin, offset));
+      run_begin = offset;
+    }
+  }
+  runs.push_back(std::make_pair(run_begin, cfi_size));
+
+  std::vector<std::unique_ptr<Module>> run_modules(runs.size());
+  std::atomic<size_t> next_run(0);
+  auto load_runs = [&]() {
+    size_t i;
+    while ((i = next_run++) < runs.size()) {
+      run_modules[i].reset(new Module(module->name(), module->os(),
+                                      module->architecture(),
+                                      module->identifier(),
+                                      module->code_identifier()));
+      DwarfCFIToModule::Reporter module_reporter(dwarf_filename,
+                                                 section_name);
+      DwarfCFIToModule handler(run_modules[i].get(), register_names,
+                               &module_reporter);
+      google_breakpad::ByteReader byte_reader(endianness);
+      init_byte_reader(&byte_reader);
+      google_breakpad::CallFrameInfo::Reporter dwarf_reporter(dwarf_filename,
+                                                           section_name);
+      google_breakpad::CallFrameInfo parser(cfi, cfi_size, &byte_reader,
+                                         &handler, &dwarf_reporter,
+                                         eh_frame);
+      parser.Start(runs[i].first, runs[i].second);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads && static_cast<size_t>(i) < runs.size(); ++i)
+    workers.push_back(std::thread(load_runs));
+  load_runs();
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+
+  for (const std::unique_ptr<Module>& run_module : run_modules)
+    module->MergeFrom(run_module.get());
+}
+
 template<typename ElfClass>
 bool LoadDwarfCFI(const string& dwarf_filename,
                   const typename ElfClass::Ehdr* elf_header,
@@ -387,6 +1207,7 @@ bool LoadDwarfCFI(const string& dwarf_filename,
                   const typename ElfClass::Shdr* got_section,
                   const typename ElfClass::Shdr* text_section,
                   const bool big_endian,
+                  int threads,
                   Module* module) {
   // Find the appropriate set of register names for this file's
   // architecture.
@@ -401,25 +1222,48 @@ bool LoadDwarfCFI(const string& dwarf_filename,
   const google_breakpad::Endianness endianness = big_endian ?
       google_breakpad::ENDIANNESS_BIG : google_breakpad::ENDIANNESS_LITTLE;
 
-  // Find the call frame information and its size.
+  // Find the call frame information and its size, decompressing it if
+  // need be.
   const uint8_t* cfi =
       GetOffset<ElfClass, uint8_t>(elf_header, section->sh_offset);
   size_t cfi_size = section->sh_size;
+  std::unique_ptr<uint8_t[]> uncompressed_cfi;
+  if (section->sh_flags & SHF_COMPRESSED) {
+    uint64_t uncompressed_size;
+    if (!google_breakpad::DecompressSection(ElfClass::kClass == ELFCLASS64,
+                                            cfi, cfi_size, &uncompressed_cfi,
+                                            &uncompressed_size)) {
+      fprintf(stderr, "%s: failed to decompress section %s\n",
+              dwarf_filename.c_str(), section_name);
+      return false;
+    }
+    cfi = uncompressed_cfi.get();
+    cfi_size = uncompressed_size;
+  }
+
+  // Set up a ByteReader for the section, providing the base addresses for
+  // .eh_frame encoded pointers, if possible.
+  auto init_byte_reader = [&](google_breakpad::ByteReader* byte_reader) {
+    byte_reader->SetAddressSize(ElfClass::kAddrSize);
+    byte_reader->SetCFIDataBase(section->sh_addr, cfi);
+    if (got_section)
+      byte_reader->SetDataBase(got_section->sh_addr);
+    if (text_section)
+      byte_reader->SetTextBase(text_section->sh_addr);
+  };
+
+  if (threads > 1) {
+    LoadDwarfCFIInParallel(dwarf_filename, section_name, cfi, cfi_size,
+                           eh_frame, endianness, init_byte_reader,
+                           register_names, threads, module);
+    return true;
+  }
 
   // Plug together the parser, handler, and their entourages.
   DwarfCFIToModule::Reporter module_reporter(dwarf_filename, section_name);
   DwarfCFIToModule handler(module, register_names, &module_reporter);
   google_breakpad::ByteReader byte_reader(endianness);
-
-  byte_reader.SetAddressSize(ElfClass::kAddrSize);
-
-  // Provide the base addresses for .eh_frame encoded pointers, if
-  // possible.
-  byte_reader.SetCFIDataBase(section->sh_addr, cfi);
-  if (got_section)
-    byte_reader.SetDataBase(got_section->sh_addr);
-  if (text_section)
-    byte_reader.SetTextBase(text_section->sh_addr);
+  init_byte_reader(&byte_reader);
 
   google_breakpad::CallFrameInfo::Reporter dwarf_reporter(dwarf_filename,
                                                        section_name);
@@ -707,7 +1551,41 @@ bool LoadSymbols(const string& obj_file,
     }
 #endif  // NO_STABS_SUPPORT
 
-    // See if there are export symbols available.
+    // Look for DWARF debugging information, and load it if present.
+    const Shdr* dwarf_section =
+      FindElfSectionByName<ElfClass>(".debug_info", SHT_PROGBITS,
+                                     sections, names, names_end,
+                                     elf_header->e_shnum);
+
+    // .debug_info section type is SHT_PROGBITS for mips on pnacl toolchains,
+    // but MIPS_DWARF for regular gnu toolchains, so both need to be checked
+    if (elf_header->e_machine == EM_MIPS && !dwarf_section) {
+      dwarf_section =
+        FindElfSectionByName<ElfClass>(".debug_info", SHT_MIPS_DWARF,
+                                       sections, names, names_end,
+                                       elf_header->e_shnum);
+    }
+
+    if (dwarf_section) {
+      found_debug_info_section = true;
+      found_usable_info = true;
+      info->LoadedSection(".debug_info");
+      if (!LoadDwarf<ElfClass>(obj_file, elf_header, big_endian,
+                               options.handle_inter_cu_refs,
+                               (options.symbol_data & INLINES) &&
+                                   !options.functions_only,
+                               options.functions_only,
+                               options.dwarf_threads,
+                               options.cu_cache_directory, module)) {
+        fprintf(stderr, "%s: \".debug_info\" section found, but failed to load "
+                "DWARF debugging information\n", obj_file.c_str());
+      }
+    }
+
+    // See if there are export symbols available.  Read them after the
+    // debugging information, so that those at the start of a function it
+    // describes are left out as they are added, rather than being added
+    // and then removed again.
     const Shdr* symtab_section =
         FindElfSectionByName<ElfClass>(".symtab", SHT_SYMTAB,
                                        sections, names, names_end,
@@ -764,35 +1642,6 @@ bool LoadSymbols(const string& obj_file,
         found_usable_info = found_usable_info || result;
       }
     }
-
-    // Only Load .debug_info after loading symbol table to avoid duplicate
-    // PUBLIC records.
-    // Look for DWARF debugging information, and load it if present.
-    const Shdr* dwarf_section =
-      FindElfSectionByName<ElfClass>(".debug_info", SHT_PROGBITS,
-                                     sections, names, names_end,
-                                     elf_header->e_shnum);
-
-    // .debug_info section type is SHT_PROGBITS for mips on pnacl toolchains,
-    // but MIPS_DWARF for regular gnu toolchains, so both need to be checked
-    if (elf_header->e_machine == EM_MIPS && !dwarf_section) {
-      dwarf_section =
-        FindElfSectionByName<ElfClass>(".debug_info", SHT_MIPS_DWARF,
-                                       sections, names, names_end,
-                                       elf_header->e_shnum);
-    }
-
-    if (dwarf_section) {
-      found_debug_info_section = true;
-      found_usable_info = true;
-      info->LoadedSection(".debug_info");
-      if (!LoadDwarf<ElfClass>(obj_file, elf_header, big_endian,
-                               options.handle_inter_cu_refs,
-                               options.symbol_data & INLINES, module)) {
-        fprintf(stderr, "%s: \".debug_info\" section found, but failed to load "
-                "DWARF debugging information\n", obj_file.c_str());
-      }
-    }
   }
 
   if (options.symbol_data & CFI) {
@@ -820,7 +1669,7 @@ bool LoadSymbols(const string& obj_file,
       bool result =
           LoadDwarfCFI<ElfClass>(obj_file, elf_header, ".debug_frame",
                                  dwarf_cfi_section, false, 0, 0, big_endian,
-                                 module);
+                                 options.dwarf_threads, module);
       found_usable_info = found_usable_info || result;
     }
 
@@ -846,7 +1695,8 @@ bool LoadSymbols(const string& obj_file,
       bool result =
           LoadDwarfCFI<ElfClass>(obj_file, elf_header, ".eh_frame",
                                  eh_frame_section, true,
-                                 got_section, text_section, big_endian, module);
+                                 got_section, text_section, big_endian,
+                                 options.dwarf_threads, module);
       found_usable_info = found_usable_info || result;
     }
   }
@@ -986,6 +1836,30 @@ bool InitModuleForElfClass(const typename ElfClass::Ehdr* elf_header,
   return true;
 }
 
+// Return true if the ELF file mapped at ELF_BASE has debugging information
+// of its own: a ".debug_info" or ".stab" section.
+bool HasDebugInfo(const void* elf_base) {
+  const void* section;
+  size_t section_size;
+  return FindElfSection(elf_base, ".debug_info", SHT_PROGBITS,
+                        &section, &section_size) ||
+         FindElfSection(elf_base, ".stab", SHT_PROGBITS,
+                        &section, &section_size);
+}
+
+// If the ELF file mapped at ELF_BASE has a build ID, set *BUILD_ID to it,
+// in lowercase hex, as debuginfod servers expect, and return true.
+bool ElfBuildId(const void* elf_base, string* build_id) {
+  PageAllocator allocator;
+  wasteful_vector<uint8_t> identifier(&allocator, kDefaultBuildIdSize);
+  if (!FileID::ElfBuildIdFromMappedFile(elf_base, identifier))
+    return false;
+  *build_id = FileID::ConvertIdentifierToString(identifier);
+  std::transform(build_id->begin(), build_id->end(), build_id->begin(),
+                 ::tolower);
+  return true;
+}
+
 template<typename ElfClass>
 bool ReadSymbolDataElfClass(const typename ElfClass::Ehdr* elf_header,
                             const string& obj_filename,
@@ -1002,6 +1876,7 @@ bool ReadSymbolDataElfClass(const typename ElfClass::Ehdr* elf_header,
                                        module)) {
     return false;
   }
+  module->SetMaxFunctionsInMemory(options.max_functions_in_memory);
 
   // Figure out what endianness this file is.
   bool big_endian;
@@ -1009,12 +1884,21 @@ bool ReadSymbolDataElfClass(const typename ElfClass::Ehdr* elf_header,
     return false;
 
   LoadSymbolsInfo<ElfClass> info(debug_dirs);
-  if (!LoadSymbols<ElfClass>(obj_filename, big_endian, elf_header,
-                             !debug_dirs.empty(), &info,
-                             options, module.get())) {
-    const string debuglink_file = info.debuglink_file();
-    if (debuglink_file.empty())
-      return false;
+  const bool loaded = LoadSymbols<ElfClass>(obj_filename, big_endian,
+                                            elf_header, !debug_dirs.empty(),
+                                            &info, options, module.get());
+  string debuglink_file = loaded ? string() : info.debuglink_file();
+
+  // If the debug directories don't hold the file's debug file, fetch it by
+  // the file's build ID, if it has one. This is tried even when the file's
+  // symbol table and CFI have been read, as they were all there was.
+  string build_id;
+  if (debuglink_file.empty() && options.debug_file_fetcher &&
+      !HasDebugInfo(elf_header) && ElfBuildId(elf_header, &build_id)) {
+    debuglink_file = options.debug_file_fetcher->FetchDebugFile(build_id);
+  }
+
+  if (!debuglink_file.empty()) {
 
     // Load debuglink ELF file.
     fprintf(stderr, "Found debugging info in %s\n", debuglink_file.c_str());
@@ -1034,6 +1918,8 @@ bool ReadSymbolDataElfClass(const typename ElfClass::Ehdr* elf_header,
                                options, module.get())) {
       return false;
     }
+  } else if (!loaded) {
+    return false;
   }
 
   *out_module = module.release();
@@ -1082,7 +1968,8 @@ bool WriteSymbolFile(const string& load_path,
                       &module))
     return false;
 
-  bool result = module->Write(sym_stream, options.symbol_data);
+  bool result = module->Write(sym_stream, options.symbol_data,
+                              options.dwarf_threads);
   delete module;
   return result;
 }
@@ -1130,6 +2017,15 @@ bool WriteSymbolFileHeader(const string& load_path,
   return module->Write(sym_stream, ALL_SYMBOL_DATA);
 }
 
+bool NeedsDebugFile(const string& path, string* build_id) {
+  MmapWrapper map_wrapper;
+  void* elf_header = NULL;
+  return LoadELF(path, &map_wrapper, &elf_header) &&
+      IsValidElf(elf_header) &&
+      !HasDebugInfo(elf_header) &&
+      ElfBuildId(elf_header, build_id);
+}
+
 bool ReadSymbolData(const string& load_path,
                     const string& obj_file,
                     const string& obj_os,
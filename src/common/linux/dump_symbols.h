@@ -46,16 +46,55 @@ namespace google_breakpad {
 
 class Module;
 
+// A source of debug files, looked up by build ID, for binaries whose debug
+// files aren't found in their debug directories. See DebuginfodClient.
+class DebugFileFetcher {
+ public:
+  virtual ~DebugFileFetcher() {}
+
+  // Return the path of a local copy of the debug file for the binary whose
+  // build ID is |build_id|, in lowercase hex, or the empty string if there
+  // is none to be had. May be called on several threads at once.
+  virtual string FetchDebugFile(const string& build_id) = 0;
+};
+
 struct DumpOptions {
   DumpOptions(SymbolData symbol_data, bool handle_inter_cu_refs)
       : symbol_data(symbol_data),
-        handle_inter_cu_refs(handle_inter_cu_refs) {
+        handle_inter_cu_refs(handle_inter_cu_refs),
+        functions_only(false),
+        dwarf_threads(1),
+        max_functions_in_memory(0),
+        debug_file_fetcher(NULL) {
   }
 
   SymbolData symbol_data;
   bool handle_inter_cu_refs;
+  // If true, read no line numbers or inlines from DWARF, only functions,
+  // finding them through a .debug_names index where there is one rather
+  // than by walking every compilation unit.
+  bool functions_only;
+  // The number of threads on which to read DWARF compilation units and
+  // call frame information, and to format the symbol file.
+  int dwarf_threads;
+  // If non-zero, the most functions whose lines and inlines are kept in
+  // memory; see Module::SetMaxFunctionsInMemory.
+  size_t max_functions_in_memory;
+  // If not empty, a directory in which to cache the functions read from
+  // DWARF compilation units; see DwarfCUCache.
+  string cu_cache_directory;
+  // If not NULL, where to fetch the debug file of a binary that has no
+  // debugging information of its own, when none is found in the debug
+  // directories. (WEAK)
+  DebugFileFetcher* debug_file_fetcher;
 };
 
+// If the ELF file at PATH has no debugging information of its own, so that
+// a debug file would be fetched for it, set *BUILD_ID to its build ID, in
+// lowercase hex, and return true. Otherwise, return false. This lets
+// callers fetch the debug files of many binaries ahead of dumping them.
+bool NeedsDebugFile(const string& path, string* build_id);
+
 // Find all the debugging information in OBJ_FILE, an ELF executable
 // or shared library, and write it to SYM_STREAM in the Breakpad symbol
 // file format.
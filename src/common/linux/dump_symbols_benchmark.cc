@@ -0,0 +1,616 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dump_symbols_benchmark.cc: Timings of dump_syms's phases on a large
+// synthesized ELF file.
+//
+// Usage: dump_symbols_benchmark [-c <units>] [-f <functions>]
+//                               [-d <depth>] [-j <threads,...>] [-r <runs>]
+//
+// The input is an x86_64 ELF file with <units> DWARF compilation units
+// (1000 by default) of <functions> functions each (16), every other one
+// with inlined calls nested <depth> deep (4), a line program row for each
+// four bytes of code, a .debug_frame FDE for each function and a .symtab
+// entry for each function.
+//
+// These are timed separately, each on every thread count given to -j
+// (1,2,4,8 by default) that it supports:
+//
+//   LoadDwarf            reading .debug_info and .debug_line into a Module
+//   LoadDwarfCFI         reading .debug_frame into a Module
+//   ELFSymbolsToModule   reading .symtab into a Module
+//   Module::Write        writing the complete Module as a symbol file
+//
+// Each is run <runs> times (3) in a process of its own, and the fastest
+// run is printed with its speedup over one thread and the process's peak
+// resident set size, which includes the synthesized input and, for
+// Module::Write, the Module being written.
+
+#include <assert.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "common/dwarf/cfi_assembler.h"
+#include "common/dwarf/dwarf2enums.h"
+#include "common/dwarf/dwarf2reader_test_common.h"
+#include "common/linux/dump_symbols.h"
+#include "common/linux/elf_symbols_to_module.h"
+#include "common/linux/eintr_wrapper.h"
+#include "common/linux/synth_elf.h"
+#include "common/module.h"
+#include "common/test_assembler.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+bool ReadSymbolDataInternal(const uint8_t* obj_file,
+                            const string& obj_filename,
+                            const string& obj_os,
+                            const std::vector<string>& debug_dir,
+                            const DumpOptions& options,
+                            Module** module);
+
+}  // namespace google_breakpad
+
+namespace {
+
+using google_breakpad::CFISection;
+using google_breakpad::DumpOptions;
+using google_breakpad::Module;
+using google_breakpad::synth_elf::ELF;
+using google_breakpad::synth_elf::StringTable;
+using google_breakpad::synth_elf::SymbolTable;
+using google_breakpad::test_assembler::kLittleEndian;
+using google_breakpad::test_assembler::Label;
+using google_breakpad::test_assembler::Section;
+
+const uint64_t kTextAddress = 0x10000;
+const uint64_t kFunctionSize = 0x80;
+
+struct Parameters {
+  int units;
+  int functions;
+  int depth;
+  std::vector<int> threads;
+  int runs;
+};
+
+// The sections of the synthesized ELF file.
+struct Sections {
+  Section abbrev;
+  Section info;
+  Section line;
+  CFISection frame;
+  string symtab;
+  string strtab;
+
+  Sections()
+      : abbrev(kLittleEndian), info(kLittleEndian), line(kLittleEndian),
+        frame(kLittleEndian, 8) {}
+};
+
+enum Abbreviation {
+  kCompileUnit = 1,
+  kFunction,
+  kInlineOrigin,
+  kFunctionWithInlines,
+  kInlinedCall
+};
+
+void WriteAbbrevTable(TestAbbrevTable* abbrev) {
+  using namespace google_breakpad;
+  abbrev->Abbrev(kCompileUnit, DW_TAG_compile_unit, DW_children_yes)
+      .Attribute(DW_AT_name, DW_FORM_string)
+      .Attribute(DW_AT_language, DW_FORM_data1)
+      .Attribute(DW_AT_low_pc, DW_FORM_addr)
+      .Attribute(DW_AT_high_pc, DW_FORM_data4)
+      .Attribute(DW_AT_stmt_list, DW_FORM_sec_offset)
+      .EndAbbrev()
+      .Abbrev(kFunction, DW_TAG_subprogram, DW_children_no)
+      .Attribute(DW_AT_name, DW_FORM_string)
+      .Attribute(DW_AT_low_pc, DW_FORM_addr)
+      .Attribute(DW_AT_high_pc, DW_FORM_data4)
+      .EndAbbrev()
+      .Abbrev(kInlineOrigin, DW_TAG_subprogram, DW_children_no)
+      .Attribute(DW_AT_name, DW_FORM_string)
+      .Attribute(DW_AT_inline, DW_FORM_data1)
+      .EndAbbrev()
+      .Abbrev(kFunctionWithInlines, DW_TAG_subprogram, DW_children_yes)
+      .Attribute(DW_AT_name, DW_FORM_string)
+      .Attribute(DW_AT_low_pc, DW_FORM_addr)
+      .Attribute(DW_AT_high_pc, DW_FORM_data4)
+      .EndAbbrev()
+      .Abbrev(kInlinedCall, DW_TAG_inlined_subroutine, DW_children_yes)
+      .Attribute(DW_AT_abstract_origin, DW_FORM_ref4)
+      .Attribute(DW_AT_low_pc, DW_FORM_addr)
+      .Attribute(DW_AT_high_pc, DW_FORM_data4)
+      .Attribute(DW_AT_call_file, DW_FORM_data1)
+      .Attribute(DW_AT_call_line, DW_FORM_data2)
+      .EndAbbrev()
+      .EndTable();
+}
+
+// Appends a DWARF 4 line program for compilation unit |unit| to |line|,
+// with a row for each four bytes of its |size| bytes of code at |address|.
+void WriteLineProgram(int unit, uint64_t address, uint64_t size,
+                      Section* line) {
+  using namespace google_breakpad;
+  const int kLineBase = -5;
+  const int kLineRange = 14;
+  const int kOpcodeBase = 13;
+  static const uint8_t kStandardOpcodeLengths[kOpcodeBase - 1] =
+      { 0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1 };
+
+  Label unit_length, unit_start, header_length, header_start, program_start,
+      unit_end;
+  line->D32(unit_length).Mark(&unit_start)
+      .D16(4)
+      .D32(header_length).Mark(&header_start)
+      .D8(1)                       // minimum_instruction_length
+      .D8(1)                       // maximum_operations_per_instruction
+      .D8(1)                       // default_is_stmt
+      .D8(static_cast<uint8_t>(kLineBase))
+      .D8(kLineRange)
+      .D8(kOpcodeBase);
+  for (int i = 0; i < kOpcodeBase - 1; ++i)
+    line->D8(kStandardOpcodeLengths[i]);
+  line->D8(0);                     // no include_directories
+  char file_name[32];
+  snprintf(file_name, sizeof(file_name), "unit%d.cc", unit);
+  line->AppendCString(file_name).ULEB128(0).ULEB128(0).ULEB128(0)
+      .D8(0)                       // end of file_names
+      .Mark(&program_start);
+
+  line->D8(0).ULEB128(9).D8(DW_LNE_set_address).D64(address);
+  // Each row is four bytes and a line on from the last.
+  const uint8_t kNextRow = (1 - kLineBase) + kLineRange * 4 + kOpcodeBase;
+  for (uint64_t offset = 0; offset < size; offset += 4)
+    line->D8(kNextRow);
+  line->D8(DW_LNS_advance_pc).ULEB128(4)
+      .D8(0).ULEB128(1).D8(DW_LNE_end_sequence)
+      .Mark(&unit_end);
+
+  unit_length = unit_end - unit_start;
+  header_length = program_start - header_start;
+}
+
+// Appends |depth| inlined calls, each nested in the last, within the
+// function at |address|.
+void WriteInlinedCalls(const std::vector<uint64_t>& origins,
+                       uint64_t address, int depth, TestCompilationUnit* cu) {
+  for (int i = 0; i < depth; ++i) {
+    uint64_t margin = 4 * (i + 1);
+    cu->ULEB128(kInlinedCall)
+        .D32(origins[i])
+        .D64(address + margin)
+        .D32(kFunctionSize - 2 * margin)
+        .D8(1)
+        .D16(10 + i);
+  }
+  for (int i = 0; i < depth; ++i)
+    cu->D8(0);
+}
+
+void Synthesize(const Parameters& parameters, Sections* sections) {
+  using namespace google_breakpad;
+  TestAbbrevTable abbrev;
+  WriteAbbrevTable(&abbrev);
+  string contents;
+  abbrev.GetContents(&contents);
+  sections->abbrev.Append(contents);
+
+  Label cie;
+  sections->frame.Mark(&cie)
+      .CIEHeader(1, -8, 16, 1, "")
+      .D8(DW_CFA_def_cfa).ULEB128(7).ULEB128(8)
+      .D8(DW_CFA_offset | 16).ULEB128(1)
+      .FinishEntry();
+
+  StringTable strtab(kLittleEndian);
+  SymbolTable symtab(kLittleEndian, 8, strtab);
+
+  const uint64_t unit_size = parameters.functions * kFunctionSize;
+  string line_contents;
+  for (int unit = 0; unit < parameters.units; ++unit) {
+    uint64_t unit_address = kTextAddress + unit * unit_size;
+    char name[64];
+
+    // Each unit gets a line program of its own.
+    uint64_t line_offset = line_contents.size();
+    Section line(kLittleEndian);
+    line.start() = 0;
+    WriteLineProgram(unit, unit_address, unit_size, &line);
+    line.GetContents(&contents);
+    line_contents += contents;
+
+    TestCompilationUnit cu;
+    cu.set_format_size(4);
+    cu.set_endianness(kLittleEndian);
+    cu.Header(4, Label(0), 8, DW_UT_compile);
+    snprintf(name, sizeof(name), "unit%d.cc", unit);
+    cu.ULEB128(kCompileUnit)
+        .AppendCString(name)
+        .D8(DW_LANG_C_plus_plus)
+        .D64(unit_address)
+        .D32(unit_size)
+        .D32(line_offset);
+
+    // The functions the unit's inlined calls are to.
+    std::vector<uint64_t> origins;
+    for (int i = 0; i < parameters.depth; ++i) {
+      origins.push_back(cu.Size());
+      snprintf(name, sizeof(name), "unit%d_inline%d", unit, i);
+      cu.ULEB128(kInlineOrigin).AppendCString(name).D8(DW_INL_inlined);
+    }
+
+    for (int function = 0; function < parameters.functions; ++function) {
+      uint64_t address = unit_address + function * kFunctionSize;
+      snprintf(name, sizeof(name), "unit%d_function%d", unit, function);
+      bool with_inlines = parameters.depth > 0 && function % 2;
+      cu.ULEB128(with_inlines ? kFunctionWithInlines : kFunction)
+          .AppendCString(name)
+          .D64(address)
+          .D32(kFunctionSize);
+      if (with_inlines) {
+        WriteInlinedCalls(origins, address, parameters.depth, &cu);
+        cu.D8(0);
+      }
+
+      sections->frame.FDEHeader(cie, address, kFunctionSize)
+          .D8(DW_CFA_advance_loc | 1)
+          .D8(DW_CFA_def_cfa_offset).ULEB128(16)
+          .D8(DW_CFA_offset | 6).ULEB128(2)
+          .D8(DW_CFA_advance_loc | 3)
+          .D8(DW_CFA_def_cfa_register).ULEB128(6)
+          .FinishEntry();
+
+      symtab.AddSymbol(name, address, kFunctionSize,
+                       ELF32_ST_INFO(STB_GLOBAL, STT_FUNC), 1);
+    }
+    cu.D8(0);
+    cu.Finish();
+    cu.GetContents(&contents);
+    sections->info.Append(contents);
+  }
+  sections->line.Append(line_contents);
+  symtab.GetContents(&sections->symtab);
+  strtab.GetContents(&sections->strtab);
+}
+
+// Returns the contents of an ELF file with the given debugging sections.
+std::vector<uint8_t> MakeElf(const Sections& sections, bool dwarf, bool cfi,
+                             bool symbols) {
+  ELF elf(EM_X86_64, ELFCLASS64, kLittleEndian);
+  Section text(kLittleEndian);
+  text.Append(4096, 0);
+  elf.AddSection(".text", text, SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR,
+                 kTextAddress);
+  if (dwarf) {
+    elf.AddSection(".debug_abbrev", sections.abbrev, SHT_PROGBITS);
+    elf.AddSection(".debug_info", sections.info, SHT_PROGBITS);
+    elf.AddSection(".debug_line", sections.line, SHT_PROGBITS);
+  }
+  if (cfi)
+    elf.AddSection(".debug_frame", sections.frame, SHT_PROGBITS);
+  if (symbols) {
+    Section strtab(kLittleEndian), symtab(kLittleEndian);
+    strtab.Append(sections.strtab);
+    symtab.Append(sections.symtab);
+    int strtab_index = elf.AddSection(".strtab", strtab, SHT_STRTAB);
+    elf.AddSection(".symtab", symtab, SHT_SYMTAB, 0, 0, strtab_index,
+                   sizeof(Elf64_Sym));
+  }
+  elf.Finish();
+  string contents;
+  elf.GetContents(&contents);
+  return std::vector<uint8_t>(contents.begin(), contents.end());
+}
+
+// A stream buffer that counts what is written to it, and keeps none of it.
+class CountingStreamBuffer : public std::streambuf {
+ public:
+  CountingStreamBuffer() : count_(0) {}
+  size_t count() const { return count_; }
+
+ protected:
+  int overflow(int c) {
+    ++count_;
+    return c == EOF ? 0 : c;
+  }
+  std::streamsize xsputn(const char*, std::streamsize n) {
+    count_ += n;
+    return n;
+  }
+
+ private:
+  size_t count_;
+};
+
+enum Phase {
+  LOAD_DWARF,
+  LOAD_DWARF_CFI,
+  ELF_SYMBOLS_TO_MODULE,
+  MODULE_WRITE
+};
+
+const char* const kPhaseNames[] = {
+  "LoadDwarf", "LoadDwarfCFI", "ELFSymbolsToModule", "Module::Write"
+};
+
+Module* ReadModule(const std::vector<uint8_t>& elf, SymbolData symbol_data,
+                   int threads) {
+  DumpOptions options(symbol_data, true);
+  options.dwarf_threads = threads;
+  Module* module = NULL;
+  if (!google_breakpad::ReadSymbolDataInternal(
+          &elf[0], "synthesized", "Linux", std::vector<string>(), options,
+          &module)) {
+    return NULL;
+  }
+  return module;
+}
+
+// Runs |phase| once on |threads| threads, returning the seconds it took,
+// or a negative number if it failed.
+double RunPhase(Phase phase, const Sections& sections,
+                const std::vector<uint8_t>& elf, int threads) {
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  bool ok = false;
+  switch (phase) {
+    case LOAD_DWARF:
+    case LOAD_DWARF_CFI: {
+      SymbolData data = phase == LOAD_DWARF ?
+          static_cast<SymbolData>(SYMBOLS_AND_FILES | INLINES) : CFI;
+      Module* module = ReadModule(elf, data, threads);
+      // Freeing the module isn't part of the phase.
+      double seconds =
+          std::chrono::duration<double>(Clock::now() - start).count();
+      ok = module != NULL;
+      delete module;
+      return ok ? seconds : -1;
+    }
+    case ELF_SYMBOLS_TO_MODULE: {
+      Module module("synthesized", "Linux", "x86_64", "id");
+      ok = google_breakpad::ELFSymbolsToModule(
+          reinterpret_cast<const uint8_t*>(sections.symtab.data()),
+          sections.symtab.size(),
+          reinterpret_cast<const uint8_t*>(sections.strtab.data()),
+          sections.strtab.size(), false, 8, &module);
+      break;
+    }
+    case MODULE_WRITE: {
+      Module* module = ReadModule(elf, ALL_SYMBOL_DATA, 1);
+      if (!module)
+        break;
+      CountingStreamBuffer buffer;
+      std::ostream stream(&buffer);
+      start = Clock::now();
+      ok = module->Write(stream, ALL_SYMBOL_DATA, threads);
+      double seconds =
+          std::chrono::duration<double>(Clock::now() - start).count();
+      delete module;
+      return ok ? seconds : -1;
+    }
+  }
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return ok ? seconds : -1;
+}
+
+// Runs |phase| |runs| times in a child process, setting |*seconds| to the
+// fastest run and |*peak_rss_kb| to the child's peak resident set size.
+bool MeasurePhase(Phase phase, const Sections& sections,
+                  const std::vector<uint8_t>& elf, int threads, int runs,
+                  double* seconds, long* peak_rss_kb) {
+  int fds[2];
+  if (pipe(fds) != 0)
+    return false;
+  pid_t child = fork();
+  if (child < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (child == 0) {
+    close(fds[0]);
+    // Reading a file without .debug_info reports that it has none.
+    if (phase == LOAD_DWARF_CFI) {
+      int null_fd = open("/dev/null", O_WRONLY);
+      if (null_fd >= 0) {
+        dup2(null_fd, STDERR_FILENO);
+        close(null_fd);
+      }
+    }
+    double best = -1;
+    for (int i = 0; i < runs; ++i) {
+      double run = RunPhase(phase, sections, elf, threads);
+      if (run < 0) {
+        best = -1;
+        break;
+      }
+      if (best < 0 || run < best)
+        best = run;
+    }
+    ssize_t written = write(fds[1], &best, sizeof(best));
+    _exit(written == sizeof(best) ? 0 : 1);
+  }
+
+  close(fds[1]);
+  double best = -1;
+  ssize_t n = HANDLE_EINTR(read(fds[0], &best, sizeof(best)));
+  close(fds[0]);
+  int status;
+  struct rusage usage;
+  if (HANDLE_EINTR(wait4(child, &status, 0, &usage)) != child)
+    return false;
+  if (n != sizeof(best) || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+      best < 0) {
+    return false;
+  }
+  *seconds = best;
+  *peak_rss_kb = usage.ru_maxrss;
+  return true;
+}
+
+bool ParseThreadCounts(const char* list, std::vector<int>* threads) {
+  threads->clear();
+  const char* p = list;
+  while (*p) {
+    char* end;
+    long count = strtol(p, &end, 10);
+    if (end == p || count < 1 || (*end != ',' && *end != '\0'))
+      return false;
+    threads->push_back(static_cast<int>(count));
+    p = *end ? end + 1 : end;
+  }
+  return !threads->empty();
+}
+
+void Usage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [-c <units>] [-f <functions>] [-d <depth>]\n"
+          "          [-j <threads,...>] [-r <runs>]\n",
+          program);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Parameters parameters;
+  parameters.units = 1000;
+  parameters.functions = 16;
+  parameters.depth = 4;
+  parameters.threads.push_back(1);
+  parameters.threads.push_back(2);
+  parameters.threads.push_back(4);
+  parameters.threads.push_back(8);
+  parameters.runs = 3;
+
+  int ch;
+  while ((ch = getopt(argc, argv, "c:d:f:j:r:")) != -1) {
+    bool valid = true;
+    switch (ch) {
+      case 'c':
+        parameters.units = atoi(optarg);
+        valid = parameters.units > 0;
+        break;
+      case 'd':
+        parameters.depth = atoi(optarg);
+        valid = parameters.depth >= 0 && parameters.depth < 64;
+        break;
+      case 'f':
+        parameters.functions = atoi(optarg);
+        valid = parameters.functions > 0;
+        break;
+      case 'j':
+        valid = ParseThreadCounts(optarg, &parameters.threads);
+        break;
+      case 'r':
+        parameters.runs = atoi(optarg);
+        valid = parameters.runs > 0;
+        break;
+      default:
+        valid = false;
+        break;
+    }
+    if (!valid) {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  if (optind != argc) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  Sections sections;
+  Synthesize(parameters, &sections);
+  std::vector<uint8_t> dwarf_elf = MakeElf(sections, true, false, false);
+  std::vector<uint8_t> cfi_elf = MakeElf(sections, false, true, false);
+  std::vector<uint8_t> full_elf = MakeElf(sections, true, true, true);
+  printf("%d units, %d functions, %zu bytes of .debug_info, "
+         "%zu of .debug_line, %zu of .debug_frame\n",
+         parameters.units, parameters.units * parameters.functions,
+         static_cast<size_t>(sections.info.Size()),
+         static_cast<size_t>(sections.line.Size()),
+         static_cast<size_t>(sections.frame.Size()));
+  printf("%-20s %8s %12s %8s %12s\n",
+         "phase", "threads", "ms", "speedup", "peak_rss_mb");
+  fflush(stdout);
+
+  bool all_ran = true;
+  const Phase kPhases[] = {
+    LOAD_DWARF, LOAD_DWARF_CFI, ELF_SYMBOLS_TO_MODULE, MODULE_WRITE
+  };
+  for (size_t i = 0; i < sizeof(kPhases) / sizeof(kPhases[0]); ++i) {
+    Phase phase = kPhases[i];
+    const std::vector<uint8_t>& elf = phase == LOAD_DWARF ? dwarf_elf :
+        phase == LOAD_DWARF_CFI ? cfi_elf : full_elf;
+    double single_thread = -1;
+    for (size_t j = 0; j < parameters.threads.size(); ++j) {
+      int threads = parameters.threads[j];
+      // ELFSymbolsToModule always runs on one thread.
+      if (phase == ELF_SYMBOLS_TO_MODULE && j > 0)
+        break;
+      double seconds;
+      long peak_rss_kb;
+      if (!MeasurePhase(phase, sections, elf, threads, parameters.runs,
+                        &seconds, &peak_rss_kb)) {
+        printf("%-20s %8d FAILED\n", kPhaseNames[phase], threads);
+        all_ran = false;
+        continue;
+      }
+      if (threads == 1)
+        single_thread = seconds;
+      if (single_thread > 0) {
+        printf("%-20s %8d %12.1f %7.2fx %12.1f\n", kPhaseNames[phase],
+               threads, seconds * 1000, single_thread / seconds,
+               peak_rss_kb / 1024.0);
+      } else {
+        printf("%-20s %8d %12.1f %8s %12.1f\n", kPhaseNames[phase],
+               threads, seconds * 1000, "-", peak_rss_kb / 1024.0);
+      }
+      fflush(stdout);
+    }
+  }
+  return all_ran ? 0 : 1;
+}
@@ -34,8 +34,11 @@
 
 #include <stddef.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 namespace google_breakpad {
 
 // Implementation of ElfCoreDump::Note.
@@ -96,10 +99,11 @@ size_t ElfCoreDump::Note::AlignedSize(size_t size) {
 
 // Implementation of ElfCoreDump.
 
-ElfCoreDump::ElfCoreDump() : proc_mem_fd_(-1) {}
+ElfCoreDump::ElfCoreDump()
+    : load_segments_indexed_(false), proc_mem_fd_(-1) {}
 
 ElfCoreDump::ElfCoreDump(const MemoryRange& content)
-    : content_(content), proc_mem_fd_(-1) {}
+    : content_(content), load_segments_indexed_(false), proc_mem_fd_(-1) {}
 
 ElfCoreDump::~ElfCoreDump() {
   if (proc_mem_fd_ != -1) {
@@ -110,6 +114,8 @@ ElfCoreDump::~ElfCoreDump() {
 
 void ElfCoreDump::SetContent(const MemoryRange& content) {
   content_ = content;
+  load_segments_.clear();
+  load_segments_indexed_ = false;
 }
 
 void ElfCoreDump::SetProcMem(int fd) {
@@ -160,23 +166,65 @@ unsigned ElfCoreDump::GetProgramHeaderCount() const {
   return header ? header->e_phnum : 0;
 }
 
-bool ElfCoreDump::CopyData(void* buffer, Addr virtual_address, size_t length) {
+void ElfCoreDump::IndexLoadSegments() {
+  if (load_segments_indexed_)
+    return;
+  load_segments_indexed_ = true;
+
   for (unsigned i = 0, n = GetProgramHeaderCount(); i < n; ++i) {
     const Phdr* program = GetProgramHeader(i);
-    if (program->p_type != PT_LOAD)
-      continue;
-
-    size_t offset_in_segment = virtual_address - program->p_vaddr;
-    if (virtual_address >= program->p_vaddr &&
-        offset_in_segment < program->p_filesz) {
-      const void* data =
-          content_.GetData(program->p_offset + offset_in_segment, length);
-      if (data) {
-        memcpy(buffer, data, length);
-        return true;
-      }
+    if (program && program->p_type == PT_LOAD && program->p_filesz) {
+      LoadSegment segment = {
+        program->p_vaddr, program->p_filesz, program->p_offset
+      };
+      load_segments_.push_back(segment);
     }
   }
+  std::stable_sort(load_segments_.begin(), load_segments_.end());
+}
+
+bool ElfCoreDump::CopyData(void* buffer, Addr virtual_address, size_t length) {
+  // Reads of at least this many bytes, typically whole stacks, ask the
+  // kernel to read the pages ahead of the copy.
+  const size_t kReadAheadSize = 64 * 1024;
+
+  IndexLoadSegments();
+
+  uint8_t* destination = reinterpret_cast<uint8_t*>(buffer);
+  Addr address = virtual_address;
+  size_t remaining = length;
+  while (remaining) {
+    LoadSegment key = { address, 0, 0 };
+    std::vector<LoadSegment>::const_iterator segment =
+        std::upper_bound(load_segments_.begin(), load_segments_.end(), key);
+    if (segment == load_segments_.begin())
+      break;
+    --segment;
+
+    const Addr offset_in_segment = address - segment->virtual_address;
+    if (offset_in_segment >= segment->file_size)
+      break;
+    const size_t chunk = static_cast<size_t>(std::min<Addr>(
+        remaining, segment->file_size - offset_in_segment));
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(content_.GetData(
+        segment->file_offset + offset_in_segment, chunk));
+    if (!data)
+      break;
+
+    if (chunk >= kReadAheadSize) {
+      const uintptr_t page_mask = getpagesize() - 1;
+      const uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~page_mask;
+      madvise(reinterpret_cast<void*>(start),
+              reinterpret_cast<uintptr_t>(data) + chunk - start,
+              MADV_WILLNEED);
+    }
+    memcpy(destination, data, chunk);
+    destination += chunk;
+    address += chunk;
+    remaining -= chunk;
+  }
+  if (!remaining)
+    return true;
 
   /* fallback: if available, read from /proc/<pid>/mem */
   if (proc_mem_fd_ != -1) {
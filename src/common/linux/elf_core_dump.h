@@ -38,6 +38,8 @@
 #include <link.h>
 #include <stddef.h>
 
+#include <vector>
+
 #include "common/memory_range.h"
 
 namespace google_breakpad {
@@ -133,8 +135,9 @@ class ElfCoreDump {
 
   // Copies |length| bytes of data starting at |virtual_address| in the core
   // dump to |buffer|. |buffer| should be a valid pointer to a buffer of at
-  // least |length| bytes. Returns true if the data to be copied is found in
-  // the core dump, or false otherwise.
+  // least |length| bytes. The data may span adjacent PT_LOAD segments.
+  // Returns true if the data to be copied is found in the core dump, or
+  // false otherwise.
   bool CopyData(void* buffer, Addr virtual_address, size_t length);
 
   // Returns the first note found in the note section of the core dump, or
@@ -145,9 +148,29 @@ class ElfCoreDump {
   void SetProcMem(const int fd);
 
  private:
+  // The part of a PT_LOAD segment's memory present in the core dump.
+  struct LoadSegment {
+    Addr virtual_address;
+    Addr file_size;
+    Addr file_offset;
+
+    bool operator<(const LoadSegment& other) const {
+      return virtual_address < other.virtual_address;
+    }
+  };
+
+  // Fills |load_segments_| from the program headers, unless that has been
+  // done since the content was last set.
+  void IndexLoadSegments();
+
   // Core dump content.
   MemoryRange content_;
 
+  // The PT_LOAD segments of |content_|, sorted by address, so that CopyData
+  // needn't scan every program header of a core with thousands of them.
+  std::vector<LoadSegment> load_segments_;
+  bool load_segments_indexed_;
+
   // Descriptor for /proc/<pid>/mem.
   int proc_mem_fd_;
 };
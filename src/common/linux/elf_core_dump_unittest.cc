@@ -127,6 +127,49 @@ TEST(ElfCoreDumpTest, TestElfHeader) {
   EXPECT_TRUE(core.IsValid());
 }
 
+TEST(ElfCoreDumpTest, CopyData) {
+  // A core with three PT_LOAD segments, listed out of order: two adjacent
+  // ones at 0x2000 and 0x3000, and one at 0x8000 after a gap.
+  struct TestCore {
+    ElfCoreDump::Ehdr header;
+    ElfCoreDump::Phdr programs[3];
+    uint8_t data[3][0x1000];
+  } core_content;
+  memset(&core_content, 0, sizeof(core_content));
+  core_content.header.e_ident[0] = ELFMAG0;
+  core_content.header.e_ident[1] = ELFMAG1;
+  core_content.header.e_ident[2] = ELFMAG2;
+  core_content.header.e_ident[3] = ELFMAG3;
+  core_content.header.e_ident[4] = ElfCoreDump::kClass;
+  core_content.header.e_version = EV_CURRENT;
+  core_content.header.e_type = ET_CORE;
+  core_content.header.e_phoff = offsetof(TestCore, programs);
+  core_content.header.e_phentsize = sizeof(ElfCoreDump::Phdr);
+  core_content.header.e_phnum = 3;
+  const ElfCoreDump::Addr kAddresses[] = { 0x8000, 0x3000, 0x2000 };
+  for (int i = 0; i < 3; ++i) {
+    core_content.programs[i].p_type = PT_LOAD;
+    core_content.programs[i].p_vaddr = kAddresses[i];
+    core_content.programs[i].p_offset =
+        offsetof(TestCore, data) + i * 0x1000;
+    core_content.programs[i].p_filesz = 0x1000;
+    core_content.programs[i].p_memsz = 0x1000;
+    memset(core_content.data[i], 'a' + i, 0x1000);
+  }
+
+  ElfCoreDump core(MemoryRange(&core_content, sizeof(core_content)));
+  ASSERT_TRUE(core.IsValid());
+
+  uint8_t buffer[0x10];
+  ASSERT_TRUE(core.CopyData(buffer, 0x8010, 4));
+  EXPECT_EQ(0, memcmp(buffer, "aaaa", 4));
+  ASSERT_TRUE(core.CopyData(buffer, 0x2ffe, 4));
+  EXPECT_EQ(0, memcmp(buffer, "ccbb", 4));
+  EXPECT_FALSE(core.CopyData(buffer, 0x3ffe, 4));
+  EXPECT_FALSE(core.CopyData(buffer, 0x1ffe, 4));
+  EXPECT_FALSE(core.CopyData(buffer, 0x9000, 4));
+}
+
 TEST(ElfCoreDumpTest, ValidCoreFile) {
   CrashGenerator crash_generator;
   if (!crash_generator.HasDefaultCorePattern()) {
@@ -36,6 +36,8 @@
 #include <elf.h>
 #include <string.h>
 
+#include <vector>
+
 #include "common/byte_cursor.h"
 #include "common/module.h"
 
@@ -153,6 +155,11 @@ bool ELFSymbolsToModule(const uint8_t* symtab_section,
   // The iterator walking the symbol table.
   ELFSymbolIterator iterator(&symbols, big_endian, value_size);
 
+  // Gather the externs and hand them to the module all at once, which
+  // sorts them in one go instead of inserting each into a tree.
+  std::vector<Module::Extern*> externs;
+  externs.reserve(symtab_size / (value_size == 4 ? 16 : 24));
+
   while(!iterator->at_end) {
     if (ELF32_ST_TYPE(iterator->info) == STT_FUNC &&
         iterator->shndx != SHN_UNDEF) {
@@ -168,10 +175,11 @@ bool ELFSymbolsToModule(const uint8_t* symtab_section,
         free(demangled);
       }
 #endif
-      module->AddExtern(ext);
+      externs.push_back(ext);
     }
     ++iterator;
   }
+  module->AddExterns(&externs);
   return true;
 }
 
@@ -154,6 +154,12 @@ bool FileID::ElfFileIdentifierFromMappedFile(const void* base,
   return HashElfTextSection(base, identifier);
 }
 
+// static
+bool FileID::ElfBuildIdFromMappedFile(const void* base,
+                                      wasteful_vector<uint8_t>& identifier) {
+  return FindElfBuildIDNote(base, identifier);
+}
+
 bool FileID::ElfFileIdentifier(wasteful_vector<uint8_t>& identifier) {
   MemoryMappedFile mapped_file(path_.c_str(), 0);
   if (!mapped_file.data())  // Should probably check if size >= ElfW(Ehdr)?
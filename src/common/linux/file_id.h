@@ -68,6 +68,13 @@ class FileID {
       const void* base,
       wasteful_vector<uint8_t>& identifier);
 
+  // Load the build ID of the elf file mapped into memory at |base|, from
+  // its build id note, into |identifier|. Unlike
+  // ElfFileIdentifierFromMappedFile, don't fall back on a hash of the text
+  // section: return false if the file has no build id note.
+  static bool ElfBuildIdFromMappedFile(const void* base,
+                                       wasteful_vector<uint8_t>& identifier);
+
   // Convert the |identifier| data to a string.  The string will
   // be formatted as a UUID in all uppercase without dashes.
   // (e.g., 22F065BBFC9C49F780FE26A7CEBD7BCE).
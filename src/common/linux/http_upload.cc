@@ -31,10 +31,26 @@
 
 #include <assert.h>
 #include <dlfcn.h>
+
+#include <mutex>
+
 #include "third_party/curl/curl.h"
 
 namespace {
 
+// The value of CURL_HTTP_VERSION_2TLS, which our copy of curl.h predates:
+// HTTP/2 for HTTPS URLs where the server and libcurl support it, HTTP/1.1
+// otherwise.
+const long kHttpVersion2Tls = 4;
+
+// A curl handle kept from one request to the next, with the library it
+// came from. The next request reuses its connection to the server, saving
+// a TCP connection and TLS handshake per request. At most one handle is
+// kept; concurrent requests get their own.
+std::mutex idle_handle_mutex;
+void* idle_curl_lib = NULL;
+CURL* idle_curl = NULL;
+
 // Callback to get the response data from server.
 static size_t WriteCallback(void* ptr, size_t size,
                             size_t nmemb, void* userp) {
@@ -69,44 +85,19 @@ bool HTTPUpload::SendRequest(const string& url,
   if (!CheckParameters(parameters))
     return false;
 
-  // We may have been linked statically; if curl_easy_init is in the
-  // current binary, no need to search for a dynamic version.
-  void* curl_lib = dlopen(NULL, RTLD_NOW);
-  if (!CheckCurlLib(curl_lib)) {
-    fprintf(stderr,
-            "Failed to open curl lib from binary, use libcurl.so instead\n");
-    dlerror();  // Clear dlerror before attempting to open libraries.
-    dlclose(curl_lib);
-    curl_lib = NULL;
-  }
-  if (!curl_lib) {
-    curl_lib = dlopen("libcurl.so", RTLD_NOW);
+  void* curl_lib = NULL;
+  CURL* curl = NULL;
+  {
+    std::lock_guard<std::mutex> lock(idle_handle_mutex);
+    curl_lib = idle_curl_lib;
+    curl = idle_curl;
+    idle_curl_lib = NULL;
+    idle_curl = NULL;
   }
-  if (!curl_lib) {
+  if (curl) {
     if (error_description != NULL)
-      *error_description = dlerror();
-    curl_lib = dlopen("libcurl.so.4", RTLD_NOW);
-  }
-  if (!curl_lib) {
-    // Debian gives libcurl a different name when it is built against GnuTLS
-    // instead of OpenSSL.
-    curl_lib = dlopen("libcurl-gnutls.so.4", RTLD_NOW);
-  }
-  if (!curl_lib) {
-    curl_lib = dlopen("libcurl.so.3", RTLD_NOW);
-  }
-  if (!curl_lib) {
-    return false;
-  }
-
-  CURL* (*curl_easy_init)(void);
-  *(void**) (&curl_easy_init) = dlsym(curl_lib, "curl_easy_init");
-  CURL* curl = (*curl_easy_init)();
-  if (error_description != NULL)
-    *error_description = "No Error";
-
-  if (!curl) {
-    dlclose(curl_lib);
+      *error_description = "No Error";
+  } else if (!OpenCurl(&curl_lib, &curl, error_description)) {
     return false;
   }
 
@@ -119,6 +110,8 @@ bool HTTPUpload::SendRequest(const string& url,
   // Curl_resolv_timeout in stack trace otherwise.
   // See https://curl.haxx.se/libcurl/c/threadsafe.html
   (*curl_easy_setopt)(curl, CURLOPT_NOSIGNAL, 1);
+  // Older versions of libcurl reject this, and keep to HTTP/1.1.
+  (*curl_easy_setopt)(curl, CURLOPT_HTTP_VERSION, kHttpVersion2Tls);
   // Set proxy information if necessary.
   if (!proxy.empty())
     (*curl_easy_setopt)(curl, CURLOPT_PROXY, proxy.c_str());
@@ -186,9 +179,25 @@ bool HTTPUpload::SendRequest(const string& url,
   if (error_description != NULL)
     *error_description = (*curl_easy_strerror)(err_code);
 
-  void (*curl_easy_cleanup)(CURL*);
-  *(void**) (&curl_easy_cleanup) = dlsym(curl_lib, "curl_easy_cleanup");
-  (*curl_easy_cleanup)(curl);
+  // Resetting the handle drops its options, which point into |formpost|
+  // and |headerlist|, but keeps its connection for the next request.
+  void (*curl_easy_reset)(CURL*);
+  *(void**) (&curl_easy_reset) = dlsym(curl_lib, "curl_easy_reset");
+  bool keep_handle = false;
+  if (curl_easy_reset) {
+    (*curl_easy_reset)(curl);
+    std::lock_guard<std::mutex> lock(idle_handle_mutex);
+    if (!idle_curl) {
+      idle_curl_lib = curl_lib;
+      idle_curl = curl;
+      keep_handle = true;
+    }
+  }
+  if (!keep_handle) {
+    void (*curl_easy_cleanup)(CURL*);
+    *(void**) (&curl_easy_cleanup) = dlsym(curl_lib, "curl_easy_cleanup");
+    (*curl_easy_cleanup)(curl);
+  }
   if (formpost != NULL) {
     void (*curl_formfree)(struct curl_httppost*);
     *(void**) (&curl_formfree) = dlsym(curl_lib, "curl_formfree");
@@ -199,10 +208,61 @@ bool HTTPUpload::SendRequest(const string& url,
     *(void**) (&curl_slist_free_all) = dlsym(curl_lib, "curl_slist_free_all");
     (*curl_slist_free_all)(headerlist);
   }
-  dlclose(curl_lib);
+  if (!keep_handle)
+    dlclose(curl_lib);
   return err_code == CURLE_OK;
 }
 
+// static
+bool HTTPUpload::OpenCurl(void** curl_lib_out, CURL** curl_out,
+                          string* error_description) {
+  // We may have been linked statically; if curl_easy_init is in the
+  // current binary, no need to search for a dynamic version.
+  void* curl_lib = dlopen(NULL, RTLD_NOW);
+  if (!CheckCurlLib(curl_lib)) {
+    fprintf(stderr,
+            "Failed to open curl lib from binary, use libcurl.so instead\n");
+    dlerror();  // Clear dlerror before attempting to open libraries.
+    dlclose(curl_lib);
+    curl_lib = NULL;
+  }
+  if (!curl_lib) {
+    curl_lib = dlopen("libcurl.so", RTLD_NOW);
+  }
+  if (!curl_lib) {
+    if (error_description != NULL)
+      *error_description = dlerror();
+    curl_lib = dlopen("libcurl.so.4", RTLD_NOW);
+  }
+  if (!curl_lib) {
+    // Debian gives libcurl a different name when it is built against GnuTLS
+    // instead of OpenSSL.
+    curl_lib = dlopen("libcurl-gnutls.so.4", RTLD_NOW);
+  }
+  if (!curl_lib) {
+    curl_lib = dlopen("libcurl.so.3", RTLD_NOW);
+  }
+  if (!curl_lib) {
+    return false;
+  }
+
+  CURL* (*curl_easy_init)(void);
+  *(void**) (&curl_easy_init) = dlsym(curl_lib, "curl_easy_init");
+  CURL* curl = (*curl_easy_init)();
+  if (error_description != NULL)
+    *error_description = "No Error";
+
+  if (!curl) {
+    dlclose(curl_lib);
+    return false;
+  }
+
+  *curl_lib_out = curl_lib;
+  *curl_out = curl;
+  return true;
+
+}
+
 // static
 bool HTTPUpload::CheckCurlLib(void* curl_lib) {
   return curl_lib &&
@@ -30,6 +30,8 @@
 // HTTPUpload provides a "nice" API to send a multipart HTTP(S) POST
 // request using libcurl.  It currently supports requests that contain
 // a set of string parameters (key/value pairs), and a file to upload.
+// Files are streamed from disk as the request is sent, and the connection
+// is kept open for the next request to the same server.
 
 #ifndef COMMON_LINUX_HTTP_UPLOAD_H__
 #define COMMON_LINUX_HTTP_UPLOAD_H__
@@ -38,6 +40,7 @@
 #include <string>
 
 #include "common/using_std_string.h"
+#include "third_party/curl/curl.h"
 
 namespace google_breakpad {
 
@@ -77,6 +80,11 @@ class HTTPUpload {
   // Checks the curl_lib parameter points to a valid curl lib.
   static bool CheckCurlLib(void* curl_lib);
 
+  // Loads libcurl and creates a handle. Returns false, with the reason in
+  // error_description if it is not NULL, on failure.
+  static bool OpenCurl(void** curl_lib_out, CURL** curl_out,
+                       string* error_description);
+
   // No instances of this class should be created.
   // Disallow all constructors, destructors, and operator=.
   HTTPUpload();
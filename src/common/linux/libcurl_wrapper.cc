@@ -28,6 +28,8 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <dlfcn.h>
+#include <stdio.h>
+#include <sys/stat.h>
 
 #include <iostream>
 #include <string>
@@ -41,6 +43,8 @@ LibcurlWrapper::LibcurlWrapper()
       curl_lib_(nullptr),
       last_curl_error_(""),
       curl_(nullptr),
+      max_send_speed_(0),
+      accept_encoding_(false),
       formpost_(nullptr),
       lastptr_(nullptr),
       headerlist_(nullptr) {}
@@ -139,9 +143,20 @@ bool LibcurlWrapper::SendPutRequest(const string& url,
   if (!CheckInit()) return false;
 
   FILE* file = fopen(path.c_str(), "rb");
+  struct stat st;
+  if (!file || fstat(fileno(file), &st) != 0) {
+    std::cout << "Could not open " << path << " for upload.\n";
+    if (file)
+      fclose(file);
+    return false;
+  }
   (*easy_setopt_)(curl_, CURLOPT_UPLOAD, 1L);
   (*easy_setopt_)(curl_, CURLOPT_PUT, 1L);
   (*easy_setopt_)(curl_, CURLOPT_READDATA, file);
+  // Without a length curl sends the file chunked, which not all servers
+  // accept for large files.
+  (*easy_setopt_)(curl_, CURLOPT_INFILESIZE_LARGE,
+                  static_cast<curl_off_t>(st.st_size));
 
   bool success = SendRequestInner(url, http_status_code, http_header_data,
                                   http_response_data);
@@ -173,6 +188,11 @@ bool LibcurlWrapper::SendSimplePostRequest(const string& url,
 }
 
 bool LibcurlWrapper::Init() {
+  // Initializing again would leak the handle, with the connections that it
+  // keeps open from one request to the next.
+  if (init_ok_)
+    return true;
+
   // First check to see if libcurl was statically linked:
   curl_lib_ = dlopen(nullptr, RTLD_NOW);
   if (curl_lib_ &&
@@ -272,6 +292,17 @@ bool LibcurlWrapper::SendRequestInner(const string& url,
                                       string* http_response_data) {
   string url_copy(url);
   (*easy_setopt_)(curl_, CURLOPT_URL, url_copy.c_str());
+  // Allow several wrappers to be used on different threads; see
+  // https://curl.haxx.se/libcurl/c/threadsafe.html
+  (*easy_setopt_)(curl_, CURLOPT_NOSIGNAL, 1L);
+  // CURL_HTTP_VERSION_2TLS, which our copy of curl.h predates. Older versions
+  // of libcurl reject it, and keep to HTTP/1.1.
+  (*easy_setopt_)(curl_, CURLOPT_HTTP_VERSION, 4L);
+  if (max_send_speed_ > 0)
+    (*easy_setopt_)(curl_, CURLOPT_MAX_SEND_SPEED_LARGE, max_send_speed_);
+  // An empty string offers every encoding libcurl was built to decode.
+  if (accept_encoding_)
+    (*easy_setopt_)(curl_, CURLOPT_ENCODING, "");
 
   // Disable 100-continue header.
   char buf[] = "Expect:";
@@ -44,9 +44,22 @@ class LibcurlWrapper {
  public:
   LibcurlWrapper();
   virtual ~LibcurlWrapper();
+  // Loads libcurl and creates the handle that all requests are sent with,
+  // so that they share connections. Returns true at once if already
+  // initialized.
   virtual bool Init();
   virtual bool SetProxy(const string& proxy_host,
                         const string& proxy_userpwd);
+  // Caps the upload bandwidth of the requests that follow, or doesn't if
+  // 0, the default.
+  void set_max_send_speed(curl_off_t bytes_per_second) {
+    max_send_speed_ = bytes_per_second;
+  }
+  // Asks for responses to be compressed with any encoding libcurl can
+  // decode, and decodes them, in the requests that follow.
+  void set_accept_encoding(bool accept_encoding) {
+    accept_encoding_ = accept_encoding;
+  }
   virtual bool AddFile(const string& upload_file_path,
                        const string& basename);
   virtual bool SendRequest(const string& url,
@@ -93,6 +106,9 @@ class LibcurlWrapper {
 
   CURL* curl_;                   // Pointer for handle for CURL calls.
 
+  curl_off_t max_send_speed_;    // See set_max_send_speed().
+  bool accept_encoding_;         // See set_accept_encoding().
+
   CURL* (*easy_init_)(void);
 
   // Stateful pointers for calling into curl_formadd()
@@ -35,8 +35,13 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "common/linux/http_upload.h"
@@ -155,24 +160,20 @@ bool SymUploadV1Start(
 }
 
 // |options| describes the current sym_upload options.
+// |libcurl_wrapper| is an initialized wrapper to send the requests with.
 // |code_id| is the basename of the module for which symbols are being
 // uploaded.
 // |debug_id| is the debug_id of the module for which symbols are being
 // uploaded.
 bool SymUploadV2Start(
     const Options& options,
+    LibcurlWrapper* libcurl_wrapper,
     const string& code_file,
     const string& debug_id,
     const string& type) {
-  google_breakpad::LibcurlWrapper libcurl_wrapper;
-  if (!libcurl_wrapper.Init()) {
-    printf("Failed to init google_breakpad::LibcurlWrapper.\n");
-    return false;
-  }
-
   if (!options.force) {
     SymbolStatus symbolStatus = SymbolCollectorClient::CheckSymbolStatus(
-        &libcurl_wrapper,
+        libcurl_wrapper,
         options.uploadURLStr,
         options.api_key,
         code_file,
@@ -189,7 +190,7 @@ bool SymUploadV2Start(
 
   UploadUrlResponse uploadUrlResponse;
   if (!SymbolCollectorClient::CreateUploadUrl(
-      &libcurl_wrapper,
+      libcurl_wrapper,
       options.uploadURLStr,
       options.api_key,
       &uploadUrlResponse)) {
@@ -203,11 +204,23 @@ bool SymUploadV2Start(
   string response;
   long response_code;
 
-  if (!libcurl_wrapper.SendPutRequest(signed_url,
-                                      options.symbolsPath,
-                                      &response_code,
-                                      &header,
-                                      &response)) {
+  // A large file may take minutes to send, so the PUT is retried if the
+  // connection drops or the server has a transient error.
+  const int kMaxPutAttempts = 3;
+  bool sent = false;
+  for (int attempt = 1; attempt <= kMaxPutAttempts; ++attempt) {
+    sent = libcurl_wrapper->SendPutRequest(signed_url,
+                                           options.symbolsPath,
+                                           &response_code,
+                                           &header,
+                                           &response);
+    if (sent && response_code < 500)
+      break;
+    if (attempt < kMaxPutAttempts)
+      printf("Failed to send symbol file, retrying.\n");
+  }
+
+  if (!sent) {
     printf("Failed to send symbol file.\n");
     printf("Response code: %ld\n", response_code);
     printf("Response:\n");
@@ -224,7 +237,7 @@ bool SymUploadV2Start(
   }
 
   CompleteUploadResult completeUploadResult =
-      SymbolCollectorClient::CompleteUpload(&libcurl_wrapper,
+      SymbolCollectorClient::CompleteUpload(libcurl_wrapper,
                                             options.uploadURLStr,
                                             options.api_key,
                                             upload_key,
@@ -244,39 +257,115 @@ bool SymUploadV2Start(
   return true;
 }
 
-//=============================================================================
-void Start(Options* options) {
-  if (options->upload_protocol == UploadProtocol::SYM_UPLOAD_V2) {
+// Uploads options.symbolsPath. |libcurl_wrapper| is an initialized wrapper
+// for sym-upload-v2 requests; it keeps its connections to the server open
+// from one file to the next.
+bool UploadSymbolFile(const Options& options,
+                      LibcurlWrapper* libcurl_wrapper) {
+  if (options.upload_protocol == UploadProtocol::SYM_UPLOAD_V2) {
     string code_file;
     string debug_id;
     string type;
 
-    if (options->type.empty() || options->type == kBreakpadSymbolType) {
+    if (options.type.empty() || options.type == kBreakpadSymbolType) {
       // Breakpad upload so read these from input file.
       std::vector<string> module_parts;
-      if (!ModuleDataForSymbolFile(options->symbolsPath, &module_parts)) {
+      if (!ModuleDataForSymbolFile(options.symbolsPath, &module_parts)) {
         fprintf(stderr, "Failed to parse symbol file!\n");
-        return;
+        return false;
       }
       code_file = module_parts[4];
       debug_id = CompactIdentifier(module_parts[3]);
       type = kBreakpadSymbolType;
     } else {
       // Native upload so these must be explicitly set.
-      code_file = options->code_file;
-      debug_id = options->debug_id;
-      type = options->type;
+      code_file = options.code_file;
+      debug_id = options.debug_id;
+      type = options.type;
     }
 
-    options->success = SymUploadV2Start(*options, code_file, debug_id, type);
-  } else {
-    std::vector<string> module_parts;
-    if (!ModuleDataForSymbolFile(options->symbolsPath, &module_parts)) {
-      fprintf(stderr, "Failed to parse symbol file!\n");
+    return SymUploadV2Start(options, libcurl_wrapper, code_file, debug_id,
+                            type);
+  }
+
+  std::vector<string> module_parts;
+  if (!ModuleDataForSymbolFile(options.symbolsPath, &module_parts)) {
+    fprintf(stderr, "Failed to parse symbol file!\n");
+    return false;
+  }
+  const string compacted_id = CompactIdentifier(module_parts[3]);
+  return SymUploadV1Start(options, module_parts, compacted_id);
+}
+
+// Uploads options.symbolsPaths, up to options.jobs at once. Each worker
+// thread has its own LibcurlWrapper, so it checks for, sends and completes
+// one file after another over the same connections while the others do
+// the same.
+bool UploadSymbolFiles(const Options& options) {
+  const std::vector<string>& paths = options.symbolsPaths;
+  int worker_count = std::max(1, std::min(options.jobs,
+                                          static_cast<int>(paths.size())));
+
+  // The wrappers are initialized before any thread starts, as libcurl's
+  // global initialization is not thread-safe. sym-upload-v1 requests go
+  // through HTTPUpload instead, but then the wrappers keep libcurl loaded
+  // and initialized.
+  std::vector<std::unique_ptr<LibcurlWrapper> > wrappers;
+  for (int i = 0; i < worker_count; ++i) {
+    wrappers.push_back(std::unique_ptr<LibcurlWrapper>(new LibcurlWrapper));
+    if (!wrappers.back()->Init()) {
+      printf("Failed to init google_breakpad::LibcurlWrapper.\n");
+      return false;
+    }
+  }
+
+  std::atomic<size_t> next_file(0);
+  std::atomic<size_t> uploaded(0);
+  std::mutex output_mutex;
+  auto upload_files = [&](LibcurlWrapper* libcurl_wrapper) {
+    Options file_options = options;
+    size_t i;
+    while ((i = next_file++) < paths.size()) {
+      file_options.symbolsPath = paths[i];
+      bool success = UploadSymbolFile(file_options, libcurl_wrapper);
+      if (success)
+        ++uploaded;
+
+      std::lock_guard<std::mutex> lock(output_mutex);
+      printf("%s: %s\n", paths[i].c_str(), success ? "OK" : "FAILED");
+      fflush(stdout);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < worker_count; ++i)
+    workers.push_back(std::thread(upload_files, wrappers[i].get()));
+  upload_files(wrappers[0].get());
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+
+  printf("Uploaded %zu of %zu symbol files.\n",
+         static_cast<size_t>(uploaded), paths.size());
+  return uploaded == paths.size();
+}
+
+//=============================================================================
+void Start(Options* options) {
+  if (!options->symbolsPaths.empty()) {
+    options->success = UploadSymbolFiles(*options);
+    return;
+  }
+
+  if (options->upload_protocol == UploadProtocol::SYM_UPLOAD_V2) {
+    google_breakpad::LibcurlWrapper libcurl_wrapper;
+    if (!libcurl_wrapper.Init()) {
+      printf("Failed to init google_breakpad::LibcurlWrapper.\n");
+      options->success = false;
       return;
     }
-    const string compacted_id = CompactIdentifier(module_parts[3]);
-    options->success = SymUploadV1Start(*options, module_parts, compacted_id);
+    options->success = UploadSymbolFile(*options, &libcurl_wrapper);
+  } else {
+    options->success = UploadSymbolFile(*options, nullptr);
   }
 }
 
@@ -35,6 +35,7 @@
 #define COMMON_LINUX_SYMBOL_UPLOAD_H_
 
 #include <string>
+#include <vector>
 
 #include "common/using_std_string.h"
 
@@ -49,7 +50,9 @@ enum class UploadProtocol {
 constexpr char kBreakpadSymbolType[] = "BREAKPAD";
 
 struct Options {
-  Options() : upload_protocol(UploadProtocol::SYM_UPLOAD_V1), force(false) {}
+  Options()
+      : success(false), upload_protocol(UploadProtocol::SYM_UPLOAD_V1),
+        force(false), jobs(1) {}
 
   string symbolsPath;
   string uploadURLStr;
@@ -65,9 +68,15 @@ struct Options {
   string code_file;
   string debug_id;
   string type;
+
+  // If not empty, the Breakpad symbol files to upload instead of
+  // symbolsPath, up to |jobs| at once.
+  std::vector<string> symbolsPaths;
+  int jobs;
 };
 
-// Starts upload to symbol server with options.
+// Starts upload to symbol server with options. |success| is set if every
+// file was uploaded, or was already on the server.
 void Start(Options* options);
 
 }  // namespace sym_upload
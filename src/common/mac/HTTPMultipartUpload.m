@@ -32,8 +32,53 @@
 #import "GTMDefines.h"
 #import "encoding_util.h"
 
+// The size of the buffer between the thread writing a streamed body and the
+// connection reading it, and of the reads from each file.
+static const NSUInteger kStreamChunkSize = 64 * 1024;
+
+// Writes |length| bytes at |bytes| to |stream|, waiting for room. Returns
+// NO if the stream is closed or fails.
+static BOOL WriteToStream(NSOutputStream* stream,
+                          const uint8_t* bytes,
+                          NSUInteger length) {
+  while (length > 0) {
+    NSInteger written = [stream write:bytes maxLength:length];
+    if (written <= 0)
+      return NO;
+    bytes += written;
+    length -= written;
+  }
+  return YES;
+}
+
+// Writes |parts|, NSData or the paths of files, to |stream| in order.
+static BOOL WritePartsToStream(NSArray* parts, NSOutputStream* stream) {
+  for (id part in parts) {
+    if ([part isKindOfClass:[NSData class]]) {
+      if (!WriteToStream(stream, (const uint8_t*)[part bytes], [part length]))
+        return NO;
+      continue;
+    }
+    NSInputStream* file = [NSInputStream inputStreamWithFileAtPath:part];
+    [file open];
+    uint8_t buffer[kStreamChunkSize];
+    NSInteger bytesRead = 0;
+    BOOL ok = YES;
+    while (ok &&
+           (bytesRead = [file read:buffer maxLength:sizeof(buffer)]) > 0) {
+      ok = WriteToStream(stream, buffer, bytesRead);
+    }
+    [file close];
+    if (!ok || bytesRead < 0)
+      return NO;
+  }
+  return YES;
+}
+
 @interface HTTPMultipartUpload (PrivateMethods)
 - (NSString*)multipartBoundary;
+// The body in order: NSData, or the paths of files to send the contents of.
+- (NSArray*)bodyParts;
 // Each of the following methods will append the starting multipart boundary,
 // but not the ending one.
 - (NSData*)formDataForKey:(NSString*)key value:(NSString*)value;
@@ -65,6 +110,39 @@
   return data;
 }
 
+//=============================================================================
+- (NSArray*)bodyParts {
+  NSMutableArray* parts = [NSMutableArray array];
+
+  // Add any parameters to the message
+  NSArray* parameterKeys = [parameters_ allKeys];
+  NSString* key;
+
+  NSInteger count = [parameterKeys count];
+  for (NSInteger i = 0; i < count; ++i) {
+    key = [parameterKeys objectAtIndex:i];
+    [parts addObject:[self formDataForKey:key
+                                    value:[parameters_ objectForKey:key]]];
+  }
+
+  // Add any files to the message
+  NSArray* fileNames = [files_ allKeys];
+  for (NSString* name in fileNames) {
+    // First the boundary and the formdata
+    NSMutableData* prefix = [NSMutableData data];
+    [self appendBoundaryData:prefix];
+    [prefix appendData:[HTTPRequest formDataPrefixForFileWithName:name]];
+    [parts addObject:prefix];
+    // Then the file, by contents or by path
+    [parts addObject:[files_ objectForKey:name]];
+  }
+
+  NSString* epilogue = [NSString stringWithFormat:@"\r\n--%@--\r\n", boundary_];
+  [parts addObject:[epilogue dataUsingEncoding:NSUTF8StringEncoding]];
+
+  return parts;
+}
+
 //=============================================================================
 - (void)appendBoundaryData:(NSMutableData*)data {
   NSString* fmt = @"--%@\r\n";
@@ -138,33 +216,70 @@
 - (NSData*)bodyData {
   NSMutableData* postBody = [NSMutableData data];
 
-  // Add any parameters to the message
-  NSArray* parameterKeys = [parameters_ allKeys];
-  NSString* key;
-
-  NSInteger count = [parameterKeys count];
-  for (NSInteger i = 0; i < count; ++i) {
-    key = [parameterKeys objectAtIndex:i];
-    [postBody appendData:[self formDataForKey:key
-                                        value:[parameters_ objectForKey:key]]];
+  for (id part in [self bodyParts]) {
+    if ([part isKindOfClass:[NSData class]]) {
+      [postBody appendData:part];
+    } else {
+      NSData* contents = [NSData dataWithContentsOfFile:part];
+      if (contents)
+        [postBody appendData:contents];
+    }
   }
 
-  // Add any files to the message
-  NSArray* fileNames = [files_ allKeys];
-  for (NSString* name in fileNames) {
-    // First append boundary
-    [self appendBoundaryData:postBody];
-    // Then the formdata
-    id fileOrData = [files_ objectForKey:name];
-    [HTTPRequest appendFileToBodyData:postBody
-                             withName:name
-                       withFileOrData:fileOrData];
+  return postBody;
+}
+
+//=============================================================================
+- (NSInputStream*)bodyStreamWithLength:(unsigned long long*)length {
+  NSArray* parts = [self bodyParts];
+
+  // The length is known up front, so the files are sized now; a file that
+  // can't be is sent from bodyData instead.
+  unsigned long long total = 0;
+  BOOL hasFile = NO;
+  NSFileManager* fileManager = [NSFileManager defaultManager];
+  for (id part in parts) {
+    if ([part isKindOfClass:[NSData class]]) {
+      total += [part length];
+      continue;
+    }
+    NSDictionary* attributes = [fileManager attributesOfItemAtPath:part
+                                                             error:NULL];
+    if (!attributes)
+      return nil;
+    total += [attributes fileSize];
+    hasFile = YES;
   }
+  // A body already in memory is sent as it is.
+  if (!hasFile)
+    return nil;
 
-  NSString* epilogue = [NSString stringWithFormat:@"\r\n--%@--\r\n", boundary_];
-  [postBody appendData:[epilogue dataUsingEncoding:NSUTF8StringEncoding]];
+  // The files are read, a chunk at a time, by a thread writing the body into
+  // one end of a bound pair of streams while the connection reads the other.
+  CFReadStreamRef readStream = NULL;
+  CFWriteStreamRef writeStream = NULL;
+  CFStreamCreateBoundPair(NULL, &readStream, &writeStream, kStreamChunkSize);
+  if (!readStream || !writeStream) {
+    if (readStream)
+      CFRelease(readStream);
+    if (writeStream)
+      CFRelease(writeStream);
+    return nil;
+  }
+  NSInputStream* input = [(NSInputStream*)readStream autorelease];
+  NSOutputStream* output = (NSOutputStream*)writeStream;
+  [output open];
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                 ^{
+                   // A write fails once the connection closes its end, so
+                   // the thread doesn't outlive a failed upload.
+                   WritePartsToStream(parts, output);
+                   [output close];
+                   [output release];
+                 });
 
-  return postBody;
+  *length = total;
+  return input;
 }
 
 @end
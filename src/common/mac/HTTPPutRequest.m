@@ -53,4 +53,14 @@
   return [NSData dataWithContentsOfFile:file_];
 }
 
+//=============================================================================
+- (NSInputStream*)bodyStreamWithLength:(unsigned long long*)length {
+  NSDictionary* attributes =
+      [[NSFileManager defaultManager] attributesOfItemAtPath:file_ error:NULL];
+  if (!attributes)
+    return nil;
+  *length = [attributes fileSize];
+  return [NSInputStream inputStreamWithFileAtPath:file_];
+}
+
 @end
@@ -58,6 +58,13 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSData*)bodyData;  // Internal, don't call outside class hierarchy.
 
+/**
+ Returns a stream of the body to send in place of bodyData, without holding
+ it all in memory, and sets |length| to its length in bytes; or returns nil
+ to send bodyData. Internal, don't call outside class hierarchy.
+ */
+- (nullable NSInputStream*)bodyStreamWithLength:(unsigned long long*)length;
+
 - (NSData*)send:(NSError**)error;
 
 /**
@@ -68,6 +75,11 @@ NS_ASSUME_NONNULL_BEGIN
                     withName:(NSString*)name
               withFileOrData:(id)fileOrData;
 
+/**
+ Returns the form data that goes before a file's contents in the HTTP request.
+ */
++ (NSData*)formDataPrefixForFileWithName:(NSString*)name;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -65,10 +65,16 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
   __block NSURLResponse* response = nil;
   dispatch_semaphore_t waitSemaphone = dispatch_semaphore_create(0);
 
-  NSURLSessionConfiguration* config =
-      [NSURLSessionConfiguration defaultSessionConfiguration];
-  [config setTimeoutIntervalForRequest:240.0];
-  NSURLSession* session = [NSURLSession sessionWithConfiguration:config];
+  // One session serves every request, so that uploads to the same server
+  // reuse its connections.
+  static NSURLSession* session;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    NSURLSessionConfiguration* config =
+        [NSURLSessionConfiguration defaultSessionConfiguration];
+    [config setTimeoutIntervalForRequest:240.0];
+    session = [[NSURLSession sessionWithConfiguration:config] retain];
+  });
   NSURLSessionDataTask *task = [session
       dataTaskWithRequest:req
         completionHandler:^(NSData* data, NSURLResponse* resp, NSError* err) {
@@ -183,6 +189,11 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
   return nil;
 }
 
+//=============================================================================
+- (NSInputStream*)bodyStreamWithLength:(unsigned long long*)length {
+  return nil;
+}
+
 //=============================================================================
 - (NSData*)send:(NSError**)withError {
   NSMutableURLRequest* req = [[NSMutableURLRequest alloc]
@@ -195,9 +206,19 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
     [req setValue:contentType forHTTPHeaderField:@"Content-type"];
   }
 
-  NSData* bodyData = [self bodyData];
-  if ([bodyData length] > 0) {
-    [req setHTTPBody:bodyData];
+  // A body written to a file URL is written from bodyData.
+  unsigned long long bodyLength = 0;
+  NSInputStream* bodyStream =
+      [URL_ isFileURL] ? nil : [self bodyStreamWithLength:&bodyLength];
+  if (bodyStream) {
+    [req setHTTPBodyStream:bodyStream];
+    [req setValue:[NSString stringWithFormat:@"%llu", bodyLength]
+        forHTTPHeaderField:@"Content-Length"];
+  } else {
+    NSData* bodyData = [self bodyData];
+    if ([bodyData length] > 0) {
+      [req setHTTPBody:bodyData];
+    }
   }
 
   [req setHTTPMethod:[self HTTPMethod]];
@@ -219,15 +240,21 @@ static NSData* SendSynchronousNSURLRequest(NSURLRequest* req,
 }
 
 //=============================================================================
-+ (NSData*)formDataForFileContents:(NSData*)contents withName:(NSString*)name {
-  NSMutableData* data = [NSMutableData data];
++ (NSData*)formDataPrefixForFileWithName:(NSString*)name {
   NSString* escaped = PercentEncodeNSString(name);
   NSString* fmt = @"Content-Disposition: form-data; name=\"%@\"; "
                    "filename=\"minidump.dmp\"\r\nContent-Type: "
                    "application/octet-stream\r\n\r\n";
   NSString* pre = [NSString stringWithFormat:fmt, escaped];
 
-  [data appendData:[pre dataUsingEncoding:NSUTF8StringEncoding]];
+  return [pre dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+//=============================================================================
++ (NSData*)formDataForFileContents:(NSData*)contents withName:(NSString*)name {
+  NSMutableData* data = [NSMutableData data];
+
+  [data appendData:[self formDataPrefixForFileWithName:name]];
   [data appendData:contents];
 
   return data;
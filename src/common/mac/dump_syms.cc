@@ -38,16 +38,20 @@
 #include <assert.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <mach-o/arch.h>
 #include <mach-o/fat.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <ostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "common/dwarf/bytereader-inl.h"
@@ -80,6 +84,7 @@ using google_breakpad::DwarfLineToModule;
 using google_breakpad::DwarfRangeListHandler;
 using google_breakpad::FileID;
 using google_breakpad::mach_o::FatReader;
+using google_breakpad::mach_o::SharedCacheReader;
 using google_breakpad::mach_o::Section;
 using google_breakpad::mach_o::Segment;
 using google_breakpad::Module;
@@ -116,10 +121,73 @@ vector<string> list_directory(const string& directory) {
   closedir(dir);
   return entries;
 }
+
+// Return the breakpad form of the 16-byte Mach-O UUID |identifier_bytes|:
+// its hex digits, without dashes, followed by a 0, as the pdb IDs have an
+// extra byte, to make everything uniform.
+string FormatIdentifier(const unsigned char identifier_bytes[16]) {
+  char identifier_string[40];
+  FileID::ConvertIdentifierToString(identifier_bytes, identifier_string,
+                                    sizeof(identifier_string));
+
+  string compacted(identifier_string);
+  for(size_t i = compacted.find('-'); i != string::npos;
+      i = compacted.find('-', i))
+    compacted.erase(i, 1);
+
+  compacted += "0";
+
+  return compacted;
+}
+
+// Return the name to use in MODULE records for the architecture
+// |cpu_type|, |cpu_subtype|, or NULL if it is unknown.
+const char* ArchitectureName(cpu_type_t cpu_type, cpu_subtype_t cpu_subtype) {
+  const NXArchInfo* arch_info =
+      google_breakpad::BreakpadGetArchInfoFromCpuType(cpu_type, cpu_subtype);
+  if (!arch_info)
+    return NULL;
+  if (strcmp(arch_info->name, "i386") == 0)
+    return "x86";
+  return arch_info->name;
+}
+
+// A LoadCommandHandler that saves the Mach-O file's UUID, from its
+// LC_UUID load command.
+class UUIDFinder: public google_breakpad::mach_o::Reader::LoadCommandHandler {
+ public:
+  UUIDFinder() : found_(false) { }
+
+  bool UnknownCommand(google_breakpad::mach_o::LoadCommandType type,
+                      const google_breakpad::ByteBuffer& contents) {
+    if (type != LC_UUID)
+      return true;
+    google_breakpad::ByteCursor cursor(&contents);
+    // Skip the command type and size.
+    found_ = cursor.Skip(8).Read(uuid_, sizeof(uuid_));
+    return true;
+  }
+
+  // If the file has a UUID, copy it to |uuid| and return true.
+  bool GetUUID(unsigned char uuid[16]) const {
+    if (found_)
+      memcpy(uuid, uuid_, sizeof(uuid_));
+    return found_;
+  }
+
+ private:
+  bool found_;
+  uint8_t uuid_[16];
+};
 }
 
 namespace google_breakpad {
 
+DumpSymbols::~DumpSymbols() {
+  if (contents_)
+    munmap(const_cast<uint8_t*>(contents_), contents_size_);
+}
+
 bool DumpSymbols::Read(const string& filename) {
   struct stat st;
   if (stat(filename.c_str(), &st) == -1) {
@@ -153,43 +221,57 @@ bool DumpSymbols::Read(const string& filename) {
     object_filename_ = input_pathname_;
   }
 
-  // Read the file's contents into memory.
-  bool read_ok = true;
-  string error;
-  if (stat(object_filename_.c_str(), &st) != -1) {
-    FILE* f = fopen(object_filename_.c_str(), "rb");
-    if (f) {
-      contents_.reset(new uint8_t[st.st_size]);
-      off_t total = 0;
-      while (total < st.st_size && !feof(f)) {
-        size_t read = fread(&contents_[0] + total, 1, st.st_size - total, f);
-        if (read == 0) {
-          if (ferror(f)) {
-            read_ok = false;
-            error = strerror(errno);
-          }
-          break;
-        }
-        total += read;
-      }
-      fclose(f);
-    } else {
-      error = strerror(errno);
-    }
+  // Map the file's contents into memory, dropping any file read before,
+  // but keeping the architecture selected in it. dSYMs can run to
+  // gigabytes; the pages are read in only as the object files selected
+  // are parsed.
+  const bool had_selection = selected_object_file_ != NULL;
+  SuperFatArch previous_selection;
+  if (had_selection)
+    previous_selection = *selected_object_file_;
+  if (contents_) {
+    munmap(const_cast<uint8_t*>(contents_), contents_size_);
+    contents_ = NULL;
+    contents_size_ = 0;
   }
-
-  if (!read_ok) {
+  object_files_.clear();
+  shared_cache_images_.clear();
+  selected_object_file_ = NULL;
+  int fd = open(object_filename_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Error reading object file: %s: %s\n",
+            object_filename_.c_str(), strerror(errno));
+    return false;
+  }
+  void* contents = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+    contents = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (contents == MAP_FAILED) {
     fprintf(stderr, "Error reading object file: %s: %s\n",
             object_filename_.c_str(),
-            error.c_str());
+            st.st_size == 0 ? "file is empty" : strerror(errno));
+    close(fd);
     return false;
   }
+  close(fd);
+  contents_ = static_cast<const uint8_t*>(contents);
+  contents_size_ = st.st_size;
+
+  // A dyld shared cache holds the system's libraries, which are read in
+  // place rather than selected among, so just list them.
+  if (SharedCacheReader::IsSharedCache(contents_, contents_size_)) {
+    SharedCacheReader::Reporter cache_reporter(object_filename_);
+    SharedCacheReader cache_reader(&cache_reporter);
+    if (!cache_reader.Read(contents_, contents_size_))
+      return false;
+    shared_cache_images_ = cache_reader.images();
+    return true;
+  }
 
   // Get the list of object files present in the file.
   FatReader::Reporter fat_reporter(object_filename_);
   FatReader fat_reader(&fat_reporter);
-  if (!fat_reader.Read(&contents_[0],
-                       st.st_size)) {
+  if (!fat_reader.Read(contents_, contents_size_)) {
     return false;
   }
 
@@ -206,6 +288,11 @@ bool DumpSymbols::Read(const string& filename) {
   memcpy(&object_files_[0], object_files,
          sizeof(SuperFatArch) * object_files_count);
 
+  if (had_selection) {
+    SetArchitecture(previous_selection.cputype,
+                    previous_selection.cpusubtype);
+  }
+
   return true;
 }
 
@@ -283,35 +370,23 @@ SuperFatArch* DumpSymbols::FindBestMatchForArchitecture(
 }
 
 string DumpSymbols::Identifier() {
+  if (!SelectDefaultObjectFile())
+    return string();
+  return Identifier(selected_object_file_);
+}
+
+string DumpSymbols::Identifier(const SuperFatArch* object_file) const {
   FileID file_id(object_filename_.c_str());
   unsigned char identifier_bytes[16];
-  scoped_ptr<Module> module;
-  if (!selected_object_file_) {
-    if (!CreateEmptyModule(module))
-      return string();
-  }
-  cpu_type_t cpu_type = selected_object_file_->cputype;
-  cpu_subtype_t cpu_subtype = selected_object_file_->cpusubtype;
+  cpu_type_t cpu_type = object_file->cputype;
+  cpu_subtype_t cpu_subtype = object_file->cpusubtype;
   if (!file_id.MachoIdentifier(cpu_type, cpu_subtype, identifier_bytes)) {
     fprintf(stderr, "Unable to calculate UUID of mach-o binary %s!\n",
             object_filename_.c_str());
     return "";
   }
 
-  char identifier_string[40];
-  FileID::ConvertIdentifierToString(identifier_bytes, identifier_string,
-                                    sizeof(identifier_string));
-
-  string compacted(identifier_string);
-  for(size_t i = compacted.find('-'); i != string::npos;
-      i = compacted.find('-', i))
-    compacted.erase(i, 1);
-
-  // The pdb for these IDs has an extra byte, so to make everything uniform put
-  // a 0 on the end of mac IDs.
-  compacted += "0";
-
-  return compacted;
+  return FormatIdentifier(identifier_bytes);
 }
 
 // A range handler that accepts rangelist data parsed by
@@ -370,9 +445,7 @@ class DumpSymbols::DumperLineToModule:
   ByteReader* byte_reader_;  // WEAK
 };
 
-bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
-  // Select an object file, if SetArchitecture hasn't been called to set one
-  // explicitly.
+bool DumpSymbols::SelectDefaultObjectFile() {
   if (!selected_object_file_) {
     // If there's only one architecture, that's the one.
     if (object_files_.size() == 1)
@@ -392,30 +465,39 @@ bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
   }
 
   assert(selected_object_file_);
+  return true;
+}
+
+bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
+  // Select an object file, if SetArchitecture hasn't been called to set one
+  // explicitly.
+  if (!SelectDefaultObjectFile())
+    return false;
+  return CreateEmptyModule(selected_object_file_, module,
+                           &selected_object_name_);
+}
 
+bool DumpSymbols::CreateEmptyModule(const SuperFatArch* object_file,
+                                    scoped_ptr<Module>& module,
+                                    string* object_name) const {
   // Find the name of the selected file's architecture, to appear in
   // the MODULE record and in error messages.
-  const NXArchInfo* selected_arch_info =
-      google_breakpad::BreakpadGetArchInfoFromCpuType(
-          selected_object_file_->cputype, selected_object_file_->cpusubtype);
-
-  const char* selected_arch_name = selected_arch_info->name;
-  if (strcmp(selected_arch_name, "i386") == 0)
-    selected_arch_name = "x86";
+  const char* selected_arch_name =
+      ArchitectureName(object_file->cputype, object_file->cpusubtype);
 
   // Produce a name to use in error messages that includes the
   // filename, and the architecture, if there is more than one.
-  selected_object_name_ = object_filename_;
+  *object_name = object_filename_;
   if (object_files_.size() > 1) {
-    selected_object_name_ += ", architecture ";
-    selected_object_name_ + selected_arch_name;
+    *object_name += ", architecture ";
+    *object_name += selected_arch_name;
   }
 
   // Compute a module name, to appear in the MODULE record.
   string module_name = google_breakpad::BaseName(object_filename_);
 
   // Choose an identifier string, to appear in the MODULE record.
-  string identifier = Identifier();
+  string identifier = Identifier(object_file);
   if (identifier.empty())
     return false;
 
@@ -428,6 +510,7 @@ bool DumpSymbols::CreateEmptyModule(scoped_ptr<Module>& module) {
 }
 
 void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
+                            const string& object_name,
                             const mach_o::Reader& macho_reader,
                             const mach_o::SectionMap& dwarf_sections,
                             bool handle_inter_cu_refs) const {
@@ -437,7 +520,7 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
                          : ENDIANNESS_LITTLE);
 
   // Construct a context for this file.
-  DwarfCUToModule::FileContext file_context(selected_object_name_,
+  DwarfCUToModule::FileContext file_context(object_name,
                                             module,
                                             handle_inter_cu_refs);
 
@@ -456,7 +539,7 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
   // There had better be a __debug_info section!
   if (debug_info_entry == file_context.section_map().end()) {
     fprintf(stderr, "%s: __DWARF segment of file has no __debug_info section\n",
-            selected_object_name_.c_str());
+            object_name.c_str());
     return;
   }
   const std::pair<const uint8_t*, uint64_t>& debug_info_section =
@@ -473,7 +556,7 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
   for (uint64_t offset = 0; offset < debug_info_length;) {
     // Make a handler for the root DIE that populates MODULE with the
     // debug info.
-    DwarfCUToModule::WarningReporter reporter(selected_object_name_,
+    DwarfCUToModule::WarningReporter reporter(object_name,
                                               offset);
     DwarfCUToModule root_handler(&file_context, &line_to_module,
                                  &ranges_handler, &reporter,
@@ -481,7 +564,7 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
     // Make a Dwarf2Handler that drives our DIEHandler.
     DIEDispatcher die_dispatcher(&root_handler);
     // Make a DWARF parser for the compilation unit at OFFSET.
-    CompilationUnit dwarf_reader(selected_object_name_,
+    CompilationUnit dwarf_reader(object_name,
                                                file_context.section_map(),
                                                offset,
                                                &byte_reader,
@@ -492,6 +575,7 @@ void DumpSymbols::ReadDwarf(google_breakpad::Module* module,
 }
 
 bool DumpSymbols::ReadCFI(google_breakpad::Module* module,
+                          const string& object_name,
                           const mach_o::Reader& macho_reader,
                           const mach_o::Section& section,
                           bool eh_frame) const {
@@ -515,7 +599,7 @@ bool DumpSymbols::ReadCFI(google_breakpad::Module* module,
       const NXArchInfo* arch = google_breakpad::BreakpadGetArchInfoFromCpuType(
           macho_reader.cpu_type(), macho_reader.cpu_subtype());
       fprintf(stderr, "%s: cannot convert DWARF call frame information for ",
-              selected_object_name_.c_str());
+              object_name.c_str());
       if (arch)
         fprintf(stderr, "architecture '%s'", arch->name);
       else
@@ -531,7 +615,7 @@ bool DumpSymbols::ReadCFI(google_breakpad::Module* module,
   size_t cfi_size = section.contents.Size();
 
   // Plug together the parser, handler, and their entourages.
-  DwarfCFIToModule::Reporter module_reporter(selected_object_name_,
+  DwarfCFIToModule::Reporter module_reporter(object_name,
                                              section.section_name);
   DwarfCFIToModule handler(module, register_names, &module_reporter);
   ByteReader byte_reader(macho_reader.big_endian() ?
@@ -543,7 +627,7 @@ bool DumpSymbols::ReadCFI(google_breakpad::Module* module,
   // this is the only base address the CFI parser will need.
   byte_reader.SetCFIDataBase(section.address, cfi);
 
-  CallFrameInfo::Reporter dwarf_reporter(selected_object_name_,
+  CallFrameInfo::Reporter dwarf_reporter(object_name,
                                                        section.section_name);
   CallFrameInfo parser(cfi, cfi_size,
                                      &byte_reader, &handler, &dwarf_reporter,
@@ -561,11 +645,13 @@ class DumpSymbols::LoadCommandDumper:
   // file, and adding data to MODULE.
   LoadCommandDumper(const DumpSymbols& dumper,
                     google_breakpad::Module* module,
+                    const string& object_name,
                     const mach_o::Reader& reader,
                     SymbolData symbol_data,
                     bool handle_inter_cu_refs)
       : dumper_(dumper),
         module_(module),
+        object_name_(object_name),
         reader_(reader),
         symbol_data_(symbol_data),
         handle_inter_cu_refs_(handle_inter_cu_refs) { }
@@ -576,6 +662,7 @@ class DumpSymbols::LoadCommandDumper:
  private:
   const DumpSymbols& dumper_;
   google_breakpad::Module* module_;  // WEAK
+  const string& object_name_;
   const mach_o::Reader& reader_;
   const SymbolData symbol_data_;
   const bool handle_inter_cu_refs_;
@@ -593,7 +680,8 @@ bool DumpSymbols::LoadCommandDumper::SegmentCommand(const Segment& segment) {
           section_map.find("__eh_frame");
       if (eh_frame != section_map.end()) {
         // If there is a problem reading this, don't treat it as a fatal error.
-        dumper_.ReadCFI(module_, reader_, eh_frame->second, true);
+        dumper_.ReadCFI(module_, object_name_, reader_, eh_frame->second,
+                        true);
       }
     }
     return true;
@@ -601,14 +689,16 @@ bool DumpSymbols::LoadCommandDumper::SegmentCommand(const Segment& segment) {
 
   if (segment.name == "__DWARF") {
     if ((symbol_data_ & SYMBOLS_AND_FILES) || (symbol_data_ & INLINES)) {
-      dumper_.ReadDwarf(module_, reader_, section_map, handle_inter_cu_refs_);
+      dumper_.ReadDwarf(module_, object_name_, reader_, section_map,
+                        handle_inter_cu_refs_);
     }
     if (symbol_data_ & CFI) {
       mach_o::SectionMap::const_iterator debug_frame
           = section_map.find("__debug_frame");
       if (debug_frame != section_map.end()) {
         // If there is a problem reading this, don't treat it as a fatal error.
-        dumper_.ReadCFI(module_, reader_, debug_frame->second, false);
+        dumper_.ReadCFI(module_, object_name_, reader_, debug_frame->second,
+                        false);
       }
     }
   }
@@ -634,24 +724,77 @@ bool DumpSymbols::LoadCommandDumper::SymtabCommand(const ByteBuffer& entries,
 }
 
 bool DumpSymbols::ReadSymbolData(Module** out_module) {
+  if (!SelectDefaultObjectFile())
+    return false;
+  return ReadSymbolData(selected_object_file_, out_module);
+}
+
+bool DumpSymbols::ReadSymbolData(const SuperFatArch* object_file,
+                                 Module** out_module) const {
   scoped_ptr<Module> module;
-  if (!CreateEmptyModule(module))
+  string object_name;
+  if (!CreateEmptyModule(object_file, module, &object_name))
+    return false;
+
+  // Parse the object file, in place in the mapping.
+  mach_o::Reader::Reporter reporter(object_name);
+  mach_o::Reader reader(&reporter);
+  if (object_file->offset > contents_size_ ||
+      object_file->size > contents_size_ - object_file->offset) {
+    fprintf(stderr, "%s: object file extends past the end of the file\n",
+            object_name.c_str());
+    return false;
+  }
+  if (!reader.Read(contents_ + object_file->offset,
+                   object_file->size,
+                   object_file->cputype,
+                   object_file->cpusubtype))
     return false;
 
-  // Parse the selected object file.
-  mach_o::Reader::Reporter reporter(selected_object_name_);
+  if (!ReadLoadCommands(reader, object_name, module.get()))
+    return false;
+
+  *out_module = module.release();
+
+  return true;
+}
+
+bool DumpSymbols::ReadSharedCacheImage(const SharedCacheReader::Image& image,
+                                       Module** out_module) const {
+  const string object_name = object_filename_ + ", image " + image.path;
+
+  // Parse the image in place in the cache. Its load commands give file
+  // offsets from the start of the cache, where the segments it shares
+  // with the other images are.
+  mach_o::Reader::Reporter reporter(object_name);
   mach_o::Reader reader(&reporter);
-  if (!reader.Read(&contents_[0]
-                   + selected_object_file_->offset,
-                   selected_object_file_->size,
-                   selected_object_file_->cputype,
-                   selected_object_file_->cpusubtype))
+  if (!reader.ReadImage(contents_, contents_size_, image.header_offset,
+                        CPU_TYPE_ANY, 0))
+    return false;
+
+  const char* arch_name =
+      ArchitectureName(reader.cpu_type(), reader.cpu_subtype());
+  if (!arch_name) {
+    fprintf(stderr, "%s: unrecognized cpu type 0x%x, subtype 0x%x\n",
+            object_name.c_str(), reader.cpu_type(), reader.cpu_subtype());
+    return false;
+  }
+
+  // The cache's images have no file of their own for FileID to read, so
+  // take the identifier from the image's own LC_UUID.
+  UUIDFinder uuid_finder;
+  unsigned char identifier_bytes[16];
+  if (!reader.WalkLoadCommands(&uuid_finder) ||
+      !uuid_finder.GetUUID(identifier_bytes)) {
+    fprintf(stderr, "Unable to find UUID of mach-o binary %s!\n",
+            object_name.c_str());
     return false;
+  }
 
-  // Walk its load commands, and deal with whatever is there.
-  LoadCommandDumper load_command_dumper(*this, module.get(), reader,
-                                        symbol_data_, handle_inter_cu_refs_);
-  if (!reader.WalkLoadCommands(&load_command_dumper))
+  scoped_ptr<Module> module(new Module(google_breakpad::BaseName(image.path),
+                                       "mac", arch_name,
+                                       FormatIdentifier(identifier_bytes)));
+  if (!ReadLoadCommands(reader, object_name, module.get()))
     return false;
 
   *out_module = module.release();
@@ -659,6 +802,76 @@ bool DumpSymbols::ReadSymbolData(Module** out_module) {
   return true;
 }
 
+bool DumpSymbols::ReadLoadCommands(const mach_o::Reader& reader,
+                                   const string& object_name,
+                                   Module* module) const {
+  // Walk the load commands, and deal with whatever is there.
+  LoadCommandDumper load_command_dumper(*this, module, object_name,
+                                        reader, symbol_data_,
+                                        handle_inter_cu_refs_);
+  return reader.WalkLoadCommands(&load_command_dumper);
+}
+
+bool DumpSymbols::ReadSymbolData(
+    const vector<const SuperFatArch*>& object_files,
+    vector<Module*>* modules) {
+  // The object files are slices of the one mapping, and reading one
+  // changes nothing shared, so each can be read on its own thread.
+  vector<Module*> results(object_files.size(), NULL);
+  vector<char> succeeded(object_files.size(), false);
+  vector<std::thread> threads;
+  for (size_t i = 1; i < object_files.size(); ++i) {
+    threads.push_back(std::thread([&, i]() {
+      succeeded[i] = ReadSymbolData(object_files[i], &results[i]);
+    }));
+  }
+  if (!object_files.empty())
+    succeeded[0] = ReadSymbolData(object_files[0], &results[0]);
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  bool result = true;
+  for (size_t i = 0; i < object_files.size(); ++i)
+    result = result && succeeded[i];
+  if (!result) {
+    for (size_t i = 0; i < results.size(); ++i)
+      delete results[i];
+    return false;
+  }
+  modules->swap(results);
+  return true;
+}
+
+bool DumpSymbols::ReadSharedCacheSymbolData(
+    const vector<const SharedCacheReader::Image*>& images,
+    vector<Module*>* modules) {
+  // Like object files, the images are read in place in the one mapping,
+  // changing nothing shared. A cache holds over a thousand images, so
+  // rather than a thread each, a thread per processor takes them in turn.
+  vector<Module*> results(images.size(), NULL);
+  std::atomic<size_t> next_image(0);
+  std::atomic<bool> result(true);
+  auto read_images = [&]() {
+    size_t i;
+    while ((i = next_image++) < images.size()) {
+      if (!ReadSharedCacheImage(*images[i], &results[i]))
+        result = false;
+    }
+  };
+  size_t thread_count = std::thread::hardware_concurrency();
+  if (thread_count > images.size())
+    thread_count = images.size();
+  vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i)
+    threads.push_back(std::thread(read_images));
+  read_images();
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  modules->swap(results);
+  return result;
+}
+
 bool DumpSymbols::WriteSymbolFile(std::ostream& stream) {
   Module* module = NULL;
 
@@ -43,6 +43,7 @@
 #include <string>
 #include <vector>
 
+#include "common/basictypes.h"
 #include "common/byte_cursor.h"
 #include "common/mac/macho_reader.h"
 #include "common/mac/super_fat_arch.h"
@@ -59,12 +60,13 @@ class DumpSymbols {
         handle_inter_cu_refs_(handle_inter_cu_refs),
         input_pathname_(),
         object_filename_(),
-        contents_(),
+        contents_(NULL),
+        contents_size_(0),
         object_files_(),
+        shared_cache_images_(),
         selected_object_file_(),
         selected_object_name_() { }
-  ~DumpSymbols() {
-  }
+  ~DumpSymbols();
 
   // Prepare to read debugging information from |filename|. |filename| may be
   // the name of a universal binary, a Mach-O file, or a dSYM bundle
@@ -93,6 +95,14 @@ class DumpSymbols {
   // architecture matches that of this dumper program.
   bool SetArchitecture(const std::string& arch_name);
 
+  // Return the object file in this dumper's file that SetArchitecture
+  // would select for |cpu_type| and |cpu_subtype|, or NULL if there is
+  // none. This leaves the selected architecture unchanged.
+  const SuperFatArch* FindObjectFile(cpu_type_t cpu_type,
+                                     cpu_subtype_t cpu_subtype) {
+    return FindBestMatchForArchitecture(cpu_type, cpu_subtype);
+  }
+
   // Return a pointer to an array of SuperFatArch structures describing the
   // object files contained in this dumper's file. Set *|count| to the number
   // of elements in the array. The returned array is owned by this DumpSymbols
@@ -122,6 +132,35 @@ class DumpSymbols {
   // module object and must delete it when finished.
   bool ReadSymbolData(Module** module);
 
+  // Read the debugging information of each object file in |object_files|,
+  // elements of the array AvailableArchitectures returns, on a thread of
+  // its own, and set |modules| to the results, in the same order. The
+  // caller owns the resulting module objects and must delete them when
+  // finished. Return true on success; if an error occurs reading any of
+  // the object files, report it, leave |modules| empty, and return false.
+  bool ReadSymbolData(const vector<const SuperFatArch*>& object_files,
+                      vector<Module*>* modules);
+
+  // If the file given to Read is a dyld shared cache, return the images it
+  // holds. The dumper then has no object files to select among, and its
+  // images are read with ReadSharedCacheSymbolData instead. Otherwise,
+  // return an empty vector.
+  const vector<mach_o::SharedCacheReader::Image>& SharedCacheImages() const {
+    return shared_cache_images_;
+  }
+
+  // Read the debugging information of each image in |images|, elements of
+  // the vector SharedCacheImages returns, and set |modules| to the results,
+  // in the same order. The images are read in place in the cache's mapping,
+  // several at once on a thread per processor, so the __LINKEDIT segment
+  // they share is only paged in once. The caller owns the resulting module
+  // objects and must delete them when finished. If an error occurs reading
+  // an image, report it and leave its element of |modules| NULL. Return
+  // true if every image was read.
+  bool ReadSharedCacheSymbolData(
+      const vector<const mach_o::SharedCacheReader::Image*>& images,
+      vector<Module*>* modules);
+
   // Return an identifier string for the file this DumpSymbols is dumping.
   std::string Identifier();
 
@@ -136,12 +175,48 @@ class DumpSymbols {
   SuperFatArch* FindBestMatchForArchitecture(
       cpu_type_t cpu_type, cpu_subtype_t cpu_subtype);
 
+  // Select the object file to dump, if SetArchitecture hasn't been called
+  // to select one explicitly. Return false if there is no obvious choice.
+  bool SelectDefaultObjectFile();
+
   // Creates an empty module object.
   bool CreateEmptyModule(scoped_ptr<Module>& module);
 
+  // Creates an empty module object for |object_file|, and sets
+  // *|object_name| to the name to use for it in error messages. This
+  // changes nothing in this dumper, so that several object files can be
+  // read at once.
+  bool CreateEmptyModule(const SuperFatArch* object_file,
+                         scoped_ptr<Module>& module,
+                         string* object_name) const;
+
+  // Return an identifier string for |object_file|, or the empty string
+  // if it can't be computed.
+  string Identifier(const SuperFatArch* object_file) const;
+
+  // Read the debugging information of |object_file| into a new module,
+  // and set *|out_module| to it. Like CreateEmptyModule, this changes
+  // nothing in this dumper.
+  bool ReadSymbolData(const SuperFatArch* object_file,
+                      Module** out_module) const;
+
+  // Read the debugging information of |image|, in the shared cache this
+  // dumper has read, into a new module, and set *|out_module| to it. Like
+  // CreateEmptyModule, this changes nothing in this dumper.
+  bool ReadSharedCacheImage(const mach_o::SharedCacheReader::Image& image,
+                            Module** out_module) const;
+
+  // Walk the load commands |reader| has read into |module|, using
+  // |object_name| in error messages.
+  bool ReadLoadCommands(const mach_o::Reader& reader,
+                        const string& object_name,
+                        Module* module) const;
+
   // Read debugging information from |dwarf_sections|, which was taken from
-  // |macho_reader|, and add it to |module|.
+  // |macho_reader|, and add it to |module|. Use |object_name| in error
+  // messages.
   void ReadDwarf(google_breakpad::Module* module,
+                 const string& object_name,
                  const mach_o::Reader& macho_reader,
                  const mach_o::SectionMap& dwarf_sections,
                  bool handle_inter_cu_refs) const;
@@ -149,9 +224,10 @@ class DumpSymbols {
   // Read DWARF CFI or .eh_frame data from |section|, belonging to
   // |macho_reader|, and record it in |module|.  If |eh_frame| is true,
   // then the data is .eh_frame-format data; otherwise, it is standard DWARF
-  // .debug_frame data. On success, return true; on failure, report
-  // the problem and return false.
+  // .debug_frame data. Use |object_name| in error messages. On success,
+  // return true; on failure, report the problem and return false.
   bool ReadCFI(google_breakpad::Module* module,
+               const string& object_name,
                const mach_o::Reader& macho_reader,
                const mach_o::Section& section,
                bool eh_frame) const;
@@ -172,8 +248,11 @@ class DumpSymbols {
   // within that bundle.
   std::string object_filename_;
 
-  // The complete contents of object_filename_, mapped into memory.
-  scoped_array<uint8_t> contents_;
+  // The complete contents of object_filename_, mapped into memory, and
+  // their size. Slices of a universal binary are read from the mapping in
+  // place, without being copied.
+  const uint8_t* contents_;
+  size_t contents_size_;
 
   // A vector of SuperFatArch structures describing the object files
   // object_filename_ contains. If object_filename_ refers to a fat binary,
@@ -181,6 +260,10 @@ class DumpSymbols {
   // has exactly one element.
   vector<SuperFatArch> object_files_;
 
+  // If object_filename_ refers to a dyld shared cache, the images it holds,
+  // which are read in place rather than selected among like object_files_.
+  vector<mach_o::SharedCacheReader::Image> shared_cache_images_;
+
   // The object file in object_files_ selected to dump, or NULL if
   // SetArchitecture hasn't been called yet.
   const SuperFatArch* selected_object_file_;
@@ -190,6 +273,8 @@ class DumpSymbols {
   // fat binary, it includes an indication of the particular architecture
   // within that binary.
   string selected_object_name_;
+
+  DISALLOW_COPY_AND_ASSIGN(DumpSymbols);
 };
 
 }  // namespace google_breakpad
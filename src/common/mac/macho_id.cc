@@ -39,6 +39,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -82,7 +84,7 @@ MachoID::~MachoID() {
 // MAX_BLOCK is the largest n such that 255n(n+1)/2 + (n+1)(MAX_BLOCK-1) <= 2^32-1
 #define MAX_BLOCK 5552
 
-void MachoID::UpdateCRC(unsigned char* bytes, size_t size) {
+void MachoID::UpdateCRC(const unsigned char* bytes, size_t size) {
 // Unrolled loops for summing
 #define DO1(buf,i)  {sum1 += (buf)[i]; sum2 += sum1;}
 #define DO2(buf,i)  DO1(buf,i); DO1(buf,i+1);
@@ -122,14 +124,24 @@ void MachoID::UpdateCRC(unsigned char* bytes, size_t size) {
   }
 }
 
-void MachoID::UpdateMD5(unsigned char* bytes, size_t size) {
-  MD5Update(&md5_context_, bytes, static_cast<unsigned>(size));
+void MachoID::UpdateMD5(const unsigned char* bytes, size_t size) {
+  MD5Update(&md5_context_, bytes, size);
 }
 
 void MachoID::Update(MachoWalker* walker, off_t offset, size_t size) {
   if (!update_function_ || !size)
     return;
 
+  // Hash the whole section at once if it is in memory.
+  const unsigned char* bytes =
+      static_cast<const unsigned char*>(walker->BytesAt(offset, size));
+  if (bytes) {
+    (this->*update_function_)(bytes, size);
+    return;
+  }
+
+  // Otherwise the section runs past the end of the memory region or the file.
+  // Hash it in chunks up to the one that can't be read in full, as before.
   // Read up to 4k bytes at a time
   unsigned char buffer[4096];
   size_t buffer_size;
@@ -241,10 +253,32 @@ bool MachoID::WalkHeader(cpu_type_t cpu_type,
   if (memory_) {
     MachoWalker walker(memory_, memory_size_, callback, context);
     return walker.WalkHeader(cpu_type, cpu_subtype);
-  } else {
+  }
+
+  void* mapped = MAP_FAILED;
+  size_t mapped_size = 0;
+  int fd = open(path_, O_RDONLY);
+  if (fd != -1) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      mapped_size = static_cast<size_t>(st.st_size);
+      mapped = mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+  }
+
+  if (mapped == MAP_FAILED) {
     MachoWalker walker(path_, callback, context);
     return walker.WalkHeader(cpu_type, cpu_subtype);
   }
+
+  bool result;
+  {
+    MachoWalker walker(mapped, mapped_size, callback, context);
+    result = walker.WalkHeader(cpu_type, cpu_subtype);
+  }
+  munmap(mapped, mapped_size);
+  return result;
 }
 
 // static
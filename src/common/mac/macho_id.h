@@ -78,20 +78,23 @@ class MachoID {
 
  private:
   // Signature of class member function to be called with data read from file
-  typedef void (MachoID::*UpdateFunction)(unsigned char* bytes, size_t size);
+  typedef void (MachoID::*UpdateFunction)(const unsigned char* bytes,
+                                          size_t size);
 
   // Update the CRC value by examining |size| |bytes| and applying the algorithm
   // to each byte.
-  void UpdateCRC(unsigned char* bytes, size_t size);
+  void UpdateCRC(const unsigned char* bytes, size_t size);
 
   // Update the MD5 value by examining |size| |bytes| and applying the algorithm
   // to each byte.
-  void UpdateMD5(unsigned char* bytes, size_t size);
+  void UpdateMD5(const unsigned char* bytes, size_t size);
 
-  // Bottleneck for update routines
+  // Bottleneck for update routines.  Sections inside the walked memory are
+  // hashed in place; anything else is read in chunks.
   void Update(MachoWalker* walker, off_t offset, size_t size);
 
-  // Factory for the MachoWalker
+  // Factory for the MachoWalker.  When no memory region was given, the file
+  // is mapped so that sections can be hashed without copying them.
   bool WalkHeader(cpu_type_t cpu_type, cpu_subtype_t cpu_subtype,
                   MachoWalker::LoadCommandCallback callback, void* context);
 
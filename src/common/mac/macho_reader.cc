@@ -29,7 +29,8 @@
 
 // Original author: Jim Blandy <jimb@mozilla.com> <jimb@red-bean.com>
 
-// macho_reader.cc: Implementation of google_breakpad::Mach_O::FatReader and
+// macho_reader.cc: Implementation of google_breakpad::Mach_O::FatReader,
+// google_breakpad::Mach_O::SharedCacheReader, and
 // google_breakpad::Mach_O::Reader. See macho_reader.h for details.
 
 #include "common/mac/macho_reader.h"
@@ -37,6 +38,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <limits>
 
@@ -157,6 +159,118 @@ bool FatReader::Read(const uint8_t* buffer, size_t size) {
   return false;
 }
 
+// The layout of a dyld shared cache's header, mapping list, and image
+// list, as given by dyld's dyld_cache_format.h. Shared caches are always
+// little-endian.
+static const size_t kSharedCacheMagicSize = 16;
+static const char kSharedCacheMagicPrefix[] = "dyld_v1 ";
+static const size_t kSharedCacheMappingSize = 32;
+static const size_t kSharedCacheImageSize = 32;
+// Caches from macOS 12 on leave the original image list empty, and give
+// the offset and count of their own after these many bytes of header.
+static const size_t kSharedCacheImagesOffset = 0x1c0;
+
+void SharedCacheReader::Reporter::BadHeader() {
+  fprintf(stderr, "%s: file is not a dyld shared cache\n", filename_.c_str());
+}
+
+void SharedCacheReader::Reporter::TooShort() {
+  fprintf(stderr, "%s: file too short for the data it claims to contain\n",
+          filename_.c_str());
+}
+
+void SharedCacheReader::Reporter::UnmappedImage(const string& path) {
+  fprintf(stderr, "%s: the image '%s' does not lie in this file;"
+          " skipping it\n", filename_.c_str(), path.c_str());
+}
+
+bool SharedCacheReader::IsSharedCache(const uint8_t* buffer, size_t size) {
+  return size >= kSharedCacheMagicSize &&
+      memcmp(buffer, kSharedCacheMagicPrefix,
+             sizeof(kSharedCacheMagicPrefix) - 1) == 0;
+}
+
+bool SharedCacheReader::Read(const uint8_t* buffer, size_t size) {
+  images_.clear();
+  if (!IsSharedCache(buffer, size)) {
+    reporter_->BadHeader();
+    return false;
+  }
+
+  ByteBuffer contents(buffer, size);
+  ByteCursor cursor(&contents, false);
+  uint32_t mappings_offset, mappings_count, images_offset, images_count;
+  cursor.Skip(kSharedCacheMagicSize)
+      >> mappings_offset >> mappings_count >> images_offset >> images_count;
+  if (!cursor) {
+    reporter_->TooShort();
+    return false;
+  }
+  // The header ends where the mapping list begins, so a field is only
+  // present if the mapping list starts past it.
+  if (images_count == 0 && mappings_offset >= kSharedCacheImagesOffset + 8 &&
+      mappings_offset <= size) {
+    cursor.set_here(buffer + kSharedCacheImagesOffset);
+    cursor >> images_offset >> images_count;
+  }
+  if (mappings_offset > size ||
+      mappings_count > (size - mappings_offset) / kSharedCacheMappingSize ||
+      images_offset > size ||
+      images_count > (size - images_offset) / kSharedCacheImageSize) {
+    reporter_->TooShort();
+    return false;
+  }
+
+  // Read the mappings, which say where each address range's contents lie
+  // in this file.
+  struct Mapping {
+    uint64_t address, size, file_offset;
+  };
+  vector<Mapping> mappings(mappings_count);
+  cursor.set_here(buffer + mappings_offset);
+  for (Mapping& mapping : mappings) {
+    cursor >> mapping.address >> mapping.size >> mapping.file_offset;
+    cursor.Skip(kSharedCacheMappingSize - 3 * sizeof(uint64_t));
+  }
+
+  // Read the image list, and find each image's header in the mappings.
+  images_.reserve(images_count);
+  cursor.set_here(buffer + images_offset);
+  for (size_t i = 0; i < images_count; i++) {
+    Image image;
+    uint64_t modification_time, inode;
+    uint32_t path_offset, padding;
+    cursor >> image.address >> modification_time >> inode
+           >> path_offset >> padding;
+    ByteCursor path_cursor(&contents);
+    if (path_offset < size)
+      path_cursor.set_here(buffer + path_offset);
+    if (path_offset >= size || !path_cursor.CString(&image.path)) {
+      reporter_->TooShort();
+      return false;
+    }
+
+    bool mapped = false;
+    for (const Mapping& mapping : mappings) {
+      if (image.address >= mapping.address &&
+          image.address - mapping.address < mapping.size &&
+          mapping.file_offset <= size &&
+          image.address - mapping.address < size - mapping.file_offset) {
+        image.header_offset =
+            mapping.file_offset + (image.address - mapping.address);
+        mapped = true;
+        break;
+      }
+    }
+    if (mapped)
+      images_.push_back(image);
+    else
+      reporter_->UnmappedImage(image.path);
+  }
+
+  return true;
+}
+
 void Reader::Reporter::BadHeader() {
   fprintf(stderr, "%s: file is not a Mach-O object file\n", filename_.c_str());
 }
@@ -229,12 +343,20 @@ bool Reader::Read(const uint8_t* buffer,
                   size_t size,
                   cpu_type_t expected_cpu_type,
                   cpu_subtype_t expected_cpu_subtype) {
+  return ReadImage(buffer, size, 0, expected_cpu_type, expected_cpu_subtype);
+}
+
+bool Reader::ReadImage(const uint8_t* buffer,
+                       size_t size,
+                       size_t header_offset,
+                       cpu_type_t expected_cpu_type,
+                       cpu_subtype_t expected_cpu_subtype) {
   assert(!buffer_.start);
   buffer_.start = buffer;
   buffer_.end = buffer + size;
   ByteCursor cursor(&buffer_, true);
   uint32_t magic;
-  if (!(cursor >> magic)) {
+  if (!(cursor.Skip(header_offset) >> magic)) {
     reporter_->HeaderTruncated();
     return false;
   }
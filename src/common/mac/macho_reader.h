@@ -153,6 +153,82 @@ class FatReader {
   vector<SuperFatArch> object_files_;
 };
 
+// A parser for dyld shared cache files, which hold the system's libraries
+// laid out together as the dynamic linker maps them, sharing a single
+// __LINKEDIT segment. This lists the images a cache holds; Reader::ReadImage
+// can then read each in place in the cache. Caches split across several
+// files are only partly supported: images whose headers lie in another
+// file are skipped.
+class SharedCacheReader {
+ public:
+
+  // A class for reporting errors found while parsing dyld shared cache
+  // files. The default definitions of these methods print messages to
+  // stderr.
+  class Reporter {
+   public:
+    // Create a reporter that attributes problems to |filename|.
+    explicit Reporter(const string& filename) : filename_(filename) { }
+
+    virtual ~Reporter() { }
+
+    // The data does not begin with a dyld shared cache magic number.
+    // This is a fatal error.
+    virtual void BadHeader();
+
+    // The file ends abruptly, without enough space to contain the
+    // header, the mapping list, the image list, or an image path the
+    // header claims are present. This is a fatal error.
+    virtual void TooShort();
+
+    // The header of the image at |path| does not lie in this file's
+    // mappings. The image is left out of the list.
+    virtual void UnmappedImage(const string& path);
+
+   private:
+    // The filename to which the reader should attribute problems.
+    string filename_;
+  };
+
+  // An image the cache holds.
+  struct Image {
+    // The image's install name, like "/usr/lib/libSystem.B.dylib".
+    string path;
+
+    // The address at which the image's Mach-O header is loaded.
+    uint64_t address;
+
+    // The offset of the image's Mach-O header from the start of the
+    // cache file.
+    uint64_t header_offset;
+  };
+
+  // Create a dyld shared cache reader that uses |reporter| to report
+  // problems.
+  explicit SharedCacheReader(Reporter* reporter) : reporter_(reporter) { }
+
+  // Return true if the |size| bytes at |buffer| begin with a dyld shared
+  // cache magic number.
+  static bool IsSharedCache(const uint8_t* buffer, size_t size);
+
+  // Read the |size| bytes at |buffer| as a dyld shared cache file. On
+  // success, return true; on failure, report the problem to reporter_ and
+  // return false.
+  bool Read(const uint8_t* buffer, size_t size);
+
+  // Return the images present in this cache, in the order the cache
+  // lists them. Assuming Read returned true, each image's header_offset
+  // lies within the bytes passed to Read.
+  const vector<Image>& images() const { return images_; }
+
+ private:
+  // We use this to report problems parsing the file's contents. (WEAK)
+  Reporter* reporter_;
+
+  // The images present in this cache.
+  vector<Image> images_;
+};
+
 // A segment in a Mach-O file. All these fields have been byte-swapped as
 // appropriate for use by the executing architecture.
 struct Segment {
@@ -369,8 +445,8 @@ class Reader {
   // into the data passed, so the data should live as long as the reader
   // does. On success, return true; on failure, return false.
   //
-  // At most one of these functions should be invoked once on each Reader
-  // instance.
+  // At most one of these functions, or ReadImage, should be invoked once
+  // on each Reader instance.
   bool Read(const uint8_t* buffer,
             size_t size,
             cpu_type_t expected_cpu_type,
@@ -384,6 +460,18 @@ class Reader {
                 expected_cpu_subtype);
   }
 
+  // Read the Mach-O image whose header sits |header_offset| bytes into
+  // the given data, as the images in a dyld shared cache do. The file
+  // offsets in the image's load commands are taken relative to the
+  // start of the data, not to the header, so the image's segments and
+  // symbol table may be anywhere in the data, and may be shared with
+  // other images. Otherwise, this is like Read.
+  bool ReadImage(const uint8_t* buffer,
+                 size_t size,
+                 size_t header_offset,
+                 cpu_type_t expected_cpu_type,
+                 cpu_subtype_t expected_cpu_subtype);
+
   // Return this file's characteristics, as found in the Mach-O header.
   cpu_type_t    cpu_type()    const { return cpu_type_; }
   cpu_subtype_t cpu_subtype() const { return cpu_subtype_; }
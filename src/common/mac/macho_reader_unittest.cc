@@ -51,6 +51,7 @@ using mach_o::Reader;
 using mach_o::Section;
 using mach_o::SectionMap;
 using mach_o::Segment;
+using mach_o::SharedCacheReader;
 using test_assembler::Endianness;
 using test_assembler::Label;
 using test_assembler::kBigEndian;
@@ -82,6 +83,15 @@ class MockFatReaderReporter: public FatReader::Reporter {
   MOCK_METHOD0(TooShort, void());
 };
 
+class MockSharedCacheReaderReporter: public SharedCacheReader::Reporter {
+ public:
+  MockSharedCacheReaderReporter(const string& filename)
+      : SharedCacheReader::Reporter(filename) { }
+  MOCK_METHOD0(BadHeader, void());
+  MOCK_METHOD0(TooShort, void());
+  MOCK_METHOD1(UnmappedImage, void(const string& path));
+};
+
 class MockReaderReporter: public Reader::Reporter {
  public:
   MockReaderReporter(const string& filename) : Reader::Reporter(filename) { }
@@ -462,6 +472,186 @@ TEST_F(FatReaderTest, IncompleteMach) {
   ReadFat(false);
 }
 
+
+// Tests for mach_o::SharedCacheReader.
+
+// Since the effect of these functions is to write to stderr, the
+// results of these tests must be inspected by hand.
+TEST(SharedCacheReaderReporter, BadHeader) {
+  SharedCacheReader::Reporter reporter("filename");
+  reporter.BadHeader();
+}
+
+TEST(SharedCacheReaderReporter, TooShort) {
+  SharedCacheReader::Reporter reporter("filename");
+  reporter.TooShort();
+}
+
+TEST(SharedCacheReaderReporter, UnmappedImage) {
+  SharedCacheReader::Reporter reporter("filename");
+  reporter.UnmappedImage("/usr/lib/libfoo.dylib");
+}
+
+struct SharedCacheReaderFixture {
+  SharedCacheReaderFixture()
+      : cache(kLittleEndian),
+        reporter("reporter filename"),
+        reader(&reporter) {
+    EXPECT_CALL(reporter, BadHeader()).Times(0);
+    EXPECT_CALL(reporter, TooShort()).Times(0);
+    EXPECT_CALL(reporter, UnmappedImage(_)).Times(0);
+
+    // here, start, and Mark are file offsets in 'cache'.
+    cache.start() = 0;
+  }
+  // Append a dyld_cache_mapping_info entry to 'cache'.
+  void AppendMapping(uint64_t address, uint64_t size, uint64_t file_offset) {
+    cache
+        .D64(address)
+        .D64(size)
+        .D64(file_offset)
+        .D32(5)                         // maximum protection
+        .D32(5);                        // initial protection
+  }
+  // Append a dyld_cache_image_info entry to 'cache'.
+  void AppendImage(uint64_t address, Label path) {
+    cache
+        .D64(address)
+        .D64(0x5f1b0a1c)                // modification time
+        .D64(0x1d4c)                    // inode
+        .D32(path)                      // file offset of path
+        .D32(0);                        // padding
+  }
+  void ReadCache(bool expect_parse_success = true) {
+    ASSERT_TRUE(cache.GetContents(&contents));
+    const uint8_t* cache_bytes =
+        reinterpret_cast<const uint8_t*>(contents.data());
+    EXPECT_TRUE(SharedCacheReader::IsSharedCache(cache_bytes,
+                                                 contents.size()));
+    EXPECT_EQ(expect_parse_success,
+              reader.Read(cache_bytes, contents.size()));
+  }
+  test_assembler::Section cache;
+  MockSharedCacheReaderReporter reporter;
+  SharedCacheReader reader;
+  string contents;
+};
+
+class SharedCacheReaderTest: public SharedCacheReaderFixture, public Test { };
+
+TEST_F(SharedCacheReaderTest, BadMagic) {
+  EXPECT_CALL(reporter, BadHeader()).Times(1);
+  cache.AppendCString("dyld_v2   x86_64", 16).Append(16, 0);
+  ASSERT_TRUE(cache.GetContents(&contents));
+  const uint8_t* cache_bytes =
+      reinterpret_cast<const uint8_t*>(contents.data());
+  EXPECT_FALSE(SharedCacheReader::IsSharedCache(cache_bytes,
+                                                contents.size()));
+  EXPECT_FALSE(reader.Read(cache_bytes, contents.size()));
+}
+
+TEST_F(SharedCacheReaderTest, HeaderTooShort) {
+  EXPECT_CALL(reporter, TooShort()).Times(1);
+  cache
+      .AppendCString("dyld_v1   arm64e", 16)
+      .D32(0x20)                        // mapping list offset
+      .D32(1);                          // mapping count
+      // Truncated!
+  ReadCache(false);
+}
+
+TEST_F(SharedCacheReaderTest, ImageListTooShort) {
+  EXPECT_CALL(reporter, TooShort()).Times(1);
+  Label mappings, images;
+  cache
+      .AppendCString("dyld_v1  x86_64h", 16)
+      .D32(mappings)                    // mapping list offset
+      .D32(0)                           // mapping count
+      .D32(images)                      // image list offset
+      .D32(3)                           // image count
+      .Mark(&mappings)
+      .Mark(&images);
+  AppendImage(0x7ff800000000ULL, 0);
+  AppendImage(0x7ff800001000ULL, 0);    // and only two images
+  ReadCache(false);
+}
+
+TEST_F(SharedCacheReaderTest, Images) {
+  EXPECT_CALL(reporter, UnmappedImage("/usr/lib/libgone.dylib")).Times(1);
+  Label mappings, images, foo_path, bar_path, gone_path;
+  cache
+      .AppendCString("dyld_v1   arm64e", 16)
+      .D32(mappings)                    // mapping list offset
+      .D32(2)                           // mapping count
+      .D32(images)                      // image list offset
+      .D32(3)                           // image count
+      .Mark(&mappings);
+  AppendMapping(0x180000000ULL, 0x2000, 0);
+  AppendMapping(0x1e0000000ULL, 0x1000, 0x2000);
+  cache.Mark(&images);
+  AppendImage(0x180001000ULL, foo_path);
+  AppendImage(0x1e0000800ULL, bar_path);
+  AppendImage(0x1f0000000ULL, gone_path);  // in no mapping
+  cache
+      .Mark(&foo_path).AppendCString("/usr/lib/libfoo.dylib")
+      .Mark(&bar_path).AppendCString("/usr/lib/libbar.dylib")
+      .Mark(&gone_path).AppendCString("/usr/lib/libgone.dylib");
+  cache.Append(0x3000 - cache.Size(), 0);
+  ReadCache();
+
+  const vector<SharedCacheReader::Image>& found = reader.images();
+  ASSERT_EQ(2U, found.size());
+  EXPECT_EQ("/usr/lib/libfoo.dylib", found[0].path);
+  EXPECT_EQ(0x180001000ULL, found[0].address);
+  EXPECT_EQ(0x1000U, found[0].header_offset);
+  EXPECT_EQ("/usr/lib/libbar.dylib", found[1].path);
+  EXPECT_EQ(0x1e0000800ULL, found[1].address);
+  EXPECT_EQ(0x2800U, found[1].header_offset);
+}
+
+TEST_F(SharedCacheReaderTest, RelocatedImageList) {
+  Label mappings, images, foo_path;
+  cache
+      .AppendCString("dyld_v1   arm64e", 16)
+      .D32(mappings)                    // mapping list offset
+      .D32(1)                           // mapping count
+      .D32(0)                           // original image list offset
+      .D32(0);                          // original image count
+  cache.Append(0x1c0 - cache.Size(), 0);
+  cache
+      .D32(images)                      // image list offset
+      .D32(1)                           // image count
+      .Mark(&mappings);
+  AppendMapping(0x180000000ULL, 0x1000, 0);
+  cache.Mark(&images);
+  AppendImage(0x180000800ULL, foo_path);
+  cache.Mark(&foo_path).AppendCString("/usr/lib/libfoo.dylib");
+  cache.Append(0x1000 - cache.Size(), 0);
+  ReadCache();
+
+  const vector<SharedCacheReader::Image>& found = reader.images();
+  ASSERT_EQ(1U, found.size());
+  EXPECT_EQ("/usr/lib/libfoo.dylib", found[0].path);
+  EXPECT_EQ(0x800U, found[0].header_offset);
+}
+
+TEST_F(SharedCacheReaderTest, PathPastEnd) {
+  EXPECT_CALL(reporter, TooShort()).Times(1);
+  Label mappings, images;
+  cache
+      .AppendCString("dyld_v1   arm64e", 16)
+      .D32(mappings)                    // mapping list offset
+      .D32(1)                           // mapping count
+      .D32(images)                      // image list offset
+      .D32(1)                           // image count
+      .Mark(&mappings);
+  AppendMapping(0x180000000ULL, 0x1000, 0);
+  cache.Mark(&images);
+  AppendImage(0x180000000ULL, 0x10000);  // path beyond the end
+  ReadCache(false);
+}
+
+
 
 // General mach_o::Reader tests.
 
@@ -1647,6 +1837,52 @@ TEST_F(LoadCommand, ZappedSegment) {
   EXPECT_TRUE(reader.WalkSegmentSections(actual_segment, &section_handler));
 }
 
+TEST_F(LoadCommand, ImageInSharedCache) {
+  WithConfiguration config(kLittleEndian, 64);
+  LoadedSection segment;
+  segment.address() = 0x7ff80a2c1000ULL;
+  segment.Append(42, '*');              // segment contents
+  SegmentLoadCommand segment_command;
+  segment_command.Header("__TEXT", segment, 5, 5, 0);
+  LoadCommands load_commands;
+  load_commands.Place(&segment_command);
+  MachOFile file;
+  file.Append(0x100, 0);                // the rest of the cache
+  file
+      .Header(&load_commands)
+      .Place(&segment);
+
+  ASSERT_TRUE(file.GetContents(&file_contents));
+  file_bytes = reinterpret_cast<const uint8_t*>(file_contents.data());
+  EXPECT_TRUE(reader.ReadImage(file_bytes, file_contents.size(), 0x100,
+                               CPU_TYPE_ANY, 0));
+
+  // The segment's file offset is from the start of the cache, not from
+  // the image's header.
+  Segment actual_segment;
+  EXPECT_CALL(load_command_handler, SegmentCommand(_))
+    .WillOnce(DoAll(SaveArg<0>(&actual_segment),
+                    Return(true)));
+  EXPECT_TRUE(reader.WalkLoadCommands(&load_command_handler));
+  EXPECT_EQ("__TEXT", actual_segment.name);
+  EXPECT_EQ(file_bytes + segment.start().Value(),
+            actual_segment.contents.start);
+  EXPECT_EQ(segment.final_size().Value(), actual_segment.contents.Size());
+}
+
+TEST_F(LoadCommand, ImageHeaderPastEnd) {
+  WithConfiguration config(kLittleEndian, 64);
+  LoadCommands load_commands;
+  MachOFile file;
+  file.Header(&load_commands);
+
+  ASSERT_TRUE(file.GetContents(&file_contents));
+  file_bytes = reinterpret_cast<const uint8_t*>(file_contents.data());
+  EXPECT_CALL(reporter, HeaderTruncated()).Times(1);
+  EXPECT_FALSE(reader.ReadImage(file_bytes, file_contents.size(),
+                                file_contents.size(), CPU_TYPE_ANY, 0));
+}
+
 TEST_F(LoadCommand, MapSegmentSections) {
   WithConfiguration config(kLittleEndian, 32);
 
@@ -116,6 +116,13 @@ bool MachoWalker::ReadBytes(void* buffer, size_t size, off_t offset) {
   }
 }
 
+const void* MachoWalker::BytesAt(off_t offset, size_t size) const {
+  if (!memory_ || offset < 0 || static_cast<size_t>(offset) > memory_size_ ||
+      size > memory_size_ - static_cast<size_t>(offset))
+    return NULL;
+  return static_cast<const char*>(memory_) + offset;
+}
+
 bool MachoWalker::CurrentHeader(struct mach_header_64* header, off_t* offset) {
   if (current_header_) {
     memcpy(header, current_header_, sizeof(mach_header_64));
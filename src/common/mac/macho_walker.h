@@ -69,6 +69,11 @@ class MachoWalker {
   // Read |size| bytes from the opened file at |offset| into |buffer|
   bool ReadBytes(void* buffer, size_t size, off_t offset);
 
+  // When walking a memory region, return a pointer to the |size| bytes at
+  // |offset| so they can be used without copying.  Return NULL when walking
+  // a file or if the bytes are not all inside the region.
+  const void* BytesAt(off_t offset, size_t size) const;
+
   // Return the current header and header offset
   bool CurrentHeader(struct mach_header_64* header, off_t* offset);
 
@@ -55,8 +55,10 @@ namespace google_breakpad {
 // This is very simple allocator which fetches pages from the kernel directly.
 // Thus, it can be used even when the heap may be corrupted.
 //
-// There is no free operation. The pages are only freed when the object is
-// destroyed.
+// Free() keeps a block on a free list for Alloc() to hand out again. The
+// pages are only returned to the kernel, or to the reserve they came from
+// (see Reserve()), when the object is destroyed. Memory handed out again
+// isn't zeroed.
 class PageAllocator {
  public:
   PageAllocator()
@@ -64,7 +66,8 @@ class PageAllocator {
         last_(NULL),
         current_page_(NULL),
         page_offset_(0),
-        pages_allocated_(0) {
+        pages_allocated_(0),
+        free_lists_() {
   }
 
   ~PageAllocator() {
@@ -75,6 +78,14 @@ class PageAllocator {
     if (!bytes)
       return NULL;
 
+    // Any block on this list is at least as large as |bytes|.
+    const unsigned size_class = SizeClass(bytes, true);
+    if (size_class < kSizeClasses && free_lists_[size_class]) {
+      FreeBlock* const block = free_lists_[size_class];
+      free_lists_[size_class] = block->next;
+      return block;
+    }
+
     if (current_page_ && page_size_ - page_offset_ >= bytes) {
       uint8_t* const ret = current_page_ + page_offset_;
       page_offset_ += bytes;
@@ -100,6 +111,52 @@ class PageAllocator {
     return ret + sizeof(PageHeader);
   }
 
+  // Puts the |bytes| at |p|, which Alloc() returned, on a free list. Blocks
+  // too small or misaligned to link are dropped.
+  void Free(void* p, size_t bytes) {
+    if (!p || bytes < sizeof(FreeBlock) ||
+        reinterpret_cast<uintptr_t>(p) % sizeof(FreeBlock*)) {
+      return;
+    }
+    const unsigned size_class = SizeClass(bytes, false);
+    FreeBlock* const block = reinterpret_cast<FreeBlock*>(p);
+    block->next = free_lists_[size_class];
+    free_lists_[size_class] = block;
+  }
+
+  // Maps |bytes| of pages for every PageAllocator in the process to take
+  // pages from before it maps its own. An allocator gives the pages it took
+  // back when it is destroyed, and the reserve starts again from its first
+  // page whenever all of them are back, so that a handler can call this
+  // once and then write dump after dump without mmap(). Taking and giving
+  // pages back is lock-free, so it is safe in a signal handler.
+  // Returns false if a reserve exists or the pages can't be mapped.
+  static bool Reserve(size_t bytes) {
+    PageReserve* const reserve = GetReserve();
+    const size_t page_size = getpagesize();
+    const size_t num_pages = (bytes + page_size - 1) / page_size;
+    if (!num_pages || num_pages > kMaxReservePages ||
+        __atomic_load_n(&reserve->pages, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    void* a = sys_mmap(NULL, page_size * num_pages, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (a == MAP_FAILED)
+      return false;
+#if defined(MEMORY_SANITIZER)
+    __msan_unpoison(a, page_size * num_pages);
+#endif
+    reserve->num_pages = num_pages;
+    uint8_t* expected = NULL;
+    if (!__atomic_compare_exchange_n(&reserve->pages, &expected,
+                                     reinterpret_cast<uint8_t*>(a), false,
+                                     __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+      sys_munmap(a, page_size * num_pages);
+      return false;
+    }
+    return true;
+  }
+
   // Checks whether the page allocator owns the passed-in pointer.
   // This method exists for testing pursposes only.
   bool OwnsPointer(const void* p) {
@@ -116,16 +173,20 @@ class PageAllocator {
 
  private:
   uint8_t* GetNPages(size_t num_pages) {
-    void* a = sys_mmap(NULL, page_size_ * num_pages, PROT_READ | PROT_WRITE,
-                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (a == MAP_FAILED)
-      return NULL;
+    void* a = TakeReservedPages(num_pages);
+    if (!a) {
+      a = sys_mmap(NULL, page_size_ * num_pages, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (a == MAP_FAILED)
+        return NULL;
 
 #if defined(MEMORY_SANITIZER)
-    // We need to indicate to MSan that memory allocated through sys_mmap is
-    // initialized, since linux_syscall_support.h doesn't have MSan hooks.
-    __msan_unpoison(a, page_size_ * num_pages);
+      // We need to indicate to MSan that memory allocated through sys_mmap
+      // is initialized, since linux_syscall_support.h doesn't have MSan
+      // hooks.
+      __msan_unpoison(a, page_size_ * num_pages);
 #endif
+    }
 
     struct PageHeader* header = reinterpret_cast<PageHeader*>(a);
     header->next = last_;
@@ -139,11 +200,88 @@ class PageAllocator {
 
   void FreeAll() {
     PageHeader* next;
+    size_t reserved_pages = 0;
 
     for (PageHeader* cur = last_; cur; cur = next) {
       next = cur->next;
-      sys_munmap(cur, cur->num_pages * page_size_);
+      if (IsReserved(cur))
+        reserved_pages += cur->num_pages;
+      else
+        sys_munmap(cur, cur->num_pages * page_size_);
     }
+    if (reserved_pages)
+      GiveBackReservedPages(reserved_pages);
+  }
+
+  // The pages of the reserve, and the state of the reserve in one word so
+  // that it changes atomically: how many pages have been taken from its
+  // front in the upper half, and how many of those are still taken in the
+  // lower half.
+  struct PageReserve {
+    uint8_t* pages;
+    size_t num_pages;
+    uint64_t state;
+  };
+  static const uint64_t kMaxReservePages = 0xffffffff;
+
+  // The process's reserve. It needs no construction, so it is zeroed
+  // before any code runs.
+  static PageReserve* GetReserve() {
+    static PageReserve reserve;
+    return &reserve;
+  }
+
+  uint8_t* TakeReservedPages(size_t num_pages) {
+    PageReserve* const reserve = GetReserve();
+    uint8_t* const pages = __atomic_load_n(&reserve->pages, __ATOMIC_ACQUIRE);
+    if (!pages)
+      return NULL;
+    uint64_t state = __atomic_load_n(&reserve->state, __ATOMIC_RELAXED);
+    uint64_t taken;
+    do {
+      taken = state >> 32;
+      if (num_pages > reserve->num_pages - taken)
+        return NULL;
+      const uint64_t in_use = (state & kMaxReservePages) + num_pages;
+      const uint64_t new_state = ((taken + num_pages) << 32) | in_use;
+      if (__atomic_compare_exchange_n(&reserve->state, &state, new_state, true,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } while (true);
+    return pages + taken * page_size_;
+  }
+
+  void GiveBackReservedPages(size_t num_pages) {
+    PageReserve* const reserve = GetReserve();
+    uint64_t state = __atomic_load_n(&reserve->state, __ATOMIC_RELAXED);
+    uint64_t new_state;
+    do {
+      const uint64_t in_use = (state & kMaxReservePages) - num_pages;
+      new_state = in_use ? (state & ~kMaxReservePages) | in_use : 0;
+    } while (!__atomic_compare_exchange_n(&reserve->state, &state, new_state,
+                                          true, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_RELAXED));
+  }
+
+  bool IsReserved(const void* p) const {
+    const PageReserve* const reserve = GetReserve();
+    const uint8_t* const pages =
+        __atomic_load_n(&reserve->pages, __ATOMIC_ACQUIRE);
+    return pages && p >= pages && p < pages + reserve->num_pages * page_size_;
+  }
+
+  // The size class of |bytes|: the power of two at or above it when
+  // |round_up|, else the one at or below it.
+  static unsigned SizeClass(size_t bytes, bool round_up) {
+    unsigned size_class = 0;
+    while (size_class + 1 < kSizeClasses &&
+           (static_cast<size_t>(1) << (size_class + 1)) <= bytes) {
+      ++size_class;
+    }
+    if (round_up && (static_cast<size_t>(1) << size_class) < bytes)
+      ++size_class;
+    return size_class;
   }
 
   struct PageHeader {
@@ -151,11 +289,18 @@ class PageAllocator {
     size_t num_pages;  // the number of pages in this set.
   };
 
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+  static const unsigned kSizeClasses = sizeof(size_t) * 8;
+
   const size_t page_size_;
   PageHeader* last_;
   uint8_t* current_page_;
   size_t page_offset_;
   unsigned long pages_allocated_;
+  // Freed blocks, by the power of two at or below their size.
+  FreeBlock* free_lists_[kSizeClasses];
 };
 
 // Wrapper to use with STL containers
@@ -193,8 +338,9 @@ struct PageStdAllocator {
     return static_cast<pointer>(allocator_.Alloc(size));
   }
 
-  inline void deallocate(pointer, size_type) {
-    // The PageAllocator doesn't free.
+  inline void deallocate(pointer p, size_type n) {
+    if (p != stackdata_)
+      allocator_.Free(p, sizeof(T) * n);
   }
 
   template <typename U> struct rebind {
@@ -214,7 +360,8 @@ struct PageStdAllocator {
 
 // A wasteful vector is a std::vector, except that it allocates memory from a
 // PageAllocator. It's wasteful because, when resizing, it always allocates a
-// whole new array since the PageAllocator doesn't support realloc.
+// whole new array since the PageAllocator doesn't support realloc. The old
+// array goes on the PageAllocator's free list for later allocations.
 template<class T>
 class wasteful_vector : public std::vector<T, PageStdAllocator<T> > {
  public:
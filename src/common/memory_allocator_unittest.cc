@@ -66,6 +66,53 @@ TEST(PageAllocatorTest, LargeObject) {
   }
 }
 
+TEST(PageAllocatorTest, Free) {
+  PageAllocator allocator;
+
+  void* p = allocator.Alloc(100);
+  ASSERT_FALSE(p == NULL);
+  allocator.Free(p, 100);
+  // A block is handed out again for anything no larger than the power of
+  // two below its size.
+  EXPECT_EQ(p, allocator.Alloc(64));
+  allocator.Free(p, 100);
+  EXPECT_NE(p, allocator.Alloc(65));
+  EXPECT_EQ(1U, allocator.pages_allocated());
+
+  // Blocks too small to link are dropped.
+  void* small = allocator.Alloc(1);
+  allocator.Free(small, 1);
+  EXPECT_NE(small, allocator.Alloc(1));
+}
+
+TEST(PageAllocatorTest, Reserve) {
+  const size_t page_size = getpagesize();
+  ASSERT_TRUE(PageAllocator::Reserve(4 * page_size));
+  EXPECT_FALSE(PageAllocator::Reserve(4 * page_size));
+
+  void* first;
+  {
+    PageAllocator allocator;
+    first = allocator.Alloc(page_size);
+    ASSERT_FALSE(first == NULL);
+    EXPECT_EQ(2U, allocator.pages_allocated());
+    {
+      PageAllocator other;
+      void* second = other.Alloc(page_size);
+      EXPECT_EQ(static_cast<uint8_t*>(first) + 2 * page_size,
+                static_cast<uint8_t*>(second));
+      // The reserve has run out, so this is mapped.
+      void* mapped = other.Alloc(page_size);
+      ASSERT_FALSE(mapped == NULL);
+      memset(mapped, 0, page_size);
+    }
+  }
+
+  // All the reserve is back, so it is handed out from its start again.
+  PageAllocator allocator;
+  EXPECT_EQ(first, allocator.Alloc(page_size));
+}
+
 namespace {
 typedef testing::Test WastefulVectorTest;
 }
@@ -103,6 +150,19 @@ TEST(WastefulVectorTest, UsesPageAllocator) {
   ASSERT_TRUE(allocator_.OwnsPointer(&v[0]));
 }
 
+TEST(WastefulVectorTest, ReusesFreedArrays) {
+  PageAllocator allocator_;
+  {
+    wasteful_vector<uint64_t> v(&allocator_, 512);
+    v.resize(512);
+  }
+  EXPECT_EQ(2U, allocator_.pages_allocated());
+  // The array of the vector above is free for this one.
+  wasteful_vector<uint64_t> v(&allocator_, 512);
+  v.resize(512);
+  EXPECT_EQ(2U, allocator_.pages_allocated());
+}
+
 TEST(WastefulVectorTest, AutoWastefulVector) {
   PageAllocator allocator_;
   EXPECT_EQ(0U, allocator_.pages_allocated());
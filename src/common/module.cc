@@ -39,17 +39,260 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <cstddef>
+
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <utility>
 
 namespace google_breakpad {
 
-using std::dec;
-using std::hex;
 using std::unique_ptr;
 
+namespace {
+
+// Write the SIZE bytes at DATA to FILE.  Return true on success.
+bool WriteSpilled(FILE* file, const void* data, size_t size) {
+  return size == 0 || fwrite(data, size, 1, file) == 1;
+}
+
+// Read SIZE bytes from FILE into DATA.  Return true on success.
+bool ReadSpilled(FILE* file, void* data, size_t size) {
+  return size == 0 || fread(data, size, 1, file) == 1;
+}
+
+// Each Function or Inline is preceded by a pointer to the arena it was
+// allocated from, or NULL if it came from the heap, padded to keep the
+// object suitably aligned.
+const size_t kRecordHeaderSize = alignof(std::max_align_t);
+
+// The arena of the innermost ScopedArena on this thread.
+thread_local Module::Arena* current_arena = NULL;
+
+// The most records Write formats into one buffer.
+const size_t kRecordsPerChunk = 4096;
+
+// Append VALUE to BUFFER in lower-case hexadecimal, as "<< hex" would.
+void AppendHex(string* buffer, uint64_t value) {
+  char digits[16];
+  size_t count = 0;
+  do {
+    digits[count++] = "0123456789abcdef"[value & 0xf];
+    value >>= 4;
+  } while (value);
+  while (count)
+    buffer->push_back(digits[--count]);
+}
+
+// Append VALUE to BUFFER in decimal, as "<< dec" would.
+void AppendDecimal(string* buffer, int64_t value) {
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : value;
+  char digits[20];
+  size_t count = 0;
+  do {
+    digits[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude);
+  if (value < 0)
+    buffer->push_back('-');
+  while (count)
+    buffer->push_back(digits[--count]);
+}
+
+// Append VALUE to BUFFER as sixteen lower-case hexadecimal digits.
+void AppendFixedHex(string* buffer, uint64_t value) {
+  for (int shift = 60; shift >= 0; shift -= 4)
+    buffer->push_back("0123456789abcdef"[(value >> shift) & 0xf]);
+}
+
+void AppendString(string* buffer, StringView str) {
+  buffer->append(str.data(), str.size());
+}
+
+// Write COUNT records to STREAM.  FORMAT(BEGIN, END, BUFFER) appends the
+// text of records BEGIN up to END to BUFFER; the records are formatted in
+// chunks of at most CHUNK_SIZE, up to THREADS chunks at once, each into a
+// buffer of its own, and the buffers written out in order.  If PREPARE is
+// given, PREPARE(BEGIN, END) is called on this thread before each group
+// of chunks is formatted, and FINISH(BEGIN, END) once it is written; if
+// PREPARE returns false, stop.  Return false if PREPARE fails or STREAM
+// goes bad.
+bool WriteChunks(
+    std::ostream& stream, size_t count, size_t chunk_size, int threads,
+    const std::function<void(size_t, size_t, string*)>& format,
+    const std::function<bool(size_t, size_t)>& prepare = nullptr,
+    const std::function<void(size_t, size_t)>& finish = nullptr) {
+  size_t group_size = chunk_size * std::max(threads, 1);
+  vector<string> buffers(std::min<size_t>(std::max(threads, 1),
+                                          (count + chunk_size - 1) /
+                                              chunk_size));
+  for (size_t group = 0; group < count; group += group_size) {
+    size_t group_end = std::min(count, group + group_size);
+    if (prepare && !prepare(group, group_end))
+      return false;
+    size_t chunks = (group_end - group + chunk_size - 1) / chunk_size;
+    auto format_chunk = [&](size_t chunk) {
+      size_t begin = group + chunk * chunk_size;
+      buffers[chunk].clear();
+      format(begin, std::min(group_end, begin + chunk_size), &buffers[chunk]);
+    };
+    vector<std::thread> workers;
+    for (size_t chunk = 1; chunk < chunks; ++chunk)
+      workers.push_back(std::thread(format_chunk, chunk));
+    format_chunk(0);
+    for (size_t i = 0; i < workers.size(); ++i)
+      workers[i].join();
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+      stream.write(buffers[chunk].data(), buffers[chunk].size());
+    if (finish)
+      finish(group, group_end);
+    if (!stream.good())
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// Storage carved out of large blocks, with a free list for each size of
+// object freed, so that deleted records' space is reused.
+class Module::Arena {
+ public:
+  Arena() : next_(NULL), end_(NULL) { }
+
+  ~Arena() {
+    for (char* block : blocks_)
+      delete[] block;
+  }
+
+  void* Allocate(size_t size) {
+    for (FreeList& list : free_lists_) {
+      if (list.size == size && list.head) {
+        FreeNode* node = list.head;
+        list.head = node->next;
+        return node;
+      }
+    }
+    if (static_cast<size_t>(end_ - next_) < size) {
+      size_t block_size = std::max(kBlockSize, size);
+      blocks_.push_back(new char[block_size]);
+      next_ = blocks_.back();
+      end_ = next_ + block_size;
+    }
+    void* result = next_;
+    next_ += size;
+    return result;
+  }
+
+  void Free(void* pointer, size_t size) {
+    FreeNode* node = static_cast<FreeNode*>(pointer);
+    for (FreeList& list : free_lists_) {
+      if (list.size == size) {
+        node->next = list.head;
+        list.head = node;
+        return;
+      }
+    }
+    node->next = NULL;
+    free_lists_.push_back(FreeList{size, node});
+  }
+
+ private:
+  static const size_t kBlockSize = 1 << 20;
+
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  struct FreeList {
+    size_t size;
+    FreeNode* head;
+  };
+
+  vector<char*> blocks_;
+  char* next_;
+  char* end_;
+
+  // There are only ever a few sizes of record, so a vector searched
+  // linearly serves.
+  vector<FreeList> free_lists_;
+};
+
+const size_t Module::Arena::kBlockSize;
+
+Module::ScopedArena::ScopedArena(Module* module)
+    : previous_(current_arena) {
+  current_arena = module->arenas_[0].get();
+}
+
+Module::ScopedArena::~ScopedArena() {
+  current_arena = previous_;
+}
+
+void* Module::AllocateRecord(size_t size) {
+  // Round up so that records carved out one after another stay aligned.
+  size_t total = kRecordHeaderSize +
+                 (size + kRecordHeaderSize - 1) / kRecordHeaderSize *
+                     kRecordHeaderSize;
+  Arena* arena = current_arena;
+  void* block = arena ? arena->Allocate(total) : ::operator new(total);
+  *static_cast<Arena**>(block) = arena;
+  return static_cast<char*>(block) + kRecordHeaderSize;
+}
+
+void Module::FreeRecord(void* pointer, size_t size) {
+  if (!pointer)
+    return;
+  char* block = static_cast<char*>(pointer) - kRecordHeaderSize;
+  Arena* arena = *reinterpret_cast<Arena**>(block);
+  if (!arena) {
+    ::operator delete(block);
+    return;
+  }
+  size_t total = kRecordHeaderSize +
+                 (size + kRecordHeaderSize - 1) / kRecordHeaderSize *
+                     kRecordHeaderSize;
+  arena->Free(block, total);
+}
+
+namespace {
+
+// The name DwarfCUToModule gives the origins of DIEs it hasn't found a
+// name for yet.
+const char kNameOmitted[] = "<name omitted>";
+
+}  // namespace
+
+size_t Module::InlineOriginTable::NameHash::operator()(StringView name) const {
+  // FNV-1a.
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < name.size(); ++i) {
+    hash ^= static_cast<unsigned char>(name.data()[i]);
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+Module::InlineOrigin* Module::InlineOriginTable::Find(StringView name) {
+  // The low bits pick the bucket within a shard, so pick the shard with
+  // the high ones.
+  size_t hash = NameHash()(name);
+  Shard& shard = shards_[(hash >> 16) % kShards];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto found = shard.entries.find(name);
+  if (found != shard.entries.end())
+    return &found->second->origin;
+  // Key the entry by the table's own copy of the name.
+  std::unique_ptr<Entry> entry(new Entry(name));
+  InlineOrigin* origin = &entry->origin;
+  StringView key(entry->name);
+  shard.entries.insert(std::make_pair(key, std::move(entry)));
+  return origin;
+}
+
 Module::InlineOrigin* Module::InlineOriginMap::GetOrCreateInlineOrigin(
     uint64_t offset,
     StringView name) {
@@ -61,14 +304,22 @@ Module::InlineOrigin* Module::InlineOriginMap::GetOrCreateInlineOrigin(
     specification_offset = references_[specification_offset];
     iter = references_.find(specification_offset);
   }
-  if (inline_origins_.find(specification_offset) != inline_origins_.end()) {
-    if (inline_origins_[specification_offset]->name == "<name omitted>") {
-      inline_origins_[specification_offset]->name = name;
-    }
-    return inline_origins_[specification_offset];
+  InlineOrigin*& origin = inline_origins_[specification_offset];
+  if (origin) {
+    // The name may belong to a module's string pool, which this origin
+    // could outlive, so use the table's copy of it.
+    if (origin->name == kNameOmitted && name != kNameOmitted)
+      origin->name = tables_.front()->Find(name)->name;
+    return origin;
+  }
+  if (name == kNameOmitted) {
+    unnamed_.push_back(
+        std::unique_ptr<InlineOrigin>(new InlineOrigin(kNameOmitted)));
+    origin = unnamed_.back().get();
+  } else {
+    origin = tables_.front()->Find(name);
   }
-  inline_origins_[specification_offset] = new Module::InlineOrigin(name);
-  return inline_origins_[specification_offset];
+  return origin;
 }
 
 void Module::InlineOriginMap::SetReference(uint64_t offset,
@@ -97,6 +348,40 @@ void Module::InlineOriginMap::SetReference(uint64_t offset,
   references_[offset] = specification_offset;
 }
 
+void Module::InlineOriginMap::MergeFrom(
+    InlineOriginMap* other,
+    map<InlineOrigin*, InlineOrigin*>* moved) {
+  references_.insert(other->references_.begin(), other->references_.end());
+  for (const auto& iter : other->inline_origins_) {
+    auto existing = inline_origins_.find(iter.first);
+    if (existing == inline_origins_.end()) {
+      inline_origins_[iter.first] = iter.second;
+      continue;
+    }
+    if (existing->second == iter.second)
+      continue;
+    if (existing->second->name == kNameOmitted)
+      existing->second->name = iter.second->name;
+    (*moved)[iter.second] = existing->second;
+  }
+  // OTHER's origins, and the names they refer to, are this map's now.
+  for (std::shared_ptr<InlineOriginTable>& table : other->tables_) {
+    if (std::find(tables_.begin(), tables_.end(), table) == tables_.end())
+      tables_.push_back(table);
+  }
+  unnamed_.insert(unnamed_.end(),
+                  std::make_move_iterator(other->unnamed_.begin()),
+                  std::make_move_iterator(other->unnamed_.end()));
+  other->inline_origins_.clear();
+  other->references_.clear();
+  other->unnamed_.clear();
+}
+
+void Module::InlineOriginMap::ShareTableWith(const InlineOriginMap& other) {
+  assert(inline_origins_.empty());
+  tables_.front() = other.tables_.front();
+}
+
 Module::Module(const string& name, const string& os,
                const string& architecture, const string& id,
                const string& code_id /* = "" */) :
@@ -105,7 +390,10 @@ Module::Module(const string& name, const string& os,
     architecture_(architecture),
     id_(id),
     code_id_(code_id),
-    load_address_(0) { }
+    load_address_(0),
+    max_functions_in_memory_(0),
+    spill_file_(NULL),
+    arenas_(1, std::make_shared<Arena>()) { }
 
 Module::~Module() {
   for (FileByNameMap::iterator it = files_.begin(); it != files_.end(); ++it)
@@ -120,6 +408,8 @@ Module::~Module() {
   }
   for (ExternSet::iterator it = externs_.begin(); it != externs_.end(); ++it)
     delete *it;
+  if (spill_file_)
+    fclose(spill_file_);
 }
 
 void Module::SetLoadAddress(Address address) {
@@ -130,6 +420,10 @@ void Module::SetAddressRanges(const vector<Range>& ranges) {
   address_ranges_ = ranges;
 }
 
+void Module::SetMaxFunctionsInMemory(size_t count) {
+  max_functions_in_memory_ = count;
+}
+
 bool Module::AddFunction(Function* function) {
   // FUNC lines must not hold an empty name, so catch the problem early if
   // callers try to add one.
@@ -172,17 +466,219 @@ bool Module::AddFunction(Function* function) {
     // now owns it.
     return false;
   }
+  if (max_functions_in_memory_ && ret.second) {
+    unspilled_functions_.push_back(function);
+    if (unspilled_functions_.size() > max_functions_in_memory_)
+      SpillFunctions();
+  }
   return true;
 }
 
+void Module::SpillFunctions() {
+  // If spilling fails, keep everything that remains in memory.
+  auto give_up = [this]() {
+    fprintf(stderr, "failed to write spilled functions: %s\n",
+            strerror(errno));
+    if (spill_file_)
+      fflush(spill_file_);
+    max_functions_in_memory_ = 0;
+    unspilled_functions_.clear();
+  };
+
+  if (!spill_file_) {
+    spill_file_ = tmpfile();
+    if (!spill_file_)
+      return give_up();
+  }
+  if (fseek(spill_file_, 0, SEEK_END) != 0)
+    return give_up();
+
+  // Write the functions in the order Write will want them back, so that
+  // it reads each spill mostly sequentially.
+  std::sort(unspilled_functions_.begin(), unspilled_functions_.end(),
+            FunctionCompare());
+  vector<std::pair<Function*, long>> spilled;
+  for (Function* function : unspilled_functions_) {
+    long offset = ftell(spill_file_);
+    uint64_t line_count = function->lines.size();
+    if (offset < 0 ||
+        !WriteSpilled(spill_file_, &line_count, sizeof(line_count)) ||
+        !WriteSpilled(spill_file_, function->lines.data(),
+                      line_count * sizeof(Line)) ||
+        !SpillInlines(function->inlines, spill_file_)) {
+      return give_up();
+    }
+    spilled.push_back(std::make_pair(function, offset));
+  }
+  if (fflush(spill_file_) != 0)
+    return give_up();
+
+  // Only now that all of them are on disk, free them, noting the files
+  // and origins they cite.
+  auto note_inline = [this](unique_ptr<Inline>& in) {
+    spilled_origins_.insert(in->origin);
+    if (in->call_site_file)
+      spilled_files_.insert(in->call_site_file);
+  };
+  for (const auto& iter : spilled) {
+    for (const Line& line : iter.first->lines)
+      spilled_files_.insert(line.file);
+    Inline::InlineDFS(iter.first->inlines, note_inline);
+    vector<Line>().swap(iter.first->lines);
+    vector<unique_ptr<Inline>>().swap(iter.first->inlines);
+    spilled_functions_[iter.first] = iter.second;
+  }
+  unspilled_functions_.clear();
+}
+
+bool Module::SpillInlines(const vector<unique_ptr<Inline>>& inlines,
+                          FILE* file) {
+  uint64_t count = inlines.size();
+  if (!WriteSpilled(file, &count, sizeof(count)))
+    return false;
+  for (const unique_ptr<Inline>& in : inlines) {
+    // The files and origins are owned by this module, and live as long as
+    // the spill file does, so refer to them by address.
+    uint64_t range_count = in->ranges.size();
+    if (!WriteSpilled(file, &in->origin, sizeof(in->origin)) ||
+        !WriteSpilled(file, &in->call_site_line,
+                      sizeof(in->call_site_line)) ||
+        !WriteSpilled(file, &in->call_site_file_id,
+                      sizeof(in->call_site_file_id)) ||
+        !WriteSpilled(file, &in->call_site_file,
+                      sizeof(in->call_site_file)) ||
+        !WriteSpilled(file, &in->inline_nest_level,
+                      sizeof(in->inline_nest_level)) ||
+        !WriteSpilled(file, &range_count, sizeof(range_count)) ||
+        !WriteSpilled(file, in->ranges.data(), range_count * sizeof(Range)) ||
+        !SpillInlines(in->child_inlines, file)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Module::RestoreInlines(vector<unique_ptr<Inline>>* inlines, FILE* file) {
+  uint64_t count;
+  if (!ReadSpilled(file, &count, sizeof(count)))
+    return false;
+  for (uint64_t i = 0; i < count; ++i) {
+    InlineOrigin* origin;
+    int call_site_line, call_site_file_id, inline_nest_level;
+    File* call_site_file;
+    uint64_t range_count;
+    if (!ReadSpilled(file, &origin, sizeof(origin)) ||
+        !ReadSpilled(file, &call_site_line, sizeof(call_site_line)) ||
+        !ReadSpilled(file, &call_site_file_id, sizeof(call_site_file_id)) ||
+        !ReadSpilled(file, &call_site_file, sizeof(call_site_file)) ||
+        !ReadSpilled(file, &inline_nest_level, sizeof(inline_nest_level)) ||
+        !ReadSpilled(file, &range_count, sizeof(range_count))) {
+      return false;
+    }
+    vector<Range> ranges(range_count, Range(0, 0));
+    if (!ReadSpilled(file, ranges.data(), range_count * sizeof(Range)))
+      return false;
+    vector<unique_ptr<Inline>> child_inlines;
+    if (!RestoreInlines(&child_inlines, file))
+      return false;
+    unique_ptr<Inline> in(new Inline(origin, ranges, call_site_line,
+                                     call_site_file_id, inline_nest_level,
+                                     std::move(child_inlines)));
+    in->call_site_file = call_site_file;
+    inlines->push_back(std::move(in));
+  }
+  return true;
+}
+
+bool Module::RestoreFunction(
+    Function* function,
+    const set<InlineOrigin*, InlineOriginCompare>& inline_origins) {
+  auto spilled = spilled_functions_.find(function);
+  assert(spilled != spilled_functions_.end());
+  // Functions are usually read back in the order they were written, so
+  // seek only when they aren't.
+  if (ftell(spill_file_) != spilled->second &&
+      fseek(spill_file_, spilled->second, SEEK_SET) != 0) {
+    return false;
+  }
+  uint64_t line_count;
+  if (!ReadSpilled(spill_file_, &line_count, sizeof(line_count)))
+    return false;
+  function->lines.resize(line_count);
+  if (!ReadSpilled(spill_file_, function->lines.data(),
+                   line_count * sizeof(Line)) ||
+      !RestoreInlines(&function->inlines, spill_file_)) {
+    return false;
+  }
+  auto use_origin = [&](unique_ptr<Inline>& in) {
+    auto it = inline_origins.find(in->origin);
+    assert(it != inline_origins.end());
+    in->origin = *it;
+  };
+  Inline::InlineDFS(function->inlines, use_origin);
+  return true;
+}
+
+void Module::MergeFrom(Module* other) {
+  assert(other->spilled_functions_.empty());
+  // OTHER's functions may live in its arenas; keep those until this
+  // module is gone too.
+  arenas_.insert(arenas_.end(), other->arenas_.begin(), other->arenas_.end());
+  map<InlineOrigin*, InlineOrigin*> origins;
+  inline_origin_map.MergeFrom(&other->inline_origin_map, &origins);
+
+  auto move_inline = [&](unique_ptr<Inline>& in) {
+    if (in->call_site_file)
+      in->call_site_file = FindFile(in->call_site_file->name);
+    auto origin = origins.find(in->origin);
+    if (origin != origins.end())
+      in->origin = origin->second;
+  };
+  for (Function* function : other->functions_) {
+    function->name = AddStringToPool(function->name.str());
+    for (Line& line : function->lines)
+      line.file = FindFile(line.file->name);
+    Inline::InlineDFS(function->inlines, move_inline);
+    if (!AddFunction(function))
+      delete function;
+  }
+  other->functions_.clear();
+
+  for (StackFrameEntry* entry : other->stack_frame_entries_) {
+    if (AddressIsInModule(entry->address)) {
+      ShareEntryRules(entry);
+      stack_frame_entries_.push_back(entry);
+    } else {
+      delete entry;
+    }
+  }
+  other->stack_frame_entries_.clear();
+}
+
 void Module::AddStackFrameEntry(StackFrameEntry* stack_frame_entry) {
   if (!AddressIsInModule(stack_frame_entry->address)) {
     return;
   }
 
+  ShareEntryRules(stack_frame_entry);
   stack_frame_entries_.push_back(stack_frame_entry);
 }
 
+void Module::ShareRuleMap(RuleMap* rules) {
+  if (!rules->empty())
+    *rules = *rule_maps_.insert(*rules).first;
+}
+
+void Module::ShareEntryRules(StackFrameEntry* entry) {
+  // Most entries begin with the same few sets of rules, and most of their
+  // changes are the same few adjustments of the CFA.
+  ShareRuleMap(&entry->initial_rules);
+  for (RuleChangeMap::iterator delta = entry->rule_changes.begin();
+       delta != entry->rule_changes.end(); ++delta) {
+    ShareRuleMap(&delta->second);
+  }
+}
+
 void Module::AddExtern(Extern* ext) {
   if (!AddressIsInModule(ext->address)) {
     return;
@@ -196,6 +692,57 @@ void Module::AddExtern(Extern* ext) {
   }
 }
 
+void Module::AddExterns(vector<Extern*>* externs) {
+  // Of several externs at the same address AddExtern keeps the first, so
+  // keep their order when sorting.
+  std::stable_sort(externs->begin(), externs->end(), ExternCompare());
+
+  // Whether the module has a function starting at ADDRESS.
+  auto has_function_at = [this](Address address) {
+    Function probe(StringView(), address);
+    FunctionSet::const_iterator it = functions_.lower_bound(&probe);
+    return it != functions_.end() && (*it)->address == address;
+  };
+  // Whether there is an extern at ADDRESS, among those the module has and
+  // those being added.
+  auto has_extern_at = [this, externs](Address address) {
+    Extern probe(address);
+    return externs_.count(&probe) != 0 ||
+        std::binary_search(externs->begin(), externs->end(), &probe,
+                           ExternCompare());
+  };
+
+  // The externs not kept are freed only once all have been looked at, as
+  // the checks above and below read their neighbours.
+  vector<Extern*> dropped;
+  ExternSet::iterator hint = externs_.begin();
+  for (size_t i = 0; i < externs->size(); ++i) {
+    Extern* ext = (*externs)[i];
+    bool keep = AddressIsInModule(ext->address) &&
+        (i == 0 || (*externs)[i - 1]->address != ext->address) &&
+        !has_function_at(ext->address);
+    // AddFunction also removes an extern at the code address of an ARM
+    // THUMB function, odd where the function's is even, unless one is at the
+    // function's own address.
+    if (keep && architecture_ == "arm" && (ext->address & 0x1) &&
+        has_function_at(ext->address & ~static_cast<Address>(0x1)) &&
+        !has_extern_at(ext->address & ~static_cast<Address>(0x1))) {
+      keep = false;
+    }
+    if (keep) {
+      size_t size = externs_.size();
+      hint = externs_.insert(hint, ext);
+      // An extern the module already had at this address wins.
+      keep = externs_.size() != size;
+    }
+    if (!keep)
+      dropped.push_back(ext);
+  }
+  for (Extern* ext : dropped)
+    delete ext;
+  externs->clear();
+}
+
 void Module::GetFunctions(vector<Function*>* vec,
                           vector<Function*>::iterator i) {
   vec->insert(i, functions_.begin(), functions_.end());
@@ -278,6 +825,8 @@ void Module::AssignSourceIds(
   for (auto func : functions_) {
     Inline::InlineDFS(func->inlines, markInlineFiles);
   }
+  for (File* file : spilled_files_)
+    file->source_id = 0;
 
   // Finally, assign source ids to those files that have been marked.
   // We could have just assigned source id numbers while traversing
@@ -304,6 +853,10 @@ void Module::CreateInlineOrigins(
   };
   for (Function* func : functions_)
     Module::Inline::InlineDFS(func->inlines, addInlineOrigins);
+  // Spilled inlines are given their origins from this set as they are
+  // read back.
+  for (InlineOrigin* origin : spilled_origins_)
+    inline_origins.insert(origin);
   int next_id = 0;
   for (InlineOrigin* origin : inline_origins) {
     origin->id = next_id++;
@@ -316,14 +869,15 @@ bool Module::ReportError() {
   return false;
 }
 
-bool Module::WriteRuleMap(const RuleMap& rule_map, std::ostream& stream) {
+void Module::AppendRuleMap(const RuleMap& rule_map, string* buffer) {
   for (RuleMap::const_iterator it = rule_map.begin();
        it != rule_map.end(); ++it) {
     if (it != rule_map.begin())
-      stream << ' ';
-    stream << it->first << ": " << it->second;
+      buffer->push_back(' ');
+    buffer->append(it->first.str());
+    buffer->append(": ");
+    buffer->append(it->second.str());
   }
-  return stream.good();
 }
 
 bool Module::AddressIsInModule(Address address) const {
@@ -339,19 +893,30 @@ bool Module::AddressIsInModule(Address address) const {
   return false;
 }
 
-bool Module::Write(std::ostream& stream, SymbolData symbol_data) {
-  stream << "MODULE " << os_ << " " << architecture_ << " "
-         << id_ << " " << name_ << "\n";
-  if (!stream.good())
-    return ReportError();
+bool Module::Write(std::ostream& stream, SymbolData symbol_data,
+                   int threads) {
+  // The header is formatted first, so that the address index can give
+  // where the records after it begin.
+  string header;
+  header.append("MODULE ");
+  header.append(os_);
+  header.push_back(' ');
+  header.append(architecture_);
+  header.push_back(' ');
+  header.append(id_);
+  header.push_back(' ');
+  header.append(name_);
+  header.push_back('\n');
 
   if (!code_id_.empty()) {
-    stream << "INFO CODE_ID " << code_id_ << "\n";
+    header.append("INFO CODE_ID ");
+    header.append(code_id_);
+    header.push_back('\n');
   }
 
+  // Get all referenced inline origins.
+  set<InlineOrigin*, InlineOriginCompare> inline_origins;
   if (symbol_data & SYMBOLS_AND_FILES) {
-    // Get all referenced inline origins.
-    set<InlineOrigin*, InlineOriginCompare> inline_origins;
     CreateInlineOrigins(inline_origins);
     AssignSourceIds(inline_origins);
 
@@ -360,102 +925,221 @@ bool Module::Write(std::ostream& stream, SymbolData symbol_data) {
          file_it != files_.end(); ++file_it) {
       File* file = file_it->second;
       if (file->source_id >= 0) {
-        stream << "FILE " << file->source_id << " " <<  file->name << "\n";
-        if (!stream.good())
-          return ReportError();
+        header.append("FILE ");
+        AppendDecimal(&header, file->source_id);
+        header.push_back(' ');
+        header.append(file->name);
+        header.push_back('\n');
       }
     }
     // Write out inline origins.
     for (InlineOrigin* origin : inline_origins) {
-      stream << "INLINE_ORIGIN " << origin->id << " " << origin->name << "\n";
-      if (!stream.good())
-        return ReportError();
+      header.append("INLINE_ORIGIN ");
+      AppendDecimal(&header, origin->id);
+      header.push_back(' ');
+      AppendString(&header, origin->name);
+      header.push_back('\n');
+    }
+  }
+  stream.write(header.data(), header.size());
+  if (!stream.good())
+    return ReportError();
+
+  // For the address index, the FUNC records written for each function,
+  // without their newlines, and the size of the records following each.
+  struct IndexEntry {
+    string function_record;
+    uint64_t records_size;
+  };
+  vector<vector<IndexEntry>> index_entries;
+
+  if (symbol_data & SYMBOLS_AND_FILES) {
+    // Write out functions and their inlines and lines.  Spilled functions
+    // are read back, a group of chunks at a time, before the chunks are
+    // formatted, and freed again once they are written; keep a group
+    // within the limit on functions in memory.
+    vector<Function*> functions(functions_.begin(), functions_.end());
+    size_t chunk_size = kRecordsPerChunk;
+    if (!spilled_functions_.empty()) {
+      chunk_size = std::max<size_t>(
+          1, std::min(chunk_size,
+                      max_functions_in_memory_ / std::max(threads, 1)));
     }
+    auto restore = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (spilled_functions_.count(functions[i]) &&
+            !RestoreFunction(functions[i], inline_origins)) {
+          fprintf(stderr, "error reading spilled functions\n");
+          return false;
+        }
+      }
+      return true;
+    };
+    auto free_spilled = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (spilled_functions_.count(functions[i])) {
+          vector<Line>().swap(functions[i]->lines);
+          vector<unique_ptr<Inline>>().swap(functions[i]->inlines);
+        }
+      }
+    };
+    if (symbol_data & ADDRESS_INDEX)
+      index_entries.resize(functions.size());
+    auto format_functions = [&](size_t begin, size_t end, string* buffer) {
+      for (size_t i = begin; i < end; ++i) {
+        Function* func = functions[i];
+        vector<Line>::const_iterator line_it = func->lines.begin();
+        for (auto range_it = func->ranges.cbegin();
+             range_it != func->ranges.cend(); ++range_it) {
+          size_t function_record_begin = buffer->size();
+          buffer->append("FUNC ");
+          if (func->is_multiple)
+            buffer->append("m ");
+          AppendHex(buffer, range_it->address - load_address_);
+          buffer->push_back(' ');
+          AppendHex(buffer, range_it->size);
+          buffer->push_back(' ');
+          AppendHex(buffer, func->parameter_size);
+          buffer->push_back(' ');
+          AppendString(buffer, func->name);
+          buffer->push_back('\n');
+          size_t records_begin = buffer->size();
 
-    // Write out functions and their inlines and lines.
-    for (FunctionSet::const_iterator func_it = functions_.begin();
-         func_it != functions_.end(); ++func_it) {
-      Function* func = *func_it;
-      vector<Line>::iterator line_it = func->lines.begin();
-      for (auto range_it = func->ranges.cbegin();
-           range_it != func->ranges.cend(); ++range_it) {
-        stream << "FUNC " << hex
-               << (range_it->address - load_address_) << " "
-               << range_it->size << " "
-               << func->parameter_size << " "
-               << func->name << dec << "\n";
-
-        if (!stream.good())
-          return ReportError();
-
-        // Write out inlines.
-        auto write_inline = [&](unique_ptr<Inline>& in) {
-          stream << "INLINE ";
-          stream << in->inline_nest_level << " " << in->call_site_line << " "
-                 << in->getCallSiteFileID() << " " << in->origin->id << hex;
-          for (const Range& r : in->ranges)
-            stream << " " << (r.address - load_address_) << " " << r.size;
-          stream << dec << "\n";
-        };
-        Module::Inline::InlineDFS(func->inlines, write_inline);
-        if (!stream.good())
-          return ReportError();
-
-        while ((line_it != func->lines.end()) &&
-               (line_it->address >= range_it->address) &&
-               (line_it->address < (range_it->address + range_it->size))) {
-          stream << hex
-                 << (line_it->address - load_address_) << " "
-                 << line_it->size << " "
-                 << dec
-                 << line_it->number << " "
-                 << line_it->file->source_id << "\n";
-
-          if (!stream.good())
-            return ReportError();
-
-          ++line_it;
+          // Write out inlines.
+          auto write_inline = [&](unique_ptr<Inline>& in) {
+            buffer->append("INLINE ");
+            AppendDecimal(buffer, in->inline_nest_level);
+            buffer->push_back(' ');
+            AppendDecimal(buffer, in->call_site_line);
+            buffer->push_back(' ');
+            AppendDecimal(buffer, in->getCallSiteFileID());
+            buffer->push_back(' ');
+            AppendDecimal(buffer, in->origin->id);
+            for (const Range& r : in->ranges) {
+              buffer->push_back(' ');
+              AppendHex(buffer, r.address - load_address_);
+              buffer->push_back(' ');
+              AppendHex(buffer, r.size);
+            }
+            buffer->push_back('\n');
+          };
+          Module::Inline::InlineDFS(func->inlines, write_inline);
+
+          while ((line_it != func->lines.end()) &&
+                 (line_it->address >= range_it->address) &&
+                 (line_it->address <
+                  (range_it->address + range_it->size))) {
+            AppendHex(buffer, line_it->address - load_address_);
+            buffer->push_back(' ');
+            AppendHex(buffer, line_it->size);
+            buffer->push_back(' ');
+            AppendDecimal(buffer, line_it->number);
+            buffer->push_back(' ');
+            AppendDecimal(buffer, line_it->file->source_id);
+            buffer->push_back('\n');
+            ++line_it;
+          }
+
+          if (!index_entries.empty()) {
+            IndexEntry entry = {
+              buffer->substr(function_record_begin,
+                             records_begin - 1 - function_record_begin),
+              buffer->size() - records_begin
+            };
+            index_entries[i].push_back(entry);
+          }
         }
       }
+    };
+    if (!WriteChunks(stream, functions.size(), chunk_size, threads,
+                     format_functions, restore, free_spilled)) {
+      return stream.good() ? false : ReportError();
     }
 
     // Write out 'PUBLIC' records.
-    for (ExternSet::const_iterator extern_it = externs_.begin();
-         extern_it != externs_.end(); ++extern_it) {
-      Extern* ext = *extern_it;
-      stream << "PUBLIC " << hex
-             << (ext->address - load_address_) << " 0 "
-             << ext->name << dec << "\n";
-    }
+    vector<Extern*> externs(externs_.begin(), externs_.end());
+    auto format_externs = [&](size_t begin, size_t end, string* buffer) {
+      for (size_t i = begin; i < end; ++i) {
+        buffer->append("PUBLIC ");
+        if (externs[i]->is_multiple)
+          buffer->append("m ");
+        AppendHex(buffer, externs[i]->address - load_address_);
+        buffer->push_back(' ');
+        AppendHex(buffer, externs[i]->parameter_size);
+        buffer->push_back(' ');
+        buffer->append(externs[i]->name);
+        buffer->push_back('\n');
+      }
+    };
+    if (!WriteChunks(stream, externs.size(), kRecordsPerChunk, threads,
+                     format_externs))
+      return ReportError();
   }
 
   if (symbol_data & CFI) {
     // Write out 'STACK CFI INIT' and 'STACK CFI' records.
-    vector<StackFrameEntry*>::const_iterator frame_it;
-    for (frame_it = stack_frame_entries_.begin();
-         frame_it != stack_frame_entries_.end(); ++frame_it) {
-      StackFrameEntry* entry = *frame_it;
-      stream << "STACK CFI INIT " << hex
-             << (entry->address - load_address_) << " "
-             << entry->size << " " << dec;
-      if (!stream.good()
-          || !WriteRuleMap(entry->initial_rules, stream))
-        return ReportError();
-
-      stream << "\n";
-
-      // Write out this entry's delta rules as 'STACK CFI' records.
-      for (RuleChangeMap::const_iterator delta_it = entry->rule_changes.begin();
-           delta_it != entry->rule_changes.end(); ++delta_it) {
-        stream << "STACK CFI " << hex
-               << (delta_it->first - load_address_) << " " << dec;
-        if (!stream.good()
-            || !WriteRuleMap(delta_it->second, stream))
-          return ReportError();
-
-        stream << "\n";
+    auto format_entries = [&](size_t begin, size_t end, string* buffer) {
+      for (size_t i = begin; i < end; ++i) {
+        StackFrameEntry* entry = stack_frame_entries_[i];
+        buffer->append("STACK CFI INIT ");
+        AppendHex(buffer, entry->address - load_address_);
+        buffer->push_back(' ');
+        AppendHex(buffer, entry->size);
+        buffer->push_back(' ');
+        AppendRuleMap(entry->initial_rules, buffer);
+        buffer->push_back('\n');
+
+        // Write out this entry's delta rules as 'STACK CFI' records.
+        for (RuleChangeMap::const_iterator delta_it =
+                 entry->rule_changes.begin();
+             delta_it != entry->rule_changes.end(); ++delta_it) {
+          buffer->append("STACK CFI ");
+          AppendHex(buffer, delta_it->first - load_address_);
+          buffer->push_back(' ');
+          AppendRuleMap(delta_it->second, buffer);
+          buffer->push_back('\n');
+        }
+      }
+    };
+    if (!WriteChunks(stream, stack_frame_entries_.size(), kRecordsPerChunk,
+                     threads, format_entries))
+      return ReportError();
+  }
+
+  if (symbol_data & ADDRESS_INDEX) {
+    // Write out the address index: for each FUNC record, an
+    // 'INFO INDEX <offset> <size> <FUNC record>' record, where the LINE and
+    // INLINE records following the FUNC record are the SIZE bytes at
+    // OFFSET in the file; and then a footer of fixed size,
+    // 'INFO INDEX_END <begin> <end>', where BEGIN and END, as sixteen hex
+    // digits each, delimit the FUNC records and the records following
+    // them.  A reader can fetch the footer, then the rest of the file
+    // outside that range, and then just the records of the functions it
+    // needs.  Readers that don't know the index skip it, as they do all
+    // INFO records.
+    string index;
+    uint64_t offset = header.size();
+    for (const vector<IndexEntry>& entries : index_entries) {
+      for (const IndexEntry& entry : entries) {
+        offset += entry.function_record.size() + 1;
+        index.append("INFO INDEX ");
+        AppendHex(&index, offset);
+        index.push_back(' ');
+        AppendHex(&index, entry.records_size);
+        index.push_back(' ');
+        index.append(entry.function_record);
+        index.push_back('\n');
+        offset += entry.records_size;
       }
     }
+    index.append("INFO INDEX_END ");
+    AppendFixedHex(&index, header.size());
+    index.push_back(' ');
+    AppendFixedHex(&index, offset);
+    index.push_back('\n');
+    stream.write(index.data(), index.size());
+    if (!stream.good())
+      return ReportError();
   }
 
   return true;
@@ -38,13 +38,18 @@
 #ifndef COMMON_LINUX_MODULE_H__
 #define COMMON_LINUX_MODULE_H__
 
+#include <stdio.h>
+
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "common/string_view.h"
@@ -105,7 +110,15 @@ class Module {
   // A function.
   struct Function {
     Function(StringView name_input, const Address& address_input) :
-        name(name_input), address(address_input), parameter_size(0) {}
+        name(name_input), address(address_input), parameter_size(0),
+        is_multiple(false) {}
+
+    // Place Functions in the current thread's arena, if any; see
+    // ScopedArena.
+    static void* operator new(size_t size) { return AllocateRecord(size); }
+    static void operator delete(void* pointer, size_t size) {
+      FreeRecord(pointer, size);
+    }
 
     // For sorting by address.  (Not style-guide compliant, but it's
     // stupid not to put this in the struct.)
@@ -123,6 +136,10 @@ class Module {
     // The function's parameter size.
     Address parameter_size;
 
+    // True if the function's code is shared with other functions, as
+    // identical code folding does; written as 'FUNC m'.
+    bool is_multiple;
+
     // Source lines belonging to this function, sorted by increasing
     // address.
     vector<Line> lines;
@@ -162,6 +179,13 @@ class Module {
           inline_nest_level(inline_nest_level),
           child_inlines(std::move(child_inlines)) {}
 
+    // Place Inlines in the current thread's arena, if any; see
+    // ScopedArena.
+    static void* operator new(size_t size) { return AllocateRecord(size); }
+    static void operator delete(void* pointer, size_t size) {
+      FreeRecord(pointer, size);
+    }
+
     InlineOrigin* origin;
 
     // The list of addresses and sizes.
@@ -196,9 +220,57 @@ class Module {
 
   typedef map<uint64_t, InlineOrigin*> InlineOriginByOffset;
 
+  // One InlineOrigin for each inlined function name, shared by every
+  // compilation unit that inlines a function of that name.  Each unit
+  // has DIEs of its own for the functions it inlines, but Write gives
+  // origins with the same name a single INLINE_ORIGIN record anyway, so
+  // sharing them as they're created saves keeping a copy per unit.  This
+  // may be used from several threads at once, so that the modules units
+  // are read into in parallel can share one.
+  class InlineOriginTable {
+   public:
+    InlineOriginTable() {}
+
+    // Return the origin named NAME, creating it if need be.  The origin,
+    // and the copy of NAME it refers to, live as long as this table.
+    InlineOrigin* Find(StringView name);
+
+   private:
+    struct Entry {
+      explicit Entry(StringView name_input)
+          : name(name_input.str()), origin(StringView(name)) {}
+
+      const string name;
+      InlineOrigin origin;
+    };
+    struct NameHash {
+      size_t operator()(StringView name) const;
+    };
+    typedef unordered_map<StringView, std::unique_ptr<Entry>, NameHash>
+        EntryByName;
+
+    // The table is split by name hash, so that threads looking up
+    // different names rarely wait for one another.
+    static const size_t kShards = 64;
+    struct Shard {
+      std::mutex mutex;
+      EntryByName entries;
+    };
+    Shard shards_[kShards];
+
+    InlineOriginTable(const InlineOriginTable&) = delete;
+    InlineOriginTable& operator=(const InlineOriginTable&) = delete;
+  };
+
   class InlineOriginMap {
    public:
-    // Add INLINE ORIGIN to the module. Return a pointer to origin .
+    InlineOriginMap()
+        : tables_(1, std::make_shared<InlineOriginTable>()) {}
+
+    // Add INLINE ORIGIN to the module. Return a pointer to origin. Origins
+    // with the same name are the same object, unless the name is
+    // "<name omitted>", in which case the origin has the name of the first
+    // call that gives its DIE one.
     InlineOrigin* GetOrCreateInlineOrigin(uint64_t offset, StringView name);
 
     // offset is the offset of a DW_TAG_subprogram. specification_offset is the
@@ -206,16 +278,29 @@ class Module {
     // DW_AT_specification doesn't exist in that DIE.
     void SetReference(uint64_t offset, uint64_t specification_offset);
 
-    ~InlineOriginMap() {
-      for (const auto& iter : inline_origins_) {
-        delete iter.second;
-      }
-    }
+    // Move the origins in OTHER, a map for other DIEs of the same file,
+    // into this map.  Where this map already had a different origin for
+    // one of OTHER's DIEs, that origin is kept, and MOVED maps OTHER's
+    // origin to it.  OTHER is left empty.
+    void MergeFrom(InlineOriginMap* other,
+                   map<InlineOrigin*, InlineOrigin*>* moved);
+
+    // Take named origins from OTHER's table from now on, rather than
+    // from a table of this map's own.  This map must be empty.
+    void ShareTableWith(const InlineOriginMap& other);
 
    private:
     // A map from a DW_TAG_subprogram's offset to the DW_TAG_subprogram.
     InlineOriginByOffset inline_origins_;
 
+    // The table named origins come from, followed by those of the maps
+    // merged into this one, whose origins this map's DIEs may still use.
+    vector<std::shared_ptr<InlineOriginTable>> tables_;
+
+    // The origins of DIEs that haven't been given a name yet, which are
+    // renamed in place if one turns up.
+    vector<std::unique_ptr<InlineOrigin>> unnamed_;
+
     // A map from a DW_TAG_subprogram's offset to the offset of its
     // specification or abstract origin subprogram. The set of values in this
     // map should always be the same set of keys in inline_origins_.
@@ -224,6 +309,25 @@ class Module {
 
   InlineOriginMap inline_origin_map;
 
+  class Arena;
+
+  // While a ScopedArena for a module exists, the Functions and Inlines
+  // created with new on the same thread are carved out of large blocks
+  // belonging to that module, rather than allocated one by one, and
+  // deleting them puts their storage back in the module's blocks for
+  // reuse.  The blocks are freed all at once, once the module and every
+  // module it was merged into with MergeFrom are gone, so objects created
+  // this way must be owned by the module, or deleted before then.
+  // ScopedArenas nest; the innermost one applies.
+  class ScopedArena {
+   public:
+    explicit ScopedArena(Module* module);
+    ~ScopedArena();
+
+   private:
+    Arena* previous_;
+  };
+
   // A source line.
   struct Line {
     // For sorting by address.  (Not style-guide compliant, but it's
@@ -239,16 +343,154 @@ class Module {
 
   // An exported symbol.
   struct Extern {
-    explicit Extern(const Address& address_input) : address(address_input) {}
+    explicit Extern(const Address& address_input)
+        : address(address_input), parameter_size(0), is_multiple(false) {}
     const Address address;
     string name;
+
+    // The size of the parameters the function takes on the stack, where
+    // the symbol's decoration gives it, as Windows stdcall names do.
+    Address parameter_size;
+
+    // True if other symbols share the address; written as 'PUBLIC m'.
+    bool is_multiple;
+  };
+
+  // A register name or postfix expression in a CFI rule. The rules for
+  // every frame in a binary are drawn from a few thousand such strings, so
+  // each distinct one is held once, for the life of the process, and
+  // RuleStrings refer to it. Equal RuleStrings refer to the same string.
+  class RuleString {
+   public:
+    RuleString() : string_(Empty()) { }
+    RuleString(const string& str) : string_(Intern(str)) { }
+    RuleString(const char* str) : string_(Intern(str)) { }
+
+    const string& str() const { return *string_; }
+    operator const string&() const { return *string_; }
+    bool empty() const { return string_->empty(); }
+
+    bool operator==(const RuleString& other) const {
+      return string_ == other.string_;
+    }
+    bool operator!=(const RuleString& other) const {
+      return string_ != other.string_;
+    }
+
+    // RuleStrings are ordered by their contents, as STACK CFI records
+    // list rules.
+    bool operator<(const RuleString& other) const {
+      return string_ != other.string_ && *string_ < *other.string_;
+    }
+
+    // A value unique to this string, for ordering RuleStrings cheaply
+    // where the order doesn't matter.
+    const string* id() const { return string_; }
+
+   private:
+    static const string* Intern(const string& str) {
+      static std::mutex* mutex = new std::mutex;
+      static unordered_set<string>* strings = new unordered_set<string>;
+      std::lock_guard<std::mutex> lock(*mutex);
+      return &*strings->insert(str).first;
+    }
+
+    static const string* Empty() {
+      static const string* empty = Intern(string());
+      return empty;
+    }
+
+    const string* string_;
   };
 
   // A map from register names to postfix expressions that recover
   // their their values. This can represent a complete set of rules to
   // follow at some address, or a set of changes to be applied to an
   // extant set of rules.
-  typedef map<string, string> RuleMap;
+  //
+  // A RuleMap is a small array of rules sorted by register name. Copies
+  // share their rules until one of them is changed, so a Module can keep
+  // a single copy of each distinct set of rules its entries use; see
+  // ShareRuleMap. A RuleMap sharing its rules with another may not be
+  // changed while the other is being read on another thread.
+  class RuleMap {
+   public:
+    typedef std::pair<RuleString, RuleString> value_type;
+    typedef vector<value_type>::const_iterator const_iterator;
+    typedef const_iterator iterator;
+
+    const_iterator begin() const {
+      return rules_ ? rules_->begin() : Empty().begin();
+    }
+    const_iterator end() const {
+      return rules_ ? rules_->end() : Empty().end();
+    }
+    size_t size() const { return rules_ ? rules_->size() : 0; }
+    bool empty() const { return size() == 0; }
+
+    // Return the rule for NAME, or end() if there is none.
+    const_iterator find(const RuleString& name) const {
+      const_iterator rule = std::lower_bound(begin(), end(), name, NameLess());
+      return rule != end() && rule->first == name ? rule : end();
+    }
+
+    // Return the expression for NAME, adding an empty one if there is
+    // none.
+    RuleString& operator[](const RuleString& name) {
+      if (!rules_)
+        rules_ = std::make_shared<vector<value_type>>();
+      else if (rules_.use_count() > 1)
+        rules_ = std::make_shared<vector<value_type>>(*rules_);
+      vector<value_type>::iterator rule =
+          std::lower_bound(rules_->begin(), rules_->end(), name, NameLess());
+      if (rule == rules_->end() || rule->first != name)
+        rule = rules_->insert(rule, value_type(name, RuleString()));
+      return rule->second;
+    }
+
+    void clear() { rules_.reset(); }
+    void swap(RuleMap& other) { rules_.swap(other.rules_); }
+
+    bool operator==(const RuleMap& other) const {
+      return rules_ == other.rules_ ||
+             (size() == other.size() &&
+              std::equal(begin(), end(), other.begin()));
+    }
+    bool operator!=(const RuleMap& other) const { return !(*this == other); }
+
+    // An arbitrary order on RuleMaps, cheaper than comparing contents,
+    // under which two RuleMaps are equivalent if they hold the same
+    // rules.
+    struct IdentityLess {
+      bool operator()(const RuleMap& a, const RuleMap& b) const {
+        if (a.size() != b.size())
+          return a.size() < b.size();
+        for (const_iterator i = a.begin(), j = b.begin(); i != a.end();
+             ++i, ++j) {
+          if (i->first != j->first)
+            return i->first.id() < j->first.id();
+          if (i->second != j->second)
+            return i->second.id() < j->second.id();
+        }
+        return false;
+      }
+    };
+
+   private:
+    struct NameLess {
+      bool operator()(const value_type& rule, const RuleString& name) const {
+        return rule.first < name;
+      }
+    };
+
+    static const vector<value_type>& Empty() {
+      static const vector<value_type>* empty = new vector<value_type>;
+      return *empty;
+    }
+
+    // The rules, or NULL if there are none.
+    std::shared_ptr<vector<value_type>> rules_;
+  };
 
   // A map from addresses to RuleMaps, representing changes that take
   // effect at given addresses.
@@ -321,22 +563,61 @@ class Module {
   // this method is called.
   void SetAddressRanges(const vector<Range>& ranges);
 
+  // Keep the lines and inlines of at most COUNT of the functions added
+  // since the last spill in memory.  Once more have been added, their
+  // lines and inlines are written, sorted by function, to a temporary
+  // file, and freed; Write reads them back one function at a time, in
+  // the order it writes the functions.  The functions themselves, with
+  // their names and ranges, stay in the module, so they may still be
+  // renamed or found by GetFunctions, but their lines and inlines are
+  // empty there once spilled.  A COUNT of zero, the default, keeps
+  // everything in memory.  A module with spilled functions can't be
+  // merged into another with MergeFrom.
+  void SetMaxFunctionsInMemory(size_t count);
+
   // Add FUNCTION to the module. FUNCTION's name must not be empty.
   // This module owns all Function objects added with this function:
-  // destroying the module destroys them as well.
+  // destroying the module destroys them as well.  If FUNCTION's lines
+  // and inlines are to be spilled (see SetMaxFunctionsInMemory), that may
+  // happen before this returns.
   // Return false if the function is duplicate and needs to be freed.
   bool AddFunction(Function* function);
 
+  // Move the functions of OTHER, a module built from other compilation
+  // units of the same file, into this module, together with the files and
+  // inline origins they refer to and the names they use, as if they had
+  // been added to this module in the first place.  OTHER's functions are
+  // added after this module's, so where both have the same function,
+  // this module's is kept.  OTHER's stack frame entries are likewise
+  // appended to this module's.  OTHER is left with no functions or stack
+  // frame entries.
+  void MergeFrom(Module* other);
+
   // Add STACK_FRAME_ENTRY to the module.
   // This module owns all StackFrameEntry objects added with this
   // function: destroying the module destroys them as well.
   void AddStackFrameEntry(StackFrameEntry* stack_frame_entry);
 
+  // Have RULES share its rules with any other RuleMap this module has
+  // been given with the same rules.
+  void ShareRuleMap(RuleMap* rules);
+
   // Add PUBLIC to the module.
   // This module owns all Extern objects added with this function:
   // destroying the module destroys them as well.
   void AddExtern(Extern* ext);
 
+  // Add the externs in EXTERNS to the module, leaving EXTERNS empty.  The
+  // result is that of calling AddExtern on each in turn, followed by
+  // AddFunction for each function the module already has: externs outside
+  // the module, at the same address as an earlier one, or at the start of
+  // one of the module's functions are dropped.  Rather than inserting the
+  // externs into the module's tree one by one, though, this sorts them once
+  // and filters them in a single pass, which is what makes a symbol table
+  // of millions of entries quick to add.  This module owns all Extern
+  // objects added with this function.
+  void AddExterns(vector<Extern*>* externs);
+
   // If this module has a file named NAME, return a pointer to it. If
   // it has none, then create one and return a pointer to the new
   // file. This module owns all File objects created using these
@@ -398,9 +679,16 @@ class Module {
   // - all public records,
   // If symbol_data is CFI then:
   // - all CFI records.
+  // If symbol_data includes ADDRESS_INDEX then, last:
+  // - an index giving the byte range of each function's records.
   // Addresses in the output are all relative to the load address
-  // established by SetLoadAddress.
-  bool Write(std::ostream& stream, SymbolData symbol_data);
+  // established by SetLoadAddress.  The records are formatted in chunks,
+  // up to THREADS of them at once; the output doesn't depend on THREADS.
+  bool Write(std::ostream& stream, SymbolData symbol_data, int threads = 1);
+
+  // Append RULE_MAP to BUFFER, in the form appropriate for 'STACK CFI'
+  // records, without a final newline.
+  static void AppendRuleMap(const RuleMap& rule_map, string* buffer);
 
   // Place the name in the global set of strings. Return a StringView points to
   // a string inside the pool.
@@ -416,19 +704,49 @@ class Module {
   string code_identifier() const { return code_id_; }
 
  private:
+  // FastModuleWriter serializes the module's records directly.
+  friend class FastModuleWriter;
+
   // Report an error that has occurred writing the symbol file, using
   // errno to find the appropriate cause.  Return false.
   static bool ReportError();
 
-  // Write RULE_MAP to STREAM, in the form appropriate for 'STACK CFI'
-  // records, without a final newline. Return true if all goes well;
-  // if an error occurs, return false, and leave errno set.
-  static bool WriteRuleMap(const RuleMap& rule_map, std::ostream& stream);
+  // Allocate SIZE bytes for a Function or Inline, from the arena of the
+  // innermost ScopedArena on this thread if there is one, or from the
+  // heap.  Free storage so allocated for an object of SIZE bytes.
+  static void* AllocateRecord(size_t size);
+  static void FreeRecord(void* pointer, size_t size);
 
   // Returns true of the specified address resides with an specified address
   // range, or if no ranges have been specified.
   bool AddressIsInModule(Address address) const;
 
+  // Have ENTRY's initial rules and rule changes share their rules with
+  // those of the module's other entries, where they are the same.
+  void ShareEntryRules(StackFrameEntry* entry);
+
+  // Write the lines and inlines of the functions in unspilled_functions_
+  // to spill_file_ and free them.  If the spill file can't be written,
+  // leave them in memory.
+  void SpillFunctions();
+
+  // Read FUNCTION's spilled lines and inlines back from spill_file_,
+  // replacing each inline's origin with the one in INLINE_ORIGINS that
+  // has its name.  Return false if they can't be read.
+  bool RestoreFunction(
+      Function* function,
+      const set<InlineOrigin*, InlineOriginCompare>& inline_origins);
+
+  // Write INLINES and their children to FILE.  Return false if an error
+  // occurs.
+  static bool SpillInlines(const vector<std::unique_ptr<Inline>>& inlines,
+                           FILE* file);
+
+  // Read inlines written by SpillInlines from FILE into INLINES.  Return
+  // false if an error occurs.
+  static bool RestoreInlines(vector<std::unique_ptr<Inline>>* inlines,
+                             FILE* file);
+
   // Module header entries.
   string name_, os_, architecture_, id_, code_id_;
 
@@ -467,13 +785,46 @@ class Module {
   // added to it.
   vector<StackFrameEntry*> stack_frame_entries_;
 
+  // One copy of each distinct set of rules the stack frame entries use.
+  set<RuleMap, RuleMap::IdentityLess> rule_maps_;
+
   // The module owns all the externs that have been added to it;
   // destroying the module frees the Externs these point to.
   ExternSet externs_;
 
   unordered_set<string> common_strings_;
+
+  // The most functions whose lines and inlines are kept in memory, or zero
+  // to keep them all; see SetMaxFunctionsInMemory.
+  size_t max_functions_in_memory_;
+
+  // The functions added since the last spill, in the order added.
+  vector<Function*> unspilled_functions_;
+
+  // The temporary file holding spilled lines and inlines, or NULL if
+  // nothing has been spilled.  It is deleted when closed.
+  FILE* spill_file_;
+
+  // The offset in spill_file_ of each spilled function's lines and
+  // inlines.
+  unordered_map<const Function*, long> spilled_functions_;
+
+  // The files and inline origins cited by spilled lines and inlines, to
+  // be numbered along with those cited by the functions in memory. These
+  // are owned by the module like any others.
+  set<File*> spilled_files_;
+  set<InlineOrigin*> spilled_origins_;
+
+  // This module's arena, followed by those of the modules merged into it,
+  // which may still hold some of its Functions and Inlines.
+  vector<std::shared_ptr<Arena>> arenas_;
 };
 
+inline std::ostream& operator<<(std::ostream& stream,
+                                const Module::RuleString& rule_string) {
+  return stream << rule_string.str();
+}
+
 }  // namespace google_breakpad
 
 #endif  // COMMON_LINUX_MODULE_H__
@@ -111,6 +111,218 @@ TEST(Write, OneLineFunc) {
                contents.c_str());
 }
 
+TEST(Write, Multiple) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+
+  Module::Function* function = new Module::Function("function_name", 0x1000);
+  function->ranges.push_back(Module::Range(0x1000, 0x10));
+  function->is_multiple = true;
+  m.AddFunction(function);
+  Module::Extern* ext = new Module::Extern(0x2000);
+  ext->name = "_abc";
+  ext->is_multiple = true;
+  m.AddExtern(ext);
+
+  m.Write(s, ALL_SYMBOL_DATA);
+  string contents = s.str();
+  EXPECT_STREQ("MODULE os-name architecture id-string name with spaces\n"
+               "FUNC m 1000 10 0 function_name\n"
+               "PUBLIC m 2000 0 _abc\n",
+               contents.c_str());
+}
+
+TEST(Write, AddressIndex) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+
+  Module::File* file = m.FindFile("file1.cc");
+  Module::Function* function1 = new Module::Function("f", 0x1000);
+  function1->ranges.push_back(Module::Range(0x1000, 0x10));
+  Module::Line line = { 0x1000, 0x10, file, 42 };
+  function1->lines.push_back(line);
+  m.AddFunction(function1);
+  Module::Function* function2 = new Module::Function("g", 0x2000);
+  function2->ranges.push_back(Module::Range(0x2000, 0x8));
+  m.AddFunction(function2);
+  Module::Extern* ext = new Module::Extern(0x3000);
+  ext->name = "p";
+  m.AddExtern(ext);
+
+  m.Write(s, ALL_SYMBOL_DATA | ADDRESS_INDEX);
+  string contents = s.str();
+  EXPECT_STREQ("MODULE os-name architecture id-string name with spaces\n"
+               "FILE 0 file1.cc\n"
+               "FUNC 1000 10 0 f\n"
+               "1000 10 42 0\n"
+               "FUNC 2000 8 0 g\n"
+               "PUBLIC 3000 0 p\n"
+               "INFO INDEX 58 d FUNC 1000 10 0 f\n"
+               "INFO INDEX 75 0 FUNC 2000 8 0 g\n"
+               "INFO INDEX_END 0000000000000047 0000000000000075\n",
+               contents.c_str());
+  EXPECT_EQ("1000 10 42 0\n", contents.substr(0x58, 0xd));
+  EXPECT_EQ("FUNC 1000", contents.substr(0x47, 9));
+  EXPECT_EQ("PUBLIC", contents.substr(0x75, 6));
+}
+
+// Add three functions with lines and inlines to M, in decreasing address
+// order, the middle one citing a file and origin that nothing else does.
+static void AddSpillableFunctions(Module* m) {
+  Module::File* file1 = m->FindFile("file1.cc");
+  Module::File* file2 = m->FindFile("file2.cc");
+  m->FindFile("unused.cc");
+  m->inline_origin_map.SetReference(1, 1);
+  m->inline_origin_map.SetReference(2, 2);
+  Module::InlineOrigin* origin1 =
+      m->inline_origin_map.GetOrCreateInlineOrigin(1, "origin1");
+  Module::InlineOrigin* origin2 =
+      m->inline_origin_map.GetOrCreateInlineOrigin(2, "origin2");
+  for (int i = 3; i > 0; --i) {
+    Module::Address address = 0x1000 * i;
+    Module::Function* function = new Module::Function(
+        m->AddStringToPool("function" + std::to_string(i)), address);
+    function->ranges.push_back(Module::Range(address, 0x100));
+    Module::File* file = i == 2 ? file2 : file1;
+    Module::Line line1 = { address, 0x10, file, 10 * i };
+    Module::Line line2 = { address + 0x10, 0x20, file1, 10 * i + 1 };
+    function->lines.push_back(line1);
+    function->lines.push_back(line2);
+    vector<std::unique_ptr<Module::Inline>> children;
+    children.push_back(std::unique_ptr<Module::Inline>(new Module::Inline(
+        origin1, vector<Module::Range>(1, Module::Range(address + 4, 4)),
+        7, 0, 1, vector<std::unique_ptr<Module::Inline>>())));
+    std::unique_ptr<Module::Inline> in(new Module::Inline(
+        i == 2 ? origin2 : origin1,
+        vector<Module::Range>(1, Module::Range(address, 0x10)),
+        5 * i, 0, 0, std::move(children)));
+    in->call_site_file = file;
+    in->child_inlines[0]->call_site_file = file1;
+    function->inlines.push_back(std::move(in));
+    m->AddFunction(function);
+  }
+}
+
+// Spilling functions' lines and inlines to disk doesn't change what
+// Write writes.
+TEST(Write, SpilledFunctions) {
+  Module expected_module(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  AddSpillableFunctions(&expected_module);
+  stringstream expected;
+  expected_module.Write(expected, ALL_SYMBOL_DATA);
+
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  m.SetMaxFunctionsInMemory(1);
+  AddSpillableFunctions(&m);
+  vector<Module::Function*> functions;
+  m.GetFunctions(&functions, functions.end());
+  ASSERT_EQ(3U, functions.size());
+  // The first two functions added were spilled; the last was not.
+  EXPECT_EQ(2U, functions[0]->lines.size());
+  EXPECT_EQ(0U, functions[1]->lines.size());
+  EXPECT_EQ(0U, functions[2]->lines.size());
+  EXPECT_EQ(0U, functions[2]->inlines.size());
+
+  stringstream s;
+  m.Write(s, ALL_SYMBOL_DATA);
+  EXPECT_EQ(expected.str(), s.str());
+  EXPECT_STREQ("MODULE os-name architecture id-string name with spaces\n"
+               "FILE 0 file1.cc\n"
+               "FILE 1 file2.cc\n"
+               "INLINE_ORIGIN 0 origin1\n"
+               "INLINE_ORIGIN 1 origin2\n"
+               "FUNC 1000 100 0 function1\n"
+               "INLINE 0 5 0 0 1000 10\n"
+               "INLINE 1 7 0 0 1004 4\n"
+               "1000 10 10 0\n"
+               "1010 20 11 0\n"
+               "FUNC 2000 100 0 function2\n"
+               "INLINE 0 10 1 1 2000 10\n"
+               "INLINE 1 7 0 0 2004 4\n"
+               "2000 10 20 1\n"
+               "2010 20 21 0\n"
+               "FUNC 3000 100 0 function3\n"
+               "INLINE 0 15 0 0 3000 10\n"
+               "INLINE 1 7 0 0 3004 4\n"
+               "3000 10 30 0\n"
+               "3010 20 31 0\n",
+               s.str().c_str());
+
+  // Writing again reads the spilled functions back again.
+  stringstream again;
+  m.Write(again, ALL_SYMBOL_DATA);
+  EXPECT_EQ(s.str(), again.str());
+}
+
+// Spilled functions are read back a group at a time when the symbol file
+// is formatted on several threads.
+TEST(Write, SpilledFunctionsOnThreads) {
+  Module expected_module(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  AddSpillableFunctions(&expected_module);
+  stringstream expected;
+  expected_module.Write(expected, ALL_SYMBOL_DATA);
+
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  m.SetMaxFunctionsInMemory(1);
+  AddSpillableFunctions(&m);
+  stringstream s;
+  EXPECT_TRUE(m.Write(s, ALL_SYMBOL_DATA, 3));
+  EXPECT_EQ(expected.str(), s.str());
+}
+
+// Enough records for several chunks come out the same, and formatted as
+// iostreams would, on any number of threads.
+TEST(Write, Threads) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  m.SetLoadAddress(0x1000);
+  Module::File* file = m.FindFile("file.cc");
+  stringstream expected;
+  expected << "MODULE " MODULE_OS " " MODULE_ARCH " " MODULE_ID " "
+           << MODULE_NAME << "\n"
+           << "FILE 0 file.cc\n";
+  const int kCount = 10000;
+  for (int i = 0; i < kCount; ++i) {
+    Module::Address address = 0x100000 + i * 0x100;
+    Module::Function* function =
+        new Module::Function(m.AddStringToPool("f" + std::to_string(i)),
+                             address);
+    function->ranges.push_back(Module::Range(address, 0x100));
+    function->parameter_size = i;
+    Module::Line line = { address, 0x10, file, i - 5 };
+    function->lines.push_back(line);
+    m.AddFunction(function);
+    expected << std::hex << "FUNC " << address - 0x1000 << " 100 " << i
+             << " f" << std::dec << i << "\n"
+             << std::hex << address - 0x1000 << " 10 " << std::dec << i - 5
+             << " 0\n";
+  }
+  for (int i = 0; i < kCount; ++i) {
+    Module::Extern* ext = new Module::Extern(0x10000000 + i);
+    ext->name = "e" + std::to_string(i);
+    m.AddExtern(ext);
+    expected << std::hex << "PUBLIC " << 0x10000000 + i - 0x1000 << " 0 e"
+             << std::dec << i << "\n";
+  }
+  for (int i = 0; i < kCount; ++i) {
+    Module::StackFrameEntry* entry = new Module::StackFrameEntry();
+    entry->address = 0x100000 + i * 0x100;
+    entry->size = 0x100;
+    entry->initial_rules[".cfa"] = "$sp 8 +";
+    entry->rule_changes[entry->address + 4][".cfa"] = "$sp 16 +";
+    m.AddStackFrameEntry(entry);
+    expected << std::hex << "STACK CFI INIT " << entry->address - 0x1000
+             << " 100 .cfa: $sp 8 +\n"
+             << "STACK CFI " << entry->address + 4 - 0x1000
+             << " .cfa: $sp 16 +\n" << std::dec;
+  }
+
+  for (int threads = 1; threads <= 4; ++threads) {
+    stringstream s;
+    EXPECT_TRUE(m.Write(s, ALL_SYMBOL_DATA, threads));
+    EXPECT_EQ(expected.str(), s.str()) << threads << " threads";
+  }
+}
+
 TEST(Write, RelativeLoadAddress) {
   stringstream s;
   Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
@@ -395,6 +607,197 @@ TEST(Construct, AddFrames) {
   EXPECT_THAT(entries[2]->rule_changes, ContainerEq(entry3_changes));
 }
 
+// Return RULES as a STACK CFI record gives them.
+static string RuleSet(const Module::RuleMap& rules) {
+  string rule_set;
+  Module::AppendRuleMap(rules, &rule_set);
+  return rule_set;
+}
+
+// Stack frame entries with the same rules share a single copy of them,
+// which changing one entry's rules leaves alone.
+TEST(Construct, ShareFrameRules) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+
+  Module::StackFrameEntry* entry1 = new Module::StackFrameEntry();
+  entry1->address = 0x1000;
+  entry1->size = 0x10;
+  entry1->initial_rules[".cfa"] = "$rsp 8 +";
+  entry1->initial_rules[".ra"] = ".cfa -8 + ^";
+  entry1->rule_changes[0x1001][".cfa"] = "$rsp 16 +";
+  m.AddStackFrameEntry(entry1);
+
+  Module::StackFrameEntry* entry2 = new Module::StackFrameEntry();
+  entry2->address = 0x2000;
+  entry2->size = 0x10;
+  entry2->initial_rules[".ra"] = ".cfa -8 + ^";
+  entry2->initial_rules[".cfa"] = "$rsp 8 +";
+  entry2->rule_changes[0x2004][".cfa"] = "$rsp 16 +";
+  m.AddStackFrameEntry(entry2);
+
+  EXPECT_EQ(entry1->initial_rules.begin(), entry2->initial_rules.begin());
+  EXPECT_EQ(entry1->rule_changes[0x1001].begin(),
+            entry2->rule_changes[0x2004].begin());
+
+  entry2->initial_rules[".cfa"] = "$rsp 24 +";
+  EXPECT_EQ(".cfa: $rsp 8 + .ra: .cfa -8 + ^", RuleSet(entry1->initial_rules));
+  EXPECT_EQ(".cfa: $rsp 24 + .ra: .cfa -8 + ^",
+            RuleSet(entry2->initial_rules));
+}
+
+TEST(Construct, MergeFrom) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  Module::Function* function1 = new Module::Function(
+      "_without_form", 0xd35024aa7ca7da5cULL);
+  Module::Range r1(0xd35024aa7ca7da5cULL, 0x200b26e605f99071ULL);
+  function1->ranges.push_back(r1);
+  m.AddFunction(function1);
+  Module::StackFrameEntry* entry1 = new Module::StackFrameEntry();
+  entry1->address = 0xddb5f41285aa7757ULL;
+  entry1->size = 0x1486493370dc5073ULL;
+  m.AddStackFrameEntry(entry1);
+
+  Module::StackFrameEntry* entry2 = new Module::StackFrameEntry();
+  entry2->address = 0x8064f3af5e067e38ULL;
+  entry2->size = 0x0de2a5ee55509407ULL;
+  {
+    Module other(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+    Module::Function* function2 = new Module::Function(
+        other.AddStringToPool("_and_void"), 0x2987743d0b35b13fULL);
+    Module::Range r2(0x2987743d0b35b13fULL, 0xb369db048deb3010ULL);
+    function2->ranges.push_back(r2);
+    other.AddFunction(function2);
+    other.AddStackFrameEntry(entry2);
+
+    m.MergeFrom(&other);
+
+    vector<Module::Function*> functions;
+    other.GetFunctions(&functions, functions.end());
+    EXPECT_EQ(0U, functions.size());
+    vector<Module::StackFrameEntry*> entries;
+    other.GetStackFrameEntries(&entries);
+    EXPECT_EQ(0U, entries.size());
+  }
+
+  // The merged function's name must outlive OTHER.
+  m.Write(s, ALL_SYMBOL_DATA);
+  string contents = s.str();
+  EXPECT_STREQ("MODULE os-name architecture id-string name with spaces\n"
+               "FUNC 2987743d0b35b13f b369db048deb3010 0 _and_void\n"
+               "FUNC d35024aa7ca7da5c 200b26e605f99071 0 _without_form\n"
+               "STACK CFI INIT ddb5f41285aa7757 1486493370dc5073 \n"
+               "STACK CFI INIT 8064f3af5e067e38 de2a5ee55509407 \n",
+               contents.c_str());
+}
+
+TEST(Construct, ScopedArena) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  Module::Function* duplicate;
+  {
+    Module::ScopedArena arena(&m);
+    Module::Function* function = new Module::Function("function", 0x1000);
+    function->ranges.push_back(Module::Range(0x1000, 0x100));
+    function->inlines.push_back(std::unique_ptr<Module::Inline>(
+        new Module::Inline(NULL, vector<Module::Range>(), 1, 0, 0,
+                           vector<std::unique_ptr<Module::Inline>>())));
+    EXPECT_TRUE(m.AddFunction(function));
+    duplicate = new Module::Function("function", 0x1000);
+    EXPECT_FALSE(m.AddFunction(duplicate));
+    delete duplicate;
+    // The deleted function's storage is reused.
+    Module::Function* reused = new Module::Function("other", 0x2000);
+    EXPECT_EQ(duplicate, reused);
+    reused->ranges.push_back(Module::Range(0x2000, 0x100));
+    EXPECT_TRUE(m.AddFunction(reused));
+  }
+  // Outside the scope, functions come from the heap again.
+  Module::Function* function = new Module::Function("heap", 0x3000);
+  function->ranges.push_back(Module::Range(0x3000, 0x100));
+  EXPECT_TRUE(m.AddFunction(function));
+  vector<Module::Function*> functions;
+  m.GetFunctions(&functions, functions.end());
+  EXPECT_EQ(3U, functions.size());
+}
+
+// Functions merged from another module outlive that module's arena scope
+// and the module itself.
+TEST(Construct, MergeFromArena) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  {
+    Module other(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+    Module::ScopedArena arena(&other);
+    Module::Function* function = new Module::Function(
+        other.AddStringToPool("function"), 0x1000);
+    function->ranges.push_back(Module::Range(0x1000, 0x100));
+    other.AddFunction(function);
+    m.MergeFrom(&other);
+  }
+  stringstream s;
+  m.Write(s, ALL_SYMBOL_DATA);
+  EXPECT_STREQ("MODULE os-name architecture id-string name with spaces\n"
+               "FUNC 1000 100 0 function\n",
+               s.str().c_str());
+}
+
+// Inline origins with the same name are one object, even across modules
+// sharing a table, and outlive the modules that created them.
+TEST(Construct, ShareInlineOrigins) {
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+  m.inline_origin_map.SetReference(1, 1);
+  m.inline_origin_map.SetReference(2, 2);
+  m.inline_origin_map.SetReference(3, 3);
+  Module::InlineOrigin* origin =
+      m.inline_origin_map.GetOrCreateInlineOrigin(1, "origin");
+  EXPECT_EQ(origin, m.inline_origin_map.GetOrCreateInlineOrigin(2, "origin"));
+  // An origin without a name yet is its DIE's own, and is renamed in
+  // place once the name turns up.
+  Module::InlineOrigin* unnamed = m.inline_origin_map.GetOrCreateInlineOrigin(
+      3, m.AddStringToPool("<name omitted>"));
+  EXPECT_NE(origin, unnamed);
+  EXPECT_EQ(unnamed, m.inline_origin_map.GetOrCreateInlineOrigin(3, "late"));
+  EXPECT_EQ("late", unnamed->name);
+
+  Module::Function* function = new Module::Function("function", 0x1000);
+  function->ranges.push_back(Module::Range(0x1000, 0x100));
+  function->inlines.push_back(std::unique_ptr<Module::Inline>(
+      new Module::Inline(origin, vector<Module::Range>(1,
+                             Module::Range(0x1000, 0x10)),
+                         1, 0, 0, vector<std::unique_ptr<Module::Inline>>())));
+  m.AddFunction(function);
+  {
+    Module other(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+    other.inline_origin_map.ShareTableWith(m.inline_origin_map);
+    other.inline_origin_map.SetReference(4, 4);
+    other.inline_origin_map.SetReference(5, 5);
+    EXPECT_EQ(origin, other.inline_origin_map.GetOrCreateInlineOrigin(
+                          4, other.AddStringToPool("origin")));
+    Module::InlineOrigin* other_origin =
+        other.inline_origin_map.GetOrCreateInlineOrigin(
+            5, other.AddStringToPool("other"));
+    Module::Function* other_function = new Module::Function(
+        other.AddStringToPool("other_function"), 0x2000);
+    other_function->ranges.push_back(Module::Range(0x2000, 0x100));
+    other_function->inlines.push_back(std::unique_ptr<Module::Inline>(
+        new Module::Inline(other_origin, vector<Module::Range>(1,
+                               Module::Range(0x2000, 0x10)),
+                           2, 0, 0,
+                           vector<std::unique_ptr<Module::Inline>>())));
+    other.AddFunction(other_function);
+    m.MergeFrom(&other);
+  }
+  stringstream s;
+  m.Write(s, ALL_SYMBOL_DATA);
+  EXPECT_STREQ("MODULE os-name architecture id-string name with spaces\n"
+               "INLINE_ORIGIN 0 origin\n"
+               "INLINE_ORIGIN 1 other\n"
+               "FUNC 1000 100 0 function\n"
+               "INLINE 0 1 -1 0 1000 10\n"
+               "FUNC 2000 100 0 other_function\n"
+               "INLINE 0 2 -1 1 2000 10\n",
+               s.str().c_str());
+}
+
 TEST(Construct, UniqueFiles) {
   Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
   Module::File* file1 = m.FindFile("foo");
@@ -567,6 +970,90 @@ TEST(Construct, FunctionsAndThumbExternsWithSameAddress) {
                contents.c_str());
 }
 
+// Adding externs all at once sorts them, keeps the first at each address,
+// and leaves the module's own alone.
+TEST(Construct, AddExterns) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
+
+  Module::Extern* existing = new Module::Extern(0xbbbb);
+  existing->name = "existing";
+  m.AddExtern(existing);
+
+  vector<Module::Extern*> externs;
+  const struct {
+    Module::Address address;
+    const char* name;
+  } symbols[] = {
+    { 0xffff, "_xyz" }, { 0xaaaa, "_abc" }, { 0xffff, "_second" },
+    { 0xbbbb, "_duplicate" }, { 0xcccc, "_def" }
+  };
+  for (size_t i = 0; i < sizeof(symbols) / sizeof(symbols[0]); ++i) {
+    Module::Extern* ext = new Module::Extern(symbols[i].address);
+    ext->name = symbols[i].name;
+    externs.push_back(ext);
+  }
+  m.AddExterns(&externs);
+  EXPECT_TRUE(externs.empty());
+
+  m.Write(s, ALL_SYMBOL_DATA);
+  string contents = s.str();
+
+  EXPECT_STREQ("MODULE " MODULE_OS " " MODULE_ARCH " "
+               MODULE_ID " " MODULE_NAME "\n"
+               "PUBLIC aaaa 0 _abc\n"
+               "PUBLIC bbbb 0 existing\n"
+               "PUBLIC cccc 0 _def\n"
+               "PUBLIC ffff 0 _xyz\n",
+               contents.c_str());
+}
+
+// Externs added all at once after the functions are filtered as if they
+// had been added first, THUMB ones included.
+TEST(Construct, AddExternsAfterFunctions) {
+  stringstream s;
+  Module m(MODULE_NAME, MODULE_OS, "arm", MODULE_ID);
+
+  Module::Function* function = new Module::Function("_thumb_xyz", 0xfff0);
+  function->ranges.push_back(Module::Range(0xfff0, 0x10));
+  m.AddFunction(function);
+  function = new Module::Function("_arm_func", 0xcc00);
+  function->ranges.push_back(Module::Range(0xcc00, 0x10));
+  m.AddFunction(function);
+  function = new Module::Function("_both", 0xdd00);
+  function->ranges.push_back(Module::Range(0xdd00, 0x10));
+  m.AddFunction(function);
+
+  vector<Module::Extern*> externs;
+  const struct {
+    Module::Address address;
+    const char* name;
+  } symbols[] = {
+    { 0xabc1, "thumb_abc" }, { 0xfff1, "thumb_xyz" }, { 0xcc00, "arm_func" },
+    { 0xdd00, "both" }, { 0xdd01, "both_thumb" }
+  };
+  for (size_t i = 0; i < sizeof(symbols) / sizeof(symbols[0]); ++i) {
+    Module::Extern* ext = new Module::Extern(symbols[i].address);
+    ext->name = symbols[i].name;
+    externs.push_back(ext);
+  }
+  m.AddExterns(&externs);
+
+  m.Write(s, ALL_SYMBOL_DATA);
+  string contents = s.str();
+
+  // As AddFunction would have, the one at 0xdd00 goes, but as there was
+  // one there, the THUMB one at 0xdd01 stays.
+  EXPECT_STREQ("MODULE " MODULE_OS " arm "
+               MODULE_ID " " MODULE_NAME "\n"
+               "FUNC cc00 10 0 _arm_func\n"
+               "FUNC dd00 10 0 _both\n"
+               "FUNC fff0 10 0 _thumb_xyz\n"
+               "PUBLIC abc1 0 thumb_abc\n"
+               "PUBLIC dd01 0 both_thumb\n",
+               contents.c_str());
+}
+
 TEST(Write, OutOfRangeAddresses) {
   stringstream s;
   Module m(MODULE_NAME, MODULE_OS, MODULE_ARCH, MODULE_ID);
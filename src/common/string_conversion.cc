@@ -32,6 +32,7 @@
 #include "common/convert_UTF.h"
 #include "common/scoped_ptr.h"
 #include "common/string_conversion.h"
+#include "common/utf16_ascii.h"
 #include "common/using_std_string.h"
 
 namespace google_breakpad {
@@ -119,24 +120,36 @@ static inline uint16_t Swap(uint16_t value) {
 }
 
 string UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
-  const UTF16* source_ptr = &in[0];
+  // The result ends at the first null character, if |in| has one.  Most
+  // strings are ASCII, which converts a code unit to a byte.  Copy as much
+  // as is ASCII in one go, and leave the rest to ConvertUTF16toUTF8.
+  string out(in.size(), '\0');
+  size_t ascii_length =
+      in.empty() ? 0 : CopyUTF16ASCIIPrefix(&in[0], in.size(), swap, &out[0]);
+  size_t null_index = strnlen(out.data(), ascii_length);
+  if (null_index < ascii_length || ascii_length == in.size()) {
+    out.resize(null_index);
+    return out;
+  }
+  out.resize(ascii_length);
+
+  const UTF16* source_ptr = &in[ascii_length];
+  size_t source_length = in.size() - ascii_length;
   scoped_array<uint16_t> source_buffer;
 
   // If we're to swap, we need to make a local copy and swap each byte pair
   if (swap) {
-    int idx = 0;
-    source_buffer.reset(new uint16_t[in.size()]);
+    source_buffer.reset(new uint16_t[source_length]);
     UTF16* source_buffer_ptr = source_buffer.get();
-    for (vector<uint16_t>::const_iterator it = in.begin();
-         it != in.end(); ++it, ++idx)
-      source_buffer_ptr[idx] = Swap(*it);
+    for (size_t idx = 0; idx < source_length; ++idx)
+      source_buffer_ptr[idx] = Swap(source_ptr[idx]);
 
     source_ptr = source_buffer.get();
   }
 
   // The maximum expansion would be 4x the size of the input string.
-  const UTF16* source_end_ptr = source_ptr + in.size();
-  size_t target_capacity = in.size() * 4;
+  const UTF16* source_end_ptr = source_ptr + source_length;
+  size_t target_capacity = source_length * 4;
   scoped_array<UTF8> target_buffer(new UTF8[target_capacity]);
   UTF8* target_ptr = target_buffer.get();
   UTF8* target_end_ptr = target_ptr + target_capacity;
@@ -145,8 +158,10 @@ string UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
                                                strictConversion);
 
   if (result == conversionOK) {
-    const char* targetPtr = reinterpret_cast<const char*>(target_buffer.get());
-    return targetPtr;
+    const char* target = reinterpret_cast<const char*>(target_buffer.get());
+    size_t target_length = target_ptr - target_buffer.get();
+    out.append(target, strnlen(target, target_length));
+    return out;
   }
 
   return "";
@@ -34,6 +34,7 @@
 
 #include "breakpad_googletest_includes.h"
 #include "common/string_conversion.h"
+#include "common/using_std_string.h"
 
 using google_breakpad::UTF8ToUTF16;
 using google_breakpad::UTF8ToUTF16Char;
@@ -62,3 +63,24 @@ TEST(StringConversionTest, UTF16ToUTF8) {
   vector<uint16_t> in{'a', 0xdf, 'c', 0};
   EXPECT_EQ("aßc", UTF16ToUTF8(in, false));
 }
+
+TEST(StringConversionTest, UTF16ToUTF8ASCII) {
+  // Long enough to be copied several code units at a time, then converted
+  // a character at a time after the first non-ASCII one.
+  const string ascii = "C:\\Program Files\\Application\\module_name.dll";
+  vector<uint16_t> in(ascii.begin(), ascii.end());
+  EXPECT_EQ(ascii, UTF16ToUTF8(in, false));
+
+  vector<uint16_t> swapped;
+  for (size_t i = 0; i < in.size(); ++i)
+    swapped.push_back(static_cast<uint16_t>(in[i] << 8));
+  EXPECT_EQ(ascii, UTF16ToUTF8(swapped, true));
+
+  in.insert(in.begin() + 20, 0xdf);
+  EXPECT_EQ(ascii.substr(0, 20) + "ß" + ascii.substr(20),
+            UTF16ToUTF8(in, false));
+
+  // The result ends at a null character.
+  in[10] = 0;
+  EXPECT_EQ(ascii.substr(0, 10), UTF16ToUTF8(in, false));
+}
@@ -40,7 +40,11 @@ enum SymbolData {
   SYMBOLS_AND_FILES = 1,
   CFI = 1 << 1,
   INLINES = 1 << 2,
-  ALL_SYMBOL_DATA = INLINES | CFI | SYMBOLS_AND_FILES
+  ALL_SYMBOL_DATA = INLINES | CFI | SYMBOLS_AND_FILES,
+  // Not symbol data proper, and not part of ALL_SYMBOL_DATA: when writing
+  // a symbol file, append an index of where each function's records lie,
+  // so that they can be fetched by byte range.  See Module::Write.
+  ADDRESS_INDEX = 1 << 3
 };
 
 inline SymbolData operator&(SymbolData data1, SymbolData data2) {
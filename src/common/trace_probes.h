@@ -0,0 +1,87 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// trace_probes.h: Static tracepoints for tracing Breakpad in production.
+//
+// On Linux, when <sys/sdt.h> (from SystemTap) is available, each
+// BREAKPAD_PROBE* becomes a USDT probe in the "breakpad" provider. A
+// disabled probe is a single nop instruction and a note in the ELF file.
+// The arguments are computed whether or not the probe is enabled, so
+// they should be values at hand. A tracer such as bpftrace or perf
+// enables the probes by name, for example:
+//
+//   bpftrace -e 'usdt:./minidump_stackwalk:breakpad:stackwalk_frame
+//                { @trust[arg1] = count(); }'
+//
+// Elsewhere, and when BREAKPAD_NO_PROBES is defined, the macros expand to
+// nothing. The probes are safe in a compromised context.
+//
+// BREAKPAD_PROBE_SCOPE(name) fires <name>_start where it is and
+// <name>_done when the enclosing scope ends, however it ends, so that a
+// tracer can time the scope.
+
+#ifndef COMMON_TRACE_PROBES_H_
+#define COMMON_TRACE_PROBES_H_
+
+#if defined(__linux__) && !defined(BREAKPAD_NO_PROBES) && \
+    defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BREAKPAD_HAVE_PROBES 1
+#endif
+#endif
+
+#if defined(BREAKPAD_HAVE_PROBES)
+
+#define BREAKPAD_PROBE0(name) DTRACE_PROBE(breakpad, name)
+#define BREAKPAD_PROBE1(name, arg1) DTRACE_PROBE1(breakpad, name, arg1)
+#define BREAKPAD_PROBE2(name, arg1, arg2) \
+  DTRACE_PROBE2(breakpad, name, arg1, arg2)
+#define BREAKPAD_PROBE3(name, arg1, arg2, arg3) \
+  DTRACE_PROBE3(breakpad, name, arg1, arg2, arg3)
+
+#define BREAKPAD_PROBE_SCOPE(name)                   \
+  BREAKPAD_PROBE0(name##_start);                     \
+  struct BreakpadProbeScope_##name {                 \
+    ~BreakpadProbeScope_##name() {                   \
+      BREAKPAD_PROBE0(name##_done);                  \
+    }                                                \
+  } breakpad_probe_scope_##name
+
+#else  // BREAKPAD_HAVE_PROBES
+
+#define BREAKPAD_PROBE0(name) do {} while (0)
+#define BREAKPAD_PROBE1(name, arg1) do {} while (0)
+#define BREAKPAD_PROBE2(name, arg1, arg2) do {} while (0)
+#define BREAKPAD_PROBE3(name, arg1, arg2, arg3) do {} while (0)
+#define BREAKPAD_PROBE_SCOPE(name) do {} while (0)
+
+#endif  // BREAKPAD_HAVE_PROBES
+
+#endif  // COMMON_TRACE_PROBES_H_
@@ -0,0 +1,114 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// utf16_ascii.h: The ASCII fast path of UTF-16 to UTF-8 conversion.
+//
+// Nearly every string in a minidump, and most that the clients convert,
+// is ASCII, for which UTF-8 is just the low byte of each UTF-16 code
+// unit.  CopyUTF16ASCIIPrefix converts the ASCII characters at the start
+// of a string eight code units at a time where SSE2 or NEON is available,
+// and four at a time otherwise, leaving the rest to a full converter.
+
+#ifndef COMMON_UTF16_ASCII_H__
+#define COMMON_UTF16_ASCII_H__
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+// Copies the UTF-16 code units at the start of |in|, up to |length| of
+// them, to |out| as UTF-8 for as long as they are ASCII, and returns how
+// many were copied.  If |swap| is true, the code units are byte-swapped
+// first.  |out| must have room for |length| bytes.
+inline size_t CopyUTF16ASCIIPrefix(const uint16_t* in, size_t length,
+                                   bool swap, char* out) {
+  // The bits that must be clear in a code unit, as it is in memory, for it
+  // to be ASCII.
+  const uint16_t non_ascii = swap ? 0x80ff : 0xff80;
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i mask = _mm_set1_epi16(static_cast<short>(non_ascii));
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= length; i += 8) {
+    __m128i words =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(words, mask),
+                                          zero)) != 0xffff) {
+      break;
+    }
+    if (swap)
+      words = _mm_srli_epi16(words, 8);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i),
+                     _mm_packus_epi16(words, words));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const uint16x8_t mask = vdupq_n_u16(non_ascii);
+  for (; i + 8 <= length; i += 8) {
+    uint16x8_t words = vld1q_u16(in + i);
+    uint64x2_t set = vreinterpretq_u64_u16(vandq_u16(words, mask));
+    if ((vgetq_lane_u64(set, 0) | vgetq_lane_u64(set, 1)) != 0)
+      break;
+    if (swap)
+      words = vshrq_n_u16(words, 8);
+    vst1_u8(reinterpret_cast<uint8_t*>(out + i), vmovn_u16(words));
+  }
+#else
+  const uint64_t mask = non_ascii * 0x0001000100010001ULL;
+  for (; i + 4 <= length; i += 4) {
+    uint64_t words;
+    memcpy(&words, in + i, sizeof(words));
+    if (words & mask)
+      break;
+    for (size_t j = 0; j < 4; ++j) {
+      uint16_t word = in[i + j];
+      out[i + j] = static_cast<char>(swap ? word >> 8 : word);
+    }
+  }
+#endif
+  for (; i < length; ++i) {
+    uint16_t word = in[i];
+    if (word & non_ascii)
+      break;
+    out[i] = static_cast<char>(swap ? word >> 8 : word);
+  }
+  return i;
+}
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_UTF16_ASCII_H__
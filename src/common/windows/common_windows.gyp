@@ -85,6 +85,8 @@
         'pdb_source_line_writer.h',
         'pe_source_line_writer.cc',
         'pe_source_line_writer.h',
+        'pe_unwind_reader.cc',
+        'pe_unwind_reader.h',
         'pe_util.h',
         'pe_util.cc',
         'string_utils.cc',
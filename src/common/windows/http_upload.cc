@@ -357,9 +357,11 @@ namespace {
     return header;
   }
 
-  bool AppendFileToRequestBody(
+  bool AppendFileDataToRequestBody(
       const wstring& file_part_name,
       const wstring& filename,
+      const char* contents,
+      size_t contents_size,
       string* request_body) {
     string file_part_name_utf8 = WideToUTF8(file_part_name);
     if (file_part_name_utf8.empty()) {
@@ -377,17 +379,27 @@ namespace {
     request_body->append("Content-Type: application/octet-stream\r\n");
     request_body->append("\r\n");
 
+    request_body->append(contents, contents_size);
+    request_body->append("\r\n");
+
+    return true;
+  }
+
+  bool AppendFileToRequestBody(
+      const wstring& file_part_name,
+      const wstring& filename,
+      string* request_body) {
     vector<char> contents;
     if (!GetFileContents(filename, &contents)) {
       return false;
     }
 
-    if (!contents.empty()) {
-      request_body->append(&(contents[0]), contents.size());
-    }
-    request_body->append("\r\n");
-
-    return true;
+    return AppendFileDataToRequestBody(
+        file_part_name,
+        filename,
+        contents.empty() ? NULL : &contents[0],
+        contents.size(),
+        request_body);
   }
 
   bool GenerateRequestBody(const map<wstring, wstring>& parameters,
@@ -446,6 +458,30 @@ namespace google_breakpad {
         response_code);
   }
 
+  bool HTTPUpload::SendPutRequest(
+      const wstring& url,
+      const wstring& path,
+      const string& contents,
+      int* timeout_ms,
+      wstring* response_body,
+      int* response_code) {
+    string request_body;
+    request_body.reserve(contents.size() + path.size() + 128);
+    if (!AppendFileDataToRequestBody(L"symbol_file", path, contents.data(),
+                                     contents.size(), &request_body)) {
+      return false;
+    }
+
+    return SendRequestInner(
+        url,
+        L"PUT",
+        L"",
+        request_body,
+        timeout_ms,
+        response_body,
+        response_code);
+  }
+
   bool HTTPUpload::SendGetRequest(
       const wstring& url,
       int* timeout_ms,
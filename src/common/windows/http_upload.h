@@ -42,6 +42,7 @@
 #include <wininet.h>
 
 #include <map>
+#include <string>
 
 namespace google_breakpad {
 
@@ -65,6 +66,16 @@ class HTTPUpload {
       wstring* response_body,
       int* response_code);
 
+  // Sends a PUT request like the one above, with |contents| in place of
+  // the contents of a file named |path|, which is not read.
+  static bool SendPutRequest(
+      const wstring& url,
+      const wstring& path,
+      const string& contents,
+      int* timeout_ms,
+      wstring* response_body,
+      int* response_code);
+
   // Sends a GET request to the given URL.
   // Only HTTP(S) URLs are currently supported.  Returns true on success.
   // If the request is successful and response_body is non-NULL,
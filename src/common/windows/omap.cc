@@ -531,6 +531,114 @@ void ClipMappedRangeOriginal(const AddressRange& clip_range,
   return;
 }
 
+// Returns the index of the first endpoint in |image_map| at or after |rva|.
+size_t FindFirstEndpoint(const ImageMap& image_map, DWORD rva) {
+  const EndpointIndexMap& eim = image_map.endpoint_index_map;
+  EndpointIndex q1 = { rva, 0 };
+  return std::lower_bound(eim.begin(), eim.end(), q1, EndpointIndexLess) -
+      eim.begin();
+}
+
+// Returns the index of the earliest range in |image_map| that can intersect
+// |query_range|, given the index of the first endpoint at or after its
+// start. It is found through the secondary indexing structure.
+size_t FirstIntersectingRange(const ImageMap& image_map,
+                              const AddressRange& query_range,
+                              size_t endpoint) {
+  const EndpointIndexMap& eim = image_map.endpoint_index_map;
+  if (endpoint == eim.size())
+    return image_map.mapping.size();
+  // Backup to find the interval that contains our query point.
+  if (endpoint != 0 && query_range.rva < eim[endpoint].endpoint)
+    --endpoint;
+  return eim[endpoint].index;
+}
+
+// Returns the index of the first range in |image_map| that starts at or
+// after |end|, the first that can't intersect a query ending there. The
+// image map is already sorted by interval start point.
+size_t FindRangeAfter(const ImageMap& image_map, DWORD end) {
+  const Mapping& map = image_map.mapping;
+  MappedRange q2 = { end, 0 };
+  return std::lower_bound(map.begin(), map.end(), q2,
+                          MappedRangeOriginalLess) - map.begin();
+}
+
+// Appends to |mapped_ranges| the transformed ranges of |original_range|,
+// given the ranges [imin, imax) of |map| that can intersect |query_range|,
+// its nonempty version. |clipped| is scratch space.
+void MapIntersectingRanges(const Mapping& map,
+                           const AddressRange& original_range,
+                           const AddressRange& query_range,
+                           size_t imin,
+                           size_t imax,
+                           Mapping* clipped,
+                           AddressRangeVector* mapped_ranges) {
+  // Find all intervals that intersect the query range.
+  Mapping& temp_map = *clipped;
+  temp_map.clear();
+  for (size_t i = imin; i < imax; ++i) {
+    MappedRange mr = map[i];
+    ClipMappedRangeOriginal(query_range, &mr);
+    if (mr.length + mr.injected > 0)
+      temp_map.push_back(mr);
+  }
+
+  // If there are no intersecting ranges then the query range has been removed
+  // from the image in question.
+  if (temp_map.empty())
+    return;
+
+  // Sort based on transformed addresses.
+  std::sort(temp_map.begin(), temp_map.end(), MappedRangeMappedLess);
+
+  // Zero-length queries can't actually be merged. We simply output the set of
+  // unique RVAs that correspond to the query RVA.
+  if (original_range.length == 0) {
+    mapped_ranges->push_back(AddressRange(temp_map[0].rva_transformed, 0));
+    for (size_t i = 1; i < temp_map.size(); ++i) {
+      if (temp_map[i].rva_transformed > mapped_ranges->back().rva)
+        mapped_ranges->push_back(AddressRange(temp_map[i].rva_transformed, 0));
+    }
+    return;
+  }
+
+  // Merge any ranges that are consecutive in the mapped image. We merge over
+  // injected content if it makes ranges contiguous, but we ignore any injected
+  // content at the tail end of a range. This allows us to detect symbols that
+  // have been lengthened by injecting content in the middle. However, it
+  // misses the case where content has been injected at the head or the tail.
+  // The problem is that it doesn't know whether to attribute it to the
+  // preceding or following symbol. It is up to the author of the transform to
+  // output explicit OMAP info in these cases to ensure full coverage of the
+  // transformed address space.
+  DWORD rva_begin = temp_map[0].rva_transformed;
+  DWORD rva_cur_content = rva_begin + temp_map[0].length;
+  DWORD rva_cur_injected = rva_cur_content + temp_map[0].injected;
+  for (size_t i = 1; i < temp_map.size(); ++i) {
+    if (rva_cur_injected < temp_map[i].rva_transformed) {
+      // This marks the end of a continuous range in the image. Output the
+      // current range and start a new one.
+      if (rva_begin < rva_cur_content) {
+        mapped_ranges->push_back(
+            AddressRange(rva_begin, rva_cur_content - rva_begin));
+      }
+      rva_begin = temp_map[i].rva_transformed;
+    }
+
+    rva_cur_content = temp_map[i].rva_transformed + temp_map[i].length;
+    rva_cur_injected = rva_cur_content + temp_map[i].injected;
+  }
+
+  // Output the range in progress.
+  if (rva_begin < rva_cur_content) {
+    mapped_ranges->push_back(
+        AddressRange(rva_begin, rva_cur_content - rva_begin));
+  }
+
+  return;
+}
+
 }  // namespace
 
 int AddressRange::Compare(const AddressRange& rhs) const {
@@ -622,95 +730,58 @@ void MapAddressRange(const ImageMap& image_map,
     query_range.length = 1;
 
   // Find the range of intervals that can potentially intersect our query range.
-  size_t imin = 0;
-  size_t imax = 0;
-  {
-    // The index of the earliest possible range that can affect is us done by
-    // searching through the secondary indexing structure.
-    const EndpointIndexMap& eim = image_map.endpoint_index_map;
-    EndpointIndex q1 = { query_range.rva, 0 };
-    EndpointIndexMap::const_iterator it1 = std::lower_bound(
-        eim.begin(), eim.end(), q1, EndpointIndexLess);
-    if (it1 == eim.end()) {
-      imin  = map.size();
-    } else {
-      // Backup to find the interval that contains our query point.
-      if (it1 != eim.begin() && query_range.rva < it1->endpoint)
-        --it1;
-      imin = it1->index;
-    }
-
-    // The first range that can't possibly intersect us is found by searching
-    // through the image map directly as it is already sorted by interval start
-    // point.
-    MappedRange q2 = { query_range.end(), 0 };
-    Mapping::const_iterator it2 = std::lower_bound(
-        map.begin(), map.end(), q2, MappedRangeOriginalLess);
-    imax = it2 - map.begin();
-  }
+  const size_t endpoint = FindFirstEndpoint(image_map, query_range.rva);
+  const size_t imin = FirstIntersectingRange(image_map, query_range, endpoint);
+  const size_t imax = FindRangeAfter(image_map, query_range.end());
 
-  // Find all intervals that intersect the query range.
   Mapping temp_map;
-  for (size_t i = imin; i < imax; ++i) {
-    MappedRange mr = map[i];
-    ClipMappedRangeOriginal(query_range, &mr);
-    if (mr.length + mr.injected > 0)
-      temp_map.push_back(mr);
-  }
+  MapIntersectingRanges(map, original_range, query_range, imin, imax,
+                        &temp_map, mapped_ranges);
+}
 
-  // If there are no intersecting ranges then the query range has been removed
-  // from the image in question.
-  if (temp_map.empty())
-    return;
+ImageMapCursor::ImageMapCursor(const ImageMap& image_map)
+    : image_map_(image_map), endpoint_(0), end_(0), valid_(false) {
+}
 
-  // Sort based on transformed addresses.
-  std::sort(temp_map.begin(), temp_map.end(), MappedRangeMappedLess);
+void ImageMapCursor::Reset() {
+  valid_ = false;
+}
 
-  // Zero-length queries can't actually be merged. We simply output the set of
-  // unique RVAs that correspond to the query RVA.
-  if (original_range.length == 0) {
-    mapped_ranges->push_back(AddressRange(temp_map[0].rva_transformed, 0));
-    for (size_t i = 1; i < temp_map.size(); ++i) {
-      if (temp_map[i].rva_transformed > mapped_ranges->back().rva)
-        mapped_ranges->push_back(AddressRange(temp_map[i].rva_transformed, 0));
-    }
+void ImageMapCursor::MapAddressRange(const AddressRange& original_range,
+                                     AddressRangeVector* mapped_ranges) {
+  assert(mapped_ranges != NULL);
+
+  const Mapping& map = image_map_.mapping;
+  if (map.empty()) {
+    mapped_ranges->push_back(original_range);
     return;
   }
 
-  // Merge any ranges that are consecutive in the mapped image. We merge over
-  // injected content if it makes ranges contiguous, but we ignore any injected
-  // content at the tail end of a range. This allows us to detect symbols that
-  // have been lengthened by injecting content in the middle. However, it
-  // misses the case where content has been injected at the head or the tail.
-  // The problem is that it doesn't know whether to attribute it to the
-  // preceding or following symbol. It is up to the author of the transform to
-  // output explicit OMAP info in these cases to ensure full coverage of the
-  // transformed address space.
-  DWORD rva_begin = temp_map[0].rva_transformed;
-  DWORD rva_cur_content = rva_begin + temp_map[0].length;
-  DWORD rva_cur_injected = rva_cur_content + temp_map[0].injected;
-  for (size_t i = 1; i < temp_map.size(); ++i) {
-    if (rva_cur_injected < temp_map[i].rva_transformed) {
-      // This marks the end of a continuous range in the image. Output the
-      // current range and start a new one.
-      if (rva_begin < rva_cur_content) {
-        mapped_ranges->push_back(
-            AddressRange(rva_begin, rva_cur_content - rva_begin));
-      }
-      rva_begin = temp_map[i].rva_transformed;
-    }
+  AddressRange query_range(original_range);
+  if (query_range.length == 0)
+    query_range.length = 1;
 
-    rva_cur_content = temp_map[i].rva_transformed + temp_map[i].length;
-    rva_cur_injected = rva_cur_content + temp_map[i].injected;
+  // Step forward from where the last query's searches ended if this query
+  // lies no earlier, and search afresh otherwise.
+  const EndpointIndexMap& eim = image_map_.endpoint_index_map;
+  if (valid_ && query_range.rva >= last_query_.rva) {
+    while (endpoint_ < eim.size() && eim[endpoint_].endpoint < query_range.rva)
+      ++endpoint_;
+  } else {
+    endpoint_ = FindFirstEndpoint(image_map_, query_range.rva);
   }
-
-  // Output the range in progress.
-  if (rva_begin < rva_cur_content) {
-    mapped_ranges->push_back(
-        AddressRange(rva_begin, rva_cur_content - rva_begin));
+  if (valid_ && query_range.end() >= last_query_.end()) {
+    while (end_ < map.size() && map[end_].rva_original < query_range.end())
+      ++end_;
+  } else {
+    end_ = FindRangeAfter(image_map_, query_range.end());
   }
+  last_query_ = query_range;
+  valid_ = true;
 
-  return;
+  const size_t imin = FirstIntersectingRange(image_map_, query_range, endpoint_);
+  MapIntersectingRanges(map, original_range, query_range, imin, end_,
+                        &clipped_, mapped_ranges);
 }
 
 }  // namespace google_breakpad
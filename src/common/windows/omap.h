@@ -67,6 +67,34 @@ void MapAddressRange(const ImageMap& image_map,
                      const AddressRange& original_range,
                      AddressRangeVector* mapped_ranges);
 
+// Maps address ranges through an ImageMap as MapAddressRange does, but
+// remembers where in the map the last query fell. A run of queries in
+// increasing address order, such as the functions and lines of a symbol
+// file, then walks the map once instead of searching it for each query.
+// Queries out of order are answered by searching.
+class ImageMapCursor {
+ public:
+  explicit ImageMapCursor(const ImageMap& image_map);
+
+  // Forgets the last query. Must be called when the ImageMap changes.
+  void Reset();
+
+  void MapAddressRange(const AddressRange& original_range,
+                       AddressRangeVector* mapped_ranges);
+
+ private:
+  const ImageMap& image_map_;
+  // The last query, the index in |image_map_.endpoint_index_map| of the
+  // first endpoint at or after its start, and the index in
+  // |image_map_.mapping| of the first range at or after its end.
+  AddressRange last_query_;
+  size_t endpoint_;
+  size_t end_;
+  bool valid_;
+  // Kept between queries so as not to allocate one for each.
+  Mapping clipped_;
+};
+
 }  // namespace google_breakpad
 
 #endif  // COMMON_WINDOWS_OMAP_H_
@@ -0,0 +1,913 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pdb_reader.cc: Implementation of PDBReader. See pdb_reader.h for details.
+//
+// The layouts read here are those of Microsoft's published PDB sources
+// (github.com/Microsoft/microsoft-pdb) and LLVM's documentation of them
+// (llvm.org/docs/PDB).
+
+#include "common/windows/pdb_reader.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace google_breakpad {
+
+namespace {
+
+using std::pair;
+
+// The signature at the start of an MSF 7.00 file.
+const char kMSFMagic[] = "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0\0";
+const size_t kMSFMagicSize = 32;
+
+// The fixed stream numbers.
+const uint32_t kPDBInfoStream = 1;
+const uint32_t kDBIStream = 3;
+
+// The stream number marking an absent stream, in the DBI stream.
+const uint16_t kNoStream = 0xffff;
+
+// The stream size marking an absent stream, in the MSF directory.
+const uint32_t kNilStreamSize = 0xffffffff;
+
+// The size of the DBI stream's header and of the fixed part of each of its
+// compiland (module information) entries.
+const size_t kDBIHeaderSize = 64;
+const size_t kModuleInfoSize = 64;
+
+// The indices of the streams the DBI stream's optional debug header names.
+enum {
+  kDebugStreamFPO = 0,
+  kDebugStreamOmapFromSource = 4,
+  kDebugStreamSectionHeaders = 5,
+  kDebugStreamFrameData = 9
+};
+
+// The size of an IMAGE_SECTION_HEADER, an FPO_DATA entry and a frame
+// data entry.
+const size_t kSectionHeaderSize = 40;
+const size_t kFPODataSize = 16;
+const size_t kFrameDataSize = 32;
+
+// The signature of a compiland's symbols in the C13 format, and of the
+// string table stream.
+const uint32_t kC13Signature = 4;
+const uint32_t kStringTableSignature = 0xeffeeffe;
+
+// CodeView symbol record kinds.
+enum {
+  S_END = 0x0006,
+  S_BLOCK32 = 0x1103,
+  S_PUB32 = 0x110e,
+  S_LPROC32 = 0x110f,
+  S_GPROC32 = 0x1110,
+  S_LPROC32_ID = 0x1146,
+  S_GPROC32_ID = 0x1147,
+  S_LPROC32_DPC = 0x1155,
+  S_LPROC32_DPC_ID = 0x1156
+};
+
+// The section characteristics marking a section as holding code
+// (IMAGE_SCN_CNT_CODE and IMAGE_SCN_MEM_EXECUTE).
+const uint32_t kSectionCode = 0x00000020;
+const uint32_t kSectionExecute = 0x20000000;
+
+// C13 debug subsection kinds.
+const uint32_t DEBUG_S_LINES = 0xf2;
+const uint32_t DEBUG_S_FILECHKSMS = 0xf4;
+
+// The flag saying a line table has column entries, and the line numbers
+// that mark code belonging to no source line.
+const uint16_t kLinesHaveColumns = 0x1;
+const uint32_t kHiddenLine = 0xfeefee;
+const uint32_t kHiddenLineToo = 0xf00f00;
+
+// Read the symbol record at CURSOR: its kind, at *KIND, and its contents
+// after the kind, at *RECORD.  Advance CURSOR past it.
+bool ReadSymbolRecord(ByteCursor* cursor, uint16_t* kind, ByteBuffer* record) {
+  uint16_t length;
+  if (!(*cursor >> length >> *kind) || length < sizeof(*kind))
+    return false;
+  const uint8_t* contents;
+  if (!cursor->PointTo(&contents, length - sizeof(*kind)))
+    return false;
+  *record = ByteBuffer(contents, length - sizeof(*kind));
+  return true;
+}
+
+// Return true if KIND is that of a procedure record.
+bool IsProcedure(uint16_t kind) {
+  return kind == S_LPROC32 || kind == S_GPROC32 ||
+      kind == S_LPROC32_ID || kind == S_GPROC32_ID ||
+      kind == S_LPROC32_DPC || kind == S_LPROC32_DPC_ID;
+}
+
+// Parse a string of decimal digits strictly, as PDBSourceLineWriter does:
+// no sign, no leading zeroes, no overflow.  An empty string is zero.
+bool ParsePositiveStrict(const string& digits, int* result) {
+  int value = 0;
+  for (size_t i = 0; i < digits.size(); ++i) {
+    if (digits[i] < '0' || digits[i] > '9')
+      return false;
+    if (value > (std::numeric_limits<int>::max() - 9) / 10)
+      return false;
+    value = value * 10 + (digits[i] - '0');
+    if (value == 0 && i + 1 < digits.size())
+      return false;
+  }
+  *result = value;
+  return true;
+}
+
+// Strip the decoration of a C stdcall, fastcall or cdecl public symbol
+// NAME, as PDBSourceLineWriter::GetSymbolFunctionName does, and set
+// *STACK_PARAM_SIZE to the size of the parameters the decoration gives,
+// or to 0 if it gives none.  C++ names, which DIA would undecorate, are
+// left alone.
+void UndecorateCName(string* name, int* stack_param_size) {
+  *stack_param_size = 0;
+  if (name->empty() || name->find_first_of(":(?") != string::npos ||
+      ((*name)[0] != '_' && (*name)[0] != '@')) {
+    return;
+  }
+
+  size_t last_at = name->rfind('@');
+  int size;
+  if (last_at != string::npos && last_at > 0 &&
+      ParsePositiveStrict(name->substr(last_at + 1), &size)) {
+    // Fastcall passes the first 8 bytes of parameters in %ecx and %edx.
+    if ((*name)[0] == '@')
+      size = size > 8 ? size - 8 : 0;
+    *stack_param_size = size;
+    *name = name->substr(1, last_at - 1);
+  } else if ((*name)[0] == '_') {
+    *name = name->substr(1);
+  }
+}
+
+}  // namespace
+
+const uint32_t PDBReader::kFrameTypeFPO;
+const uint32_t PDBReader::kFrameTypeFrameData;
+
+struct PDBReader::Procedure {
+  string name;
+  uint32_t size;
+  // The blocks of the procedure that lie outside it, which profile-guided
+  // optimization moves away from the rest of the function's code.
+  vector<Module::Range> separated_blocks;
+};
+
+struct PDBReader::PendingLine {
+  bool operator<(const PendingLine& that) const {
+    return address < that.address;
+  }
+  uint32_t address;
+  uint32_t size;
+  uint32_t number;
+  Module::File* file;
+};
+
+PDBReader::PDBReader()
+    : contents_(NULL),
+      size_(0),
+      block_size_(0),
+      age_(0),
+      symbol_record_stream_(kNoStream),
+      section_header_stream_(kNoStream),
+      fpo_stream_(kNoStream),
+      frame_data_stream_(kNoStream) {
+  memset(guid_, 0, sizeof(guid_));
+}
+
+bool PDBReader::Read(const uint8_t* contents, size_t size) {
+  contents_ = contents;
+  size_ = size;
+  stream_sizes_.clear();
+  stream_blocks_.clear();
+  string_table_ = ByteBuffer();
+  compilands_.clear();
+  sections_.clear();
+
+  ByteBuffer file(contents, size);
+  ByteCursor cursor(&file);
+  const uint8_t* magic;
+  uint32_t free_block_map, block_count, directory_size, unknown, block_map;
+  if (!cursor.PointTo(&magic, kMSFMagicSize) ||
+      memcmp(magic, kMSFMagic, kMSFMagicSize) != 0) {
+    fprintf(stderr, "not a PDB file (MSF 7.00)\n");
+    return false;
+  }
+  if (!(cursor >> block_size_ >> free_block_map >> block_count
+               >> directory_size >> unknown >> block_map)) {
+    fprintf(stderr, "PDB file header is truncated\n");
+    return false;
+  }
+  if (block_size_ < 512 || (block_size_ & (block_size_ - 1)) != 0 ||
+      static_cast<uint64_t>(block_count) * block_size_ > size) {
+    fprintf(stderr, "PDB file header is corrupt\n");
+    return false;
+  }
+
+  // The block map lists the blocks holding the stream directory.
+  uint64_t directory_blocks =
+      (static_cast<uint64_t>(directory_size) + block_size_ - 1) / block_size_;
+  if (static_cast<uint64_t>(block_map) * block_size_ +
+      directory_blocks * sizeof(uint32_t) > size) {
+    fprintf(stderr, "PDB stream directory is out of bounds\n");
+    return false;
+  }
+  ByteBuffer map_buffer(contents + static_cast<size_t>(block_map) * block_size_,
+                        directory_blocks * sizeof(uint32_t));
+  ByteCursor map_cursor(&map_buffer);
+  vector<uint8_t> directory;
+  directory.reserve(directory_blocks * block_size_);
+  for (uint64_t i = 0; i < directory_blocks; ++i) {
+    uint32_t block;
+    map_cursor >> block;
+    if (block >= block_count) {
+      fprintf(stderr, "PDB stream directory is out of bounds\n");
+      return false;
+    }
+    const uint8_t* start = contents + static_cast<size_t>(block) * block_size_;
+    directory.insert(directory.end(), start, start + block_size_);
+  }
+  directory.resize(directory_size);
+
+  ByteBuffer directory_buffer(directory.data(), directory.size());
+  ByteCursor directory_cursor(&directory_buffer);
+  uint32_t stream_count;
+  if (!(directory_cursor >> stream_count) ||
+      stream_count > directory_cursor.Available() / sizeof(uint32_t)) {
+    fprintf(stderr, "PDB stream directory is corrupt\n");
+    return false;
+  }
+  stream_sizes_.resize(stream_count);
+  for (uint32_t i = 0; i < stream_count; ++i) {
+    directory_cursor >> stream_sizes_[i];
+    if (stream_sizes_[i] == kNilStreamSize)
+      stream_sizes_[i] = 0;
+  }
+  stream_blocks_.resize(stream_count);
+  for (uint32_t i = 0; i < stream_count; ++i) {
+    uint32_t blocks = (stream_sizes_[i] + block_size_ - 1) / block_size_;
+    if (blocks > directory_cursor.Available() / sizeof(uint32_t)) {
+      fprintf(stderr, "PDB stream directory is corrupt\n");
+      return false;
+    }
+    stream_blocks_[i].resize(blocks);
+    for (uint32_t j = 0; j < blocks; ++j) {
+      directory_cursor >> stream_blocks_[i][j];
+      if (stream_blocks_[i][j] >= block_count) {
+        fprintf(stderr, "PDB stream %u is out of bounds\n", i);
+        return false;
+      }
+    }
+  }
+
+  return ReadInfoStream() && ReadDBIStream() && ReadSections();
+}
+
+bool PDBReader::GetStream(uint32_t index, vector<uint8_t>* storage,
+                          ByteBuffer* stream) const {
+  if (index >= stream_sizes_.size())
+    return false;
+  const vector<uint32_t>& blocks = stream_blocks_[index];
+  uint32_t size = stream_sizes_[index];
+  if (blocks.empty()) {
+    *stream = ByteBuffer();
+    return true;
+  }
+
+  bool contiguous = true;
+  for (size_t i = 1; i < blocks.size() && contiguous; ++i)
+    contiguous = blocks[i] == blocks[i - 1] + 1;
+  if (contiguous) {
+    *stream = ByteBuffer(contents_ + static_cast<size_t>(blocks[0]) *
+                         block_size_, size);
+    return true;
+  }
+
+  storage->resize(size);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    size_t copied = i * block_size_;
+    memcpy(storage->data() + copied,
+           contents_ + static_cast<size_t>(blocks[i]) * block_size_,
+           std::min<size_t>(block_size_, size - copied));
+  }
+  *stream = ByteBuffer(storage->data(), size);
+  return true;
+}
+
+bool PDBReader::ReadInfoStream() {
+  vector<uint8_t> storage;
+  ByteBuffer stream;
+  if (!GetStream(kPDBInfoStream, &storage, &stream)) {
+    fprintf(stderr, "PDB file has no information stream\n");
+    return false;
+  }
+
+  // The header, followed by a hash table mapping stream names, in a
+  // buffer of strings, to stream numbers.
+  ByteCursor cursor(&stream);
+  uint32_t version, signature, age, names_size;
+  const uint8_t* names;
+  if (!(cursor >> version >> signature >> age).Read(guid_, sizeof(guid_)) ||
+      !(cursor >> names_size).PointTo(&names, names_size)) {
+    fprintf(stderr, "PDB information stream is truncated\n");
+    return false;
+  }
+
+  uint32_t entry_count, capacity, present_words, deleted_words;
+  if (!(cursor >> entry_count >> capacity >> present_words) ||
+      present_words > cursor.Available() / sizeof(uint32_t)) {
+    fprintf(stderr, "PDB stream name table is corrupt\n");
+    return false;
+  }
+  vector<uint32_t> present(present_words);
+  for (uint32_t i = 0; i < present_words; ++i)
+    cursor >> present[i];
+  if (!(cursor >> deleted_words) ||
+      !cursor.Skip(static_cast<size_t>(deleted_words) * sizeof(uint32_t))) {
+    fprintf(stderr, "PDB stream name table is corrupt\n");
+    return false;
+  }
+
+  uint32_t string_table_stream = kNilStreamSize;
+  for (uint32_t bucket = 0; bucket < present_words * 32; ++bucket) {
+    if (!(present[bucket / 32] & (1U << (bucket % 32))))
+      continue;
+    uint32_t name_offset, stream_index;
+    if (!(cursor >> name_offset >> stream_index) ||
+        name_offset >= names_size) {
+      fprintf(stderr, "PDB stream name table is corrupt\n");
+      return false;
+    }
+    const char* name = reinterpret_cast<const char*>(names + name_offset);
+    if (strnlen(name, names_size - name_offset) < names_size - name_offset &&
+        strcmp(name, "/names") == 0) {
+      string_table_stream = stream_index;
+    }
+  }
+
+  // The string table holds the names of source files and the frame data's
+  // program strings.  A PDB with neither may have none.
+  if (string_table_stream == kNilStreamSize)
+    return true;
+  ByteBuffer table;
+  if (!GetStream(string_table_stream, &string_table_storage_, &table)) {
+    fprintf(stderr, "PDB string table stream is missing\n");
+    return false;
+  }
+  ByteCursor table_cursor(&table);
+  uint32_t table_signature, hash_version, strings_size;
+  const uint8_t* strings;
+  if (!(table_cursor >> table_signature >> hash_version >> strings_size) ||
+      table_signature != kStringTableSignature ||
+      !table_cursor.PointTo(&strings, strings_size)) {
+    fprintf(stderr, "PDB string table is corrupt\n");
+    return false;
+  }
+  string_table_ = ByteBuffer(strings, strings_size);
+  return true;
+}
+
+bool PDBReader::ReadDBIStream() {
+  vector<uint8_t> storage;
+  ByteBuffer stream;
+  if (!GetStream(kDBIStream, &storage, &stream) ||
+      stream.Size() < kDBIHeaderSize) {
+    fprintf(stderr, "PDB file has no DBI stream\n");
+    return false;
+  }
+
+  ByteCursor cursor(&stream);
+  int32_t version_signature;
+  uint32_t version, mfc_type_server;
+  uint16_t global_stream, build_number, public_stream, dll_version,
+      dll_build, flags, machine;
+  int32_t module_info_size, section_contribution_size, section_map_size,
+      source_info_size, type_server_map_size, debug_header_size,
+      ec_size;
+  cursor >> version_signature >> version >> age_
+         >> global_stream >> build_number >> public_stream >> dll_version
+         >> symbol_record_stream_ >> dll_build
+         >> module_info_size >> section_contribution_size
+         >> section_map_size >> source_info_size >> type_server_map_size
+         >> mfc_type_server >> debug_header_size >> ec_size
+         >> flags >> machine;
+  cursor.Skip(sizeof(uint32_t));
+  if (module_info_size < 0 || section_contribution_size < 0 ||
+      section_map_size < 0 || source_info_size < 0 ||
+      type_server_map_size < 0 || debug_header_size < 0 || ec_size < 0) {
+    fprintf(stderr, "PDB DBI stream header is corrupt\n");
+    return false;
+  }
+
+  // Name the machine as FileHeaderMachineToCpuString does.
+  switch (machine) {
+    case 0x014c:  // IMAGE_FILE_MACHINE_I386
+      cpu_ = "x86";
+      break;
+    case 0x0200:  // IMAGE_FILE_MACHINE_IA64
+    case 0x8664:  // IMAGE_FILE_MACHINE_AMD64
+      cpu_ = "x86_64";
+      break;
+    default:
+      cpu_ = "unknown";
+      break;
+  }
+
+  const uint8_t* module_info;
+  if (!cursor.PointTo(&module_info, module_info_size) ||
+      !cursor.Skip(static_cast<size_t>(section_contribution_size) +
+                   section_map_size + source_info_size +
+                   type_server_map_size + ec_size)) {
+    fprintf(stderr, "PDB DBI stream is truncated\n");
+    return false;
+  }
+
+  // Each compiland's entry is followed by its name and that of its object
+  // file, and padded to a multiple of four bytes.
+  ByteBuffer modules(module_info, module_info_size);
+  ByteCursor module_cursor(&modules);
+  while (module_cursor.Available() >= kModuleInfoSize) {
+    Compiland compiland;
+    uint16_t module_flags;
+    string object_name;
+    module_cursor.Skip(32);
+    module_cursor >> module_flags >> compiland.symbol_stream
+                  >> compiland.symbol_size >> compiland.c11_lines_size
+                  >> compiland.c13_lines_size;
+    module_cursor.Skip(16);
+    if (!module_cursor.CString(&compiland.name).CString(&object_name)) {
+      fprintf(stderr, "PDB compiland list is corrupt\n");
+      return false;
+    }
+    size_t used = module_cursor.here() - module_info;
+    module_cursor.Skip(((used + 3) & ~static_cast<size_t>(3)) - used);
+    compilands_.push_back(compiland);
+  }
+
+  // The optional debug header names the streams holding the section
+  // headers, the OMAP tables and the frame data.
+  vector<uint16_t> debug_streams(debug_header_size / sizeof(uint16_t));
+  for (size_t i = 0; i < debug_streams.size(); ++i) {
+    if (!(cursor >> debug_streams[i])) {
+      fprintf(stderr, "PDB DBI stream is truncated\n");
+      return false;
+    }
+  }
+  debug_streams.resize(std::max<size_t>(debug_streams.size(),
+                                        kDebugStreamFrameData + 1),
+                       kNoStream);
+
+  uint16_t omap_stream = debug_streams[kDebugStreamOmapFromSource];
+  if (omap_stream != kNoStream && omap_stream < stream_sizes_.size() &&
+      stream_sizes_[omap_stream] != 0) {
+    fprintf(stderr, "PDB files with OMAP address translation are not "
+            "supported\n");
+    return false;
+  }
+
+  section_header_stream_ = debug_streams[kDebugStreamSectionHeaders];
+  fpo_stream_ = debug_streams[kDebugStreamFPO];
+  frame_data_stream_ = debug_streams[kDebugStreamFrameData];
+  return true;
+}
+
+bool PDBReader::ReadSections() {
+  vector<uint8_t> storage;
+  ByteBuffer stream;
+  if (section_header_stream_ == kNoStream ||
+      !GetStream(section_header_stream_, &storage, &stream)) {
+    fprintf(stderr, "PDB file has no section headers\n");
+    return false;
+  }
+
+  ByteCursor cursor(&stream);
+  while (cursor.Available() >= kSectionHeaderSize) {
+    Section section;
+    cursor.Skip(8);
+    cursor >> section.size >> section.rva;
+    cursor.Skip(kSectionHeaderSize - 20);
+    cursor >> section.characteristics;
+    sections_.push_back(section);
+  }
+  return true;
+}
+
+string PDBReader::DebugIdentifier() const {
+  // The format the symbol server uses for its directories, as
+  // GUIDString::GUIDToSymbolServerWString and GenerateDebugIdentifier
+  // write it.
+  ByteBuffer buffer(guid_, sizeof(guid_));
+  ByteCursor cursor(&buffer);
+  uint32_t data1;
+  uint16_t data2, data3;
+  cursor >> data1 >> data2 >> data3;
+  char identifier[64];
+  snprintf(identifier, sizeof(identifier),
+           "%08X%04X%04X%02X%02X%02X%02X%02X%02X%02X%02X%x",
+           data1, data2, data3, guid_[8], guid_[9], guid_[10], guid_[11],
+           guid_[12], guid_[13], guid_[14], guid_[15], age_);
+  return identifier;
+}
+
+string PDBReader::TableString(uint32_t offset) const {
+  if (offset >= string_table_.Size())
+    return string();
+  const char* start = reinterpret_cast<const char*>(string_table_.start) +
+      offset;
+  return string(start, strnlen(start, string_table_.Size() - offset));
+}
+
+uint32_t PDBReader::SectionRVA(uint16_t section, uint32_t offset) const {
+  if (section == 0 || section > sections_.size())
+    return 0;
+  return sections_[section - 1].rva + offset;
+}
+
+bool PDBReader::ReadCompiland(const Compiland& compiland,
+                              ProcedureMap* procedures,
+                              vector<PendingLine>* lines,
+                              Module* module) const {
+  if (compiland.symbol_stream == kNoStream)
+    return true;
+  vector<uint8_t> storage;
+  ByteBuffer stream;
+  if (!GetStream(compiland.symbol_stream, &storage, &stream) ||
+      stream.Size() < static_cast<uint64_t>(compiland.symbol_size) +
+                      compiland.c11_lines_size + compiland.c13_lines_size) {
+    fprintf(stderr, "PDB symbol stream for compiland %s is truncated\n",
+            compiland.name.c_str());
+    return false;
+  }
+
+  // The compiland's symbols.  Procedure and block records open scopes,
+  // giving the offset of the record that closes them.
+  ByteBuffer symbols(stream.start, compiland.symbol_size);
+  ByteCursor cursor(&symbols);
+  uint32_t signature;
+  if (!(cursor >> signature) || signature != kC13Signature) {
+    // Symbols older than C13 are not worth reading.
+    return true;
+  }
+  Procedure* procedure = NULL;
+  uint32_t procedure_rva = 0, procedure_end = 0;
+  while (cursor.Available() >= 2 * sizeof(uint16_t)) {
+    size_t offset = cursor.here() - symbols.start;
+    if (procedure && offset > procedure_end)
+      procedure = NULL;
+
+    uint16_t kind;
+    ByteBuffer record;
+    if (!ReadSymbolRecord(&cursor, &kind, &record)) {
+      fprintf(stderr, "PDB symbols for compiland %s are corrupt\n",
+              compiland.name.c_str());
+      return false;
+    }
+    ByteCursor record_cursor(&record);
+
+    if (IsProcedure(kind)) {
+      uint32_t parent, end, next, size, debug_start, debug_end, type,
+          code_offset;
+      uint16_t segment;
+      uint8_t flags;
+      string name;
+      if (!(record_cursor >> parent >> end >> next >> size >> debug_start
+                          >> debug_end >> type >> code_offset >> segment
+                          >> flags).CString(&name)) {
+        continue;
+      }
+      uint32_t rva = SectionRVA(segment, code_offset);
+      if (rva == 0)
+        continue;
+
+      // Where several procedures share an address, as after identical code
+      // folding, take the one DIA would: the least name.
+      ProcedureMap::iterator it = procedures->find(rva);
+      if (it == procedures->end()) {
+        it = procedures->insert(std::make_pair(rva, Procedure())).first;
+        it->second.name = name;
+        it->second.size = size;
+      } else if (name < it->second.name) {
+        it->second.name = name;
+        it->second.size = size;
+      }
+      procedure = &it->second;
+      procedure_rva = rva;
+      procedure_end = end;
+    } else if (kind == S_BLOCK32 && procedure) {
+      uint32_t parent, end, size, code_offset;
+      uint16_t segment;
+      if (!(record_cursor >> parent >> end >> size >> code_offset
+                          >> segment)) {
+        continue;
+      }
+      uint32_t rva = SectionRVA(segment, code_offset);
+      if (rva < procedure_rva || rva > procedure_rva + procedure->size)
+        procedure->separated_blocks.push_back(Module::Range(rva, size));
+    }
+  }
+
+  // The C13 line information: a series of subsections, among which the
+  // line tables refer to files by their offset in the file checksum
+  // subsection, which in turn names them in the string table.
+  ByteBuffer c13(stream.start + compiland.symbol_size +
+                 compiland.c11_lines_size, compiland.c13_lines_size);
+  vector<ByteBuffer> line_tables;
+  ByteBuffer checksums;
+  ByteCursor c13_cursor(&c13);
+  while (c13_cursor.Available() >= 2 * sizeof(uint32_t)) {
+    uint32_t kind, length;
+    const uint8_t* data;
+    if (!(c13_cursor >> kind >> length).PointTo(&data, length)) {
+      fprintf(stderr, "PDB line information for compiland %s is corrupt\n",
+              compiland.name.c_str());
+      return false;
+    }
+    c13_cursor.Skip(std::min<size_t>((4 - length % 4) % 4,
+                                     c13_cursor.Available()));
+    if (kind == DEBUG_S_FILECHKSMS)
+      checksums = ByteBuffer(data, length);
+    else if (kind == DEBUG_S_LINES)
+      line_tables.push_back(ByteBuffer(data, length));
+  }
+
+  for (size_t i = 0; i < line_tables.size(); ++i) {
+    ByteCursor lines_cursor(&line_tables[i]);
+    uint32_t code_offset, code_size;
+    uint16_t segment, flags;
+    if (!(lines_cursor >> code_offset >> segment >> flags >> code_size))
+      continue;
+    uint32_t rva = SectionRVA(segment, code_offset);
+    size_t column_size = (flags & kLinesHaveColumns) ? 4 : 0;
+
+    // Each block gives the lines of one file.
+    while (lines_cursor.Available() >= 3 * sizeof(uint32_t)) {
+      uint32_t file_offset, line_count, block_size;
+      lines_cursor >> file_offset >> line_count >> block_size;
+      if (line_count > lines_cursor.Available() / (8 + column_size)) {
+        fprintf(stderr, "PDB line table for compiland %s is corrupt\n",
+                compiland.name.c_str());
+        return false;
+      }
+      ByteBuffer entries(lines_cursor.here(), line_count * 8);
+      lines_cursor.Skip(line_count * (8 + column_size));
+
+      uint32_t name_offset;
+      ByteCursor checksum_cursor(&checksums);
+      if (file_offset >= checksums.Size() ||
+          !(checksum_cursor.Skip(file_offset) >> name_offset)) {
+        fprintf(stderr, "PDB line table for compiland %s names an unknown "
+                "file\n", compiland.name.c_str());
+        return false;
+      }
+      Module::File* file = module->FindFile(TableString(name_offset));
+
+      // A line runs up to the next line's code, or to the end of the
+      // table's code.
+      ByteCursor entry_cursor(&entries);
+      uint32_t offset, line_flags;
+      entry_cursor >> offset >> line_flags;
+      for (uint32_t j = 0; j < line_count; ++j) {
+        uint32_t next_offset = code_size;
+        uint32_t next_flags = 0;
+        if (j + 1 < line_count)
+          entry_cursor >> next_offset >> next_flags;
+        uint32_t number = line_flags & 0xffffff;
+        if (number != kHiddenLine && number != kHiddenLineToo &&
+            next_offset >= offset) {
+          PendingLine line = { rva + offset, next_offset - offset, number,
+                               file };
+          lines->push_back(line);
+        }
+        offset = next_offset;
+        line_flags = next_flags;
+      }
+    }
+  }
+  return true;
+}
+
+bool PDBReader::ReadSymbols(Module* module) const {
+  ProcedureMap procedures;
+  vector<PendingLine> lines;
+  for (size_t i = 0; i < compilands_.size(); ++i) {
+    if (!ReadCompiland(compilands_[i], &procedures, &lines, module))
+      return false;
+  }
+  std::stable_sort(lines.begin(), lines.end());
+
+  for (ProcedureMap::const_iterator it = procedures.begin();
+       it != procedures.end(); ++it) {
+    const Procedure& procedure = it->second;
+    // dwarf_cu_to_module.cc and PDBSourceLineWriter name nameless
+    // functions this way.
+    const string& name =
+        procedure.name.empty() ? "<name omitted>" : procedure.name;
+    Module::Function* function =
+        new Module::Function(module->AddStringToPool(name), it->first);
+    function->ranges.push_back(Module::Range(it->first, procedure.size));
+    function->ranges.insert(function->ranges.end(),
+                            procedure.separated_blocks.begin(),
+                            procedure.separated_blocks.end());
+    std::sort(function->ranges.begin(), function->ranges.end(),
+              [](const Module::Range& a, const Module::Range& b) {
+                return a.address < b.address;
+              });
+
+    for (const Module::Range& range : function->ranges) {
+      PendingLine start = { static_cast<uint32_t>(range.address), 0, 0,
+                            NULL };
+      for (vector<PendingLine>::const_iterator line =
+               std::lower_bound(lines.begin(), lines.end(), start);
+           line != lines.end() && line->address < range.address + range.size;
+           ++line) {
+        Module::Line module_line = { line->address, line->size, line->file,
+                                     static_cast<int>(line->number) };
+        function->lines.push_back(module_line);
+      }
+    }
+
+    if (!module->AddFunction(function))
+      delete function;
+  }
+
+  // The public symbols are among the global symbol records.  As with
+  // procedures, the least decorated name at an address is the one taken,
+  // and addresses with a function are left to it.
+  if (symbol_record_stream_ == kNoStream)
+    return true;
+  vector<uint8_t> storage;
+  ByteBuffer stream;
+  if (!GetStream(symbol_record_stream_, &storage, &stream)) {
+    fprintf(stderr, "PDB global symbol stream is missing\n");
+    return false;
+  }
+  std::map<uint32_t, pair<string, bool> > publics;
+  ByteCursor cursor(&stream);
+  while (cursor.Available() >= 2 * sizeof(uint16_t)) {
+    uint16_t kind;
+    ByteBuffer record;
+    if (!ReadSymbolRecord(&cursor, &kind, &record)) {
+      fprintf(stderr, "PDB global symbols are corrupt\n");
+      return false;
+    }
+    if (kind != S_PUB32)
+      continue;
+    ByteCursor record_cursor(&record);
+    uint32_t flags, offset;
+    uint16_t segment;
+    string name;
+    if (!(record_cursor >> flags >> offset >> segment).CString(&name))
+      continue;
+    uint32_t rva = SectionRVA(segment, offset);
+    if (rva == 0 || procedures.count(rva))
+      continue;
+    // DIA takes a public symbol to be code if its section holds code; the
+    // record's own flags are often clear even for functions.
+    bool is_code = (sections_[segment - 1].characteristics &
+                    (kSectionCode | kSectionExecute)) != 0;
+    std::map<uint32_t, pair<string, bool> >::iterator it = publics.find(rva);
+    if (it == publics.end())
+      publics[rva] = std::make_pair(name, is_code);
+    else if (name < it->second.first)
+      it->second = std::make_pair(name, is_code);
+  }
+
+  for (std::map<uint32_t, pair<string, bool> >::iterator it =
+           publics.begin(); it != publics.end(); ++it) {
+    if (!it->second.second)
+      continue;
+    Module::Extern* ext = new Module::Extern(it->first);
+    int stack_param_size;
+    ext->name = it->second.first;
+    UndecorateCName(&ext->name, &stack_param_size);
+    ext->parameter_size = stack_param_size;
+    module->AddExtern(ext);
+  }
+  return true;
+}
+
+bool PDBReader::ReadFrameData(vector<FrameData>* frame_data) const {
+  vector<uint8_t> storage;
+  ByteBuffer stream;
+  if (frame_data_stream_ != kNoStream) {
+    if (!GetStream(frame_data_stream_, &storage, &stream)) {
+      fprintf(stderr, "PDB frame data stream is missing\n");
+      return false;
+    }
+    // The entries may follow a four-byte relocation pointer.
+    ByteCursor cursor(&stream);
+    if (stream.Size() % kFrameDataSize != 0)
+      cursor.Skip(sizeof(uint32_t));
+    while (cursor.Available() >= kFrameDataSize) {
+      FrameData entry;
+      uint32_t program_offset, flags;
+      uint16_t prolog_size, saved_register_size;
+      cursor >> entry.rva >> entry.code_size >> entry.local_size
+             >> entry.parameter_size >> entry.max_stack_size
+             >> program_offset >> prolog_size >> saved_register_size
+             >> flags;
+      entry.type = kFrameTypeFrameData;
+      entry.prolog_size = prolog_size;
+      entry.saved_register_size = saved_register_size;
+      entry.program_string = TableString(program_offset);
+      entry.has_program_string = !entry.program_string.empty();
+      entry.allocates_base_pointer = false;
+      frame_data->push_back(entry);
+    }
+  }
+
+  if (fpo_stream_ != kNoStream) {
+    if (!GetStream(fpo_stream_, &storage, &stream)) {
+      fprintf(stderr, "PDB FPO stream is missing\n");
+      return false;
+    }
+    // FPO_DATA gives sizes in doublewords, and packs the prolog size, the
+    // number of saved registers and whether %ebp is used into one field.
+    ByteCursor cursor(&stream);
+    while (cursor.Available() >= kFPODataSize) {
+      FrameData entry;
+      uint32_t locals;
+      uint16_t parameters, attributes;
+      cursor >> entry.rva >> entry.code_size >> locals >> parameters
+             >> attributes;
+      entry.type = kFrameTypeFPO;
+      entry.prolog_size = attributes & 0xff;
+      entry.parameter_size = parameters * 4;
+      entry.saved_register_size = ((attributes >> 8) & 0x7) * 4;
+      entry.local_size = locals * 4;
+      entry.max_stack_size = 0;
+      entry.has_program_string = false;
+      entry.allocates_base_pointer = (attributes >> 12) & 0x1;
+      frame_data->push_back(entry);
+    }
+  }
+  return true;
+}
+
+// static
+bool PDBReader::WriteStackWinRecords(const vector<FrameData>& frame_data,
+                                     std::ostream& stream) {
+  // PDB files, especially system ones, often repeat an entry many times
+  // over; PDBSourceLineWriter leaves the repetitions out, and so do we.
+  const FrameData* last = NULL;
+  for (size_t i = 0; i < frame_data.size(); ++i) {
+    const FrameData& entry = frame_data[i];
+    if (last && entry.type == last->type && entry.rva == last->rva &&
+        entry.code_size == last->code_size &&
+        entry.prolog_size == last->prolog_size) {
+      continue;
+    }
+    last = &entry;
+    stream << "STACK WIN " << std::hex << entry.type << " " << entry.rva
+           << " " << entry.code_size << " " << entry.prolog_size
+           << " 0 " << entry.parameter_size << " "
+           << entry.saved_register_size << " " << entry.local_size << " "
+           << entry.max_stack_size << " " << std::dec
+           << entry.has_program_string << " ";
+    if (entry.has_program_string)
+      stream << entry.program_string << "\n";
+    else
+      stream << entry.allocates_base_pointer << "\n";
+    if (!stream.good())
+      return false;
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,214 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pdb_reader.h: Read the symbols of a Program Database (PDB) file directly,
+// without the Debug Interface Access (DIA) SDK.
+//
+// A PDB file is a Multi-Stream File (MSF): a block-structured container
+// whose directory lists, for each numbered stream, the blocks holding its
+// contents.  PDBReader parses the container and the streams that
+// PDBSourceLineWriter reaches through DIA: the PDB information stream for
+// the module's identifier, the DBI stream for the list of compilands and
+// the section headers, each compiland's symbols and C13 line tables, the
+// global symbol records for the PUBLIC symbols, and the FPO and frame data
+// streams for the STACK WIN records.  As nothing here depends on Windows,
+// PDB files can be dumped on any host.
+//
+// There are some differences from PDBSourceLineWriter's output:
+//
+// - Function names are taken as they appear in the compilands' procedure
+//   records, without the parameter list DIA builds from the type records,
+//   and C++ public symbol names are left decorated.
+//
+// - A FUNC record's parameter size is always zero.  DIA works it out from
+//   the types of the function's parameters.
+//
+// - PDB files whose addresses have to be translated through an OMAP table,
+//   written by tools that rearrange a linked image, are rejected.
+
+#ifndef COMMON_WINDOWS_PDB_READER_H_
+#define COMMON_WINDOWS_PDB_READER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "common/basictypes.h"
+#include "common/byte_cursor.h"
+#include "common/module.h"
+
+namespace google_breakpad {
+
+using std::string;
+using std::vector;
+
+class PDBReader {
+ public:
+  // One entry of the PDB's FPO or frame data tables: the information
+  // needed to unwind a stack frame in a range of x86 code.
+  struct FrameData {
+    // The kind of entry, as it appears in a STACK WIN record: kFrameTypeFPO
+    // for an FPO_DATA entry, kFrameTypeFrameData for a frame data entry.
+    uint32_t type;
+    uint32_t rva;
+    uint32_t code_size;
+    uint32_t prolog_size;
+    uint32_t parameter_size;
+    uint32_t saved_register_size;
+    uint32_t local_size;
+    uint32_t max_stack_size;
+    // The postfix expression recovering the caller's registers, if any.
+    bool has_program_string;
+    string program_string;
+    // Whether the function uses %ebp as its frame pointer, for entries
+    // without a program string.
+    bool allocates_base_pointer;
+  };
+
+  static const uint32_t kFrameTypeFPO = 0;
+  static const uint32_t kFrameTypeFrameData = 4;
+
+  PDBReader();
+
+  // Parse the SIZE bytes of the PDB file at CONTENTS, reading its header,
+  // stream directory, PDB information and DBI streams.  CONTENTS must stay
+  // valid for as long as this reader is in use.  On failure, print a
+  // message to stderr and return false.
+  bool Read(const uint8_t* contents, size_t size);
+
+  // The architecture of the code the PDB describes, named as in a symbol
+  // file's MODULE record ("x86", "x86_64", ...), and the identifier a
+  // symbol server files it under: its GUID followed by its age.
+  const string& cpu() const { return cpu_; }
+  string DebugIdentifier() const;
+
+  // Add the PDB's functions, with their source lines, and its public code
+  // symbols that no function covers to MODULE.  On failure, print a
+  // message to stderr and return false.
+  bool ReadSymbols(Module* module) const;
+
+  // Append the PDB's frame data entries to FRAME_DATA: those of the frame
+  // data stream, followed by those of the FPO stream, in the order DIA
+  // presents them.  On failure, print a message to stderr and return false.
+  bool ReadFrameData(vector<FrameData>* frame_data) const;
+
+  // Write FRAME_DATA to STREAM as STACK WIN records, leaving out entries
+  // that repeat the preceding one's type, address and sizes.  Return false
+  // if writing fails.
+  static bool WriteStackWinRecords(const vector<FrameData>& frame_data,
+                                   std::ostream& stream);
+
+ private:
+  // A compiland, as described by its entry in the DBI stream.
+  struct Compiland {
+    string name;
+    uint16_t symbol_stream;
+    uint32_t symbol_size;
+    uint32_t c11_lines_size;
+    uint32_t c13_lines_size;
+  };
+
+  // A function, chosen among the procedure records at its address, and a
+  // source line, before they are handed to the Module.
+  struct Procedure;
+  struct PendingLine;
+  typedef std::map<uint32_t, Procedure> ProcedureMap;
+
+  // A section of the image, as its header in the PDB gives it.
+  struct Section {
+    uint32_t rva;
+    uint32_t size;
+    uint32_t characteristics;
+  };
+
+  // Set *STREAM to the contents of stream INDEX.  If the stream's blocks
+  // follow one another in the file, STREAM points into the file itself;
+  // otherwise they are copied into STORAGE, and STREAM points there.
+  // Return false if there is no such stream or it goes past the end of the
+  // file.
+  bool GetStream(uint32_t index, vector<uint8_t>* storage,
+                 ByteBuffer* stream) const;
+
+  // Parse the PDB information stream, for the GUID and the index of the
+  // string table stream.
+  bool ReadInfoStream();
+
+  // Parse the DBI stream, for the age, machine type, list of compilands
+  // and the indices of the optional debug streams.
+  bool ReadDBIStream();
+
+  // Parse the section header stream.
+  bool ReadSections();
+
+  // Return the string at OFFSET in the PDB's string table ("/names"),
+  // or the empty string if there is none.
+  string TableString(uint32_t offset) const;
+
+  // Return the rva of OFFSET in the one-based SECTION, or 0 if there is
+  // no such section.
+  uint32_t SectionRVA(uint16_t section, uint32_t offset) const;
+
+  // Add the procedures of COMPILAND to PROCEDURES and its source lines,
+  // whose files MODULE is to hold, to LINES.
+  bool ReadCompiland(const Compiland& compiland, ProcedureMap* procedures,
+                     vector<PendingLine>* lines, Module* module) const;
+
+  // The file's contents and its MSF block size.
+  const uint8_t* contents_;
+  size_t size_;
+  uint32_t block_size_;
+
+  // For each stream, its size and the blocks holding it.
+  vector<uint32_t> stream_sizes_;
+  vector<vector<uint32_t> > stream_blocks_;
+
+  // From the PDB information stream.
+  uint8_t guid_[16];
+  ByteBuffer string_table_;
+  vector<uint8_t> string_table_storage_;
+
+  // From the DBI stream.
+  uint32_t age_;
+  string cpu_;
+  uint16_t symbol_record_stream_;
+  uint16_t section_header_stream_;
+  uint16_t fpo_stream_;
+  uint16_t frame_data_stream_;
+  vector<Compiland> compilands_;
+  vector<Section> sections_;
+
+  DISALLOW_COPY_AND_ASSIGN(PDBReader);
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_WINDOWS_PDB_READER_H_
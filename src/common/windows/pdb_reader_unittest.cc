@@ -0,0 +1,184 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pdb_reader_unittest.cc: Unit tests for google_breakpad::PDBReader.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/module.h"
+#include "common/windows/pdb_reader.h"
+
+using google_breakpad::Module;
+using google_breakpad::PDBReader;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Read the PDB file NAME from the Windows dump_syms test data into
+// *CONTENTS.
+bool ReadTestPDB(const string& name, vector<uint8_t>* contents) {
+  string path = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+      "/src/tools/windows/dump_syms/testdata/" + name;
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  uint8_t buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents->insert(contents->end(), buffer, buffer + read);
+  fclose(file);
+  return !contents->empty();
+}
+
+class PDBReaderTest : public testing::Test {
+ public:
+  void SetUp() {
+    ASSERT_TRUE(ReadTestPDB("dump_syms_regtest.pdb", &contents_));
+  }
+
+  vector<uint8_t> contents_;
+  PDBReader reader_;
+};
+
+TEST_F(PDBReaderTest, ModuleInfo) {
+  ASSERT_TRUE(reader_.Read(contents_.data(), contents_.size()));
+  EXPECT_EQ("x86", reader_.cpu());
+  EXPECT_EQ("9214611565FA4C538FE724A797B860F71", reader_.DebugIdentifier());
+}
+
+TEST_F(PDBReaderTest, Symbols) {
+  ASSERT_TRUE(reader_.Read(contents_.data(), contents_.size()));
+  Module module("dump_syms_regtest.pdb", "windows", reader_.cpu(),
+                reader_.DebugIdentifier());
+  ASSERT_TRUE(reader_.ReadSymbols(&module));
+
+  vector<Module::Function*> functions;
+  module.GetFunctions(&functions, functions.end());
+  ASSERT_EQ(158U, functions.size());
+  const Module::Function* main_function = NULL;
+  for (size_t i = 0; i < functions.size(); ++i) {
+    if (functions[i]->address == 0x1000)
+      main_function = functions[i];
+  }
+  ASSERT_TRUE(main_function != NULL);
+  EXPECT_EQ("main", main_function->name.str());
+  ASSERT_EQ(1U, main_function->ranges.size());
+  EXPECT_EQ(0x54U, main_function->ranges[0].size);
+  ASSERT_EQ(8U, main_function->lines.size());
+  EXPECT_EQ(0x1000U, main_function->lines[0].address);
+  EXPECT_EQ(6U, main_function->lines[0].size);
+  EXPECT_EQ(57, main_function->lines[0].number);
+  EXPECT_EQ("c:\\src\\breakpad\\src\\src\\tools\\windows\\dump_syms\\"
+            "testdata\\dump_syms_regtest.cc",
+            main_function->lines[0].file->name);
+  EXPECT_EQ(0x1050U, main_function->lines[7].address);
+  EXPECT_EQ(4U, main_function->lines[7].size);
+
+  // Only the code publics at addresses with no function remain, with
+  // their C decoration stripped.
+  vector<Module::Extern*> externs;
+  module.GetExterns(&externs, externs.end());
+  ASSERT_EQ(4U, externs.size());
+  EXPECT_EQ(0x45dcU, externs[0]->address);
+  EXPECT_EQ("_NLG_Dispatch", externs[0]->name);
+  EXPECT_EQ(0U, externs[0]->parameter_size);
+  EXPECT_EQ(0x57b2U, externs[3]->address);
+  EXPECT_EQ("RtlUnwind", externs[3]->name);
+  EXPECT_EQ(0x10U, externs[3]->parameter_size);
+}
+
+TEST_F(PDBReaderTest, FrameData) {
+  ASSERT_TRUE(reader_.Read(contents_.data(), contents_.size()));
+  vector<PDBReader::FrameData> frame_data;
+  ASSERT_TRUE(reader_.ReadFrameData(&frame_data));
+  ASSERT_FALSE(frame_data.empty());
+
+  // The frame data entries come first, then the FPO ones.
+  const PDBReader::FrameData& first = frame_data.front();
+  EXPECT_EQ(PDBReader::kFrameTypeFrameData, first.type);
+  EXPECT_EQ(0x1000U, first.rva);
+  EXPECT_EQ(0x54U, first.code_size);
+  EXPECT_EQ(6U, first.prolog_size);
+  EXPECT_EQ(8U, first.parameter_size);
+  EXPECT_EQ(0x14U, first.local_size);
+  EXPECT_TRUE(first.has_program_string);
+  EXPECT_EQ(PDBReader::kFrameTypeFPO, frame_data.back().type);
+
+  std::ostringstream stream;
+  ASSERT_TRUE(PDBReader::WriteStackWinRecords(frame_data, stream));
+  string records = stream.str();
+  EXPECT_EQ(0U, records.find("STACK WIN 4 1000 54 6 0 8 0 14 0 1 $T0 $ebp = "
+                             "$eip $T0 4 + ^ = $ebp $T0 ^ = $esp $T0 8 + = \n"));
+  EXPECT_NE(string::npos,
+            records.find("\nSTACK WIN 0 2db0 46 0 0 10 4 0 0 0 1\n"));
+}
+
+TEST(PDBReader, WriteStackWinRecordsSkipsRepeats) {
+  PDBReader::FrameData entry = {
+    PDBReader::kFrameTypeFPO, 0x1000, 0x20, 3, 8, 4, 0x10, 0, false, "", true
+  };
+  vector<PDBReader::FrameData> frame_data(3, entry);
+  frame_data[1].local_size = 0x20;
+  frame_data[2].rva = 0x1020;
+  frame_data[2].has_program_string = true;
+  frame_data[2].program_string = "$eip $esp ^ =";
+
+  std::ostringstream stream;
+  ASSERT_TRUE(PDBReader::WriteStackWinRecords(frame_data, stream));
+  EXPECT_EQ("STACK WIN 0 1000 20 3 0 8 4 10 0 0 1\n"
+            "STACK WIN 0 1020 20 3 0 8 4 10 0 1 $eip $esp ^ =\n",
+            stream.str());
+}
+
+TEST_F(PDBReaderTest, RejectsOtherFiles) {
+  vector<uint8_t> not_pdb(4096, 'x');
+  EXPECT_FALSE(reader_.Read(not_pdb.data(), not_pdb.size()));
+}
+
+TEST_F(PDBReaderTest, RejectsTruncatedFiles) {
+  // Cut the file off before its stream directory.
+  EXPECT_FALSE(reader_.Read(contents_.data(), 48));
+  EXPECT_FALSE(reader_.Read(contents_.data(), contents_.size() / 2));
+}
+
+TEST(PDBReader, RejectsOMAP) {
+  vector<uint8_t> contents;
+  ASSERT_TRUE(ReadTestPDB("omap_reorder_funcs.pdb", &contents));
+  PDBReader reader;
+  EXPECT_FALSE(reader.Read(contents.data(), contents.size()));
+}
+
+}  // namespace
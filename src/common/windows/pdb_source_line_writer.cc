@@ -35,6 +35,7 @@
 #include <dia2.h>
 #include <diacreate.h>
 #include <ImageHlp.h>
+#include <stdarg.h>
 #include <stdio.h>
 
 #include <algorithm>
@@ -60,6 +61,12 @@ namespace {
 
 using std::vector;
 
+// Size at which buffered output is written out to the symbol file.  The
+// records are small and numerous, so writing them out through one fwrite
+// per megabyte rather than one locked fprintf per record keeps the CRT's
+// stream locking out of the profile on large PDBs.
+const size_t kOutputBufferSize = 1 << 20;
+
 // The symbol (among possibly many) selected to represent an rva.
 struct SelectedSymbol {
   SelectedSymbol(const CComPtr<IDiaSymbol>& symbol, bool is_public)
@@ -208,7 +215,8 @@ void StripLlvmSuffixAndUndecorate(BSTR* name) {
 
 }  // namespace
 
-PDBSourceLineWriter::PDBSourceLineWriter() : output_(NULL) {
+PDBSourceLineWriter::PDBSourceLineWriter()
+    : output_(NULL), output_data_(NULL), image_map_cursor_(image_map_) {
 }
 
 PDBSourceLineWriter::~PDBSourceLineWriter() {
@@ -314,10 +322,10 @@ bool PDBSourceLineWriter::PrintLines(IDiaEnumLineNumbers* lines) {
     }
 
     AddressRangeVector ranges;
-    MapAddressRange(image_map_, AddressRange(rva, length), &ranges);
+    image_map_cursor_.MapAddressRange(AddressRange(rva, length), &ranges);
     for (size_t i = 0; i < ranges.size(); ++i) {
-      fprintf(output_, "%lx %lx %lu %lu\n", ranges[i].rva, ranges[i].length,
-              line_num, source_id);
+      Print("%lx %lx %lu %lu\n", ranges[i].rva, ranges[i].length,
+            line_num, source_id);
     }
     line.Release();
   }
@@ -359,12 +367,12 @@ bool PDBSourceLineWriter::PrintFunction(IDiaSymbol* function,
   }
 
   AddressRangeVector ranges;
-  MapAddressRange(image_map_, AddressRange(rva, static_cast<DWORD>(length)),
-                  &ranges);
+  image_map_cursor_.MapAddressRange(
+      AddressRange(rva, static_cast<DWORD>(length)), &ranges);
   for (size_t i = 0; i < ranges.size(); ++i) {
     const char* optional_multiple_field = has_multiple_symbols ? "m " : "";
-    fprintf(output_, "FUNC %s%lx %lx %x %ws\n", optional_multiple_field,
-            ranges[i].rva, ranges[i].length, stack_param_size, name.m_str);
+    Print("FUNC %s%lx %lx %x %ws\n", optional_multiple_field,
+          ranges[i].rva, ranges[i].length, stack_param_size, name.m_str);
   }
 
   CComPtr<IDiaEnumLineNumbers> lines;
@@ -415,7 +423,7 @@ bool PDBSourceLineWriter::PrintSourceFiles() {
       if (!FileIDIsCached(file_name_string)) {
         // this is a new file name, cache it and output a FILE line.
         CacheFileID(file_name_string, file_id);
-        fwprintf(output_, L"FILE %d %ws\n", file_id, file_name_string.c_str());
+        Print("FILE %d %ws\n", file_id, file_name_string.c_str());
       } else {
         // this file name has already been seen, just save this
         // ID for later lookup.
@@ -646,16 +654,15 @@ bool PDBSourceLineWriter::PrintFrameDataUsingPDB() {
       // Figure out where the prolog bytes have landed.
       AddressRangeVector prolog_ranges;
       if (prolog_size > 0) {
-        MapAddressRange(image_map_, AddressRange(rva, prolog_size),
-                        &prolog_ranges);
+        image_map_cursor_.MapAddressRange(AddressRange(rva, prolog_size),
+                                          &prolog_ranges);
       }
 
       // And figure out where the code bytes have landed.
       AddressRangeVector code_ranges;
-      MapAddressRange(image_map_,
-                      AddressRange(rva + prolog_size,
-                                   code_size - prolog_size),
-                      &code_ranges);
+      image_map_cursor_.MapAddressRange(
+          AddressRange(rva + prolog_size, code_size - prolog_size),
+          &code_ranges);
 
       struct FrameInfo {
         DWORD rva;
@@ -689,14 +696,14 @@ bool PDBSourceLineWriter::PrintFrameDataUsingPDB() {
 
       for (size_t i = 0; i < frame_infos.size(); ++i) {
         const FrameInfo& fi(frame_infos[i]);
-        fprintf(output_, "STACK WIN %lx %lx %lx %lx %x %lx %lx %lx %lx %d ",
-                type, fi.rva, fi.code_size, fi.prolog_size,
-                0 /* epilog_size */, parameter_size, saved_register_size,
-                local_size, max_stack_size, program_string_result == S_OK);
+        Print("STACK WIN %lx %lx %lx %lx %x %lx %lx %lx %lx %d ",
+              type, fi.rva, fi.code_size, fi.prolog_size,
+              0 /* epilog_size */, parameter_size, saved_register_size,
+              local_size, max_stack_size, program_string_result == S_OK);
         if (program_string_result == S_OK) {
-          fprintf(output_, "%ws\n", program_string.m_str);
+          Print("%ws\n", program_string.m_str);
         } else {
-          fprintf(output_, "%d\n", allocates_base_pointer);
+          Print("%d\n", allocates_base_pointer);
         }
       }
 
@@ -718,7 +725,12 @@ bool PDBSourceLineWriter::PrintFrameDataUsingEXE() {
     return false;
   }
 
-  return PrintPEFrameData(code_file_, output_);
+  // PrintPEFrameData writes to output_ directly, so everything buffered so
+  // far must reach the file first.
+  if (output_data_) {
+    return FlushOutput() && PrintPEFrameData(code_file_, output_data_);
+  }
+  return FlushOutput() && PrintPEFrameData(code_file_, output_);
 }
 
 bool PDBSourceLineWriter::PrintFrameData() {
@@ -751,12 +763,12 @@ bool PDBSourceLineWriter::PrintCodePublicSymbol(IDiaSymbol* symbol,
   }
 
   AddressRangeVector ranges;
-  MapAddressRange(image_map_, AddressRange(rva, 1), &ranges);
+  image_map_cursor_.MapAddressRange(AddressRange(rva, 1), &ranges);
   for (size_t i = 0; i < ranges.size(); ++i) {
     const char* optional_multiple_field = has_multiple_symbols ? "m " : "";
-    fprintf(output_, "PUBLIC %s%lx %x %ws\n", optional_multiple_field,
-            ranges[i].rva, stack_param_size > 0 ? stack_param_size : 0,
-            name.m_str);
+    Print("PUBLIC %s%lx %x %ws\n", optional_multiple_field,
+          ranges[i].rva, stack_param_size > 0 ? stack_param_size : 0,
+          name.m_str);
   }
 
   // Now walk the function in the original untranslated space, asking DIA
@@ -784,10 +796,10 @@ bool PDBSourceLineWriter::PrintCodePublicSymbol(IDiaSymbol* symbol,
       break;
 
     AddressRangeVector next_ranges;
-    MapAddressRange(image_map_, AddressRange(rva, 1), &next_ranges);
+    image_map_cursor_.MapAddressRange(AddressRange(rva, 1), &next_ranges);
     for (size_t i = 0; i < next_ranges.size(); ++i) {
-      fprintf(output_, "PUBLIC %lx %x %ws\n", next_ranges[i].rva,
-              stack_param_size > 0 ? stack_param_size : 0, name.m_str);
+      Print("PUBLIC %lx %x %ws\n", next_ranges[i].rva,
+            stack_param_size > 0 ? stack_param_size : 0, name.m_str);
     }
   }
 
@@ -803,9 +815,9 @@ bool PDBSourceLineWriter::PrintPDBInfo() {
   // Hard-code "windows" for the OS because that's the only thing that makes
   // sense for PDB files.  (This might not be strictly correct for Windows CE
   // support, but we don't care about that at the moment.)
-  fprintf(output_, "MODULE windows %ws %ws %ws\n",
-          info.cpu.c_str(), info.debug_identifier.c_str(),
-          info.debug_file.c_str());
+  Print("MODULE windows %ws %ws %ws\n",
+        info.cpu.c_str(), info.debug_identifier.c_str(),
+        info.debug_file.c_str());
 
   return true;
 }
@@ -816,9 +828,9 @@ bool PDBSourceLineWriter::PrintPEInfo() {
     return false;
   }
 
-  fprintf(output_, "INFO CODE_ID %ws %ws\n",
-          info.code_identifier.c_str(),
-          info.code_file.c_str());
+  Print("INFO CODE_ID %ws %ws\n",
+        info.code_identifier.c_str(),
+        info.code_file.c_str());
   return true;
 }
 
@@ -1092,8 +1104,64 @@ next_child:
   return param_size;
 }
 
+void PDBSourceLineWriter::Print(const char* format, ...) {
+  char line[1024];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (length < 0) {
+    return;
+  }
+
+  if (static_cast<size_t>(length) < sizeof(line)) {
+    output_buffer_.append(line, length);
+  } else {
+    // Long decorated names don't fit the stack buffer; format straight into
+    // the output buffer instead.
+    size_t offset = output_buffer_.size();
+    output_buffer_.resize(offset + length + 1);
+    va_start(args, format);
+    vsnprintf(&output_buffer_[offset], length + 1, format, args);
+    va_end(args);
+    output_buffer_.resize(offset + length);
+  }
+
+  if (output_buffer_.size() >= kOutputBufferSize) {
+    FlushOutput();
+  }
+}
+
+bool PDBSourceLineWriter::FlushOutput() {
+  if (output_data_) {
+    output_data_->append(output_buffer_);
+    output_buffer_.clear();
+    return true;
+  }
+  if (!output_buffer_.empty()) {
+    fwrite(output_buffer_.data(), 1, output_buffer_.size(), output_);
+    output_buffer_.clear();
+  }
+  return !ferror(output_);
+}
+
 bool PDBSourceLineWriter::WriteSymbols(FILE* symbol_file) {
   output_ = symbol_file;
+  bool ret = WriteSymbolRecords();
+  output_ = NULL;
+  return ret;
+}
+
+bool PDBSourceLineWriter::WriteSymbols(std::string* symbol_data) {
+  output_data_ = symbol_data;
+  bool ret = WriteSymbolRecords();
+  output_data_ = NULL;
+  return ret;
+}
+
+bool PDBSourceLineWriter::WriteSymbolRecords() {
+  output_buffer_.clear();
+  output_buffer_.reserve(kOutputBufferSize);
 
   // Load the OMAP information, and disable auto-translation of addresses in
   // preference of doing it ourselves.
@@ -1101,6 +1169,7 @@ bool PDBSourceLineWriter::WriteSymbols(FILE* symbol_file) {
   if (!GetOmapDataAndDisableTranslation(session_, &omap_data))
     return false;
   BuildImageMap(omap_data, &image_map_);
+  image_map_cursor_.Reset();
 
   bool ret = PrintPDBInfo();
   // This is not a critical piece of the symbol file.
@@ -1109,9 +1178,9 @@ bool PDBSourceLineWriter::WriteSymbols(FILE* symbol_file) {
       PrintSourceFiles() &&
       PrintFunctions() &&
       PrintFrameData();
-
-  output_ = NULL;
-  return ret;
+  // Flush even after a failure so that whatever was dumped reaches the file,
+  // as it did when every record was written to it straight away.
+  return FlushOutput() && ret;
 }
 
 void PDBSourceLineWriter::Close() {
@@ -83,6 +83,9 @@ class PDBSourceLineWriter {
   // Returns true on success.
   bool WriteSymbols(FILE *symbol_file);
 
+  // As above, but appends the symbol file to |symbol_data| in memory.
+  bool WriteSymbols(std::string *symbol_data);
+
   // Retrieves information about the module's debugging file.  Returns
   // true on success and false on failure.
   bool GetModuleInfo(PDBModuleInfo *info);
@@ -148,6 +151,17 @@ class PDBSourceLineWriter {
   // which consists of its timestamp and file size.
   bool PrintPEInfo();
 
+  // Formats a record like fprintf and appends it to output_buffer_, writing
+  // the buffer out to output_ once it grows past a megabyte.
+  void Print(const char* format, ...);
+
+  // Writes whatever is held in output_buffer_ out to output_, or appends it
+  // to output_data_.  Returns false if the output file is in an error state.
+  bool FlushOutput();
+
+  // Writes the whole symbol file out through Print and FlushOutput.
+  bool WriteSymbolRecords();
+
   // Returns true if this filename has already been seen,
   // and an ID is stored for it, or false if it has not.
   bool FileIDIsCached(const wstring& file) {
@@ -206,6 +220,13 @@ class PDBSourceLineWriter {
   // The current output file for this WriteMap invocation.
   FILE *output_;
 
+  // The string the symbol file is written to instead, when WriteSymbols was
+  // given one.
+  std::string *output_data_;
+
+  // Records formatted by Print that have not yet been written to output_.
+  std::string output_buffer_;
+
   // There may be many duplicate filenames with different IDs.
   // This maps from the DIA "unique ID" to a single ID per unique
   // filename.
@@ -215,6 +236,9 @@ class PDBSourceLineWriter {
 
   // This is used for calculating post-transform symbol addresses and lengths.
   ImageMap image_map_;
+  // Translates through |image_map_|, quickly for addresses in order, as the
+  // functions and their lines are printed.
+  ImageMapCursor image_map_cursor_;
 
   // Disallow copy ctor and operator=
   PDBSourceLineWriter(const PDBSourceLineWriter&);
@@ -0,0 +1,515 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pe_unwind_reader.cc: Implementation of PEUnwindReader. See
+// pe_unwind_reader.h for details.
+//
+// The layouts read here are those of Microsoft's documentation of the PE
+// format and of x64 exception handling (learn.microsoft.com/en-us/cpp/
+// build/exception-handling-x64).
+
+#include "common/windows/pe_unwind_reader.h"
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+
+namespace google_breakpad {
+
+namespace {
+
+using std::string;
+
+// The signatures of the MS-DOS stub and of the PE header it points to, and
+// the offset of that pointer in the stub.
+const uint16_t kDOSMagic = 0x5a4d;  // "MZ"
+const uint32_t kPESignature = 0x00004550;  // "PE\0\0"
+const size_t kPEHeaderPointerOffset = 0x3c;
+
+// The machine type of an x86_64 image, and the magic number of a PE32+
+// optional header.
+const uint16_t kMachineAMD64 = 0x8664;
+const uint16_t kPE32PlusMagic = 0x20b;
+
+// The offset in a PE32+ optional header of the count of data directories,
+// and the index of the exception directory among them.
+const size_t kDataDirectoryCountOffset = 108;
+const uint32_t kExceptionDirectory = 3;
+
+// The size of an IMAGE_SECTION_HEADER, of a RUNTIME_FUNCTION and of the
+// fixed part of an UNWIND_INFO.
+const size_t kSectionHeaderSize = 40;
+const uint32_t kRuntimeFunctionSize = 12;
+const uint32_t kUnwindInfoHeaderSize = 4;
+
+// The UNWIND_INFO flag saying a RUNTIME_FUNCTION for the function this
+// fragment belongs to follows the unwind codes.
+const uint8_t UNW_FLAG_CHAININFO = 0x4;
+
+// Unwind operation codes.
+enum {
+  UWOP_PUSH_NONVOL = 0,
+  UWOP_ALLOC_LARGE = 1,
+  UWOP_ALLOC_SMALL = 2,
+  UWOP_SET_FPREG = 3,
+  UWOP_SAVE_NONVOL = 4,
+  UWOP_SAVE_NONVOL_FAR = 5,
+  // UWOP_SAVE_XMM in version 1 unwind information, an epilog description
+  // in version 2.
+  UWOP_EPILOG = 6,
+  // UWOP_SAVE_XMM_FAR in version 1 unwind information.
+  UWOP_SPARE_CODE = 7,
+  UWOP_SAVE_XMM128 = 8,
+  UWOP_SAVE_XMM128_FAR = 9,
+  UWOP_PUSH_MACHFRAME = 10
+};
+
+// The registers unwind codes number, as STACK CFI records name them.
+const char* const kRegisterNames[] = {
+  "$rax", "$rcx", "$rdx", "$rbx", "$rsp", "$rbp", "$rsi", "$rdi",
+  "$r8", "$r9", "$r10", "$r11", "$r12", "$r13", "$r14", "$r15"
+};
+const int kRSP = 4;
+
+// How many RUNTIME_FUNCTION entries may chain to one another before we
+// take the chain for a loop.
+const int kMaxChainLength = 32;
+
+// Write RULES to STREAM as a STACK CFI record gives them.  This is
+// Module::AppendRuleMap's format; the Windows dump_syms, which uses this
+// file, doesn't otherwise need Module's implementation.
+void WriteRules(const Module::RuleMap& rules, std::ostream& stream) {
+  for (Module::RuleMap::const_iterator it = rules.begin(); it != rules.end();
+       ++it) {
+    stream << (it == rules.begin() ? "" : " ") << it->first << ": "
+           << it->second;
+  }
+}
+
+// Return the postfix expression for the sum of REG and OFFSET.
+string Sum(const string& reg, int64_t offset) {
+  return reg + " " + std::to_string(offset) + " +";
+}
+
+}  // namespace
+
+// Positions in the frame are given relative to the value %rsp had on entry
+// to the function, just below the return address.
+struct PEUnwindReader::Frame {
+  Frame()
+      : stack_size(0), frame_register(-1), frame_depth(0),
+        has_machine_frame(false), machine_frame(0) {}
+
+  // The rules recovering the caller's registers in this state.
+  Module::RuleMap Rules() const;
+
+  // The bytes the prolog has pushed and allocated so far: %rsp is the
+  // entry value less STACK_SIZE.
+  int64_t stack_size;
+
+  // The register the prolog has made its frame pointer, or -1 if none:
+  // the frame pointer is the entry value of %rsp less FRAME_DEPTH.  Once
+  // there is one, it locates the frame even where %rsp varies.
+  int frame_register;
+  int64_t frame_depth;
+
+  // Whether the function is entered through an interrupt or exception,
+  // which pushes a machine frame holding the caller's %rip and %rsp,
+  // rather than a call; and where the %rip of that machine frame is.
+  bool has_machine_frame;
+  int64_t machine_frame;
+
+  // Where the prolog has pushed or saved each nonvolatile register.
+  std::map<int, int64_t> saved_registers;
+};
+
+Module::RuleMap PEUnwindReader::Frame::Rules() const {
+  // The expression for the entry value of %rsp.
+  string base = "$rsp";
+  int64_t base_offset = stack_size;
+  if (frame_register >= 0) {
+    base = kRegisterNames[frame_register];
+    base_offset = frame_depth;
+  }
+
+  Module::RuleMap rules;
+  if (!has_machine_frame) {
+    rules[".cfa"] = Sum(base, base_offset + 8);
+    rules[".ra"] = Sum(".cfa", -8) + " ^";
+  } else {
+    rules[".cfa"] = Sum(base, base_offset + machine_frame + 24) + " ^";
+    rules[".ra"] = Sum(base, base_offset + machine_frame) + " ^";
+  }
+  for (std::map<int, int64_t>::const_iterator it = saved_registers.begin();
+       it != saved_registers.end(); ++it) {
+    if (it->first == kRSP)
+      continue;
+    if (!has_machine_frame)
+      rules[kRegisterNames[it->first]] = Sum(".cfa", it->second - 8) + " ^";
+    else
+      rules[kRegisterNames[it->first]] = Sum(base, base_offset + it->second) +
+          " ^";
+  }
+  return rules;
+}
+
+PEUnwindReader::PEUnwindReader()
+    : contents_(NULL), size_(0), exception_rva_(0), exception_size_(0) {}
+
+bool PEUnwindReader::Read(const uint8_t* contents, size_t size) {
+  contents_ = contents;
+  size_ = size;
+  sections_.clear();
+  exception_rva_ = 0;
+  exception_size_ = 0;
+
+  ByteBuffer file(contents, size);
+  ByteCursor cursor(&file);
+  uint16_t dos_magic;
+  uint32_t pe_header;
+  if (size < kPEHeaderPointerOffset + sizeof(pe_header) ||
+      !(cursor >> dos_magic) || dos_magic != kDOSMagic) {
+    fprintf(stderr, "not a PE image file\n");
+    return false;
+  }
+  cursor.set_here(contents + kPEHeaderPointerOffset) >> pe_header;
+  uint32_t signature = 0;
+  if (pe_header < size)
+    cursor.set_here(contents + pe_header) >> signature;
+  if (signature != kPESignature) {
+    fprintf(stderr, "not a PE image file\n");
+    return false;
+  }
+
+  uint16_t machine, section_count, optional_header_size, characteristics;
+  uint32_t timestamp, symbol_table, symbol_count;
+  const uint8_t* optional_header;
+  if (!(cursor >> machine >> section_count >> timestamp >> symbol_table
+               >> symbol_count >> optional_header_size >> characteristics) ||
+      !cursor.PointTo(&optional_header, optional_header_size)) {
+    fprintf(stderr, "PE header is truncated\n");
+    return false;
+  }
+  if (machine != kMachineAMD64) {
+    fprintf(stderr, "PE image is not for x86_64\n");
+    return false;
+  }
+
+  ByteBuffer optional_buffer(optional_header, optional_header_size);
+  ByteCursor optional_cursor(&optional_buffer);
+  uint16_t magic;
+  uint32_t directory_count;
+  if (!(optional_cursor >> magic) || magic != kPE32PlusMagic) {
+    fprintf(stderr, "not a PE32+ image\n");
+    return false;
+  }
+  if (!optional_cursor.Skip(kDataDirectoryCountOffset - sizeof(magic)) ||
+      !(optional_cursor >> directory_count)) {
+    fprintf(stderr, "PE optional header is truncated\n");
+    return false;
+  }
+  // An image without an exception directory has nothing to unwind.
+  if (directory_count > kExceptionDirectory &&
+      !(optional_cursor.Skip(kExceptionDirectory * 2 * sizeof(uint32_t))
+            >> exception_rva_ >> exception_size_)) {
+    fprintf(stderr, "PE optional header is truncated\n");
+    return false;
+  }
+
+  for (uint16_t i = 0; i < section_count; ++i) {
+    const uint8_t* header;
+    if (!cursor.PointTo(&header, kSectionHeaderSize)) {
+      fprintf(stderr, "PE section table is truncated\n");
+      return false;
+    }
+    ByteBuffer header_buffer(header, kSectionHeaderSize);
+    ByteCursor header_cursor(&header_buffer);
+    uint32_t virtual_size, raw_size;
+    Section section;
+    header_cursor.Skip(8) >> virtual_size >> section.rva >> raw_size
+                          >> section.file_offset;
+    // Only the part of the section that the file holds can be read; the
+    // rest of it is zeroes the loader supplies.
+    section.size = raw_size;
+    if (virtual_size != 0 && virtual_size < section.size)
+      section.size = virtual_size;
+    if (section.file_offset > size)
+      section.size = 0;
+    else if (section.size > size - section.file_offset)
+      section.size = size - section.file_offset;
+    sections_.push_back(section);
+  }
+  return true;
+}
+
+bool PEUnwindReader::GetData(uint32_t rva, uint32_t size,
+                             ByteBuffer* data) const {
+  for (size_t i = 0; i < sections_.size(); ++i) {
+    const Section& section = sections_[i];
+    if (rva < section.rva || rva - section.rva >= section.size)
+      continue;
+    uint32_t offset = rva - section.rva;
+    if (size > section.size - offset)
+      return false;
+    *data = ByteBuffer(contents_ + section.file_offset + offset, size);
+    return true;
+  }
+  return false;
+}
+
+bool PEUnwindReader::ApplyUnwindInfo(uint32_t rva, int depth, Frame* frame,
+                                     Module::StackFrameEntry* entry) const {
+  ByteBuffer header;
+  if (depth > kMaxChainLength ||
+      !GetData(rva, kUnwindInfoHeaderSize, &header)) {
+    return false;
+  }
+  ByteCursor header_cursor(&header);
+  uint8_t version_and_flags, prolog_size, code_count, frame_info;
+  header_cursor >> version_and_flags >> prolog_size >> code_count
+                >> frame_info;
+  uint8_t version = version_and_flags & 0x7;
+  uint8_t flags = version_and_flags >> 3;
+  if (version != 1 && version != 2)
+    return false;
+
+  // Each code takes a two-byte slot, and some take one or two more for
+  // their operands.  A chained function's RUNTIME_FUNCTION follows the
+  // codes, at an even number of slots.
+  ByteBuffer codes;
+  if (!GetData(rva + kUnwindInfoHeaderSize, code_count * 2, &codes))
+    return false;
+
+  // A fragment's frame is that of the function it is chained to, once its
+  // whole prolog has run, extended by the fragment's own prolog.
+  if (flags & UNW_FLAG_CHAININFO) {
+    ByteBuffer chained;
+    uint32_t begin, end, chained_rva;
+    if (!GetData(rva + kUnwindInfoHeaderSize + ((code_count + 1) & ~1) * 2,
+                 kRuntimeFunctionSize, &chained)) {
+      return false;
+    }
+    ByteCursor(&chained) >> begin >> end >> chained_rva;
+    if (!ApplyUnwindInfo(chained_rva, depth + 1, frame, NULL))
+      return false;
+  }
+
+  // The codes list the prolog's operations last first, each with the
+  // offset of the end of its instruction in the prolog.
+  struct Operation {
+    uint8_t offset;
+    uint8_t code;
+    uint8_t info;
+    uint32_t operand;
+  };
+  vector<Operation> operations;
+  ByteCursor code_cursor(&codes);
+  while (!code_cursor.AtEnd()) {
+    Operation operation;
+    uint8_t code_and_info;
+    uint16_t low, high;
+    bool tracked = true;
+    code_cursor >> operation.offset >> code_and_info;
+    operation.code = code_and_info & 0xf;
+    operation.info = code_and_info >> 4;
+    operation.operand = 0;
+    switch (operation.code) {
+      case UWOP_PUSH_NONVOL:
+      case UWOP_ALLOC_SMALL:
+      case UWOP_SET_FPREG:
+      case UWOP_PUSH_MACHFRAME:
+        break;
+      case UWOP_ALLOC_LARGE:
+        if (operation.info == 0) {
+          code_cursor >> low;
+          operation.operand = low * 8;
+        } else {
+          code_cursor >> low >> high;
+          operation.operand = low | (static_cast<uint32_t>(high) << 16);
+        }
+        break;
+      case UWOP_SAVE_NONVOL:
+        code_cursor >> low;
+        operation.operand = low * 8;
+        break;
+      case UWOP_SAVE_NONVOL_FAR:
+        code_cursor >> low >> high;
+        operation.operand = low | (static_cast<uint32_t>(high) << 16);
+        break;
+      // The rest leave the registers Breakpad recovers alone.
+      case UWOP_EPILOG:
+        // Epilog descriptions take one slot; UWOP_SAVE_XMM two.
+        if (version == 1)
+          code_cursor.Skip(2);
+        tracked = false;
+        break;
+      case UWOP_SPARE_CODE:
+      case UWOP_SAVE_XMM128_FAR:
+        code_cursor.Skip(4);
+        tracked = false;
+        break;
+      case UWOP_SAVE_XMM128:
+        code_cursor.Skip(2);
+        tracked = false;
+        break;
+      default:
+        return false;
+    }
+    if (!code_cursor)
+      return false;
+    if (tracked)
+      operations.push_back(operation);
+  }
+
+  Module::RuleMap rules;
+  if (entry) {
+    entry->initial_rules = frame->Rules();
+    rules = entry->initial_rules;
+  }
+  uint8_t last_offset = 0;
+  for (vector<Operation>::const_reverse_iterator it = operations.rbegin();
+       it != operations.rend(); ++it) {
+    if (it->offset < last_offset)
+      return false;
+    last_offset = it->offset;
+    switch (it->code) {
+      case UWOP_PUSH_NONVOL:
+        frame->stack_size += 8;
+        frame->saved_registers[it->info] = -frame->stack_size;
+        break;
+      case UWOP_ALLOC_LARGE:
+        frame->stack_size += it->operand;
+        break;
+      case UWOP_ALLOC_SMALL:
+        frame->stack_size += it->info * 8 + 8;
+        break;
+      case UWOP_SET_FPREG:
+        if ((frame_info & 0xf) == 0)
+          return false;
+        frame->frame_register = frame_info & 0xf;
+        frame->frame_depth = frame->stack_size - (frame_info >> 4) * 16;
+        break;
+      case UWOP_SAVE_NONVOL:
+      case UWOP_SAVE_NONVOL_FAR:
+        frame->saved_registers[it->info] =
+            static_cast<int64_t>(it->operand) - frame->stack_size;
+        break;
+      case UWOP_PUSH_MACHFRAME:
+        // The machine frame is there on entry: %rip, then %cs, %rflags,
+        // %rsp and %ss, after an error code if INFO is 1.
+        frame->has_machine_frame = true;
+        frame->machine_frame = (it->info ? 8 : 0) - frame->stack_size;
+        break;
+    }
+
+    // An operation's rules take effect after its instruction, unless it
+    // is one the function is entered with.  The prolog may run past the
+    // end of a fragment; those operations never take effect in it.
+    if (!entry || it->offset >= entry->size)
+      continue;
+    Module::RuleMap changes;
+    Module::RuleMap new_rules = frame->Rules();
+    for (Module::RuleMap::const_iterator rule = new_rules.begin();
+         rule != new_rules.end(); ++rule) {
+      Module::RuleMap::const_iterator old_rule = rules.find(rule->first);
+      if (old_rule == rules.end() || old_rule->second != rule->second)
+        changes[rule->first] = rule->second;
+    }
+    rules.swap(new_rules);
+    Module::RuleMap& target = it->offset == 0 ?
+        entry->initial_rules :
+        entry->rule_changes[entry->address + it->offset];
+    for (Module::RuleMap::const_iterator rule = changes.begin();
+         rule != changes.end(); ++rule) {
+      target[rule->first] = rule->second;
+    }
+  }
+  return true;
+}
+
+bool PEUnwindReader::ReadStackFrameEntries(
+    vector<Module::StackFrameEntry>* entries) const {
+  if (exception_size_ == 0)
+    return true;
+  ByteBuffer directory;
+  if (!GetData(exception_rva_, exception_size_, &directory)) {
+    fprintf(stderr, "PE exception directory is out of bounds\n");
+    return false;
+  }
+
+  ByteCursor cursor(&directory);
+  for (uint32_t i = 0; i < exception_size_ / kRuntimeFunctionSize; ++i) {
+    uint32_t begin, end, unwind_rva;
+    cursor >> begin >> end >> unwind_rva;
+    if (end <= begin)
+      continue;
+    // An odd unwind information address is that of another function's
+    // RUNTIME_FUNCTION, whose unwind information this one shares.
+    for (int length = 0; (unwind_rva & 1) && length < kMaxChainLength;
+         ++length) {
+      ByteBuffer shared;
+      uint32_t shared_begin, shared_end;
+      if (!GetData(unwind_rva & ~1U, kRuntimeFunctionSize, &shared))
+        break;
+      ByteCursor(&shared) >> shared_begin >> shared_end >> unwind_rva;
+    }
+    if (unwind_rva & 1)
+      continue;
+
+    Module::StackFrameEntry entry;
+    entry.address = begin;
+    entry.size = end - begin;
+    Frame frame;
+    if (ApplyUnwindInfo(unwind_rva, 0, &frame, &entry))
+      entries->push_back(entry);
+  }
+  return true;
+}
+
+bool PEUnwindReader::WriteStackCFIRecords(
+    const vector<Module::StackFrameEntry>& entries, std::ostream& stream) {
+  stream << std::hex;
+  for (size_t i = 0; i < entries.size() && stream.good(); ++i) {
+    const Module::StackFrameEntry& entry = entries[i];
+    stream << "STACK CFI INIT " << entry.address << " " << entry.size << " ";
+    WriteRules(entry.initial_rules, stream);
+    stream << "\n";
+    for (Module::RuleChangeMap::const_iterator it = entry.rule_changes.begin();
+         it != entry.rule_changes.end(); ++it) {
+      stream << "STACK CFI " << it->first << " ";
+      WriteRules(it->second, stream);
+      stream << "\n";
+    }
+  }
+  stream << std::dec;
+  return stream.good();
+}
+
+}  // namespace google_breakpad
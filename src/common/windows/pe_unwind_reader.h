@@ -0,0 +1,120 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pe_unwind_reader.h: Read the unwind tables of an x86_64 Portable
+// Executable (PE32+) image and give them as STACK CFI records.
+//
+// An x86_64 image lists its functions that aren't leaves in its exception
+// directory (the .pdata section).  Each RUNTIME_FUNCTION entry there gives
+// a function's extent and its UNWIND_INFO (in .xdata), which lists the
+// operations of the function's prolog: the registers it pushes or saves,
+// the stack it allocates and the frame pointer it sets up.  PEUnwindReader
+// replays those operations, and gives the rules recovering the caller's
+// %rip, %rsp and nonvolatile registers at each point of the prolog and in
+// the body after it.  As nothing here depends on Windows, images can be
+// read on any host.
+//
+// Windows' own unwinder recognizes epilogs by disassembling the code they
+// are in, and UNWIND_INFO doesn't describe them, so the body's rules run
+// on to the end of each function.  XMM registers saved by the prolog are
+// not recovered, as Breakpad doesn't track them.
+
+#ifndef COMMON_WINDOWS_PE_UNWIND_READER_H_
+#define COMMON_WINDOWS_PE_UNWIND_READER_H_
+
+#include <stdint.h>
+
+#include <ostream>
+#include <vector>
+
+#include "common/basictypes.h"
+#include "common/byte_cursor.h"
+#include "common/module.h"
+
+namespace google_breakpad {
+
+using std::vector;
+
+class PEUnwindReader {
+ public:
+  PEUnwindReader();
+
+  // Parse the headers of the SIZE bytes of the PE image file at CONTENTS,
+  // finding its sections and exception directory.  CONTENTS must stay
+  // valid for as long as this reader is in use.  On failure, print a
+  // message to stderr and return false.
+  bool Read(const uint8_t* contents, size_t size);
+
+  // Append an entry to ENTRIES for each function in the image's exception
+  // directory, in the directory's order, with addresses given relative to
+  // the image's base.  A function whose unwind information is malformed
+  // is left out.  If the exception directory itself is out of bounds,
+  // print a message to stderr and return false.
+  bool ReadStackFrameEntries(vector<Module::StackFrameEntry>* entries) const;
+
+  // Write ENTRIES to STREAM as STACK CFI INIT and STACK CFI records.
+  // Return false if writing fails.
+  static bool WriteStackCFIRecords(
+      const vector<Module::StackFrameEntry>& entries, std::ostream& stream);
+
+ private:
+  // A section of the image, as its header gives it.
+  struct Section {
+    uint32_t rva;
+    uint32_t size;
+    uint32_t file_offset;
+  };
+
+  // The state of a function's frame at some point of its prolog.
+  struct Frame;
+
+  // Set *DATA to the SIZE bytes of the image at RVA.  Return false if they
+  // don't all lie in one section's contents.
+  bool GetData(uint32_t rva, uint32_t size, ByteBuffer* data) const;
+
+  // Add the operations of the UNWIND_INFO at RVA to FRAME, and, if ENTRY
+  // isn't NULL, the rules in force after each of them to ENTRY's rule
+  // changes.  If ENTRY is NULL, the whole prolog is applied, as for the
+  // unwind information of the function a fragment is chained to.  Return
+  // false if the unwind information is malformed.
+  bool ApplyUnwindInfo(uint32_t rva, int depth, Frame* frame,
+                       Module::StackFrameEntry* entry) const;
+
+  const uint8_t* contents_;
+  size_t size_;
+  vector<Section> sections_;
+  uint32_t exception_rva_;
+  uint32_t exception_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(PEUnwindReader);
+};
+
+}  // namespace google_breakpad
+
+#endif  // COMMON_WINDOWS_PE_UNWIND_READER_H_
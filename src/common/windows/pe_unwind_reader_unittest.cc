@@ -0,0 +1,276 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pe_unwind_reader_unittest.cc: Unit tests for
+// google_breakpad::PEUnwindReader.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/module.h"
+#include "common/windows/pe_unwind_reader.h"
+
+using google_breakpad::Module;
+using google_breakpad::PEUnwindReader;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Read the file NAME from the Windows dump_syms test data into *CONTENTS.
+bool ReadTestFile(const string& name, vector<uint8_t>* contents) {
+  string path = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+      "/src/tools/windows/dump_syms/testdata/" + name;
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  uint8_t buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    contents->insert(contents->end(), buffer, buffer + read);
+  fclose(file);
+  return !contents->empty();
+}
+
+// Return the entry of ENTRIES starting at ADDRESS, or NULL.
+const Module::StackFrameEntry* FindEntry(
+    const vector<Module::StackFrameEntry>& entries, Module::Address address) {
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i].address == address)
+      return &entries[i];
+  }
+  return NULL;
+}
+
+// Return RULES as a STACK CFI record would give them.
+string RuleString(const Module::RuleMap& rules) {
+  string result;
+  Module::AppendRuleMap(rules, &result);
+  return result;
+}
+
+// Append VALUE to IMAGE in little-endian order, in SIZE bytes.
+void Append(vector<uint8_t>* image, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; ++i)
+    image->push_back(static_cast<uint8_t>(value >> (i * 8)));
+}
+
+// Store VALUE at OFFSET in IMAGE in little-endian order, in SIZE bytes.
+void Store(vector<uint8_t>* image, size_t offset, uint64_t value,
+           size_t size) {
+  for (size_t i = 0; i < size; ++i)
+    (*image)[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+}
+
+// Return a PE32+ image with one section, at rva 0x1000 and file offset
+// 0x200, whose contents are the exception directory PDATA followed, at
+// rva 0x1100, by XDATA.
+vector<uint8_t> MakeImage(const vector<uint8_t>& pdata,
+                          const vector<uint8_t>& xdata) {
+  vector<uint8_t> image(0x40, 0);
+  Store(&image, 0, 0x5a4d, 2);   // "MZ"
+  Store(&image, 0x3c, 0x40, 4);  // The PE header's offset.
+  Append(&image, 0x00004550, 4);  // "PE\0\0"
+  Append(&image, 0x8664, 2);      // Machine
+  Append(&image, 1, 2);           // NumberOfSections
+  Append(&image, 0, 12);
+  Append(&image, 240, 2);         // SizeOfOptionalHeader
+  Append(&image, 0, 2);
+  size_t optional_header = image.size();
+  image.resize(optional_header + 240, 0);
+  Store(&image, optional_header, 0x20b, 2);  // PE32+
+  Store(&image, optional_header + 108, 16, 4);  // NumberOfRvaAndSizes
+  Store(&image, optional_header + 112 + 3 * 8, 0x1000, 4);
+  Store(&image, optional_header + 112 + 3 * 8 + 4, pdata.size(), 4);
+  Append(&image, 0, 8);           // Name
+  Append(&image, 0x200, 4);       // VirtualSize
+  Append(&image, 0x1000, 4);      // VirtualAddress
+  Append(&image, 0x200, 4);       // SizeOfRawData
+  Append(&image, 0x200, 4);       // PointerToRawData
+  Append(&image, 0, 16);
+  image.resize(0x200, 0);
+  image.insert(image.end(), pdata.begin(), pdata.end());
+  image.resize(0x300, 0);
+  image.insert(image.end(), xdata.begin(), xdata.end());
+  image.resize(0x400, 0);
+  return image;
+}
+
+class PEUnwindReaderTest : public testing::Test {
+ public:
+  void Read(const string& name) {
+    ASSERT_TRUE(ReadTestFile(name, &contents_));
+    ASSERT_TRUE(reader_.Read(contents_.data(), contents_.size()));
+    ASSERT_TRUE(reader_.ReadStackFrameEntries(&entries_));
+  }
+
+  vector<uint8_t> contents_;
+  PEUnwindReader reader_;
+  vector<Module::StackFrameEntry> entries_;
+};
+
+TEST_F(PEUnwindReaderTest, FollowsProlog) {
+  ASSERT_NO_FATAL_FAILURE(Read("dump_syms_regtest64.exe"));
+  EXPECT_EQ(195U, entries_.size());
+
+  // push %rdi; sub $0x20,%rsp, with %rbx saved in the caller's home space
+  // for its parameters.
+  const Module::StackFrameEntry* entry = FindEntry(entries_, 0x1180);
+  ASSERT_TRUE(entry != NULL);
+  EXPECT_EQ(0x39U, entry->size);
+  EXPECT_EQ(".cfa: $rsp 8 + .ra: .cfa -8 + ^",
+            RuleString(entry->initial_rules));
+  ASSERT_EQ(2U, entry->rule_changes.size());
+  Module::RuleChangeMap::const_iterator change = entry->rule_changes.begin();
+  EXPECT_EQ(0x1186U, change->first);
+  EXPECT_EQ("$rdi: .cfa -16 + ^ .cfa: $rsp 16 +", RuleString(change->second));
+  ++change;
+  EXPECT_EQ(0x118aU, change->first);
+  EXPECT_EQ("$rbx: .cfa 0 + ^ .cfa: $rsp 48 +", RuleString(change->second));
+}
+
+TEST_F(PEUnwindReaderTest, FramePointer) {
+  ASSERT_NO_FATAL_FAILURE(Read("dump_syms_regtest64.exe"));
+
+  // Once lea 0x40(%rsp),%rbp has run, the frame is found from %rbp.
+  const Module::StackFrameEntry* entry = FindEntry(entries_, 0x5e68);
+  ASSERT_TRUE(entry != NULL);
+  Module::RuleChangeMap::const_iterator change =
+      entry->rule_changes.find(0x5e76);
+  ASSERT_TRUE(change != entry->rule_changes.end());
+  EXPECT_EQ(".cfa: $rsp 128 +", RuleString(change->second));
+  change = entry->rule_changes.find(0x5e7b);
+  ASSERT_TRUE(change != entry->rule_changes.end());
+  EXPECT_EQ(".cfa: $rbp 64 +", RuleString(change->second));
+  change = entry->rule_changes.find(0x5e87);
+  ASSERT_TRUE(change != entry->rule_changes.end());
+  EXPECT_EQ("$rdi: .cfa 16 + ^", RuleString(change->second));
+}
+
+TEST_F(PEUnwindReaderTest, ChainedFragment) {
+  ASSERT_NO_FATAL_FAILURE(Read("pe_only_symbol_test.dll"));
+  EXPECT_EQ(106U, entries_.size());
+
+  // The function at 0x1940 ends before its prolog's last instruction,
+  // which the fragment after it, chained to it, starts with.
+  const Module::StackFrameEntry* entry = FindEntry(entries_, 0x1940);
+  ASSERT_TRUE(entry != NULL);
+  ASSERT_EQ(2U, entry->rule_changes.size());
+  EXPECT_EQ("$rdi: .cfa -24 + ^ .cfa: $rsp 24 +",
+            RuleString(entry->rule_changes.rbegin()->second));
+
+  entry = FindEntry(entries_, 0x1947);
+  ASSERT_TRUE(entry != NULL);
+  EXPECT_EQ("$rbx: .cfa -16 + ^ $rdi: .cfa -24 + ^ "
+            ".cfa: $rsp 64 + .ra: .cfa -8 + ^",
+            RuleString(entry->initial_rules));
+}
+
+TEST(PEUnwindReader, MachineFrame) {
+  // An interrupt handler: push machine frame with error code, push %rbp,
+  // sub $0x1000,%rsp.
+  vector<uint8_t> pdata;
+  Append(&pdata, 0x2000, 4);
+  Append(&pdata, 0x2100, 4);
+  Append(&pdata, 0x1100, 4);
+  vector<uint8_t> xdata;
+  Append(&xdata, 0x01, 1);  // Version 1, no flags
+  Append(&xdata, 8, 1);     // SizeOfProlog
+  Append(&xdata, 4, 1);     // CountOfCodes
+  Append(&xdata, 0, 1);     // No frame register
+  Append(&xdata, 0x0108, 2);  // At 8, UWOP_ALLOC_LARGE, in 8-byte units
+  Append(&xdata, 0x1000 / 8, 2);
+  Append(&xdata, 0x5001, 2);  // At 1, UWOP_PUSH_NONVOL %rbp
+  Append(&xdata, 0x1a00, 2);  // At 0, UWOP_PUSH_MACHFRAME, error code
+  vector<uint8_t> image = MakeImage(pdata, xdata);
+
+  PEUnwindReader reader;
+  vector<Module::StackFrameEntry> entries;
+  ASSERT_TRUE(reader.Read(image.data(), image.size()));
+  ASSERT_TRUE(reader.ReadStackFrameEntries(&entries));
+  ASSERT_EQ(1U, entries.size());
+  EXPECT_EQ(0x2000U, entries[0].address);
+  EXPECT_EQ(0x100U, entries[0].size);
+  EXPECT_EQ(".cfa: $rsp 32 + ^ .ra: $rsp 8 + ^",
+            RuleString(entries[0].initial_rules));
+  ASSERT_EQ(2U, entries[0].rule_changes.size());
+  EXPECT_EQ("$rbp: $rsp 0 + ^ .cfa: $rsp 40 + ^ .ra: $rsp 16 + ^",
+            RuleString(entries[0].rule_changes[0x2001]));
+  EXPECT_EQ("$rbp: $rsp 4096 + ^ .cfa: $rsp 4136 + ^ .ra: $rsp 4112 + ^",
+            RuleString(entries[0].rule_changes[0x2008]));
+
+  std::ostringstream stream;
+  ASSERT_TRUE(PEUnwindReader::WriteStackCFIRecords(entries, stream));
+  EXPECT_EQ("STACK CFI INIT 2000 100 .cfa: $rsp 32 + ^ .ra: $rsp 8 + ^\n"
+            "STACK CFI 2001 $rbp: $rsp 0 + ^ .cfa: $rsp 40 + ^ "
+            ".ra: $rsp 16 + ^\n"
+            "STACK CFI 2008 $rbp: $rsp 4096 + ^ .cfa: $rsp 4136 + ^ "
+            ".ra: $rsp 4112 + ^\n",
+            stream.str());
+}
+
+TEST(PEUnwindReader, SkipsMalformedUnwindInfo) {
+  // The first function's unwind information has an unknown version; the
+  // second's lies outside the image.
+  vector<uint8_t> pdata;
+  Append(&pdata, 0x2000, 4);
+  Append(&pdata, 0x2010, 4);
+  Append(&pdata, 0x1100, 4);
+  Append(&pdata, 0x2010, 4);
+  Append(&pdata, 0x2020, 4);
+  Append(&pdata, 0x9000, 4);
+  vector<uint8_t> xdata;
+  Append(&xdata, 0x03, 1);
+  Append(&xdata, 0, 3);
+  vector<uint8_t> image = MakeImage(pdata, xdata);
+
+  PEUnwindReader reader;
+  vector<Module::StackFrameEntry> entries;
+  ASSERT_TRUE(reader.Read(image.data(), image.size()));
+  ASSERT_TRUE(reader.ReadStackFrameEntries(&entries));
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST(PEUnwindReader, RejectsOtherFiles) {
+  vector<uint8_t> contents;
+  ASSERT_TRUE(ReadTestFile("dump_syms_regtest.pdb", &contents));
+  PEUnwindReader reader;
+  EXPECT_FALSE(reader.Read(contents.data(), contents.size()));
+  // Cut the image off in its section table.
+  vector<uint8_t> image;
+  ASSERT_TRUE(ReadTestFile("pe_only_symbol_test.dll", &image));
+  EXPECT_FALSE(reader.Read(image.data(), 0x250));
+}
+
+}  // namespace
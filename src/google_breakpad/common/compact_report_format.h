@@ -0,0 +1,84 @@
+/* Copyright (c) 2026, Google Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following disclaimer
+ * in the documentation and/or other materials provided with the
+ * distribution.
+ *     * Neither the name of Google Inc. nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+/* compact_report_format.h: A compact crash report format.
+ *
+ * A compact report records where a thread of a process was, with far less
+ * than a minidump or even a microdump: the modules its stack runs through,
+ * a few registers, and the addresses found by unwinding it on the client.
+ * It's meant for frequent non-fatal reports, where a report is around a
+ * kilobyte and takes microseconds to write.
+ *
+ * A report is an MDCompactReportHeader, followed by module_count
+ * MDCompactReportModules, followed by frame_count uint64_t addresses.  The
+ * first address is the thread's instruction pointer and the rest are
+ * return addresses, innermost first.  Like minidumps, reports are in the
+ * byte order of the machine that wrote them. */
+
+#ifndef GOOGLE_BREAKPAD_COMMON_COMPACT_REPORT_FORMAT_H__
+#define GOOGLE_BREAKPAD_COMMON_COMPACT_REPORT_FORMAT_H__
+
+#include "google_breakpad/common/breakpad_types.h"
+
+#define MD_COMPACT_REPORT_SIGNATURE 0x52434d42 /* 'RCMB' */
+#define MD_COMPACT_REPORT_VERSION   1
+
+typedef struct {
+  uint32_t signature;  /* MD_COMPACT_REPORT_SIGNATURE */
+  uint32_t version;    /* MD_COMPACT_REPORT_VERSION */
+  uint32_t processor_architecture;  /* A MDCPUArchitecture */
+  uint32_t platform_id;             /* A MDOSPlatform */
+  uint32_t process_id;
+  uint32_t thread_id;
+  uint64_t time;  /* Seconds since the epoch */
+  uint64_t instruction_pointer;
+  uint64_t stack_pointer;
+  uint64_t frame_pointer;
+  uint32_t module_count;
+  uint32_t frame_count;
+} MDCompactReportHeader;
+
+#define MD_COMPACT_REPORT_MAX_BUILD_ID_SIZE 32
+#define MD_COMPACT_REPORT_MAX_NAME_SIZE 64
+
+typedef struct {
+  uint64_t base_address;
+  uint64_t size;
+  /* The module's build ID, such as the GNU build ID note of an ELF file,
+   * truncated to MD_COMPACT_REPORT_MAX_BUILD_ID_SIZE bytes.  Zero if it has
+   * none. */
+  uint32_t build_id_size;
+  uint8_t  build_id[MD_COMPACT_REPORT_MAX_BUILD_ID_SIZE];
+  /* The file name of the module, without its directory, NUL-terminated and
+   * truncated if need be. */
+  char     name[MD_COMPACT_REPORT_MAX_NAME_SIZE];
+  uint32_t reserved;
+} MDCompactReportModule;
+
+#endif  /* GOOGLE_BREAKPAD_COMMON_COMPACT_REPORT_FORMAT_H__ */
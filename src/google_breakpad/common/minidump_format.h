@@ -347,6 +347,8 @@ typedef enum {
   MD_LINUX_AUXV                  = 0x47670008,  /* /proc/$x/auxv      */
   MD_LINUX_MAPS                  = 0x47670009,  /* /proc/$x/maps      */
   MD_LINUX_DSO_DEBUG             = 0x4767000A,  /* MDRawDebug{32,64}  */
+  MD_LINUX_SNAPSHOT_INFO         = 0x4767000B,  /* MDRawLinuxSnapshotInfo */
+  MD_BASE_DUMP_STREAM            = 0x4767000C,  /* MDRawBaseDump      */
 
   /* Crashpad extension types. 0x4350 = "CP"
    * See Crashpad's minidump/minidump_extensions.h. */
@@ -997,6 +999,31 @@ typedef enum {
   MD_BREAKPAD_INFO_VALID_REQUESTING_THREAD_ID = 1 << 1
 } MDBreakpadInfoValidity;
 
+/* A compressed minidump, which the Linux client writes when asked to, is
+ * an MDRawCompressedHeader followed by a series of records, each an
+ * MDRawCompressedRecord and its data.  A record gives bytes to place at
+ * |rva| in the minidump; later records replace the bytes of earlier ones
+ * they overlap.  The minidump is as long as the furthest a record reaches.
+ * The header and records are in the byte order of the minidump. */
+typedef struct {
+  uint32_t signature;  /* MD_COMPRESSED_HEADER_SIGNATURE */
+  uint32_t version;    /* MD_COMPRESSED_HEADER_VERSION */
+} MDRawCompressedHeader;
+
+#define MD_COMPRESSED_HEADER_SIGNATURE 0x5a4d444d /* 'ZMDM' */
+#define MD_COMPRESSED_HEADER_VERSION   1
+
+typedef struct {
+  MDRVA    rva;
+  uint32_t data_size;        /* The size of the data, decompressed. */
+  /* The size of the LZ4 block holding the data that follows, or 0 if
+   * |data_size| bytes of data follow uncompressed. */
+  uint32_t compressed_size;
+} MDRawCompressedRecord;
+
+/* The most data one MDRawCompressedRecord holds. */
+#define MD_COMPRESSED_RECORD_MAX_DATA_SIZE 0x10000 /* 64 KiB */
+
 typedef struct {
   /* expression, function, and file are 0-terminated UTF-16 strings.  They
    * may be truncated if necessary, but should always be 0-terminated when
@@ -1058,6 +1085,37 @@ typedef struct {
   uint64_t  dynamic;
 } MDRawDebug64;
 
+/* Describes one of a series of live snapshots of a process, which are
+ * minidumps with the registers and the top of the stack of every thread.
+ * A snapshot leaves out its module list when it is the same as that of
+ * the previous snapshot; module_list_id then refers to the last snapshot
+ * of the series that has MD_LINUX_SNAPSHOT_HAS_MODULE_LIST set and the
+ * same module_list_id, which is also its base dump (see MDRawBaseDump). */
+typedef struct {
+  uint32_t  sequence;        /* 0 for the first snapshot of a series */
+  uint32_t  flags;           /* MDLinuxSnapshotInfoFlags */
+  uint64_t  module_list_id;  /* a hash of the process's mappings */
+} MDRawLinuxSnapshotInfo;
+
+typedef enum {
+  /* The snapshot has a MD_MODULE_LIST_STREAM. */
+  MD_LINUX_SNAPSHOT_HAS_MODULE_LIST = 1 << 0
+} MDLinuxSnapshotInfoFlags;
+
+/* MD_BASE_DUMP_STREAM identifies a minidump, and makes it a delta against
+ * another minidump of the same process, its base dump, if base_dump_id
+ * isn't all zeros.  Any stream that a delta lacks is taken from its base
+ * dump, which may itself be a delta.  A thread whose stack memory
+ * descriptor has a nonzero data_size but an rva of 0 has the same stack as
+ * the thread with the same ID in the base dump.  Readers find the base dump
+ * in the same directory as the delta, named after base_dump_id formatted
+ * as "%08x-%04x-%04x-%08x-%08x.dmp", with data4 read as two little-endian
+ * 32-bit values, as the Linux client names minidumps. */
+typedef struct {
+  MDGUID  dump_id;       /* identifies this minidump */
+  MDGUID  base_dump_id;  /* all zeros if this minidump isn't a delta */
+} MDRawBaseDump;
+
 /* Crashpad extension types. See Crashpad's minidump/minidump_extensions.h. */
 
 typedef struct {
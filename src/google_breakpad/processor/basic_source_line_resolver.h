@@ -52,12 +52,90 @@ using std::map;
 class BasicSourceLineResolver : public SourceLineResolverBase {
  public:
   BasicSourceLineResolver();
+
+  // Creates a resolver that splits each symbol file it loads into chunks at
+  // FUNC, PUBLIC and STACK record boundaries and parses the chunks on up to
+  // |num_load_threads| threads.  The chunks are stored into the module in
+  // file order, so the result matches loading on a single thread as long as
+  // every LINE and INLINE record directly follows its FUNC record, as it does
+  // in dump_syms output.  A value of 1 or less loads on the calling thread.
+  explicit BasicSourceLineResolver(int num_load_threads);
+
+  // Loads symbol files as above.  If |load_lines_lazily| is true, loading a
+  // module only builds its FUNC, PUBLIC and STACK indexes, and a function's
+  // LINE and INLINE records are parsed the first time an address in it is
+  // looked up, so that load time and memory scale with the functions a
+  // crash actually touches.  The records are read in place, so the symbol
+  // data has to stay alive as long as the module, and
+  // ShouldDeleteMemoryBufferAfterLoadModule() returns false.  Errors in
+  // those records are logged when they are parsed but don't make the module
+  // corrupt.
+  BasicSourceLineResolver(int num_load_threads, bool load_lines_lazily);
+
+  // Fetches the LINE and INLINE records of functions that a symbol file's
+  // address index lists, from the symbol file itself.
+  class RecordFetcher {
+   public:
+    virtual ~RecordFetcher() { }
+
+    // Places the |length| bytes at |offset| in the symbol file of the
+    // module named |module_name|, its code_file(), in |*records|.  Returns
+    // false if they can't be fetched.  May be called at any time while the
+    // module is loaded.
+    virtual bool FetchRecords(const string& module_name,
+                              uint64_t offset,
+                              uint64_t length,
+                              string* records) = 0;
+  };
+
+  // Loads symbol files lazily, as above, and also takes each function
+  // listed in an address index (see Module::Write) as if its FUNC record
+  // appeared there, fetching its LINE and INLINE records from
+  // |record_fetcher| the first time an address in it is looked up.  Symbol
+  // data made of a file's header, address index and the records outside its
+  // functions, as RangeSymbolSupplier supplies, then loads as the whole file
+  // would.  |record_fetcher| must outlive the resolver.
+  BasicSourceLineResolver(int num_load_threads,
+                          RecordFetcher* record_fetcher);
+
   virtual ~BasicSourceLineResolver() { }
 
+  // An address for SymbolizeAddresses(), as an offset from the base
+  // address of |module|.
+  struct AddressToSymbolize {
+    const CodeModule* module;
+    uint64_t offset;
+  };
+
+  // What SymbolizeAddresses() found for an address, as FillSourceLineInfo()
+  // would fill it in without inlined frames.  Names are NULL where unknown
+  // and otherwise interned: every module the resolver loads shares one copy
+  // of each name, so equal names have equal pointers and can stand for IDs.
+  // They stay valid while a module that contains them is loaded.
+  struct SymbolizedAddress {
+    SymbolizedAddress()
+        : function_name(NULL), function_offset(0), source_file_name(NULL),
+          source_line(0) { }
+    const char* function_name;
+    // The start of the function, as an offset from the module's base.
+    uint64_t function_offset;
+    const char* source_file_name;
+    int source_line;
+  };
+
+  // Symbolizes the |count| |addresses| into |results|, results[i] for
+  // addresses[i], for callers like profilers with many addresses at once.
+  // The addresses are sorted by module and offset, so each module is
+  // looked up once and its functions are visited in order, with addresses
+  // in the same function or line as the one before taking no lookup at all.
+  void SymbolizeAddresses(const AddressToSymbolize* addresses,
+                          size_t count,
+                          SymbolizedAddress* results);
+
   using SourceLineResolverBase::LoadModule;
   using SourceLineResolverBase::LoadModuleUsingMapBuffer;
   using SourceLineResolverBase::LoadModuleUsingMemoryBuffer;
-  using SourceLineResolverBase::ShouldDeleteMemoryBufferAfterLoadModule;
+  virtual bool ShouldDeleteMemoryBufferAfterLoadModule();
   using SourceLineResolverBase::UnloadModule;
   using SourceLineResolverBase::HasModule;
   using SourceLineResolverBase::IsModuleCorrupt;
@@ -68,6 +146,7 @@ class BasicSourceLineResolver : public SourceLineResolverBase {
  private:
   // friend declarations:
   friend class BasicModuleFactory;
+  friend class FastModuleWriter;
   friend class ModuleComparer;
   friend class ModuleSerializer;
   template<class> friend class SimpleSerializer;
@@ -77,6 +156,9 @@ class BasicSourceLineResolver : public SourceLineResolverBase {
   // Module implements SourceLineResolverBase::Module interface.
   class Module;
 
+  // Whether modules defer parsing their LINE and INLINE records.
+  bool load_lines_lazily_;
+
   // Disallow unwanted copy ctor and assignment operator
   BasicSourceLineResolver(const BasicSourceLineResolver&);
   void operator=(const BasicSourceLineResolver&);
@@ -170,9 +252,6 @@ class SymbolParseHelper {
                                 char** name);            // out
 
  private:
-  // Used for success checks after strtoull and strtol.
-  static bool IsValidAfterNumber(char* after_number);
-
   // Only allow static methods.
   SymbolParseHelper();
   SymbolParseHelper(const SymbolParseHelper&);
@@ -71,7 +71,9 @@ class CallStack {
   uint32_t tid() const { return tid_; }
 
  private:
-  // Stackwalker is responsible for building the frames_ vector.
+  // Stackwalker is responsible for building the frames_ vector, or
+  // CallStackCache for copying one it built before.
+  friend class CallStackCache;
   friend class Stackwalker;
 
   // Storage for pushed frames.
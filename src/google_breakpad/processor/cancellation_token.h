@@ -0,0 +1,103 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// cancellation_token.h: Lets a caller stop MinidumpProcessor::Process
+// and Stackwalker::Walk part way through, either from another thread or
+// when a deadline passes, and keep the results so far.
+//
+// A corrupt dump can make stack scanning run for minutes: each thread may
+// scan up to Stackwalker::set_max_frames_scanned() frames, and a dump may
+// have hundreds of threads.  A worker that must not stall on such a dump
+// sets a deadline on a token before processing it.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_CANCELLATION_TOKEN_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_CANCELLATION_TOKEN_H__
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace google_breakpad {
+
+class CancellationToken {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  CancellationToken() : cancelled_(false), deadline_(kNoDeadline) {}
+
+  // Cancels whatever is using the token, from any thread.
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  // Cancels whatever is using the token once |deadline| has passed.
+  void set_deadline(Clock::time_point deadline) {
+    deadline_.store(deadline.time_since_epoch().count(),
+                    std::memory_order_relaxed);
+  }
+
+  // Cancels whatever is using the token |timeout| from now.
+  void set_timeout(Clock::duration timeout) {
+    set_deadline(Clock::now() + timeout);
+  }
+
+  // Forgets any cancellation and deadline, so the token can be used again.
+  void Reset() {
+    cancelled_.store(false, std::memory_order_relaxed);
+    deadline_.store(kNoDeadline, std::memory_order_relaxed);
+  }
+
+  // Returns true once Cancel() has been called or the deadline has
+  // passed.  This reads the clock if there is a deadline, so callers in
+  // tight loops should check every so many iterations, not every one.
+  bool IsCancelled() const {
+    if (cancelled_.load(std::memory_order_relaxed))
+      return true;
+    Clock::rep deadline = deadline_.load(std::memory_order_relaxed);
+    if (deadline == kNoDeadline ||
+        Clock::now().time_since_epoch().count() < deadline) {
+      return false;
+    }
+    cancelled_.store(true, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  static const Clock::rep kNoDeadline =
+      std::numeric_limits<Clock::rep>::max();
+
+  mutable std::atomic<bool> cancelled_;
+  std::atomic<Clock::rep> deadline_;
+
+  // Disallow copy constructor and assignment operator.
+  CancellationToken(const CancellationToken&);
+  void operator=(const CancellationToken&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_CANCELLATION_TOKEN_H__
@@ -0,0 +1,77 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compact_report.h: A compact report reader.  A compact report (see
+// google_breakpad/common/compact_report_format.h) holds a thread's stack
+// as already unwound by the client, with the modules it runs through, so
+// it can be symbolized but not walked again.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_COMPACT_REPORT_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_COMPACT_REPORT_H__
+
+#include <vector>
+
+#include "common/scoped_ptr.h"
+#include "common/string_view.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/common/compact_report_format.h"
+#include "google_breakpad/processor/microdump.h"
+#include "google_breakpad/processor/system_info.h"
+
+namespace google_breakpad {
+
+class CompactReport {
+ public:
+  // contents need only remain valid for the constructor.
+  explicit CompactReport(StringView contents);
+  virtual ~CompactReport() {}
+
+  // Whether contents was a compact report this reader understands.  The
+  // accessors below are only meaningful if so.
+  bool valid() const { return valid_; }
+
+  const MDCompactReportHeader& header() const { return header_; }
+  MicrodumpModules* GetModules() { return modules_.get(); }
+  SystemInfo* GetSystemInfo() { return system_info_.get(); }
+
+  // The thread's instruction pointer followed by the return addresses of
+  // its callers, innermost first.
+  const std::vector<uint64_t>& frames() const { return frames_; }
+
+ private:
+  bool valid_;
+  MDCompactReportHeader header_;
+  scoped_ptr<MicrodumpModules> modules_;
+  scoped_ptr<SystemInfo> system_info_;
+  std::vector<uint64_t> frames_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_COMPACT_REPORT_H__
@@ -0,0 +1,80 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// The processor for compact reports (see compact_report.h), which
+// symbolizes the stack the client unwound rather than walking it.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_COMPACT_REPORT_PROCESSOR_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_COMPACT_REPORT_PROCESSOR_H__
+
+#include <vector>
+
+#include "common/string_view.h"
+#include "google_breakpad/processor/process_result.h"
+
+namespace google_breakpad {
+
+class CompactReport;
+class ProcessState;
+class StackFrameSymbolizer;
+
+class CompactReportProcessor {
+ public:
+  // Receives the result of processing the report at index in the batch
+  // passed to ProcessBatch.  process_state is only valid during the call.
+  typedef void (*BatchCallback)(size_t index,
+                                ProcessResult result,
+                                const ProcessState& process_state,
+                                void* context);
+
+  // Initializes the CompactReportProcessor with a stack frame symbolizer.
+  // Does not take ownership of frame_symbolizer, which must NOT be NULL.
+  explicit CompactReportProcessor(StackFrameSymbolizer* frame_symbolizer);
+
+  virtual ~CompactReportProcessor();
+
+  // Processes the report and fills process_state with the result.  The
+  // report's thread is given as the requesting thread, not a crashed one.
+  ProcessResult Process(CompactReport* report, ProcessState* process_state);
+
+  // Parses and processes each of reports in turn, passing the results to
+  // callback.  As with MicrodumpProcessor::ProcessBatch, the symbols
+  // loaded are shared by the whole batch.  Returns the number of reports
+  // processed successfully.
+  size_t ProcessBatch(const std::vector<StringView>& reports,
+                      BatchCallback callback,
+                      void* context);
+
+ private:
+  StackFrameSymbolizer* frame_symbolizer_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_COMPACT_REPORT_PROCESSOR_H__
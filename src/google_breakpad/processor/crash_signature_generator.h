@@ -0,0 +1,148 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_signature_generator.h: Computes a crash signature from a call
+// stack.
+//
+// A crash signature names the frames of a stack that say where a crash
+// happened, so that crashes can be grouped by it. CrashSignatureGenerator
+// follows the usual scheme: walking out from the innermost frame, frames
+// matching a skip rule (allocators, abort(), assertion handlers) are left
+// out; a frame matching a prefix rule (a function that only reports an
+// error, such as a CHECK failure handler) is put in the signature and the
+// walk goes on; the first other frame is put in the signature and ends
+// it. Inlined frames are frames like any other.
+//
+// A frame is named by its function name or, without symbols, by its
+// module's file name and offset in the module, "libfoo.so@0x1234"; rules
+// are matched against the function name, or the module's file name. A
+// rule ending in "*" matches any name starting with the rest of it;
+// otherwise a rule matches only the same name. The rules are compiled
+// into a trie when the generator is created, so matching a frame costs a
+// walk along its name whatever the number of rules.
+//
+// Generate() returns a hash of the signature, computed from the frames'
+// names without formatting them, and the signature as text only when
+// asked for it. The hash is stable: the same frames give the same hash
+// in any process on any host. A generator doesn't change once created,
+// so several threads can use one.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_CRASH_SIGNATURE_GENERATOR_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_CRASH_SIGNATURE_GENERATOR_H__
+
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class CallStack;
+class ProcessState;
+struct StackFrame;
+
+using std::vector;
+
+class CrashSignatureGenerator {
+ public:
+  // The separator between the frames of a signature's text.
+  static const char kFrameSeparator[];
+
+  // Creates a generator with |skip_rules| and |prefix_rules|, as described
+  // above, that puts at most |max_frames| frames in a signature. A name
+  // that matches rules of both kinds follows the one that matches more of
+  // it, and the prefix rule if they match as much.
+  CrashSignatureGenerator(const vector<string>& skip_rules,
+                          const vector<string>& prefix_rules,
+                          int max_frames);
+
+  // Computes the signature of |frames|, innermost first. Sets |hash| to
+  // its hash and, if |signature| is not NULL, sets |signature| to its
+  // text. Returns false if no frame is in the signature: |frames| is
+  // empty, or all its frames are skipped.
+  bool Generate(const vector<StackFrame*>& frames,
+                uint64_t* hash,
+                string* signature) const;
+
+  // Computes the signature of |stack|.
+  bool Generate(const CallStack& stack,
+                uint64_t* hash,
+                string* signature) const;
+
+  // Computes the signature of |state|'s requesting thread: the crashed
+  // thread, or the one that asked for the dump. Returns false if there
+  // is none.
+  bool Generate(const ProcessState& state,
+                uint64_t* hash,
+                string* signature) const;
+
+ private:
+  // What a rule does to the frames it matches.
+  enum Action {
+    ACTION_NONE,
+    ACTION_SKIP,
+    ACTION_PREFIX
+  };
+
+  // A node of the trie. The edges to its children are
+  // edges_[first_edge, first_edge + edge_count), sorted by label.
+  struct Node {
+    uint32_t first_edge;
+    uint32_t edge_count;
+    // The action of a rule matching the name that leads to this node
+    // exactly, and the action of a rule matching the names that start
+    // with it.
+    Action exact_action;
+    Action prefix_action;
+  };
+
+  struct Edge {
+    uint8_t label;
+    uint32_t child;
+  };
+
+  static bool EdgeLabelLess(const Edge& edge, uint8_t label);
+
+  // Adds |rule| with |action| to the trie.
+  void AddRule(const string& rule, Action action,
+               vector<vector<Edge> >* children);
+
+  // Returns the action of the rule that matches most of the |length|
+  // bytes at |name|.
+  Action Match(const char* name, size_t length) const;
+
+  vector<Node> nodes_;
+  vector<Edge> edges_;
+  int max_frames_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_CRASH_SIGNATURE_GENERATOR_H__
@@ -0,0 +1,83 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// eh_frame_stack_frame_symbolizer.h: A StackFrameSymbolizer that can
+// unwind from a module's binary where its symbol file has no STACK CFI
+// records.
+//
+// Where the resolver has no CFI rules for a frame, the symbolizer asks
+// the supplier for the module's binary (see SymbolSupplier::GetBinaryFile)
+// and reads the rules from its .eh_frame section, finding the one FDE
+// that covers the frame through the binary search table in
+// .eh_frame_hdr.  Binaries are mapped rather than read, and only the FDEs
+// of frames actually walked through are parsed, so symbol files can leave
+// their STACK CFI records out without costing the processor the memory
+// they would have taken.  Only ELF binaries with an .eh_frame_hdr are
+// understood.
+
+#ifndef GOOGLE_BREAKPAD_PROCESSOR_EH_FRAME_STACK_FRAME_SYMBOLIZER_H__
+#define GOOGLE_BREAKPAD_PROCESSOR_EH_FRAME_STACK_FRAME_SYMBOLIZER_H__
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+
+namespace google_breakpad {
+
+class EhFrameStackFrameSymbolizer : public StackFrameSymbolizer {
+ public:
+  EhFrameStackFrameSymbolizer(SymbolSupplier* supplier,
+                              SourceLineResolverInterface* resolver);
+  virtual ~EhFrameStackFrameSymbolizer();
+
+  // Returns the resolver's CFI rules for |frame| if it has any, and
+  // otherwise those of the .eh_frame of |frame|'s module's binary, if the
+  // supplier has the binary.
+  virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame);
+
+ private:
+  class Binary;
+
+  // Returns |module|'s binary, mapping it the first time it is asked for,
+  // or NULL if the supplier has none or it can't be used.
+  Binary* GetBinary(const CodeModule* module);
+
+  // Guards binaries_.
+  std::mutex binaries_mutex_;
+  // The binaries asked for so far by code file, with NULL for those not
+  // found.  They are kept across Reset(), as the resolver's symbols are.
+  std::map<string, Binary*> binaries_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // GOOGLE_BREAKPAD_PROCESSOR_EH_FRAME_STACK_FRAME_SYMBOLIZER_H__
@@ -53,11 +53,10 @@ class Exploitability {
   static Exploitability *ExploitabilityForPlatform(Minidump *dump,
                                                    ProcessState *process_state);
 
-  // The boolean parameter signals whether the exploitability engine is
-  // enabled to call out to objdump for disassembly. This is disabled by
-  // default. It is used to check the identity of the instruction that
-  // caused the program to crash. This should not be enabled if there are
-  // portability concerns.
+  // The boolean parameter signals whether the exploitability engine
+  // decodes the instruction that caused the program to crash, to check
+  // whether it wrote to memory. This is disabled by default. The name is
+  // historical: the instruction is decoded in process.
   static Exploitability *ExploitabilityForPlatform(Minidump *dump,
                                                    ProcessState *process_state,
                                                    bool enable_objdump);
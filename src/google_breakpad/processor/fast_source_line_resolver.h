@@ -57,14 +57,34 @@ using std::map;
 class FastSourceLineResolver : public SourceLineResolverBase {
  public:
   FastSourceLineResolver();
-  virtual ~FastSourceLineResolver() { }
+
+  // If |thread_safe| is true, any number of threads may look up addresses
+  // at once, and load or unload modules while they do.  Lookups only share
+  // a lock with other lookups and don't allocate shared state.  Each module
+  // is loaded once, even when several threads try to load it at the same
+  // time; all but one of them find it already loaded.  A module may be
+  // unloaded or evicted between two lookups unless it is pinned.
+  explicit FastSourceLineResolver(bool thread_safe);
+  virtual ~FastSourceLineResolver();
+
+  // Memory-maps a file of serialized symbol data, as written by sym_to_fast
+  // or ModuleSerializer, and loads it without copying or parsing.  The file
+  // stays mapped until the module is unloaded.  Returns false if the file
+  // can't be mapped or doesn't hold serialized data of the current version.
+  virtual bool LoadModule(const CodeModule* module, const string& map_file);
+
+  // If |use_huge_pages| is true, LoadModule() loads a copy of the file in
+  // huge pages, made with CopySymbolFileToHugePages(), rather than mapping
+  // it.  Off by default.
+  void set_use_huge_pages(bool use_huge_pages) {
+    use_huge_pages_ = use_huge_pages;
+  }
 
   using SourceLineResolverBase::FillSourceLineInfo;
   using SourceLineResolverBase::FindCFIFrameInfo;
   using SourceLineResolverBase::FindWindowsFrameInfo;
   using SourceLineResolverBase::HasModule;
   using SourceLineResolverBase::IsModuleCorrupt;
-  using SourceLineResolverBase::LoadModule;
   using SourceLineResolverBase::LoadModuleUsingMapBuffer;
   using SourceLineResolverBase::LoadModuleUsingMemoryBuffer;
   using SourceLineResolverBase::UnloadModule;
@@ -74,10 +94,10 @@ class FastSourceLineResolver : public SourceLineResolverBase {
   friend class ModuleComparer;
   friend class ModuleSerializer;
   friend class FastModuleFactory;
+  friend class FastModuleWriter;
 
   // Nested types that will derive from corresponding nested types defined in
   // SourceLineResolverBase.
-  struct Line;
   struct Function;
   struct Inline;
   struct InlineOrigin;
@@ -92,6 +112,8 @@ class FastSourceLineResolver : public SourceLineResolverBase {
   // virtual method.
   virtual bool ShouldDeleteMemoryBufferAfterLoadModule();
 
+  bool use_huge_pages_;
+
   // Disallow unwanted copy ctor and assignment operator
   FastSourceLineResolver(const FastSourceLineResolver&);
   void operator=(const FastSourceLineResolver&);
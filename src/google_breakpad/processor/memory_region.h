@@ -39,6 +39,8 @@
 #define GOOGLE_BREAKPAD_PROCESSOR_MEMORY_REGION_H__
 
 
+#include <stddef.h>
+
 #include "google_breakpad/common/breakpad_types.h"
 
 
@@ -68,8 +70,52 @@ class MemoryRegion {
   virtual bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const = 0;
   virtual bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const = 0;
 
+  // Direct access to the bytes of the memory region starting at address,
+  // as stored, without byte-swapping.  Returns a pointer to them and sets
+  // *span_length to the number available there, at most length, so that
+  // callers can read a range of memory without a call per value.  Returns
+  // NULL, setting *span_length to 0, if no bytes at address are available,
+  // or if the region can't provide direct access to its memory; callers
+  // should then use GetMemoryAtAddress.  The pointer remains valid for the
+  // lifetime of the region.
+  virtual const uint8_t* GetMemorySpan(uint64_t address, size_t length,
+                                       size_t* span_length) const {
+    *span_length = 0;
+    return NULL;
+  }
+
+  // Whether GetMemoryAtAddress byte-swaps the values it reads, so that
+  // they differ from the bytes GetMemorySpan gives.
+  virtual bool IsByteSwapped() const { return false; }
+
+  // Access to count consecutive values starting at address, as if by
+  // calling GetMemoryAtAddress for each in turn and stopping at the first
+  // that fails.  Returns the number of values stored in values.  Regions
+  // whose contents are contiguous in memory can override these to avoid
+  // a call per value.
+  virtual size_t GetMemoryAtAddresses(uint64_t address, uint32_t* values,
+                                      size_t count) const {
+    return GetValuesAtAddresses(address, values, count);
+  }
+  virtual size_t GetMemoryAtAddresses(uint64_t address, uint64_t* values,
+                                      size_t count) const {
+    return GetValuesAtAddresses(address, values, count);
+  }
+
   // Print a human-readable representation of the object to stdout.
   virtual void Print() const = 0;
+
+ private:
+  template<typename T>
+  size_t GetValuesAtAddresses(uint64_t address, T* values,
+                              size_t count) const {
+    size_t i = 0;
+    for (; i < count; ++i) {
+      if (!GetMemoryAtAddress(address + i * sizeof(T), &values[i]))
+        break;
+    }
+    return i;
+  }
 };
 
 
@@ -43,6 +43,7 @@
 #include <vector>
 
 #include "common/scoped_ptr.h"
+#include "common/string_view.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/dump_context.h"
 #include "google_breakpad/processor/memory_region.h"
@@ -59,6 +60,11 @@ class MicrodumpModules : public BasicCodeModules {
   // Takes over ownership of |module|.
   void Add(const CodeModule* module);
 
+  // As Add(), but leaves the modules unavailable for lookup until
+  // BuildIndex() is called, so that adding many is linear.
+  void AddUnindexed(const CodeModule* module);
+  void BuildIndex();
+
   // Enables/disables module address range shrink.
   void SetEnableModuleShrink(bool is_enabled);
 };
@@ -85,6 +91,7 @@ class MicrodumpMemoryRegion : public MemoryRegion {
   // instance of this class in a test fixture class, individual tests
   // can use this to provide the region's contents.
   void Init(uint64_t base_address, const std::vector<uint8_t>& contents);
+  void Init(uint64_t base_address, std::vector<uint8_t>&& contents);
 
   virtual uint64_t GetBase() const;
   virtual uint32_t GetSize() const;
@@ -94,6 +101,9 @@ class MicrodumpMemoryRegion : public MemoryRegion {
   virtual bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const;
   virtual bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const;
 
+  virtual const uint8_t* GetMemorySpan(uint64_t address, size_t length,
+                                       size_t* span_length) const;
+
   // Print a human-readable representation of the object to stdout.
   virtual void Print() const;
 
@@ -111,7 +121,8 @@ class MicrodumpMemoryRegion : public MemoryRegion {
 // the microdump's context, memory regions and modules.
 class Microdump {
  public:
-  explicit Microdump(const string& contents);
+  // contents need only remain valid for the constructor.
+  explicit Microdump(StringView contents);
   virtual ~Microdump() {}
 
   DumpContext* GetContext() { return context_.get(); }
@@ -34,7 +34,9 @@
 #define GOOGLE_BREAKPAD_PROCESSOR_MICRODUMP_PROCESSOR_H__
 
 #include <string>
+#include <vector>
 
+#include "common/string_view.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/process_result.h"
 
@@ -46,6 +48,13 @@ class StackFrameSymbolizer;
 
 class MicrodumpProcessor {
  public:
+  // Receives the result of processing the microdump at index in the batch
+  // passed to ProcessBatch.  process_state is only valid during the call.
+  typedef void (*BatchCallback)(size_t index,
+                                ProcessResult result,
+                                const ProcessState& process_state,
+                                void* context);
+
   // Initializes the MicrodumpProcessor with a stack frame symbolizer.
   // Does not take ownership of frame_symbolizer, which must NOT be NULL.
   explicit MicrodumpProcessor(StackFrameSymbolizer* frame_symbolizer);
@@ -55,6 +64,16 @@ class MicrodumpProcessor {
   // Processes the microdump contents and fills process_state with the result.
   google_breakpad::ProcessResult Process(Microdump* microdump,
                                          ProcessState* process_state);
+
+  // Parses and processes each of microdumps in turn, passing the results
+  // to callback.  The frame symbolizer, and so any symbols its resolver
+  // has loaded, is shared by the whole batch.  As the resolver knows
+  // modules by code file, the batch should hold a single build of each
+  // module.  Returns the number of microdumps processed successfully.
+  size_t ProcessBatch(const std::vector<StringView>& microdumps,
+                      BatchCallback callback,
+                      void* context);
+
  private:
   StackFrameSymbolizer* frame_symbolizer_;
 };
@@ -85,6 +85,7 @@
 #include <unistd.h>
 #endif
 
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <string>
@@ -107,7 +108,9 @@ using std::map;
 using std::vector;
 
 
+class BasicCodeModules;
 class Minidump;
+template<typename AddressType, typename EntryType> class AddressRangeTable;
 template<typename AddressType, typename EntryType> class RangeMap;
 
 
@@ -228,16 +231,39 @@ class MinidumpMemoryRegion : public MinidumpObject,
   // Frees the cached memory region, if cached.
   void FreeMemory();
 
+  // The unit in which a region's contents are read from a minidump that
+  // loads memory by page.
+  static const uint32_t kPageSize = 4096;
+
   // Obtains the value of memory at the pointer specified by address.
   bool GetMemoryAtAddress(uint64_t address, uint8_t*  value) const;
   bool GetMemoryAtAddress(uint64_t address, uint16_t* value) const;
   bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const;
   bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const;
 
+  // Obtains a pointer to up to length bytes of the cached memory starting
+  // at address.  See MemoryRegion::GetMemorySpan.
+  const uint8_t* GetMemorySpan(uint64_t address, size_t length,
+                               size_t* span_length) const;
+
+  // True if the minidump's byte order differs from the host's.
+  bool IsByteSwapped() const;
+
+  // Obtains count consecutive values starting at address, copying them
+  // from the cached memory at once.
+  size_t GetMemoryAtAddresses(uint64_t address, uint32_t* values,
+                              size_t count) const;
+  size_t GetMemoryAtAddresses(uint64_t address, uint64_t* values,
+                              size_t count) const;
+
   // Print a human-readable representation of the object to stdout.
   void Print() const;
   void SetPrintMode(bool hexdump, unsigned int width);
 
+  // Print, as Print does, only the bytes of the region whose addresses lie
+  // between first_address and last_address, inclusive.
+  void PrintRange(uint64_t first_address, uint64_t last_address) const;
+
  protected:
   explicit MinidumpMemoryRegion(Minidump* minidump);
 
@@ -249,10 +275,25 @@ class MinidumpMemoryRegion : public MinidumpObject,
   // location it may be found in the minidump file.
   void SetDescriptor(MDMemoryDescriptor* descriptor);
 
+  // Print the length bytes at offset within the region, which must lie
+  // within it, reading no more of the region than they need.
+  void PrintBytes(uint32_t offset, uint32_t length) const;
+
+  // Returns a pointer to the base of the memory region, like GetMemory, but
+  // only guarantees that the length bytes at offset within it are there,
+  // which spares reading the rest of the region when the minidump loads
+  // memory by page.  offset and length must lie within the region.
+  const uint8_t* GetMemoryRange(uint64_t offset, uint64_t length) const;
+
   // Implementation for GetMemoryAtAddress
   template<typename T> bool GetMemoryAtAddressInternal(uint64_t address,
                                                        T*        value) const;
 
+  // Implementation for GetMemoryAtAddresses
+  template<typename T> size_t GetMemoryAtAddressesInternal(uint64_t address,
+                                                           T* values,
+                                                           size_t count) const;
+
   // Knobs for controlling display of memory printing.
   bool hexdump_;
   unsigned int hexdump_width_;
@@ -266,6 +307,15 @@ class MinidumpMemoryRegion : public MinidumpObject,
 
   // Cached memory.
   mutable vector<uint8_t>* memory_;
+
+  // The memory in place in a memory-mapped minidump, used instead of
+  // memory_ when the minidump is mapped.
+  mutable const uint8_t* mapped_memory_;
+
+  // The memory of a region read by page, allocated whole but filled in only
+  // as pages are read, and which of its pages have been.
+  mutable uint8_t* paged_memory_;
+  mutable vector<bool> pages_read_;
 };
 
 
@@ -445,14 +495,22 @@ class MinidumpModule : public MinidumpObject,
   // MinidumpModuleList handles that directly.
   bool Read();
 
-  // Reads indirectly-referenced data, including the module name, CodeView
-  // record, and miscellaneous debugging record.  This is necessary to allow
-  // MinidumpModuleList to fully construct MinidumpModule objects without
-  // requiring seeks to read a contiguous set of MinidumpModule objects.
-  // All auxiliary data should be available when Read is called, in order to
-  // allow the CodeModule getters to be const methods.
+  // Reads indirectly-referenced data, the module name.  This is necessary
+  // to allow MinidumpModuleList to fully construct MinidumpModule objects
+  // without requiring seeks to read a contiguous set of MinidumpModule
+  // objects.  The CodeView record and miscellaneous debugging record are
+  // left to be read the first time they're needed, by HasDebugInfo.
   bool ReadAuxiliaryData();
 
+  // Returns true if debug info is available, reading the CodeView and
+  // miscellaneous debugging records the first time it is called, so that
+  // only consumers of the debug identifiers pay to read them.
+  bool HasDebugInfo() const;
+
+  // Reads the CodeView and miscellaneous debugging records for
+  // HasDebugInfo.  Returns false if either is expected but can't be read.
+  bool ReadDebugRecords();
+
   // The largest number of bytes that will be read from a minidump for a
   // CodeView record or miscellaneous debugging record, respectively.  The
   // default for each is 1024.
@@ -468,8 +526,12 @@ class MinidumpModule : public MinidumpObject,
 
   // True if debug info was read from the module.  Certain modules
   // may contain debug records in formats we don't support,
-  // so we can just set this to false to ignore them.
-  bool              has_debug_info_;
+  // so we can just set this to false to ignore them.  Only meaningful once
+  // debug_info_read_ is set.
+  mutable bool      has_debug_info_;
+
+  // True once HasDebugInfo has tried to read the debug records.
+  mutable bool      debug_info_read_;
 
   MDRawModule       module_;
 
@@ -519,6 +581,10 @@ class MinidumpModuleList : public MinidumpStream,
   virtual const MinidumpModule* GetModuleAtIndex(unsigned int index) const;
   virtual const CodeModules* Copy() const;
 
+  // Makes the copy Copy() does in |modules|, which may hold an earlier
+  // copy, reusing its storage rather than allocating another.
+  void CopyTo(BasicCodeModules* modules) const;
+
   // Returns a vector of all modules which address ranges needed to be shrunk
   // down due to address range conflicts with other modules.
   virtual vector<linked_ptr<const CodeModule> > GetShrunkRangeModules() const;
@@ -551,6 +617,10 @@ class MinidumpModuleList : public MinidumpStream,
   // Access to modules using addresses as the key.
   RangeMap<uint64_t, unsigned int>* range_map_;
 
+  // The contents of range_map_ once Read has finished building it,
+  // flattened for lookups.
+  AddressRangeTable<uint64_t, unsigned int>* range_table_;
+
   MinidumpModules* modules_;
   uint32_t module_count_;
 
@@ -585,9 +655,15 @@ class MinidumpMemoryList : public MinidumpStream {
   // the address identified by address.
   virtual MinidumpMemoryRegion* GetMemoryRegionForAddress(uint64_t address);
 
-  // Print a human-readable representation of the object to stdout.
+  // Print a human-readable representation of the object to stdout.  Each
+  // region's memory is freed once it's printed, so that printing a dump
+  // holds no more than one region's contents at a time.
   void Print();
 
+  // Print, as Print does, only the regions that hold memory between
+  // first_address and last_address, inclusive, and only that memory.
+  void PrintRange(uint64_t first_address, uint64_t last_address);
+
  private:
   friend class Minidump;
   friend class MockMinidumpMemoryList;
@@ -605,8 +681,23 @@ class MinidumpMemoryList : public MinidumpStream {
   // The default is 256.
   static uint32_t max_regions_;
 
-  // Access to memory regions using addresses as the key.
-  RangeMap<uint64_t, unsigned int>* range_map_;
+  // An entry in the index of memory regions by address: the region at
+  // index in regions_ spans base through high, inclusive.
+  struct RegionRange {
+    uint64_t base;
+    uint64_t high;
+    unsigned int index;
+  };
+
+  // Access to memory regions using addresses as the key: the regions, which
+  // don't overlap, sorted by base address.  A flat array is searched with
+  // fewer cache misses than a tree, and is built once, in Read.
+  vector<RegionRange> region_ranges_;
+
+  // The entry of region_ranges_ that the last lookup found, which is tried
+  // first, as lookups tend to come in runs within one region.  Atomic only
+  // so that lookups from several threads are safe; it's just a hint.
+  std::atomic<size_t> last_region_range_;
 
   // The list of descriptors.  This is maintained separately from the list
   // of regions, because MemoryRegion doesn't own its MemoryDescriptor, it
@@ -977,8 +1068,8 @@ class MinidumpMemoryInfo : public MinidumpObject {
 
 // MinidumpMemoryInfoList contains a list of information about
 // mapped memory regions for a process in the form of MDRawMemoryInfo.
-// It maintains a map of these structures so that it may easily provide
-// info corresponding to a specific address.
+// It maintains a sorted table of these structures so that it may provide
+// the info corresponding to a specific address with a binary search.
 class MinidumpMemoryInfoList : public MinidumpStream {
  public:
   virtual ~MinidumpMemoryInfoList();
@@ -1002,8 +1093,10 @@ class MinidumpMemoryInfoList : public MinidumpStream {
 
   bool Read(uint32_t expected_size) override;
 
-  // Access to memory info using addresses as the key.
+  // Access to memory info using addresses as the key.  The table, built
+  // from the map once the list is read, is what lookups search.
   RangeMap<uint64_t, unsigned int>* range_map_;
+  AddressRangeTable<uint64_t, unsigned int>* range_table_;
 
   MinidumpMemoryInfos* infos_;
   uint32_t info_count_;
@@ -1067,12 +1160,16 @@ class MinidumpLinuxMaps : public MinidumpObject {
 // MinidumpLinuxMapsList corresponds to the Linux-exclusive MD_LINUX_MAPS
 // stream, which contains the contents of /prod/self/maps, which contains
 // the mapped memory regions and their access permissions.
+//
+// The text is kept as read and parsed only when a mapping is first asked
+// for, when a sorted table of the mappings is also built for lookups by
+// address.  A list whose text can't be parsed has no mappings.
 class MinidumpLinuxMapsList : public MinidumpStream {
  public:
   virtual ~MinidumpLinuxMapsList();
 
   // Get number of mappings.
-  unsigned int get_maps_count() const { return valid_ ? maps_count_ : 0; }
+  unsigned int get_maps_count() const;
 
   // Get mapping at the given memory address. The caller owns the pointer.
   const MinidumpLinuxMaps* GetLinuxMapsForAddress(uint64_t address) const;
@@ -1092,15 +1189,30 @@ class MinidumpLinuxMapsList : public MinidumpStream {
   // The caller owns the pointer.
   explicit MinidumpLinuxMapsList(Minidump* minidump);
 
-  // Read and load the contents of the process mapping data.
-  // The stream should have data in the form of /proc/self/maps.
-  // This method returns whether the stream was read successfully.
+  // Read the contents of the process mapping data, which should be in the
+  // form of /proc/self/maps.  This method returns whether the stream was
+  // read successfully; the text isn't parsed until ParseMaps.
   bool Read(uint32_t expected_size) override;
 
-  // The list of individual mappings.
-  MinidumpLinuxMappings* maps_;
-  // The number of mappings.
-  uint32_t maps_count_;
+  // Parses the text read, unless that's been done, into maps_ and
+  // range_table_.  Returns false if the list is invalid or its text
+  // couldn't be parsed.
+  bool ParseMaps() const;
+
+  // Frees the mappings and forgets the text.
+  void Reset();
+
+  // The text of the stream, until it's parsed.
+  mutable string maps_text_;
+  mutable bool parsed_;
+
+  // The list of individual mappings, and the number of them.
+  mutable MinidumpLinuxMappings* maps_;
+  mutable uint32_t maps_count_;
+
+  // The mappings' indices in maps_, by address.
+  RangeMap<uint64_t, unsigned int>* range_map_;
+  AddressRangeTable<uint64_t, unsigned int>* range_table_;
 
   DISALLOW_COPY_AND_ASSIGN(MinidumpLinuxMapsList);
 };
@@ -1151,6 +1263,42 @@ class Minidump {
 
   virtual ~Minidump();
 
+  // Closes the minidump and forgets everything read from it, so that the
+  // next Read() reads the minidump file at |path| instead, as if this
+  // had been constructed with it.  Settings such as set_use_mmap() are
+  // kept, as is the storage for the stream directory, so a worker can
+  // reuse one Minidump for a series of files.
+  void Reset(const string& path);
+
+  // Memory-maps the minidump file when it's opened, rather than reading it
+  // through a stream, so that memory regions are used in place in the
+  // mapping instead of being copied out of it, whatever their size.  Must
+  // be called before Read().  Has no effect on a Minidump constructed from
+  // a stream, or if the file can't be mapped.
+  void set_use_mmap(bool use_mmap) { use_mmap_ = use_mmap; }
+
+  // Reads memory regions' contents a page at a time, as they're accessed,
+  // rather than a whole region the first time any of it is, so that a dump
+  // holding a large amount of memory can be processed reading only the
+  // pages that are used.  MinidumpMemoryRegion::GetMemory still reads a
+  // whole region.
+  void set_load_memory_by_page(bool load_memory_by_page) {
+    load_memory_by_page_ = load_memory_by_page;
+  }
+  bool load_memory_by_page() const { return load_memory_by_page_; }
+
+  // Limits the total number of bytes of memory regions' contents that will
+  // be read from the minidump, or removes the limit if memory_budget is 0,
+  // the default.  Reads that would exceed it fail, leaving the memory
+  // unavailable.  Memory used in place in a memory-mapped minidump isn't
+  // read, and doesn't count.
+  void set_memory_budget(uint64_t memory_budget) {
+    memory_budget_ = memory_budget;
+  }
+
+  // The number of bytes of memory regions' contents read so far.
+  uint64_t memory_bytes_read() const { return memory_bytes_read_; }
+
   // path may be empty if the minidump was not opened from a file
   virtual string path() const {
     return path_;
@@ -1183,6 +1331,13 @@ class Minidump {
   // Minidump object.
   virtual bool Read();
 
+  // If the minidump is a delta against a base dump (see MDRawBaseDump),
+  // returns the base dump, which Read() has opened and read from the
+  // minidump's directory, or NULL if there is none or it couldn't be read.
+  // The stream getters below fall back on the base dump for streams that
+  // the minidump lacks, and MinidumpThread::GetMemory on its stacks.
+  Minidump* GetBaseDump() { return valid_ ? base_dump_ : NULL; }
+
   // The next set of methods are stubs that call GetStream.  They exist to
   // force code generation of the templatized API within the module, and
   // to avoid exposing an ugly API (GetStream needs to accept a garbage
@@ -1225,6 +1380,16 @@ class Minidump {
   // Returns the current position of the minidump file.
   off_t Tell();
 
+  // Returns a pointer to the count bytes at offset in a memory-mapped
+  // minidump file, which stays valid as long as the Minidump object does,
+  // or NULL if the minidump isn't mapped or is too short to hold them.
+  const uint8_t* GetMappedBytes(off_t offset, size_t count) const;
+
+  // Accounts for count bytes of memory regions' contents that are about to
+  // be read.  Returns false, accounting for none, if that would exceed the
+  // budget set by set_memory_budget.
+  bool ChargeMemoryBudget(uint64_t count);
+
   // Medium-level I/O routines.
 
   // ReadString returns a string which is owned by the caller!  offset
@@ -1268,6 +1433,27 @@ class Minidump {
   // valid iff this method returns true.
   bool GetPlatform(MDOSPlatform* platform);
 
+  // What a load balancer needs to send minidumps that use the same symbols
+  // to the same processors, whose caches are then warm for them.
+  struct RoutingKey {
+    RoutingKey() : build_fingerprint(0) {}
+
+    // A hash of the main module's debug file and identifier, the same for
+    // every minidump of a build, or 0 if there are no modules.
+    uint64_t build_fingerprint;
+
+    // The largest modules, whose symbols cost the most to load, largest
+    // first, each as "debug-file/debug-identifier", or, if the module has
+    // no debug identifier, "code-file/code-identifier".
+    vector<string> heavy_modules;
+  };
+
+  // Fills in |key| from the minidump's header, directory and module list
+  // alone, without reading threads or memory, calling Read() first if it
+  // hasn't been.  Lists up to |max_heavy_modules| modules.  Returns false
+  // if the minidump or its module list can't be read.
+  bool GetRoutingKey(size_t max_heavy_modules, RoutingKey* key);
+
   // Get current hexdump display settings.
   unsigned int HexdumpMode() const { return hexdump_ ? hexdump_width_ : 0; }
 
@@ -1294,6 +1480,24 @@ class Minidump {
   // Opens the minidump file, or if already open, seeks to the beginning.
   bool Open();
 
+  // Closes the minidump file or unmaps it, if it's open.
+  void Close();
+
+  // Memory-maps the minidump file for Open().  Returns false if it can't.
+  bool MapFile();
+
+  // If the minidump file is compressed (see MDRawCompressedHeader), opens
+  // it for Open() as a stream over its decompressed contents.  Returns
+  // false if it isn't compressed or can't be decompressed.
+  bool OpenCompressed();
+
+  // Opens and reads the base dump named by the MD_BASE_DUMP_STREAM, if
+  // there is one, for Read().
+  void ReadBaseDump();
+
+  // The longest chain of base dumps that will be followed.
+  static const int kMaxBaseDumpDepth = 16;
+
   // The largest number of top-level streams that will be read from a minidump.
   // Note that streams are only read (and only consume memory) as needed,
   // when directed by the caller.  The default is 128.
@@ -1313,14 +1517,28 @@ class Minidump {
   // Access to streams using the stream type as the key.
   MinidumpStreamMap*        stream_map_;
 
-  // The pathname of the minidump file to process, set in the constructor.
-  // This may be empty if the minidump was opened directly from a stream.
-  const string              path_;
+  // The pathname of the minidump file to process, set in the constructor
+  // or by Reset().  This may be empty if the minidump was opened directly
+  // from a stream.
+  string                    path_;
 
   // The stream for all file I/O.  Used by ReadBytes and SeekSet.
   // Set based on the path in Open, or directly in the constructor.
   std::istream*             stream_;
 
+  // Whether Open() should memory-map the file, and if it did, the mapping
+  // and the current position in it, which take the place of stream_.
+  bool                      use_mmap_;
+  const uint8_t*            mapped_data_;
+  size_t                    mapped_size_;
+  off_t                     mapped_position_;
+
+  // Whether memory regions are read a page at a time, and the limit on and
+  // count of the bytes they've read.
+  bool                      load_memory_by_page_;
+  uint64_t                  memory_budget_;
+  uint64_t                  memory_bytes_read_;
+
   // swap_ is true if the minidump file should be byte-swapped.  If the
   // minidump was produced by a CPU that is other-endian than the CPU
   // processing the minidump, this will be true.  If the two CPUs are
@@ -1339,6 +1557,11 @@ class Minidump {
   bool                      hexdump_;
   unsigned int              hexdump_width_;
 
+  // The base dump of a delta minidump, owned by this object, and how many
+  // deltas refer to this minidump through their base dumps.
+  Minidump*                 base_dump_;
+  int                       base_dump_depth_;
+
   DISALLOW_COPY_AND_ASSIGN(Minidump);
 };
 
@@ -31,15 +31,24 @@
 #define GOOGLE_BREAKPAD_PROCESSOR_MINIDUMP_PROCESSOR_H__
 
 #include <assert.h>
+#include <set>
 #include <string>
+#include <vector>
 
+#include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/processor/process_result.h"
 
 namespace google_breakpad {
 
+class CallStack;
+class CallStackCache;
+class CancellationToken;
+class CodeModule;
+class DeferredStackwalks;
 class Minidump;
+class ProcessorMetrics;
 class ProcessState;
 class StackFrameSymbolizer;
 class SourceLineResolverInterface;
@@ -77,6 +86,15 @@ class MinidumpProcessor {
   // result.
   ProcessResult Process(Minidump* minidump,
                         ProcessState* process_state);
+
+  // Processes the minidump structure like Process(), but only walks the
+  // stack of the requesting thread, for when that is wanted quickly.  The
+  // other threads are placed in process_state with empty stacks, and
+  // handed to |deferred| to be walked later.  Exploitability, if enabled,
+  // is rated from the requesting thread alone.
+  ProcessResult ProcessRequestingThread(Minidump* minidump,
+                                        ProcessState* process_state,
+                                        DeferredStackwalks* deferred);
   // Populates the cpu_* fields of the |info| parameter with textual
   // representations of the CPU type that the minidump in |dump| was
   // produced on.  Returns false if this information is not available in
@@ -117,7 +135,8 @@ class MinidumpProcessor {
   // that separately before calling this.
   static bool IsErrorUnrecoverable(ProcessResult p) {
     assert(p !=  PROCESS_OK);
-    return (p != PROCESS_SYMBOL_SUPPLIER_INTERRUPTED);
+    return (p != PROCESS_SYMBOL_SUPPLIER_INTERRUPTED &&
+            p != PROCESS_CANCELLED);
   }
 
   // Returns a textual representation of an assertion included
@@ -127,7 +146,140 @@ class MinidumpProcessor {
 
   void set_enable_objdump(bool enabled) { enable_objdump_ = enabled; }
 
+  // Walks the stacks of up to |threads| of a minidump's threads at once.
+  // The default, 1, walks them one after another.  Threads are only walked
+  // concurrently if the stack frame symbolizer is thread-safe, which for
+  // the default symbolizer means a resolver that allows concurrent lookups,
+  // such as a FastSourceLineResolver in thread-safe mode.  Either way, the
+  // resulting ProcessState is the same.
+  void set_stackwalk_threads(int threads) { stackwalk_threads_ = threads; }
+
+  // Walks all of the threads' stacks, loading only the symbols unwinding
+  // needs, before symbolizing any of their frames, which are then
+  // symbolized a module at a time in order of address, and on up to
+  // set_stackwalk_threads() threads at once if the stack frame symbolizer
+  // is thread-safe, if |symbolize| is true.  This keeps each module's
+  // symbols in cache while they are looked up, which pays off for
+  // minidumps with many threads.  The default, false, symbolizes each
+  // frame as it is walked.  Either way, the resulting ProcessState is the
+  // same.
+  void set_symbolize_after_walking(bool symbolize) {
+    symbolize_after_walking_ = symbolize;
+  }
+
+  // Names the modules, by the base names of their code files, that are
+  // built with frame pointers, so that the callers of their frames are
+  // found by frame pointer before CFI (see
+  // Stackwalker::set_frame_pointer_modules()).  With symbolization after
+  // walking, these modules' symbols are then only loaded to symbolize
+  // their frames, not to walk through them, which speeds up the walk.
+  // The default is none.
+  void set_frame_pointer_modules(const std::set<string>& modules) {
+    frame_pointer_modules_ = modules;
+  }
+
+  // Fetches the symbols for all of a minidump's modules before walking any
+  // stacks, on up to |threads| threads at once if the symbol supplier is
+  // thread-safe, so that slow fetches overlap instead of stalling the walk
+  // one module after another.  This may fetch symbols for modules that no
+  // stack passes through.  The default, 0, leaves the walk to fetch symbols
+  // as it needs them.
+  void set_symbol_prefetch_threads(int threads) {
+    symbol_prefetch_threads_ = threads;
+  }
+
+  // Fetches and loads the symbols of the modules a minidump's stacks look
+  // like they pass through before walking them: those holding the
+  // threads' instruction pointers, and those any word on the threads'
+  // stacks points into, as a return address would.  Up to |threads| are
+  // fetched at once if the symbol supplier is thread-safe, and parsed at
+  // once too if the source line resolver is, so that a minidump touching
+  // many cold modules pays for parsing them about once rather than once
+  // per module.  Unlike set_symbol_prefetch_threads(), this leaves alone
+  // modules no stack refers to.  The default, 0, leaves the walk to load
+  // symbols as it needs them.
+  void set_symbol_preload_threads(int threads) {
+    symbol_preload_threads_ = threads;
+  }
+
+  // Counts and times what processing minidumps involves into |metrics|, or
+  // stops if |metrics| is NULL, the default (see processor_metrics.h).  The
+  // stack frame symbolizer is given |metrics| too.  The metrics must
+  // outlive the processor, and may be shared with other processors.
+  void set_metrics(ProcessorMetrics* metrics);
+
+  // Cuts stack walks short once |token| is cancelled, or never if |token|
+  // is NULL, the default.  Threads walked after that are left with no
+  // frames, the thread being walked keeps the frames found so far, and
+  // Process returns PROCESS_CANCELLED with the rest of the ProcessState
+  // filled in as usual, except for exploitability.  To bound the time
+  // spent on each minidump, set a deadline on the token before each
+  // Process call.  The token must outlive processing.
+  void set_cancellation_token(const CancellationToken* token) {
+    cancellation_token_ = token;
+  }
+
+  // Copies the requesting thread's stack from |call_stack_cache| when a
+  // minidump repeats the system info, modules, context and stack memory
+  // of one walked before, and adds the stacks it walks to the cache, or
+  // walks every stack if |call_stack_cache| is NULL, the default (see
+  // call_stack_cache.h).  The cache must outlive the processor, and may be
+  // shared with other processors using the same symbols.
+  void set_call_stack_cache(CallStackCache* call_stack_cache) {
+    call_stack_cache_ = call_stack_cache;
+  }
+
  private:
+  friend class DeferredStackwalks;
+
+  // A thread of the minidump being processed, ready to have its stack
+  // walked into |stack|.
+  struct ThreadWalk;
+
+  // Processes |minidump|, walking every thread's stack unless |deferred|
+  // is given, in which case only the requesting thread is walked.
+  ProcessResult ProcessInternal(Minidump* minidump,
+                                ProcessState* process_state,
+                                DeferredStackwalks* deferred);
+
+  // Walks the stacks of the |count| threads at |walks|, on up to
+  // stackwalk_threads_ threads at once.  Returns false if the symbol
+  // supplier interrupted any of the walks.
+  bool WalkThreads(ProcessState* process_state,
+                   ThreadWalk* walks,
+                   size_t count);
+
+  // Walks the stack of |walk|, adding the modules that lack symbols or have
+  // corrupt ones to |modules_without_symbols| and
+  // |modules_with_corrupt_symbols|.  Returns false if the symbol supplier
+  // interrupted the walk.  When symbolizing after walking, the walk is
+  // left for FinishWalk() once its frames are symbolized.
+  bool WalkThread(ProcessState* process_state,
+                  ThreadWalk* walk,
+                  std::vector<const CodeModule*>* modules_without_symbols,
+                  std::vector<const CodeModule*>* modules_with_corrupt_symbols);
+
+  // Caches the stack of |walk| if it is to be cached, and counts it.
+  void FinishWalk(ProcessState* process_state, const ThreadWalk& walk);
+
+  // Adds the frame pointer modules of |walk|'s frames, whose symbols the
+  // walk didn't load, to the module lists if symbolizing found their
+  // symbols missing or corrupt, as the walk would have.
+  void AddFramePointerModules(ProcessState* process_state, ThreadWalk* walk);
+
+  // Loads the symbols of the modules the stacks of the |count| threads at
+  // |walks| refer to, on up to symbol_preload_threads_ threads at once.
+  void PreloadSymbols(ProcessState* process_state,
+                      const ThreadWalk* walks,
+                      size_t count);
+
+  // Counts the thread |stack| was walked for, and its frames by trust,
+  // into metrics_ if there are any.
+  void CountFrames(const CallStack& stack);
+
+  // Returns true if the cancellation token has been cancelled.
+  bool IsCancelled() const;
+
   StackFrameSymbolizer* frame_symbolizer_;
   // Indicate whether resolver_helper_ is owned by this instance.
   bool own_frame_symbolizer_;
@@ -137,9 +289,78 @@ class MinidumpProcessor {
   // memory corruption issue.
   bool enable_exploitability_;
 
-  // This flag permits the exploitability scanner to shell out to objdump
-  // for purposes of disassembly.
+  // This flag permits the exploitability scanner to decode the crashing
+  // instruction.
   bool enable_objdump_;
+
+  // The most threads to walk stacks on at once.
+  int stackwalk_threads_;
+
+  // Whether frames are symbolized once all stacks are walked.
+  bool symbolize_after_walking_;
+
+  // The modules whose frames are walked by frame pointer first.
+  std::set<string> frame_pointer_modules_;
+
+  // The most symbol fetches to make at once before walking stacks, or 0 to
+  // fetch symbols during the walk.
+  int symbol_prefetch_threads_;
+
+  // The most symbol loads to make at once for the modules the stacks refer
+  // to before walking them, or 0 to load symbols during the walk.
+  int symbol_preload_threads_;
+
+  // Where processing is counted and timed, if anywhere.
+  ProcessorMetrics* metrics_;
+
+  // What stops stack walks early, if anything.
+  const CancellationToken* cancellation_token_;
+
+  // Where requesting threads' stacks are kept across minidumps, if
+  // anywhere.
+  CallStackCache* call_stack_cache_;
+};
+
+// The threads whose stacks MinidumpProcessor::ProcessRequestingThread left
+// unwalked, to be walked later, all at once or a few at a time, possibly on
+// another thread.  Until every thread is walked, the MinidumpProcessor and
+// the Minidump and ProcessState passed to it must stay alive, and the
+// ProcessState's threads other than the requesting thread, and its lists
+// of modules without symbols or with corrupt symbols, must not be read
+// concurrently with Walk().
+class DeferredStackwalks {
+ public:
+  DeferredStackwalks();
+  ~DeferredStackwalks();
+
+  // Forgets about any threads left to walk.
+  void Clear();
+
+  // The number of threads whose stacks are still unwalked.
+  size_t remaining() const;
+
+  // Walks the stacks of up to |count| more threads, in the order they
+  // appear in the ProcessState, on as many threads as the processor's
+  // set_stackwalk_threads() allows.  Returns PROCESS_OK,
+  // PROCESS_SYMBOL_SUPPLIER_INTERRUPTED if the symbol supplier interrupted
+  // any of the walks, or PROCESS_CANCELLED if the processor's cancellation
+  // token cut them short.
+  ProcessResult Walk(size_t count);
+
+  // Walks the stacks of all threads left.
+  ProcessResult WalkAll() { return Walk(remaining()); }
+
+ private:
+  friend class MinidumpProcessor;
+
+  MinidumpProcessor* processor_;
+  ProcessState* process_state_;
+  scoped_ptr<std::vector<MinidumpProcessor::ThreadWalk> > walks_;
+  size_t next_walk_;
+
+  // Disallow copy constructor and assignment operator.
+  DeferredStackwalks(const DeferredStackwalks&);
+  void operator=(const DeferredStackwalks&);
 };
 
 }  // namespace google_breakpad
@@ -56,9 +56,15 @@ enum ProcessResult {
   PROCESS_ERROR_DUPLICATE_REQUESTING_THREADS,  // There was more than one
                                                // requesting thread.
 
-  PROCESS_SYMBOL_SUPPLIER_INTERRUPTED          // The dump processing was
+  PROCESS_SYMBOL_SUPPLIER_INTERRUPTED,         // The dump processing was
                                                // interrupted by the
                                                // SymbolSupplier(not fatal).
+
+  PROCESS_CANCELLED                            // The processing was
+                                               // cancelled or ran past its
+                                               // deadline; the stacks hold
+                                               // the frames walked so far
+                                               // (not fatal).
 };
 
 }  // namespace google_breakpad
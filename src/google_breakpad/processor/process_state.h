@@ -49,8 +49,10 @@ namespace google_breakpad {
 
 using std::vector;
 
+class BasicCodeModules;
 class CallStack;
 class CodeModules;
+class FrameArena;
 
 enum ExploitabilityRating {
   EXPLOITABILITY_HIGH,                 // The crash likely represents
@@ -92,10 +94,17 @@ enum ExploitabilityRating {
 
 class ProcessState {
  public:
-  ProcessState() : modules_(NULL), unloaded_modules_(NULL) { Clear(); }
+  ProcessState()
+      : modules_(NULL), unloaded_modules_(NULL), module_storage_(NULL),
+        frame_arena_(NULL) {
+    Clear();
+  }
   ~ProcessState();
 
-  // Resets the ProcessState to its default values
+  // Resets the ProcessState to its default values.  The storage for its
+  // threads, frames and modules is kept for the next dump processed into
+  // it, so reusing a ProcessState for a series of similar dumps saves
+  // most of the allocation that processing each one would need.
   void Clear();
 
   // Accessors.  See the data declarations below.
@@ -129,8 +138,17 @@ class ProcessState {
   // MinidumpProcessor and MicrodumpProcessor are responsible for building
   // ProcessState objects.
   friend class MinidumpProcessor;
+  friend class CompactReportProcessor;
   friend class MicrodumpProcessor;
 
+  // Returns an empty CallStack to add to threads_, one Clear() kept if
+  // there is one.
+  CallStack* NewCallStack();
+
+  // Returns the storage Clear() keeps for modules_, creating it the first
+  // time.
+  BasicCodeModules* ModuleStorage();
+
   // The time-date stamp of the minidump (time_t format)
   uint32_t time_date_stamp_;
 
@@ -187,6 +205,10 @@ class ProcessState {
   // ProcessState.
   const CodeModules *unloaded_modules_;
 
+  // Where modules_ is copied to from a minidump's module list, kept by
+  // Clear().  modules_ is owned outright if it's anything else.
+  BasicCodeModules* module_storage_;
+
   // The modules which virtual address ranges were shrunk down due to
   // virtual address conflicts.
   vector<linked_ptr<const CodeModule> > shrunk_range_modules_;
@@ -201,6 +223,13 @@ class ProcessState {
   // engine. When the exploitability engine is not enabled this
   // defaults to EXPLOITABILITY_NOT_ANALYZED.
   ExploitabilityRating exploitability_;
+
+  // The CallStacks Clear() took out of threads_, emptied for reuse.
+  vector<CallStack*> spare_threads_;
+
+  // Where the frames of threads_ are carved out of, reset all at once by
+  // Clear() (see processor/frame_arena.h).
+  FrameArena* frame_arena_;
 };
 
 }  // namespace google_breakpad
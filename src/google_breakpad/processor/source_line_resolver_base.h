@@ -45,7 +45,9 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 
+#include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/processor/source_line_resolver_interface.h"
 
 namespace google_breakpad {
@@ -69,9 +71,112 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
                              char** symbol_data,
                              size_t* symbol_data_size);
 
+  // Maps the file with given file_name read-only into memory, for symbol
+  // data that is used in place rather than parsed.  Where mmap is not
+  // available, the file is read into a heap buffer instead.  Caller owns the
+  // mapping and should release it with UnmapSymbolFile().
+  static bool MapSymbolFile(const string& file_name,
+                            char** symbol_data,
+                            size_t* symbol_data_size);
+
+  // Maps the file with given file_name copy-on-write into memory, followed
+  // by a null terminator, for symbol data that is parsed in place like
+  // ReadSymbolFile()'s.  The file is paged in as it is parsed rather than
+  // read up front, and only the pages the parser writes to are copied.
+  // Where mmap is not available, this is ReadSymbolFile().  Caller owns the
+  // mapping and should release it with UnmapSymbolFile().
+  static bool MapSymbolFileForParsing(const string& file_name,
+                                      char** symbol_data,
+                                      size_t* symbol_data_size);
+
+  // Copies the file with given file_name into private memory that starts
+  // on a huge page boundary and asks for transparent huge pages to back it,
+  // for symbol data that is used in place like MapSymbolFile()'s.  Lookups
+  // that land all over a large file then take far fewer TLB misses than
+  // they do in a mapping of the file's 4 KB page-cache pages, at the cost
+  // of a private copy.  Where huge pages aren't available, the copy uses
+  // ordinary pages; where mmap isn't, this is MapSymbolFile().  Caller owns
+  // the copy and should release it with UnmapSymbolFile().
+  static bool CopySymbolFileToHugePages(const string& file_name,
+                                        char** symbol_data,
+                                        size_t* symbol_data_size);
+
+  // Releases a mapping made by MapSymbolFile(), MapSymbolFileForParsing(),
+  // or CopySymbolFileToHugePages().
+  static void UnmapSymbolFile(char* symbol_data, size_t symbol_data_size);
+
+  // Counters describing the module cache.  A hit or miss is counted each
+  // time HasModule() finds or doesn't find a module.
+  struct ModuleCacheStats {
+    ModuleCacheStats()
+        : hits(0), misses(0), evictions(0), resident_modules(0),
+          resident_bytes(0) {}
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t resident_modules;
+    uint64_t resident_bytes;
+  };
+
+  // Limits the modules kept loaded to |budget_bytes| of symbol data, the
+  // size of the buffer each module was loaded from.  Once a load takes the
+  // total over budget, the least recently used modules are unloaded until
+  // it fits again; the module just loaded and pinned modules are never
+  // unloaded this way.  The default budget, 0, never unloads anything.
+  void SetModuleCacheBudget(uint64_t budget_bytes);
+
+  // Keeps a loaded module from being evicted until a matching
+  // UnpinModule() call, for example while a dump that uses it is still
+  // being processed.  Pins nest.  Returns false if the module isn't loaded.
+  // UnloadModule() unloads a module whether or not it is pinned.
+  bool PinModule(const CodeModule* module);
+  void UnpinModule(const CodeModule* module);
+
+  ModuleCacheStats GetModuleCacheStats() const;
+
+  // The memory a loaded module's symbols take up, in bytes, by the kind of
+  // record they came from.  For a module used in place from serialized
+  // data, these are the bytes of that data; for a parsed module, they are
+  // an estimate of what it allocated, with the names it interned in a pool
+  // shared with other modules counted in full.  Lookup caches and search
+  // indexes built on load count toward the records they index.
+  struct SymbolFootprint {
+    SymbolFootprint()
+        : functions(0), lines(0), inlines(0), public_symbols(0),
+          windows_frame_info(0), cfi(0), strings(0) {}
+
+    uint64_t total() const {
+      return functions + lines + inlines + public_symbols +
+          windows_frame_info + cfi + strings;
+    }
+
+    // FUNC records, less their names, lines and inlines.
+    uint64_t functions;
+    uint64_t lines;
+    // INLINE and INLINE_ORIGIN records, less their names.
+    uint64_t inlines;
+    // PUBLIC records, less their names.
+    uint64_t public_symbols;
+    // STACK WIN records, with their programs.
+    uint64_t windows_frame_info;
+    // STACK CFI INIT and STACK CFI records, with their rules.
+    uint64_t cfi;
+    // FILE records, and the names of functions, inline origins and public
+    // symbols.
+    uint64_t strings;
+  };
+
+  // Sets |footprint| to what the loaded symbols of |module| take up in
+  // memory.  Returns false if the module isn't loaded.
+  bool GetModuleFootprint(const CodeModule* module,
+                          SymbolFootprint* footprint);
+
  protected:
   // Users are not allowed create SourceLineResolverBase instance directly.
-  SourceLineResolverBase(ModuleFactory* module_factory);
+  // If |thread_safe| is true, lookups may be made from any number of threads
+  // at once, concurrently with loads and unloads; see ModuleTableLock.
+  SourceLineResolverBase(ModuleFactory* module_factory,
+                         bool thread_safe = false);
   virtual ~SourceLineResolverBase();
 
   // Virtual methods inherited from SourceLineResolverInterface.
@@ -90,6 +195,28 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
       std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
   virtual WindowsFrameInfo* FindWindowsFrameInfo(const StackFrame* frame);
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame);
+  virtual bool IsThreadSafe();
+
+  // What LoadModuleFromBuffer() does with the buffer it is given.
+  enum BufferOwnership {
+    // The caller keeps the buffer, as with LoadModuleUsingMemoryBuffer().
+    BUFFER_BORROWED,
+    // The buffer came from new[] and now belongs to the resolver.
+    BUFFER_ALLOCATED,
+    // The buffer came from MapSymbolFile() and now belongs to the resolver.
+    BUFFER_MAPPED
+  };
+
+  // Loads |module| from |memory_buffer|.  A buffer that belongs to the
+  // resolver is kept for as long as the module if
+  // ShouldDeleteMemoryBufferAfterLoadModule() is false, and released before
+  // returning otherwise, including when the load fails.  In thread-safe mode,
+  // a thread that tries to load a module that another thread is already
+  // loading waits for it, then returns false as the module is loaded.
+  bool LoadModuleFromBuffer(const CodeModule* module,
+                            char* memory_buffer,
+                            size_t memory_buffer_size,
+                            BufferOwnership ownership);
 
   // Nested structs and classes.
   struct InlineOrigin;
@@ -104,6 +231,18 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
   class Module;
   class AutoFileCloser;
 
+  // Receives the loaded module VisitModule() finds.
+  class ModuleVisitor {
+   public:
+    virtual ~ModuleVisitor() { }
+    virtual void Visit(const Module* module) = 0;
+  };
+
+  // Calls |visitor| with the module loaded for |code_module|, if there is
+  // one, while holding the module table for lookups as FillSourceLineInfo()
+  // does, so that a subclass can make many lookups in it at once.
+  void VisitModule(const CodeModule* code_module, ModuleVisitor* visitor);
+
   // All of the modules that are loaded.
   typedef map<string, Module*, CompareString> ModuleMap;
   ModuleMap* modules_;
@@ -116,10 +255,42 @@ class SourceLineResolverBase : public SourceLineResolverInterface {
   typedef std::map<string, char*, CompareString> MemoryMap;
   MemoryMap* memory_buffers_;
 
+  // All of the mapped buffers, with their sizes, owned by the resolver.
+  typedef std::map<string, std::pair<char*, size_t>, CompareString>
+      MappedMemoryMap;
+  MappedMemoryMap* mapped_buffers_;
+
   // Creates a concrete module at run-time.
   ModuleFactory* module_factory_;
 
  private:
+  // Recency and size bookkeeping for loaded modules.
+  class ModuleCache;
+  ModuleCache* module_cache_;
+
+  // Guards the module table in thread-safe mode, and does nothing
+  // otherwise.  Lookups share it; loads, unloads and evictions hold it
+  // exclusively, and only while changing the table, never while parsing.
+  class ModuleTableLock;
+  ModuleTableLock* lock_;
+
+  // Returns true if a module named |code_file| is loaded.
+  bool IsLoaded(const string& code_file);
+
+  // Evicts least recently used modules, other than |keep|, until the
+  // module cache is within budget.  The table lock must be held
+  // exclusively.
+  void EvictModules(const string& keep);
+
+  // Deletes the module named |code_file| along with any buffer kept alive
+  // for it.  The table lock must be held exclusively.
+  void RemoveModule(const string& code_file);
+
+  // Releases |memory_buffer| if |ownership| says it belongs to the resolver.
+  static void ReleaseBuffer(char* memory_buffer,
+                            size_t memory_buffer_size,
+                            BufferOwnership ownership);
+
   // ModuleFactory needs to have access to protected type Module.
   friend class ModuleFactory;
 
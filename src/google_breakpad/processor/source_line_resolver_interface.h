@@ -114,6 +114,11 @@ class SourceLineResolverInterface {
   // returned CFIFrameInfo object.
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame) = 0;
 
+  // Returns true if lookups through HasModule(), IsModuleCorrupt(),
+  // FillSourceLineInfo(), FindWindowsFrameInfo() and FindCFIFrameInfo()
+  // may be made from several threads at once, concurrently with loads.
+  virtual bool IsThreadSafe() { return false; }
+
  protected:
   // SourceLineResolverInterface cannot be instantiated except by subclasses
   SourceLineResolverInterface() {}
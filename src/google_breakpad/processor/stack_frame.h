@@ -30,6 +30,8 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_STACK_FRAME_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_STACK_FRAME_H__
 
+#include <stddef.h>
+
 #include <string>
 
 #include "common/using_std_string.h"
@@ -66,6 +68,11 @@ struct StackFrame {
         trust(FRAME_TRUST_NONE){}
   virtual ~StackFrame() {}
 
+  // Place frames in the current thread's frame arena, if any; see
+  // processor/frame_arena.h.
+  static void* operator new(size_t size);
+  static void operator delete(void* pointer);
+
   // Return a string describing how this stack frame was found
   // by the stackwalker.
   string trust_description() const {
@@ -41,6 +41,8 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_STACK_FRAME_CPU_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_STACK_FRAME_CPU_H__
 
+#include <memory>
+
 #include "google_breakpad/common/minidump_format.h"
 #include "google_breakpad/processor/stack_frame.h"
 
@@ -174,6 +176,51 @@ struct StackFrameAMD64 : public StackFrame {
     CONTEXT_VALID_ALL  = -1
   };
 
+  // The registers of an MDRawContextAMD64 that context_validity covers,
+  // under the same names. A frame holds only these, rather than the whole
+  // context with its floating-point and vector state, which is over 1 KB
+  // and which no caller frame recovers.
+  struct Registers {
+    Registers& operator=(const MDRawContextAMD64& raw) {
+      rax = raw.rax;
+      rcx = raw.rcx;
+      rdx = raw.rdx;
+      rbx = raw.rbx;
+      rsp = raw.rsp;
+      rbp = raw.rbp;
+      rsi = raw.rsi;
+      rdi = raw.rdi;
+      r8 = raw.r8;
+      r9 = raw.r9;
+      r10 = raw.r10;
+      r11 = raw.r11;
+      r12 = raw.r12;
+      r13 = raw.r13;
+      r14 = raw.r14;
+      r15 = raw.r15;
+      rip = raw.rip;
+      return *this;
+    }
+
+    uint64_t rax;
+    uint64_t rcx;
+    uint64_t rdx;
+    uint64_t rbx;
+    uint64_t rsp;
+    uint64_t rbp;
+    uint64_t rsi;
+    uint64_t rdi;
+    uint64_t r8;
+    uint64_t r9;
+    uint64_t r10;
+    uint64_t r11;
+    uint64_t r12;
+    uint64_t r13;
+    uint64_t r14;
+    uint64_t r15;
+    uint64_t rip;
+  };
+
   StackFrameAMD64() : context(), context_validity(CONTEXT_VALID_NONE) {}
 
   // Overriden to return the return address as saved on the stack.
@@ -182,7 +229,11 @@ struct StackFrameAMD64 : public StackFrame {
   // Register state. This is only fully valid for the topmost frame in a
   // stack. In other frames, which registers are present depends on what
   // debugging information we had available. Refer to context_validity.
-  MDRawContextAMD64 context;
+  Registers context;
+
+  // The whole CPU context the stack was walked from, in the topmost frame
+  // only. Copies of the frame share it.
+  std::shared_ptr<const MDRawContextAMD64> raw_context;
 
   // For each register in context whose value has been recovered, we set
   // the corresponding CONTEXT_VALID_ bit in context_validity.
@@ -318,6 +369,20 @@ struct StackFrameARM64 : public StackFrame {
   static const uint64_t CONTEXT_VALID_SP   = CONTEXT_VALID_X31;
   static const uint64_t CONTEXT_VALID_PC   = CONTEXT_VALID_X32;
 
+  // The registers of an MDRawContextARM64 that context_validity covers,
+  // under the same name. A frame holds only these, rather than the whole
+  // context with its floating-point state, which no caller frame
+  // recovers.
+  struct Registers {
+    Registers& operator=(const MDRawContextARM64& raw) {
+      for (int i = 0; i < MD_CONTEXT_ARM64_GPR_COUNT; i++)
+        iregs[i] = raw.iregs[i];
+      return *this;
+    }
+
+    uint64_t iregs[MD_CONTEXT_ARM64_GPR_COUNT];
+  };
+
   StackFrameARM64() : context(),
                       context_validity(CONTEXT_VALID_NONE) {}
 
@@ -330,7 +395,11 @@ struct StackFrameARM64 : public StackFrame {
   // stack.  In other frames, the values of nonvolatile registers may be
   // present, given sufficient debugging information.  Refer to
   // context_validity.
-  MDRawContextARM64 context;
+  Registers context;
+
+  // The whole CPU context the stack was walked from, in the topmost frame
+  // only. Copies of the frame share it.
+  std::shared_ptr<const MDRawContextARM64> raw_context;
 
   // For each register in context whose value has been recovered, we set
   // the corresponding CONTEXT_VALID_ bit in context_validity.
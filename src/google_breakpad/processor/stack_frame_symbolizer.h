@@ -37,6 +37,7 @@
 
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -44,13 +45,17 @@
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/symbol_supplier.h"
 
 namespace google_breakpad {
 class CFIFrameInfo;
 class CodeModules;
-class SymbolSupplier;
+class FrameSymbolCache;
+class HotModuleSet;
+class ProcessorMetrics;
 class SourceLineResolverInterface;
 struct StackFrame;
+class SymbolLoadCache;
 struct SystemInfo;
 struct WindowsFrameInfo;
 
@@ -85,28 +90,161 @@ class StackFrameSymbolizer {
       StackFrame* stack_frame,
       std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
 
+  // Does the part of FillSourceLineInfo() a stack walk can't do without:
+  // sets |frame|'s module, and fetches and loads its symbols if they
+  // aren't loaded yet, so that FindWindowsFrameInfo() and
+  // FindCFIFrameInfo() can find its caller.  Returns what
+  // FillSourceLineInfo() would, without filling in any source line info.
+  virtual SymbolizerResult LoadSymbolsForFrame(
+      const CodeModules* modules,
+      const CodeModules* unloaded_modules,
+      const SystemInfo* system_info,
+      StackFrame* frame);
+
+  // Fetches and loads |module|'s symbols if they aren't loaded yet, as
+  // LoadSymbolsForFrame() does for a frame's module.  This is for frames
+  // whose module was found without loading its symbols.
+  virtual SymbolizerResult LoadModuleSymbols(const CodeModule* module,
+                                             const SystemInfo* system_info);
+
+  // Fills in the source line info for |frame|, whose module
+  // LoadSymbolsForFrame() has already set, from symbols already loaded.
+  // Returns kError, leaving |frame| alone, if its module has none.
+  virtual SymbolizerResult FillModuleSourceLineInfo(
+      StackFrame* frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
+
   virtual WindowsFrameInfo* FindWindowsFrameInfo(const StackFrame* frame);
 
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame);
 
+  // Fetches and loads the symbols for those of |modules| not yet loaded
+  // or known to be missing, ahead of the stack walk that would otherwise
+  // fetch them one at a time as it reaches each module.  If the supplier
+  // is thread-safe, up to |threads| fetches are made at once, so that
+  // their latencies overlap rather than add up; if the resolver is
+  // thread-safe too, the symbols are parsed concurrently as well, and
+  // otherwise loaded one module at a time.  Modules whose symbols can't be
+  // found or loaded are remembered just as FillSourceLineInfo() would
+  // remember them.  A module whose fetch is interrupted is left for the
+  // walk to ask for again.
+  virtual void PrefetchSymbols(const CodeModules* modules,
+                               const SystemInfo* system_info,
+                               int threads);
+
+  // Fetches and loads the symbols for |modules| as PrefetchSymbols() does,
+  // for callers that have narrowed a minidump's modules down to those its
+  // stacks are likely to pass through.
+  virtual void PrefetchModuleSymbols(
+      const std::vector<const CodeModule*>& modules,
+      const SystemInfo* system_info,
+      int threads);
+
   // Reset internal (locally owned) data as if the helper is re-instantiated.
   // A typical case is to call Reset() after processing an individual report
   // before start to process next one, in order to reset internal information
   // about missing symbols found so far.
-  virtual void Reset() { no_symbol_modules_.clear(); }
+  virtual void Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    no_symbol_modules_.clear();
+  }
 
   // Returns true if there is valid implementation for stack symbolization.
   virtual bool HasImplementation() { return resolver_ && supplier_; }
 
+  // Returns true if FillSourceLineInfo(), LoadSymbolsForFrame(),
+  // FillModuleSourceLineInfo(), FindWindowsFrameInfo() and
+  // FindCFIFrameInfo() may be called from several threads at once.  The
+  // symbolizer serializes its own bookkeeping and its calls into the
+  // supplier, so this holds whenever the resolver allows concurrent lookups.
+  virtual bool IsThreadSafe();
+
   SourceLineResolverInterface* resolver() { return resolver_; }
   SymbolSupplier* supplier() { return supplier_; }
 
+  // Shares symbol loads with the other symbolizers using |load_cache|, so
+  // that a module is fetched by only one of them at a time and a module
+  // found to be missing its symbols is remembered for all of them, across
+  // Reset().  The cache must outlive the symbolizer.  Without one, which is
+  // the default, the symbolizer fetches modules on its own.
+  void set_symbol_load_cache(SymbolLoadCache* load_cache) {
+    load_cache_ = load_cache;
+  }
+
+  // Answers lookups of source line info, CFI rules and Windows frame info
+  // in loaded modules from |frame_symbol_cache|, which remembers them
+  // across minidumps and may be shared with other symbolizers, or asks the
+  // resolver every time if |frame_symbol_cache| is NULL, the default (see
+  // frame_symbol_cache.h).  The cache must outlive the symbolizer.
+  void set_frame_symbol_cache(FrameSymbolCache* frame_symbol_cache) {
+    frame_symbol_cache_ = frame_symbol_cache;
+  }
+
+  // Counts each frame's lookup of its module's symbols in |hot_modules|,
+  // which may be shared with other symbolizers, or stops if |hot_modules|
+  // is NULL, the default (see hot_module_set.h).  The set must outlive the
+  // symbolizer.
+  void set_hot_module_set(HotModuleSet* hot_modules) {
+    hot_modules_ = hot_modules;
+  }
+
+  // Counts symbol fetches into |metrics|, and times them and the loads of
+  // the symbols into the resolver, or stops if |metrics| is NULL, the
+  // default.  The metrics must outlive the symbolizer.
+  void set_metrics(ProcessorMetrics* metrics) { metrics_ = metrics; }
+
  protected:
+  // Returns true if |module| is known to have missing symbols.
+  bool IsMissingSymbols(const CodeModule* module);
+
+  // Sets |frame|'s module, and makes sure |resolver_| has its symbols,
+  // returning kNoError if it does.
+  SymbolizerResult FindModuleSymbols(const CodeModules* modules,
+                                     const CodeModules* unloaded_modules,
+                                     const SystemInfo* system_info,
+                                     StackFrame* frame);
+
+  // Fetches the symbols for |module| from |supplier_| and loads them into
+  // |resolver_|, through |load_cache_| if there is one.  Must be called
+  // with mutex_ held.
+  SymbolizerResult FetchSymbols(const CodeModule* module,
+                                const SystemInfo* system_info);
+
+  // Fills in the source line info for |frame|, whose module |resolver_|
+  // has loaded, from frame_symbol_cache_ if it has it and otherwise from
+  // |resolver_|, caching what the resolver finds if |inlined_frames| was
+  // empty.
+  SymbolizerResult FillLoadedSourceLineInfo(
+      StackFrame* frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames);
+
+  // Loads the symbols |supplier_| returned for |module|, given its
+  // |symbol_result|, into |resolver_|, and frees them if the resolver
+  // allows.  Returns kError if the symbols are missing or fail to load,
+  // which the caller is to remember in no_symbol_modules_.  Must be called
+  // with mutex_ held, unless both the supplier and the resolver are
+  // thread-safe.
+  SymbolizerResult LoadSymbols(const CodeModule* module,
+                               SymbolSupplier::SymbolResult symbol_result,
+                               char* symbol_data,
+                               size_t symbol_data_size);
+
   SymbolSupplier* supplier_;
   SourceLineResolverInterface* resolver_;
   // A list of modules known to have symbols missing. This helps avoid
   // repeated lookups for the missing symbols within one minidump.
   std::set<string> no_symbol_modules_;
+  // Symbol loads shared with other symbolizers, if any.
+  SymbolLoadCache* load_cache_;
+  // Where symbol fetches and loads are counted and timed, if anywhere.
+  ProcessorMetrics* metrics_;
+  // Lookups in loaded modules shared with other symbolizers, if any.
+  FrameSymbolCache* frame_symbol_cache_;
+  // Where the modules served are counted, if anywhere.
+  HotModuleSet* hot_modules_;
+  // Guards no_symbol_modules_, and is held while a module's symbols are
+  // fetched from the supplier and loaded into the resolver.
+  std::mutex mutex_;
 };
 
 }  // namespace google_breakpad
@@ -41,12 +41,17 @@
 #ifndef GOOGLE_BREAKPAD_PROCESSOR_STACKWALKER_H__
 #define GOOGLE_BREAKPAD_PROCESSOR_STACKWALKER_H__
 
+#include <string.h>
+
+#include <algorithm>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/cancellation_token.h"
 #include "google_breakpad/processor/code_modules.h"
 #include "google_breakpad/processor/memory_region.h"
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
@@ -54,6 +59,7 @@
 namespace google_breakpad {
 
 class CallStack;
+class CFIFrameInfo;
 class DumpContext;
 class StackFrameSymbolizer;
 
@@ -77,10 +83,27 @@ class Stackwalker {
   // CodeModules passed to the StackWalker constructor (which currently
   // happens to be the lifetime of the Breakpad's ProcessingState object).
   // There is a check for duplicate modules so no duplicates are expected.
+  // If the cancellation token is cancelled during the walk, the walk stops
+  // and |stack| keeps the frames found so far; this still returns true.
   bool Walk(CallStack* stack,
             vector<const CodeModule*>* modules_without_symbols,
             vector<const CodeModule*>* modules_with_corrupt_symbols);
 
+  // Symbolizes the frames of the |count| stacks at |stacks|, which Walk()
+  // walked with symbolization deferred: all frames in the same module
+  // together, in order of address, so that lookups in each module's
+  // symbols follow one another rather than alternating with other
+  // modules'.  Each frame's inlined frames are inserted before it, as
+  // Walk() would have.  If |frame_symbolizer| is thread-safe, up to
+  // |threads| modules are symbolized at once.  The symbols of modules
+  // Walk() went through without loading (see set_frame_pointer_modules())
+  // are loaded first, for |system_info|.
+  static void SymbolizeStacks(CallStack* const* stacks,
+                              size_t count,
+                              StackFrameSymbolizer* frame_symbolizer,
+                              const SystemInfo* system_info,
+                              int threads);
+
   // Returns a new concrete subclass suitable for the CPU that a stack was
   // generated on, according to the CPU type indicated by the context
   // argument.  If no suitable concrete subclass exists, returns NULL.
@@ -103,6 +126,56 @@ class Stackwalker {
     max_frames_scanned_ = max_frames_scanned;
   }
 
+  // Stops stack scanning for the rest of a walk once this many frames in
+  // a row have been found by scanning or are otherwise untrustworthy.  On
+  // a corrupt stack, scanning goes on finding return addresses left behind
+  // by long-returned calls; a run of them without a single frame found
+  // any other way is unlikely to lead back to real frames.
+  static void set_max_consecutive_frames_scanned(uint32_t max_frames) {
+    max_consecutive_frames_scanned_ = max_frames;
+  }
+
+  // Limits the stack words each walk looks at while scanning for return
+  // addresses, over all of its frames; once they have been looked at,
+  // scanning finds nothing more.  This bounds the work of a thread's walk however
+  // its frames are spread over its stack.
+  static void set_max_words_scanned(uint64_t max_words) {
+    max_words_scanned_ = max_words;
+  }
+
+  // Stops Walk() and stack scanning once |token| is cancelled, or never if
+  // |token| is NULL, the default.  The token must outlive the walk.
+  void set_cancellation_token(const CancellationToken* token) {
+    cancellation_token_ = token;
+  }
+
+  // Has Walk() find each frame's module and load its symbols, as
+  // unwinding needs, but leave the frames' source line info and inlined
+  // frames for SymbolizeStacks() to fill in, if |defer| is true.  The
+  // default, false, symbolizes each frame as it is walked.  Walk() still
+  // reports modules without symbols or with corrupt ones, but the limit
+  // set_max_frames() places counts only the frames it walks, not their
+  // inlined frames.
+  void set_defer_symbolization(bool defer) { defer_symbolization_ = defer; }
+
+  // Names the modules, by the base names of their code files, that are
+  // built to keep a frame pointer chain, or NULL, the default, for none.
+  // Where the CPU's stackwalker supports it (AMD64 and ARM64), the callers
+  // of frames in these modules are found by following the frame pointer
+  // before CFI is tried, and by CFI only if that fails; the context frame,
+  // which may have stopped before setting up its frame pointer, still
+  // tries CFI first.  With symbolization deferred, Walk() then doesn't
+  // load these modules' symbols unless CFI turns out to be needed, and
+  // leaves them to SymbolizeStacks().  The set must outlive the walk.
+  void set_frame_pointer_modules(const set<string>* modules) {
+    frame_pointer_modules_ = modules;
+  }
+
+  // Returns true if the walk has been cancelled.
+  bool IsCancelled() const {
+    return cancellation_token_ && cancellation_token_->IsCancelled();
+  }
+
  protected:
   // system_info identifies the operating system, NULL or empty if unknown.
   // memory identifies a MemoryRegion that provides the stack memory
@@ -128,6 +201,23 @@ class Stackwalker {
   // Returns false otherwise.
   bool InstructionAddressSeemsValid(uint64_t address) const;
 
+  // Returns the module of modules_, or failing that of unloaded_modules_,
+  // that contains |address|, or NULL if none does.
+  const CodeModule* GetModuleForAddress(uint64_t address) const;
+
+  // Returns true if |frame|'s caller should be found by frame pointer
+  // before CFI is tried: |frame| isn't the context frame, and its module
+  // is one of the frame pointer modules.
+  bool PrefersFramePointer(const StackFrame* frame) const;
+
+  // Looks up the CFI for |frame|, first loading its module's symbols if
+  // Walk() went through it without doing so.
+  CFIFrameInfo* FindCFIFrameInfo(StackFrame* frame);
+
+  // Returns true if GetCallerFrame() tries frame pointers first for the
+  // frames PrefersFramePointer() picks out.
+  virtual bool SupportsFramePointerFirst() const { return false; }
+
   // Checks whether we should stop the stack trace.
   // (either we reached the end-of-stack or we detected a
   //  broken callstack invariant)
@@ -164,33 +254,103 @@ class Stackwalker {
   // When returning true, sets location_found to the address at which
   // the value was found, and ip_found to the value contained at that
   // location in memory.
+  //
+  // The stack is read a block of words at a time.  Each block is first
+  // checked against the span of addresses the modules occupy, in a loop
+  // simple enough for the compiler to vectorize, so that only the few words
+  // that may point into a module are looked up.
   template<typename InstructionType>
   bool ScanForReturnAddress(InstructionType location_start,
                             InstructionType* location_found,
                             InstructionType* ip_found,
                             int searchwords) {
-    for (InstructionType location = location_start;
-         location <= location_start + searchwords * sizeof(InstructionType);
-         location += sizeof(InstructionType)) {
-      InstructionType ip;
-      if (!memory_->GetMemoryAtAddress(location, &ip))
-        break;
+    if (!modules_ || searchwords < 0)
+      return false;
+
+    const uint64_t first = location_start;
+    const uint64_t last =
+        first + static_cast<uint64_t>(searchwords) * sizeof(InstructionType);
+    if (last < first)
+      return false;
+
+    const ModuleRanges& ranges = GetModuleRanges();
+    if (ranges.empty())
+      return false;
+    const uint64_t low = ranges.front().first;
+    const uint64_t span = ranges.back().second - low;
+
+    static const size_t kBlockWords = 64;
+    InstructionType words[kBlockWords];
+    bool candidates[kBlockWords];
+    uint64_t remaining = (last - first) / sizeof(InstructionType) + 1;
+    uint64_t location = first;
+    while (remaining > 0) {
+      if (IsCancelled())
+        return false;
+      if (words_scanned_ >= max_words_scanned_)
+        return false;
+      uint64_t budget = std::min(remaining,
+                                 max_words_scanned_ - words_scanned_);
+      size_t count = budget < kBlockWords ?
+          static_cast<size_t>(budget) : kBlockWords;
+      size_t read = memory_->GetMemoryAtAddresses(location, words, count);
 
       // The return address points to the instruction after a call. If the
-      // caller was a no return function, this might point past the end of the
-      // function. Subtract one from the instruction pointer so it points into
-      // the call instruction instead.
-      if (modules_ && modules_->GetModuleForAddress(ip  - 1) &&
-          InstructionAddressSeemsValid(ip - 1)) {
-        *ip_found = ip;
-        *location_found = location;
-        return true;
+      // caller was a no return function, this might point past the end of
+      // the function. Subtract one from the instruction pointer so it points
+      // into the call instruction instead.
+      for (size_t i = 0; i < read; ++i) {
+        candidates[i] =
+            static_cast<uint64_t>(static_cast<InstructionType>(words[i] - 1)) -
+            low < span;
+      }
+      for (size_t i = 0; i < read; ++i) {
+        if (!candidates[i])
+          continue;
+        InstructionType ip = words[i];
+        if (AddressInModuleRanges(ip - 1) &&
+            modules_->GetModuleForAddress(ip - 1) &&
+            InstructionAddressSeemsValid(ip - 1)) {
+          *ip_found = ip;
+          *location_found = static_cast<InstructionType>(
+              location + i * sizeof(InstructionType));
+          words_scanned_ += i + 1;
+          return true;
+        }
       }
+      words_scanned_ += read;
+
+      if (read < count)
+        break;
+      location += count * sizeof(InstructionType);
+      remaining -= count;
     }
     // nothing found
     return false;
   }
 
+  // Reads the value at address in memory_, as memory_->GetMemoryAtAddress
+  // does. Where memory_ gives direct access to its bytes (see
+  // MemoryRegion::GetMemorySpan), they are copied straight from a window
+  // onto them, sparing the virtual call per value that walking each frame
+  // otherwise makes.
+  template<typename T>
+  bool GetStackMemory(uint64_t address, T* value) const {
+    if (window_region_ == memory_) {
+      const uint64_t offset = address - window_base_;
+      if (offset < window_size_ && window_size_ - offset >= sizeof(T)) {
+        memcpy(value, window_ + offset, sizeof(T));
+        return true;
+      }
+    }
+    const uint8_t* bytes = MoveStackWindow(address, sizeof(T));
+    if (bytes) {
+      memcpy(value, bytes, sizeof(T));
+      return true;
+    }
+    return memory_ && memory_->GetMemoryAtAddress(address, value);
+  }
+
   // Information about the system that produced the minidump.  Subclasses
   // and the SymbolSupplier may find this information useful.
   const SystemInfo* system_info_;
@@ -213,6 +373,22 @@ class Stackwalker {
   StackFrameSymbolizer* frame_symbolizer_;
 
  private:
+  // Sorted, disjoint [start, end) address ranges covering modules_.
+  typedef vector<std::pair<uint64_t, uint64_t> > ModuleRanges;
+
+  // Returns the ranges the modules in modules_ occupy, computing them the
+  // first time they are needed.
+  const ModuleRanges& GetModuleRanges();
+
+  // Returns true if address lies within one of the ranges GetModuleRanges
+  // returned.  Every address modules_ has a module for does.
+  bool AddressInModuleRanges(uint64_t address) const;
+
+  // Moves GetStackMemory's window onto memory_ to take in the size bytes
+  // at address, and returns a pointer to them, or NULL if memory_ can't
+  // give direct access to them.
+  const uint8_t* MoveStackWindow(uint64_t address, size_t size) const;
+
   // Obtains the context frame, the innermost called procedure in a stack
   // trace.  Returns NULL on failure.  GetContextFrame allocates a new
   // StackFrame (or StackFrame subclass), ownership of which is taken by
@@ -239,6 +415,33 @@ class Stackwalker {
   virtual StackFrame* GetCallerFrame(const CallStack* stack,
                                      bool stack_scan_allowed) = 0;
 
+  // The ranges modules_ occupies, for ScanForReturnAddress, and whether
+  // they have been computed yet.
+  ModuleRanges module_ranges_;
+  bool module_ranges_computed_;
+
+  // Stops the walk when cancelled, if non-NULL.
+  const CancellationToken* cancellation_token_;
+
+  // Whether Walk() leaves the frames for SymbolizeStacks() to symbolize.
+  bool defer_symbolization_;
+
+  // The modules walked by frame pointer first, if non-NULL.
+  const set<string>* frame_pointer_modules_;
+
+  // The stack words the walk has looked at while scanning so far.
+  uint64_t words_scanned_;
+
+  // GetStackMemory's window: size bytes of window_region_ from base, in
+  // place. window_region_ is the memory_ the window was taken from, which
+  // subclasses may change, and window_direct_ is false once it is known
+  // not to give direct access to its memory.
+  mutable const MemoryRegion* window_region_;
+  mutable const uint8_t* window_;
+  mutable uint64_t window_base_;
+  mutable size_t window_size_;
+  mutable bool window_direct_;
+
   // The maximum number of frames Stackwalker will walk through.
   // This defaults to 1024 to prevent infinite loops.
   static uint32_t max_frames_;
@@ -253,6 +456,14 @@ class Stackwalker {
   // disable or limit it is helpful in cases where unwind performance is
   // important.  This defaults to 1024, the same as max_frames_.
   static uint32_t max_frames_scanned_;
+
+  // The most frames in a row that may be found by scanning or be otherwise
+  // untrustworthy before scanning stops.  This defaults to no limit.
+  static uint32_t max_consecutive_frames_scanned_;
+
+  // The most stack words a walk may look at while scanning.  This defaults
+  // to no limit.
+  static uint64_t max_words_scanned_;
 };
 
 }  // namespace google_breakpad
@@ -92,6 +92,24 @@ class SymbolSupplier {
 
   // Frees the data buffer allocated for the module in GetCStringSymbolData.
   virtual void FreeSymbolData(const CodeModule* module) = 0;
+
+  // Retrieves the binary the given CodeModule was loaded from, placing its
+  // path in binary_file if successful, so that the processor can read
+  // what the symbol file leaves out, such as the unwind tables of an ELF
+  // file's .eh_frame.  system_info may be NULL.  Suppliers that don't
+  // keep binaries needn't override this, which finds none.
+  virtual SymbolResult GetBinaryFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* binary_file) {
+    return NOT_FOUND;
+  }
+
+  // Returns true if GetCStringSymbolData() and FreeSymbolData() may be
+  // called for different modules from several threads at once.  A supplier
+  // that fetches symbols from slow storage benefits from allowing it, as
+  // StackFrameSymbolizer::PrefetchSymbols() can then fetch a minidump's
+  // symbols in parallel.
+  virtual bool IsThreadSafe() { return false; }
 };
 
 }  // namespace google_breakpad
@@ -63,6 +63,9 @@ class AddressMap {
   bool Retrieve(const AddressType& address,
                 EntryType* entry, AddressType* entry_address) const;
 
+  // Returns the number of entries stored in the map.
+  int GetCount() const { return static_cast<int>(map_.size()); }
+
   // Empties the address map, restoring it to the same state as when it was
   // initially created.
   void Clear();
@@ -0,0 +1,152 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// address_range_table-inl.h: Flat address range table implementation.
+//
+// See address_range_table.h for documentation.
+
+#ifndef PROCESSOR_ADDRESS_RANGE_TABLE_INL_H__
+#define PROCESSOR_ADDRESS_RANGE_TABLE_INL_H__
+
+#include <assert.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "processor/address_range_table.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+AddressRangeTable<AddressType, EntryType>::AddressRangeTable()
+    : highs_(), ranges_(), id_(0) {
+}
+
+
+template<typename AddressType, typename EntryType>
+void AddressRangeTable<AddressType, EntryType>::Build(
+    const RangeMap<AddressType, EntryType>& range_map) {
+  static std::atomic<uint64_t> next_id(1);
+
+  Clear();
+  highs_.reserve(range_map.map_.size());
+  ranges_.reserve(range_map.map_.size());
+  for (typename RangeMap<AddressType, EntryType>::MapConstIterator iterator =
+           range_map.map_.begin();
+       iterator != range_map.map_.end(); ++iterator) {
+    highs_.push_back(iterator->first);
+    ranges_.push_back(Range(iterator->second.base(), iterator->second.entry()));
+  }
+  id_ = next_id++;
+}
+
+
+template<typename AddressType, typename EntryType>
+bool AddressRangeTable<AddressType, EntryType>::RetrieveRange(
+    const AddressType& address, EntryType* entry, AddressType* entry_base,
+    AddressType* entry_size) const {
+  BPLOG_IF(ERROR, !entry) << "AddressRangeTable::RetrieveRange requires "
+                             "|entry|";
+  assert(entry);
+
+  // The most recently found ranges come first.  Because no two ranges in a
+  // table overlap, an entry left over from another table can't produce a
+  // wrong answer, only a wasted check, as Contains validates every index.
+  static thread_local CacheEntry cache[kCacheSize];
+
+  for (int cache_index = 0; cache_index < kCacheSize; ++cache_index) {
+    if (cache[cache_index].table_id == id_ &&
+        Contains(cache[cache_index].index, address)) {
+      CacheEntry hit = cache[cache_index];
+      std::copy_backward(cache, cache + cache_index, cache + cache_index + 1);
+      cache[0] = hit;
+      GetRange(hit.index, entry, entry_base, entry_size);
+      return true;
+    }
+  }
+
+  // The only range that can encompass address is the first one whose high
+  // address is at or above it.
+  typename std::vector<AddressType>::const_iterator high =
+      std::lower_bound(highs_.begin(), highs_.end(), address);
+  if (high == highs_.end())
+    return false;
+  size_t index = high - highs_.begin();
+  if (address < ranges_[index].base)
+    return false;
+
+  std::copy_backward(cache, cache + kCacheSize - 1, cache + kCacheSize);
+  cache[0].table_id = id_;
+  cache[0].index = index;
+  GetRange(index, entry, entry_base, entry_size);
+  return true;
+}
+
+
+template<typename AddressType, typename EntryType>
+bool AddressRangeTable<AddressType, EntryType>::RetrieveRangeAtIndex(
+    int index, EntryType* entry, AddressType* entry_base,
+    AddressType* entry_size) const {
+  BPLOG_IF(ERROR, !entry) << "AddressRangeTable::RetrieveRangeAtIndex "
+                             "requires |entry|";
+  assert(entry);
+
+  if (index < 0 || index >= GetCount()) {
+    BPLOG(ERROR) << "Index out of range: " << index << "/" << GetCount();
+    return false;
+  }
+
+  GetRange(index, entry, entry_base, entry_size);
+  return true;
+}
+
+
+template<typename AddressType, typename EntryType>
+void AddressRangeTable<AddressType, EntryType>::Clear() {
+  highs_.clear();
+  ranges_.clear();
+  id_ = 0;
+}
+
+
+template<typename AddressType, typename EntryType>
+void AddressRangeTable<AddressType, EntryType>::GetRange(
+    size_t index, EntryType* entry, AddressType* entry_base,
+    AddressType* entry_size) const {
+  *entry = ranges_[index].entry;
+  if (entry_base)
+    *entry_base = ranges_[index].base;
+  if (entry_size)
+    *entry_size = highs_[index] - ranges_[index].base + 1;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_ADDRESS_RANGE_TABLE_INL_H__
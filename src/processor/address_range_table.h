@@ -0,0 +1,129 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// address_range_table.h: A flat table of address ranges.
+//
+// AddressRangeTable holds the ranges stored in a RangeMap in contiguous,
+// sorted arrays, for lookups that are faster than walking the RangeMap's
+// tree.  It's meant for a set of ranges that are built once and then looked
+// up many times, such as those of a process's code modules, which are
+// consulted for every stack frame and every scanned stack word.
+//
+// The high addresses, which are what a lookup searches, are kept apart from
+// the rest of each range so that a binary search touches as few cache lines
+// as possible.  In front of the search, each thread keeps a few of the
+// ranges it most recently found, since consecutive lookups tend to land in
+// the same handful of modules.
+
+#ifndef PROCESSOR_ADDRESS_RANGE_TABLE_H__
+#define PROCESSOR_ADDRESS_RANGE_TABLE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "processor/range_map.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+class AddressRangeTable {
+ public:
+  AddressRangeTable();
+
+  // Replaces the contents of the table with the ranges stored in range_map.
+  // The table doesn't follow later changes to range_map; call Build again
+  // after making them.
+  void Build(const RangeMap<AddressType, EntryType>& range_map);
+
+  // Locates the range encompassing the supplied address, as
+  // RangeMap::RetrieveRange does.  Returns false if there is no such range.
+  // entry_base and entry_size, if non-NULL, are set to the base and size of
+  // the range.  Lookups from several threads at once are safe.
+  bool RetrieveRange(const AddressType& address, EntryType* entry,
+                     AddressType* entry_base, AddressType* entry_size) const;
+
+  // Treating all ranges as a list ordered by the address spaces that they
+  // occupy, locates the range at the index specified by index, as
+  // RangeMap::RetrieveRangeAtIndex does, but in constant time.
+  bool RetrieveRangeAtIndex(int index, EntryType* entry,
+                            AddressType* entry_base,
+                            AddressType* entry_size) const;
+
+  // Returns the number of ranges stored in the table.
+  int GetCount() const { return static_cast<int>(highs_.size()); }
+
+  // Empties the table.
+  void Clear();
+
+ private:
+  struct Range {
+    Range(const AddressType& base, const EntryType& entry)
+        : base(base), entry(entry) {}
+
+    AddressType base;
+    EntryType entry;
+  };
+
+  // The number of recently found ranges that each thread remembers.
+  static const int kCacheSize = 4;
+
+  // A recently found range: the index of the range in the table identified
+  // by table_id.
+  struct CacheEntry {
+    uint64_t table_id;
+    size_t index;
+  };
+
+  // Returns true if the range at index encompasses address.
+  bool Contains(size_t index, const AddressType& address) const {
+    return index < highs_.size() && ranges_[index].base <= address &&
+           address <= highs_[index];
+  }
+
+  // Copies the range at index into whichever of entry, entry_base and
+  // entry_size are non-NULL.
+  void GetRange(size_t index, EntryType* entry, AddressType* entry_base,
+                AddressType* entry_size) const;
+
+  // The high address of each range, in increasing order.
+  std::vector<AddressType> highs_;
+
+  // The rest of each range, in the same order as highs_.
+  std::vector<Range> ranges_;
+
+  // Distinguishes this table's entries, as last built, in the per-thread
+  // caches from those of other tables.  0 is never used.
+  uint64_t id_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_ADDRESS_RANGE_TABLE_H__
@@ -0,0 +1,202 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// address_range_table_unittest.cc: Unit tests for AddressRangeTable.
+
+#include <stdint.h>
+
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "processor/address_range_table-inl.h"
+#include "processor/range_map-inl.h"
+
+namespace {
+
+using google_breakpad::AddressRangeTable;
+using google_breakpad::MergeRangeStrategy;
+using google_breakpad::RangeMap;
+
+typedef RangeMap<uint64_t, int> TestMap;
+typedef AddressRangeTable<uint64_t, int> TestTable;
+
+// Checks that table and map agree about every address from 0 through last.
+void ExpectSameLookups(const TestTable& table, const TestMap& map,
+                       uint64_t last) {
+  for (uint64_t address = 0; address <= last; ++address) {
+    int map_entry = -1, table_entry = -1;
+    uint64_t map_base = 0, map_size = 0, table_base = 0, table_size = 0;
+    bool map_found = map.RetrieveRange(address, &map_entry, &map_base,
+                                       NULL /* delta */, &map_size);
+    bool table_found = table.RetrieveRange(address, &table_entry, &table_base,
+                                           &table_size);
+    ASSERT_EQ(map_found, table_found) << address;
+    if (map_found) {
+      EXPECT_EQ(map_entry, table_entry) << address;
+      EXPECT_EQ(map_base, table_base) << address;
+      EXPECT_EQ(map_size, table_size) << address;
+    }
+  }
+}
+
+TEST(AddressRangeTable, Empty) {
+  TestTable table;
+  int entry;
+  EXPECT_EQ(0, table.GetCount());
+  EXPECT_FALSE(table.RetrieveRange(0, &entry, NULL, NULL));
+  EXPECT_FALSE(table.RetrieveRangeAtIndex(0, &entry, NULL, NULL));
+
+  TestMap map;
+  table.Build(map);
+  EXPECT_EQ(0, table.GetCount());
+  EXPECT_FALSE(table.RetrieveRange(0, &entry, NULL, NULL));
+}
+
+TEST(AddressRangeTable, MatchesRangeMap) {
+  TestMap map;
+  ASSERT_TRUE(map.StoreRange(20, 10, 1));
+  ASSERT_TRUE(map.StoreRange(5, 5, 2));
+  ASSERT_TRUE(map.StoreRange(30, 1, 3));
+  ASSERT_TRUE(map.StoreRange(40, 20, 4));
+
+  TestTable table;
+  table.Build(map);
+  EXPECT_EQ(4, table.GetCount());
+  ExpectSameLookups(table, map, 70);
+  // Again, in reverse, so that the per-thread cache is exercised in a
+  // different order.
+  for (uint64_t address = 70; address-- > 0;) {
+    int map_entry = -1, table_entry = -1;
+    bool map_found = map.RetrieveRange(address, &map_entry, NULL, NULL, NULL);
+    EXPECT_EQ(map_found,
+              table.RetrieveRange(address, &table_entry, NULL, NULL));
+    EXPECT_EQ(map_entry, table_entry) << address;
+  }
+
+  for (int index = 0; index < table.GetCount(); ++index) {
+    int map_entry, table_entry;
+    uint64_t map_base, map_size, table_base, table_size;
+    ASSERT_TRUE(map.RetrieveRangeAtIndex(index, &map_entry, &map_base,
+                                         NULL /* delta */, &map_size));
+    ASSERT_TRUE(table.RetrieveRangeAtIndex(index, &table_entry, &table_base,
+                                           &table_size));
+    EXPECT_EQ(map_entry, table_entry);
+    EXPECT_EQ(map_base, table_base);
+    EXPECT_EQ(map_size, table_size);
+  }
+  int entry;
+  EXPECT_FALSE(table.RetrieveRangeAtIndex(4, &entry, NULL, NULL));
+  EXPECT_FALSE(table.RetrieveRangeAtIndex(-1, &entry, NULL, NULL));
+}
+
+TEST(AddressRangeTable, TruncatedRanges) {
+  TestMap map;
+  map.SetMergeStrategy(MergeRangeStrategy::kTruncateLower);
+  ASSERT_TRUE(map.StoreRange(10, 20, 1));
+  ASSERT_TRUE(map.StoreRange(20, 20, 2));
+
+  TestTable table;
+  table.Build(map);
+  ExpectSameLookups(table, map, 50);
+}
+
+TEST(AddressRangeTable, RangeAtTopOfAddressSpace) {
+  TestMap map;
+  ASSERT_TRUE(map.StoreRange(UINT64_MAX - 9, 10, 1));
+
+  TestTable table;
+  table.Build(map);
+  int entry = 0;
+  EXPECT_TRUE(table.RetrieveRange(UINT64_MAX, &entry, NULL, NULL));
+  EXPECT_EQ(1, entry);
+  EXPECT_FALSE(table.RetrieveRange(UINT64_MAX - 10, &entry, NULL, NULL));
+}
+
+// Each table must answer from its own ranges, even when lookups in several
+// tables share a thread's cache.
+TEST(AddressRangeTable, SeveralTables) {
+  TestMap map1, map2;
+  ASSERT_TRUE(map1.StoreRange(0, 100, 1));
+  ASSERT_TRUE(map2.StoreRange(50, 10, 2));
+  ASSERT_TRUE(map2.StoreRange(60, 10, 3));
+
+  TestTable table1, table2;
+  table1.Build(map1);
+  table2.Build(map2);
+  for (int pass = 0; pass < 2; ++pass) {
+    ExpectSameLookups(table1, map1, 110);
+    ExpectSameLookups(table2, map2, 110);
+  }
+
+  // Rebuilding a table from a changed map gives the new ranges.
+  ASSERT_TRUE(map1.StoreRange(200, 10, 4));
+  table1.Build(map1);
+  ExpectSameLookups(table1, map1, 220);
+
+  table1.Clear();
+  int entry;
+  EXPECT_EQ(0, table1.GetCount());
+  EXPECT_FALSE(table1.RetrieveRange(50, &entry, NULL, NULL));
+}
+
+TEST(AddressRangeTable, ConcurrentLookups) {
+  TestMap map;
+  for (int index = 0; index < 64; ++index)
+    ASSERT_TRUE(map.StoreRange(index * 100, 50, index));
+
+  TestTable table;
+  table.Build(map);
+  std::vector<std::thread> threads;
+  std::vector<int> failures(4);
+  for (int thread_index = 0; thread_index < 4; ++thread_index) {
+    threads.push_back(std::thread([&table, &failures, thread_index]() {
+      for (uint64_t address = thread_index; address < 6400; address += 3) {
+        int entry = -1;
+        bool found = table.RetrieveRange(address, &entry, NULL, NULL);
+        bool expected = address % 100 < 50;
+        if (found != expected ||
+            (found && entry != static_cast<int>(address / 100))) {
+          ++failures[thread_index];
+        }
+      }
+    }));
+  }
+  for (size_t thread_index = 0; thread_index < threads.size(); ++thread_index)
+    threads[thread_index].join();
+  for (size_t thread_index = 0; thread_index < failures.size(); ++thread_index)
+    EXPECT_EQ(0, failures[thread_index]);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
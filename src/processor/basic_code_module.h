@@ -41,10 +41,12 @@
 #ifndef PROCESSOR_BASIC_CODE_MODULE_H__
 #define PROCESSOR_BASIC_CODE_MODULE_H__
 
+#include <memory>
 #include <string>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/code_module.h"
+#include "processor/code_module_string_table.h"
 
 namespace google_breakpad {
 
@@ -58,12 +60,26 @@ class BasicCodeModule : public CodeModule {
       : base_address_(that->base_address()),
         size_(that->size()),
         shrink_down_delta_(that->shrink_down_delta()),
-        code_file_(that->code_file()),
-        code_identifier_(that->code_identifier()),
-        debug_file_(that->debug_file()),
-        debug_identifier_(that->debug_identifier()),
-        version_(that->version()),
-        is_unloaded_(that->is_unloaded()) {}
+        strings_(new CodeModuleStringTable()),
+        is_unloaded_(that->is_unloaded()) {
+    AddStrings(that->code_file(), that->code_identifier(),
+               that->debug_file(), that->debug_identifier(),
+               that->version());
+  }
+
+  // As above, but stores the strings in |strings|, which may be shared with
+  // other modules, such as those of the same BasicCodeModules.
+  BasicCodeModule(const CodeModule *that,
+                  const std::shared_ptr<CodeModuleStringTable>& strings)
+      : base_address_(that->base_address()),
+        size_(that->size()),
+        shrink_down_delta_(that->shrink_down_delta()),
+        strings_(strings),
+        is_unloaded_(that->is_unloaded()) {
+    AddStrings(that->code_file(), that->code_identifier(),
+               that->debug_file(), that->debug_identifier(),
+               that->version());
+  }
 
   BasicCodeModule(uint64_t base_address, uint64_t size,
                   const string& code_file,
@@ -75,13 +91,11 @@ class BasicCodeModule : public CodeModule {
       : base_address_(base_address),
         size_(size),
         shrink_down_delta_(0),
-        code_file_(code_file),
-        code_identifier_(code_identifier),
-        debug_file_(debug_file),
-        debug_identifier_(debug_identifier),
-        version_(version),
-        is_unloaded_(is_unloaded)
-    {}
+        strings_(new CodeModuleStringTable()),
+        is_unloaded_(is_unloaded) {
+    AddStrings(code_file, code_identifier, debug_file, debug_identifier,
+               version);
+  }
   virtual ~BasicCodeModule() {}
 
   // See code_module.h for descriptions of these methods and the associated
@@ -92,27 +106,61 @@ class BasicCodeModule : public CodeModule {
   virtual void SetShrinkDownDelta(uint64_t shrink_down_delta) {
     shrink_down_delta_ = shrink_down_delta;
   }
-  virtual string code_file() const { return code_file_; }
-  virtual string code_identifier() const { return code_identifier_; }
-  virtual string debug_file() const { return debug_file_; }
-  virtual string debug_identifier() const { return debug_identifier_; }
-  virtual string version() const { return version_; }
-  virtual CodeModule* Copy() const { return new BasicCodeModule(this); }
+  virtual string code_file() const { return strings_->Get(code_file_); }
+  virtual string code_identifier() const {
+    return strings_->Get(code_identifier_);
+  }
+  virtual string debug_file() const { return strings_->Get(debug_file_); }
+  virtual string debug_identifier() const {
+    return strings_->Get(debug_identifier_);
+  }
+  virtual string version() const { return strings_->Get(version_); }
+  // The copy shares this module's string table.
+  virtual CodeModule* Copy() const { return new BasicCodeModule(*this); }
   virtual bool is_unloaded() const { return is_unloaded_; }
 
  private:
+  // Used by Copy.
+  BasicCodeModule(const BasicCodeModule& that)
+      : CodeModule(),
+        base_address_(that.base_address_),
+        size_(that.size_),
+        shrink_down_delta_(that.shrink_down_delta_),
+        strings_(that.strings_),
+        code_file_(that.code_file_),
+        code_identifier_(that.code_identifier_),
+        debug_file_(that.debug_file_),
+        debug_identifier_(that.debug_identifier_),
+        version_(that.version_),
+        is_unloaded_(that.is_unloaded_) {}
+
+  void AddStrings(const string& code_file,
+                  const string& code_identifier,
+                  const string& debug_file,
+                  const string& debug_identifier,
+                  const string& version) {
+    code_file_ = strings_->Add(code_file);
+    code_identifier_ = strings_->Add(code_identifier);
+    debug_file_ = strings_->Add(debug_file);
+    debug_identifier_ = strings_->Add(debug_identifier);
+    version_ = strings_->Add(version);
+  }
+
   uint64_t base_address_;
   uint64_t size_;
   uint64_t shrink_down_delta_;
-  string code_file_;
-  string code_identifier_;
-  string debug_file_;
-  string debug_identifier_;
-  string version_;
+
+  // Where the strings are kept, and their indices there.
+  std::shared_ptr<CodeModuleStringTable> strings_;
+  CodeModuleStringTable::Index code_file_;
+  CodeModuleStringTable::Index code_identifier_;
+  CodeModuleStringTable::Index debug_file_;
+  CodeModuleStringTable::Index debug_identifier_;
+  CodeModuleStringTable::Index version_;
+
   bool is_unloaded_;
 
-  // Disallow copy constructor and assignment operator.
-  BasicCodeModule(const BasicCodeModule& that);
+  // Disallow assignment operator.
   void operator=(const BasicCodeModule& that);
 };
 
@@ -41,6 +41,8 @@
 #include <vector>
 
 #include "google_breakpad/processor/code_module.h"
+#include "processor/basic_code_module.h"
+#include "processor/address_range_table-inl.h"
 #include "processor/linked_ptr.h"
 #include "processor/logging.h"
 #include "processor/range_map-inl.h"
@@ -51,35 +53,73 @@ using std::vector;
 
 BasicCodeModules::BasicCodeModules(const CodeModules* that,
                                    MergeRangeStrategy strategy)
-    : main_address_(0), map_() {
-  BPLOG_IF(ERROR, !that) << "BasicCodeModules::BasicCodeModules requires "
-                            "|that|";
+    : main_address_(0), map_(), range_table_() {
+  Assign(that, strategy);
+}
+
+BasicCodeModules::BasicCodeModules()
+    : main_address_(0), map_(), range_table_() { }
+
+BasicCodeModules::~BasicCodeModules() {
+}
+
+void BasicCodeModules::Assign(const CodeModules* that,
+                              MergeRangeStrategy strategy) {
+  BPLOG_IF(ERROR, !that) << "BasicCodeModules::Assign requires |that|";
   assert(that);
 
+  map_.Clear();
+  range_table_.Clear();
+  shrunk_range_modules_.clear();
+  main_address_ = 0;
   map_.SetMergeStrategy(strategy);
 
   const CodeModule *main_module = that->GetMainModule();
   if (main_module)
     main_address_ = main_module->base_address();
 
+  // Copies of another BasicCodeModules's modules share its string table,
+  // which is no longer added to.  Other modules' strings go into a table of
+  // this object's own, reusing the last one if nothing else still refers to
+  // it.
+  const BasicCodeModules* basic_that =
+      dynamic_cast<const BasicCodeModules*>(that);
   unsigned int count = that->module_count();
+  if (basic_that) {
+    strings_ = basic_that->strings_;
+  } else if (strings_ && strings_.use_count() == 1) {
+    strings_->Clear();
+  } else {
+    strings_.reset(new CodeModuleStringTable());
+  }
+  if (!basic_that) {
+    // Enough for each module's code and debug files, and its identifiers
+    // and version if they differ too, at typical lengths.
+    strings_->Reserve(count * 5, count * 160);
+  }
+
   for (unsigned int i = 0; i < count; ++i) {
     // Make a copy of the module and insert it into the map.  Use
     // GetModuleAtIndex because ordering is unimportant when slurping the
     // entire list, and GetModuleAtIndex may be faster than
     // GetModuleAtSequence.
-    linked_ptr<const CodeModule> module(that->GetModuleAtIndex(i)->Copy());
+    const CodeModule* original = that->GetModuleAtIndex(i);
+    linked_ptr<const CodeModule> module(
+        basic_that ? original->Copy()
+                   : new BasicCodeModule(original, strings_));
     if (!map_.StoreRange(module->base_address(), module->size(), module)) {
       BPLOG(ERROR) << "Module " << module->code_file()
                    << " could not be stored";
     }
   }
+  range_table_.Build(map_);
 
   // Report modules with shrunk ranges.
   for (unsigned int i = 0; i < count; ++i) {
-    linked_ptr<const CodeModule> module(that->GetModuleAtIndex(i)->Copy());
+    const CodeModule* original = that->GetModuleAtIndex(i);
+    linked_ptr<const CodeModule> module;
     uint64_t delta = 0;
-    if (map_.RetrieveRange(module->base_address() + module->size() - 1,
+    if (map_.RetrieveRange(original->base_address() + original->size() - 1,
                            &module, NULL /* base */, &delta, NULL /* size */) &&
         delta > 0) {
       BPLOG(INFO) << "The range for module " << module->code_file()
@@ -94,20 +134,15 @@ BasicCodeModules::BasicCodeModules(const CodeModules* that,
   // modules should be copied from |that|.
 }
 
-BasicCodeModules::BasicCodeModules() : main_address_(0), map_() { }
-
-BasicCodeModules::~BasicCodeModules() {
-}
-
 unsigned int BasicCodeModules::module_count() const {
-  return map_.GetCount();
+  return range_table_.GetCount();
 }
 
 const CodeModule* BasicCodeModules::GetModuleForAddress(
     uint64_t address) const {
   linked_ptr<const CodeModule> module;
-  if (!map_.RetrieveRange(address, &module, NULL /* base */, NULL /* delta */,
-                          NULL /* size */)) {
+  if (!range_table_.RetrieveRange(address, &module, NULL /* base */,
+                                  NULL /* size */)) {
     BPLOG(INFO) << "No module at " << HexString(address);
     return NULL;
   }
@@ -122,8 +157,8 @@ const CodeModule* BasicCodeModules::GetMainModule() const {
 const CodeModule* BasicCodeModules::GetModuleAtSequence(
     unsigned int sequence) const {
   linked_ptr<const CodeModule> module;
-  if (!map_.RetrieveRangeAtIndex(sequence, &module, NULL /* base */,
-                                 NULL /* delta */, NULL /* size */)) {
+  if (!range_table_.RetrieveRangeAtIndex(sequence, &module, NULL /* base */,
+                                         NULL /* size */)) {
     BPLOG(ERROR) << "RetrieveRangeAtIndex failed for sequence " << sequence;
     return NULL;
   }
@@ -133,10 +168,10 @@ const CodeModule* BasicCodeModules::GetModuleAtSequence(
 
 const CodeModule* BasicCodeModules::GetModuleAtIndex(
     unsigned int index) const {
-  // This class stores everything in a RangeMap, without any more-efficient
-  // way to walk the list of CodeModule objects.  Implement GetModuleAtIndex
-  // using GetModuleAtSequence, which meets all of the requirements, and
-  // in addition, guarantees ordering.
+  // This class keeps everything in address order, without any other way to
+  // walk the list of CodeModule objects.  Implement GetModuleAtIndex using
+  // GetModuleAtSequence, which meets all of the requirements, and in
+  // addition, guarantees ordering.
   return GetModuleAtSequence(index);
 }
 
@@ -43,9 +43,12 @@
 
 #include <stddef.h>
 
+#include <memory>
 #include <vector>
 
 #include "google_breakpad/processor/code_modules.h"
+#include "processor/address_range_table.h"
+#include "processor/code_module_string_table.h"
 #include "processor/linked_ptr.h"
 #include "processor/range_map.h"
 
@@ -60,8 +63,15 @@ class BasicCodeModules : public CodeModules {
   // made of each contained CodeModule using CodeModule::Copy.
   BasicCodeModules(const CodeModules *that, MergeRangeStrategy strategy);
 
+  // Creates an empty BasicCodeModules, to be filled by Assign().
+  BasicCodeModules();
+
   virtual ~BasicCodeModules();
 
+  // Replaces the contents with copies of |that|'s modules, as the
+  // constructor above makes, keeping the storage of the lookup table.
+  void Assign(const CodeModules *that, MergeRangeStrategy strategy);
+
   // See code_modules.h for descriptions of these methods.
   virtual unsigned int module_count() const;
   virtual const CodeModule* GetModuleForAddress(uint64_t address) const;
@@ -73,8 +83,6 @@ class BasicCodeModules : public CodeModules {
   GetShrunkRangeModules() const;
 
  protected:
-  BasicCodeModules();
-
   // The base address of the main module.
   uint64_t main_address_;
 
@@ -82,10 +90,17 @@ class BasicCodeModules : public CodeModules {
   // address range.
   RangeMap<uint64_t, linked_ptr<const CodeModule> > map_;
 
+  // The contents of map_, flattened for lookups.  This must be rebuilt
+  // from map_ whenever map_ changes.
+  AddressRangeTable<uint64_t, linked_ptr<const CodeModule> > range_table_;
+
   // A vector of all CodeModules that were shrunk downs due to
   // address range conflicts.
   std::vector<linked_ptr<const CodeModule> > shrunk_range_modules_;
 
+  // The strings of every module in map_ and shrunk_range_modules_.
+  std::shared_ptr<CodeModuleStringTable> strings_;
+
  private:
   // Disallow copy constructor and assignment operator.
   BasicCodeModules(const BasicCodeModules& that);
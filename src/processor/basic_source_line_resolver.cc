@@ -38,15 +38,22 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <set>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "processor/basic_source_line_resolver_types.h"
 #include "processor/module_factory.h"
+#include "processor/number_parser.h"
+#include "processor/postfix_program-inl.h"
 
 #include "processor/tokenize.h"
 
@@ -62,7 +69,6 @@ namespace google_breakpad {
 #ifdef _MSC_VER
 #define strtok_r strtok_s
 #endif
-#define strtoull _strtoui64
 #endif
 
 namespace {
@@ -70,43 +76,337 @@ namespace {
 // Utility function to tokenize given the presence of an optional initial
 // field. In this case, optional_field is the expected string for the optional
 // field, and max_tokens is the maximum number of tokens including the optional
-// field. Refer to the documentation for Tokenize for descriptions of the other
-// arguments.
+// field. |tokens| must have room for max_tokens entries. Refer to the
+// documentation for Tokenize for descriptions of the other arguments.
 bool TokenizeWithOptionalField(char* line,
                                const char* optional_field,
                                const char* separators,
                                int max_tokens,
-                               vector<char*>* tokens) {
+                               char** tokens,
+                               int* num_tokens) {
   // First tokenize assuming the optional field is not present.  If we then see
   // the optional field, additionally tokenize the last token into two tokens.
-  if (!Tokenize(line, separators, max_tokens - 1, tokens)) {
+  if (!Tokenize(line, separators, max_tokens - 1, tokens, num_tokens)) {
     return false;
   }
 
-  if (strcmp(tokens->front(), optional_field) == 0) {
+  if (strcmp(tokens[0], optional_field) == 0) {
     // The optional field is present. Split the last token in two to recover the
     // field prior to the last.
-    vector<char*> last_tokens;
-    if (!Tokenize(tokens->back(), separators, 2, &last_tokens)) {
+    char* last_tokens[2];
+    int num_last_tokens;
+    if (!Tokenize(tokens[*num_tokens - 1], separators, 2, last_tokens,
+                  &num_last_tokens)) {
       return false;
     }
     // Replace the previous last token with the two new tokens.
-    tokens->pop_back();
-    tokens->push_back(last_tokens[0]);
-    tokens->push_back(last_tokens[1]);
+    tokens[*num_tokens - 1] = last_tokens[0];
+    tokens[(*num_tokens)++] = last_tokens[1];
   }
 
   return true;
 }
 
+// Returns true if |record| is one of the records that follow a FUNC record
+// and belong to it: an INLINE record or a line record, which has no keyword.
+bool IsFunctionRecord(const char* record) {
+  static const char* const kKeywords[] = {
+    "FILE ", "STACK ", "FUNC ", "PUBLIC ", "MODULE ", "INFO ",
+    "INLINE_ORIGIN "
+  };
+  for (size_t i = 0; i < sizeof(kKeywords) / sizeof(kKeywords[0]); ++i) {
+    if (strncmp(record, kKeywords[i], strlen(kKeywords[i])) == 0)
+      return false;
+  }
+  return true;
+}
+
+// What a std::map node takes up besides its key and value: its color and
+// three links.
+const size_t kMapNodeOverhead = 4 * sizeof(void*);
+
+// Returns the bytes |str| allocated for its characters, which a short
+// string keeps within the string object.
+size_t StringHeapBytes(const string& str) {
+  const char* object = reinterpret_cast<const char*>(&str);
+  if (str.data() >= object && str.data() < object + sizeof(str))
+    return 0;
+  return str.capacity() + 1;
+}
+
 }  // namespace
 
 static const char* kWhitespace = " \r\n";
 static const int kMaxErrorsPrinted = 5;
 static const int kMaxErrorsBeforeBailing = 100;
+// The largest number of whitespace-separated fields accepted in an INLINE
+// record, which bounds the number of address ranges it may list.
+static const int kMaxInlineTokens = 512;
+// When loading in parallel, the symbol file is split into this many chunks
+// per thread, so that threads which finish early can pick up more work.
+static const int kChunksPerLoadThread = 4;
+// Symbol files smaller than this are always loaded on a single thread.
+static const size_t kMinParallelLoadSize = 1 << 20;
+// Modules with fewer functions than this look them up in functions_
+// alone, which is quick enough at that size, rather than also keeping a
+// page table over them.
+static const int kMinFunctionsForPageIndex = 1 << 16;
 
 BasicSourceLineResolver::BasicSourceLineResolver() :
-    SourceLineResolverBase(new BasicModuleFactory) { }
+    SourceLineResolverBase(new BasicModuleFactory),
+    load_lines_lazily_(false) { }
+
+BasicSourceLineResolver::BasicSourceLineResolver(int num_load_threads) :
+    SourceLineResolverBase(new BasicModuleFactory(num_load_threads)),
+    load_lines_lazily_(false) { }
+
+BasicSourceLineResolver::BasicSourceLineResolver(int num_load_threads,
+                                                 bool load_lines_lazily) :
+    SourceLineResolverBase(new BasicModuleFactory(num_load_threads,
+                                                  load_lines_lazily)),
+    load_lines_lazily_(load_lines_lazily) { }
+
+BasicSourceLineResolver::BasicSourceLineResolver(
+    int num_load_threads,
+    RecordFetcher* record_fetcher) :
+    SourceLineResolverBase(new BasicModuleFactory(num_load_threads, true,
+                                                  record_fetcher)),
+    load_lines_lazily_(true) { }
+
+bool BasicSourceLineResolver::ShouldDeleteMemoryBufferAfterLoadModule() {
+  // Lazily loaded modules parse their LINE and INLINE records in place.
+  return !load_lines_lazily_;
+}
+
+void BasicSourceLineResolver::SymbolizeAddresses(
+    const AddressToSymbolize* addresses,
+    size_t count,
+    SymbolizedAddress* results) {
+  // Each module's addresses, with the index of their results.
+  typedef vector<std::pair<MemAddr, size_t>> ModuleAddresses;
+  map<const CodeModule*, ModuleAddresses> by_module;
+  for (size_t i = 0; i < count; ++i) {
+    results[i] = SymbolizedAddress();
+    if (addresses[i].module) {
+      by_module[addresses[i].module].push_back(
+          make_pair(addresses[i].offset, i));
+    }
+  }
+
+  class Symbolizer : public ModuleVisitor {
+   public:
+    Symbolizer(const ModuleAddresses* addresses, SymbolizedAddress* results)
+        : addresses_(addresses), results_(results) { }
+    virtual void Visit(const SourceLineResolverBase::Module* module) {
+      static_cast<const Module*>(module)->SymbolizeSortedAddresses(
+          &(*addresses_)[0], addresses_->size(), results_);
+    }
+
+   private:
+    const ModuleAddresses* addresses_;
+    SymbolizedAddress* results_;
+  };
+
+  for (map<const CodeModule*, ModuleAddresses>::iterator it =
+           by_module.begin(); it != by_module.end(); ++it) {
+    std::sort(it->second.begin(), it->second.end());
+    Symbolizer symbolizer(&it->second, results);
+    VisitModule(it->first, &symbolizer);
+  }
+}
+
+BasicSourceLineResolver::Module::~Module() {
+  for (size_t i = 0; i < interned_strings_.size(); ++i)
+    string_pool_->Release(interned_strings_[i]);
+}
+
+const char* BasicSourceLineResolver::Module::Intern(const char* str) {
+  const char* interned = string_pool_->Intern(str);
+  interned_strings_.push_back(interned);
+  return interned;
+}
+
+class BasicSourceLineResolver::Module::RecordSink {
+ public:
+  virtual ~RecordSink() { }
+  virtual void AddFile(long index, const char* filename) = 0;
+  virtual void AddInlineOrigin(long origin_id,
+                               linked_ptr<InlineOrigin> origin) = 0;
+  virtual void AddFunction(linked_ptr<Function> function) = 0;
+  // Returns false if the symbol could not be stored.
+  virtual bool AddPublicSymbol(linked_ptr<PublicSymbol> symbol,
+                               int line_number) = 0;
+  virtual void AddWindowsFrameInfo(int type,
+                                   MemAddr rva,
+                                   MemAddr code_size,
+                                   linked_ptr<WindowsFrameInfo> info) = 0;
+  virtual void AddCFIInitialRules(MemAddr address,
+                                  MemAddr size,
+                                  const char* rules) = 0;
+  virtual void AddCFIDeltaRules(MemAddr address, const char* rules) = 0;
+};
+
+// Stores records directly into a module.
+class BasicSourceLineResolver::Module::ModuleRecordSink : public RecordSink {
+ public:
+  explicit ModuleRecordSink(Module* module) : module_(module) { }
+
+  virtual void AddFile(long index, const char* filename) {
+    module_->files_.emplace(index, module_->Intern(filename));
+  }
+
+  virtual void AddInlineOrigin(long origin_id,
+                               linked_ptr<InlineOrigin> origin) {
+    origin->name = module_->Intern(origin->name);
+    module_->inline_origins_.insert(make_pair(origin_id, origin));
+  }
+
+  virtual void AddFunction(linked_ptr<Function> function) {
+    function->name = module_->Intern(function->name);
+    if (module_->load_lines_lazily_)
+      module_->lazy_functions_.push_back(function);
+    // Storing will fail if the function has an invalid address or size.
+    // We'll silently ignore this, the function and any corresponding lines
+    // will be destroyed when the last reference to it is released.
+    module_->functions_.AppendRange(function->address, function->size,
+                                    function);
+  }
+
+  virtual bool AddPublicSymbol(linked_ptr<PublicSymbol> symbol,
+                               int line_number) {
+    symbol->name = module_->Intern(symbol->name);
+    return module_->public_symbols_.Store(symbol->address, symbol);
+  }
+
+  virtual void AddWindowsFrameInfo(int type,
+                                   MemAddr rva,
+                                   MemAddr code_size,
+                                   linked_ptr<WindowsFrameInfo> info) {
+    module_->windows_frame_info_[type].StoreRange(rva, code_size, info);
+  }
+
+  virtual void AddCFIInitialRules(MemAddr address,
+                                  MemAddr size,
+                                  const char* rules) {
+    module_->cfi_initial_rules_.AppendRange(address, size, rules);
+  }
+
+  virtual void AddCFIDeltaRules(MemAddr address, const char* rules) {
+    module_->cfi_delta_rules_[address] = rules;
+  }
+
+ private:
+  Module* module_;
+};
+
+// Collects the records of one chunk of a symbol file, so that they can be
+// stored into the module in file order after all chunks are parsed.  Names
+// and rule strings point into the symbol buffer until then, and names are
+// interned as they are stored.
+class BasicSourceLineResolver::Module::ChunkRecordSink : public RecordSink {
+ public:
+  ChunkRecordSink() : num_errors_(0), inline_num_errors_(0) { }
+
+  virtual void AddFile(long index, const char* filename) {
+    files_.push_back(make_pair(index, filename));
+  }
+
+  virtual void AddInlineOrigin(long origin_id,
+                               linked_ptr<InlineOrigin> origin) {
+    inline_origins_.push_back(make_pair(origin_id, origin));
+  }
+
+  virtual void AddFunction(linked_ptr<Function> function) {
+    functions_.push_back(function);
+  }
+
+  virtual bool AddPublicSymbol(linked_ptr<PublicSymbol> symbol,
+                               int line_number) {
+    // Duplicates can only be detected once earlier chunks are stored, so
+    // keep the line number around for the error message.
+    public_symbols_.push_back(make_pair(line_number, symbol));
+    return true;
+  }
+
+  virtual void AddWindowsFrameInfo(int type,
+                                   MemAddr rva,
+                                   MemAddr code_size,
+                                   linked_ptr<WindowsFrameInfo> info) {
+    WindowsFrameInfoRecord record = { type, rva, code_size, info };
+    windows_frame_info_.push_back(record);
+  }
+
+  virtual void AddCFIInitialRules(MemAddr address,
+                                  MemAddr size,
+                                  const char* rules) {
+    CFIRulesRecord record = { address, size, rules };
+    cfi_initial_rules_.push_back(record);
+  }
+
+  virtual void AddCFIDeltaRules(MemAddr address, const char* rules) {
+    CFIRulesRecord record = { address, 0, rules };
+    cfi_delta_rules_.push_back(record);
+  }
+
+  // Passes the collected records to |sink| in the order they were parsed,
+  // logging public symbols that |sink| rejects as errors.
+  void Replay(RecordSink* sink, int* num_errors) const {
+    for (size_t i = 0; i < files_.size(); ++i)
+      sink->AddFile(files_[i].first, files_[i].second);
+    for (size_t i = 0; i < inline_origins_.size(); ++i)
+      sink->AddInlineOrigin(inline_origins_[i].first,
+                            inline_origins_[i].second);
+    for (size_t i = 0; i < functions_.size(); ++i)
+      sink->AddFunction(functions_[i]);
+    for (size_t i = 0; i < public_symbols_.size(); ++i) {
+      if (!sink->AddPublicSymbol(public_symbols_[i].second,
+                                 public_symbols_[i].first)) {
+        LogParseError("ParsePublicSymbol failed", public_symbols_[i].first,
+                      num_errors);
+      }
+    }
+    for (size_t i = 0; i < windows_frame_info_.size(); ++i) {
+      const WindowsFrameInfoRecord& record = windows_frame_info_[i];
+      sink->AddWindowsFrameInfo(record.type, record.rva, record.code_size,
+                                record.info);
+    }
+    for (size_t i = 0; i < cfi_initial_rules_.size(); ++i) {
+      const CFIRulesRecord& record = cfi_initial_rules_[i];
+      sink->AddCFIInitialRules(record.address, record.size, record.rules);
+    }
+    for (size_t i = 0; i < cfi_delta_rules_.size(); ++i) {
+      const CFIRulesRecord& record = cfi_delta_rules_[i];
+      sink->AddCFIDeltaRules(record.address, record.rules);
+    }
+  }
+
+  int* num_errors() { return &num_errors_; }
+  int* inline_num_errors() { return &inline_num_errors_; }
+
+ private:
+  struct WindowsFrameInfoRecord {
+    int type;
+    MemAddr rva;
+    MemAddr code_size;
+    linked_ptr<WindowsFrameInfo> info;
+  };
+
+  struct CFIRulesRecord {
+    MemAddr address;
+    MemAddr size;
+    const char* rules;
+  };
+
+  vector<std::pair<long, const char*>> files_;
+  vector<std::pair<long, linked_ptr<InlineOrigin>>> inline_origins_;
+  vector<linked_ptr<Function>> functions_;
+  vector<std::pair<int, linked_ptr<PublicSymbol>>> public_symbols_;
+  vector<WindowsFrameInfoRecord> windows_frame_info_;
+  vector<CFIRulesRecord> cfi_initial_rules_;
+  vector<CFIRulesRecord> cfi_delta_rules_;
+  int num_errors_;
+  int inline_num_errors_;
+};
 
 // static
 void BasicSourceLineResolver::Module::LogParseError(
@@ -125,11 +425,9 @@ void BasicSourceLineResolver::Module::LogParseError(
 bool BasicSourceLineResolver::Module::LoadMapFromMemory(
     char* memory_buffer,
     size_t memory_buffer_size) {
-  linked_ptr<Function> cur_func;
   int line_number = 0;
   int num_errors = 0;
   int inline_num_errors = 0;
-  char* save_ptr;
 
   // If the length is 0, we can still pretend we have a symbol file. This is
   // for scenarios that want to test symbol lookup, but don't necessarily care
@@ -151,11 +449,12 @@ bool BasicSourceLineResolver::Module::LoadMapFromMemory(
          memory_buffer[last_null_terminator - 1] == '\0') {
     last_null_terminator--;
   }
-  for (size_t i = 0; i < last_null_terminator; i++) {
-    if (memory_buffer[i] == '\0') {
-      memory_buffer[i] = '_';
-      has_null_terminator_in_the_middle = true;
-    }
+  char* stray_null = memory_buffer;
+  char* const buffer_end = memory_buffer + last_null_terminator;
+  while ((stray_null = static_cast<char*>(
+              memchr(stray_null, '\0', buffer_end - stray_null))) != NULL) {
+    *stray_null++ = '_';
+    has_null_terminator_in_the_middle = true;
   }
   if (has_null_terminator_in_the_middle) {
     LogParseError(
@@ -164,36 +463,85 @@ bool BasicSourceLineResolver::Module::LoadMapFromMemory(
        &num_errors);
   }
 
-  char* buffer;
-  buffer = strtok_r(memory_buffer, "\r\n", &save_ptr);
+  if (num_load_threads_ > 1 && last_null_terminator >= kMinParallelLoadSize) {
+    LoadChunksInParallel(memory_buffer, last_null_terminator, &num_errors,
+                         &inline_num_errors);
+  } else {
+    ModuleRecordSink sink(this);
+    ParseRecords(memory_buffer, line_number, &sink, &num_errors,
+                 &inline_num_errors);
+  }
+  is_corrupt_ = num_errors > 0;
+
+  // No more FUNC, STACK CFI INIT or STACK WIN records will be added.
+  functions_.StoreAppendedRanges();
+  cfi_initial_rules_.StoreAppendedRanges();
+  if (functions_.GetCount() >= kMinFunctionsForPageIndex)
+    function_index_.Build(functions_);
+  for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i)
+    windows_frame_info_[i].Flatten(&flat_windows_frame_info_[i]);
+  return true;
+}
+
+void BasicSourceLineResolver::Module::ParseRecords(
+    char* buffer,
+    int line_number,
+    RecordSink* sink,
+    int* num_errors,
+    int* inline_num_errors) const {
+  linked_ptr<Function> cur_func;
+  // Set when another record follows records deferred for cur_func, which
+  // have to stay contiguous.
+  bool deferral_interrupted = false;
+  char* save_ptr;
+
+  buffer = strtok_r(buffer, "\r\n", &save_ptr);
 
   while (buffer != NULL) {
     ++line_number;
 
+    if (load_lines_lazily_ && cur_func.get() && IsFunctionRecord(buffer)) {
+      if (deferral_interrupted) {
+        LoadFunctionRecords(cur_func.get());
+        deferral_interrupted = false;
+      }
+      // strtok_r has already terminated the record.
+      if (!cur_func->pending_records)
+        cur_func->pending_records = buffer;
+      cur_func->pending_records_end = buffer + strlen(buffer);
+      buffer = strtok_r(NULL, "\r\n", &save_ptr);
+      continue;
+    }
+    if (cur_func.get() && cur_func->pending_records)
+      deferral_interrupted = true;
+
     if (strncmp(buffer, "FILE ", 5) == 0) {
-      if (!ParseFile(buffer)) {
-        LogParseError("ParseFile on buffer failed", line_number, &num_errors);
+      if (!ParseFile(buffer, sink)) {
+        LogParseError("ParseFile on buffer failed", line_number, num_errors);
       }
     } else if (strncmp(buffer, "STACK ", 6) == 0) {
-      if (!ParseStackInfo(buffer)) {
-        LogParseError("ParseStackInfo failed", line_number, &num_errors);
+      if (!ParseStackInfo(buffer, sink)) {
+        LogParseError("ParseStackInfo failed", line_number, num_errors);
       }
     } else if (strncmp(buffer, "FUNC ", 5) == 0) {
+      deferral_interrupted = false;
+      if (cur_func.get())
+        cur_func->lines.StoreAppendedRanges();
       cur_func.reset(ParseFunction(buffer));
       if (!cur_func.get()) {
-        LogParseError("ParseFunction failed", line_number, &num_errors);
+        LogParseError("ParseFunction failed", line_number, num_errors);
       } else {
-        // StoreRange will fail if the function has an invalid address or size.
-        // We'll silently ignore this, the function and any corresponding lines
-        // will be destroyed when cur_func is released.
-        functions_.StoreRange(cur_func->address, cur_func->size, cur_func);
+        sink->AddFunction(cur_func);
       }
     } else if (strncmp(buffer, "PUBLIC ", 7) == 0) {
       // Clear cur_func: public symbols don't contain line number information.
+      if (cur_func.get())
+        cur_func->lines.StoreAppendedRanges();
       cur_func.reset();
+      deferral_interrupted = false;
 
-      if (!ParsePublicSymbol(buffer)) {
-        LogParseError("ParsePublicSymbol failed", line_number, &num_errors);
+      if (!ParsePublicSymbol(buffer, line_number, sink)) {
+        LogParseError("ParsePublicSymbol failed", line_number, num_errors);
       }
     } else if (strncmp(buffer, "MODULE ", 7) == 0) {
       // Ignore these.  They're not of any use to BasicSourceLineResolver,
@@ -206,95 +554,362 @@ bool BasicSourceLineResolver::Module::LoadMapFromMemory(
       // Ignore these as well, they're similarly just for housekeeping.
       //
       // INFO CODE_ID <code id> <filename>
+      //
+      // The exception is an address index, when the records of the
+      // functions it lists can be fetched: they may be all the module has.
+      //
+      // INFO INDEX <offset> <length> <FUNC record>
+      if (record_fetcher_ && load_lines_lazily_ &&
+          strncmp(buffer, "INFO INDEX ", 11) == 0) {
+        if (cur_func.get())
+          cur_func->lines.StoreAppendedRanges();
+        cur_func.reset();
+        deferral_interrupted = false;
+        linked_ptr<Function> indexed_func(ParseIndexedFunction(buffer));
+        if (!indexed_func.get()) {
+          LogParseError("ParseIndexedFunction failed", line_number,
+                        num_errors);
+        } else {
+          sink->AddFunction(indexed_func);
+        }
+      }
     } else if (strncmp(buffer, "INLINE ", 7) == 0) {
       linked_ptr<Inline> in = ParseInline(buffer);
       if (!in.get())
-        LogParseError("ParseInline failed", line_number, &inline_num_errors);
+        LogParseError("ParseInline failed", line_number, inline_num_errors);
       else
         cur_func->AppendInline(in);
     } else if (strncmp(buffer, "INLINE_ORIGIN ", 14) == 0) {
-      if (!ParseInlineOrigin(buffer)) {
+      if (!ParseInlineOrigin(buffer, sink)) {
         LogParseError("ParseInlineOrigin failed", line_number,
-                      &inline_num_errors);
+                      inline_num_errors);
       }
     } else {
       if (!cur_func.get()) {
         LogParseError("Found source line data without a function",
-                       line_number, &num_errors);
+                       line_number, num_errors);
       } else {
-        Line* line = ParseLine(buffer);
-        if (!line) {
-          LogParseError("ParseLine failed", line_number, &num_errors);
+        Line line;
+        if (!ParseLine(buffer, &line)) {
+          LogParseError("ParseLine failed", line_number, num_errors);
         } else {
-          cur_func->lines.StoreRange(line->address, line->size,
-                                     linked_ptr<Line>(line));
+          cur_func->lines.AppendRange(line.address, line.size, line);
         }
       }
     }
-    if (num_errors > kMaxErrorsBeforeBailing) {
+    if (*num_errors > kMaxErrorsBeforeBailing) {
       break;
     }
     buffer = strtok_r(NULL, "\r\n", &save_ptr);
   }
-  is_corrupt_ = num_errors > 0;
-  return true;
+  if (cur_func.get())
+    cur_func->lines.StoreAppendedRanges();
 }
 
-void BasicSourceLineResolver::Module::ConstructInlineFrames(
-    StackFrame* frame,
-    MemAddr address,
-    const ContainedRangeMap<uint64_t, linked_ptr<Inline>>& inline_map,
-    deque<unique_ptr<StackFrame>>* inlined_frames) const {
-  vector<const linked_ptr<Inline>*> inlines;
-  if (!inline_map.RetrieveRanges(address, inlines)) {
-    return;
-  }
+void BasicSourceLineResolver::Module::LoadFunctionRecords(
+    Function* function) const {
+  char* record = function->pending_records;
+  char* const records_end = function->pending_records_end;
+  function->pending_records = NULL;
+  function->pending_records_end = NULL;
 
-  for (const linked_ptr<Inline>* const in : inlines) {
-    unique_ptr<StackFrame> new_frame =
-        unique_ptr<StackFrame>(new StackFrame(*frame));
-    auto origin = inline_origins_.find(in->get()->origin_id);
-    if (origin != inline_origins_.end()) {
-      new_frame->function_name = origin->second->name;
+  int num_errors = 0;
+  while (record && record < records_end) {
+    if (*record == '\0' || *record == '\r' || *record == '\n') {
+      // Skip the separators strtok_r left between records.
+      ++record;
+      continue;
+    }
+    size_t length = strlen(record);
+    // Parsing tokenizes the record in place, so find the next one first.
+    char* next_record = record + length + 1;
+    if (strncmp(record, "INLINE ", 7) == 0) {
+      linked_ptr<Inline> in = ParseInline(record);
+      if (!in.get())
+        ++num_errors;
+      else
+        function->AppendInline(in);
     } else {
-      new_frame->function_name = "<name omitted>";
+      Line line;
+      if (!ParseLine(record, &line))
+        ++num_errors;
+      else
+        function->lines.AppendRange(line.address, line.size, line);
     }
-    
-    // Store call site file and line in current frame, which will be updated
-    // later.
-    new_frame->source_line = in->get()->call_site_line;
-    if (in->get()->has_call_site_file_id) {
-      auto file = files_.find(in->get()->call_site_file_id);
-      if (file != files_.end()) {
-        new_frame->source_file_name = file->second;
+    record = next_record;
+  }
+  function->lines.StoreAppendedRanges();
+  if (num_errors > 0) {
+    BPLOG(ERROR) << num_errors << " LINE or INLINE records of function "
+                 << function->name << " in module " << name_
+                 << " could not be parsed";
+  }
+}
+
+void BasicSourceLineResolver::Module::FetchFunctionRecords(
+    Function* function) const {
+  uint64_t offset = function->indexed_records_offset;
+  uint64_t length = function->indexed_records_length;
+  function->indexed_records_length = 0;
+
+  string records;
+  if (!record_fetcher_->FetchRecords(name_, offset, length, &records)) {
+    BPLOG(ERROR) << "Could not fetch the LINE and INLINE records of function "
+                 << function->name << " in module " << name_;
+    return;
+  }
+  // Separate the records as ParseRecords would have, and parse them as if
+  // they had been deferred; nothing parsed points into them.
+  std::vector<char> buffer(records.begin(), records.end());
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    if (buffer[i] == '\r' || buffer[i] == '\n')
+      buffer[i] = '\0';
+  }
+  buffer.push_back('\0');
+  function->pending_records = &buffer[0];
+  function->pending_records_end = &buffer[0] + records.size();
+  LoadFunctionRecords(function);
+}
+
+void BasicSourceLineResolver::Module::LoadAllFunctionRecords() const {
+  for (size_t i = 0; i < lazy_functions_.size(); ++i) {
+    if (lazy_functions_[i]->pending_records)
+      LoadFunctionRecords(lazy_functions_[i].get());
+    else if (lazy_functions_[i]->indexed_records_length)
+      FetchFunctionRecords(lazy_functions_[i].get());
+  }
+  lazy_functions_.clear();
+}
+
+bool BasicSourceLineResolver::Module::FindNearestFunction(
+    MemAddr address,
+    linked_ptr<Function>* function,
+    MemAddr* function_base,
+    MemAddr* function_size) const {
+  if (function_index_.GetCount() == 0) {
+    return functions_.RetrieveNearestRange(address, function, function_base,
+                                           NULL /* delta */, function_size);
+  }
+  const linked_ptr<Function>* entry;
+  if (!function_index_.RetrieveNearestRange(address, &entry, function_base,
+                                            function_size)) {
+    return false;
+  }
+  *function = *entry;
+  return true;
+}
+
+// static
+void BasicSourceLineResolver::Module::SplitIntoChunks(
+    char* buffer,
+    size_t buffer_size,
+    size_t max_chunks,
+    vector<char*>* chunks) {
+  char* const buffer_end = buffer + buffer_size;
+  size_t chunk_size = buffer_size / max_chunks;
+  chunks->clear();
+  chunks->push_back(buffer);
+
+  char* position = buffer;
+  for (size_t i = 1; i < max_chunks; ++i) {
+    char* target = buffer + i * chunk_size;
+    if (target > position)
+      position = target;
+
+    // Move to the start of the next FUNC, PUBLIC or STACK record.
+    char* chunk_start = NULL;
+    while (position < buffer_end) {
+      char* newline = static_cast<char*>(
+          memchr(position, '\n', buffer_end - position));
+      if (!newline)
+        break;
+      position = newline + 1;
+      if (strncmp(position, "FUNC ", 5) == 0 ||
+          strncmp(position, "PUBLIC ", 7) == 0 ||
+          strncmp(position, "STACK ", 6) == 0) {
+        chunk_start = position;
+        break;
       }
     }
+    if (!chunk_start)
+      break;
 
-    // Use the starting address of the inlined range as inlined function base.
-    new_frame->function_base = new_frame->module->base_address();
-    for (const auto& range : in->get()->inline_ranges) {
-      if (address >= range.first && address < range.first + range.second) {
-        new_frame->function_base += range.first;
-        break;
+    // Terminate the previous chunk at the newline that ends it.
+    chunk_start[-1] = '\0';
+    chunks->push_back(chunk_start);
+  }
+}
+
+void BasicSourceLineResolver::Module::LoadChunksInParallel(
+    char* buffer,
+    size_t buffer_size,
+    int* num_errors,
+    int* inline_num_errors) {
+  vector<char*> chunks;
+  SplitIntoChunks(buffer, buffer_size,
+                  static_cast<size_t>(num_load_threads_) * kChunksPerLoadThread,
+                  &chunks);
+  size_t num_threads = std::min(static_cast<size_t>(num_load_threads_),
+                                chunks.size());
+
+  // Runs |work| on num_threads threads, including the calling one.
+  auto run_on_threads = [num_threads](const std::function<void()>& work) {
+    vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i)
+      threads.push_back(std::thread(work));
+    work();
+    for (size_t i = 0; i < threads.size(); ++i)
+      threads[i].join();
+  };
+
+  // Count the lines in each chunk so that errors can be reported with their
+  // line numbers.  SplitIntoChunks replaced the newline that ended each chunk
+  // with a null terminator, so that line is counted here too.
+  vector<int> line_numbers(chunks.size());
+  std::atomic<size_t> next_chunk(0);
+  run_on_threads([&]() {
+    size_t i;
+    while ((i = next_chunk++) < chunks.size()) {
+      int lines = 1;
+      for (const char* newline = strchr(chunks[i], '\n'); newline;
+           newline = strchr(newline + 1, '\n')) {
+        ++lines;
       }
+      line_numbers[i] = lines;
     }
-    new_frame->trust = StackFrame::FRAME_TRUST_INLINE;
+  });
+
+  // Turn the line counts into the number of lines preceding each chunk.
+  int lines_so_far = 0;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    int lines = line_numbers[i];
+    line_numbers[i] = lines_so_far;
+    lines_so_far += lines;
+  }
 
-    // The inlines vector has an order from innermost entry to outermost entry.
-    // By push_back, we will have inlined_frames with the same order.
-    inlined_frames->push_back(std::move(new_frame));
+  vector<ChunkRecordSink> sinks(chunks.size());
+  next_chunk = 0;
+  run_on_threads([&]() {
+    size_t i;
+    while ((i = next_chunk++) < chunks.size()) {
+      ParseRecords(chunks[i], line_numbers[i], &sinks[i],
+                   sinks[i].num_errors(), sinks[i].inline_num_errors());
+    }
+  });
+
+  ModuleRecordSink module_sink(this);
+  for (size_t i = 0; i < sinks.size(); ++i) {
+    *num_errors += *sinks[i].num_errors();
+    *inline_num_errors += *sinks[i].inline_num_errors();
+    sinks[i].Replay(&module_sink, num_errors);
   }
+}
+
+void BasicSourceLineResolver::Module::BuildInlineTable(
+    Function* function) const {
+  // RetrieveRanges returns the same inlines everywhere between two
+  // consecutive boundaries, so each such stretch becomes one segment.
+  vector<MemAddr> boundaries;
+  function->inlines.GetRangeBoundaries(&boundaries);
+  std::sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(std::unique(boundaries.begin(), boundaries.end()),
+                   boundaries.end());
 
-  // Update the source file and source line for each inlined frame.
-  if (!inlined_frames->empty()) {
-    string parent_frame_source_file_name = frame->source_file_name;
-    int parent_frame_source_line = frame->source_line;
-    frame->source_file_name = inlined_frames->back()->source_file_name;
-    frame->source_line = inlined_frames->back()->source_line;
-    for (unique_ptr<StackFrame>& inlined_frame : *inlined_frames) {
-      std::swap(inlined_frame->source_file_name, parent_frame_source_file_name);
-      std::swap(inlined_frame->source_line, parent_frame_source_line);
+  vector<const linked_ptr<Inline>*> inlines;
+  for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+    MemAddr address = boundaries[i];
+    inlines.clear();
+    if (!function->inlines.RetrieveRanges(address, inlines))
+      continue;
+
+    Function::InlineSegment segment;
+    segment.address = address;
+    segment.end = boundaries[i + 1];
+    segment.first_frame = function->inline_frames.size();
+    segment.frame_count = inlines.size();
+    for (const linked_ptr<Inline>* const in : inlines) {
+      Function::InlineFrame inline_frame;
+      auto origin = inline_origins_.find(in->get()->origin_id);
+      if (origin != inline_origins_.end()) {
+        inline_frame.function_name = origin->second->name;
+      } else {
+        inline_frame.function_name = "<name omitted>";
+      }
+      inline_frame.call_site_file_name = NULL;
+      if (in->get()->has_call_site_file_id) {
+        auto file = files_.find(in->get()->call_site_file_id);
+        if (file != files_.end()) {
+          inline_frame.call_site_file_name = file->second;
+        }
+      }
+      inline_frame.call_site_line = in->get()->call_site_line;
+
+      // Use the starting address of the inlined range as inlined function
+      // base.
+      inline_frame.function_base = 0;
+      for (const auto& range : in->get()->inline_ranges) {
+        if (address >= range.first && address < range.first + range.second) {
+          inline_frame.function_base = range.first;
+          break;
+        }
+      }
+      function->inline_frames.push_back(inline_frame);
+    }
+    function->inline_segments.push_back(segment);
+  }
+  function->inline_segments.shrink_to_fit();
+  function->inline_frames.shrink_to_fit();
+  function->inline_table_built = true;
+}
+
+void BasicSourceLineResolver::Module::ConstructInlineFrames(
+    StackFrame* frame,
+    MemAddr address,
+    Function* function,
+    deque<unique_ptr<StackFrame>>* inlined_frames) const {
+  if (!function->inline_table_built)
+    BuildInlineTable(function);
+
+  const vector<Function::InlineSegment>& segments = function->inline_segments;
+  auto segment = std::upper_bound(
+      segments.begin(), segments.end(), address,
+      [](MemAddr a, const Function::InlineSegment& b) {
+        return a < b.address;
+      });
+  if (segment == segments.begin())
+    return;
+  --segment;
+  if (address >= segment->end)
+    return;
+
+  // Each inlined frame takes the source line of the call site inside the
+  // next inner one, the innermost keeping the frame's own, and the frame
+  // takes the outermost call site. A call site without a file keeps the
+  // frame's own file.
+  const string source_file_name = frame->source_file_name;
+  const Function::InlineFrame* inlines =
+      &function->inline_frames[segment->first_frame];
+  for (uint32_t i = 0; i < segment->frame_count; ++i) {
+    // inlines runs from innermost entry to outermost entry, and so does
+    // inlined_frames.
+    unique_ptr<StackFrame> new_frame(new StackFrame(*frame));
+    new_frame->function_name = inlines[i].function_name;
+    new_frame->function_base =
+        frame->module->base_address() + inlines[i].function_base;
+    new_frame->trust = StackFrame::FRAME_TRUST_INLINE;
+    if (i > 0) {
+      const Function::InlineFrame& inner = inlines[i - 1];
+      new_frame->source_file_name = inner.call_site_file_name ?
+          inner.call_site_file_name : source_file_name;
+      new_frame->source_line = inner.call_site_line;
     }
+    inlined_frames->push_back(std::move(new_frame));
+  }
+  if (segment->frame_count > 0) {
+    const Function::InlineFrame& outer = inlines[segment->frame_count - 1];
+    if (outer.call_site_file_name)
+      frame->source_file_name = outer.call_site_file_name;
+    frame->source_line = outer.call_site_line;
   }
 }
 
@@ -314,27 +929,31 @@ void BasicSourceLineResolver::Module::LookupAddress(
   MemAddr function_base;
   MemAddr function_size;
   MemAddr public_address;
-  if (functions_.RetrieveNearestRange(address, &func, &function_base,
-                                      NULL /* delta */, &function_size) &&
+  if (FindNearestFunction(address, &func, &function_base, &function_size) &&
       address >= function_base && address - function_base < function_size) {
     frame->function_name = func->name;
     frame->function_base = frame->module->base_address() + function_base;
 
-    linked_ptr<Line> line;
+    if (func->pending_records)
+      LoadFunctionRecords(func.get());
+    else if (func->indexed_records_length)
+      FetchFunctionRecords(func.get());
+
+    Line line;
     MemAddr line_base;
     if (func->lines.RetrieveRange(address, &line, &line_base, NULL /* delta */,
                                   NULL /* size */)) {
-      FileMap::const_iterator it = files_.find(line->source_file_id);
+      FileMap::const_iterator it = files_.find(line.source_file_id);
       if (it != files_.end()) {
-        frame->source_file_name = files_.find(line->source_file_id)->second;
+        frame->source_file_name = it->second;
       }
-      frame->source_line = line->line;
+      frame->source_line = line.line;
       frame->source_line_base = frame->module->base_address() + line_base;
     }
 
     // Check if this is inlined function call.
     if (inlined_frames) {
-      ConstructInlineFrames(frame, address, func->inlines, inlined_frames);
+      ConstructInlineFrames(frame, address, func.get(), inlined_frames);
     }
   } else if (public_symbols_.Retrieve(address,
                                       &public_symbol, &public_address) &&
@@ -344,6 +963,70 @@ void BasicSourceLineResolver::Module::LookupAddress(
   }
 }
 
+void BasicSourceLineResolver::Module::SymbolizeSortedAddresses(
+    const std::pair<MemAddr, size_t>* addresses,
+    size_t count,
+    SymbolizedAddress* results) const {
+  // The function and line the previous address fell in, which the next
+  // one, being no lower, often falls in too.
+  linked_ptr<Function> func;
+  MemAddr function_base = 0;
+  MemAddr function_size = 0;
+  bool in_function = false;
+  Line line;
+  MemAddr line_base = 0;
+  MemAddr line_size = 0;
+  bool in_line = false;
+  const char* line_file = NULL;
+
+  for (size_t i = 0; i < count; ++i) {
+    const MemAddr address = addresses[i].first;
+    SymbolizedAddress* result = &results[addresses[i].second];
+    if (!in_function || address < function_base ||
+        address - function_base >= function_size) {
+      in_line = false;
+      in_function =
+          FindNearestFunction(address, &func, &function_base,
+                              &function_size) &&
+          address >= function_base && address - function_base < function_size;
+      if (in_function) {
+        if (func->pending_records)
+          LoadFunctionRecords(func.get());
+        else if (func->indexed_records_length)
+          FetchFunctionRecords(func.get());
+      }
+    }
+
+    if (in_function) {
+      result->function_name = func->name;
+      result->function_offset = function_base;
+      if (!in_line || address < line_base || address - line_base >= line_size) {
+        in_line = func->lines.RetrieveRange(address, &line, &line_base,
+                                            NULL /* delta */, &line_size);
+        if (in_line) {
+          FileMap::const_iterator it = files_.find(line.source_file_id);
+          line_file = it != files_.end() ? it->second : NULL;
+        }
+      }
+      if (in_line) {
+        result->source_file_name = line_file;
+        result->source_line = line.line;
+      }
+      continue;
+    }
+
+    // As in LookupAddress, a PUBLIC symbol covers the address unless a
+    // function starts between them.
+    linked_ptr<PublicSymbol> public_symbol;
+    MemAddr public_address;
+    if (public_symbols_.Retrieve(address, &public_symbol, &public_address) &&
+        (!func.get() || public_address > function_base)) {
+      result->function_name = public_symbol->name;
+      result->function_offset = public_address;
+    }
+  }
+}
+
 WindowsFrameInfo* BasicSourceLineResolver::Module::FindWindowsFrameInfo(
     const StackFrame* frame) const {
   MemAddr address = frame->instruction - frame->module->base_address();
@@ -355,12 +1038,16 @@ WindowsFrameInfo* BasicSourceLineResolver::Module::FindWindowsFrameInfo(
   // includes its own program string.
   // WindowsFrameInfo::STACK_INFO_FPO is the older type
   // corresponding to the FPO_DATA struct. See stackwalker_x86.cc.
-  linked_ptr<WindowsFrameInfo> frame_info;
-  if ((windows_frame_info_[WindowsFrameInfo::STACK_INFO_FRAME_DATA]
+  const linked_ptr<WindowsFrameInfo>* frame_info;
+  if ((flat_windows_frame_info_[WindowsFrameInfo::STACK_INFO_FRAME_DATA]
        .RetrieveRange(address, &frame_info))
-      || (windows_frame_info_[WindowsFrameInfo::STACK_INFO_FPO]
+      || (flat_windows_frame_info_[WindowsFrameInfo::STACK_INFO_FPO]
           .RetrieveRange(address, &frame_info))) {
-    result->CopyFrom(*frame_info.get());
+    result->CopyFrom(*frame_info->get());
+    if (!result->program_string.empty()) {
+      result->program = windows_program_cache_.Get(frame_info->get(),
+                                                   result->program_string);
+    }
     return result.release();
   }
 
@@ -373,8 +1060,8 @@ WindowsFrameInfo* BasicSourceLineResolver::Module::FindWindowsFrameInfo(
   // comparison in an overflow-friendly way.
   linked_ptr<Function> function;
   MemAddr function_base, function_size;
-  if (functions_.RetrieveNearestRange(address, &function, &function_base,
-                                      NULL /* delta */, &function_size) &&
+  if (FindNearestFunction(address, &function, &function_base,
+                          &function_size) &&
       address >= function_base && address - function_base < function_size) {
     result->parameter_size = function->parameter_size;
     result->valid |= WindowsFrameInfo::VALID_PARAMETER_SIZE;
@@ -408,54 +1095,143 @@ CFIFrameInfo* BasicSourceLineResolver::Module::FindCFIFrameInfo(
     return NULL;
   }
 
+  // Find the delta rules from the start of the initial rule's range up to
+  // and including the frame's address.  The rule set they yield may have
+  // been built for an earlier frame.
+  map<MemAddr, string>::const_iterator first_delta =
+    cfi_delta_rules_.lower_bound(initial_base);
+  map<MemAddr, string>::const_iterator end_delta =
+    cfi_delta_rules_.upper_bound(address);
+  MemAddr last_delta_address = initial_base;
+  if (first_delta != end_delta) {
+    map<MemAddr, string>::const_iterator last_delta = end_delta;
+    --last_delta;
+    last_delta_address = last_delta->first;
+  }
+  CFIFrameInfo* cached_rules =
+      cfi_frame_info_cache_.Find(initial_base, last_delta_address);
+  if (cached_rules)
+    return cached_rules;
+
   // Create a frame info structure, and populate it with the rules from
   // the STACK CFI INIT record.
   scoped_ptr<CFIFrameInfo> rules(new CFIFrameInfo());
   if (!ParseCFIRuleSet(initial_rules, rules.get()))
     return NULL;
 
-  // Find the first delta rule that falls within the initial rule's range.
-  map<MemAddr, string>::const_iterator delta =
-    cfi_delta_rules_.lower_bound(initial_base);
-
   // Apply delta rules up to and including the frame's address.
-  while (delta != cfi_delta_rules_.end() && delta->first <= address) {
+  for (map<MemAddr, string>::const_iterator delta = first_delta;
+       delta != end_delta; ++delta) {
     ParseCFIRuleSet(delta->second, rules.get());
-    delta++;
   }
 
+  cfi_frame_info_cache_.Insert(initial_base, last_delta_address, *rules);
   return rules.release();
 }
 
-bool BasicSourceLineResolver::Module::ParseFile(char* file_line) {
+void BasicSourceLineResolver::Module::GetFootprint(
+    SymbolFootprint* footprint) const {
+  *footprint = SymbolFootprint();
+
+  // A RangeMap node is keyed by its range's high address, and holds its
+  // base, delta and entry; a ContainedRangeMap node is keyed the same way,
+  // and points to a child map holding the rest.
+  const size_t kRangeNodeOverhead = kMapNodeOverhead + 3 * sizeof(MemAddr);
+  const size_t kInlineNode = kMapNodeOverhead + sizeof(MemAddr) +
+      sizeof(void*) + sizeof(ContainedRangeMap<MemAddr, linked_ptr<Inline>>) +
+      sizeof(Inline);
+  functions_.VisitEntries([&](const linked_ptr<Function>& function) {
+    footprint->functions += kRangeNodeOverhead +
+        sizeof(linked_ptr<Function>) + sizeof(Function);
+    footprint->lines +=
+        function->lines.GetCount() * (kRangeNodeOverhead + sizeof(Line));
+    function->inlines.VisitEntries([&](const linked_ptr<Inline>& in) {
+      footprint->inlines += kInlineNode + in->inline_ranges.capacity() *
+          sizeof(Inline::InlineRanges::value_type);
+    });
+    footprint->inlines +=
+        function->inline_segments.capacity() *
+            sizeof(Function::InlineSegment) +
+        function->inline_frames.capacity() * sizeof(Function::InlineFrame);
+  });
+  footprint->functions += function_index_.MemoryBytes() +
+      lazy_functions_.capacity() * sizeof(linked_ptr<Function>);
+  footprint->inlines += inline_origins_.size() *
+      (kMapNodeOverhead + sizeof(int) + sizeof(linked_ptr<InlineOrigin>) +
+       sizeof(InlineOrigin));
+
+  footprint->public_symbols = public_symbols_.GetCount() *
+      (kMapNodeOverhead + sizeof(MemAddr) + sizeof(linked_ptr<PublicSymbol>) +
+       sizeof(PublicSymbol));
+
+  const size_t kWindowsFrameInfoNode = kMapNodeOverhead + sizeof(MemAddr) +
+      sizeof(void*) +
+      sizeof(ContainedRangeMap<MemAddr, linked_ptr<WindowsFrameInfo>>) +
+      sizeof(WindowsFrameInfo);
+  for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i) {
+    windows_frame_info_[i].VisitEntries(
+        [&](const linked_ptr<WindowsFrameInfo>& info) {
+          footprint->windows_frame_info += kWindowsFrameInfoNode +
+              StringHeapBytes(info->program_string);
+        });
+    footprint->windows_frame_info += flat_windows_frame_info_[i].MemoryBytes();
+  }
+
+  cfi_initial_rules_.VisitEntries([&](const string& rules) {
+    footprint->cfi +=
+        kRangeNodeOverhead + sizeof(string) + StringHeapBytes(rules);
+  });
+  for (map<MemAddr, string>::const_iterator delta = cfi_delta_rules_.begin();
+       delta != cfi_delta_rules_.end(); ++delta) {
+    footprint->cfi += kMapNodeOverhead + sizeof(MemAddr) + sizeof(string) +
+        StringHeapBytes(delta->second);
+  }
+
+  // Names interned more than once are held once.
+  std::set<const char*> names(interned_strings_.begin(),
+                              interned_strings_.end());
+  for (std::set<const char*>::const_iterator name = names.begin();
+       name != names.end(); ++name) {
+    footprint->strings += strlen(*name) + 1;
+  }
+  footprint->strings +=
+      interned_strings_.capacity() * sizeof(const char*) +
+      files_.size() * (kMapNodeOverhead + sizeof(FileMap::value_type));
+}
+
+bool BasicSourceLineResolver::Module::ParseFile(char* file_line,
+                                               RecordSink* sink) const {
   long index;
   char* filename;
   if (SymbolParseHelper::ParseFile(file_line, &index, &filename)) {
-    files_.insert(make_pair(index, string(filename)));
+    sink->AddFile(index, filename);
     return true;
   }
   return false;
 }
 
 bool BasicSourceLineResolver::Module::ParseInlineOrigin(
-  char* inline_origin_line) {
+  char* inline_origin_line, RecordSink* sink) const {
   bool has_file_id;
   long origin_id;
-  long source_file_id;
+  // Left alone for origins without a file id; keep what is serialized for
+  // them deterministic.
+  long source_file_id = -1;
   char* origin_name;
   if (SymbolParseHelper::ParseInlineOrigin(inline_origin_line, &has_file_id,
                                            &origin_id, &source_file_id,
                                            &origin_name)) {
-    inline_origins_.insert(make_pair(
+    sink->AddInlineOrigin(
         origin_id,
-        new InlineOrigin(has_file_id, source_file_id, origin_name)));
+        linked_ptr<InlineOrigin>(
+            new InlineOrigin(has_file_id, source_file_id, origin_name)));
     return true;
   }
   return false;
 }
 
 linked_ptr<BasicSourceLineResolver::Inline>
-BasicSourceLineResolver::Module::ParseInline(char* inline_line) {
+BasicSourceLineResolver::Module::ParseInline(char* inline_line) const {
   bool has_call_site_file_id;
   long inline_nest_level;
   long call_site_line;
@@ -473,7 +1249,7 @@ BasicSourceLineResolver::Module::ParseInline(char* inline_line) {
 }
 
 BasicSourceLineResolver::Function*
-BasicSourceLineResolver::Module::ParseFunction(char* function_line) {
+BasicSourceLineResolver::Module::ParseFunction(char* function_line) const {
   bool is_multiple;
   uint64_t address;
   uint64_t size;
@@ -486,8 +1262,33 @@ BasicSourceLineResolver::Module::ParseFunction(char* function_line) {
   return NULL;
 }
 
-BasicSourceLineResolver::Line* BasicSourceLineResolver::Module::ParseLine(
-    char* line_line) {
+BasicSourceLineResolver::Function*
+BasicSourceLineResolver::Module::ParseIndexedFunction(char* index_line) const {
+  // INFO INDEX <offset> <length> <FUNC record>
+  assert(strncmp(index_line, "INFO INDEX ", 11) == 0);
+  index_line += 11;  // skip prefix
+
+  vector<char*> tokens;
+  if (!Tokenize(index_line, kWhitespace, 3, &tokens) ||
+      strncmp(tokens[2], "FUNC ", 5) != 0) {
+    return NULL;
+  }
+  uint64_t offset;
+  uint64_t length;
+  if (!ParseHexField(tokens[0], &offset) ||
+      !ParseHexField(tokens[1], &length)) {
+    return NULL;
+  }
+  Function* function = ParseFunction(tokens[2]);
+  if (function) {
+    function->indexed_records_offset = offset;
+    function->indexed_records_length = length;
+  }
+  return function;
+}
+
+bool BasicSourceLineResolver::Module::ParseLine(char* line_line,
+                                               Line* line) const {
   uint64_t address;
   uint64_t size;
   long line_number;
@@ -495,12 +1296,14 @@ BasicSourceLineResolver::Line* BasicSourceLineResolver::Module::ParseLine(
 
   if (SymbolParseHelper::ParseLine(line_line, &address, &size, &line_number,
                                    &source_file)) {
-    return new Line(address, size, source_file, line_number);
+    *line = Line(address, size, source_file, line_number);
+    return true;
   }
-  return NULL;
+  return false;
 }
 
-bool BasicSourceLineResolver::Module::ParsePublicSymbol(char* public_line) {
+bool BasicSourceLineResolver::Module::ParsePublicSymbol(
+    char* public_line, int line_number, RecordSink* sink) const {
   bool is_multiple;
   uint64_t address;
   long stack_param_size;
@@ -521,12 +1324,13 @@ bool BasicSourceLineResolver::Module::ParsePublicSymbol(char* public_line) {
     linked_ptr<PublicSymbol> symbol(new PublicSymbol(name, address,
                                                      stack_param_size,
                                                      is_multiple));
-    return public_symbols_.Store(address, symbol);
+    return sink->AddPublicSymbol(symbol, line_number);
   }
   return false;
 }
 
-bool BasicSourceLineResolver::Module::ParseStackInfo(char* stack_info_line) {
+bool BasicSourceLineResolver::Module::ParseStackInfo(char* stack_info_line,
+                                                    RecordSink* sink) const {
   // Skip "STACK " prefix.
   stack_info_line += 6;
 
@@ -571,11 +1375,11 @@ bool BasicSourceLineResolver::Module::ParseStackInfo(char* stack_info_line) {
     // if ContainedRangeMap were modified to allow replacement of
     // already-stored values.
 
-    windows_frame_info_[type].StoreRange(rva, code_size, stack_frame_info);
+    sink->AddWindowsFrameInfo(type, rva, code_size, stack_frame_info);
     return true;
   } else if (strcmp(platform, "CFI") == 0) {
     // DWARF CFI stack frame info
-    return ParseCFIFrameInfo(stack_info_line);
+    return ParseCFIFrameInfo(stack_info_line, sink);
   } else {
     // Something unrecognized.
     return false;
@@ -583,7 +1387,7 @@ bool BasicSourceLineResolver::Module::ParseStackInfo(char* stack_info_line) {
 }
 
 bool BasicSourceLineResolver::Module::ParseCFIFrameInfo(
-    char* stack_info_line) {
+    char* stack_info_line, RecordSink* sink) const {
   char* cursor;
 
   // Is this an INIT record or a delta record?
@@ -602,9 +1406,13 @@ bool BasicSourceLineResolver::Module::ParseCFIFrameInfo(
     char* initial_rules = strtok_r(NULL, "\r\n", &cursor);
     if (!initial_rules) return false;
 
-    MemAddr address = strtoul(address_field, NULL, 16);
-    MemAddr size    = strtoul(size_field,    NULL, 16);
-    cfi_initial_rules_.StoreRange(address, size, initial_rules);
+    MemAddr address;
+    MemAddr size;
+    if (!ParseHexField(address_field, &address) ||
+        !ParseHexField(size_field, &size)) {
+      return false;
+    }
+    sink->AddCFIInitialRules(address, size, initial_rules);
     return true;
   }
 
@@ -612,8 +1420,9 @@ bool BasicSourceLineResolver::Module::ParseCFIFrameInfo(
   char* address_field = init_or_address;
   char* delta_rules = strtok_r(NULL, "\r\n", &cursor);
   if (!delta_rules) return false;
-  MemAddr address = strtoul(address_field, NULL, 16);
-  cfi_delta_rules_[address] = delta_rules;
+  MemAddr address;
+  if (!ParseHexField(address_field, &address)) return false;
+  sink->AddCFIDeltaRules(address, delta_rules);
   return true;
 }
 
@@ -637,15 +1446,13 @@ bool SymbolParseHelper::ParseFile(char* file_line, long* index,
   assert(strncmp(file_line, "FILE ", 5) == 0);
   file_line += 5;  // skip prefix
 
-  vector<char*> tokens;
-  if (!Tokenize(file_line, kWhitespace, 2, &tokens)) {
+  char* tokens[2];
+  int num_tokens;
+  if (!Tokenize(file_line, kWhitespace, 2, tokens, &num_tokens)) {
     return false;
   }
 
-  char* after_number;
-  *index = strtol(tokens[0], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *index < 0 ||
-      *index == std::numeric_limits<long>::max()) {
+  if (!ParseDecimalField(tokens[0], index) || *index < 0) {
     return false;
   }
 
@@ -669,18 +1476,16 @@ bool SymbolParseHelper::ParseInlineOrigin(char* inline_origin_line,
   // INLINE_ORIGIN <origin_id> <name>
   assert(strncmp(inline_origin_line, "INLINE_ORIGIN ", 14) == 0);
   inline_origin_line += 14;  // skip prefix
-  vector<char*> tokens;
+  char* tokens[2];
+  int num_tokens;
   // Split the line into two parts so that the first token is "<origin_id>", and
   // second token is either "<file_id> <name>"" or "<name>"" depending on the
   // format version.
-  if (!Tokenize(inline_origin_line, kWhitespace, 2, &tokens)) {
+  if (!Tokenize(inline_origin_line, kWhitespace, 2, tokens, &num_tokens)) {
     return false;
   }
 
-  char* after_number;
-  *origin_id = strtol(tokens[0], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *origin_id < 0 ||
-      *origin_id == std::numeric_limits<long>::max()) {
+  if (!ParseDecimalField(tokens[0], origin_id) || *origin_id < 0) {
     return false;
   }
 
@@ -700,14 +1505,12 @@ bool SymbolParseHelper::ParseInlineOrigin(char* inline_origin_line,
 
   if (*has_file_id) {
     // If it's old format, split "<file_id> <name>" to {"<field_id>", "<name>"}.
-    if (!Tokenize(remaining_line, kWhitespace, 2, &tokens)) {
+    if (!Tokenize(remaining_line, kWhitespace, 2, tokens, &num_tokens)) {
       return false;
     }
-    *file_id = strtol(tokens[0], &after_number, 10);
     // If the file id is -1, it might be an artificial function that doesn't
     // have file id. So, we consider -1 as a valid special case.
-    if (!IsValidAfterNumber(after_number) || *file_id < -1 ||
-        *file_id == std::numeric_limits<long>::max()) {
+    if (!ParseDecimalField(tokens[0], file_id) || *file_id < -1) {
       return false;
     }
   }
@@ -737,58 +1540,49 @@ bool SymbolParseHelper::ParseInline(
   assert(strncmp(inline_line, "INLINE ", 7) == 0);
   inline_line += 7; // skip prefix
 
-  vector<char*> tokens;
-  // Increase max_tokens if necessary.
-  Tokenize(inline_line, kWhitespace, 512, &tokens);
+  // Increase kMaxInlineTokens if necessary.
+  char* tokens[kMaxInlineTokens];
+  int num_tokens;
+  Tokenize(inline_line, kWhitespace, kMaxInlineTokens, tokens, &num_tokens);
 
-  // Determine the version of INLINE record by parity of the vector length.
-  *has_call_site_file_id = tokens.size() % 2 == 0;
+  // Determine the version of INLINE record by parity of the token count.
+  *has_call_site_file_id = num_tokens % 2 == 0;
 
-  // The length of the vector should be at least 5.
-  if (tokens.size() < 5) {
+  // The number of tokens should be at least 5.
+  if (num_tokens < 5) {
     return false;
   }
 
-  char* after_number;
-  size_t next_idx = 0;
+  int next_idx = 0;
 
-  *inline_nest_level = strtol(tokens[next_idx++], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *inline_nest_level < 0 ||
-      *inline_nest_level == std::numeric_limits<long>::max()) {
+  if (!ParseDecimalField(tokens[next_idx++], inline_nest_level) ||
+      *inline_nest_level < 0) {
     return false;
   }
 
-  *call_site_line = strtol(tokens[next_idx++], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *call_site_line < 0 ||
-      *call_site_line == std::numeric_limits<long>::max()) {
+  if (!ParseDecimalField(tokens[next_idx++], call_site_line) ||
+      *call_site_line < 0) {
     return false;
   }
 
   if (*has_call_site_file_id) {
-    *call_site_file_id = strtol(tokens[next_idx++], &after_number, 10);
     // If the file id is -1, it might be an artificial function that doesn't
     // have file id. So, we consider -1 as a valid special case.
-    if (!IsValidAfterNumber(after_number) || *call_site_file_id < -1 ||
-        *call_site_file_id == std::numeric_limits<long>::max()) {
+    if (!ParseDecimalField(tokens[next_idx++], call_site_file_id) ||
+        *call_site_file_id < -1) {
       return false;
     }
   }
 
-  *origin_id = strtol(tokens[next_idx++], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *origin_id < 0 ||
-      *origin_id == std::numeric_limits<long>::max()) {
+  if (!ParseDecimalField(tokens[next_idx++], origin_id) || *origin_id < 0) {
     return false;
   }
 
-  while (next_idx < tokens.size()) {
-    MemAddr address = strtoull(tokens[next_idx++], &after_number, 16);
-    if (!IsValidAfterNumber(after_number) ||
-        address == std::numeric_limits<unsigned long long>::max()) {
-      return false;
-    }
-    MemAddr size = strtoull(tokens[next_idx++], &after_number, 16);
-    if (!IsValidAfterNumber(after_number) ||
-        size == std::numeric_limits<unsigned long long>::max()) {
+  while (next_idx < num_tokens) {
+    MemAddr address;
+    MemAddr size;
+    if (!ParseHexField(tokens[next_idx++], &address) ||
+        !ParseHexField(tokens[next_idx++], &size)) {
       return false;
     }
     ranges->push_back({address, size});
@@ -805,29 +1599,23 @@ bool SymbolParseHelper::ParseFunction(char* function_line, bool* is_multiple,
   assert(strncmp(function_line, "FUNC ", 5) == 0);
   function_line += 5;  // skip prefix
 
-  vector<char*> tokens;
-  if (!TokenizeWithOptionalField(function_line, "m", kWhitespace, 5, &tokens)) {
+  char* tokens[5];
+  int num_tokens;
+  if (!TokenizeWithOptionalField(function_line, "m", kWhitespace, 5, tokens,
+                                 &num_tokens)) {
     return false;
   }
 
   *is_multiple = strcmp(tokens[0], "m") == 0;
   int next_token = *is_multiple ? 1 : 0;
 
-  char* after_number;
-  *address = strtoull(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *address == std::numeric_limits<unsigned long long>::max()) {
+  if (!ParseHexField(tokens[next_token++], address)) {
     return false;
   }
-  *size = strtoull(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *size == std::numeric_limits<unsigned long long>::max()) {
+  if (!ParseHexField(tokens[next_token++], size)) {
     return false;
   }
-  *stack_param_size = strtol(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *stack_param_size == std::numeric_limits<long>::max() ||
-      *stack_param_size < 0) {
+  if (!ParseHexField(tokens[next_token++], stack_param_size)) {
     return false;
   }
   *name = tokens[next_token++];
@@ -840,30 +1628,22 @@ bool SymbolParseHelper::ParseLine(char* line_line, uint64_t* address,
                                   uint64_t* size, long* line_number,
                                   long* source_file) {
   // <address> <size> <line number> <source file id>
-  vector<char*> tokens;
-  if (!Tokenize(line_line, kWhitespace, 4, &tokens)) {
+  char* tokens[4];
+  int num_tokens;
+  if (!Tokenize(line_line, kWhitespace, 4, tokens, &num_tokens)) {
     return false;
   }
 
-  char* after_number;
-  *address  = strtoull(tokens[0], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *address == std::numeric_limits<unsigned long long>::max()) {
+  if (!ParseHexField(tokens[0], address)) {
     return false;
   }
-  *size = strtoull(tokens[1], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *size == std::numeric_limits<unsigned long long>::max()) {
+  if (!ParseHexField(tokens[1], size)) {
     return false;
   }
-  *line_number = strtol(tokens[2], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) ||
-      *line_number == std::numeric_limits<long>::max()) {
+  if (!ParseDecimalField(tokens[2], line_number)) {
     return false;
   }
-  *source_file = strtol(tokens[3], &after_number, 10);
-  if (!IsValidAfterNumber(after_number) || *source_file < 0 ||
-      *source_file == std::numeric_limits<long>::max()) {
+  if (!ParseDecimalField(tokens[3], source_file) || *source_file < 0) {
     return false;
   }
 
@@ -889,24 +1669,20 @@ bool SymbolParseHelper::ParsePublicSymbol(char* public_line, bool* is_multiple,
   assert(strncmp(public_line, "PUBLIC ", 7) == 0);
   public_line += 7;  // skip prefix
 
-  vector<char*> tokens;
-  if (!TokenizeWithOptionalField(public_line, "m", kWhitespace, 4, &tokens)) {
+  char* tokens[4];
+  int num_tokens;
+  if (!TokenizeWithOptionalField(public_line, "m", kWhitespace, 4, tokens,
+                                 &num_tokens)) {
     return false;
   }
 
   *is_multiple = strcmp(tokens[0], "m") == 0;
   int next_token = *is_multiple ? 1 : 0;
 
-  char* after_number;
-  *address = strtoull(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *address == std::numeric_limits<unsigned long long>::max()) {
+  if (!ParseHexField(tokens[next_token++], address)) {
     return false;
   }
-  *stack_param_size = strtol(tokens[next_token++], &after_number, 16);
-  if (!IsValidAfterNumber(after_number) ||
-      *stack_param_size == std::numeric_limits<long>::max() ||
-      *stack_param_size < 0) {
+  if (!ParseHexField(tokens[next_token++], stack_param_size)) {
     return false;
   }
   *name = tokens[next_token++];
@@ -914,12 +1690,4 @@ bool SymbolParseHelper::ParsePublicSymbol(char* public_line, bool* is_multiple,
   return true;
 }
 
-// static
-bool SymbolParseHelper::IsValidAfterNumber(char* after_number) {
-  if (after_number != NULL && strchr(kWhitespace, *after_number) != NULL) {
-    return true;
-  }
-  return false;
-}
-
 }  // namespace google_breakpad
@@ -39,6 +39,8 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/scoped_ptr.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
@@ -46,18 +48,20 @@
 
 #include "processor/address_map-inl.h"
 #include "processor/range_map-inl.h"
+#include "processor/range_map_page_index-inl.h"
 #include "processor/contained_range_map-inl.h"
 
 #include "processor/linked_ptr.h"
 #include "google_breakpad/processor/stack_frame.h"
 #include "processor/cfi_frame_info.h"
+#include "processor/string_pool.h"
 #include "processor/windows_frame_info.h"
 
 namespace google_breakpad {
 
 struct
 BasicSourceLineResolver::Function : public SourceLineResolverBase::Function {
-  Function(const string& function_name,
+  Function(const char* function_name,
            MemAddr function_address,
            MemAddr code_size,
            int set_parameter_size,
@@ -68,6 +72,11 @@ BasicSourceLineResolver::Function : public SourceLineResolverBase::Function {
              set_parameter_size,
              is_mutiple),
         inlines(true),
+        pending_records(NULL),
+        pending_records_end(NULL),
+        indexed_records_offset(0),
+        indexed_records_length(0),
+        inline_table_built(false),
         last_added_inline_nest_level(0) {}
 
   // Append inline into corresponding RangeMap.
@@ -75,7 +84,49 @@ BasicSourceLineResolver::Function : public SourceLineResolverBase::Function {
   bool AppendInline(linked_ptr<Inline> in);
 
   ContainedRangeMap<MemAddr, linked_ptr<Inline>> inlines;
-  RangeMap<MemAddr, linked_ptr<Line>> lines;
+  // Lines are stored by value: a large module holds millions of them, and
+  // keeping each in its own heap block dominated load time and memory use.
+  RangeMap<MemAddr, Line> lines;
+
+  // When loading lazily, the LINE and INLINE records that follow the FUNC
+  // record, not yet parsed: NUL-separated text in the symbol data from
+  // pending_records up to pending_records_end.  NULL once they are parsed.
+  char* pending_records;
+  char* pending_records_end;
+
+  // For a function taken from an address index, where its LINE and INLINE
+  // records lie in the symbol file, to be fetched when an address in it is
+  // first looked up.  The length is zero once they are fetched, or if
+  // there are none.
+  uint64_t indexed_records_offset;
+  uint64_t indexed_records_length;
+
+  // An inlined frame as ConstructInlineFrames builds it, with the names
+  // it takes from the module's maps already looked up.
+  struct InlineFrame {
+    const char* function_name;
+    // NULL if the INLINE record has no call site file, or it's unknown.
+    const char* call_site_file_name;
+    int32_t call_site_line;
+    // The start of the inline's range, relative to the module.
+    MemAddr function_base;
+  };
+
+  // Where the same inlines are active, from |address| up to |end|, and
+  // their frames, inline_frames[first_frame] being the innermost.
+  struct InlineSegment {
+    MemAddr address;
+    MemAddr end;
+    uint32_t first_frame;
+    uint32_t frame_count;
+  };
+
+  // |inlines| flattened into segments sorted by address, built the first
+  // time an address in the function is looked up, so that expanding a
+  // frame's inlines takes a binary search and no map lookups.
+  std::vector<InlineSegment> inline_segments;
+  std::vector<InlineFrame> inline_frames;
+  bool inline_table_built;
 
  private:
   typedef SourceLineResolverBase::Function Base;
@@ -87,8 +138,30 @@ BasicSourceLineResolver::Function : public SourceLineResolverBase::Function {
 
 class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
  public:
-  explicit Module(const string& name) : name_(name), is_corrupt_(false) { }
-  virtual ~Module() { }
+  // Names are interned in |string_pool|, which must outlive the module; if
+  // it is NULL, the module uses a pool of its own.
+  explicit Module(const string& name, int num_load_threads = 1,
+                  StringPool* string_pool = NULL)
+      : name_(name), is_corrupt_(false), num_load_threads_(num_load_threads),
+        load_lines_lazily_(false), record_fetcher_(NULL),
+        own_string_pool_(string_pool ? NULL : new StringPool),
+        string_pool_(string_pool ? string_pool : own_string_pool_.get()) { }
+  virtual ~Module();
+
+  // If |load_lines_lazily| is true, LoadMapFromMemory() leaves each
+  // function's LINE and INLINE records in the buffer, to be parsed when an
+  // address in the function is first looked up.
+  void set_load_lines_lazily(bool load_lines_lazily) {
+    load_lines_lazily_ = load_lines_lazily;
+  }
+
+  // If |record_fetcher| is not NULL, and lines are loaded lazily,
+  // LoadMapFromMemory() takes the functions an address index lists, and
+  // their LINE and INLINE records are fetched from |record_fetcher|.
+  void set_record_fetcher(BasicSourceLineResolver::RecordFetcher*
+                              record_fetcher) {
+    record_fetcher_ = record_fetcher;
+  }
 
   // Loads a map from the given buffer in char* type.
   // Does NOT have ownership of memory_buffer.
@@ -115,9 +188,17 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   virtual void ConstructInlineFrames(
       StackFrame* frame,
       MemAddr address,
-      const ContainedRangeMap<uint64_t, linked_ptr<Inline>>& inline_map,
+      Function* function,
       std::deque<std::unique_ptr<StackFrame>>* inline_frames) const;
 
+  // Symbolizes the |count| module-relative addresses in |addresses|, which
+  // are sorted, into |results|: each address's result goes to the element
+  // its second member indexes.
+  void SymbolizeSortedAddresses(
+      const std::pair<MemAddr, size_t>* addresses,
+      size_t count,
+      SymbolizedAddress* results) const;
+
   // If Windows stack walking information is available covering ADDRESS,
   // return a WindowsFrameInfo structure describing it. If the information
   // is not available, returns NULL. A NULL return value does not indicate
@@ -131,13 +212,26 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   // returned CFIFrameInfo object.
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame) const;
 
+  // Sets |footprint| to an estimate of the heap the loaded symbols take up,
+  // from the number of entries in each map and the sizes of their nodes.
+  // Records still waiting to be parsed lazily aren't counted.
+  virtual void GetFootprint(SymbolFootprint* footprint) const;
+
  private:
   // Friend declarations.
   friend class BasicSourceLineResolver;
   friend class ModuleComparer;
   friend class ModuleSerializer;
 
-  typedef std::map<int, string> FileMap;
+  typedef std::map<int, const char*> FileMap;
+
+  // Receives the records parsed from a symbol file.  When loading on a
+  // single thread, records go straight into the module's maps; when loading
+  // in parallel, each chunk's records are collected and stored into the
+  // module in file order once every chunk has been parsed.
+  class RecordSink;
+  class ModuleRecordSink;
+  class ChunkRecordSink;
 
   // Logs parse errors.  |*num_errors| is increased every time LogParseError is
   // called.
@@ -146,39 +240,120 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
       int line_number,
       int* num_errors);
 
+  // Parses the null-terminated, newline-separated records in |buffer|,
+  // passing them to |sink|.  |line_number| is the number of lines that
+  // precede |buffer| in the symbol file.  Errors are counted in |*num_errors|
+  // and, for INLINE and INLINE_ORIGIN records, in |*inline_num_errors|.
+  void ParseRecords(char* buffer,
+                    int line_number,
+                    RecordSink* sink,
+                    int* num_errors,
+                    int* inline_num_errors) const;
+
+  // Splits the null-terminated |buffer| into chunks of roughly equal size
+  // for parallel parsing, null-terminates each chunk in place, and stores
+  // the start of each chunk in |chunks|.  Chunks begin only at FUNC, PUBLIC
+  // or STACK records, so a function's LINE and INLINE records stay together.
+  static void SplitIntoChunks(char* buffer,
+                              size_t buffer_size,
+                              size_t max_chunks,
+                              std::vector<char*>* chunks);
+
+  // Parses |buffer| on num_load_threads_ threads and stores the results.
+  void LoadChunksInParallel(char* buffer,
+                            size_t buffer_size,
+                            int* num_errors,
+                            int* inline_num_errors);
+
+  // Parses the LINE and INLINE records deferred for |function|.
+  void LoadFunctionRecords(Function* function) const;
+
+  // Fills in |function|'s inline_segments and inline_frames.
+  void BuildInlineTable(Function* function) const;
+
+  // Fetches and parses the LINE and INLINE records of |function|, which
+  // came from an address index.
+  void FetchFunctionRecords(Function* function) const;
+
+  // Parses the records still deferred for every function, for callers that
+  // need the whole module, like ModuleSerializer.
+  void LoadAllFunctionRecords() const;
+
+  // Finds the function containing |address| or, failing that, the nearest
+  // one below it, as functions_.RetrieveNearestRange does.
+  bool FindNearestFunction(MemAddr address,
+                           linked_ptr<Function>* function,
+                           MemAddr* function_base,
+                           MemAddr* function_size) const;
+
+  // Parses an 'INFO INDEX' record of an address index, returning a new
+  // Function object whose records are to be fetched.
+  Function* ParseIndexedFunction(char* index_line) const;
+
   // Parses a file declaration
-  bool ParseFile(char* file_line);
+  bool ParseFile(char* file_line, RecordSink* sink) const;
 
   // Parses an inline origin declaration.
-  bool ParseInlineOrigin(char* inline_origin_line);
+  bool ParseInlineOrigin(char* inline_origin_line, RecordSink* sink) const;
 
   // Parses an inline declaration.
-  linked_ptr<Inline> ParseInline(char* inline_line);
+  linked_ptr<Inline> ParseInline(char* inline_line) const;
 
   // Parses a function declaration, returning a new Function object.
-  Function* ParseFunction(char* function_line);
+  Function* ParseFunction(char* function_line) const;
 
-  // Parses a line declaration, returning a new Line object.
-  Line* ParseLine(char* line_line);
+  // Parses a line declaration into |*line|.  Returns false if an error
+  // occurs.
+  bool ParseLine(char* line_line, Line* line) const;
 
-  // Parses a PUBLIC symbol declaration, storing it in public_symbols_.
+  // Parses a PUBLIC symbol declaration, passing it to |sink|.
+  // |line_number| identifies the record in errors reported later.
   // Returns false if an error occurs.
-  bool ParsePublicSymbol(char* public_line);
+  bool ParsePublicSymbol(char* public_line,
+                         int line_number,
+                         RecordSink* sink) const;
 
-  // Parses a STACK WIN or STACK CFI frame info declaration, storing
-  // it in the appropriate table.
-  bool ParseStackInfo(char* stack_info_line);
+  // Parses a STACK WIN or STACK CFI frame info declaration, passing
+  // it to |sink|.
+  bool ParseStackInfo(char* stack_info_line, RecordSink* sink) const;
 
-  // Parses a STACK CFI record, storing it in cfi_frame_info_.
-  bool ParseCFIFrameInfo(char* stack_info_line);
+  // Parses a STACK CFI record, passing it to |sink|.
+  bool ParseCFIFrameInfo(char* stack_info_line, RecordSink* sink) const;
 
   string name_;
   FileMap files_;
   std::map<int, linked_ptr<InlineOrigin>> inline_origins_;
   RangeMap< MemAddr, linked_ptr<Function> > functions_;
   AddressMap< MemAddr, linked_ptr<PublicSymbol> > public_symbols_;
+
+  // A page table over functions_ for FindNearestFunction, built once the
+  // module is loaded if it has enough functions to make it worthwhile
+  // (see range_map_page_index.h).
+  RangeMapPageIndex< MemAddr, linked_ptr<Function> > function_index_;
   bool is_corrupt_;
 
+  // The number of threads LoadMapFromMemory may use.
+  int num_load_threads_;
+
+  // Whether LoadMapFromMemory defers LINE and INLINE records, and the
+  // functions that may still have records deferred.
+  bool load_lines_lazily_;
+  mutable std::vector<linked_ptr<Function>> lazy_functions_;
+
+  // Where the records of functions taken from an address index are
+  // fetched from, or NULL to ignore address indexes.
+  BasicSourceLineResolver::RecordFetcher* record_fetcher_;
+
+  // Returns the pool's copy of |str|, to be released when the module is
+  // destroyed.
+  const char* Intern(const char* str);
+
+  // Where the names this module points to are kept, and the names it has
+  // interned there.
+  scoped_ptr<StringPool> own_string_pool_;
+  StringPool* string_pool_;
+  std::vector<const char*> interned_strings_;
+
   // Each element in the array is a ContainedRangeMap for a type
   // listed in WindowsFrameInfoTypes. These are split by type because
   // there may be overlaps between maps of different types, but some
@@ -186,6 +361,11 @@ class BasicSourceLineResolver::Module : public SourceLineResolverBase::Module {
   ContainedRangeMap< MemAddr, linked_ptr<WindowsFrameInfo> >
     windows_frame_info_[WindowsFrameInfo::STACK_INFO_LAST];
 
+  // windows_frame_info_, flattened once the module is loaded, for
+  // FindWindowsFrameInfo to search (see flat_contained_range_map.h).
+  FlatContainedRangeMap< MemAddr, linked_ptr<WindowsFrameInfo> >
+    flat_windows_frame_info_[WindowsFrameInfo::STACK_INFO_LAST];
+
   // DWARF CFI stack walking data. The Module stores the initial rule sets
   // and rule deltas as strings, just as they appear in the symbol file:
   // although the file may contain hundreds of thousands of STACK CFI
@@ -29,11 +29,16 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "breakpad_googletest_includes.h"
 #include "common/scoped_ptr.h"
+#include "common/tests/auto_tempdir.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "google_breakpad/processor/code_module.h"
@@ -46,10 +51,12 @@
 
 namespace {
 
+using google_breakpad::AutoTempDir;
 using google_breakpad::BasicSourceLineResolver;
 using google_breakpad::CFIFrameInfo;
 using google_breakpad::CodeModule;
 using google_breakpad::MemoryRegion;
+using google_breakpad::SourceLineResolverBase;
 using google_breakpad::StackFrame;
 using google_breakpad::WindowsFrameInfo;
 using google_breakpad::linked_ptr;
@@ -413,6 +420,70 @@ TEST_F(TestBasicSourceLineResolver, TestUnload)
   ASSERT_TRUE(resolver.HasModule(&module1));
 }
 
+TEST_F(TestBasicSourceLineResolver, TestModuleCacheBudget) {
+  const string symbols = "FUNC 1000 10 0 Function\n";
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  TestCodeModule module3("module3");
+
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module1, symbols));
+  const uint64_t module_size = resolver.GetModuleCacheStats().resident_bytes;
+  ASSERT_GT(module_size, 0U);
+  resolver.SetModuleCacheBudget(2 * module_size);
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module2, symbols));
+  EXPECT_EQ(0U, resolver.GetModuleCacheStats().evictions);
+
+  // Using module1 leaves module2 as the least recently used.
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module3, symbols));
+  SourceLineResolverBase::ModuleCacheStats stats =
+      resolver.GetModuleCacheStats();
+  EXPECT_EQ(1U, stats.evictions);
+  EXPECT_EQ(2U, stats.resident_modules);
+  EXPECT_EQ(2 * module_size, stats.resident_bytes);
+  EXPECT_EQ(1U, stats.hits);
+  EXPECT_EQ(0U, stats.misses);
+  ASSERT_FALSE(resolver.HasModule(&module2));
+  ASSERT_TRUE(resolver.HasModule(&module3));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  stats = resolver.GetModuleCacheStats();
+  EXPECT_EQ(3U, stats.hits);
+  EXPECT_EQ(1U, stats.misses);
+
+  // A pinned module stays even when it is the least recently used.
+  ASSERT_TRUE(resolver.PinModule(&module1));
+  ASSERT_FALSE(resolver.PinModule(&module2));
+  ASSERT_TRUE(resolver.HasModule(&module3));
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module2, symbols));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  ASSERT_TRUE(resolver.HasModule(&module2));
+  ASSERT_FALSE(resolver.HasModule(&module3));
+
+  // Lowering the budget evicts straight away, but still spares pinned
+  // modules.
+  resolver.SetModuleCacheBudget(module_size);
+  ASSERT_FALSE(resolver.HasModule(&module2));
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  stats = resolver.GetModuleCacheStats();
+  EXPECT_EQ(3U, stats.evictions);
+  EXPECT_EQ(1U, stats.resident_modules);
+  EXPECT_EQ(module_size, stats.resident_bytes);
+
+  // Once unpinned, a module can be evicted again.
+  resolver.UnpinModule(&module1);
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module3, symbols));
+  ASSERT_FALSE(resolver.HasModule(&module1));
+  ASSERT_TRUE(resolver.HasModule(&module3));
+  EXPECT_EQ(4U, resolver.GetModuleCacheStats().evictions);
+
+  // Explicit unloads are not evictions.
+  resolver.UnloadModule(&module3);
+  stats = resolver.GetModuleCacheStats();
+  EXPECT_EQ(4U, stats.evictions);
+  EXPECT_EQ(0U, stats.resident_modules);
+  EXPECT_EQ(0U, stats.resident_bytes);
+}
+
 TEST_F(TestBasicSourceLineResolver, TestLoadAndResolveOldInlines) {
   TestCodeModule module("linux_inline");
   ASSERT_TRUE(resolver.LoadModule(
@@ -501,6 +572,426 @@ TEST_F(TestBasicSourceLineResolver, TestLoadAndResolveNewInlines) {
   ASSERT_EQ(inlined_frames[0]->trust, StackFrame::FRAME_TRUST_INLINE);
 }
 
+// Inlines nested in more than one range should expand the same way at
+// every address, including those at the ends of each range.
+TEST_F(TestBasicSourceLineResolver, TestInlineRangeBoundaries) {
+  string symbols =
+      "MODULE Linux x86_64 000000000000000000000000000000000 inlines\n"
+      "FILE 0 outer.cc\n"
+      "FILE 1 a.h\n"
+      "INLINE_ORIGIN 0 a()\n"
+      "INLINE_ORIGIN 1 b()\n"
+      "FUNC 1000 100 0 outer\n"
+      "INLINE 0 10 0 0 1010 20 1050 10\n"
+      "INLINE 1 20 1 1 1018 8 1054 4\n"
+      "INLINE 0 30 7 2 1080 10\n"
+      "1000 100 5 0\n";
+  TestCodeModule module("inlines");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module, symbols));
+
+  struct {
+    uint64_t address;
+    const char* frame_file;
+    int frame_line;
+    // Innermost first, as in inlined_frames.
+    std::vector<std::pair<string, uint64_t>> inlines;
+    std::vector<std::pair<string, int>> inline_lines;
+  } cases[] = {
+    { 0x1000, "outer.cc", 5, {}, {} },
+    { 0x100f, "outer.cc", 5, {}, {} },
+    { 0x1010, "outer.cc", 10, {{"a()", 0x1010}}, {{"outer.cc", 5}} },
+    { 0x1017, "outer.cc", 10, {{"a()", 0x1010}}, {{"outer.cc", 5}} },
+    { 0x1018, "outer.cc", 10, {{"b()", 0x1018}, {"a()", 0x1010}},
+      {{"outer.cc", 5}, {"a.h", 20}} },
+    { 0x101f, "outer.cc", 10, {{"b()", 0x1018}, {"a()", 0x1010}},
+      {{"outer.cc", 5}, {"a.h", 20}} },
+    { 0x1020, "outer.cc", 10, {{"a()", 0x1010}}, {{"outer.cc", 5}} },
+    { 0x102f, "outer.cc", 10, {{"a()", 0x1010}}, {{"outer.cc", 5}} },
+    { 0x1030, "outer.cc", 5, {}, {} },
+    { 0x1050, "outer.cc", 10, {{"a()", 0x1050}}, {{"outer.cc", 5}} },
+    { 0x1054, "outer.cc", 10, {{"b()", 0x1054}, {"a()", 0x1050}},
+      {{"outer.cc", 5}, {"a.h", 20}} },
+    { 0x1058, "outer.cc", 10, {{"a()", 0x1050}}, {{"outer.cc", 5}} },
+    { 0x1060, "outer.cc", 5, {}, {} },
+    // An unknown origin and call site file.
+    { 0x1080, "outer.cc", 30, {{"<name omitted>", 0x1080}},
+      {{"outer.cc", 5}} },
+    { 0x1090, "outer.cc", 5, {}, {} },
+  };
+  for (const auto& test : cases) {
+    StackFrame frame;
+    std::deque<std::unique_ptr<StackFrame>> inlined_frames;
+    frame.instruction = test.address;
+    frame.module = &module;
+    resolver.FillSourceLineInfo(&frame, &inlined_frames);
+    SCOPED_TRACE(test.address);
+    EXPECT_EQ("outer", frame.function_name);
+    EXPECT_EQ(test.frame_file, frame.source_file_name);
+    EXPECT_EQ(test.frame_line, frame.source_line);
+    ASSERT_EQ(test.inlines.size(), inlined_frames.size());
+    for (size_t i = 0; i < inlined_frames.size(); ++i) {
+      EXPECT_EQ(test.inlines[i].first, inlined_frames[i]->function_name);
+      EXPECT_EQ(test.inlines[i].second, inlined_frames[i]->function_base);
+      EXPECT_EQ(test.inline_lines[i].first,
+                inlined_frames[i]->source_file_name);
+      EXPECT_EQ(test.inline_lines[i].second, inlined_frames[i]->source_line);
+      EXPECT_EQ(StackFrame::FRAME_TRUST_INLINE, inlined_frames[i]->trust);
+    }
+  }
+}
+
+// Loading a symbol file on several threads should produce the same module
+// as loading it on one.
+TEST_F(TestBasicSourceLineResolver, TestLoadInParallel) {
+  // Build a symbol file large enough to be split into many chunks.
+  string symbols = "MODULE Linux x86_64 000000000000000000000000000000000 big\n";
+  char record[128];
+  const int kNumFiles = 16;
+  for (int i = 0; i < kNumFiles; ++i) {
+    snprintf(record, sizeof(record), "FILE %d file%d.cc\n", i, i);
+    symbols += record;
+  }
+  const int kNumFunctions = 20000;
+  for (int i = 0; i < kNumFunctions; ++i) {
+    uint64_t address = 0x1000 + i * 0x100;
+    snprintf(record, sizeof(record), "FUNC %llx 80 0 function_%d\n",
+             static_cast<unsigned long long>(address), i);
+    symbols += record;
+    for (int j = 0; j < 4; ++j) {
+      snprintf(record, sizeof(record), "%llx 20 %d %d\n",
+               static_cast<unsigned long long>(address + j * 0x20),
+               i + j, (i + j) % kNumFiles);
+      symbols += record;
+    }
+  }
+  for (int i = 0; i < kNumFunctions; ++i) {
+    snprintf(record, sizeof(record), "PUBLIC %llx 0 public_%d\n",
+             static_cast<unsigned long long>(0x1080 + i * 0x100), i);
+    symbols += record;
+  }
+  for (int i = 0; i < kNumFunctions; ++i) {
+    uint64_t address = 0x1000 + i * 0x100;
+    snprintf(record, sizeof(record),
+             "STACK CFI INIT %llx 80 .cfa: $esp 4 + .ra: .cfa 4 - ^\n",
+             static_cast<unsigned long long>(address));
+    symbols += record;
+    snprintf(record, sizeof(record), "STACK CFI %llx .cfa: $esp %d +\n",
+             static_cast<unsigned long long>(address + 0x10), 8 + i % 8);
+    symbols += record;
+  }
+  ASSERT_GT(symbols.size(), 1U << 20);
+
+  BasicSourceLineResolver parallel_resolver(4);
+  TestCodeModule module("big");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module, symbols));
+  ASSERT_TRUE(parallel_resolver.LoadModuleUsingMapBuffer(&module, symbols));
+  ASSERT_FALSE(resolver.IsModuleCorrupt(&module));
+  ASSERT_FALSE(parallel_resolver.IsModuleCorrupt(&module));
+
+  for (uint64_t address = 0x1000; address < 0x1000 + kNumFunctions * 0x100;
+       address += 0x18) {
+    StackFrame expected;
+    expected.instruction = address;
+    expected.module = &module;
+    resolver.FillSourceLineInfo(&expected, nullptr);
+    StackFrame actual;
+    actual.instruction = address;
+    actual.module = &module;
+    parallel_resolver.FillSourceLineInfo(&actual, nullptr);
+    ASSERT_FALSE(actual.function_name.empty());
+    ASSERT_EQ(expected.function_name, actual.function_name);
+    ASSERT_EQ(expected.function_base, actual.function_base);
+    ASSERT_EQ(expected.source_file_name, actual.source_file_name);
+    ASSERT_EQ(expected.source_line, actual.source_line);
+    ASSERT_EQ(expected.source_line_base, actual.source_line_base);
+
+    scoped_ptr<CFIFrameInfo> expected_cfi(resolver.FindCFIFrameInfo(&actual));
+    scoped_ptr<CFIFrameInfo> actual_cfi(
+        parallel_resolver.FindCFIFrameInfo(&actual));
+    ASSERT_EQ(expected_cfi.get() == NULL, actual_cfi.get() == NULL);
+    if (expected_cfi.get())
+      ASSERT_EQ(expected_cfi->Serialize(), actual_cfi->Serialize());
+  }
+
+  // A bad record in a later chunk marks the module corrupt in both modes.
+  TestCodeModule corrupt_module("big-corrupt");
+  string corrupt_symbols = symbols + "FUNC garbage\n";
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&corrupt_module,
+                                                corrupt_symbols));
+  ASSERT_TRUE(parallel_resolver.LoadModuleUsingMapBuffer(&corrupt_module,
+                                                         corrupt_symbols));
+  ASSERT_TRUE(resolver.IsModuleCorrupt(&corrupt_module));
+  ASSERT_TRUE(parallel_resolver.IsModuleCorrupt(&corrupt_module));
+}
+
+// Compares the source line information, including inlined frames, that two
+// resolvers give for the addresses in [start, end).
+static void CompareLookups(BasicSourceLineResolver* expected_resolver,
+                           BasicSourceLineResolver* actual_resolver,
+                           const CodeModule* module,
+                           uint64_t start, uint64_t end, uint64_t step) {
+  for (uint64_t address = start; address < end; address += step) {
+    StackFrame expected;
+    expected.instruction = address;
+    expected.module = module;
+    std::deque<std::unique_ptr<StackFrame>> expected_inlined;
+    expected_resolver->FillSourceLineInfo(&expected, &expected_inlined);
+    StackFrame actual;
+    actual.instruction = address;
+    actual.module = module;
+    std::deque<std::unique_ptr<StackFrame>> actual_inlined;
+    actual_resolver->FillSourceLineInfo(&actual, &actual_inlined);
+    ASSERT_EQ(expected.function_name, actual.function_name);
+    ASSERT_EQ(expected.function_base, actual.function_base);
+    ASSERT_EQ(expected.source_file_name, actual.source_file_name);
+    ASSERT_EQ(expected.source_line, actual.source_line);
+    ASSERT_EQ(expected.source_line_base, actual.source_line_base);
+    ASSERT_EQ(expected_inlined.size(), actual_inlined.size());
+    for (size_t i = 0; i < expected_inlined.size(); ++i) {
+      ASSERT_EQ(expected_inlined[i]->function_name,
+                actual_inlined[i]->function_name);
+      ASSERT_EQ(expected_inlined[i]->function_base,
+                actual_inlined[i]->function_base);
+      ASSERT_EQ(expected_inlined[i]->source_file_name,
+                actual_inlined[i]->source_file_name);
+      ASSERT_EQ(expected_inlined[i]->source_line,
+                actual_inlined[i]->source_line);
+    }
+  }
+}
+
+// A resolver that parses LINE and INLINE records on first lookup should
+// answer every lookup the way one that parses them up front does.
+TEST_F(TestBasicSourceLineResolver, TestLazyLineLoading) {
+  BasicSourceLineResolver lazy_resolver(1, true);
+  ASSERT_FALSE(lazy_resolver.ShouldDeleteMemoryBufferAfterLoadModule());
+
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  ASSERT_TRUE(lazy_resolver.LoadModule(&module1,
+                                       testdata_dir + "/module1.out"));
+  ASSERT_FALSE(lazy_resolver.IsModuleCorrupt(&module1));
+  CompareLookups(&resolver, &lazy_resolver, &module1, 0x0, 0x3000, 0x3);
+
+  TestCodeModule inline_module("linux_inline");
+  const string inline_path = testdata_dir +
+      "/symbols/linux_inline/BBA6FA10B8AAB33D00000000000000000/"
+      "linux_inline.new.sym";
+  ASSERT_TRUE(resolver.LoadModule(&inline_module, inline_path));
+  ASSERT_TRUE(lazy_resolver.LoadModule(&inline_module, inline_path));
+  CompareLookups(&resolver, &lazy_resolver, &inline_module,
+                 0x15b00, 0x16400, 0x1);
+
+  // Line records separated from their function by another record, and
+  // lines ending in CRLF.
+  const string symbols =
+      "MODULE Linux x86 000000000000000000000000000000000 lazy\r\n"
+      "FILE 0 a.cc\r\n"
+      "FILE 1 b.cc\r\n"
+      "FUNC 1000 40 0 first\r\n"
+      "1000 10 10 0\r\n"
+      "1010 10 11 1\r\n"
+      "STACK CFI INIT 1000 40 .cfa: $esp 4 + .ra: .cfa 4 - ^\r\n"
+      "1020 20 12 0\r\n"
+      "FUNC 2000 20 0 second\r\n"
+      "2000 20 20 1\r\n"
+      "PUBLIC 3000 0 third\r\n";
+  TestCodeModule lazy_module("lazy");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&lazy_module, symbols));
+  ASSERT_TRUE(lazy_resolver.LoadModuleUsingMapBuffer(&lazy_module, symbols));
+  ASSERT_FALSE(lazy_resolver.IsModuleCorrupt(&lazy_module));
+  CompareLookups(&resolver, &lazy_resolver, &lazy_module, 0xff0, 0x3010, 0x4);
+
+  StackFrame frame;
+  frame.instruction = 0x1024;
+  frame.module = &lazy_module;
+  lazy_resolver.FillSourceLineInfo(&frame, nullptr);
+  ASSERT_EQ(frame.function_name, "first");
+  ASSERT_EQ(frame.source_file_name, "a.cc");
+  ASSERT_EQ(frame.source_line, 12);
+}
+
+// A module with enough functions to be looked up through the page index
+// finds the same function as a small one would, including nearest-function
+// matches in gaps and past the last function.
+TEST_F(TestBasicSourceLineResolver, TestManyFunctions) {
+  const int kFunctions = 70000;
+  string symbols =
+      "MODULE Linux x86_64 000000000000000000000000000000000 many\n"
+      "FILE 0 many.cc\n";
+  char record[64];
+  for (int i = 0; i < kFunctions; ++i) {
+    // Sixteen bytes of function in every 0x40, with a larger gap every
+    // 1000 functions.
+    uint64_t base = 0x10000 + i * 0x40 + (i / 1000) * 0x10000;
+    snprintf(record, sizeof(record), "FUNC %llx 10 0 f%d\n%llx 10 %d 0\n",
+             static_cast<unsigned long long>(base), i,
+             static_cast<unsigned long long>(base), i + 1);
+    symbols += record;
+  }
+  TestCodeModule module("many");
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module, symbols));
+
+  const int samples[] = { 0, 1, 999, 1000, 31337, kFunctions - 1 };
+  for (int i : samples) {
+    uint64_t base = 0x10000 + i * 0x40 + (i / 1000) * 0x10000;
+    char name[16];
+    snprintf(name, sizeof(name), "f%d", i);
+
+    StackFrame frame;
+    frame.module = &module;
+    frame.instruction = base + 4;
+    resolver.FillSourceLineInfo(&frame, nullptr);
+    EXPECT_EQ(name, frame.function_name);
+    EXPECT_EQ(base, frame.function_base);
+    EXPECT_EQ(i + 1, frame.source_line);
+
+    // Past the function's end there is no line, but no function can start
+    // nearer either, so a frame there is attributed to no function.
+    StackFrame gap_frame;
+    gap_frame.module = &module;
+    gap_frame.instruction = base + 0x20;
+    resolver.FillSourceLineInfo(&gap_frame, nullptr);
+    EXPECT_TRUE(gap_frame.function_name.empty());
+  }
+
+  StackFrame below;
+  below.module = &module;
+  below.instruction = 0xfff0;
+  resolver.FillSourceLineInfo(&below, nullptr);
+  EXPECT_TRUE(below.function_name.empty());
+}
+
+// SymbolizeAddresses answers as FillSourceLineInfo does, whatever order
+// the addresses come in, and gives equal names equal pointers.
+TEST_F(TestBasicSourceLineResolver, TestSymbolizeAddresses) {
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  TestCodeModule module2("module2");
+  ASSERT_TRUE(resolver.LoadModule(&module2, testdata_dir + "/module2.out"));
+  TestCodeModule unloaded("unloaded");
+
+  // Descending addresses, alternating between modules, with some in a
+  // module that isn't loaded or in none at all.
+  std::vector<BasicSourceLineResolver::AddressToSymbolize> addresses;
+  for (uint64_t offset = 0x3000; offset-- > 0;) {
+    const CodeModule* module = offset % 2 ? &module1 : &module2;
+    if (offset % 97 == 0)
+      module = &unloaded;
+    else if (offset % 89 == 0)
+      module = NULL;
+    BasicSourceLineResolver::AddressToSymbolize address = { module, offset };
+    addresses.push_back(address);
+  }
+  std::vector<BasicSourceLineResolver::SymbolizedAddress> results(
+      addresses.size());
+  resolver.SymbolizeAddresses(&addresses[0], addresses.size(), &results[0]);
+
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    StackFrame frame;
+    frame.instruction = addresses[i].offset;
+    frame.module = addresses[i].module;
+    resolver.FillSourceLineInfo(&frame, nullptr);
+    const BasicSourceLineResolver::SymbolizedAddress& result = results[i];
+    ASSERT_EQ(frame.function_name,
+              result.function_name ? result.function_name : "")
+        << "at " << i;
+    if (result.function_name)
+      ASSERT_EQ(frame.function_base, result.function_offset);
+    ASSERT_EQ(frame.source_file_name,
+              result.source_file_name ? result.source_file_name : "")
+        << "at " << i;
+    ASSERT_EQ(frame.source_line, result.source_line) << "at " << i;
+  }
+
+  // Two addresses in the same function, looked up far apart.
+  BasicSourceLineResolver::AddressToSymbolize same_function[] = {
+    { &module1, 0x1000 }, { &module2, 0x2181 }, { &module1, 0x1007 }
+  };
+  BasicSourceLineResolver::SymbolizedAddress same_results[3];
+  resolver.SymbolizeAddresses(same_function, 3, same_results);
+  ASSERT_TRUE(same_results[0].function_name);
+  EXPECT_EQ(same_results[0].function_name, same_results[2].function_name);
+  EXPECT_EQ(same_results[0].source_file_name,
+            same_results[2].source_file_name);
+}
+
+// Mapping a symbol file for parsing gives the same null-terminated data as
+// reading it, which the resolver parses just the same, even when the
+// terminator falls on a page past the end of the file.
+TEST_F(TestBasicSourceLineResolver, TestMapSymbolFileForParsing) {
+  AutoTempDir temp_dir;
+  const string page_file = temp_dir.path() + "/page.sym";
+  string page_symbols = "FUNC 1000 10 0 Function\n";
+  page_symbols.append(getpagesize() - page_symbols.size() - 1, ' ');
+  page_symbols.append("\n");
+  FILE* f = fopen(page_file.c_str(), "wb");
+  ASSERT_TRUE(f);
+  ASSERT_EQ(page_symbols.size(),
+            fwrite(page_symbols.data(), 1, page_symbols.size(), f));
+  ASSERT_EQ(0, fclose(f));
+
+  const string files[] = { testdata_dir + "/module1.out", page_file };
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+    char* read_data;
+    size_t read_size;
+    ASSERT_TRUE(SourceLineResolverBase::ReadSymbolFile(files[i], &read_data,
+                                                       &read_size));
+    char* mapped_data;
+    size_t mapped_size;
+    ASSERT_TRUE(SourceLineResolverBase::MapSymbolFileForParsing(
+        files[i], &mapped_data, &mapped_size));
+    ASSERT_EQ(read_size, mapped_size);
+    EXPECT_EQ(0, memcmp(read_data, mapped_data, read_size));
+    EXPECT_EQ('\0', mapped_data[mapped_size - 1]);
+
+    TestCodeModule module("mapped");
+    BasicSourceLineResolver read_resolver;
+    BasicSourceLineResolver mapped_resolver;
+    ASSERT_TRUE(read_resolver.LoadModuleUsingMemoryBuffer(&module, read_data,
+                                                          read_size));
+    ASSERT_TRUE(mapped_resolver.LoadModuleUsingMemoryBuffer(
+        &module, mapped_data, mapped_size));
+    CompareLookups(&read_resolver, &mapped_resolver, &module,
+                   0x0, 0x3000, 0x3);
+    delete [] read_data;
+    SourceLineResolverBase::UnmapSymbolFile(mapped_data, mapped_size);
+  }
+}
+
+// Every kind of record a module holds shows up in its footprint, and a
+// module that isn't loaded has none.
+TEST_F(TestBasicSourceLineResolver, TestModuleFootprint) {
+  TestCodeModule module1("module1");
+  SourceLineResolverBase::SymbolFootprint footprint;
+  ASSERT_FALSE(resolver.GetModuleFootprint(&module1, &footprint));
+  ASSERT_TRUE(resolver.LoadModule(&module1, testdata_dir + "/module1.out"));
+  ASSERT_TRUE(resolver.GetModuleFootprint(&module1, &footprint));
+  EXPECT_GT(footprint.functions, 0U);
+  EXPECT_GT(footprint.lines, 0U);
+  EXPECT_EQ(0U, footprint.inlines);
+  EXPECT_GT(footprint.public_symbols, 0U);
+  EXPECT_GT(footprint.windows_frame_info, 0U);
+  EXPECT_GT(footprint.cfi, 0U);
+  EXPECT_GT(footprint.strings, 0U);
+  EXPECT_EQ(footprint.functions + footprint.lines + footprint.inlines +
+                footprint.public_symbols + footprint.windows_frame_info +
+                footprint.cfi + footprint.strings,
+            footprint.total());
+
+  TestCodeModule inline_module("linux_inline");
+  ASSERT_TRUE(resolver.LoadModule(
+      &inline_module, testdata_dir +
+                          "/symbols/linux_inline/"
+                          "BBA6FA10B8AAB33D00000000000000000/"
+                          "linux_inline.new.sym"));
+  ASSERT_TRUE(resolver.GetModuleFootprint(&inline_module, &footprint));
+  EXPECT_GT(footprint.inlines, 0U);
+
+  resolver.UnloadModule(&module1);
+  EXPECT_FALSE(resolver.GetModuleFootprint(&module1, &footprint));
+}
+
 // Test parsing of valid FILE lines.  The format is:
 // FILE <id> <filename>
 TEST(SymbolParseHelper, ParseFileValid) {
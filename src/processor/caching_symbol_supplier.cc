@@ -0,0 +1,277 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// caching_symbol_supplier.cc: A SimpleSymbolSupplier that serves symbols in
+// the serialized format loaded by FastSourceLineResolver.
+//
+// See caching_symbol_supplier.h for documentation.
+
+#include "processor/caching_symbol_supplier.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/source_line_resolver_base.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Maps file_name, or copies it into huge pages if in_huge_pages is true,
+// if it exists and holds serialized symbol data of the current version.
+bool MapUsableFile(const string& file_name,
+                   bool in_huge_pages,
+                   char** symbol_data,
+                   size_t* symbol_data_size) {
+  struct stat sb;
+  if (stat(file_name.c_str(), &sb) != 0)
+    return false;
+  bool mapped = in_huge_pages ?
+      SourceLineResolverBase::CopySymbolFileToHugePages(
+          file_name, symbol_data, symbol_data_size) :
+      SourceLineResolverBase::MapSymbolFile(file_name, symbol_data,
+                                            symbol_data_size);
+  if (!mapped)
+    return false;
+  if (!ModuleSerializer::CheckSerializedHeader(*symbol_data,
+                                               *symbol_data_size)) {
+    SourceLineResolverBase::UnmapSymbolFile(*symbol_data, *symbol_data_size);
+    return false;
+  }
+  return true;
+}
+
+// Creates each missing directory on the way to and including path.
+bool MakeDirectories(const string& path) {
+  size_t slash = path.find('/', 1);
+  while (true) {
+    string directory = path.substr(0, slash);
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+      return false;
+    if (slash == string::npos)
+      return true;
+    slash = path.find('/', slash + 1);
+  }
+}
+
+}  // namespace
+
+CachingSymbolSupplier::~CachingSymbolSupplier() {
+  map<string, MappedFile>::iterator it = mapped_files_.begin();
+  for (; it != mapped_files_.end(); ++it) {
+    SourceLineResolverBase::UnmapSymbolFile(it->second.data, it->second.size);
+  }
+}
+
+SymbolSupplier::SymbolResult CachingSymbolSupplier::GetSymbolFile(
+    const CodeModule* module, const SystemInfo* system_info,
+    string* symbol_file) {
+  BPLOG_IF(ERROR, !symbol_file) << "CachingSymbolSupplier::GetSymbolFile "
+                                   "requires |symbol_file|";
+  assert(symbol_file);
+
+  char* symbol_data;
+  size_t symbol_data_size;
+  SymbolResult s = MapCacheFile(module, system_info, false, symbol_file,
+                                &symbol_data, &symbol_data_size);
+  if (s == FOUND)
+    SourceLineResolverBase::UnmapSymbolFile(symbol_data, symbol_data_size);
+  return s;
+}
+
+SymbolSupplier::SymbolResult CachingSymbolSupplier::GetSymbolFile(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    string* symbol_data) {
+  assert(symbol_data);
+  symbol_data->clear();
+
+  char* data;
+  size_t data_size;
+  SymbolResult s = MapCacheFile(module, system_info, false, symbol_file,
+                                &data, &data_size);
+  if (s == FOUND) {
+    symbol_data->assign(data, data_size);
+    SourceLineResolverBase::UnmapSymbolFile(data, data_size);
+  }
+  return s;
+}
+
+SymbolSupplier::SymbolResult CachingSymbolSupplier::GetCStringSymbolData(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+  assert(symbol_data);
+  assert(symbol_data_size);
+
+  {
+    std::lock_guard<std::mutex> guard(mapped_files_mutex_);
+    map<string, MappedFile>::iterator it =
+        mapped_files_.find(module->code_file());
+    if (it != mapped_files_.end()) {
+      if (symbol_file)
+        *symbol_file = it->second.path;
+      *symbol_data = it->second.data;
+      *symbol_data_size = it->second.size;
+      return FOUND;
+    }
+  }
+
+  string cache_file;
+  SymbolResult s = MapCacheFile(module, system_info, use_huge_pages_,
+                                &cache_file, symbol_data, symbol_data_size);
+  if (s != FOUND)
+    return s;
+  if (symbol_file)
+    *symbol_file = cache_file;
+
+  // Another thread may have mapped the module meanwhile; keep only one
+  // mapping, since a resolver may already be using the other.
+  std::lock_guard<std::mutex> guard(mapped_files_mutex_);
+  MappedFile& mapped = mapped_files_[module->code_file()];
+  if (mapped.data) {
+    SourceLineResolverBase::UnmapSymbolFile(*symbol_data, *symbol_data_size);
+    *symbol_data = mapped.data;
+    *symbol_data_size = mapped.size;
+  } else {
+    mapped.path = cache_file;
+    mapped.data = *symbol_data;
+    mapped.size = *symbol_data_size;
+  }
+  return FOUND;
+}
+
+void CachingSymbolSupplier::FreeSymbolData(const CodeModule* module) {
+  if (!module)
+    return;
+
+  std::lock_guard<std::mutex> guard(mapped_files_mutex_);
+  map<string, MappedFile>::iterator it =
+      mapped_files_.find(module->code_file());
+  if (it != mapped_files_.end()) {
+    SourceLineResolverBase::UnmapSymbolFile(it->second.data, it->second.size);
+    mapped_files_.erase(it);
+  }
+}
+
+SymbolSupplier::SymbolResult CachingSymbolSupplier::MapCacheFile(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    bool in_huge_pages,
+    string* cache_file,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+  cache_file->clear();
+
+  string relative_path;
+  if (!GetRelativeSymbolPath(module, &relative_path))
+    return NOT_FOUND;
+  string path = cache_path_ + "/" + relative_path + ".fast";
+
+  if (!MapUsableFile(path, in_huge_pages, symbol_data, symbol_data_size)) {
+    string symbol_file;
+    SymbolResult s = SimpleSymbolSupplier::GetSymbolFile(module, system_info,
+                                                         &symbol_file);
+    if (s != FOUND)
+      return s;
+    if (!PublishCacheFile(symbol_file, path) ||
+        !MapUsableFile(path, in_huge_pages, symbol_data, symbol_data_size)) {
+      return NOT_FOUND;
+    }
+  }
+
+  *cache_file = path;
+  return FOUND;
+}
+
+bool CachingSymbolSupplier::PublishCacheFile(const string& symbol_file,
+                                             const string& cache_file) {
+  string directory = cache_file.substr(0, cache_file.rfind('/'));
+  if (!MakeDirectories(directory)) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not create " << directory <<
+        ", error " << error_code << ": " << error_string;
+    return false;
+  }
+
+  // Convert into a uniquely named file next to cache_file, so that other
+  // processes only ever see a complete file under its final name.
+  string temp_template = cache_file + ".XXXXXX";
+  std::vector<char> temp_name(temp_template.begin(), temp_template.end());
+  temp_name.push_back('\0');
+  int fd = mkstemp(&temp_name[0]);
+  if (fd == -1) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not create a temporary file in " << directory <<
+        ", error " << error_code << ": " << error_string;
+    return false;
+  }
+  // mkstemp only grants access to the owner, but the cache may be shared.
+  fchmod(fd, 0644);
+  close(fd);
+  string temp_file(&temp_name[0]);
+
+  // Cached files are meant for large symbol sets, where the search indexes
+  // pay for themselves.
+  ModuleSerializer serializer;
+  serializer.set_build_search_index(true);
+  if (!serializer.ConvertSymbolFile(symbol_file, temp_file)) {
+    unlink(temp_file.c_str());
+    return false;
+  }
+
+  if (rename(temp_file.c_str(), cache_file.c_str()) != 0) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not rename " << temp_file << " to " << cache_file <<
+        ", error " << error_code << ": " << error_string;
+    unlink(temp_file.c_str());
+    return false;
+  }
+
+  BPLOG(INFO) << "Cached " << symbol_file << " as " << cache_file;
+  return true;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,150 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// caching_symbol_supplier.h: A SimpleSymbolSupplier that serves symbols in
+// the serialized format loaded by FastSourceLineResolver.
+//
+// CachingSymbolSupplier finds text symbol files the same way as
+// SimpleSymbolSupplier, but hands out serialized copies of them kept in a
+// cache directory.  The cache mirrors the symbol store layout, with a .fast
+// extension in place of .sym:
+//
+// cache/test_app.pdb/63FE4780728D49379B9D7BB6460CB42A1/test_app.fast
+//
+// The first lookup of a module converts its symbol file with
+// ModuleSerializer and publishes the result by renaming it into place, so
+// that concurrent processes sharing the cache never see a partial file.
+// Later lookups, from any process, memory-map the cached file read-only, so
+// every process using the cache shares the same page-cache pages instead of
+// parsing and holding its own copy of the symbols.
+//
+// Cached files are keyed only by debug_file and debug_identifier.  A symbol
+// file that changes without its identifier changing is not picked up until
+// its cached copy is removed.  Cached files written by a different version
+// of the serialized format are replaced on first use.
+//
+// The symbol data returned by this supplier must be loaded with
+// FastSourceLineResolver.  A CachingSymbolSupplier may be shared by threads
+// that share a thread-safe FastSourceLineResolver.
+
+#ifndef PROCESSOR_CACHING_SYMBOL_SUPPLIER_H__
+#define PROCESSOR_CACHING_SYMBOL_SUPPLIER_H__
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace google_breakpad {
+
+class CachingSymbolSupplier : public SimpleSymbolSupplier {
+ public:
+  // Creates a new CachingSymbolSupplier that finds symbol files beneath
+  // paths and keeps their serialized copies beneath cache_path.
+  CachingSymbolSupplier(const vector<string>& paths, const string& cache_path)
+      : SimpleSymbolSupplier(paths), cache_path_(cache_path),
+        use_huge_pages_(false) {}
+
+  virtual ~CachingSymbolSupplier();
+
+  // If |use_huge_pages| is true, GetCStringSymbolData() returns a private
+  // copy of each cached file in huge pages, made with
+  // SourceLineResolverBase::CopySymbolFileToHugePages(), rather than a
+  // mapping of the file.  This suits a long-running processor making many
+  // lookups in large symbol files; processes no longer share the cached
+  // data's pages.  Off by default.
+  void set_use_huge_pages(bool use_huge_pages) {
+    use_huge_pages_ = use_huge_pages;
+  }
+
+  // Returns the path to the cached serialized symbol file for the given
+  // module, creating it first if needed.
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file);
+
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file,
+                                     string* symbol_data);
+
+  // Memory-maps the cached serialized symbol file, or copies it into huge
+  // pages if set_use_huge_pages() asked for it.  The mapping stays alive
+  // until FreeSymbolData() is called for the module or the supplier is
+  // destroyed, so the supplier must outlive any FastSourceLineResolver the
+  // data is loaded into.  Asking again for a module that is still mapped
+  // returns the same mapping.
+  virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
+                                            const SystemInfo* system_info,
+                                            string* symbol_file,
+                                            char** symbol_data,
+                                            size_t* symbol_data_size);
+
+  virtual void FreeSymbolData(const CodeModule* module);
+
+ private:
+  // Maps the cached serialized symbol file for module, or copies it into
+  // huge pages if in_huge_pages is true, converting and publishing it first
+  // if it's missing or unusable.  On success, sets cache_file to its path
+  // and symbol_data and symbol_data_size to the mapping.
+  SymbolResult MapCacheFile(const CodeModule* module,
+                            const SystemInfo* system_info,
+                            bool in_huge_pages,
+                            string* cache_file,
+                            char** symbol_data,
+                            size_t* symbol_data_size);
+
+  // Converts symbol_file into a temporary file in the cache and renames it
+  // to cache_file.  Returns false if the conversion fails.
+  bool PublishCacheFile(const string& symbol_file, const string& cache_file);
+
+  string cache_path_;
+  bool use_huge_pages_;
+
+  // A mapped cache file.
+  struct MappedFile {
+    MappedFile() : data(NULL), size(0) {}
+    string path;
+    char* data;
+    size_t size;
+  };
+
+  // Mapped cache files, keyed by module code_file, and the mutex guarding
+  // them.
+  map<string, MappedFile> mapped_files_;
+  std::mutex mapped_files_mutex_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_CACHING_SYMBOL_SUPPLIER_H__
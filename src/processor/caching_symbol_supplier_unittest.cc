@@ -0,0 +1,207 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// caching_symbol_supplier_unittest.cc: Unit tests for CachingSymbolSupplier.
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+#include "processor/caching_symbol_supplier.h"
+#include "processor/module_serializer.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::CachingSymbolSupplier;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::ModuleSerializer;
+using google_breakpad::SourceLineResolverBase;
+using google_breakpad::StackFrame;
+using google_breakpad::SymbolSupplier;
+
+static bool CopyFile(const string& from, const string& to) {
+  char* data;
+  size_t size;
+  if (!SourceLineResolverBase::ReadSymbolFile(from, &data, &size))
+    return false;
+  FILE* f = fopen(to.c_str(), "wb");
+  bool ok = f && fwrite(data, 1, size - 1, f) == size - 1;
+  if (f)
+    ok = fclose(f) == 0 && ok;
+  delete [] data;
+  return ok;
+}
+
+class CachingSymbolSupplierTest : public ::testing::Test {
+ public:
+  CachingSymbolSupplierTest()
+      : module_(0x1000, 0xb000, "module1.dll", "", "module1.pdb",
+                "ABCDEF0123456789ABCDEF01234567891", ""),
+        symbol_paths_(1, temp_dir_.path() + "/symbols"),
+        cache_path_(temp_dir_.path() + "/cache"),
+        cache_file_(cache_path_ +
+                    "/module1.pdb/ABCDEF0123456789ABCDEF01234567891/"
+                    "module1.fast") {}
+
+  void SetUp() {
+    string testdata_dir = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                          "/src/processor/testdata";
+    string directory = symbol_paths_[0];
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0755));
+    directory += "/module1.pdb";
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0755));
+    directory += "/ABCDEF0123456789ABCDEF01234567891";
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0755));
+    symbol_file_ = directory + "/module1.sym";
+    ASSERT_TRUE(CopyFile(testdata_dir + "/module1.out", symbol_file_));
+  }
+
+  // Loads the module from supplier into a new resolver and checks that it
+  // resolves an address.
+  void CheckLoad(CachingSymbolSupplier* supplier) {
+    string symbol_file;
+    char* symbol_data = NULL;
+    size_t symbol_data_size = 0;
+    ASSERT_EQ(SymbolSupplier::FOUND,
+              supplier->GetCStringSymbolData(&module_, NULL, &symbol_file,
+                                             &symbol_data,
+                                             &symbol_data_size));
+    EXPECT_EQ(cache_file_, symbol_file);
+
+    FastSourceLineResolver resolver;
+    ASSERT_TRUE(resolver.LoadModuleUsingMemoryBuffer(&module_, symbol_data,
+                                                     symbol_data_size));
+    EXPECT_FALSE(resolver.IsModuleCorrupt(&module_));
+    StackFrame frame;
+    frame.instruction = 0x2000;
+    frame.module = &module_;
+    resolver.FillSourceLineInfo(&frame, NULL);
+    EXPECT_EQ("Function1_1", frame.function_name);
+    EXPECT_EQ("file1_1.cc", frame.source_file_name);
+    EXPECT_EQ(44, frame.source_line);
+  }
+
+  AutoTempDir temp_dir_;
+  BasicCodeModule module_;
+  std::vector<string> symbol_paths_;
+  string cache_path_;
+  string cache_file_;
+  string symbol_file_;
+};
+
+TEST_F(CachingSymbolSupplierTest, ConvertsAndPublishes) {
+  struct stat sb;
+  ASSERT_NE(0, stat(cache_file_.c_str(), &sb));
+
+  CachingSymbolSupplier supplier(symbol_paths_, cache_path_);
+  CheckLoad(&supplier);
+  ASSERT_EQ(0, stat(cache_file_.c_str(), &sb));
+
+  string symbol_file;
+  string symbol_data;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file,
+                                   &symbol_data));
+  EXPECT_EQ(cache_file_, symbol_file);
+  EXPECT_TRUE(ModuleSerializer::VerifySerializedData(symbol_data.data(),
+                                                     symbol_data.size()));
+}
+
+TEST_F(CachingSymbolSupplierTest, UsesPublishedFile) {
+  {
+    CachingSymbolSupplier supplier(symbol_paths_, cache_path_);
+    string symbol_file;
+    ASSERT_EQ(SymbolSupplier::FOUND,
+              supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  }
+
+  // Once published, the cached copy is used without the symbol file.
+  ASSERT_EQ(0, unlink(symbol_file_.c_str()));
+  CachingSymbolSupplier supplier(symbol_paths_, cache_path_);
+  CheckLoad(&supplier);
+}
+
+TEST_F(CachingSymbolSupplierTest, CopiesIntoHugePages) {
+  CachingSymbolSupplier supplier(symbol_paths_, cache_path_);
+  supplier.set_use_huge_pages(true);
+  CheckLoad(&supplier);
+  supplier.FreeSymbolData(&module_);
+}
+
+TEST_F(CachingSymbolSupplierTest, ReplacesUnusableFile) {
+  {
+    CachingSymbolSupplier supplier(symbol_paths_, cache_path_);
+    string symbol_file;
+    ASSERT_EQ(SymbolSupplier::FOUND,
+              supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  }
+
+  FILE* f = fopen(cache_file_.c_str(), "wb");
+  ASSERT_TRUE(f);
+  fputs("MODULE windows x86 ABCDEF0123456789ABCDEF01234567891 module1.pdb\n",
+        f);
+  ASSERT_EQ(0, fclose(f));
+
+  CachingSymbolSupplier supplier(symbol_paths_, cache_path_);
+  CheckLoad(&supplier);
+}
+
+TEST_F(CachingSymbolSupplierTest, MissingSymbols) {
+  BasicCodeModule missing(0x1000, 0xb000, "missing.dll", "", "missing.pdb",
+                          "ABCDEF0123456789ABCDEF01234567891", "");
+  CachingSymbolSupplier supplier(symbol_paths_, cache_path_);
+  string symbol_file;
+  char* symbol_data = NULL;
+  size_t symbol_data_size = 0;
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetCStringSymbolData(&missing, NULL, &symbol_file,
+                                          &symbol_data, &symbol_data_size));
+  EXPECT_TRUE(symbol_file.empty());
+
+  struct stat sb;
+  EXPECT_NE(0, stat((cache_path_ + "/missing.pdb").c_str(), &sb));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
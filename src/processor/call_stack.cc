@@ -48,6 +48,7 @@ void CallStack::Clear() {
        ++iterator) {
     delete *iterator;
   }
+  frames_.clear();
   tid_ = 0;
 }
 
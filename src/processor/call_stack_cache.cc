@@ -0,0 +1,368 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// call_stack_cache.cc: Whole stacks walked by MinidumpProcessors, kept for
+// minidumps that repeat them exactly.
+//
+// See call_stack_cache.h for documentation.
+
+#include "processor/call_stack_cache.h"
+
+#include <algorithm>
+
+#include "google_breakpad/common/minidump_format.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/dump_context.h"
+#include "google_breakpad/processor/memory_region.h"
+#include "google_breakpad/processor/stack_frame_cpu.h"
+#include "google_breakpad/processor/system_info.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/frame_arena.h"
+#include "processor/windows_frame_info.h"
+
+namespace google_breakpad {
+
+namespace {
+
+template<typename T>
+void AppendValue(const T& value, string* key) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(const string& value, string* key) {
+  AppendValue(static_cast<uint64_t>(value.size()), key);
+  key->append(value);
+}
+
+void AppendModules(const CodeModules* modules, string* key) {
+  unsigned int count = modules ? modules->module_count() : 0;
+  AppendValue(count, key);
+  for (unsigned int i = 0; i < count; ++i) {
+    const CodeModule* module = modules->GetModuleAtIndex(i);
+    AppendValue(module->base_address(), key);
+    AppendValue(module->size(), key);
+    AppendString(module->code_file(), key);
+    AppendString(module->debug_file(), key);
+    AppendString(module->debug_identifier(), key);
+  }
+}
+
+// Appends the raw context |context| of a CPU, or returns false if it's
+// missing.
+template<typename T>
+bool AppendContext(const T* context, string* key) {
+  if (!context)
+    return false;
+  AppendValue(*context, key);
+  return true;
+}
+
+// Returns a copy of |frame|, adding its size to |*bytes|.
+template<typename T>
+StackFrame* CopyFrameOfType(const StackFrame& frame, size_t* bytes) {
+  *bytes += sizeof(T);
+  return new T(static_cast<const T&>(frame));
+}
+
+// Appends |module| to |modules| unless it's there already.
+void AddModule(const CodeModule* module,
+               std::vector<const CodeModule*>* modules) {
+  if (module &&
+      std::find(modules->begin(), modules->end(), module) == modules->end())
+    modules->push_back(module);
+}
+
+}  // namespace
+
+const size_t CallStackCache::kDefaultMaxBytes;
+
+CallStackCache::Entry::Entry() : key(NULL), cpu(0), bytes(0) {}
+
+CallStackCache::Entry::~Entry() {}
+
+CallStackCache::CallStackCache()
+    : max_bytes_(kDefaultMaxBytes), bytes_(0), hits_(0), misses_(0) {}
+
+CallStackCache::CallStackCache(size_t max_bytes)
+    : max_bytes_(max_bytes), bytes_(0), hits_(0), misses_(0) {}
+
+CallStackCache::~CallStackCache() {}
+
+// static
+bool CallStackCache::MakeKey(const SystemInfo& system_info,
+                             const CodeModules* modules,
+                             const CodeModules* unloaded_modules,
+                             const DumpContext& context,
+                             const MemoryRegion& memory,
+                             string* key) {
+  key->clear();
+  AppendString(system_info.os, key);
+  AppendString(system_info.os_short, key);
+  AppendString(system_info.os_version, key);
+  AppendString(system_info.cpu, key);
+  AppendString(system_info.cpu_info, key);
+  AppendModules(modules, key);
+  AppendModules(unloaded_modules, key);
+
+  uint32_t cpu = context.GetContextCPU();
+  AppendValue(cpu, key);
+  bool has_context;
+  switch (cpu) {
+    case MD_CONTEXT_X86:
+      has_context = AppendContext(context.GetContextX86(), key);
+      break;
+    case MD_CONTEXT_PPC:
+      has_context = AppendContext(context.GetContextPPC(), key);
+      break;
+    case MD_CONTEXT_PPC64:
+      has_context = AppendContext(context.GetContextPPC64(), key);
+      break;
+    case MD_CONTEXT_AMD64:
+      has_context = AppendContext(context.GetContextAMD64(), key);
+      break;
+    case MD_CONTEXT_SPARC:
+      has_context = AppendContext(context.GetContextSPARC(), key);
+      break;
+    case MD_CONTEXT_MIPS:
+    case MD_CONTEXT_MIPS64:
+      has_context = AppendContext(context.GetContextMIPS(), key);
+      break;
+    case MD_CONTEXT_ARM:
+      has_context = AppendContext(context.GetContextARM(), key);
+      break;
+    case MD_CONTEXT_ARM64:
+      has_context = AppendContext(context.GetContextARM64(), key);
+      break;
+    default:
+      has_context = false;
+      break;
+  }
+  if (!has_context)
+    return false;
+
+  uint64_t address = memory.GetBase();
+  uint64_t size = memory.GetSize();
+  AppendValue(address, key);
+  AppendValue(size, key);
+  while (size > 0) {
+    size_t span_length;
+    const uint8_t* span = memory.GetMemorySpan(address, size, &span_length);
+    if (!span)
+      return false;
+    key->append(reinterpret_cast<const char*>(span), span_length);
+    address += span_length;
+    size -= span_length;
+  }
+  return true;
+}
+
+bool CallStackCache::Find(
+    const string& key,
+    const CodeModules* modules,
+    const CodeModules* unloaded_modules,
+    CallStack* stack,
+    std::vector<const CodeModule*>* modules_without_symbols,
+    std::vector<const CodeModule*>* modules_with_corrupt_symbols) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::unordered_map<string, EntryList::iterator>::iterator found =
+      index_.find(key);
+  if (found == index_.end()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  entries_.splice(entries_.begin(), entries_, found->second);
+
+  const Entry& entry = *found->second;
+  size_t bytes = 0;
+  for (size_t i = 0; i < entry.frames.size(); ++i) {
+    StackFrame* frame = CopyFrame(*entry.frames[i], entry.cpu, &bytes);
+    frame->module = FindModule(entry.frame_modules[i], modules,
+                               unloaded_modules);
+    stack->frames_.push_back(frame);
+  }
+  for (size_t i = 0; i < entry.modules_without_symbols.size(); ++i) {
+    AddModule(FindModule(entry.modules_without_symbols[i], modules,
+                         unloaded_modules),
+              modules_without_symbols);
+  }
+  for (size_t i = 0; i < entry.modules_with_corrupt_symbols.size(); ++i) {
+    AddModule(FindModule(entry.modules_with_corrupt_symbols[i], modules,
+                         unloaded_modules),
+              modules_with_corrupt_symbols);
+  }
+  return true;
+}
+
+void CallStackCache::Insert(
+    const string& key,
+    uint32_t cpu,
+    const CodeModules* modules,
+    const CodeModules* unloaded_modules,
+    const CallStack& stack,
+    const std::vector<const CodeModule*>& modules_without_symbols,
+    const std::vector<const CodeModule*>& modules_with_corrupt_symbols) {
+  // Copy the stack before taking the lock.  The copies come from the heap
+  // even while the walking thread has a frame arena, which they would
+  // otherwise keep alive for as long as they are cached.
+  ScopedFrameArena heap_frames(NULL);
+  Entry entry;
+  entry.cpu = cpu;
+  entry.bytes = key.size() + sizeof(Entry);
+  const std::vector<StackFrame*>* frames = stack.frames();
+  for (size_t i = 0; i < frames->size(); ++i) {
+    const StackFrame& frame = *(*frames)[i];
+    StackFrame* copy = CopyFrame(frame, cpu, &entry.bytes);
+    copy->module = NULL;
+    entry.frames.push_back(std::unique_ptr<StackFrame>(copy));
+    entry.frame_modules.push_back(MakeModuleRef(frame.module,
+                                                unloaded_modules));
+    entry.bytes += sizeof(ModuleRef) + frame.function_name.size() +
+        frame.source_file_name.size();
+  }
+  for (size_t i = 0; i < modules_without_symbols.size(); ++i) {
+    entry.modules_without_symbols.push_back(
+        MakeModuleRef(modules_without_symbols[i], unloaded_modules));
+  }
+  for (size_t i = 0; i < modules_with_corrupt_symbols.size(); ++i) {
+    entry.modules_with_corrupt_symbols.push_back(
+        MakeModuleRef(modules_with_corrupt_symbols[i], unloaded_modules));
+  }
+  if (entry.bytes > max_bytes_)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.find(key) != index_.end())
+    return;
+  while (!entries_.empty() && bytes_ + entry.bytes > max_bytes_) {
+    bytes_ -= entries_.back().bytes;
+    index_.erase(*entries_.back().key);
+    entries_.pop_back();
+  }
+  entries_.emplace_front();
+  Entry& cached = entries_.front();
+  std::pair<std::unordered_map<string, EntryList::iterator>::iterator, bool>
+      inserted = index_.insert(std::make_pair(key, entries_.begin()));
+  cached.key = &inserted.first->first;
+  cached.cpu = entry.cpu;
+  cached.frames.swap(entry.frames);
+  cached.frame_modules.swap(entry.frame_modules);
+  cached.modules_without_symbols.swap(entry.modules_without_symbols);
+  cached.modules_with_corrupt_symbols.swap(
+      entry.modules_with_corrupt_symbols);
+  cached.bytes = entry.bytes;
+  bytes_ += cached.bytes;
+}
+
+size_t CallStackCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+void CallStackCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+// static
+StackFrame* CallStackCache::CopyFrame(const StackFrame& frame, uint32_t cpu,
+                                      size_t* bytes) {
+  // Inlined frames are plain StackFrames whatever the CPU.
+  if (frame.trust == StackFrame::FRAME_TRUST_INLINE)
+    return CopyFrameOfType<StackFrame>(frame, bytes);
+  switch (cpu) {
+    case MD_CONTEXT_X86: {
+      StackFrameX86* copy = static_cast<StackFrameX86*>(
+          CopyFrameOfType<StackFrameX86>(frame, bytes));
+      // The frame owns its rules, so the copy needs its own.
+      if (copy->windows_frame_info) {
+        copy->windows_frame_info =
+            new WindowsFrameInfo(*copy->windows_frame_info);
+        *bytes += sizeof(WindowsFrameInfo);
+      }
+      if (copy->cfi_frame_info) {
+        copy->cfi_frame_info = new CFIFrameInfo(*copy->cfi_frame_info);
+        *bytes += sizeof(CFIFrameInfo);
+      }
+      return copy;
+    }
+    case MD_CONTEXT_PPC:
+      return CopyFrameOfType<StackFramePPC>(frame, bytes);
+    case MD_CONTEXT_PPC64:
+      return CopyFrameOfType<StackFramePPC64>(frame, bytes);
+    case MD_CONTEXT_AMD64:
+      return CopyFrameOfType<StackFrameAMD64>(frame, bytes);
+    case MD_CONTEXT_SPARC:
+      return CopyFrameOfType<StackFrameSPARC>(frame, bytes);
+    case MD_CONTEXT_MIPS:
+    case MD_CONTEXT_MIPS64:
+      return CopyFrameOfType<StackFrameMIPS>(frame, bytes);
+    case MD_CONTEXT_ARM:
+      return CopyFrameOfType<StackFrameARM>(frame, bytes);
+    case MD_CONTEXT_ARM64:
+      return CopyFrameOfType<StackFrameARM64>(frame, bytes);
+    default:
+      return CopyFrameOfType<StackFrame>(frame, bytes);
+  }
+}
+
+// static
+CallStackCache::ModuleRef CallStackCache::MakeModuleRef(
+    const CodeModule* module,
+    const CodeModules* unloaded_modules) {
+  ModuleRef ref;
+  ref.list = ModuleRef::NONE;
+  ref.base_address = 0;
+  if (module) {
+    ref.base_address = module->base_address();
+    ref.list = unloaded_modules &&
+        unloaded_modules->GetModuleForAddress(ref.base_address) == module ?
+        ModuleRef::UNLOADED : ModuleRef::LOADED;
+  }
+  return ref;
+}
+
+// static
+const CodeModule* CallStackCache::FindModule(
+    const ModuleRef& ref,
+    const CodeModules* modules,
+    const CodeModules* unloaded_modules) {
+  const CodeModules* list = NULL;
+  if (ref.list == ModuleRef::LOADED)
+    list = modules;
+  else if (ref.list == ModuleRef::UNLOADED)
+    list = unloaded_modules;
+  return list ? list->GetModuleForAddress(ref.base_address) : NULL;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,187 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// call_stack_cache.h: Whole stacks walked by MinidumpProcessors, kept for
+// minidumps that repeat them exactly.
+//
+// During a crash spike most minidumps come from the same build crashing
+// in the same place, with the same modules loaded at the same addresses
+// and, often enough, the same bytes on the crashing thread's stack.
+// Walking and symbolizing such a stack again gives the same frames, so a
+// CallStackCache given to the processors remembers each walked stack,
+// keyed by everything the walk reads: the system info, the module and
+// unloaded module lists, the thread's context, and its stack memory.  A
+// minidump that matches a key byte for byte gets a copy of the stack
+// instead of a walk.
+//
+// The cache assumes that symbols don't change while it's in use, and
+// keeps the stacks of walks that found modules without symbols as they
+// were; call Clear() after adding symbols.  It holds up to a number of
+// bytes of keys and frames, dropping the least recently used stacks to
+// stay under it.  It is safe to share between threads.
+
+#ifndef PROCESSOR_CALL_STACK_CACHE_H__
+#define PROCESSOR_CALL_STACK_CACHE_H__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class CallStack;
+class CodeModule;
+class CodeModules;
+class DumpContext;
+class MemoryRegion;
+struct StackFrame;
+struct SystemInfo;
+
+class CallStackCache {
+ public:
+  // The bytes of keys and frames kept, unless the cache is created with
+  // another limit.
+  static const size_t kDefaultMaxBytes = 64 << 20;
+
+  CallStackCache();
+  explicit CallStackCache(size_t max_bytes);
+  ~CallStackCache();
+
+  // Sets |*key| to the key for walking the stack in |memory| from
+  // |context|, in a process described by |system_info|, |modules| and
+  // |unloaded_modules|, either of which may be NULL.  Returns false if
+  // there is no key, because |memory| can't provide its bytes directly or
+  // |context| is of an unknown CPU.
+  static bool MakeKey(const SystemInfo& system_info,
+                      const CodeModules* modules,
+                      const CodeModules* unloaded_modules,
+                      const DumpContext& context,
+                      const MemoryRegion& memory,
+                      string* key);
+
+  // If a stack is cached for |key|, appends copies of its frames to
+  // |stack| and the modules its walk found without symbols or with
+  // corrupt symbols to |modules_without_symbols| and
+  // |modules_with_corrupt_symbols|, taking each module from |modules| or
+  // |unloaded_modules|, the lists |key| was made from, and returns true.
+  bool Find(const string& key,
+            const CodeModules* modules,
+            const CodeModules* unloaded_modules,
+            CallStack* stack,
+            std::vector<const CodeModule*>* modules_without_symbols,
+            std::vector<const CodeModule*>* modules_with_corrupt_symbols);
+
+  // Caches copies of |stack|'s frames, whose modules are from |modules|
+  // or |unloaded_modules|, and the modules its walk found without
+  // symbols or with corrupt symbols, under |key|.  |cpu| is the
+  // MD_CONTEXT_* CPU of the context the stack was walked from.
+  void Insert(const string& key,
+              uint32_t cpu,
+              const CodeModules* modules,
+              const CodeModules* unloaded_modules,
+              const CallStack& stack,
+              const std::vector<const CodeModule*>& modules_without_symbols,
+              const std::vector<const CodeModule*>&
+                  modules_with_corrupt_symbols);
+
+  // Lookups answered from the cache, and those that weren't.
+  uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+  // The bytes of keys and frames held.
+  size_t bytes() const;
+
+  // Forgets every stack.
+  void Clear();
+
+ private:
+  // Which of the lists a cached module is in, and its base address there.
+  struct ModuleRef {
+    enum List { NONE, LOADED, UNLOADED };
+    List list;
+    uint64_t base_address;
+  };
+
+  // A cached stack.  Its frames' modules are NULL, and kept apart in
+  // |frame_modules|, since the lists they pointed into belong to the
+  // minidump they were walked in.  |key| points to its key in index_.
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    const string* key;
+    uint32_t cpu;
+    std::vector<std::unique_ptr<StackFrame>> frames;
+    std::vector<ModuleRef> frame_modules;
+    std::vector<ModuleRef> modules_without_symbols;
+    std::vector<ModuleRef> modules_with_corrupt_symbols;
+    size_t bytes;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  // Returns a copy of |frame|, which was walked from a context of the
+  // MD_CONTEXT_* |cpu|, of the same type, adding its size to |*bytes|.
+  static StackFrame* CopyFrame(const StackFrame& frame, uint32_t cpu,
+                               size_t* bytes);
+
+  static ModuleRef MakeModuleRef(const CodeModule* module,
+                                 const CodeModules* unloaded_modules);
+  static const CodeModule* FindModule(const ModuleRef& ref,
+                                      const CodeModules* modules,
+                                      const CodeModules* unloaded_modules);
+
+  size_t max_bytes_;
+
+  // The stacks, most recently used first, an index of them by key, the
+  // bytes they hold, and the mutex guarding them.
+  EntryList entries_;
+  std::unordered_map<string, EntryList::iterator> index_;
+  size_t bytes_;
+  mutable std::mutex mutex_;
+
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+
+  // Disallow copy constructor and assignment operator.
+  CallStackCache(const CallStackCache&);
+  void operator=(const CallStackCache&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_CALL_STACK_CACHE_H__
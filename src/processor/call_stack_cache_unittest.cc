@@ -0,0 +1,225 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// call_stack_cache_unittest.cc: Unit tests for CallStackCache, as
+// MinidumpProcessor uses it.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/minidump.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/call_stack_cache.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CallStack;
+using google_breakpad::CallStackCache;
+using google_breakpad::CodeModule;
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ProcessState;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::StackFrame;
+
+class CallStackCacheTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    testdata_dir_ = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                    "/src/processor/testdata";
+    // linux_inline.dmp's symbols are kept under another name.
+    string directory = temp_dir_.path() + "/linux_inline";
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0755));
+    directory += "/BBA6FA10B8AAB33D00000000000000000";
+    ASSERT_EQ(0, mkdir(directory.c_str(), 0755));
+    ASSERT_EQ(0, symlink((testdata_dir_ + "/symbols/linux_inline/"
+                          "BBA6FA10B8AAB33D00000000000000000/"
+                          "linux_inline.new.sym").c_str(),
+                         (directory + "/linux_inline.sym").c_str()));
+  }
+
+  // Processes the minidump |name| with symbols if |symbols| is true,
+  // through |cache|, into |state|.
+  void Process(const string& name, bool symbols, CallStackCache* cache,
+               ProcessState* state) {
+    std::vector<string> symbol_paths;
+    symbol_paths.push_back(testdata_dir_ + "/symbols");
+    symbol_paths.push_back(temp_dir_.path());
+    SimpleSymbolSupplier supplier(symbol_paths);
+    BasicSourceLineResolver resolver;
+    MinidumpProcessor processor(symbols ? &supplier : NULL, &resolver);
+    processor.set_call_stack_cache(cache);
+    Minidump dump(testdata_dir_ + "/" + name);
+    ASSERT_TRUE(dump.Read());
+    ASSERT_EQ(google_breakpad::PROCESS_OK, processor.Process(&dump, state));
+  }
+
+  // Checks that the requesting threads of |expected| and |actual| have
+  // the same frames, each with a module from its own state.
+  void ExpectSameStack(const ProcessState& expected,
+                       const ProcessState& actual) {
+    ASSERT_LE(0, expected.requesting_thread());
+    ASSERT_EQ(expected.requesting_thread(), actual.requesting_thread());
+    const CallStack* expected_stack =
+        expected.threads()->at(expected.requesting_thread());
+    const CallStack* actual_stack =
+        actual.threads()->at(actual.requesting_thread());
+    EXPECT_EQ(expected_stack->tid(), actual_stack->tid());
+    ASSERT_EQ(expected_stack->frames()->size(),
+              actual_stack->frames()->size());
+    for (size_t i = 0; i < expected_stack->frames()->size(); ++i) {
+      const StackFrame* expected_frame = expected_stack->frames()->at(i);
+      const StackFrame* actual_frame = actual_stack->frames()->at(i);
+      EXPECT_EQ(expected_frame->instruction, actual_frame->instruction);
+      EXPECT_EQ(expected_frame->trust, actual_frame->trust);
+      EXPECT_EQ(expected_frame->function_name, actual_frame->function_name);
+      EXPECT_EQ(expected_frame->source_file_name,
+                actual_frame->source_file_name);
+      EXPECT_EQ(expected_frame->source_line, actual_frame->source_line);
+      EXPECT_EQ(expected_frame->ReturnAddress(),
+                actual_frame->ReturnAddress());
+      ASSERT_EQ(!expected_frame->module, !actual_frame->module);
+      if (actual_frame->module) {
+        EXPECT_EQ(expected_frame->module->code_file(),
+                  actual_frame->module->code_file());
+        EXPECT_EQ(actual_frame->module, actual.modules()->GetModuleForAddress(
+            actual_frame->module->base_address()));
+      }
+    }
+  }
+
+  AutoTempDir temp_dir_;
+  string testdata_dir_;
+};
+
+TEST_F(CallStackCacheTest, RepeatedMinidumpCopiesStack) {
+  CallStackCache cache;
+  ProcessState first, second, uncached;
+  Process("minidump2.dmp", true, &cache, &first);
+  EXPECT_EQ(0U, cache.hits());
+  EXPECT_EQ(1U, cache.misses());
+  EXPECT_LT(0U, cache.bytes());
+  Process("minidump2.dmp", true, &cache, &second);
+  EXPECT_EQ(1U, cache.hits());
+  Process("minidump2.dmp", true, NULL, &uncached);
+  ExpectSameStack(uncached, first);
+  ExpectSameStack(uncached, second);
+  // Only the requesting thread is looked up.
+  EXPECT_EQ(2U, cache.hits() + cache.misses());
+}
+
+TEST_F(CallStackCacheTest, InlinedFrames) {
+  CallStackCache cache;
+  ProcessState first, second;
+  Process("linux_inline.dmp", true, &cache, &first);
+  Process("linux_inline.dmp", true, &cache, &second);
+  EXPECT_EQ(1U, cache.hits());
+  ExpectSameStack(first, second);
+  size_t inlined = 0;
+  const CallStack* stack = second.threads()->at(second.requesting_thread());
+  for (size_t i = 0; i < stack->frames()->size(); ++i) {
+    if (stack->frames()->at(i)->trust == StackFrame::FRAME_TRUST_INLINE)
+      ++inlined;
+  }
+  EXPECT_LT(0U, inlined);
+}
+
+TEST_F(CallStackCacheTest, ModulesWithoutSymbols) {
+  CallStackCache cache;
+  ProcessState first, second;
+  Process("minidump2.dmp", false, &cache, &first);
+  Process("minidump2.dmp", false, &cache, &second);
+  EXPECT_EQ(1U, cache.hits());
+  ExpectSameStack(first, second);
+  ASSERT_EQ(first.modules_without_symbols()->size(),
+            second.modules_without_symbols()->size());
+  ASSERT_LT(0U, second.modules_without_symbols()->size());
+  for (size_t i = 0; i < second.modules_without_symbols()->size(); ++i) {
+    const CodeModule* module = second.modules_without_symbols()->at(i);
+    EXPECT_EQ(first.modules_without_symbols()->at(i)->code_file(),
+              module->code_file());
+    EXPECT_EQ(module,
+              second.modules()->GetModuleForAddress(module->base_address()));
+  }
+}
+
+TEST_F(CallStackCacheTest, DifferentMinidumpsMiss) {
+  CallStackCache cache;
+  ProcessState state;
+  Process("minidump2.dmp", true, &cache, &state);
+  Process("linux_inline.dmp", true, &cache, &state);
+  EXPECT_EQ(0U, cache.hits());
+  EXPECT_EQ(2U, cache.misses());
+}
+
+TEST_F(CallStackCacheTest, LeastRecentlyUsedDropped) {
+  CallStackCache sizing;
+  ProcessState state;
+  Process("minidump2.dmp", true, &sizing, &state);
+  size_t one_stack = sizing.bytes();
+  Process("linux_inline.dmp", true, &sizing, &state);
+  size_t other_stack = sizing.bytes() - one_stack;
+
+  // Room for either stack but not both.
+  CallStackCache cache(std::max(one_stack, other_stack));
+  Process("minidump2.dmp", true, &cache, &state);
+  Process("linux_inline.dmp", true, &cache, &state);
+  Process("minidump2.dmp", true, &cache, &state);
+  EXPECT_EQ(0U, cache.hits());
+  Process("minidump2.dmp", true, &cache, &state);
+  EXPECT_EQ(1U, cache.hits());
+
+  cache.Clear();
+  EXPECT_EQ(0U, cache.bytes());
+  Process("minidump2.dmp", true, &cache, &state);
+  EXPECT_EQ(1U, cache.hits());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
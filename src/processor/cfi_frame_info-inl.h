@@ -48,22 +48,22 @@ bool SimpleCFIWalker<RegisterType, RawContextType>::FindCallerRegisters(
     int callee_validity,
     RawContextType* caller_context,
     int* caller_validity) const {
-  typedef CFIFrameInfo::RegisterValueMap<RegisterType> ValueMap;
-  ValueMap callee_registers;
-  ValueMap caller_registers;
-  // Just for brevity.
-  typename ValueMap::const_iterator caller_none = caller_registers.end();
+  // Registers are numbered by their position in register_map_.
+  RegisterValueArray<RegisterType> callee_registers;
+  RegisterValueArray<RegisterType> caller_registers;
+  RegisterType caller_ra, caller_cfa;
 
   // Populate callee_registers with register values from callee_context.
   for (size_t i = 0; i < map_size_; i++) {
     const RegisterSet& r = register_map_[i];
     if (callee_validity & r.validity_flag)
-      callee_registers[r.name] = callee_context.*r.context_member;
+      callee_registers.Set(i, callee_context.*r.context_member);
   }
 
   // Apply the rules, and see what register values they yield.
-  if (!cfi_frame_info.FindCallerRegs<RegisterType>(callee_registers, memory,
-                                                   &caller_registers))
+  if (!cfi_frame_info.FindCallerRegs<RegisterType>(
+          &register_names_[0], map_size_, callee_registers, memory,
+          &caller_registers, &caller_ra, &caller_cfa))
     return false;
 
   // Populate *caller_context with the values the rules placed in
@@ -72,12 +72,11 @@ bool SimpleCFIWalker<RegisterType, RawContextType>::FindCallerRegisters(
   *caller_validity = 0;
   for (size_t i = 0; i < map_size_; i++) {
     const RegisterSet& r = register_map_[i];
-    typename ValueMap::const_iterator caller_entry;
+    RegisterType value;
 
     // Did the rules provide a value for this register by its name?
-    caller_entry = caller_registers.find(r.name);
-    if (caller_entry != caller_none) {
-      caller_context->*r.context_member = caller_entry->second;
+    if (caller_registers.Get(i, &value)) {
+      caller_context->*r.context_member = value;
       *caller_validity |= r.validity_flag;
       continue;
     }
@@ -85,9 +84,21 @@ bool SimpleCFIWalker<RegisterType, RawContextType>::FindCallerRegisters(
     // Did the rules provide a value for this register under its
     // alternate name?
     if (r.alternate_name) {
-      caller_entry = caller_registers.find(r.alternate_name);
-      if (caller_entry != caller_none) {
-        caller_context->*r.context_member = caller_entry->second;
+      bool found = false;
+      if (strcmp(r.alternate_name, ".ra") == 0) {
+        value = caller_ra;
+        found = true;
+      } else if (strcmp(r.alternate_name, ".cfa") == 0) {
+        value = caller_cfa;
+        found = true;
+      } else {
+        for (size_t j = 0; j < map_size_ && !found; j++) {
+          if (strcmp(r.alternate_name, register_map_[j].name) == 0)
+            found = caller_registers.Get(j, &value);
+        }
+      }
+      if (found) {
+        caller_context->*r.context_member = value;
         *caller_validity |= r.validity_flag;
         continue;
       }
@@ -39,7 +39,9 @@
 #include <sstream>
 
 #include "common/scoped_ptr.h"
+#include "processor/logging.h"
 #include "processor/postfix_evaluator-inl.h"
+#include "processor/postfix_program-inl.h"
 
 namespace google_breakpad {
 
@@ -47,40 +49,115 @@ namespace google_breakpad {
 #define strtok_r strtok_s
 #endif
 
+void CFIFrameInfo::SetCFARule(const string& expression) {
+  cfa_rule_ = PostfixProgram(expression);
+}
+
+void CFIFrameInfo::SetRARule(const string& expression) {
+  ra_rule_ = PostfixProgram(expression);
+}
+
+void CFIFrameInfo::SetRegisterRule(const string& register_name,
+                                   const string& expression) {
+  register_rules_[register_name] = PostfixProgram(expression);
+}
+
+template<typename V>
+bool CFIFrameInfo::EvaluateRule(const PostfixProgram& rule,
+                                const RegisterValueMap<V>& registers,
+                                const V* cfa,
+                                const MemoryRegion& memory,
+                                V* result) {
+  if (!rule.compiled()) {
+    RegisterValueMap<V> working = registers;
+    if (cfa)
+      working[".cfa"] = *cfa;
+    PostfixEvaluator<V> evaluator(&working, &memory);
+    return evaluator.EvaluateForValue(rule.expression(), result);
+  }
+
+  PostfixProgram::Registers<V> values;
+  rule.LoadRegisters(registers, &values);
+  if (cfa) {
+    int index = rule.FindRegister(".cfa");
+    if (index >= 0) {
+      values.values[index] = *cfa;
+      values.known[index] = true;
+    }
+  }
+  return rule.EvaluateForValue(&values, &memory, result);
+}
+
+int CFIFrameInfo::FindRegisterNumber(const char* const* register_names,
+                                     size_t register_count,
+                                     const string& name) {
+  for (size_t i = 0; i < register_count; ++i) {
+    if (name == register_names[i])
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+template<typename V>
+bool CFIFrameInfo::EvaluateRule(const PostfixProgram& rule,
+                                const char* const* register_names,
+                                size_t register_count,
+                                const RegisterValueArray<V>& registers,
+                                const V* cfa,
+                                const MemoryRegion& memory,
+                                V* result) {
+  if (!rule.compiled()) {
+    RegisterValueMap<V> dictionary;
+    for (size_t i = 0; i < register_count; ++i) {
+      V value;
+      if (registers.Get(i, &value))
+        dictionary[register_names[i]] = value;
+    }
+    return EvaluateRule(rule, dictionary, cfa, memory, result);
+  }
+
+  PostfixProgram::Registers<V> values;
+  for (size_t i = 0; i < rule.register_count(); ++i) {
+    const string& name = rule.register_name(i);
+    if (cfa && name == ".cfa") {
+      values.values[i] = *cfa;
+      values.known[i] = true;
+      continue;
+    }
+    int number = FindRegisterNumber(register_names, register_count, name);
+    if (number >= 0 && registers.Get(number, &values.values[i]))
+      values.known[i] = true;
+  }
+  return rule.EvaluateForValue(&values, &memory, result);
+}
+
 template<typename V>
 bool CFIFrameInfo::FindCallerRegs(const RegisterValueMap<V>& registers,
                                   const MemoryRegion& memory,
                                   RegisterValueMap<V>* caller_registers) const {
   // If there are not rules for both .ra and .cfa in effect at this address,
   // don't use this CFI data for stack walking.
-  if (cfa_rule_.empty() || ra_rule_.empty())
+  if (cfa_rule_.expression().empty() || ra_rule_.expression().empty())
     return false;
 
-  RegisterValueMap<V> working;
-  PostfixEvaluator<V> evaluator(&working, &memory);
-
   caller_registers->clear();
 
   // First, compute the CFA.
   V cfa;
-  working = registers;
-  if (!evaluator.EvaluateForValue(cfa_rule_, &cfa))
+  if (!EvaluateRule(cfa_rule_, registers, static_cast<const V*>(NULL), memory,
+                    &cfa))
     return false;
 
   // Then, compute the return address.
   V ra;
-  working = registers;
-  working[".cfa"] = cfa;
-  if (!evaluator.EvaluateForValue(ra_rule_, &ra))
+  if (!EvaluateRule(ra_rule_, registers, &cfa, memory, &ra))
     return false;
 
   // Now, compute values for all the registers register_rules_ mentions.
   for (RuleMap::const_iterator it = register_rules_.begin();
        it != register_rules_.end(); it++) {
     V value;
-    working = registers;
-    working[".cfa"] = cfa;
-    if (!evaluator.EvaluateForValue(it->second, &value))
+    if (!EvaluateRule(it->second, registers, &cfa, memory, &value))
       return false;
     (*caller_registers)[it->first] = value;
   }
@@ -91,6 +168,55 @@ bool CFIFrameInfo::FindCallerRegs(const RegisterValueMap<V>& registers,
   return true;
 }
 
+template<typename V>
+bool CFIFrameInfo::FindCallerRegs(const char* const* register_names,
+                                  size_t register_count,
+                                  const RegisterValueArray<V>& registers,
+                                  const MemoryRegion& memory,
+                                  RegisterValueArray<V>* caller_registers,
+                                  V* caller_ra,
+                                  V* caller_cfa) const {
+  // If there are not rules for both .ra and .cfa in effect at this address,
+  // don't use this CFI data for stack walking.
+  if (cfa_rule_.expression().empty() || ra_rule_.expression().empty())
+    return false;
+
+  if (register_count > RegisterValueArray<V>::kCapacity) {
+    BPLOG(ERROR) << "Too many registers for a RegisterValueArray: "
+                 << register_count;
+    return false;
+  }
+
+  caller_registers->Clear();
+
+  V cfa;
+  if (!EvaluateRule(cfa_rule_, register_names, register_count, registers,
+                    static_cast<const V*>(NULL), memory, &cfa))
+    return false;
+
+  V ra;
+  if (!EvaluateRule(ra_rule_, register_names, register_count, registers,
+                    &cfa, memory, &ra))
+    return false;
+
+  for (RuleMap::const_iterator it = register_rules_.begin();
+       it != register_rules_.end(); it++) {
+    V value;
+    if (!EvaluateRule(it->second, register_names, register_count, registers,
+                      &cfa, memory, &value))
+      return false;
+    int number = FindRegisterNumber(register_names, register_count,
+                                    it->first);
+    if (number >= 0)
+      caller_registers->Set(number, value);
+  }
+
+  *caller_ra = ra;
+  *caller_cfa = cfa;
+
+  return true;
+}
+
 // Explicit instantiations for 32-bit and 64-bit architectures.
 template bool CFIFrameInfo::FindCallerRegs<uint32_t>(
     const RegisterValueMap<uint32_t>& registers,
@@ -100,29 +226,63 @@ template bool CFIFrameInfo::FindCallerRegs<uint64_t>(
     const RegisterValueMap<uint64_t>& registers,
     const MemoryRegion& memory,
     RegisterValueMap<uint64_t>* caller_registers) const;
+template bool CFIFrameInfo::FindCallerRegs<uint32_t>(
+    const char* const* register_names,
+    size_t register_count,
+    const RegisterValueArray<uint32_t>& registers,
+    const MemoryRegion& memory,
+    RegisterValueArray<uint32_t>* caller_registers,
+    uint32_t* caller_ra,
+    uint32_t* caller_cfa) const;
+template bool CFIFrameInfo::FindCallerRegs<uint64_t>(
+    const char* const* register_names,
+    size_t register_count,
+    const RegisterValueArray<uint64_t>& registers,
+    const MemoryRegion& memory,
+    RegisterValueArray<uint64_t>* caller_registers,
+    uint64_t* caller_ra,
+    uint64_t* caller_cfa) const;
 
 string CFIFrameInfo::Serialize() const {
   std::ostringstream stream;
 
-  if (!cfa_rule_.empty()) {
-    stream << ".cfa: " << cfa_rule_;
+  if (!cfa_rule_.expression().empty()) {
+    stream << ".cfa: " << cfa_rule_.expression();
   }
-  if (!ra_rule_.empty()) {
+  if (!ra_rule_.expression().empty()) {
     if (static_cast<std::streamoff>(stream.tellp()) != 0)
       stream << " ";
-    stream << ".ra: " << ra_rule_;
+    stream << ".ra: " << ra_rule_.expression();
   }
   for (RuleMap::const_iterator iter = register_rules_.begin();
        iter != register_rules_.end();
        ++iter) {
     if (static_cast<std::streamoff>(stream.tellp()) != 0)
       stream << " ";
-    stream << iter->first << ": " << iter->second;
+    stream << iter->first << ": " << iter->second.expression();
   }
 
   return stream.str();
 }
 
+CFIFrameInfo* CFIFrameInfoCache::Find(uint64_t init_address,
+                                      uint64_t delta_address) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  RuleSetMap::const_iterator it =
+      rule_sets_.find(std::make_pair(init_address, delta_address));
+  if (it == rule_sets_.end())
+    return NULL;
+  return new CFIFrameInfo(it->second);
+}
+
+void CFIFrameInfoCache::Insert(uint64_t init_address, uint64_t delta_address,
+                               const CFIFrameInfo& rules) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (rule_sets_.size() >= kMaxEntries)
+    rule_sets_.clear();
+  rule_sets_[std::make_pair(init_address, delta_address)] = rules;
+}
+
 bool CFIRuleParser::Parse(const string& rule_set) {
   size_t rule_set_len = rule_set.size();
   scoped_array<char> working_copy(new char[rule_set_len + 1]);
@@ -39,10 +39,14 @@
 #define PROCESSOR_CFI_FRAME_INFO_H_
 
 #include <map>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
+#include "processor/postfix_program.h"
 
 namespace google_breakpad {
 
@@ -50,6 +54,54 @@ using std::map;
 
 class MemoryRegion;
 
+// A fixed-capacity map from register numbers onto values.  Stack walkers
+// number their registers by position in a table of register names; see
+// CFIFrameInfo::FindCallerRegs.  Unlike CFIFrameInfo::RegisterValueMap,
+// building and querying one never allocates memory, so walkers can use
+// them freely for every frame.
+template<typename ValueType>
+class RegisterValueArray {
+ public:
+  // The most registers an array can hold, numbered 0 to kCapacity - 1.
+  static const size_t kCapacity = 64;
+
+  RegisterValueArray() : present_(0) { }
+
+  // Return true if the array holds a value for register NUMBER.
+  bool Has(size_t number) const {
+    return number < kCapacity && (present_ & Bit(number)) != 0;
+  }
+
+  // If the array holds a value for register NUMBER, set *VALUE to it and
+  // return true.  Otherwise, return false.
+  bool Get(size_t number, ValueType* value) const {
+    if (!Has(number))
+      return false;
+    *value = values_[number];
+    return true;
+  }
+
+  // Set register NUMBER's value to VALUE.  NUMBER must be less than
+  // kCapacity.
+  void Set(size_t number, ValueType value) {
+    values_[number] = value;
+    present_ |= Bit(number);
+  }
+
+  // Forget all register values.
+  void Clear() { present_ = 0; }
+
+ private:
+  static uint64_t Bit(size_t number) {
+    return static_cast<uint64_t>(1) << number;
+  }
+
+  ValueType values_[kCapacity];
+
+  // Bit N is set if values_[N] holds register N's value.
+  uint64_t present_;
+};
+
 // A set of rules for recovering the calling frame's registers'
 // values, when the PC is at a given address in the current frame's
 // function. See the description of 'STACK CFI' records at:
@@ -72,11 +124,11 @@ class CFIFrameInfo {
   // Set the expression for computing a call frame address, return
   // address, or register's value. At least the CFA rule and the RA
   // rule must be set before calling FindCallerRegs.
-  void SetCFARule(const string& expression) { cfa_rule_ = expression; }
-  void SetRARule(const string& expression)  { ra_rule_ = expression; }
-  void SetRegisterRule(const string& register_name, const string& expression) {
-    register_rules_[register_name] = expression;
-  }
+  // Each expression is compiled once, here, so that FindCallerRegs
+  // doesn't have to tokenize it again for every frame.
+  void SetCFARule(const string& expression);
+  void SetRARule(const string& expression);
+  void SetRegisterRule(const string& register_name, const string& expression);
 
   // Compute the values of the calling frame's registers, according to
   // this rule set. Use ValueType in expression evaluation; this
@@ -100,24 +152,63 @@ class CFIFrameInfo {
                       const MemoryRegion& memory,
                       RegisterValueMap<ValueType>* caller_registers) const;
 
+  // Like FindCallerRegs above, but with registers numbered by their
+  // index in REGISTER_NAMES, an array of REGISTER_COUNT names, rather than
+  // named, so that no memory is allocated.  REGISTER_COUNT must be at most
+  // RegisterValueArray::kCapacity.  Rules for registers not in
+  // REGISTER_NAMES are evaluated, but their values are discarded.  The
+  // caller's return address and call frame address, which FindCallerRegs
+  // above stores as ".ra" and ".cfa", are stored in *CALLER_RA and
+  // *CALLER_CFA.
+  template<typename ValueType>
+  bool FindCallerRegs(const char* const* register_names,
+                      size_t register_count,
+                      const RegisterValueArray<ValueType>& registers,
+                      const MemoryRegion& memory,
+                      RegisterValueArray<ValueType>* caller_registers,
+                      ValueType* caller_ra,
+                      ValueType* caller_cfa) const;
+
   // Serialize the rules in this object into a string in the format
   // of STACK CFI records.
   string Serialize() const;
 
  private:
-
-  // A map from register names onto evaluation rules. 
-  typedef map<string, string> RuleMap;
-
-  // In this type, a "postfix expression" is an expression of the sort
-  // interpreted by google_breakpad::PostfixEvaluator.
+  // Evaluate RULE with the values in REGISTERS, and with ".cfa" set to
+  // *CFA if CFA isn't NULL, like PostfixEvaluator::EvaluateForValue.
+  template<typename ValueType>
+  static bool EvaluateRule(const PostfixProgram& rule,
+                           const RegisterValueMap<ValueType>& registers,
+                           const ValueType* cfa,
+                           const MemoryRegion& memory,
+                           ValueType* result);
+
+  // Like EvaluateRule above, but with register values numbered as for
+  // the RegisterValueArray form of FindCallerRegs.
+  template<typename ValueType>
+  static bool EvaluateRule(const PostfixProgram& rule,
+                           const char* const* register_names,
+                           size_t register_count,
+                           const RegisterValueArray<ValueType>& registers,
+                           const ValueType* cfa,
+                           const MemoryRegion& memory,
+                           ValueType* result);
+
+  // Return the index of NAME in REGISTER_NAMES, an array of REGISTER_COUNT
+  // names, or -1 if it isn't there.
+  static int FindRegisterNumber(const char* const* register_names,
+                                size_t register_count,
+                                const string& name);
+
+  // A map from register names onto evaluation rules.
+  typedef map<string, PostfixProgram> RuleMap;
 
   // A postfix expression for computing the current frame's CFA (call
   // frame address). The CFA is a reference address for the frame that
   // remains unchanged throughout the frame's lifetime. You should
   // evaluate this expression with a dictionary initially populated
   // with the values of the current frame's known registers.
-  string cfa_rule_;
+  PostfixProgram cfa_rule_;
 
   // The following expressions should be evaluated with a dictionary
   // initially populated with the values of the current frame's known
@@ -125,8 +216,8 @@ class CFIFrameInfo {
   // cfa_rule expression, above.
 
   // A postfix expression for computing the current frame's return
-  // address. 
-  string ra_rule_;
+  // address.
+  PostfixProgram ra_rule_;
 
   // For a register named REG, rules[REG] is a postfix expression
   // which leaves the value of REG in the calling frame on the top of
@@ -134,6 +225,39 @@ class CFIFrameInfo {
   RuleMap register_rules_;
 };
 
+// A cache of the rule sets a symbol file's STACK CFI records yield, so that
+// each set is parsed and compiled once, however many frames it unwinds.
+// Rule sets are keyed by the address of the STACK CFI INIT record and the
+// address of the last STACK CFI record applied to it, or the INIT record's
+// address again if none was.  The cache holds up to kMaxEntries rule sets,
+// and is safe to use from several threads.
+class CFIFrameInfoCache {
+ public:
+  CFIFrameInfoCache() { }
+
+  // Returns a new copy of the rule set cached under |init_address| and
+  // |delta_address|, owned by the caller, or NULL if there is none.
+  CFIFrameInfo* Find(uint64_t init_address, uint64_t delta_address) const;
+
+  // Caches a copy of |rules| under |init_address| and |delta_address|.
+  void Insert(uint64_t init_address, uint64_t delta_address,
+              const CFIFrameInfo& rules);
+
+ private:
+  // Once the cache is full it is emptied; rule sets are cheap to rebuild
+  // and stack walks reuse only a handful of them.
+  static const size_t kMaxEntries = 4096;
+
+  typedef map<std::pair<uint64_t, uint64_t>, CFIFrameInfo> RuleSetMap;
+
+  mutable std::mutex mutex_;
+  RuleSetMap rule_sets_;
+
+  // Disallow copy constructor and assignment operator.
+  CFIFrameInfoCache(const CFIFrameInfoCache&);
+  void operator=(const CFIFrameInfoCache&);
+};
+
 // A parser for STACK CFI-style rule sets.
 // This may seem bureaucratic: there's no legitimate run-time reason
 // to use a parser/handler pattern for this, as it's not a likely
@@ -241,7 +365,11 @@ class SimpleCFIWalker {
   // RegisterSet structures; MAP_SIZE is the number of elements in the
   // array.
   SimpleCFIWalker(const RegisterSet* register_map, size_t map_size)
-      : register_map_(register_map), map_size_(map_size) { }
+      : register_map_(register_map), map_size_(map_size),
+        register_names_(map_size) {
+    for (size_t i = 0; i < map_size; i++)
+      register_names_[i] = register_map[i].name;
+  }
 
   // Compute the calling frame's raw context given the callee's raw
   // context.
@@ -266,6 +394,10 @@ class SimpleCFIWalker {
  private:
   const RegisterSet* register_map_;
   size_t map_size_;
+
+  // The names of the registers in register_map_, in the same order, so
+  // that registers can be passed to CFIFrameInfo by number.
+  std::vector<const char*> register_names_;
 };
 
 }  // namespace google_breakpad
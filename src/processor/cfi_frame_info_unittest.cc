@@ -32,17 +32,24 @@
 // cfi_frame_info_unittest.cc: Unit tests for CFIFrameInfo,
 // CFIRuleParser, CFIFrameInfoParseHandler, and SimpleCFIWalker.
 
+#include <stdio.h>
 #include <string.h>
 
 #include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
 #include "processor/cfi_frame_info.h"
+#include "processor/postfix_evaluator-inl.h"
 #include "google_breakpad/processor/memory_region.h"
 
 using google_breakpad::CFIFrameInfo;
+using google_breakpad::CFIFrameInfoCache;
 using google_breakpad::CFIFrameInfoParseHandler;
 using google_breakpad::CFIRuleParser;
 using google_breakpad::MemoryRegion;
+using google_breakpad::PostfixEvaluator;
+using google_breakpad::RegisterValueArray;
+using google_breakpad::scoped_ptr;
 using google_breakpad::SimpleCFIWalker;
 using testing::_;
 using testing::A;
@@ -290,6 +297,194 @@ TEST_F(Scope, SeparateTempsRA) {
                                              &caller_registers));
 }
 
+// A memory region that can't be read at odd addresses, and holds
+// address * 7 + 3 everywhere else.
+class FakeMemoryRegion: public MemoryRegion {
+ public:
+  uint64_t GetBase() const { return 0; }
+  uint32_t GetSize() const { return 0xffffffff; }
+  bool GetMemoryAtAddress(uint64_t address, uint8_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint16_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const {
+    return Get(address, value);
+  }
+  void Print() const { }
+
+ private:
+  template<typename T>
+  bool Get(uint64_t address, T* value) const {
+    if (address & 1)
+      return false;
+    *value = static_cast<T>(address * 7 + 3);
+    return true;
+  }
+};
+
+// Rules are run as compiled programs, which should agree with
+// PostfixEvaluator on every expression, including the ones that fail.
+template<typename V>
+static void CheckMatchesPostfixEvaluator(const string& expression) {
+  FakeMemoryRegion memory;
+  CFIFrameInfo::RegisterValueMap<V> registers;
+  registers["$ebp"] = 0x1000;
+  registers["$esp"] = 0x0ff0;
+  registers["$odd"] = 0x1001;
+  for (int i = 0; i < 20; ++i) {
+    char name[8];
+    snprintf(name, sizeof(name), "$r%d", i);
+    registers[name] = i;
+  }
+
+  CFIFrameInfo::RegisterValueMap<V> dictionary = registers;
+  PostfixEvaluator<V> evaluator(&dictionary, &memory);
+  V expected = 0;
+  bool expected_success = evaluator.EvaluateForValue(expression, &expected);
+
+  CFIFrameInfo cfi;
+  cfi.SetCFARule(expression);
+  cfi.SetRARule(".cfa");
+  CFIFrameInfo::RegisterValueMap<V> caller_registers;
+  bool success = cfi.FindCallerRegs<V>(registers, memory, &caller_registers);
+  ASSERT_EQ(expected_success, success) << expression;
+  if (success) {
+    ASSERT_EQ(expected, caller_registers[".cfa"]) << expression;
+    ASSERT_EQ(expected, caller_registers[".ra"]) << expression;
+  }
+}
+
+TEST(Compiled, MatchesPostfixEvaluator) {
+  const char* kExpressions[] = {
+    "1", "-1", "+5", "-+5", "4294967295", "4294967296",
+    "18446744073709551615", "18446744073709551616", "0x10", "5x",
+    "$ebp", "$nope", "$ebp 4 +", "$ebp 8 - ^", "$odd ^", "$esp 16 @",
+    "$ebp $esp *", "$ebp 3 /", "$ebp 3 %", "$ebp $esp -",
+    "$T0 $ebp 8 + = $T0 ^ $T0 +", "$T0 $ebp 8 + =$T1 $T0 4 - = $T1",
+    "$T0 1 = $T0 $T0 2 = $T0 +", "$T0 $T1 =", "5 3 =", "$ebp 3 =",
+    ".cfa 4 +", "1 2", "+", "^", "", "$T0 4 = $T0 $T0 ^ =",
+    "$r0 $r1 + $r2 + $r3 + $r4 + $r5 + $r6 + $r7 + $r8 + $r9 + $r10 + "
+    "$r11 + $r12 + $r13 + $r14 + $r15 + $r16 + $r17 + $r18 + $r19 +",
+    "1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 "
+    "27 28 29 30 31 32 33 34 + + + + + + + + + + + + + + + + + + + + + + + "
+    "+ + + + + + + + + +",
+  };
+  for (size_t i = 0; i < sizeof(kExpressions) / sizeof(kExpressions[0]);
+       ++i) {
+    CheckMatchesPostfixEvaluator<uint32_t>(kExpressions[i]);
+    CheckMatchesPostfixEvaluator<uint64_t>(kExpressions[i]);
+  }
+}
+
+// Unlike PostfixEvaluator, compiled rules fail on division by zero.
+TEST(Compiled, DivisionByZero) {
+  FakeMemoryRegion memory;
+  CFIFrameInfo::RegisterValueMap<uint64_t> registers, caller_registers;
+  registers["$ebp"] = 0x1000;
+  CFIFrameInfo cfi;
+  cfi.SetCFARule("$ebp 0 /");
+  cfi.SetRARule("0");
+  ASSERT_FALSE(cfi.FindCallerRegs<uint64_t>(registers, memory,
+                                             &caller_registers));
+  cfi.SetCFARule("$ebp 0 %");
+  ASSERT_FALSE(cfi.FindCallerRegs<uint64_t>(registers, memory,
+                                             &caller_registers));
+}
+
+TEST(CFIFrameInfoCache, FindAndInsert) {
+  CFIFrameInfoCache cache;
+  ASSERT_EQ(NULL, cache.Find(0x1000, 0x1000));
+
+  CFIFrameInfo rules;
+  rules.SetCFARule("$esp 4 +");
+  rules.SetRARule(".cfa ^");
+  cache.Insert(0x1000, 0x1000, rules);
+  rules.SetCFARule("$esp 8 +");
+  cache.Insert(0x1000, 0x1010, rules);
+
+  scoped_ptr<CFIFrameInfo> found(cache.Find(0x1000, 0x1000));
+  ASSERT_TRUE(found.get());
+  ASSERT_EQ(".cfa: $esp 4 + .ra: .cfa ^", found->Serialize());
+  found.reset(cache.Find(0x1000, 0x1010));
+  ASSERT_TRUE(found.get());
+  ASSERT_EQ(".cfa: $esp 8 + .ra: .cfa ^", found->Serialize());
+  ASSERT_EQ(NULL, cache.Find(0x1010, 0x1010));
+
+  // A full cache makes room for new rule sets.
+  for (uint64_t address = 0x2000; address < 0x4000; ++address)
+    cache.Insert(address, address, rules);
+  found.reset(cache.Find(0x3fff, 0x3fff));
+  ASSERT_TRUE(found.get());
+}
+
+TEST(RegisterValueArray, SetAndGet) {
+  RegisterValueArray<uint64_t> registers;
+  uint64_t value = 0;
+  ASSERT_FALSE(registers.Has(0));
+  ASSERT_FALSE(registers.Get(63, &value));
+  registers.Set(0, 0x1234);
+  registers.Set(63, 0x5678);
+  ASSERT_TRUE(registers.Get(0, &value));
+  ASSERT_EQ(0x1234U, value);
+  ASSERT_TRUE(registers.Get(63, &value));
+  ASSERT_EQ(0x5678U, value);
+  ASSERT_FALSE(registers.Has(1));
+  ASSERT_FALSE(registers.Has(64));
+  registers.Clear();
+  ASSERT_FALSE(registers.Has(0));
+  ASSERT_FALSE(registers.Has(63));
+}
+
+// The RegisterValueArray form of FindCallerRegs gives the same results
+// as the RegisterValueMap form.
+TEST(RegisterValueArray, FindCallerRegsMatchesMap) {
+  static const char* const kNames[] = { "$esp", "$ebp", "$ebx", "$esi" };
+  static const size_t kCount = sizeof(kNames) / sizeof(kNames[0]);
+  FakeMemoryRegion memory;
+  CFIFrameInfo::RegisterValueMap<uint32_t> map_registers, map_caller;
+  RegisterValueArray<uint32_t> registers, caller;
+  map_registers["$esp"] = 0x1000;
+  map_registers["$ebp"] = 0x2000;
+  map_registers["$ebx"] = 0x3000;
+  registers.Set(0, 0x1000);
+  registers.Set(1, 0x2000);
+  registers.Set(2, 0x3000);
+
+  CFIFrameInfo cfi;
+  cfi.SetCFARule("$esp 8 +");
+  cfi.SetRARule(".cfa 4 - ^");
+  cfi.SetRegisterRule("$ebp", ".cfa 8 - ^");
+  cfi.SetRegisterRule("$ebx", "$T0 $ebx 2 * = $T0 1 +");
+  cfi.SetRegisterRule("$unnumbered", "$esp");
+  ASSERT_TRUE(cfi.FindCallerRegs<uint32_t>(map_registers, memory,
+                                           &map_caller));
+  uint32_t ra, cfa;
+  ASSERT_TRUE(cfi.FindCallerRegs<uint32_t>(kNames, kCount, registers, memory,
+                                           &caller, &ra, &cfa));
+  ASSERT_EQ(map_caller[".ra"], ra);
+  ASSERT_EQ(map_caller[".cfa"], cfa);
+  for (size_t i = 0; i < kCount; ++i) {
+    uint32_t value;
+    CFIFrameInfo::RegisterValueMap<uint32_t>::const_iterator it =
+        map_caller.find(kNames[i]);
+    ASSERT_EQ(it != map_caller.end(), caller.Get(i, &value)) << kNames[i];
+    if (it != map_caller.end())
+      ASSERT_EQ(it->second, value) << kNames[i];
+  }
+
+  // A rule using a register with no value fails, as with the map.
+  cfi.SetRegisterRule("$esi", "$esi 4 +");
+  ASSERT_FALSE(cfi.FindCallerRegs<uint32_t>(map_registers, memory,
+                                            &map_caller));
+  ASSERT_FALSE(cfi.FindCallerRegs<uint32_t>(kNames, kCount, registers, memory,
+                                            &caller, &ra, &cfa));
+}
+
 class MockCFIRuleParserHandler: public CFIRuleParser::Handler {
  public:
   MOCK_METHOD1(CFARule, void(const string&));
@@ -0,0 +1,165 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// code_module_string_table.h: The strings of a list of code modules, kept
+// together.
+//
+// Each code module has five strings: its code file, code identifier, debug
+// file, debug identifier and version.  Kept as std::string members, these
+// cost an allocation apiece every time a module is copied, and the modules
+// of a dump are copied more than once on their way into a ProcessState.
+// CodeModuleStringTable appends the strings to a single buffer instead,
+// storing each distinct string once, and modules refer to them by index.
+// The modules of a BasicCodeModules share one table, as do copies of those
+// modules, so copying them doesn't copy any strings.
+//
+// Unlike StringPool, which lets a resolver free each module's symbol
+// strings as the module is unloaded, a table only grows: a list of modules
+// is built all at once and dropped all at once.  An index stays valid as
+// more strings are added.  Adding strings isn't thread-safe, but reading
+// them from a table that's no longer being added to is.
+
+#ifndef PROCESSOR_CODE_MODULE_STRING_TABLE_H__
+#define PROCESSOR_CODE_MODULE_STRING_TABLE_H__
+
+#include <stddef.h>
+#include <string.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class CodeModuleStringTable {
+ public:
+  typedef uint32_t Index;
+
+  CodeModuleStringTable() {}
+
+  // Empties the table, keeping its storage.
+  void Clear() {
+    buffer_.clear();
+    entries_.clear();
+    slots_.assign(slots_.size(), Index(kEmptySlot));
+  }
+
+  // Makes room for |strings| distinct strings of |bytes| bytes in total.
+  void Reserve(size_t strings, size_t bytes) {
+    buffer_.reserve(bytes);
+    entries_.reserve(strings);
+    size_t slot_count = kMinimumSlots;
+    while (slot_count * 3 / 4 < strings)
+      slot_count *= 2;
+    if (slot_count > slots_.size())
+      Rehash(slot_count);
+  }
+
+  // Returns the index of |value|, storing it first unless an identical
+  // string is already stored.
+  Index Add(const string& value) {
+    if ((entries_.size() + 1) * 4 > slots_.size() * 3)
+      Rehash(slots_.empty() ? kMinimumSlots : slots_.size() * 2);
+
+    size_t hash = std::hash<string>()(value);
+    size_t mask = slots_.size() - 1;
+    size_t slot = hash & mask;
+    while (slots_[slot] != kEmptySlot) {
+      const Entry& entry = entries_[slots_[slot]];
+      if (entry.hash == hash && entry.length == value.size() &&
+          (entry.length == 0 ||
+           memcmp(buffer_.data() + entry.offset, value.data(),
+                  entry.length) == 0)) {
+        return slots_[slot];
+      }
+      slot = (slot + 1) & mask;
+    }
+
+    Entry entry = { buffer_.size(), value.size(), hash };
+    buffer_.insert(buffer_.end(), value.begin(), value.end());
+    Index index = static_cast<Index>(entries_.size());
+    entries_.push_back(entry);
+    slots_[slot] = index;
+    return index;
+  }
+
+  // Returns the string at |index|, which must have been returned by Add.
+  string Get(Index index) const {
+    const Entry& entry = entries_[index];
+    if (entry.length == 0)
+      return string();
+    return string(buffer_.data() + entry.offset, entry.length);
+  }
+
+  // The number of distinct strings stored.
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    size_t offset;
+    size_t length;
+    size_t hash;
+  };
+
+  static const Index kEmptySlot = static_cast<Index>(-1);
+  static const size_t kMinimumSlots = 16;
+
+  // Sizes slots_ to |slot_count|, a power of two, and refills it.
+  void Rehash(size_t slot_count) {
+    slots_.assign(slot_count, Index(kEmptySlot));
+    size_t mask = slot_count - 1;
+    for (Index index = 0; index < entries_.size(); ++index) {
+      size_t slot = entries_[index].hash & mask;
+      while (slots_[slot] != kEmptySlot)
+        slot = (slot + 1) & mask;
+      slots_[slot] = index;
+    }
+  }
+
+  // The characters of every stored string, one after another.
+  std::vector<char> buffer_;
+
+  // Where each string lies in buffer_, by index.
+  std::vector<Entry> entries_;
+
+  // An open-addressed hash table of indices into entries_, used to find a
+  // string that's already stored.
+  std::vector<Index> slots_;
+
+  // Disallow copy constructor and assignment operator.
+  CodeModuleStringTable(const CodeModuleStringTable& that);
+  void operator=(const CodeModuleStringTable& that);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_CODE_MODULE_STRING_TABLE_H__
@@ -0,0 +1,192 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// code_module_string_table_unittest.cc: Unit tests for
+// CodeModuleStringTable, and for the BasicCodeModule and BasicCodeModules
+// objects that share one.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "processor/basic_code_module.h"
+#include "processor/basic_code_modules.h"
+#include "processor/code_module_string_table.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicCodeModules;
+using google_breakpad::CodeModule;
+using google_breakpad::CodeModuleStringTable;
+using google_breakpad::CodeModules;
+using google_breakpad::MergeRangeStrategy;
+using std::vector;
+
+TEST(CodeModuleStringTable, StoresDistinctStringsOnce) {
+  CodeModuleStringTable table;
+  CodeModuleStringTable::Index a = table.Add("kernel32.dll");
+  CodeModuleStringTable::Index empty = table.Add("");
+  CodeModuleStringTable::Index b = table.Add("ntdll.dll");
+  EXPECT_EQ(a, table.Add("kernel32.dll"));
+  EXPECT_EQ(empty, table.Add(""));
+  EXPECT_EQ(b, table.Add("ntdll.dll"));
+  EXPECT_NE(a, b);
+  EXPECT_EQ(3U, table.size());
+  EXPECT_EQ("kernel32.dll", table.Get(a));
+  EXPECT_EQ("", table.Get(empty));
+  EXPECT_EQ("ntdll.dll", table.Get(b));
+}
+
+TEST(CodeModuleStringTable, Grows) {
+  CodeModuleStringTable table;
+  vector<CodeModuleStringTable::Index> indices;
+  for (int i = 0; i < 1000; ++i)
+    indices.push_back(table.Add("module" + std::to_string(i) + ".so"));
+  for (int i = 0; i < 1000; ++i) {
+    string name = "module" + std::to_string(i) + ".so";
+    EXPECT_EQ(name, table.Get(indices[i]));
+    EXPECT_EQ(indices[i], table.Add(name));
+  }
+  EXPECT_EQ(1000U, table.size());
+}
+
+TEST(CodeModuleStringTable, Clear) {
+  CodeModuleStringTable table;
+  table.Reserve(10, 100);
+  table.Add("a");
+  table.Add("b");
+  table.Clear();
+  EXPECT_EQ(0U, table.size());
+  CodeModuleStringTable::Index b = table.Add("b");
+  EXPECT_EQ(0U, b);
+  EXPECT_EQ("b", table.Get(b));
+}
+
+// A CodeModules that isn't a BasicCodeModules, holding BasicCodeModule
+// objects of its own.
+class TestCodeModules : public CodeModules {
+ public:
+  void Add(CodeModule* module) { modules_.push_back(module); }
+  ~TestCodeModules() {
+    for (size_t i = 0; i < modules_.size(); ++i)
+      delete modules_[i];
+  }
+
+  unsigned int module_count() const {
+    return static_cast<unsigned int>(modules_.size());
+  }
+  const CodeModule* GetModuleForAddress(uint64_t address) const {
+    return NULL;
+  }
+  const CodeModule* GetMainModule() const {
+    return modules_.empty() ? NULL : modules_[0];
+  }
+  const CodeModule* GetModuleAtSequence(unsigned int sequence) const {
+    return modules_[sequence];
+  }
+  const CodeModule* GetModuleAtIndex(unsigned int index) const {
+    return modules_[index];
+  }
+  const CodeModules* Copy() const { return NULL; }
+  vector<google_breakpad::linked_ptr<const CodeModule> >
+  GetShrunkRangeModules() const {
+    return vector<google_breakpad::linked_ptr<const CodeModule> >();
+  }
+
+ private:
+  vector<CodeModule*> modules_;
+};
+
+void ExpectSameModule(const CodeModule* expected, const CodeModule* actual) {
+  ASSERT_TRUE(actual);
+  EXPECT_EQ(expected->base_address(), actual->base_address());
+  EXPECT_EQ(expected->size(), actual->size());
+  EXPECT_EQ(expected->code_file(), actual->code_file());
+  EXPECT_EQ(expected->code_identifier(), actual->code_identifier());
+  EXPECT_EQ(expected->debug_file(), actual->debug_file());
+  EXPECT_EQ(expected->debug_identifier(), actual->debug_identifier());
+  EXPECT_EQ(expected->version(), actual->version());
+}
+
+TEST(BasicCodeModules, CopiesShareStrings) {
+  TestCodeModules modules;
+  modules.Add(new BasicCodeModule(0x1000, 0x1000, "main", "id1", "main.pdb",
+                                  "debugid1", "1.0"));
+  modules.Add(new BasicCodeModule(0x3000, 0x1000, "libc.so", "id2",
+                                  "libc.so", "debugid2", "1.0"));
+
+  std::unique_ptr<BasicCodeModules> basic(
+      new BasicCodeModules(&modules, MergeRangeStrategy::kExclusiveRanges));
+  ASSERT_EQ(2U, basic->module_count());
+  std::unique_ptr<const CodeModules> copy(basic->Copy());
+  ASSERT_EQ(2U, copy->module_count());
+
+  // Copies outlive the objects they were copied from.
+  std::unique_ptr<CodeModule> module_copy(
+      basic->GetModuleForAddress(0x3000)->Copy());
+  basic.reset();
+  for (unsigned int i = 0; i < 2; ++i) {
+    ExpectSameModule(modules.GetModuleAtIndex(i),
+                     copy->GetModuleForAddress(
+                         modules.GetModuleAtIndex(i)->base_address()));
+  }
+  ExpectSameModule(modules.GetModuleAtIndex(1), module_copy.get());
+  EXPECT_EQ("main", copy->GetMainModule()->code_file());
+}
+
+TEST(BasicCodeModules, Reassign) {
+  TestCodeModules first;
+  first.Add(new BasicCodeModule(0x1000, 0x1000, "first", "", "", "", ""));
+  TestCodeModules second;
+  second.Add(new BasicCodeModule(0x2000, 0x1000, "second", "", "", "", ""));
+
+  BasicCodeModules modules;
+  modules.Assign(&first, MergeRangeStrategy::kExclusiveRanges);
+  std::unique_ptr<CodeModule> kept(
+      modules.GetModuleForAddress(0x1000)->Copy());
+  modules.Assign(&second, MergeRangeStrategy::kExclusiveRanges);
+  ASSERT_EQ(1U, modules.module_count());
+  EXPECT_EQ("second", modules.GetModuleForAddress(0x2000)->code_file());
+  EXPECT_EQ(NULL, modules.GetModuleForAddress(0x1000));
+  EXPECT_EQ("first", kept->code_file());
+
+  modules.Assign(&first, MergeRangeStrategy::kExclusiveRanges);
+  EXPECT_EQ("first", modules.GetModuleForAddress(0x1000)->code_file());
+  EXPECT_EQ("first", kept->code_file());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
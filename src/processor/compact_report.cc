@@ -0,0 +1,168 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compact_report.cc: A compact report reader.
+//
+// See compact_report.h for documentation.
+
+#include "google_breakpad/processor/compact_report.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/minidump_format.h"
+#include "processor/basic_code_module.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The identifiers minidumps give an ELF module with |build_id|: the code
+// identifier is the build ID in hex, and the debug identifier is as many
+// of its bytes as fit in a GUID, formatted as one with age 0.
+void BuildIdToIdentifiers(const uint8_t* build_id, size_t build_id_size,
+                          string* code_identifier, string* debug_identifier) {
+  code_identifier->clear();
+  debug_identifier->clear();
+  if (build_id_size == 0)
+    return;
+
+  for (size_t i = 0; i < build_id_size; ++i) {
+    char hexbyte[3];
+    snprintf(hexbyte, sizeof(hexbyte), "%02x", build_id[i]);
+    *code_identifier += hexbyte;
+  }
+
+  MDGUID guid;
+  memset(&guid, 0, sizeof(guid));
+  memcpy(&guid, build_id,
+         build_id_size < sizeof(guid) ? build_id_size : sizeof(guid));
+  char identifier_string[41];
+  snprintf(identifier_string, sizeof(identifier_string),
+           "%08X%04X%04X%02X%02X%02X%02X%02X%02X%02X%02X%x",
+           guid.data1, guid.data2, guid.data3,
+           guid.data4[0], guid.data4[1], guid.data4[2], guid.data4[3],
+           guid.data4[4], guid.data4[5], guid.data4[6], guid.data4[7],
+           0);
+  *debug_identifier = identifier_string;
+}
+
+}  // namespace
+
+CompactReport::CompactReport(StringView contents)
+    : valid_(false),
+      modules_(new MicrodumpModules),
+      system_info_(new SystemInfo()) {
+  memset(&header_, 0, sizeof(header_));
+  if (contents.size() < sizeof(header_)) {
+    BPLOG(ERROR) << "Compact report too small for its header";
+    return;
+  }
+  memcpy(&header_, contents.data(), sizeof(header_));
+  if (header_.signature != MD_COMPACT_REPORT_SIGNATURE ||
+      header_.version != MD_COMPACT_REPORT_VERSION) {
+    BPLOG(ERROR) << "Not a compact report this reader understands";
+    return;
+  }
+  const uint64_t modules_size =
+      static_cast<uint64_t>(header_.module_count) *
+      sizeof(MDCompactReportModule);
+  const uint64_t frames_size =
+      static_cast<uint64_t>(header_.frame_count) * sizeof(uint64_t);
+  if (contents.size() - sizeof(header_) < modules_size + frames_size) {
+    BPLOG(ERROR) << "Compact report too small for its modules and frames";
+    return;
+  }
+
+  const char* data = contents.data() + sizeof(header_);
+  for (uint32_t i = 0; i < header_.module_count; ++i) {
+    MDCompactReportModule module;
+    memcpy(&module, data, sizeof(module));
+    data += sizeof(module);
+
+    if (module.build_id_size > sizeof(module.build_id))
+      module.build_id_size = sizeof(module.build_id);
+    module.name[sizeof(module.name) - 1] = '\0';
+    string code_identifier, debug_identifier;
+    BuildIdToIdentifiers(module.build_id, module.build_id_size,
+                         &code_identifier, &debug_identifier);
+    modules_->AddUnindexed(new BasicCodeModule(
+        module.base_address,        // base_address
+        module.size,                // size
+        module.name,                // code_file
+        code_identifier,            // code_identifier
+        module.name,                // debug_file
+        debug_identifier,           // debug_identifier
+        ""));                       // version
+  }
+  modules_->BuildIndex();
+
+  frames_.resize(header_.frame_count);
+  if (header_.frame_count)
+    memcpy(&frames_[0], data, frames_size);
+
+  switch (header_.processor_architecture) {
+    case MD_CPU_ARCHITECTURE_X86:
+      system_info_->cpu = "x86";
+      break;
+    case MD_CPU_ARCHITECTURE_AMD64:
+      system_info_->cpu = "amd64";
+      break;
+    case MD_CPU_ARCHITECTURE_ARM:
+      system_info_->cpu = "arm";
+      break;
+    case MD_CPU_ARCHITECTURE_ARM64:
+    case MD_CPU_ARCHITECTURE_ARM64_OLD:
+      system_info_->cpu = "arm64";
+      break;
+    case MD_CPU_ARCHITECTURE_MIPS:
+      system_info_->cpu = "mips";
+      break;
+    case MD_CPU_ARCHITECTURE_MIPS64:
+      system_info_->cpu = "mips64";
+      break;
+  }
+  switch (header_.platform_id) {
+    case MD_OS_LINUX:
+      system_info_->os = "Linux";
+      system_info_->os_short = "linux";
+      break;
+    case MD_OS_ANDROID:
+      system_info_->os = "Android";
+      system_info_->os_short = "android";
+      break;
+  }
+  valid_ = true;
+}
+
+}  // namespace google_breakpad
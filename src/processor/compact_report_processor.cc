@@ -0,0 +1,122 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compact_report_processor.cc: A compact report processor.
+//
+// See compact_report_processor.h for documentation.
+
+#include "google_breakpad/processor/compact_report_processor.h"
+
+#include <assert.h>
+
+#include <vector>
+
+#include "common/scoped_ptr.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/compact_report.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/frame_arena.h"
+#include "processor/logging.h"
+#include "processor/stackwalker_address_list.h"
+
+namespace google_breakpad {
+
+CompactReportProcessor::CompactReportProcessor(
+    StackFrameSymbolizer* frame_symbolizer)
+    : frame_symbolizer_(frame_symbolizer) {
+  assert(frame_symbolizer);
+}
+
+CompactReportProcessor::~CompactReportProcessor() {}
+
+ProcessResult CompactReportProcessor::Process(CompactReport* report,
+                                              ProcessState* process_state) {
+  assert(process_state);
+
+  process_state->Clear();
+
+  if (!report->valid()) {
+    BPLOG(ERROR) << "Can't process an invalid compact report";
+    return PROCESS_ERROR_NO_MINIDUMP_HEADER;
+  }
+  if (report->frames().empty()) {
+    BPLOG(ERROR) << "Compact report has no frames";
+    return PROCESS_ERROR_NO_THREAD_LIST;
+  }
+
+  // Return addresses are moved back into the call instruction, as the
+  // other stackwalkers do, so that they are symbolized as the call.
+  std::vector<uint64_t> frames(report->frames());
+  for (size_t i = 1; i < frames.size(); ++i)
+    frames[i] -= 1;
+
+  process_state->modules_ = report->GetModules()->Copy();
+  ScopedFrameArena frame_arena(process_state->frame_arena_);
+  StackwalkerAddressList stackwalker(&frames[0], frames.size(),
+                                     process_state->modules_,
+                                     frame_symbolizer_);
+
+  scoped_ptr<CallStack> stack(new CallStack());
+  if (!stackwalker.Walk(stack.get(),
+                        &process_state->modules_without_symbols_,
+                        &process_state->modules_with_corrupt_symbols_)) {
+    BPLOG(INFO) << "Processing was interrupted.";
+    return PROCESS_SYMBOL_SUPPLIER_INTERRUPTED;
+  }
+  stack->set_tid(report->header().thread_id);
+
+  process_state->threads_.push_back(stack.release());
+  process_state->thread_memory_regions_.push_back(NULL);
+  process_state->crashed_ = false;
+  process_state->requesting_thread_ = 0;
+  process_state->time_date_stamp_ = report->header().time;
+  process_state->process_create_time_ = 0;
+  process_state->system_info_ = *report->GetSystemInfo();
+
+  return PROCESS_OK;
+}
+
+size_t CompactReportProcessor::ProcessBatch(
+    const std::vector<StringView>& reports,
+    BatchCallback callback,
+    void* context) {
+  size_t processed = 0;
+  for (size_t i = 0; i < reports.size(); ++i) {
+    ProcessState process_state;
+    CompactReport report(reports[i]);
+    const ProcessResult result = Process(&report, &process_state);
+    if (result == PROCESS_OK)
+      ++processed;
+    callback(i, result, process_state, context);
+  }
+  return processed;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,213 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Unit test for CompactReport and CompactReportProcessor.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/common/compact_report_format.h"
+#include "google_breakpad/common/minidump_format.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/compact_report.h"
+#include "google_breakpad/processor/compact_report_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/stackwalker_unittest_utils.h"
+
+namespace {
+
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CodeModule;
+using google_breakpad::CompactReport;
+using google_breakpad::CompactReportProcessor;
+using google_breakpad::ProcessState;
+using google_breakpad::StackFrame;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::StringView;
+using testing::_;
+using testing::AnyNumber;
+using testing::DoAll;
+using testing::Property;
+using testing::Return;
+using testing::SetArgumentPointee;
+
+const uint64_t kSymbolsBase = 0x7f0000000000ULL;
+const uint64_t kNoSymbolsBase = 0x500000000000ULL;
+
+class CompactReportProcessorTest : public ::testing::Test {
+ public:
+  CompactReportProcessorTest() {
+    EXPECT_CALL(supplier_, GetCStringSymbolData(_, _, _, _, _))
+        .WillRepeatedly(Return(MockSymbolSupplier::NOT_FOUND));
+    EXPECT_CALL(supplier_, FreeSymbolData(_)).Times(AnyNumber());
+
+    memset(&header_, 0, sizeof(header_));
+    header_.signature = MD_COMPACT_REPORT_SIGNATURE;
+    header_.version = MD_COMPACT_REPORT_VERSION;
+    header_.processor_architecture = MD_CPU_ARCHITECTURE_AMD64;
+    header_.platform_id = MD_OS_LINUX;
+    header_.thread_id = 1234;
+    header_.time = 1700000000;
+
+    AddModule(kSymbolsBase, "libsymbols.so", 20);
+    AddModule(kNoSymbolsBase, "libnosymbols.so", 0);
+
+    // An instruction in Inner, called by Outer, called from a module
+    // without symbols.
+    frames_.push_back(kSymbolsBase + 0x1010);
+    frames_.push_back(kSymbolsBase + 0x2050);
+    frames_.push_back(kNoSymbolsBase + 0x3000);
+  }
+
+  void AddModule(uint64_t base, const char* name, uint32_t build_id_size) {
+    MDCompactReportModule module;
+    memset(&module, 0, sizeof(module));
+    module.base_address = base;
+    module.size = 0x10000;
+    module.build_id_size = build_id_size;
+    for (uint32_t i = 0; i < build_id_size; ++i)
+      module.build_id[i] = i;
+    strncpy(module.name, name, sizeof(module.name) - 1);
+    modules_.push_back(module);
+  }
+
+  string Serialize() {
+    header_.module_count = modules_.size();
+    header_.frame_count = frames_.size();
+    string report(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    report.append(reinterpret_cast<const char*>(&modules_[0]),
+                  modules_.size() * sizeof(modules_[0]));
+    report.append(reinterpret_cast<const char*>(&frames_[0]),
+                  frames_.size() * sizeof(frames_[0]));
+    return report;
+  }
+
+  MDCompactReportHeader header_;
+  std::vector<MDCompactReportModule> modules_;
+  std::vector<uint64_t> frames_;
+  MockSymbolSupplier supplier_;
+  BasicSourceLineResolver resolver_;
+};
+
+TEST_F(CompactReportProcessorTest, ReadsModules) {
+  const string contents = Serialize();
+  CompactReport report(contents);
+  ASSERT_TRUE(report.valid());
+  ASSERT_EQ(2U, report.GetModules()->module_count());
+  ASSERT_EQ(3U, report.frames().size());
+  EXPECT_EQ("amd64", report.GetSystemInfo()->cpu);
+  EXPECT_EQ("linux", report.GetSystemInfo()->os_short);
+
+  const CodeModule* module =
+      report.GetModules()->GetModuleForAddress(kSymbolsBase + 0x1010);
+  ASSERT_TRUE(module);
+  EXPECT_EQ("libsymbols.so", module->code_file());
+  EXPECT_EQ("libsymbols.so", module->debug_file());
+  EXPECT_EQ("000102030405060708090a0b0c0d0e0f10111213",
+            module->code_identifier());
+  // As minidumps give ELF modules with a build ID.
+  EXPECT_EQ("030201000504070608090A0B0C0D0E0F0", module->debug_identifier());
+
+  module = report.GetModules()->GetModuleForAddress(kNoSymbolsBase);
+  ASSERT_TRUE(module);
+  EXPECT_EQ("", module->debug_identifier());
+}
+
+TEST_F(CompactReportProcessorTest, RejectsBadReports) {
+  string contents = Serialize();
+  EXPECT_FALSE(CompactReport(StringView(contents.data(), 10)).valid());
+  EXPECT_FALSE(
+      CompactReport(StringView(contents.data(), contents.size() - 1)).valid());
+  contents[0] ^= 1;
+  EXPECT_FALSE(CompactReport(contents).valid());
+
+  StackFrameSymbolizer frame_symbolizer(&supplier_, &resolver_);
+  CompactReportProcessor processor(&frame_symbolizer);
+  ProcessState state;
+  CompactReport report(contents);
+  EXPECT_NE(google_breakpad::PROCESS_OK, processor.Process(&report, &state));
+}
+
+TEST_F(CompactReportProcessorTest, SymbolizesFrames) {
+  size_t buffer_size;
+  char* buffer = supplier_.CopySymbolDataAndOwnTheCopy(
+      "MODULE Linux x86_64 030201000504070608090A0B0C0D0E0F0 libsymbols.so\n"
+      "FUNC 1000 100 0 Inner\n"
+      "FUNC 2000 100 0 Outer\n",
+      &buffer_size);
+  EXPECT_CALL(supplier_,
+              GetCStringSymbolData(
+                  Property(&CodeModule::code_file, "libsymbols.so"),
+                  _, _, _, _))
+      .WillRepeatedly(DoAll(SetArgumentPointee<3>(buffer),
+                            SetArgumentPointee<4>(buffer_size),
+                            Return(MockSymbolSupplier::FOUND)));
+
+  const string contents = Serialize();
+  CompactReport report(contents);
+  StackFrameSymbolizer frame_symbolizer(&supplier_, &resolver_);
+  CompactReportProcessor processor(&frame_symbolizer);
+  ProcessState state;
+  ASSERT_EQ(google_breakpad::PROCESS_OK, processor.Process(&report, &state));
+
+  EXPECT_FALSE(state.crashed());
+  EXPECT_EQ(0, state.requesting_thread());
+  EXPECT_EQ(1700000000U, state.time_date_stamp());
+  EXPECT_EQ("amd64", state.system_info()->cpu);
+  ASSERT_EQ(1U, state.threads()->size());
+  const google_breakpad::CallStack* stack = state.threads()->at(0);
+  EXPECT_EQ(1234U, stack->tid());
+  const std::vector<StackFrame*>& frames = *stack->frames();
+  ASSERT_EQ(3U, frames.size());
+
+  EXPECT_EQ(kSymbolsBase + 0x1010, frames[0]->instruction);
+  EXPECT_EQ("Inner", frames[0]->function_name);
+  // Return addresses are symbolized as their calls.
+  EXPECT_EQ(kSymbolsBase + 0x204f, frames[1]->instruction);
+  EXPECT_EQ("Outer", frames[1]->function_name);
+  EXPECT_EQ(kNoSymbolsBase + 0x2fff, frames[2]->instruction);
+  ASSERT_TRUE(frames[2]->module);
+  EXPECT_EQ("libnosymbols.so", frames[2]->module->code_file());
+  EXPECT_EQ("", frames[2]->function_name);
+
+  ASSERT_EQ(1U, state.modules_without_symbols()->size());
+  EXPECT_EQ("libnosymbols.so",
+            state.modules_without_symbols()->at(0)->code_file());
+}
+
+}  // namespace
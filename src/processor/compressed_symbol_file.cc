@@ -0,0 +1,329 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compressed_symbol_file.cc: Reads symbol files stored compressed.
+//
+// See compressed_symbol_file.h for documentation.
+
+#include "processor/compressed_symbol_file.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <vector>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+const unsigned char kGzipMagic[] = { 0x1f, 0x8b };
+const unsigned char kZstdMagic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+// How much compressed input is read from the file at a time.
+const size_t kChunkSize = 64 * 1024;
+
+// The most a file's recorded uncompressed size may exceed its compressed
+// size by and still be trusted to size the output buffer up front.  Deflate
+// can't do much better than this; a larger claim is more likely damage than
+// a genuine file, and the buffer is then grown as the data arrives instead.
+const uint64_t kMaxTrustedRatio = 1032;
+
+class ScopedFile {
+ public:
+  explicit ScopedFile(FILE* file) : file_(file) {}
+  ~ScopedFile() {
+    if (file_)
+      fclose(file_);
+  }
+  FILE* get() const { return file_; }
+
+ private:
+  FILE* file_;
+
+  ScopedFile(const ScopedFile&);
+  void operator=(const ScopedFile&);
+};
+
+// The decompressed text, in a new[] buffer that is grown as needed and
+// always has room left for the null terminator.
+class OutputBuffer {
+ public:
+  // Sizes the buffer for |expected_size| bytes of text, if that's known.
+  explicit OutputBuffer(size_t expected_size)
+      : data_(NULL), size_(0), capacity_(0) {
+    Grow(std::max(expected_size, kChunkSize));
+  }
+  ~OutputBuffer() { delete [] data_; }
+
+  // Ensures there is room for at least one more byte of text, and returns
+  // where it goes and how much room there is.
+  char* Space(size_t* space_size) {
+    if (size_ == capacity_)
+      Grow(capacity_ * 2);
+    *space_size = capacity_ - size_;
+    return data_ + size_;
+  }
+
+  // Accounts for |size| bytes written at Space().
+  void Advance(size_t size) { size_ += size; }
+
+  // Terminates the text and hands the buffer over to the caller.
+  char* Release(size_t* size) {
+    data_[size_] = '\0';
+    *size = size_ + 1;
+    char* data = data_;
+    data_ = NULL;
+    return data;
+  }
+
+ private:
+  void Grow(size_t capacity) {
+    char* data = new char[capacity + 1];
+    if (size_ > 0)
+      memcpy(data, data_, size_);
+    delete [] data_;
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  char* data_;
+  size_t size_;
+  // Bytes of text the buffer holds, not counting the terminator's byte.
+  size_t capacity_;
+
+  OutputBuffer(const OutputBuffer&);
+  void operator=(const OutputBuffer&);
+};
+
+// Returns |recorded_size| if it is plausible for a file of
+// |compressed_size| bytes, and otherwise 0.
+size_t TrustedSize(uint64_t recorded_size, uint64_t compressed_size) {
+  if (recorded_size / kMaxTrustedRatio > compressed_size ||
+      recorded_size >= SIZE_MAX)
+    return 0;
+  return static_cast<size_t>(recorded_size);
+}
+
+#ifdef HAVE_LIBZ
+// Returns the uncompressed size gzip records at the end of |file|, which is
+// exact for the usual single-member file smaller than 4GB.  Leaves |file|
+// positioned at its start.
+uint64_t GzipRecordedSize(FILE* file) {
+  unsigned char trailer[4];
+  uint64_t size = 0;
+  if (fseek(file, -4, SEEK_END) == 0 &&
+      fread(trailer, 1, sizeof(trailer), file) == sizeof(trailer)) {
+    size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) |
+           (static_cast<uint64_t>(trailer[3]) << 24);
+  }
+  rewind(file);
+  return size;
+}
+
+bool InflateGzip(FILE* file, uint64_t compressed_size,
+                 char** symbol_data, size_t* symbol_data_size) {
+  OutputBuffer output(TrustedSize(GzipRecordedSize(file), compressed_size));
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // 16 selects the gzip wrapper.
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+    return false;
+
+  std::vector<unsigned char> input(kChunkSize);
+  bool complete = false;
+  bool ok = true;
+  while (ok) {
+    if (stream.avail_in == 0) {
+      size_t read = fread(&input[0], 1, input.size(), file);
+      if (read == 0) {
+        ok = !ferror(file) && complete;
+        break;
+      }
+      stream.next_in = &input[0];
+      stream.avail_in = static_cast<uInt>(read);
+    }
+    size_t space_size;
+    char* space = output.Space(&space_size);
+    stream.next_out = reinterpret_cast<Bytef*>(space);
+    stream.avail_out = static_cast<uInt>(
+        std::min<size_t>(space_size, UINT32_MAX));
+    uInt avail_out = stream.avail_out;
+    int result = inflate(&stream, Z_NO_FLUSH);
+    output.Advance(avail_out - stream.avail_out);
+    complete = false;
+    if (result == Z_STREAM_END) {
+      // A file may hold several members, which decompress to their
+      // concatenation.
+      complete = true;
+      ok = inflateReset(&stream) == Z_OK;
+    } else if (result != Z_OK &&
+               !(result == Z_BUF_ERROR && stream.avail_in == 0)) {
+      ok = false;
+    }
+  }
+  inflateEnd(&stream);
+  if (ok)
+    *symbol_data = output.Release(symbol_data_size);
+  return ok;
+}
+#endif  // HAVE_LIBZ
+
+#ifdef HAVE_LIBZSTD
+bool DecompressZstd(FILE* file, uint64_t compressed_size,
+                    char** symbol_data, size_t* symbol_data_size) {
+  std::vector<unsigned char> input(kChunkSize);
+  size_t read = fread(&input[0], 1, input.size(), file);
+  unsigned long long recorded_size = ZSTD_getFrameContentSize(&input[0], read);
+  if (recorded_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+      recorded_size == ZSTD_CONTENTSIZE_ERROR) {
+    recorded_size = 0;
+  }
+  OutputBuffer output(TrustedSize(recorded_size, compressed_size));
+
+  ZSTD_DStream* stream = ZSTD_createDStream();
+  if (!stream)
+    return false;
+  ZSTD_initDStream(stream);
+  ZSTD_inBuffer in = { &input[0], read, 0 };
+  // ZSTD_decompressStream returns 0 once a frame is complete and flushed.
+  size_t result = 1;
+  bool ok = true;
+  while (ok) {
+    if (in.pos == in.size) {
+      read = fread(&input[0], 1, input.size(), file);
+      if (read == 0) {
+        ok = !ferror(file) && result == 0;
+        break;
+      }
+      in.size = read;
+      in.pos = 0;
+    }
+    size_t space_size;
+    char* space = output.Space(&space_size);
+    ZSTD_outBuffer out = { space, space_size, 0 };
+    result = ZSTD_decompressStream(stream, &out, &in);
+    output.Advance(out.pos);
+    ok = !ZSTD_isError(result);
+  }
+  ZSTD_freeDStream(stream);
+  if (ok)
+    *symbol_data = output.Release(symbol_data_size);
+  return ok;
+}
+#endif  // HAVE_LIBZSTD
+
+}  // namespace
+
+SymbolFileCompression GetSymbolFileCompression(const string& path) {
+  ScopedFile file(fopen(path.c_str(), "rb"));
+  if (!file.get())
+    return SYMBOL_FILE_UNCOMPRESSED;
+  unsigned char magic[4];
+  size_t read = fread(magic, 1, sizeof(magic), file.get());
+  if (read >= sizeof(kGzipMagic) &&
+      memcmp(magic, kGzipMagic, sizeof(kGzipMagic)) == 0)
+    return SYMBOL_FILE_GZIP;
+  if (read >= sizeof(kZstdMagic) &&
+      memcmp(magic, kZstdMagic, sizeof(kZstdMagic)) == 0)
+    return SYMBOL_FILE_ZSTD;
+  return SYMBOL_FILE_UNCOMPRESSED;
+}
+
+bool IsSymbolFileCompressionSupported(SymbolFileCompression compression) {
+  switch (compression) {
+    case SYMBOL_FILE_UNCOMPRESSED:
+      return true;
+    case SYMBOL_FILE_GZIP:
+#ifdef HAVE_LIBZ
+      return true;
+#else
+      return false;
+#endif
+    case SYMBOL_FILE_ZSTD:
+#ifdef HAVE_LIBZSTD
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+bool ReadCompressedSymbolFile(const string& path,
+                              SymbolFileCompression compression,
+                              char** symbol_data,
+                              size_t* symbol_data_size) {
+  if (!IsSymbolFileCompressionSupported(compression) ||
+      compression == SYMBOL_FILE_UNCOMPRESSED) {
+    BPLOG(ERROR) << "Can't decompress " << path << " in this build";
+    return false;
+  }
+
+  ScopedFile file(fopen(path.c_str(), "rb"));
+  struct stat buf;
+  if (!file.get() || fstat(fileno(file.get()), &buf) == -1) {
+    BPLOG(ERROR) << "Could not open " << path;
+    return false;
+  }
+
+  BPLOG(INFO) << "Decompressing " << path;
+  bool ok = false;
+  switch (compression) {
+#ifdef HAVE_LIBZ
+    case SYMBOL_FILE_GZIP:
+      ok = InflateGzip(file.get(), buf.st_size, symbol_data, symbol_data_size);
+      break;
+#endif
+#ifdef HAVE_LIBZSTD
+    case SYMBOL_FILE_ZSTD:
+      ok = DecompressZstd(file.get(), buf.st_size,
+                          symbol_data, symbol_data_size);
+      break;
+#endif
+    default:
+      break;
+  }
+  if (!ok)
+    BPLOG(ERROR) << "Could not decompress " << path;
+  return ok;
+}
+
+}  // namespace google_breakpad
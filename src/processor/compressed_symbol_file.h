@@ -0,0 +1,76 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compressed_symbol_file.h: Reads symbol files stored compressed.
+//
+// Symbol stores often keep their text symbol files compressed with gzip or
+// zstd, which shrinks them several times over.  These functions recognize
+// such a file by its magic number and decompress it as it is read, a chunk
+// at a time, into the null-terminated buffer the source line resolvers
+// parse, so that neither the whole compressed file nor a second copy of the
+// text is ever held alongside the result.
+
+#ifndef PROCESSOR_COMPRESSED_SYMBOL_FILE_H__
+#define PROCESSOR_COMPRESSED_SYMBOL_FILE_H__
+
+#include <stddef.h>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+enum SymbolFileCompression {
+  SYMBOL_FILE_UNCOMPRESSED,
+  SYMBOL_FILE_GZIP,
+  SYMBOL_FILE_ZSTD
+};
+
+// Returns how the file at |path| is compressed, judging by its first few
+// bytes.  Files that can't be read are reported as uncompressed, leaving
+// the caller to fail on them in the usual way.
+SymbolFileCompression GetSymbolFileCompression(const string& path);
+
+// Returns true if this build can decompress files compressed with
+// |compression|.  Uncompressed files are always supported.
+bool IsSymbolFileCompressionSupported(SymbolFileCompression compression);
+
+// Decompresses the file at |path| into a buffer allocated with new[],
+// followed by a null terminator, and returns it in |symbol_data| with its
+// size, terminator included, in |symbol_data_size|, as
+// SourceLineResolverBase::ReadSymbolFile does.  Returns false if the file
+// can't be read, is damaged, or is compressed in a way this build doesn't
+// support.
+bool ReadCompressedSymbolFile(const string& path,
+                              SymbolFileCompression compression,
+                              char** symbol_data,
+                              size_t* symbol_data_size);
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_COMPRESSED_SYMBOL_FILE_H__
@@ -0,0 +1,225 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// compressed_symbol_file_unittest.cc: Unit tests for reading compressed
+// symbol files, directly and through SimpleSymbolSupplier.
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/basic_code_module.h"
+#include "processor/compressed_symbol_file.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::GetSymbolFileCompression;
+using google_breakpad::ReadCompressedSymbolFile;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SymbolSupplier;
+
+class CompressedSymbolFileTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    // Enough text to take several chunks of input and output.
+    text_ = "MODULE Linux x86 DEBUG1 libfoo.so\n";
+    for (int i = 0; i < 20000; ++i) {
+      char line[64];
+      snprintf(line, sizeof(line), "FUNC %x 10 0 function_%d\n", i * 16, i);
+      text_ += line;
+    }
+  }
+
+  static bool WriteFile(const string& path, const string& contents) {
+    FILE* f = fopen(path.c_str(), "wb");
+    return f && fwrite(contents.data(), 1, contents.size(), f) ==
+        contents.size() && fclose(f) == 0;
+  }
+
+#ifdef HAVE_LIBZ
+  // Writes |contents| gzipped to |path|, in |members| gzip members.
+  static bool WriteGzipFile(const string& path, const string& contents,
+                            int members) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f)
+      return false;
+    fclose(f);
+    size_t start = 0;
+    for (int i = 0; i < members; ++i) {
+      size_t end = i == members - 1 ? contents.size() :
+          contents.size() / members * (i + 1);
+      gzFile gz = gzopen(path.c_str(), "ab");
+      if (!gz ||
+          gzwrite(gz, contents.data() + start,
+                  static_cast<unsigned>(end - start)) !=
+              static_cast<int>(end - start) ||
+          gzclose(gz) != Z_OK) {
+        return false;
+      }
+      start = end;
+    }
+    return true;
+  }
+#endif
+
+  AutoTempDir temp_dir_;
+  string text_;
+};
+
+TEST_F(CompressedSymbolFileTest, DetectsCompression) {
+  string plain = temp_dir_.path() + "/plain.sym";
+  string gzip = temp_dir_.path() + "/gzip.sym";
+  string zstd = temp_dir_.path() + "/zstd.sym";
+  string empty = temp_dir_.path() + "/empty.sym";
+  ASSERT_TRUE(WriteFile(plain, text_));
+  ASSERT_TRUE(WriteFile(gzip, string("\x1f\x8b\x08\x00", 4)));
+  ASSERT_TRUE(WriteFile(zstd, string("\x28\xb5\x2f\xfd\x00", 5)));
+  ASSERT_TRUE(WriteFile(empty, ""));
+  EXPECT_EQ(google_breakpad::SYMBOL_FILE_UNCOMPRESSED,
+            GetSymbolFileCompression(plain));
+  EXPECT_EQ(google_breakpad::SYMBOL_FILE_GZIP,
+            GetSymbolFileCompression(gzip));
+  EXPECT_EQ(google_breakpad::SYMBOL_FILE_ZSTD,
+            GetSymbolFileCompression(zstd));
+  EXPECT_EQ(google_breakpad::SYMBOL_FILE_UNCOMPRESSED,
+            GetSymbolFileCompression(empty));
+  EXPECT_EQ(google_breakpad::SYMBOL_FILE_UNCOMPRESSED,
+            GetSymbolFileCompression(temp_dir_.path() + "/missing.sym"));
+}
+
+TEST_F(CompressedSymbolFileTest, RejectsUnsupported) {
+  string path = temp_dir_.path() + "/plain.sym";
+  ASSERT_TRUE(WriteFile(path, text_));
+  char* data = NULL;
+  size_t size = 0;
+  EXPECT_FALSE(ReadCompressedSymbolFile(
+      path, google_breakpad::SYMBOL_FILE_UNCOMPRESSED, &data, &size));
+#ifndef HAVE_LIBZSTD
+  EXPECT_FALSE(google_breakpad::IsSymbolFileCompressionSupported(
+      google_breakpad::SYMBOL_FILE_ZSTD));
+  EXPECT_FALSE(ReadCompressedSymbolFile(
+      path, google_breakpad::SYMBOL_FILE_ZSTD, &data, &size));
+#endif
+}
+
+#ifdef HAVE_LIBZ
+TEST_F(CompressedSymbolFileTest, ReadsGzip) {
+  string path = temp_dir_.path() + "/libfoo.so.sym.gz";
+  ASSERT_TRUE(WriteGzipFile(path, text_, 1));
+  char* data = NULL;
+  size_t size = 0;
+  ASSERT_TRUE(ReadCompressedSymbolFile(
+      path, google_breakpad::SYMBOL_FILE_GZIP, &data, &size));
+  ASSERT_EQ(text_.size() + 1, size);
+  EXPECT_EQ('\0', data[size - 1]);
+  EXPECT_EQ(text_, string(data, size - 1));
+  delete [] data;
+}
+
+TEST_F(CompressedSymbolFileTest, ReadsConcatenatedGzipMembers) {
+  // The size gzip records is only the last member's, which the buffer
+  // must grow past.
+  string path = temp_dir_.path() + "/libfoo.so.sym.gz";
+  ASSERT_TRUE(WriteGzipFile(path, text_, 3));
+  char* data = NULL;
+  size_t size = 0;
+  ASSERT_TRUE(ReadCompressedSymbolFile(
+      path, google_breakpad::SYMBOL_FILE_GZIP, &data, &size));
+  EXPECT_EQ(text_, string(data, size - 1));
+  delete [] data;
+}
+
+TEST_F(CompressedSymbolFileTest, RejectsTruncatedGzip) {
+  string path = temp_dir_.path() + "/libfoo.so.sym.gz";
+  ASSERT_TRUE(WriteGzipFile(path, text_, 1));
+  struct stat buf;
+  ASSERT_EQ(0, stat(path.c_str(), &buf));
+  ASSERT_EQ(0, truncate(path.c_str(), buf.st_size / 2));
+  char* data = NULL;
+  size_t size = 0;
+  EXPECT_FALSE(ReadCompressedSymbolFile(
+      path, google_breakpad::SYMBOL_FILE_GZIP, &data, &size));
+}
+
+TEST_F(CompressedSymbolFileTest, SupplierFindsGzip) {
+  string directory = temp_dir_.path() + "/libfoo.so";
+  ASSERT_EQ(0, mkdir(directory.c_str(), 0755));
+  directory += "/DEBUG1";
+  ASSERT_EQ(0, mkdir(directory.c_str(), 0755));
+  string path = directory + "/libfoo.so.sym.gz";
+  ASSERT_TRUE(WriteGzipFile(path, text_, 1));
+
+  BasicCodeModule module(0x1000, 0x1000, "libfoo.so", "", "libfoo.so",
+                         "DEBUG1", "");
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  // Mapping is asked for, but doesn't apply to compressed files.
+  supplier.set_use_mmap(true);
+  string symbol_file;
+  char* data = NULL;
+  size_t size = 0;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetCStringSymbolData(&module, NULL, &symbol_file,
+                                          &data, &size));
+  EXPECT_EQ(path, symbol_file);
+  EXPECT_EQ(text_, string(data, size - 1));
+  supplier.FreeSymbolData(&module);
+
+  string symbol_data;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module, NULL, &symbol_file,
+                                   &symbol_data));
+  EXPECT_EQ(text_, symbol_data);
+
+  // An uncompressed file beside it is preferred.
+  string plain = directory + "/libfoo.so.sym";
+  ASSERT_TRUE(WriteFile(plain, "MODULE Linux x86 DEBUG1 libfoo.so\n"));
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module, NULL, &symbol_file));
+  EXPECT_EQ(plain, symbol_file);
+}
+#endif  // HAVE_LIBZ
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -40,6 +40,7 @@
 
 #include <assert.h>
 
+#include "processor/flat_contained_range_map-inl.h"
 #include "processor/logging.h"
 
 
@@ -196,6 +197,58 @@ bool ContainedRangeMap<AddressType, EntryType>::RetrieveRanges(
   return true;
 }
 
+template<typename AddressType, typename EntryType>
+void ContainedRangeMap<AddressType, EntryType>::GetRangeBoundaries(
+    std::vector<AddressType>* boundaries) const {
+  if (!map_)
+    return;
+  MapConstIterator end = map_->end();
+  for (MapConstIterator child = map_->begin(); child != end; ++child) {
+    boundaries->push_back(child->second->base_);
+    boundaries->push_back(child->first + 1);
+    child->second->GetRangeBoundaries(boundaries);
+  }
+}
+
+template<typename AddressType, typename EntryType>
+void ContainedRangeMap<AddressType, EntryType>::Flatten(
+    FlatContainedRangeMap<AddressType, EntryType>* flat) const {
+  flat->Clear();
+  FlattenChildren(flat, FlatContainedRangeMap<AddressType,
+                                              EntryType>::kNoParent);
+  flat->ShrinkToFit();
+}
+
+template<typename AddressType, typename EntryType>
+void ContainedRangeMap<AddressType, EntryType>::FlattenChildren(
+    FlatContainedRangeMap<AddressType, EntryType>* flat,
+    int32_t parent) const {
+  if (!map_)
+    return;
+  // Children are keyed by their high addresses, but since they don't
+  // overlap, that puts them in order of their base addresses too.
+  MapConstIterator end = map_->end();
+  for (MapConstIterator child = map_->begin(); child != end; ++child) {
+    int32_t index = flat->AddRange(child->second->base_, child->first, parent,
+                                   &child->second->entry_);
+    child->second->FlattenChildren(flat, index);
+  }
+}
+
+template<typename AddressType, typename EntryType>
+template<typename Visitor>
+void ContainedRangeMap<AddressType, EntryType>::VisitEntries(
+    Visitor visitor) const {
+  if (!map_)
+    return;
+  for (MapConstIterator child = map_->begin(); child != map_->end();
+       ++child) {
+    visitor(child->second->entry_);
+    child->second->VisitEntries(visitor);
+  }
+}
+
+
 template<typename AddressType, typename EntryType>
 void ContainedRangeMap<AddressType, EntryType>::Clear() {
   if (map_) {
@@ -64,11 +64,13 @@
 #include <map>
 #include <vector>
 
+#include "google_breakpad/common/breakpad_types.h"
 
 namespace google_breakpad {
 
 // Forward declarations (for later friend declarations of specialized template).
 template<class, class> class ContainedRangeMapSerializer;
+template<class, class> class FlatContainedRangeMap;
 
 template<typename AddressType, typename EntryType>
 class ContainedRangeMap {
@@ -104,6 +106,22 @@ class ContainedRangeMap {
   bool RetrieveRanges(const AddressType& address,
                       std::vector<const EntryType*>& entries) const;
 
+  // Appends the base address of each descendant range, and the address
+  // just past its end, to |boundaries|, in no particular order.  Between
+  // two consecutive boundaries, RetrieveRanges returns the same entries
+  // for every address.
+  void GetRangeBoundaries(std::vector<AddressType>* boundaries) const;
+
+  // Replaces the ranges in |flat| with this map's descendant ranges, for
+  // faster lookups once no more will be stored (see
+  // flat_contained_range_map.h).  |flat| points to this map's entries.
+  void Flatten(FlatContainedRangeMap<AddressType, EntryType>* flat) const;
+
+  // Calls |visitor| with the entry of each descendant range, each range
+  // before its children.
+  template<typename Visitor>
+  void VisitEntries(Visitor visitor) const;
+
   // Removes all children.  Note that Clear only removes descendants,
   // leaving the node on which it is called intact.  Because the only
   // meaningful things contained by a root node are descendants, this
@@ -122,6 +140,11 @@ class ContainedRangeMap {
   typedef typename AddressToRangeMap::iterator MapIterator;
   typedef typename AddressToRangeMap::value_type MapValue;
 
+  // Adds this map's descendant ranges to |flat|, as children of the range
+  // at |parent|.
+  void FlattenChildren(FlatContainedRangeMap<AddressType, EntryType>* flat,
+                       int32_t parent) const;
+
   // Creates a new ContainedRangeMap with the specified base address, entry,
   // and initial child map, which may be NULL.  This is only used internally
   // by ContainedRangeMap when it creates a new child.
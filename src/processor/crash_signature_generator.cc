@@ -0,0 +1,238 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_signature_generator.cc: Computes a crash signature from a call
+// stack.
+//
+// See crash_signature_generator.h for documentation.
+
+#include "google_breakpad/processor/crash_signature_generator.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+
+namespace google_breakpad {
+
+namespace {
+
+const uint64_t kFnv1aBasis = 14695981039346656037ULL;
+const uint64_t kFnv1aPrime = 1099511628211ULL;
+
+uint64_t HashBytes(uint64_t hash, const char* bytes, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<uint8_t>(bytes[i]);
+    hash *= kFnv1aPrime;
+  }
+  return hash;
+}
+
+// Hashes |value| a byte at a time, least significant first, so that the
+// hash doesn't depend on the host's byte order.
+uint64_t HashValue(uint64_t hash, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    hash ^= (value >> (i * 8)) & 0xff;
+    hash *= kFnv1aPrime;
+  }
+  return hash;
+}
+
+// Returns the offset of the file name in |path|, after its last slash or
+// backslash.
+size_t FileNameOffset(const string& path) {
+  const size_t slash = path.find_last_of("/\\");
+  return slash == string::npos ? 0 : slash + 1;
+}
+
+}  // namespace
+
+const char CrashSignatureGenerator::kFrameSeparator[] = " | ";
+
+// static
+bool CrashSignatureGenerator::EdgeLabelLess(const Edge& edge, uint8_t label) {
+  return edge.label < label;
+}
+
+CrashSignatureGenerator::CrashSignatureGenerator(
+    const vector<string>& skip_rules,
+    const vector<string>& prefix_rules,
+    int max_frames)
+    : max_frames_(max_frames) {
+  // Build the trie with a list of edges for each node, then lay the lists
+  // out one after the other.
+  Node root = { 0, 0, ACTION_NONE, ACTION_NONE };
+  nodes_.push_back(root);
+  vector<vector<Edge> > children(1);
+  for (size_t i = 0; i < skip_rules.size(); ++i)
+    AddRule(skip_rules[i], ACTION_SKIP, &children);
+  for (size_t i = 0; i < prefix_rules.size(); ++i)
+    AddRule(prefix_rules[i], ACTION_PREFIX, &children);
+
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    nodes_[i].first_edge = static_cast<uint32_t>(edges_.size());
+    nodes_[i].edge_count = static_cast<uint32_t>(children[i].size());
+    edges_.insert(edges_.end(), children[i].begin(), children[i].end());
+  }
+}
+
+void CrashSignatureGenerator::AddRule(const string& rule, Action action,
+                                      vector<vector<Edge> >* children) {
+  size_t length = rule.size();
+  const bool is_prefix = length > 0 && rule[length - 1] == '*';
+  if (is_prefix)
+    --length;
+
+  uint32_t node = 0;
+  for (size_t i = 0; i < length; ++i) {
+    const uint8_t label = static_cast<uint8_t>(rule[i]);
+    vector<Edge>& edges = (*children)[node];
+    vector<Edge>::iterator edge =
+        std::lower_bound(edges.begin(), edges.end(), label, EdgeLabelLess);
+    if (edge != edges.end() && edge->label == label) {
+      node = edge->child;
+      continue;
+    }
+    const uint32_t child = static_cast<uint32_t>(nodes_.size());
+    Edge new_edge = { label, child };
+    edges.insert(edge, new_edge);
+    Node new_node = { 0, 0, ACTION_NONE, ACTION_NONE };
+    nodes_.push_back(new_node);
+    children->push_back(vector<Edge>());
+    node = child;
+  }
+
+  // A prefix rule wins over a skip rule for the same name.
+  Action& node_action =
+      is_prefix ? nodes_[node].prefix_action : nodes_[node].exact_action;
+  if (node_action != ACTION_PREFIX)
+    node_action = action;
+}
+
+CrashSignatureGenerator::Action CrashSignatureGenerator::Match(
+    const char* name, size_t length) const {
+  const Node* node = &nodes_[0];
+  Action action = node->prefix_action;
+  for (size_t i = 0; i < length; ++i) {
+    const Edge* edges_begin = edges_.data() + node->first_edge;
+    const Edge* edges_end = edges_begin + node->edge_count;
+    const uint8_t label = static_cast<uint8_t>(name[i]);
+    const Edge* edge =
+        std::lower_bound(edges_begin, edges_end, label, EdgeLabelLess);
+    if (edge == edges_end || edge->label != label)
+      return action;
+    node = &nodes_[edge->child];
+    if (node->prefix_action != ACTION_NONE)
+      action = node->prefix_action;
+  }
+  // An exact rule matches all of the name, as much as a prefix rule for
+  // the whole name, which wins if it's a prefix rule of the other kind.
+  if (node->exact_action != ACTION_NONE &&
+      !(node->exact_action == ACTION_SKIP &&
+        node->prefix_action == ACTION_PREFIX)) {
+    return node->exact_action;
+  }
+  return action;
+}
+
+bool CrashSignatureGenerator::Generate(const vector<StackFrame*>& frames,
+                                       uint64_t* hash,
+                                       string* signature) const {
+  if (signature)
+    signature->clear();
+  *hash = kFnv1aBasis;
+  int signature_frames = 0;
+  for (size_t i = 0;
+       i < frames.size() && signature_frames < max_frames_; ++i) {
+    const StackFrame* frame = frames[i];
+    const string& function = frame->function_name;
+    Action action;
+    if (!function.empty()) {
+      action = Match(function.data(), function.size());
+      if (action == ACTION_SKIP)
+        continue;
+      *hash = HashBytes(*hash, function.data(), function.size() + 1);
+      if (signature) {
+        if (signature_frames > 0)
+          signature->append(kFrameSeparator);
+        signature->append(function);
+      }
+    } else {
+      uint64_t offset = frame->instruction;
+      string code_file;
+      size_t name_offset = 0;
+      if (frame->module) {
+        code_file = frame->module->code_file();
+        name_offset = FileNameOffset(code_file);
+        offset -= frame->module->base_address();
+      }
+      const char* name = code_file.data() + name_offset;
+      const size_t name_length = code_file.size() - name_offset;
+      action = Match(name, name_length);
+      if (action == ACTION_SKIP)
+        continue;
+      *hash = HashBytes(*hash, name, name_length + 1);
+      *hash = HashValue(*hash, offset);
+      if (signature) {
+        if (signature_frames > 0)
+          signature->append(kFrameSeparator);
+        char offset_string[24];
+        snprintf(offset_string, sizeof(offset_string), "@0x%" PRIx64, offset);
+        signature->append(name, name_length);
+        signature->append(offset_string);
+      }
+    }
+    ++signature_frames;
+    if (action != ACTION_PREFIX)
+      break;
+  }
+  return signature_frames > 0;
+}
+
+bool CrashSignatureGenerator::Generate(const CallStack& stack,
+                                       uint64_t* hash,
+                                       string* signature) const {
+  return Generate(*stack.frames(), hash, signature);
+}
+
+bool CrashSignatureGenerator::Generate(const ProcessState& state,
+                                       uint64_t* hash,
+                                       string* signature) const {
+  const int thread = state.requesting_thread();
+  if (thread < 0 || static_cast<size_t>(thread) >= state.threads()->size())
+    return false;
+  return Generate(*state.threads()->at(thread), hash, signature);
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,184 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// crash_signature_generator_unittest.cc: Unit tests for
+// CrashSignatureGenerator.
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/crash_signature_generator.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::CrashSignatureGenerator;
+using google_breakpad::StackFrame;
+using std::vector;
+
+class CrashSignatureGeneratorTest : public ::testing::Test {
+ protected:
+  CrashSignatureGeneratorTest()
+      : module_(0x40000000, 0x10000, "/usr/lib/libfoo.so", "", "", "", "") {}
+
+  ~CrashSignatureGeneratorTest() {
+    for (size_t i = 0; i < frames_.size(); ++i)
+      delete frames_[i];
+  }
+
+  void AddFrame(const string& function_name) {
+    StackFrame* frame = new StackFrame();
+    frame->function_name = function_name;
+    frame->module = &module_;
+    frame->instruction = 0x40001000 + frames_.size();
+    frames_.push_back(frame);
+  }
+
+  void AddUnsymbolizedFrame(uint64_t instruction, bool in_module) {
+    StackFrame* frame = new StackFrame();
+    frame->module = in_module ? &module_ : NULL;
+    frame->instruction = instruction;
+    frames_.push_back(frame);
+  }
+
+  string Signature(const CrashSignatureGenerator& generator) {
+    uint64_t hash;
+    string signature;
+    if (!generator.Generate(frames_, &hash, &signature))
+      return "<none>";
+    return signature;
+  }
+
+  BasicCodeModule module_;
+  vector<StackFrame*> frames_;
+};
+
+TEST_F(CrashSignatureGeneratorTest, NoRules) {
+  CrashSignatureGenerator generator(vector<string>(), vector<string>(), 10);
+  EXPECT_EQ("<none>", Signature(generator));
+  AddFrame("crash");
+  AddFrame("main");
+  EXPECT_EQ("crash", Signature(generator));
+}
+
+TEST_F(CrashSignatureGeneratorTest, SkipAndPrefixRules) {
+  vector<string> skip_rules;
+  skip_rules.push_back("abort");
+  skip_rules.push_back("__libc_*");
+  vector<string> prefix_rules;
+  prefix_rules.push_back("logging::CheckFailed*");
+  prefix_rules.push_back("free");
+  CrashSignatureGenerator generator(skip_rules, prefix_rules, 10);
+
+  AddFrame("__libc_message");
+  AddFrame("abort");
+  AddFrame("aborted");
+  EXPECT_EQ("aborted", Signature(generator));
+
+  delete frames_.back();
+  frames_.pop_back();
+  AddFrame("logging::CheckFailed(char const*)");
+  AddFrame("free");
+  AddFrame("Widget::Destroy()");
+  AddFrame("main");
+  EXPECT_EQ("logging::CheckFailed(char const*) | free | Widget::Destroy()",
+            Signature(generator));
+}
+
+TEST_F(CrashSignatureGeneratorTest, LongestRuleWins) {
+  vector<string> skip_rules;
+  skip_rules.push_back("std::*");
+  skip_rules.push_back("std::vector::at");
+  vector<string> prefix_rules;
+  prefix_rules.push_back("std::vector*");
+  CrashSignatureGenerator generator(skip_rules, prefix_rules, 10);
+
+  AddFrame("std::string::string");
+  AddFrame("std::vector::at");
+  AddFrame("std::vector::push_back");
+  AddFrame("Grow");
+  EXPECT_EQ("std::vector::push_back | Grow", Signature(generator));
+}
+
+TEST_F(CrashSignatureGeneratorTest, MaxFrames) {
+  vector<string> prefix_rules(1, "*");
+  CrashSignatureGenerator generator(vector<string>(), prefix_rules, 2);
+  AddFrame("a");
+  AddFrame("b");
+  AddFrame("c");
+  EXPECT_EQ("a | b", Signature(generator));
+}
+
+TEST_F(CrashSignatureGeneratorTest, UnsymbolizedFrames) {
+  vector<string> skip_rules(1, "libc.so*");
+  CrashSignatureGenerator generator(skip_rules, vector<string>(), 10);
+  AddUnsymbolizedFrame(0x40001234, true);
+  EXPECT_EQ("libfoo.so@0x1234", Signature(generator));
+  delete frames_[0];
+  frames_.clear();
+  AddUnsymbolizedFrame(0x1234, false);
+  EXPECT_EQ("@0x1234", Signature(generator));
+}
+
+TEST_F(CrashSignatureGeneratorTest, HashWithoutText) {
+  vector<string> skip_rules(1, "abort");
+  CrashSignatureGenerator generator(skip_rules, vector<string>(), 10);
+  AddFrame("abort");
+  AddFrame("crash");
+  uint64_t with_text, without_text;
+  string signature;
+  ASSERT_TRUE(generator.Generate(frames_, &with_text, &signature));
+  ASSERT_TRUE(generator.Generate(frames_, &without_text, NULL));
+  EXPECT_EQ(with_text, without_text);
+
+  // Skipped frames and frames past the signature don't change the hash.
+  delete frames_[0];
+  frames_.erase(frames_.begin());
+  AddFrame("main");
+  uint64_t hash;
+  ASSERT_TRUE(generator.Generate(frames_, &hash, NULL));
+  EXPECT_EQ(with_text, hash);
+
+  frames_[0]->function_name = "crash2";
+  ASSERT_TRUE(generator.Generate(frames_, &hash, NULL));
+  EXPECT_NE(with_text, hash);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,465 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// eh_frame_stack_frame_symbolizer.cc: A StackFrameSymbolizer that can
+// unwind from .eh_frame.
+//
+// See eh_frame_stack_frame_symbolizer.h for documentation.
+
+#include "google_breakpad/processor/eh_frame_stack_frame_symbolizer.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "common/dwarf/bytereader-inl.h"
+#include "common/dwarf/bytereader.h"
+#include "common/dwarf/dwarf2reader.h"
+#include "common/dwarf_cfi_to_module.h"
+#include "common/linux/elfutils.h"
+#include "common/module.h"
+#include "common/scoped_ptr.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+// A mapped ELF binary, from which the CFI rules for an address are found
+// by parsing just the FDE covering it.
+class EhFrameStackFrameSymbolizer::Binary {
+ public:
+  Binary();
+  ~Binary();
+
+  // Maps the binary at |path| and finds its .eh_frame and .eh_frame_hdr.
+  // Returns false if it can't be used.
+  bool Load(const string& path);
+
+  // Returns the CFI rules in force at |address|, relative to the start of
+  // the module as symbol files give addresses, or NULL if there are none.
+  // The caller takes ownership.  May be called from several threads at
+  // once.
+  CFIFrameInfo* FindCFIFrameInfo(uint64_t address) const;
+
+ private:
+  template<typename ElfClass>
+  bool LoadSections();
+
+  // Sets up |reader| to read encoded pointers in the section that is at
+  // |section| in the mapping and |section_address| in the binary.
+  void InitByteReader(ByteReader* reader, const uint8_t* section,
+                      uint64_t section_address) const;
+
+  string path_;
+  void* map_;
+  size_t map_size_;
+  Endianness endianness_;
+  uint8_t address_size_;
+  std::vector<string> register_names_;
+
+  // The address symbol file addresses are relative to.
+  uint64_t load_address_;
+  uint64_t text_address_;
+  uint64_t got_address_;
+
+  const uint8_t* eh_frame_;
+  size_t eh_frame_size_;
+  uint64_t eh_frame_address_;
+
+  // The binary search table of .eh_frame_hdr: fde_count_ pairs of an
+  // FDE's initial location and its address, each encoded as
+  // table_encoding_ in table_entry_size_ bytes.
+  const uint8_t* eh_frame_hdr_;
+  uint64_t eh_frame_hdr_address_;
+  const uint8_t* table_;
+  size_t table_entry_size_;
+  uint64_t fde_count_;
+  DwarfPointerEncoding table_encoding_;
+};
+
+EhFrameStackFrameSymbolizer::Binary::Binary()
+    : map_(MAP_FAILED),
+      map_size_(0),
+      endianness_(ENDIANNESS_LITTLE),
+      address_size_(0),
+      load_address_(0),
+      text_address_(0),
+      got_address_(0),
+      eh_frame_(NULL),
+      eh_frame_size_(0),
+      eh_frame_address_(0),
+      eh_frame_hdr_(NULL),
+      eh_frame_hdr_address_(0),
+      table_(NULL),
+      table_entry_size_(0),
+      fde_count_(0),
+      table_encoding_(DW_EH_PE_omit) {}
+
+EhFrameStackFrameSymbolizer::Binary::~Binary() {
+  if (map_ != MAP_FAILED)
+    munmap(map_, map_size_);
+}
+
+bool EhFrameStackFrameSymbolizer::Binary::Load(const string& path) {
+  path_ = path;
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    BPLOG(ERROR) << "Can't open binary " << path;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    map_size_ = st.st_size;
+    map_ = mmap(NULL, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (map_ == MAP_FAILED) {
+    BPLOG(ERROR) << "Can't map binary " << path;
+    return false;
+  }
+
+  const uint8_t* ident = static_cast<const uint8_t*>(map_);
+  if (map_size_ < EI_NIDENT || memcmp(ident, ELFMAG, SELFMAG) != 0) {
+    BPLOG(ERROR) << "Binary " << path << " is not an ELF file";
+    return false;
+  }
+  // The headers are read in place, so they must be in this machine's byte
+  // order.
+  const uint16_t one = 1;
+  const bool little_endian_host = *reinterpret_cast<const uint8_t*>(&one);
+  if ((ident[EI_DATA] == ELFDATA2LSB) != little_endian_host) {
+    BPLOG(ERROR) << "Binary " << path << " has foreign byte order";
+    return false;
+  }
+  endianness_ = little_endian_host ? ENDIANNESS_LITTLE : ENDIANNESS_BIG;
+  if (ident[EI_CLASS] == ELFCLASS32)
+    return LoadSections<ElfClass32>();
+  if (ident[EI_CLASS] == ELFCLASS64)
+    return LoadSections<ElfClass64>();
+  BPLOG(ERROR) << "Binary " << path << " has an unknown ELF class";
+  return false;
+}
+
+template<typename ElfClass>
+bool EhFrameStackFrameSymbolizer::Binary::LoadSections() {
+  typedef typename ElfClass::Ehdr Ehdr;
+  typedef typename ElfClass::Phdr Phdr;
+  typedef typename ElfClass::Shdr Shdr;
+
+  const uint8_t* base = static_cast<const uint8_t*>(map_);
+  if (map_size_ < sizeof(Ehdr))
+    return false;
+  const Ehdr* ehdr = reinterpret_cast<const Ehdr*>(base);
+  address_size_ = ElfClass::kAddrSize;
+
+  switch (ehdr->e_machine) {
+    case EM_386:
+      register_names_ = DwarfCFIToModule::RegisterNames::I386();
+      break;
+    case EM_ARM:
+      register_names_ = DwarfCFIToModule::RegisterNames::ARM();
+      break;
+    case EM_AARCH64:
+      register_names_ = DwarfCFIToModule::RegisterNames::ARM64();
+      break;
+    case EM_MIPS:
+      register_names_ = DwarfCFIToModule::RegisterNames::MIPS();
+      break;
+    case EM_X86_64:
+      register_names_ = DwarfCFIToModule::RegisterNames::X86_64();
+      break;
+    default:
+      BPLOG(ERROR) << "Binary " << path_ << " is for an unknown machine";
+      return false;
+  }
+
+  // As dump_syms does, addresses are relative to the first loaded
+  // segment's.
+  if (ehdr->e_phoff > map_size_ ||
+      (map_size_ - ehdr->e_phoff) / sizeof(Phdr) < ehdr->e_phnum) {
+    return false;
+  }
+  const Phdr* phdrs = reinterpret_cast<const Phdr*>(base + ehdr->e_phoff);
+  for (int i = 0; i < ehdr->e_phnum; ++i) {
+    if (phdrs[i].p_type == PT_LOAD) {
+      load_address_ = phdrs[i].p_vaddr;
+      break;
+    }
+  }
+
+  if (ehdr->e_shoff > map_size_ ||
+      (map_size_ - ehdr->e_shoff) / sizeof(Shdr) < ehdr->e_shnum ||
+      ehdr->e_shstrndx >= ehdr->e_shnum) {
+    return false;
+  }
+  const Shdr* shdrs = reinterpret_cast<const Shdr*>(base + ehdr->e_shoff);
+  const Shdr& names = shdrs[ehdr->e_shstrndx];
+  if (names.sh_offset > map_size_ || names.sh_size > map_size_ - names.sh_offset)
+    return false;
+  const Shdr* eh_frame = NULL;
+  const Shdr* eh_frame_hdr = NULL;
+  for (int i = 0; i < ehdr->e_shnum; ++i) {
+    const Shdr& shdr = shdrs[i];
+    if (shdr.sh_name >= names.sh_size)
+      continue;
+    const char* name =
+        reinterpret_cast<const char*>(base + names.sh_offset + shdr.sh_name);
+    const size_t max_length = names.sh_size - shdr.sh_name;
+    if (strnlen(name, max_length) == max_length)
+      continue;
+    if (shdr.sh_type == SHT_NOBITS || shdr.sh_offset > map_size_ ||
+        shdr.sh_size > map_size_ - shdr.sh_offset) {
+      continue;
+    }
+    if (strcmp(name, ".eh_frame") == 0)
+      eh_frame = &shdr;
+    else if (strcmp(name, ".eh_frame_hdr") == 0)
+      eh_frame_hdr = &shdr;
+    else if (strcmp(name, ".text") == 0)
+      text_address_ = shdr.sh_addr;
+    else if (strcmp(name, ".got") == 0)
+      got_address_ = shdr.sh_addr;
+  }
+  if (!eh_frame || !eh_frame_hdr) {
+    BPLOG(INFO) << "Binary " << path_ << " has no .eh_frame_hdr";
+    return false;
+  }
+  eh_frame_ = base + eh_frame->sh_offset;
+  eh_frame_size_ = eh_frame->sh_size;
+  eh_frame_address_ = eh_frame->sh_addr;
+  eh_frame_hdr_ = base + eh_frame_hdr->sh_offset;
+  eh_frame_hdr_address_ = eh_frame_hdr->sh_addr;
+
+  // The header: a version, then the encodings of the .eh_frame pointer,
+  // the FDE count and the table, then the pointer and the count.
+  const uint8_t* hdr_end = eh_frame_hdr_ + eh_frame_hdr->sh_size;
+  if (eh_frame_hdr->sh_size < 4 || eh_frame_hdr_[0] != 1)
+    return false;
+  const DwarfPointerEncoding eh_frame_ptr_encoding =
+      static_cast<DwarfPointerEncoding>(eh_frame_hdr_[1]);
+  const DwarfPointerEncoding fde_count_encoding =
+      static_cast<DwarfPointerEncoding>(eh_frame_hdr_[2]);
+  table_encoding_ = static_cast<DwarfPointerEncoding>(eh_frame_hdr_[3]);
+  switch (table_encoding_ & 0x0f) {
+    case DW_EH_PE_udata2:
+    case DW_EH_PE_sdata2:
+      table_entry_size_ = 2;
+      break;
+    case DW_EH_PE_udata4:
+    case DW_EH_PE_sdata4:
+      table_entry_size_ = 4;
+      break;
+    case DW_EH_PE_udata8:
+    case DW_EH_PE_sdata8:
+      table_entry_size_ = 8;
+      break;
+    default:
+      BPLOG(INFO) << "Binary " << path_ << " has no usable FDE table";
+      return false;
+  }
+
+  ByteReader reader(endianness_);
+  InitByteReader(&reader, eh_frame_hdr_, eh_frame_hdr_address_);
+  if (eh_frame_ptr_encoding == DW_EH_PE_omit ||
+      fde_count_encoding == DW_EH_PE_omit ||
+      (table_encoding_ & DW_EH_PE_indirect) ||
+      !reader.ValidEncoding(eh_frame_ptr_encoding) ||
+      !reader.UsableEncoding(eh_frame_ptr_encoding) ||
+      !reader.ValidEncoding(fde_count_encoding) ||
+      !reader.UsableEncoding(fde_count_encoding) ||
+      !reader.ValidEncoding(table_encoding_) ||
+      !reader.UsableEncoding(table_encoding_)) {
+    BPLOG(INFO) << "Binary " << path_ << " has no usable FDE table";
+    return false;
+  }
+  // Encoded pointers are at most 8 bytes, so the reads stay in the
+  // section while 16 bytes remain.
+  const uint8_t* cursor = eh_frame_hdr_ + 4;
+  size_t length;
+  if (hdr_end - cursor < 16)
+    return false;
+  reader.ReadEncodedPointer(cursor, eh_frame_ptr_encoding, &length);
+  cursor += length;
+  fde_count_ = reader.ReadEncodedPointer(cursor, fde_count_encoding, &length);
+  cursor += length;
+  table_ = cursor;
+  if (cursor > hdr_end ||
+      fde_count_ > static_cast<uint64_t>(hdr_end - cursor) /
+                       (2 * table_entry_size_)) {
+    return false;
+  }
+  return true;
+}
+
+void EhFrameStackFrameSymbolizer::Binary::InitByteReader(
+    ByteReader* reader, const uint8_t* section,
+    uint64_t section_address) const {
+  reader->SetAddressSize(address_size_);
+  reader->SetCFIDataBase(section_address, section);
+  if (section == eh_frame_hdr_) {
+    // Pointers in .eh_frame_hdr are relative to its start.
+    reader->SetDataBase(eh_frame_hdr_address_);
+    return;
+  }
+  if (got_address_)
+    reader->SetDataBase(got_address_);
+  if (text_address_)
+    reader->SetTextBase(text_address_);
+}
+
+CFIFrameInfo* EhFrameStackFrameSymbolizer::Binary::FindCFIFrameInfo(
+    uint64_t address) const {
+  address += load_address_;
+
+  // Find the last FDE starting at or before |address|.
+  ByteReader reader(endianness_);
+  InitByteReader(&reader, eh_frame_hdr_, eh_frame_hdr_address_);
+  size_t length;
+  uint64_t low = 0;
+  uint64_t high = fde_count_;
+  while (low < high) {
+    const uint64_t middle = low + (high - low) / 2;
+    const uint64_t initial_location = reader.ReadEncodedPointer(
+        table_ + middle * 2 * table_entry_size_, table_encoding_, &length);
+    if (initial_location <= address)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  if (low == 0)
+    return NULL;
+  const uint64_t fde_address = reader.ReadEncodedPointer(
+      table_ + ((low - 1) * 2 + 1) * table_entry_size_, table_encoding_,
+      &length);
+  if (fde_address < eh_frame_address_ ||
+      fde_address - eh_frame_address_ + 4 > eh_frame_size_) {
+    return NULL;
+  }
+
+  // Parse just that FDE, and its CIE.
+  const size_t fde_offset = fde_address - eh_frame_address_;
+  ByteReader cfi_reader(endianness_);
+  InitByteReader(&cfi_reader, eh_frame_, eh_frame_address_);
+  size_t initial_length_size;
+  const uint64_t fde_length =
+      cfi_reader.ReadInitialLength(eh_frame_ + fde_offset,
+                                   &initial_length_size);
+  if (fde_length > eh_frame_size_ - fde_offset - initial_length_size)
+    return NULL;
+  Module module(path_, "", "", "");
+  DwarfCFIToModule::Reporter module_reporter(path_, ".eh_frame");
+  DwarfCFIToModule handler(&module, register_names_, &module_reporter);
+  CallFrameInfo::Reporter reporter(path_, ".eh_frame");
+  CallFrameInfo parser(eh_frame_, eh_frame_size_, &cfi_reader, &handler,
+                       &reporter, true);
+  parser.Start(fde_offset, fde_offset + initial_length_size + fde_length);
+
+  std::vector<Module::StackFrameEntry*> entries;
+  module.GetStackFrameEntries(&entries);
+  if (entries.size() != 1 || address < entries[0]->address ||
+      address - entries[0]->address >= entries[0]->size) {
+    return NULL;
+  }
+
+  // Apply the rules as the resolvers apply STACK CFI records.
+  const Module::StackFrameEntry& entry = *entries[0];
+  scoped_ptr<CFIFrameInfo> rules(new CFIFrameInfo());
+  CFIFrameInfoParseHandler parse_handler(rules.get());
+  CFIRuleParser rule_parser(&parse_handler);
+  string rule_set;
+  Module::AppendRuleMap(entry.initial_rules, &rule_set);
+  if (!rule_parser.Parse(rule_set))
+    return NULL;
+  for (Module::RuleChangeMap::const_iterator delta =
+           entry.rule_changes.begin();
+       delta != entry.rule_changes.end() && delta->first <= address;
+       ++delta) {
+    rule_set.clear();
+    Module::AppendRuleMap(delta->second, &rule_set);
+    rule_parser.Parse(rule_set);
+  }
+  return rules.release();
+}
+
+EhFrameStackFrameSymbolizer::EhFrameStackFrameSymbolizer(
+    SymbolSupplier* supplier,
+    SourceLineResolverInterface* resolver)
+    : StackFrameSymbolizer(supplier, resolver) {}
+
+EhFrameStackFrameSymbolizer::~EhFrameStackFrameSymbolizer() {
+  for (std::map<string, Binary*>::iterator it = binaries_.begin();
+       it != binaries_.end(); ++it) {
+    delete it->second;
+  }
+}
+
+CFIFrameInfo* EhFrameStackFrameSymbolizer::FindCFIFrameInfo(
+    const StackFrame* frame) {
+  CFIFrameInfo* cfi_frame_info = StackFrameSymbolizer::FindCFIFrameInfo(frame);
+  if (cfi_frame_info || !frame->module ||
+      frame->instruction < frame->module->base_address()) {
+    return cfi_frame_info;
+  }
+  Binary* binary = GetBinary(frame->module);
+  if (!binary)
+    return NULL;
+  return binary->FindCFIFrameInfo(frame->instruction -
+                                  frame->module->base_address());
+}
+
+EhFrameStackFrameSymbolizer::Binary* EhFrameStackFrameSymbolizer::GetBinary(
+    const CodeModule* module) {
+  std::lock_guard<std::mutex> lock(binaries_mutex_);
+  std::map<string, Binary*>::iterator it =
+      binaries_.find(module->code_file());
+  if (it != binaries_.end())
+    return it->second;
+
+  Binary* binary = NULL;
+  string binary_file;
+  if (supplier() &&
+      supplier()->GetBinaryFile(module, NULL, &binary_file) ==
+          SymbolSupplier::FOUND) {
+    binary = new Binary();
+    if (!binary->Load(binary_file)) {
+      delete binary;
+      binary = NULL;
+    }
+  }
+  binaries_[module->code_file()] = binary;
+  return binary;
+}
+
+}  // namespace google_breakpad
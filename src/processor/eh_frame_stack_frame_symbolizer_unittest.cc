@@ -0,0 +1,155 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Unit tests for EhFrameStackFrameSymbolizer and
+// SimpleSymbolSupplier::GetBinaryFile, unwinding from this test's own
+// binary.
+
+#include <link.h>
+#include <sys/stat.h>
+
+#include <fstream>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/eh_frame_stack_frame_symbolizer.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/simple_symbol_supplier.h"
+#include "processor/stackwalker_unittest_utils.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CFIFrameInfo;
+using google_breakpad::EhFrameStackFrameSymbolizer;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::StackFrame;
+using google_breakpad::SymbolSupplier;
+using google_breakpad::scoped_ptr;
+
+__attribute__((noinline)) int Probe(int x) {
+  return x * 3 + 1;
+}
+
+// Finds where this test's executable is loaded, as a minidump would
+// give its module's base address.
+int FindExecutable(struct dl_phdr_info* info, size_t, void* data) {
+  for (int i = 0; i < info->dlpi_phnum; ++i) {
+    if (info->dlpi_phdr[i].p_type == PT_LOAD) {
+      *static_cast<uint64_t*>(data) =
+          info->dlpi_addr + info->dlpi_phdr[i].p_vaddr;
+      break;
+    }
+  }
+  return 1;
+}
+
+class EhFrameStackFrameSymbolizerTest : public ::testing::Test {
+ public:
+  EhFrameStackFrameSymbolizerTest()
+      : base_(0), module_(NULL) {}
+
+  void SetUp() {
+    dl_iterate_phdr(FindExecutable, &base_);
+    ASSERT_NE(0U, base_);
+    module_.reset(new MockCodeModule(base_, 0x10000000, "selftest", ""));
+
+    // Keep a copy of this binary where a SimpleSymbolSupplier looks for
+    // the binary of "selftest", whose debug file and identifier are both
+    // "selftest".
+    string dir = temp_dir_.path() + "/selftest";
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+    dir += "/selftest";
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+    binary_path_ = dir + "/selftest";
+    std::ifstream in("/proc/self/exe", std::ios::binary);
+    std::ofstream out(binary_path_.c_str(), std::ios::binary);
+    out << in.rdbuf();
+    ASSERT_TRUE(out.good());
+  }
+
+  uint64_t base_;
+  scoped_ptr<MockCodeModule> module_;
+  AutoTempDir temp_dir_;
+  string binary_path_;
+  BasicSourceLineResolver resolver_;
+};
+
+TEST_F(EhFrameStackFrameSymbolizerTest, SupplierFindsBinary) {
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  string binary_file;
+  EXPECT_EQ(SymbolSupplier::FOUND,
+            supplier.GetBinaryFile(module_.get(), NULL, &binary_file));
+  EXPECT_EQ(binary_path_, binary_file);
+
+  MockCodeModule other(base_, 0x1000, "other", "");
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetBinaryFile(&other, NULL, &binary_file));
+  EXPECT_EQ("", binary_file);
+}
+
+TEST_F(EhFrameStackFrameSymbolizerTest, FindsRulesInBinary) {
+  SimpleSymbolSupplier supplier(temp_dir_.path());
+  EhFrameStackFrameSymbolizer symbolizer(&supplier, &resolver_);
+
+  StackFrame frame;
+  frame.module = module_.get();
+  frame.instruction = reinterpret_cast<uint64_t>(&Probe);
+  scoped_ptr<CFIFrameInfo> rules(symbolizer.FindCFIFrameInfo(&frame));
+  ASSERT_TRUE(rules.get());
+  const string serialized = rules->Serialize();
+  EXPECT_NE(string::npos, serialized.find(".cfa:")) << serialized;
+  EXPECT_NE(string::npos, serialized.find(".ra:")) << serialized;
+
+  // The ELF header isn't code that any FDE covers.
+  frame.instruction = base_;
+  rules.reset(symbolizer.FindCFIFrameInfo(&frame));
+  EXPECT_FALSE(rules.get());
+
+  EXPECT_EQ(4, Probe(1));
+}
+
+TEST_F(EhFrameStackFrameSymbolizerTest, NoBinary) {
+  SimpleSymbolSupplier supplier(temp_dir_.path() + "/empty");
+  EhFrameStackFrameSymbolizer symbolizer(&supplier, &resolver_);
+
+  StackFrame frame;
+  frame.module = module_.get();
+  frame.instruction = reinterpret_cast<uint64_t>(&Probe);
+  scoped_ptr<CFIFrameInfo> rules(symbolizer.FindCFIFrameInfo(&frame));
+  EXPECT_FALSE(rules.get());
+}
+
+}  // namespace
@@ -36,15 +36,6 @@
 
 #include "processor/exploitability_linux.h"
 
-#ifndef _WIN32
-#include <regex.h>
-#include <stdio.h>
-#include <stdlib.h>
-
-#include <sstream>
-#include <iterator>
-#endif  // _WIN32
-
 #include <string.h>
 
 #include "google_breakpad/common/minidump_exception_linux.h"
@@ -68,10 +59,8 @@ constexpr char kStackCheckFailureFunction[] = "__stack_chk_fail";
 // can determine that the call would overflow the target buffer.
 constexpr char kBoundsCheckFailureFunction[] = "__chk_fail";
 
-#ifndef _WIN32
-const unsigned int MAX_INSTRUCTION_LEN = 15;
-const unsigned int MAX_OBJDUMP_BUFFER_LEN = 4096;
-#endif  // _WIN32
+// The longest an x86 instruction can be.
+constexpr size_t kMaxInstructionLength = 15;
 
 }  // namespace
 
@@ -158,8 +147,8 @@ ExploitabilityRating ExploitabilityLinux::CheckPlatformExploitability() {
     return EXPLOITABILITY_HIGH;
   }
 
-  // Check for write to read only memory or invalid memory, shelling out
-  // to objdump is enabled.
+  // Check for write to read only memory or invalid memory, if decoding the
+  // crashing instruction is enabled.
   if (enable_objdump_ && this->EndedOnIllegalWrite(instruction_ptr)) {
     return EXPLOITABILITY_HIGH;
   }
@@ -170,9 +159,6 @@ ExploitabilityRating ExploitabilityLinux::CheckPlatformExploitability() {
 }
 
 bool ExploitabilityLinux::EndedOnIllegalWrite(uint64_t instruction_ptr) {
-#ifdef _WIN32
-  BPLOG(INFO) << "MinGW does not support fork and exec. Terminating method.";
-#else
   // Get memory region containing instruction pointer.
   MinidumpMemoryList* memory_list = dump_->GetMemoryList();
   MinidumpMemoryRegion* memory_region =
@@ -183,8 +169,6 @@ bool ExploitabilityLinux::EndedOnIllegalWrite(uint64_t instruction_ptr) {
     return false;
   }
 
-  // Get exception data to find architecture.
-  string architecture = "";
   MinidumpException* exception = dump_->GetException();
   // This should never evaluate to true, since this should not be reachable
   // without checking for exception data earlier.
@@ -192,344 +176,218 @@ bool ExploitabilityLinux::EndedOnIllegalWrite(uint64_t instruction_ptr) {
     BPLOG(INFO) << "No exception data.";
     return false;
   }
-  const MDRawExceptionStream* raw_exception_stream = exception->exception();
   const MinidumpContext* context = exception->GetContext();
   // This should not evaluate to true, for the same reason mentioned above.
-  if (!raw_exception_stream || !context) {
-    BPLOG(INFO) << "No exception or architecture data.";
+  if (!context) {
+    BPLOG(INFO) << "No exception context.";
     return false;
   }
-  // Check architecture and set architecture variable to corresponding flag
-  // in objdump.
-  switch (context->GetContextCPU()) {
-    case MD_CONTEXT_X86:
-      architecture = "i386";
-      break;
-    case MD_CONTEXT_AMD64:
-      architecture = "i386:x86-64";
-      break;
-    default:
-      // Unsupported architecture. Note that ARM architectures are not
-      // supported because objdump does not support ARM.
-      return false;
-  }
 
-  // Get memory region around instruction pointer and the number of bytes
-  // before and after the instruction pointer in the memory region.
-  const uint8_t* raw_memory = memory_region->GetMemory();
-  const uint64_t base = memory_region->GetBase();
-  if (base > instruction_ptr) {
-    BPLOG(ERROR) << "Memory region base value exceeds instruction pointer.";
+  // Read the bytes of the instruction at the instruction pointer, which may
+  // run up to the end of the region.
+  size_t available = 0;
+  const uint8_t* raw_memory = memory_region->GetMemorySpan(
+      instruction_ptr, kMaxInstructionLength, &available);
+  if (!raw_memory) {
+    BPLOG(INFO) << "No bytes at instruction pointer.";
     return false;
   }
-  const uint64_t offset = instruction_ptr - base;
-  if (memory_region->GetSize() < MAX_INSTRUCTION_LEN + offset) {
-    BPLOG(INFO) << "Not enough bytes left to guarantee complete instruction.";
-    return false;
-  }
-
-  // Convert bytes into objdump output.
-  char objdump_output_buffer[MAX_OBJDUMP_BUFFER_LEN] = {0};
-  DisassembleBytes(architecture,
-                   raw_memory + offset,
-                   MAX_OBJDUMP_BUFFER_LEN,
-                   objdump_output_buffer);
 
-  string line;
-  if (!GetObjdumpInstructionLine(objdump_output_buffer, &line)) {
+  uint64_t write_address = 0;
+  if (!DecodeMemoryWrite(raw_memory, available, instruction_ptr, *context,
+                         &write_address)) {
     return false;
   }
 
-  // Convert objdump instruction line into the operation and operands.
-  string instruction = "";
-  string dest = "";
-  string src = "";
-  TokenizeObjdumpInstruction(line, &instruction, &dest, &src);
-
-  // Check if the operation is a write to memory. First, the instruction
-  // must one that can write to memory. Second, the write destination
-  // must be a spot in memory rather than a register. Since there are no
-  // symbols from objdump, the destination will be enclosed by brackets.
-  if (dest.size() > 2 && dest.at(0) == '[' && dest.at(dest.size() - 1) == ']' &&
-      (!instruction.compare("mov") || !instruction.compare("inc") ||
-       !instruction.compare("dec") || !instruction.compare("and") ||
-       !instruction.compare("or") || !instruction.compare("xor") ||
-       !instruction.compare("not") || !instruction.compare("neg") ||
-       !instruction.compare("add") || !instruction.compare("sub") ||
-       !instruction.compare("shl") || !instruction.compare("shr"))) {
-    // Strip away enclosing brackets from the destination address.
-    dest = dest.substr(1, dest.size() - 2);
-    uint64_t write_address = 0;
-    CalculateAddress(dest, *context, &write_address);
-
-    // If the program crashed as a result of a write, the destination of
-    // the write must have been an address that did not permit writing.
-    // However, if the address is under 4k, due to program protections,
-    // the crash does not suggest exploitability for writes with such a
-    // low target address.
-    return write_address > 4096;
-  }
-#endif  // _WIN32
-  return false;
+  // If the program crashed as a result of a write, the destination of
+  // the write must have been an address that did not permit writing.
+  // However, if the address is under 4k, due to program protections,
+  // the crash does not suggest exploitability for writes with such a
+  // low target address.
+  return write_address > 4096;
 }
 
-#ifndef _WIN32
-bool ExploitabilityLinux::CalculateAddress(const string& address_expression,
-                                           const DumpContext& context,
-                                           uint64_t* write_address) {
-  // The destination should be the format reg+a or reg-a, where reg
-  // is a register and a is a hexadecimal constant. Although more complex
-  // expressions can make valid instructions, objdump's disassembly outputs
-  // it in this simpler format.
-  // TODO(liuandrew): Handle more complex formats, should they arise.
-
-  if (!write_address) {
+// static
+bool ExploitabilityLinux::DecodeMemoryWrite(const uint8_t* bytes,
+                                            size_t length,
+                                            uint64_t instruction_ptr,
+                                            const DumpContext& context,
+                                            uint64_t* write_address) {
+  if (!bytes || !write_address) {
     BPLOG(ERROR) << "Null parameter.";
     return false;
   }
-
-  // Clone parameter into a non-const string.
-  string expression = address_expression;
-
-  // Parse out the constant that is added to the address (if it exists).
-  size_t delim = expression.find('+');
-  bool positive_add_constant = true;
-  // Check if constant is subtracted instead of added.
-  if (delim == string::npos) {
-    positive_add_constant = false;
-    delim = expression.find('-');
+  const uint32_t cpu = context.GetContextCPU();
+  if (cpu != MD_CONTEXT_X86 && cpu != MD_CONTEXT_AMD64) {
+    // Only x86 and x86-64 instructions are decoded.
+    return false;
   }
-  uint32_t add_constant = 0;
-  // Save constant and remove it from the expression.
-  if (delim != string::npos) {
-    if (!sscanf(expression.substr(delim + 1).c_str(), "%x", &add_constant)) {
-      BPLOG(ERROR) << "Failed to scan constant.";
+  const bool long_mode = cpu == MD_CONTEXT_AMD64;
+  if (length > kMaxInstructionLength)
+    length = kMaxInstructionLength;
+
+  // Legacy prefixes. A segment override other than the flat ones leaves
+  // the address relative to a segment base the context doesn't record.
+  size_t offset = 0;
+  bool operand_size_override = false;
+  bool address_size_override = false;
+  for (; offset < length; ++offset) {
+    const uint8_t prefix = bytes[offset];
+    if (prefix == 0x66) {
+      operand_size_override = true;
+    } else if (prefix == 0x67) {
+      address_size_override = true;
+    } else if (prefix == 0x64 || prefix == 0x65) {
       return false;
+    } else if (prefix != 0xf0 && prefix != 0xf2 && prefix != 0xf3 &&
+               prefix != 0x26 && prefix != 0x2e && prefix != 0x36 &&
+               prefix != 0x3e) {
+      break;
     }
-    expression = expression.substr(0, delim);
   }
-
-  // Set the the write address to the corresponding register.
-  // TODO(liuandrew): Add support for partial registers, such as
-  // the rax/eax/ax/ah/al chain.
-  switch (context.GetContextCPU()) {
-    case MD_CONTEXT_X86:
-      if (!expression.compare("eax")) {
-        *write_address = context.GetContextX86()->eax;
-      } else if (!expression.compare("ebx")) {
-        *write_address = context.GetContextX86()->ebx;
-      } else if (!expression.compare("ecx")) {
-        *write_address = context.GetContextX86()->ecx;
-      } else if (!expression.compare("edx")) {
-        *write_address = context.GetContextX86()->edx;
-      } else if (!expression.compare("edi")) {
-        *write_address = context.GetContextX86()->edi;
-      } else if (!expression.compare("esi")) {
-        *write_address = context.GetContextX86()->esi;
-      } else if (!expression.compare("ebp")) {
-        *write_address = context.GetContextX86()->ebp;
-      } else if (!expression.compare("esp")) {
-        *write_address = context.GetContextX86()->esp;
-      } else if (!expression.compare("eip")) {
-        *write_address = context.GetContextX86()->eip;
-      } else {
-        BPLOG(ERROR) << "Unsupported register";
+  // A REX prefix extends the register numbers in the ModRM and SIB bytes.
+  uint8_t rex = 0;
+  if (long_mode && offset < length && (bytes[offset] & 0xf0) == 0x40)
+    rex = bytes[offset++];
+  if (offset + 2 > length)
+    return false;
+  const uint8_t opcode = bytes[offset++];
+  const uint8_t modrm = bytes[offset++];
+  const uint8_t mod = modrm >> 6;
+  const uint8_t reg = (modrm >> 3) & 7;
+  const uint8_t rm = modrm & 7;
+
+  // The operations that write their first operand, and the size of any
+  // immediate operand following the address.
+  size_t immediate_size = 0;
+  switch (opcode) {
+    case 0x00: case 0x01:  // add
+    case 0x08: case 0x09:  // or
+    case 0x20: case 0x21:  // and
+    case 0x28: case 0x29:  // sub
+    case 0x30: case 0x31:  // xor
+    case 0x88: case 0x89:  // mov
+      break;
+    case 0x80: case 0x81: case 0x83:  // add, or, and, sub, xor with imm
+      if (reg != 0 && reg != 1 && reg != 4 && reg != 5 && reg != 6)
         return false;
-      }
+      immediate_size = opcode != 0x81 ? 1 : operand_size_override ? 2 : 4;
       break;
-    case MD_CONTEXT_AMD64:
-      if (!expression.compare("rax")) {
-        *write_address = context.GetContextAMD64()->rax;
-      } else if (!expression.compare("rbx")) {
-        *write_address = context.GetContextAMD64()->rbx;
-      } else if (!expression.compare("rcx")) {
-        *write_address = context.GetContextAMD64()->rcx;
-      } else if (!expression.compare("rdx")) {
-        *write_address = context.GetContextAMD64()->rdx;
-      } else if (!expression.compare("rdi")) {
-        *write_address = context.GetContextAMD64()->rdi;
-      } else if (!expression.compare("rsi")) {
-        *write_address = context.GetContextAMD64()->rsi;
-      } else if (!expression.compare("rbp")) {
-        *write_address = context.GetContextAMD64()->rbp;
-      } else if (!expression.compare("rsp")) {
-        *write_address = context.GetContextAMD64()->rsp;
-      } else if (!expression.compare("rip")) {
-        *write_address = context.GetContextAMD64()->rip;
-      } else if (!expression.compare("r8")) {
-        *write_address = context.GetContextAMD64()->r8;
-      } else if (!expression.compare("r9")) {
-        *write_address = context.GetContextAMD64()->r9;
-      } else if (!expression.compare("r10")) {
-        *write_address = context.GetContextAMD64()->r10;
-      } else if (!expression.compare("r11")) {
-        *write_address = context.GetContextAMD64()->r11;
-      } else if (!expression.compare("r12")) {
-        *write_address = context.GetContextAMD64()->r12;
-      } else if (!expression.compare("r13")) {
-        *write_address = context.GetContextAMD64()->r13;
-      } else if (!expression.compare("r14")) {
-        *write_address = context.GetContextAMD64()->r14;
-      } else if (!expression.compare("r15")) {
-        *write_address = context.GetContextAMD64()->r15;
-      } else {
-        BPLOG(ERROR) << "Unsupported register";
+    case 0xc6: case 0xc7:  // mov with imm
+      if (reg != 0)
+        return false;
+      immediate_size = opcode == 0xc6 ? 1 : operand_size_override ? 2 : 4;
+      break;
+    case 0xfe: case 0xff:  // inc, dec
+      if (reg != 0 && reg != 1)
+        return false;
+      break;
+    case 0xf6: case 0xf7:  // not, neg
+      if (reg != 2 && reg != 3)
+        return false;
+      break;
+    case 0xc0: case 0xc1:  // shl, shr by imm
+      if (reg != 4 && reg != 5)
+        return false;
+      immediate_size = 1;
+      break;
+    case 0xd0: case 0xd1: case 0xd2: case 0xd3:  // shl, shr by 1 or cl
+      if (reg != 4 && reg != 5)
         return false;
-      }
       break;
     default:
-      // This should not occur since the same switch condition
-      // should have terminated this method.
       return false;
   }
-
-  // Add or subtract constant from write address (if applicable).
-  *write_address =
-      positive_add_constant ?
-      *write_address + add_constant : *write_address - add_constant;
-
-  return true;
-}
-
-// static
-bool ExploitabilityLinux::GetObjdumpInstructionLine(
-    const char* objdump_output_buffer,
-    string* instruction_line) {
-  // Put buffer data into stream to output line-by-line.
-  std::stringstream objdump_stream;
-  objdump_stream.str(string(objdump_output_buffer));
-
-  // Pipe each output line into the string until the string contains the first
-  // instruction from objdump.  All lines before the "<.data>:" section are
-  // skipped.  Loop until the line shows the first instruction or there are no
-  // lines left.
-  bool data_section_seen = false;
-  do {
-    if (!getline(objdump_stream, *instruction_line)) {
-      BPLOG(INFO) << "Objdump instructions not found";
-      return false;
-    }
-    if (instruction_line->find("<.data>:") != string::npos) {
-      data_section_seen = true;
-    }
-  } while (!data_section_seen || instruction_line->find("0:") == string::npos);
-  // This first instruction contains the above substring.
-
-  return true;
-}
-
-bool ExploitabilityLinux::TokenizeObjdumpInstruction(const string& line,
-                                                     string* operation,
-                                                     string* dest,
-                                                     string* src) {
-  if (!operation || !dest || !src) {
-    BPLOG(ERROR) << "Null parameters passed.";
+  // The destination must be memory rather than a register.
+  if (mod == 3)
+    return false;
+  // 16-bit addressing is left alone.
+  if (!long_mode && address_size_override)
     return false;
-  }
-
-  // Set all pointer values to empty strings.
-  *operation = "";
-  *dest = "";
-  *src = "";
-
-  // Tokenize the objdump line.
-  vector<string> tokens;
-  std::istringstream line_stream(line);
-  copy(std::istream_iterator<string>(line_stream),
-       std::istream_iterator<string>(),
-       std::back_inserter(tokens));
-
-  // Regex for the data in hex form. Each byte is two hex digits.
-  regex_t regex;
-  regcomp(&regex, "^[[:xdigit:]]{2}$", REG_EXTENDED | REG_NOSUB);
-
-  // Find and set the location of the operator. The operator appears
-  // directly after the chain of bytes that define the instruction. The
-  // operands will be the last token, given that the instruction has operands.
-  // If not, the operator is the last token. The loop skips the first token
-  // because the first token is the instruction number (namely "0:").
-  string operands = "";
-  for (size_t i = 1; i < tokens.size(); i++) {
-    // Check if current token no longer is in byte format.
-    if (regexec(&regex, tokens[i].c_str(), 0, NULL, 0)) {
-      // instruction = tokens[i];
-      *operation = tokens[i];
-      // If the operator is the last token, there are no operands.
-      if (i != tokens.size() - 1) {
-        operands = tokens[tokens.size() - 1];
-      }
-      break;
-    }
-  }
-  regfree(&regex);
 
-  if (operation->empty()) {
-    BPLOG(ERROR) << "Failed to parse out operation from objdump instruction.";
+  bool has_base = true;
+  bool rip_relative = false;
+  int base = rm | ((rex & 0x1) << 3);
+  int index = -1;
+  int scale = 0;
+  if (rm == 4) {
+    if (offset >= length)
+      return false;
+    const uint8_t sib = bytes[offset++];
+    scale = sib >> 6;
+    index = ((sib >> 3) & 7) | ((rex & 0x2) << 2);
+    if (index == 4)
+      index = -1;
+    base = (sib & 7) | ((rex & 0x1) << 3);
+    if (mod == 0 && (sib & 7) == 5)
+      has_base = false;
+  } else if (mod == 0 && rm == 5) {
+    has_base = false;
+    rip_relative = long_mode;
+  }
+
+  size_t displacement_size = mod == 1 ? 1 : (mod == 2 || !has_base) ? 4 : 0;
+  if (offset + displacement_size + immediate_size > length)
     return false;
+  int64_t displacement = 0;
+  if (displacement_size == 1) {
+    displacement = static_cast<int8_t>(bytes[offset]);
+  } else if (displacement_size == 4) {
+    displacement = static_cast<int32_t>(
+        bytes[offset] | (bytes[offset + 1] << 8) |
+        (bytes[offset + 2] << 16) |
+        (static_cast<uint32_t>(bytes[offset + 3]) << 24));
+  }
+  offset += displacement_size + immediate_size;
+
+  uint64_t address = static_cast<uint64_t>(displacement);
+  uint64_t value = 0;
+  if (rip_relative) {
+    // Relative to the end of the instruction.
+    address += instruction_ptr + offset;
+  } else if (has_base) {
+    if (!GetRegister(context, base, &value))
+      return false;
+    address += value;
   }
-
-  // Split operands into source and destination (if applicable).
-  if (!operands.empty()) {
-    size_t delim = operands.find(',');
-    if (delim == string::npos) {
-      *dest = operands;
-    } else {
-      *dest = operands.substr(0, delim);
-      *src = operands.substr(delim + 1);
-    }
+  if (index != -1) {
+    if (!GetRegister(context, index, &value))
+      return false;
+    address += value << scale;
   }
+  if (!long_mode || address_size_override)
+    address &= 0xffffffff;
+  *write_address = address;
   return true;
 }
 
-bool ExploitabilityLinux::DisassembleBytes(const string& architecture,
-                                           const uint8_t* raw_bytes,
-                                           const unsigned int buffer_len,
-                                           char* objdump_output_buffer) {
-  if (!raw_bytes || !objdump_output_buffer) {
-    BPLOG(ERROR) << "Bad input parameters.";
-    return false;
-  }
-
-  // Write raw bytes around instruction pointer to a temporary file to
-  // pass as an argument to objdump.
-  char raw_bytes_tmpfile[] = "/tmp/breakpad_mem_region-raw_bytes-XXXXXX";
-  int raw_bytes_fd = mkstemp(raw_bytes_tmpfile);
-  if (raw_bytes_fd < 0) {
-    BPLOG(ERROR) << "Failed to create tempfile.";
-    unlink(raw_bytes_tmpfile);
-    return false;
-  }
-  if (write(raw_bytes_fd, raw_bytes, MAX_INSTRUCTION_LEN)
-      != MAX_INSTRUCTION_LEN) {
-    BPLOG(ERROR) << "Writing of raw bytes failed.";
-    unlink(raw_bytes_tmpfile);
-    return false;
-  }
-
-  char cmd[1024] = {0};
-  snprintf(cmd,
-           1024,
-           "objdump -D -b binary -M intel -m %s %s",
-           architecture.c_str(),
-           raw_bytes_tmpfile);
-  FILE* objdump_fp = popen(cmd, "r");
-  if (!objdump_fp) {
-    fclose(objdump_fp);
-    unlink(raw_bytes_tmpfile);
-    BPLOG(ERROR) << "Failed to call objdump.";
-    return false;
-  }
-  if (fread(objdump_output_buffer, 1, buffer_len, objdump_fp) <= 0) {
-    fclose(objdump_fp);
-    unlink(raw_bytes_tmpfile);
-    BPLOG(ERROR) << "Failed to read objdump output.";
+// static
+bool ExploitabilityLinux::GetRegister(const DumpContext& context,
+                                      int number,
+                                      uint64_t* value) {
+  if (context.GetContextCPU() == MD_CONTEXT_X86) {
+    const MDRawContextX86* raw = context.GetContextX86();
+    const uint32_t registers[] = {
+      raw->eax, raw->ecx, raw->edx, raw->ebx,
+      raw->esp, raw->ebp, raw->esi, raw->edi
+    };
+    if (number < 0 || number >= 8)
+      return false;
+    *value = registers[number];
+    return true;
+  }
+  const MDRawContextAMD64* raw = context.GetContextAMD64();
+  const uint64_t registers[] = {
+    raw->rax, raw->rcx, raw->rdx, raw->rbx,
+    raw->rsp, raw->rbp, raw->rsi, raw->rdi,
+    raw->r8, raw->r9, raw->r10, raw->r11,
+    raw->r12, raw->r13, raw->r14, raw->r15
+  };
+  if (number < 0 || number >= 16)
     return false;
-  }
-  fclose(objdump_fp);
-  unlink(raw_bytes_tmpfile);
+  *value = registers[number];
   return true;
 }
-#endif  // _WIN32
 
 bool ExploitabilityLinux::StackPointerOffStack(uint64_t stack_ptr) {
   MinidumpLinuxMapsList* linux_maps_list = dump_->GetLinuxMapsList();
@@ -48,11 +48,10 @@ class ExploitabilityLinux : public Exploitability {
                       ProcessState* process_state);
 
   // Parameters are the minidump to analyze, the object representing process
-  // state, and whether to enable objdump disassembly.
-  // Enabling objdump will allow exploitability analysis to call out to
-  // objdump for diassembly. It is used to check the identity of the
-  // instruction that caused the program to crash. If there are any
-  // portability concerns, this should not be enabled.
+  // state, and whether to enable decoding the crashing instruction.
+  // Enabling it lets exploitability analysis check whether the program
+  // crashed writing to memory, and where. The instruction is decoded in
+  // process, and only x86 and x86-64 instructions are understood.
   ExploitabilityLinux(Minidump* dump,
                       ProcessState* process_state,
                       bool enable_objdump);
@@ -76,40 +75,24 @@ class ExploitabilityLinux : public Exploitability {
   // instruction is at a spot in memory that prohibits writes.
   bool EndedOnIllegalWrite(uint64_t instruction_ptr);
 
-#ifndef _WIN32
-  // Disassembles raw bytes via objdump and pipes the output into the provided
-  // buffer, given the desired architecture, the file from which objdump will
-  // read, and the buffer length. The method returns whether the disassembly
-  // was a success, and the caller owns all pointers.
-  static bool DisassembleBytes(const string& architecture,
-                               const uint8_t* raw_bytes,
-                               const unsigned int MAX_OBJDUMP_BUFFER_LEN,
-                               char* objdump_output_buffer);
-
-  // Parses the objdump output given in |objdump_output_buffer| and extracts
-  // the line of the first instruction into |instruction_line|.  Returns true
-  // when the instruction line is successfully extracted.
-  static bool GetObjdumpInstructionLine(
-      const char* objdump_output_buffer,
-      string* instruction_line);
-
-  // Tokenizes out the operation and operands from a line of instruction
-  // disassembled by objdump. This method modifies the pointers to match the
-  // tokens of the instruction, and returns if the tokenizing was a success.
-  // The caller owns all pointers.
-  static bool TokenizeObjdumpInstruction(const string& line,
-                                         string* operation,
-                                         string* dest,
-                                         string* src);
-
-  // Calculates the effective address of an expression in the form reg+a or
-  // reg-a, where 'reg' is a register and 'a' is a constant, and writes the
-  // result in the pointer. The method returns whether the calculation was
-  // a success. The caller owns the pointer.
-  static bool CalculateAddress(const string& address_expression,
-                               const DumpContext& context,
-                               uint64_t* write_address);
-#endif  // _WIN32
+  // Decodes the x86 or x86-64 instruction at the start of the |length|
+  // bytes at |bytes|, found at |instruction_ptr|. If it is a mov, inc, dec,
+  // and, or, xor, not, neg, add, sub, shl or shr whose destination is in
+  // memory, computes the destination's address from the registers in
+  // |context| into |write_address| and returns true. Returns false for any
+  // other instruction, or one that can't be decoded or whose address can't
+  // be computed.
+  static bool DecodeMemoryWrite(const uint8_t* bytes,
+                                size_t length,
+                                uint64_t instruction_ptr,
+                                const DumpContext& context,
+                                uint64_t* write_address);
+
+  // Sets |value| to the general purpose register numbered |number| in
+  // |context|, in the order they are numbered in instruction encodings.
+  static bool GetRegister(const DumpContext& context,
+                          int number,
+                          uint64_t* value);
 
   // Checks if the stack pointer points to a memory mapping that is not
   // labelled as the stack.
@@ -119,8 +102,7 @@ class ExploitabilityLinux : public Exploitability {
   // to the memory mappings.
   bool ExecutableStackOrHeap();
 
-  // Whether this exploitability engine is permitted to shell out to objdump
-  // to disassemble raw bytes.
+  // Whether this exploitability engine decodes the crashing instruction.
   bool enable_objdump_;
 };
 
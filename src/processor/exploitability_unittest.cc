@@ -47,10 +47,7 @@ namespace google_breakpad {
 
 class ExploitabilityLinuxTest : public ExploitabilityLinux {
  public:
-  using ExploitabilityLinux::CalculateAddress;
-  using ExploitabilityLinux::DisassembleBytes;
-  using ExploitabilityLinux::GetObjdumpInstructionLine;
-  using ExploitabilityLinux::TokenizeObjdumpInstruction;
+  using ExploitabilityLinux::DecodeMemoryWrite;
 };
 
 class ExploitabilityLinuxTestMinidumpContext : public MinidumpContext {
@@ -61,6 +58,13 @@ class ExploitabilityLinuxTestMinidumpContext : public MinidumpContext {
     SetContextAMD64(new MDRawContextAMD64(context));
     SetContextFlags(MD_CONTEXT_AMD64);
   }
+
+  explicit ExploitabilityLinuxTestMinidumpContext(
+      const MDRawContextX86& context) : MinidumpContext(NULL) {
+    valid_ = true;
+    SetContextX86(new MDRawContextX86(context));
+    SetContextFlags(MD_CONTEXT_X86);
+  }
 };
 
 }  // namespace google_breakpad
@@ -171,7 +175,6 @@ TEST(ExploitabilityTest, TestLinuxEngine) {
             ExploitabilityFor("linux_executable_heap.dmp"));
   ASSERT_EQ(google_breakpad::EXPLOITABILITY_HIGH,
             ExploitabilityFor("linux_jmp_to_module_not_exe_region.dmp"));
-#ifndef _WIN32
   ASSERT_EQ(google_breakpad::EXPLOITABILITY_HIGH,
             ExploitabilityFor("linux_write_to_nonwritable_module.dmp"));
   ASSERT_EQ(google_breakpad::EXPLOITABILITY_HIGH,
@@ -182,124 +185,117 @@ TEST(ExploitabilityTest, TestLinuxEngine) {
             ExploitabilityFor("linux_write_to_outside_module_via_math.dmp"));
   ASSERT_EQ(google_breakpad::EXPLOITABILITY_INTERESTING,
             ExploitabilityFor("linux_write_to_under_4k.dmp"));
-#endif  // _WIN32
 }
 
 #ifndef _WIN32
-TEST(ExploitabilityLinuxUtilsTest, DisassembleBytesTest) {
-  ASSERT_FALSE(ExploitabilityLinuxTest::DisassembleBytes("", NULL, 5, NULL));
-  uint8_t bytes[6] = {0xc7, 0x0, 0x5, 0x0, 0x0, 0x0};
-  char buffer[1024] = {0};
-  ASSERT_TRUE(ExploitabilityLinuxTest::DisassembleBytes("i386:x86-64",
-                                                        bytes,
-                                                        1024,
-                                                        buffer));
-  std::stringstream objdump_stream;
-  objdump_stream.str(string(buffer));
-  string line = "";
-  while (line.find("<.data>") == string::npos)
-    getline(objdump_stream, line);
-  getline(objdump_stream, line);
-  ASSERT_EQ(line, "   0:\tc7 00 05 00 00 00    \tmov    DWORD PTR [rax],0x5");
+// Expects DecodeMemoryWrite to find a write to |expected| in |bytes|.
+template<size_t N>
+void ExpectWrite(const uint8_t (&bytes)[N],
+                 uint64_t instruction_ptr,
+                 const ExploitabilityLinuxTestMinidumpContext& context,
+                 uint64_t expected) {
+  uint64_t write_address = 0;
+  EXPECT_TRUE(ExploitabilityLinuxTest::DecodeMemoryWrite(
+      bytes, N, instruction_ptr, context, &write_address));
+  EXPECT_EQ(expected, write_address);
 }
 
-TEST(ExploitabilityLinuxUtilsTest, GetObjdumpInstructionLine) {
-  string disassebly =
-      "\n"
-      "/tmp/breakpad_mem_region-raw_bytes-tMmMo0:     file format binary\n"
-      "// Trying to confuse the parser 0:\n"
-      "\n"
-      "Disassembly of section .data:\n"
-      "\n"
-      "0000000000000000 <.data>:\n"
-      "   0:\tc7 00 01 00 00 00    \tmov    DWORD PTR [rax],0x1\n"
-      "   6:\t5d                   \tpop    rbp\n"
-      "   7:\tc3                   \tret    \n"
-      "   8:\t55                   \tpush   rbp\n"
-      "   9:\t48 89 e5             \tmov    rbp,rsp\n"
-      "   c:\t53                   \tpush   rbx\n"
-      "   d:\t48                   \trex.W\n"
-      "   e:\t81                   \t.byte 0x81\n";
-  string line;
-  EXPECT_TRUE(ExploitabilityLinuxTest::GetObjdumpInstructionLine(
-      disassebly.c_str(), &line));
-  EXPECT_EQ("   0:\tc7 00 01 00 00 00    \tmov    DWORD PTR [rax],0x1", line);
-
-  // There is no "0:" after "<.data>:".  Expected to return false.
-  disassebly =
-      "\n"
-      "/tmp/breakpad_mem_region-raw_bytes-tMmMo0:     file format binary\n"
-      "// Trying to confuse the parser 0:\n"
-      "\n"
-      "Disassembly of section .data:\n"
-      "\n"
-      "   0:\tc7 00 01 00 00 00    \tmov    DWORD PTR [rax],0x1\n"
-      "   6:\t5d                   \tpop    rbp\n"
-      "   7:\tc3                   \tret    \n"
-      "   8:\t55                   \tpush   rbp\n"
-      "   9:\t48 89 e5             \tmov    rbp,rsp\n"
-      "   d:\t48                   \trex.W\n"
-      "0000000000000000 <.data>:\n"
-      "   c:\t53                   \tpush   rbx\n";
-  EXPECT_FALSE(ExploitabilityLinuxTest::GetObjdumpInstructionLine(
-      disassebly.c_str(), &line));
+// Expects DecodeMemoryWrite to find no write in |bytes|.
+template<size_t N>
+void ExpectNoWrite(const uint8_t (&bytes)[N],
+                   const ExploitabilityLinuxTestMinidumpContext& context) {
+  uint64_t write_address = 0;
+  EXPECT_FALSE(ExploitabilityLinuxTest::DecodeMemoryWrite(
+      bytes, N, 0, context, &write_address));
 }
 
-TEST(ExploitabilityLinuxUtilsTest, TokenizeObjdumpInstructionTest) {
-  ASSERT_FALSE(ExploitabilityLinuxTest::TokenizeObjdumpInstruction("",
-                                                                   NULL,
-                                                                   NULL,
-                                                                   NULL));
-  string line = "0: c7 00 05 00 00 00     mov    DWORD PTR [rax],0x5";
-  string operation = "";
-  string dest = "";
-  string src = "";
-  ASSERT_TRUE(ExploitabilityLinuxTest::TokenizeObjdumpInstruction(line,
-                                                                  &operation,
-                                                                  &dest,
-                                                                  &src));
-  ASSERT_EQ(operation, "mov");
-  ASSERT_EQ(dest, "[rax]");
-  ASSERT_EQ(src, "0x5");
-  line = "0: c3 ret";
-  ASSERT_TRUE(ExploitabilityLinuxTest::TokenizeObjdumpInstruction(line,
-                                                                  &operation,
-                                                                  &dest,
-                                                                  &src));
-  ASSERT_EQ(operation, "ret");
-  ASSERT_EQ(dest, "");
-  ASSERT_EQ(src, "");
-  line = "0: 5f pop rdi";
-  ASSERT_TRUE(ExploitabilityLinuxTest::TokenizeObjdumpInstruction(line,
-                                                                  &operation,
-                                                                  &dest,
-                                                                  &src));
-  ASSERT_EQ(operation, "pop");
-  ASSERT_EQ(dest, "rdi");
-  ASSERT_EQ(src, "");
+TEST(ExploitabilityLinuxUtilsTest, DecodeMemoryWriteAMD64) {
+  MDRawContextAMD64 raw_context = {};
+  raw_context.rax = 0x100000;
+  raw_context.rbx = 0x200000;
+  raw_context.rcx = 0x10;
+  raw_context.rdx = 12345;
+  raw_context.r8 = 0x20;
+  ExploitabilityLinuxTestMinidumpContext context(raw_context);
+
+  ASSERT_FALSE(ExploitabilityLinuxTest::DecodeMemoryWrite(NULL, 0, 0, context,
+                                                          NULL));
+
+  // mov DWORD PTR [rax],0x5
+  const uint8_t mov_imm[] = {0xc7, 0x00, 0x05, 0x00, 0x00, 0x00};
+  ExpectWrite(mov_imm, 0, context, 0x100000);
+  // mov QWORD PTR [rdx-0x4d2],rax
+  const uint8_t mov_disp32[] = {0x48, 0x89, 0x82, 0x2e, 0xfb, 0xff, 0xff};
+  ExpectWrite(mov_disp32, 0, context, 11111);
+  // add DWORD PTR [rdx+0x10],0x1
+  const uint8_t add_disp8[] = {0x83, 0x42, 0x10, 0x01};
+  ExpectWrite(add_disp8, 0, context, 12361);
+  // mov DWORD PTR [rbx+rcx*4],eax
+  const uint8_t mov_sib[] = {0x89, 0x04, 0x8b};
+  ExpectWrite(mov_sib, 0, context, 0x200040);
+  // mov DWORD PTR [rcx+r8*8],eax
+  const uint8_t mov_rex_index[] = {0x42, 0x89, 0x04, 0xc1};
+  ExpectWrite(mov_rex_index, 0, context, 0x110);
+  // inc QWORD PTR [rax]
+  const uint8_t inc[] = {0x48, 0xff, 0x00};
+  ExpectWrite(inc, 0, context, 0x100000);
+  // shl DWORD PTR [rbx],cl
+  const uint8_t shl[] = {0xd3, 0x23};
+  ExpectWrite(shl, 0, context, 0x200000);
+  // mov DWORD PTR [rip+0x10],0x1, relative to the next instruction.
+  const uint8_t mov_rip[] = {0xc7, 0x05, 0x10, 0x00, 0x00, 0x00,
+                             0x01, 0x00, 0x00, 0x00};
+  ExpectWrite(mov_rip, 0x400000, context, 0x40001a);
+  // mov DWORD PTR [eax],0x5, with 32-bit addressing.
+  raw_context.rax = 0x123400001000;
+  ExploitabilityLinuxTestMinidumpContext wide_context(raw_context);
+  const uint8_t mov_addr32[] = {0x67, 0xc7, 0x00, 0x05, 0x00, 0x00, 0x00};
+  ExpectWrite(mov_addr32, 0, wide_context, 0x1000);
+
+  // pop rdi
+  const uint8_t pop[] = {0x5f};
+  ExpectNoWrite(pop, context);
+  // ret
+  const uint8_t ret[] = {0xc3};
+  ExpectNoWrite(ret, context);
+  // mov rbx,rax
+  const uint8_t mov_reg[] = {0x48, 0x89, 0xc3};
+  ExpectNoWrite(mov_reg, context);
+  // mov eax,DWORD PTR [rax]
+  const uint8_t load[] = {0x8b, 0x00};
+  ExpectNoWrite(load, context);
+  // cmp DWORD PTR [rax],0x0
+  const uint8_t cmp[] = {0x83, 0x38, 0x00};
+  ExpectNoWrite(cmp, context);
+  // mov QWORD PTR fs:0x28,rax
+  const uint8_t mov_fs[] = {0x64, 0x48, 0x89, 0x04, 0x25,
+                            0x28, 0x00, 0x00, 0x00};
+  ExpectNoWrite(mov_fs, context);
+  // mov DWORD PTR [rax],0x5, cut short.
+  const uint8_t truncated[] = {0xc7, 0x00, 0x05};
+  ExpectNoWrite(truncated, context);
 }
 
-TEST(ExploitabilityLinuxUtilsTest, CalculateAddressTest) {
-  MDRawContextAMD64 raw_context;
-  raw_context.rdx = 12345;
+TEST(ExploitabilityLinuxUtilsTest, DecodeMemoryWriteX86) {
+  MDRawContextX86 raw_context = {};
+  raw_context.eax = 0x1000;
+  raw_context.esp = 0xbfff0000;
   ExploitabilityLinuxTestMinidumpContext context(raw_context);
-  ASSERT_EQ(context.GetContextAMD64()->rdx, 12345U);
-  ASSERT_FALSE(ExploitabilityLinuxTest::CalculateAddress("", context, NULL));
-  uint64_t write_address = 0;
-  ASSERT_TRUE(ExploitabilityLinuxTest::CalculateAddress("rdx-0x4D2",
-                                                        context,
-                                                        &write_address));
-  ASSERT_EQ(write_address, 11111U);
-  ASSERT_TRUE(ExploitabilityLinuxTest::CalculateAddress("rdx+0x4D2",
-                                                        context,
-                                                        &write_address));
-  ASSERT_EQ(write_address, 13579U);
-  ASSERT_FALSE(ExploitabilityLinuxTest::CalculateAddress("rdx+rax",
-                                                         context,
-                                                         &write_address));
-  ASSERT_FALSE(ExploitabilityLinuxTest::CalculateAddress("0x3482+0x4D2",
-                                                         context,
-                                                         &write_address));
+
+  // mov DWORD PTR [esp],eax
+  const uint8_t mov_esp[] = {0x89, 0x04, 0x24};
+  ExpectWrite(mov_esp, 0, context, 0xbfff0000);
+  // sub DWORD PTR [eax-0x8],0x1
+  const uint8_t sub[] = {0x83, 0x68, 0xf8, 0x01};
+  ExpectWrite(sub, 0, context, 0xff8);
+  // mov DWORD PTR ds:0x2000,0x1, an absolute address.
+  const uint8_t mov_absolute[] = {0xc7, 0x05, 0x00, 0x20, 0x00, 0x00,
+                                  0x01, 0x00, 0x00, 0x00};
+  ExpectWrite(mov_absolute, 0x8048000, context, 0x2000);
+  // dec eax; mov DWORD PTR [eax],eax. There is no REX prefix in 32-bit
+  // code.
+  const uint8_t dec[] = {0x48, 0x89, 0x00};
+  ExpectNoWrite(dec, context);
 }
 #endif  // _WIN32
 
@@ -69,6 +69,11 @@ static const size_t kHugeBump          = 90;
 // The maximum number of bytes to disassemble past the program counter.
 static const size_t kDisassembleBytesBeyondPC = 2048;
 
+// The maximum number of instructions to disassemble past the faulting one
+// looking for the end of its block. Code that runs on longer than this is
+// unlikely to be reached with the bad value still in use.
+static const int kDisassembleInstructionsBeyondPC = 128;
+
 ExploitabilityWin::ExploitabilityWin(Minidump* dump,
                                      ProcessState* process_state)
     : Exploitability(dump, process_state) { }
@@ -203,15 +208,10 @@ ExploitabilityRating ExploitabilityWin::CheckPlatformExploitability() {
             context->GetContextCPU() == MD_CONTEXT_X86 &&
             (bad_read || bad_write)) {
           // Perform checks related to memory around instruction pointer.
-          uint32_t memory_offset =
-              instruction_ptr - instruction_region->GetBase();
-          uint32_t available_memory =
-              instruction_region->GetSize() - memory_offset;
-          available_memory = available_memory > kDisassembleBytesBeyondPC ?
-              kDisassembleBytesBeyondPC : available_memory;
-          if (available_memory) {
-            const uint8_t* raw_memory =
-                instruction_region->GetMemory() + memory_offset;
+          size_t available_memory = 0;
+          const uint8_t* raw_memory = instruction_region->GetMemorySpan(
+              instruction_ptr, kDisassembleBytesBeyondPC, &available_memory);
+          if (raw_memory) {
             DisassemblerX86 disassembler(raw_memory,
                                          available_memory,
                                          instruction_ptr);
@@ -236,7 +236,9 @@ ExploitabilityRating ExploitabilityWin::CheckPlatformExploitability() {
               // Loop the disassembler through the code and check if it
               // IDed any interesting conditions in the near future.
               // Multiple flags may be set so treat each equally.
-              while (disassembler.NextInstruction() &&
+              int instructions = 0;
+              while (instructions++ < kDisassembleInstructionsBeyondPC &&
+                     disassembler.NextInstruction() &&
                      disassembler.currentInstructionValid() &&
                      !disassembler.endOfBlock())
                 continue;
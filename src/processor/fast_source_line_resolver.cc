@@ -40,6 +40,8 @@
 #include "google_breakpad/processor/fast_source_line_resolver.h"
 #include "processor/fast_source_line_resolver_types.h"
 
+#include <string.h>
+
 #include <cassert>
 #include <map>
 #include <string>
@@ -49,6 +51,7 @@
 #include "common/using_std_string.h"
 #include "processor/logging.h"
 #include "processor/module_factory.h"
+#include "processor/postfix_program-inl.h"
 #include "processor/simple_serializer-inl.h"
 
 using std::deque;
@@ -57,7 +60,41 @@ using std::unique_ptr;
 namespace google_breakpad {
 
 FastSourceLineResolver::FastSourceLineResolver()
-  : SourceLineResolverBase(new FastModuleFactory) { }
+  : SourceLineResolverBase(new FastModuleFactory), use_huge_pages_(false) { }
+
+FastSourceLineResolver::FastSourceLineResolver(bool thread_safe)
+  : SourceLineResolverBase(new FastModuleFactory, thread_safe),
+    use_huge_pages_(false) { }
+
+FastSourceLineResolver::~FastSourceLineResolver() { }
+
+bool FastSourceLineResolver::LoadModule(const CodeModule* module,
+                                        const string& map_file) {
+  if (module == NULL)
+    return false;
+
+  BPLOG(INFO) << "Mapping symbols for module " << module->code_file()
+              << " from " << map_file;
+
+  char* data;
+  size_t size;
+  bool mapped = use_huge_pages_ ?
+      CopySymbolFileToHugePages(map_file, &data, &size) :
+      MapSymbolFile(map_file, &data, &size);
+  if (!mapped)
+    return false;
+
+  // Reject files of the wrong format or version up front, so that they are
+  // reported as missing symbols rather than as a corrupt module.
+  if (!Module::CheckHeader(data, size)) {
+    BPLOG(ERROR) << map_file << " does not hold usable serialized symbols";
+    UnmapSymbolFile(data, size);
+    return false;
+  }
+
+  // The mapping stays alive as long as the module.
+  return LoadModuleFromBuffer(module, data, size, BUFFER_MAPPED);
+}
 
 bool FastSourceLineResolver::ShouldDeleteMemoryBufferAfterLoadModule() {
   return false;
@@ -89,18 +126,14 @@ void FastSourceLineResolver::Module::LookupAddress(
     frame->function_name = func->name;
     frame->function_base = frame->module->base_address() + function_base;
 
-    scoped_ptr<Line> line(new Line);
-    const Line* line_ptr = 0;
-    MemAddr line_base;
-    if (func->lines.RetrieveRange(address, line_ptr, &line_base, NULL)) {
-      line->CopyFrom(line_ptr);
-      FileMap::iterator it = files_.find(line->source_file_id);
+    StaticLineTable::Row line;
+    if (func->lines.Retrieve(address, &line)) {
+      FileMap::iterator it = files_.find(line.source_file_id);
       if (it != files_.end()) {
-        frame->source_file_name =
-            files_.find(line->source_file_id).GetValuePtr();
+        frame->source_file_name = it.GetValuePtr();
       }
-      frame->source_line = line->line;
-      frame->source_line_base = frame->module->base_address() + line_base;
+      frame->source_line = line.line;
+      frame->source_line_base = frame->module->base_address() + line.address;
     }
     // Check if this is inlined function call.
     if (inlined_frames) {
@@ -219,8 +252,13 @@ bool FastSourceLineResolver::Module::LoadMapFromMemory(
     size_t memory_buffer_size) {
   if (!memory_buffer) return false;
 
+  if (!CheckHeader(memory_buffer, memory_buffer_size)) {
+    is_corrupt_ = true;
+    return false;
+  }
+
   // Read the "is_corrupt" flag.
-  const char* mem_buffer = memory_buffer;
+  const char* mem_buffer = memory_buffer + sizeof(SerializedHeader);
   mem_buffer = SimpleSerializer<bool>::Read(mem_buffer, &is_corrupt_);
 
   const uint32_t* map_sizes = reinterpret_cast<const uint32_t*>(mem_buffer);
@@ -231,25 +269,36 @@ bool FastSourceLineResolver::Module::LoadMapFromMemory(
   // for each "Static***Map" component of Module.
   // "Static***Map": static version of std::map or map wrapper, i.e., StaticMap,
   // StaticAddressMap, StaticContainedRangeMap, and StaticRangeMap.
+  // The first map follows the map sizes, aligned like the rest.
   unsigned int offsets[kNumberMaps_];
-  offsets[0] = header_size;
+  size_t prefix_size = sizeof(SerializedHeader) + sizeof(bool);
+  offsets[0] = static_cast<unsigned int>(
+      AlignMapOffset(prefix_size + header_size) - prefix_size);
   for (int i = 1; i < kNumberMaps_; ++i) {
     offsets[i] = offsets[i - 1] + map_sizes[i - 1];
   }
-  unsigned int expected_size = sizeof(bool) + offsets[kNumberMaps_ - 1] +
+  unsigned int expected_size = sizeof(SerializedHeader) + sizeof(bool) +
+                               offsets[kNumberMaps_ - 1] +
                                map_sizes[kNumberMaps_ - 1] + 1;
   if (expected_size != memory_buffer_size &&
       // Allow for having an extra null terminator.
       expected_size != memory_buffer_size - 1) {
     // This could either be a random corruption or the serialization format was
-    // changed without updating the version in kSerializedBreakpadFileExtension.
+    // changed without updating kSerializedVersion.
     BPLOG(ERROR) << "Memory buffer is either corrupt or an unsupported version"
                  << ", expected size: " << expected_size
                  << ", actual size: " << memory_buffer_size;
+    is_corrupt_ = true;
     return false;
   }
   BPLOG(INFO) << "Memory buffer size looks good, size: " << memory_buffer_size;
 
+  data_size_ = memory_buffer_size;
+  for (int i = 0; i < kNumberMaps_; ++i) {
+    map_data_[i] = mem_buffer + offsets[i];
+    map_sizes_[i] = map_sizes[i];
+  }
+
   // Use pointers to construct Static*Map data members in Module:
   int map_id = 0;
   files_ = StaticMap<int, char>(mem_buffer + offsets[map_id++]);
@@ -260,6 +309,7 @@ bool FastSourceLineResolver::Module::LoadMapFromMemory(
   for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i) {
     windows_frame_info_[i] =
         StaticContainedRangeMap<MemAddr, char>(mem_buffer + offsets[map_id++]);
+    windows_frame_info_[i].Flatten(&flat_windows_frame_info_[i]);
   }
 
   cfi_initial_rules_ =
@@ -269,6 +319,57 @@ bool FastSourceLineResolver::Module::LoadMapFromMemory(
   return true;
 }
 
+const uint32_t FastSourceLineResolver::Module::kSerializedMagic;
+const uint32_t FastSourceLineResolver::Module::kSerializedVersion;
+const size_t FastSourceLineResolver::Module::kMapAlignment;
+
+bool FastSourceLineResolver::Module::CheckHeader(const char* buffer,
+                                                 size_t buffer_size) {
+  SerializedHeader header;
+  if (!buffer || buffer_size < sizeof(header)) {
+    BPLOG(ERROR) << "Memory buffer is too small to hold serialized symbol "
+                 << "data, size: " << buffer_size;
+    return false;
+  }
+  memcpy(&header, buffer, sizeof(header));
+
+  if (header.magic != kSerializedMagic) {
+    BPLOG(ERROR) << "Memory buffer does not hold serialized symbol data";
+    return false;
+  }
+  if (header.version != kSerializedVersion) {
+    BPLOG(ERROR) << "Unsupported serialized symbol data version "
+                 << header.version << ", expected " << kSerializedVersion;
+    return false;
+  }
+  // Allow for having an extra null terminator.
+  if (header.size != buffer_size && header.size != buffer_size - 1) {
+    BPLOG(ERROR) << "Serialized symbol data is truncated or corrupt"
+                 << ", expected size: " << header.size
+                 << ", actual size: " << buffer_size;
+    return false;
+  }
+  return true;
+}
+
+bool FastSourceLineResolver::Module::VerifyChecksum(const char* buffer,
+                                                    size_t buffer_size) {
+  if (!CheckHeader(buffer, buffer_size))
+    return false;
+
+  SerializedHeader header;
+  memcpy(&header, buffer, sizeof(header));
+  uint32_t checksum = Checksum(buffer + sizeof(header),
+                               header.size - sizeof(header));
+  if (checksum != header.checksum) {
+    BPLOG(ERROR) << "Serialized symbol data checksum mismatch, expected: "
+                 << HexString(header.checksum)
+                 << ", actual: " << HexString(checksum);
+    return false;
+  }
+  return true;
+}
+
 WindowsFrameInfo* FastSourceLineResolver::Module::FindWindowsFrameInfo(
     const StackFrame* frame) const {
   MemAddr address = frame->instruction - frame->module->base_address();
@@ -281,11 +382,15 @@ WindowsFrameInfo* FastSourceLineResolver::Module::FindWindowsFrameInfo(
   // WindowsFrameInfo::STACK_INFO_FPO is the older type
   // corresponding to the FPO_DATA struct. See stackwalker_x86.cc.
   const char* frame_info_ptr;
-  if ((windows_frame_info_[WindowsFrameInfo::STACK_INFO_FRAME_DATA]
-       .RetrieveRange(address, frame_info_ptr))
-      || (windows_frame_info_[WindowsFrameInfo::STACK_INFO_FPO]
-          .RetrieveRange(address, frame_info_ptr))) {
+  if ((flat_windows_frame_info_[WindowsFrameInfo::STACK_INFO_FRAME_DATA]
+       .RetrieveRange(address, &frame_info_ptr))
+      || (flat_windows_frame_info_[WindowsFrameInfo::STACK_INFO_FPO]
+          .RetrieveRange(address, &frame_info_ptr))) {
     result->CopyFrom(CopyWFI(frame_info_ptr));
+    if (!result->program_string.empty()) {
+      result->program = windows_program_cache_.Get(frame_info_ptr,
+                                                   result->program_string);
+    }
     return result.release();
   }
 
@@ -337,23 +442,114 @@ CFIFrameInfo* FastSourceLineResolver::Module::FindCFIFrameInfo(
     return NULL;
   }
 
+  // Find the delta rules from the start of the initial rule's range up to
+  // and including the frame's address.  The rule set they yield may have
+  // been built for an earlier frame.
+  StaticMap<MemAddr, char>::iterator first_delta =
+    cfi_delta_rules_.lower_bound(initial_base);
+  StaticMap<MemAddr, char>::iterator end_delta =
+    cfi_delta_rules_.upper_bound(address);
+  MemAddr last_delta_address = initial_base;
+  if (first_delta != end_delta) {
+    StaticMap<MemAddr, char>::iterator last_delta = end_delta;
+    --last_delta;
+    last_delta_address = last_delta.GetKey();
+  }
+  CFIFrameInfo* cached_rules =
+      cfi_frame_info_cache_.Find(initial_base, last_delta_address);
+  if (cached_rules)
+    return cached_rules;
+
   // Create a frame info structure, and populate it with the rules from
   // the STACK CFI INIT record.
   scoped_ptr<CFIFrameInfo> rules(new CFIFrameInfo());
   if (!ParseCFIRuleSet(initial_rules, rules.get()))
     return NULL;
 
-  // Find the first delta rule that falls within the initial rule's range.
-  StaticMap<MemAddr, char>::iterator delta =
-    cfi_delta_rules_.lower_bound(initial_base);
-
   // Apply delta rules up to and including the frame's address.
-  while (delta != cfi_delta_rules_.end() && delta.GetKey() <= address) {
+  for (StaticMap<MemAddr, char>::iterator delta = first_delta;
+       delta != end_delta; ++delta) {
     ParseCFIRuleSet(delta.GetValuePtr(), rules.get());
-    delta++;
   }
 
+  cfi_frame_info_cache_.Insert(initial_base, last_delta_address, *rules);
   return rules.release();
 }
 
+void FastSourceLineResolver::Module::GetFootprint(
+    SymbolFootprint* footprint) const {
+  *footprint = SymbolFootprint();
+  int map_id = 0;
+  const int kFilesMap = map_id++;
+  const int kFunctionsMap = map_id++;
+  const int kPublicSymbolsMap = map_id++;
+  const int kWindowsFrameInfoMaps = map_id;
+  map_id += WindowsFrameInfo::STACK_INFO_LAST;
+  const int kCFIInitialRulesMap = map_id++;
+  const int kCFIDeltaRulesMap = map_id++;
+  const int kInlineOriginsMap = map_id++;
+
+  // Whatever isn't in a map: the header, the map sizes, the padding that
+  // aligns the first map and the final null terminator.
+  uint64_t maps_size = 0;
+  for (int i = 0; i < kNumberMaps_; ++i)
+    maps_size += map_sizes_[i];
+  footprint->functions = data_size_ - maps_size;
+
+  // A function is its name, its fixed-size fields, its inlines and then
+  // its lines, which take up the rest of its entry.
+  const size_t kFunctionFields = 2 * sizeof(MemAddr) + sizeof(int32_t) +
+      SimpleSerializer<bool>::SizeOf(false) + sizeof(int32_t);
+  const char* first_entry = NULL;
+  uint64_t names = 0, inlines = 0;
+  functions_.VisitEntries([&](const Function* entry) {
+    const char* raw = reinterpret_cast<const char*>(entry);
+    if (!first_entry)
+      first_entry = raw;
+    size_t name_size = strlen(raw) + 1;
+    int32_t inline_size;
+    memcpy(&inline_size, raw + name_size + kFunctionFields - sizeof(int32_t),
+           sizeof(inline_size));
+    names += name_size;
+    inlines += inline_size;
+  });
+  if (first_entry) {
+    // Each entry follows its range's base address.
+    const char* entries = first_entry - sizeof(MemAddr);
+    uint64_t entries_size =
+        map_data_[kFunctionsMap] + map_sizes_[kFunctionsMap] - entries;
+    uint64_t fields = functions_.GetCount() *
+        (sizeof(MemAddr) + kFunctionFields);
+    footprint->functions += (entries - map_data_[kFunctionsMap]) + fields;
+    footprint->lines = entries_size - fields - names - inlines;
+    footprint->inlines = inlines;
+    footprint->strings = names;
+  } else {
+    footprint->functions += map_sizes_[kFunctionsMap];
+  }
+
+  names = 0;
+  public_symbols_.VisitEntries([&](const PublicSymbol* entry) {
+    names += strlen(reinterpret_cast<const char*>(entry)) + 1;
+  });
+  footprint->public_symbols = map_sizes_[kPublicSymbolsMap] - names;
+  footprint->strings += names;
+
+  // An origin's name follows its has_file_id and source_file_id.
+  names = 0;
+  for (StaticMap<int, char>::iterator origin = inline_origins_.begin();
+       origin != inline_origins_.end(); ++origin) {
+    names += strlen(origin.GetValuePtr() + sizeof(bool) + sizeof(int32_t)) + 1;
+  }
+  footprint->inlines += map_sizes_[kInlineOriginsMap] - names;
+  footprint->strings += names + map_sizes_[kFilesMap];
+
+  for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i) {
+    footprint->windows_frame_info += map_sizes_[kWindowsFrameInfoMaps + i] +
+        flat_windows_frame_info_[i].MemoryBytes();
+  }
+  footprint->cfi =
+      map_sizes_[kCFIInitialRulesMap] + map_sizes_[kCFIDeltaRulesMap];
+}
+
 }  // namespace google_breakpad
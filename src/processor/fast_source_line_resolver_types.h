@@ -37,6 +37,8 @@
 #ifndef PROCESSOR_FAST_SOURCE_LINE_RESOLVER_TYPES_H__
 #define PROCESSOR_FAST_SOURCE_LINE_RESOLVER_TYPES_H__
 
+#include <string.h>
+
 #include <cstdint>
 #include <map>
 #include <string>
@@ -49,6 +51,7 @@
 #include "processor/source_line_resolver_base_types.h"
 #include "processor/static_address_map-inl.h"
 #include "processor/static_contained_range_map-inl.h"
+#include "processor/static_line_table.h"
 #include "processor/static_map.h"
 #include "processor/static_range_map-inl.h"
 #include "processor/windows_frame_info.h"
@@ -59,21 +62,6 @@ namespace google_breakpad {
   field = *(reinterpret_cast<const decltype(field)*>(raw_ptr)); \
   raw_ptr += sizeof(field);
 
-struct FastSourceLineResolver::Line : public SourceLineResolverBase::Line {
-  void CopyFrom(const Line* line_ptr) {
-    const char* raw = reinterpret_cast<const char*>(line_ptr);
-    CopyFrom(raw);
-  }
-
-  // De-serialize the memory data of a Line.
-  void CopyFrom(const char* raw) {
-    DESERIALIZE(raw, address);
-    DESERIALIZE(raw, size);
-    DESERIALIZE(raw, source_file_id);
-    DESERIALIZE(raw, line);
-  }
-};
-
 struct FastSourceLineResolver::Function :
 public SourceLineResolverBase::Function {
   void CopyFrom(const Function* func_ptr) {
@@ -93,11 +81,11 @@ public SourceLineResolverBase::Function {
     int32_t inline_size;
     DESERIALIZE(raw, inline_size);
     inlines = StaticContainedRangeMap<MemAddr, char>(raw);
-    lines = StaticRangeMap<MemAddr, Line>(raw + inline_size);
+    lines = StaticLineTable(raw + inline_size);
   }
 
   StaticContainedRangeMap<MemAddr, char> inlines;
-  StaticRangeMap<MemAddr, Line> lines;
+  StaticLineTable lines;
 };
 
 struct FastSourceLineResolver::Inline : public SourceLineResolverBase::Inline {
@@ -161,7 +149,9 @@ public SourceLineResolverBase::PublicSymbol {
 
 class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
  public:
-  explicit Module(const string& name) : name_(name), is_corrupt_(false) { }
+  explicit Module(const string& name)
+      : name_(name), is_corrupt_(false), data_size_(0), map_data_(),
+        map_sizes_() { }
   virtual ~Module() { }
 
   // Looks up the given relative address, and fills the StackFrame struct
@@ -201,9 +191,84 @@ class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
   // returned CFIFrameInfo object.
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame) const;
 
+  // Sets |footprint| to the bytes of serialized data each kind of record
+  // takes up, which add up to the size of the data, plus the flattened
+  // STACK WIN maps built on load.  The header and the padding at the end
+  // of the functions map count toward functions and lines respectively.
+  virtual void GetFootprint(SymbolFootprint* footprint) const;
+
   // Number of serialized map components of Module.
   static const int kNumberMaps_ = 6 + WindowsFrameInfo::STACK_INFO_LAST;
 
+  // Serialized symbol data begins with this header, stored in host byte
+  // order like the rest of the data.  |size| is the total size of the
+  // serialized data including the header, and |checksum| is the Adler-32
+  // checksum of everything that follows the header.
+  struct SerializedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t checksum;
+  };
+  static const uint32_t kSerializedMagic = 0x53465042;  // "BPFS"
+  // Bump whenever the serialized layout changes.
+  static const uint32_t kSerializedVersion = 3;
+
+  // Each serialized map begins a multiple of kMapAlignment bytes from the
+  // start of the data, a cache line, and the size recorded for it includes
+  // the zero padding that follows it up to the next multiple.  Loaded from
+  // a page-aligned mapping or a huge-page copy, no map then shares a cache
+  // line with its neighbors, and the hot search indexes at their fronts
+  // start on one.
+  static const size_t kMapAlignment = 64;
+
+  // Returns |offset| rounded up to a multiple of kMapAlignment.
+  static size_t AlignMapOffset(size_t offset) {
+    return (offset + kMapAlignment - 1) & ~(kMapAlignment - 1);
+  }
+
+  // Zeroes the bytes from |dest| to the next map boundary, counting from
+  // |start|, the start of the serialized data, and returns the boundary.
+  static char* PadToMapAlignment(const char* start, char* dest) {
+    size_t offset = dest - start;
+    size_t padding = AlignMapOffset(offset) - offset;
+    memset(dest, 0, padding);
+    return dest + padding;
+  }
+
+  // Returns true if |buffer| begins with a header for the current format
+  // version whose recorded size matches |buffer_size|, allowing for one
+  // extra null terminator.  Only the header is read, so this is cheap even
+  // for memory-mapped data.
+  static bool CheckHeader(const char* buffer, size_t buffer_size);
+
+  // Returns true if |buffer| passes CheckHeader and the checksum recorded in
+  // its header matches its contents.  This reads the whole buffer.
+  static bool VerifyChecksum(const char* buffer, size_t buffer_size);
+
+  // Computes the checksum stored in SerializedHeader over |size| bytes.
+  // Defined here so that writers of serialized data need not link the
+  // resolver.
+  static uint32_t Checksum(const char* data, size_t size) {
+    // Adler-32.  5552 is the largest number of bytes that can be summed
+    // before the 32-bit sums must be reduced to avoid overflow.
+    static const uint32_t kModulus = 65521;
+    static const size_t kBlockSize = 5552;
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+      size_t block_size = size < kBlockSize ? size : kBlockSize;
+      size -= block_size;
+      for (; block_size > 0; --block_size) {
+        a += *bytes++;
+        b += a;
+      }
+      a %= kModulus;
+      b %= kModulus;
+    }
+    return (b << 16) | a;
+  }
+
  private:
   friend class FastSourceLineResolver;
   friend class ModuleComparer;
@@ -222,6 +287,11 @@ class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
   StaticContainedRangeMap<MemAddr, char>
     windows_frame_info_[WindowsFrameInfo::STACK_INFO_LAST];
 
+  // windows_frame_info_, flattened once the module is loaded, for
+  // FindWindowsFrameInfo to search (see flat_contained_range_map.h).
+  FlatContainedRangeMap<MemAddr, char>
+    flat_windows_frame_info_[WindowsFrameInfo::STACK_INFO_LAST];
+
   // DWARF CFI stack walking data. The Module stores the initial rule sets
   // and rule deltas as strings, just as they appear in the symbol file:
   // although the file may contain hundreds of thousands of STACK CFI
@@ -243,6 +313,12 @@ class FastSourceLineResolver::Module: public SourceLineResolverBase::Module {
   // INLINE_ORIGIN records: used as a function name string pool for INLINE
   // records.
   StaticMap<int, char> inline_origins_;
+
+  // The size of the serialized data, and where each map begins in it and
+  // its size, padding included, for GetFootprint().
+  size_t data_size_;
+  const char* map_data_[kNumberMaps_];
+  uint32_t map_sizes_[kNumberMaps_];
 };
 
 }  // namespace google_breakpad
@@ -40,10 +40,14 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <atomic>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/stack_frame.h"
@@ -54,6 +58,7 @@
 
 namespace {
 
+using google_breakpad::AutoTempDir;
 using google_breakpad::SourceLineResolverBase;
 using google_breakpad::BasicSourceLineResolver;
 using google_breakpad::FastSourceLineResolver;
@@ -65,6 +70,7 @@ using google_breakpad::MemoryRegion;
 using google_breakpad::StackFrame;
 using google_breakpad::WindowsFrameInfo;
 using google_breakpad::linked_ptr;
+using google_breakpad::scoped_array;
 using google_breakpad::scoped_ptr;
 
 class TestCodeModule : public CodeModule {
@@ -568,6 +574,299 @@ TEST_F(TestFastSourceLineResolver, TestUnload) {
   ASSERT_TRUE(fast_resolver.HasModule(&module1));
 }
 
+static bool WriteBuffer(const string& path, const char* data, size_t size) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(data, 1, size, f) == size;
+  return fclose(f) == 0 && ok;
+}
+
+TEST_F(TestFastSourceLineResolver, TestLoadMappedFile) {
+  AutoTempDir temp_dir;
+  string fast_file = temp_dir.path() + "/module1.fast";
+  ASSERT_TRUE(serializer.ConvertSymbolFile(symbol_file(1), fast_file));
+
+  TestCodeModule module1("module1");
+  ASSERT_TRUE(fast_resolver.LoadModule(&module1, fast_file));
+  ASSERT_TRUE(fast_resolver.HasModule(&module1));
+  ASSERT_FALSE(fast_resolver.IsModuleCorrupt(&module1));
+  ASSERT_FALSE(fast_resolver.LoadModule(&module1, fast_file));
+
+  StackFrame frame;
+  frame.instruction = 0x1000;
+  frame.module = &module1;
+  fast_resolver.FillSourceLineInfo(&frame, nullptr);
+  ASSERT_EQ(frame.function_name, "Function1_1");
+  ASSERT_EQ(frame.source_file_name, "file1_1.cc");
+  ASSERT_EQ(frame.source_line, 44);
+
+  fast_resolver.UnloadModule(&module1);
+  ASSERT_FALSE(fast_resolver.HasModule(&module1));
+  ASSERT_TRUE(fast_resolver.LoadModule(&module1, fast_file));
+  ASSERT_TRUE(fast_resolver.HasModule(&module1));
+}
+
+TEST_F(TestFastSourceLineResolver, TestLoadInHugePages) {
+  AutoTempDir temp_dir;
+  string fast_file = temp_dir.path() + "/module1.fast";
+  ASSERT_TRUE(serializer.ConvertSymbolFile(symbol_file(1), fast_file));
+
+  // The copy starts on a huge page boundary, and holds the whole file.
+  char* data;
+  size_t size;
+  ASSERT_TRUE(SourceLineResolverBase::CopySymbolFileToHugePages(
+      fast_file, &data, &size));
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(data) % (2 << 20));
+  EXPECT_TRUE(ModuleSerializer::VerifySerializedData(data, size));
+
+  // Every map starts on a 64-byte boundary.  The map sizes follow a
+  // 16-byte header and the corrupt flag, and the maps are followed by a
+  // null terminator.
+  const size_t kPrefixSize = 16 + 1;
+  const int kNumberMaps = 6 + WindowsFrameInfo::STACK_INFO_LAST;
+  const uint32_t* map_sizes =
+      reinterpret_cast<const uint32_t*>(data + kPrefixSize);
+  size_t offset = kPrefixSize + kNumberMaps * sizeof(uint32_t);
+  offset = (offset + 63) / 64 * 64;
+  for (int i = 0; i < kNumberMaps; ++i) {
+    EXPECT_EQ(0U, map_sizes[i] % 64);
+    offset += map_sizes[i];
+  }
+  EXPECT_EQ(size, offset + 1);
+  SourceLineResolverBase::UnmapSymbolFile(data, size);
+
+  TestCodeModule module1("module1");
+  fast_resolver.set_use_huge_pages(true);
+  ASSERT_TRUE(fast_resolver.LoadModule(&module1, fast_file));
+  ASSERT_FALSE(fast_resolver.IsModuleCorrupt(&module1));
+  StackFrame frame;
+  frame.instruction = 0x1000;
+  frame.module = &module1;
+  fast_resolver.FillSourceLineInfo(&frame, nullptr);
+  ASSERT_EQ(frame.function_name, "Function1_1");
+  ASSERT_EQ(frame.source_file_name, "file1_1.cc");
+  ASSERT_EQ(frame.source_line, 44);
+  fast_resolver.UnloadModule(&module1);
+}
+
+TEST_F(TestFastSourceLineResolver, TestVersionAndChecksum) {
+  char* symbol_data;
+  size_t symbol_data_size;
+  ASSERT_TRUE(SourceLineResolverBase::ReadSymbolFile(
+      symbol_file(1), &symbol_data, &symbol_data_size));
+  string symbol_data_string(symbol_data, symbol_data_size);
+  delete [] symbol_data;
+
+  unsigned int size;
+  scoped_array<char> serialized(
+      serializer.SerializeSymbolFileData(symbol_data_string, &size));
+  ASSERT_TRUE(serialized.get());
+  ASSERT_TRUE(ModuleSerializer::VerifySerializedData(serialized.get(), size));
+  string data(serialized.get(), size);
+
+  AutoTempDir temp_dir;
+  TestCodeModule module1("module1");
+
+  // A truncated file is rejected without being loaded.
+  string truncated_file = temp_dir.path() + "/truncated.fast";
+  ASSERT_TRUE(WriteBuffer(truncated_file, data.data(), data.size() / 2));
+  ASSERT_FALSE(ModuleSerializer::VerifySerializedData(data.data(),
+                                                      data.size() / 2));
+  ASSERT_FALSE(fast_resolver.LoadModule(&module1, truncated_file));
+  ASSERT_FALSE(fast_resolver.HasModule(&module1));
+
+  // So is a file written by a different version of the format.  The version
+  // immediately follows the four-byte magic number.
+  string version_data = data;
+  version_data[4]++;
+  string version_file = temp_dir.path() + "/version.fast";
+  ASSERT_TRUE(WriteBuffer(version_file, version_data.data(),
+                          version_data.size()));
+  ASSERT_FALSE(ModuleSerializer::VerifySerializedData(version_data.data(),
+                                                      version_data.size()));
+  ASSERT_FALSE(fast_resolver.LoadModule(&module1, version_file));
+  ASSERT_FALSE(fast_resolver.HasModule(&module1));
+
+  // Text symbol files aren't mistaken for serialized data.
+  ASSERT_FALSE(fast_resolver.LoadModule(&module1, symbol_file(1)));
+  ASSERT_FALSE(fast_resolver.HasModule(&module1));
+
+  // Damage past the header is caught by the checksum.
+  string damaged_data = data;
+  damaged_data[damaged_data.size() / 2] ^= 0x20;
+  ASSERT_FALSE(ModuleSerializer::VerifySerializedData(damaged_data.data(),
+                                                      damaged_data.size()));
+}
+
+TEST_F(TestFastSourceLineResolver, TestThreadSafeLookups) {
+  AutoTempDir temp_dir;
+  string fast_file1 = temp_dir.path() + "/module1.fast";
+  string fast_file2 = temp_dir.path() + "/module2.fast";
+  ASSERT_TRUE(serializer.ConvertSymbolFile(symbol_file(1), fast_file1));
+  ASSERT_TRUE(serializer.ConvertSymbolFile(symbol_file(2), fast_file2));
+
+  FastSourceLineResolver resolver(true);
+  TestCodeModule module1("module1");
+  TestCodeModule module2("module2");
+  const int kNumThreads = 8;
+  const int kNumLookups = 2000;
+  std::atomic<int> loads(0);
+  std::atomic<int> failures(0);
+
+  // Every thread races to load module1 and then looks addresses up in it,
+  // while the last thread also keeps loading and unloading module2.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::thread([&, i]() {
+      if (resolver.LoadModule(&module1, fast_file1))
+        ++loads;
+      for (int j = 0; j < kNumLookups; ++j) {
+        if (i == kNumThreads - 1) {
+          resolver.LoadModule(&module2, fast_file2);
+          resolver.UnloadModule(&module2);
+        }
+        StackFrame frame;
+        frame.instruction = 0x1000;
+        frame.module = &module1;
+        resolver.FillSourceLineInfo(&frame, nullptr);
+        if (frame.function_name != "Function1_1" ||
+            frame.source_file_name != "file1_1.cc" ||
+            frame.source_line != 44) {
+          ++failures;
+        }
+      }
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  ASSERT_EQ(loads, 1);
+  ASSERT_EQ(failures, 0);
+  ASSERT_TRUE(resolver.HasModule(&module1));
+  ASSERT_FALSE(resolver.HasModule(&module2));
+  FastSourceLineResolver::ModuleCacheStats stats =
+      resolver.GetModuleCacheStats();
+  ASSERT_EQ(stats.hits, 1U);
+  ASSERT_EQ(stats.misses, 1U);
+  ASSERT_EQ(stats.resident_modules, 1U);
+}
+
+// Modules serialized with search indexes should resolve every address the
+// way modules serialized without them do.
+TEST_F(TestFastSourceLineResolver, TestSearchIndex) {
+  string symbols = "MODULE Linux x86_64 000000000000000000000000000000000 big\n"
+                   "FILE 0 file0.cc\n";
+  char record[128];
+  const int kNumFunctions = 2000;
+  for (int i = 0; i < kNumFunctions; ++i) {
+    uint64_t address = 0x1000 + i * 0x100;
+    snprintf(record, sizeof(record), "FUNC %llx 80 0 function_%d\n",
+             static_cast<unsigned long long>(address), i);
+    symbols += record;
+    snprintf(record, sizeof(record), "%llx 40 %d 0\n",
+             static_cast<unsigned long long>(address), i);
+    symbols += record;
+  }
+  for (int i = 0; i < kNumFunctions; ++i) {
+    uint64_t address = 0x1000 + i * 0x100;
+    snprintf(record, sizeof(record), "PUBLIC %llx 0 public_%d\n",
+             static_cast<unsigned long long>(address + 0x80), i);
+    symbols += record;
+    snprintf(record, sizeof(record),
+             "STACK CFI INIT %llx 80 .cfa: $esp 4 + .ra: .cfa 4 - ^\n",
+             static_cast<unsigned long long>(address));
+    symbols += record;
+    snprintf(record, sizeof(record), "STACK CFI %llx .cfa: $esp %d +\n",
+             static_cast<unsigned long long>(address + 0x10), 8 + i % 8);
+    symbols += record;
+  }
+
+  unsigned int plain_size;
+  scoped_array<char> plain(
+      serializer.SerializeSymbolFileData(symbols, &plain_size));
+  ModuleSerializer indexed_serializer;
+  indexed_serializer.set_build_search_index(true);
+  unsigned int indexed_size;
+  scoped_array<char> indexed(
+      indexed_serializer.SerializeSymbolFileData(symbols, &indexed_size));
+  ASSERT_TRUE(plain.get());
+  ASSERT_TRUE(indexed.get());
+  ASSERT_GT(indexed_size, plain_size);
+  ASSERT_TRUE(ModuleSerializer::VerifySerializedData(indexed.get(),
+                                                     indexed_size));
+
+  FastSourceLineResolver indexed_resolver;
+  TestCodeModule module("big");
+  ASSERT_TRUE(fast_resolver.LoadModuleUsingMapBuffer(
+      &module, string(plain.get(), plain_size)));
+  ASSERT_TRUE(indexed_resolver.LoadModuleUsingMapBuffer(
+      &module, string(indexed.get(), indexed_size)));
+  ASSERT_FALSE(indexed_resolver.IsModuleCorrupt(&module));
+
+  for (uint64_t address = 0xf00; address < 0x1200 + kNumFunctions * 0x100;
+       address += 0x1c) {
+    StackFrame expected;
+    expected.instruction = address;
+    expected.module = &module;
+    fast_resolver.FillSourceLineInfo(&expected, nullptr);
+    StackFrame actual;
+    actual.instruction = address;
+    actual.module = &module;
+    indexed_resolver.FillSourceLineInfo(&actual, nullptr);
+    ASSERT_EQ(expected.function_name, actual.function_name);
+    ASSERT_EQ(expected.function_base, actual.function_base);
+    ASSERT_EQ(expected.source_file_name, actual.source_file_name);
+    ASSERT_EQ(expected.source_line, actual.source_line);
+
+    scoped_ptr<CFIFrameInfo> expected_cfi(
+        fast_resolver.FindCFIFrameInfo(&actual));
+    scoped_ptr<CFIFrameInfo> actual_cfi(
+        indexed_resolver.FindCFIFrameInfo(&actual));
+    ASSERT_EQ(expected_cfi.get() == NULL, actual_cfi.get() == NULL);
+    if (expected_cfi.get())
+      ASSERT_EQ(expected_cfi->Serialize(), actual_cfi->Serialize());
+  }
+}
+
+// The footprint of a converted module accounts for every byte of its
+// serialized data, plus the lookup tables built when it loads.
+TEST_F(TestFastSourceLineResolver, TestModuleFootprint) {
+  const string files[] = {
+    symbol_file(1),
+    symbol_file(2),
+    testdata_dir + "/symbols/linux_inline/BBA6FA10B8AAB33D00000000000000000/"
+        "linux_inline.new.sym"
+  };
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+    char* data;
+    size_t size;
+    ASSERT_TRUE(SourceLineResolverBase::ReadSymbolFile(files[i], &data,
+                                                       &size));
+    string symbols(data, size - 1);
+    delete [] data;
+    unsigned int serialized_size;
+    scoped_array<char> serialized(
+        serializer.SerializeSymbolFileData(symbols, &serialized_size));
+    ASSERT_TRUE(serialized.get());
+
+    TestCodeModule module("module");
+    FastSourceLineResolver resolver;
+    ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(
+        &module, string(serialized.get(), serialized_size)));
+    SourceLineResolverBase::SymbolFootprint footprint;
+    ASSERT_TRUE(resolver.GetModuleFootprint(&module, &footprint));
+    EXPECT_GT(footprint.functions, 0U);
+    EXPECT_GT(footprint.lines, 0U);
+    EXPECT_GT(footprint.strings, 0U);
+    // LoadModuleUsingMapBuffer adds a terminating NUL, and the flat STACK WIN
+    // tables add at most a few words per record.
+    EXPECT_LE(serialized_size + 1U, footprint.total());
+    EXPECT_GE(serialized_size + 1U + footprint.windows_frame_info,
+              footprint.total());
+  }
+}
+
 TEST_F(TestFastSourceLineResolver, CompareModule) {
   char* symbol_data;
   size_t symbol_data_size;
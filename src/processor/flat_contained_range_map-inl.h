@@ -0,0 +1,117 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// flat_contained_range_map-inl.h: FlatContainedRangeMap implementation.
+//
+// See flat_contained_range_map.h for documentation.
+
+#ifndef PROCESSOR_FLAT_CONTAINED_RANGE_MAP_INL_H__
+#define PROCESSOR_FLAT_CONTAINED_RANGE_MAP_INL_H__
+
+#include "processor/flat_contained_range_map.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+const int32_t FlatContainedRangeMap<AddressType, EntryType>::kNoParent;
+
+template<typename AddressType, typename EntryType>
+int32_t FlatContainedRangeMap<AddressType, EntryType>::AddRange(
+    const AddressType& base,
+    const AddressType& high,
+    int32_t parent,
+    const EntryType* entry) {
+  assert(bases_.empty() || base >= bases_.back());
+  assert(parent == kNoParent ||
+         (parent < static_cast<int32_t>(ranges_.size()) &&
+          base >= bases_[parent] && high <= ranges_[parent].high));
+  Range range;
+  range.high = high;
+  range.parent = parent;
+  range.entry = entry;
+  bases_.push_back(base);
+  ranges_.push_back(range);
+  return static_cast<int32_t>(ranges_.size() - 1);
+}
+
+template<typename AddressType, typename EntryType>
+int32_t FlatContainedRangeMap<AddressType, EntryType>::FindInnermost(
+    const AddressType& address) const {
+  // The innermost range containing |address| is either the last range
+  // based at or below it, or one of that range's ancestors: any range
+  // after it in the array that isn't its descendant begins beyond its end.
+  int32_t index = static_cast<int32_t>(
+      std::upper_bound(bases_.begin(), bases_.end(), address) -
+      bases_.begin()) - 1;
+  while (index != kNoParent && ranges_[index].high < address)
+    index = ranges_[index].parent;
+  return index;
+}
+
+template<typename AddressType, typename EntryType>
+bool FlatContainedRangeMap<AddressType, EntryType>::RetrieveRange(
+    const AddressType& address, const EntryType** entry) const {
+  int32_t index = FindInnermost(address);
+  if (index == kNoParent)
+    return false;
+  *entry = ranges_[index].entry;
+  return true;
+}
+
+template<typename AddressType, typename EntryType>
+bool FlatContainedRangeMap<AddressType, EntryType>::RetrieveRanges(
+    const AddressType& address,
+    std::vector<const EntryType*>& entries) const {
+  int32_t index = FindInnermost(address);
+  if (index == kNoParent)
+    return false;
+  // Every ancestor of a range containing |address| contains it too.
+  for (; index != kNoParent; index = ranges_[index].parent)
+    entries.push_back(ranges_[index].entry);
+  return true;
+}
+
+template<typename AddressType, typename EntryType>
+void FlatContainedRangeMap<AddressType, EntryType>::ShrinkToFit() {
+  bases_.shrink_to_fit();
+  ranges_.shrink_to_fit();
+}
+
+template<typename AddressType, typename EntryType>
+void FlatContainedRangeMap<AddressType, EntryType>::Clear() {
+  std::vector<AddressType>().swap(bases_);
+  std::vector<Range>().swap(ranges_);
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FLAT_CONTAINED_RANGE_MAP_INL_H__
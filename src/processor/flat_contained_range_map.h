@@ -0,0 +1,114 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// flat_contained_range_map.h: A contained range map flattened into arrays.
+//
+// ContainedRangeMap and StaticContainedRangeMap keep their ranges as a
+// tree, one map per level, so a lookup follows a pointer or offset and
+// binary searches again at each level it descends.  A
+// FlatContainedRangeMap holds the same ranges in the order a walk of the
+// tree visits them, which is by base address with each range before the
+// ranges it contains, and gives each range the index of its parent.  Only
+// the base addresses are searched, so a lookup is one binary search over a
+// contiguous array, followed by a walk up through the parents of the
+// range found until one of them contains the address.
+//
+// A FlatContainedRangeMap is built once, after the tree is complete, with
+// ContainedRangeMap::Flatten or StaticContainedRangeMap::Flatten, and
+// can't be modified.  Its entries are pointers to the tree's entries,
+// which must outlive it.
+
+#ifndef PROCESSOR_FLAT_CONTAINED_RANGE_MAP_H__
+#define PROCESSOR_FLAT_CONTAINED_RANGE_MAP_H__
+
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+class FlatContainedRangeMap {
+ public:
+  // The parent of a range not contained by any other.
+  static const int32_t kNoParent = -1;
+
+  FlatContainedRangeMap() : bases_(), ranges_() {}
+
+  // Appends a range from |base| to |high| inclusive.  Ranges must be added
+  // by base address, each after the range containing it, whose index is
+  // |parent|, or kNoParent.  Returns the new range's index.
+  int32_t AddRange(const AddressType& base,
+                   const AddressType& high,
+                   int32_t parent,
+                   const EntryType* entry);
+
+  // Retrieves the entry of the most specific (smallest) range containing
+  // |address|.  Returns false if no range contains it.
+  bool RetrieveRange(const AddressType& address,
+                     const EntryType** entry) const;
+
+  // Retrieves the entries of every range containing |address|, from the
+  // innermost to the outermost.
+  bool RetrieveRanges(const AddressType& address,
+                      std::vector<const EntryType*>& entries) const;
+
+  // Releases the memory the arrays don't use, once every range is added.
+  void ShrinkToFit();
+
+  void Clear();
+
+  bool empty() const { return bases_.empty(); }
+  size_t size() const { return bases_.size(); }
+
+  // Returns the bytes the arrays take up.
+  size_t MemoryBytes() const {
+    return bases_.capacity() * sizeof(AddressType) +
+        ranges_.capacity() * sizeof(Range);
+  }
+
+ private:
+  struct Range {
+    AddressType high;
+    int32_t parent;
+    const EntryType* entry;
+  };
+
+  // Returns the index of the innermost range containing |address|, or
+  // kNoParent.
+  int32_t FindInnermost(const AddressType& address) const;
+
+  // Each range's base address, kept apart from the rest so that searching
+  // them touches as little memory as possible.
+  std::vector<AddressType> bases_;
+  std::vector<Range> ranges_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FLAT_CONTAINED_RANGE_MAP_H__
@@ -0,0 +1,190 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// flat_contained_range_map_unittest.cc: Unit tests for
+// FlatContainedRangeMap, comparing its lookups with those of the
+// ContainedRangeMap and StaticContainedRangeMap it's flattened from.
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "processor/contained_range_map-inl.h"
+#include "processor/flat_contained_range_map-inl.h"
+#include "processor/map_serializers-inl.h"
+#include "processor/static_contained_range_map-inl.h"
+
+namespace {
+
+using google_breakpad::ContainedRangeMap;
+using google_breakpad::ContainedRangeMapSerializer;
+using google_breakpad::FlatContainedRangeMap;
+using google_breakpad::StaticContainedRangeMap;
+using google_breakpad::scoped_array;
+
+typedef ContainedRangeMap<unsigned int, int> TreeMap;
+typedef FlatContainedRangeMap<unsigned int, int> FlatMap;
+typedef StaticContainedRangeMap<unsigned int, int> StaticMap;
+
+const unsigned int kAddressSpace = 4096;
+
+// Stores |count| ranges at random, many of which |map| will refuse for
+// overlapping others.
+void StoreRandomRanges(TreeMap* map, int count) {
+  srand(0);
+  for (int i = 0; i < count; ++i) {
+    unsigned int size = 1 + rand() % (1 << (rand() % 10));
+    unsigned int base = rand() % (kAddressSpace - size);
+    map->StoreRange(base, size, i);
+  }
+}
+
+// Checks that |flat| and |tree| give the same entries for every address,
+// including those beyond every range.
+void ExpectSameLookups(const TreeMap& tree, const FlatMap& flat) {
+  for (unsigned int address = 0; address < kAddressSpace + 2; ++address) {
+    SCOPED_TRACE(address);
+    int tree_entry;
+    const int* flat_entry = NULL;
+    bool found = tree.RetrieveRange(address, &tree_entry);
+    ASSERT_EQ(found, flat.RetrieveRange(address, &flat_entry));
+    if (found)
+      ASSERT_EQ(tree_entry, *flat_entry);
+
+    std::vector<const int*> tree_entries, flat_entries;
+    ASSERT_EQ(tree.RetrieveRanges(address, tree_entries),
+              flat.RetrieveRanges(address, flat_entries));
+    ASSERT_EQ(tree_entries, flat_entries);
+  }
+}
+
+TEST(FlatContainedRangeMapTest, Empty) {
+  TreeMap tree;
+  FlatMap flat;
+  tree.Flatten(&flat);
+  EXPECT_TRUE(flat.empty());
+  const int* entry;
+  EXPECT_FALSE(flat.RetrieveRange(0, &entry));
+  std::vector<const int*> entries;
+  EXPECT_FALSE(flat.RetrieveRanges(0, entries));
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST(FlatContainedRangeMapTest, Nested) {
+  TreeMap tree;
+  ASSERT_TRUE(tree.StoreRange(10, 10, 1));
+  ASSERT_TRUE(tree.StoreRange(12, 2, 2));
+  ASSERT_TRUE(tree.StoreRange(16, 3, 3));
+  ASSERT_TRUE(tree.StoreRange(17, 1, 4));
+  ASSERT_TRUE(tree.StoreRange(30, 5, 5));
+  FlatMap flat;
+  tree.Flatten(&flat);
+  EXPECT_EQ(5U, flat.size());
+
+  const int* entry;
+  EXPECT_FALSE(flat.RetrieveRange(9, &entry));
+  ASSERT_TRUE(flat.RetrieveRange(10, &entry));
+  EXPECT_EQ(1, *entry);
+  ASSERT_TRUE(flat.RetrieveRange(13, &entry));
+  EXPECT_EQ(2, *entry);
+  // Past the end of 2 but still within 1.
+  ASSERT_TRUE(flat.RetrieveRange(15, &entry));
+  EXPECT_EQ(1, *entry);
+  ASSERT_TRUE(flat.RetrieveRange(17, &entry));
+  EXPECT_EQ(4, *entry);
+  // Past the ends of 4 and 3, which both come after 1 in the array.
+  ASSERT_TRUE(flat.RetrieveRange(19, &entry));
+  EXPECT_EQ(1, *entry);
+  EXPECT_FALSE(flat.RetrieveRange(20, &entry));
+  ASSERT_TRUE(flat.RetrieveRange(34, &entry));
+  EXPECT_EQ(5, *entry);
+  EXPECT_FALSE(flat.RetrieveRange(35, &entry));
+
+  std::vector<const int*> entries;
+  ASSERT_TRUE(flat.RetrieveRanges(17, entries));
+  ASSERT_EQ(3U, entries.size());
+  EXPECT_EQ(4, *entries[0]);
+  EXPECT_EQ(3, *entries[1]);
+  EXPECT_EQ(1, *entries[2]);
+
+  ExpectSameLookups(tree, flat);
+}
+
+TEST(FlatContainedRangeMapTest, MatchesTree) {
+  TreeMap tree;
+  StoreRandomRanges(&tree, 2000);
+  FlatMap flat;
+  tree.Flatten(&flat);
+  ExpectSameLookups(tree, flat);
+}
+
+TEST(FlatContainedRangeMapTest, MatchesTreeWithEqualRanges) {
+  TreeMap tree(true /* allow_equal_range */);
+  StoreRandomRanges(&tree, 2000);
+  ASSERT_TRUE(tree.StoreRange(0, 1, -1));
+  ASSERT_TRUE(tree.StoreRange(0, 1, -2));
+  FlatMap flat;
+  tree.Flatten(&flat);
+  ExpectSameLookups(tree, flat);
+}
+
+TEST(FlatContainedRangeMapTest, MatchesStaticMap) {
+  TreeMap tree;
+  StoreRandomRanges(&tree, 2000);
+  ContainedRangeMapSerializer<unsigned int, int> serializer;
+  scoped_array<char> serialized(serializer.Serialize(&tree, NULL));
+  StaticMap static_map(serialized.get());
+  FlatMap flat;
+  static_map.Flatten(&flat);
+
+  for (unsigned int address = 0; address < kAddressSpace + 2; ++address) {
+    SCOPED_TRACE(address);
+    const int* static_entry = NULL;
+    const int* flat_entry = NULL;
+    ASSERT_EQ(static_map.RetrieveRange(address, static_entry),
+              flat.RetrieveRange(address, &flat_entry));
+    ASSERT_EQ(static_entry, flat_entry);
+    int tree_entry;
+    if (tree.RetrieveRange(address, &tree_entry))
+      ASSERT_EQ(tree_entry, *flat_entry);
+
+    std::vector<const int*> static_entries, flat_entries;
+    ASSERT_EQ(static_map.RetrieveRanges(address, static_entries),
+              flat.RetrieveRanges(address, flat_entries));
+    ASSERT_EQ(static_entries, flat_entries);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
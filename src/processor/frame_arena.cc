@@ -0,0 +1,183 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// frame_arena.cc: Bulk storage for the stack frames of a ProcessState.
+//
+// See frame_arena.h for documentation.
+
+#include "processor/frame_arena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+#include "google_breakpad/processor/stack_frame.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Each frame is preceded by a pointer to the arena it was carved out of,
+// or NULL if it came from the heap, padded to keep the frame suitably
+// aligned.
+const size_t kFrameHeaderSize = alignof(std::max_align_t);
+
+// The arena of the innermost ScopedFrameArena on this thread, and the
+// part of a block this thread is carving frames out of.
+thread_local FrameArena* current_arena = NULL;
+thread_local char* current_next = NULL;
+thread_local char* current_end = NULL;
+
+}  // namespace
+
+FrameArena::FrameArena()
+    : next_block_(0), spare_begin_(NULL), spare_end_(NULL), references_(1) {
+}
+
+FrameArena::~FrameArena() {
+  for (size_t i = 0; i < blocks_.size(); ++i)
+    delete[] blocks_[i].data;
+}
+
+void FrameArena::Release() {
+  Unreference();
+}
+
+bool FrameArena::Reset() {
+  if (references_.load(std::memory_order_acquire) != 1)
+    return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  next_block_ = 0;
+  spare_begin_ = spare_end_ = NULL;
+  return true;
+}
+
+// static
+FrameArena* FrameArena::Current() {
+  return current_arena;
+}
+
+// static
+void* FrameArena::AllocateFrame(size_t size) {
+  // Round up so that frames carved out one after another stay aligned.
+  size_t total = kFrameHeaderSize +
+                 (size + kFrameHeaderSize - 1) / kFrameHeaderSize *
+                     kFrameHeaderSize;
+  FrameArena* arena = current_arena;
+  char* block;
+  if (!arena) {
+    block = static_cast<char*>(::operator new(total));
+  } else {
+    if (static_cast<size_t>(current_end - current_next) < total)
+      arena->TakeBlock(total, &current_next, &current_end);
+    block = current_next;
+    current_next += total;
+    arena->references_.fetch_add(1, std::memory_order_relaxed);
+  }
+  *reinterpret_cast<FrameArena**>(block) = arena;
+  return block + kFrameHeaderSize;
+}
+
+// static
+void FrameArena::FreeFrame(void* pointer) {
+  if (!pointer)
+    return;
+  char* block = static_cast<char*>(pointer) - kFrameHeaderSize;
+  FrameArena* arena = *reinterpret_cast<FrameArena**>(block);
+  if (!arena) {
+    ::operator delete(block);
+    return;
+  }
+  arena->Unreference();
+}
+
+void FrameArena::TakeBlock(size_t size, char** begin, char** end) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (static_cast<size_t>(spare_end_ - spare_begin_) >= size) {
+    *begin = spare_begin_;
+    *end = spare_end_;
+    spare_begin_ = spare_end_ = NULL;
+    return;
+  }
+  while (next_block_ < blocks_.size()) {
+    Block& block = blocks_[next_block_++];
+    if (block.size >= size) {
+      *begin = block.data;
+      *end = block.data + block.size;
+      return;
+    }
+  }
+  Block block;
+  block.size = std::max(kBlockSize, size);
+  block.data = new char[block.size];
+  blocks_.push_back(block);
+  next_block_ = blocks_.size();
+  *begin = block.data;
+  *end = block.data + block.size;
+}
+
+void FrameArena::GiveBackBlock(char* begin, char* end) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (end - begin > spare_end_ - spare_begin_) {
+    spare_begin_ = begin;
+    spare_end_ = end;
+  }
+}
+
+void FrameArena::Unreference() {
+  if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete this;
+}
+
+const size_t FrameArena::kBlockSize;
+
+ScopedFrameArena::ScopedFrameArena(FrameArena* arena)
+    : previous_arena_(current_arena),
+      previous_next_(current_next),
+      previous_end_(current_end) {
+  current_arena = arena;
+  current_next = current_end = NULL;
+}
+
+ScopedFrameArena::~ScopedFrameArena() {
+  if (current_arena && current_next != current_end)
+    current_arena->GiveBackBlock(current_next, current_end);
+  current_arena = previous_arena_;
+  current_next = previous_next_;
+  current_end = previous_end_;
+}
+
+void* StackFrame::operator new(size_t size) {
+  return FrameArena::AllocateFrame(size);
+}
+
+void StackFrame::operator delete(void* pointer) {
+  FrameArena::FreeFrame(pointer);
+}
+
+}  // namespace google_breakpad
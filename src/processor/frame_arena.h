@@ -0,0 +1,148 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// frame_arena.h: Bulk storage for the stack frames of a ProcessState.
+//
+// Walking a minidump's stacks creates a StackFrame, of the CPU's subclass,
+// for every frame of every thread, and another for every inlined frame
+// symbolization finds; with hundreds of threads that is tens of thousands
+// of allocations, all freed together when the ProcessState is cleared.
+// While a ScopedFrameArena exists, the StackFrames created with new on its
+// thread are instead carved out of large blocks belonging to its
+// FrameArena.  A FrameArena may be used from several threads at once, each
+// with a ScopedFrameArena of its own, carving from a block of its own.
+//
+// Deleting a frame from an arena runs its destructor but leaves its
+// storage in place.  The blocks are freed all at once, once the arena's
+// owner has released it and every frame carved out of it has been
+// deleted, so a frame may safely outlive its ProcessState; it just keeps
+// the arena's blocks alive until then.
+
+#ifndef PROCESSOR_FRAME_ARENA_H__
+#define PROCESSOR_FRAME_ARENA_H__
+
+#include <stddef.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace google_breakpad {
+
+struct StackFrame;
+
+class FrameArena {
+ public:
+  FrameArena();
+
+  // Gives up the owner's claim on the arena.  Its blocks are freed as
+  // soon as every frame carved out of them has been deleted too, which is
+  // right away if they all have been already.
+  void Release();
+
+  // Makes the arena's blocks available to carve new frames out of, from
+  // the start, and returns true, if every frame carved out of them has
+  // been deleted.  Otherwise, returns false, and the arena is left as it
+  // was.  Must not be called while a ScopedFrameArena is using the arena.
+  bool Reset();
+
+  // Returns the arena of the innermost ScopedFrameArena on this thread, or
+  // NULL if there is none, for passing on to other threads.
+  static FrameArena* Current();
+
+ private:
+  friend class ScopedFrameArena;
+  friend struct StackFrame;
+
+  ~FrameArena();
+
+  // Allocates |size| bytes for a StackFrame from the current thread's
+  // arena, or from the heap if there is none, and frees them again.
+  static void* AllocateFrame(size_t size);
+  static void FreeFrame(void* pointer);
+
+  // Sets [*begin, *end) to a block of at least |size| bytes: the unused
+  // end of a block some ScopedFrameArena gave back, if that is big enough,
+  // or the next block left unused since Reset(), or a new one.
+  void TakeBlock(size_t size, char** begin, char** end);
+
+  // Keeps the unused end [begin, end) of a block for the next TakeBlock(),
+  // if it is more than the one kept already.
+  void GiveBackBlock(char* begin, char* end);
+
+  // Drops a reference, deleting the arena if it was the last.
+  void Unreference();
+
+  static const size_t kBlockSize = 64 * 1024;
+
+  struct Block {
+    char* data;
+    size_t size;
+  };
+
+  // Guards blocks_, next_block_ and the spare block.  blocks_ from
+  // next_block_ on haven't been carved out of since Reset().
+  std::mutex mutex_;
+  std::vector<Block> blocks_;
+  size_t next_block_;
+  char* spare_begin_;
+  char* spare_end_;
+
+  // The frames carved out of the arena and not yet deleted, plus one until
+  // Release().
+  std::atomic<size_t> references_;
+
+  // Disallow copy constructor and assignment operator.
+  FrameArena(const FrameArena&);
+  void operator=(const FrameArena&);
+};
+
+// Carves the StackFrames created on this thread out of |arena| while it
+// exists, or allocates them from the heap if |arena| is NULL.  The arena
+// must not be released before the ScopedFrameArena is gone.
+// ScopedFrameArenas nest; the innermost one applies.
+class ScopedFrameArena {
+ public:
+  explicit ScopedFrameArena(FrameArena* arena);
+  ~ScopedFrameArena();
+
+ private:
+  // The enclosing ScopedFrameArena's arena, and the rest of the block it
+  // was carving frames out of.
+  FrameArena* previous_arena_;
+  char* previous_next_;
+  char* previous_end_;
+
+  // Disallow copy constructor and assignment operator.
+  ScopedFrameArena(const ScopedFrameArena&);
+  void operator=(const ScopedFrameArena&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FRAME_ARENA_H__
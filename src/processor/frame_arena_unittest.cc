@@ -0,0 +1,189 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// frame_arena_unittest.cc: Unit tests for FrameArena and ScopedFrameArena.
+
+#include <stdint.h>
+
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/frame_arena.h"
+
+namespace {
+
+using google_breakpad::FrameArena;
+using google_breakpad::ScopedFrameArena;
+using google_breakpad::StackFrame;
+using std::vector;
+
+// A frame bigger than StackFrame, as the CPUs' frames are.
+struct BigFrame : public StackFrame {
+  uint64_t registers[32];
+};
+
+bool IsAligned(const void* pointer) {
+  return reinterpret_cast<uintptr_t>(pointer) % alignof(std::max_align_t) ==
+      0;
+}
+
+TEST(FrameArenaTest, NoArena) {
+  EXPECT_EQ(NULL, FrameArena::Current());
+  StackFrame* frame = new StackFrame();
+  EXPECT_TRUE(IsAligned(frame));
+  frame->function_name = "heap";
+  delete frame;
+}
+
+TEST(FrameArenaTest, FramesShareBlocks) {
+  FrameArena* arena = new FrameArena();
+  vector<StackFrame*> frames;
+  {
+    ScopedFrameArena scoped_arena(arena);
+    EXPECT_EQ(arena, FrameArena::Current());
+    for (int i = 0; i < 100; ++i) {
+      StackFrame* frame = i % 2 ? new StackFrame() : new BigFrame();
+      EXPECT_TRUE(IsAligned(frame));
+      frame->instruction = i;
+      frame->function_name = string(100, 'a' + i % 26);
+      frames.push_back(frame);
+    }
+  }
+  EXPECT_EQ(NULL, FrameArena::Current());
+
+  // Frames carved one after another from a block sit one after another.
+  for (size_t i = 1; i < frames.size(); ++i) {
+    EXPECT_LT(reinterpret_cast<char*>(frames[i - 1]),
+              reinterpret_cast<char*>(frames[i]));
+  }
+  for (size_t i = 0; i < frames.size(); ++i) {
+    EXPECT_EQ(i, frames[i]->instruction);
+    EXPECT_EQ(string(100, 'a' + i % 26), frames[i]->function_name);
+    delete frames[i];
+  }
+  arena->Release();
+}
+
+TEST(FrameArenaTest, FramesOutliveRelease) {
+  FrameArena* arena = new FrameArena();
+  StackFrame* frame;
+  {
+    ScopedFrameArena scoped_arena(arena);
+    frame = new BigFrame();
+  }
+  arena->Release();
+  // The arena's block stays until its last frame is deleted.
+  frame->function_name = "still here";
+  EXPECT_EQ("still here", frame->function_name);
+  delete frame;
+}
+
+TEST(FrameArenaTest, Reset) {
+  FrameArena* arena = new FrameArena();
+  StackFrame* first;
+  {
+    ScopedFrameArena scoped_arena(arena);
+    first = new BigFrame();
+  }
+  // Not while a frame is left.
+  EXPECT_FALSE(arena->Reset());
+  delete first;
+  EXPECT_TRUE(arena->Reset());
+
+  // Frames are carved out of the same block again, from its start.
+  {
+    ScopedFrameArena scoped_arena(arena);
+    StackFrame* again = new BigFrame();
+    EXPECT_EQ(first, again);
+    delete again;
+  }
+  arena->Release();
+}
+
+TEST(FrameArenaTest, Nesting) {
+  FrameArena* arena = new FrameArena();
+  {
+    ScopedFrameArena scoped_arena(arena);
+    StackFrame* before = new StackFrame();
+    StackFrame* heap_frame;
+    {
+      ScopedFrameArena heap_frames(NULL);
+      EXPECT_EQ(NULL, FrameArena::Current());
+      heap_frame = new StackFrame();
+    }
+    EXPECT_EQ(arena, FrameArena::Current());
+    // The outer scope carries on carving from where it left off.
+    StackFrame* after = new StackFrame();
+    EXPECT_LT(reinterpret_cast<char*>(before),
+              reinterpret_cast<char*>(after));
+    EXPECT_GT(reinterpret_cast<char*>(before) + 1024,
+              reinterpret_cast<char*>(after));
+    delete before;
+    delete heap_frame;
+    delete after;
+  }
+  arena->Release();
+}
+
+TEST(FrameArenaTest, Threads) {
+  const int kThreads = 8;
+  const int kFramesPerThread = 10000;
+  FrameArena* arena = new FrameArena();
+  vector<vector<StackFrame*> > frames(kThreads);
+  auto allocate = [&](int thread) {
+    ScopedFrameArena scoped_arena(arena);
+    for (int i = 0; i < kFramesPerThread; ++i) {
+      StackFrame* frame = new BigFrame();
+      frame->instruction = thread * kFramesPerThread + i;
+      frames[thread].push_back(frame);
+    }
+  };
+  vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i)
+    threads.push_back(std::thread(allocate, i));
+  for (int i = 0; i < kThreads; ++i)
+    threads[i].join();
+  arena->Release();
+
+  for (int thread = 0; thread < kThreads; ++thread) {
+    for (int i = 0; i < kFramesPerThread; ++i) {
+      EXPECT_EQ(static_cast<uint64_t>(thread * kFramesPerThread + i),
+                frames[thread][i]->instruction);
+      delete frames[thread][i];
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,216 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// frame_symbol_cache.cc: What StackFrameSymbolizers find for each address
+// of a module, kept across minidumps.
+//
+// See frame_symbol_cache.h for documentation.
+
+#include "processor/frame_symbol_cache.h"
+
+#include "google_breakpad/processor/code_module.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/windows_frame_info.h"
+
+namespace google_breakpad {
+
+const size_t FrameSymbolCache::kDefaultMaxAddresses;
+
+FrameSymbolCache::AddressResults::AddressResults()
+    : has_source_line_info(false),
+      function_base(0),
+      source_line(0),
+      source_line_base(0),
+      corrupt(false),
+      has_cfi_frame_info(false),
+      has_windows_frame_info(false) {}
+
+FrameSymbolCache::AddressResults::~AddressResults() {}
+
+FrameSymbolCache::FrameSymbolCache()
+    : max_addresses_(kDefaultMaxAddresses), address_count_(0), hits_(0),
+      misses_(0) {}
+
+FrameSymbolCache::FrameSymbolCache(size_t max_addresses)
+    : max_addresses_(max_addresses), address_count_(0), hits_(0),
+      misses_(0) {}
+
+FrameSymbolCache::~FrameSymbolCache() {}
+
+bool FrameSymbolCache::FindSourceLineInfo(
+    StackFrame* frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+    bool* corrupt) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const AddressResults* results = FindLocked(*frame);
+  bool hit = results && results->has_source_line_info;
+  Count(hit);
+  if (!hit)
+    return false;
+
+  uint64_t base = frame->module->base_address();
+  frame->function_name = results->function_name;
+  frame->function_base = base + results->function_base;
+  frame->source_file_name = results->source_file_name;
+  frame->source_line = results->source_line;
+  frame->source_line_base = base + results->source_line_base;
+  if (inlined_frames) {
+    // As the resolver builds them: copies of the outer frame, with the
+    // inlined function's name and the source line of its call or, for
+    // the innermost, of the instruction.
+    for (size_t i = 0; i < results->inlined_frames.size(); ++i) {
+      const InlinedFrame& inlined = results->inlined_frames[i];
+      std::unique_ptr<StackFrame> inlined_frame(new StackFrame(*frame));
+      inlined_frame->function_name = inlined.function_name;
+      inlined_frame->function_base = base + inlined.function_base;
+      inlined_frame->source_file_name = inlined.source_file_name;
+      inlined_frame->source_line = inlined.source_line;
+      inlined_frame->trust = StackFrame::FRAME_TRUST_INLINE;
+      inlined_frames->push_back(std::move(inlined_frame));
+    }
+  }
+  *corrupt = results->corrupt;
+  return true;
+}
+
+void FrameSymbolCache::InsertSourceLineInfo(
+    const StackFrame& frame,
+    const std::deque<std::unique_ptr<StackFrame>>& inlined_frames,
+    bool corrupt) {
+  uint64_t base = frame.module->base_address();
+  std::lock_guard<std::mutex> lock(mutex_);
+  AddressResults* results = InsertLocked(frame);
+  results->has_source_line_info = true;
+  results->function_name = frame.function_name;
+  results->function_base = frame.function_base - base;
+  results->source_file_name = frame.source_file_name;
+  results->source_line = frame.source_line;
+  results->source_line_base = frame.source_line_base - base;
+  results->inlined_frames.resize(inlined_frames.size());
+  for (size_t i = 0; i < inlined_frames.size(); ++i) {
+    InlinedFrame& inlined = results->inlined_frames[i];
+    inlined.function_name = inlined_frames[i]->function_name;
+    inlined.function_base = inlined_frames[i]->function_base - base;
+    inlined.source_file_name = inlined_frames[i]->source_file_name;
+    inlined.source_line = inlined_frames[i]->source_line;
+  }
+  results->corrupt = corrupt;
+}
+
+bool FrameSymbolCache::FindCFIFrameInfo(const StackFrame& frame,
+                                        CFIFrameInfo** cfi_frame_info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const AddressResults* results = FindLocked(frame);
+  bool hit = results && results->has_cfi_frame_info;
+  Count(hit);
+  if (!hit)
+    return false;
+  *cfi_frame_info = results->cfi_frame_info ?
+      new CFIFrameInfo(*results->cfi_frame_info) : NULL;
+  return true;
+}
+
+void FrameSymbolCache::InsertCFIFrameInfo(
+    const StackFrame& frame,
+    const CFIFrameInfo* cfi_frame_info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AddressResults* results = InsertLocked(frame);
+  results->has_cfi_frame_info = true;
+  results->cfi_frame_info.reset(
+      cfi_frame_info ? new CFIFrameInfo(*cfi_frame_info) : NULL);
+}
+
+bool FrameSymbolCache::FindWindowsFrameInfo(
+    const StackFrame& frame,
+    WindowsFrameInfo** windows_frame_info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const AddressResults* results = FindLocked(frame);
+  bool hit = results && results->has_windows_frame_info;
+  Count(hit);
+  if (!hit)
+    return false;
+  *windows_frame_info = results->windows_frame_info ?
+      new WindowsFrameInfo(*results->windows_frame_info) : NULL;
+  return true;
+}
+
+void FrameSymbolCache::InsertWindowsFrameInfo(
+    const StackFrame& frame,
+    const WindowsFrameInfo* windows_frame_info) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AddressResults* results = InsertLocked(frame);
+  results->has_windows_frame_info = true;
+  results->windows_frame_info.reset(
+      windows_frame_info ? new WindowsFrameInfo(*windows_frame_info) : NULL);
+}
+
+void FrameSymbolCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  modules_.clear();
+  address_count_ = 0;
+}
+
+// static
+string FrameSymbolCache::ModuleKey(const CodeModule* module) {
+  return module->code_file() + '\n' + module->debug_file() + '\n' +
+      module->debug_identifier();
+}
+
+const FrameSymbolCache::AddressResults* FrameSymbolCache::FindLocked(
+    const StackFrame& frame) {
+  std::map<string, AddressMap>::const_iterator module =
+      modules_.find(ModuleKey(frame.module));
+  if (module == modules_.end())
+    return NULL;
+  AddressMap::const_iterator address = module->second.find(
+      frame.instruction - frame.module->base_address());
+  return address != module->second.end() ? &address->second : NULL;
+}
+
+FrameSymbolCache::AddressResults* FrameSymbolCache::InsertLocked(
+    const StackFrame& frame) {
+  string key = ModuleKey(frame.module);
+  uint64_t address = frame.instruction - frame.module->base_address();
+  std::map<string, AddressMap>::iterator module = modules_.find(key);
+  if (module != modules_.end()) {
+    AddressMap::iterator it = module->second.find(address);
+    if (it != module->second.end())
+      return &it->second;
+  }
+  if (address_count_ >= max_addresses_) {
+    // A crash spike reuses a small set of addresses, which are soon
+    // cached again.
+    modules_.clear();
+    address_count_ = 0;
+  }
+  ++address_count_;
+  return &modules_[key][address];
+}
+
+}  // namespace google_breakpad
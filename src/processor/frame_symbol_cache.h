@@ -0,0 +1,185 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// frame_symbol_cache.h: What StackFrameSymbolizers find for each address
+// of a module, kept across minidumps.
+//
+// A crash that happens often leaves thousands of minidumps with the same
+// stacks, and symbolizing each frame of each of them repeats the same
+// lookups in the resolver: the function, source line and inlined frames
+// at the frame's address, and the Windows frame info or CFI rules that
+// unwind it.  A FrameSymbolCache given to the symbolizers that process
+// them remembers each result, keyed by module and module-relative address,
+// so that each is looked up in the resolver once.  Rule sets are kept
+// compiled, as CFIFrameInfo and WindowsFrameInfo.
+//
+// Modules are identified by code_file, debug_file and debug_identifier,
+// as SymbolLoadCache identifies them, so different builds of one library
+// are kept apart, and one build loaded at different addresses shares its
+// results.  Only results found with the module's symbols loaded are kept.
+// The cache holds up to a number of addresses' results, and is emptied
+// when full.  It is safe to share between threads.
+
+#ifndef PROCESSOR_FRAME_SYMBOL_CACHE_H__
+#define PROCESSOR_FRAME_SYMBOL_CACHE_H__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/stack_frame.h"
+
+namespace google_breakpad {
+
+class CFIFrameInfo;
+class CodeModule;
+struct WindowsFrameInfo;
+
+class FrameSymbolCache {
+ public:
+  // The number of addresses whose results are kept, unless the cache is
+  // created with another limit.
+  static const size_t kDefaultMaxAddresses = 1 << 18;
+
+  FrameSymbolCache();
+  explicit FrameSymbolCache(size_t max_addresses);
+  ~FrameSymbolCache();
+
+  // If source line info for |frame|'s module and instruction is cached,
+  // fills it into |frame|, appends the inlined frames to |inlined_frames|
+  // unless it is NULL, sets |*corrupt| to whether the module's symbols
+  // were corrupt, and returns true.  |frame->module| must be set.
+  bool FindSourceLineInfo(
+      StackFrame* frame,
+      std::deque<std::unique_ptr<StackFrame>>* inlined_frames,
+      bool* corrupt);
+
+  // Caches the source line info the resolver filled into |frame|, and
+  // the |inlined_frames| it found.
+  void InsertSourceLineInfo(
+      const StackFrame& frame,
+      const std::deque<std::unique_ptr<StackFrame>>& inlined_frames,
+      bool corrupt);
+
+  // If CFI rules for |frame|'s module and instruction are cached, sets
+  // |*cfi_frame_info| to a new copy of them owned by the caller, or to
+  // NULL if the module has none there, and returns true.
+  bool FindCFIFrameInfo(const StackFrame& frame,
+                        CFIFrameInfo** cfi_frame_info);
+
+  // Caches |cfi_frame_info|, which may be NULL, for |frame|.
+  void InsertCFIFrameInfo(const StackFrame& frame,
+                          const CFIFrameInfo* cfi_frame_info);
+
+  // Likewise for Windows frame info.
+  bool FindWindowsFrameInfo(const StackFrame& frame,
+                            WindowsFrameInfo** windows_frame_info);
+  void InsertWindowsFrameInfo(const StackFrame& frame,
+                              const WindowsFrameInfo* windows_frame_info);
+
+  // Lookups answered from the cache, and those that weren't.
+  uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+  // Forgets every result.
+  void Clear();
+
+ private:
+  // An inlined frame, with its function_base relative to the module.
+  struct InlinedFrame {
+    string function_name;
+    uint64_t function_base;
+    string source_file_name;
+    int source_line;
+  };
+
+  // What is known about one address of a module.  Addresses are relative
+  // to the module's base address.
+  struct AddressResults {
+    AddressResults();
+    ~AddressResults();
+
+    bool has_source_line_info;
+    string function_name;
+    uint64_t function_base;
+    string source_file_name;
+    int source_line;
+    uint64_t source_line_base;
+    std::vector<InlinedFrame> inlined_frames;
+    bool corrupt;
+
+    bool has_cfi_frame_info;
+    std::unique_ptr<CFIFrameInfo> cfi_frame_info;
+
+    bool has_windows_frame_info;
+    std::unique_ptr<WindowsFrameInfo> windows_frame_info;
+  };
+
+  typedef std::map<uint64_t, AddressResults> AddressMap;
+
+  static string ModuleKey(const CodeModule* module);
+
+  // Returns the results cached for |frame|, or NULL.  Must be called with
+  // mutex_ held.
+  const AddressResults* FindLocked(const StackFrame& frame);
+
+  // Returns the results for |frame|, adding them if needed and emptying
+  // the cache first if it is full.  Must be called with mutex_ held.
+  AddressResults* InsertLocked(const StackFrame& frame);
+
+  void Count(bool hit) {
+    (hit ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+  }
+
+  size_t max_addresses_;
+
+  // The results, by ModuleKey() and then relative address, the number of
+  // addresses they cover, and the mutex guarding them.
+  std::map<string, AddressMap> modules_;
+  size_t address_count_;
+  std::mutex mutex_;
+
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+
+  // Disallow copy constructor and assignment operator.
+  FrameSymbolCache(const FrameSymbolCache&);
+  void operator=(const FrameSymbolCache&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_FRAME_SYMBOL_CACHE_H__
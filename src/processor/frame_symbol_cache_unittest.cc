@@ -0,0 +1,257 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// frame_symbol_cache_unittest.cc: Unit tests for FrameSymbolCache, alone
+// and as StackFrameSymbolizer uses it.
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/frame_symbol_cache.h"
+#include "processor/stackwalker_unittest_utils.h"
+#include "processor/windows_frame_info.h"
+
+namespace {
+
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CFIFrameInfo;
+using google_breakpad::FrameSymbolCache;
+using google_breakpad::StackFrame;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::WindowsFrameInfo;
+using google_breakpad::scoped_ptr;
+using std::deque;
+using std::unique_ptr;
+
+// A resolver that counts the lookups it answers.
+class CountingResolver : public BasicSourceLineResolver {
+ public:
+  CountingResolver() : source_line_lookups(0), cfi_lookups(0),
+                       windows_lookups(0) {}
+
+  void FillSourceLineInfo(StackFrame* frame,
+                          deque<unique_ptr<StackFrame>>* inlined_frames) {
+    ++source_line_lookups;
+    BasicSourceLineResolver::FillSourceLineInfo(frame, inlined_frames);
+  }
+  CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame) {
+    ++cfi_lookups;
+    return BasicSourceLineResolver::FindCFIFrameInfo(frame);
+  }
+  WindowsFrameInfo* FindWindowsFrameInfo(const StackFrame* frame) {
+    ++windows_lookups;
+    return BasicSourceLineResolver::FindWindowsFrameInfo(frame);
+  }
+
+  int source_line_lookups;
+  int cfi_lookups;
+  int windows_lookups;
+};
+
+class FrameSymbolCacheTest : public ::testing::Test {
+ public:
+  FrameSymbolCacheTest()
+      : module_a_(0x10000, 0x10000, "module1", ""),
+        module_b_(0x80000, 0x10000, "module1", ""),
+        other_module_(0x10000, 0x10000, "module2", "") {}
+
+  void SetUp() {
+    testdata_dir_ = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                    "/src/processor/testdata";
+  }
+
+  MockCodeModule module_a_;
+  MockCodeModule module_b_;
+  MockCodeModule other_module_;
+  string testdata_dir_;
+};
+
+TEST_F(FrameSymbolCacheTest, SourceLineInfoRebasedToEachModule) {
+  FrameSymbolCache cache;
+  StackFrame frame;
+  frame.module = &module_a_;
+  frame.instruction = 0x11004;
+  frame.function_name = "Function1_1";
+  frame.function_base = 0x11000;
+  frame.source_file_name = "file1_1.cc";
+  frame.source_line = 45;
+  frame.source_line_base = 0x11004;
+  deque<unique_ptr<StackFrame>> inlined_frames;
+  inlined_frames.push_back(unique_ptr<StackFrame>(new StackFrame(frame)));
+  inlined_frames.back()->function_name = "Inlined";
+  inlined_frames.back()->function_base = 0x11002;
+  inlined_frames.back()->source_line = 12;
+  cache.InsertSourceLineInfo(frame, inlined_frames, true);
+
+  // The same address of another load of the module.
+  StackFrame found;
+  found.module = &module_b_;
+  found.instruction = 0x81004;
+  deque<unique_ptr<StackFrame>> found_inlined;
+  bool corrupt = false;
+  ASSERT_TRUE(cache.FindSourceLineInfo(&found, &found_inlined, &corrupt));
+  EXPECT_TRUE(corrupt);
+  EXPECT_EQ("Function1_1", found.function_name);
+  EXPECT_EQ(0x81000U, found.function_base);
+  EXPECT_EQ("file1_1.cc", found.source_file_name);
+  EXPECT_EQ(45, found.source_line);
+  EXPECT_EQ(0x81004U, found.source_line_base);
+  ASSERT_EQ(1U, found_inlined.size());
+  EXPECT_EQ("Inlined", found_inlined[0]->function_name);
+  EXPECT_EQ(0x81002U, found_inlined[0]->function_base);
+  EXPECT_EQ(12, found_inlined[0]->source_line);
+  EXPECT_EQ(0x81004U, found_inlined[0]->instruction);
+  EXPECT_EQ(StackFrame::FRAME_TRUST_INLINE, found_inlined[0]->trust);
+
+  // Neither another address nor another module is cached.
+  found.instruction = 0x81008;
+  EXPECT_FALSE(cache.FindSourceLineInfo(&found, NULL, &corrupt));
+  found.module = &other_module_;
+  found.instruction = 0x11004;
+  EXPECT_FALSE(cache.FindSourceLineInfo(&found, NULL, &corrupt));
+  EXPECT_EQ(1U, cache.hits());
+  EXPECT_EQ(2U, cache.misses());
+}
+
+TEST_F(FrameSymbolCacheTest, FrameInfoCopiesAndAbsence) {
+  FrameSymbolCache cache;
+  StackFrame frame;
+  frame.module = &module_a_;
+  frame.instruction = 0x13d41;
+
+  CFIFrameInfo* cfi_frame_info;
+  EXPECT_FALSE(cache.FindCFIFrameInfo(frame, &cfi_frame_info));
+  CFIFrameInfo rules;
+  rules.SetCFARule(".cfa: $esp 8 +");
+  rules.SetRARule(".cfa 4 - ^");
+  cache.InsertCFIFrameInfo(frame, &rules);
+  ASSERT_TRUE(cache.FindCFIFrameInfo(frame, &cfi_frame_info));
+  scoped_ptr<CFIFrameInfo> cfi_copy(cfi_frame_info);
+  ASSERT_TRUE(cfi_copy.get());
+  EXPECT_NE(&rules, cfi_copy.get());
+  EXPECT_EQ(rules.Serialize(), cfi_copy->Serialize());
+
+  // A module without Windows frame info at an address is remembered too.
+  WindowsFrameInfo* windows_frame_info;
+  EXPECT_FALSE(cache.FindWindowsFrameInfo(frame, &windows_frame_info));
+  cache.InsertWindowsFrameInfo(frame, NULL);
+  ASSERT_TRUE(cache.FindWindowsFrameInfo(frame, &windows_frame_info));
+  EXPECT_EQ(NULL, windows_frame_info);
+
+  // Source line info wasn't cached with the rest.
+  bool corrupt;
+  EXPECT_FALSE(cache.FindSourceLineInfo(&frame, NULL, &corrupt));
+}
+
+TEST_F(FrameSymbolCacheTest, EmptiedWhenFull) {
+  FrameSymbolCache cache(2);
+  StackFrame frame;
+  frame.module = &module_a_;
+  for (uint64_t address = 0x11000; address < 0x11003; ++address) {
+    frame.instruction = address;
+    cache.InsertCFIFrameInfo(frame, NULL);
+  }
+  CFIFrameInfo* cfi_frame_info;
+  frame.instruction = 0x11000;
+  EXPECT_FALSE(cache.FindCFIFrameInfo(frame, &cfi_frame_info));
+  frame.instruction = 0x11002;
+  EXPECT_TRUE(cache.FindCFIFrameInfo(frame, &cfi_frame_info));
+
+  cache.Clear();
+  EXPECT_FALSE(cache.FindCFIFrameInfo(frame, &cfi_frame_info));
+}
+
+TEST_F(FrameSymbolCacheTest, SymbolizersShareResolverLookups) {
+  CountingResolver resolver;
+  ASSERT_TRUE(resolver.LoadModule(&module_a_,
+                                  testdata_dir_ + "/module1.out"));
+  MockCodeModules modules_a;
+  modules_a.Add(&module_a_);
+  MockCodeModules modules_b;
+  modules_b.Add(&module_b_);
+  FrameSymbolCache cache;
+
+  for (int i = 0; i < 2; ++i) {
+    StackFrameSymbolizer symbolizer(NULL, &resolver);
+    symbolizer.set_frame_symbol_cache(&cache);
+    StackFrame frame;
+    frame.instruction = (i == 0 ? 0x10000 : 0x80000) + 0x1004;
+    deque<unique_ptr<StackFrame>> inlined_frames;
+    EXPECT_EQ(StackFrameSymbolizer::kNoError,
+              symbolizer.FillSourceLineInfo(i == 0 ? &modules_a : &modules_b,
+                                            NULL, NULL, &frame,
+                                            &inlined_frames));
+    EXPECT_EQ("Function1_1", frame.function_name);
+    EXPECT_EQ(45, frame.source_line);
+    scoped_ptr<WindowsFrameInfo> windows_frame_info(
+        symbolizer.FindWindowsFrameInfo(&frame));
+    ASSERT_TRUE(windows_frame_info.get());
+    EXPECT_EQ(1U, windows_frame_info->prolog_size);
+
+    frame.instruction = (i == 0 ? 0x10000 : 0x80000) + 0x3d44;
+    scoped_ptr<CFIFrameInfo> cfi_frame_info(
+        symbolizer.FindCFIFrameInfo(&frame));
+    ASSERT_TRUE(cfi_frame_info.get());
+    EXPECT_EQ(".cfa: $ebp 8 + .ra: .cfa 4 - ^ $ebp: .cfa 8 - ^",
+              cfi_frame_info->Serialize());
+  }
+  EXPECT_EQ(1, resolver.source_line_lookups);
+  EXPECT_EQ(1, resolver.windows_lookups);
+  EXPECT_EQ(1, resolver.cfi_lookups);
+  EXPECT_EQ(3U, cache.hits());
+}
+
+TEST_F(FrameSymbolCacheTest, UnloadedModulesNotCached) {
+  CountingResolver resolver;
+  FrameSymbolCache cache;
+  StackFrameSymbolizer symbolizer(NULL, &resolver);
+  symbolizer.set_frame_symbol_cache(&cache);
+  StackFrame frame;
+  frame.module = &module_a_;
+  frame.instruction = 0x13d44;
+  for (int i = 0; i < 2; ++i)
+    EXPECT_EQ(NULL, symbolizer.FindCFIFrameInfo(&frame));
+  EXPECT_EQ(2, resolver.cfi_lookups);
+  EXPECT_EQ(0U, cache.hits() + cache.misses());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
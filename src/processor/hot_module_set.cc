@@ -0,0 +1,225 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// hot_module_set.cc: The modules a processor serves most, kept across
+// restarts so that a new process can load them before taking work.
+//
+// See hot_module_set.h for documentation.
+
+#include "processor/hot_module_set.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/source_line_resolver_interface.h"
+#include "google_breakpad/processor/symbol_supplier.h"
+#include "processor/basic_code_module.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Returns true if |name| can be saved in a line of tab-separated fields.
+bool IsSavable(const string& name) {
+  return name.find_first_of("\t\n") == string::npos;
+}
+
+}  // namespace
+
+void HotModuleSet::Record(const CodeModule* module) {
+  string code_file = module->code_file();
+  string debug_file = module->debug_file();
+  string debug_identifier = module->debug_identifier();
+  string key = code_file + '\n' + debug_file + '\n' + debug_identifier;
+  std::lock_guard<std::mutex> lock(mutex_);
+  HotModule& hot_module = modules_[key];
+  if (hot_module.count++ == 0) {
+    hot_module.code_file = code_file;
+    hot_module.debug_file = debug_file;
+    hot_module.debug_identifier = debug_identifier;
+  }
+}
+
+std::vector<HotModuleSet::HotModule> HotModuleSet::Hottest(
+    size_t count) const {
+  std::vector<HotModule> hottest;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::map<string, HotModule>::const_iterator module =
+             modules_.begin();
+         module != modules_.end(); ++module) {
+      hottest.push_back(module->second);
+    }
+  }
+  // Among equals, in key order, so that the choice is the same every time.
+  std::stable_sort(hottest.begin(), hottest.end(),
+                   [](const HotModule& a, const HotModule& b) {
+                     return a.count > b.count;
+                   });
+  if (hottest.size() > count)
+    hottest.resize(count);
+  return hottest;
+}
+
+bool HotModuleSet::Load(const string& path) {
+  std::ifstream file(path.c_str());
+  if (!file) {
+    BPLOG(INFO) << "No hot modules to load from " << path;
+    return false;
+  }
+  std::vector<HotModule> loaded;
+  string line;
+  while (std::getline(file, line)) {
+    HotModule module;
+    size_t count_end = line.find('\t');
+    size_t code_file_end = line.find('\t', count_end + 1);
+    size_t debug_file_end = line.find('\t', code_file_end + 1);
+    char* end;
+    if (debug_file_end == string::npos ||
+        line.find('\t', debug_file_end + 1) != string::npos ||
+        (module.count = strtoull(line.c_str(), &end, 10)) == 0 ||
+        end != line.c_str() + count_end) {
+      BPLOG(ERROR) << "Malformed hot module in " << path << ": " << line;
+      return false;
+    }
+    module.code_file = line.substr(count_end + 1,
+                                   code_file_end - count_end - 1);
+    module.debug_file = line.substr(code_file_end + 1,
+                                    debug_file_end - code_file_end - 1);
+    module.debug_identifier = line.substr(debug_file_end + 1);
+    loaded.push_back(module);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < loaded.size(); ++i) {
+    string key = loaded[i].code_file + '\n' + loaded[i].debug_file + '\n' +
+        loaded[i].debug_identifier;
+    HotModule& hot_module = modules_[key];
+    uint64_t count = hot_module.count + loaded[i].count;
+    hot_module = loaded[i];
+    hot_module.count = count;
+  }
+  return true;
+}
+
+bool HotModuleSet::Save(const string& path) const {
+  std::vector<HotModule> modules = Hottest(static_cast<size_t>(-1));
+  // Uniquely named, in case other processes are saving to |path| too.
+  string temp_template = path + ".XXXXXX";
+  std::vector<char> temp_name(temp_template.begin(), temp_template.end());
+  temp_name.push_back('\0');
+  int fd = mkstemp(&temp_name[0]);
+  FILE* file = fd == -1 ? NULL : fdopen(fd, "w");
+  if (!file) {
+    BPLOG(ERROR) << "Could not create a temporary file for " << path <<
+        ": " << strerror(errno);
+    if (fd != -1) {
+      close(fd);
+      unlink(&temp_name[0]);
+    }
+    return false;
+  }
+  string temp_file(&temp_name[0]);
+  for (size_t i = 0; i < modules.size(); ++i) {
+    if (!IsSavable(modules[i].code_file) ||
+        !IsSavable(modules[i].debug_file) ||
+        !IsSavable(modules[i].debug_identifier)) {
+      continue;
+    }
+    fprintf(file, "%llu\t%s\t%s\t%s\n",
+            static_cast<unsigned long long>(modules[i].count),
+            modules[i].code_file.c_str(), modules[i].debug_file.c_str(),
+            modules[i].debug_identifier.c_str());
+  }
+  bool written = !ferror(file);
+  if (fclose(file) != 0 || !written ||
+      rename(temp_file.c_str(), path.c_str()) != 0) {
+    BPLOG(ERROR) << "Could not write " << path << ": " << strerror(errno);
+    unlink(temp_file.c_str());
+    return false;
+  }
+  return true;
+}
+
+int HotModuleSet::WarmUp(size_t count,
+                         SymbolSupplier* supplier,
+                         SourceLineResolverInterface* resolver) const {
+  std::vector<HotModule> hottest = Hottest(count);
+  int loaded = 0;
+  for (size_t i = 0; i < hottest.size(); ++i) {
+    BasicCodeModule module(0, 0, hottest[i].code_file, string(),
+                           hottest[i].debug_file,
+                           hottest[i].debug_identifier, string());
+    if (resolver->HasModule(&module)) {
+      ++loaded;
+      continue;
+    }
+    string symbol_file;
+    char* symbol_data = NULL;
+    size_t symbol_data_size;
+    if (supplier->GetCStringSymbolData(&module, NULL, &symbol_file,
+                                       &symbol_data, &symbol_data_size) !=
+        SymbolSupplier::FOUND) {
+      continue;
+    }
+    bool keeps_data = !resolver->ShouldDeleteMemoryBufferAfterLoadModule();
+#ifdef MADV_WILLNEED
+    // For a mapped file this starts readahead of the whole file, as
+    // posix_fadvise would; the resolver reads it in place from now on.
+    if (keeps_data && symbol_data_size > 0) {
+      uintptr_t page_size = sysconf(_SC_PAGESIZE);
+      uintptr_t start = reinterpret_cast<uintptr_t>(symbol_data);
+      uintptr_t page_start = start & ~(page_size - 1);
+      madvise(reinterpret_cast<void*>(page_start),
+              symbol_data_size + (start - page_start), MADV_WILLNEED);
+    }
+#endif
+    if (resolver->LoadModuleUsingMemoryBuffer(&module, symbol_data,
+                                              symbol_data_size)) {
+      ++loaded;
+    } else {
+      BPLOG(ERROR) << "Could not warm up " << hottest[i].code_file;
+    }
+    if (!keeps_data)
+      supplier->FreeSymbolData(&module);
+  }
+  return loaded;
+}
+
+}  // namespace google_breakpad
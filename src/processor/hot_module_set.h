@@ -0,0 +1,106 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// hot_module_set.h: The modules a processor serves most, kept across
+// restarts so that a new process can load them before taking work.
+//
+// A processor starting cold loads each module's symbols the first time a
+// minidump needs them, so it answers slowly until its busiest modules are
+// all loaded.  A HotModuleSet shared by its StackFrameSymbolizers counts
+// the lookups in each module.  Saved from time to time and loaded by the
+// next process, it tells WarmUp() which modules to load and page in before
+// that process starts serving.
+//
+// Modules are identified by code_file, debug_file and debug_identifier,
+// as in SymbolLoadCache.  The saved file has a line for each module: its
+// count and those three names, separated by tabs.
+
+#ifndef PROCESSOR_HOT_MODULE_SET_H__
+#define PROCESSOR_HOT_MODULE_SET_H__
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class CodeModule;
+class SourceLineResolverInterface;
+class SymbolSupplier;
+
+class HotModuleSet {
+ public:
+  struct HotModule {
+    HotModule() : count(0) {}
+
+    string code_file;
+    string debug_file;
+    string debug_identifier;
+    uint64_t count;
+  };
+
+  // Counts a lookup in |module|.  May be called from several threads.
+  void Record(const CodeModule* module);
+
+  // Returns up to |count| modules, the most counted first.
+  std::vector<HotModule> Hottest(size_t count) const;
+
+  // Adds the counts saved in the file at |path| to this set's.  Returns
+  // false, adding nothing, if the file can't be read or is malformed.
+  bool Load(const string& path);
+
+  // Saves the counts to the file at |path|, writing a temporary file and
+  // renaming it into place, so that a process loading it never sees part
+  // of it.  Returns false if it can't be written.
+  bool Save(const string& path) const;
+
+  // Loads the symbols of up to |count| of the hottest modules from
+  // |supplier| into |resolver|.  Where the resolver uses the supplier's
+  // symbol data in place, asks the kernel to read all of it in now, rather
+  // than a page at a time as lookups fault it in.  Returns the number of
+  // modules loaded.  This reads a lot of data for a large set; a process
+  // that should start serving meanwhile calls it from a thread of its own.
+  int WarmUp(size_t count,
+             SymbolSupplier* supplier,
+             SourceLineResolverInterface* resolver) const;
+
+ private:
+  // The modules, keyed as by SymbolLoadCache, and the mutex guarding them.
+  std::map<string, HotModule> modules_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_HOT_MODULE_SET_H__
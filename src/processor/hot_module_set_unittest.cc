@@ -0,0 +1,149 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// hot_module_set_unittest.cc: Unit tests for HotModuleSet.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "processor/basic_code_module.h"
+#include "processor/hot_module_set.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::HotModuleSet;
+using google_breakpad::SimpleSymbolSupplier;
+
+// Records |count| lookups in |module| in |hot_modules|.
+void RecordTimes(HotModuleSet* hot_modules, const BasicCodeModule& module,
+                 int count) {
+  for (int i = 0; i < count; ++i)
+    hot_modules->Record(&module);
+}
+
+TEST(HotModuleSet, Hottest) {
+  BasicCodeModule foo(0x1000, 0x1000, "libfoo.so", "", "libfoo.so",
+                      "DEBUG1", "");
+  BasicCodeModule foo2(0x1000, 0x1000, "libfoo.so", "", "libfoo.so",
+                       "DEBUG2", "");
+  BasicCodeModule bar(0x3000, 0x1000, "libbar.so", "", "libbar.so",
+                      "DEBUG3", "");
+  HotModuleSet hot_modules;
+  RecordTimes(&hot_modules, foo, 2);
+  RecordTimes(&hot_modules, foo2, 5);
+  RecordTimes(&hot_modules, bar, 3);
+
+  std::vector<HotModuleSet::HotModule> hottest = hot_modules.Hottest(2);
+  ASSERT_EQ(2U, hottest.size());
+  EXPECT_EQ("DEBUG2", hottest[0].debug_identifier);
+  EXPECT_EQ(5U, hottest[0].count);
+  EXPECT_EQ("libbar.so", hottest[1].code_file);
+  EXPECT_EQ(3U, hottest[1].count);
+  EXPECT_EQ(3U, hot_modules.Hottest(10).size());
+}
+
+TEST(HotModuleSet, SaveAndLoad) {
+  AutoTempDir temp_dir;
+  string path = temp_dir.path() + "/hot_modules";
+  BasicCodeModule foo(0x1000, 0x1000, "libfoo.so", "", "libfoo.so",
+                      "DEBUG1", "");
+  BasicCodeModule bar(0x3000, 0x1000, "/lib/bar baz.so", "", "bar baz.so",
+                      "DEBUG3", "");
+  HotModuleSet hot_modules;
+  RecordTimes(&hot_modules, foo, 2);
+  RecordTimes(&hot_modules, bar, 3);
+  ASSERT_TRUE(hot_modules.Save(path));
+
+  // Loaded counts add to those already recorded.
+  HotModuleSet loaded;
+  RecordTimes(&loaded, foo, 4);
+  ASSERT_TRUE(loaded.Load(path));
+  std::vector<HotModuleSet::HotModule> hottest = loaded.Hottest(10);
+  ASSERT_EQ(2U, hottest.size());
+  EXPECT_EQ("libfoo.so", hottest[0].code_file);
+  EXPECT_EQ(6U, hottest[0].count);
+  EXPECT_EQ("/lib/bar baz.so", hottest[1].code_file);
+  EXPECT_EQ("bar baz.so", hottest[1].debug_file);
+  EXPECT_EQ("DEBUG3", hottest[1].debug_identifier);
+  EXPECT_EQ(3U, hottest[1].count);
+}
+
+TEST(HotModuleSet, LoadMalformed) {
+  AutoTempDir temp_dir;
+  string path = temp_dir.path() + "/hot_modules";
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file != NULL);
+  fputs("2\tlibfoo.so\tlibfoo.so\tDEBUG1\n", file);
+  fputs("many\tlibbar.so\tlibbar.so\tDEBUG3\n", file);
+  ASSERT_EQ(0, fclose(file));
+
+  HotModuleSet hot_modules;
+  EXPECT_FALSE(hot_modules.Load(path));
+  EXPECT_TRUE(hot_modules.Hottest(10).empty());
+  EXPECT_FALSE(hot_modules.Load(temp_dir.path() + "/missing"));
+}
+
+TEST(HotModuleSet, WarmUp) {
+  string symbols = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+      "/src/processor/testdata/symbols";
+  BasicCodeModule test_app(0x400000, 0x2d000, "c:\\test_app.exe", "",
+                           "c:\\test_app.pdb",
+                           "5A9832E5287241C1838ED98914E9B7FF1", "");
+  BasicCodeModule missing(0x3000, 0x1000, "libmissing.so", "",
+                          "libmissing.so", "DEBUG3", "");
+  HotModuleSet hot_modules;
+  RecordTimes(&hot_modules, test_app, 2);
+  RecordTimes(&hot_modules, missing, 1);
+
+  SimpleSymbolSupplier supplier(symbols);
+  BasicSourceLineResolver resolver;
+  EXPECT_EQ(0, hot_modules.WarmUp(0, &supplier, &resolver));
+  EXPECT_FALSE(resolver.HasModule(&test_app));
+  EXPECT_EQ(1, hot_modules.WarmUp(10, &supplier, &resolver));
+  EXPECT_TRUE(resolver.HasModule(&test_app));
+  EXPECT_FALSE(resolver.HasModule(&missing));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
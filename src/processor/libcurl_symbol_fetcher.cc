@@ -0,0 +1,124 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// libcurl_symbol_fetcher.cc: Fetches text symbol files for
+// TieredSymbolSupplier over HTTP with libcurl.
+//
+// See libcurl_symbol_fetcher.h for documentation.
+
+#include "processor/libcurl_symbol_fetcher.h"
+
+#include <stdio.h>
+
+#include <utility>
+
+#include "common/linux/libcurl_wrapper.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Returns |path| with the bytes that may not appear in a URL path
+// percent-encoded.
+string EscapeURLPath(const string& path) {
+  string escaped;
+  for (size_t i = 0; i < path.size(); ++i) {
+    unsigned char c = path[i];
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+        (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.' ||
+        c == '~' || c == '/') {
+      escaped += c;
+    } else {
+      char hex[4];
+      snprintf(hex, sizeof(hex), "%%%02X", c);
+      escaped += hex;
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+LibcurlSymbolFetcher::LibcurlSymbolFetcher(const string& base_url)
+    : base_url_(base_url) {
+  while (!base_url_.empty() && base_url_[base_url_.size() - 1] == '/')
+    base_url_.erase(base_url_.size() - 1);
+}
+
+LibcurlSymbolFetcher::~LibcurlSymbolFetcher() {}
+
+SymbolSupplier::SymbolResult LibcurlSymbolFetcher::Fetch(const string& path,
+                                                         string* contents) {
+  contents->clear();
+  std::unique_ptr<LibcurlWrapper> handle = TakeHandle();
+  if (!handle)
+    return SymbolSupplier::INTERRUPT;
+
+  string url = base_url_ + "/" + EscapeURLPath(path);
+  long status = 0;
+  bool sent = handle->SendGetRequest(url, &status, NULL, contents);
+  ReturnHandle(std::move(handle));
+
+  if (sent && status == 200)
+    return SymbolSupplier::FOUND;
+  contents->clear();
+  if (sent && (status == 404 || status == 403)) {
+    BPLOG(INFO) << "No symbol file at " << url;
+    return SymbolSupplier::NOT_FOUND;
+  }
+  BPLOG(ERROR) << "Could not fetch " << url << ", status " << status;
+  return SymbolSupplier::INTERRUPT;
+}
+
+std::unique_ptr<LibcurlWrapper> LibcurlSymbolFetcher::TakeHandle() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!idle_handles_.empty()) {
+      std::unique_ptr<LibcurlWrapper> handle = std::move(idle_handles_.back());
+      idle_handles_.pop_back();
+      return handle;
+    }
+  }
+  std::unique_ptr<LibcurlWrapper> handle(new LibcurlWrapper);
+  if (!handle->Init()) {
+    BPLOG(ERROR) << "Could not load libcurl";
+    return std::unique_ptr<LibcurlWrapper>();
+  }
+  handle->set_accept_encoding(true);
+  return handle;
+}
+
+void LibcurlSymbolFetcher::ReturnHandle(
+    std::unique_ptr<LibcurlWrapper> handle) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  idle_handles_.push_back(std::move(handle));
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,93 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// libcurl_symbol_fetcher.h: Fetches text symbol files for
+// TieredSymbolSupplier over HTTP with libcurl.
+//
+// A LibcurlSymbolFetcher fetches the symbol file at a path, as laid out
+// beneath a symbol path, from the same path beneath a base URL, such as
+// that of a symbol server or an S3 bucket:
+//
+// https://symbols.example.com/test_app.pdb/63FE4780728D49379B9D7BB6460CB42A1/test_app.sym
+//
+// A 404, or the 403 S3 answers for a missing object to those not allowed
+// to list the bucket, means the store doesn't have the file; any other
+// failure is reported as an interruption, so the file is asked for again
+// later.  Responses are requested compressed.
+//
+// Fetches may be made from several threads at once.  Each thread takes a
+// libcurl handle from a pool, and returns it when done, so that its
+// connection is reused by the next fetch.
+
+#ifndef PROCESSOR_LIBCURL_SYMBOL_FETCHER_H__
+#define PROCESSOR_LIBCURL_SYMBOL_FETCHER_H__
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "processor/tiered_symbol_supplier.h"
+
+namespace google_breakpad {
+
+class LibcurlWrapper;
+
+class LibcurlSymbolFetcher : public TieredSymbolSupplier::Fetcher {
+ public:
+  // Creates a fetcher for the symbol files beneath |base_url|.
+  explicit LibcurlSymbolFetcher(const string& base_url);
+
+  virtual ~LibcurlSymbolFetcher();
+
+  virtual SymbolSupplier::SymbolResult Fetch(const string& path,
+                                             string* contents);
+
+ private:
+  // Returns an initialized handle from the pool, or a new one, or NULL if
+  // libcurl can't be loaded.
+  std::unique_ptr<LibcurlWrapper> TakeHandle();
+
+  void ReturnHandle(std::unique_ptr<LibcurlWrapper> handle);
+
+  string base_url_;
+
+  // The handles not in use, and the mutex guarding them.
+  std::vector<std::unique_ptr<LibcurlWrapper> > idle_handles_;
+  std::mutex mutex_;
+
+  // Disallow copy constructor and assignment operator.
+  LibcurlSymbolFetcher(const LibcurlSymbolFetcher&);
+  void operator=(const LibcurlSymbolFetcher&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_LIBCURL_SYMBOL_FETCHER_H__
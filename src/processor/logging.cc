@@ -47,9 +47,17 @@
 
 namespace google_breakpad {
 
+std::atomic<int> LogStream::minimum_severity_(LogStream::SEVERITY_INFO);
+LogStream::Sink LogStream::sink_ = NULL;
+void* LogStream::sink_context_ = NULL;
+
 LogStream::LogStream(std::ostream& stream, Severity severity,
                      const char* file, int line)
-    : stream_(stream) {
+    : stream_(stream), severity_(severity), file_(file), line_(line) {
+  // A sink gets the message alone.
+  if (sink_)
+    return;
+
   time_t clock;
   time(&clock);
   struct tm tm_struct;
@@ -74,12 +82,23 @@ LogStream::LogStream(std::ostream& stream, Severity severity,
       break;
   }
 
-  stream_ << time_string << ": " << PathnameStripper::File(file) << ":" <<
+  buffer_ << time_string << ": " << PathnameStripper::File(file) << ":" <<
              line << ": " << severity_string << ": ";
 }
 
 LogStream::~LogStream() {
-  stream_ << std::endl;
+  if (sink_) {
+    sink_(severity_, file_, line_, buffer_.str(), sink_context_);
+    return;
+  }
+  buffer_ << '\n';
+  stream_ << buffer_.str() << std::flush;
+}
+
+// static
+void LogStream::set_sink(Sink sink, void* context) {
+  sink_ = sink;
+  sink_context_ = context;
 }
 
 string HexString(uint32_t number) {
@@ -52,12 +52,24 @@
 // BPLOG_INIT(&argc, &argv); before any logging can be performed; define
 // BPLOG_INIT appropriately if initialization is required.
 //
+// Messages below BPLOG_MINIMUM_SEVERITY are compiled out, and messages
+// below LogStream::minimum_severity() are skipped at run time.  Either
+// way, the values streamed into a skipped message are not evaluated, so
+// building with -DBPLOG_MINIMUM_SEVERITY=SEVERITY_ERROR or calling
+// LogStream::set_minimum_severity(LogStream::SEVERITY_ERROR) makes the
+// INFO logging of a stack walk cost next to nothing.
+//
+// A program that collects its own logs can call LogStream::set_sink() to
+// receive each message whole, rather than have it written to a stream.
+//
 // Author: Mark Mentovai
 
 #ifndef PROCESSOR_LOGGING_H__
 #define PROCESSOR_LOGGING_H__
 
+#include <atomic>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "common/using_std_string.h"
@@ -86,21 +98,53 @@ class LogStream {
     SEVERITY_CRITICAL
   };
 
+  // Receives a message logged at |severity| by the line of source code
+  // identified by |file| and |line|, without a trailing newline.  It may be
+  // called on any thread that logs, and on several at once.
+  typedef void (*Sink)(Severity severity, const char* file, int line,
+                       const string& message, void* context);
+
   // Begin logging a message to the stream identified by |stream|, at the
   // indicated severity.  The file and line parameters should be set so as to
   // identify the line of source code that is producing a message.
   LogStream(std::ostream& stream, Severity severity,
             const char* file, int line);
 
-  // Finish logging by printing a newline and flushing the output stream.
+  // Finish logging by passing the message to the sink, if there is one, or
+  // else by writing it with a newline to the output stream and flushing
+  // it.  The message is written all at once, so that messages logged on
+  // different threads are not interleaved.
   ~LogStream();
 
   template<typename T> std::ostream& operator<<(const T& t) {
-    return stream_ << t;
+    return buffer_ << t;
+  }
+
+  // Messages below |severity| are skipped.  This may be called at any time,
+  // on any thread.
+  static void set_minimum_severity(Severity severity) {
+    minimum_severity_.store(severity, std::memory_order_relaxed);
+  }
+  static Severity minimum_severity() {
+    return static_cast<Severity>(
+        minimum_severity_.load(std::memory_order_relaxed));
   }
 
+  // Sends messages to |sink|, along with |context|, rather than to their
+  // streams; a NULL |sink| restores the streams.  This must be called
+  // before other threads may be logging.
+  static void set_sink(Sink sink, void* context);
+
  private:
+  static std::atomic<int> minimum_severity_;
+  static Sink sink_;
+  static void* sink_context_;
+
   std::ostream& stream_;
+  Severity severity_;
+  const char* file_;
+  int line_;
+  std::ostringstream buffer_;
 
   // Disallow copy constructor and assignment operator
   explicit LogStream(const LogStream& that);
@@ -145,9 +189,13 @@ int ErrnoString(string* error_string);
 #define BPLOG_MINIMUM_SEVERITY SEVERITY_INFO
 #endif
 
+// The first comparison is constant, so that a message below
+// BPLOG_MINIMUM_SEVERITY is compiled out entirely.
 #define BPLOG_LOG_IS_ON(severity) \
     ((google_breakpad::LogStream::SEVERITY_ ## severity) >= \
-     (google_breakpad::LogStream::BPLOG_MINIMUM_SEVERITY))
+     (google_breakpad::LogStream::BPLOG_MINIMUM_SEVERITY) && \
+     (google_breakpad::LogStream::SEVERITY_ ## severity) >= \
+     google_breakpad::LogStream::minimum_severity())
 
 #ifndef BPLOG
 #define BPLOG(severity) BPLOG_LAZY_STREAM(severity, BPLOG_LOG_IS_ON(severity))
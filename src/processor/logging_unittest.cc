@@ -0,0 +1,120 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// logging_unittest.cc: Unit tests for Breakpad logging.
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "processor/logging.h"
+
+namespace {
+
+using google_breakpad::LogStream;
+
+struct LoggedMessage {
+  LogStream::Severity severity;
+  int line;
+  string message;
+};
+
+void RecordMessage(LogStream::Severity severity, const char* file, int line,
+                   const string& message, void* context) {
+  LoggedMessage logged = { severity, line, message };
+  static_cast<std::vector<LoggedMessage>*>(context)->push_back(logged);
+}
+
+int Evaluate(int* evaluations) {
+  return ++*evaluations;
+}
+
+class LoggingTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    LogStream::set_sink(RecordMessage, &messages_);
+  }
+  void TearDown() {
+    LogStream::set_sink(NULL, NULL);
+    LogStream::set_minimum_severity(LogStream::SEVERITY_INFO);
+  }
+
+  std::vector<LoggedMessage> messages_;
+};
+
+TEST_F(LoggingTest, Sink) {
+  int line = __LINE__ + 1;
+  BPLOG(INFO) << "one " << 1;
+  BPLOG(ERROR) << "two";
+  ASSERT_EQ(2U, messages_.size());
+  EXPECT_EQ(LogStream::SEVERITY_INFO, messages_[0].severity);
+  EXPECT_EQ(line, messages_[0].line);
+  EXPECT_EQ("one 1", messages_[0].message);
+  EXPECT_EQ(LogStream::SEVERITY_ERROR, messages_[1].severity);
+  EXPECT_EQ("two", messages_[1].message);
+}
+
+TEST_F(LoggingTest, MinimumSeveritySkipsEvaluation) {
+  int evaluations = 0;
+  LogStream::set_minimum_severity(LogStream::SEVERITY_ERROR);
+  BPLOG(INFO) << Evaluate(&evaluations);
+  BPLOG_IF(INFO, true) << Evaluate(&evaluations);
+  EXPECT_EQ(0, evaluations);
+  EXPECT_TRUE(messages_.empty());
+
+  BPLOG(ERROR) << Evaluate(&evaluations);
+  EXPECT_EQ(1, evaluations);
+  ASSERT_EQ(1U, messages_.size());
+  EXPECT_EQ("1", messages_[0].message);
+
+  LogStream::set_minimum_severity(LogStream::SEVERITY_INFO);
+  BPLOG(INFO) << Evaluate(&evaluations);
+  EXPECT_EQ(2, evaluations);
+  EXPECT_EQ(2U, messages_.size());
+}
+
+TEST(LoggingStreamTest, WritesWholeLine) {
+  std::ostringstream stream;
+  {
+    LogStream log(stream, LogStream::SEVERITY_ERROR, "dir/file.cc", 12);
+    log << "message";
+    // Nothing is written until the message is finished.
+    EXPECT_EQ("", stream.str());
+  }
+  string line = stream.str();
+  EXPECT_NE(string::npos, line.find(": file.cc:12: ERROR: message\n"));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -39,9 +39,11 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "processor/map_serializers.h"
 #include "processor/simple_serializer.h"
+#include "processor/static_map_search_index-inl.h"
 
 #include "processor/address_map-inl.h"
 #include "processor/range_map-inl.h"
@@ -57,6 +59,8 @@ size_t StdMapSerializer<Key, Value>::SizeOf(
   size_t size = 0;
   size_t header_size = (1 + m.size()) * sizeof(uint32_t);
   size += header_size;
+  if (HasSearchIndex(m.size()))
+    size += StaticMapSearchIndex<Key>::SizeOf(m.size());
 
   typename std::map<Key, Value>::const_iterator iter;
   for (iter = m.begin(); iter != m.end(); ++iter) {
@@ -76,14 +80,22 @@ char* StdMapSerializer<Key, Value>::Write(const std::map<Key, Value>& m,
   char* start_address = dest;
 
   // Write header:
-  // Number of nodes.
-  dest = SimpleSerializer<uint32_t>::Write(m.size(), dest);
+  // Number of nodes, flagged if there is a search index.
+  bool has_search_index = HasSearchIndex(m.size());
+  uint32_t header = static_cast<uint32_t>(m.size());
+  if (has_search_index)
+    header |= StaticMapSearchIndex<Key>::kIndexFlag;
+  dest = SimpleSerializer<uint32_t>::Write(header, dest);
   // Nodes offsets.
   uint32_t* offsets = reinterpret_cast<uint32_t*>(dest);
   dest += sizeof(uint32_t) * m.size();
 
+  char* const keys_start = dest;
   char* key_address = dest;
   dest += sizeof(Key) * m.size();
+  char* const index_address = dest;
+  if (has_search_index)
+    dest += StaticMapSearchIndex<Key>::SizeOf(m.size());
 
   // Traverse map.
   typename std::map<Key, Value>::const_iterator iter;
@@ -93,6 +105,8 @@ char* StdMapSerializer<Key, Value>::Write(const std::map<Key, Value>& m,
     key_address = key_serializer_.Write(iter->first, key_address);
     dest = value_serializer_.Write(iter->second, dest);
   }
+  if (has_search_index)
+    StaticMapSearchIndex<Key>::Write(keys_start, m.size(), index_address);
   return dest;
 }
 
@@ -121,6 +135,8 @@ size_t RangeMapSerializer<Address, Entry>::SizeOf(
   size_t size = 0;
   size_t header_size = (1 + m.map_.size()) * sizeof(uint32_t);
   size += header_size;
+  if (HasSearchIndex(m.map_.size()))
+    size += StaticMapSearchIndex<Address>::SizeOf(m.map_.size());
 
   typename std::map<Address, Range>::const_iterator iter;
   for (iter = m.map_.begin(); iter != m.map_.end(); ++iter) {
@@ -144,14 +160,22 @@ char* RangeMapSerializer<Address, Entry>::Write(
   char* start_address = dest;
 
   // Write header:
-  // Number of nodes.
-  dest = SimpleSerializer<uint32_t>::Write(m.map_.size(), dest);
+  // Number of nodes, flagged if there is a search index.
+  bool has_search_index = HasSearchIndex(m.map_.size());
+  uint32_t header = static_cast<uint32_t>(m.map_.size());
+  if (has_search_index)
+    header |= StaticMapSearchIndex<Address>::kIndexFlag;
+  dest = SimpleSerializer<uint32_t>::Write(header, dest);
   // Nodes offsets.
   uint32_t* offsets = reinterpret_cast<uint32_t*>(dest);
   dest += sizeof(uint32_t) * m.map_.size();
 
+  char* const keys_start = dest;
   char* key_address = dest;
   dest += sizeof(Address) * m.map_.size();
+  char* const index_address = dest;
+  if (has_search_index)
+    dest += StaticMapSearchIndex<Address>::SizeOf(m.map_.size());
 
   // Traverse map.
   typename std::map<Address, Range>::const_iterator iter;
@@ -162,6 +186,10 @@ char* RangeMapSerializer<Address, Entry>::Write(
     dest = address_serializer_.Write(iter->second.base(), dest);
     dest = entry_serializer_.Write(iter->second.entry(), dest);
   }
+  if (has_search_index) {
+    StaticMapSearchIndex<Address>::Write(keys_start, m.map_.size(),
+                                         index_address);
+  }
   return dest;
 }
 
@@ -185,6 +213,41 @@ char* RangeMapSerializer<Address, Entry>::Serialize(
   return serialized_data;
 }
 
+template<typename Address, typename Entry>
+size_t LineTableSerializer<Address, Entry>::SizeOf(
+    const RangeMap<Address, Entry>& m) const {
+  std::vector<StaticLineTable::Row> rows;
+  GetRows(m, &rows);
+  return StaticLineTable::SizeOf(rows);
+}
+
+template<typename Address, typename Entry>
+char* LineTableSerializer<Address, Entry>::Write(
+    const RangeMap<Address, Entry>& m, char* dest) const {
+  if (!dest) {
+    BPLOG(ERROR) << "LineTableSerializer failed: write to NULL address.";
+    return NULL;
+  }
+  std::vector<StaticLineTable::Row> rows;
+  GetRows(m, &rows);
+  return StaticLineTable::Write(rows, dest);
+}
+
+template<typename Address, typename Entry>
+void LineTableSerializer<Address, Entry>::GetRows(
+    const RangeMap<Address, Entry>& m,
+    std::vector<StaticLineTable::Row>* rows) {
+  rows->reserve(m.map_.size());
+  typename RangeMap<Address, Entry>::MapConstIterator iter;
+  for (iter = m.map_.begin(); iter != m.map_.end(); ++iter) {
+    StaticLineTable::Row row;
+    row.address = iter->second.base();
+    row.size = iter->first - iter->second.base() + 1;
+    row.source_file_id = iter->second.entry().source_file_id;
+    row.line = iter->second.entry().line;
+    rows->push_back(row);
+  }
+}
 
 template<class AddrType, class EntryType>
 size_t ContainedRangeMapSerializer<AddrType, EntryType>::SizeOf(
@@ -198,6 +261,8 @@ size_t ContainedRangeMapSerializer<AddrType, EntryType>::SizeOf(
   size += sizeof(uint32_t);
   if (m->map_) {
     size += m->map_->size() * sizeof(uint32_t);
+    if (HasSearchIndex(m->map_->size()))
+      size += StaticMapSearchIndex<AddrType>::SizeOf(m->map_->size());
     typename Map::const_iterator iter;
     for (iter = m->map_->begin(); iter != m->map_->end(); ++iter) {
       size += addr_serializer_.SizeOf(iter->first);
@@ -225,12 +290,20 @@ char* ContainedRangeMapSerializer<AddrType, EntryType>::Write(
   if (m->map_ == NULL) {
     dest = SimpleSerializer<uint32_t>::Write(0, dest);
   } else {
-    dest = SimpleSerializer<uint32_t>::Write(m->map_->size(), dest);
+    bool has_search_index = HasSearchIndex(m->map_->size());
+    uint32_t header = static_cast<uint32_t>(m->map_->size());
+    if (has_search_index)
+      header |= StaticMapSearchIndex<AddrType>::kIndexFlag;
+    dest = SimpleSerializer<uint32_t>::Write(header, dest);
     uint32_t* offsets = reinterpret_cast<uint32_t*>(dest);
     dest += sizeof(uint32_t) * m->map_->size();
 
+    char* const keys_start = dest;
     char* key_address = dest;
     dest += sizeof(AddrType) * m->map_->size();
+    char* const index_address = dest;
+    if (has_search_index)
+      dest += StaticMapSearchIndex<AddrType>::SizeOf(m->map_->size());
 
     // Traverse map.
     typename Map::const_iterator iter;
@@ -241,6 +314,10 @@ char* ContainedRangeMapSerializer<AddrType, EntryType>::Write(
       // Recursively write.
       dest = Write(iter->second, dest);
     }
+    if (has_search_index) {
+      StaticMapSearchIndex<AddrType>::Write(keys_start, m->map_->size(),
+                                            index_address);
+    }
   }
   return dest;
 }
@@ -38,8 +38,11 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "processor/simple_serializer.h"
+#include "processor/static_line_table.h"
+#include "processor/static_map_search_index.h"
 
 #include "processor/address_map-inl.h"
 #include "processor/range_map-inl.h"
@@ -52,6 +55,14 @@ namespace google_breakpad {
 template<typename Key, typename Value>
 class StdMapSerializer {
  public:
+  StdMapSerializer() : build_search_index_(false) { }
+
+  // If |build_search_index| is true, maps large enough to benefit get a
+  // StaticMapSearchIndex.  Off by default.
+  void set_build_search_index(bool build_search_index) {
+    build_search_index_ = build_search_index;
+  }
+
   // Calculate the memory size of serialized data.
   size_t SizeOf(const std::map<Key, Value>& m) const;
 
@@ -69,8 +80,15 @@ class StdMapSerializer {
   char* Serialize(const std::map<Key, Value>& m, unsigned int* size) const;
 
  private:
+  // Whether a map with |num_nodes| nodes gets a search index.
+  bool HasSearchIndex(size_t num_nodes) const {
+    return build_search_index_ &&
+           num_nodes >= StaticMapSearchIndex<Key>::kMinIndexedNodes;
+  }
+
   SimpleSerializer<Key> key_serializer_;
   SimpleSerializer<Value> value_serializer_;
+  bool build_search_index_;
 };
 
 // AddressMapSerializer allocates memory and serializes an AddressMap into a
@@ -78,6 +96,11 @@ class StdMapSerializer {
 template<typename Addr, typename Entry>
 class AddressMapSerializer {
  public:
+  // See StdMapSerializer::set_build_search_index.
+  void set_build_search_index(bool build_search_index) {
+    std_map_serializer_.set_build_search_index(build_search_index);
+  }
+
   // Calculate the memory size of serialized data.
   size_t SizeOf(const AddressMap<Addr, Entry>& m) const {
     return std_map_serializer_.SizeOf(m.map_);
@@ -109,6 +132,14 @@ class AddressMapSerializer {
 template<typename Address, typename Entry>
 class RangeMapSerializer {
  public:
+  RangeMapSerializer() : build_search_index_(false) { }
+
+  // If |build_search_index| is true, maps large enough to benefit get a
+  // StaticMapSearchIndex.  Off by default.
+  void set_build_search_index(bool build_search_index) {
+    build_search_index_ = build_search_index;
+  }
+
   // Calculate the memory size of serialized data.
   size_t SizeOf(const RangeMap<Address, Entry>& m) const;
 
@@ -131,6 +162,34 @@ class RangeMapSerializer {
   SimpleSerializer<Address> address_serializer_;
   // Serializer for RangeMap::Range::entry_.
   SimpleSerializer<Entry> entry_serializer_;
+
+  // Whether a map with |num_nodes| nodes gets a search index.
+  bool HasSearchIndex(size_t num_nodes) const {
+    return build_search_index_ &&
+           num_nodes >= StaticMapSearchIndex<Address>::kMinIndexedNodes;
+  }
+
+  bool build_search_index_;
+};
+
+// LineTableSerializer serializes the RangeMap of a function's lines into the
+// compact encoding read by StaticLineTable.  Entry must have source_file_id
+// and line members.
+template<typename Address, typename Entry>
+class LineTableSerializer {
+ public:
+  // Calculate the memory size of serialized data.
+  size_t SizeOf(const RangeMap<Address, Entry>& m) const;
+
+  // Write the serialized data to specified memory location.  Return the "end"
+  // of data, i.e., return the address after the final byte of data.
+  // NOTE: caller has to allocate enough memory before invoke Write() method.
+  char* Write(const RangeMap<Address, Entry>& m, char* dest) const;
+
+ private:
+  // Lists the ranges in m as rows, in address order.
+  static void GetRows(const RangeMap<Address, Entry>& m,
+                      std::vector<StaticLineTable::Row>* rows);
 };
 
 // ContainedRangeMapSerializer allocates memory and serializes a
@@ -138,6 +197,14 @@ class RangeMapSerializer {
 template<class AddrType, class EntryType>
 class ContainedRangeMapSerializer {
  public:
+  ContainedRangeMapSerializer() : build_search_index_(false) { }
+
+  // If |build_search_index| is true, maps large enough to benefit get a
+  // StaticMapSearchIndex.  Off by default.
+  void set_build_search_index(bool build_search_index) {
+    build_search_index_ = build_search_index;
+  }
+
   // Calculate the memory size of serialized data.
   size_t SizeOf(const ContainedRangeMap<AddrType, EntryType>* m) const;
 
@@ -161,6 +228,14 @@ class ContainedRangeMapSerializer {
   // Serializer for addresses and entries stored in ContainedRangeMap.
   SimpleSerializer<AddrType> addr_serializer_;
   SimpleSerializer<EntryType> entry_serializer_;
+
+  // Whether a map with |num_nodes| nodes gets a search index.
+  bool HasSearchIndex(size_t num_nodes) const {
+    return build_search_index_ &&
+           num_nodes >= StaticMapSearchIndex<AddrType>::kMinIndexedNodes;
+  }
+
+  bool build_search_index_;
 };
 
 }  // namespace google_breakpad
@@ -33,16 +33,20 @@
 
 #include "google_breakpad/processor/microdump.h"
 
+#include <ctype.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+#include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "google_breakpad/common/minidump_cpu_arm.h"
 #include "google_breakpad/processor/code_module.h"
+#include "processor/address_range_table-inl.h"
 #include "processor/basic_code_module.h"
 #include "processor/convert_old_arm64_context.h"
 #include "processor/linked_ptr.h"
@@ -50,6 +54,9 @@
 #include "processor/range_map-inl.h"
 
 namespace {
+
+using google_breakpad::StringView;
+
 static const char kGoogleBreakpadKey[] = "google-breakpad";
 static const char kMicrodumpBegin[] = "-----BEGIN BREAKPAD MICRODUMP-----";
 static const char kMicrodumpEnd[] = "-----END BREAKPAD MICRODUMP-----";
@@ -60,6 +67,7 @@ static const char kGpuKey[] = ": G ";
 static const char kMmapKey[] = ": M ";
 static const char kStackKey[] = ": S ";
 static const char kStackFirstLineKey[] = ": S 0 ";
+static const char kStackBase64Key[] = ": S64 ";
 static const char kArmArchitecture[] = "arm";
 static const char kArm64Architecture[] = "arm64";
 static const char kX86Architecture[] = "x86";
@@ -67,33 +75,125 @@ static const char kMipsArchitecture[] = "mips";
 static const char kMips64Architecture[] = "mips64";
 static const char kGpuUnknown[] = "UNKNOWN";
 
-template<typename T>
-T HexStrToL(const string& str) {
+// Maps each character to its value as a hex digit, or to -1.
+class HexDigitTable {
+ public:
+  HexDigitTable() {
+    memset(values_, -1, sizeof(values_));
+    for (int i = 0; i < 10; ++i)
+      values_['0' + i] = static_cast<int8_t>(i);
+    for (int i = 0; i < 6; ++i) {
+      values_['A' + i] = static_cast<int8_t>(10 + i);
+      values_['a' + i] = static_cast<int8_t>(10 + i);
+    }
+  }
+  int operator[](char c) const { return values_[static_cast<uint8_t>(c)]; }
+
+ private:
+  int8_t values_[256];
+};
+
+const HexDigitTable kHexDigitValues;
+
+// Returns the value of the hex digits at the start of str, or 0.
+uint64_t HexStrToU64(StringView str) {
   uint64_t res = 0;
-  std::istringstream ss(str);
-  ss >> std::hex >> res;
-  return static_cast<T>(res);
+  for (size_t i = 0; i < str.size(); ++i) {
+    const int digit = kHexDigitValues[str.data()[i]];
+    if (digit < 0)
+      break;
+    res = res << 4 | static_cast<uint64_t>(digit);
+  }
+  return res;
 }
 
-std::vector<uint8_t> ParseHexBuf(const string& str) {
-  std::vector<uint8_t> buf;
-  for (size_t i = 0; i < str.length(); i += 2) {
-    buf.push_back(HexStrToL<uint8_t>(str.substr(i, 2)));
+// Appends the bytes hex-encoded in str to buf.
+void ParseHexBuf(StringView str, std::vector<uint8_t>* buf) {
+  const char* data = str.data();
+  const size_t size = str.size() & ~static_cast<size_t>(1);
+  buf->reserve(buf->size() + size / 2);
+  for (size_t i = 0; i < size; i += 2) {
+    const int high = kHexDigitValues[data[i]];
+    const int low = kHexDigitValues[data[i + 1]];
+    buf->push_back(static_cast<uint8_t>((high < 0 ? 0 : high) << 4 |
+                                        (low < 0 ? 0 : low)));
   }
-  return buf;
 }
 
-bool GetLine(std::istringstream* istream, string* str) {
-  if (std::getline(*istream, *str)) {
-    // Trim any trailing newline from the end of the line. Allows us
-    // to seamlessly handle both Windows/DOS and Unix formatted input. The
-    // adb tool generally writes logcat dumps in Windows/DOS format.
-    if (!str->empty() && str->at(str->size() - 1) == '\r') {
-      str->erase(str->size() - 1);
+// Appends the bytes encoded in padded base64 in str to buf, stopping at the
+// first character outside the alphabet.
+void ParseBase64Buf(StringView str, std::vector<uint8_t>* buf) {
+  buf->reserve(buf->size() + str.size() / 4 * 3);
+  uint32_t bits = 0;
+  int bit_count = 0;
+  for (size_t i = 0; i < str.size(); ++i) {
+    const char c = str.data()[i];
+    int value;
+    if (c >= 'A' && c <= 'Z')
+      value = c - 'A';
+    else if (c >= 'a' && c <= 'z')
+      value = c - 'a' + 26;
+    else if (c >= '0' && c <= '9')
+      value = c - '0' + 52;
+    else if (c == '+')
+      value = 62;
+    else if (c == '/')
+      value = 63;
+    else
+      break;
+    bits = bits << 6 | value;
+    bit_count += 6;
+    if (bit_count >= 8) {
+      bit_count -= 8;
+      buf->push_back(static_cast<uint8_t>(bits >> bit_count));
     }
-    return true;
   }
-  return false;
+}
+
+// Moves *rest past the next line, with any trailing carriage return
+// trimmed to seamlessly handle both Windows/DOS and Unix formatted input
+// (the adb tool generally writes logcat dumps in Windows/DOS format), and
+// stores it in *line.  Returns false at the end of the input.
+bool GetLine(StringView* rest, StringView* line) {
+  if (rest->empty())
+    return false;
+  const char* start = rest->data();
+  const char* newline =
+      static_cast<const char*>(memchr(start, '\n', rest->size()));
+  size_t length = newline ? newline - start : rest->size();
+  *rest = newline ? StringView(newline + 1, rest->size() - length - 1)
+                  : StringView();
+  if (length && start[length - 1] == '\r')
+    --length;
+  *line = StringView(start, length);
+  return true;
+}
+
+// Returns the position of key in line, or string::npos.
+size_t Find(StringView line, const char* key) {
+  const char* end = line.data() + line.size();
+  const char* found = std::search(line.data(), end, key, key + strlen(key));
+  return found == end ? string::npos : found - line.data();
+}
+
+// Returns the part of line after the key found at pos.
+StringView After(StringView line, size_t pos, const char* key) {
+  const size_t start = pos + strlen(key);
+  return StringView(line.data() + start, line.size() - start);
+}
+
+// Returns the next space-separated token in *rest, and moves *rest past
+// it.
+StringView NextToken(StringView* rest) {
+  const char* p = rest->data();
+  const char* end = p + rest->size();
+  while (p < end && isspace(static_cast<unsigned char>(*p)))
+    ++p;
+  const char* token = p;
+  while (p < end && !isspace(static_cast<unsigned char>(*p)))
+    ++p;
+  *rest = StringView(p, end - p);
+  return StringView(token, p - token);
 }
 
 }  // namespace
@@ -105,6 +205,11 @@ namespace google_breakpad {
 //
 
 void MicrodumpModules::Add(const CodeModule* module) {
+  AddUnindexed(module);
+  BuildIndex();
+}
+
+void MicrodumpModules::AddUnindexed(const CodeModule* module) {
   linked_ptr<const CodeModule> module_ptr(module);
   if (!map_.StoreRange(module->base_address(), module->size(), module_ptr)) {
     BPLOG(ERROR) << "Module " << module->code_file() <<
@@ -112,6 +217,10 @@ void MicrodumpModules::Add(const CodeModule* module) {
   }
 }
 
+void MicrodumpModules::BuildIndex() {
+  range_table_.Build(map_);
+}
+
 void MicrodumpModules::SetEnableModuleShrink(bool is_enabled) {
   map_.SetMergeStrategy(is_enabled ? MergeRangeStrategy::kTruncateUpper
                                    : MergeRangeStrategy::kExclusiveRanges);
@@ -164,6 +273,12 @@ void MicrodumpMemoryRegion::Init(uint64_t base_address,
   contents_ = contents;
 }
 
+void MicrodumpMemoryRegion::Init(uint64_t base_address,
+                                 std::vector<uint8_t>&& contents) {
+  base_address_ = base_address;
+  contents_ = std::move(contents);
+}
+
 uint64_t MicrodumpMemoryRegion::GetBase() const { return base_address_; }
 
 uint32_t MicrodumpMemoryRegion::GetSize() const { return contents_.size(); }
@@ -188,6 +303,19 @@ bool MicrodumpMemoryRegion::GetMemoryAtAddress(uint64_t address,
   return GetMemoryLittleEndian(address, value);
 }
 
+const uint8_t* MicrodumpMemoryRegion::GetMemorySpan(uint64_t address,
+                                                    size_t length,
+                                                    size_t* span_length) const {
+  *span_length = 0;
+  if (length == 0 || address < base_address_ ||
+      address - base_address_ >= contents_.size())
+    return NULL;
+  size_t offset = static_cast<size_t>(address - base_address_);
+  size_t available = contents_.size() - offset;
+  *span_length = length < available ? length : available;
+  return &contents_[offset];
+}
+
 template<typename ValueType>
 bool MicrodumpMemoryRegion::GetMemoryLittleEndian(uint64_t address,
                                                   ValueType* value) const {
@@ -211,7 +339,7 @@ void MicrodumpMemoryRegion::Print() const {
 //
 // Microdump
 //
-Microdump::Microdump(const string& contents)
+Microdump::Microdump(StringView contents)
   : context_(new MicrodumpContext()),
     stack_region_(new MicrodumpMemoryRegion()),
     modules_(new MicrodumpModules()),
@@ -221,48 +349,43 @@ Microdump::Microdump(const string& contents)
   assert(!contents.empty());
 
   bool in_microdump = false;
-  string line;
+  StringView line;
   uint64_t stack_start = 0;
   std::vector<uint8_t> stack_content;
   string arch;
 
-  std::istringstream stream(contents);
-  while (GetLine(&stream, &line)) {
-    if (line.find(kGoogleBreakpadKey) == string::npos) {
+  StringView rest = contents;
+  while (GetLine(&rest, &line)) {
+    if (Find(line, kGoogleBreakpadKey) == string::npos) {
       continue;
     }
-    if (line.find(kMicrodumpBegin) != string::npos) {
+    if (Find(line, kMicrodumpBegin) != string::npos) {
       in_microdump = true;
       continue;
     }
     if (!in_microdump) {
       continue;
     }
-    if (line.find(kMicrodumpEnd) != string::npos) {
+    if (Find(line, kMicrodumpEnd) != string::npos) {
       break;
     }
 
     size_t pos;
-    if ((pos = line.find(kOsKey)) != string::npos) {
-      string os_str(line, pos + strlen(kOsKey));
-      std::istringstream os_tokens(os_str);
-      string os_id;
-      string num_cpus;
-      string os_version;
+    if ((pos = Find(line, kOsKey)) != string::npos) {
+      StringView os_tokens = After(line, pos, kOsKey);
+      StringView os_id = NextToken(&os_tokens);
+      arch = NextToken(&os_tokens).str();
+      StringView num_cpus = NextToken(&os_tokens);
       // This reflect the actual HW arch and might not match the arch emulated
       // for the execution (e.g., running a 32-bit binary on a 64-bit cpu).
-      string hw_arch;
-
-      os_tokens >> os_id;
-      os_tokens >> arch;
-      os_tokens >> num_cpus;
-      os_tokens >> hw_arch;
-      GetLine(&os_tokens, &os_version);
-      os_version.erase(0, 1);  // remove leading space.
+      NextToken(&os_tokens);  // hw_arch
+      // Remove the leading space.
+      StringView os_version = os_tokens.empty() ? os_tokens :
+          StringView(os_tokens.data() + 1, os_tokens.size() - 1);
 
       system_info_->cpu = arch;
-      system_info_->cpu_count = HexStrToL<uint8_t>(num_cpus);
-      system_info_->os_version = os_version;
+      system_info_->cpu_count = static_cast<uint8_t>(HexStrToU64(num_cpus));
+      system_info_->os_version = os_version.str();
 
       if (os_id == "L") {
         system_info_->os = "Linux";
@@ -274,21 +397,27 @@ Microdump::Microdump(const string& contents)
       }
 
       // OS line also contains release and version for future use.
-    } else if ((pos = line.find(kStackKey)) != string::npos) {
-      if (line.find(kStackFirstLineKey) != string::npos) {
+    } else if ((pos = Find(line, kStackKey)) != string::npos ||
+               (pos = Find(line, kStackBase64Key)) != string::npos) {
+      size_t header_pos = Find(line, kStackFirstLineKey);
+      if (header_pos != string::npos) {
         // The first line of the stack (S 0 stack header) provides the value of
         // the stack pointer, the start address of the stack being dumped and
-        // the length of the stack. We could use it in future to double check
-        // that we received all the stack as expected.
+        // the length of the stack, which is used to size the copy up front.
+        StringView header = After(line, header_pos, kStackFirstLineKey);
+        NextToken(&header);  // stack pointer
+        NextToken(&header);  // start address
+        const uint64_t stack_len = HexStrToU64(NextToken(&header));
+        // Don't let a corrupt length reserve more than 64MB.
+        if (stack_len <= (64u << 20))
+          stack_content.reserve(static_cast<size_t>(stack_len));
         continue;
       }
-      string stack_str(line, pos + strlen(kStackKey));
-      std::istringstream stack_tokens(stack_str);
-      string start_addr_str;
-      string raw_content;
-      stack_tokens >> start_addr_str;
-      stack_tokens >> raw_content;
-      uint64_t start_addr = HexStrToL<uint64_t>(start_addr_str);
+      const bool base64 = Find(line, kStackBase64Key) == pos;
+      StringView stack_tokens =
+          After(line, pos, base64 ? kStackBase64Key : kStackKey);
+      uint64_t start_addr = HexStrToU64(NextToken(&stack_tokens));
+      StringView raw_content = NextToken(&stack_tokens);
 
       if (stack_start != 0) {
         // Verify that the stack chunks in the microdump are contiguous.
@@ -296,12 +425,14 @@ Microdump::Microdump(const string& contents)
       } else {
         stack_start = start_addr;
       }
-      std::vector<uint8_t> chunk = ParseHexBuf(raw_content);
-      stack_content.insert(stack_content.end(), chunk.begin(), chunk.end());
-
-    } else if ((pos = line.find(kCpuKey)) != string::npos) {
-      string cpu_state_str(line, pos + strlen(kCpuKey));
-      std::vector<uint8_t> cpu_state_raw = ParseHexBuf(cpu_state_str);
+      if (base64)
+        ParseBase64Buf(raw_content, &stack_content);
+      else
+        ParseHexBuf(raw_content, &stack_content);
+
+    } else if ((pos = Find(line, kCpuKey)) != string::npos) {
+      std::vector<uint8_t> cpu_state_raw;
+      ParseHexBuf(After(line, pos, kCpuKey), &cpu_state_raw);
       if (strcmp(arch.c_str(), kArmArchitecture) == 0) {
         if (cpu_state_raw.size() != sizeof(MDRawContextARM)) {
           std::cerr << "Malformed CPU context. Got " << cpu_state_raw.size()
@@ -362,36 +493,37 @@ Microdump::Microdump(const string& contents)
       } else {
         std::cerr << "Unsupported architecture: " << arch << std::endl;
       }
-    } else if ((pos = line.find(kCrashReasonKey)) != string::npos) {
-      string crash_reason_str(line, pos + strlen(kCrashReasonKey));
-      std::istringstream crash_reason_tokens(crash_reason_str);
-      string signal;
-      string address;
-      crash_reason_tokens >> signal;
-      crash_reason_tokens >> crash_reason_;
-      crash_reason_tokens >> address;
-      crash_address_ = HexStrToL<uint64_t>(address);
-    } else if ((pos = line.find(kGpuKey)) != string::npos) {
-      string gpu_str(line, pos + strlen(kGpuKey));
-      if (strcmp(gpu_str.c_str(), kGpuUnknown) != 0) {
-        std::istringstream gpu_tokens(gpu_str);
-        std::getline(gpu_tokens, system_info_->gl_version, '|');
-        std::getline(gpu_tokens, system_info_->gl_vendor, '|');
-        std::getline(gpu_tokens, system_info_->gl_renderer, '|');
+    } else if ((pos = Find(line, kCrashReasonKey)) != string::npos) {
+      StringView crash_reason_tokens = After(line, pos, kCrashReasonKey);
+      NextToken(&crash_reason_tokens);  // signal
+      crash_reason_ = NextToken(&crash_reason_tokens).str();
+      crash_address_ = HexStrToU64(NextToken(&crash_reason_tokens));
+    } else if ((pos = Find(line, kGpuKey)) != string::npos) {
+      StringView gpu_str = After(line, pos, kGpuKey);
+      if (gpu_str != kGpuUnknown) {
+        string* gpu_fields[] = { &system_info_->gl_version,
+                                 &system_info_->gl_vendor,
+                                 &system_info_->gl_renderer };
+        const char* field = gpu_str.data();
+        const char* end = field + gpu_str.size();
+        for (size_t i = 0; i < sizeof(gpu_fields) / sizeof(gpu_fields[0]);
+             ++i) {
+          const char* separator = std::find(field, end, '|');
+          gpu_fields[i]->assign(field, separator);
+          field = separator == end ? end : separator + 1;
+        }
       }
-    } else if ((pos = line.find(kMmapKey)) != string::npos) {
-      string mmap_line(line, pos + strlen(kMmapKey));
-      std::istringstream mmap_tokens(mmap_line);
-      string addr, offset, size, identifier, filename;
-      mmap_tokens >> addr;
-      mmap_tokens >> offset;
-      mmap_tokens >> size;
-      mmap_tokens >> identifier;
-      mmap_tokens >> filename;
-
-      modules_->Add(new BasicCodeModule(
-          HexStrToL<uint64_t>(addr),  // base_address
-          HexStrToL<uint64_t>(size),  // size
+    } else if ((pos = Find(line, kMmapKey)) != string::npos) {
+      StringView mmap_tokens = After(line, pos, kMmapKey);
+      StringView addr = NextToken(&mmap_tokens);
+      NextToken(&mmap_tokens);  // offset
+      StringView size = NextToken(&mmap_tokens);
+      string identifier = NextToken(&mmap_tokens).str();
+      string filename = NextToken(&mmap_tokens).str();
+
+      modules_->AddUnindexed(new BasicCodeModule(
+          HexStrToU64(addr),          // base_address
+          HexStrToU64(size),          // size
           filename,                   // code_file
           identifier,                 // code_identifier
           filename,                   // debug_file
@@ -399,7 +531,9 @@ Microdump::Microdump(const string& contents)
           ""));                       // version
     }
   }
-  stack_region_->Init(stack_start, stack_content);
+  modules_->BuildIndex();
+  stack_region_->Init(stack_start, std::move(stack_content));
 }
 
+
 }  // namespace google_breakpad
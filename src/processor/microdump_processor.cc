@@ -43,6 +43,7 @@
 #include "google_breakpad/processor/process_state.h"
 #include "google_breakpad/processor/stackwalker.h"
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/frame_arena.h"
 #include "processor/logging.h"
 
 namespace google_breakpad {
@@ -61,6 +62,7 @@ ProcessResult MicrodumpProcessor::Process(Microdump *microdump,
   process_state->Clear();
 
   process_state->modules_ = microdump->GetModules()->Copy();
+  ScopedFrameArena frame_arena(process_state->frame_arena_);
   scoped_ptr<Stackwalker> stackwalker(
       Stackwalker::StackwalkerForCPU(
                             &process_state->system_info_,
@@ -94,4 +96,25 @@ ProcessResult MicrodumpProcessor::Process(Microdump *microdump,
   return PROCESS_OK;
 }
 
+size_t MicrodumpProcessor::ProcessBatch(
+    const std::vector<StringView>& microdumps,
+    BatchCallback callback,
+    void* context) {
+  size_t processed = 0;
+  for (size_t i = 0; i < microdumps.size(); ++i) {
+    // A ProcessState of its own, as it refers to the microdump's memory.
+    ProcessState process_state;
+    ProcessResult result = PROCESS_ERROR_MINIDUMP_NOT_FOUND;
+    scoped_ptr<Microdump> microdump;
+    if (!microdumps[i].empty()) {
+      microdump.reset(new Microdump(microdumps[i]));
+      result = Process(microdump.get(), &process_state);
+      if (result == PROCESS_OK)
+        ++processed;
+    }
+    callback(i, result, process_state, context);
+  }
+  return processed;
+}
+
 }  // namespace google_breakpad
@@ -53,6 +53,7 @@ using google_breakpad::MicrodumpProcessor;
 using google_breakpad::ProcessState;
 using google_breakpad::SimpleSymbolSupplier;
 using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::StringView;
 
 class MicrodumpProcessorTest : public ::testing::Test {
  public:
@@ -235,6 +236,69 @@ TEST_F(MicrodumpProcessorTest, TestProcessMultiple) {
   ASSERT_EQ(5U, state.threads()->at(0)->frames()->size());
 }
 
+struct BatchResult {
+  google_breakpad::ProcessResult result;
+  string cpu;
+  size_t frame_count;
+  string top_function;
+};
+
+void CollectBatchResult(size_t index,
+                        google_breakpad::ProcessResult result,
+                        const ProcessState& process_state,
+                        void* context) {
+  std::vector<BatchResult>* results =
+      reinterpret_cast<std::vector<BatchResult>*>(context);
+  ASSERT_EQ(results->size(), index);
+  BatchResult batch_result = { result, process_state.system_info()->cpu, 0,
+                               "" };
+  if (result == google_breakpad::PROCESS_OK) {
+    const std::vector<google_breakpad::CallStack*>* threads =
+        process_state.threads();
+    batch_result.frame_count = threads->at(0)->frames()->size();
+    batch_result.top_function =
+        threads->at(0)->frames()->at(0)->function_name;
+  }
+  results->push_back(batch_result);
+}
+
+TEST_F(MicrodumpProcessorTest, TestProcessBatch) {
+  string arm_contents;
+  string x86_contents;
+  ReadFile(files_path_ + "microdump-arm.dmp", &arm_contents);
+  ReadFile(files_path_ + "microdump-x86.dmp", &x86_contents);
+
+  std::vector<StringView> microdumps;
+  microdumps.push_back(arm_contents);
+  microdumps.push_back(StringView());
+  microdumps.push_back(x86_contents);
+  microdumps.push_back(arm_contents);
+
+  SimpleSymbolSupplier supplier(files_path_ + "symbols/microdump");
+  BasicSourceLineResolver resolver;
+  StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+  MicrodumpProcessor processor(&frame_symbolizer);
+  std::vector<BatchResult> results;
+  ASSERT_EQ(3U, processor.ProcessBatch(microdumps, CollectBatchResult,
+                                       &results));
+
+  ASSERT_EQ(4U, results.size());
+  ASSERT_EQ(google_breakpad::PROCESS_OK, results[0].result);
+  ASSERT_EQ("arm", results[0].cpu);
+  ASSERT_EQ(8U, results[0].frame_count);
+  ASSERT_EQ(google_breakpad::PROCESS_ERROR_MINIDUMP_NOT_FOUND,
+            results[1].result);
+  ASSERT_EQ(google_breakpad::PROCESS_OK, results[2].result);
+  ASSERT_EQ("x86", results[2].cpu);
+  ASSERT_EQ(17U, results[2].frame_count);
+  // The second arm microdump is symbolized with the symbols loaded for
+  // the first.
+  ASSERT_EQ(google_breakpad::PROCESS_OK, results[3].result);
+  ASSERT_EQ(8U, results[3].frame_count);
+  ASSERT_EQ("MicrodumpWriterTest_Setup_Test::TestBody",
+            results[3].top_function);
+}
+
 TEST_F(MicrodumpProcessorTest, TestProcessMips) {
   ProcessState state;
   AnalyzeDump("microdump-mips32.dmp", false /* omit_symbols */,
@@ -44,19 +44,26 @@
 #ifdef _WIN32
 #include <io.h>
 #else  // _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif  // _WIN32
 
 #include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <limits>
+#include <sstream>
 #include <utility>
 
+#include "processor/address_range_table-inl.h"
 #include "processor/range_map-inl.h"
 
 #include "common/macros.h"
 #include "common/scoped_ptr.h"
 #include "common/stdio_wrapper.h"
+#include "common/trace_probes.h"
+#include "common/utf16_ascii.h"
 #include "google_breakpad/processor/dump_context.h"
 #include "processor/basic_code_module.h"
 #include "processor/basic_code_modules.h"
@@ -113,30 +120,26 @@ bool IsContextSizeUnique(uint32_t context_size) {
 // (MinidumpMemoryRegion::GetMemoryAtAddressInternal).
 inline void Swap(uint8_t* value) {}
 
-// Optimization: don't need to AND the furthest right shift, because we're
-// shifting an unsigned quantity.  The standard requires zero-filling in this
-// case.  If the quantities were signed, a bitmask whould be needed for this
-// right shift to avoid an arithmetic shift (which retains the sign bit).
-// The furthest left shift never needs to be ANDed bitmask.
+// Each of these swaps the whole value at once, which compilers turn into a
+// single byte-swap instruction.  Swapping a 64-bit value as two 32-bit
+// halves would take two, plus the exchange of the halves.
 
 inline void Swap(uint16_t* value) {
-  *value = (*value >> 8) | (*value << 8);
+  *value = static_cast<uint16_t>((*value >> 8) | (*value << 8));
 }
 
 inline void Swap(uint32_t* value) {
-  *value =  (*value >> 24) |
-           ((*value >> 8)  & 0x0000ff00) |
-           ((*value << 8)  & 0x00ff0000) |
-            (*value << 24);
+  uint32_t v = *value;
+  v = ((v & 0x00ff00ffU) << 8) | ((v >> 8) & 0x00ff00ffU);
+  *value = (v << 16) | (v >> 16);
 }
 
 inline void Swap(uint64_t* value) {
-  uint32_t* value32 = reinterpret_cast<uint32_t*>(value);
-  Swap(&value32[0]);
-  Swap(&value32[1]);
-  uint32_t temp = value32[0];
-  value32[0] = value32[1];
-  value32[1] = temp;
+  uint64_t v = *value;
+  v = ((v & 0x00ff00ff00ff00ffULL) << 8) | ((v >> 8) & 0x00ff00ff00ff00ffULL);
+  v = ((v & 0x0000ffff0000ffffULL) << 16) |
+      ((v >> 16) & 0x0000ffff0000ffffULL);
+  *value = (v << 32) | (v >> 32);
 }
 
 
@@ -212,11 +215,19 @@ inline void Swap(MDRawSimpleStringDictionaryEntry* entry) {
   Swap(&entry->value);
 }
 
+// Swap each of the |count| values at |values|: a register file, or a run
+// of words read from memory at once.  A plain loop of whole-value swaps
+// over contiguous values is one the compiler can vectorize into byte
+// shuffles, so prefer this to swapping the elements of an array one call
+// at a time.
+template<typename T>
+inline void SwapArray(T* values, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    Swap(&values[i]);
+}
+
 inline void Swap(uint16_t* data, size_t size_in_bytes) {
-  size_t data_length = size_in_bytes / sizeof(data[0]);
-  for (size_t i = 0; i < data_length; i++) {
-    Swap(&data[i]);
-  }
+  SwapArray(data, size_in_bytes / sizeof(data[0]));
 }
 
 //
@@ -233,16 +244,24 @@ inline void Swap(uint16_t* data, size_t size_in_bytes) {
 // parameter, a converter that uses iconv would also need to take the host
 // CPU's endianness into consideration.  It doesn't seems worth the trouble
 // of making it a dependency when we don't care about anything but UTF-16.
-string* UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
+string* UTF16ToUTF8(const uint16_t* in, size_t length, bool swap) {
   scoped_ptr<string> out(new string());
 
-  // Set the string's initial capacity to the number of UTF-16 characters,
-  // because the UTF-8 representation will always be at least this long.
-  // If the UTF-8 representation is longer, the string will grow dynamically.
-  out->reserve(in.size());
-
-  for (vector<uint16_t>::const_iterator iterator = in.begin();
-       iterator != in.end();
+  // Size the string to the number of UTF-16 characters, because the UTF-8
+  // representation will always be at least this long, and is exactly this
+  // long for ASCII, which most strings are.  Convert as much as is ASCII in
+  // one go.  If the UTF-8 representation is longer, the string will grow
+  // dynamically.
+  out->resize(length);
+  size_t ascii_length =
+      length ? CopyUTF16ASCIIPrefix(in, length, swap, &(*out)[0]) : 0;
+  if (ascii_length == length)
+    return out.release();
+  out->resize(ascii_length);
+
+  const uint16_t* end = in + length;
+  for (const uint16_t* iterator = in + ascii_length;
+       iterator != end;
        ++iterator) {
     // Get a 16-bit value from the input
     uint16_t in_word = *iterator;
@@ -258,7 +277,7 @@ string* UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
     } else if (in_word >= 0xd800 && in_word <= 0xdbff) {
       // High surrogate.
       unichar = (in_word - 0xd7c0) << 10;
-      if (++iterator == in.end()) {
+      if (++iterator == end) {
         BPLOG(ERROR) << "UTF16ToUTF8 found high surrogate " <<
                         HexString(in_word) << " at end of string";
         return NULL;
@@ -304,6 +323,10 @@ string* UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
   return out.release();
 }
 
+string* UTF16ToUTF8(const vector<uint16_t>& in, bool swap) {
+  return UTF16ToUTF8(in.empty() ? NULL : &in[0], in.size(), swap);
+}
+
 // Return the smaller of the number of code units in the UTF-16 string,
 // not including the terminating null word, or maxlen.
 size_t UTF16codeunits(const uint16_t* string, size_t maxlen) {
@@ -335,10 +358,7 @@ void ConvertUTF16BufferToUTF8String(const uint16_t* utf16_data,
   size_t max_word_length = max_length_in_bytes / sizeof(utf16_data[0]);
   size_t word_length = UTF16codeunits(utf16_data, max_word_length);
   if (word_length > 0) {
-    size_t byte_length = word_length * sizeof(utf16_data[0]);
-    vector<uint16_t> utf16_vector(word_length);
-    memcpy(&utf16_vector[0], &utf16_data[0], byte_length);
-    scoped_ptr<string> temp(UTF16ToUTF8(utf16_vector, swap));
+    scoped_ptr<string> temp(UTF16ToUTF8(utf16_data, word_length, swap));
     if (temp.get()) {
       utf8_result->assign(*temp);
     }
@@ -409,6 +429,136 @@ bool IsDevAshmem(const string& filename) {
   return filename.compare(0, kDevAshmem.length(), kDevAshmem) == 0;
 }
 
+// Reads the part of an LZ4 length that didn't fit in the token, adding it
+// to |length|.  Returns false if the block ends first.
+bool ReadLZ4Length(const uint8_t** in, const uint8_t* in_end, size_t* length) {
+  uint8_t byte;
+  do {
+    if (*in == in_end)
+      return false;
+    byte = *(*in)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Decompresses the LZ4 block of |size| bytes at |src| into |dst|, which
+// it must fill exactly.
+bool DecompressLZ4Block(const uint8_t* src, size_t size,
+                        uint8_t* dst, size_t dst_size) {
+  const uint8_t* in = src;
+  const uint8_t* const in_end = src + size;
+  size_t out = 0;
+  while (in < in_end) {
+    const uint8_t token = *in++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLZ4Length(&in, in_end, &literal_length))
+      return false;
+    if (literal_length > static_cast<size_t>(in_end - in) ||
+        literal_length > dst_size - out)
+      return false;
+    memcpy(dst + out, in, literal_length);
+    in += literal_length;
+    out += literal_length;
+    // The last sequence has only literals.
+    if (in == in_end)
+      break;
+
+    if (in_end - in < 2)
+      return false;
+    const size_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    size_t match_length = token & 15;
+    if (match_length == 15 && !ReadLZ4Length(&in, in_end, &match_length))
+      return false;
+    match_length += 4;
+    if (offset == 0 || offset > out || match_length > dst_size - out)
+      return false;
+    // The match may overlap the bytes it produces, so copy byte by byte.
+    for (size_t i = 0; i < match_length; ++i, ++out)
+      dst[out] = dst[out - offset];
+  }
+  return out == dst_size;
+}
+
+// Decompresses |compressed|, a compressed minidump as described at
+// MDRawCompressedHeader, into |minidump|.  Returns false if |compressed|
+// isn't one, or is corrupt.
+bool DecompressMinidump(const string& compressed, string* minidump) {
+  MDRawCompressedHeader header;
+  if (compressed.size() < sizeof(header))
+    return false;
+  memcpy(&header, compressed.data(), sizeof(header));
+  bool swap = false;
+  if (header.signature != MD_COMPRESSED_HEADER_SIGNATURE) {
+    Swap(&header.signature);
+    Swap(&header.version);
+    if (header.signature != MD_COMPRESSED_HEADER_SIGNATURE)
+      return false;
+    swap = true;
+  }
+  if (header.version != MD_COMPRESSED_HEADER_VERSION) {
+    BPLOG(ERROR) << "DecompressMinidump unknown version " << header.version;
+    return false;
+  }
+
+  // Find how long the minidump is, then fill it in.
+  for (int pass = 0; pass < 2; ++pass) {
+    uint64_t minidump_size = 0;
+    size_t offset = sizeof(header);
+    while (offset < compressed.size()) {
+      MDRawCompressedRecord record;
+      if (compressed.size() - offset < sizeof(record)) {
+        BPLOG(ERROR) << "DecompressMinidump truncated record header";
+        return false;
+      }
+      memcpy(&record, compressed.data() + offset, sizeof(record));
+      offset += sizeof(record);
+      if (swap) {
+        Swap(&record.rva);
+        Swap(&record.data_size);
+        Swap(&record.compressed_size);
+      }
+      const size_t stored_size =
+          record.compressed_size ? record.compressed_size : record.data_size;
+      if (record.data_size > MD_COMPRESSED_RECORD_MAX_DATA_SIZE ||
+          compressed.size() - offset < stored_size) {
+        BPLOG(ERROR) << "DecompressMinidump bad record at " << offset;
+        return false;
+      }
+
+      const uint8_t* data =
+          reinterpret_cast<const uint8_t*>(compressed.data()) + offset;
+      offset += stored_size;
+      const uint64_t end =
+          static_cast<uint64_t>(record.rva) + record.data_size;
+      if (pass == 0) {
+        minidump_size = std::max(minidump_size, end);
+        continue;
+      }
+      uint8_t* out = reinterpret_cast<uint8_t*>(&(*minidump)[0]) + record.rva;
+      if (!record.compressed_size) {
+        memcpy(out, data, record.data_size);
+      } else if (!DecompressLZ4Block(data, record.compressed_size, out,
+                                     record.data_size)) {
+        BPLOG(ERROR) << "DecompressMinidump bad LZ4 block at " << offset;
+        return false;
+      }
+    }
+    if (pass == 0) {
+      // LZ4 can't compress by more than 255 to 1, so a bigger minidump
+      // means the records are corrupt.
+      if (minidump_size > static_cast<uint64_t>(compressed.size()) * 256) {
+        BPLOG(ERROR) << "DecompressMinidump implausible size " <<
+                        minidump_size;
+        return false;
+      }
+      minidump->assign(minidump_size, '\0');
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 //
@@ -573,10 +723,7 @@ bool MinidumpContext::Read(uint32_t expected_size) {
       // is valid.  We're not currently using either,
       // but it would be good to have them swapped properly.
 
-      for (unsigned int vr_index = 0;
-           vr_index < MD_CONTEXT_AMD64_VR_COUNT;
-           ++vr_index)
-        Swap(&context_amd64->vector_register[vr_index]);
+      SwapArray(context_amd64->vector_register, MD_CONTEXT_AMD64_VR_COUNT);
       Swap(&context_amd64->vector_control);
       Swap(&context_amd64->debug_control);
       Swap(&context_amd64->last_branch_to_rip);
@@ -642,21 +789,14 @@ bool MinidumpContext::Read(uint32_t expected_size) {
       // context_ppc64->context_flags was already swapped.
       Swap(&context_ppc64->srr0);
       Swap(&context_ppc64->srr1);
-      for (unsigned int gpr_index = 0;
-           gpr_index < MD_CONTEXT_PPC64_GPR_COUNT;
-           ++gpr_index) {
-        Swap(&context_ppc64->gpr[gpr_index]);
-      }
+      SwapArray(context_ppc64->gpr, MD_CONTEXT_PPC64_GPR_COUNT);
       Swap(&context_ppc64->cr);
       Swap(&context_ppc64->xer);
       Swap(&context_ppc64->lr);
       Swap(&context_ppc64->ctr);
       Swap(&context_ppc64->vrsave);
-      for (unsigned int fpr_index = 0;
-           fpr_index < MD_FLOATINGSAVEAREA_PPC_FPR_COUNT;
-           ++fpr_index) {
-        Swap(&context_ppc64->float_save.fpregs[fpr_index]);
-      }
+      SwapArray(context_ppc64->float_save.fpregs,
+                MD_FLOATINGSAVEAREA_PPC_FPR_COUNT);
       // Don't swap context_ppc64->float_save.fpscr_pad because it is only
       // used for padding.
       Swap(&context_ppc64->float_save.fpscr);
@@ -738,11 +878,7 @@ bool MinidumpContext::Read(uint32_t expected_size) {
 
     if (minidump_->swap()) {
       // context_arm64->context_flags was already swapped.
-      for (unsigned int ireg_index = 0;
-           ireg_index < MD_CONTEXT_ARM64_GPR_COUNT;
-           ++ireg_index) {
-        Swap(&context_arm64->iregs[ireg_index]);
-      }
+      SwapArray(context_arm64->iregs, MD_CONTEXT_ARM64_GPR_COUNT);
       Swap(&context_arm64->cpsr);
       Swap(&context_arm64->float_save.fpsr);
       Swap(&context_arm64->float_save.fpcr);
@@ -907,30 +1043,20 @@ bool MinidumpContext::Read(uint32_t expected_size) {
           // context_ppc->context_flags was already swapped.
           Swap(&context_ppc->srr0);
           Swap(&context_ppc->srr1);
-          for (unsigned int gpr_index = 0;
-               gpr_index < MD_CONTEXT_PPC_GPR_COUNT;
-               ++gpr_index) {
-            Swap(&context_ppc->gpr[gpr_index]);
-          }
+          SwapArray(context_ppc->gpr, MD_CONTEXT_PPC_GPR_COUNT);
           Swap(&context_ppc->cr);
           Swap(&context_ppc->xer);
           Swap(&context_ppc->lr);
           Swap(&context_ppc->ctr);
           Swap(&context_ppc->mq);
           Swap(&context_ppc->vrsave);
-          for (unsigned int fpr_index = 0;
-               fpr_index < MD_FLOATINGSAVEAREA_PPC_FPR_COUNT;
-               ++fpr_index) {
-            Swap(&context_ppc->float_save.fpregs[fpr_index]);
-          }
+          SwapArray(context_ppc->float_save.fpregs,
+                    MD_FLOATINGSAVEAREA_PPC_FPR_COUNT);
           // Don't swap context_ppc->float_save.fpscr_pad because it is only
           // used for padding.
           Swap(&context_ppc->float_save.fpscr);
-          for (unsigned int vr_index = 0;
-               vr_index < MD_VECTORSAVEAREA_PPC_VR_COUNT;
-               ++vr_index) {
-            Swap(&context_ppc->vector_save.save_vr[vr_index]);
-          }
+          SwapArray(context_ppc->vector_save.save_vr,
+                    MD_VECTORSAVEAREA_PPC_VR_COUNT);
           Swap(&context_ppc->vector_save.save_vscr);
           // Don't swap the padding fields in vector_save.
           Swap(&context_ppc->vector_save.save_vrvalid);
@@ -973,22 +1099,15 @@ bool MinidumpContext::Read(uint32_t expected_size) {
 
         if (minidump_->swap()) {
           // context_sparc->context_flags was already swapped.
-          for (unsigned int gpr_index = 0;
-               gpr_index < MD_CONTEXT_SPARC_GPR_COUNT;
-               ++gpr_index) {
-            Swap(&context_sparc->g_r[gpr_index]);
-          }
+          SwapArray(context_sparc->g_r, MD_CONTEXT_SPARC_GPR_COUNT);
           Swap(&context_sparc->ccr);
           Swap(&context_sparc->pc);
           Swap(&context_sparc->npc);
           Swap(&context_sparc->y);
           Swap(&context_sparc->asi);
           Swap(&context_sparc->fprs);
-          for (unsigned int fpr_index = 0;
-               fpr_index < MD_FLOATINGSAVEAREA_SPARC_FPR_COUNT;
-               ++fpr_index) {
-            Swap(&context_sparc->float_save.regs[fpr_index]);
-          }
+          SwapArray(context_sparc->float_save.regs,
+                    MD_FLOATINGSAVEAREA_SPARC_FPR_COUNT);
           Swap(&context_sparc->float_save.filler);
           Swap(&context_sparc->float_save.fsr);
         }
@@ -1029,23 +1148,13 @@ bool MinidumpContext::Read(uint32_t expected_size) {
 
         if (minidump_->swap()) {
           // context_arm->context_flags was already swapped.
-          for (unsigned int ireg_index = 0;
-               ireg_index < MD_CONTEXT_ARM_GPR_COUNT;
-               ++ireg_index) {
-            Swap(&context_arm->iregs[ireg_index]);
-          }
+          SwapArray(context_arm->iregs, MD_CONTEXT_ARM_GPR_COUNT);
           Swap(&context_arm->cpsr);
           Swap(&context_arm->float_save.fpscr);
-          for (unsigned int fpr_index = 0;
-               fpr_index < MD_FLOATINGSAVEAREA_ARM_FPR_COUNT;
-               ++fpr_index) {
-            Swap(&context_arm->float_save.regs[fpr_index]);
-          }
-          for (unsigned int fpe_index = 0;
-               fpe_index < MD_FLOATINGSAVEAREA_ARM_FPEXTRA_COUNT;
-               ++fpe_index) {
-            Swap(&context_arm->float_save.extra[fpe_index]);
-          }
+          SwapArray(context_arm->float_save.regs,
+                    MD_FLOATINGSAVEAREA_ARM_FPR_COUNT);
+          SwapArray(context_arm->float_save.extra,
+                    MD_FLOATINGSAVEAREA_ARM_FPEXTRA_COUNT);
         }
         SetContextARM(context_arm.release());
 
@@ -1084,11 +1193,7 @@ bool MinidumpContext::Read(uint32_t expected_size) {
 
         if (minidump_->swap()) {
           // context_arm64->context_flags was already swapped.
-          for (unsigned int ireg_index = 0;
-               ireg_index < MD_CONTEXT_ARM64_GPR_COUNT;
-               ++ireg_index) {
-            Swap(&context_arm64->iregs[ireg_index]);
-          }
+          SwapArray(context_arm64->iregs, MD_CONTEXT_ARM64_GPR_COUNT);
           Swap(&context_arm64->cpsr);
           Swap(&context_arm64->float_save.fpsr);
           Swap(&context_arm64->float_save.fpcr);
@@ -1139,11 +1244,7 @@ bool MinidumpContext::Read(uint32_t expected_size) {
 
         if (minidump_->swap()) {
           // context_mips->context_flags was already swapped.
-          for (int ireg_index = 0;
-               ireg_index < MD_CONTEXT_MIPS_GPR_COUNT;
-               ++ireg_index) {
-            Swap(&context_mips->iregs[ireg_index]);
-          }
+          SwapArray(context_mips->iregs, MD_CONTEXT_MIPS_GPR_COUNT);
 	  Swap(&context_mips->mdhi);
 	  Swap(&context_mips->mdlo);
           for (int dsp_index = 0;
@@ -1157,11 +1258,8 @@ bool MinidumpContext::Read(uint32_t expected_size) {
           Swap(&context_mips->badvaddr);
           Swap(&context_mips->status);
           Swap(&context_mips->cause);
-          for (int fpr_index = 0;
-               fpr_index < MD_FLOATINGSAVEAREA_MIPS_FPR_COUNT;
-               ++fpr_index) {
-            Swap(&context_mips->float_save.regs[fpr_index]);
-          }
+          SwapArray(context_mips->float_save.regs,
+                    MD_FLOATINGSAVEAREA_MIPS_FPR_COUNT);
           Swap(&context_mips->float_save.fpcsr);
           Swap(&context_mips->float_save.fir);
         }
@@ -1284,7 +1382,10 @@ uint32_t MinidumpMemoryRegion::max_bytes_ = 64 * 1024 * 1024;  // 64MB
 MinidumpMemoryRegion::MinidumpMemoryRegion(Minidump* minidump)
     : MinidumpObject(minidump),
       descriptor_(NULL),
-      memory_(NULL) {
+      memory_(NULL),
+      mapped_memory_(NULL),
+      paged_memory_(NULL),
+      pages_read_() {
   hexdump_width_ = minidump_ ? minidump_->HexdumpMode() : 0;
   hexdump_ = hexdump_width_ != 0;
 }
@@ -1292,6 +1393,7 @@ MinidumpMemoryRegion::MinidumpMemoryRegion(Minidump* minidump)
 
 MinidumpMemoryRegion::~MinidumpMemoryRegion() {
   delete memory_;
+  delete[] paged_memory_;
 }
 
 
@@ -1310,12 +1412,45 @@ const uint8_t* MinidumpMemoryRegion::GetMemory() const {
     return NULL;
   }
 
+  if (mapped_memory_)
+    return mapped_memory_;
+
+  if (paged_memory_ || (!memory_ && minidump_->load_memory_by_page())) {
+    if (descriptor_->memory.data_size == 0) {
+      BPLOG(ERROR) << "MinidumpMemoryRegion is empty";
+      return NULL;
+    }
+
+    // Reading every page is limited as reading the region at once is,
+    // unless the region can be used in place.
+    if (!paged_memory_) {
+      mapped_memory_ = minidump_->GetMappedBytes(
+          descriptor_->memory.rva, descriptor_->memory.data_size);
+      if (mapped_memory_)
+        return mapped_memory_;
+    }
+    if (descriptor_->memory.data_size > max_bytes_) {
+      BPLOG(ERROR) << "MinidumpMemoryRegion size " <<
+                      descriptor_->memory.data_size << " exceeds maximum " <<
+                      max_bytes_;
+      return NULL;
+    }
+    return GetMemoryRange(0, descriptor_->memory.data_size);
+  }
+
   if (!memory_) {
     if (descriptor_->memory.data_size == 0) {
       BPLOG(ERROR) << "MinidumpMemoryRegion is empty";
       return NULL;
     }
 
+    // A memory-mapped minidump holds the region in place, so there's nothing
+    // to copy and no need to limit its size.
+    mapped_memory_ = minidump_->GetMappedBytes(descriptor_->memory.rva,
+                                               descriptor_->memory.data_size);
+    if (mapped_memory_)
+      return mapped_memory_;
+
     if (!minidump_->SeekSet(descriptor_->memory.rva)) {
       BPLOG(ERROR) << "MinidumpMemoryRegion could not seek to memory region";
       return NULL;
@@ -1328,6 +1463,12 @@ const uint8_t* MinidumpMemoryRegion::GetMemory() const {
       return NULL;
     }
 
+    if (!minidump_->ChargeMemoryBudget(descriptor_->memory.data_size)) {
+      BPLOG(ERROR) << "MinidumpMemoryRegion could not read memory region "
+                      "within the memory budget";
+      return NULL;
+    }
+
     scoped_ptr< vector<uint8_t> > memory(
         new vector<uint8_t>(descriptor_->memory.data_size));
 
@@ -1343,6 +1484,64 @@ const uint8_t* MinidumpMemoryRegion::GetMemory() const {
 }
 
 
+const uint8_t* MinidumpMemoryRegion::GetMemoryRange(uint64_t offset,
+                                                    uint64_t length) const {
+  if (mapped_memory_ || memory_ ||
+      (!paged_memory_ && !minidump_->load_memory_by_page())) {
+    return GetMemory();
+  }
+
+  uint32_t size = descriptor_->memory.data_size;
+  if (!paged_memory_) {
+    mapped_memory_ = minidump_->GetMappedBytes(descriptor_->memory.rva, size);
+    if (mapped_memory_)
+      return mapped_memory_;
+
+    // The pages aren't touched until they're read, so a large region costs
+    // little more than the pages of it that are used.
+    paged_memory_ = new uint8_t[size];
+    pages_read_.assign((size + kPageSize - 1) / kPageSize, false);
+  }
+
+  if (length == 0)
+    return paged_memory_;
+
+  // Read each run of pages that haven't been read yet at once.
+  uint64_t page = offset / kPageSize;
+  uint64_t last_page = (offset + length - 1) / kPageSize;
+  while (page <= last_page) {
+    if (pages_read_[page]) {
+      ++page;
+      continue;
+    }
+    uint64_t end_page = page + 1;
+    while (end_page <= last_page && !pages_read_[end_page])
+      ++end_page;
+
+    uint64_t start = page * kPageSize;
+    uint64_t end = std::min(end_page * kPageSize, static_cast<uint64_t>(size));
+    if (!minidump_->ChargeMemoryBudget(end - start)) {
+      BPLOG(ERROR) << "MinidumpMemoryRegion could not read memory at " <<
+                      HexString(descriptor_->start_of_memory_range + start) <<
+                      " within the memory budget";
+      return NULL;
+    }
+    if (!minidump_->SeekSet(descriptor_->memory.rva + start)) {
+      BPLOG(ERROR) << "MinidumpMemoryRegion could not seek to memory region";
+      return NULL;
+    }
+    if (!minidump_->ReadBytes(paged_memory_ + start, end - start)) {
+      BPLOG(ERROR) << "MinidumpMemoryRegion could not read memory region";
+      return NULL;
+    }
+    while (page < end_page)
+      pages_read_[page++] = true;
+  }
+
+  return paged_memory_;
+}
+
+
 uint64_t MinidumpMemoryRegion::GetBase() const {
   if (!valid_) {
     BPLOG(ERROR) << "Invalid MinidumpMemoryRegion for GetBase";
@@ -1366,6 +1565,10 @@ uint32_t MinidumpMemoryRegion::GetSize() const {
 void MinidumpMemoryRegion::FreeMemory() {
   delete memory_;
   memory_ = NULL;
+  mapped_memory_ = NULL;
+  delete[] paged_memory_;
+  paged_memory_ = NULL;
+  pages_read_.clear();
 }
 
 
@@ -1395,9 +1598,10 @@ bool MinidumpMemoryRegion::GetMemoryAtAddressInternal(uint64_t address,
     return false;
   }
 
-  const uint8_t* memory = GetMemory();
+  const uint8_t* memory = GetMemoryRange(
+      address - descriptor_->start_of_memory_range, sizeof(T));
   if (!memory) {
-    // GetMemory already logged a perfectly good message.
+    // GetMemoryRange already logged a perfectly good message.
     return false;
   }
 
@@ -1413,6 +1617,63 @@ bool MinidumpMemoryRegion::GetMemoryAtAddressInternal(uint64_t address,
 }
 
 
+const uint8_t* MinidumpMemoryRegion::GetMemorySpan(uint64_t address,
+                                                   size_t   length,
+                                                   size_t*  span_length)
+    const {
+  *span_length = 0;
+  if (!valid_) {
+    BPLOG(ERROR) << "Invalid MinidumpMemoryRegion for GetMemorySpan";
+    return NULL;
+  }
+
+  uint64_t start = descriptor_->start_of_memory_range;
+  uint64_t size = descriptor_->memory.data_size;
+  if (length == 0 || start + size < start || address < start ||
+      address - start >= size) {
+    return NULL;
+  }
+
+  uint64_t offset = address - start;
+  uint64_t available = size - offset;
+  size_t span = length < available ? length : static_cast<size_t>(available);
+  const uint8_t* memory = GetMemoryRange(offset, span);
+  if (!memory) {
+    // GetMemoryRange already logged a perfectly good message.
+    return NULL;
+  }
+
+  *span_length = span;
+  return memory + offset;
+}
+
+
+bool MinidumpMemoryRegion::IsByteSwapped() const {
+  return minidump_->swap();
+}
+
+
+template<typename T>
+size_t MinidumpMemoryRegion::GetMemoryAtAddressesInternal(uint64_t address,
+                                                          T*       values,
+                                                          size_t   count)
+    const {
+  // Only the values that lie entirely within the region can be read.
+  size_t length = 0;
+  const uint8_t* span = count > numeric_limits<size_t>::max() / sizeof(T) ?
+      NULL : GetMemorySpan(address, count * sizeof(T), &length);
+  if (!span)
+    return 0;
+  count = length / sizeof(T);
+
+  memcpy(values, span, count * sizeof(T));
+  if (minidump_->swap())
+    SwapArray(values, count);
+
+  return count;
+}
+
+
 bool MinidumpMemoryRegion::GetMemoryAtAddress(uint64_t  address,
                                               uint8_t*  value) const {
   return GetMemoryAtAddressInternal(address, value);
@@ -1437,67 +1698,162 @@ bool MinidumpMemoryRegion::GetMemoryAtAddress(uint64_t  address,
 }
 
 
+size_t MinidumpMemoryRegion::GetMemoryAtAddresses(uint64_t  address,
+                                                  uint32_t* values,
+                                                  size_t    count) const {
+  return GetMemoryAtAddressesInternal(address, values, count);
+}
+
+
+size_t MinidumpMemoryRegion::GetMemoryAtAddresses(uint64_t  address,
+                                                  uint64_t* values,
+                                                  size_t    count) const {
+  return GetMemoryAtAddressesInternal(address, values, count);
+}
+
+
+namespace {
+
+// Collects text for stdout and writes it a buffer at a time, so that
+// printing a large memory region takes a few fwrite calls per megabyte
+// rather than a printf call per byte.
+class PrintBuffer {
+ public:
+  PrintBuffer() : length_(0) {}
+  ~PrintBuffer() { Flush(); }
+
+  void Append(char c) {
+    if (length_ == sizeof(buffer_))
+      Flush();
+    buffer_[length_++] = c;
+  }
+
+  // Appends byte as two lowercase hex digits, as "%02x" would.
+  void AppendHex(uint8_t byte) {
+    static const char kHexDigits[] = "0123456789abcdef";
+    Append(kHexDigits[byte >> 4]);
+    Append(kHexDigits[byte & 0xf]);
+  }
+
+  // Appends value as eight lowercase hex digits, as "%08x" would.
+  void AppendHex32(uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+      AppendHex(static_cast<uint8_t>(value >> shift));
+  }
+
+  void Flush() {
+    fwrite(buffer_, 1, length_, stdout);
+    length_ = 0;
+  }
+
+ private:
+  char buffer_[64 * 1024];
+  size_t length_;
+};
+
+}  // namespace
+
 void MinidumpMemoryRegion::Print() const {
   if (!valid_) {
     BPLOG(ERROR) << "MinidumpMemoryRegion cannot print invalid data";
     return;
   }
 
-  const uint8_t* memory = GetMemory();
-  if (memory) {
-    if (hexdump_) {
-      // Pretty hexdump view.
-      for (unsigned int byte_index = 0;
-           byte_index < descriptor_->memory.data_size;
-           byte_index += hexdump_width_) {
-        // In case the memory won't fill a whole line.
-        unsigned int num_bytes = std::min(
-            descriptor_->memory.data_size - byte_index, hexdump_width_);
-
-        // Display the leading address.
-        printf("%08x  ", byte_index);
-
-        // Show the bytes in hex.
-        for (unsigned int i = 0; i < hexdump_width_; ++i) {
-          if (i < num_bytes) {
-            // Show the single byte of memory in hex.
-            printf("%02x ", memory[byte_index + i]);
-          } else {
-            // If this line doesn't fill up, pad it out.
-            printf("   ");
-          }
+  PrintBytes(0, descriptor_->memory.data_size);
+}
 
-          // Insert a space every 8 bytes to make it more readable.
-          if (((i + 1) % 8) == 0) {
-            printf(" ");
-          }
+
+void MinidumpMemoryRegion::PrintRange(uint64_t first_address,
+                                      uint64_t last_address) const {
+  if (!valid_) {
+    BPLOG(ERROR) << "MinidumpMemoryRegion cannot print invalid data";
+    return;
+  }
+
+  uint64_t base = descriptor_->start_of_memory_range;
+  uint32_t size = descriptor_->memory.data_size;
+  if (size == 0 ||
+      (first_address <= base && last_address >= base + (size - 1))) {
+    PrintBytes(0, size);
+    return;
+  }
+  if (first_address > base + (size - 1) || last_address < base) {
+    printf("No memory\n");
+    return;
+  }
+  uint64_t first = std::max(first_address, base);
+  uint64_t last = std::min(last_address, base + (size - 1));
+  PrintBytes(static_cast<uint32_t>(first - base),
+             static_cast<uint32_t>(last - first + 1));
+}
+
+
+void MinidumpMemoryRegion::PrintBytes(uint32_t offset,
+                                      uint32_t length) const {
+  const uint8_t* memory = length ? GetMemoryRange(offset, length)
+                                 : GetMemory();
+  if (!memory) {
+    printf("No memory\n");
+    return;
+  }
+
+  PrintBuffer out;
+  const uint64_t end = static_cast<uint64_t>(offset) + length;
+  if (hexdump_) {
+    // Pretty hexdump view.
+    for (uint64_t byte_index = offset;
+         byte_index < end;
+         byte_index += hexdump_width_) {
+      // In case the memory won't fill a whole line.
+      unsigned int num_bytes = static_cast<unsigned int>(
+          std::min<uint64_t>(end - byte_index, hexdump_width_));
+
+      // Display the leading offset within the region.
+      out.AppendHex32(static_cast<uint32_t>(byte_index));
+      out.Append(' ');
+      out.Append(' ');
+
+      // Show the bytes in hex.
+      for (unsigned int i = 0; i < hexdump_width_; ++i) {
+        if (i < num_bytes) {
+          // Show the single byte of memory in hex.
+          out.AppendHex(memory[byte_index + i]);
+          out.Append(' ');
+        } else {
+          // If this line doesn't fill up, pad it out.
+          out.Append(' ');
+          out.Append(' ');
+          out.Append(' ');
         }
 
-        // Decode the line as ASCII.
-        printf("|");
-        for (unsigned int i = 0; i < hexdump_width_; ++i) {
-          if (i < num_bytes) {
-            uint8_t byte = memory[byte_index + i];
-            printf("%c", isprint(byte) ? byte : '.');
-          } else {
-            // If this line doesn't fill up, pad it out.
-            printf(" ");
-          }
+        // Insert a space every 8 bytes to make it more readable.
+        if (((i + 1) % 8) == 0) {
+          out.Append(' ');
         }
-        printf("|\n");
       }
-    } else {
-      // Ugly raw string view.
-      printf("0x");
-      for (unsigned int i = 0;
-           i < descriptor_->memory.data_size;
-           i++) {
-        printf("%02x", memory[i]);
+
+      // Decode the line as ASCII.
+      out.Append('|');
+      for (unsigned int i = 0; i < hexdump_width_; ++i) {
+        if (i < num_bytes) {
+          uint8_t byte = memory[byte_index + i];
+          out.Append(isprint(byte) ? byte : '.');
+        } else {
+          // If this line doesn't fill up, pad it out.
+          out.Append(' ');
+        }
       }
-      printf("\n");
+      out.Append('|');
+      out.Append('\n');
     }
   } else {
-    printf("No memory\n");
+    // Ugly raw string view.
+    out.Append('0');
+    out.Append('x');
+    for (uint64_t i = offset; i < end; ++i) {
+      out.AppendHex(memory[i]);
+    }
+    out.Append('\n');
   }
 }
 
@@ -1560,7 +1916,10 @@ bool MinidumpThread::Read() {
   }
 
   // Check for base + size overflow or undersize.
-  if (thread_.stack.memory.rva == 0 ||
+  if (thread_.stack.memory.rva == 0 && thread_.stack.memory.data_size != 0 &&
+      minidump_->GetBaseDump()) {
+    // The stack is the same as in the base dump; see GetMemory.
+  } else if (thread_.stack.memory.rva == 0 ||
       thread_.stack.memory.data_size == 0 ||
       thread_.stack.memory.data_size > numeric_limits<uint64_t>::max() -
                                        thread_.stack.start_of_memory_range) {
@@ -1593,6 +1952,21 @@ MinidumpMemoryRegion* MinidumpThread::GetMemory() {
     return NULL;
   }
 
+  if (!memory_ && thread_.stack.memory.rva == 0 &&
+      thread_.stack.memory.data_size != 0) {
+    // A delta minidump leaves out a stack that is the same as in its base
+    // dump.
+    Minidump* base_dump = minidump_->GetBaseDump();
+    MinidumpThreadList* base_threads =
+        base_dump ? base_dump->GetThreadList() : NULL;
+    MinidumpThread* base_thread =
+        base_threads ? base_threads->GetThreadByID(thread_.thread_id) : NULL;
+    if (base_thread && base_thread->GetStartOfStackMemoryRange() ==
+                           thread_.stack.start_of_memory_range) {
+      return base_thread->GetMemory();
+    }
+  }
+
   return memory_;
 }
 
@@ -1857,6 +2231,7 @@ MinidumpModule::MinidumpModule(Minidump* minidump)
     : MinidumpObject(minidump),
       module_valid_(false),
       has_debug_info_(false),
+      debug_info_read_(false),
       module_(),
       name_(NULL),
       cv_record_(NULL),
@@ -1884,6 +2259,7 @@ bool MinidumpModule::Read() {
 
   module_valid_ = false;
   has_debug_info_ = false;
+  debug_info_read_ = false;
   valid_ = false;
 
   if (!minidump_->ReadBytes(&module_, MD_MODULE_SIZE)) {
@@ -1946,7 +2322,23 @@ bool MinidumpModule::ReadAuxiliaryData() {
 
   // At this point, we have enough info for the module to be valid.
   valid_ = true;
+  return true;
+}
+
 
+bool MinidumpModule::HasDebugInfo() const {
+  if (!debug_info_read_) {
+    debug_info_read_ = true;
+    // The records are read through the non-const getters, which cache them;
+    // to callers they are as much a part of the module as if they had been
+    // read along with it.
+    has_debug_info_ = const_cast<MinidumpModule*>(this)->ReadDebugRecords();
+  }
+  return has_debug_info_;
+}
+
+
+bool MinidumpModule::ReadDebugRecords() {
   // CodeView and miscellaneous debug records are only required if the
   // module indicates that they exist.
   if (module_.cv_record.data_size && !GetCVRecord(NULL)) {
@@ -1961,7 +2353,6 @@ bool MinidumpModule::ReadAuxiliaryData() {
     return false;
   }
 
-  has_debug_info_ = true;
   return true;
 }
 
@@ -1982,7 +2373,7 @@ string MinidumpModule::code_identifier() const {
     return "";
   }
 
-  if (!has_debug_info_)
+  if (!HasDebugInfo())
     return "";
 
   MinidumpSystemInfo* minidump_system_info = minidump_->GetSystemInfo();
@@ -2066,7 +2457,7 @@ string MinidumpModule::debug_file() const {
     return "";
   }
 
-  if (!has_debug_info_)
+  if (!HasDebugInfo())
     return "";
 
   string file;
@@ -2174,7 +2565,7 @@ string MinidumpModule::debug_identifier() const {
     return "";
   }
 
-  if (!has_debug_info_)
+  if (!HasDebugInfo())
     return "";
 
   string identifier;
@@ -2663,6 +3054,7 @@ uint32_t MinidumpModuleList::max_modules_ = 2048;
 MinidumpModuleList::MinidumpModuleList(Minidump* minidump)
     : MinidumpStream(minidump),
       range_map_(new RangeMap<uint64_t, unsigned int>()),
+      range_table_(new AddressRangeTable<uint64_t, unsigned int>()),
       modules_(NULL),
       module_count_(0) {
   MDOSPlatform platform;
@@ -2675,6 +3067,7 @@ MinidumpModuleList::MinidumpModuleList(Minidump* minidump)
 
 MinidumpModuleList::~MinidumpModuleList() {
   delete range_map_;
+  delete range_table_;
   delete modules_;
 }
 
@@ -2682,6 +3075,7 @@ MinidumpModuleList::~MinidumpModuleList() {
 bool MinidumpModuleList::Read(uint32_t expected_size) {
   // Invalidate cached data.
   range_map_->Clear();
+  range_table_->Clear();
   delete modules_;
   modules_ = NULL;
   module_count_ = 0;
@@ -2759,11 +3153,11 @@ bool MinidumpModuleList::Read(uint32_t expected_size) {
          ++module_index) {
       MinidumpModule& module = (*modules)[module_index];
 
-      // ReadAuxiliaryData fails if any data that the module indicates should
-      // exist is missing, but we treat some such cases as valid anyway.  See
-      // issue #222: if a debugging record is of a format that's too large to
-      // handle, it shouldn't render the entire dump invalid.  Check module
-      // validity before giving up.
+      // ReadAuxiliaryData fails if the module's name is missing.  Debugging
+      // records are only read once they're asked for, so one of a format
+      // that's too large to handle doesn't render the entire dump invalid
+      // (see issue #222); it leaves the module without debug info.  Check
+      // module validity before giving up.
       if (!module.ReadAuxiliaryData() && !module.valid()) {
         BPLOG(ERROR) << "MinidumpModuleList could not read required module "
                         "auxiliary data for module " <<
@@ -2827,6 +3221,7 @@ bool MinidumpModuleList::Read(uint32_t expected_size) {
       last_end_address = base_address + module_size;
     }
 
+    range_table_->Build(*range_map_);
     modules_ = modules.release();
   }
 
@@ -2867,8 +3262,8 @@ const MinidumpModule* MinidumpModuleList::GetModuleForAddress(
   }
 
   unsigned int module_index;
-  if (!range_map_->RetrieveRange(address, &module_index, NULL /* base */,
-                                 NULL /* delta */, NULL /* size */)) {
+  if (!range_table_->RetrieveRange(address, &module_index, NULL /* base */,
+                                   NULL /* size */)) {
     BPLOG(INFO) << "MinidumpModuleList has no module at " <<
                    HexString(address);
     return NULL;
@@ -2904,9 +3299,8 @@ const MinidumpModule* MinidumpModuleList::GetModuleAtSequence(
   }
 
   unsigned int module_index;
-  if (!range_map_->RetrieveRangeAtIndex(sequence, &module_index,
-                                        NULL /* base */, NULL /* delta */,
-                                        NULL /* size */)) {
+  if (!range_table_->RetrieveRangeAtIndex(sequence, &module_index,
+                                          NULL /* base */, NULL /* size */)) {
     BPLOG(ERROR) << "MinidumpModuleList has no module at sequence " << sequence;
     return NULL;
   }
@@ -2936,6 +3330,10 @@ const CodeModules* MinidumpModuleList::Copy() const {
   return new BasicCodeModules(this, range_map_->GetMergeStrategy());
 }
 
+void MinidumpModuleList::CopyTo(BasicCodeModules* modules) const {
+  modules->Assign(this, range_map_->GetMergeStrategy());
+}
+
 vector<linked_ptr<const CodeModule> >
 MinidumpModuleList::GetShrunkRangeModules() const {
   return vector<linked_ptr<const CodeModule> >();
@@ -2971,7 +3369,7 @@ uint32_t MinidumpMemoryList::max_regions_ = 4096;
 
 MinidumpMemoryList::MinidumpMemoryList(Minidump* minidump)
     : MinidumpStream(minidump),
-      range_map_(new RangeMap<uint64_t, unsigned int>()),
+      last_region_range_(0),
       descriptors_(NULL),
       regions_(NULL),
       region_count_(0) {
@@ -2979,7 +3377,6 @@ MinidumpMemoryList::MinidumpMemoryList(Minidump* minidump)
 
 
 MinidumpMemoryList::~MinidumpMemoryList() {
-  delete range_map_;
   delete descriptors_;
   delete regions_;
 }
@@ -2991,7 +3388,8 @@ bool MinidumpMemoryList::Read(uint32_t expected_size) {
   descriptors_ = NULL;
   delete regions_;
   regions_ = NULL;
-  range_map_->Clear();
+  region_ranges_.clear();
+  last_region_range_ = 0;
   region_count_ = 0;
 
   valid_ = false;
@@ -3056,6 +3454,7 @@ bool MinidumpMemoryList::Read(uint32_t expected_size) {
 
     scoped_ptr<MemoryRegions> regions(
         new MemoryRegions(region_count, MinidumpMemoryRegion(minidump_)));
+    vector<RegionRange> region_ranges(region_count);
 
     for (unsigned int region_index = 0;
          region_index < region_count;
@@ -3078,19 +3477,35 @@ bool MinidumpMemoryList::Read(uint32_t expected_size) {
         return false;
       }
 
-      if (!range_map_->StoreRange(base_address, region_size, region_index)) {
+      region_ranges[region_index].base = base_address;
+      region_ranges[region_index].high = base_address + region_size - 1;
+      region_ranges[region_index].index = region_index;
+
+      (*regions)[region_index].SetDescriptor(descriptor);
+    }
+
+    // Index the regions by address, which requires that none overlap.
+    std::sort(region_ranges.begin(), region_ranges.end(),
+              [](const RegionRange& a, const RegionRange& b) {
+                return a.base < b.base;
+              });
+    for (unsigned int range_index = 1; range_index < region_count;
+         ++range_index) {
+      const RegionRange& previous = region_ranges[range_index - 1];
+      const RegionRange& range = region_ranges[range_index];
+      if (range.base <= previous.high) {
         BPLOG(ERROR) << "MinidumpMemoryList could not store memory region " <<
-                        region_index << "/" << region_count << ", " <<
-                        HexString(base_address) << "+" <<
-                        HexString(region_size);
+                        range.index << "/" << region_count << ", " <<
+                        HexString(range.base) << "+" <<
+                        HexString(range.high - range.base + 1) <<
+                        ", which overlaps region " << previous.index;
         return false;
       }
-
-      (*regions)[region_index].SetDescriptor(descriptor);
     }
 
     descriptors_ = descriptors.release();
     regions_ = regions.release();
+    region_ranges_.swap(region_ranges);
   }
 
   region_count_ = region_count;
@@ -3124,19 +3539,37 @@ MinidumpMemoryRegion* MinidumpMemoryList::GetMemoryRegionForAddress(
     return NULL;
   }
 
-  unsigned int region_index;
-  if (!range_map_->RetrieveRange(address, &region_index, NULL /* base */,
-                                 NULL /* delta */, NULL /* size */)) {
-    BPLOG(INFO) << "MinidumpMemoryList has no memory region at " <<
-                   HexString(address);
-    return NULL;
+  size_t range_index = last_region_range_.load(std::memory_order_relaxed);
+  if (range_index >= region_ranges_.size() ||
+      address < region_ranges_[range_index].base ||
+      address > region_ranges_[range_index].high) {
+    // The last region whose base is at or below address is the only one that
+    // may contain it.
+    vector<RegionRange>::const_iterator range =
+        std::upper_bound(region_ranges_.begin(), region_ranges_.end(), address,
+                         [](uint64_t address, const RegionRange& range) {
+                           return address < range.base;
+                         });
+    if (range == region_ranges_.begin() || address > (--range)->high) {
+      BPLOG(INFO) << "MinidumpMemoryList has no memory region at " <<
+                     HexString(address);
+      return NULL;
+    }
+    range_index = range - region_ranges_.begin();
+    last_region_range_.store(range_index, std::memory_order_relaxed);
   }
 
-  return GetMemoryRegionAtIndex(region_index);
+  return GetMemoryRegionAtIndex(region_ranges_[range_index].index);
 }
 
 
 void MinidumpMemoryList::Print() {
+  PrintRange(0, numeric_limits<uint64_t>::max());
+}
+
+
+void MinidumpMemoryList::PrintRange(uint64_t first_address,
+                                    uint64_t last_address) {
   if (!valid_) {
     BPLOG(ERROR) << "MinidumpMemoryList cannot print invalid data";
     return;
@@ -3150,6 +3583,13 @@ void MinidumpMemoryList::Print() {
        region_index < region_count_;
        ++region_index) {
     MDMemoryDescriptor* descriptor = &(*descriptors_)[region_index];
+    uint64_t base = descriptor->start_of_memory_range;
+    uint32_t size = descriptor->memory.data_size;
+    if (base > last_address ||
+        (size == 0 ? base < first_address
+                   : base + (size - 1) < first_address)) {
+      continue;
+    }
     printf("region[%d]\n", region_index);
     printf("MDMemoryDescriptor\n");
     printf("  start_of_memory_range = 0x%" PRIx64 "\n",
@@ -3159,7 +3599,8 @@ void MinidumpMemoryList::Print() {
     MinidumpMemoryRegion* region = GetMemoryRegionAtIndex(region_index);
     if (region) {
       printf("Memory\n");
-      region->Print();
+      region->PrintRange(first_address, last_address);
+      region->FreeMemory();
     } else {
       printf("No memory\n");
     }
@@ -3214,11 +3655,8 @@ bool MinidumpException::Read(uint32_t expected_size) {
     Swap(&exception_.exception_record.number_parameters);
     // exception_.exception_record.__align is for alignment only and does not
     // need to be swapped.
-    for (unsigned int parameter_index = 0;
-         parameter_index < MD_EXCEPTION_MAXIMUM_PARAMETERS;
-         ++parameter_index) {
-      Swap(&exception_.exception_record.exception_information[parameter_index]);
-    }
+    SwapArray(exception_.exception_record.exception_information,
+              MD_EXCEPTION_MAXIMUM_PARAMETERS);
     Swap(&exception_.thread_context);
   }
 
@@ -4525,6 +4963,7 @@ void MinidumpMemoryInfo::Print() {
 MinidumpMemoryInfoList::MinidumpMemoryInfoList(Minidump* minidump)
     : MinidumpStream(minidump),
       range_map_(new RangeMap<uint64_t, unsigned int>()),
+      range_table_(new AddressRangeTable<uint64_t, unsigned int>()),
       infos_(NULL),
       info_count_(0) {
 }
@@ -4532,6 +4971,7 @@ MinidumpMemoryInfoList::MinidumpMemoryInfoList(Minidump* minidump)
 
 MinidumpMemoryInfoList::~MinidumpMemoryInfoList() {
   delete range_map_;
+  delete range_table_;
   delete infos_;
 }
 
@@ -4541,6 +4981,7 @@ bool MinidumpMemoryInfoList::Read(uint32_t expected_size) {
   delete infos_;
   infos_ = NULL;
   range_map_->Clear();
+  range_table_->Clear();
   info_count_ = 0;
 
   valid_ = false;
@@ -4637,6 +5078,7 @@ bool MinidumpMemoryInfoList::Read(uint32_t expected_size) {
       }
     }
 
+    range_table_->Build(*range_map_);
     infos_ = infos.release();
   }
 
@@ -4673,8 +5115,8 @@ const MinidumpMemoryInfo* MinidumpMemoryInfoList::GetMemoryInfoForAddress(
   }
 
   unsigned int info_index;
-  if (!range_map_->RetrieveRange(address, &info_index, NULL /* base */,
-                                 NULL /* delta */, NULL /* size */)) {
+  if (!range_table_->RetrieveRange(address, &info_index, NULL /* base */,
+                                   NULL /* size */)) {
     BPLOG(INFO) << "MinidumpMemoryInfoList has no memory info at " <<
                    HexString(address);
     return NULL;
@@ -4725,50 +5167,65 @@ void MinidumpLinuxMaps::Print() const {
 
 MinidumpLinuxMapsList::MinidumpLinuxMapsList(Minidump* minidump)
     : MinidumpStream(minidump),
+      parsed_(false),
       maps_(NULL),
-      maps_count_(0) {
+      maps_count_(0),
+      range_map_(new RangeMap<uint64_t, unsigned int>()),
+      range_table_(new AddressRangeTable<uint64_t, unsigned int>()) {
 }
 
 MinidumpLinuxMapsList::~MinidumpLinuxMapsList() {
+  Reset();
+  delete range_map_;
+  delete range_table_;
+}
+
+void MinidumpLinuxMapsList::Reset() {
   if (maps_) {
     for (unsigned int i = 0; i < maps_->size(); i++) {
       delete (*maps_)[i];
     }
     delete maps_;
   }
+  maps_ = NULL;
+  maps_count_ = 0;
+  range_map_->Clear();
+  range_table_->Clear();
+  maps_text_.clear();
+  parsed_ = false;
+}
+
+unsigned int MinidumpLinuxMapsList::get_maps_count() const {
+  return ParseMaps() ? maps_count_ : 0;
 }
 
 const MinidumpLinuxMaps* MinidumpLinuxMapsList::GetLinuxMapsForAddress(
     uint64_t address) const {
-  if (!valid_ || (maps_ == NULL)) {
+  if (!ParseMaps()) {
     BPLOG(ERROR) << "Invalid MinidumpLinuxMapsList for GetLinuxMapsForAddress";
     return NULL;
   }
 
-  // Search every memory mapping.
-  for (unsigned int index = 0; index < maps_count_; index++) {
-    // Check if address is within bounds of the current memory region.
-    if ((*maps_)[index]->GetBase() <= address &&
-        (*maps_)[index]->GetBase() + (*maps_)[index]->GetSize() > address) {
-      return (*maps_)[index];
-    }
+  unsigned int index;
+  if (!range_table_->RetrieveRange(address, &index, NULL /* base */,
+                                   NULL /* size */)) {
+    // No mapping encloses the memory address.
+    BPLOG(ERROR) << "MinidumpLinuxMapsList has no mapping at "
+                 << HexString(address);
+    return NULL;
   }
-
-  // No mapping encloses the memory address.
-  BPLOG(ERROR) << "MinidumpLinuxMapsList has no mapping at "
-               << HexString(address);
-  return NULL;
+  return (*maps_)[index];
 }
 
 const MinidumpLinuxMaps* MinidumpLinuxMapsList::GetLinuxMapsAtIndex(
     unsigned int index) const {
-  if (!valid_ || (maps_ == NULL)) {
+  if (!ParseMaps()) {
     BPLOG(ERROR) << "Invalid MinidumpLinuxMapsList for GetLinuxMapsAtIndex";
     return NULL;
   }
 
   // Index out of bounds.
-  if (index >= maps_count_ || (maps_ == NULL)) {
+  if (index >= maps_count_) {
     BPLOG(ERROR) << "MinidumpLinuxMapsList index of out range: "
                  << index
                  << "/"
@@ -4780,14 +5237,7 @@ const MinidumpLinuxMaps* MinidumpLinuxMapsList::GetLinuxMapsAtIndex(
 
 bool MinidumpLinuxMapsList::Read(uint32_t expected_size) {
   // Invalidate cached data.
-  if (maps_) {
-    for (unsigned int i = 0; i < maps_->size(); i++) {
-      delete (*maps_)[i];
-    }
-    delete maps_;
-  }
-  maps_ = NULL;
-  maps_count_ = 0;
+  Reset();
 
   valid_ = false;
 
@@ -4805,40 +5255,59 @@ bool MinidumpLinuxMapsList::Read(uint32_t expected_size) {
     return false;
   }
 
-  // Create a vector to read stream data. The vector needs to have
-  // at least enough capacity to read all the data.
-  vector<char> mapping_bytes(length);
-  if (!minidump_->ReadBytes(&mapping_bytes[0], length)) {
+  // Keep the text; it's parsed when a mapping is first asked for.
+  maps_text_.resize(length);
+  if (length > 0 && !minidump_->ReadBytes(&maps_text_[0], length)) {
     BPLOG(ERROR) << "MinidumpLinuxMapsList failed to read bytes";
+    maps_text_.clear();
     return false;
   }
-  string map_string(mapping_bytes.begin(), mapping_bytes.end());
-  vector<MappedMemoryRegion> all_regions;
+
+  valid_ = true;
+  return true;
+}
+
+bool MinidumpLinuxMapsList::ParseMaps() const {
+  if (!valid_)
+    return false;
+  if (parsed_)
+    return maps_ != NULL;
+  parsed_ = true;
 
   // Parse string into mapping data.
-  if (!ParseProcMaps(map_string, &all_regions)) {
+  vector<MappedMemoryRegion> all_regions;
+  bool parsed = ParseProcMaps(maps_text_, &all_regions);
+  string().swap(maps_text_);
+  if (!parsed) {
+    BPLOG(ERROR) << "MinidumpLinuxMapsList could not parse the mappings";
     return false;
   }
 
   scoped_ptr<MinidumpLinuxMappings> maps(new MinidumpLinuxMappings());
 
-  // Push mapping data into wrapper classes.
+  // Push mapping data into wrapper classes, and index them by address.
+  // Mappings that are empty or overlap an earlier one can't be looked up
+  // by address, though they're still listed.
+  maps->reserve(all_regions.size());
   for (size_t i = 0; i < all_regions.size(); i++) {
     scoped_ptr<MinidumpLinuxMaps> ele(new MinidumpLinuxMaps(minidump_));
     ele->region_ = all_regions[i];
     ele->valid_ = true;
+    range_map_->StoreRange(ele->GetBase(), ele->GetSize(),
+                           static_cast<unsigned int>(i));
     maps->push_back(ele.release());
   }
+  range_table_->Build(*range_map_);
+  range_map_->Clear();
 
   // Set instance variables.
   maps_ = maps.release();
   maps_count_ = static_cast<uint32_t>(maps_->size());
-  valid_ = true;
   return true;
 }
 
 void MinidumpLinuxMapsList::Print() const {
-  if (!valid_ || (maps_ == NULL)) {
+  if (!ParseMaps()) {
     BPLOG(ERROR) << "MinidumpLinuxMapsList cannot print valid data";
     return;
   }
@@ -5040,11 +5509,20 @@ Minidump::Minidump(const string& path, bool hexdump, unsigned int hexdump_width)
       stream_map_(new MinidumpStreamMap()),
       path_(path),
       stream_(NULL),
+      use_mmap_(false),
+      mapped_data_(NULL),
+      mapped_size_(0),
+      mapped_position_(0),
+      load_memory_by_page_(false),
+      memory_budget_(0),
+      memory_bytes_read_(0),
       swap_(false),
       is_big_endian_(false),
       valid_(false),
       hexdump_(hexdump),
-      hexdump_width_(hexdump_width) {
+      hexdump_width_(hexdump_width),
+      base_dump_(NULL),
+      base_dump_depth_(0) {
 }
 
 Minidump::Minidump(istream& stream)
@@ -5053,27 +5531,64 @@ Minidump::Minidump(istream& stream)
       stream_map_(new MinidumpStreamMap()),
       path_(),
       stream_(&stream),
+      use_mmap_(false),
+      mapped_data_(NULL),
+      mapped_size_(0),
+      mapped_position_(0),
+      load_memory_by_page_(false),
+      memory_budget_(0),
+      memory_bytes_read_(0),
       swap_(false),
       is_big_endian_(false),
       valid_(false),
       hexdump_(false),
-      hexdump_width_(0) {
+      hexdump_width_(0),
+      base_dump_(NULL),
+      base_dump_depth_(0) {
 }
 
 Minidump::~Minidump() {
-  if (stream_) {
+  Close();
+  delete directory_;
+  delete stream_map_;
+  delete base_dump_;
+}
+
+
+void Minidump::Reset(const string& path) {
+  Close();
+  if (directory_)
+    directory_->clear();
+  stream_map_->clear();
+  delete base_dump_;
+  base_dump_ = NULL;
+  path_ = path;
+  memory_bytes_read_ = 0;
+  valid_ = false;
+}
+
+
+void Minidump::Close() {
+  if (stream_ || mapped_data_) {
     BPLOG(INFO) << "Minidump closing minidump";
   }
   if (!path_.empty()) {
     delete stream_;
   }
-  delete directory_;
-  delete stream_map_;
+  stream_ = NULL;
+#ifndef _WIN32
+  if (mapped_data_) {
+    munmap(const_cast<uint8_t*>(mapped_data_), mapped_size_);
+  }
+#endif  // _WIN32
+  mapped_data_ = NULL;
+  mapped_size_ = 0;
+  mapped_position_ = 0;
 }
 
 
 bool Minidump::Open() {
-  if (stream_ != NULL) {
+  if (stream_ != NULL || mapped_data_ != NULL) {
     BPLOG(INFO) << "Minidump reopening minidump " << path_;
 
     // The file is already open.  Seek to the beginning, which is the position
@@ -5081,6 +5596,14 @@ bool Minidump::Open() {
     return SeekSet(0);
   }
 
+  if (OpenCompressed())
+    return true;
+
+  if (use_mmap_ && !path_.empty() && MapFile()) {
+    BPLOG(INFO) << "Minidump mapped minidump " << path_;
+    return true;
+  }
+
   stream_ = new ifstream(path_.c_str(), std::ios::in | std::ios::binary);
   if (!stream_ || !stream_->good()) {
     string error_string;
@@ -5094,6 +5617,61 @@ bool Minidump::Open() {
   return true;
 }
 
+bool Minidump::OpenCompressed() {
+  ifstream file(path_.c_str(), std::ios::in | std::ios::binary);
+  uint32_t signature;
+  if (!file.read(reinterpret_cast<char*>(&signature), sizeof(signature)))
+    return false;
+  uint32_t swapped_signature = signature;
+  Swap(&swapped_signature);
+  if (signature != MD_COMPRESSED_HEADER_SIGNATURE &&
+      swapped_signature != MD_COMPRESSED_HEADER_SIGNATURE) {
+    return false;
+  }
+
+  file.seekg(0);
+  string compressed((std::istreambuf_iterator<char>(file)),
+                    std::istreambuf_iterator<char>());
+  string decompressed;
+  if (!DecompressMinidump(compressed, &decompressed)) {
+    BPLOG(ERROR) << "Minidump could not decompress minidump " << path_;
+    return false;
+  }
+  stream_ = new std::istringstream(decompressed);
+  BPLOG(INFO) << "Minidump decompressed minidump " << path_;
+  return true;
+}
+
+bool Minidump::MapFile() {
+#ifdef _WIN32
+  return false;
+#else
+  int fd = open(path_.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat file_stat;
+  void* mapping = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+    mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  if (mapping == MAP_FAILED) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    close(fd);
+    BPLOG(INFO) << "Minidump could not map minidump " << path_ <<
+                   ", error " << error_code << ": " << error_string;
+    return false;
+  }
+  close(fd);
+
+  mapped_data_ = static_cast<const uint8_t*>(mapping);
+  mapped_size_ = file_stat.st_size;
+  mapped_position_ = 0;
+  return true;
+#endif  // _WIN32
+}
+
 bool Minidump::GetContextCPUFlagsFromSystemInfo(uint32_t* context_cpu_flags) {
   // Initialize output parameters
   *context_cpu_flags = 0;
@@ -5174,10 +5752,14 @@ bool Minidump::GetContextCPUFlagsFromSystemInfo(uint32_t* context_cpu_flags) {
 
 
 bool Minidump::Read() {
-  // Invalidate cached data.
-  delete directory_;
-  directory_ = NULL;
+  BREAKPAD_PROBE_SCOPE(minidump_read);
+
+  // Invalidate cached data, keeping the directory's storage.
+  if (directory_)
+    directory_->clear();
   stream_map_->clear();
+  delete base_dump_;
+  base_dump_ = NULL;
 
   valid_ = false;
 
@@ -5254,12 +5836,13 @@ bool Minidump::Read() {
   }
 
   if (header_.stream_count != 0) {
-    scoped_ptr<MinidumpDirectoryEntries> directory(
-        new MinidumpDirectoryEntries(header_.stream_count));
+    if (!directory_)
+      directory_ = new MinidumpDirectoryEntries();
+    directory_->resize(header_.stream_count);
 
     // Read the entire array in one fell swoop, instead of reading one entry
     // at a time in the loop.
-    if (!ReadBytes(&(*directory)[0],
+    if (!ReadBytes(&(*directory_)[0],
                    sizeof(MDRawDirectory) * header_.stream_count)) {
       BPLOG(ERROR) << "Minidump cannot read stream directory";
       return false;
@@ -5268,7 +5851,7 @@ bool Minidump::Read() {
     for (unsigned int stream_index = 0;
          stream_index < header_.stream_count;
          ++stream_index) {
-      MDRawDirectory* directory_entry = &(*directory)[stream_index];
+      MDRawDirectory* directory_entry = &(*directory_)[stream_index];
 
       if (swap_) {
         Swap(&directory_entry->stream_type);
@@ -5304,15 +5887,68 @@ bool Minidump::Read() {
         }
       }
     }
-
-    directory_ = directory.release();
   }
 
   valid_ = true;
+  ReadBaseDump();
   return true;
 }
 
 
+void Minidump::ReadBaseDump() {
+  uint32_t stream_length;
+  if (stream_map_->find(MD_BASE_DUMP_STREAM) == stream_map_->end() ||
+      !SeekToStreamType(MD_BASE_DUMP_STREAM, &stream_length)) {
+    return;
+  }
+  MDRawBaseDump base_dump;
+  if (stream_length < sizeof(base_dump) ||
+      !ReadBytes(&base_dump, sizeof(base_dump))) {
+    BPLOG(ERROR) << "Minidump cannot read base dump stream";
+    return;
+  }
+  if (swap_) {
+    Swap(&base_dump.dump_id);
+    Swap(&base_dump.base_dump_id);
+  }
+
+  static const MDGUID kNoBaseDump = {0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0}};
+  if (memcmp(&base_dump.base_dump_id, &kNoBaseDump, sizeof(MDGUID)) == 0)
+    return;
+  if (path_.empty()) {
+    BPLOG(ERROR) << "Minidump cannot find the base dump of a minidump "
+                    "without a path";
+    return;
+  }
+  if (base_dump_depth_ >= kMaxBaseDumpDepth) {
+    BPLOG(ERROR) << "Minidump base dumps nested too deeply";
+    return;
+  }
+
+  const MDGUID& id = base_dump.base_dump_id;
+  char name[64];
+  snprintf(name, sizeof(name), "%08x-%04x-%04x-%08x-%08x.dmp",
+           id.data1, id.data2, id.data3,
+           id.data4[0] | id.data4[1] << 8 | id.data4[2] << 16 |
+               static_cast<uint32_t>(id.data4[3]) << 24,
+           id.data4[4] | id.data4[5] << 8 | id.data4[6] << 16 |
+               static_cast<uint32_t>(id.data4[7]) << 24);
+  const size_t slash = path_.find_last_of('/');
+  const string base_path =
+      (slash == string::npos ? string() : path_.substr(0, slash + 1)) + name;
+
+  scoped_ptr<Minidump> base(new Minidump(base_path));
+  base->base_dump_depth_ = base_dump_depth_ + 1;
+  base->set_use_mmap(use_mmap_);
+  base->set_load_memory_by_page(load_memory_by_page_);
+  if (!base->Read()) {
+    BPLOG(ERROR) << "Minidump cannot read base dump " << base_path;
+    return;
+  }
+  base_dump_ = base.release();
+}
+
+
 MinidumpThreadList* Minidump::GetThreadList() {
   MinidumpThreadList* thread_list;
   return GetStream(&thread_list);
@@ -5407,6 +6043,59 @@ MinidumpCrashpadInfo* Minidump::GetCrashpadInfo() {
   return GetStream(&crashpad_info);
 }
 
+// The name a module is routed by: its symbols' name, where it has one.
+static string routing_name(const MinidumpModule& module) {
+  string debug_identifier = module.debug_identifier();
+  if (!debug_identifier.empty())
+    return module.debug_file() + "/" + debug_identifier;
+  return module.code_file() + "/" + module.code_identifier();
+}
+
+bool Minidump::GetRoutingKey(size_t max_heavy_modules, RoutingKey* key) {
+  key->build_fingerprint = 0;
+  key->heavy_modules.clear();
+  if (!valid_ && !Read()) {
+    BPLOG(ERROR) << "Minidump cannot get a routing key without being read";
+    return false;
+  }
+  MinidumpModuleList* module_list = GetModuleList();
+  if (!module_list) {
+    BPLOG(ERROR) << "Minidump cannot get a routing key without modules";
+    return false;
+  }
+
+  const MinidumpModule* main_module = module_list->GetMainModule();
+  if (main_module) {
+    // FNV-1a, which is stable across hosts and releases, unlike std::hash.
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    string name = routing_name(*main_module);
+    for (size_t i = 0; i < name.size(); ++i) {
+      hash ^= static_cast<unsigned char>(name[i]);
+      hash *= 0x100000001b3ULL;
+    }
+    key->build_fingerprint = hash;
+  }
+
+  // Largest first, and in the module list's order among equals, so that
+  // the list is the same for every minidump of a build.
+  vector<std::pair<uint64_t, unsigned int> > sizes;
+  for (unsigned int i = 0; i < module_list->module_count(); ++i) {
+    const MinidumpModule* module = module_list->GetModuleAtIndex(i);
+    if (module)
+      sizes.push_back(std::make_pair(module->size(), i));
+  }
+  std::stable_sort(sizes.begin(), sizes.end(),
+                   [](const std::pair<uint64_t, unsigned int>& a,
+                      const std::pair<uint64_t, unsigned int>& b) {
+                     return a.first > b.first;
+                   });
+  for (size_t i = 0; i < sizes.size() && i < max_heavy_modules; ++i) {
+    key->heavy_modules.push_back(
+        routing_name(*module_list->GetModuleAtIndex(sizes[i].second)));
+  }
+  return true;
+}
+
 static const char* get_stream_name(uint32_t stream_type) {
   switch (stream_type) {
   case MD_UNUSED_STREAM:
@@ -5551,6 +6240,17 @@ const MDRawDirectory* Minidump::GetDirectoryEntryAtIndex(unsigned int index)
 bool Minidump::ReadBytes(void* bytes, size_t count) {
   // Can't check valid_ because Read needs to call this method before
   // validity can be determined.
+  if (mapped_data_) {
+    const uint8_t* mapped_bytes = GetMappedBytes(mapped_position_, count);
+    if (!mapped_bytes) {
+      BPLOG(ERROR) << "ReadBytes: read " << count << " bytes at " <<
+                      mapped_position_ << " beyond end of minidump";
+      return false;
+    }
+    memcpy(bytes, mapped_bytes, count);
+    mapped_position_ += count;
+    return true;
+  }
   if (!stream_) {
     return false;
   }
@@ -5583,6 +6283,15 @@ bool Minidump::ReadBytes(void* bytes, size_t count) {
 bool Minidump::SeekSet(off_t offset) {
   // Can't check valid_ because Read needs to call this method before
   // validity can be determined.
+  if (mapped_data_) {
+    if (offset < 0 || static_cast<uint64_t>(offset) > mapped_size_) {
+      BPLOG(ERROR) << "SeekSet: offset " << offset << " beyond end of "
+                      "minidump";
+      return false;
+    }
+    mapped_position_ = offset;
+    return true;
+  }
   if (!stream_) {
     return false;
   }
@@ -5597,9 +6306,12 @@ bool Minidump::SeekSet(off_t offset) {
 }
 
 off_t Minidump::Tell() {
-  if (!valid_ || !stream_) {
+  if (!valid_ || (!stream_ && !mapped_data_)) {
     return (off_t)-1;
   }
+  if (mapped_data_) {
+    return mapped_position_;
+  }
 
   // Check for conversion data loss
   std::streamoff std_streamoff = stream_->tellg();
@@ -5613,6 +6325,30 @@ off_t Minidump::Tell() {
 }
 
 
+const uint8_t* Minidump::GetMappedBytes(off_t offset, size_t count) const {
+  if (!mapped_data_ || offset < 0 ||
+      static_cast<uint64_t>(offset) > mapped_size_ ||
+      count > mapped_size_ - static_cast<uint64_t>(offset)) {
+    return NULL;
+  }
+  return mapped_data_ + offset;
+}
+
+
+bool Minidump::ChargeMemoryBudget(uint64_t count) {
+  if (memory_budget_ != 0 &&
+      (memory_bytes_read_ > memory_budget_ ||
+       count > memory_budget_ - memory_bytes_read_)) {
+    BPLOG(ERROR) << "Minidump memory budget of " << memory_budget_ <<
+                    " bytes would be exceeded reading " << count <<
+                    " more after " << memory_bytes_read_;
+    return false;
+  }
+  memory_bytes_read_ += count;
+  return true;
+}
+
+
 string* Minidump::ReadString(off_t offset) {
   if (!valid_) {
     BPLOG(ERROR) << "Invalid Minidump for ReadString";
@@ -5646,6 +6382,22 @@ string* Minidump::ReadString(off_t offset) {
     return NULL;
   }
 
+  // Convert a memory-mapped string where it is, if it's aligned as
+  // UTF-16 should be, as it is unless the minidump is malformed.
+  if (mapped_data_) {
+    const uint8_t* mapped_bytes = GetMappedBytes(mapped_position_, bytes);
+    if (!mapped_bytes) {
+      BPLOG(ERROR) << "ReadString could not read " << bytes <<
+                      "-byte string at offset " << offset;
+      return NULL;
+    }
+    if (reinterpret_cast<uintptr_t>(mapped_bytes) % sizeof(uint16_t) == 0) {
+      mapped_position_ += bytes;
+      return UTF16ToUTF8(reinterpret_cast<const uint16_t*>(mapped_bytes),
+                         utf16_words, swap_);
+    }
+  }
+
   vector<uint16_t> string_utf16(utf16_words);
 
   if (utf16_words) {
@@ -5871,6 +6623,9 @@ T* Minidump::GetStream(T** stream) {
 
   MinidumpStreamMap::iterator iterator = stream_map_->find(stream_type);
   if (iterator == stream_map_->end()) {
+    // A delta takes the streams it lacks from its base dump.
+    if (base_dump_)
+      return base_dump_->GetStream(stream);
     // This stream type didn't exist in the directory.
     BPLOG(INFO) << "GetStream: type " << stream_type << " not present";
     return NULL;
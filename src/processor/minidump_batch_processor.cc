@@ -0,0 +1,709 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_batch_processor.cc: Processes every minidump in a directory
+// tree in one process, on a pool of workers that share their symbols.
+//
+// The minidumps found are dealt out to the workers in runs of neighboring
+// files, which in a tree laid out by product or version tend to need the
+// same symbols.  A worker that runs out takes minidumps from the far end
+// of another's run, so that the workers finish together however unevenly
+// the work was dealt.
+//
+// Each minidump's record, as would be printed by minidump_stackwalk -b, goes
+// to one of a number of shard files in the output directory, chosen by the
+// minidump's path so that a minidump lands in the same shard from one run
+// to the next.  With -A, each shard is instead an Apache Arrow IPC stream
+// holding a row for each of its minidumps, which analytics systems can
+// load without parsing records.  Progress, in minidumps per second, is
+// reported to stderr as the batch runs.
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/minidump.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/caching_symbol_supplier.h"
+#include "processor/call_stack_cache.h"
+#include "processor/frame_symbol_cache.h"
+#include "processor/hot_module_set.h"
+#include "processor/logging.h"
+#include "processor/numa_topology.h"
+#include "processor/process_state_arrow_writer.h"
+#include "processor/stackwalk_common.h"
+#include "processor/symbol_load_cache.h"
+#include "processor/symbol_path_cache.h"
+
+namespace {
+
+using google_breakpad::CachingSymbolSupplier;
+using google_breakpad::CallStackCache;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::FrameSymbolCache;
+using google_breakpad::HotModuleSet;
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpMemoryList;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::MinidumpThreadList;
+using google_breakpad::NumaTopology;
+using google_breakpad::ProcessState;
+using google_breakpad::ProcessStateArrowWriter;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::SymbolLoadCache;
+using google_breakpad::SymbolPathCache;
+using std::chrono::steady_clock;
+
+struct Options {
+  string minidump_dir;
+  string output_dir;
+  string symbol_cache_path;
+  string hot_modules_path;
+  std::vector<string> symbol_paths;
+  int workers;
+  int shards;
+  int report_seconds;
+  int stackwalk_threads;
+  int warm_modules;
+  uint64_t module_cache_budget;
+  bool use_mmap;
+  bool index_symbol_paths;
+  bool numa;
+  bool arrow;
+};
+
+// Adds the path of each minidump, a regular file whose name ends in .dmp,
+// in the tree under |dir| to |minidump_files|.  Returns false if a directory
+// in the tree can't be read.
+bool FindMinidumps(const string& dir, std::vector<string>* minidump_files) {
+  DIR* dir_stream = opendir(dir.c_str());
+  if (!dir_stream) {
+    BPLOG(ERROR) << "Could not read directory " << dir << ": "
+                 << strerror(errno);
+    return false;
+  }
+  std::vector<string> names;
+  while (struct dirent* entry = readdir(dir_stream)) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+      names.push_back(entry->d_name);
+  }
+  closedir(dir_stream);
+
+  // In order, so that neighboring minidumps are dealt to the same worker.
+  std::sort(names.begin(), names.end());
+  bool succeeded = true;
+  for (size_t i = 0; i < names.size(); ++i) {
+    string path = dir + "/" + names[i];
+    struct stat info;
+    if (lstat(path.c_str(), &info) != 0)
+      continue;
+    if (S_ISDIR(info.st_mode)) {
+      succeeded = FindMinidumps(path, minidump_files) && succeeded;
+    } else if (S_ISREG(info.st_mode) && names[i].size() > 4 &&
+               names[i].compare(names[i].size() - 4, 4, ".dmp") == 0) {
+      minidump_files->push_back(path);
+    }
+  }
+  return succeeded;
+}
+
+// The minidumps waiting for each worker, which other workers take from
+// once they've finished their own.
+class WorkQueues {
+ public:
+  // Deals |item_count| items, numbered from 0, to |worker_count| workers in
+  // contiguous runs.
+  WorkQueues(size_t worker_count, size_t item_count) {
+    for (size_t worker = 0; worker < worker_count; ++worker) {
+      queues_.push_back(std::unique_ptr<Queue>(new Queue));
+      size_t begin = item_count * worker / worker_count;
+      size_t end = item_count * (worker + 1) / worker_count;
+      for (size_t item = begin; item < end; ++item)
+        queues_[worker]->items.push_back(item);
+    }
+  }
+
+  // Sets |item| to the next item for |worker|: the first of its own, or
+  // failing that, the last of another worker's.  Returns false once no
+  // items are left.
+  bool Next(size_t worker, size_t* item) {
+    {
+      Queue* queue = queues_[worker].get();
+      std::lock_guard<std::mutex> lock(queue->mutex);
+      if (!queue->items.empty()) {
+        *item = queue->items.front();
+        queue->items.pop_front();
+        return true;
+      }
+    }
+    for (size_t i = 1; i < queues_.size(); ++i) {
+      Queue* victim = queues_[(worker + i) % queues_.size()].get();
+      std::lock_guard<std::mutex> lock(victim->mutex);
+      if (!victim->items.empty()) {
+        *item = victim->items.back();
+        victim->items.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> items;
+  };
+
+  std::vector<std::unique_ptr<Queue> > queues_;
+};
+
+// The shard files that records are written to.
+class ShardedOutput {
+ public:
+  ShardedOutput() {}
+  ~ShardedOutput() {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i]->arrow_writer.reset();
+      if (shards_[i]->file)
+        fclose(shards_[i]->file);
+    }
+  }
+
+  // Creates |shard_count| shard files in |dir|, as Arrow streams if
+  // |arrow| is set.  Returns false if any can't be created.
+  bool Open(const string& dir, int shard_count, bool arrow) {
+    for (int i = 0; i < shard_count; ++i) {
+      char name[32];
+      snprintf(name, sizeof(name), "/shard-%05d%s", i, arrow ? ".arrow" : "");
+      string path = dir + name;
+      shards_.push_back(std::unique_ptr<Shard>(new Shard));
+      shards_[i]->file = fopen(path.c_str(), arrow ? "wb" : "w");
+      if (!shards_[i]->file) {
+        BPLOG(ERROR) << "Could not create " << path << ": " << strerror(errno);
+        return false;
+      }
+      if (arrow) {
+        shards_[i]->arrow_writer.reset(
+            new ProcessStateArrowWriter(shards_[i]->file));
+      }
+    }
+    return true;
+  }
+
+  // Appends |record| to the shard for |key|.
+  bool Write(const string& key, const string& record) {
+    Shard* shard = shards_[ShardIndex(key)].get();
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    return fwrite(record.data(), 1, record.size(), shard->file) ==
+           record.size();
+  }
+
+  // Adds a row for the minidump at |path| to its shard's Arrow stream.
+  bool WriteArrow(const string& path, const string& status,
+                  const ProcessState* process_state) {
+    Shard* shard = shards_[ShardIndex(path)].get();
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    return shard->arrow_writer->Write(path, status, process_state);
+  }
+
+  // Ends the shards' Arrow streams, if they are streams.  Returns false if
+  // any couldn't be completed.
+  bool Finish() {
+    bool ok = true;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      if (shards_[i]->arrow_writer && !shards_[i]->arrow_writer->Finish())
+        ok = false;
+    }
+    return ok;
+  }
+
+ private:
+  struct Shard {
+    Shard() : file(NULL) {}
+    std::mutex mutex;
+    FILE* file;
+    std::unique_ptr<ProcessStateArrowWriter> arrow_writer;
+  };
+
+  // FNV-1a, which unlike std::hash is the same from one build to the next.
+  size_t ShardIndex(const string& key) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < key.size(); ++i) {
+      hash ^= static_cast<unsigned char>(key[i]);
+      hash *= 1099511628211ULL;
+    }
+    return hash % shards_.size();
+  }
+
+  std::vector<std::unique_ptr<Shard> > shards_;
+};
+
+// Processes |path| into |process_state| with |dump|, both reused from
+// the last minidump.  Returns its status as minidump_stackwalk -b would
+// report it, "OK" if it was processed successfully.
+const char* ProcessMinidump(MinidumpProcessor* minidump_processor,
+                            const string& path,
+                            Minidump* dump,
+                            ProcessState* process_state) {
+  dump->Reset(path);
+  if (!dump->Read()) {
+    BPLOG(ERROR) << "Minidump " << path << " could not be read";
+    return "ERROR_READ";
+  }
+  if (minidump_processor->Process(dump, process_state) !=
+      google_breakpad::PROCESS_OK) {
+    BPLOG(ERROR) << "MinidumpProcessor::Process failed for " << path;
+    return "ERROR_PROCESS";
+  }
+  return "OK";
+}
+
+// Leaves the record of the minidump at |path| with |status|, processed
+// into |process_state|, in |record|.  Returns false if it couldn't be
+// formatted.
+bool FormatRecord(const string& path,
+                  const char* status,
+                  const ProcessState& process_state,
+                  string* record) {
+  char* buffer = NULL;
+  size_t size = 0;
+  FILE* out = open_memstream(&buffer, &size);
+  if (!out) {
+    BPLOG(ERROR) << "Could not buffer output: " << strerror(errno);
+    return false;
+  }
+  fprintf(out, "Minidump|%s|%s\n", path.c_str(), status);
+  if (strcmp(status, "OK") == 0)
+    PrintProcessStateMachineReadable(process_state, out);
+  fclose(out);
+  record->assign(buffer, size);
+  free(buffer);
+  return true;
+}
+
+// Reports progress to stderr every |options.report_seconds| until Stop().
+class ProgressReporter {
+ public:
+  ProgressReporter(const Options& options, size_t total,
+                   const std::atomic<size_t>* done)
+      : total_(total),
+        done_(done),
+        start_(steady_clock::now()),
+        stopped_(false),
+        thread_(&ProgressReporter::Run, this, options.report_seconds) {}
+
+  // Stops reporting, and reports the totals for the batch.
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    stop_.notify_one();
+    thread_.join();
+    Report(done_->load(), Elapsed(), 0);
+  }
+
+ private:
+  double Elapsed() const {
+    return std::chrono::duration<double>(steady_clock::now() - start_).count();
+  }
+
+  void Report(size_t done, double elapsed, double recent_rate) const {
+    double rate = elapsed > 0 ? done / elapsed : 0;
+    if (recent_rate > 0) {
+      fprintf(stderr, "%zu/%zu minidumps, %.1f/s (%.1f/s overall)\n",
+              done, total_, recent_rate, rate);
+    } else {
+      fprintf(stderr, "%zu/%zu minidumps in %.1fs, %.1f/s\n",
+              done, total_, elapsed, rate);
+    }
+  }
+
+  void Run(int report_seconds) {
+    size_t last_done = 0;
+    double last_elapsed = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_.wait_for(lock, std::chrono::seconds(report_seconds),
+                           [this]() { return stopped_; })) {
+      size_t done = done_->load();
+      double elapsed = Elapsed();
+      Report(done, elapsed, (done - last_done) / (elapsed - last_elapsed));
+      last_done = done;
+      last_elapsed = elapsed;
+    }
+  }
+
+  size_t total_;
+  const std::atomic<size_t>* done_;
+  steady_clock::time_point start_;
+  std::mutex mutex_;
+  std::condition_variable stop_;
+  bool stopped_;
+  std::thread thread_;
+};
+
+// The symbols, and what was resolved from them, shared by a group of
+// workers: all of them, or with -N, those bound to one NUMA node.
+struct SymbolState {
+  SymbolState(const Options& options, SymbolPathCache* path_cache)
+      : supplier(options.symbol_paths, options.symbol_cache_path),
+        resolver(true),
+        workers(0),
+        local_minidumps(0),
+        remote_minidumps(0) {
+    supplier.set_path_cache(path_cache);
+    // Copied symbols are placed by the worker that first touches them,
+    // which with -N is one of this node's.
+    supplier.set_use_huge_pages(options.numa);
+    resolver.SetModuleCacheBudget(options.module_cache_budget);
+  }
+
+  // The resolver is destroyed before the supplier, which owns the mapped
+  // symbol data that it points into.
+  CachingSymbolSupplier supplier;
+  FastSourceLineResolver resolver;
+  // Lets one worker at a time fetch a module that several need, and
+  // remembers modules missing their symbols across minidumps.
+  SymbolLoadCache load_cache;
+  // Remember what each frame address symbolized and unwound to, and the
+  // requesting threads' stacks of minidumps that repeat each other.
+  FrameSymbolCache frame_cache;
+  CallStackCache call_stack_cache;
+
+  // With -N, the workers using these symbols, and the minidumps they
+  // processed while running on this node's CPUs, and off them.
+  int workers;
+  std::atomic<uint64_t> local_minidumps;
+  std::atomic<uint64_t> remote_minidumps;
+};
+
+// Processes every minidump under |options.minidump_dir| into the shards in
+// |options.output_dir|.  Returns false if any minidump could not be found
+// or processed.
+bool ProcessMinidumps(const Options& options) {
+  std::vector<string> minidump_files;
+  bool all_processed = FindMinidumps(options.minidump_dir, &minidump_files);
+
+  ShardedOutput output;
+  if (!output.Open(options.output_dir, options.shards, options.arrow))
+    return false;
+
+  // Remembers where symbol files are, and aren't, across minidumps.
+  SymbolPathCache path_cache;
+  if (options.index_symbol_paths) {
+    for (size_t i = 0; i < options.symbol_paths.size(); ++i)
+      path_cache.IndexRoot(options.symbol_paths[i]);
+  }
+
+  // With -N, each NUMA node gets its own copy of the symbols, so that
+  // workers bound to its CPUs look them up in local memory rather than
+  // across the interconnect.  Otherwise one copy is shared by all workers.
+  NumaTopology topology;
+  if (options.numa && !topology.Read())
+    BPLOG(INFO) << "No NUMA nodes found; treating the host as one node";
+  std::vector<std::unique_ptr<SymbolState> > states;
+  for (int node = 0; node < topology.node_count(); ++node)
+    states.push_back(std::unique_ptr<SymbolState>(
+        new SymbolState(options, &path_cache)));
+
+  size_t worker_count = std::max<size_t>(1,
+      std::min<size_t>(options.workers, minidump_files.size()));
+  for (size_t i = 0; i < worker_count; ++i)
+    ++states[i % states.size()]->workers;
+
+  // With -W, loads the modules earlier runs used most before starting,
+  // each node's on a thread bound to it, and counts this run's.
+  HotModuleSet hot_modules;
+  if (!options.hot_modules_path.empty() &&
+      hot_modules.Load(options.hot_modules_path)) {
+    std::vector<std::thread> warmers;
+    for (size_t node = 0; node < states.size(); ++node) {
+      warmers.push_back(std::thread([&, node]() {
+        if (options.numa)
+          topology.BindCurrentThread(static_cast<int>(node));
+        int warmed = hot_modules.WarmUp(options.warm_modules,
+                                        &states[node]->supplier,
+                                        &states[node]->resolver);
+        BPLOG(INFO) << "Warmed up " << warmed << " modules";
+      }));
+    }
+    for (size_t i = 0; i < warmers.size(); ++i)
+      warmers[i].join();
+  }
+  WorkQueues queues(worker_count, minidump_files.size());
+  std::atomic<size_t> done(0);
+  std::atomic<bool> all_ok(true);
+  ProgressReporter reporter(options, minidump_files.size(), &done);
+
+  auto work = [&](size_t worker) {
+    // Workers are dealt to the nodes in turn.
+    int node = static_cast<int>(worker % states.size());
+    SymbolState* state = states[node].get();
+    if (options.numa && !topology.BindCurrentThread(node))
+      BPLOG(INFO) << "Could not bind worker " << worker << " to node " << node;
+    StackFrameSymbolizer symbolizer(&state->supplier, &state->resolver);
+    symbolizer.set_symbol_load_cache(&state->load_cache);
+    symbolizer.set_frame_symbol_cache(&state->frame_cache);
+    if (!options.hot_modules_path.empty())
+      symbolizer.set_hot_module_set(&hot_modules);
+    MinidumpProcessor minidump_processor(&symbolizer, false);
+    minidump_processor.set_call_stack_cache(&state->call_stack_cache);
+    minidump_processor.set_stackwalk_threads(options.stackwalk_threads);
+    Minidump dump((string()));
+    dump.set_use_mmap(options.use_mmap);
+    ProcessState process_state;
+    size_t i;
+    string record;
+    while (queues.Next(worker, &i)) {
+      const string& path = minidump_files[i];
+      const char* status = ProcessMinidump(&minidump_processor, path, &dump,
+                                           &process_state);
+      bool processed = strcmp(status, "OK") == 0;
+      if (!processed)
+        all_ok = false;
+      bool written;
+      if (options.arrow) {
+        written = output.WriteArrow(path, status,
+                                    processed ? &process_state : NULL);
+      } else {
+        written = FormatRecord(path, status, process_state, &record) &&
+                  output.Write(path, record);
+      }
+      if (!written) {
+        BPLOG(ERROR) << "Could not write the record for " << path;
+        all_ok = false;
+      }
+      if (options.numa) {
+        int current_node = topology.CurrentNode();
+        if (current_node == node)
+          ++state->local_minidumps;
+        else if (current_node >= 0)
+          ++state->remote_minidumps;
+      }
+      ++done;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < worker_count; ++i)
+    workers.push_back(std::thread(work, i));
+  work(0);
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+
+  reporter.Stop();
+  if (!output.Finish()) {
+    BPLOG(ERROR) << "Could not complete the shard files";
+    all_ok = false;
+  }
+  if (!options.hot_modules_path.empty())
+    hot_modules.Save(options.hot_modules_path);
+  if (options.numa) {
+    for (size_t node = 0; node < states.size(); ++node) {
+      const SymbolState& state = *states[node];
+      fprintf(stderr, "node %zu: %d workers, %llu minidumps on the node, "
+              "%llu off it\n", node, state.workers,
+              static_cast<unsigned long long>(state.local_minidumps.load()),
+              static_cast<unsigned long long>(state.remote_minidumps.load()));
+    }
+  }
+  return all_processed && all_ok;
+}
+
+}  // namespace
+
+static void Usage(int argc, const char *argv[], bool error) {
+  fprintf(error ? stderr : stdout,
+          "Usage: %s [options] -f <dir> -o <dir> <minidump-dir> "
+          "[symbol-path ...]\n"
+          "\n"
+          "Process every minidump (*.dmp) in the tree under <minidump-dir>,\n"
+          "writing a record for each, as minidump_stackwalk -b would, to one\n"
+          "of the shard files in the output directory\n"
+          "\n"
+          "Options:\n"
+          "\n"
+          "  -f <dir>    Cache symbols in <dir> in the fast-loading format\n"
+          "  -o <dir>    Write the shard files to <dir>, which must exist\n"
+          "  -A          Write each shard as an Apache Arrow IPC stream,\n"
+          "              with a row for each minidump\n"
+          "  -w <n>      Process up to <n> minidumps at once (default: the\n"
+          "              number of CPUs)\n"
+          "  -S <n>      Write <n> shard files (default 16)\n"
+          "  -r <s>      Report progress every <s> seconds (default 10)\n"
+          "  -m <bytes>  Unload the least recently used symbols to keep\n"
+          "              them within <bytes> (default 0, no limit)\n"
+          "  -j <n>      Walk up to <n> threads' stacks of a minidump at "
+          "once\n"
+          "  -M          Memory-map each minidump rather than reading it\n"
+          "  -I          List the symbol files in each symbol path before\n"
+          "              starting, rather than looking for each module's\n"
+          "              symbols where it's needed\n"
+          "  -N          Bind workers to the host's NUMA nodes in turn, giving\n"
+          "              each node its own copy of the symbols\n"
+          "  -W <file>   Before starting, load the symbols that earlier runs\n"
+          "              used most, as counted in <file>, and add this run's\n"
+          "              counts to it\n"
+          "  -P <n>      Load up to <n> modules' symbols for -W (default 100)\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+static int PositiveIntArgument(int argc, const char *argv[],
+                               const char* value) {
+  int result = atoi(value);
+  if (result < 1) {
+    fprintf(stderr, "%s: Invalid count: %s\n", argv[0], value);
+    Usage(argc, argv, true);
+    exit(1);
+  }
+  return result;
+}
+
+static void SetupOptions(int argc, const char *argv[], Options* options) {
+  int ch;
+
+  options->workers = std::max(1u, std::thread::hardware_concurrency());
+  options->shards = 16;
+  options->report_seconds = 10;
+  options->stackwalk_threads = 1;
+  options->warm_modules = 100;
+  options->module_cache_budget = 0;
+  options->use_mmap = false;
+  options->index_symbol_paths = false;
+  options->numa = false;
+  options->arrow = false;
+
+  while ((ch = getopt(argc, (char * const*)argv, "AIMNP:S:W:f:hj:m:o:r:w:")) !=
+         -1) {
+    switch (ch) {
+      case 'h':
+        Usage(argc, argv, false);
+        exit(0);
+        break;
+
+      case 'A':
+        options->arrow = true;
+        break;
+      case 'I':
+        options->index_symbol_paths = true;
+        break;
+      case 'M':
+        options->use_mmap = true;
+        break;
+      case 'N':
+        options->numa = true;
+        break;
+      case 'P':
+        options->warm_modules = PositiveIntArgument(argc, argv, optarg);
+        break;
+      case 'S':
+        options->shards = PositiveIntArgument(argc, argv, optarg);
+        break;
+      case 'W':
+        options->hot_modules_path = optarg;
+        break;
+      case 'f':
+        options->symbol_cache_path = optarg;
+        break;
+      case 'j':
+        options->stackwalk_threads = PositiveIntArgument(argc, argv, optarg);
+        break;
+      case 'm':
+        options->module_cache_budget = strtoull(optarg, NULL, 10);
+        break;
+      case 'o':
+        options->output_dir = optarg;
+        break;
+      case 'r':
+        options->report_seconds = PositiveIntArgument(argc, argv, optarg);
+        break;
+      case 'w':
+        options->workers = PositiveIntArgument(argc, argv, optarg);
+        break;
+
+      case '?':
+        Usage(argc, argv, true);
+        exit(1);
+        break;
+    }
+  }
+
+  if ((argc - optind) == 0) {
+    fprintf(stderr, "%s: Missing minidump directory\n", argv[0]);
+    Usage(argc, argv, true);
+    exit(1);
+  }
+  if (options->symbol_cache_path.empty()) {
+    fprintf(stderr, "%s: Missing symbol cache directory\n", argv[0]);
+    Usage(argc, argv, true);
+    exit(1);
+  }
+  if (options->output_dir.empty()) {
+    fprintf(stderr, "%s: Missing output directory\n", argv[0]);
+    Usage(argc, argv, true);
+    exit(1);
+  }
+
+  options->minidump_dir = argv[optind];
+
+  for (int argi = optind + 1; argi < argc; ++argi)
+    options->symbol_paths.push_back(argv[argi]);
+}
+
+int main(int argc, const char* argv[]) {
+  Options options;
+  SetupOptions(argc, argv, &options);
+
+  // Increase the maximum number of threads and regions.
+  MinidumpThreadList::set_max_threads(std::numeric_limits<uint32_t>::max());
+  MinidumpMemoryList::set_max_regions(std::numeric_limits<uint32_t>::max());
+
+  return ProcessMinidumps(options) ? 0 : 1;
+}
@@ -32,10 +32,15 @@
 //
 // Author: Mark Mentovai
 
+#include <getopt.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <set>
+#include <string>
+
 #include "common/path_helper.h"
 #include "common/scoped_ptr.h"
 #include "google_breakpad/processor/minidump.h"
@@ -55,13 +60,34 @@ using google_breakpad::MinidumpMiscInfo;
 using google_breakpad::MinidumpBreakpadInfo;
 using google_breakpad::MinidumpCrashpadInfo;
 
+// The streams that can be chosen with --streams, in the order they're
+// printed.
+const char* const kStreamNames[] = {
+  "directory", "threads", "modules", "memory", "exception", "assertion",
+  "system_info", "misc_info", "breakpad_info", "memory_info",
+  "crashpad_info", "linux_cmd_line", "linux_environ", "linux_lsb_release",
+  "linux_proc_status", "linux_cpu_info", "linux_maps"
+};
+
 struct Options {
   Options()
-      : minidumpPath(), hexdump(false), hexdump_width(16) {}
+      : minidumpPath(), hexdump(false), hexdump_width(16),
+        memory_first(0), memory_last(UINT64_MAX) {}
 
   string minidumpPath;
   bool hexdump;
   unsigned int hexdump_width;
+
+  // The streams to print, or all of them if empty.
+  std::set<string> streams;
+
+  // The addresses of the memory to print from the memory list.
+  uint64_t memory_first;
+  uint64_t memory_last;
+
+  bool Wants(const char* stream) const {
+    return streams.empty() || streams.count(stream) != 0;
+  }
 };
 
 static void DumpRawStream(Minidump *minidump,
@@ -106,117 +132,154 @@ static void DumpRawStream(Minidump *minidump,
 static bool PrintMinidumpDump(const Options& options) {
   Minidump minidump(options.minidumpPath,
                     options.hexdump);
+  // Print memory in place from the mapped dump, rather than copying every
+  // region out of it, and read a region only as far as it's printed.
+  minidump.set_use_mmap(true);
+  minidump.set_load_memory_by_page(true);
   if (!minidump.Read()) {
     BPLOG(ERROR) << "minidump.Read() failed";
     return false;
   }
-  minidump.Print();
+  if (options.Wants("directory"))
+    minidump.Print();
 
   int errors = 0;
 
-  MinidumpThreadList *thread_list = minidump.GetThreadList();
-  if (!thread_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetThreadList() failed";
-  } else {
-    thread_list->Print();
+  if (options.Wants("threads")) {
+    MinidumpThreadList *thread_list = minidump.GetThreadList();
+    if (!thread_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetThreadList() failed";
+    } else {
+      thread_list->Print();
+    }
   }
 
-  // It's useful to be able to see the full list of modules here even if it
-  // would cause minidump_stackwalk to fail.
-  MinidumpModuleList::set_max_modules(UINT32_MAX);
-  MinidumpModuleList *module_list = minidump.GetModuleList();
-  if (!module_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetModuleList() failed";
-  } else {
-    module_list->Print();
+  if (options.Wants("modules")) {
+    // It's useful to be able to see the full list of modules here even if
+    // it would cause minidump_stackwalk to fail.
+    MinidumpModuleList::set_max_modules(UINT32_MAX);
+    MinidumpModuleList *module_list = minidump.GetModuleList();
+    if (!module_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetModuleList() failed";
+    } else {
+      module_list->Print();
+    }
   }
 
-  MinidumpMemoryList *memory_list = minidump.GetMemoryList();
-  if (!memory_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetMemoryList() failed";
-  } else {
-    memory_list->Print();
+  if (options.Wants("memory")) {
+    MinidumpMemoryList *memory_list = minidump.GetMemoryList();
+    if (!memory_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetMemoryList() failed";
+    } else {
+      memory_list->PrintRange(options.memory_first, options.memory_last);
+    }
   }
 
-  MinidumpException *exception = minidump.GetException();
-  if (!exception) {
-    BPLOG(INFO) << "minidump.GetException() failed";
-  } else {
-    exception->Print();
+  if (options.Wants("exception")) {
+    MinidumpException *exception = minidump.GetException();
+    if (!exception) {
+      BPLOG(INFO) << "minidump.GetException() failed";
+    } else {
+      exception->Print();
+    }
   }
 
-  MinidumpAssertion *assertion = minidump.GetAssertion();
-  if (!assertion) {
-    BPLOG(INFO) << "minidump.GetAssertion() failed";
-  } else {
-    assertion->Print();
+  if (options.Wants("assertion")) {
+    MinidumpAssertion *assertion = minidump.GetAssertion();
+    if (!assertion) {
+      BPLOG(INFO) << "minidump.GetAssertion() failed";
+    } else {
+      assertion->Print();
+    }
   }
 
-  MinidumpSystemInfo *system_info = minidump.GetSystemInfo();
-  if (!system_info) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetSystemInfo() failed";
-  } else {
-    system_info->Print();
+  if (options.Wants("system_info")) {
+    MinidumpSystemInfo *system_info = minidump.GetSystemInfo();
+    if (!system_info) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetSystemInfo() failed";
+    } else {
+      system_info->Print();
+    }
   }
 
-  MinidumpMiscInfo *misc_info = minidump.GetMiscInfo();
-  if (!misc_info) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetMiscInfo() failed";
-  } else {
-    misc_info->Print();
+  if (options.Wants("misc_info")) {
+    MinidumpMiscInfo *misc_info = minidump.GetMiscInfo();
+    if (!misc_info) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetMiscInfo() failed";
+    } else {
+      misc_info->Print();
+    }
   }
 
-  MinidumpBreakpadInfo *breakpad_info = minidump.GetBreakpadInfo();
-  if (!breakpad_info) {
-    // Breakpad info is optional, so don't treat this as an error.
-    BPLOG(INFO) << "minidump.GetBreakpadInfo() failed";
-  } else {
-    breakpad_info->Print();
+  if (options.Wants("breakpad_info")) {
+    MinidumpBreakpadInfo *breakpad_info = minidump.GetBreakpadInfo();
+    if (!breakpad_info) {
+      // Breakpad info is optional, so don't treat this as an error.
+      BPLOG(INFO) << "minidump.GetBreakpadInfo() failed";
+    } else {
+      breakpad_info->Print();
+    }
   }
 
-  MinidumpMemoryInfoList *memory_info_list = minidump.GetMemoryInfoList();
-  if (!memory_info_list) {
-    ++errors;
-    BPLOG(ERROR) << "minidump.GetMemoryInfoList() failed";
-  } else {
-    memory_info_list->Print();
+  if (options.Wants("memory_info")) {
+    MinidumpMemoryInfoList *memory_info_list = minidump.GetMemoryInfoList();
+    if (!memory_info_list) {
+      ++errors;
+      BPLOG(ERROR) << "minidump.GetMemoryInfoList() failed";
+    } else {
+      memory_info_list->Print();
+    }
   }
 
-  MinidumpCrashpadInfo *crashpad_info = minidump.GetCrashpadInfo();
-  if (crashpad_info) {
-    // Crashpad info is optional, so don't treat absence as an error.
-    crashpad_info->Print();
+  if (options.Wants("crashpad_info")) {
+    MinidumpCrashpadInfo *crashpad_info = minidump.GetCrashpadInfo();
+    if (crashpad_info) {
+      // Crashpad info is optional, so don't treat absence as an error.
+      crashpad_info->Print();
+    }
   }
 
-  DumpRawStream(&minidump,
-                MD_LINUX_CMD_LINE,
-                "MD_LINUX_CMD_LINE",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_ENVIRON,
-                "MD_LINUX_ENVIRON",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_LSB_RELEASE,
-                "MD_LINUX_LSB_RELEASE",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_PROC_STATUS,
-                "MD_LINUX_PROC_STATUS",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_CPU_INFO,
-                "MD_LINUX_CPU_INFO",
-                &errors);
-  DumpRawStream(&minidump,
-                MD_LINUX_MAPS,
-                "MD_LINUX_MAPS",
-                &errors);
+  if (options.Wants("linux_cmd_line")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_CMD_LINE,
+                  "MD_LINUX_CMD_LINE",
+                  &errors);
+  }
+  if (options.Wants("linux_environ")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_ENVIRON,
+                  "MD_LINUX_ENVIRON",
+                  &errors);
+  }
+  if (options.Wants("linux_lsb_release")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_LSB_RELEASE,
+                  "MD_LINUX_LSB_RELEASE",
+                  &errors);
+  }
+  if (options.Wants("linux_proc_status")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_PROC_STATUS,
+                  "MD_LINUX_PROC_STATUS",
+                  &errors);
+  }
+  if (options.Wants("linux_cpu_info")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_CPU_INFO,
+                  "MD_LINUX_CPU_INFO",
+                  &errors);
+  }
+  if (options.Wants("linux_maps")) {
+    DumpRawStream(&minidump,
+                  MD_LINUX_MAPS,
+                  "MD_LINUX_MAPS",
+                  &errors);
+  }
 
   return errors == 0;
 }
@@ -233,20 +296,95 @@ Usage(int argc, char *argv[], bool error) {
           "Options:\n"
           "  <minidump> should be a minidump.\n"
           "  -x:\t Display memory in a hexdump like format\n"
-          "  -h:\t Usage\n",
+          "  -s, --streams=<name>[,<name>...]:\n"
+          "\t Print only the named streams:",
           google_breakpad::BaseName(argv[0]).c_str());
+  for (size_t i = 0; i < sizeof(kStreamNames) / sizeof(kStreamNames[0]);
+       ++i) {
+    fprintf(fp, "%s%s", i % 6 == 0 ? "\n\t   " : " ", kStreamNames[i]);
+  }
+  fprintf(fp,
+          "\n"
+          "  -m, --memory=<start>-<end>:\n"
+          "\t Print only the memory list's memory from <start> up to,\n"
+          "\t but not including, <end>\n"
+          "  -h:\t Usage\n");
+}
+
+// Parses a comma-separated list of stream names into streams.  Returns
+// false if a name isn't one of kStreamNames.
+static bool ParseStreams(const char* list, std::set<string>* streams) {
+  string names(list);
+  size_t start = 0;
+  while (start <= names.size()) {
+    size_t comma = names.find(',', start);
+    if (comma == string::npos)
+      comma = names.size();
+    string name = names.substr(start, comma - start);
+    start = comma + 1;
+    if (name.empty())
+      continue;
+    bool known = false;
+    for (const char* stream : kStreamNames)
+      known |= name == stream;
+    if (!known) {
+      fprintf(stderr, "Unknown stream %s\n", name.c_str());
+      return false;
+    }
+    streams->insert(name);
+  }
+  return true;
+}
+
+// Parses "<start>-<end>", in any base strtoull accepts, into the first
+// and last addresses of the range.  Returns false if it's malformed or
+// empty.
+static bool ParseMemoryRange(const char* range, uint64_t* first,
+                             uint64_t* last) {
+  char* end;
+  uint64_t start = strtoull(range, &end, 0);
+  if (end == range || *end != '-')
+    return false;
+  const char* limit_start = end + 1;
+  uint64_t limit = strtoull(limit_start, &end, 0);
+  if (end == limit_start || *end != '\0' || limit <= start)
+    return false;
+  *first = start;
+  *last = limit - 1;
+  return true;
 }
 
 //=============================================================================
 static void
 SetupOptions(int argc, char *argv[], Options *options) {
+  static const struct option kLongOptions[] = {
+    {"streams", required_argument, NULL, 's'},
+    {"memory", required_argument, NULL, 'm'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+  };
   int ch;
 
-  while ((ch = getopt(argc, (char * const*)argv, "xh")) != -1) {
+  while ((ch = getopt_long(argc, (char * const*)argv, "xhs:m:",
+                           kLongOptions, NULL)) != -1) {
     switch (ch) {
       case 'x':
         options->hexdump = true;
         break;
+      case 's':
+        if (!ParseStreams(optarg, &options->streams)) {
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      case 'm':
+        if (!ParseMemoryRange(optarg, &options->memory_first,
+                              &options->memory_last)) {
+          fprintf(stderr, "Invalid memory range %s\n", optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
       case 'h':
         Usage(argc, argv, false);
         exit(0);
@@ -32,17 +32,29 @@
 #include <assert.h>
 
 #include <algorithm>
+#include <atomic>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "common/scoped_ptr.h"
 #include "common/stdio_wrapper.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/cancellation_token.h"
 #include "google_breakpad/processor/minidump.h"
 #include "google_breakpad/processor/process_state.h"
 #include "google_breakpad/processor/exploitability.h"
+#include "google_breakpad/processor/source_line_resolver_interface.h"
+#include "google_breakpad/processor/stack_frame.h"
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/basic_code_modules.h"
+#include "processor/call_stack_cache.h"
+#include "processor/frame_arena.h"
 #include "processor/logging.h"
+#include "processor/pathname_stripper.h"
+#include "processor/processor_metrics.h"
 #include "processor/stackwalker_x86.h"
 #include "processor/symbolic_constants_win.h"
 
@@ -53,7 +65,14 @@ MinidumpProcessor::MinidumpProcessor(SymbolSupplier* supplier,
     : frame_symbolizer_(new StackFrameSymbolizer(supplier, resolver)),
       own_frame_symbolizer_(true),
       enable_exploitability_(false),
-      enable_objdump_(false) {
+      enable_objdump_(false),
+      stackwalk_threads_(1),
+      symbolize_after_walking_(false),
+      symbol_prefetch_threads_(0),
+      symbol_preload_threads_(0),
+      metrics_(NULL),
+      cancellation_token_(NULL),
+      call_stack_cache_(NULL) {
 }
 
 MinidumpProcessor::MinidumpProcessor(SymbolSupplier* supplier,
@@ -62,7 +81,14 @@ MinidumpProcessor::MinidumpProcessor(SymbolSupplier* supplier,
     : frame_symbolizer_(new StackFrameSymbolizer(supplier, resolver)),
       own_frame_symbolizer_(true),
       enable_exploitability_(enable_exploitability),
-      enable_objdump_(false) {
+      enable_objdump_(false),
+      stackwalk_threads_(1),
+      symbolize_after_walking_(false),
+      symbol_prefetch_threads_(0),
+      symbol_preload_threads_(0),
+      metrics_(NULL),
+      cancellation_token_(NULL),
+      call_stack_cache_(NULL) {
 }
 
 MinidumpProcessor::MinidumpProcessor(StackFrameSymbolizer* frame_symbolizer,
@@ -70,7 +96,14 @@ MinidumpProcessor::MinidumpProcessor(StackFrameSymbolizer* frame_symbolizer,
     : frame_symbolizer_(frame_symbolizer),
       own_frame_symbolizer_(false),
       enable_exploitability_(enable_exploitability),
-      enable_objdump_(false) {
+      enable_objdump_(false),
+      stackwalk_threads_(1),
+      symbolize_after_walking_(false),
+      symbol_prefetch_threads_(0),
+      symbol_preload_threads_(0),
+      metrics_(NULL),
+      cancellation_token_(NULL),
+      call_stack_cache_(NULL) {
   assert(frame_symbolizer_);
 }
 
@@ -78,11 +111,155 @@ MinidumpProcessor::~MinidumpProcessor() {
   if (own_frame_symbolizer_) delete frame_symbolizer_;
 }
 
+void MinidumpProcessor::set_metrics(ProcessorMetrics* metrics) {
+  metrics_ = metrics;
+  frame_symbolizer_->set_metrics(metrics);
+}
+
+struct MinidumpProcessor::ThreadWalk {
+  string thread_string;
+  uint32_t thread_id;
+  MinidumpContext* context;
+  MinidumpMemoryRegion* memory;
+  CallStack* stack;
+  // The key of the stack in call_stack_cache_, or empty if it isn't
+  // looked up there.
+  string cache_key;
+  // Only used when walking stacks on several threads.
+  vector<const CodeModule*> modules_without_symbols;
+  vector<const CodeModule*> modules_with_corrupt_symbols;
+  bool interrupted;
+  // Whether the stack has been walked and is to be cached, and what its
+  // walk added to the module lists, to be cached with it.
+  bool cacheable;
+  vector<const CodeModule*> new_modules_without_symbols;
+  vector<const CodeModule*> new_modules_with_corrupt_symbols;
+  // Whether the stack's frames are left to symbolize after walking.
+  bool unsymbolized;
+};
+
+namespace {
+
+// Appends the modules in |modules| that aren't in |merged| yet to |merged|.
+void MergeModules(const vector<const CodeModule*>& modules,
+                  vector<const CodeModule*>* merged) {
+  for (size_t i = 0; i < modules.size(); ++i) {
+    if (std::find(merged->begin(), merged->end(), modules[i]) ==
+        merged->end()) {
+      merged->push_back(modules[i]);
+    }
+  }
+}
+
+// Returns true if the stack words of a thread with a context for |cpu| are
+// 64 bits wide.
+bool HasWideStackWords(uint32_t cpu) {
+  switch (cpu) {
+    case MD_CONTEXT_AMD64:
+    case MD_CONTEXT_ARM64:
+    case MD_CONTEXT_MIPS64:
+    case MD_CONTEXT_PPC64:
+    case MD_CONTEXT_SPARC:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Appends to |found| the modules in |modules| that the words of |memory|
+// point into and that |seen| doesn't hold yet, adding them to |seen|.
+template<typename Word>
+void FindStackModules(const MemoryRegion& memory,
+                      const CodeModules& modules,
+                      std::set<const CodeModule*>* seen,
+                      vector<const CodeModule*>* found) {
+  Word words[512];
+  const size_t kWordCount = sizeof(words) / sizeof(words[0]);
+  uint64_t address = memory.GetBase();
+  uint64_t end = address + memory.GetSize();
+  while (address + sizeof(Word) <= end) {
+    size_t count = std::min(kWordCount,
+                            static_cast<size_t>((end - address) /
+                                                sizeof(Word)));
+    count = memory.GetMemoryAtAddresses(address, words, count);
+    if (count == 0)
+      break;
+    for (size_t i = 0; i < count; ++i) {
+      const CodeModule* module = modules.GetModuleForAddress(words[i]);
+      if (module && seen->insert(module).second)
+        found->push_back(module);
+    }
+    address += count * sizeof(Word);
+  }
+}
+
+}  // namespace
+
+DeferredStackwalks::DeferredStackwalks()
+    : processor_(NULL),
+      process_state_(NULL),
+      walks_(new vector<MinidumpProcessor::ThreadWalk>()),
+      next_walk_(0) {
+}
+
+DeferredStackwalks::~DeferredStackwalks() {
+}
+
+void DeferredStackwalks::Clear() {
+  processor_ = NULL;
+  process_state_ = NULL;
+  walks_->clear();
+  next_walk_ = 0;
+}
+
+size_t DeferredStackwalks::remaining() const {
+  return walks_->size() - next_walk_;
+}
+
+ProcessResult DeferredStackwalks::Walk(size_t count) {
+  count = std::min(count, remaining());
+  if (count == 0) {
+    return PROCESS_OK;
+  }
+
+  MinidumpProcessor::ThreadWalk* walks = &(*walks_)[next_walk_];
+  next_walk_ += count;
+  if (!processor_->WalkThreads(process_state_, walks, count)) {
+    BPLOG(INFO) << "Deferred stackwalk interrupted";
+    return PROCESS_SYMBOL_SUPPLIER_INTERRUPTED;
+  }
+  if (processor_->IsCancelled()) {
+    BPLOG(INFO) << "Deferred stackwalk cancelled";
+    return PROCESS_CANCELLED;
+  }
+  return PROCESS_OK;
+}
+
 ProcessResult MinidumpProcessor::Process(
     Minidump* dump, ProcessState* process_state) {
+  return ProcessInternal(dump, process_state, NULL);
+}
+
+ProcessResult MinidumpProcessor::ProcessRequestingThread(
+    Minidump* dump,
+    ProcessState* process_state,
+    DeferredStackwalks* deferred) {
+  assert(deferred);
+  deferred->Clear();
+  return ProcessInternal(dump, process_state, deferred);
+}
+
+ProcessResult MinidumpProcessor::ProcessInternal(
+    Minidump* dump,
+    ProcessState* process_state,
+    DeferredStackwalks* deferred) {
   assert(dump);
   assert(process_state);
 
+  ProcessorMetrics::ScopedTimer timer(metrics_, ProcessorMetrics::PROCESS);
+  if (metrics_)
+    metrics_->Add(ProcessorMetrics::MINIDUMPS);
+
   process_state->Clear();
 
   const MDRawHeader* header = dump->header();
@@ -147,9 +324,11 @@ ProcessResult MinidumpProcessor::Process(
 
   // Put a copy of the module list into ProcessState object.  This is not
   // necessarily a MinidumpModuleList, but it adheres to the CodeModules
-  // interface, which is all that ProcessState needs to expose.
+  // interface, which is all that ProcessState needs to expose.  The copy
+  // reuses the storage of any the ProcessState held before.
   if (module_list) {
-    process_state->modules_ = module_list->Copy();
+    module_list->CopyTo(process_state->ModuleStorage());
+    process_state->modules_ = process_state->module_storage_;
     process_state->shrunk_range_modules_ =
         process_state->modules_->GetShrunkRangeModules();
     for (unsigned int i = 0;
@@ -169,11 +348,10 @@ ProcessResult MinidumpProcessor::Process(
     process_state->unloaded_modules_ = unloaded_module_list->Copy();
   }
 
-  MinidumpMemoryList* memory_list = dump->GetMemoryList();
-  if (memory_list) {
-    BPLOG(INFO) << "Found " << memory_list->region_count()
-                << " memory regions.";
-  }
+  // The memory list is only read if a thread's stack needs looking up in
+  // it, which keeps its index of every region out of the common case.
+  MinidumpMemoryList* memory_list = NULL;
+  bool memory_list_read = false;
 
   MinidumpThreadList* threads = dump->GetThreadList();
   if (!threads) {
@@ -199,6 +377,22 @@ ProcessResult MinidumpProcessor::Process(
   // Reset frame_symbolizer_ at the beginning of stackwalk for each minidump.
   frame_symbolizer_->Reset();
 
+  if (symbol_prefetch_threads_ > 0) {
+    frame_symbolizer_->PrefetchSymbols(process_state->modules_,
+                                       process_state->system_info(),
+                                       symbol_prefetch_threads_);
+  }
+
+  bool walk_concurrently = stackwalk_threads_ > 1;
+  if (walk_concurrently && !frame_symbolizer_->IsThreadSafe()) {
+    BPLOG(INFO) << "Stack frame symbolizer is not thread-safe, walking "
+                << "threads of " << dump->path() << " one at a time";
+    walk_concurrently = false;
+  }
+
+  // Everything that reads the minidump happens here, on this thread; the
+  // stacks are walked afterwards, possibly on several threads at once.
+  vector<ThreadWalk> walks;
   for (unsigned int thread_index = 0;
        thread_index < thread_count;
        ++thread_index) {
@@ -266,6 +460,14 @@ ProcessResult MinidumpProcessor::Process(
     // in the memory descriptor inside MINIDUMP_THREAD, try to locate and use
     // a memory region (containing the stack) from the minidump memory list.
     MinidumpMemoryRegion* thread_memory = thread->GetMemory();
+    if (!thread_memory && !memory_list_read) {
+      memory_list = dump->GetMemoryList();
+      memory_list_read = true;
+      if (memory_list) {
+        BPLOG(INFO) << "Found " << memory_list->region_count()
+                    << " memory regions.";
+      }
+    }
     if (!thread_memory && memory_list) {
       uint64_t start_stack_memory_range = thread->GetStartOfStackMemoryRange();
       if (start_stack_memory_range) {
@@ -275,49 +477,62 @@ ProcessResult MinidumpProcessor::Process(
     }
     if (!thread_memory) {
       BPLOG(ERROR) << "No memory region for " << thread_string;
+    } else if ((walk_concurrently || deferred) && context) {
+      // A region reads its contents from the minidump as they're used,
+      // which must not happen on the walking threads, or once Process
+      // returns.  Asking for all of it reads the whole region, even when
+      // the minidump would otherwise read it a page at a time.
+      size_t span_length;
+      thread_memory->GetMemorySpan(thread_memory->GetBase(),
+                                   thread_memory->GetSize(), &span_length);
     }
 
-    // Use process_state->modules_ instead of module_list, because the
-    // |modules| argument will be used to populate the |module| fields in
-    // the returned StackFrame objects, which will be placed into the
-    // returned ProcessState object.  module_list's lifetime is only as
-    // long as the Minidump object: it will be deleted when this function
-    // returns.  process_state->modules_ is owned by the ProcessState object
-    // (just like the StackFrame objects), and is much more suitable for this
-    // task.
-    scoped_ptr<Stackwalker> stackwalker(
-        Stackwalker::StackwalkerForCPU(process_state->system_info(),
-                                       context,
-                                       thread_memory,
-                                       process_state->modules_,
-                                       process_state->unloaded_modules_,
-                                       frame_symbolizer_));
-
-    scoped_ptr<CallStack> stack(new CallStack());
-    if (stackwalker.get()) {
-      if (!stackwalker->Walk(stack.get(),
-                             &process_state->modules_without_symbols_,
-                             &process_state->modules_with_corrupt_symbols_)) {
-        BPLOG(INFO) << "Stackwalker interrupt (missing symbols?) at "
-                    << thread_string;
-        interrupted = true;
-      }
-    } else {
-      // Threads with missing CPU contexts will hit this, but
-      // don't abort processing the rest of the dump just for
-      // one bad thread.
-      BPLOG(ERROR) << "No stackwalker for " << thread_string;
-    }
+    CallStack* stack = process_state->NewCallStack();
     stack->set_tid(thread_id);
-    process_state->threads_.push_back(stack.release());
+    process_state->threads_.push_back(stack);
     process_state->thread_memory_regions_.push_back(thread_memory);
+
+    ThreadWalk walk;
+    walk.thread_string = thread_string;
+    walk.thread_id = thread_id;
+    walk.context = context;
+    walk.memory = thread_memory;
+    walk.stack = stack;
+    walk.interrupted = false;
+    walk.cacheable = false;
+    walk.unsymbolized = false;
+    if (call_stack_cache_ && context && thread_memory &&
+        process_state->requesting_thread_ ==
+            static_cast<int>(process_state->threads_.size()) - 1) {
+      if (!CallStackCache::MakeKey(process_state->system_info_,
+                                   process_state->modules_,
+                                   process_state->unloaded_modules_, *context,
+                                   *thread_memory, &walk.cache_key)) {
+        walk.cache_key.clear();
+      }
+    }
+    walks.push_back(walk);
   }
 
+  if (!deferred) {
+    interrupted = !WalkThreads(process_state, walks.data(), walks.size());
+  } else if (found_requesting_thread) {
+    // Walk the requesting thread now, and hand the rest to |deferred|.
+    size_t requesting_walk = process_state->requesting_thread_;
+    interrupted = !WalkThreads(process_state, &walks[requesting_walk], 1);
+    walks.erase(walks.begin() + requesting_walk);
+  }
   if (interrupted) {
     BPLOG(INFO) << "Processing interrupted for " << dump->path();
     return PROCESS_SYMBOL_SUPPLIER_INTERRUPTED;
   }
 
+  if (deferred) {
+    deferred->processor_ = this;
+    deferred->process_state_ = process_state;
+    deferred->walks_->swap(walks);
+  }
+
   // If a requesting thread was indicated, it must be present.
   if (has_requesting_thread && !found_requesting_thread) {
     // Don't mark as an error, but invalidate the requesting thread
@@ -330,9 +545,16 @@ ProcessResult MinidumpProcessor::Process(
   // Exploitability defaults to EXPLOITABILITY_NOT_ANALYZED
   process_state->exploitability_ = EXPLOITABILITY_NOT_ANALYZED;
 
+  if (IsCancelled()) {
+    BPLOG(INFO) << "Processing cancelled for " << dump->path();
+    return PROCESS_CANCELLED;
+  }
+
   // If an exploitability run was requested we perform the platform specific
   // rating.
   if (enable_exploitability_) {
+    ProcessorMetrics::ScopedTimer timer(metrics_,
+                                        ProcessorMetrics::EXPLOITABILITY);
     scoped_ptr<Exploitability> exploitability(
         Exploitability::ExploitabilityForPlatform(dump,
                                                   process_state,
@@ -349,12 +571,272 @@ ProcessResult MinidumpProcessor::Process(
   return PROCESS_OK;
 }
 
+bool MinidumpProcessor::WalkThreads(ProcessState* process_state,
+                                    ThreadWalk* walks,
+                                    size_t count) {
+  if (symbol_preload_threads_ > 0)
+    PreloadSymbols(process_state, walks, count);
+
+  size_t stackwalk_threads = std::min(
+      static_cast<size_t>(std::max(stackwalk_threads_, 1)), count);
+  // Every walking thread carves the frames it creates out of the
+  // ProcessState's arena.
+  ScopedFrameArena frame_arena(process_state->frame_arena_);
+  bool completed = true;
+  if (stackwalk_threads <= 1 || !frame_symbolizer_->IsThreadSafe()) {
+    for (size_t i = 0; i < count; ++i) {
+      if (!WalkThread(process_state, &walks[i],
+                      &process_state->modules_without_symbols_,
+                      &process_state->modules_with_corrupt_symbols_)) {
+        completed = false;
+      }
+    }
+  } else {
+    // Each walking thread takes the next unwalked thread until none are
+    // left, and keeps the modules it finds to itself; they are merged in
+    // thread order below.
+    std::atomic<size_t> next_walk(0);
+    auto walk_threads = [&]() {
+      ScopedFrameArena thread_frame_arena(process_state->frame_arena_);
+      size_t i;
+      while ((i = next_walk++) < count) {
+        ThreadWalk* walk = &walks[i];
+        walk->interrupted =
+            !WalkThread(process_state, walk, &walk->modules_without_symbols,
+                        &walk->modules_with_corrupt_symbols);
+      }
+    };
+    vector<std::thread> workers;
+    for (size_t i = 1; i < stackwalk_threads; ++i) {
+      workers.push_back(std::thread(walk_threads));
+    }
+    walk_threads();
+    for (size_t i = 0; i < workers.size(); ++i) {
+      workers[i].join();
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      completed &= !walks[i].interrupted;
+      MergeModules(walks[i].modules_without_symbols,
+                   &process_state->modules_without_symbols_);
+      MergeModules(walks[i].modules_with_corrupt_symbols,
+                   &process_state->modules_with_corrupt_symbols_);
+    }
+  }
+
+  if (symbolize_after_walking_) {
+    vector<CallStack*> stacks;
+    for (size_t i = 0; i < count; ++i) {
+      if (walks[i].unsymbolized)
+        stacks.push_back(walks[i].stack);
+    }
+    {
+      ProcessorMetrics::ScopedTimer timer(metrics_,
+                                          ProcessorMetrics::STACKWALK);
+      Stackwalker::SymbolizeStacks(stacks.data(), stacks.size(),
+                                   frame_symbolizer_,
+                                   process_state->system_info(),
+                                   stackwalk_threads_);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      if (walks[i].unsymbolized) {
+        AddFramePointerModules(process_state, &walks[i]);
+        walks[i].unsymbolized = false;
+        FinishWalk(process_state, walks[i]);
+      }
+    }
+  }
+  return completed;
+}
+
+bool MinidumpProcessor::WalkThread(
+    ProcessState* process_state,
+    ThreadWalk* walk,
+    vector<const CodeModule*>* modules_without_symbols,
+    vector<const CodeModule*>* modules_with_corrupt_symbols) {
+  if (IsCancelled()) {
+    // Leave the stack empty; Process reports the cancellation.
+    return true;
+  }
+
+  // Use process_state->modules_ instead of module_list, because the
+  // |modules| argument will be used to populate the |module| fields in
+  // the returned StackFrame objects, which will be placed into the
+  // returned ProcessState object.  module_list's lifetime is only as
+  // long as the Minidump object: it will be deleted when Process
+  // returns.  process_state->modules_ is owned by the ProcessState object
+  // (just like the StackFrame objects), and is much more suitable for this
+  // task.
+  ProcessorMetrics::ScopedTimer timer(metrics_, ProcessorMetrics::STACKWALK);
+  if (!walk->cache_key.empty() &&
+      call_stack_cache_->Find(walk->cache_key, process_state->modules_,
+                              process_state->unloaded_modules_, walk->stack,
+                              modules_without_symbols,
+                              modules_with_corrupt_symbols)) {
+    walk->stack->set_tid(walk->thread_id);
+    CountFrames(*walk->stack);
+    return true;
+  }
+
+  // What this walk adds to the module lists is cached with its stack.
+  size_t old_modules_without_symbols = modules_without_symbols->size();
+  size_t old_modules_with_corrupt_symbols =
+      modules_with_corrupt_symbols->size();
+  scoped_ptr<Stackwalker> stackwalker(
+      Stackwalker::StackwalkerForCPU(process_state->system_info(),
+                                     walk->context,
+                                     walk->memory,
+                                     process_state->modules_,
+                                     process_state->unloaded_modules_,
+                                     frame_symbolizer_));
+
+  bool completed = true;
+  if (stackwalker.get()) {
+    stackwalker->set_cancellation_token(cancellation_token_);
+    stackwalker->set_defer_symbolization(symbolize_after_walking_);
+    if (!frame_pointer_modules_.empty())
+      stackwalker->set_frame_pointer_modules(&frame_pointer_modules_);
+    if (!stackwalker->Walk(walk->stack, modules_without_symbols,
+                           modules_with_corrupt_symbols)) {
+      BPLOG(INFO) << "Stackwalker interrupt (missing symbols?) at "
+                  << walk->thread_string;
+      completed = false;
+    }
+  } else {
+    // Threads with missing CPU contexts will hit this, but
+    // don't abort processing the rest of the dump just for
+    // one bad thread.
+    BPLOG(ERROR) << "No stackwalker for " << walk->thread_string;
+  }
+  walk->stack->set_tid(walk->thread_id);
+
+  // A walk cut short by the supplier is left out of the cache.
+  walk->cacheable = !walk->cache_key.empty() && stackwalker.get() &&
+      completed;
+  if (walk->cacheable) {
+    walk->new_modules_without_symbols.assign(
+        modules_without_symbols->begin() + old_modules_without_symbols,
+        modules_without_symbols->end());
+    walk->new_modules_with_corrupt_symbols.assign(
+        modules_with_corrupt_symbols->begin() +
+            old_modules_with_corrupt_symbols,
+        modules_with_corrupt_symbols->end());
+  }
+
+  if (symbolize_after_walking_ && stackwalker.get()) {
+    walk->unsymbolized = true;
+  } else {
+    FinishWalk(process_state, *walk);
+  }
+  return completed;
+}
+
+void MinidumpProcessor::FinishWalk(ProcessState* process_state,
+                                   const ThreadWalk& walk) {
+  // A walk cut short by cancellation is left out of the cache too.
+  if (walk.cacheable && !IsCancelled()) {
+    call_stack_cache_->Insert(
+        walk.cache_key, walk.context->GetContextCPU(),
+        process_state->modules_, process_state->unloaded_modules_,
+        *walk.stack, walk.new_modules_without_symbols,
+        walk.new_modules_with_corrupt_symbols);
+  }
+  CountFrames(*walk.stack);
+}
+
+void MinidumpProcessor::AddFramePointerModules(ProcessState* process_state,
+                                               ThreadWalk* walk) {
+  SourceLineResolverInterface* resolver = frame_symbolizer_->resolver();
+  if (frame_pointer_modules_.empty() || !resolver)
+    return;
+  vector<const CodeModule*> without_symbols;
+  vector<const CodeModule*> with_corrupt_symbols;
+  const vector<StackFrame*>* frames = walk->stack->frames();
+  for (size_t i = 0; i < frames->size(); ++i) {
+    const CodeModule* module = (*frames)[i]->module;
+    if (!module || !frame_pointer_modules_.count(
+                       PathnameStripper::File(module->code_file()))) {
+      continue;
+    }
+    if (!resolver->HasModule(module))
+      without_symbols.push_back(module);
+    else if (resolver->IsModuleCorrupt(module))
+      with_corrupt_symbols.push_back(module);
+  }
+  MergeModules(without_symbols, &process_state->modules_without_symbols_);
+  MergeModules(with_corrupt_symbols,
+               &process_state->modules_with_corrupt_symbols_);
+  if (walk->cacheable) {
+    MergeModules(without_symbols, &walk->new_modules_without_symbols);
+    MergeModules(with_corrupt_symbols,
+                 &walk->new_modules_with_corrupt_symbols);
+  }
+}
+
+void MinidumpProcessor::PreloadSymbols(ProcessState* process_state,
+                                       const ThreadWalk* walks,
+                                       size_t count) {
+  const CodeModules* modules = process_state->modules_;
+  if (!modules || modules->module_count() == 0)
+    return;
+
+  // The modules are preloaded in the order the stacks refer to them, the
+  // instruction pointers' first.
+  std::set<const CodeModule*> seen;
+  vector<const CodeModule*> found;
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t instruction;
+    if (!walks[i].context ||
+        !walks[i].context->GetInstructionPointer(&instruction)) {
+      continue;
+    }
+    const CodeModule* module = modules->GetModuleForAddress(instruction);
+    if (module && seen.insert(module).second)
+      found.push_back(module);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (!walks[i].context || !walks[i].memory)
+      continue;
+    if (HasWideStackWords(walks[i].context->GetContextCPU())) {
+      FindStackModules<uint64_t>(*walks[i].memory, *modules, &seen, &found);
+    } else {
+      FindStackModules<uint32_t>(*walks[i].memory, *modules, &seen, &found);
+    }
+  }
+
+  BPLOG(INFO) << "Preloading symbols for " << found.size() << " of "
+              << modules->module_count() << " modules";
+  frame_symbolizer_->PrefetchModuleSymbols(found,
+                                           process_state->system_info(),
+                                           symbol_preload_threads_);
+}
+
+void MinidumpProcessor::CountFrames(const CallStack& stack) {
+  if (!metrics_)
+    return;
+  metrics_->Add(ProcessorMetrics::THREADS);
+  const vector<StackFrame*>* frames = stack.frames();
+  for (size_t i = 0; i < frames->size(); ++i) {
+    metrics_->Add(static_cast<ProcessorMetrics::Counter>(
+        ProcessorMetrics::FRAMES_NONE + (*frames)[i]->trust));
+  }
+}
+
+bool MinidumpProcessor::IsCancelled() const {
+  return cancellation_token_ && cancellation_token_->IsCancelled();
+}
+
 ProcessResult MinidumpProcessor::Process(
     const string& minidump_file, ProcessState* process_state) {
   BPLOG(INFO) << "Processing minidump in file " << minidump_file;
 
   Minidump dump(minidump_file);
-  if (!dump.Read()) {
+  bool read;
+  {
+    ProcessorMetrics::ScopedTimer timer(metrics_, ProcessorMetrics::READ);
+    read = dump.Read();
+  }
+  if (!read) {
      BPLOG(ERROR) << "Minidump " << dump.path() << " could not be read";
      return PROCESS_ERROR_MINIDUMP_NOT_FOUND;
   }
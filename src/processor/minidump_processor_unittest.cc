@@ -32,10 +32,15 @@
 
 #include <stdlib.h>
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <utility>
 
 #include "breakpad_googletest_includes.h"
@@ -43,6 +48,7 @@
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
 #include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/cancellation_token.h"
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/code_modules.h"
 #include "google_breakpad/processor/minidump.h"
@@ -51,9 +57,12 @@
 #include "google_breakpad/processor/stack_frame.h"
 #include "google_breakpad/processor/symbol_supplier.h"
 #include "processor/logging.h"
+#include "processor/processor_metrics.h"
 #include "processor/stackwalker_unittest_utils.h"
+#include "processor/synth_minidump.h"
 
 using std::map;
+using std::vector;
 
 namespace google_breakpad {
 class MockMinidump : public Minidump {
@@ -139,6 +148,11 @@ class MockMinidumpMemoryRegion : public MinidumpMemoryRegion {
   bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const {
     return region_.GetMemoryAtAddress(address, value);
   }
+  const uint8_t* GetMemorySpan(uint64_t address, size_t length,
+                               size_t* span_length) const {
+    return region_.GetMemorySpan(address, length, span_length);
+  }
+  bool IsByteSwapped() const { return region_.IsByteSwapped(); }
 
   MockMemoryRegion region_;
 };
@@ -160,7 +174,11 @@ namespace {
 
 using google_breakpad::BasicSourceLineResolver;
 using google_breakpad::CallStack;
+using google_breakpad::CancellationToken;
 using google_breakpad::CodeModule;
+using google_breakpad::CodeModules;
+using google_breakpad::DeferredStackwalks;
+using google_breakpad::Minidump;
 using google_breakpad::MinidumpContext;
 using google_breakpad::MinidumpMemoryRegion;
 using google_breakpad::MinidumpMiscInfo;
@@ -176,8 +194,16 @@ using google_breakpad::MockMinidumpThreadList;
 using google_breakpad::MockMinidumpUnloadedModule;
 using google_breakpad::MockMinidumpUnloadedModuleList;
 using google_breakpad::ProcessState;
+using google_breakpad::ProcessorMetrics;
 using google_breakpad::scoped_ptr;
+using google_breakpad::StackFrame;
 using google_breakpad::SymbolSupplier;
+using google_breakpad::SynthMinidump::Context;
+using google_breakpad::SynthMinidump::Dump;
+using google_breakpad::SynthMinidump::Exception;
+using google_breakpad::SynthMinidump::Memory;
+using google_breakpad::SynthMinidump::String;
+using google_breakpad::SynthMinidump::Thread;
 using google_breakpad::SystemInfo;
 using ::testing::_;
 using ::testing::AnyNumber;
@@ -187,6 +213,8 @@ using ::testing::Ne;
 using ::testing::Property;
 using ::testing::Return;
 using ::testing::SetArgumentPointee;
+using google_breakpad::test_assembler::kLittleEndian;
+using std::istringstream;
 
 static const char* kSystemInfoOS = "Windows NT";
 static const char* kSystemInfoOSShort = "windows";
@@ -315,6 +343,50 @@ void TestSymbolSupplier::FreeSymbolData(const CodeModule* module) {
   }
 }
 
+// A TestSymbolSupplier that may be called from several threads at once,
+// taking a while over each fetch, as a supplier fetching from remote
+// storage would.  It counts the fetches of each module, and the most it was
+// asked for at once.
+class SlowTestSymbolSupplier : public TestSymbolSupplier {
+ public:
+  SlowTestSymbolSupplier() : fetching_(0), most_fetching_(0) {}
+
+  virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
+                                            const SystemInfo* system_info,
+                                            string* symbol_file,
+                                            char** symbol_data,
+                                            size_t* symbol_data_size) {
+    int fetching = ++fetching_;
+    int most_fetching = most_fetching_;
+    while (fetching > most_fetching &&
+           !most_fetching_.compare_exchange_weak(most_fetching, fetching)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    --fetching_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++fetches_[module->code_file()];
+    return TestSymbolSupplier::GetCStringSymbolData(
+        module, system_info, symbol_file, symbol_data, symbol_data_size);
+  }
+
+  virtual void FreeSymbolData(const CodeModule* module) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TestSymbolSupplier::FreeSymbolData(module);
+  }
+
+  virtual bool IsThreadSafe() { return true; }
+
+  const map<string, int>& fetches() const { return fetches_; }
+  int most_fetching() const { return most_fetching_; }
+
+ private:
+  std::atomic<int> fetching_;
+  std::atomic<int> most_fetching_;
+  std::mutex mutex_;
+  map<string, int> fetches_;
+};
+
 // A test system info stream, just returns values from the
 // MDRawSystemInfo fed to it.
 class TestMinidumpSystemInfo : public MinidumpSystemInfo {
@@ -367,9 +439,10 @@ TEST_F(MinidumpProcessorTest, TestUnloadedModules) {
   EXPECT_CALL(dump, GetUnloadedModuleList()).
       WillOnce(Return(&unloaded_module_list));
 
+  // The memory list is only consulted for threads missing their stacks.
   MockMinidumpMemoryList memory_list;
   EXPECT_CALL(dump, GetMemoryList()).
-      WillOnce(Return(&memory_list));
+      WillRepeatedly(Return(&memory_list));
 
   MockMinidumpThreadList thread_list;
   EXPECT_CALL(dump, GetThreadList()).
@@ -705,9 +778,10 @@ TEST_F(MinidumpProcessorTest, TestThreadMissingContext) {
   EXPECT_CALL(dump, GetThreadList()).
       WillOnce(Return(&thread_list));
 
+  // The memory list is only consulted for threads missing their stacks.
   MockMinidumpMemoryList memory_list;
   EXPECT_CALL(dump, GetMemoryList()).
-      WillOnce(Return(&memory_list));
+      WillRepeatedly(Return(&memory_list));
 
   // Return a thread missing a thread context.
   MockMinidumpThread no_context_thread;
@@ -741,6 +815,438 @@ TEST_F(MinidumpProcessorTest, TestThreadMissingContext) {
   ASSERT_EQ(0U, state.threads()->at(0)->frames()->size());
 }
 
+TEST_F(MinidumpProcessorTest, TestStackwalkThreads) {
+  MockMinidump dump;
+  EXPECT_CALL(dump, path()).WillRepeatedly(Return("mock minidump"));
+  EXPECT_CALL(dump, Read()).WillRepeatedly(Return(true));
+
+  MDRawHeader fake_header;
+  fake_header.time_date_stamp = 0;
+  EXPECT_CALL(dump, header()).WillRepeatedly(Return(&fake_header));
+
+  MDRawSystemInfo raw_system_info;
+  memset(&raw_system_info, 0, sizeof(raw_system_info));
+  raw_system_info.processor_architecture = MD_CPU_ARCHITECTURE_X86;
+  raw_system_info.platform_id = MD_OS_WIN32_NT;
+  TestMinidumpSystemInfo dump_system_info(raw_system_info);
+  EXPECT_CALL(dump, GetSystemInfo()).
+      WillRepeatedly(Return(&dump_system_info));
+
+  MockMinidumpThreadList thread_list;
+  EXPECT_CALL(dump, GetThreadList()).
+      WillRepeatedly(Return(&thread_list));
+
+  // Every thread gets a context with its own instruction pointer, and
+  // some stack memory.
+  const int kThreadCount = 16;
+  const uint32_t kStackBase = 0x10000;
+  MockMinidumpThread threads[kThreadCount];
+  scoped_ptr<TestMinidumpContext> contexts[kThreadCount];
+  scoped_ptr<MockMinidumpMemoryRegion> stacks[kThreadCount];
+  for (int i = 0; i < kThreadCount; ++i) {
+    MDRawContextX86 raw_context;
+    memset(&raw_context, 0, sizeof(raw_context));
+    raw_context.context_flags = MD_CONTEXT_X86_FULL;
+    raw_context.eip = 0x40000000 + i;
+    raw_context.esp = kStackBase;
+    contexts[i].reset(new TestMinidumpContext(raw_context));
+    stacks[i].reset(new MockMinidumpMemoryRegion(kStackBase,
+                                                 string(64, 'a' + i)));
+
+    EXPECT_CALL(threads[i], GetThreadID(_)).
+      WillRepeatedly(DoAll(SetArgumentPointee<0>(100 + i),
+                           Return(true)));
+    EXPECT_CALL(threads[i], GetContext()).
+      WillRepeatedly(Return(contexts[i].get()));
+    EXPECT_CALL(threads[i], GetMemory()).
+      WillRepeatedly(Return(stacks[i].get()));
+    EXPECT_CALL(thread_list, GetThreadAtIndex(i)).
+      WillRepeatedly(Return(&threads[i]));
+  }
+  EXPECT_CALL(thread_list, thread_count()).
+    WillRepeatedly(Return(kThreadCount));
+
+  // With no resolver, the default symbolizer is thread-safe, so the
+  // threads really are walked at once; the result must not depend on it.
+  for (int stackwalk_threads = 1; stackwalk_threads <= 8;
+       stackwalk_threads *= 2) {
+    MinidumpProcessor processor(reinterpret_cast<SymbolSupplier*>(NULL),
+                                NULL);
+    processor.set_stackwalk_threads(stackwalk_threads);
+    ProcessState state;
+    ASSERT_EQ(google_breakpad::PROCESS_OK, processor.Process(&dump, &state));
+
+    ASSERT_EQ(static_cast<size_t>(kThreadCount), state.threads()->size());
+    ASSERT_EQ(static_cast<size_t>(kThreadCount),
+              state.thread_memory_regions()->size());
+    for (int i = 0; i < kThreadCount; ++i) {
+      CallStack* stack = state.threads()->at(i);
+      EXPECT_EQ(static_cast<uint32_t>(100 + i), stack->tid());
+      ASSERT_LE(1U, stack->frames()->size());
+      EXPECT_EQ(0x40000000U + i, stack->frames()->at(0)->instruction);
+      EXPECT_EQ(stacks[i].get(), state.thread_memory_regions()->at(i));
+    }
+  }
+}
+
+TEST_F(MinidumpProcessorTest, TestStackwalkThreadsSerialFallback) {
+  // BasicSourceLineResolver doesn't allow concurrent lookups, so asking for
+  // several stackwalk threads walks them one at a time, to the same result.
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+  processor.set_stackwalk_threads(4);
+
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_EQ(state.threads()->size(), size_t(1));
+  CallStack* stack = state.threads()->at(0);
+  ASSERT_EQ(stack->frames()->size(), 4U);
+  ASSERT_EQ(stack->frames()->at(0)->function_name,
+            "`anonymous namespace'::CrashFunction");
+  ASSERT_EQ(stack->frames()->at(1)->function_name, "main");
+}
+
+TEST_F(MinidumpProcessorTest, TestSymbolizeAfterWalking) {
+  // Symbolizing once all stacks are walked gives the same stacks, and finds
+  // the same modules without symbols, as symbolizing during the walk.
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+  ProcessState states[2];
+  for (int symbolize_after_walking = 0; symbolize_after_walking < 2;
+       ++symbolize_after_walking) {
+    TestSymbolSupplier supplier;
+    BasicSourceLineResolver resolver;
+    MinidumpProcessor processor(&supplier, &resolver);
+    processor.set_symbolize_after_walking(symbolize_after_walking != 0);
+    ASSERT_EQ(google_breakpad::PROCESS_OK,
+              processor.Process(minidump_file,
+                                &states[symbolize_after_walking]));
+  }
+
+  ASSERT_EQ(states[0].threads()->size(), states[1].threads()->size());
+  for (size_t i = 0; i < states[0].threads()->size(); ++i) {
+    const vector<StackFrame*>* frames = states[0].threads()->at(i)->frames();
+    const vector<StackFrame*>* deferred_frames =
+        states[1].threads()->at(i)->frames();
+    ASSERT_EQ(frames->size(), deferred_frames->size());
+    for (size_t j = 0; j < frames->size(); ++j) {
+      const StackFrame* frame = frames->at(j);
+      const StackFrame* deferred_frame = deferred_frames->at(j);
+      EXPECT_EQ(frame->instruction, deferred_frame->instruction);
+      EXPECT_EQ(frame->trust, deferred_frame->trust);
+      ASSERT_EQ(frame->module == NULL, deferred_frame->module == NULL);
+      if (frame->module) {
+        EXPECT_EQ(frame->module->code_file(),
+                  deferred_frame->module->code_file());
+      }
+      EXPECT_EQ(frame->function_name, deferred_frame->function_name);
+      EXPECT_EQ(frame->function_base, deferred_frame->function_base);
+      EXPECT_EQ(frame->source_file_name, deferred_frame->source_file_name);
+      EXPECT_EQ(frame->source_line, deferred_frame->source_line);
+    }
+  }
+  EXPECT_EQ("`anonymous namespace'::CrashFunction",
+            states[1].threads()->at(0)->frames()->at(0)->function_name);
+  EXPECT_EQ(states[0].modules_without_symbols()->size(),
+            states[1].modules_without_symbols()->size());
+}
+
+TEST_F(MinidumpProcessorTest, TestReuseAcrossDumps) {
+  // A Minidump and ProcessState reused for another dump, and then the
+  // first again, give the same results as fresh ones, in the same storage.
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(reinterpret_cast<SymbolSupplier*>(NULL),
+                              &resolver);
+  const string files[] = {
+    GetTestDataPath() + "minidump2.dmp",
+    GetTestDataPath() + "linux_inline.dmp",
+    GetTestDataPath() + "minidump2.dmp",
+  };
+
+  Minidump dump((string()));
+  ProcessState state;
+  const CodeModules* first_modules = NULL;
+  const StackFrame* first_frame = NULL;
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+    dump.Reset(files[i]);
+    ASSERT_TRUE(dump.Read());
+    ASSERT_EQ(google_breakpad::PROCESS_OK, processor.Process(&dump, &state));
+
+    ProcessState fresh_state;
+    ASSERT_EQ(google_breakpad::PROCESS_OK,
+              processor.Process(files[i], &fresh_state));
+    EXPECT_EQ(fresh_state.crash_reason(), state.crash_reason());
+    EXPECT_EQ(fresh_state.crash_address(), state.crash_address());
+    EXPECT_EQ(fresh_state.requesting_thread(), state.requesting_thread());
+    EXPECT_EQ(fresh_state.thread_memory_regions()->size(),
+              state.thread_memory_regions()->size());
+    ASSERT_EQ(fresh_state.modules()->module_count(),
+              state.modules()->module_count());
+    ASSERT_EQ(fresh_state.threads()->size(), state.threads()->size());
+    for (size_t j = 0; j < state.threads()->size(); ++j) {
+      const vector<StackFrame*>* frames = state.threads()->at(j)->frames();
+      const vector<StackFrame*>* fresh_frames =
+          fresh_state.threads()->at(j)->frames();
+      ASSERT_EQ(fresh_frames->size(), frames->size());
+      for (size_t k = 0; k < frames->size(); ++k) {
+        EXPECT_EQ(fresh_frames->at(k)->instruction,
+                  frames->at(k)->instruction);
+        EXPECT_EQ(fresh_frames->at(k)->function_name,
+                  frames->at(k)->function_name);
+      }
+    }
+
+    if (i == 0) {
+      first_modules = state.modules();
+      first_frame = state.threads()->at(0)->frames()->at(0);
+    } else {
+      EXPECT_EQ(first_modules, state.modules());
+    }
+  }
+  // The frames were carved out of the same arena blocks as the first time.
+  EXPECT_EQ(first_frame, state.threads()->at(0)->frames()->at(0));
+}
+
+TEST_F(MinidumpProcessorTest, TestSymbolPrefetch) {
+  // Prefetching fetches every module's symbols once, several at a time,
+  // leaving nothing for the walk to fetch, and the same stack as without.
+  SlowTestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+  processor.set_symbol_prefetch_threads(4);
+
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_EQ(state.modules()->module_count(), supplier.fetches().size());
+  for (map<string, int>::const_iterator it = supplier.fetches().begin();
+       it != supplier.fetches().end(); ++it) {
+    EXPECT_EQ(1, it->second) << it->first;
+  }
+  EXPECT_LT(1, supplier.most_fetching());
+
+  ASSERT_EQ(state.threads()->size(), size_t(1));
+  CallStack* stack = state.threads()->at(0);
+  ASSERT_EQ(stack->frames()->size(), 4U);
+  ASSERT_EQ(stack->frames()->at(0)->function_name,
+            "`anonymous namespace'::CrashFunction");
+  ASSERT_EQ(stack->frames()->at(1)->function_name, "main");
+}
+
+TEST_F(MinidumpProcessorTest, TestSymbolPreload) {
+  // Preloading fetches the symbols of the modules the stack refers to once
+  // each, several at a time, and no others, leaving the same stack as
+  // without.
+  SlowTestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+  processor.set_symbol_preload_threads(4);
+
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  ASSERT_LT(1U, supplier.fetches().size());
+  ASSERT_GT(state.modules()->module_count(), supplier.fetches().size());
+  for (map<string, int>::const_iterator it = supplier.fetches().begin();
+       it != supplier.fetches().end(); ++it) {
+    EXPECT_EQ(1, it->second) << it->first;
+  }
+  EXPECT_LT(1, supplier.most_fetching());
+
+  ASSERT_EQ(state.threads()->size(), size_t(1));
+  CallStack* stack = state.threads()->at(0);
+  ASSERT_EQ(stack->frames()->size(), 4U);
+  for (size_t i = 0; i < stack->frames()->size(); ++i) {
+    const CodeModule* module = stack->frames()->at(i)->module;
+    ASSERT_TRUE(module);
+    EXPECT_EQ(1U, supplier.fetches().count(module->code_file()))
+        << module->code_file();
+  }
+  ASSERT_EQ(stack->frames()->at(0)->function_name,
+            "`anonymous namespace'::CrashFunction");
+  ASSERT_EQ(stack->frames()->at(1)->function_name, "main");
+}
+
+TEST_F(MinidumpProcessorTest, TestMetrics) {
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+  ProcessorMetrics metrics;
+  processor.set_metrics(&metrics);
+
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  ProcessState state;
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  EXPECT_EQ(1U, metrics.count(ProcessorMetrics::MINIDUMPS));
+  EXPECT_EQ(1U, metrics.count(ProcessorMetrics::THREADS));
+  EXPECT_EQ(1U, metrics.count(ProcessorMetrics::FRAMES_CONTEXT));
+  EXPECT_EQ(3U, metrics.count(ProcessorMetrics::FRAMES_CFI) +
+                metrics.count(ProcessorMetrics::FRAMES_FP) +
+                metrics.count(ProcessorMetrics::FRAMES_SCAN) +
+                metrics.count(ProcessorMetrics::FRAMES_CFI_SCAN));
+  EXPECT_LE(1U, metrics.count(ProcessorMetrics::SYMBOLS_FOUND));
+  EXPECT_EQ(metrics.count(ProcessorMetrics::SYMBOLS_FOUND) +
+            metrics.count(ProcessorMetrics::SYMBOLS_NOT_FOUND),
+            metrics.timer_count(ProcessorMetrics::SYMBOL_FETCH));
+  EXPECT_EQ(metrics.count(ProcessorMetrics::SYMBOLS_FOUND),
+            metrics.timer_count(ProcessorMetrics::MODULE_LOAD));
+  EXPECT_EQ(1U, metrics.timer_count(ProcessorMetrics::READ));
+  EXPECT_EQ(1U, metrics.timer_count(ProcessorMetrics::PROCESS));
+  EXPECT_EQ(1U, metrics.timer_count(ProcessorMetrics::STACKWALK));
+  EXPECT_EQ(0U, metrics.timer_count(ProcessorMetrics::EXPLOITABILITY));
+  EXPECT_LE(metrics.total_microseconds(ProcessorMetrics::STACKWALK),
+            metrics.total_microseconds(ProcessorMetrics::PROCESS));
+
+  // Processing without metrics leaves them alone.
+  processor.set_metrics(NULL);
+  ASSERT_EQ(processor.Process(minidump_file, &state),
+            google_breakpad::PROCESS_OK);
+  EXPECT_EQ(1U, metrics.count(ProcessorMetrics::MINIDUMPS));
+}
+
+TEST_F(MinidumpProcessorTest, TestCancellation) {
+  TestSymbolSupplier supplier;
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(&supplier, &resolver);
+  CancellationToken token;
+  processor.set_cancellation_token(&token);
+
+  string minidump_file = GetTestDataPath() + "minidump2.dmp";
+
+  // A cancelled token leaves every thread there, but unwalked.
+  token.Cancel();
+  ProcessState state;
+  ASSERT_EQ(google_breakpad::PROCESS_CANCELLED,
+            processor.Process(minidump_file, &state));
+  EXPECT_FALSE(MinidumpProcessor::IsErrorUnrecoverable(
+      google_breakpad::PROCESS_CANCELLED));
+  ASSERT_EQ(1U, state.threads()->size());
+  EXPECT_EQ(0U, state.threads()->at(0)->frames()->size());
+  ASSERT_TRUE(state.modules());
+  EXPECT_LT(0U, state.modules()->module_count());
+
+  // So does a deadline that has passed.
+  token.Reset();
+  token.set_deadline(CancellationToken::Clock::now());
+  ASSERT_EQ(google_breakpad::PROCESS_CANCELLED,
+            processor.Process(minidump_file, &state));
+  EXPECT_EQ(0U, state.threads()->at(0)->frames()->size());
+
+  // One that hasn't passed yet changes nothing.
+  token.Reset();
+  token.set_timeout(std::chrono::hours(1));
+  ASSERT_EQ(google_breakpad::PROCESS_OK,
+            processor.Process(minidump_file, &state));
+  EXPECT_EQ(4U, state.threads()->at(0)->frames()->size());
+}
+
+TEST_F(MinidumpProcessorTest, TestProcessRequestingThread) {
+  // A dump of four threads, the third of which crashed.
+  Dump dump(0, kLittleEndian);
+  String csd_version(dump,
+      google_breakpad::SynthMinidump::SystemInfo::windows_x86_csd_version);
+  google_breakpad::SynthMinidump::SystemInfo system_info(
+      dump, google_breakpad::SynthMinidump::SystemInfo::windows_x86,
+      csd_version);
+  dump.Add(&csd_version);
+  dump.Add(&system_info);
+
+  const int kThreadCount = 4;
+  const uint32_t kCrashedThreadId = 0x1002;
+  const uint32_t kCrashEIP = 0x40001234;
+  scoped_ptr<Memory> stacks[kThreadCount];
+  scoped_ptr<Context> contexts[kThreadCount];
+  scoped_ptr<Thread> threads[kThreadCount];
+  for (int i = 0; i < kThreadCount; ++i) {
+    const uint32_t stack_base = 0x10000 * (i + 1);
+    stacks[i].reset(new Memory(dump, stack_base));
+    stacks[i]->Append(64, 0);
+    MDRawContextX86 raw_context;
+    memset(&raw_context, 0, sizeof(raw_context));
+    raw_context.context_flags = MD_CONTEXT_X86_FULL;
+    raw_context.eip = 0x40000000 + i;
+    raw_context.esp = stack_base;
+    contexts[i].reset(new Context(dump, raw_context));
+    threads[i].reset(new Thread(dump, 0x1000 + i, *stacks[i], *contexts[i]));
+    dump.Add(stacks[i].get());
+    dump.Add(contexts[i].get());
+    dump.Add(threads[i].get());
+  }
+
+  MDRawContextX86 raw_crash_context;
+  memset(&raw_crash_context, 0, sizeof(raw_crash_context));
+  raw_crash_context.context_flags = MD_CONTEXT_X86_FULL;
+  raw_crash_context.eip = kCrashEIP;
+  raw_crash_context.esp = 0x30000;
+  Context crash_context(dump, raw_crash_context);
+  Exception exception(dump, crash_context, kCrashedThreadId,
+                      MD_EXCEPTION_CODE_WIN_ACCESS_VIOLATION, 0, kCrashEIP);
+  dump.Add(&crash_context);
+  dump.Add(&exception);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpProcessor processor(reinterpret_cast<SymbolSupplier*>(NULL), NULL);
+  ProcessState full_state;
+  ASSERT_EQ(google_breakpad::PROCESS_OK,
+            processor.Process(&minidump, &full_state));
+
+  ProcessState state;
+  DeferredStackwalks deferred;
+  ASSERT_EQ(google_breakpad::PROCESS_OK,
+            processor.ProcessRequestingThread(&minidump, &state, &deferred));
+  ASSERT_TRUE(state.crashed());
+  ASSERT_EQ(2, state.requesting_thread());
+  ASSERT_EQ(static_cast<size_t>(kThreadCount), state.threads()->size());
+  ASSERT_EQ(static_cast<size_t>(kThreadCount - 1), deferred.remaining());
+
+  // Only the requesting thread has been walked so far, from the exception
+  // context; the others are there, but with empty stacks.
+  for (int i = 0; i < kThreadCount; ++i) {
+    CallStack* stack = state.threads()->at(i);
+    EXPECT_EQ(static_cast<uint32_t>(0x1000 + i), stack->tid());
+    if (i == state.requesting_thread()) {
+      ASSERT_LE(1U, stack->frames()->size());
+      EXPECT_EQ(kCrashEIP, stack->frames()->at(0)->instruction);
+    } else {
+      EXPECT_EQ(0U, stack->frames()->size());
+    }
+  }
+
+  // Walking the rest, in a couple of steps, leaves the same state as
+  // Process does.
+  ASSERT_EQ(google_breakpad::PROCESS_OK, deferred.Walk(1));
+  ASSERT_EQ(static_cast<size_t>(kThreadCount - 2), deferred.remaining());
+  ASSERT_LE(1U, state.threads()->at(0)->frames()->size());
+  EXPECT_EQ(0U, state.threads()->at(1)->frames()->size());
+  ASSERT_EQ(google_breakpad::PROCESS_OK, deferred.WalkAll());
+  ASSERT_EQ(0U, deferred.remaining());
+  ASSERT_EQ(google_breakpad::PROCESS_OK, deferred.WalkAll());
+
+  for (int i = 0; i < kThreadCount; ++i) {
+    CallStack* stack = state.threads()->at(i);
+    CallStack* full_stack = full_state.threads()->at(i);
+    EXPECT_EQ(full_stack->tid(), stack->tid());
+    ASSERT_EQ(full_stack->frames()->size(), stack->frames()->size());
+    EXPECT_EQ(full_stack->frames()->at(0)->instruction,
+              stack->frames()->at(0)->instruction);
+  }
+}
+
 TEST_F(MinidumpProcessorTest, Test32BitCrashingAddress) {
   TestSymbolSupplier supplier;
   BasicSourceLineResolver resolver;
@@ -0,0 +1,289 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_result_cache.cc: The results of processing minidumps, kept for
+// minidumps that are submitted again.
+//
+// See minidump_result_cache.h for documentation.
+
+#include "processor/minidump_result_cache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <utility>
+#include <vector>
+
+#include "common/md5.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Creates each missing directory on the way to and including path.
+bool MakeDirectories(const string& path) {
+  size_t slash = path.find('/', 1);
+  while (true) {
+    string directory = path.substr(0, slash);
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+      return false;
+    if (slash == string::npos)
+      return true;
+    slash = path.find('/', slash + 1);
+  }
+}
+
+}  // namespace
+
+MinidumpResultCache::MinidumpResultCache()
+    : max_bytes_(kDefaultMaxBytes), directory_made_(false), bytes_(0),
+      hits_(0), misses_(0) {}
+
+MinidumpResultCache::MinidumpResultCache(size_t max_bytes)
+    : max_bytes_(max_bytes), directory_made_(false), bytes_(0), hits_(0),
+      misses_(0) {}
+
+MinidumpResultCache::~MinidumpResultCache() {}
+
+MinidumpResultCache::Fingerprinter::Fingerprinter(const string& salt)
+    : size_(0) {
+  MD5Init(&context_);
+  uint64_t salt_size = salt.size();
+  MD5Update(&context_, reinterpret_cast<const unsigned char*>(&salt_size),
+            sizeof(salt_size));
+  MD5Update(&context_, reinterpret_cast<const unsigned char*>(salt.data()),
+            salt.size());
+}
+
+void MinidumpResultCache::Fingerprinter::Update(const void* data,
+                                                size_t size) {
+  MD5Update(&context_, static_cast<const unsigned char*>(data), size);
+  size_ += size;
+}
+
+string MinidumpResultCache::Fingerprinter::Finish() {
+  unsigned char digest[16];
+  MD5Final(digest, &context_);
+  char fingerprint[sizeof(digest) * 2 + 24];
+  for (size_t i = 0; i < sizeof(digest); ++i)
+    snprintf(fingerprint + i * 2, 3, "%02x", digest[i]);
+  snprintf(fingerprint + sizeof(digest) * 2, 24, "-%" PRIu64, size_);
+  return fingerprint;
+}
+
+// static
+bool MinidumpResultCache::Fingerprint(const string& path, const string& salt,
+                                      string* fingerprint) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not open " << path << ", error " << error_code <<
+        ": " << error_string;
+    return false;
+  }
+
+  Fingerprinter fingerprinter(salt);
+  std::vector<char> buffer(64 << 10);
+  size_t read;
+  while ((read = fread(&buffer[0], 1, buffer.size(), file)) > 0)
+    fingerprinter.Update(&buffer[0], read);
+  bool failed = ferror(file);
+  fclose(file);
+  if (failed) {
+    BPLOG(ERROR) << "Could not read " << path;
+    return false;
+  }
+  *fingerprint = fingerprinter.Finish();
+  return true;
+}
+
+bool MinidumpResultCache::Find(const string& fingerprint, string* result) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<string, EntryList::iterator>::iterator found =
+        index_.find(fingerprint);
+    if (found != index_.end()) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      entries_.splice(entries_.begin(), entries_, found->second);
+      *result = found->second->result;
+      return true;
+    }
+  }
+
+  if (!directory_.empty() && ReadResult(PathFor(fingerprint), result)) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    InsertInMemory(fingerprint, *result);
+    return true;
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void MinidumpResultCache::Insert(const string& fingerprint,
+                                 const string& result) {
+  InsertInMemory(fingerprint, result);
+  if (!directory_.empty())
+    WriteResult(PathFor(fingerprint), result);
+}
+
+size_t MinidumpResultCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+void MinidumpResultCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+void MinidumpResultCache::PrintStats(FILE* out) const {
+  fprintf(out, "%-20s %10s %10s %14s\n", "result_cache", "hits", "misses",
+          "bytes");
+  fprintf(out, "%-20s %10" PRIu64 " %10" PRIu64 " %14" PRIu64 "\n",
+          directory_.empty() ? "memory" : "memory+disk", hits(), misses(),
+          static_cast<uint64_t>(bytes()));
+}
+
+void MinidumpResultCache::InsertInMemory(const string& fingerprint,
+                                         const string& result) {
+  size_t entry_bytes = fingerprint.size() + result.size() + sizeof(Entry);
+  if (entry_bytes > max_bytes_)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.find(fingerprint) != index_.end())
+    return;
+  while (!entries_.empty() && bytes_ + entry_bytes > max_bytes_) {
+    const Entry& last = entries_.back();
+    bytes_ -= last.fingerprint->size() + last.result.size() + sizeof(Entry);
+    index_.erase(*last.fingerprint);
+    entries_.pop_back();
+  }
+  entries_.emplace_front();
+  Entry& cached = entries_.front();
+  std::pair<std::unordered_map<string, EntryList::iterator>::iterator, bool>
+      inserted = index_.insert(std::make_pair(fingerprint, entries_.begin()));
+  cached.fingerprint = &inserted.first->first;
+  cached.result = result;
+  bytes_ += entry_bytes;
+}
+
+string MinidumpResultCache::PathFor(const string& fingerprint) const {
+  return directory_ + "/" + fingerprint;
+}
+
+// static
+bool MinidumpResultCache::ReadResult(const string& path, string* result) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  result->clear();
+  std::vector<char> buffer(64 << 10);
+  size_t read;
+  while ((read = fread(&buffer[0], 1, buffer.size(), file)) > 0)
+    result->append(&buffer[0], read);
+  bool failed = ferror(file);
+  fclose(file);
+  if (failed) {
+    BPLOG(ERROR) << "Could not read " << path;
+    return false;
+  }
+  return true;
+}
+
+bool MinidumpResultCache::WriteResult(const string& path,
+                                      const string& result) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!directory_made_) {
+      if (!MakeDirectories(directory_)) {
+        string error_string;
+        int error_code = ErrnoString(&error_string);
+        BPLOG(ERROR) << "Could not create " << directory_ <<
+            ", error " << error_code << ": " << error_string;
+        return false;
+      }
+      directory_made_ = true;
+    }
+  }
+
+  // Write to a uniquely named file next to path, so that other processes
+  // only ever see a complete file under its final name.
+  string temp_template = path + ".XXXXXX";
+  std::vector<char> temp_name(temp_template.begin(), temp_template.end());
+  temp_name.push_back('\0');
+  int fd = mkstemp(&temp_name[0]);
+  if (fd == -1) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not create a temporary file in " << directory_ <<
+        ", error " << error_code << ": " << error_string;
+    return false;
+  }
+  // mkstemp only grants access to the owner, but the cache may be shared.
+  fchmod(fd, 0644);
+  string temp_file(&temp_name[0]);
+  size_t written = 0;
+  while (written < result.size()) {
+    ssize_t count = write(fd, result.data() + written,
+                          result.size() - written);
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      break;
+    written += static_cast<size_t>(count);
+  }
+  close(fd);
+  if (written != result.size()) {
+    BPLOG(ERROR) << "Could not write " << temp_file;
+    unlink(temp_file.c_str());
+    return false;
+  }
+
+  if (rename(temp_file.c_str(), path.c_str()) != 0) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not rename " << temp_file << " to " << path <<
+        ", error " << error_code << ": " << error_string;
+    unlink(temp_file.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
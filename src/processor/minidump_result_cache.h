@@ -0,0 +1,176 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_result_cache.h: The results of processing minidumps, kept for
+// minidumps that are submitted again.
+//
+// Crash collectors receive many minidumps more than once, from uploads
+// that are retried or duplicated.  A MinidumpResultCache remembers what
+// processing each minidump produced, such as its printed stacks, keyed by
+// a fingerprint of the minidump, so that a minidump seen before needn't be
+// walked and symbolized again.  The fingerprint is an MD5 digest of the
+// minidump's bytes, which may be computed as they arrive, and of a salt
+// identifying whatever else the result depends on, such as the symbols
+// used and the output format.  All of the bytes go into it because a
+// minidump's streams refer to one another's data all over the file, and
+// hashing them costs far less than walking a single stack.  It tells apart
+// minidumps that differ by accident, not ones crafted to collide.
+//
+// Results are kept in memory, up to a number of bytes, dropping the least
+// recently used.  Given a directory, the cache also keeps results there,
+// where later processes using the same directory find them.  The cache
+// assumes that a result doesn't change once made, so callers should leave
+// out results that symbols arriving later would change, those of
+// minidumps with modules missing their symbols.  It is safe to share
+// between threads.
+
+#ifndef PROCESSOR_MINIDUMP_RESULT_CACHE_H__
+#define PROCESSOR_MINIDUMP_RESULT_CACHE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "common/md5.h"
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class MinidumpResultCache {
+ public:
+  // The bytes of results kept in memory, unless the cache is created with
+  // another limit.
+  static const size_t kDefaultMaxBytes = 64 << 20;
+
+  MinidumpResultCache();
+  explicit MinidumpResultCache(size_t max_bytes);
+  ~MinidumpResultCache();
+
+  // Keeps results in |directory| as well as in memory, and looks for those
+  // not in memory there.  The directory is created if need be.
+  void set_directory(const string& directory) { directory_ = directory; }
+
+  // Computes the fingerprint of a minidump from its bytes, given in order
+  // as they arrive.
+  class Fingerprinter {
+   public:
+    explicit Fingerprinter(const string& salt);
+
+    void Update(const void* data, size_t size);
+
+    // Returns the fingerprint of the bytes given: 32 hex digits, then a
+    // dash and their number.
+    string Finish();
+
+   private:
+    MD5Context context_;
+    uint64_t size_;
+  };
+
+  // Sets |*fingerprint| to the fingerprint of the minidump file at |path|
+  // with |salt|.  Returns false if the file can't be read.
+  static bool Fingerprint(const string& path, const string& salt,
+                          string* fingerprint);
+
+  // If a result is cached for |fingerprint|, in memory or in the
+  // directory, sets |*result| to it and returns true.
+  bool Find(const string& fingerprint, string* result);
+
+  // Caches |result| under |fingerprint| in memory, and in the directory if
+  // there is one.
+  void Insert(const string& fingerprint, const string& result);
+
+  // Lookups answered from the cache, and those that weren't.
+  uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+  // The bytes of results held in memory.
+  size_t bytes() const;
+
+  // Forgets every result held in memory.
+  void Clear();
+
+  // Prints the hits, misses and bytes held to |out|.
+  void PrintStats(FILE* out) const;
+
+ private:
+  struct Entry {
+    // The fingerprint, owned by index_.
+    const string* fingerprint;
+    string result;
+  };
+  typedef std::list<Entry> EntryList;
+
+  // Caches |result| under |fingerprint| in memory.
+  void InsertInMemory(const string& fingerprint, const string& result);
+
+  // Where the result for |fingerprint| is kept in the directory.
+  string PathFor(const string& fingerprint) const;
+
+  // Reads the result at |path| into |*result|.
+  static bool ReadResult(const string& path, string* result);
+
+  // Writes |result| to |path|, so that other processes only ever see a
+  // complete file there.
+  bool WriteResult(const string& path, const string& result);
+
+  size_t max_bytes_;
+  string directory_;
+
+  // Guards the members below.
+  mutable std::mutex mutex_;
+
+  // Whether directory_ has been created.
+  bool directory_made_;
+
+  // The results, most recently used first.
+  EntryList entries_;
+
+  // Each result in entries_, by fingerprint.
+  std::unordered_map<string, EntryList::iterator> index_;
+
+  // The bytes of fingerprints and results held.
+  size_t bytes_;
+
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+
+  // Disallow copy constructor and assignment operator.
+  MinidumpResultCache(const MinidumpResultCache&);
+  void operator=(const MinidumpResultCache&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_MINIDUMP_RESULT_CACHE_H__
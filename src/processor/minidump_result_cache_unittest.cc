@@ -0,0 +1,159 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_result_cache_unittest.cc: Unit tests for MinidumpResultCache.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/minidump_result_cache.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::MinidumpResultCache;
+
+class MinidumpResultCacheTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    testdata_dir_ = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                    "/src/processor/testdata";
+  }
+
+  AutoTempDir temp_dir_;
+  string testdata_dir_;
+};
+
+TEST_F(MinidumpResultCacheTest, Fingerprint) {
+  string dump = testdata_dir_ + "/minidump2.dmp";
+  string fingerprint, again, salted, other;
+  ASSERT_TRUE(MinidumpResultCache::Fingerprint(dump, "", &fingerprint));
+  ASSERT_TRUE(MinidumpResultCache::Fingerprint(dump, "", &again));
+  EXPECT_EQ(fingerprint, again);
+  // 32 hex digits, then the file's size.
+  struct stat sb;
+  ASSERT_EQ(0, stat(dump.c_str(), &sb));
+  EXPECT_EQ(fingerprint.substr(32), "-" + std::to_string(sb.st_size));
+
+  ASSERT_TRUE(MinidumpResultCache::Fingerprint(dump, "machine", &salted));
+  EXPECT_NE(fingerprint, salted);
+  ASSERT_TRUE(MinidumpResultCache::Fingerprint(
+      testdata_dir_ + "/linux_divide_by_zero.dmp", "", &other));
+  EXPECT_NE(fingerprint, other);
+
+  EXPECT_FALSE(MinidumpResultCache::Fingerprint(
+      temp_dir_.path() + "/missing.dmp", "", &other));
+}
+
+TEST_F(MinidumpResultCacheTest, FingerprintInPieces) {
+  string dump = testdata_dir_ + "/minidump2.dmp";
+  string fingerprint;
+  ASSERT_TRUE(MinidumpResultCache::Fingerprint(dump, "salt", &fingerprint));
+
+  FILE* file = fopen(dump.c_str(), "rb");
+  ASSERT_TRUE(file);
+  MinidumpResultCache::Fingerprinter fingerprinter("salt");
+  char buffer[1000];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    fingerprinter.Update(buffer, read);
+  fclose(file);
+  EXPECT_EQ(fingerprint, fingerprinter.Finish());
+}
+
+TEST_F(MinidumpResultCacheTest, FindAndInsert) {
+  MinidumpResultCache cache;
+  string result;
+  EXPECT_FALSE(cache.Find("a", &result));
+  cache.Insert("a", "result a");
+  ASSERT_TRUE(cache.Find("a", &result));
+  EXPECT_EQ("result a", result);
+  EXPECT_FALSE(cache.Find("b", &result));
+  EXPECT_EQ(1U, cache.hits());
+  EXPECT_EQ(2U, cache.misses());
+  EXPECT_LT(0U, cache.bytes());
+
+  cache.Clear();
+  EXPECT_EQ(0U, cache.bytes());
+  EXPECT_FALSE(cache.Find("a", &result));
+}
+
+TEST_F(MinidumpResultCacheTest, DropsLeastRecentlyUsed) {
+  string result_a(1000, 'a'), result_b(1000, 'b'), result_c(1000, 'c');
+  MinidumpResultCache cache(2500);
+  cache.Insert("a", result_a);
+  cache.Insert("b", result_b);
+  string result;
+  ASSERT_TRUE(cache.Find("a", &result));
+  // Makes room by dropping b, which a's lookup left least recently used.
+  cache.Insert("c", result_c);
+  EXPECT_TRUE(cache.Find("a", &result));
+  EXPECT_FALSE(cache.Find("b", &result));
+  EXPECT_TRUE(cache.Find("c", &result));
+  EXPECT_GE(2500U, cache.bytes());
+
+  // A result larger than the whole cache isn't kept.
+  cache.Insert("d", string(3000, 'd'));
+  EXPECT_FALSE(cache.Find("d", &result));
+}
+
+TEST_F(MinidumpResultCacheTest, Directory) {
+  string directory = temp_dir_.path() + "/results/machine";
+  {
+    MinidumpResultCache cache;
+    cache.set_directory(directory);
+    cache.Insert("kept", "kept result");
+  }
+
+  MinidumpResultCache cache;
+  cache.set_directory(directory);
+  string result;
+  ASSERT_TRUE(cache.Find("kept", &result));
+  EXPECT_EQ("kept result", result);
+  EXPECT_FALSE(cache.Find("other", &result));
+
+  // Results found on disk are then held in memory.
+  EXPECT_EQ(0, remove((directory + "/kept").c_str()));
+  result.clear();
+  ASSERT_TRUE(cache.Find("kept", &result));
+  EXPECT_EQ("kept result", result);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
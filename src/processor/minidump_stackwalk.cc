@@ -33,50 +33,161 @@
 // Author: Mark Mentovai
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "common/path_helper.h"
 #include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
 #include "google_breakpad/processor/minidump.h"
 #include "google_breakpad/processor/minidump_processor.h"
 #include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/caching_symbol_supplier.h"
+#include "processor/call_stack_cache.h"
+#include "processor/frame_symbol_cache.h"
+#include "processor/libcurl_symbol_fetcher.h"
 #include "processor/logging.h"
+#include "processor/process_state_proto_writer.h"
+#include "processor/processor_metrics.h"
+#include "processor/sequential_stream_buffer.h"
 #include "processor/simple_symbol_supplier.h"
 #include "processor/stackwalk_common.h"
+#include "processor/symbol_load_cache.h"
+#include "processor/symbol_path_cache.h"
+#include "processor/tiered_symbol_supplier.h"
 
 
 namespace {
 
 struct Options {
   bool machine_readable;
+  bool proto_output;
+  bool json_output;
   bool output_stack_contents;
+  bool output_registers;
   bool output_requesting_thread_only;
+  bool use_mmap;
+  bool load_memory_by_page;
+  uint64_t memory_budget;
+  int symbol_load_threads;
+  int stackwalk_threads;
+  int symbol_prefetch_threads;
+  int symbol_preload_threads;
+  bool symbolize_after_walking;
+  // The modules, by code file base name, walked by frame pointer first.
+  std::set<string> frame_pointer_modules;
+  string symbol_cache_path;
+  bool use_huge_pages;
+  // Where symbols missing from the symbol paths are fetched from if -u
+  // was given, or NULL, and the most the cache may then hold, or 0.
+  google_breakpad::LibcurlSymbolFetcher* symbol_fetcher;
+  uint64_t symbol_cache_bytes;
+  string batch_file;
+  int batch_workers;
+  // Where processing is counted and timed if -S was given, or NULL.
+  google_breakpad::ProcessorMetrics* metrics;
 
   string minidump_file;
   std::vector<string> symbol_paths;
 };
 
 using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CachingSymbolSupplier;
+using google_breakpad::CallStackCache;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::FrameSymbolCache;
+using google_breakpad::LibcurlSymbolFetcher;
 using google_breakpad::Minidump;
 using google_breakpad::MinidumpMemoryList;
 using google_breakpad::MinidumpThreadList;
 using google_breakpad::MinidumpProcessor;
 using google_breakpad::ProcessState;
+using google_breakpad::ProcessorMetrics;
+using google_breakpad::SequentialStreamBuffer;
 using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SourceLineResolverInterface;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::SymbolLoadCache;
+using google_breakpad::SymbolPathCache;
+using google_breakpad::SymbolSupplier;
+using google_breakpad::TieredSymbolSupplier;
 using google_breakpad::scoped_ptr;
 
+// Returns true if |options| asks for symbols in the format loaded by
+// FastSourceLineResolver.
+bool UsesFastSymbols(const Options& options) {
+  return !options.symbol_cache_path.empty() || options.symbol_fetcher;
+}
+
+// Returns the symbol supplier that |options| asks for, or NULL if there
+// are no symbol paths and no symbol server.
+SimpleSymbolSupplier* CreateSymbolSupplier(const Options& options) {
+  if (options.symbol_fetcher) {
+    TieredSymbolSupplier* supplier = new TieredSymbolSupplier(
+        options.symbol_paths, options.symbol_cache_path,
+        options.symbol_fetcher);
+    if (options.symbol_cache_bytes)
+      supplier->set_disk_cache_bytes(options.symbol_cache_bytes);
+    return supplier;
+  }
+  if (options.symbol_paths.empty())
+    return NULL;
+  // TODO(mmentovai): check existence of symbol_path if specified?
+  if (!options.symbol_cache_path.empty()) {
+    CachingSymbolSupplier* supplier = new CachingSymbolSupplier(
+        options.symbol_paths, options.symbol_cache_path);
+    supplier->set_use_huge_pages(options.use_huge_pages);
+    return supplier;
+  }
+  SimpleSymbolSupplier* supplier =
+      new SimpleSymbolSupplier(options.symbol_paths);
+  supplier->set_use_mmap(options.use_mmap);
+  return supplier;
+}
+
+// Returns the resolver that |options| asks for, which allows concurrent
+// lookups if |thread_safe| is true and it is a FastSourceLineResolver.
+SourceLineResolverInterface* CreateResolver(const Options& options,
+                                            bool thread_safe) {
+  if (UsesFastSymbols(options))
+    return new FastSourceLineResolver(thread_safe);
+  return new BasicSourceLineResolver(options.symbol_load_threads);
+}
+
+// Prints the symbol tiers' stats to stderr if -S and -u were given, in
+// which case |supplier| is a TieredSymbolSupplier.
+void PrintSymbolTierStats(const Options& options,
+                          SimpleSymbolSupplier* supplier) {
+  if (options.metrics && options.symbol_fetcher)
+    static_cast<TieredSymbolSupplier*>(supplier)->PrintStats(stderr);
+}
+
 // Processes |options.minidump_file| using MinidumpProcessor.
 // |options.symbol_path|, if non-empty, is the base directory of a
 // symbol storage area, laid out in the format required by
 // SimpleSymbolSupplier.  If such a storage area is specified, it is
-// made available for use by the MinidumpProcessor.
+// made available for use by the MinidumpProcessor.  If
+// |options.symbol_cache_path| is also non-empty, symbols are served from
+// a CachingSymbolSupplier cache there and loaded with FastSourceLineResolver,
+// which then also lets |options.stackwalk_threads| walk threads at once.
+// If |options.symbol_fetcher| is set, symbols are served by a
+// TieredSymbolSupplier instead, which fetches those not in the symbol paths.
 //
 // Returns the value of MinidumpProcessor::Process.  If processing succeeds,
 // prints identifying OS and CPU information from the minidump, crash
@@ -84,54 +195,260 @@ using google_breakpad::scoped_ptr;
 // call stacks for each thread contained in the minidump.  All information
 // is printed to stdout.
 bool PrintMinidumpProcess(const Options& options) {
-  scoped_ptr<SimpleSymbolSupplier> symbol_supplier;
-  if (!options.symbol_paths.empty()) {
-    // TODO(mmentovai): check existence of symbol_path if specified?
-    symbol_supplier.reset(new SimpleSymbolSupplier(options.symbol_paths));
-  }
+  scoped_ptr<SimpleSymbolSupplier> symbol_supplier(
+      CreateSymbolSupplier(options));
 
-  BasicSourceLineResolver resolver;
-  MinidumpProcessor minidump_processor(symbol_supplier.get(), &resolver);
+  // The resolver is destroyed before the supplier, which owns the mapped
+  // symbol data that a FastSourceLineResolver points into.
+  scoped_ptr<SourceLineResolverInterface> resolver(
+      CreateResolver(options, options.stackwalk_threads > 1 ||
+                              options.symbol_preload_threads > 1));
+  MinidumpProcessor minidump_processor(symbol_supplier.get(), resolver.get());
+  minidump_processor.set_stackwalk_threads(options.stackwalk_threads);
+  minidump_processor.set_symbol_prefetch_threads(
+      options.symbol_prefetch_threads);
+  minidump_processor.set_symbol_preload_threads(
+      options.symbol_preload_threads);
+  minidump_processor.set_symbolize_after_walking(
+      options.symbolize_after_walking);
+  minidump_processor.set_frame_pointer_modules(options.frame_pointer_modules);
+  minidump_processor.set_metrics(options.metrics);
 
-  // Increase the maximum number of threads and regions.
-  MinidumpThreadList::set_max_threads(std::numeric_limits<uint32_t>::max());
-  MinidumpMemoryList::set_max_regions(std::numeric_limits<uint32_t>::max());
-  // Process the minidump.
-  Minidump dump(options.minidump_file);
-  if (!dump.Read()) {
-     BPLOG(ERROR) << "Minidump " << dump.path() << " could not be read";
+  // Process the minidump.  One piped in on stdin is read as it arrives,
+  // and needn't be written to a file first.
+  SequentialStreamBuffer stdin_buffer(&std::cin);
+  std::istream stdin_stream(&stdin_buffer);
+  scoped_ptr<Minidump> dump(options.minidump_file == "-" ?
+      new Minidump(stdin_stream) : new Minidump(options.minidump_file));
+  dump->set_use_mmap(options.use_mmap);
+  dump->set_load_memory_by_page(options.load_memory_by_page);
+  dump->set_memory_budget(options.memory_budget);
+  bool read;
+  {
+    ProcessorMetrics::ScopedTimer timer(options.metrics,
+                                        ProcessorMetrics::READ);
+    read = dump->Read();
+  }
+  if (!read) {
+     BPLOG(ERROR) << "Minidump " << dump->path() << " could not be read";
      return false;
   }
   ProcessState process_state;
-  if (minidump_processor.Process(&dump, &process_state) !=
+  if (minidump_processor.Process(dump.get(), &process_state) !=
       google_breakpad::PROCESS_OK) {
     BPLOG(ERROR) << "MinidumpProcessor::Process failed";
     return false;
   }
+  PrintSymbolTierStats(options, symbol_supplier.get());
 
-  if (options.machine_readable) {
+  if (options.proto_output) {
+    if (!google_breakpad::WriteDelimitedProcessStateProto(process_state,
+                                                          stdout)) {
+      BPLOG(ERROR) << "Could not write the process state";
+      return false;
+    }
+  } else if (options.json_output) {
+    PrintProcessStateJSON(process_state, options.output_stack_contents,
+                          options.output_registers,
+                          options.output_requesting_thread_only, stdout);
+  } else if (options.machine_readable) {
     PrintProcessStateMachineReadable(process_state);
   } else {
     PrintProcessState(process_state, options.output_stack_contents,
-                      options.output_requesting_thread_only, &resolver);
+                      options.output_requesting_thread_only, resolver.get());
   }
 
   return true;
 }
 
+// Processes each minidump listed, one path per line, in
+// |options.batch_file|, or on stdin if it is "-", on
+// |options.batch_workers| threads.  Symbols are loaded once for the whole
+// batch: the workers share a thread-safe FastSourceLineResolver when
+// |options.symbol_cache_path| or |options.symbol_fetcher| is set, and
+// otherwise each keeps its own
+// BasicSourceLineResolver, which doesn't allow concurrent lookups.  Either
+// way, a module needed by several workers at once is fetched by only one
+// of them, and a module missing its symbols is looked for only once.
+//
+// Prints one record per minidump, in the order they finish:
+// Minidump|{path}|{OK or error}, followed for a processed minidump by its
+// state in machine-readable format, as would be printed with -m.  Returns
+// false if any minidump could not be processed.
+bool ProcessMinidumpBatch(const Options& options) {
+  std::ifstream batch_stream;
+  if (options.batch_file != "-") {
+    batch_stream.open(options.batch_file.c_str());
+    if (!batch_stream.is_open()) {
+      BPLOG(ERROR) << "Could not open batch file " << options.batch_file;
+      return false;
+    }
+  }
+  std::istream& batch = options.batch_file != "-" ? batch_stream : std::cin;
+  std::vector<string> minidump_files;
+  string line;
+  while (std::getline(batch, line)) {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      line.erase(line.size() - 1);
+    if (!line.empty())
+      minidump_files.push_back(line);
+  }
+
+  int worker_count = std::max(1, std::min(options.batch_workers,
+      static_cast<int>(minidump_files.size())));
+  bool shared = UsesFastSymbols(options);
+  // Remembers where symbol files are, and aren't, across minidumps.
+  SymbolPathCache path_cache;
+  std::vector<std::unique_ptr<SimpleSymbolSupplier> > suppliers;
+  std::vector<std::unique_ptr<SourceLineResolverInterface> > resolvers;
+  for (int i = 0; i < (shared ? 1 : worker_count); ++i) {
+    suppliers.push_back(
+        std::unique_ptr<SimpleSymbolSupplier>(CreateSymbolSupplier(options)));
+    if (suppliers.back())
+      suppliers.back()->set_path_cache(&path_cache);
+  }
+  for (int i = 0; i < (shared ? 1 : worker_count); ++i) {
+    resolvers.push_back(std::unique_ptr<SourceLineResolverInterface>(
+        CreateResolver(options, worker_count > 1 ||
+                                options.stackwalk_threads > 1 ||
+                                options.symbol_preload_threads > 1)));
+  }
+
+  SymbolLoadCache load_cache;
+  FrameSymbolCache frame_cache;
+  CallStackCache call_stack_cache;
+  std::atomic<size_t> next_minidump(0);
+  std::atomic<bool> all_processed(true);
+  std::mutex output_mutex;
+  auto process_minidumps = [&](SymbolSupplier* supplier,
+                               SourceLineResolverInterface* resolver) {
+    StackFrameSymbolizer symbolizer(supplier, resolver);
+    symbolizer.set_symbol_load_cache(&load_cache);
+    symbolizer.set_frame_symbol_cache(&frame_cache);
+    MinidumpProcessor minidump_processor(&symbolizer, false);
+    minidump_processor.set_call_stack_cache(&call_stack_cache);
+    minidump_processor.set_stackwalk_threads(options.stackwalk_threads);
+    minidump_processor.set_symbol_prefetch_threads(
+        options.symbol_prefetch_threads);
+    minidump_processor.set_symbol_preload_threads(
+        options.symbol_preload_threads);
+    minidump_processor.set_symbolize_after_walking(
+        options.symbolize_after_walking);
+    minidump_processor.set_frame_pointer_modules(
+        options.frame_pointer_modules);
+    minidump_processor.set_metrics(options.metrics);
+    // One Minidump and ProcessState serve for every minidump, keeping
+    // their storage from one to the next.
+    Minidump dump((string()));
+    dump.set_use_mmap(options.use_mmap);
+    dump.set_load_memory_by_page(options.load_memory_by_page);
+    dump.set_memory_budget(options.memory_budget);
+    ProcessState process_state;
+    size_t i;
+    while ((i = next_minidump++) < minidump_files.size()) {
+      dump.Reset(minidump_files[i]);
+      const char* status = "OK";
+      bool read;
+      {
+        ProcessorMetrics::ScopedTimer timer(options.metrics,
+                                            ProcessorMetrics::READ);
+        read = dump.Read();
+      }
+      if (!read) {
+        BPLOG(ERROR) << "Minidump " << dump.path() << " could not be read";
+        status = "ERROR_READ";
+      } else if (minidump_processor.Process(&dump, &process_state) !=
+                 google_breakpad::PROCESS_OK) {
+        BPLOG(ERROR) << "MinidumpProcessor::Process failed for "
+                     << dump.path();
+        status = "ERROR_PROCESS";
+      }
+
+      std::lock_guard<std::mutex> lock(output_mutex);
+      printf("Minidump|%s|%s\n", minidump_files[i].c_str(), status);
+      if (strcmp(status, "OK") == 0) {
+        PrintProcessStateMachineReadable(process_state);
+      } else {
+        all_processed = false;
+      }
+      fflush(stdout);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < worker_count; ++i) {
+    int symbols = shared ? 0 : i;
+    workers.push_back(std::thread(process_minidumps,
+                                  suppliers[symbols].get(),
+                                  resolvers[symbols].get()));
+  }
+  process_minidumps(suppliers[0].get(), resolvers[0].get());
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+  PrintSymbolTierStats(options, suppliers[0].get());
+
+  // The resolvers are destroyed before the suppliers, which own the mapped
+  // symbol data that a FastSourceLineResolver points into.
+  resolvers.clear();
+  return all_processed;
+}
+
 }  // namespace
 
 static void Usage(int argc, const char *argv[], bool error) {
   fprintf(error ? stderr : stdout,
           "Usage: %s [options] <minidump-file> [symbol-path ...]\n"
+          "       %s [options] -b <file> [symbol-path ...]\n"
           "\n"
-          "Output a stack trace for the provided minidump\n"
+          "Output a stack trace for the provided minidump, or for one\n"
+          "read from stdin if <minidump-file> is -\n"
           "\n"
           "Options:\n"
           "\n"
           "  -m         Output in machine-readable format\n"
+          "  -F <fmt>   Output in format <fmt>: text (the default), machine\n"
+          "             (as with -m), proto, a length-delimited\n"
+          "             ProcessStateProto (see proto/process_state.proto),\n"
+          "             or json\n"
           "  -s         Output stack contents\n"
-          "  -c         Output thread that causes crash or dump only\n",
+          "  -R         Leave register values out of json output\n"
+          "  -c         Output thread that causes crash or dump only\n"
+          "  -M         Memory-map the minidump and symbol files rather\n"
+          "             than reading them\n"
+          "  -P         Read memory from the minidump a page at a time, as\n"
+          "             it's used\n"
+          "  -B <n>     Read at most <n> bytes of memory from the minidump\n"
+          "  -j <n>     Parse each symbol file on <n> threads\n"
+          "  -f <dir>   Cache symbols in <dir> in the fast-loading format,\n"
+          "             shared with other processes using the same cache\n"
+          "  -H         Copy symbols from the -f cache into huge pages\n"
+          "             rather than mapping them, for fewer TLB misses\n"
+          "  -u <url>   Fetch symbols missing from the symbol paths from the\n"
+          "             symbol server at <url>, keeping them in the -f cache\n"
+          "             if given\n"
+          "  -C <n>     Keep at most <n> bytes in the -f cache when fetching\n"
+          "             with -u\n"
+          "  -t <n>     Walk up to <n> threads' stacks at once (needs -f or\n"
+          "             -u)\n"
+          "  -p <n>     Fetch all modules' symbols before walking stacks,\n"
+          "             up to <n> at once\n"
+          "  -L <n>     Load the symbols of the modules the stacks refer to\n"
+          "             before walking them, parsing up to <n> at once with\n"
+          "             -f or -u\n"
+          "  -D         Walk all stacks before symbolizing their frames,\n"
+          "             a module at a time\n"
+          "  -e <name>  Walk through frames in the module whose code file\n"
+          "             is named <name>, built with frame pointers, by\n"
+          "             frame pointer before CFI; with -D, without loading\n"
+          "             its symbols to do so.  May be repeated\n"
+          "  -b <file>  Process each minidump listed in <file>, or on stdin\n"
+          "             if it is -, printing machine-readable records; all\n"
+          "             arguments are then symbol paths\n"
+          "  -n <n>     Process <n> minidumps of a batch at once\n"
+          "  -S         Print counts and timings of the processing to\n"
+          "             stderr when done\n"
+          "  -q         Log errors only\n",
+          google_breakpad::BaseName(argv[0]).c_str(),
           google_breakpad::BaseName(argv[0]).c_str());
 }
 
@@ -139,25 +456,151 @@ static void SetupOptions(int argc, const char *argv[], Options* options) {
   int ch;
 
   options->machine_readable = false;
+  options->proto_output = false;
+  options->json_output = false;
   options->output_stack_contents = false;
+  options->output_registers = true;
   options->output_requesting_thread_only = false;
+  options->use_mmap = false;
+  options->load_memory_by_page = false;
+  options->memory_budget = 0;
+  options->symbol_load_threads = 1;
+  options->stackwalk_threads = 1;
+  options->symbol_prefetch_threads = 0;
+  options->symbol_preload_threads = 0;
+  options->symbolize_after_walking = false;
+  options->batch_workers = 1;
+  options->metrics = NULL;
+  options->symbol_fetcher = NULL;
+  options->symbol_cache_bytes = 0;
+  options->use_huge_pages = false;
 
-  while ((ch = getopt(argc, (char * const*)argv, "chms")) != -1) {
+  while ((ch = getopt(argc, (char * const*)argv, "B:C:DF:HL:MPRSb:ce:f:hj:mn:p:qst:u:")) != -1) {
     switch (ch) {
       case 'h':
         Usage(argc, argv, false);
         exit(0);
         break;
 
+      case 'B': {
+        char* end;
+        options->memory_budget = strtoull(optarg, &end, 10);
+        if (*optarg == '\0' || *end != '\0' || options->memory_budget == 0) {
+          fprintf(stderr, "%s: Invalid byte count: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      }
+      case 'C': {
+        char* end;
+        options->symbol_cache_bytes = strtoull(optarg, &end, 10);
+        if (*optarg == '\0' || *end != '\0' ||
+            options->symbol_cache_bytes == 0) {
+          fprintf(stderr, "%s: Invalid byte count: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      }
+      case 'D':
+        options->symbolize_after_walking = true;
+        break;
+      case 'F':
+        if (strcmp(optarg, "proto") == 0) {
+          options->proto_output = true;
+        } else if (strcmp(optarg, "json") == 0) {
+          options->json_output = true;
+        } else if (strcmp(optarg, "machine") == 0) {
+          options->machine_readable = true;
+        } else if (strcmp(optarg, "text") != 0) {
+          fprintf(stderr, "%s: Invalid output format: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      case 'H':
+        options->use_huge_pages = true;
+        break;
+      case 'L':
+        options->symbol_preload_threads = atoi(optarg);
+        if (options->symbol_preload_threads < 1) {
+          fprintf(stderr, "%s: Invalid thread count: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      case 'M':
+        options->use_mmap = true;
+        break;
+      case 'P':
+        options->load_memory_by_page = true;
+        break;
+      case 'R':
+        options->output_registers = false;
+        break;
+      case 'S':
+        if (!options->metrics)
+          options->metrics = new ProcessorMetrics;
+        break;
+      case 'b':
+        options->batch_file = optarg;
+        break;
       case 'c':
         options->output_requesting_thread_only = true;
         break;
+      case 'e':
+        options->frame_pointer_modules.insert(optarg);
+        break;
+      case 'f':
+        options->symbol_cache_path = optarg;
+        break;
+      case 'j':
+        options->symbol_load_threads = atoi(optarg);
+        if (options->symbol_load_threads < 1) {
+          fprintf(stderr, "%s: Invalid thread count: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
       case 'm':
         options->machine_readable = true;
         break;
+      case 'n':
+        options->batch_workers = atoi(optarg);
+        if (options->batch_workers < 1) {
+          fprintf(stderr, "%s: Invalid worker count: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      case 'p':
+        options->symbol_prefetch_threads = atoi(optarg);
+        if (options->symbol_prefetch_threads < 1) {
+          fprintf(stderr, "%s: Invalid thread count: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      case 'q':
+        google_breakpad::LogStream::set_minimum_severity(
+            google_breakpad::LogStream::SEVERITY_ERROR);
+        break;
       case 's':
         options->output_stack_contents = true;
         break;
+      case 't':
+        options->stackwalk_threads = atoi(optarg);
+        if (options->stackwalk_threads < 1) {
+          fprintf(stderr, "%s: Invalid thread count: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      case 'u':
+        delete options->symbol_fetcher;
+        options->symbol_fetcher = new LibcurlSymbolFetcher(optarg);
+        break;
 
       case '?':
         Usage(argc, argv, true);
@@ -166,15 +609,24 @@ static void SetupOptions(int argc, const char *argv[], Options* options) {
     }
   }
 
-  if ((argc - optind) == 0) {
-    fprintf(stderr, "%s: Missing minidump file\n", argv[0]);
+  if (!options->batch_file.empty() &&
+      (options->proto_output || options->json_output)) {
+    fprintf(stderr, "%s: -b prints machine-readable records only\n",
+            argv[0]);
     Usage(argc, argv, true);
     exit(1);
   }
 
-  options->minidump_file = argv[optind];
+  if (options->batch_file.empty()) {
+    if ((argc - optind) == 0) {
+      fprintf(stderr, "%s: Missing minidump file\n", argv[0]);
+      Usage(argc, argv, true);
+      exit(1);
+    }
+    options->minidump_file = argv[optind++];
+  }
 
-  for (int argi = optind + 1; argi < argc; ++argi)
+  for (int argi = optind; argi < argc; ++argi)
     options->symbol_paths.push_back(argv[argi]);
 }
 
@@ -182,5 +634,16 @@ int main(int argc, const char* argv[]) {
   Options options;
   SetupOptions(argc, argv, &options);
 
-  return PrintMinidumpProcess(options) ? 0 : 1;
+  // Increase the maximum number of threads and regions.
+  MinidumpThreadList::set_max_threads(std::numeric_limits<uint32_t>::max());
+  MinidumpMemoryList::set_max_regions(std::numeric_limits<uint32_t>::max());
+
+  bool processed = !options.batch_file.empty() ?
+      ProcessMinidumpBatch(options) : PrintMinidumpProcess(options);
+  if (options.metrics) {
+    options.metrics->Print(stderr);
+    delete options.metrics;
+  }
+  delete options.symbol_fetcher;
+  return processed ? 0 : 1;
 }
@@ -0,0 +1,679 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// minidump_stackwalk_server.cc: A long-running server that processes
+// minidumps sent to it over a Unix domain socket, keeping symbols loaded
+// from one request to the next.
+//
+// A client may send any number of requests on a connection, each the line
+//   PROCESS <minidump size> [<timeout in milliseconds>]
+// followed by the minidump's bytes.  The server answers each with the line
+//   <status> <output size>
+// followed by the output.  The status is the name of the ProcessResult of
+// processing the minidump, with the state printed as by minidump_stackwalk
+// -m for PROCESS_OK.  A request that runs out of time ends as
+// PROCESS_CANCELLED.  The server may also answer BUSY, if it is already holding as
+// many connections as it admits, or BAD_REQUEST; either comes without
+// output, and the server closes the connection after it.
+//
+// Collectors often send the same minidump more than once, as uploads are
+// retried or duplicated.  The server fingerprints each minidump's bytes as
+// they arrive and answers one it has processed before from a cache of
+// results, without processing it again.  Only the results of minidumps
+// whose modules all had symbols are cached, so that symbols added later
+// still show up.
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/cancellation_token.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/minidump.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "processor/caching_symbol_supplier.h"
+#include "processor/call_stack_cache.h"
+#include "processor/frame_symbol_cache.h"
+#include "processor/logging.h"
+#include "processor/minidump_result_cache.h"
+#include "processor/stackwalk_common.h"
+#include "processor/symbol_load_cache.h"
+#include "processor/symbol_path_cache.h"
+
+namespace {
+
+using google_breakpad::CachingSymbolSupplier;
+using google_breakpad::CallStackCache;
+using google_breakpad::CancellationToken;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::FrameSymbolCache;
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpMemoryList;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::MinidumpResultCache;
+using google_breakpad::MinidumpThreadList;
+using google_breakpad::ProcessResult;
+using google_breakpad::ProcessState;
+using google_breakpad::SourceLineResolverInterface;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::SymbolLoadCache;
+using google_breakpad::SymbolPathCache;
+using google_breakpad::SymbolSupplier;
+using std::chrono::steady_clock;
+
+// How long a connection may sit idle, or take to send a request, before
+// the server drops it and frees its worker.
+const int kIdleTimeoutSeconds = 30;
+
+// The longest request line accepted.
+const size_t kMaxRequestLine = 256;
+
+struct Options {
+  string socket_path;
+  string symbol_cache_path;
+  std::vector<string> symbol_paths;
+  int workers;
+  int max_waiting;
+  int timeout_ms;
+  uint64_t max_minidump_size;
+  uint64_t module_cache_budget;
+  int stackwalk_threads;
+  int missing_symbols_ttl_seconds;
+  bool index_symbol_paths;
+  // The most bytes of results cached in memory, and where they're also
+  // kept on disk, if anywhere.
+  uint64_t result_cache_bytes;
+  string result_directory;
+
+  // The minidump to send to a server, in client mode.
+  string request_file;
+};
+
+const char* ProcessResultName(ProcessResult result) {
+  switch (result) {
+    case google_breakpad::PROCESS_OK:
+      return "PROCESS_OK";
+    case google_breakpad::PROCESS_ERROR_MINIDUMP_NOT_FOUND:
+      return "PROCESS_ERROR_MINIDUMP_NOT_FOUND";
+    case google_breakpad::PROCESS_ERROR_NO_MINIDUMP_HEADER:
+      return "PROCESS_ERROR_NO_MINIDUMP_HEADER";
+    case google_breakpad::PROCESS_ERROR_NO_THREAD_LIST:
+      return "PROCESS_ERROR_NO_THREAD_LIST";
+    case google_breakpad::PROCESS_ERROR_GETTING_THREAD:
+      return "PROCESS_ERROR_GETTING_THREAD";
+    case google_breakpad::PROCESS_ERROR_GETTING_THREAD_ID:
+      return "PROCESS_ERROR_GETTING_THREAD_ID";
+    case google_breakpad::PROCESS_ERROR_DUPLICATE_REQUESTING_THREADS:
+      return "PROCESS_ERROR_DUPLICATE_REQUESTING_THREADS";
+    case google_breakpad::PROCESS_SYMBOL_SUPPLIER_INTERRUPTED:
+      return "PROCESS_SYMBOL_SUPPLIER_INTERRUPTED";
+    case google_breakpad::PROCESS_CANCELLED:
+      return "PROCESS_CANCELLED";
+  }
+  return "PROCESS_UNKNOWN";
+}
+
+// Connections accepted but not yet taken by a worker, up to a limit past
+// which they are turned away.
+class ConnectionQueue {
+ public:
+  explicit ConnectionQueue(size_t max_waiting) : max_waiting_(max_waiting) {}
+
+  // Queues |fd| for a worker, or returns false if the queue is full.
+  bool Push(int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fds_.size() >= max_waiting_)
+      return false;
+    fds_.push_back(fd);
+    ready_.notify_one();
+    return true;
+  }
+
+  // Waits for a connection and returns it.
+  int Pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (fds_.empty())
+      ready_.wait(lock);
+    int fd = fds_.front();
+    fds_.pop_front();
+    return fd;
+  }
+
+ private:
+  size_t max_waiting_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<int> fds_;
+};
+
+bool ReadFully(int fd, char* buffer, size_t size) {
+  while (size > 0) {
+    ssize_t result = read(fd, buffer, size);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+      return false;
+    buffer += result;
+    size -= result;
+  }
+  return true;
+}
+
+bool WriteFully(int fd, const char* buffer, size_t size) {
+  while (size > 0) {
+    ssize_t result = write(fd, buffer, size);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+      return false;
+    buffer += result;
+    size -= result;
+  }
+  return true;
+}
+
+// Reads a line, without its newline, into |line|.  Returns false at the end
+// of input, on error, or if the line is longer than kMaxRequestLine.
+bool ReadLine(int fd, string* line) {
+  line->clear();
+  char c;
+  while (ReadFully(fd, &c, 1)) {
+    if (c == '\n')
+      return true;
+    if (line->size() == kMaxRequestLine)
+      return false;
+    line->push_back(c);
+  }
+  return false;
+}
+
+bool WriteResponse(int fd, const char* status, const string& output) {
+  char header[64];
+  snprintf(header, sizeof(header), "%s %zu\n", status, output.size());
+  return WriteFully(fd, header, strlen(header)) &&
+         WriteFully(fd, output.data(), output.size());
+}
+
+// Processes |minidump|, giving up at |deadline|, and leaves its state in
+// minidump_stackwalk -m format in |output|.  Symbols are loaded through
+// |load_cache|, frames symbolized through |frame_cache|, and requesting
+// threads' stacks kept in |call_stack_cache|, all shared by all workers.
+// The output is cached in |result_cache|, if any, under |fingerprint| if
+// every module had symbols.
+ProcessResult ProcessMinidump(const Options& options,
+                              SymbolSupplier* supplier,
+                              SourceLineResolverInterface* resolver,
+                              SymbolLoadCache* load_cache,
+                              FrameSymbolCache* frame_cache,
+                              CallStackCache* call_stack_cache,
+                              MinidumpResultCache* result_cache,
+                              const string& fingerprint,
+                              const string& minidump,
+                              steady_clock::time_point deadline,
+                              string* output) {
+  StackFrameSymbolizer symbolizer(supplier, resolver);
+  symbolizer.set_symbol_load_cache(load_cache);
+  symbolizer.set_frame_symbol_cache(frame_cache);
+  CancellationToken cancellation_token;
+  cancellation_token.set_deadline(deadline);
+  MinidumpProcessor processor(&symbolizer, false);
+  processor.set_call_stack_cache(call_stack_cache);
+  processor.set_stackwalk_threads(options.stackwalk_threads);
+  processor.set_cancellation_token(&cancellation_token);
+
+  std::istringstream minidump_stream(minidump);
+  Minidump dump(minidump_stream);
+  if (!dump.Read()) {
+    BPLOG(ERROR) << "Minidump could not be read";
+    return google_breakpad::PROCESS_ERROR_MINIDUMP_NOT_FOUND;
+  }
+  ProcessState process_state;
+  ProcessResult result = processor.Process(&dump, &process_state);
+  if (result != google_breakpad::PROCESS_OK)
+    return result;
+
+  char* buffer = NULL;
+  size_t size = 0;
+  FILE* out = open_memstream(&buffer, &size);
+  if (!out) {
+    BPLOG(ERROR) << "Could not buffer output: " << strerror(errno);
+    return google_breakpad::PROCESS_SYMBOL_SUPPLIER_INTERRUPTED;
+  }
+  PrintProcessStateMachineReadable(process_state, out);
+  fclose(out);
+  output->assign(buffer, size);
+  free(buffer);
+  if (result_cache && process_state.modules_without_symbols()->empty() &&
+      process_state.modules_with_corrupt_symbols()->empty()) {
+    result_cache->Insert(fingerprint, *output);
+  }
+  return result;
+}
+
+// Answers requests on |fd| until the client closes the connection or
+// sends something the server doesn't understand.
+void ServeConnection(const Options& options,
+                     SymbolSupplier* supplier,
+                     SourceLineResolverInterface* resolver,
+                     SymbolLoadCache* load_cache,
+                     FrameSymbolCache* frame_cache,
+                     CallStackCache* call_stack_cache,
+                     MinidumpResultCache* result_cache,
+                     const string& result_salt,
+                     int fd) {
+  string line;
+  while (ReadLine(fd, &line)) {
+    unsigned long long size = 0;
+    int timeout_ms = options.timeout_ms;
+    char extra;
+    int fields = sscanf(line.c_str(), "PROCESS %llu %d %c",
+                        &size, &timeout_ms, &extra);
+    if (fields < 1 || fields > 2 || timeout_ms <= 0 ||
+        size > options.max_minidump_size) {
+      BPLOG(ERROR) << "Bad request: " << line;
+      WriteResponse(fd, "BAD_REQUEST", string());
+      return;
+    }
+
+    steady_clock::time_point deadline =
+        steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    // Fingerprint the minidump a piece at a time, as it's received.
+    string minidump(size, '\0');
+    MinidumpResultCache::Fingerprinter fingerprinter(result_salt);
+    for (size_t offset = 0; offset < size; ) {
+      size_t piece = std::min(static_cast<size_t>(size - offset),
+                              static_cast<size_t>(64 << 10));
+      if (!ReadFully(fd, &minidump[offset], piece)) {
+        BPLOG(ERROR) << "Minidump of " << size << " bytes cut short";
+        return;
+      }
+      if (result_cache)
+        fingerprinter.Update(&minidump[offset], piece);
+      offset += piece;
+    }
+
+    string output;
+    string fingerprint;
+    if (result_cache) {
+      fingerprint = fingerprinter.Finish();
+      if (result_cache->Find(fingerprint, &output)) {
+        BPLOG(INFO) << "Answered a minidump of " << size
+                    << " bytes from the result cache";
+        if (!WriteResponse(fd, "PROCESS_OK", output))
+          return;
+        continue;
+      }
+    }
+    ProcessResult result = ProcessMinidump(options, supplier, resolver,
+                                           load_cache, frame_cache,
+                                           call_stack_cache, result_cache,
+                                           fingerprint, minidump, deadline,
+                                           &output);
+    BPLOG(INFO) << "Processed a minidump of " << size << " bytes: "
+                << ProcessResultName(result);
+    if (!WriteResponse(fd, ProcessResultName(result), output))
+      return;
+  }
+}
+
+bool Serve(const Options& options) {
+  // The resolver is destroyed before the supplier, which owns the mapped
+  // symbol data that it points into.  Both are shared by all workers, as
+  // are the caches.
+  SymbolPathCache path_cache(
+      std::chrono::seconds(options.missing_symbols_ttl_seconds));
+  if (options.index_symbol_paths) {
+    for (size_t i = 0; i < options.symbol_paths.size(); ++i)
+      path_cache.IndexRoot(options.symbol_paths[i]);
+  }
+  CachingSymbolSupplier supplier(options.symbol_paths,
+                                 options.symbol_cache_path);
+  supplier.set_path_cache(&path_cache);
+  FastSourceLineResolver resolver(true);
+  resolver.SetModuleCacheBudget(options.module_cache_budget);
+  SymbolLoadCache load_cache(
+      std::chrono::seconds(options.missing_symbols_ttl_seconds));
+  FrameSymbolCache frame_cache;
+  CallStackCache call_stack_cache;
+  std::unique_ptr<MinidumpResultCache> result_cache;
+  if (options.result_cache_bytes > 0 || !options.result_directory.empty()) {
+    result_cache.reset(new MinidumpResultCache(
+        static_cast<size_t>(options.result_cache_bytes)));
+    result_cache->set_directory(options.result_directory);
+  }
+  // Results depend on the symbols they were made with, so a result
+  // directory shared with servers using other symbols mustn't mix them up.
+  string result_salt = "machine-readable";
+  for (size_t i = 0; i < options.symbol_paths.size(); ++i)
+    result_salt += "\n" + options.symbol_paths[i];
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    BPLOG(ERROR) << "Could not create socket: " << strerror(errno);
+    return false;
+  }
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (options.socket_path.size() >= sizeof(address.sun_path)) {
+    BPLOG(ERROR) << "Socket path too long: " << options.socket_path;
+    close(listen_fd);
+    return false;
+  }
+  strcpy(address.sun_path, options.socket_path.c_str());
+  unlink(options.socket_path.c_str());
+  if (bind(listen_fd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(listen_fd, options.max_waiting) != 0) {
+    BPLOG(ERROR) << "Could not listen on " << options.socket_path << ": "
+                 << strerror(errno);
+    close(listen_fd);
+    return false;
+  }
+
+  // A client that hangs up early must not take the server down with it.
+  signal(SIGPIPE, SIG_IGN);
+
+  ConnectionQueue queue(options.max_waiting);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < options.workers; ++i) {
+    workers.push_back(std::thread([&]() {
+      while (true) {
+        int fd = queue.Pop();
+        ServeConnection(options, &supplier, &resolver, &load_cache,
+                        &frame_cache, &call_stack_cache, result_cache.get(),
+                        result_salt, fd);
+        close(fd);
+      }
+    }));
+  }
+
+  BPLOG(INFO) << "Serving on " << options.socket_path;
+  while (true) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      BPLOG(ERROR) << "Could not accept connection: " << strerror(errno);
+      break;
+    }
+    struct timeval timeout;
+    timeout.tv_sec = kIdleTimeoutSeconds;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (!queue.Push(fd)) {
+      BPLOG(INFO) << "Too many connections waiting, turning one away";
+      WriteResponse(fd, "BUSY", string());
+      close(fd);
+    }
+  }
+
+  // The workers never return, and hold references to the supplier and the
+  // resolver, so leave them running to the end of the process.
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].detach();
+  close(listen_fd);
+  return false;
+}
+
+// Sends |options.request_file| to the server at |options.socket_path| and
+// prints the output of processing it to stdout.  Returns true if it was
+// processed successfully.
+bool SendRequest(const Options& options) {
+  std::ifstream file(options.request_file.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    BPLOG(ERROR) << "Could not open " << options.request_file;
+    return false;
+  }
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  string minidump = contents.str();
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (fd < 0 || options.socket_path.size() >= sizeof(address.sun_path)) {
+    BPLOG(ERROR) << "Could not create socket for " << options.socket_path;
+    if (fd >= 0)
+      close(fd);
+    return false;
+  }
+  strcpy(address.sun_path, options.socket_path.c_str());
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&address),
+              sizeof(address)) != 0) {
+    BPLOG(ERROR) << "Could not connect to " << options.socket_path << ": "
+                 << strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  char request[64];
+  snprintf(request, sizeof(request), "PROCESS %zu %d\n", minidump.size(),
+           options.timeout_ms);
+  string status_line;
+  char status[64];
+  unsigned long long size = 0;
+  bool succeeded =
+      WriteFully(fd, request, strlen(request)) &&
+      WriteFully(fd, minidump.data(), minidump.size()) &&
+      ReadLine(fd, &status_line) &&
+      sscanf(status_line.c_str(), "%63s %llu", status, &size) == 2;
+  string output(size, '\0');
+  succeeded = succeeded && (size == 0 || ReadFully(fd, &output[0], size));
+  close(fd);
+  if (!succeeded) {
+    BPLOG(ERROR) << "No response from " << options.socket_path;
+    return false;
+  }
+
+  fwrite(output.data(), 1, output.size(), stdout);
+  if (strcmp(status, "PROCESS_OK") != 0) {
+    fprintf(stderr, "%s\n", status);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+static void Usage(int argc, const char *argv[], bool error) {
+  fprintf(error ? stderr : stdout,
+          "Usage: %s [options] -f <dir> <socket> [symbol-path ...]\n"
+          "       %s [-t <ms>] -r <minidump-file> <socket>\n"
+          "\n"
+          "Serve minidump processing requests on the Unix domain socket\n"
+          "<socket>, or with -r, send one to the server there and print\n"
+          "the result\n"
+          "\n"
+          "Options:\n"
+          "\n"
+          "  -f <dir>    Cache symbols in <dir> in the fast-loading format\n"
+          "  -w <n>      Serve up to <n> connections at once (default 4)\n"
+          "  -q <n>      Turn away connections once <n> are waiting for\n"
+          "              a worker (default 16)\n"
+          "  -t <ms>     Give up on a minidump after <ms> milliseconds\n"
+          "              (default 30000)\n"
+          "  -s <bytes>  Refuse minidumps larger than <bytes>\n"
+          "              (default 268435456)\n"
+          "  -m <bytes>  Unload the least recently used symbols to keep\n"
+          "              them within <bytes> (default 0, no limit)\n"
+          "  -j <n>      Walk up to <n> threads' stacks of a minidump at "
+          "once\n"
+          "  -n <s>      Remember modules missing their symbols, and where\n"
+          "              symbol files are, for <s> seconds before looking\n"
+          "              for them again (default 300)\n"
+          "  -I          List the symbol files in each symbol path at\n"
+          "              startup, and use the list for -n seconds rather\n"
+          "              than looking for each module's\n"
+          "  -c <bytes>  Keep up to <bytes> of results in memory, to answer\n"
+          "              minidumps sent again (default 67108864, 0 for none)\n"
+          "  -d <dir>    Keep results in <dir> as well, shared with other\n"
+          "              servers using the same directory\n"
+          "  -r <file>   Send the minidump <file> to the server\n",
+          google_breakpad::BaseName(argv[0]).c_str(),
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+static int PositiveIntArgument(int argc, const char *argv[],
+                               const char* value) {
+  int result = atoi(value);
+  if (result < 1) {
+    fprintf(stderr, "%s: Invalid count: %s\n", argv[0], value);
+    Usage(argc, argv, true);
+    exit(1);
+  }
+  return result;
+}
+
+static void SetupOptions(int argc, const char *argv[], Options* options) {
+  int ch;
+
+  options->workers = 4;
+  options->max_waiting = 16;
+  options->timeout_ms = 30000;
+  options->max_minidump_size = 256 << 20;
+  options->module_cache_budget = 0;
+  options->stackwalk_threads = 1;
+  options->missing_symbols_ttl_seconds =
+      SymbolLoadCache::kDefaultMissingSymbolsTTLSeconds;
+  options->index_symbol_paths = false;
+  options->result_cache_bytes = MinidumpResultCache::kDefaultMaxBytes;
+
+  while ((ch = getopt(argc, (char * const*)argv,
+                      "Ic:d:f:hj:m:n:q:r:s:t:w:")) != -1) {
+    switch (ch) {
+      case 'h':
+        Usage(argc, argv, false);
+        exit(0);
+        break;
+
+      case 'I':
+        options->index_symbol_paths = true;
+        break;
+      case 'c':
+        options->result_cache_bytes = strtoull(optarg, NULL, 10);
+        break;
+      case 'd':
+        options->result_directory = optarg;
+        break;
+      case 'f':
+        options->symbol_cache_path = optarg;
+        break;
+      case 'j':
+        options->stackwalk_threads = PositiveIntArgument(argc, argv, optarg);
+        break;
+      case 'm':
+        options->module_cache_budget = strtoull(optarg, NULL, 10);
+        break;
+      case 'n':
+        options->missing_symbols_ttl_seconds = atoi(optarg);
+        if (options->missing_symbols_ttl_seconds < 0) {
+          fprintf(stderr, "%s: Invalid time: %s\n", argv[0], optarg);
+          Usage(argc, argv, true);
+          exit(1);
+        }
+        break;
+      case 'q':
+        options->max_waiting = PositiveIntArgument(argc, argv, optarg);
+        break;
+      case 'r':
+        options->request_file = optarg;
+        break;
+      case 's':
+        options->max_minidump_size = strtoull(optarg, NULL, 10);
+        break;
+      case 't':
+        options->timeout_ms = PositiveIntArgument(argc, argv, optarg);
+        break;
+      case 'w':
+        options->workers = PositiveIntArgument(argc, argv, optarg);
+        break;
+
+      case '?':
+        Usage(argc, argv, true);
+        exit(1);
+        break;
+    }
+  }
+
+  if ((argc - optind) == 0) {
+    fprintf(stderr, "%s: Missing socket\n", argv[0]);
+    Usage(argc, argv, true);
+    exit(1);
+  }
+  if (options->request_file.empty() && options->symbol_cache_path.empty()) {
+    fprintf(stderr, "%s: Missing symbol cache directory\n", argv[0]);
+    Usage(argc, argv, true);
+    exit(1);
+  }
+
+  options->socket_path = argv[optind];
+
+  for (int argi = optind + 1; argi < argc; ++argi)
+    options->symbol_paths.push_back(argv[argi]);
+}
+
+int main(int argc, const char* argv[]) {
+  Options options;
+  SetupOptions(argc, argv, &options);
+
+  if (!options.request_file.empty())
+    return SendRequest(options) ? 0 : 1;
+
+  // Increase the maximum number of threads and regions.
+  MinidumpThreadList::set_max_threads(std::numeric_limits<uint32_t>::max());
+  MinidumpMemoryList::set_max_regions(std::numeric_limits<uint32_t>::max());
+
+  return Serve(options) ? 0 : 1;
+}
@@ -32,12 +32,14 @@
 
 #include <iostream>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <stdlib.h>
 #include <string>
 #include <vector>
 
 #include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/common/minidump_format.h"
 #include "google_breakpad/processor/minidump.h"
@@ -46,9 +48,12 @@
 
 namespace {
 
+using google_breakpad::AutoTempDir;
 using google_breakpad::Minidump;
 using google_breakpad::MinidumpContext;
 using google_breakpad::MinidumpException;
+using google_breakpad::MinidumpLinuxMaps;
+using google_breakpad::MinidumpLinuxMapsList;
 using google_breakpad::MinidumpMemoryInfo;
 using google_breakpad::MinidumpMemoryInfoList;
 using google_breakpad::MinidumpMemoryList;
@@ -105,6 +110,30 @@ TEST_F(MinidumpTest, TestMinidumpFromFile) {
   ASSERT_EQ("5A9832E5287241C1838ED98914E9B7FF1", md_module->debug_identifier());
 }
 
+TEST_F(MinidumpTest, TestRoutingKey) {
+  // Reads the minidump itself, as far as it needs to.
+  Minidump minidump(minidump_file_);
+  Minidump::RoutingKey key;
+  ASSERT_TRUE(minidump.GetRoutingKey(3, &key));
+  EXPECT_NE(0U, key.build_fingerprint);
+  ASSERT_EQ(3U, key.heavy_modules.size());
+  EXPECT_EQ("ole32.pdb/683B65B246F4418796D2EE6D4C55EB112",
+            key.heavy_modules[0]);
+  EXPECT_EQ("kernel32.pdb/BCE8785C57B44245A669896B6A19B9542",
+            key.heavy_modules[1]);
+  EXPECT_EQ("ntdll.pdb/36515FB5D04345E491F672FA2E2878C02",
+            key.heavy_modules[2]);
+
+  // Another read of the same build gets the same key.
+  Minidump again(minidump_file_);
+  ASSERT_TRUE(again.Read());
+  Minidump::RoutingKey again_key;
+  ASSERT_TRUE(again.GetRoutingKey(1, &again_key));
+  EXPECT_EQ(key.build_fingerprint, again_key.build_fingerprint);
+  ASSERT_EQ(1U, again_key.heavy_modules.size());
+  EXPECT_EQ(key.heavy_modules[0], again_key.heavy_modules[0]);
+}
+
 TEST_F(MinidumpTest, TestMinidumpFromStream) {
   // read minidump contents into memory, construct a stringstream around them
   ifstream file_stream(minidump_file_.c_str(), std::ios::in);
@@ -131,6 +160,170 @@ TEST_F(MinidumpTest, TestMinidumpFromStream) {
   //TODO: add more checks here
 }
 
+TEST_F(MinidumpTest, TestMinidumpFromMappedFile) {
+  Minidump streamed(minidump_file_);
+  ASSERT_TRUE(streamed.Read());
+  EXPECT_TRUE(streamed.GetMappedBytes(0, 1) == NULL);
+
+  Minidump mapped(minidump_file_);
+  mapped.set_use_mmap(true);
+  ASSERT_TRUE(mapped.Read());
+  const MDRawHeader* header = mapped.header();
+  ASSERT_NE(header, (MDRawHeader*)NULL);
+  ASSERT_EQ(header->signature, uint32_t(MD_HEADER_SIGNATURE));
+  const uint8_t* signature = mapped.GetMappedBytes(0, sizeof(uint32_t));
+  ASSERT_TRUE(signature != NULL);
+  EXPECT_EQ(0, memcmp(signature, &header->signature, sizeof(uint32_t)));
+
+  // The mapping ends where the file does.
+  ifstream file_stream(minidump_file_.c_str(), std::ios::in);
+  file_stream.seekg(0, std::ios_base::end);
+  off_t file_size = file_stream.tellg();
+  EXPECT_TRUE(mapped.GetMappedBytes(file_size, 0) != NULL);
+  EXPECT_TRUE(mapped.GetMappedBytes(file_size, 1) == NULL);
+  EXPECT_TRUE(mapped.GetMappedBytes(file_size - 1, 2) == NULL);
+
+  MinidumpModuleList* md_module_list = mapped.GetModuleList();
+  ASSERT_TRUE(md_module_list != NULL);
+  const MinidumpModule* md_module = md_module_list->GetModuleAtIndex(0);
+  ASSERT_TRUE(md_module != NULL);
+  ASSERT_EQ("c:\\test_app.exe", md_module->code_file());
+  ASSERT_EQ("5A9832E5287241C1838ED98914E9B7FF1", md_module->debug_identifier());
+
+  // Each thread's stack is read in place from the mapping, with the same
+  // contents as when it's read through a stream.
+  MinidumpThreadList* streamed_threads = streamed.GetThreadList();
+  MinidumpThreadList* mapped_threads = mapped.GetThreadList();
+  ASSERT_TRUE(streamed_threads != NULL);
+  ASSERT_TRUE(mapped_threads != NULL);
+  ASSERT_EQ(streamed_threads->thread_count(), mapped_threads->thread_count());
+  ASSERT_LT(0U, mapped_threads->thread_count());
+  for (unsigned int i = 0; i < mapped_threads->thread_count(); ++i) {
+    MinidumpMemoryRegion* streamed_stack =
+        streamed_threads->GetThreadAtIndex(i)->GetMemory();
+    MinidumpMemoryRegion* mapped_stack =
+        mapped_threads->GetThreadAtIndex(i)->GetMemory();
+    ASSERT_TRUE(streamed_stack != NULL);
+    ASSERT_TRUE(mapped_stack != NULL);
+    ASSERT_EQ(streamed_stack->GetBase(), mapped_stack->GetBase());
+    ASSERT_EQ(streamed_stack->GetSize(), mapped_stack->GetSize());
+    const uint8_t* memory = mapped_stack->GetMemory();
+    ASSERT_TRUE(memory != NULL);
+    EXPECT_EQ(0, memcmp(streamed_stack->GetMemory(), memory,
+                        mapped_stack->GetSize()));
+    EXPECT_TRUE(memory >= signature && memory < signature + file_size);
+  }
+}
+
+// Appends a compressed minidump record placing |data| at |rva|, compressed
+// if |compress| is set.  Compression only turns runs of a byte into
+// matches, which is enough to exercise the decoder.
+void AppendCompressedRecord(MDRVA rva, const string& data, bool compress,
+                            string* compressed) {
+  string block;
+  if (compress) {
+    // LZ4 requires matches to start at least 12 bytes before the end of
+    // the block and to end at least 5 bytes before it.
+    const size_t kMatchStartLimit = data.size() > 12 ? data.size() - 12 : 0;
+    const size_t kMatchEndLimit = data.size() > 5 ? data.size() - 5 : 0;
+    size_t anchor = 0;
+    for (size_t i = 1; i < kMatchStartLimit; ++i) {
+      size_t run = 0;
+      while (i + run < kMatchEndLimit && data[i + run] == data[i - 1])
+        ++run;
+      if (run < 4)
+        continue;
+      const size_t literals = i - anchor;
+      const size_t extra = run - 4;
+      block += static_cast<char>(((literals < 15 ? literals : 15) << 4) |
+                                 (extra < 15 ? extra : 15));
+      if (literals >= 15) {
+        size_t length = literals - 15;
+        for (; length >= 255; length -= 255)
+          block += static_cast<char>(255);
+        block += static_cast<char>(length);
+      }
+      block += data.substr(anchor, literals);
+      block += '\x01';
+      block += '\x00';
+      if (extra >= 15) {
+        size_t length = extra - 15;
+        for (; length >= 255; length -= 255)
+          block += static_cast<char>(255);
+        block += static_cast<char>(length);
+      }
+      i += run;
+      anchor = i;
+    }
+    const size_t literals = data.size() - anchor;
+    block += static_cast<char>((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) {
+      size_t length = literals - 15;
+      for (; length >= 255; length -= 255)
+        block += static_cast<char>(255);
+      block += static_cast<char>(length);
+    }
+    block += data.substr(anchor);
+  }
+
+  MDRawCompressedRecord record;
+  record.rva = rva;
+  record.data_size = data.size();
+  record.compressed_size = block.size();
+  compressed->append(reinterpret_cast<const char*>(&record), sizeof(record));
+  compressed->append(compress ? block : data);
+}
+
+TEST_F(MinidumpTest, TestMinidumpFromCompressedFile) {
+  ifstream file_stream(minidump_file_.c_str(), std::ios::in | std::ios::binary);
+  ASSERT_TRUE(file_stream.good());
+  const string original((std::istreambuf_iterator<char>(file_stream)),
+                        std::istreambuf_iterator<char>());
+
+  MDRawCompressedHeader header;
+  header.signature = MD_COMPRESSED_HEADER_SIGNATURE;
+  header.version = MD_COMPRESSED_HEADER_VERSION;
+  string compressed(reinterpret_cast<const char*>(&header), sizeof(header));
+  // Garbage where the header goes, which a later record replaces.
+  AppendCompressedRecord(0, string(64, 'x'), false, &compressed);
+  // The rest in chunks, alternately stored and compressed, ending with the
+  // header.
+  const size_t kChunkSize = 4096;
+  for (size_t offset = 64; offset < original.size(); offset += kChunkSize) {
+    AppendCompressedRecord(offset, original.substr(offset, kChunkSize),
+                           (offset / kChunkSize) % 2, &compressed);
+  }
+  AppendCompressedRecord(0, original.substr(0, 64), true, &compressed);
+  EXPECT_LT(compressed.size(), original.size());
+
+  AutoTempDir temp_dir;
+  const string path = temp_dir.path() + "/compressed.dmp";
+  {
+    std::ofstream out(path.c_str(), std::ios::out | std::ios::binary);
+    out << compressed;
+  }
+
+  Minidump minidump(path);
+  ASSERT_TRUE(minidump.Read());
+  const MDRawHeader* raw_header = minidump.header();
+  ASSERT_NE(raw_header, (MDRawHeader*)NULL);
+  ASSERT_EQ(raw_header->signature, uint32_t(MD_HEADER_SIGNATURE));
+  MinidumpModuleList* md_module_list = minidump.GetModuleList();
+  ASSERT_TRUE(md_module_list != NULL);
+  const MinidumpModule* md_module = md_module_list->GetModuleAtIndex(0);
+  ASSERT_TRUE(md_module != NULL);
+  ASSERT_EQ("c:\\test_app.exe", md_module->code_file());
+  ASSERT_EQ("5A9832E5287241C1838ED98914E9B7FF1", md_module->debug_identifier());
+
+  // A truncated file doesn't decompress.
+  {
+    std::ofstream out(path.c_str(), std::ios::out | std::ios::binary);
+    out << compressed.substr(0, compressed.size() - 1);
+  }
+  Minidump truncated(path);
+  EXPECT_FALSE(truncated.Read());
+}
+
 TEST(Dump, ReadBackEmpty) {
   Dump dump(0);
   dump.Finish();
@@ -218,6 +411,238 @@ TEST(Dump, OneMemory) {
   ASSERT_TRUE(memcmp("memory contents", region1_bytes, 15) == 0);
 }
 
+// GetMemoryAtAddresses reads the same values as GetMemoryAtAddress would,
+// byte-swapped, stopping at the end of the region; GetMemorySpan gives
+// direct access to the bytes.
+TEST(Dump, MemoryAtAddresses) {
+  Dump dump(0, kBigEndian);
+  Memory memory(dump, 0x1000);
+  memory.D32(0x01020304).D32(0x05060708).D32(0x090a0b0c).D32(0x0d0e0f10)
+      .D32(0x11121314).D8(0xff).D8(0xfe);
+  dump.Add(&memory);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  MinidumpMemoryRegion* region = memory_list->GetMemoryRegionAtIndex(0);
+  ASSERT_TRUE(region != NULL);
+
+  for (uint64_t address = 0x0ffc; address < 0x1018; address += 2) {
+    uint32_t values32[8];
+    size_t read32 = region->GetMemoryAtAddresses(address, values32, 8);
+    size_t expected32 = 0;
+    uint32_t value32;
+    while (expected32 < 8 &&
+           region->GetMemoryAtAddress(address + expected32 * 4, &value32)) {
+      EXPECT_EQ(value32, values32[expected32]) << address;
+      ++expected32;
+    }
+    EXPECT_EQ(expected32, read32) << address;
+
+    uint64_t values64[4];
+    size_t read64 = region->GetMemoryAtAddresses(address, values64, 4);
+    size_t expected64 = 0;
+    uint64_t value64;
+    while (expected64 < 4 &&
+           region->GetMemoryAtAddress(address + expected64 * 8, &value64)) {
+      EXPECT_EQ(value64, values64[expected64]) << address;
+      ++expected64;
+    }
+    EXPECT_EQ(expected64, read64) << address;
+  }
+
+  // Whole runs of words come out in the host's byte order.
+  uint32_t values32[5];
+  ASSERT_EQ(5U, region->GetMemoryAtAddresses(0x1000, values32, 5));
+  EXPECT_EQ(0x01020304U, values32[0]);
+  EXPECT_EQ(0x11121314U, values32[4]);
+  uint64_t values64[2];
+  ASSERT_EQ(2U, region->GetMemoryAtAddresses(0x1004, values64, 2));
+  EXPECT_EQ(0x05060708090a0b0cULL, values64[0]);
+  EXPECT_EQ(0x0d0e0f1011121314ULL, values64[1]);
+
+  // Spans are the region's bytes as stored.
+  size_t span_length = 1;
+  EXPECT_EQ(NULL, region->GetMemorySpan(0x0fff, 4, &span_length));
+  EXPECT_EQ(0U, span_length);
+  EXPECT_EQ(NULL, region->GetMemorySpan(0x1016, 4, &span_length));
+  EXPECT_EQ(0U, span_length);
+  const uint8_t* span = region->GetMemorySpan(0x1004, 8, &span_length);
+  ASSERT_TRUE(span != NULL);
+  EXPECT_EQ(8U, span_length);
+  EXPECT_EQ(region->GetMemory() + 4, span);
+  EXPECT_EQ(0x05, span[0]);
+  EXPECT_EQ(0x0c, span[7]);
+  span = region->GetMemorySpan(0x1010, 100, &span_length);
+  ASSERT_TRUE(span != NULL);
+  EXPECT_EQ(6U, span_length);
+  EXPECT_EQ(0xfe, span[5]);
+
+  uint32_t value;
+  EXPECT_EQ(1U, region->GetMemoryAtAddresses(0x1008, &value, 1));
+  EXPECT_EQ(0x090a0b0cU, value);
+  EXPECT_EQ(0U, region->GetMemoryAtAddresses(0x1000, &value, 0));
+}
+
+TEST(Dump, MemoryByPage) {
+  const uint32_t kPageSize = MinidumpMemoryRegion::kPageSize;
+  Dump dump(0, kLittleEndian);
+  Memory memory(dump, 0x10000);
+  for (uint32_t i = 0; i < 4 * kPageSize; ++i)
+    memory.D8(i / kPageSize + 1);
+  dump.Add(&memory);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  minidump.set_load_memory_by_page(true);
+  minidump.set_memory_budget(3 * kPageSize);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  MinidumpMemoryRegion* region = memory_list->GetMemoryRegionAtIndex(0);
+  ASSERT_TRUE(region != NULL);
+  uint64_t bytes_read = minidump.memory_bytes_read();
+
+  // Reading a value reads just the page holding it.
+  uint8_t value8;
+  ASSERT_TRUE(region->GetMemoryAtAddress(0x10000 + kPageSize + 5, &value8));
+  EXPECT_EQ(2U, value8);
+  EXPECT_EQ(bytes_read + kPageSize, minidump.memory_bytes_read());
+  ASSERT_TRUE(region->GetMemoryAtAddress(0x10000 + kPageSize, &value8));
+  EXPECT_EQ(bytes_read + kPageSize, minidump.memory_bytes_read());
+
+  // A value that straddles pages reads the one not yet read.
+  uint32_t value32;
+  ASSERT_TRUE(region->GetMemoryAtAddress(0x10000 + kPageSize - 2, &value32));
+  EXPECT_EQ(0x02020101U, value32);
+  EXPECT_EQ(bytes_read + 2 * kPageSize, minidump.memory_bytes_read());
+
+  // Spans are contiguous across pages.
+  size_t span_length;
+  const uint8_t* span =
+      region->GetMemorySpan(0x10000 + kPageSize - 1, 2, &span_length);
+  ASSERT_TRUE(span != NULL);
+  ASSERT_EQ(2U, span_length);
+  EXPECT_EQ(1U, span[0]);
+  EXPECT_EQ(2U, span[1]);
+
+  // The budget leaves room for one more page, but not two.
+  ASSERT_TRUE(region->GetMemoryAtAddress(0x10000 + 3 * kPageSize, &value8));
+  EXPECT_EQ(4U, value8);
+  EXPECT_FALSE(region->GetMemoryAtAddress(0x10000 + 2 * kPageSize, &value8));
+  EXPECT_TRUE(region->GetMemory() == NULL);
+  EXPECT_TRUE(region->GetMemoryAtAddress(0x10000, &value8));
+  EXPECT_EQ(bytes_read + 3 * kPageSize, minidump.memory_bytes_read());
+}
+
+TEST(Dump, MemoryByPageWhole) {
+  const uint32_t kPageSize = MinidumpMemoryRegion::kPageSize;
+  Dump dump(0, kLittleEndian);
+  Memory memory(dump, 0x10000);
+  for (uint32_t i = 0; i < 2 * kPageSize + 10; ++i)
+    memory.D8(i / kPageSize + 1);
+  dump.Add(&memory);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  minidump.set_load_memory_by_page(true);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  MinidumpMemoryRegion* region = memory_list->GetMemoryRegionAtIndex(0);
+  ASSERT_TRUE(region != NULL);
+  uint64_t bytes_read = minidump.memory_bytes_read();
+
+  uint8_t value8;
+  ASSERT_TRUE(region->GetMemoryAtAddress(0x10000 + kPageSize, &value8));
+  EXPECT_EQ(2U, value8);
+
+  // GetMemory reads the rest, including the partial last page.
+  const uint8_t* bytes = region->GetMemory();
+  ASSERT_TRUE(bytes != NULL);
+  EXPECT_EQ(bytes_read + 2 * kPageSize + 10, minidump.memory_bytes_read());
+  EXPECT_EQ(1U, bytes[0]);
+  EXPECT_EQ(2U, bytes[2 * kPageSize - 1]);
+  EXPECT_EQ(3U, bytes[2 * kPageSize + 9]);
+  EXPECT_FALSE(region->GetMemoryAtAddress(0x10000 + 2 * kPageSize + 10,
+                                          &value8));
+}
+
+TEST(Dump, MemoryRegionsByAddress) {
+  Dump dump(0, kLittleEndian);
+  // Listed out of address order, with gaps between them.
+  Memory memory1(dump, 0x3000);
+  memory1.Append(0x100, 0x33);
+  dump.Add(&memory1);
+  Memory memory2(dump, 0x1000);
+  memory2.Append(0x10, 0x11);
+  dump.Add(&memory2);
+  Memory memory3(dump, 0x2000);
+  memory3.Append(0x800, 0x22);
+  dump.Add(&memory3);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpMemoryList* memory_list = minidump.GetMemoryList();
+  ASSERT_TRUE(memory_list != NULL);
+  ASSERT_EQ(3U, memory_list->region_count());
+
+  struct {
+    uint64_t address;
+    uint64_t base;  // 0 if no region contains address.
+  } lookups[] = {
+    { 0x0000, 0 },      { 0x0fff, 0 },      { 0x1000, 0x1000 },
+    { 0x1008, 0x1000 }, { 0x100f, 0x1000 }, { 0x1010, 0 },
+    { 0x1fff, 0 },      { 0x2000, 0x2000 }, { 0x27ff, 0x2000 },
+    { 0x2800, 0 },      { 0x3000, 0x3000 }, { 0x30ff, 0x3000 },
+    { 0x3100, 0 },      { 0x3000, 0x3000 }, { 0x3000, 0x3000 },
+    { 0x1004, 0x1000 }, { ~0ULL, 0 },
+  };
+  for (size_t i = 0; i < sizeof(lookups) / sizeof(lookups[0]); ++i) {
+    MinidumpMemoryRegion* region =
+        memory_list->GetMemoryRegionForAddress(lookups[i].address);
+    if (lookups[i].base == 0) {
+      EXPECT_TRUE(region == NULL) << lookups[i].address;
+    } else {
+      ASSERT_TRUE(region != NULL) << lookups[i].address;
+      EXPECT_EQ(lookups[i].base, region->GetBase()) << lookups[i].address;
+    }
+  }
+}
+
+TEST(Dump, OverlappingMemoryRegions) {
+  Dump dump(0, kLittleEndian);
+  Memory memory1(dump, 0x2000);
+  memory1.Append(0x100, 0x22);
+  dump.Add(&memory1);
+  Memory memory2(dump, 0x1000);
+  memory2.Append(0x1001, 0x11);
+  dump.Add(&memory2);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+  EXPECT_TRUE(minidump.GetMemoryList() == NULL);
+}
+
 // One thread --- and its requisite entourage.
 TEST(Dump, OneThread) {
   Dump dump(0, kLittleEndian);
@@ -532,6 +957,60 @@ TEST(Dump, OneModule) {
                      sizeof(fixed_file_info)) == 0);
 }
 
+// Test that a module's CodeView record is only read once it's needed.
+TEST(Dump, OneModuleLazyCVRecord) {
+  Dump dump(0, kLittleEndian);
+  String module_name(dump, "single module");
+  Section cv_info(dump);
+  cv_info
+    .D32(MD_CVINFOPDB70_SIGNATURE)  // signature
+    // signature, a MDGUID
+    .D32(0xabcd1234)
+    .D16(0xf00d)
+    .D16(0xbeef)
+    .Append("\x01\x02\x03\x04\x05\x06\x07\x08")
+    .D32(1) // age
+    .AppendCString("c:\\foo\\file.pdb");  // pdb_file_name
+
+  String csd_version(dump, "Windows 9000");
+  SystemInfo system_info(dump, SystemInfo::windows_x86, csd_version);
+
+  Module module(dump, 0xa90206ca83eb2852ULL, 0xada542bd,
+                module_name,
+                0xb1054d2a,
+                0x34571371,
+                fixed_file_info, // from synth_minidump_unittest_data.h
+                &cv_info, nullptr);
+
+  dump.Add(&module);
+  dump.Add(&module_name);
+  dump.Add(&cv_info);
+  dump.Add(&system_info);
+  dump.Add(&csd_version);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpModuleList* md_module_list = minidump.GetModuleList();
+  ASSERT_TRUE(md_module_list != NULL);
+  ASSERT_EQ(1U, md_module_list->module_count());
+  const MinidumpModule* md_module = md_module_list->GetModuleAtIndex(0);
+  ASSERT_TRUE(md_module != NULL);
+  ASSERT_EQ("single module", md_module->code_file());
+
+  // Change the record in place: the module, read before the change, sees it.
+  size_t pdb_file_name = contents.find("c:\\foo\\file.pdb");
+  ASSERT_NE(string::npos, pdb_file_name);
+  contents.replace(pdb_file_name, 15, "c:\\foo\\late.pdb");
+  minidump_stream.str(contents);
+  ASSERT_EQ("c:\\foo\\late.pdb", md_module->debug_file());
+  ASSERT_EQ("ABCD1234F00DBEEF01020304050607081", md_module->debug_identifier());
+}
+
 // Test that a module with a MDCVInfoELF CV record is handled properly.
 TEST(Dump, OneModuleCVELF) {
   Dump dump(0, kLittleEndian);
@@ -1046,6 +1525,63 @@ TEST(Dump, OneMemoryInfo) {
   ASSERT_EQ(kRegionSize, info2->GetSize());
 }
 
+TEST(Dump, LinuxMaps) {
+  Dump dump(0, kLittleEndian);
+  Stream stream(dump, MD_LINUX_MAPS);
+  stream.Append("00400000-00452000 r-xp 00000000 08:02 173521 /bin/app\n"
+                "00651000-00652000 rw-p 00051000 08:02 173521 /bin/app\n"
+                "7fff0000-7fff2000 rw-p 00000000 00:00 0 [stack]\n");
+  dump.Add(&stream);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+
+  MinidumpLinuxMapsList* maps_list = minidump.GetLinuxMapsList();
+  ASSERT_TRUE(maps_list != NULL);
+  ASSERT_EQ(3U, maps_list->get_maps_count());
+  EXPECT_EQ(0x651000U, maps_list->GetLinuxMapsAtIndex(1)->GetBase());
+
+  const MinidumpLinuxMaps* maps = maps_list->GetLinuxMapsForAddress(0x400000);
+  ASSERT_TRUE(maps != NULL);
+  EXPECT_EQ("/bin/app", maps->GetPathname());
+  EXPECT_TRUE(maps->IsExecutable());
+  maps = maps_list->GetLinuxMapsForAddress(0x651fff);
+  ASSERT_TRUE(maps != NULL);
+  EXPECT_EQ(0x651000U, maps->GetBase());
+  maps = maps_list->GetLinuxMapsForAddress(0x7fff1000);
+  ASSERT_TRUE(maps != NULL);
+  EXPECT_EQ("[stack]", maps->GetPathname());
+  EXPECT_TRUE(maps_list->GetLinuxMapsForAddress(0x3fffff) == NULL);
+  EXPECT_TRUE(maps_list->GetLinuxMapsForAddress(0x452000) == NULL);
+  EXPECT_TRUE(maps_list->GetLinuxMapsForAddress(0x7fff2000) == NULL);
+}
+
+TEST(Dump, UnparseableLinuxMaps) {
+  Dump dump(0, kLittleEndian);
+  Stream stream(dump, MD_LINUX_MAPS);
+  stream.Append("not a mapping\n");
+  dump.Add(&stream);
+  dump.Finish();
+
+  string contents;
+  ASSERT_TRUE(dump.GetContents(&contents));
+  istringstream minidump_stream(contents);
+  Minidump minidump(minidump_stream);
+  ASSERT_TRUE(minidump.Read());
+
+  // The text is only parsed once a mapping is asked for, and then there
+  // are none.
+  MinidumpLinuxMapsList* maps_list = minidump.GetLinuxMapsList();
+  ASSERT_TRUE(maps_list != NULL);
+  EXPECT_EQ(0U, maps_list->get_maps_count());
+  EXPECT_TRUE(maps_list->GetLinuxMapsAtIndex(0) == NULL);
+  EXPECT_TRUE(maps_list->GetLinuxMapsForAddress(0x1000) == NULL);
+}
+
 TEST(Dump, OneExceptionX86) {
   Dump dump(0, kLittleEndian);
 
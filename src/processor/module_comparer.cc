@@ -34,8 +34,11 @@
 
 #include "processor/module_comparer.h"
 
+#include <string.h>
+
 #include <map>
 #include <string>
+#include <vector>
 
 #include "common/scoped_ptr.h"
 #include "processor/basic_code_module.h"
@@ -192,42 +195,34 @@ bool ModuleComparer::CompareFunction(const BasicFunc *basic_func,
                                     const FastFunc *fast_func_raw) const {
   FastFunc* fast_func = new FastFunc();
   fast_func->CopyFrom(fast_func_raw);
-  ASSERT_TRUE(basic_func->name == fast_func->name);
+  ASSERT_TRUE(strcmp(basic_func->name, fast_func->name) == 0);
   ASSERT_TRUE(basic_func->address == fast_func->address);
   ASSERT_TRUE(basic_func->size == fast_func->size);
 
   // compare range map of lines:
-  RangeMap<MemAddr, linked_ptr<BasicLine> >::MapConstIterator iter1;
-  StaticRangeMap<MemAddr, FastLine>::MapConstIterator iter2;
-  iter1 = basic_func->lines.map_.begin();
-  iter2 = fast_func->lines.map_.begin();
-  while (iter1 != basic_func->lines.map_.end()
-      && iter2 != fast_func->lines.map_.end()) {
-    ASSERT_TRUE(iter1->first == iter2.GetKey());
-    ASSERT_TRUE(iter1->second.base() == iter2.GetValuePtr()->base());
-    ASSERT_TRUE(CompareLine(iter1->second.entry().get(),
-                            iter2.GetValuePtr()->entryptr()));
-    ++iter1;
-    ++iter2;
+  RangeMap<MemAddr, BasicLine>::MapConstIterator iter1;
+  std::vector<FastLine> fast_lines;
+  fast_func->lines.ReadAll(&fast_lines);
+  ASSERT_TRUE(fast_lines.size() == basic_func->lines.map_.size());
+  size_t index = 0;
+  for (iter1 = basic_func->lines.map_.begin();
+       iter1 != basic_func->lines.map_.end(); ++iter1, ++index) {
+    ASSERT_TRUE(iter1->first ==
+                fast_lines[index].address + fast_lines[index].size - 1);
+    ASSERT_TRUE(iter1->second.base() == fast_lines[index].address);
+    ASSERT_TRUE(CompareLine(&iter1->second.entry(), fast_lines[index]));
   }
-  ASSERT_TRUE(iter1 == basic_func->lines.map_.end());
-  ASSERT_TRUE(iter2 == fast_func->lines.map_.end());
 
   delete fast_func;
   return true;
 }
 
 bool ModuleComparer::CompareLine(const BasicLine *basic_line,
-                                const FastLine *fast_line_raw) const {
-  FastLine *fast_line = new FastLine;
-  fast_line->CopyFrom(fast_line_raw);
-
-  ASSERT_TRUE(basic_line->address == fast_line->address);
-  ASSERT_TRUE(basic_line->size == fast_line->size);
-  ASSERT_TRUE(basic_line->source_file_id == fast_line->source_file_id);
-  ASSERT_TRUE(basic_line->line == fast_line->line);
-
-  delete fast_line;
+                                const FastLine &fast_line) const {
+  ASSERT_TRUE(basic_line->address == fast_line.address);
+  ASSERT_TRUE(basic_line->size == fast_line.size);
+  ASSERT_TRUE(basic_line->source_file_id == fast_line.source_file_id);
+  ASSERT_TRUE(basic_line->line == fast_line.line);
   return true;
 }
 
@@ -235,7 +230,7 @@ bool ModuleComparer::ComparePubSymbol(const BasicPubSymbol* basic_ps,
                                      const FastPubSymbol* fastps_raw) const {
   FastPubSymbol *fast_ps = new FastPubSymbol;
   fast_ps->CopyFrom(fastps_raw);
-  ASSERT_TRUE(basic_ps->name == fast_ps->name);
+  ASSERT_TRUE(strcmp(basic_ps->name, fast_ps->name) == 0);
   ASSERT_TRUE(basic_ps->address == fast_ps->address);
   ASSERT_TRUE(basic_ps->parameter_size == fast_ps->parameter_size);
   delete fast_ps;
@@ -72,7 +72,7 @@ class ModuleComparer {
   typedef BasicSourceLineResolver::Function BasicFunc;
   typedef FastSourceLineResolver::Function FastFunc;
   typedef BasicSourceLineResolver::Line BasicLine;
-  typedef FastSourceLineResolver::Line FastLine;
+  typedef StaticLineTable::Row FastLine;
   typedef BasicSourceLineResolver::PublicSymbol BasicPubSymbol;
   typedef FastSourceLineResolver::PublicSymbol FastPubSymbol;
   typedef WindowsFrameInfo WFI;
@@ -80,7 +80,7 @@ class ModuleComparer {
   bool CompareModule(const BasicModule *oldmodule,
                      const FastModule *newmodule) const;
   bool CompareFunction(const BasicFunc *oldfunc, const FastFunc *newfunc) const;
-  bool CompareLine(const BasicLine *oldline, const FastLine *newline) const;
+  bool CompareLine(const BasicLine *oldline, const FastLine &newline) const;
   bool ComparePubSymbol(const BasicPubSymbol*, const FastPubSymbol*) const;
   bool CompareWFI(const WindowsFrameInfo&, const WindowsFrameInfo&) const;
 
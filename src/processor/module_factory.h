@@ -51,11 +51,32 @@ class ModuleFactory {
 
 class BasicModuleFactory : public ModuleFactory {
  public:
+  explicit BasicModuleFactory(
+      int num_load_threads = 1,
+      bool load_lines_lazily = false,
+      BasicSourceLineResolver::RecordFetcher* record_fetcher = NULL)
+      : num_load_threads_(num_load_threads),
+        load_lines_lazily_(load_lines_lazily),
+        record_fetcher_(record_fetcher) { }
   virtual ~BasicModuleFactory() { }
   virtual BasicSourceLineResolver::Module* CreateModule(
       const string& name) const {
-    return new BasicSourceLineResolver::Module(name);
+    BasicSourceLineResolver::Module* module =
+        new BasicSourceLineResolver::Module(name, num_load_threads_,
+                                            &string_pool_);
+    module->set_load_lines_lazily(load_lines_lazily_);
+    module->set_record_fetcher(record_fetcher_);
+    return module;
   }
+
+ private:
+  int num_load_threads_;
+  bool load_lines_lazily_;
+  BasicSourceLineResolver::RecordFetcher* record_fetcher_;
+
+  // Shared by every module this factory creates.  The resolver deletes its
+  // modules before its factory.
+  mutable StringPool string_pool_;
 };
 
 class FastModuleFactory : public ModuleFactory {
@@ -35,9 +35,13 @@
 
 #include "processor/module_serializer.h"
 
+#include <stdio.h>
+#include <string.h>
+
 #include <map>
 #include <string>
 
+#include "common/scoped_ptr.h"
 #include "processor/basic_code_module.h"
 #include "processor/logging.h"
 
@@ -46,16 +50,33 @@ namespace google_breakpad {
 // Definition of static member variables in SimplerSerializer<Funcion> and
 // SimplerSerializer<Inline>, which are declared in file
 // "simple_serializer-inl.h"
-RangeMapSerializer<MemAddr, linked_ptr<BasicSourceLineResolver::Line>>
-    SimpleSerializer<BasicSourceLineResolver::Function>::range_map_serializer_;
+LineTableSerializer<MemAddr, BasicSourceLineResolver::Line>
+    SimpleSerializer<BasicSourceLineResolver::Function>::line_table_serializer_;
 ContainedRangeMapSerializer<MemAddr,
                             linked_ptr<BasicSourceLineResolver::Inline>>
     SimpleSerializer<
         BasicSourceLineResolver::Function>::inline_range_map_serializer_;
 
+void ModuleSerializer::set_build_search_index(bool build_search_index) {
+  files_serializer_.set_build_search_index(build_search_index);
+  functions_serializer_.set_build_search_index(build_search_index);
+  pubsym_serializer_.set_build_search_index(build_search_index);
+  wfi_serializer_.set_build_search_index(build_search_index);
+  cfi_init_rules_serializer_.set_build_search_index(build_search_index);
+  cfi_delta_rules_serializer_.set_build_search_index(build_search_index);
+  inline_origin_serializer_.set_build_search_index(build_search_index);
+}
+
 size_t ModuleSerializer::SizeOf(const BasicSourceLineResolver::Module& module) {
   size_t total_size_alloc_ = 0;
 
+  // Records deferred by lazy loading have to be parsed before the module's
+  // functions can be measured and written.
+  module.LoadAllFunctionRecords();
+
+  // Size of the versioned header.
+  total_size_alloc_ += sizeof(SerializedHeader);
+
   // Size of the "is_corrupt" flag.
   total_size_alloc_ += SimpleSerializer<bool>::SizeOf(module.is_corrupt_);
 
@@ -74,10 +95,14 @@ size_t ModuleSerializer::SizeOf(const BasicSourceLineResolver::Module& module) {
   map_sizes_[map_index++] =
       inline_origin_serializer_.SizeOf(module.inline_origins_);
 
-  // Header size.
+  // Header size, and the padding that aligns the first map.
   total_size_alloc_ += kNumberMaps_ * sizeof(uint32_t);
+  total_size_alloc_ = FastModule::AlignMapOffset(total_size_alloc_);
 
+  // Each map is padded to align the next.
   for (int i = 0; i < kNumberMaps_; ++i) {
+    map_sizes_[i] =
+        static_cast<uint32_t>(FastModule::AlignMapOffset(map_sizes_[i]));
     total_size_alloc_ += map_sizes_[i];
   }
 
@@ -89,22 +114,38 @@ size_t ModuleSerializer::SizeOf(const BasicSourceLineResolver::Module& module) {
 
 char* ModuleSerializer::Write(const BasicSourceLineResolver::Module& module,
                               char* dest) {
+  // Leave room for the header, which is filled in once the size and checksum
+  // of the data that follows it are known.
+  char* start = dest;
+  dest += sizeof(SerializedHeader);
   // Write the is_corrupt flag.
   dest = SimpleSerializer<bool>::Write(module.is_corrupt_, dest);
   // Write header.
   memcpy(dest, map_sizes_, kNumberMaps_ * sizeof(uint32_t));
   dest += kNumberMaps_ * sizeof(uint32_t);
-  // Write each map.
-  dest = files_serializer_.Write(module.files_, dest);
-  dest = functions_serializer_.Write(module.functions_, dest);
-  dest = pubsym_serializer_.Write(module.public_symbols_, dest);
+  // Write each map, padding each one out to the next's alignment.
+  auto pad = [start](char* end) {
+    return FastModule::PadToMapAlignment(start, end);
+  };
+  dest = pad(dest);
+  dest = pad(files_serializer_.Write(module.files_, dest));
+  dest = pad(functions_serializer_.Write(module.functions_, dest));
+  dest = pad(pubsym_serializer_.Write(module.public_symbols_, dest));
   for (int i = 0; i < WindowsFrameInfo::STACK_INFO_LAST; ++i)
-    dest = wfi_serializer_.Write(&(module.windows_frame_info_[i]), dest);
-  dest = cfi_init_rules_serializer_.Write(module.cfi_initial_rules_, dest);
-  dest = cfi_delta_rules_serializer_.Write(module.cfi_delta_rules_, dest);
-  dest = inline_origin_serializer_.Write(module.inline_origins_, dest);
+    dest = pad(wfi_serializer_.Write(&(module.windows_frame_info_[i]), dest));
+  dest = pad(cfi_init_rules_serializer_.Write(module.cfi_initial_rules_, dest));
+  dest = pad(cfi_delta_rules_serializer_.Write(module.cfi_delta_rules_, dest));
+  dest = pad(inline_origin_serializer_.Write(module.inline_origins_, dest));
   // Write a null terminator.
   dest = SimpleSerializer<char>::Write(0, dest);
+
+  SerializedHeader header;
+  header.magic = FastSourceLineResolver::Module::kSerializedMagic;
+  header.version = FastSourceLineResolver::Module::kSerializedVersion;
+  header.size = static_cast<uint32_t>(dest - start);
+  header.checksum = FastSourceLineResolver::Module::Checksum(
+      start + sizeof(header), dest - start - sizeof(header));
+  memcpy(start, &header, sizeof(header));
   return dest;
 }
 
@@ -198,6 +239,56 @@ bool ModuleSerializer::ConvertOneModule(
   return SerializeModuleAndLoadIntoFastResolver(iter, fast_resolver);
 }
 
+bool ModuleSerializer::ConvertSymbolFile(const string& symbol_file,
+                                         const string& serialized_file) {
+  char* symbol_data;
+  size_t symbol_data_size;
+  if (!SourceLineResolverBase::ReadSymbolFile(symbol_file, &symbol_data,
+                                              &symbol_data_size)) {
+    return false;
+  }
+  scoped_array<char> buffer(symbol_data);
+
+  // A corrupt module is still written out, with its corrupt flag set, so that
+  // it loads the same way it would from the text symbol file.
+  BasicSourceLineResolver::Module module(symbol_file);
+  if (!module.LoadMapFromMemory(buffer.get(), symbol_data_size)) {
+    BPLOG(ERROR) << "Too many errors while parsing " << symbol_file;
+  }
+  buffer.reset();
+
+  unsigned int size = 0;
+  scoped_array<char> serialized_data(Serialize(module, &size));
+  if (!serialized_data.get())
+    return false;
+
+  FILE* f = fopen(serialized_file.c_str(), "wb");
+  if (!f) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not open " << serialized_file <<
+        ", error " << error_code << ": " << error_string;
+    return false;
+  }
+  bool ok = fwrite(serialized_data.get(), 1, size, f) == size;
+  ok = fclose(f) == 0 && ok;
+  if (!ok) {
+    BPLOG(ERROR) << "Could not write " << serialized_file;
+    remove(serialized_file.c_str());
+  }
+  return ok;
+}
+
+bool ModuleSerializer::CheckSerializedHeader(const char* serialized_data,
+                                             size_t size) {
+  return FastSourceLineResolver::Module::CheckHeader(serialized_data, size);
+}
+
+bool ModuleSerializer::VerifySerializedData(const char* serialized_data,
+                                            size_t size) {
+  return FastSourceLineResolver::Module::VerifyChecksum(serialized_data, size);
+}
+
 char* ModuleSerializer::SerializeSymbolFileData(
     const string& symbol_data, unsigned int* size) {
   scoped_ptr<BasicSourceLineResolver::Module> module(
@@ -0,0 +1,165 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// numa_topology.cc: Which CPUs belong to which NUMA node, and placing
+// threads on them.
+//
+// See numa_topology.h for documentation.
+
+#include "processor/numa_topology.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace google_breakpad {
+
+const char NumaTopology::kSysfsNodePath[] = "/sys/devices/system/node";
+
+NumaTopology::NumaTopology() : node_cpus_(1) {}
+
+bool NumaTopology::Read(const string& node_path) {
+  node_cpus_.assign(1, std::vector<int>());
+  cpu_nodes_.clear();
+#ifdef __linux__
+  DIR* dir = opendir(node_path.c_str());
+  if (!dir)
+    return false;
+  std::vector<int> node_numbers;
+  while (struct dirent* entry = readdir(dir)) {
+    const char* name = entry->d_name;
+    if (strncmp(name, "node", 4) != 0 || !name[4])
+      continue;
+    char* end;
+    long number = strtol(name + 4, &end, 10);
+    if (*end == '\0' && number >= 0)
+      node_numbers.push_back(static_cast<int>(number));
+  }
+  closedir(dir);
+  std::sort(node_numbers.begin(), node_numbers.end());
+
+  std::vector<std::vector<int> > node_cpus;
+  for (size_t i = 0; i < node_numbers.size(); ++i) {
+    char file_name[32];
+    snprintf(file_name, sizeof(file_name), "/node%d/cpulist",
+             node_numbers[i]);
+    FILE* file = fopen((node_path + file_name).c_str(), "r");
+    if (!file)
+      continue;
+    char buffer[4096];
+    string list;
+    while (fgets(buffer, sizeof(buffer), file))
+      list += buffer;
+    fclose(file);
+    std::vector<int> cpus;
+    if (ParseCPUList(list, &cpus) && !cpus.empty())
+      node_cpus.push_back(cpus);
+  }
+  if (node_cpus.empty())
+    return false;
+
+  node_cpus_.swap(node_cpus);
+  for (int node = 0; node < node_count(); ++node) {
+    for (size_t i = 0; i < node_cpus_[node].size(); ++i) {
+      int cpu = node_cpus_[node][i];
+      if (static_cast<size_t>(cpu) >= cpu_nodes_.size())
+        cpu_nodes_.resize(cpu + 1, -1);
+      cpu_nodes_[cpu] = node;
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+int NumaTopology::NodeOfCPU(int cpu) const {
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_nodes_.size())
+    return -1;
+  return cpu_nodes_[cpu];
+}
+
+int NumaTopology::CurrentNode() const {
+#ifdef __linux__
+  return NodeOfCPU(sched_getcpu());
+#else
+  return -1;
+#endif
+}
+
+bool NumaTopology::BindCurrentThread(int node) const {
+  if (node < 0 || node >= node_count() || node_cpus_[node].empty())
+    return false;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (size_t i = 0; i < node_cpus_[node].size(); ++i) {
+    if (node_cpus_[node][i] < CPU_SETSIZE)
+      CPU_SET(node_cpus_[node][i], &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+// static
+bool NumaTopology::ParseCPUList(const string& list, std::vector<int>* cpus) {
+  const char* p = list.c_str();
+  while (*p && *p != '\n') {
+    char* end;
+    long first = strtol(p, &end, 10);
+    if (end == p || first < 0)
+      return false;
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      ++p;
+      last = strtol(p, &end, 10);
+      if (end == p || last < first)
+        return false;
+      p = end;
+    }
+    for (long cpu = first; cpu <= last; ++cpu)
+      cpus->push_back(static_cast<int>(cpu));
+    if (*p == ',')
+      ++p;
+    else if (*p && *p != '\n')
+      return false;
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
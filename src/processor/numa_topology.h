@@ -0,0 +1,101 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// numa_topology.h: Which CPUs belong to which NUMA node, and placing
+// threads on them.
+//
+// On a host with several NUMA nodes, memory is attached to one node, and
+// threads running on another node's CPUs reach it more slowly.  Symbol
+// lookups, which land all over large tables, suffer from that more than
+// most work.  NumaTopology reads the host's nodes so that a pool of
+// workers can be spread over them, each worker bound to one node's CPUs
+// and using data allocated there.
+//
+// The topology comes from sysfs on Linux.  Elsewhere, or where sysfs has
+// no node information, the host is treated as a single node, and threads
+// aren't bound.
+
+#ifndef PROCESSOR_NUMA_TOPOLOGY_H__
+#define PROCESSOR_NUMA_TOPOLOGY_H__
+
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class NumaTopology {
+ public:
+  // The directory sysfs describes the nodes in.
+  static const char kSysfsNodePath[];
+
+  // Creates a topology of one node with no known CPUs, until Read() is
+  // called.
+  NumaTopology();
+
+  // Reads the online nodes and their CPUs from |node_path|, a directory
+  // laid out like kSysfsNodePath, with a nodeN/cpulist file for each node.
+  // Nodes without CPUs are left out.  Returns false, leaving a single node
+  // with no known CPUs, if no node could be read.
+  bool Read(const string& node_path = kSysfsNodePath);
+
+  // The number of nodes, always at least one.
+  int node_count() const { return static_cast<int>(node_cpus_.size()); }
+
+  // The CPUs of |node|, a number from 0 to node_count() - 1; these are
+  // numbered in order of their nodes' numbers in sysfs, which needn't be
+  // contiguous.
+  const std::vector<int>& cpus(int node) const { return node_cpus_[node]; }
+
+  // Returns the node that |cpu| belongs to, or -1 if it's unknown.
+  int NodeOfCPU(int cpu) const;
+
+  // Returns the node of the CPU the calling thread is running on, or -1 if
+  // it's unknown.
+  int CurrentNode() const;
+
+  // Binds the calling thread to the CPUs of |node|.  Returns false if the
+  // node's CPUs are unknown or the thread can't be bound.
+  bool BindCurrentThread(int node) const;
+
+  // Parses |list|, a CPU list in the kernel's format, such as "0-3,8,10-11",
+  // appending its CPUs to |cpus|.  Returns false if it's malformed.
+  static bool ParseCPUList(const string& list, std::vector<int>* cpus);
+
+ private:
+  std::vector<std::vector<int> > node_cpus_;
+
+  // The node of each CPU, by CPU number, or -1 for CPUs of no node.
+  std::vector<int> cpu_nodes_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_NUMA_TOPOLOGY_H__
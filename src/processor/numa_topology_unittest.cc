@@ -0,0 +1,116 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// numa_topology_unittest.cc: Unit tests for NumaTopology.
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/numa_topology.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::NumaTopology;
+
+// Writes a nodeN/cpulist file holding |cpulist| beneath |dir|.
+void AddNode(const string& dir, int node, const char* cpulist) {
+  string node_dir = dir + "/node" + std::to_string(node);
+  ASSERT_EQ(0, mkdir(node_dir.c_str(), 0755));
+  FILE* file = fopen((node_dir + "/cpulist").c_str(), "w");
+  ASSERT_TRUE(file);
+  fprintf(file, "%s\n", cpulist);
+  ASSERT_EQ(0, fclose(file));
+}
+
+TEST(NumaTopologyTest, ParseCPUList) {
+  std::vector<int> cpus;
+  ASSERT_TRUE(NumaTopology::ParseCPUList("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 8, 10, 11}), cpus);
+
+  cpus.clear();
+  ASSERT_TRUE(NumaTopology::ParseCPUList("\n", &cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  EXPECT_FALSE(NumaTopology::ParseCPUList("3-1", &cpus));
+  EXPECT_FALSE(NumaTopology::ParseCPUList("0,,1", &cpus));
+  EXPECT_FALSE(NumaTopology::ParseCPUList("0-", &cpus));
+  EXPECT_FALSE(NumaTopology::ParseCPUList("a", &cpus));
+}
+
+TEST(NumaTopologyTest, Read) {
+  AutoTempDir temp_dir;
+  // Nodes are ordered by number, not by name, and a node without CPUs,
+  // such as one with only memory, is left out.
+  AddNode(temp_dir.path(), 10, "4-5");
+  AddNode(temp_dir.path(), 2, "0-1,6");
+  AddNode(temp_dir.path(), 3, "");
+  ASSERT_EQ(0, mkdir((temp_dir.path() + "/power").c_str(), 0755));
+
+  NumaTopology topology;
+  ASSERT_TRUE(topology.Read(temp_dir.path()));
+  ASSERT_EQ(2, topology.node_count());
+  EXPECT_EQ((std::vector<int>{0, 1, 6}), topology.cpus(0));
+  EXPECT_EQ((std::vector<int>{4, 5}), topology.cpus(1));
+  EXPECT_EQ(0, topology.NodeOfCPU(6));
+  EXPECT_EQ(1, topology.NodeOfCPU(4));
+  EXPECT_EQ(-1, topology.NodeOfCPU(2));
+  EXPECT_EQ(-1, topology.NodeOfCPU(7));
+  EXPECT_EQ(-1, topology.NodeOfCPU(-1));
+}
+
+TEST(NumaTopologyTest, ReadNothing) {
+  AutoTempDir temp_dir;
+  NumaTopology topology;
+  EXPECT_FALSE(topology.Read(temp_dir.path() + "/missing"));
+  EXPECT_FALSE(topology.Read(temp_dir.path()));
+  EXPECT_EQ(1, topology.node_count());
+  EXPECT_TRUE(topology.cpus(0).empty());
+  EXPECT_EQ(-1, topology.CurrentNode());
+  EXPECT_FALSE(topology.BindCurrentThread(0));
+}
+
+// This host's own topology, whatever it is, includes the CPU this runs on.
+TEST(NumaTopologyTest, ReadHost) {
+  NumaTopology topology;
+  if (!topology.Read())
+    return;
+  int node = topology.CurrentNode();
+  ASSERT_GE(node, 0);
+  EXPECT_TRUE(topology.BindCurrentThread(node));
+  EXPECT_EQ(node, topology.CurrentNode());
+}
+
+}  // namespace
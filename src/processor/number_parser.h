@@ -0,0 +1,201 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// number_parser.h: Strict parsers for the numbers in symbol files.
+//
+// The hexadecimal addresses and sizes that make up most of a .sym file
+// used to go through strtoull, which handles locales, signs, "0x"
+// prefixes and leading whitespace, and reports overflow through errno.
+// None of that belongs in a symbol file.  These parsers accept only
+// digits, convert eight hexadecimal digits at a time with SWAR
+// arithmetic, and report malformed or overflowing numbers by returning
+// false.
+
+#ifndef PROCESSOR_NUMBER_PARSER_H__
+#define PROCESSOR_NUMBER_PARSER_H__
+
+#include <limits>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+// Returns the value of the hexadecimal digit |c|, or 16 if |c| isn't one.
+inline uint32_t HexDigitValue(char c) {
+  const uint32_t decimal = static_cast<unsigned char>(c) - '0';
+  const uint32_t letter = (static_cast<unsigned char>(c) | 0x20) - 'a';
+  return decimal < 10 ? decimal : letter < 6 ? letter + 10 : 16;
+}
+
+// Returns the value of the eight hexadecimal digits at |digits|, the
+// first being the most significant.  All eight must be digits.
+inline uint32_t ParseEightHexDigits(const char* digits) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(digits);
+  // Compilers turn this into a single load on little-endian machines.
+  uint64_t chunk = static_cast<uint64_t>(bytes[0]) |
+                   static_cast<uint64_t>(bytes[1]) << 8 |
+                   static_cast<uint64_t>(bytes[2]) << 16 |
+                   static_cast<uint64_t>(bytes[3]) << 24 |
+                   static_cast<uint64_t>(bytes[4]) << 32 |
+                   static_cast<uint64_t>(bytes[5]) << 40 |
+                   static_cast<uint64_t>(bytes[6]) << 48 |
+                   static_cast<uint64_t>(bytes[7]) << 56;
+  // The low nibble of '0'-'9' is its value, and that of 'a'-'f' and
+  // 'A'-'F' is nine less than its value; only the letters have bit 6 set.
+  const uint64_t letters = (chunk & 0x4040404040404040ULL) >> 6;
+  chunk = (chunk & 0x0f0f0f0f0f0f0f0fULL) + letters * 9;
+  // Pack the nibbles into bytes, the bytes into 16-bit halves and those
+  // into the result, the earlier digits of each pair being the higher.
+  chunk = ((chunk & 0x000f000f000f000fULL) << 4) |
+          ((chunk >> 8) & 0x000f000f000f000fULL);
+  chunk = ((chunk & 0x000000ff000000ffULL) << 8) |
+          ((chunk >> 16) & 0x000000ff000000ffULL);
+  return static_cast<uint32_t>(((chunk & 0xffff) << 16) |
+                               ((chunk >> 32) & 0xffff));
+}
+
+// Parses the hexadecimal number at the start of |number| into |*value|
+// and sets |*end| to the first character after its digits.  Returns
+// false, leaving |*value| and |*end| alone, if |number| doesn't start
+// with a digit or the number doesn't fit in 64 bits.
+inline bool ParseHex(const char* number, uint64_t* value, const char** end) {
+  const char* digits_end = number;
+  while (HexDigitValue(*digits_end) < 16)
+    ++digits_end;
+  if (digits_end == number)
+    return false;
+  while (*number == '0' && digits_end - number > 16)
+    ++number;
+  if (digits_end - number > 16)
+    return false;
+
+  uint64_t result = 0;
+  for (; digits_end - number >= 8; number += 8)
+    result = (result << 32) | ParseEightHexDigits(number);
+  for (; number != digits_end; ++number)
+    result = (result << 4) | HexDigitValue(*number);
+  *value = result;
+  *end = digits_end;
+  return true;
+}
+
+// Parses the decimal number at the start of |number| into |*value| and
+// sets |*end| to the first character after its digits.  Returns false,
+// leaving |*value| and |*end| alone, if |number| doesn't start with a
+// digit or the number doesn't fit in 64 bits.
+inline bool ParseDecimal(const char* number, uint64_t* value,
+                         const char** end) {
+  uint64_t result = 0;
+  const char* digit = number;
+  for (uint32_t d; (d = static_cast<unsigned char>(*digit) - '0') < 10;
+       ++digit) {
+    if (result > (std::numeric_limits<uint64_t>::max() - d) / 10)
+      return false;
+    result = result * 10 + d;
+  }
+  if (digit == number)
+    return false;
+  *value = result;
+  *end = digit;
+  return true;
+}
+
+// Like ParseDecimal, but for a number that may be preceded by a minus
+// sign and must fit in an int64_t.
+inline bool ParseSignedDecimal(const char* number, int64_t* value,
+                               const char** end) {
+  const bool negative = *number == '-';
+  uint64_t magnitude;
+  const char* digits_end;
+  if (!ParseDecimal(number + negative, &magnitude, &digits_end))
+    return false;
+  const uint64_t limit =
+      static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + negative;
+  if (magnitude > limit)
+    return false;
+  *value = negative ? static_cast<int64_t>(0 - magnitude)
+                    : static_cast<int64_t>(magnitude);
+  *end = digits_end;
+  return true;
+}
+
+// Returns true if |c| may follow a number in a symbol file record:
+// whitespace or the end of the record.
+inline bool IsEndOfNumber(char c) {
+  return c == ' ' || c == '\r' || c == '\n' || c == '\0';
+}
+
+// Returns |field| past any spaces before its number.  Only the last field
+// that Tokenize finds, which is the rest of the record, can have them.
+inline const char* SkipSpaces(const char* field) {
+  while (*field == ' ')
+    ++field;
+  return field;
+}
+
+// Parses the hexadecimal field |field| of a symbol file record, which runs
+// to whitespace or the end of the record, into |*value|.  The largest
+// value is rejected too, as strtoull's saturated result for an overflow
+// used to be.
+inline bool ParseHexField(const char* field, uint64_t* value) {
+  const char* end;
+  return ParseHex(SkipSpaces(field), value, &end) && IsEndOfNumber(*end) &&
+         *value != std::numeric_limits<uint64_t>::max();
+}
+
+// Like the above, for a field that must fit in a long.
+inline bool ParseHexField(const char* field, long* value) {
+  uint64_t number;
+  if (!ParseHexField(field, &number) ||
+      number >= static_cast<uint64_t>(std::numeric_limits<long>::max())) {
+    return false;
+  }
+  *value = static_cast<long>(number);
+  return true;
+}
+
+// Parses the decimal field |field|, which may be negative, into |*value|.
+// The largest and smallest longs are rejected, as strtol's saturated
+// results used to be.
+inline bool ParseDecimalField(const char* field, long* value) {
+  int64_t number;
+  const char* end;
+  if (!ParseSignedDecimal(SkipSpaces(field), &number, &end) ||
+      !IsEndOfNumber(*end) ||
+      number >= std::numeric_limits<long>::max() ||
+      number <= std::numeric_limits<long>::min()) {
+    return false;
+  }
+  *value = static_cast<long>(number);
+  return true;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_NUMBER_PARSER_H__
@@ -0,0 +1,168 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// number_parser_unittest.cc: Unit tests for the symbol file number parsers.
+
+#include <ctype.h>
+
+#include <limits>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "processor/number_parser.h"
+
+namespace {
+
+using google_breakpad::HexDigitValue;
+using google_breakpad::ParseDecimal;
+using google_breakpad::ParseDecimalField;
+using google_breakpad::ParseEightHexDigits;
+using google_breakpad::ParseHex;
+using google_breakpad::ParseHexField;
+using google_breakpad::ParseSignedDecimal;
+
+TEST(NumberParserTest, HexDigitValue) {
+  const string digits = "0123456789abcdef";
+  for (int c = 0; c < 256; ++c) {
+    const size_t position = digits.find(tolower(c));
+    const uint32_t expected =
+        c != 0 && position != string::npos ? position : 16;
+    EXPECT_EQ(expected, HexDigitValue(static_cast<char>(c))) << c;
+  }
+}
+
+TEST(NumberParserTest, EightHexDigits) {
+  EXPECT_EQ(0x01234567U, ParseEightHexDigits("01234567"));
+  EXPECT_EQ(0x89abcdefU, ParseEightHexDigits("89abcdef"));
+  EXPECT_EQ(0x89abcdefU, ParseEightHexDigits("89ABCDEF"));
+  EXPECT_EQ(0xffffffffU, ParseEightHexDigits("fFfFfFfF"));
+  EXPECT_EQ(0U, ParseEightHexDigits("00000000"));
+}
+
+TEST(NumberParserTest, Hex) {
+  static const struct {
+    const char* text;
+    uint64_t value;
+    size_t length;
+  } kCases[] = {
+    { "0", 0, 1 },
+    { "a", 0xa, 1 },
+    { "1f ", 0x1f, 2 },
+    { "1234567", 0x1234567, 7 },
+    { "12345678", 0x12345678, 8 },
+    { "123456789", 0x123456789ULL, 9 },
+    { "fedcba9876543210x", 0xfedcba9876543210ULL, 16 },
+    { "FFFFFFFFFFFFFFFF", 0xffffffffffffffffULL, 16 },
+    { "00000000000000000000001", 1, 23 },
+    { "0x10", 0, 1 },
+  };
+  for (const auto& c : kCases) {
+    uint64_t value;
+    const char* end;
+    ASSERT_TRUE(ParseHex(c.text, &value, &end)) << c.text;
+    EXPECT_EQ(c.value, value) << c.text;
+    EXPECT_EQ(c.text + c.length, end) << c.text;
+  }
+
+  static const char* const kBad[] = {
+    "", " 1", "-1", "+1", "x", "g", "10000000000000000",
+  };
+  for (const char* text : kBad) {
+    uint64_t value = 7;
+    const char* end = NULL;
+    EXPECT_FALSE(ParseHex(text, &value, &end)) << text;
+    EXPECT_EQ(7U, value) << text;
+    EXPECT_EQ(NULL, end) << text;
+  }
+}
+
+TEST(NumberParserTest, Decimal) {
+  uint64_t value;
+  const char* end;
+  const char* text = "18446744073709551615 ";
+  ASSERT_TRUE(ParseDecimal(text, &value, &end));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), value);
+  EXPECT_EQ(text + 20, end);
+  text = "0042";
+  ASSERT_TRUE(ParseDecimal(text, &value, &end));
+  EXPECT_EQ(42U, value);
+  EXPECT_EQ(text + 4, end);
+  EXPECT_FALSE(ParseDecimal("18446744073709551616", &value, &end));
+  EXPECT_FALSE(ParseDecimal("a", &value, &end));
+  EXPECT_FALSE(ParseDecimal("-1", &value, &end));
+
+  int64_t signed_value;
+  ASSERT_TRUE(ParseSignedDecimal("-1", &signed_value, &end));
+  EXPECT_EQ(-1, signed_value);
+  ASSERT_TRUE(ParseSignedDecimal("-9223372036854775808", &signed_value, &end));
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(), signed_value);
+  ASSERT_TRUE(ParseSignedDecimal("9223372036854775807", &signed_value, &end));
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), signed_value);
+  EXPECT_FALSE(ParseSignedDecimal("9223372036854775808", &signed_value, &end));
+  EXPECT_FALSE(ParseSignedDecimal("-9223372036854775809", &signed_value,
+                                  &end));
+  EXPECT_FALSE(ParseSignedDecimal("-", &signed_value, &end));
+  EXPECT_FALSE(ParseSignedDecimal("--1", &signed_value, &end));
+}
+
+TEST(NumberParserTest, Fields) {
+  uint64_t address;
+  EXPECT_TRUE(ParseHexField("1000", &address));
+  EXPECT_EQ(0x1000U, address);
+  EXPECT_TRUE(ParseHexField("1000 20", &address));
+  EXPECT_TRUE(ParseHexField("1000\r\n", &address));
+  EXPECT_TRUE(ParseHexField("  1000", &address));
+  EXPECT_EQ(0x1000U, address);
+  EXPECT_FALSE(ParseHexField("1000x", &address));
+  EXPECT_FALSE(ParseHexField("ffffffffffffffff", &address));
+  EXPECT_FALSE(ParseHexField("", &address));
+
+  long size;
+  EXPECT_TRUE(ParseHexField("10", &size));
+  EXPECT_EQ(0x10, size);
+  EXPECT_FALSE(ParseHexField("-10", &size));
+  EXPECT_FALSE(ParseHexField("ffffffffffffffff0", &size));
+
+  long line;
+  EXPECT_TRUE(ParseDecimalField("-1", &line));
+  EXPECT_EQ(-1, line);
+  EXPECT_TRUE(ParseDecimalField("42 foo", &line));
+  EXPECT_EQ(42, line);
+  EXPECT_FALSE(ParseDecimalField("42foo", &line));
+  EXPECT_FALSE(ParseDecimalField("0x2a", &line));
+  EXPECT_FALSE(ParseDecimalField("99999999999999999999", &line));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
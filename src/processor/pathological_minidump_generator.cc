@@ -0,0 +1,134 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pathological_minidump_generator.cc: Writes the minidumps
+// pathological_minidumps.h builds to a directory, as a corpus for fuzzing
+// and for timing minidump_stackwalk.
+//
+// Usage: pathological_minidump_generator [-s <size>,...] <directory>
+//
+// Each kind is written at each size (1000,10000,100000 by default), to
+// <directory>/<kind>_<size>.dmp.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "processor/pathological_minidumps.h"
+
+namespace {
+
+using google_breakpad::PathologicalMinidump;
+
+bool ParseSizes(const char* list, std::vector<int>* sizes) {
+  sizes->clear();
+  const char* p = list;
+  while (*p) {
+    char* end;
+    long size = strtol(p, &end, 10);
+    if (end == p || size < 1 || (*end != ',' && *end != '\0'))
+      return false;
+    sizes->push_back(static_cast<int>(size));
+    p = *end ? end + 1 : end;
+  }
+  return !sizes->empty();
+}
+
+bool WriteFile(const string& path, const string& contents) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+  bool ok = fwrite(contents.data(), 1, contents.size(), file) ==
+      contents.size();
+  return fclose(file) == 0 && ok;
+}
+
+void Usage(const char* program) {
+  fprintf(stderr, "Usage: %s [-s <size>,...] <directory>\n", program);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<int> sizes;
+  sizes.push_back(1000);
+  sizes.push_back(10000);
+  sizes.push_back(100000);
+
+  int ch;
+  while ((ch = getopt(argc, argv, "s:")) != -1) {
+    switch (ch) {
+      case 's':
+        if (!ParseSizes(optarg, &sizes)) {
+          Usage(argv[0]);
+          return 1;
+        }
+        break;
+      default:
+        Usage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind != argc - 1) {
+    Usage(argv[0]);
+    return 1;
+  }
+  const string directory = argv[optind];
+
+  for (int kind = 0; kind < google_breakpad::PATHOLOGICAL_MINIDUMP_COUNT;
+       ++kind) {
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      PathologicalMinidump pathological =
+          static_cast<PathologicalMinidump>(kind);
+      string contents;
+      if (!google_breakpad::SynthesizePathologicalMinidump(
+              pathological, sizes[i], &contents)) {
+        fprintf(stderr, "Couldn't build %s at %d\n",
+                google_breakpad::PathologicalMinidumpName(pathological),
+                sizes[i]);
+        return 1;
+      }
+      char name[64];
+      snprintf(name, sizeof(name), "/%s_%d.dmp",
+               google_breakpad::PathologicalMinidumpName(pathological),
+               sizes[i]);
+      const string path = directory + name;
+      if (!WriteFile(path, contents)) {
+        perror(path.c_str());
+        return 1;
+      }
+      printf("%s\n", path.c_str());
+    }
+  }
+  return 0;
+}
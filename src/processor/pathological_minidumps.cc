@@ -0,0 +1,219 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pathological_minidumps.cc: Implementation of
+// SynthesizePathologicalMinidump. See pathological_minidumps.h.
+
+#include "processor/pathological_minidumps.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "common/test_assembler.h"
+#include "processor/synth_minidump.h"
+
+namespace google_breakpad {
+
+namespace {
+
+using SynthMinidump::Context;
+using SynthMinidump::Dump;
+using SynthMinidump::Memory;
+using SynthMinidump::Module;
+using SynthMinidump::String;
+using SynthMinidump::SystemInfo;
+using SynthMinidump::Thread;
+using test_assembler::kLittleEndian;
+
+const uint32_t kModuleBase = 0x40000000;
+const uint32_t kModuleSize = 0x100000;
+const uint32_t kStackBase = 0x00100000;
+const uint32_t kRegionBase = 0x20000000;
+
+// A minidump under construction, which owns the sections added to it.
+class Builder {
+ public:
+  Builder()
+      : dump_(0, kLittleEndian),
+        csd_version_(dump_, SystemInfo::windows_x86_csd_version),
+        system_info_(dump_, SystemInfo::windows_x86, csd_version_) {
+    dump_.Add(&csd_version_);
+    dump_.Add(&system_info_);
+  }
+
+  Dump& dump() { return dump_; }
+
+  void AddModule(uint32_t base, uint32_t size, const string& name) {
+    String* module_name = Own(new String(dump_, name));
+    Module* module = Own(new Module(dump_, base, size, *module_name));
+    dump_.Add(module_name);
+    dump_.Add(module);
+  }
+
+  // Returns a new memory region at |address|, to be filled in and then
+  // passed to AddMemory() or AddThread().
+  Memory* NewMemory(uint64_t address) {
+    return Own(new Memory(dump_, address));
+  }
+
+  void AddMemory(Memory* memory) { dump_.Add(memory); }
+
+  void AddThread(Memory* stack, uint32_t eip, uint32_t esp, uint32_t ebp) {
+    MDRawContextX86 raw_context;
+    memset(&raw_context, 0, sizeof(raw_context));
+    raw_context.context_flags = MD_CONTEXT_X86_FULL;
+    raw_context.eip = eip;
+    raw_context.esp = esp;
+    raw_context.ebp = ebp;
+    Context* context = Own(new Context(dump_, raw_context));
+    Thread* thread = Own(new Thread(dump_, 0x1000, *stack, *context));
+    dump_.Add(stack);
+    dump_.Add(context);
+    dump_.Add(thread);
+  }
+
+  bool Finish(string* contents) {
+    dump_.Finish();
+    return dump_.GetContents(contents);
+  }
+
+ private:
+  template<typename T>
+  T* Own(T* section) {
+    sections_.push_back(std::unique_ptr<test_assembler::Section>(section));
+    return section;
+  }
+
+  Dump dump_;
+  String csd_version_;
+  SystemInfo system_info_;
+  std::vector<std::unique_ptr<test_assembler::Section> > sections_;
+};
+
+// Adds a thread with a short stack and no frame pointer, in the module
+// at kModuleBase.
+void AddShallowThread(Builder* builder) {
+  Memory* stack = builder->NewMemory(kStackBase);
+  for (int i = 0; i < 16; ++i)
+    stack->D32(0);
+  builder->AddThread(stack, kModuleBase + 0x100, kStackBase, 0);
+}
+
+bool ManyModules(int size, string* contents) {
+  Builder builder;
+  for (int i = 0; i < size; ++i) {
+    char name[32];
+    snprintf(name, sizeof(name), "c:\\modules\\module%d.dll", i);
+    builder.AddModule(kModuleBase + i * 0x1000, 0x1000, name);
+  }
+  AddShallowThread(&builder);
+  return builder.Finish(contents);
+}
+
+bool OverlappingMemory(int size, string* contents) {
+  Builder builder;
+  builder.AddModule(kModuleBase, kModuleSize, "c:\\synthesized.exe");
+  for (int i = 0; i < size; ++i) {
+    Memory* region = builder.NewMemory(kRegionBase + i * 0x80);
+    region->Append(0x100, 0);
+    builder.AddMemory(region);
+  }
+  AddShallowThread(&builder);
+  return builder.Finish(contents);
+}
+
+bool DeepStack(int size, string* contents) {
+  Builder builder;
+  builder.AddModule(kModuleBase, kModuleSize, "c:\\synthesized.exe");
+  // Each frame is a saved frame pointer and a return address; the last
+  // frame's are zero.
+  Memory* stack = builder.NewMemory(kStackBase);
+  for (int i = 0; i < size; ++i) {
+    uint32_t frame = kStackBase + i * 8;
+    if (i + 1 < size) {
+      stack->D32(frame + 8);
+      stack->D32(kModuleBase + 0x1000 + (i % 0x1000) * 16);
+    } else {
+      stack->D32(0);
+      stack->D32(0);
+    }
+  }
+  builder.AddThread(stack, kModuleBase + 0x100, kStackBase, kStackBase);
+  return builder.Finish(contents);
+}
+
+bool ScannedStack(int size, string* contents) {
+  Builder builder;
+  builder.AddModule(kModuleBase, kModuleSize, "c:\\synthesized.exe");
+  Memory* stack = builder.NewMemory(kStackBase);
+  for (int i = 0; i < size; ++i)
+    stack->D32(kModuleBase + 0x1000 + (i % 0x1000) * 16);
+  builder.AddThread(stack, kModuleBase + 0x100, kStackBase, 0);
+  return builder.Finish(contents);
+}
+
+}  // namespace
+
+const char* PathologicalMinidumpName(PathologicalMinidump kind) {
+  switch (kind) {
+    case PATHOLOGICAL_MANY_MODULES:
+      return "many_modules";
+    case PATHOLOGICAL_OVERLAPPING_MEMORY:
+      return "overlapping_memory";
+    case PATHOLOGICAL_DEEP_STACK:
+      return "deep_stack";
+    case PATHOLOGICAL_SCANNED_STACK:
+      return "scanned_stack";
+    default:
+      return "unknown";
+  }
+}
+
+bool SynthesizePathologicalMinidump(PathologicalMinidump kind, int size,
+                                    string* contents) {
+  if (size <= 0)
+    return false;
+  switch (kind) {
+    case PATHOLOGICAL_MANY_MODULES:
+      return ManyModules(size, contents);
+    case PATHOLOGICAL_OVERLAPPING_MEMORY:
+      return OverlappingMemory(size, contents);
+    case PATHOLOGICAL_DEEP_STACK:
+      return DeepStack(size, contents);
+    case PATHOLOGICAL_SCANNED_STACK:
+      return ScannedStack(size, contents);
+    default:
+      return false;
+  }
+}
+
+}  // namespace google_breakpad
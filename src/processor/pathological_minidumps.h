@@ -0,0 +1,76 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pathological_minidumps.h: Windows x86 minidumps, built with
+// SynthMinidump, of the shapes that corrupt or unusual dumps take when
+// they make the processor slow: huge module lists, overlapping memory
+// regions, very deep stacks, and stacks that can only be scanned.
+//
+// Each is scaled by a size, so that tests can check that processing time
+// grows no faster than the size, and fuzzers can start from them.
+
+#ifndef PROCESSOR_PATHOLOGICAL_MINIDUMPS_H__
+#define PROCESSOR_PATHOLOGICAL_MINIDUMPS_H__
+
+#include <string>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+enum PathologicalMinidump {
+  // |size| modules, each a page long, and one thread.
+  PATHOLOGICAL_MANY_MODULES,
+
+  // |size| memory regions, each overlapping the next, and one thread.
+  PATHOLOGICAL_OVERLAPPING_MEMORY,
+
+  // One thread whose stack is a chain of |size| frames, each with a
+  // frame pointer and a return address into a module.
+  PATHOLOGICAL_DEEP_STACK,
+
+  // One thread whose stack is |size| words, each a return address into a
+  // module, but without frame pointers, so that every frame is found by
+  // scanning.
+  PATHOLOGICAL_SCANNED_STACK,
+
+  PATHOLOGICAL_MINIDUMP_COUNT
+};
+
+// Returns a short name for |kind|, for file names and test output.
+const char* PathologicalMinidumpName(PathologicalMinidump kind);
+
+// Sets |contents| to a minidump of the shape |kind| at |size|. Returns
+// false if it couldn't be built.
+bool SynthesizePathologicalMinidump(PathologicalMinidump kind, int size,
+                                    string* contents);
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PATHOLOGICAL_MINIDUMPS_H__
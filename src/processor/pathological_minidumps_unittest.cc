@@ -0,0 +1,261 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// pathological_minidumps_unittest.cc: Checks that the processor's time on
+// the minidumps pathological_minidumps.h builds grows no faster than
+// their size, and that the limits on what it reads hold.
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/cancellation_token.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/minidump.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stackwalker.h"
+#include "processor/logging.h"
+#include "processor/pathological_minidumps.h"
+
+namespace {
+
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CancellationToken;
+using google_breakpad::LogStream;
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpMemoryList;
+using google_breakpad::MinidumpModuleList;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::PathologicalMinidump;
+using google_breakpad::ProcessResult;
+using google_breakpad::ProcessState;
+using google_breakpad::Stackwalker;
+using google_breakpad::SynthesizePathologicalMinidump;
+
+// The larger of the two sizes each case is processed at is this many
+// times the smaller, and may take at most kMaxTimeRatio times as long:
+// enough for n log n growth and noise, but not for quadratic growth.
+const int kSizeRatio = 8;
+const double kMaxTimeRatio = 24;
+
+// Times under this are too short to compare.
+const double kMinComparableSeconds = 0.002;
+
+class PathologicalMinidumpTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    LogStream::set_minimum_severity(LogStream::SEVERITY_CRITICAL);
+  }
+
+  void TearDown() {
+    LogStream::set_minimum_severity(LogStream::SEVERITY_INFO);
+    MinidumpModuleList::set_max_modules(2048);
+    MinidumpMemoryList::set_max_regions(4096);
+    Stackwalker::set_max_frames(1 << 20);
+    Stackwalker::set_max_frames_scanned(1 << 14);
+    Stackwalker::set_max_consecutive_frames_scanned(
+        std::numeric_limits<uint32_t>::max());
+    Stackwalker::set_max_words_scanned(std::numeric_limits<uint64_t>::max());
+  }
+
+  // Reads and processes |contents| into |state|, also reading the memory
+  // list as exploitability analysis would. Returns the fastest of three
+  // runs' times, in seconds.
+  double Process(const string& contents, ProcessState* state,
+                 ProcessResult* result) {
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+      std::chrono::steady_clock::time_point start =
+          std::chrono::steady_clock::now();
+      std::istringstream stream(contents);
+      Minidump dump(stream);
+      EXPECT_TRUE(dump.Read());
+      dump.GetMemoryList();
+      BasicSourceLineResolver resolver;
+      MinidumpProcessor processor(NULL, &resolver);
+      *result = processor.Process(&dump, state);
+      double seconds = std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count();
+      if (run == 0 || seconds < best)
+        best = seconds;
+    }
+    return best;
+  }
+
+  // Processes |kind| at |size| and kSizeRatio times |size|, and checks
+  // that the larger took no more than kMaxTimeRatio times as long.
+  // Leaves the larger one's results in |state_| and |result_|.
+  void CheckScaling(PathologicalMinidump kind, int size) {
+    string small_dump, large_dump;
+    ASSERT_TRUE(SynthesizePathologicalMinidump(kind, size, &small_dump));
+    ASSERT_TRUE(SynthesizePathologicalMinidump(kind, size * kSizeRatio,
+                                               &large_dump));
+    ProcessState small_state;
+    ProcessResult small_result;
+    double small_seconds = Process(small_dump, &small_state, &small_result);
+    double large_seconds = Process(large_dump, &state_, &result_);
+    EXPECT_EQ(small_result, result_);
+    double floor = std::max(small_seconds, kMinComparableSeconds);
+    EXPECT_LE(large_seconds, floor * kMaxTimeRatio)
+        << google_breakpad::PathologicalMinidumpName(kind) << ": "
+        << small_seconds << "s at " << size << ", " << large_seconds
+        << "s at " << size * kSizeRatio;
+  }
+
+  size_t FrameCount() {
+    if (state_.threads()->empty())
+      return 0;
+    return state_.threads()->at(0)->frames()->size();
+  }
+
+  ProcessState state_;
+  ProcessResult result_;
+};
+
+TEST_F(PathologicalMinidumpTest, ManyModules) {
+  MinidumpModuleList::set_max_modules(1 << 20);
+  CheckScaling(google_breakpad::PATHOLOGICAL_MANY_MODULES, 4000);
+  EXPECT_EQ(google_breakpad::PROCESS_OK, result_);
+  EXPECT_EQ(32000U, state_.modules()->module_count());
+}
+
+TEST_F(PathologicalMinidumpTest, ManyModulesOverLimit) {
+  // The default limit is far below this, so the list isn't read at all.
+  string contents;
+  ASSERT_TRUE(SynthesizePathologicalMinidump(
+      google_breakpad::PATHOLOGICAL_MANY_MODULES, 100000, &contents));
+  Process(contents, &state_, &result_);
+  EXPECT_TRUE(!state_.modules() || state_.modules()->module_count() == 0);
+}
+
+TEST_F(PathologicalMinidumpTest, OverlappingMemory) {
+  MinidumpMemoryList::set_max_regions(1 << 20);
+  CheckScaling(google_breakpad::PATHOLOGICAL_OVERLAPPING_MEMORY, 4000);
+  EXPECT_EQ(google_breakpad::PROCESS_OK, result_);
+}
+
+TEST_F(PathologicalMinidumpTest, DeepStack) {
+  CheckScaling(google_breakpad::PATHOLOGICAL_DEEP_STACK, 4000);
+  EXPECT_EQ(google_breakpad::PROCESS_OK, result_);
+  EXPECT_EQ(32000U, FrameCount());
+}
+
+TEST_F(PathologicalMinidumpTest, DeepStackPastMaxFrames) {
+  Stackwalker::set_max_frames(1000);
+  string contents;
+  ASSERT_TRUE(SynthesizePathologicalMinidump(
+      google_breakpad::PATHOLOGICAL_DEEP_STACK, 100000, &contents));
+  Process(contents, &state_, &result_);
+  EXPECT_EQ(google_breakpad::PROCESS_OK, result_);
+  // The walk stops as soon as it has gone past the limit.
+  EXPECT_EQ(1001U, FrameCount());
+}
+
+TEST_F(PathologicalMinidumpTest, ScannedStack) {
+  CheckScaling(google_breakpad::PATHOLOGICAL_SCANNED_STACK, 1000);
+  EXPECT_EQ(google_breakpad::PROCESS_OK, result_);
+  EXPECT_LE(8000U, FrameCount());
+}
+
+TEST_F(PathologicalMinidumpTest, ScannedStackPastMaxFramesScanned) {
+  Stackwalker::set_max_frames_scanned(1000);
+  string contents;
+  ASSERT_TRUE(SynthesizePathologicalMinidump(
+      google_breakpad::PATHOLOGICAL_SCANNED_STACK, 100000, &contents));
+  Process(contents, &state_, &result_);
+  EXPECT_EQ(google_breakpad::PROCESS_OK, result_);
+  // Scanning stops at the limit, after which only the context frame and
+  // the scanned frames are left.
+  EXPECT_GE(1002U, FrameCount());
+  EXPECT_LE(1000U, FrameCount());
+}
+
+TEST_F(PathologicalMinidumpTest, ScannedStackPastMaxConsecutiveFramesScanned) {
+  Stackwalker::set_max_consecutive_frames_scanned(100);
+  string contents;
+  ASSERT_TRUE(SynthesizePathologicalMinidump(
+      google_breakpad::PATHOLOGICAL_SCANNED_STACK, 100000, &contents));
+  Process(contents, &state_, &result_);
+  EXPECT_EQ(google_breakpad::PROCESS_OK, result_);
+  // Every frame but the context frame is scanned, so scanning stops after
+  // the first hundred.
+  EXPECT_GE(102U, FrameCount());
+  EXPECT_LE(100U, FrameCount());
+}
+
+TEST_F(PathologicalMinidumpTest, ScannedStackPastMaxWordsScanned) {
+  Stackwalker::set_max_words_scanned(1000);
+  string contents;
+  ASSERT_TRUE(SynthesizePathologicalMinidump(
+      google_breakpad::PATHOLOGICAL_SCANNED_STACK, 100000, &contents));
+  Process(contents, &state_, &result_);
+  EXPECT_EQ(google_breakpad::PROCESS_OK, result_);
+  // Each word scanned is a return address, so no more than a frame each
+  // is found before the words run out.
+  EXPECT_GE(1002U, FrameCount());
+  EXPECT_LE(100U, FrameCount());
+}
+
+TEST_F(PathologicalMinidumpTest, ScannedStackPastDeadline) {
+  // Without the limit on scanned frames, only the deadline stops the walk
+  // short of the million frames there are.
+  const int kSize = 1 << 20;
+  Stackwalker::set_max_frames(kSize * 2);
+  Stackwalker::set_max_frames_scanned(kSize * 2);
+  string contents;
+  ASSERT_TRUE(SynthesizePathologicalMinidump(
+      google_breakpad::PATHOLOGICAL_SCANNED_STACK, kSize, &contents));
+  std::istringstream stream(contents);
+  Minidump dump(stream);
+  ASSERT_TRUE(dump.Read());
+  BasicSourceLineResolver resolver;
+  MinidumpProcessor processor(NULL, &resolver);
+  CancellationToken token;
+  processor.set_cancellation_token(&token);
+  token.set_timeout(std::chrono::milliseconds(20));
+  result_ = processor.Process(&dump, &state_);
+  EXPECT_EQ(google_breakpad::PROCESS_CANCELLED, result_);
+  // The frames walked before the deadline are kept.
+  EXPECT_LE(1U, FrameCount());
+  EXPECT_GT(static_cast<size_t>(kSize), FrameCount());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
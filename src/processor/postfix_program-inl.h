@@ -0,0 +1,419 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// postfix_program-inl.h: PostfixProgram implementation.
+//
+// See postfix_program.h for documentation.
+
+#ifndef PROCESSOR_POSTFIX_PROGRAM_INL_H__
+#define PROCESSOR_POSTFIX_PROGRAM_INL_H__
+
+#include "processor/postfix_program.h"
+
+#include <ctype.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "google_breakpad/processor/memory_region.h"
+#include "processor/logging.h"
+#include "processor/postfix_evaluator-inl.h"
+
+namespace google_breakpad {
+
+inline PostfixProgram::PostfixProgram(const string& expression)
+    : expression_(expression), compiled_(false), final_depth_(0) {
+  compiled_ = Compile();
+  if (!compiled_) {
+    code_.clear();
+    registers_.clear();
+  }
+}
+
+inline int PostfixProgram::FindRegister(const string& name) const {
+  for (size_t i = 0; i < registers_.size(); ++i) {
+    if (registers_[i] == name)
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+inline int PostfixProgram::AddRegister(const string& name) {
+  int index = FindRegister(name);
+  if (index >= 0)
+    return index;
+  registers_.push_back(name);
+  return static_cast<int>(registers_.size() - 1);
+}
+
+inline bool PostfixProgram::Compile() {
+  // What each stack entry will hold when the program runs: an identifier, a
+  // literal, or a computed value.  Which one an entry is doesn't depend on
+  // the identifiers' values, so the checks PostfixEvaluator makes on the
+  // stack at run time can be made here.  Where one fails, the program gets
+  // an OP_FAIL, so that the assignments before it still take effect.
+  enum EntryKind { ENTRY_REGISTER, ENTRY_LITERAL, ENTRY_VALUE };
+  std::vector<EntryKind> stack;
+  std::vector<int> stack_registers;
+
+  std::istringstream stream(expression_);
+  string token;
+  std::vector<string> tokens;
+  while (stream >> token) {
+    // As in PostfixEvaluator, "=" may be smashed up against the next token.
+    if (token.size() > 1 && token[0] == '=') {
+      tokens.push_back("=");
+      tokens.push_back(token.substr(1));
+    } else {
+      tokens.push_back(token);
+    }
+  }
+
+  size_t max_depth = 0;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const string& token = tokens[i];
+    Instruction instruction;
+    instruction.literal = 0;
+    instruction.negative = false;
+    instruction.register_index = -1;
+
+    if (token == "+" || token == "-" || token == "*" || token == "/" ||
+        token == "%" || token == "@") {
+      if (stack.size() < 2) {
+        instruction.opcode = OP_FAIL;
+        code_.push_back(instruction);
+        break;
+      }
+      switch (token[0]) {
+        case '+': instruction.opcode = OP_ADD; break;
+        case '-': instruction.opcode = OP_SUBTRACT; break;
+        case '*': instruction.opcode = OP_MULTIPLY; break;
+        case '/': instruction.opcode = OP_DIVIDE; break;
+        case '%': instruction.opcode = OP_MODULUS; break;
+        default: instruction.opcode = OP_ALIGN; break;
+      }
+      stack.resize(stack.size() - 2);
+      stack_registers.resize(stack_registers.size() - 2);
+      stack.push_back(ENTRY_VALUE);
+      stack_registers.push_back(-1);
+    } else if (token == "^") {
+      if (stack.empty()) {
+        instruction.opcode = OP_FAIL;
+        code_.push_back(instruction);
+        break;
+      }
+      instruction.opcode = OP_DEREFERENCE;
+      stack.back() = ENTRY_VALUE;
+      stack_registers.back() = -1;
+    } else if (token == "=") {
+      // Only variables, whose names begin with '$', can be assigned to.
+      if (stack.size() < 2 || stack[stack.size() - 2] != ENTRY_REGISTER ||
+          registers_[stack_registers[stack_registers.size() - 2]][0] != '$') {
+        instruction.opcode = OP_FAIL;
+        code_.push_back(instruction);
+        break;
+      }
+      instruction.opcode = OP_ASSIGN;
+      instruction.register_index = stack_registers[stack_registers.size() - 2];
+      stack.resize(stack.size() - 2);
+      stack_registers.resize(stack_registers.size() - 2);
+    } else {
+      // A literal is an optional '-', an optional '+' and decimal digits,
+      // as read by istringstream.  Names begin with anything else; other
+      // tokens are left to PostfixEvaluator.
+      size_t position = 0;
+      bool negative = false;
+      if (token[position] == '-') {
+        negative = true;
+        ++position;
+      }
+      if (position < token.size() && token[position] == '+')
+        ++position;
+      bool is_name = position == 0 &&
+                     !isdigit(static_cast<unsigned char>(token[0]));
+      uint64_t literal = 0;
+      if (!is_name) {
+        if (position == token.size())
+          return false;
+        for (; position < token.size(); ++position) {
+          unsigned char digit = token[position];
+          if (!isdigit(digit))
+            return false;
+          if (literal > (~static_cast<uint64_t>(0) - (digit - '0')) / 10) {
+            // Too large for any ValueType, so PostfixEvaluator takes it for
+            // a name.
+            is_name = true;
+          }
+          literal = literal * 10 + (digit - '0');
+        }
+      }
+      if (is_name) {
+        instruction.opcode = OP_PUSH_REGISTER;
+        instruction.register_index = AddRegister(token);
+        stack.push_back(ENTRY_REGISTER);
+        stack_registers.push_back(instruction.register_index);
+      } else {
+        instruction.opcode = OP_PUSH_LITERAL;
+        instruction.literal = literal;
+        instruction.negative = negative;
+        stack.push_back(ENTRY_LITERAL);
+        stack_registers.push_back(-1);
+      }
+    }
+    code_.push_back(instruction);
+    max_depth = std::max(max_depth, stack.size());
+  }
+
+  final_depth_ = stack.size();
+  return registers_.size() <= kMaxRegisters && max_depth <= kMaxStackDepth;
+}
+
+template<typename ValueType>
+void PostfixProgram::LoadRegisters(
+    const std::map<string, ValueType>& dictionary,
+    Registers<ValueType>* registers) const {
+  for (size_t i = 0; i < registers_.size(); ++i) {
+    typename std::map<string, ValueType>::const_iterator it =
+        dictionary.find(registers_[i]);
+    if (it != dictionary.end()) {
+      registers->values[i] = it->second;
+      registers->known[i] = true;
+    }
+  }
+}
+
+template<typename ValueType>
+void PostfixProgram::StoreRegisters(const Registers<ValueType>& registers,
+                                    std::map<string, ValueType>* dictionary,
+                                    std::map<string, bool>* assigned) const {
+  for (size_t i = 0; i < registers_.size(); ++i) {
+    if (!registers.assigned[i])
+      continue;
+    (*dictionary)[registers_[i]] = registers.values[i];
+    if (assigned)
+      (*assigned)[registers_[i]] = true;
+  }
+}
+
+template<typename ValueType>
+bool PostfixProgram::Run(Registers<ValueType>* registers,
+                         const MemoryRegion* memory,
+                         size_t final_depth,
+                         ValueType* result) const {
+  // Identifiers are pushed as indices, and read when popped, as
+  // PostfixEvaluator would read them from its dictionary.
+  struct Entry {
+    ValueType value;
+    int register_index;
+  };
+  Entry stack[kMaxStackDepth];
+  size_t depth = 0;
+  ValueType operands[2];
+  for (size_t i = 0; i < code_.size(); ++i) {
+    const Instruction& instruction = code_[i];
+    int num_operands = 0;
+    switch (instruction.opcode) {
+      case OP_PUSH_LITERAL:
+      case OP_PUSH_REGISTER:
+        break;
+      case OP_FAIL:
+        BPLOG(ERROR) << "Invalid postfix expression: " << expression_;
+        return false;
+      case OP_DEREFERENCE:
+        if (!memory) {
+          BPLOG(ERROR) << "Attempt to dereference without memory: "
+                       << expression_;
+          return false;
+        }
+        num_operands = 1;
+        break;
+      case OP_ASSIGN:
+        // The value; Compile() checked that the identifier is below it.
+        num_operands = 1;
+        break;
+      default:
+        num_operands = 2;
+        break;
+    }
+    for (int j = num_operands - 1; j >= 0; --j) {
+      const Entry& entry = stack[--depth];
+      if (entry.register_index >= 0) {
+        if (!registers->known[entry.register_index]) {
+          BPLOG(INFO) << "Identifier " << registers_[entry.register_index]
+                      << " not in dictionary";
+          return false;
+        }
+        operands[j] = registers->values[entry.register_index];
+      } else {
+        operands[j] = entry.value;
+      }
+    }
+
+    Entry pushed;
+    pushed.register_index = -1;
+    switch (instruction.opcode) {
+      case OP_PUSH_LITERAL: {
+        ValueType literal = static_cast<ValueType>(instruction.literal);
+        if (static_cast<uint64_t>(literal) != instruction.literal) {
+          // Too large for ValueType: PostfixEvaluator would look it up as
+          // a name.
+          BPLOG(INFO) << "Identifier " << instruction.literal
+                      << " not in dictionary";
+          return false;
+        }
+        pushed.value = instruction.negative ? -literal : literal;
+        break;
+      }
+      case OP_PUSH_REGISTER:
+        pushed.value = ValueType();
+        pushed.register_index = instruction.register_index;
+        break;
+      case OP_ADD:
+        pushed.value = operands[0] + operands[1];
+        break;
+      case OP_SUBTRACT:
+        pushed.value = operands[0] - operands[1];
+        break;
+      case OP_MULTIPLY:
+        pushed.value = operands[0] * operands[1];
+        break;
+      case OP_DIVIDE:
+      case OP_MODULUS:
+        if (operands[1] == 0) {
+          BPLOG(ERROR) << "Division by zero: " << expression_;
+          return false;
+        }
+        pushed.value = instruction.opcode == OP_DIVIDE ?
+            operands[0] / operands[1] : operands[0] % operands[1];
+        break;
+      case OP_ALIGN:
+        pushed.value =
+            operands[0] & (static_cast<ValueType>(-1) ^ (operands[1] - 1));
+        break;
+      case OP_DEREFERENCE:
+        if (!memory->GetMemoryAtAddress(operands[0], &pushed.value)) {
+          BPLOG(ERROR) << "Could not dereference memory at address "
+                       << HexString(operands[0]) << ": " << expression_;
+          return false;
+        }
+        break;
+      case OP_ASSIGN:
+        --depth;
+        registers->values[instruction.register_index] = operands[0];
+        registers->known[instruction.register_index] = true;
+        registers->assigned[instruction.register_index] = true;
+        continue;
+      case OP_FAIL:
+        return false;
+    }
+    stack[depth++] = pushed;
+  }
+
+  if (depth != final_depth) {
+    BPLOG(ERROR) << "Expression yielded bad number of results: '"
+                 << expression_ << "'";
+    return false;
+  }
+  if (final_depth == 0)
+    return true;
+
+  const Entry& entry = stack[0];
+  if (entry.register_index >= 0) {
+    if (!registers->known[entry.register_index]) {
+      BPLOG(INFO) << "Identifier " << registers_[entry.register_index]
+                  << " not in dictionary";
+      return false;
+    }
+    *result = registers->values[entry.register_index];
+  } else {
+    *result = entry.value;
+  }
+  return true;
+}
+
+template<typename ValueType>
+bool PostfixProgram::Evaluate(Registers<ValueType>* registers,
+                              const MemoryRegion* memory) const {
+  return Run(registers, memory, 0, static_cast<ValueType*>(NULL));
+}
+
+template<typename ValueType>
+bool PostfixProgram::EvaluateForValue(Registers<ValueType>* registers,
+                                      const MemoryRegion* memory,
+                                      ValueType* result) const {
+  return Run(registers, memory, 1, result);
+}
+
+template<typename ValueType>
+bool PostfixProgram::Evaluate(std::map<string, ValueType>* dictionary,
+                              const MemoryRegion* memory,
+                              std::map<string, bool>* assigned) const {
+  if (!compiled_) {
+    PostfixEvaluator<ValueType> evaluator(dictionary, memory);
+    return evaluator.Evaluate(expression_, assigned);
+  }
+  Registers<ValueType> registers;
+  LoadRegisters(*dictionary, &registers);
+  bool result = Evaluate(&registers, memory);
+  StoreRegisters(registers, dictionary, assigned);
+  return result;
+}
+
+template<typename ValueType>
+bool PostfixProgram::EvaluateForValue(
+    const std::map<string, ValueType>& dictionary,
+    const MemoryRegion* memory,
+    ValueType* result) const {
+  if (!compiled_) {
+    std::map<string, ValueType> working = dictionary;
+    PostfixEvaluator<ValueType> evaluator(&working, memory);
+    return evaluator.EvaluateForValue(expression_, result);
+  }
+  Registers<ValueType> registers;
+  LoadRegisters(dictionary, &registers);
+  return EvaluateForValue(&registers, memory, result);
+}
+
+inline std::shared_ptr<const PostfixProgram> PostfixProgramCache::Get(
+    const void* key, const string& expression) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ProgramMap::const_iterator it = programs_.find(key);
+  if (it != programs_.end() && it->second->expression() == expression)
+    return it->second;
+  if (programs_.size() >= kMaxEntries)
+    programs_.clear();
+  std::shared_ptr<const PostfixProgram> program(
+      new PostfixProgram(expression));
+  programs_[key] = program;
+  return program;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_POSTFIX_PROGRAM_INL_H__
@@ -0,0 +1,233 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// postfix_program.h: A postfix expression compiled for fast evaluation.
+//
+// PostfixProgram compiles an expression in the language PostfixEvaluator
+// interprets (see postfix_evaluator.h) once, so that it can be evaluated
+// many times without tokenizing it again.  The compiled program refers to
+// identifiers by index into a small fixed-size array rather than by name,
+// and keeps its operand stack as values rather than strings, so evaluating
+// it allocates no memory.
+//
+// Evaluation gives the same results as PostfixEvaluator, including which
+// variables a failing expression has already assigned to, with one
+// exception: dividing by zero fails instead of trapping.  Expressions the
+// compiler does not handle, because they use more than kMaxRegisters
+// identifiers, would need more than kMaxStackDepth stack entries, or have
+// tokens that are neither operators, plain decimal literals nor names, are
+// left uncompiled; compiled() returns false for them, and the convenience
+// Evaluate and EvaluateForValue methods fall back to PostfixEvaluator.
+
+#ifndef PROCESSOR_POSTFIX_PROGRAM_H__
+#define PROCESSOR_POSTFIX_PROGRAM_H__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class MemoryRegion;
+
+class PostfixProgram {
+ public:
+  // The most identifiers and stack entries a compiled program may use.
+  static const size_t kMaxRegisters = 16;
+  static const size_t kMaxStackDepth = 32;
+
+  // The values of the identifiers a program uses, by index.  Only
+  // register_count() entries are used.
+  template<typename ValueType>
+  struct Registers {
+    Registers() {
+      for (size_t i = 0; i < kMaxRegisters; ++i) {
+        values[i] = ValueType();
+        known[i] = false;
+        assigned[i] = false;
+      }
+    }
+
+    ValueType values[kMaxRegisters];
+    // Whether values[i] holds a value.
+    bool known[kMaxRegisters];
+    // Whether the program assigned to values[i].
+    bool assigned[kMaxRegisters];
+  };
+
+  PostfixProgram() : compiled_(false), final_depth_(0) { }
+
+  // Compiles |expression|.
+  explicit PostfixProgram(const string& expression);
+
+  const string& expression() const { return expression_; }
+
+  // Whether the expression could be compiled.  Programs that weren't may
+  // only be evaluated through the dictionary-based methods below.
+  bool compiled() const { return compiled_; }
+
+  // The identifiers the program uses, by index.
+  size_t register_count() const { return registers_.size(); }
+  const string& register_name(size_t index) const { return registers_[index]; }
+
+  // Returns the index of the identifier |name|, or -1 if the program
+  // doesn't use it.
+  int FindRegister(const string& name) const;
+
+  // Sets the entries of |registers| for identifiers found in |dictionary|.
+  template<typename ValueType>
+  void LoadRegisters(const std::map<string, ValueType>& dictionary,
+                     Registers<ValueType>* registers) const;
+
+  // Copies the entries of |registers| the program assigned to into
+  // |dictionary|, and sets them to true in |assigned| if it isn't NULL.
+  template<typename ValueType>
+  void StoreRegisters(const Registers<ValueType>& registers,
+                      std::map<string, ValueType>* dictionary,
+                      std::map<string, bool>* assigned) const;
+
+  // Runs a compiled program, like PostfixEvaluator::Evaluate: the program
+  // must leave nothing on the stack.  |memory| may be NULL, in which case
+  // dereferencing fails.  Returns false on failure, leaving the entries
+  // assigned so far in |registers|.
+  template<typename ValueType>
+  bool Evaluate(Registers<ValueType>* registers,
+                const MemoryRegion* memory) const;
+
+  // Runs a compiled program like PostfixEvaluator::EvaluateForValue: the
+  // program must leave exactly one value on the stack, which is stored in
+  // *|result|.
+  template<typename ValueType>
+  bool EvaluateForValue(Registers<ValueType>* registers,
+                        const MemoryRegion* memory,
+                        ValueType* result) const;
+
+  // Evaluates the program with |dictionary|, exactly as
+  // PostfixEvaluator::Evaluate would, whether or not it is compiled.
+  template<typename ValueType>
+  bool Evaluate(std::map<string, ValueType>* dictionary,
+                const MemoryRegion* memory,
+                std::map<string, bool>* assigned) const;
+
+  // Evaluates the program with |dictionary|, exactly as
+  // PostfixEvaluator::EvaluateForValue would, whether or not it is compiled.
+  template<typename ValueType>
+  bool EvaluateForValue(const std::map<string, ValueType>& dictionary,
+                        const MemoryRegion* memory,
+                        ValueType* result) const;
+
+ private:
+  enum Opcode {
+    // Push a literal.
+    OP_PUSH_LITERAL,
+    // Push an identifier, whose value is read when it is popped.
+    OP_PUSH_REGISTER,
+    OP_ADD,
+    OP_SUBTRACT,
+    OP_MULTIPLY,
+    OP_DIVIDE,
+    OP_MODULUS,
+    OP_ALIGN,
+    OP_DEREFERENCE,
+    // Pop a value and the identifier below it, and assign the value to it.
+    OP_ASSIGN,
+    // Fail: the expression can't be evaluated past this point.
+    OP_FAIL
+  };
+
+  struct Instruction {
+    Opcode opcode;
+    // For OP_PUSH_LITERAL, the literal's magnitude and sign.
+    uint64_t literal;
+    bool negative;
+    // For OP_PUSH_REGISTER and OP_ASSIGN, the identifier's index.
+    int register_index;
+  };
+
+  // Compiles expression_ into code_ and registers_.  Returns false if the
+  // expression can't be compiled.
+  bool Compile();
+
+  // Returns the index of |name| in registers_, adding it if needed.
+  int AddRegister(const string& name);
+
+  // Runs the program, which must leave |final_depth| entries on the stack;
+  // if it is 1, *|result| is set to the value left.
+  template<typename ValueType>
+  bool Run(Registers<ValueType>* registers,
+           const MemoryRegion* memory,
+           size_t final_depth,
+           ValueType* result) const;
+
+  string expression_;
+  bool compiled_;
+  std::vector<Instruction> code_;
+  std::vector<string> registers_;
+
+  // The number of entries the program leaves on the stack.
+  size_t final_depth_;
+};
+
+// A cache of compiled programs, keyed by the address of the record each
+// program came from, so that a symbol file's program strings are compiled
+// once, however many frames they unwind.  The cache holds up to kMaxEntries
+// programs, and is safe to use from several threads.
+class PostfixProgramCache {
+ public:
+  PostfixProgramCache() { }
+
+  // Returns the program compiled from |expression| for the record at
+  // |key|, compiling it if it isn't cached yet.
+  std::shared_ptr<const PostfixProgram> Get(const void* key,
+                                            const string& expression);
+
+ private:
+  // Once the cache is full it is emptied; programs are cheap to rebuild
+  // and stack walks reuse only a handful of them.
+  static const size_t kMaxEntries = 4096;
+
+  typedef std::map<const void*, std::shared_ptr<const PostfixProgram> >
+      ProgramMap;
+
+  std::mutex mutex_;
+  ProgramMap programs_;
+
+  // Disallow copy constructor and assignment operator.
+  PostfixProgramCache(const PostfixProgramCache&);
+  void operator=(const PostfixProgramCache&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_POSTFIX_PROGRAM_H__
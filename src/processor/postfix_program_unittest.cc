@@ -0,0 +1,246 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// postfix_program_unittest.cc: Unit tests for PostfixProgram.
+//
+// Most of these tests check that a compiled program gives the same results
+// as PostfixEvaluator interpreting the same expression.
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/memory_region.h"
+#include "processor/postfix_evaluator-inl.h"
+#include "processor/postfix_program-inl.h"
+
+namespace {
+
+using google_breakpad::MemoryRegion;
+using google_breakpad::PostfixEvaluator;
+using google_breakpad::PostfixProgram;
+using google_breakpad::PostfixProgramCache;
+using std::map;
+
+// Memory in which odd addresses can't be read, and each even address holds
+// a value computed from the address.
+class FakeMemoryRegion : public MemoryRegion {
+ public:
+  uint64_t GetBase() const { return 0; }
+  uint32_t GetSize() const { return 0xffffffff; }
+  bool GetMemoryAtAddress(uint64_t address, uint8_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint16_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint32_t* value) const {
+    return Get(address, value);
+  }
+  bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const {
+    return Get(address, value);
+  }
+  void Print() const { }
+
+ private:
+  template<typename T>
+  bool Get(uint64_t address, T* value) const {
+    if (address & 1)
+      return false;
+    *value = static_cast<T>(address * 7 + 3);
+    return true;
+  }
+};
+
+template<typename V>
+map<string, V> MakeDictionary() {
+  map<string, V> dictionary;
+  dictionary["$ebp"] = 0x1000;
+  dictionary["$esp"] = 0x0ff0;
+  dictionary["$odd"] = 0x1001;
+  dictionary[".cbSavedRegs"] = 12;
+  for (int i = 0; i < 20; ++i) {
+    char name[8];
+    snprintf(name, sizeof(name), "$r%d", i);
+    dictionary[name] = i;
+  }
+  return dictionary;
+}
+
+const char* kExpressions[] = {
+  "", "1", "-1", "+5", "-+5", "--5", "4294967295", "4294967296",
+  "18446744073709551615", "18446744073709551616", "-18446744073709551616",
+  "0x10", "5x", "$ebp", "$nope", "$ebp 4 +", "$ebp 8 - ^", "$odd ^",
+  "$esp 16 @", "$ebp $esp *", "$ebp 3 /", "$ebp 3 %", "$ebp $esp -",
+  "+", "^", "=", "1 2", "5 3 =", "$ebp 3 =", "ebp 3 =", "$T0 $T1 =",
+  "$T0 $ebp 8 + =", "$T0 $ebp 8 + = $T0 ^ $T0 +",
+  "$T0 $ebp 8 + =$T1 $T0 4 - = $T1", "$T0 $ebp =$eip $T0 4 + ^ =$ebp $T0 ^ =",
+  "$T0 1 = $T0 $T0 2 = $T0 +", "$T0 4 = $T0 $T0 ^ =", "$T0 4 = $T0 1 =",
+  "$eip 1 = $odd ^ $esp 2 =", "$eip 1 = $esp 2 = +", "$eip 1 = = $esp 2 =",
+  "$eip 1 = $esp ==x", "$eip $nope = $esp 2 =", "$eip 1 = 99 $esp 2 =",
+  "$eip .raSearchStart ^ = $esp .raSearchStart 4 + =",
+  "$T0 $ebp = $eip $T0 4 + ^ = $ebp $T0 ^ = $esp $T0 8 + = "
+  "$L $T0 .cbSavedRegs - = $P $T0 8 + .cbParams + =",
+  "$r0 $r1 + $r2 + $r3 + $r4 + $r5 + $r6 + $r7 + $r8 + $r9 + $r10 + "
+  "$r11 + $r12 + $r13 + $r14 + $r15 + $r16 + $r17 + $r18 + $r19 +",
+  "1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 "
+  "27 28 29 30 31 32 33 34 + + + + + + + + + + + + + + + + + + + + + + + "
+  "+ + + + + + + + + +",
+};
+
+// Checks that evaluating EXPRESSION as a program gives the same result,
+// dictionary and assigned variables as PostfixEvaluator::Evaluate.
+template<typename V>
+void CheckEvaluateMatches(const string& expression) {
+  FakeMemoryRegion memory;
+  map<string, V> expected_dictionary = MakeDictionary<V>();
+  map<string, bool> expected_assigned;
+  PostfixEvaluator<V> evaluator(&expected_dictionary, &memory);
+  bool expected_result = evaluator.Evaluate(expression, &expected_assigned);
+
+  PostfixProgram program(expression);
+  map<string, V> dictionary = MakeDictionary<V>();
+  map<string, bool> assigned;
+  bool result = program.Evaluate(&dictionary, &memory, &assigned);
+
+  EXPECT_EQ(expected_result, result) << expression;
+  EXPECT_TRUE(expected_dictionary == dictionary) << expression;
+  EXPECT_TRUE(expected_assigned == assigned) << expression;
+}
+
+// Checks that evaluating EXPRESSION as a program for its value gives the
+// same result as PostfixEvaluator::EvaluateForValue.
+template<typename V>
+void CheckEvaluateForValueMatches(const string& expression) {
+  FakeMemoryRegion memory;
+  map<string, V> expected_dictionary = MakeDictionary<V>();
+  PostfixEvaluator<V> evaluator(&expected_dictionary, &memory);
+  V expected_value = 0;
+  bool expected_result = evaluator.EvaluateForValue(expression,
+                                                    &expected_value);
+
+  PostfixProgram program(expression);
+  V value = 0;
+  bool result = program.EvaluateForValue(MakeDictionary<V>(), &memory,
+                                         &value);
+
+  EXPECT_EQ(expected_result, result) << expression;
+  if (expected_result && result)
+    EXPECT_EQ(expected_value, value) << expression;
+}
+
+TEST(PostfixProgramTest, EvaluateMatchesPostfixEvaluator) {
+  for (size_t i = 0; i < sizeof(kExpressions) / sizeof(kExpressions[0]);
+       ++i) {
+    CheckEvaluateMatches<uint32_t>(kExpressions[i]);
+    CheckEvaluateMatches<uint64_t>(kExpressions[i]);
+  }
+}
+
+TEST(PostfixProgramTest, EvaluateForValueMatchesPostfixEvaluator) {
+  for (size_t i = 0; i < sizeof(kExpressions) / sizeof(kExpressions[0]);
+       ++i) {
+    CheckEvaluateForValueMatches<uint32_t>(kExpressions[i]);
+    CheckEvaluateForValueMatches<uint64_t>(kExpressions[i]);
+  }
+}
+
+TEST(PostfixProgramTest, Compiled) {
+  EXPECT_TRUE(PostfixProgram("$T0 $ebp 8 + = $eip $T0 ^ =").compiled());
+  EXPECT_TRUE(PostfixProgram("$eip 1 = +").compiled());
+  EXPECT_TRUE(PostfixProgram("18446744073709551616").compiled());
+  EXPECT_FALSE(PostfixProgram("0x10").compiled());
+  EXPECT_FALSE(PostfixProgram("-+").compiled());
+
+  PostfixProgram program("$T0 $ebp 8 + = $eip $T0 ^ =");
+  ASSERT_EQ(3U, program.register_count());
+  EXPECT_EQ(0, program.FindRegister("$T0"));
+  EXPECT_EQ(1, program.FindRegister("$ebp"));
+  EXPECT_EQ(2, program.FindRegister("$eip"));
+  EXPECT_EQ(-1, program.FindRegister("$esp"));
+}
+
+TEST(PostfixProgramTest, Registers) {
+  FakeMemoryRegion memory;
+  PostfixProgram program("$eip $esp ^ = $esp $esp 4 + =");
+  PostfixProgram::Registers<uint32_t> registers;
+  int esp = program.FindRegister("$esp");
+  int eip = program.FindRegister("$eip");
+  ASSERT_GE(esp, 0);
+  ASSERT_GE(eip, 0);
+  registers.values[esp] = 0x2000;
+  registers.known[esp] = true;
+  ASSERT_TRUE(program.Evaluate(&registers, &memory));
+  EXPECT_EQ(0x2000U * 7 + 3, registers.values[eip]);
+  EXPECT_EQ(0x2004U, registers.values[esp]);
+  EXPECT_TRUE(registers.assigned[eip]);
+  EXPECT_TRUE(registers.assigned[esp]);
+
+  // Without memory, dereferencing fails.
+  PostfixProgram::Registers<uint32_t> no_memory;
+  no_memory.values[esp] = 0x2000;
+  no_memory.known[esp] = true;
+  EXPECT_FALSE(program.Evaluate(&no_memory, NULL));
+}
+
+// Unlike PostfixEvaluator, programs fail on division by zero.
+TEST(PostfixProgramTest, DivisionByZero) {
+  FakeMemoryRegion memory;
+  map<string, uint32_t> dictionary = MakeDictionary<uint32_t>();
+  uint32_t value;
+  EXPECT_FALSE(PostfixProgram("$ebp 0 /").EvaluateForValue(dictionary,
+                                                           &memory, &value));
+  EXPECT_FALSE(PostfixProgram("$ebp 0 %").EvaluateForValue(dictionary,
+                                                           &memory, &value));
+}
+
+TEST(PostfixProgramCacheTest, Get) {
+  PostfixProgramCache cache;
+  int first, second;
+  std::shared_ptr<const PostfixProgram> program = cache.Get(&first, "$ebp");
+  ASSERT_TRUE(program.get());
+  EXPECT_EQ("$ebp", program->expression());
+  EXPECT_EQ(program.get(), cache.Get(&first, "$ebp").get());
+  EXPECT_NE(program.get(), cache.Get(&second, "$ebp").get());
+
+  // A key whose record has a different program string is recompiled.
+  std::shared_ptr<const PostfixProgram> other = cache.Get(&first, "$esp");
+  EXPECT_EQ("$esp", other->expression());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
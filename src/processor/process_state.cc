@@ -36,11 +36,17 @@
 #include "google_breakpad/processor/process_state.h"
 #include "google_breakpad/processor/call_stack.h"
 #include "google_breakpad/processor/code_modules.h"
+#include "processor/basic_code_modules.h"
+#include "processor/frame_arena.h"
 
 namespace google_breakpad {
 
 ProcessState::~ProcessState() {
   Clear();
+  for (size_t i = 0; i < spare_threads_.size(); ++i)
+    delete spare_threads_[i];
+  delete module_storage_;
+  frame_arena_->Release();
 }
 
 void ProcessState::Clear() {
@@ -51,21 +57,49 @@ void ProcessState::Clear() {
   crash_address_ = 0;
   assertion_.clear();
   requesting_thread_ = -1;
+  exception_record_ = ExceptionRecord();
   for (vector<CallStack*>::const_iterator iterator = threads_.begin();
        iterator != threads_.end();
        ++iterator) {
-    delete *iterator;
+    (*iterator)->Clear();
+    spare_threads_.push_back(*iterator);
   }
   threads_.clear();
+  // thread_memory_regions_ doesn't own the regions, which belong to the
+  // dump.
+  thread_memory_regions_.clear();
+  // The frames went with the threads, so their arena's blocks can be
+  // carved up again, unless a frame is still out there keeping them.
+  if (!frame_arena_ || !frame_arena_->Reset()) {
+    if (frame_arena_)
+      frame_arena_->Release();
+    frame_arena_ = new FrameArena();
+  }
   system_info_.Clear();
   // modules_without_symbols_ and modules_with_corrupt_symbols_ DO NOT own
   // the underlying CodeModule pointers.  Just clear the vectors.
   modules_without_symbols_.clear();
   modules_with_corrupt_symbols_.clear();
-  delete modules_;
+  shrunk_range_modules_.clear();
+  if (modules_ != module_storage_)
+    delete modules_;
   modules_ = NULL;
   delete unloaded_modules_;
   unloaded_modules_ = NULL;
 }
 
+CallStack* ProcessState::NewCallStack() {
+  if (spare_threads_.empty())
+    return new CallStack();
+  CallStack* stack = spare_threads_.back();
+  spare_threads_.pop_back();
+  return stack;
+}
+
+BasicCodeModules* ProcessState::ModuleStorage() {
+  if (!module_storage_)
+    module_storage_ = new BasicCodeModules();
+  return module_storage_;
+}
+
 }  // namespace google_breakpad
@@ -0,0 +1,830 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_arrow_writer.cc: Writes ProcessStates as an Arrow IPC
+// stream.
+//
+// See process_state_arrow_writer.h for documentation.
+//
+// The stream is a sequence of messages, each a flatbuffer describing it,
+// as defined by the Arrow format's Message.fbs and Schema.fbs, followed by
+// a body holding the columns' buffers.  The flatbuffers are laid out here
+// front to back, each table's vtable ahead of it and what it refers to
+// after it, which is as valid a layout as the usual builder's.
+
+#include "processor/process_state_arrow_writer.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "google_breakpad/processor/system_info.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// From Message.fbs.
+const int kMetadataVersionV5 = 4;
+enum MessageHeader {
+  kSchema = 1,
+  kDictionaryBatch = 2,
+  kRecordBatch = 3
+};
+
+// From Schema.fbs.
+enum Type {
+  kInt = 2,
+  kUtf8 = 5,
+  kBool = 6,
+  kList = 12,
+  kStruct = 13
+};
+
+// Each message's metadata is preceded by this and its size.
+const uint32_t kContinuation = 0xffffffff;
+
+// A flatbuffer table, string or vector, as much of the format as Arrow's
+// metadata needs.
+struct FlatNode {
+  enum Kind {
+    TABLE,
+    STRING,
+    STRUCTS,  // A vector of structs, given as their encoding.
+    TABLES    // A vector of tables.
+  };
+
+  // A table's field: a scalar of |size| bytes, or an offset to |child|.
+  struct Field {
+    int id;
+    int size;
+    uint64_t scalar;
+    std::unique_ptr<FlatNode> child;
+  };
+
+  explicit FlatNode(Kind kind) : kind(kind), count(0) {}
+
+  void AddScalar(int id, int size, uint64_t value) {
+    Field field = { id, size, value, std::unique_ptr<FlatNode>() };
+    fields.push_back(std::move(field));
+  }
+
+  void AddChild(int id, std::unique_ptr<FlatNode> child) {
+    Field field = { id, 4, 0, std::move(child) };
+    fields.push_back(std::move(field));
+  }
+
+  Kind kind;
+  std::vector<Field> fields;
+  // A string's characters, or the structs' encoding.
+  string bytes;
+  size_t count;
+  std::vector<std::unique_ptr<FlatNode> > elements;
+};
+
+std::unique_ptr<FlatNode> NewTable() {
+  return std::unique_ptr<FlatNode>(new FlatNode(FlatNode::TABLE));
+}
+
+std::unique_ptr<FlatNode> NewString(const string& value) {
+  std::unique_ptr<FlatNode> node(new FlatNode(FlatNode::STRING));
+  node->bytes = value;
+  return node;
+}
+
+std::unique_ptr<FlatNode> NewStructs(const string& bytes, size_t count) {
+  std::unique_ptr<FlatNode> node(new FlatNode(FlatNode::STRUCTS));
+  node->bytes = bytes;
+  node->count = count;
+  return node;
+}
+
+std::unique_ptr<FlatNode> NewTables() {
+  return std::unique_ptr<FlatNode>(new FlatNode(FlatNode::TABLES));
+}
+
+void Pad(string* buffer, size_t alignment) {
+  buffer->append((alignment - buffer->size() % alignment) % alignment, '\0');
+}
+
+void AppendLittleEndian(string* buffer, uint64_t value, int size) {
+  for (int i = 0; i < size; ++i)
+    buffer->push_back(static_cast<char>(value >> (8 * i)));
+}
+
+void PutLittleEndian(string* buffer, size_t position, uint64_t value,
+                     int size) {
+  for (int i = 0; i < size; ++i)
+    (*buffer)[position + i] = static_cast<char>(value >> (8 * i));
+}
+
+size_t LayOut(const FlatNode& node, string* buffer);
+
+size_t LayOutTable(const FlatNode& node, string* buffer) {
+  int slots = 0;
+  bool wide = false;
+  std::vector<const FlatNode::Field*> fields;
+  for (size_t i = 0; i < node.fields.size(); ++i) {
+    slots = std::max(slots, node.fields[i].id + 1);
+    wide = wide || node.fields[i].size == 8;
+    fields.push_back(&node.fields[i]);
+  }
+  // Widest first, so that aligning them wastes little.
+  std::stable_sort(fields.begin(), fields.end(),
+                   [](const FlatNode::Field* a, const FlatNode::Field* b) {
+                     return a->size > b->size;
+                   });
+
+  // The vtable: its size, the table's, and each field's offset in the
+  // table, 0 for those left out.
+  Pad(buffer, 4);
+  size_t vtable = buffer->size();
+  size_t vtable_size = 4 + 2 * slots;
+  buffer->append(vtable_size, '\0');
+
+  // The table: the distance back to its vtable, then the fields, each
+  // aligned to its size.
+  Pad(buffer, 4);
+  if (wide && (buffer->size() + 4) % 8 != 0)
+    buffer->append(4, '\0');
+  size_t table = buffer->size();
+  AppendLittleEndian(buffer, table - vtable, 4);
+  std::vector<size_t> positions;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    Pad(buffer, fields[i]->size);
+    positions.push_back(buffer->size());
+    PutLittleEndian(buffer, vtable + 4 + 2 * fields[i]->id,
+                    buffer->size() - table, 2);
+    AppendLittleEndian(buffer, fields[i]->scalar, fields[i]->size);
+  }
+  PutLittleEndian(buffer, vtable, vtable_size, 2);
+  PutLittleEndian(buffer, vtable + 2, buffer->size() - table, 2);
+
+  for (size_t i = 0; i < fields.size(); ++i) {
+    if (fields[i]->child) {
+      size_t child = LayOut(*fields[i]->child, buffer);
+      PutLittleEndian(buffer, positions[i], child - positions[i], 4);
+    }
+  }
+  return table;
+}
+
+// Lays |node| out at the end of |buffer|, followed by what it refers to,
+// and returns where it starts.  |buffer| must start 8-byte aligned.
+size_t LayOut(const FlatNode& node, string* buffer) {
+  size_t position;
+  switch (node.kind) {
+    case FlatNode::TABLE:
+      return LayOutTable(node, buffer);
+    case FlatNode::STRING:
+      Pad(buffer, 4);
+      position = buffer->size();
+      AppendLittleEndian(buffer, node.bytes.size(), 4);
+      buffer->append(node.bytes);
+      buffer->push_back('\0');
+      return position;
+    case FlatNode::STRUCTS:
+      // Arrow's structs hold 64-bit values, which follow the 4-byte count.
+      if ((buffer->size() + 4) % 8 != 0)
+        Pad(buffer, 4);
+      if ((buffer->size() + 4) % 8 != 0)
+        buffer->append(4, '\0');
+      position = buffer->size();
+      AppendLittleEndian(buffer, node.count, 4);
+      buffer->append(node.bytes);
+      return position;
+    case FlatNode::TABLES:
+      Pad(buffer, 4);
+      position = buffer->size();
+      AppendLittleEndian(buffer, node.elements.size(), 4);
+      buffer->append(4 * node.elements.size(), '\0');
+      for (size_t i = 0; i < node.elements.size(); ++i) {
+        size_t slot = position + 4 + 4 * i;
+        size_t element = LayOut(*node.elements[i], buffer);
+        PutLittleEndian(buffer, slot, element - slot, 4);
+      }
+      return position;
+  }
+  return 0;
+}
+
+// Returns the flatbuffer with |root| as its root table, padded to a
+// multiple of 8 bytes.
+string FlatBuffer(const FlatNode& root) {
+  string buffer(4, '\0');
+  size_t position = LayOut(root, &buffer);
+  PutLittleEndian(&buffer, 0, position, 4);
+  Pad(&buffer, 8);
+  return buffer;
+}
+
+std::unique_ptr<FlatNode> IntType(int bit_width, bool is_signed) {
+  std::unique_ptr<FlatNode> type = NewTable();
+  type->AddScalar(0, 4, bit_width);
+  type->AddScalar(1, 1, is_signed);
+  return type;
+}
+
+// Returns a non-nullable Field of the type given by |type_type| and |type|.
+std::unique_ptr<FlatNode> NewField(const string& name,
+                                   Type type_type,
+                                   std::unique_ptr<FlatNode> type,
+                                   std::unique_ptr<FlatNode> children) {
+  std::unique_ptr<FlatNode> field = NewTable();
+  field->AddChild(0, NewString(name));
+  field->AddScalar(1, 1, false);
+  field->AddScalar(2, 1, type_type);
+  field->AddChild(3, std::move(type));
+  field->AddChild(5, children ? std::move(children) : NewTables());
+  return field;
+}
+
+bool HostIsBigEndian() {
+  const uint16_t probe = 1;
+  return *reinterpret_cast<const uint8_t*>(&probe) == 0;
+}
+
+// The field nodes and buffers of a record batch, and its body, which
+// holds the buffers' contents in the host's byte order.
+class BatchBody {
+ public:
+  BatchBody() : node_count_(0), buffer_count_(0) {}
+
+  void AddNode(size_t length) {
+    AppendLittleEndian(&nodes_, length, 8);
+    AppendLittleEndian(&nodes_, 0, 8);  // null_count
+    ++node_count_;
+  }
+
+  // Adds a buffer holding |size| bytes at |data|, padded as Arrow
+  // requires.  Columns have no nulls, so their validity buffers are empty.
+  void AddBuffer(const void* data, size_t size) {
+    AppendLittleEndian(&buffers_, body_.size(), 8);
+    AppendLittleEndian(&buffers_, size, 8);
+    ++buffer_count_;
+    if (size > 0)
+      body_.append(static_cast<const char*>(data), size);
+    Pad(&body_, 8);
+  }
+
+  // Returns the RecordBatch describing the body, of |length| rows.
+  std::unique_ptr<FlatNode> RecordBatch(size_t length) const {
+    std::unique_ptr<FlatNode> batch = NewTable();
+    batch->AddScalar(0, 8, length);
+    batch->AddChild(1, NewStructs(nodes_, node_count_));
+    batch->AddChild(2, NewStructs(buffers_, buffer_count_));
+    return batch;
+  }
+
+  const string& body() const { return body_; }
+
+ private:
+  string nodes_;
+  size_t node_count_;
+  string buffers_;
+  size_t buffer_count_;
+  string body_;
+};
+
+// A column of a record batch, collecting the values of its rows until they
+// are written.
+class Column {
+ public:
+  explicit Column(const string& name) : name_(name) {}
+  virtual ~Column() {}
+
+  const string& name() const { return name_; }
+
+  // Returns the column's Field for the schema.
+  virtual std::unique_ptr<FlatNode> Field() const = 0;
+
+  // Adds the column's node and buffers to |body|, followed by any
+  // children's.
+  virtual void AddTo(BatchBody* body) const = 0;
+
+  // Forgets the rows collected.
+  virtual void Clear() = 0;
+
+ private:
+  string name_;
+};
+
+template<typename T>
+class IntColumn : public Column {
+ public:
+  explicit IntColumn(const string& name) : Column(name) {}
+
+  void Append(T value) { values_.push_back(value); }
+
+  std::unique_ptr<FlatNode> Field() const {
+    return NewField(name(), kInt,
+                    IntType(8 * sizeof(T), std::numeric_limits<T>::is_signed),
+                    std::unique_ptr<FlatNode>());
+  }
+
+  void AddTo(BatchBody* body) const {
+    body->AddNode(values_.size());
+    body->AddBuffer(NULL, 0);
+    body->AddBuffer(values_.data(), values_.size() * sizeof(T));
+  }
+
+  void Clear() { values_.clear(); }
+
+ private:
+  std::vector<T> values_;
+};
+
+class BoolColumn : public Column {
+ public:
+  explicit BoolColumn(const string& name) : Column(name), length_(0) {}
+
+  void Append(bool value) {
+    if (length_ % 8 == 0)
+      bits_.push_back(0);
+    if (value)
+      bits_.back() |= 1 << (length_ % 8);
+    ++length_;
+  }
+
+  std::unique_ptr<FlatNode> Field() const {
+    return NewField(name(), kBool, NewTable(), std::unique_ptr<FlatNode>());
+  }
+
+  void AddTo(BatchBody* body) const {
+    body->AddNode(length_);
+    body->AddBuffer(NULL, 0);
+    body->AddBuffer(bits_.data(), bits_.size());
+  }
+
+  void Clear() {
+    bits_.clear();
+    length_ = 0;
+  }
+
+ private:
+  std::vector<uint8_t> bits_;
+  size_t length_;
+};
+
+class StringColumn : public Column {
+ public:
+  explicit StringColumn(const string& name)
+      : Column(name), offsets_(1, 0) {}
+
+  void Append(const string& value) {
+    data_.append(value);
+    offsets_.push_back(static_cast<int32_t>(data_.size()));
+  }
+
+  size_t length() const { return offsets_.size() - 1; }
+
+  std::unique_ptr<FlatNode> Field() const {
+    return NewField(name(), kUtf8, NewTable(), std::unique_ptr<FlatNode>());
+  }
+
+  void AddTo(BatchBody* body) const {
+    body->AddNode(length());
+    body->AddBuffer(NULL, 0);
+    body->AddBuffer(offsets_.data(), offsets_.size() * sizeof(int32_t));
+    body->AddBuffer(data_.data(), data_.size());
+  }
+
+  void Clear() {
+    offsets_.resize(1);
+    data_.clear();
+  }
+
+ private:
+  std::vector<int32_t> offsets_;
+  string data_;
+};
+
+// A string column encoded as indices into a dictionary of the distinct
+// values, which lasts the whole stream.
+class DictionaryColumn : public Column {
+ public:
+  DictionaryColumn(const string& name, int64_t id)
+      : Column(name), id_(id), new_values_(string()) {}
+
+  int64_t id() const { return id_; }
+
+  void Append(const string& value) {
+    std::pair<std::unordered_map<string, int32_t>::iterator, bool> entry =
+        dictionary_.insert(
+            std::make_pair(value, static_cast<int32_t>(dictionary_.size())));
+    if (entry.second)
+      new_values_.Append(value);
+    indices_.push_back(entry.first->second);
+  }
+
+  std::unique_ptr<FlatNode> Field() const {
+    std::unique_ptr<FlatNode> field =
+        NewField(name(), kUtf8, NewTable(), std::unique_ptr<FlatNode>());
+    std::unique_ptr<FlatNode> encoding = NewTable();
+    encoding->AddScalar(0, 8, id_);
+    encoding->AddChild(1, IntType(32, true));
+    encoding->AddScalar(2, 1, false);  // isOrdered
+    field->AddChild(4, std::move(encoding));
+    return field;
+  }
+
+  void AddTo(BatchBody* body) const {
+    body->AddNode(indices_.size());
+    body->AddBuffer(NULL, 0);
+    body->AddBuffer(indices_.data(), indices_.size() * sizeof(int32_t));
+  }
+
+  void Clear() { indices_.clear(); }
+
+  // The dictionary entries added since the last ClearNewValues().
+  const StringColumn& new_values() const { return new_values_; }
+  void ClearNewValues() { new_values_.Clear(); }
+
+ private:
+  int64_t id_;
+  std::unordered_map<string, int32_t> dictionary_;
+  StringColumn new_values_;
+  std::vector<int32_t> indices_;
+};
+
+class StructColumn : public Column {
+ public:
+  explicit StructColumn(const string& name) : Column(name), length_(0) {}
+
+  // Adds |child| as the next of the struct's fields, and returns it.
+  template<typename C>
+  C* Add(C* child) {
+    children_.push_back(std::unique_ptr<Column>(child));
+    return child;
+  }
+
+  // Ends a row, once each child has had its value appended.
+  void EndRow() { ++length_; }
+
+  size_t length() const { return length_; }
+
+  std::unique_ptr<FlatNode> Field() const {
+    return NewField(name(), kStruct, NewTable(), ChildFields());
+  }
+
+  void AddTo(BatchBody* body) const {
+    body->AddNode(length_);
+    body->AddBuffer(NULL, 0);
+    AddChildrenTo(body);
+  }
+
+  // Returns the vector of the children's Fields.
+  std::unique_ptr<FlatNode> ChildFields() const {
+    std::unique_ptr<FlatNode> fields = NewTables();
+    for (size_t i = 0; i < children_.size(); ++i)
+      fields->elements.push_back(children_[i]->Field());
+    return fields;
+  }
+
+  // Adds the children's nodes and buffers to |body|, without the struct's
+  // own.
+  void AddChildrenTo(BatchBody* body) const {
+    for (size_t i = 0; i < children_.size(); ++i)
+      children_[i]->AddTo(body);
+  }
+
+  void Clear() {
+    for (size_t i = 0; i < children_.size(); ++i)
+      children_[i]->Clear();
+    length_ = 0;
+  }
+
+ private:
+  std::vector<std::unique_ptr<Column> > children_;
+  size_t length_;
+};
+
+// A column of lists of structs.
+class ListColumn : public Column {
+ public:
+  explicit ListColumn(const string& name)
+      : Column(name), item_("item"), offsets_(1, 0) {}
+
+  StructColumn* item() { return &item_; }
+
+  // Ends a row holding the items added since the last.
+  void EndRow() {
+    offsets_.push_back(static_cast<int32_t>(item_.length()));
+  }
+
+  std::unique_ptr<FlatNode> Field() const {
+    std::unique_ptr<FlatNode> children = NewTables();
+    children->elements.push_back(item_.Field());
+    return NewField(name(), kList, NewTable(), std::move(children));
+  }
+
+  void AddTo(BatchBody* body) const {
+    body->AddNode(offsets_.size() - 1);
+    body->AddBuffer(NULL, 0);
+    body->AddBuffer(offsets_.data(), offsets_.size() * sizeof(int32_t));
+    item_.AddTo(body);
+  }
+
+  void Clear() {
+    item_.Clear();
+    offsets_.resize(1);
+  }
+
+ private:
+  StructColumn item_;
+  std::vector<int32_t> offsets_;
+};
+
+// Returns a message with |header| of type |header_type|, and a body of
+// |body_length| bytes.
+std::unique_ptr<FlatNode> NewMessage(MessageHeader header_type,
+                                     std::unique_ptr<FlatNode> header,
+                                     size_t body_length) {
+  std::unique_ptr<FlatNode> message = NewTable();
+  message->AddScalar(0, 2, kMetadataVersionV5);
+  message->AddScalar(1, 1, header_type);
+  message->AddChild(2, std::move(header));
+  message->AddScalar(3, 8, body_length);
+  return message;
+}
+
+bool WriteMessage(FILE* out, const FlatNode& message, const string& body) {
+  string metadata = FlatBuffer(message);
+  string prefix;
+  AppendLittleEndian(&prefix, kContinuation, 4);
+  AppendLittleEndian(&prefix, metadata.size(), 4);
+  return fwrite(prefix.data(), 1, prefix.size(), out) == prefix.size() &&
+         fwrite(metadata.data(), 1, metadata.size(), out) ==
+             metadata.size() &&
+         (body.empty() ||
+          fwrite(body.data(), 1, body.size(), out) == body.size());
+}
+
+}  // namespace
+
+struct ProcessStateArrowWriter::Columns {
+  Columns() : rows(0), root(string()) {
+    path = root.Add(new StringColumn("path"));
+    status = AddDictionary(&root, "status");
+    time_date_stamp = root.Add(new IntColumn<uint32_t>("time_date_stamp"));
+    crashed = root.Add(new BoolColumn("crashed"));
+    crash_reason = AddDictionary(&root, "crash_reason");
+    crash_address = root.Add(new IntColumn<uint64_t>("crash_address"));
+    assertion = AddDictionary(&root, "assertion");
+    requesting_thread = root.Add(new IntColumn<int32_t>("requesting_thread"));
+    os = AddDictionary(&root, "os");
+    os_version = AddDictionary(&root, "os_version");
+    cpu = AddDictionary(&root, "cpu");
+    cpu_info = AddDictionary(&root, "cpu_info");
+    cpu_count = root.Add(new IntColumn<int32_t>("cpu_count"));
+
+    modules = root.Add(new ListColumn("modules"));
+    StructColumn* module = modules->item();
+    module_base_address = module->Add(new IntColumn<uint64_t>("base_address"));
+    module_size = module->Add(new IntColumn<uint64_t>("size"));
+    module_code_file = AddDictionary(module, "code_file");
+    module_code_identifier = AddDictionary(module, "code_identifier");
+    module_debug_file = AddDictionary(module, "debug_file");
+    module_debug_identifier = AddDictionary(module, "debug_identifier");
+    module_version = AddDictionary(module, "version");
+
+    threads = root.Add(new ListColumn("threads"));
+    StructColumn* thread = threads->item();
+    thread_id = thread->Add(new IntColumn<uint32_t>("thread_id"));
+    frames = thread->Add(new ListColumn("frames"));
+    StructColumn* frame = frames->item();
+    frame_instruction = frame->Add(new IntColumn<uint64_t>("instruction"));
+    frame_module = AddDictionary(frame, "module");
+    frame_function_name = AddDictionary(frame, "function_name");
+    frame_function_base = frame->Add(new IntColumn<uint64_t>("function_base"));
+    frame_source_file = AddDictionary(frame, "source_file");
+    frame_source_line = frame->Add(new IntColumn<int32_t>("source_line"));
+    frame_trust = AddDictionary(frame, "trust");
+  }
+
+  DictionaryColumn* AddDictionary(StructColumn* parent, const string& name) {
+    DictionaryColumn* column = parent->Add(
+        new DictionaryColumn(name, static_cast<int64_t>(dictionaries.size())));
+    dictionaries.push_back(column);
+    return column;
+  }
+
+  void AppendModule(const CodeModule& module) {
+    module_base_address->Append(module.base_address());
+    module_size->Append(module.size());
+    module_code_file->Append(module.code_file());
+    module_code_identifier->Append(module.code_identifier());
+    module_debug_file->Append(module.debug_file());
+    module_debug_identifier->Append(module.debug_identifier());
+    module_version->Append(module.version());
+    modules->item()->EndRow();
+  }
+
+  void AppendFrame(const StackFrame& frame) {
+    frame_instruction->Append(frame.instruction);
+    frame_module->Append(frame.module ? frame.module->code_file() : string());
+    frame_function_name->Append(frame.function_name);
+    frame_function_base->Append(frame.function_base);
+    frame_source_file->Append(frame.source_file_name);
+    frame_source_line->Append(frame.source_line);
+    frame_trust->Append(frame.trust_description());
+    frames->item()->EndRow();
+  }
+
+  size_t rows;
+  // The top-level columns are the fields of this struct, which itself
+  // isn't written.
+  StructColumn root;
+  std::vector<DictionaryColumn*> dictionaries;
+
+  StringColumn* path;
+  DictionaryColumn* status;
+  IntColumn<uint32_t>* time_date_stamp;
+  BoolColumn* crashed;
+  DictionaryColumn* crash_reason;
+  IntColumn<uint64_t>* crash_address;
+  DictionaryColumn* assertion;
+  IntColumn<int32_t>* requesting_thread;
+  DictionaryColumn* os;
+  DictionaryColumn* os_version;
+  DictionaryColumn* cpu;
+  DictionaryColumn* cpu_info;
+  IntColumn<int32_t>* cpu_count;
+
+  ListColumn* modules;
+  IntColumn<uint64_t>* module_base_address;
+  IntColumn<uint64_t>* module_size;
+  DictionaryColumn* module_code_file;
+  DictionaryColumn* module_code_identifier;
+  DictionaryColumn* module_debug_file;
+  DictionaryColumn* module_debug_identifier;
+  DictionaryColumn* module_version;
+
+  ListColumn* threads;
+  IntColumn<uint32_t>* thread_id;
+  ListColumn* frames;
+  IntColumn<uint64_t>* frame_instruction;
+  DictionaryColumn* frame_module;
+  DictionaryColumn* frame_function_name;
+  IntColumn<uint64_t>* frame_function_base;
+  DictionaryColumn* frame_source_file;
+  IntColumn<int32_t>* frame_source_line;
+  DictionaryColumn* frame_trust;
+};
+
+ProcessStateArrowWriter::ProcessStateArrowWriter(FILE* out, size_t batch_rows)
+    : out_(out),
+      batch_rows_(std::max<size_t>(batch_rows, 1)),
+      columns_(new Columns),
+      wrote_schema_(false),
+      wrote_dictionaries_(false) {}
+
+ProcessStateArrowWriter::~ProcessStateArrowWriter() {}
+
+bool ProcessStateArrowWriter::Write(const string& minidump_path,
+                                    const string& status,
+                                    const ProcessState* process_state) {
+  Columns* c = columns_.get();
+  c->path->Append(minidump_path);
+  c->status->Append(status);
+  if (process_state) {
+    const SystemInfo* system_info = process_state->system_info();
+    c->time_date_stamp->Append(process_state->time_date_stamp());
+    c->crashed->Append(process_state->crashed());
+    c->crash_reason->Append(process_state->crash_reason());
+    c->crash_address->Append(process_state->crash_address());
+    c->assertion->Append(process_state->assertion());
+    c->requesting_thread->Append(process_state->requesting_thread());
+    c->os->Append(system_info->os);
+    c->os_version->Append(system_info->os_version);
+    c->cpu->Append(system_info->cpu);
+    c->cpu_info->Append(system_info->cpu_info);
+    c->cpu_count->Append(system_info->cpu_count);
+
+    const CodeModules* modules = process_state->modules();
+    if (modules) {
+      for (unsigned int i = 0; i < modules->module_count(); ++i)
+        c->AppendModule(*modules->GetModuleAtSequence(i));
+    }
+
+    const std::vector<CallStack*>* threads = process_state->threads();
+    for (size_t i = 0; i < threads->size(); ++i) {
+      const CallStack* stack = threads->at(i);
+      c->thread_id->Append(stack->tid());
+      const std::vector<StackFrame*>* frames = stack->frames();
+      for (size_t j = 0; j < frames->size(); ++j)
+        c->AppendFrame(*frames->at(j));
+      c->frames->EndRow();
+      c->threads->item()->EndRow();
+    }
+  } else {
+    c->time_date_stamp->Append(0);
+    c->crashed->Append(false);
+    c->crash_reason->Append(string());
+    c->crash_address->Append(0);
+    c->assertion->Append(string());
+    c->requesting_thread->Append(-1);
+    c->os->Append(string());
+    c->os_version->Append(string());
+    c->cpu->Append(string());
+    c->cpu_info->Append(string());
+    c->cpu_count->Append(0);
+  }
+  c->modules->EndRow();
+  c->threads->EndRow();
+  c->root.EndRow();
+
+  if (++c->rows < batch_rows_)
+    return true;
+  return WriteBatch();
+}
+
+bool ProcessStateArrowWriter::Finish() {
+  string end;
+  AppendLittleEndian(&end, kContinuation, 4);
+  AppendLittleEndian(&end, 0, 4);
+  return WriteBatch() &&
+         fwrite(end.data(), 1, end.size(), out_) == end.size() &&
+         fflush(out_) == 0;
+}
+
+bool ProcessStateArrowWriter::WriteBatch() {
+  Columns* c = columns_.get();
+  bool ok = true;
+  if (!wrote_schema_) {
+    std::unique_ptr<FlatNode> schema = NewTable();
+    schema->AddScalar(0, 2, HostIsBigEndian() ? 1 : 0);
+    schema->AddChild(1, c->root.ChildFields());
+    ok = WriteMessage(out_, *NewMessage(kSchema, std::move(schema), 0),
+                      string());
+    wrote_schema_ = true;
+  }
+  if (c->rows == 0)
+    return ok;
+
+  // Each dictionary is sent whole before the first batch, and then only
+  // the entries that later batches added to it.
+  for (size_t i = 0; i < c->dictionaries.size(); ++i) {
+    DictionaryColumn* dictionary = c->dictionaries[i];
+    size_t new_values = dictionary->new_values().length();
+    if (wrote_dictionaries_ && new_values == 0)
+      continue;
+    BatchBody body;
+    dictionary->new_values().AddTo(&body);
+    std::unique_ptr<FlatNode> batch = NewTable();
+    batch->AddScalar(0, 8, dictionary->id());
+    batch->AddChild(1, body.RecordBatch(new_values));
+    batch->AddScalar(2, 1, wrote_dictionaries_);  // isDelta
+    ok = WriteMessage(out_, *NewMessage(kDictionaryBatch, std::move(batch),
+                                        body.body().size()),
+                      body.body()) && ok;
+    dictionary->ClearNewValues();
+  }
+  wrote_dictionaries_ = true;
+
+  BatchBody body;
+  c->root.AddChildrenTo(&body);
+  ok = WriteMessage(out_, *NewMessage(kRecordBatch, body.RecordBatch(c->rows),
+                                      body.body().size()),
+                    body.body()) && ok;
+  c->root.Clear();
+  c->rows = 0;
+  return ok;
+}
+
+}  // namespace google_breakpad
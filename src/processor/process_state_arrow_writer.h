@@ -0,0 +1,103 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_arrow_writer.h: Writes the ProcessStates of many minidumps
+// as an Apache Arrow IPC stream, for loading into analytics systems.
+//
+// Each minidump is one row.  Its modules, and its threads with their
+// frames, are list columns of structs nested in the row, so that one
+// stream holds the whole of each result without a join.  Strings that
+// repeat from one minidump to the next, such as module and function names,
+// are dictionary-encoded; each new batch of rows carries only the
+// dictionary entries that are new since the last.
+//
+// Like process_state_proto_writer.h, the format is written directly,
+// without depending on the Arrow library.  The stream can be read by any
+// Arrow implementation, for example with pyarrow.ipc.open_stream.
+
+#ifndef PROCESSOR_PROCESS_STATE_ARROW_WRITER_H__
+#define PROCESSOR_PROCESS_STATE_ARROW_WRITER_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class ProcessState;
+
+class ProcessStateArrowWriter {
+ public:
+  // The number of rows written in each record batch by default.
+  static const size_t kDefaultBatchRows = 1024;
+
+  // Writes the stream to |out|, which the caller keeps ownership of, in
+  // record batches of |batch_rows| rows.
+  explicit ProcessStateArrowWriter(FILE* out,
+                                   size_t batch_rows = kDefaultBatchRows);
+  ~ProcessStateArrowWriter();
+
+  // Adds a row for the minidump at |minidump_path|, with |status| as
+  // minidump_stackwalk -b would report it.  |process_state| is what it was
+  // processed into, or NULL if it couldn't be processed, leaving the row's
+  // other columns empty.  Returns false if a full batch couldn't be
+  // written.
+  bool Write(const string& minidump_path,
+             const string& status,
+             const ProcessState* process_state);
+
+  // Writes any rows not yet written and ends the stream.  Returns false if
+  // they couldn't be written.
+  bool Finish();
+
+ private:
+  struct Columns;
+
+  // Writes the rows added since the last batch, preceded by the schema if
+  // nothing has been written yet and by the new dictionary entries.
+  bool WriteBatch();
+
+  FILE* out_;
+  size_t batch_rows_;
+  std::unique_ptr<Columns> columns_;
+  bool wrote_schema_;
+  bool wrote_dictionaries_;
+
+  // Disallow copy constructor and assignment operator.
+  ProcessStateArrowWriter(const ProcessStateArrowWriter&);
+  void operator=(const ProcessStateArrowWriter&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PROCESS_STATE_ARROW_WRITER_H__
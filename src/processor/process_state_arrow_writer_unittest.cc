@@ -0,0 +1,351 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_arrow_writer_unittest.cc: Unit tests for
+// ProcessStateArrowWriter.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "processor/process_state_arrow_writer.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ProcessState;
+using google_breakpad::ProcessStateArrowWriter;
+using google_breakpad::SimpleSymbolSupplier;
+
+uint64_t ReadLittleEndian(const string& data, size_t position, int size) {
+  uint64_t value = 0;
+  for (int i = 0; i < size; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[position + i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+// A table in a flatbuffer, read just far enough to check what was written.
+struct FlatTable {
+  FlatTable(const string* data, size_t position)
+      : data(data), position(position) {}
+
+  // Returns the position of field |id|, or 0 if it's absent.
+  size_t Field(int id) const {
+    size_t vtable = position - static_cast<int32_t>(
+        ReadLittleEndian(*data, position, 4));
+    size_t vtable_size = ReadLittleEndian(*data, vtable, 2);
+    if (4 + 2 * static_cast<size_t>(id) >= vtable_size)
+      return 0;
+    size_t offset = ReadLittleEndian(*data, vtable + 4 + 2 * id, 2);
+    return offset ? position + offset : 0;
+  }
+
+  uint64_t Scalar(int id, int size) const {
+    size_t field = Field(id);
+    return field ? ReadLittleEndian(*data, field, size) : 0;
+  }
+
+  size_t Target(int id) const {
+    size_t field = Field(id);
+    EXPECT_NE(0U, field) << id;
+    return field + ReadLittleEndian(*data, field, 4);
+  }
+
+  FlatTable Table(int id) const { return FlatTable(data, Target(id)); }
+
+  string String(int id) const {
+    size_t string = Target(id);
+    return data->substr(string + 4, ReadLittleEndian(*data, string, 4));
+  }
+
+  size_t VectorLength(int id) const {
+    return ReadLittleEndian(*data, Target(id), 4);
+  }
+
+  FlatTable VectorTable(int id, size_t index) const {
+    size_t slot = Target(id) + 4 + 4 * index;
+    return FlatTable(data, slot + ReadLittleEndian(*data, slot, 4));
+  }
+
+  // Returns the |field|th 64-bit field of the |index|th struct of
+  // |size| bytes in vector |id|.
+  uint64_t VectorStruct(int id, size_t index, size_t size, int field) const {
+    size_t vector = Target(id);
+    EXPECT_EQ(0U, (vector + 4) % 8);
+    return ReadLittleEndian(*data, vector + 4 + index * size + 8 * field, 8);
+  }
+
+  const string* data;
+  size_t position;
+};
+
+// An encapsulated message of the stream.
+struct Message {
+  string metadata;
+  string body;
+
+  int header_type() const { return Root().Scalar(1, 1); }
+  FlatTable Header() const { return Root().Table(2); }
+  FlatTable Root() const {
+    return FlatTable(&metadata, ReadLittleEndian(metadata, 0, 4));
+  }
+};
+
+// Splits |stream| into its messages, checking the framing.  Returns false
+// if the end-of-stream marker isn't found at the end.
+bool ReadMessages(const string& stream, std::vector<Message>* messages) {
+  size_t position = 0;
+  while (position + 8 <= stream.size()) {
+    EXPECT_EQ(0xffffffffU, ReadLittleEndian(stream, position, 4));
+    size_t metadata_size = ReadLittleEndian(stream, position + 4, 4);
+    position += 8;
+    if (metadata_size == 0)
+      return position == stream.size();
+    EXPECT_EQ(0U, metadata_size % 8);
+    Message message;
+    message.metadata = stream.substr(position, metadata_size);
+    position += metadata_size;
+    size_t body_size = message.Root().Scalar(3, 8);
+    EXPECT_EQ(0U, body_size % 8);
+    message.body = stream.substr(position, body_size);
+    position += body_size;
+    messages->push_back(message);
+  }
+  return false;
+}
+
+// Returns the strings of a Utf8 array whose offsets and data are in buffers
+// |buffer| and |buffer| + 1 of |batch|.
+std::vector<string> Strings(const Message& message, const FlatTable& batch,
+                            size_t buffer, size_t length) {
+  size_t offsets = batch.VectorStruct(2, buffer, 16, 0);
+  size_t data = batch.VectorStruct(2, buffer + 1, 16, 0);
+  std::vector<string> strings;
+  for (size_t i = 0; i < length; ++i) {
+    int32_t begin, end;
+    memcpy(&begin, &message.body[offsets + 4 * i], 4);
+    memcpy(&end, &message.body[offsets + 4 * i + 4], 4);
+    strings.push_back(message.body.substr(data + begin, end - begin));
+  }
+  return strings;
+}
+
+std::vector<int32_t> Int32s(const Message& message, const FlatTable& batch,
+                            size_t buffer, size_t length) {
+  std::vector<int32_t> values(length);
+  size_t data = batch.VectorStruct(2, buffer, 16, 0);
+  if (length > 0)
+    memcpy(&values[0], &message.body[data], 4 * length);
+  return values;
+}
+
+class ProcessStateArrowWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    char* srcdir = getenv("srcdir");
+    string testdata = string(srcdir ? srcdir : ".") + "/src/processor/testdata";
+    SimpleSymbolSupplier supplier(testdata + "/symbols");
+    BasicSourceLineResolver resolver;
+    MinidumpProcessor processor(&supplier, &resolver);
+    ASSERT_EQ(google_breakpad::PROCESS_OK,
+              processor.Process(testdata + "/minidump2.dmp", &state_));
+    file_ = tmpfile();
+    ASSERT_TRUE(file_ != NULL);
+  }
+
+  void TearDown() {
+    if (file_)
+      fclose(file_);
+  }
+
+  string Contents() {
+    long size = ftell(file_);
+    string contents(size, '\0');
+    rewind(file_);
+    EXPECT_EQ(contents.size(), fread(&contents[0], 1, contents.size(), file_));
+    return contents;
+  }
+
+  ProcessState state_;
+  FILE* file_;
+};
+
+TEST_F(ProcessStateArrowWriterTest, Schema) {
+  ProcessStateArrowWriter writer(file_);
+  ASSERT_TRUE(writer.Finish());
+  std::vector<Message> messages;
+  ASSERT_TRUE(ReadMessages(Contents(), &messages));
+
+  // With no rows, there is only the schema.
+  ASSERT_EQ(1U, messages.size());
+  EXPECT_EQ(4U, messages[0].Root().Scalar(0, 2));  // V5
+  ASSERT_EQ(1, messages[0].header_type());
+  FlatTable schema = messages[0].Header();
+  const char* kFields[] = {
+    "path", "status", "time_date_stamp", "crashed", "crash_reason",
+    "crash_address", "assertion", "requesting_thread", "os", "os_version",
+    "cpu", "cpu_info", "cpu_count", "modules", "threads"
+  };
+  const size_t kFieldCount = sizeof(kFields) / sizeof(kFields[0]);
+  ASSERT_EQ(kFieldCount, schema.VectorLength(1));
+  for (size_t i = 0; i < kFieldCount; ++i)
+    EXPECT_EQ(kFields[i], schema.VectorTable(1, i).String(0));
+
+  // path is plain Utf8, and status is dictionary-encoded with 32-bit
+  // indices.
+  FlatTable path = schema.VectorTable(1, 0);
+  EXPECT_EQ(5U, path.Scalar(2, 1));
+  EXPECT_EQ(0U, path.Field(4));
+  FlatTable status = schema.VectorTable(1, 1);
+  EXPECT_EQ(5U, status.Scalar(2, 1));
+  FlatTable encoding = status.Table(4);
+  EXPECT_EQ(0U, encoding.Scalar(0, 8));
+  EXPECT_EQ(32U, encoding.Table(1).Scalar(0, 4));
+  EXPECT_EQ(1U, encoding.Table(1).Scalar(1, 1));
+
+  // threads is a list of structs holding a list of frame structs.
+  FlatTable threads = schema.VectorTable(1, 14);
+  EXPECT_EQ(12U, threads.Scalar(2, 1));
+  ASSERT_EQ(1U, threads.VectorLength(5));
+  FlatTable thread = threads.VectorTable(5, 0);
+  EXPECT_EQ(13U, thread.Scalar(2, 1));
+  ASSERT_EQ(2U, thread.VectorLength(5));
+  EXPECT_EQ("thread_id", thread.VectorTable(5, 0).String(0));
+  FlatTable frames = thread.VectorTable(5, 1);
+  EXPECT_EQ("frames", frames.String(0));
+  EXPECT_EQ(12U, frames.Scalar(2, 1));
+}
+
+TEST_F(ProcessStateArrowWriterTest, Rows) {
+  ProcessStateArrowWriter writer(file_);
+  ASSERT_TRUE(writer.Write("a.dmp", "OK", &state_));
+  ASSERT_TRUE(writer.Write("b.dmp", "ERROR_READ", NULL));
+  ASSERT_TRUE(writer.Write("c.dmp", "OK", &state_));
+  ASSERT_TRUE(writer.Finish());
+  std::vector<Message> messages;
+  ASSERT_TRUE(ReadMessages(Contents(), &messages));
+
+  // The schema, each dictionary, then the batch.
+  ASSERT_GT(messages.size(), 3U);
+  EXPECT_EQ(1, messages[0].header_type());
+  for (size_t i = 1; i + 1 < messages.size(); ++i) {
+    EXPECT_EQ(2, messages[i].header_type());
+    EXPECT_EQ(static_cast<uint64_t>(i - 1),
+              messages[i].Header().Scalar(0, 8));
+    EXPECT_EQ(0U, messages[i].Header().Scalar(2, 1));  // not a delta
+  }
+  const Message& batch_message = messages.back();
+  ASSERT_EQ(3, batch_message.header_type());
+  FlatTable batch = batch_message.Header();
+  EXPECT_EQ(3U, batch.Scalar(0, 8));
+
+  // path's node, then its validity, offsets and data buffers.
+  EXPECT_EQ(3U, batch.VectorStruct(1, 0, 16, 0));
+  EXPECT_EQ(0U, batch.VectorStruct(1, 0, 16, 1));
+  std::vector<string> paths = Strings(batch_message, batch, 1, 3);
+  ASSERT_EQ(3U, paths.size());
+  EXPECT_EQ("a.dmp", paths[0]);
+  EXPECT_EQ("b.dmp", paths[1]);
+  EXPECT_EQ("c.dmp", paths[2]);
+
+  // status's indices follow, into dictionary 0.
+  std::vector<int32_t> statuses = Int32s(batch_message, batch, 4, 3);
+  FlatTable dictionary = messages[1].Header().Table(1);
+  ASSERT_EQ(2U, dictionary.Scalar(0, 8));
+  std::vector<string> values = Strings(messages[1], dictionary, 1, 2);
+  EXPECT_EQ("OK", values[statuses[0]]);
+  EXPECT_EQ("ERROR_READ", values[statuses[1]]);
+  EXPECT_EQ("OK", values[statuses[2]]);
+
+  // Each buffer lies within the body.
+  size_t buffer_count = batch.VectorLength(2);
+  for (size_t i = 0; i < buffer_count; ++i) {
+    uint64_t offset = batch.VectorStruct(2, i, 16, 0);
+    uint64_t length = batch.VectorStruct(2, i, 16, 1);
+    EXPECT_EQ(0U, offset % 8);
+    EXPECT_LE(offset + length, batch_message.body.size());
+  }
+}
+
+TEST_F(ProcessStateArrowWriterTest, DeltaDictionaries) {
+  ProcessStateArrowWriter writer(file_, 1);
+  ASSERT_TRUE(writer.Write("a.dmp", "OK", &state_));
+  ASSERT_TRUE(writer.Write("b.dmp", "OK", &state_));
+  ASSERT_TRUE(writer.Write("c.dmp", "ERROR_READ", NULL));
+  ASSERT_TRUE(writer.Finish());
+  std::vector<Message> messages;
+  ASSERT_TRUE(ReadMessages(Contents(), &messages));
+
+  // The second minidump repeats the first, so its batch needs no new
+  // dictionary entries.  The third adds one status, and an empty string
+  // to some other dictionaries, as deltas.
+  ASSERT_GT(messages.size(), 4U);
+  EXPECT_EQ(3, messages[messages.size() - 1].header_type());
+  size_t i = messages.size() - 2;
+  bool status_delta = false;
+  while (messages[i].header_type() == 2) {
+    EXPECT_EQ(1U, messages[i].Header().Scalar(2, 1));
+    if (messages[i].Header().Scalar(0, 8) == 0) {
+      status_delta = true;
+      FlatTable dictionary = messages[i].Header().Table(1);
+      ASSERT_EQ(1U, dictionary.Scalar(0, 8));
+      EXPECT_EQ("ERROR_READ", Strings(messages[i], dictionary, 1, 1)[0]);
+    }
+    --i;
+  }
+  EXPECT_TRUE(status_delta);
+  EXPECT_EQ(3, messages[i].header_type());
+  EXPECT_EQ(3, messages[i - 1].header_type());
+  EXPECT_EQ(2, messages[i - 2].header_type());
+
+  // The batches' status indices continue into the deltas.
+  std::vector<int32_t> status =
+      Int32s(messages.back(), messages.back().Header(), 4, 1);
+  EXPECT_EQ(1, status[0]);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,226 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_proto_writer.cc: Serializes a ProcessState as a
+// ProcessStateProto.
+//
+// See process_state_proto_writer.h for documentation.
+
+#include "processor/process_state_proto_writer.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Field numbers, from proto/process_state.proto.
+enum ProcessStateProtoField {
+  kTimeDateStamp = 1,
+  kCrash = 2,
+  kAssertion = 3,
+  kRequestingThread = 4,
+  kThreads = 5,
+  kModules = 6,
+  kOS = 7,
+  kOSShort = 8,
+  kOSVersion = 9,
+  kCPU = 10,
+  kCPUInfo = 11,
+  kCPUCount = 12,
+  kProcessCreateTime = 13
+};
+
+enum CrashField {
+  kCrashReason = 1,
+  kCrashAddress = 2
+};
+
+enum ThreadField {
+  kThreadFrames = 1
+};
+
+enum StackFrameField {
+  kFrameInstruction = 1,
+  kFrameModule = 2,
+  kFrameFunctionName = 3,
+  kFrameFunctionBase = 4,
+  kFrameSourceFileName = 5,
+  kFrameSourceLine = 6,
+  kFrameSourceLineBase = 7
+};
+
+enum CodeModuleField {
+  kModuleBaseAddress = 1,
+  kModuleSize = 2,
+  kModuleCodeFile = 3,
+  kModuleCodeIdentifier = 4,
+  kModuleDebugFile = 5,
+  kModuleDebugIdentifier = 6,
+  kModuleVersion = 7
+};
+
+// Wire types.
+const int kVarint = 0;
+const int kLengthDelimited = 2;
+
+void AppendVarint(uint64_t value, string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+void AppendTag(int field, int wire_type, string* output) {
+  AppendVarint((static_cast<uint64_t>(field) << 3) | wire_type, output);
+}
+
+// int32 and int64 fields are both encoded as 64-bit varints, with negative
+// int32 values sign-extended.
+void AppendIntField(int field, int64_t value, string* output) {
+  AppendTag(field, kVarint, output);
+  AppendVarint(static_cast<uint64_t>(value), output);
+}
+
+void AppendBytesField(int field, const string& value, string* output) {
+  AppendTag(field, kLengthDelimited, output);
+  AppendVarint(value.size(), output);
+  output->append(value);
+}
+
+// Appends an optional string field, leaving it out if it's empty.
+void AppendStringField(int field, const string& value, string* output) {
+  if (!value.empty())
+    AppendBytesField(field, value, output);
+}
+
+void SerializeCodeModule(const CodeModule& module, string* output) {
+  AppendIntField(kModuleBaseAddress, module.base_address(), output);
+  AppendIntField(kModuleSize, module.size(), output);
+  AppendStringField(kModuleCodeFile, module.code_file(), output);
+  AppendStringField(kModuleCodeIdentifier, module.code_identifier(), output);
+  AppendStringField(kModuleDebugFile, module.debug_file(), output);
+  AppendStringField(kModuleDebugIdentifier, module.debug_identifier(),
+                    output);
+  AppendStringField(kModuleVersion, module.version(), output);
+}
+
+void SerializeStackFrame(const StackFrame& frame, string* output) {
+  AppendIntField(kFrameInstruction, frame.instruction, output);
+  if (frame.module) {
+    string module;
+    SerializeCodeModule(*frame.module, &module);
+    AppendBytesField(kFrameModule, module, output);
+  }
+  if (!frame.function_name.empty()) {
+    AppendStringField(kFrameFunctionName, frame.function_name, output);
+    AppendIntField(kFrameFunctionBase, frame.function_base, output);
+  }
+  if (!frame.source_file_name.empty()) {
+    AppendStringField(kFrameSourceFileName, frame.source_file_name, output);
+    AppendIntField(kFrameSourceLine, frame.source_line, output);
+    AppendIntField(kFrameSourceLineBase, frame.source_line_base, output);
+  }
+}
+
+}  // namespace
+
+void SerializeProcessStateProto(const ProcessState& process_state,
+                                string* output) {
+  AppendIntField(kTimeDateStamp, process_state.time_date_stamp(), output);
+  AppendIntField(kProcessCreateTime, process_state.process_create_time(),
+                 output);
+
+  if (process_state.crashed()) {
+    string crash;
+    AppendBytesField(kCrashReason, process_state.crash_reason(), &crash);
+    AppendIntField(kCrashAddress, process_state.crash_address(), &crash);
+    AppendBytesField(kCrash, crash, output);
+  }
+  AppendStringField(kAssertion, process_state.assertion(), output);
+  AppendIntField(kRequestingThread, process_state.requesting_thread(), output);
+
+  const std::vector<CallStack*>* threads = process_state.threads();
+  string thread, frame;
+  for (size_t thread_index = 0; thread_index < threads->size();
+       ++thread_index) {
+    thread.clear();
+    const std::vector<StackFrame*>* frames =
+        threads->at(thread_index)->frames();
+    for (size_t frame_index = 0; frame_index < frames->size();
+         ++frame_index) {
+      frame.clear();
+      SerializeStackFrame(*frames->at(frame_index), &frame);
+      AppendBytesField(kThreadFrames, frame, &thread);
+    }
+    AppendBytesField(kThreads, thread, output);
+  }
+
+  const CodeModules* modules = process_state.modules();
+  if (modules) {
+    string module;
+    unsigned int module_count = modules->module_count();
+    for (unsigned int module_sequence = 0; module_sequence < module_count;
+         ++module_sequence) {
+      module.clear();
+      SerializeCodeModule(*modules->GetModuleAtSequence(module_sequence),
+                          &module);
+      AppendBytesField(kModules, module, output);
+    }
+  }
+
+  const SystemInfo* system_info = process_state.system_info();
+  AppendStringField(kOS, system_info->os, output);
+  AppendStringField(kOSShort, system_info->os_short, output);
+  AppendStringField(kOSVersion, system_info->os_version, output);
+  AppendStringField(kCPU, system_info->cpu, output);
+  AppendStringField(kCPUInfo, system_info->cpu_info, output);
+  AppendIntField(kCPUCount, system_info->cpu_count, output);
+}
+
+bool WriteDelimitedProcessStateProto(const ProcessState& process_state,
+                                     FILE* out) {
+  string message;
+  SerializeProcessStateProto(process_state, &message);
+  string record;
+  AppendVarint(message.size(), &record);
+  record.append(message);
+  return fwrite(record.data(), 1, record.size(), out) == record.size();
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,65 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_proto_writer.h: Serializes a ProcessState as a
+// ProcessStateProto, defined in proto/process_state.proto.
+//
+// The encoding is written directly in the protobuf wire format, so that
+// a processed minidump can be handed to protobuf consumers without the
+// processor itself depending on the protobuf library.  A message written
+// here parses as a ProcessStateProto with any protobuf implementation.
+
+#ifndef PROCESSOR_PROCESS_STATE_PROTO_WRITER_H__
+#define PROCESSOR_PROCESS_STATE_PROTO_WRITER_H__
+
+#include <stdio.h>
+
+#include <string>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class ProcessState;
+
+// Appends the ProcessStateProto encoding of process_state to output.
+void SerializeProcessStateProto(const ProcessState& process_state,
+                                string* output);
+
+// Writes process_state to out as a length-delimited ProcessStateProto: the
+// message's size as a varint, followed by the message, which is the framing
+// used by protobuf's writeDelimitedTo and parseDelimitedFrom, so that
+// the records of any number of minidumps can be written to one stream and
+// read back in turn.  Returns false if the record couldn't be written.
+bool WriteDelimitedProcessStateProto(const ProcessState& process_state,
+                                     FILE* out);
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PROCESS_STATE_PROTO_WRITER_H__
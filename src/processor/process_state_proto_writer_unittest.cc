@@ -0,0 +1,263 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// process_state_proto_writer_unittest.cc: Unit tests for
+// SerializeProcessStateProto and WriteDelimitedProcessStateProto.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/call_stack.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/code_modules.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/process_state_proto_writer.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CodeModule;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ProcessState;
+using google_breakpad::SerializeProcessStateProto;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::StackFrame;
+using google_breakpad::WriteDelimitedProcessStateProto;
+
+// The fields of one protobuf message, decoded from the wire format: the
+// values of the varint fields, and the contents of the length-delimited
+// ones, by field number, in order.
+struct Message {
+  std::multimap<int, uint64_t> varints;
+  std::multimap<int, string> bytes;
+
+  uint64_t Varint(int field) const {
+    EXPECT_EQ(1U, varints.count(field)) << field;
+    std::multimap<int, uint64_t>::const_iterator value = varints.find(field);
+    return value == varints.end() ? 0 : value->second;
+  }
+
+  string Bytes(int field) const {
+    EXPECT_EQ(1U, bytes.count(field)) << field;
+    std::multimap<int, string>::const_iterator value = bytes.find(field);
+    return value == bytes.end() ? string() : value->second;
+  }
+
+  std::vector<string> Repeated(int field) const {
+    std::vector<string> values;
+    for (std::multimap<int, string>::const_iterator value =
+             bytes.lower_bound(field);
+         value != bytes.upper_bound(field); ++value) {
+      values.push_back(value->second);
+    }
+    return values;
+  }
+};
+
+bool ReadVarint(const string& data, size_t* position, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && *position < data.size(); shift += 7) {
+    uint8_t byte = data[(*position)++];
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+bool Decode(const string& data, Message* message) {
+  size_t position = 0;
+  while (position < data.size()) {
+    uint64_t tag, value;
+    if (!ReadVarint(data, &position, &tag) ||
+        !ReadVarint(data, &position, &value)) {
+      return false;
+    }
+    int field = static_cast<int>(tag >> 3);
+    switch (tag & 7) {
+      case 0:
+        message->varints.insert(std::make_pair(field, value));
+        break;
+      case 2:
+        if (value > data.size() - position)
+          return false;
+        message->bytes.insert(
+            std::make_pair(field, data.substr(position, value)));
+        position += value;
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+void ExpectModule(const CodeModule& expected, const string& encoded) {
+  Message module;
+  ASSERT_TRUE(Decode(encoded, &module));
+  EXPECT_EQ(expected.base_address(), module.Varint(1));
+  EXPECT_EQ(expected.size(), module.Varint(2));
+  EXPECT_EQ(expected.code_file(), module.Bytes(3));
+  EXPECT_EQ(expected.code_identifier(), module.Bytes(4));
+  EXPECT_EQ(expected.debug_file(), module.Bytes(5));
+  EXPECT_EQ(expected.debug_identifier(), module.Bytes(6));
+}
+
+class ProcessStateProtoWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    char* srcdir = getenv("srcdir");
+    string testdata = string(srcdir ? srcdir : ".") + "/src/processor/testdata";
+    SimpleSymbolSupplier supplier(testdata + "/symbols");
+    BasicSourceLineResolver resolver;
+    MinidumpProcessor processor(&supplier, &resolver);
+    ASSERT_EQ(google_breakpad::PROCESS_OK,
+              processor.Process(testdata + "/minidump2.dmp", &state_));
+  }
+
+  ProcessState state_;
+};
+
+TEST_F(ProcessStateProtoWriterTest, Serialize) {
+  string encoded;
+  SerializeProcessStateProto(state_, &encoded);
+  Message message;
+  ASSERT_TRUE(Decode(encoded, &message));
+
+  EXPECT_EQ(state_.time_date_stamp(), message.Varint(1));
+  EXPECT_EQ(state_.process_create_time(), message.Varint(13));
+  EXPECT_EQ(static_cast<uint64_t>(state_.requesting_thread()),
+            message.Varint(4));
+  EXPECT_EQ(state_.system_info()->os, message.Bytes(7));
+  EXPECT_EQ(state_.system_info()->os_short, message.Bytes(8));
+  EXPECT_EQ(state_.system_info()->os_version, message.Bytes(9));
+  EXPECT_EQ(state_.system_info()->cpu, message.Bytes(10));
+  EXPECT_EQ(state_.system_info()->cpu_info, message.Bytes(11));
+  EXPECT_EQ(static_cast<uint64_t>(state_.system_info()->cpu_count),
+            message.Varint(12));
+  EXPECT_EQ(0U, message.bytes.count(3));
+
+  ASSERT_TRUE(state_.crashed());
+  Message crash;
+  ASSERT_TRUE(Decode(message.Bytes(2), &crash));
+  EXPECT_EQ(state_.crash_reason(), crash.Bytes(1));
+  EXPECT_EQ(state_.crash_address(), crash.Varint(2));
+
+  std::vector<string> modules = message.Repeated(6);
+  ASSERT_EQ(state_.modules()->module_count(), modules.size());
+  for (size_t i = 0; i < modules.size(); ++i)
+    ExpectModule(*state_.modules()->GetModuleAtSequence(i), modules[i]);
+
+  std::vector<string> threads = message.Repeated(5);
+  ASSERT_EQ(state_.threads()->size(), threads.size());
+  for (size_t thread_index = 0; thread_index < threads.size();
+       ++thread_index) {
+    Message thread;
+    ASSERT_TRUE(Decode(threads[thread_index], &thread));
+    const std::vector<StackFrame*>* expected_frames =
+        state_.threads()->at(thread_index)->frames();
+    std::vector<string> frames = thread.Repeated(1);
+    ASSERT_EQ(expected_frames->size(), frames.size());
+    for (size_t frame_index = 0; frame_index < frames.size();
+         ++frame_index) {
+      const StackFrame* expected = expected_frames->at(frame_index);
+      Message frame;
+      ASSERT_TRUE(Decode(frames[frame_index], &frame));
+      EXPECT_EQ(expected->instruction, frame.Varint(1));
+      if (expected->module)
+        ExpectModule(*expected->module, frame.Bytes(2));
+      else
+        EXPECT_EQ(0U, frame.bytes.count(2));
+      if (expected->function_name.empty()) {
+        EXPECT_EQ(0U, frame.bytes.count(3));
+      } else {
+        EXPECT_EQ(expected->function_name, frame.Bytes(3));
+        EXPECT_EQ(expected->function_base, frame.Varint(4));
+      }
+      if (expected->source_file_name.empty()) {
+        EXPECT_EQ(0U, frame.bytes.count(5));
+      } else {
+        EXPECT_EQ(expected->source_file_name, frame.Bytes(5));
+        EXPECT_EQ(static_cast<uint64_t>(expected->source_line),
+                  frame.Varint(6));
+        EXPECT_EQ(expected->source_line_base, frame.Varint(7));
+      }
+    }
+  }
+
+  // The symbols were found, so the crashing frame is symbolized.
+  Message thread, frame;
+  ASSERT_TRUE(Decode(threads[state_.requesting_thread()], &thread));
+  ASSERT_TRUE(Decode(thread.Repeated(1)[0], &frame));
+  EXPECT_EQ("`anonymous namespace'::CrashFunction", frame.Bytes(3));
+}
+
+TEST_F(ProcessStateProtoWriterTest, Delimited) {
+  string message;
+  SerializeProcessStateProto(state_, &message);
+
+  FILE* file = tmpfile();
+  ASSERT_TRUE(file != NULL);
+  ASSERT_TRUE(WriteDelimitedProcessStateProto(state_, file));
+  ASSERT_TRUE(WriteDelimitedProcessStateProto(state_, file));
+  long size = ftell(file);
+  ASSERT_GT(size, 0);
+  string records(size, '\0');
+  rewind(file);
+  ASSERT_EQ(records.size(), fread(&records[0], 1, records.size(), file));
+  fclose(file);
+
+  size_t position = 0;
+  for (int i = 0; i < 2; ++i) {
+    uint64_t length;
+    ASSERT_TRUE(ReadVarint(records, &position, &length));
+    ASSERT_EQ(message.size(), length);
+    EXPECT_EQ(message, records.substr(position, length));
+    position += length;
+  }
+  EXPECT_EQ(records.size(), position);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
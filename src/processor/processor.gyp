@@ -38,12 +38,18 @@
       'sources': [
         'address_map-inl.h',
         'address_map.h',
+        'address_range_table-inl.h',
+        'address_range_table.h',
         'basic_code_module.h',
         'basic_code_modules.cc',
         'basic_code_modules.h',
         'basic_source_line_resolver.cc',
         'basic_source_line_resolver_types.h',
+        'caching_symbol_supplier.cc',
+        'caching_symbol_supplier.h',
         'call_stack.cc',
+        'call_stack_cache.cc',
+        'call_stack_cache.h',
         'cfi_frame_info-inl.h',
         'cfi_frame_info.cc',
         'cfi_frame_info.h',
@@ -62,6 +68,12 @@
         'exploitability_win.h',
         'fast_source_line_resolver.cc',
         'fast_source_line_resolver_types.h',
+        'flat_contained_range_map-inl.h',
+        'flat_contained_range_map.h',
+        'frame_arena.cc',
+        'frame_arena.h',
+        'frame_symbol_cache.cc',
+        'frame_symbol_cache.h',
         'linked_ptr.h',
         'logging.cc',
         'logging.h',
@@ -73,16 +85,29 @@
         'module_comparer.cc',
         'module_comparer.h',
         'module_factory.h',
+        'number_parser.h',
         'module_serializer.cc',
         'module_serializer.h',
         'pathname_stripper.cc',
         'pathname_stripper.h',
+        'pathological_minidumps.cc',
+        'pathological_minidumps.h',
         'postfix_evaluator-inl.h',
         'postfix_evaluator.h',
+        'postfix_program-inl.h',
+        'postfix_program.h',
         'proc_maps_linux.cc',
+        'processor_metrics.cc',
+        'processor_metrics.h',
         'process_state.cc',
+        'process_state_proto_writer.cc',
+        'process_state_proto_writer.h',
         'range_map-inl.h',
         'range_map.h',
+        'range_symbol_supplier.cc',
+        'range_symbol_supplier.h',
+        'sequential_stream_buffer.cc',
+        'sequential_stream_buffer.h',
         'simple_serializer-inl.h',
         'simple_serializer.h',
         'simple_symbol_supplier.cc',
@@ -117,14 +142,28 @@
         'static_address_map.h',
         'static_contained_range_map-inl.h',
         'static_contained_range_map.h',
+        'static_line_table.cc',
+        'static_line_table.h',
         'static_map-inl.h',
         'static_map.h',
         'static_map_iterator-inl.h',
         'static_map_iterator.h',
+        'static_map_search_index-inl.h',
+        'static_map_search_index.h',
         'static_range_map-inl.h',
         'static_range_map.h',
+        'string_pool.cc',
+        'string_pool.h',
+        'symbol_compactor.cc',
+        'symbol_compactor.h',
+        'symbol_load_cache.cc',
+        'symbol_load_cache.h',
+        'symbol_path_cache.cc',
+        'symbol_path_cache.h',
         'symbolic_constants_win.cc',
         'symbolic_constants_win.h',
+        'tiered_symbol_supplier.cc',
+        'tiered_symbol_supplier.h',
         'synth_minidump.cc',
         'synth_minidump.h',
         'tokenize.cc',
@@ -144,21 +183,37 @@
       'type': 'executable',
       'sources': [
         'address_map_unittest.cc',
+        'address_range_table_unittest.cc',
         'basic_source_line_resolver_unittest.cc',
+        'caching_symbol_supplier_unittest.cc',
+        'call_stack_cache_unittest.cc',
         'cfi_frame_info_unittest.cc',
         'contained_range_map_unittest.cc',
         'disassembler_x86_unittest.cc',
         'exploitability_unittest.cc',
         'fast_source_line_resolver_unittest.cc',
+        'flat_contained_range_map_unittest.cc',
+        'frame_arena_unittest.cc',
+        'frame_symbol_cache_unittest.cc',
+        'logging_unittest.cc',
         'map_serializers_unittest.cc',
         'microdump_processor_unittest.cc',
         'minidump_processor_unittest.cc',
         'minidump_unittest.cc',
+        'number_parser_unittest.cc',
         'pathname_stripper_unittest.cc',
+        'pathological_minidumps_unittest.cc',
         'postfix_evaluator_unittest.cc',
+        'postfix_program_unittest.cc',
+        'processor_metrics_unittest.cc',
+        'process_state_proto_writer_unittest.cc',
+        'range_map_append_unittest.cc',
+        'range_map_page_index_unittest.cc',
         'range_map_truncate_lower_unittest.cc',
         'range_map_truncate_upper_unittest.cc',
         'range_map_unittest.cc',
+        'range_symbol_supplier_unittest.cc',
+        'sequential_stream_buffer_unittest.cc',
         'stackwalker_address_list_unittest.cc',
         'stackwalker_amd64_unittest.cc',
         'stackwalker_arm64_unittest.cc',
@@ -169,10 +224,44 @@
         'stackwalker_x86_unittest.cc',
         'static_address_map_unittest.cc',
         'static_contained_range_map_unittest.cc',
+        'static_line_table_unittest.cc',
         'static_map_unittest.cc',
         'static_range_map_unittest.cc',
+        'string_pool_unittest.cc',
+        'symbol_compactor_unittest.cc',
+        'symbol_load_cache_unittest.cc',
+        'symbol_path_cache_unittest.cc',
         'synth_minidump_unittest.cc',
         'synth_minidump_unittest_data.h',
+        'tiered_symbol_supplier_unittest.cc',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'dependencies': [
+        'processor',
+        '../build/testing.gyp:gmock',
+        '../build/testing.gyp:gtest',
+      ],
+    },
+    {
+      'target_name': 'pathological_minidump_generator',
+      'type': 'executable',
+      'sources': [
+        'pathological_minidump_generator.cc',
+      ],
+      'include_dirs': [
+        '..',
+      ],
+      'dependencies': [
+        'processor',
+      ],
+    },
+    {
+      'target_name': 'processor_benchmarks',
+      'type': 'executable',
+      'sources': [
+        'processor_benchmarks.cc',
       ],
       'include_dirs': [
         '..',
@@ -0,0 +1,618 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_benchmarks.cc: Timings of the processor's hot paths.
+//
+// Usage: processor_benchmarks [-t <seconds>] [filter ...]
+//
+// Each benchmark repeats an operation, doubling the repetitions until they
+// take at least <seconds> (0.5 by default), and prints the time that one
+// took.  Only the benchmarks whose names contain one of the filters run, if
+// any are given.  Test data comes from $srcdir/src/processor/testdata, as
+// for the unit tests, so run this from the top of the source tree or set
+// srcdir.
+//
+// The benchmarks cover loading symbol files into the basic and fast
+// resolvers, looking up the same address over and over (hot) and
+// addresses all over a module (cold), finding CFI, evaluating a STACK WIN
+// program, scanning a stack for a return address, and processing whole
+// minidumps: some from the test data, and a large one made with
+// SynthMinidump whose many threads' stacks must be scanned.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/minidump.h"
+#include "google_breakpad/processor/minidump_processor.h"
+#include "google_breakpad/processor/process_state.h"
+#include "google_breakpad/processor/stack_frame_symbolizer.h"
+#include "google_breakpad/processor/system_info.h"
+#include "processor/basic_code_module.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+#include "processor/postfix_evaluator-inl.h"
+#include "processor/postfix_program-inl.h"
+#include "processor/simple_symbol_supplier.h"
+#include "processor/stackwalker_amd64.h"
+#include "processor/stackwalker_unittest_utils.h"
+#include "processor/synth_minidump.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::CFIFrameInfo;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::LogStream;
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpProcessor;
+using google_breakpad::ModuleSerializer;
+using google_breakpad::PostfixEvaluator;
+using google_breakpad::PostfixProgram;
+using google_breakpad::ProcessState;
+using google_breakpad::SimpleSymbolSupplier;
+using google_breakpad::SourceLineResolverInterface;
+using google_breakpad::StackFrame;
+using google_breakpad::StackFrameSymbolizer;
+using google_breakpad::StackwalkerAMD64;
+using google_breakpad::SystemInfo;
+using google_breakpad::scoped_array;
+using google_breakpad::scoped_ptr;
+using google_breakpad::test_assembler::kLittleEndian;
+
+// Results are added to this so that the compiler can't discard the work
+// that produced them.
+volatile uint64_t g_sink;
+
+string GetTestDataPath() {
+  char* srcdir = getenv("srcdir");
+  return string(srcdir ? srcdir : ".") + "/src/processor/testdata/";
+}
+
+bool ReadFile(const string& path, string* contents) {
+  std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    return false;
+  std::ostringstream stream;
+  stream << file.rdbuf();
+  *contents = stream.str();
+  return true;
+}
+
+// The addresses of the records in |symbol_data| whose lines begin with
+// |prefix|, such as "FUNC " or "STACK CFI INIT ".
+std::vector<uint64_t> RecordAddresses(const string& symbol_data,
+                                      const string& prefix) {
+  std::vector<uint64_t> addresses;
+  size_t line = 0;
+  while (line < symbol_data.size()) {
+    size_t end = symbol_data.find('\n', line);
+    if (end == string::npos)
+      end = symbol_data.size();
+    if (symbol_data.compare(line, prefix.size(), prefix) == 0) {
+      const char* field = symbol_data.c_str() + line + prefix.size();
+      // FUNC records may be marked as sharing code with another function.
+      if (strncmp(field, "m ", 2) == 0)
+        field += 2;
+      addresses.push_back(strtoull(field, NULL, 16));
+    }
+    line = end + 1;
+  }
+  return addresses;
+}
+
+// Shuffles |addresses| the same way every time, so that looking them up in
+// order touches the module all over.
+void Shuffle(std::vector<uint64_t>* addresses) {
+  uint32_t state = 1;
+  for (size_t i = addresses->size(); i > 1; --i) {
+    state = state * 1103515245 + 12345;
+    std::swap((*addresses)[i - 1], (*addresses)[(state >> 8) % i]);
+  }
+}
+
+class Benchmark {
+ public:
+  virtual ~Benchmark() {}
+
+  // Prepares to run, returning false if that isn't possible.
+  virtual bool SetUp() = 0;
+
+  // Does the operation being timed |iterations| times.
+  virtual void Run(int iterations) = 0;
+};
+
+// A symbol file loaded into a resolver, for the benchmarks that use one.
+class SymbolFileBenchmark : public Benchmark {
+ public:
+  SymbolFileBenchmark(const char* symbol_file, bool fast)
+      : symbol_file_(symbol_file),
+        fast_(fast),
+        module_(0, 0x10000000, "module", "", "module", "", "") {}
+
+  bool SetUp() {
+    if (!ReadFile(GetTestDataPath() + "symbols/" + symbol_file_,
+                  &symbol_data_)) {
+      fprintf(stderr, "Can't read %s\n", symbol_file_);
+      return false;
+    }
+    if (fast_) {
+      unsigned int size;
+      ModuleSerializer serializer;
+      serialized_.reset(
+          serializer.SerializeSymbolFileData(symbol_data_, &size));
+      if (!serialized_.get())
+        return false;
+      serialized_size_ = size;
+      resolver_.reset(new FastSourceLineResolver);
+    } else {
+      resolver_.reset(new BasicSourceLineResolver);
+    }
+    return Load();
+  }
+
+ protected:
+  // Loads the symbol file into resolver_, as StackFrameSymbolizer would.
+  bool Load() {
+    if (fast_) {
+      // The fast resolver uses the serialized data in place.
+      return resolver_->LoadModuleUsingMemoryBuffer(
+          &module_, serialized_.get(), serialized_size_);
+    }
+    // The basic resolver takes the buffer, which must be NUL-terminated.
+    char* buffer = new char[symbol_data_.size() + 1];
+    memcpy(buffer, symbol_data_.c_str(), symbol_data_.size() + 1);
+    return resolver_->LoadModuleUsingMemoryBuffer(&module_, buffer,
+                                                  symbol_data_.size() + 1);
+  }
+
+  const char* symbol_file_;
+  bool fast_;
+  BasicCodeModule module_;
+  string symbol_data_;
+  scoped_array<char> serialized_;
+  size_t serialized_size_;
+  scoped_ptr<SourceLineResolverInterface> resolver_;
+};
+
+class LoadSymbolsBenchmark : public SymbolFileBenchmark {
+ public:
+  LoadSymbolsBenchmark(const char* symbol_file, bool fast)
+      : SymbolFileBenchmark(symbol_file, fast) {}
+
+  void Run(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      resolver_->UnloadModule(&module_);
+      g_sink = g_sink + Load();
+    }
+  }
+};
+
+class LookupAddressBenchmark : public SymbolFileBenchmark {
+ public:
+  LookupAddressBenchmark(const char* symbol_file, bool fast, bool hot)
+      : SymbolFileBenchmark(symbol_file, fast), hot_(hot) {}
+
+  bool SetUp() {
+    if (!SymbolFileBenchmark::SetUp())
+      return false;
+    addresses_ = RecordAddresses(symbol_data_, "FUNC ");
+    if (addresses_.empty())
+      return false;
+    Shuffle(&addresses_);
+    // Look up an address within each function, past its first line.
+    for (size_t i = 0; i < addresses_.size(); ++i)
+      addresses_[i] += 4;
+    if (hot_)
+      addresses_.resize(1);
+    return true;
+  }
+
+  void Run(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      StackFrame frame;
+      frame.module = &module_;
+      frame.instruction = addresses_[i % addresses_.size()];
+      resolver_->FillSourceLineInfo(&frame, NULL);
+      g_sink = g_sink + frame.source_line;
+    }
+  }
+
+ private:
+  bool hot_;
+  std::vector<uint64_t> addresses_;
+};
+
+class FindCFIFrameInfoBenchmark : public SymbolFileBenchmark {
+ public:
+  FindCFIFrameInfoBenchmark(const char* symbol_file, bool fast)
+      : SymbolFileBenchmark(symbol_file, fast) {}
+
+  bool SetUp() {
+    if (!SymbolFileBenchmark::SetUp())
+      return false;
+    addresses_ = RecordAddresses(symbol_data_, "STACK CFI INIT ");
+    Shuffle(&addresses_);
+    return !addresses_.empty();
+  }
+
+  void Run(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      StackFrame frame;
+      frame.module = &module_;
+      frame.instruction = addresses_[i % addresses_.size()];
+      scoped_ptr<CFIFrameInfo> cfi(resolver_->FindCFIFrameInfo(&frame));
+      g_sink = g_sink + (cfi.get() != NULL);
+    }
+  }
+
+ private:
+  std::vector<uint64_t> addresses_;
+};
+
+// The program of a STACK WIN record for a function with a frame pointer.
+const char kStackWinProgram[] =
+    "$T0 $ebp = $eip $T0 4 + ^ = $ebp $T0 ^ = $esp $T0 8 + =";
+const uint32_t kStackBase = 0x80000;
+
+class PostfixBenchmark : public Benchmark {
+ public:
+  explicit PostfixBenchmark(bool compiled)
+      : compiled_(compiled), program_(kStackWinProgram) {}
+
+  bool SetUp() {
+    // A saved %ebp and a return address.
+    string stack(16, '\0');
+    stack[0] = 0x10;
+    stack[4] = 0x34;
+    stack[5] = 0x12;
+    memory_.Init(kStackBase, stack);
+    dictionary_["$ebp"] = kStackBase;
+    dictionary_["$esp"] = kStackBase - 0x20;
+    dictionary_["$eip"] = 0x1000;
+    return program_.compiled();
+  }
+
+  void Run(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      if (compiled_) {
+        PostfixProgram::Registers<uint32_t> registers;
+        program_.LoadRegisters(dictionary_, &registers);
+        g_sink = g_sink + program_.Evaluate(&registers, &memory_);
+      } else {
+        PostfixEvaluator<uint32_t>::DictionaryType dictionary = dictionary_;
+        PostfixEvaluator<uint32_t>::DictionaryValidityType assigned;
+        PostfixEvaluator<uint32_t> evaluator(&dictionary, &memory_);
+        g_sink = g_sink + evaluator.Evaluate(kStackWinProgram, &assigned);
+      }
+    }
+  }
+
+ private:
+  bool compiled_;
+  PostfixProgram program_;
+  MockMemoryRegion memory_;
+  PostfixEvaluator<uint32_t>::DictionaryType dictionary_;
+};
+
+// A stack walker that lets ScanForReturnAddress be called directly.
+class ScanningStackwalker : public StackwalkerAMD64 {
+ public:
+  ScanningStackwalker(const SystemInfo* system_info,
+                      google_breakpad::MemoryRegion* memory,
+                      const google_breakpad::CodeModules* modules,
+                      StackFrameSymbolizer* frame_symbolizer)
+      : StackwalkerAMD64(system_info, NULL, memory, modules,
+                         frame_symbolizer) {}
+
+  bool Scan(uint64_t start, uint64_t* found) {
+    uint64_t location;
+    return ScanForReturnAddress(start, &location, found, true);
+  }
+};
+
+class ScanForReturnAddressBenchmark : public Benchmark {
+ public:
+  ScanForReturnAddressBenchmark()
+      : module1_(0x40000000, 0x10000, "module1", "version1"),
+        module2_(0x50000000, 0x10000, "module2", "version2"),
+        frame_symbolizer_(NULL, NULL) {}
+
+  bool SetUp() {
+    modules_.Add(&module1_);
+    modules_.Add(&module2_);
+    // Small integers and pointers between the modules, as the search
+    // finds in practice, with the return address at the far end of what
+    // is searched from a context frame.
+    const int kWords = 150;
+    string stack;
+    for (int i = 0; i < kWords; ++i) {
+      uint64_t word = i == kWords - 1 ? 0x50001234 :
+                      i % 2 ? 0x48000000 + i * 8 : i;
+      stack.append(reinterpret_cast<const char*>(&word), sizeof(word));
+    }
+    memory_.Init(kStackBase, stack);
+    system_info_.os = "Linux";
+    system_info_.cpu = "x86";
+    walker_.reset(new ScanningStackwalker(&system_info_, &memory_, &modules_,
+                                          &frame_symbolizer_));
+    uint64_t found;
+    return walker_->Scan(kStackBase, &found);
+  }
+
+  void Run(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      uint64_t found = 0;
+      walker_->Scan(kStackBase, &found);
+      g_sink = g_sink + found;
+    }
+  }
+
+ private:
+  MockCodeModule module1_;
+  MockCodeModule module2_;
+  MockCodeModules modules_;
+  MockMemoryRegion memory_;
+  SystemInfo system_info_;
+  StackFrameSymbolizer frame_symbolizer_;
+  scoped_ptr<ScanningStackwalker> walker_;
+};
+
+// Reads and processes a minidump held in memory, with symbols from the
+// test data; the symbols are loaded the first time.
+class ProcessBenchmark : public Benchmark {
+ public:
+  explicit ProcessBenchmark(const char* minidump_file)
+      : minidump_file_(minidump_file),
+        supplier_(GetTestDataPath() + "symbols"),
+        processor_(&supplier_, &resolver_) {}
+
+  bool SetUp() {
+    if (minidump_file_)
+      return ReadFile(GetTestDataPath() + minidump_file_, &contents_);
+    return Synthesize();
+  }
+
+  void Run(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+      std::istringstream stream(contents_);
+      Minidump minidump(stream);
+      ProcessState state;
+      if (minidump.Read())
+        processor_.Process(&minidump, &state);
+      g_sink = g_sink + state.threads()->size();
+    }
+  }
+
+ private:
+  // Makes a Windows x86 minidump of many threads, whose stacks hold no
+  // frame pointers, so that each must be scanned for return addresses.
+  bool Synthesize() {
+    using google_breakpad::SynthMinidump::Context;
+    using google_breakpad::SynthMinidump::Dump;
+    using google_breakpad::SynthMinidump::Memory;
+    using google_breakpad::SynthMinidump::Module;
+    using google_breakpad::SynthMinidump::String;
+    using google_breakpad::SynthMinidump::Thread;
+
+    const int kThreadCount = 256;
+    const int kStackWords = 4096;
+    const uint32_t kModuleBase = 0x40000000;
+    const uint32_t kModuleSize = 0x100000;
+
+    Dump dump(0, kLittleEndian);
+    String csd_version(dump,
+        google_breakpad::SynthMinidump::SystemInfo::windows_x86_csd_version);
+    google_breakpad::SynthMinidump::SystemInfo system_info(
+        dump, google_breakpad::SynthMinidump::SystemInfo::windows_x86,
+        csd_version);
+    String module_name(dump, "c:\\synthesized.dll");
+    Module module(dump, kModuleBase, kModuleSize, module_name);
+    dump.Add(&csd_version);
+    dump.Add(&system_info);
+    dump.Add(&module_name);
+    dump.Add(&module);
+
+    uint32_t state = 1;
+    std::vector<std::unique_ptr<Memory> > stacks;
+    std::vector<std::unique_ptr<Context> > contexts;
+    std::vector<std::unique_ptr<Thread> > threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+      const uint32_t stack_base = 0x100000 + i * kStackWords * 4;
+      Memory* stack = new Memory(dump, stack_base);
+      // Mostly data, with a return address every 64 words or so.
+      for (int word = 0; word < kStackWords; ++word) {
+        state = state * 1103515245 + 12345;
+        if (state % 64 == 0)
+          stack->D32(kModuleBase + (state >> 8) % kModuleSize);
+        else
+          stack->D32(state >> 16);
+      }
+      MDRawContextX86 raw_context;
+      memset(&raw_context, 0, sizeof(raw_context));
+      raw_context.context_flags = MD_CONTEXT_X86_FULL;
+      raw_context.eip = kModuleBase + 0x1000 + i;
+      raw_context.esp = stack_base;
+      Context* context = new Context(dump, raw_context);
+      Thread* thread = new Thread(dump, 0x1000 + i, *stack, *context);
+      dump.Add(stack);
+      dump.Add(context);
+      dump.Add(thread);
+      stacks.push_back(std::unique_ptr<Memory>(stack));
+      contexts.push_back(std::unique_ptr<Context>(context));
+      threads.push_back(std::unique_ptr<Thread>(thread));
+    }
+    dump.Finish();
+    return dump.GetContents(&contents_);
+  }
+
+  const char* minidump_file_;
+  string contents_;
+  SimpleSymbolSupplier supplier_;
+  BasicSourceLineResolver resolver_;
+  MinidumpProcessor processor_;
+};
+
+const char kTestAppSymbols[] =
+    "test_app.pdb/5A9832E5287241C1838ED98914E9B7FF1/test_app.sym";
+const char kLibcSymbols[] =
+    "libc-2.13.so/F4F8DFCD5A5FB5A7CE64717E9E6AE3890/libc-2.13.so.sym";
+
+struct BenchmarkEntry {
+  const char* name;
+  Benchmark* (*create)();
+};
+
+const BenchmarkEntry kBenchmarks[] = {
+  { "LoadSymbols/Basic",
+    []() -> Benchmark* {
+      return new LoadSymbolsBenchmark(kTestAppSymbols, false); } },
+  { "LoadSymbols/Fast",
+    []() -> Benchmark* {
+      return new LoadSymbolsBenchmark(kTestAppSymbols, true); } },
+  { "LookupAddress/Basic/Hot",
+    []() -> Benchmark* {
+      return new LookupAddressBenchmark(kTestAppSymbols, false, true); } },
+  { "LookupAddress/Basic/Cold",
+    []() -> Benchmark* {
+      return new LookupAddressBenchmark(kTestAppSymbols, false, false); } },
+  { "LookupAddress/Fast/Hot",
+    []() -> Benchmark* {
+      return new LookupAddressBenchmark(kTestAppSymbols, true, true); } },
+  { "LookupAddress/Fast/Cold",
+    []() -> Benchmark* {
+      return new LookupAddressBenchmark(kTestAppSymbols, true, false); } },
+  { "FindCFIFrameInfo/Basic",
+    []() -> Benchmark* {
+      return new FindCFIFrameInfoBenchmark(kLibcSymbols, false); } },
+  { "FindCFIFrameInfo/Fast",
+    []() -> Benchmark* {
+      return new FindCFIFrameInfoBenchmark(kLibcSymbols, true); } },
+  { "PostfixEvaluator/StackWin",
+    []() -> Benchmark* { return new PostfixBenchmark(false); } },
+  { "PostfixProgram/StackWin",
+    []() -> Benchmark* { return new PostfixBenchmark(true); } },
+  { "ScanForReturnAddress",
+    []() -> Benchmark* { return new ScanForReturnAddressBenchmark; } },
+  { "Process/minidump2",
+    []() -> Benchmark* { return new ProcessBenchmark("minidump2.dmp"); } },
+  { "Process/linux_overflow",
+    []() -> Benchmark* {
+      return new ProcessBenchmark("linux_overflow.dmp"); } },
+  { "Process/Synthesized",
+    []() -> Benchmark* { return new ProcessBenchmark(NULL); } },
+};
+
+bool Selected(const char* name, const std::vector<string>& filters) {
+  if (filters.empty())
+    return true;
+  for (size_t i = 0; i < filters.size(); ++i) {
+    if (strstr(name, filters[i].c_str()))
+      return true;
+  }
+  return false;
+}
+
+void Usage(const char* program) {
+  fprintf(stderr, "Usage: %s [-t <seconds>] [filter ...]\n", program);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  double min_seconds = 0.5;
+  int ch;
+  while ((ch = getopt(argc, argv, "t:")) != -1) {
+    switch (ch) {
+      case 't':
+        min_seconds = atof(optarg);
+        if (min_seconds <= 0) {
+          Usage(argv[0]);
+          return 1;
+        }
+        break;
+      default:
+        Usage(argv[0]);
+        return 1;
+    }
+  }
+  std::vector<string> filters(argv + optind, argv + argc);
+
+  // The processor's logging would swamp the results.
+  LogStream::set_minimum_severity(LogStream::SEVERITY_CRITICAL);
+
+  bool all_ran = true;
+  for (size_t i = 0; i < sizeof(kBenchmarks) / sizeof(kBenchmarks[0]); ++i) {
+    const BenchmarkEntry& entry = kBenchmarks[i];
+    if (!Selected(entry.name, filters))
+      continue;
+    scoped_ptr<Benchmark> benchmark(entry.create());
+    if (!benchmark->SetUp()) {
+      printf("%-28s FAILED TO SET UP\n", entry.name);
+      all_ran = false;
+      continue;
+    }
+
+    // Run once untimed to warm up, then double the iterations until a run
+    // takes long enough to time.
+    benchmark->Run(1);
+    int iterations = 1;
+    double seconds;
+    while (true) {
+      std::chrono::steady_clock::time_point start =
+          std::chrono::steady_clock::now();
+      benchmark->Run(iterations);
+      seconds = std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count();
+      if (seconds >= min_seconds || iterations >= (1 << 30))
+        break;
+      iterations *= 2;
+    }
+    printf("%-28s %14.1f ns/op %12d iterations\n", entry.name,
+           seconds * 1e9 / iterations, iterations);
+    fflush(stdout);
+  }
+  return all_ran ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_metrics.cc: Implementation of ProcessorMetrics.  See
+// processor_metrics.h.
+
+#include "processor/processor_metrics.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+
+namespace google_breakpad {
+
+ProcessorMetrics::ProcessorMetrics() {
+  Reset();
+}
+
+void ProcessorMetrics::Record(Timer timer,
+                              std::chrono::steady_clock::duration elapsed) {
+  int64_t elapsed_microseconds =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  uint64_t microseconds =
+      elapsed_microseconds > 0 ? static_cast<uint64_t>(elapsed_microseconds) :
+                                 0;
+  Histogram& histogram = timers_[timer];
+  histogram.count.fetch_add(1, std::memory_order_relaxed);
+  histogram.total_microseconds.fetch_add(microseconds,
+                                         std::memory_order_relaxed);
+  uint64_t max = histogram.max_microseconds.load(std::memory_order_relaxed);
+  while (microseconds > max &&
+         !histogram.max_microseconds.compare_exchange_weak(
+             max, microseconds, std::memory_order_relaxed)) {
+  }
+
+  int bucket = 0;
+  while (bucket < kBucketCount - 1 &&
+         microseconds >= (static_cast<uint64_t>(1) << bucket)) {
+    ++bucket;
+  }
+  histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t ProcessorMetrics::timer_count(Timer timer) const {
+  return timers_[timer].count.load(std::memory_order_relaxed);
+}
+
+uint64_t ProcessorMetrics::total_microseconds(Timer timer) const {
+  return timers_[timer].total_microseconds.load(std::memory_order_relaxed);
+}
+
+uint64_t ProcessorMetrics::max_microseconds(Timer timer) const {
+  return timers_[timer].max_microseconds.load(std::memory_order_relaxed);
+}
+
+uint64_t ProcessorMetrics::PercentileMicroseconds(Timer timer,
+                                                  double percentile) const {
+  const Histogram& histogram = timers_[timer];
+  uint64_t count = histogram.count.load(std::memory_order_relaxed);
+  if (count == 0)
+    return 0;
+
+  // The rank of the time wanted, counting from 1.
+  uint64_t rank = static_cast<uint64_t>(count * percentile / 100.0 + 0.5);
+  if (rank < 1)
+    rank = 1;
+  uint64_t max = histogram.max_microseconds.load(std::memory_order_relaxed);
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < kBucketCount - 1; ++bucket) {
+    seen += histogram.buckets[bucket].load(std::memory_order_relaxed);
+    if (seen >= rank)
+      return std::min(static_cast<uint64_t>(1) << bucket, max);
+  }
+  return max;
+}
+
+void ProcessorMetrics::Reset() {
+  for (int i = 0; i < COUNTER_COUNT; ++i)
+    counters_[i].store(0, std::memory_order_relaxed);
+  for (int i = 0; i < TIMER_COUNT; ++i) {
+    Histogram& histogram = timers_[i];
+    histogram.count.store(0, std::memory_order_relaxed);
+    histogram.total_microseconds.store(0, std::memory_order_relaxed);
+    histogram.max_microseconds.store(0, std::memory_order_relaxed);
+    for (int bucket = 0; bucket < kBucketCount; ++bucket)
+      histogram.buckets[bucket].store(0, std::memory_order_relaxed);
+  }
+}
+
+void ProcessorMetrics::Print(FILE* out) const {
+  for (int i = 0; i < COUNTER_COUNT; ++i) {
+    Counter counter = static_cast<Counter>(i);
+    fprintf(out, "%-20s %" PRIu64 "\n", CounterName(counter), count(counter));
+  }
+  fprintf(out, "%-20s %10s %12s %10s %10s %10s %10s\n",
+          "timer", "count", "total_ms", "mean_us", "p50_us", "p99_us",
+          "max_us");
+  for (int i = 0; i < TIMER_COUNT; ++i) {
+    Timer timer = static_cast<Timer>(i);
+    uint64_t count = timer_count(timer);
+    uint64_t total = total_microseconds(timer);
+    fprintf(out, "%-20s %10" PRIu64 " %12.1f %10" PRIu64 " %10" PRIu64
+            " %10" PRIu64 " %10" PRIu64 "\n",
+            TimerName(timer), count, total / 1000.0,
+            count ? total / count : 0,
+            PercentileMicroseconds(timer, 50),
+            PercentileMicroseconds(timer, 99),
+            max_microseconds(timer));
+  }
+}
+
+// static
+const char* ProcessorMetrics::CounterName(Counter counter) {
+  switch (counter) {
+    case MINIDUMPS: return "minidumps";
+    case THREADS: return "threads";
+    case FRAMES_NONE: return "frames_none";
+    case FRAMES_SCAN: return "frames_scan";
+    case FRAMES_CFI_SCAN: return "frames_cfi_scan";
+    case FRAMES_FP: return "frames_fp";
+    case FRAMES_CFI: return "frames_cfi";
+    case FRAMES_PREWALKED: return "frames_prewalked";
+    case FRAMES_CONTEXT: return "frames_context";
+    case FRAMES_INLINE: return "frames_inline";
+    case SYMBOLS_FOUND: return "symbols_found";
+    case SYMBOLS_NOT_FOUND: return "symbols_not_found";
+    case SYMBOLS_INTERRUPTED: return "symbols_interrupted";
+    case SYMBOLS_NOT_LOADED: return "symbols_not_loaded";
+    case COUNTER_COUNT: break;
+  }
+  return "unknown";
+}
+
+// static
+const char* ProcessorMetrics::TimerName(Timer timer) {
+  switch (timer) {
+    case READ: return "read";
+    case PROCESS: return "process";
+    case SYMBOL_FETCH: return "symbol_fetch";
+    case MODULE_LOAD: return "module_load";
+    case STACKWALK: return "stackwalk";
+    case EXPLOITABILITY: return "exploitability";
+    case TIMER_COUNT: break;
+  }
+  return "unknown";
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,185 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_metrics.h: Counts and timings of what MinidumpProcessor does.
+//
+// A ProcessorMetrics given to MinidumpProcessor::set_metrics() counts the
+// minidumps, threads, frames and symbol fetches it processes, and keeps a
+// histogram of the time spent in each step: reading the minidump, fetching
+// and loading symbols, walking each thread's stack and rating
+// exploitability.  It shows where the time goes, and how unevenly, without
+// a profiler.  The steps are timed where MinidumpProcessor and
+// StackFrameSymbolizer call into the Minidump, SymbolSupplier,
+// SourceLineResolverInterface and Stackwalker, so any implementation of
+// them is measured.
+//
+// Recording is lock-free, so one ProcessorMetrics may be shared by
+// processors on several threads.
+//
+// Each timed step also fires the phase_start and phase_done static
+// tracepoints (see common/trace_probes.h), with the Timer as argument,
+// whether or not a ProcessorMetrics is given, so that a tracer can time
+// the steps of a processor running without one.
+
+#ifndef PROCESSOR_PROCESSOR_METRICS_H__
+#define PROCESSOR_PROCESSOR_METRICS_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+
+#include "common/trace_probes.h"
+
+namespace google_breakpad {
+
+class ProcessorMetrics {
+ public:
+  enum Counter {
+    // Minidumps processed, and threads whose stacks were walked.
+    MINIDUMPS,
+    THREADS,
+    // Frames found, by how they were found; in the order of
+    // StackFrame::FrameTrust, so that FRAMES_NONE + trust is the counter
+    // for a frame.
+    FRAMES_NONE,
+    FRAMES_SCAN,
+    FRAMES_CFI_SCAN,
+    FRAMES_FP,
+    FRAMES_CFI,
+    FRAMES_PREWALKED,
+    FRAMES_CONTEXT,
+    FRAMES_INLINE,
+    // Symbol fetches from the SymbolSupplier, by result.
+    SYMBOLS_FOUND,
+    SYMBOLS_NOT_FOUND,
+    SYMBOLS_INTERRUPTED,
+    // Symbol files that the resolver failed to load.
+    SYMBOLS_NOT_LOADED,
+    COUNTER_COUNT
+  };
+
+  enum Timer {
+    // Minidump::Read(), when MinidumpProcessor reads the minidump itself.
+    READ,
+    // MinidumpProcessor::Process(), from start to finish.
+    PROCESS,
+    // A SymbolSupplier fetch.
+    SYMBOL_FETCH,
+    // Loading a symbol file into the SourceLineResolver.
+    MODULE_LOAD,
+    // Walking one thread's stack, including the symbol fetches and loads
+    // it leads to.
+    STACKWALK,
+    // Rating exploitability.
+    EXPLOITABILITY,
+    TIMER_COUNT
+  };
+
+  // Times from its construction to its destruction into |timer| of
+  // |metrics|, unless |metrics| is NULL.
+  class ScopedTimer {
+   public:
+    ScopedTimer(ProcessorMetrics* metrics, Timer timer)
+        : metrics_(metrics), timer_(timer) {
+      BREAKPAD_PROBE1(phase_start, static_cast<int>(timer_));
+      if (metrics_)
+        start_ = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+      if (metrics_)
+        metrics_->Record(timer_, std::chrono::steady_clock::now() - start_);
+      BREAKPAD_PROBE1(phase_done, static_cast<int>(timer_));
+    }
+
+   private:
+    ProcessorMetrics* metrics_;
+    Timer timer_;
+    std::chrono::steady_clock::time_point start_;
+
+    ScopedTimer(const ScopedTimer&);
+    void operator=(const ScopedTimer&);
+  };
+
+  ProcessorMetrics();
+
+  void Add(Counter counter, uint64_t count = 1) {
+    counters_[counter].fetch_add(count, std::memory_order_relaxed);
+  }
+
+  void Record(Timer timer, std::chrono::steady_clock::duration elapsed);
+
+  uint64_t count(Counter counter) const {
+    return counters_[counter].load(std::memory_order_relaxed);
+  }
+
+  // The number of times recorded for |timer|, their total and the longest,
+  // in microseconds.
+  uint64_t timer_count(Timer timer) const;
+  uint64_t total_microseconds(Timer timer) const;
+  uint64_t max_microseconds(Timer timer) const;
+
+  // An upper bound on the |percentile|th percentile of the times recorded
+  // for |timer|, in microseconds, within a factor of two and no more than
+  // the longest, or 0 if none were recorded.
+  uint64_t PercentileMicroseconds(Timer timer, double percentile) const;
+
+  // Forgets everything recorded so far.
+  void Reset();
+
+  // Writes the counters and a line per timer to |out|.
+  void Print(FILE* out) const;
+
+  static const char* CounterName(Counter counter);
+  static const char* TimerName(Timer timer);
+
+ private:
+  // Bucket i of a histogram counts the times under 2^i microseconds that
+  // aren't in an earlier bucket; the last bucket counts the rest.
+  static const int kBucketCount = 40;
+
+  struct Histogram {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total_microseconds;
+    std::atomic<uint64_t> max_microseconds;
+    std::atomic<uint64_t> buckets[kBucketCount];
+  };
+
+  std::atomic<uint64_t> counters_[COUNTER_COUNT];
+  Histogram timers_[TIMER_COUNT];
+
+  // Disallow copy constructor and assignment operator.
+  ProcessorMetrics(const ProcessorMetrics&);
+  void operator=(const ProcessorMetrics&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_PROCESSOR_METRICS_H__
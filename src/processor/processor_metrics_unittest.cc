@@ -0,0 +1,123 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// processor_metrics_unittest.cc: Unit tests for ProcessorMetrics.
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "processor/processor_metrics.h"
+
+namespace {
+
+using google_breakpad::ProcessorMetrics;
+using std::chrono::microseconds;
+
+TEST(ProcessorMetricsTest, Counters) {
+  ProcessorMetrics metrics;
+  EXPECT_EQ(0U, metrics.count(ProcessorMetrics::THREADS));
+  metrics.Add(ProcessorMetrics::THREADS);
+  metrics.Add(ProcessorMetrics::THREADS, 4);
+  metrics.Add(ProcessorMetrics::FRAMES_CFI, 2);
+  EXPECT_EQ(5U, metrics.count(ProcessorMetrics::THREADS));
+  EXPECT_EQ(2U, metrics.count(ProcessorMetrics::FRAMES_CFI));
+  EXPECT_EQ(0U, metrics.count(ProcessorMetrics::FRAMES_SCAN));
+
+  metrics.Reset();
+  EXPECT_EQ(0U, metrics.count(ProcessorMetrics::THREADS));
+}
+
+TEST(ProcessorMetricsTest, Timers) {
+  ProcessorMetrics metrics;
+  EXPECT_EQ(0U, metrics.PercentileMicroseconds(ProcessorMetrics::READ, 50));
+
+  // 98 short reads, and two slow ones.
+  for (int i = 0; i < 98; ++i)
+    metrics.Record(ProcessorMetrics::READ, microseconds(100));
+  metrics.Record(ProcessorMetrics::READ, microseconds(50000));
+  metrics.Record(ProcessorMetrics::READ, microseconds(70000));
+
+  EXPECT_EQ(100U, metrics.timer_count(ProcessorMetrics::READ));
+  EXPECT_EQ(98U * 100 + 50000 + 70000,
+            metrics.total_microseconds(ProcessorMetrics::READ));
+  EXPECT_EQ(70000U, metrics.max_microseconds(ProcessorMetrics::READ));
+  // Percentiles are the top of a power-of-two bucket, or the longest time.
+  EXPECT_EQ(128U, metrics.PercentileMicroseconds(ProcessorMetrics::READ, 50));
+  EXPECT_EQ(128U, metrics.PercentileMicroseconds(ProcessorMetrics::READ, 98));
+  EXPECT_EQ(65536U,
+            metrics.PercentileMicroseconds(ProcessorMetrics::READ, 99));
+  EXPECT_EQ(70000U,
+            metrics.PercentileMicroseconds(ProcessorMetrics::READ, 100));
+  EXPECT_EQ(0U, metrics.timer_count(ProcessorMetrics::PROCESS));
+
+  metrics.Reset();
+  EXPECT_EQ(0U, metrics.timer_count(ProcessorMetrics::READ));
+  EXPECT_EQ(0U, metrics.max_microseconds(ProcessorMetrics::READ));
+}
+
+TEST(ProcessorMetricsTest, ScopedTimer) {
+  ProcessorMetrics metrics;
+  {
+    ProcessorMetrics::ScopedTimer timer(&metrics, ProcessorMetrics::PROCESS);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  EXPECT_EQ(1U, metrics.timer_count(ProcessorMetrics::PROCESS));
+  EXPECT_LE(2000U, metrics.total_microseconds(ProcessorMetrics::PROCESS));
+
+  // A timer without metrics records nothing.
+  { ProcessorMetrics::ScopedTimer timer(NULL, ProcessorMetrics::PROCESS); }
+  EXPECT_EQ(1U, metrics.timer_count(ProcessorMetrics::PROCESS));
+}
+
+TEST(ProcessorMetricsTest, Concurrent) {
+  ProcessorMetrics metrics;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.push_back(std::thread([&metrics, i]() {
+      for (int j = 0; j < 1000; ++j) {
+        metrics.Add(ProcessorMetrics::FRAMES_SCAN);
+        metrics.Record(ProcessorMetrics::STACKWALK, microseconds(i * 1000 + j));
+      }
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  EXPECT_EQ(4000U, metrics.count(ProcessorMetrics::FRAMES_SCAN));
+  EXPECT_EQ(4000U, metrics.timer_count(ProcessorMetrics::STACKWALK));
+  EXPECT_EQ(3999U, metrics.max_microseconds(ProcessorMetrics::STACKWALK));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
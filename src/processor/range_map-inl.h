@@ -39,6 +39,7 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include "processor/range_map.h"
 #include "processor/linked_ptr.h"
 #include "processor/logging.h"
@@ -179,6 +180,65 @@ bool RangeMap<AddressType, EntryType>::StoreRangeInternal(
 }
 
 
+template<typename AddressType, typename EntryType>
+bool RangeMap<AddressType, EntryType>::AppendRange(const AddressType& base,
+                                                   const AddressType& size,
+                                                   const EntryType& entry) {
+  AddressType high = base + (size - 1);
+  if (size <= 0 || high < base) {
+    // Fail, and log, just as storing it would.
+    return StoreRangeInternal(base, 0 /* delta */, size, entry);
+  }
+  appended_.push_back(AppendedRange(base, high, entry));
+  return true;
+}
+
+template<typename AddressType, typename EntryType>
+void RangeMap<AddressType, EntryType>::StoreAppendedRanges() {
+  std::vector<AppendedRange> appended;
+  appended.swap(appended_);
+  if (appended.empty())
+    return;
+
+  // Put the ranges in address order, unless they already are.
+  std::vector<size_t> order;
+  for (size_t i = 1; i < appended.size(); ++i) {
+    if (appended[i].base <= appended[i - 1].high) {
+      order.resize(appended.size());
+      for (size_t j = 0; j < order.size(); ++j)
+        order[j] = j;
+      std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return appended[a].base < appended[b].base;
+      });
+      break;
+    }
+  }
+  const AppendedRange& lowest = appended[order.empty() ? 0 : order[0]];
+
+  // If no two overlap, and they all lie above the ranges already stored,
+  // the order they're stored in doesn't matter, and each can go at the end
+  // of the map without a search.
+  bool disjoint = map_.empty() || map_.rbegin()->first < lowest.base;
+  for (size_t i = 1; disjoint && i < order.size(); ++i)
+    disjoint = appended[order[i - 1]].high < appended[order[i]].base;
+
+  if (!disjoint) {
+    for (size_t i = 0; i < appended.size(); ++i) {
+      const AppendedRange& range = appended[i];
+      StoreRangeInternal(range.base, 0 /* delta */,
+                         range.high - range.base + 1, range.entry);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < appended.size(); ++i) {
+    const AppendedRange& range = appended[order.empty() ? i : order[i]];
+    map_.insert(map_.end(),
+                MapValue(range.high, Range(range.base, 0, range.entry)));
+  }
+}
+
+
 template<typename AddressType, typename EntryType>
 bool RangeMap<AddressType, EntryType>::RetrieveRange(
     const AddressType& address, EntryType* entry, AddressType* entry_base,
@@ -279,9 +339,20 @@ int RangeMap<AddressType, EntryType>::GetCount() const {
 }
 
 
+template<typename AddressType, typename EntryType>
+template<typename Visitor>
+void RangeMap<AddressType, EntryType>::VisitEntries(Visitor visitor) const {
+  for (MapConstIterator iterator = map_.begin(); iterator != map_.end();
+       ++iterator) {
+    visitor(iterator->second.entry());
+  }
+}
+
+
 template<typename AddressType, typename EntryType>
 void RangeMap<AddressType, EntryType>::Clear() {
   map_.clear();
+  appended_.clear();
 }
 
 
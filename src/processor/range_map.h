@@ -42,12 +42,15 @@
 
 
 #include <map>
-
+#include <vector>
 
 namespace google_breakpad {
 
 // Forward declarations (for later friend declarations of specialized template).
 template<class, class> class RangeMapSerializer;
+template<class, class> class LineTableSerializer;
+template<class, class> class AddressRangeTable;
+template<class, class> class RangeMapPageIndex;
 
 // Determines what happens when two ranges overlap.
 enum class MergeRangeStrategy {
@@ -67,7 +70,10 @@ enum class MergeRangeStrategy {
 template<typename AddressType, typename EntryType>
 class RangeMap {
  public:
-  RangeMap() : merge_strategy_(MergeRangeStrategy::kExclusiveRanges), map_() {}
+  RangeMap()
+      : merge_strategy_(MergeRangeStrategy::kExclusiveRanges),
+        map_(),
+        appended_() {}
 
   void SetMergeStrategy(MergeRangeStrategy strat) { merge_strategy_ = strat; }
 
@@ -81,6 +87,20 @@ class RangeMap {
   bool StoreRange(const AddressType& base, const AddressType& size,
                   const EntryType& entry);
 
+  // Adds a range to those that StoreAppendedRanges will store, returning
+  // false only for a parameter error.  Ranges may be appended in any order.
+  // Until they're stored, lookups don't find them.
+  bool AppendRange(const AddressType& base, const AddressType& size,
+                   const EntryType& entry);
+
+  // Stores the ranges appended since the last call, with the same results
+  // as passing each to StoreRange in the order they were appended.  When
+  // they overlap neither each other nor the ranges already stored, which
+  // is usual for a symbol file's records, that takes one pass over them,
+  // and a sort if they weren't appended in address order, instead of a
+  // search of the map for each range.
+  void StoreAppendedRanges();
+
   // Locates the range encompassing the supplied address.  If there is no such
   // range, returns false.  entry_base, entry_delta, and entry_size, if
   // non-NULL, are set to the base, delta, and size of the entry's range.
@@ -117,6 +137,10 @@ class RangeMap {
   // Returns the number of ranges stored in the RangeMap.
   int GetCount() const;
 
+  // Calls |visitor| with the entry of each range stored, in address order.
+  template<typename Visitor>
+  void VisitEntries(Visitor visitor) const;
+
   // Empties the range map, restoring it to the state it was when it was
   // initially created.
   void Clear();
@@ -125,12 +149,26 @@ class RangeMap {
   // Friend declarations.
   friend class ModuleComparer;
   friend class RangeMapSerializer<AddressType, EntryType>;
+  friend class LineTableSerializer<AddressType, EntryType>;
+  friend class AddressRangeTable<AddressType, EntryType>;
+  friend class RangeMapPageIndex<AddressType, EntryType>;
 
   // Same a StoreRange() with the only exception that the |delta| can be
   // passed in.
   bool StoreRangeInternal(const AddressType& base, const AddressType& delta,
                           const AddressType& size, const EntryType& entry);
 
+  // A range passed to AppendRange, not yet stored.
+  struct AppendedRange {
+    AppendedRange(const AddressType& base, const AddressType& high,
+                  const EntryType& entry)
+        : base(base), high(high), entry(entry) {}
+
+    AddressType base;
+    AddressType high;
+    EntryType entry;
+  };
+
   class Range {
    public:
     Range(const AddressType& base, const AddressType& delta,
@@ -139,7 +177,7 @@ class RangeMap {
 
     AddressType base() const { return base_; }
     AddressType delta() const { return delta_; }
-    EntryType entry() const { return entry_; }
+    const EntryType& entry() const { return entry_; }
 
    private:
     // The base address of the range.  The high address does not need to
@@ -162,6 +200,10 @@ class RangeMap {
 
   // Maps the high address of each range to a EntryType.
   AddressToRangeMap map_;
+
+  // The ranges passed to AppendRange since StoreAppendedRanges was last
+  // called, in the order they were appended.
+  std::vector<AppendedRange> appended_;
 };
 
 
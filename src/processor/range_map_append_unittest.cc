@@ -0,0 +1,201 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// range_map_append_unittest.cc: Unit tests for storing ranges in a RangeMap
+// with AppendRange and StoreAppendedRanges, which must give the same map as
+// storing them one at a time.
+
+#include <stdlib.h>
+
+#include <vector>
+
+#include "processor/range_map-inl.h"
+
+#include "breakpad_googletest_includes.h"
+#include "processor/logging.h"
+
+namespace {
+
+using google_breakpad::MergeRangeStrategy;
+using google_breakpad::RangeMap;
+
+typedef RangeMap<unsigned int, int> TestMap;
+
+struct TestRange {
+  unsigned int base;
+  unsigned int size;
+};
+
+// Expects |expected| and |actual| to hold the same ranges.
+void ExpectSameRanges(const TestMap& expected, const TestMap& actual) {
+  ASSERT_EQ(expected.GetCount(), actual.GetCount());
+  for (int i = 0; i < expected.GetCount(); ++i) {
+    int expected_entry, actual_entry;
+    unsigned int expected_base, actual_base;
+    unsigned int expected_delta, actual_delta;
+    unsigned int expected_size, actual_size;
+    ASSERT_TRUE(expected.RetrieveRangeAtIndex(i, &expected_entry,
+                                              &expected_base, &expected_delta,
+                                              &expected_size));
+    ASSERT_TRUE(actual.RetrieveRangeAtIndex(i, &actual_entry, &actual_base,
+                                            &actual_delta, &actual_size));
+    EXPECT_EQ(expected_entry, actual_entry) << "at index " << i;
+    EXPECT_EQ(expected_base, actual_base) << "at index " << i;
+    EXPECT_EQ(expected_delta, actual_delta) << "at index " << i;
+    EXPECT_EQ(expected_size, actual_size) << "at index " << i;
+  }
+}
+
+// Stores |ranges| in one map with StoreRange and in another by appending
+// them, each map having |stored| already, and expects the same results.
+void CheckAppending(MergeRangeStrategy strategy,
+                    const std::vector<TestRange>& stored,
+                    const std::vector<TestRange>& ranges) {
+  TestMap expected, actual;
+  expected.SetMergeStrategy(strategy);
+  actual.SetMergeStrategy(strategy);
+  for (size_t i = 0; i < stored.size(); ++i) {
+    expected.StoreRange(stored[i].base, stored[i].size, -1 - i);
+    actual.StoreRange(stored[i].base, stored[i].size, -1 - i);
+  }
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    bool valid = ranges[i].size > 0 &&
+                 ranges[i].base + ranges[i].size - 1 >= ranges[i].base;
+    expected.StoreRange(ranges[i].base, ranges[i].size, i);
+    EXPECT_EQ(valid, actual.AppendRange(ranges[i].base, ranges[i].size, i));
+  }
+  actual.StoreAppendedRanges();
+  ExpectSameRanges(expected, actual);
+
+  // Nothing is left to store.
+  actual.StoreAppendedRanges();
+  ExpectSameRanges(expected, actual);
+}
+
+// Returns |count| ranges at random, which overlap often if |sparse| is
+// false, and never if it's true.
+std::vector<TestRange> RandomRanges(int count, bool sparse) {
+  std::vector<TestRange> ranges;
+  for (int i = 0; i < count; ++i) {
+    TestRange range;
+    if (sparse) {
+      range.base = (rand() % (count * 4)) * 16;
+      range.size = 1 + rand() % 16;
+    } else {
+      range.base = rand() % (count * 4);
+      range.size = rand() % 16;
+    }
+    ranges.push_back(range);
+  }
+  if (sparse) {
+    // Drop those at the same base addresses.
+    std::vector<bool> used(count * 4);
+    std::vector<TestRange> unique;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      if (!used[ranges[i].base / 16]) {
+        used[ranges[i].base / 16] = true;
+        unique.push_back(ranges[i]);
+      }
+    }
+    ranges.swap(unique);
+  }
+  return ranges;
+}
+
+const MergeRangeStrategy kStrategies[] = {
+  MergeRangeStrategy::kExclusiveRanges,
+  MergeRangeStrategy::kTruncateLower,
+  MergeRangeStrategy::kTruncateUpper,
+};
+
+TEST(RangeMapAppendTest, InOrder) {
+  std::vector<TestRange> ranges;
+  for (unsigned int i = 0; i < 100; ++i) {
+    TestRange range = { i * 10, 10 };
+    ranges.push_back(range);
+  }
+  for (MergeRangeStrategy strategy : kStrategies)
+    CheckAppending(strategy, std::vector<TestRange>(), ranges);
+}
+
+TEST(RangeMapAppendTest, InvalidRanges) {
+  std::vector<TestRange> ranges;
+  TestRange zero_size = { 10, 0 };
+  TestRange overflow = { 0xfffffff0, 0x20 };
+  TestRange valid = { 20, 5 };
+  ranges.push_back(zero_size);
+  ranges.push_back(overflow);
+  ranges.push_back(valid);
+  for (MergeRangeStrategy strategy : kStrategies)
+    CheckAppending(strategy, std::vector<TestRange>(), ranges);
+}
+
+TEST(RangeMapAppendTest, OutOfOrderDisjoint) {
+  srand(0);
+  for (MergeRangeStrategy strategy : kStrategies) {
+    for (int i = 0; i < 10; ++i)
+      CheckAppending(strategy, std::vector<TestRange>(),
+                     RandomRanges(500, true));
+  }
+}
+
+TEST(RangeMapAppendTest, Overlapping) {
+  srand(0);
+  for (MergeRangeStrategy strategy : kStrategies) {
+    for (int i = 0; i < 10; ++i)
+      CheckAppending(strategy, std::vector<TestRange>(),
+                     RandomRanges(500, false));
+  }
+}
+
+TEST(RangeMapAppendTest, AfterStoredRanges) {
+  srand(0);
+  std::vector<TestRange> stored;
+  TestRange low = { 0, 16 };
+  stored.push_back(low);
+  std::vector<TestRange> ranges;
+  for (unsigned int i = 1; i < 100; ++i) {
+    TestRange range = { i * 16, 16 };
+    ranges.push_back(range);
+  }
+  for (MergeRangeStrategy strategy : kStrategies) {
+    CheckAppending(strategy, stored, ranges);
+    // Overlapping what's stored.
+    CheckAppending(strategy, RandomRanges(200, false),
+                   RandomRanges(200, true));
+    CheckAppending(strategy, RandomRanges(200, true),
+                   RandomRanges(200, true));
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// range_map_page_index-inl.h: RangeMap page table implementation.
+//
+// See range_map_page_index.h for documentation.
+
+#ifndef PROCESSOR_RANGE_MAP_PAGE_INDEX_INL_H__
+#define PROCESSOR_RANGE_MAP_PAGE_INDEX_INL_H__
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "processor/logging.h"
+#include "processor/range_map_page_index.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+const int RangeMapPageIndex<AddressType, EntryType>::kMinPageShift;
+
+template<typename AddressType, typename EntryType>
+const size_t RangeMapPageIndex<AddressType, EntryType>::kMaxPagesPerRange;
+
+template<typename AddressType, typename EntryType>
+RangeMapPageIndex<AddressType, EntryType>::RangeMapPageIndex()
+    : bases_(), ranges_(), pages_(), first_page_(), page_shift_(0) {
+}
+
+template<typename AddressType, typename EntryType>
+void RangeMapPageIndex<AddressType, EntryType>::Build(
+    const RangeMap<AddressType, EntryType>& range_map) {
+  Clear();
+  if (range_map.map_.empty())
+    return;
+
+  bases_.reserve(range_map.map_.size());
+  ranges_.reserve(range_map.map_.size());
+  for (typename RangeMap<AddressType, EntryType>::MapConstIterator iterator =
+           range_map.map_.begin();
+       iterator != range_map.map_.end(); ++iterator) {
+    Range range;
+    range.high = iterator->first;
+    range.entry = &iterator->second.entry();
+    bases_.push_back(iterator->second.base());
+    ranges_.push_back(range);
+  }
+
+  // Ranges based beyond the last page are found through the final entry,
+  // so the pages need only reach the last range's base.
+  first_page_ = bases_.front();
+  AddressType span = bases_.back() - first_page_;
+  page_shift_ = kMinPageShift;
+  const size_t max_pages = bases_.size() * kMaxPagesPerRange;
+  while (page_shift_ < static_cast<int>(sizeof(AddressType) * 8) - 1 &&
+         static_cast<uint64_t>(span >> page_shift_) >= max_pages) {
+    ++page_shift_;
+  }
+
+  size_t page_count = static_cast<size_t>(span >> page_shift_) + 1;
+  pages_.resize(page_count + 1);
+  size_t index = 0;
+  for (size_t page = 0; page < page_count; ++page) {
+    AddressType page_base =
+        first_page_ + (static_cast<AddressType>(page) << page_shift_);
+    while (index < bases_.size() && bases_[index] < page_base)
+      ++index;
+    pages_[page] = static_cast<uint32_t>(index);
+  }
+  pages_[page_count] = static_cast<uint32_t>(bases_.size());
+}
+
+template<typename AddressType, typename EntryType>
+bool RangeMapPageIndex<AddressType, EntryType>::RetrieveNearestRange(
+    const AddressType& address, const EntryType** entry,
+    AddressType* entry_base, AddressType* entry_size) const {
+  BPLOG_IF(ERROR, !entry) << "RangeMapPageIndex::RetrieveNearestRange "
+                             "requires |entry|";
+  assert(entry);
+
+  if (bases_.empty() || address < first_page_)
+    return false;
+
+  // Ranges don't overlap, so the one wanted is the last based at or below
+  // address: one of those based in address's page, or the last before it.
+  size_t page = static_cast<size_t>((address - first_page_) >> page_shift_);
+  size_t begin, end;
+  if (page + 1 < pages_.size()) {
+    begin = pages_[page];
+    end = pages_[page + 1];
+  } else {
+    begin = pages_[pages_.size() - 2];
+    end = bases_.size();
+  }
+  size_t index =
+      std::upper_bound(bases_.begin() + begin, bases_.begin() + end,
+                       address) - bases_.begin();
+  // begin is never 0 unless bases_[0] is in the page, and so at or below
+  // address.
+  assert(index > 0);
+  --index;
+
+  *entry = ranges_[index].entry;
+  if (entry_base)
+    *entry_base = bases_[index];
+  if (entry_size)
+    *entry_size = ranges_[index].high - bases_[index] + 1;
+  return true;
+}
+
+template<typename AddressType, typename EntryType>
+void RangeMapPageIndex<AddressType, EntryType>::Clear() {
+  std::vector<AddressType>().swap(bases_);
+  std::vector<Range>().swap(ranges_);
+  std::vector<uint32_t>().swap(pages_);
+  first_page_ = AddressType();
+  page_shift_ = 0;
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_RANGE_MAP_PAGE_INDEX_INL_H__
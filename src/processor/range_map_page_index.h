@@ -0,0 +1,115 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// range_map_page_index.h: A page table over the ranges of a RangeMap.
+//
+// RangeMap::RetrieveNearestRange searches the whole map on every lookup,
+// which for a module with a million functions is some twenty levels of a
+// tree, each a cache miss.  RangeMapPageIndex divides the addresses the
+// ranges span into pages, and keeps for each page the index of the first
+// range based in it, so that a lookup goes straight to the handful of
+// ranges that can hold an address, and searches those alone.
+//
+// The ranges' base addresses are kept in an array of their own, which
+// is what the search within a page reads, apart from their high
+// addresses and entries, which are only read for the range found.  Pages
+// are 4 KB unless that would take more than a couple of entries per range
+// in the page table, when they're made larger: a module whose functions
+// are spread thinly doesn't need a table many times its size.
+
+#ifndef PROCESSOR_RANGE_MAP_PAGE_INDEX_H__
+#define PROCESSOR_RANGE_MAP_PAGE_INDEX_H__
+
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+#include "processor/range_map.h"
+
+namespace google_breakpad {
+
+template<typename AddressType, typename EntryType>
+class RangeMapPageIndex {
+ public:
+  RangeMapPageIndex();
+
+  // Replaces the contents of the index with the ranges stored in
+  // range_map, which it points to: range_map mustn't change or be destroyed
+  // while the index is in use.  Ranges that were truncated on being stored
+  // are found with their truncated bases.
+  void Build(const RangeMap<AddressType, EntryType>& range_map);
+
+  // Locates the range encompassing the supplied address or, if there is
+  // none, the nearest range below it, as RangeMap::RetrieveNearestRange
+  // does.  Returns false if there is no such range.  entry_base and
+  // entry_size, if non-NULL, are set to the base and size of the range.
+  bool RetrieveNearestRange(const AddressType& address,
+                            const EntryType** entry,
+                            AddressType* entry_base,
+                            AddressType* entry_size) const;
+
+  // Returns the number of ranges in the index.
+  int GetCount() const { return static_cast<int>(bases_.size()); }
+
+  // Returns the bytes the index takes up.
+  size_t MemoryBytes() const {
+    return bases_.capacity() * sizeof(AddressType) +
+        ranges_.capacity() * sizeof(Range) +
+        pages_.capacity() * sizeof(uint32_t);
+  }
+
+  // Empties the index.
+  void Clear();
+
+ private:
+  // The smallest pages, and the most page table entries there may be for
+  // each range before pages are made larger.
+  static const int kMinPageShift = 12;
+  static const size_t kMaxPagesPerRange = 2;
+
+  struct Range {
+    AddressType high;
+    const EntryType* entry;
+  };
+
+  // Each range's base address, in increasing order, and the rest of it.
+  std::vector<AddressType> bases_;
+  std::vector<Range> ranges_;
+
+  // For each page, the index of the first range based in it or above it.
+  // A final entry holds the number of ranges.
+  std::vector<uint32_t> pages_;
+
+  // The address the first page begins at, which is the lowest range's
+  // base, and log2 of the size of each page.
+  AddressType first_page_;
+  int page_shift_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_RANGE_MAP_PAGE_INDEX_H__
@@ -0,0 +1,161 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// range_map_page_index_unittest.cc: Unit tests for RangeMapPageIndex,
+// comparing its lookups with RangeMap::RetrieveNearestRange's.
+
+#include <stdlib.h>
+
+#include "breakpad_googletest_includes.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "processor/range_map-inl.h"
+#include "processor/range_map_page_index-inl.h"
+
+namespace {
+
+using google_breakpad::RangeMap;
+using google_breakpad::RangeMapPageIndex;
+
+typedef RangeMap<uint64_t, int> TestMap;
+typedef RangeMapPageIndex<uint64_t, int> TestIndex;
+
+// Expects |index| to find the same range as |map| for |address|.
+void ExpectSameRange(const TestMap& map, const TestIndex& index,
+                     uint64_t address) {
+  int expected_entry;
+  uint64_t expected_base, expected_size;
+  const int* actual_entry = NULL;
+  uint64_t actual_base, actual_size;
+  bool found = map.RetrieveNearestRange(address, &expected_entry,
+                                        &expected_base, NULL, &expected_size);
+  ASSERT_EQ(found, index.RetrieveNearestRange(address, &actual_entry,
+                                              &actual_base, &actual_size))
+      << "at " << address;
+  if (!found)
+    return;
+  EXPECT_EQ(expected_entry, *actual_entry) << "at " << address;
+  EXPECT_EQ(expected_base, actual_base) << "at " << address;
+  EXPECT_EQ(expected_size, actual_size) << "at " << address;
+}
+
+// Stores |count| ranges at random in |map|, with up to |max_gap| between
+// them, and checks lookups around each range's ends.
+void CheckRandomRanges(int count, uint64_t first_base, uint64_t max_gap) {
+  TestMap map;
+  uint64_t base = first_base;
+  for (int i = 0; i < count; ++i) {
+    uint64_t size = 1 + rand() % 64;
+    ASSERT_TRUE(map.StoreRange(base, size, i));
+    base += size + rand() % (max_gap + 1);
+  }
+  TestIndex index;
+  index.Build(map);
+  ASSERT_EQ(map.GetCount(), index.GetCount());
+
+  for (int i = 0; i < map.GetCount(); ++i) {
+    int entry;
+    uint64_t range_base, range_size;
+    ASSERT_TRUE(map.RetrieveRangeAtIndex(i, &entry, &range_base, NULL,
+                                         &range_size));
+    uint64_t high = range_base + range_size - 1;
+    ExpectSameRange(map, index, range_base - 1);
+    ExpectSameRange(map, index, range_base);
+    ExpectSameRange(map, index, range_base + range_size / 2);
+    ExpectSameRange(map, index, high);
+    ExpectSameRange(map, index, high + 1);
+  }
+  ExpectSameRange(map, index, 0);
+  ExpectSameRange(map, index, base + 0x100000);
+  ExpectSameRange(map, index, ~0ULL);
+}
+
+TEST(RangeMapPageIndexTest, Empty) {
+  TestMap map;
+  TestIndex index;
+  index.Build(map);
+  const int* entry;
+  EXPECT_FALSE(index.RetrieveNearestRange(0, &entry, NULL, NULL));
+  EXPECT_FALSE(index.RetrieveNearestRange(0x1000, &entry, NULL, NULL));
+}
+
+TEST(RangeMapPageIndexTest, SingleRange) {
+  TestMap map;
+  ASSERT_TRUE(map.StoreRange(0x1000, 0x10, 7));
+  TestIndex index;
+  index.Build(map);
+  const int* entry;
+  uint64_t base, size;
+  EXPECT_FALSE(index.RetrieveNearestRange(0xfff, &entry, &base, &size));
+  ASSERT_TRUE(index.RetrieveNearestRange(0x1000, &entry, &base, &size));
+  EXPECT_EQ(7, *entry);
+  EXPECT_EQ(0x1000U, base);
+  EXPECT_EQ(0x10U, size);
+  // The nearest range below.
+  ASSERT_TRUE(index.RetrieveNearestRange(0x5000, &entry, &base, &size));
+  EXPECT_EQ(7, *entry);
+}
+
+TEST(RangeMapPageIndexTest, DenseRanges) {
+  srand(0);
+  // Many ranges to a page.
+  CheckRandomRanges(20000, 0x1000, 4);
+}
+
+TEST(RangeMapPageIndexTest, SparseRanges) {
+  srand(0);
+  // Gaps of up to several pages between ranges.
+  CheckRandomRanges(5000, 0x400000, 0x8000);
+}
+
+TEST(RangeMapPageIndexTest, WidelySpreadRanges) {
+  srand(0);
+  // Ranges far enough apart that pages must be larger than 4 KB, and near
+  // the top of the address space.
+  TestMap map;
+  ASSERT_TRUE(map.StoreRange(0x1000, 0x10, 0));
+  ASSERT_TRUE(map.StoreRange(0x7fffffff00000000ULL, 0x10, 1));
+  ASSERT_TRUE(map.StoreRange(0xfffffffffffff000ULL, 0x1000, 2));
+  TestIndex index;
+  index.Build(map);
+  const uint64_t addresses[] = {
+    0, 0xfff, 0x1000, 0x100f, 0x1010, 0x7ffffffeffffffffULL,
+    0x7fffffff00000000ULL, 0x7fffffff00000010ULL, 0xffffffffffffefffULL,
+    0xfffffffffffff000ULL, ~0ULL
+  };
+  for (uint64_t address : addresses)
+    ExpectSameRange(map, index, address);
+
+  CheckRandomRanges(1000, 0x10000, 1ULL << 40);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,223 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// range_symbol_supplier.cc: A SimpleSymbolSupplier that reads symbol files
+// a byte range at a time.
+//
+// See range_symbol_supplier.h for documentation.
+
+#include "processor/range_symbol_supplier.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "google_breakpad/processor/code_module.h"
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// The footer Module::Write appends to an address index:
+// "INFO INDEX_END <functions begin> <functions end>\n", with both offsets
+// written as 16 hex digits.
+const char kIndexEndPrefix[] = "INFO INDEX_END ";
+const size_t kIndexEndPrefixSize = sizeof(kIndexEndPrefix) - 1;
+const size_t kIndexEndSize = kIndexEndPrefixSize + 16 + 1 + 16 + 1;
+
+// Parses the 16 hex digits at digits into *value.
+bool ParseFixedHex(const char* digits, uint64_t* value) {
+  *value = 0;
+  for (int i = 0; i < 16; ++i) {
+    char c = digits[i];
+    int digit;
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      digit = c - 'a' + 10;
+    else
+      return false;
+    *value = (*value << 4) | digit;
+  }
+  return true;
+}
+
+// Parses footer, the last kIndexEndSize bytes of a symbol file, setting
+// *begin and *end to the offsets of the function records.  Returns false
+// if it isn't an index footer.
+bool ParseIndexEnd(const string& footer, uint64_t* begin, uint64_t* end) {
+  const char* data = footer.data();
+  return footer.size() == kIndexEndSize &&
+         memcmp(data, kIndexEndPrefix, kIndexEndPrefixSize) == 0 &&
+         ParseFixedHex(data + kIndexEndPrefixSize, begin) &&
+         data[kIndexEndPrefixSize + 16] == ' ' &&
+         ParseFixedHex(data + kIndexEndPrefixSize + 17, end) &&
+         data[kIndexEndSize - 1] == '\n';
+}
+
+}  // namespace
+
+RangeSymbolSupplier::~RangeSymbolSupplier() {
+  map<string, char*>::iterator it = memory_buffers_.begin();
+  for (; it != memory_buffers_.end(); ++it)
+    delete [] it->second;
+}
+
+SymbolSupplier::SymbolResult RangeSymbolSupplier::GetSymbolFile(
+    const CodeModule* module, const SystemInfo* system_info,
+    string* symbol_file) {
+  BPLOG_IF(ERROR, !symbol_file) << "RangeSymbolSupplier::GetSymbolFile "
+                                   "requires |symbol_file|";
+  assert(symbol_file);
+  symbol_file->clear();
+
+  string relative_path;
+  if (!module || !GetRelativeSymbolPath(module, &relative_path))
+    return NOT_FOUND;
+
+  string path = root_ + "/" + relative_path + ".sym";
+  uint64_t size;
+  if (!reader_->GetSize(path, &size))
+    return NOT_FOUND;
+  *symbol_file = path;
+  return FOUND;
+}
+
+SymbolSupplier::SymbolResult RangeSymbolSupplier::GetSymbolFile(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    string* symbol_data) {
+  assert(symbol_data);
+  symbol_data->clear();
+
+  string path;
+  SymbolResult s = GetSymbolFile(module, system_info, &path);
+  if (s != FOUND)
+    return s;
+  if (!ReadSymbolData(path, symbol_data))
+    return INTERRUPT;
+  if (symbol_file)
+    *symbol_file = path;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  symbol_files_[module->code_file()] = path;
+  return FOUND;
+}
+
+SymbolSupplier::SymbolResult RangeSymbolSupplier::GetCStringSymbolData(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+  assert(symbol_data);
+  assert(symbol_data_size);
+
+  string symbol_data_string;
+  SymbolResult s = GetSymbolFile(module, system_info, symbol_file,
+                                 &symbol_data_string);
+  if (s != FOUND)
+    return s;
+
+  *symbol_data_size = symbol_data_string.size() + 1;
+  *symbol_data = new char[*symbol_data_size];
+  memcpy(*symbol_data, symbol_data_string.c_str(), *symbol_data_size);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  char*& buffer = memory_buffers_[module->code_file()];
+  delete [] buffer;
+  buffer = *symbol_data;
+  return FOUND;
+}
+
+void RangeSymbolSupplier::FreeSymbolData(const CodeModule* module) {
+  if (!module)
+    return;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  map<string, char*>::iterator it = memory_buffers_.find(module->code_file());
+  if (it != memory_buffers_.end()) {
+    delete [] it->second;
+    memory_buffers_.erase(it);
+  }
+}
+
+bool RangeSymbolSupplier::FetchRecords(const string& module_name,
+                                       uint64_t offset,
+                                       uint64_t length,
+                                       string* records) {
+  string path;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    map<string, string>::const_iterator it = symbol_files_.find(module_name);
+    if (it == symbol_files_.end()) {
+      BPLOG(ERROR) << "No symbol file supplied for module " << module_name;
+      return false;
+    }
+    path = it->second;
+  }
+  return reader_->Read(path, offset, length, records);
+}
+
+bool RangeSymbolSupplier::ReadSymbolData(const string& path,
+                                         string* symbol_data) {
+  symbol_data->clear();
+
+  uint64_t size;
+  if (!reader_->GetSize(path, &size))
+    return false;
+
+  string footer;
+  uint64_t begin, end;
+  if (size >= kIndexEndSize &&
+      reader_->Read(path, size - kIndexEndSize, kIndexEndSize, &footer) &&
+      ParseIndexEnd(footer, &begin, &end) &&
+      begin <= end && end <= size - kIndexEndSize) {
+    string rest;
+    if (!reader_->Read(path, 0, begin, symbol_data) ||
+        !reader_->Read(path, end, size - kIndexEndSize - end, &rest)) {
+      BPLOG(ERROR) << "Could not read symbol file " << path;
+      return false;
+    }
+    symbol_data->append(rest);
+    return true;
+  }
+
+  if (!reader_->Read(path, 0, size, symbol_data)) {
+    BPLOG(ERROR) << "Could not read symbol file " << path;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
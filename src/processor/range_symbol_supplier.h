@@ -0,0 +1,141 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// range_symbol_supplier.h: A SimpleSymbolSupplier that reads symbol files
+// a byte range at a time.
+//
+// RangeSymbolSupplier finds symbol files laid out as SimpleSymbolSupplier
+// describes beneath a single root, which may be a URL, and reads them
+// through a RangeReader, which might issue HTTP range requests.  For a
+// symbol file with an address index, as dump_syms -x writes, it reads only
+// the index's footer and then the parts of the file outside the FUNC
+// records and the records following them: the header, the PUBLIC and STACK
+// records, and the index, which lists every FUNC record again.  That is
+// the symbol data it supplies.  The supplier is then the
+// BasicSourceLineResolver::RecordFetcher from which the resolver fetches a
+// function's LINE and INLINE records the first time it looks up an address
+// in the function, so that processing a minidump reads only the records of
+// the functions on its stacks.  A symbol file without an index is read
+// whole.
+//
+//   RangeSymbolSupplier supplier(&reader, "https://symbols.example.com");
+//   BasicSourceLineResolver resolver(1, &supplier);
+//   MinidumpProcessor processor(&supplier, &resolver);
+//
+// The supplier must outlive the resolver.  The RangeReader may be called
+// from several threads at once, when modules' symbols are prefetched in
+// parallel.
+
+#ifndef PROCESSOR_RANGE_SYMBOL_SUPPLIER_H__
+#define PROCESSOR_RANGE_SYMBOL_SUPPLIER_H__
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace google_breakpad {
+
+class RangeSymbolSupplier : public SimpleSymbolSupplier,
+                            public BasicSourceLineResolver::RecordFetcher {
+ public:
+  // Reads parts of files, by path.
+  class RangeReader {
+   public:
+    virtual ~RangeReader() { }
+
+    // Sets |*size| to the size of the file at |path|.  Returns false if
+    // there is no such file.
+    virtual bool GetSize(const string& path, uint64_t* size) = 0;
+
+    // Places the |length| bytes at |offset| in the file at |path| in
+    // |*data|.  Returns false if they can't be read.
+    virtual bool Read(const string& path,
+                      uint64_t offset,
+                      uint64_t length,
+                      string* data) = 0;
+  };
+
+  // Creates a new RangeSymbolSupplier that reads the symbol files beneath
+  // root through reader, which must outlive it.
+  RangeSymbolSupplier(RangeReader* reader, const string& root)
+      : SimpleSymbolSupplier(root), reader_(reader), root_(root) {}
+
+  virtual ~RangeSymbolSupplier();
+
+  // Returns the path to the symbol file for the given module, if reader
+  // finds it.
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file);
+
+  // Reads the symbol data for the given module, as described above.
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file,
+                                     string* symbol_data);
+
+  virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
+                                            const SystemInfo* system_info,
+                                            string* symbol_file,
+                                            char** symbol_data,
+                                            size_t* symbol_data_size);
+
+  virtual void FreeSymbolData(const CodeModule* module);
+
+  // Reads records from the symbol file supplied for the module named
+  // module_name.
+  virtual bool FetchRecords(const string& module_name,
+                            uint64_t offset,
+                            uint64_t length,
+                            string* records);
+
+ private:
+  // Reads the symbol data of the file at path into symbol_data, leaving
+  // out the function records if the file has an address index.  Returns
+  // false if the file can't be read.
+  bool ReadSymbolData(const string& path, string* symbol_data);
+
+  RangeReader* reader_;
+  string root_;
+
+  // The symbol file supplied for each module and the data buffers handed
+  // out, keyed by module code_file, and the mutex guarding them.
+  map<string, string> symbol_files_;
+  map<string, char*> memory_buffers_;
+  std::mutex mutex_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_RANGE_SYMBOL_SUPPLIER_H__
@@ -0,0 +1,223 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// range_symbol_supplier_unittest.cc: Unit tests for RangeSymbolSupplier.
+
+#include <stdio.h>
+
+#include <map>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+#include "processor/range_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::RangeSymbolSupplier;
+using google_breakpad::StackFrame;
+using google_breakpad::SymbolSupplier;
+
+// A RangeReader over files held in memory, which counts the bytes read.
+class FakeRangeReader : public RangeSymbolSupplier::RangeReader {
+ public:
+  FakeRangeReader() : bytes_read_(0) {}
+
+  virtual bool GetSize(const string& path, uint64_t* size) {
+    std::map<string, string>::const_iterator it = files_.find(path);
+    if (it == files_.end())
+      return false;
+    *size = it->second.size();
+    return true;
+  }
+
+  virtual bool Read(const string& path,
+                    uint64_t offset,
+                    uint64_t length,
+                    string* data) {
+    std::map<string, string>::const_iterator it = files_.find(path);
+    if (it == files_.end() || offset > it->second.size() ||
+        length > it->second.size() - offset)
+      return false;
+    data->assign(it->second, offset, length);
+    bytes_read_ += length;
+    return true;
+  }
+
+  std::map<string, string> files_;
+  uint64_t bytes_read_;
+};
+
+const char kHeader[] =
+    "MODULE windows x86 ABCDEF0123456789ABCDEF01234567891 module1.pdb\n"
+    "FILE 0 file1.cc\n";
+const char kFunction1[] = "FUNC 1000 10 0 Function1";
+const char kRecords1[] = "1000 8 10 0\n1008 8 11 0\n";
+const char kFunction2[] = "FUNC 2000 8 0 Function2";
+const char kRecords2[] = "2000 8 20 0\n";
+const char kTrailer[] = "PUBLIC 3000 0 Public1\n";
+
+// Returns the symbol file above, with an address index if index is true,
+// laid out as Module::Write would lay it out.
+string SymbolFile(bool index) {
+  string file = kHeader;
+  uint64_t functions_begin = file.size();
+  file += string(kFunction1) + "\n";
+  uint64_t records1 = file.size();
+  file += kRecords1;
+  file += string(kFunction2) + "\n";
+  uint64_t records2 = file.size();
+  file += kRecords2;
+  uint64_t functions_end = file.size();
+  file += kTrailer;
+  if (!index)
+    return file;
+
+  char buffer[100];
+  snprintf(buffer, sizeof(buffer), "INFO INDEX %llx %llx ",
+           static_cast<unsigned long long>(records1),
+           static_cast<unsigned long long>(sizeof(kRecords1) - 1));
+  file += string(buffer) + kFunction1 + "\n";
+  snprintf(buffer, sizeof(buffer), "INFO INDEX %llx %llx ",
+           static_cast<unsigned long long>(records2),
+           static_cast<unsigned long long>(sizeof(kRecords2) - 1));
+  file += string(buffer) + kFunction2 + "\n";
+  snprintf(buffer, sizeof(buffer), "INFO INDEX_END %016llx %016llx\n",
+           static_cast<unsigned long long>(functions_begin),
+           static_cast<unsigned long long>(functions_end));
+  file += buffer;
+  return file;
+}
+
+class RangeSymbolSupplierTest : public ::testing::Test {
+ public:
+  RangeSymbolSupplierTest()
+      : module_(0x1000, 0xb000, "module1.dll", "", "module1.pdb",
+                "ABCDEF0123456789ABCDEF01234567891", ""),
+        root_("https://symbols.example.com"),
+        symbol_file_(root_ +
+                     "/module1.pdb/ABCDEF0123456789ABCDEF01234567891/"
+                     "module1.sym") {}
+
+  // Loads the module from supplier into resolver.
+  void Load(RangeSymbolSupplier* supplier, BasicSourceLineResolver* resolver) {
+    string symbol_file;
+    char* symbol_data = NULL;
+    size_t symbol_data_size = 0;
+    ASSERT_EQ(SymbolSupplier::FOUND,
+              supplier->GetCStringSymbolData(&module_, NULL, &symbol_file,
+                                             &symbol_data,
+                                             &symbol_data_size));
+    EXPECT_EQ(symbol_file_, symbol_file);
+    ASSERT_TRUE(resolver->LoadModuleUsingMemoryBuffer(&module_, symbol_data,
+                                                      symbol_data_size));
+    EXPECT_FALSE(resolver->IsModuleCorrupt(&module_));
+  }
+
+  // Checks that resolver resolves the module-relative address to function
+  // and line.
+  void CheckLookup(BasicSourceLineResolver* resolver, uint64_t address,
+                   const string& function, int line) {
+    StackFrame frame;
+    frame.instruction = module_.base_address() + address;
+    frame.module = &module_;
+    resolver->FillSourceLineInfo(&frame, NULL);
+    EXPECT_EQ(function, frame.function_name);
+    EXPECT_EQ(line, frame.source_line);
+    if (line)
+      EXPECT_EQ("file1.cc", frame.source_file_name);
+  }
+
+  BasicCodeModule module_;
+  string root_;
+  string symbol_file_;
+  FakeRangeReader reader_;
+};
+
+TEST_F(RangeSymbolSupplierTest, ReadsOnlyTheRecordsLookedUp) {
+  reader_.files_[symbol_file_] = SymbolFile(true);
+  RangeSymbolSupplier supplier(&reader_, root_);
+  BasicSourceLineResolver resolver(1, &supplier);
+  Load(&supplier, &resolver);
+
+  // Only the function records are left out.
+  uint64_t skeleton_size = reader_.bytes_read_;
+  EXPECT_EQ(SymbolFile(true).size() - SymbolFile(false).size() +
+            sizeof(kHeader) - 1 + sizeof(kTrailer) - 1,
+            skeleton_size);
+
+  CheckLookup(&resolver, 0x2006, "Function2", 20);
+  EXPECT_EQ(skeleton_size + sizeof(kRecords2) - 1, reader_.bytes_read_);
+  CheckLookup(&resolver, 0x2002, "Function2", 20);
+  EXPECT_EQ(skeleton_size + sizeof(kRecords2) - 1, reader_.bytes_read_);
+
+  CheckLookup(&resolver, 0x100c, "Function1", 11);
+  CheckLookup(&resolver, 0x3000, "Public1", 0);
+}
+
+TEST_F(RangeSymbolSupplierTest, ReadsUnindexedFileWhole) {
+  reader_.files_[symbol_file_] = SymbolFile(false);
+  RangeSymbolSupplier supplier(&reader_, root_);
+  BasicSourceLineResolver resolver(1, &supplier);
+  Load(&supplier, &resolver);
+  CheckLookup(&resolver, 0x1002, "Function1", 10);
+  CheckLookup(&resolver, 0x2004, "Function2", 20);
+}
+
+TEST_F(RangeSymbolSupplierTest, IndexedFileLoadsWithoutFetcher) {
+  // Resolvers without a fetcher ignore the index.
+  string file = SymbolFile(true);
+  BasicSourceLineResolver resolver;
+  ASSERT_TRUE(resolver.LoadModuleUsingMapBuffer(&module_, file));
+  CheckLookup(&resolver, 0x1002, "Function1", 10);
+  CheckLookup(&resolver, 0x2004, "Function2", 20);
+}
+
+TEST_F(RangeSymbolSupplierTest, MissingSymbols) {
+  RangeSymbolSupplier supplier(&reader_, root_);
+  string symbol_file;
+  char* symbol_data = NULL;
+  size_t symbol_data_size = 0;
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetCStringSymbolData(&module_, NULL, &symbol_file,
+                                          &symbol_data, &symbol_data_size));
+  EXPECT_TRUE(symbol_file.empty());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
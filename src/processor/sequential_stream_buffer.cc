@@ -0,0 +1,110 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// sequential_stream_buffer.cc: A std::streambuf that makes a source which
+// can only be read in order look like a seekable stream.
+//
+// See sequential_stream_buffer.h for documentation.
+
+#include "processor/sequential_stream_buffer.h"
+
+#include <limits>
+
+namespace google_breakpad {
+
+namespace {
+
+// How much to read from the source at a time.
+const size_t kReadSize = 64 * 1024;
+
+}  // namespace
+
+SequentialStreamBuffer::SequentialStreamBuffer(std::istream* source)
+    : source_(source),
+      source_ended_(false) {
+}
+
+SequentialStreamBuffer::int_type SequentialStreamBuffer::underflow() {
+  size_t position = gptr() - eback();
+  if (!FillTo(position + 1))
+    return traits_type::eof();
+  SetPosition(position);
+  return traits_type::to_int_type(*gptr());
+}
+
+SequentialStreamBuffer::pos_type SequentialStreamBuffer::seekoff(
+    off_type offset,
+    std::ios_base::seekdir direction,
+    std::ios_base::openmode which) {
+  const pos_type failed = pos_type(off_type(-1));
+  if (!(which & std::ios_base::in))
+    return failed;
+
+  off_type base = 0;
+  if (direction == std::ios_base::cur) {
+    base = gptr() - eback();
+  } else if (direction == std::ios_base::end) {
+    FillTo(std::numeric_limits<size_t>::max());
+    base = buffer_.size();
+  }
+  if (offset < -base)
+    return failed;
+  size_t position = base + offset;
+  if (!FillTo(position))
+    return failed;
+  SetPosition(position);
+  return pos_type(off_type(position));
+}
+
+SequentialStreamBuffer::pos_type SequentialStreamBuffer::seekpos(
+    pos_type position,
+    std::ios_base::openmode which) {
+  return seekoff(off_type(position), std::ios_base::beg, which);
+}
+
+bool SequentialStreamBuffer::FillTo(size_t size) {
+  size_t position = gptr() - eback();
+  while (buffer_.size() < size && !source_ended_) {
+    size_t buffered = buffer_.size();
+    buffer_.resize(buffered + kReadSize);
+    source_->read(&buffer_[buffered], kReadSize);
+    buffer_.resize(buffered + source_->gcount());
+    source_ended_ = !source_->good();
+  }
+  // Growing the buffer may have moved it.
+  SetPosition(position);
+  return buffer_.size() >= size;
+}
+
+void SequentialStreamBuffer::SetPosition(size_t position) {
+  char* data = buffer_.empty() ? NULL : &buffer_[0];
+  setg(data, data + position, data + buffer_.size());
+}
+
+}  // namespace google_breakpad
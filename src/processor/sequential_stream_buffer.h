@@ -0,0 +1,89 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// sequential_stream_buffer.h: A std::streambuf that makes a source which
+// can only be read in order, such as a pipe or a network upload, look like
+// a seekable stream.
+//
+// Minidump reads through a std::istream, seeking to each stream and to the
+// data the streams refer to.  Wrapping a sequential source in a
+// SequentialStreamBuffer lets a minidump be processed straight from it,
+// without first writing it to a file or reading it entirely into memory:
+// the source is only read as far as the minidump has been read, and seeks
+// forward read ahead to the new position.  Because any part of a minidump
+// may refer back to data before it, everything read from the source is
+// kept for seeks backward, so the buffer grows to the furthest position
+// read, which is at most the minidump's size.
+
+#ifndef PROCESSOR_SEQUENTIAL_STREAM_BUFFER_H__
+#define PROCESSOR_SEQUENTIAL_STREAM_BUFFER_H__
+
+#include <stddef.h>
+
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+namespace google_breakpad {
+
+class SequentialStreamBuffer : public std::streambuf {
+ public:
+  // Reads from |source|, which must outlive the buffer, only ever in order.
+  explicit SequentialStreamBuffer(std::istream* source);
+
+  // Returns the number of bytes read from the source so far.
+  size_t buffered_size() const { return buffer_.size(); }
+
+ protected:
+  int_type underflow() override;
+  pos_type seekoff(off_type offset,
+                   std::ios_base::seekdir direction,
+                   std::ios_base::openmode which) override;
+  pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+
+ private:
+  // Reads from the source until at least |size| bytes are buffered, or
+  // the source ends.  Returns true if |size| bytes are buffered.
+  bool FillTo(size_t size);
+
+  // Points the get area at all buffered bytes, positioned at |position|.
+  void SetPosition(size_t position);
+
+  std::istream* source_;
+
+  // Everything read from the source so far.
+  std::vector<char> buffer_;
+
+  // True once the source has no more to read.
+  bool source_ended_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SEQUENTIAL_STREAM_BUFFER_H__
@@ -0,0 +1,181 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// sequential_stream_buffer_unittest.cc: Unit tests for
+// SequentialStreamBuffer.
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <streambuf>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/minidump.h"
+#include "processor/sequential_stream_buffer.h"
+
+namespace {
+
+using google_breakpad::Minidump;
+using google_breakpad::MinidumpModuleList;
+using google_breakpad::SequentialStreamBuffer;
+
+// A source that serves |contents| a few bytes at a time and can't seek,
+// as a pipe would.
+class PipeBuffer : public std::streambuf {
+ public:
+  explicit PipeBuffer(const string& contents)
+      : contents_(contents), served_(0) {}
+
+ protected:
+  int_type underflow() override {
+    if (served_ == contents_.size())
+      return traits_type::eof();
+    size_t size = std::min(contents_.size() - served_, static_cast<size_t>(7));
+    char* data = &contents_[served_];
+    setg(data, data, data + size);
+    served_ += size;
+    return traits_type::to_int_type(*data);
+  }
+
+ private:
+  string contents_;
+  size_t served_;
+};
+
+class SequentialStreamBufferTest : public ::testing::Test {
+ public:
+  SequentialStreamBufferTest()
+      : pipe_buffer_(Contents()),
+        pipe_(&pipe_buffer_),
+        buffer_(&pipe_),
+        stream_(&buffer_) {}
+
+  static string Contents() {
+    string contents;
+    for (int i = 0; i < 200000; ++i)
+      contents.push_back(static_cast<char>(i * 7 + i / 256));
+    return contents;
+  }
+
+  PipeBuffer pipe_buffer_;
+  std::istream pipe_;
+  SequentialStreamBuffer buffer_;
+  std::istream stream_;
+};
+
+TEST_F(SequentialStreamBufferTest, ReadsInOrder) {
+  string contents = Contents();
+  string read(contents.size(), '\0');
+  ASSERT_TRUE(stream_.read(&read[0], 1000));
+  ASSERT_TRUE(stream_.read(&read[1000], read.size() - 1000));
+  EXPECT_EQ(contents, read);
+  EXPECT_EQ(contents.size(), buffer_.buffered_size());
+
+  char c;
+  EXPECT_FALSE(stream_.read(&c, 1));
+  EXPECT_EQ(0, stream_.gcount());
+}
+
+TEST_F(SequentialStreamBufferTest, ReadsOnlyAsFarAsNeeded) {
+  char c;
+  ASSERT_TRUE(stream_.read(&c, 1));
+  EXPECT_EQ(Contents()[0], c);
+  EXPECT_GT(Contents().size(), buffer_.buffered_size());
+}
+
+TEST_F(SequentialStreamBufferTest, Seeks) {
+  string contents = Contents();
+  char bytes[4];
+
+  // Forward, reading ahead.
+  ASSERT_TRUE(stream_.seekg(150000));
+  ASSERT_TRUE(stream_.read(bytes, sizeof(bytes)));
+  EXPECT_EQ(contents.substr(150000, 4), string(bytes, sizeof(bytes)));
+  EXPECT_EQ(150004, stream_.tellg());
+
+  // Backward, into what's already been read.
+  ASSERT_TRUE(stream_.seekg(10));
+  ASSERT_TRUE(stream_.read(bytes, sizeof(bytes)));
+  EXPECT_EQ(contents.substr(10, 4), string(bytes, sizeof(bytes)));
+
+  // Relative to the current position and to the end.
+  ASSERT_TRUE(stream_.seekg(-2, std::ios_base::cur));
+  EXPECT_EQ(12, stream_.tellg());
+  ASSERT_TRUE(stream_.seekg(-4, std::ios_base::end));
+  ASSERT_TRUE(stream_.read(bytes, sizeof(bytes)));
+  EXPECT_EQ(contents.substr(contents.size() - 4), string(bytes, 4));
+  EXPECT_EQ(contents.size(), buffer_.buffered_size());
+}
+
+TEST_F(SequentialStreamBufferTest, SeeksOutOfRangeFail) {
+  EXPECT_FALSE(stream_.seekg(Contents().size() + 1));
+  stream_.clear();
+  EXPECT_FALSE(stream_.seekg(-1, std::ios_base::beg));
+  stream_.clear();
+
+  // Seeking to the very end is fine, though there's nothing there to read.
+  ASSERT_TRUE(stream_.seekg(Contents().size()));
+  char c;
+  EXPECT_FALSE(stream_.read(&c, 1));
+}
+
+TEST(SequentialStreamBufferMinidumpTest, ReadsMinidump) {
+  string minidump_file = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+      "/src/processor/testdata/minidump2.dmp";
+  std::ifstream file(minidump_file.c_str(), std::ios::in | std::ios::binary);
+  ASSERT_TRUE(file.is_open());
+  string contents((std::istreambuf_iterator<char>(file)),
+                  std::istreambuf_iterator<char>());
+  PipeBuffer pipe_buffer(contents);
+  std::istream pipe(&pipe_buffer);
+  SequentialStreamBuffer buffer(&pipe);
+  std::istream stream(&buffer);
+
+  Minidump minidump(stream);
+  ASSERT_TRUE(minidump.Read());
+  MinidumpModuleList* module_list = minidump.GetModuleList();
+  ASSERT_TRUE(module_list != NULL);
+  ASSERT_LT(0U, module_list->module_count());
+  EXPECT_EQ("c:\\test_app.exe",
+            module_list->GetModuleAtIndex(0)->code_file());
+  EXPECT_EQ("5A9832E5287241C1838ED98914E9B7FF1",
+            module_list->GetModuleAtIndex(0)->debug_identifier());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
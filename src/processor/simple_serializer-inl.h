@@ -123,12 +123,12 @@ class SimpleSerializer<BasicSourceLineResolver::InlineOrigin> {
   static size_t SizeOf(const InlineOrigin& origin) {
     return SimpleSerializer<bool>::SizeOf(origin.has_file_id) +
            SimpleSerializer<int32_t>::SizeOf(origin.source_file_id) +
-           SimpleSerializer<string>::SizeOf(origin.name);
+           SimpleSerializer<const char*>::SizeOf(origin.name);
   }
   static char* Write(const InlineOrigin& origin, char* dest) {
     dest = SimpleSerializer<bool>::Write(origin.has_file_id, dest);
     dest = SimpleSerializer<int32_t>::Write(origin.source_file_id, dest);
-    dest = SimpleSerializer<string>::Write(origin.name, dest);
+    dest = SimpleSerializer<const char*>::Write(origin.name, dest);
     return dest;
   }
 };
@@ -139,13 +139,13 @@ class SimpleSerializer<BasicSourceLineResolver::PublicSymbol> {
   typedef BasicSourceLineResolver::PublicSymbol PublicSymbol;
  public:
   static size_t SizeOf(const PublicSymbol& pubsymbol) {
-    return SimpleSerializer<string>::SizeOf(pubsymbol.name)
+    return SimpleSerializer<const char*>::SizeOf(pubsymbol.name)
          + SimpleSerializer<MemAddr>::SizeOf(pubsymbol.address)
          + SimpleSerializer<int32_t>::SizeOf(pubsymbol.parameter_size)
          + SimpleSerializer<bool>::SizeOf(pubsymbol.is_multiple);
   }
   static char* Write(const PublicSymbol& pubsymbol, char* dest) {
-    dest = SimpleSerializer<string>::Write(pubsymbol.name, dest);
+    dest = SimpleSerializer<const char*>::Write(pubsymbol.name, dest);
     dest = SimpleSerializer<MemAddr>::Write(pubsymbol.address, dest);
     dest = SimpleSerializer<int32_t>::Write(pubsymbol.parameter_size, dest);
     dest = SimpleSerializer<bool>::Write(pubsymbol.is_multiple, dest);
@@ -286,7 +286,7 @@ class SimpleSerializer<BasicSourceLineResolver::Function> {
  public:
   static size_t SizeOf(const Function& func) {
     unsigned int size = 0;
-    size += SimpleSerializer<string>::SizeOf(func.name);
+    size += SimpleSerializer<const char*>::SizeOf(func.name);
     size += SimpleSerializer<MemAddr>::SizeOf(func.address);
     size += SimpleSerializer<MemAddr>::SizeOf(func.size);
     size += SimpleSerializer<int32_t>::SizeOf(func.parameter_size);
@@ -295,12 +295,12 @@ class SimpleSerializer<BasicSourceLineResolver::Function> {
     // we know where to start de-serialize func.lines.
     size += sizeof(int32_t);
     size += inline_range_map_serializer_.SizeOf(&func.inlines);
-    size += range_map_serializer_.SizeOf(func.lines);
+    size += line_table_serializer_.SizeOf(func.lines);
     return size;
   }
 
   static char* Write(const Function& func, char* dest) {
-    dest = SimpleSerializer<string>::Write(func.name, dest);
+    dest = SimpleSerializer<const char*>::Write(func.name, dest);
     dest = SimpleSerializer<MemAddr>::Write(func.address, dest);
     dest = SimpleSerializer<MemAddr>::Write(func.size, dest);
     dest = SimpleSerializer<int32_t>::Write(func.parameter_size, dest);
@@ -312,12 +312,12 @@ class SimpleSerializer<BasicSourceLineResolver::Function> {
     // field itself.
     SimpleSerializer<MemAddr>::Write(dest - old_dest - sizeof(int32_t),
                                      old_dest);
-    dest = range_map_serializer_.Write(func.lines, dest);
+    dest = line_table_serializer_.Write(func.lines, dest);
     return dest;
   }
  private:
   // This static member is defined in module_serializer.cc.
-  static RangeMapSerializer<MemAddr, linked_ptr<Line>> range_map_serializer_;
+  static LineTableSerializer<MemAddr, Line> line_table_serializer_;
   static ContainedRangeMapSerializer<MemAddr, linked_ptr<Inline>>
       inline_range_map_serializer_;
 };
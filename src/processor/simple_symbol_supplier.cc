@@ -36,7 +36,6 @@
 #include "processor/simple_symbol_supplier.h"
 
 #include <assert.h>
-#include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -46,9 +45,12 @@
 
 #include "common/using_std_string.h"
 #include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/source_line_resolver_base.h"
 #include "google_breakpad/processor/system_info.h"
+#include "processor/compressed_symbol_file.h"
 #include "processor/logging.h"
 #include "processor/pathname_stripper.h"
+#include "processor/symbol_path_cache.h"
 
 namespace google_breakpad {
 
@@ -86,7 +88,20 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFile(
 
   SymbolSupplier::SymbolResult s = GetSymbolFile(module, system_info,
                                                  symbol_file);
-  if (s == FOUND) {
+  if (s != FOUND)
+    return s;
+
+  SymbolFileCompression compression = GetSymbolFileCompression(*symbol_file);
+  if (compression != SYMBOL_FILE_UNCOMPRESSED) {
+    char* data;
+    size_t data_size;
+    if (!ReadCompressedSymbolFile(*symbol_file, compression,
+                                  &data, &data_size)) {
+      return INTERRUPT;
+    }
+    symbol_data->assign(data, data_size - 1);
+    delete [] data;
+  } else {
     std::ifstream in(symbol_file->c_str());
     std::getline(in, *symbol_data, string::traits_type::to_char_type(
                      string::traits_type::eof()));
@@ -104,21 +119,35 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetCStringSymbolData(
   assert(symbol_data);
   assert(symbol_data_size);
 
-  string symbol_data_string;
   SymbolSupplier::SymbolResult s =
-      GetSymbolFile(module, system_info, symbol_file, &symbol_data_string);
+      GetSymbolFile(module, system_info, symbol_file);
 
   if (s == FOUND) {
-    *symbol_data_size = symbol_data_string.size() + 1;
-    *symbol_data = new char[*symbol_data_size];
-    if (*symbol_data == NULL) {
-      BPLOG(ERROR) << "Memory allocation for size " << *symbol_data_size
-                   << " failed";
+    // Read the file straight into the buffer the resolver gets, with the
+    // null terminator it expects, rather than through a string.
+    // Compressed files are decompressed into the buffer as they are read.
+    SymbolFileCompression compression = GetSymbolFileCompression(*symbol_file);
+    MemoryBuffer buffer;
+    buffer.mapped = use_mmap_ && compression == SYMBOL_FILE_UNCOMPRESSED;
+    bool loaded;
+    if (compression != SYMBOL_FILE_UNCOMPRESSED) {
+      loaded = ReadCompressedSymbolFile(*symbol_file, compression,
+                                        &buffer.data, &buffer.size);
+    } else if (use_mmap_) {
+      loaded = SourceLineResolverBase::MapSymbolFileForParsing(
+          *symbol_file, &buffer.data, &buffer.size);
+    } else {
+      loaded = SourceLineResolverBase::ReadSymbolFile(
+          *symbol_file, &buffer.data, &buffer.size);
+    }
+    if (!loaded) {
+      BPLOG(ERROR) << "Could not load symbol data from " << *symbol_file;
       return INTERRUPT;
     }
-    memcpy(*symbol_data, symbol_data_string.c_str(), symbol_data_string.size());
-    (*symbol_data)[symbol_data_string.size()] = '\0';
-    memory_buffers_.insert(make_pair(module->code_file(), *symbol_data));
+    *symbol_data = buffer.data;
+    *symbol_data_size = buffer.size;
+    std::lock_guard<std::mutex> lock(memory_buffers_mutex_);
+    memory_buffers_.insert(make_pair(module->code_file(), buffer));
   }
   return s;
 }
@@ -129,13 +158,20 @@ void SimpleSymbolSupplier::FreeSymbolData(const CodeModule* module) {
     return;
   }
 
-  map<string, char*>::iterator it = memory_buffers_.find(module->code_file());
+  std::lock_guard<std::mutex> lock(memory_buffers_mutex_);
+  map<string, MemoryBuffer>::iterator it =
+      memory_buffers_.find(module->code_file());
   if (it == memory_buffers_.end()) {
     BPLOG(INFO) << "Cannot find symbol data buffer for module "
                 << module->code_file();
     return;
   }
-  delete [] it->second;
+  if (it->second.mapped) {
+    SourceLineResolverBase::UnmapSymbolFile(it->second.data,
+                                            it->second.size);
+  } else {
+    delete [] it->second.data;
+  }
   memory_buffers_.erase(it);
 }
 
@@ -147,20 +183,76 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFileAtPathFromRoot(
   assert(symbol_file);
   symbol_file->clear();
 
-  if (!module)
+  string relative_path;
+  if (!GetRelativeSymbolPath(module, &relative_path))
     return NOT_FOUND;
 
-  // Start with the base path.
-  string path = root_path;
+  // Prefer an uncompressed symbol file, then a compressed one this build
+  // can read.
+  static const struct {
+    const char* suffix;
+    SymbolFileCompression compression;
+  } kSymbolFileSuffixes[] = {
+    { ".sym", SYMBOL_FILE_UNCOMPRESSED },
+    { ".sym.gz", SYMBOL_FILE_GZIP },
+    { ".sym.zst", SYMBOL_FILE_ZSTD },
+  };
+  string base = root_path + "/" + relative_path;
+  for (size_t i = 0;
+       i < sizeof(kSymbolFileSuffixes) / sizeof(kSymbolFileSuffixes[0]);
+       ++i) {
+    if (!IsSymbolFileCompressionSupported(kSymbolFileSuffixes[i].compression))
+      continue;
+    string path = base + kSymbolFileSuffixes[i].suffix;
+    if (path_cache_ ? path_cache_->FileExists(path) : file_exists(path)) {
+      *symbol_file = path;
+      return FOUND;
+    }
+  }
 
-  // Append the debug (pdb) file name as a directory name.
-  path.append("/");
+  BPLOG(INFO) << "No symbol file at " << base << ".sym";
+  return NOT_FOUND;
+}
+
+SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetBinaryFile(
+    const CodeModule* module, const SystemInfo* system_info,
+    string* binary_file) {
+  assert(binary_file);
+  binary_file->clear();
+
+  string relative_path;
+  if (!GetRelativeSymbolPath(module, &relative_path))
+    return NOT_FOUND;
+  string code_file_name = PathnameStripper::File(module->code_file());
+  if (code_file_name.empty())
+    return NOT_FOUND;
+  relative_path = relative_path.substr(0, relative_path.rfind('/') + 1) +
+                  code_file_name;
+
+  for (unsigned int path_index = 0; path_index < paths_.size(); ++path_index) {
+    string path = paths_[path_index] + "/" + relative_path;
+    if (path_cache_ ? path_cache_->FileExists(path) : file_exists(path)) {
+      *binary_file = path;
+      return FOUND;
+    }
+  }
+  return NOT_FOUND;
+}
+
+bool SimpleSymbolSupplier::GetRelativeSymbolPath(const CodeModule* module,
+                                                 string* relative_path) {
+  relative_path->clear();
+  if (!module)
+    return false;
+
+  // Start with the debug (pdb) file name as a directory name.
+  string path;
   string debug_file_name = PathnameStripper::File(module->debug_file());
   if (debug_file_name.empty()) {
     BPLOG(ERROR) << "Can't construct symbol file path without debug_file "
                     "(code_file = " <<
                     PathnameStripper::File(module->code_file()) << ")";
-    return NOT_FOUND;
+    return false;
   }
   path.append(debug_file_name);
 
@@ -172,13 +264,13 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFileAtPathFromRoot(
                     "(code_file = " <<
                     PathnameStripper::File(module->code_file()) <<
                     ", debug_file = " << debug_file_name << ")";
-    return NOT_FOUND;
+    return false;
   }
   path.append(identifier);
 
-  // Transform the debug file name into one ending in .sym.  If the existing
-  // name ends in .pdb, strip the .pdb.  Otherwise, add .sym to the non-.pdb
-  // name.
+  // Transform the debug file name into the symbol file name.  If the
+  // existing name ends in .pdb, strip the .pdb.  The caller adds the .sym
+  // extension.
   path.append("/");
   string debug_file_extension;
   if (debug_file_name.size() > 4)
@@ -190,15 +282,9 @@ SymbolSupplier::SymbolResult SimpleSymbolSupplier::GetSymbolFileAtPathFromRoot(
   } else {
     path.append(debug_file_name);
   }
-  path.append(".sym");
-
-  if (!file_exists(path)) {
-    BPLOG(INFO) << "No symbol file at " << path;
-    return NOT_FOUND;
-  }
 
-  *symbol_file = path;
-  return FOUND;
+  *relative_path = path;
+  return true;
 }
 
 }  // namespace google_breakpad
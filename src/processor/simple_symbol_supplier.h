@@ -65,6 +65,16 @@
 // SimpleSymbolSupplier will iterate over all root paths searching for
 // a symbol file existing in that path.
 //
+// Binaries may be kept beside the symbol files, named as the module's code
+// file is without its directory, for example
+// symbols/libfoo.so/<identifier>/libfoo.so next to
+// symbols/libfoo.so/<identifier>/libfoo.so.sym.
+//
+// A symbol file may also be compressed with gzip or zstd and named with a
+// further .gz or .zst extension, as in test_app.sym.gz, when the build
+// supports that compression.  An uncompressed file is preferred when both
+// exist.  Compressed files are decompressed as they are read.
+//
 // SimpleSymbolSupplier supports any debugging file which can be identified
 // by a CodeModule object's debug_file and debug_identifier accessors.  The
 // expected ultimate source of these CodeModule objects are MinidumpModule
@@ -77,6 +87,7 @@
 #define PROCESSOR_SIMPLE_SYMBOL_SUPPLIER_H__
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -89,19 +100,35 @@ using std::map;
 using std::vector;
 
 class CodeModule;
+class SymbolPathCache;
 
 class SimpleSymbolSupplier : public SymbolSupplier {
  public:
   // Creates a new SimpleSymbolSupplier, using path as the root path where
   // symbols are stored.
-  explicit SimpleSymbolSupplier(const string& path) : paths_(1, path) {}
+  explicit SimpleSymbolSupplier(const string& path)
+      : paths_(1, path), use_mmap_(false), path_cache_(NULL) {}
 
   // Creates a new SimpleSymbolSupplier, using paths as a list of root
   // paths where symbols may be stored.
-  explicit SimpleSymbolSupplier(const vector<string>& paths) : paths_(paths) {}
+  explicit SimpleSymbolSupplier(const vector<string>& paths)
+      : paths_(paths), use_mmap_(false), path_cache_(NULL) {}
 
   virtual ~SimpleSymbolSupplier() {}
 
+  // Memory-maps symbol files copy-on-write for GetCStringSymbolData rather
+  // than reading them into the heap, so that a large symbol file is paged
+  // in as the resolver parses it instead of being read up front.
+  void set_use_mmap(bool use_mmap) { use_mmap_ = use_mmap; }
+
+  // Checks for symbol files through |path_cache|, which remembers what it
+  // finds and may be shared with other suppliers, or directly if
+  // |path_cache| is NULL, the default (see symbol_path_cache.h).  The
+  // cache must outlive the supplier.
+  void set_path_cache(SymbolPathCache* path_cache) {
+    path_cache_ = path_cache;
+  }
+
   // Returns the path to the symbol file for the given module.  See the
   // description above.
   virtual SymbolResult GetSymbolFile(const CodeModule* module,
@@ -113,7 +140,8 @@ class SimpleSymbolSupplier : public SymbolSupplier {
                                      string* symbol_file,
                                      string* symbol_data);
 
-  // Allocates data buffer on heap and writes symbol data into buffer.
+  // Allocates data buffer on heap and writes symbol data into buffer, or
+  // maps the symbol file if set_use_mmap() asked for it.
   // Symbol supplier ALWAYS takes ownership of the data buffer.
   virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
                                             const SystemInfo* system_info,
@@ -121,18 +149,46 @@ class SimpleSymbolSupplier : public SymbolSupplier {
                                             char** symbol_data,
                                             size_t* symbol_data_size);
 
-  // Free the data buffer allocated in the above GetCStringSymbolData();
+  // Free the data buffer allocated or mapped in the above
+  // GetCStringSymbolData();
   virtual void FreeSymbolData(const CodeModule* module);
 
+  // Returns the path to the binary kept for the given module beside its
+  // symbol file.  See the description above.
+  virtual SymbolResult GetBinaryFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* binary_file);
+
+  // Symbol files are read independently of one another, so different
+  // modules' symbols may be fetched at once.
+  virtual bool IsThreadSafe() { return true; }
+
  protected:
   SymbolResult GetSymbolFileAtPathFromRoot(const CodeModule* module,
                                            const SystemInfo* system_info,
                                            const string& root_path,
                                            string* symbol_file);
 
+  // Sets |relative_path| to the location of the symbol file for |module|
+  // beneath a root path, without its .sym extension, as described above.
+  // Returns false if the module lacks a debug_file or debug_identifier.
+  static bool GetRelativeSymbolPath(const CodeModule* module,
+                                    string* relative_path);
+
  private:
-  map<string, char*> memory_buffers_;
+  // A buffer GetCStringSymbolData handed out, and how to release it.
+  struct MemoryBuffer {
+    char* data;
+    size_t size;
+    bool mapped;
+  };
+
+  // Guards memory_buffers_.
+  std::mutex memory_buffers_mutex_;
+  map<string, MemoryBuffer> memory_buffers_;
   vector<string> paths_;
+  bool use_mmap_;
+  SymbolPathCache* path_cache_;
 };
 
 }  // namespace google_breakpad
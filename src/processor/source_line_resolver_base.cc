@@ -34,11 +34,22 @@
 //
 // Author: Siyang Xie (lambxsy@google.com)
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <set>
 #include <utility>
 
 #include "google_breakpad/processor/source_line_resolver_base.h"
@@ -50,12 +61,216 @@ using std::make_pair;
 
 namespace google_breakpad {
 
+// Tracks the size and recency of each loaded module.  Entries are only
+// added and removed with the table lock held exclusively; recency and pins
+// are atomic so that lookups can update them while sharing it.
+class SourceLineResolverBase::ModuleCache {
+ public:
+  ModuleCache() : budget_(0), clock_(0) {}
+
+  void Add(const string& code_file, uint64_t size) {
+    Entry& entry = entries_[code_file];
+    entry.size = size;
+    entry.last_use.store(++clock_, std::memory_order_relaxed);
+    stats_.resident_bytes += size;
+    stats_.resident_modules = entries_.size();
+  }
+
+  void Remove(const string& code_file) {
+    EntryMap::iterator it = entries_.find(code_file);
+    if (it == entries_.end())
+      return;
+    stats_.resident_bytes -= it->second.size;
+    entries_.erase(it);
+    stats_.resident_modules = entries_.size();
+  }
+
+  // Marks |code_file| as the most recently used module.  Repeated lookups
+  // in the same module only read the clock.
+  void Touch(const string& code_file) {
+    EntryMap::iterator it = entries_.find(code_file);
+    if (it == entries_.end())
+      return;
+    std::atomic<uint64_t>& last_use = it->second.last_use;
+    if (last_use.load(std::memory_order_relaxed) !=
+        clock_.load(std::memory_order_relaxed)) {
+      last_use.store(++clock_, std::memory_order_relaxed);
+    }
+  }
+
+  bool Pin(const string& code_file) {
+    EntryMap::iterator it = entries_.find(code_file);
+    if (it == entries_.end())
+      return false;
+    ++it->second.pins;
+    return true;
+  }
+
+  void Unpin(const string& code_file) {
+    EntryMap::iterator it = entries_.find(code_file);
+    if (it == entries_.end())
+      return;
+    int pins = it->second.pins.load();
+    while (pins > 0 && !it->second.pins.compare_exchange_weak(pins, pins - 1)) {
+    }
+  }
+
+  // If the cache is over budget, sets |code_file| to the least recently used
+  // unpinned module other than |keep| and returns true.
+  bool NextEviction(const string& keep, string* code_file) const {
+    if (budget_ == 0 || stats_.resident_bytes <= budget_)
+      return false;
+    EntryMap::const_iterator oldest = entries_.end();
+    for (EntryMap::const_iterator it = entries_.begin();
+         it != entries_.end(); ++it) {
+      if (it->first == keep || it->second.pins.load() != 0)
+        continue;
+      if (oldest == entries_.end() ||
+          it->second.last_use.load(std::memory_order_relaxed) <
+          oldest->second.last_use.load(std::memory_order_relaxed)) {
+        oldest = it;
+      }
+    }
+    if (oldest == entries_.end())
+      return false;
+    *code_file = oldest->first;
+    return true;
+  }
+
+  uint64_t budget_;
+  // Hits and misses are counted in the table lock's shards instead.
+  ModuleCacheStats stats_;
+
+ private:
+  struct Entry {
+    Entry() : size(0), pins(0), last_use(0) {}
+    uint64_t size;
+    std::atomic<int> pins;
+    std::atomic<uint64_t> last_use;
+  };
+  typedef map<string, Entry> EntryMap;
+
+  EntryMap entries_;
+  std::atomic<uint64_t> clock_;
+};
+
+// A reader-writer lock split into shards, one mutex to a cache line.  Each
+// thread reads through its own shard, so concurrent lookups don't contend on
+// a shared lock word; a writer takes every shard in order.  The shards also
+// hold the hit and miss counters, so counting them doesn't share a cache
+// line between threads either.
+//
+// The lock also makes loads happen once per module: a thread loading a
+// module claims its name, and any other thread loading it waits until the
+// first one is done.
+class SourceLineResolverBase::ModuleTableLock {
+ public:
+  struct Shard {
+    Shard() : hits(0), misses(0) {}
+    std::mutex mutex;
+    uint64_t hits;
+    uint64_t misses;
+    char padding[64];
+  };
+
+  explicit ModuleTableLock(bool enabled)
+      : enabled_(enabled), shards_(new Shard[enabled ? kNumShards : 1]) {}
+  ~ModuleTableLock() { delete [] shards_; }
+
+  bool enabled() const { return enabled_; }
+  int num_shards() const { return enabled_ ? kNumShards : 1; }
+  Shard* shard(int i) { return &shards_[i]; }
+
+  // Holds the calling thread's shard for the life of the Reader.
+  class Reader {
+   public:
+    explicit Reader(ModuleTableLock* lock)
+        : lock_(lock), shard_(lock->ReaderShard()) {
+      if (lock_->enabled_)
+        shard_->mutex.lock();
+    }
+    ~Reader() {
+      if (lock_->enabled_)
+        shard_->mutex.unlock();
+    }
+    Shard* shard() { return shard_; }
+
+   private:
+    ModuleTableLock* lock_;
+    Shard* shard_;
+  };
+
+  // Holds every shard for the life of the Writer.
+  class Writer {
+   public:
+    explicit Writer(ModuleTableLock* lock) : lock_(lock) {
+      if (lock_->enabled_) {
+        for (int i = 0; i < kNumShards; ++i)
+          lock_->shards_[i].mutex.lock();
+      }
+    }
+    ~Writer() {
+      if (lock_->enabled_) {
+        for (int i = kNumShards - 1; i >= 0; --i)
+          lock_->shards_[i].mutex.unlock();
+      }
+    }
+
+   private:
+    ModuleTableLock* lock_;
+  };
+
+  // Waits until no other thread is loading |code_file|, then claims it.
+  void BeginLoad(const string& code_file) {
+    if (!enabled_)
+      return;
+    std::unique_lock<std::mutex> guard(load_mutex_);
+    while (loading_.find(code_file) != loading_.end())
+      load_done_.wait(guard);
+    loading_.insert(code_file);
+  }
+
+  // Releases a claim made by BeginLoad().
+  void EndLoad(const string& code_file) {
+    if (!enabled_)
+      return;
+    {
+      std::lock_guard<std::mutex> guard(load_mutex_);
+      loading_.erase(code_file);
+    }
+    load_done_.notify_all();
+  }
+
+ private:
+  static const int kNumShards = 32;
+
+  Shard* ReaderShard() {
+    if (!enabled_)
+      return &shards_[0];
+    static std::atomic<int> next_shard(0);
+    static thread_local int shard_index = -1;
+    if (shard_index < 0)
+      shard_index = next_shard++ % kNumShards;
+    return &shards_[shard_index];
+  }
+
+  bool enabled_;
+  Shard* shards_;
+
+  std::mutex load_mutex_;
+  std::condition_variable load_done_;
+  set<string> loading_;
+};
+
 SourceLineResolverBase::SourceLineResolverBase(
-    ModuleFactory* module_factory)
+    ModuleFactory* module_factory, bool thread_safe)
   : modules_(new ModuleMap),
     corrupt_modules_(new ModuleSet),
     memory_buffers_(new MemoryMap),
-    module_factory_(module_factory) {
+    mapped_buffers_(new MappedMemoryMap),
+    module_factory_(module_factory),
+    module_cache_(new ModuleCache),
+    lock_(new ModuleTableLock(thread_safe)) {
 }
 
 SourceLineResolverBase::~SourceLineResolverBase() {
@@ -81,8 +296,22 @@ SourceLineResolverBase::~SourceLineResolverBase() {
   delete memory_buffers_;
   memory_buffers_ = NULL;
 
+  // The modules pointed into the mapped buffers, so they had to go first.
+  MappedMemoryMap::iterator mapped = mapped_buffers_->begin();
+  for (; mapped != mapped_buffers_->end(); ++mapped) {
+    UnmapSymbolFile(mapped->second.first, mapped->second.second);
+  }
+  delete mapped_buffers_;
+  mapped_buffers_ = NULL;
+
   delete module_factory_;
   module_factory_ = NULL;
+
+  delete module_cache_;
+  module_cache_ = NULL;
+
+  delete lock_;
+  lock_ = NULL;
 }
 
 bool SourceLineResolverBase::ReadSymbolFile(const string& map_file,
@@ -148,13 +377,204 @@ bool SourceLineResolverBase::ReadSymbolFile(const string& map_file,
   return true;
 }
 
+bool SourceLineResolverBase::MapSymbolFile(const string& file_name,
+                                           char** symbol_data,
+                                           size_t* symbol_data_size) {
+  struct stat buf;
+  if (stat(file_name.c_str(), &buf) == -1) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not open " << file_name <<
+        ", error " << error_code << ": " << error_string;
+    return false;
+  }
+  if (buf.st_size == 0) {
+    BPLOG(ERROR) << file_name << " is empty";
+    return false;
+  }
+
+#ifdef _WIN32
+  FILE* f = fopen(file_name.c_str(), "rb");
+  if (!f) {
+    BPLOG(ERROR) << "Could not open " << file_name;
+    return false;
+  }
+  *symbol_data_size = buf.st_size;
+  *symbol_data = new char[*symbol_data_size];
+  size_t bytes_read = fread(*symbol_data, 1, *symbol_data_size, f);
+  fclose(f);
+  if (bytes_read != *symbol_data_size) {
+    BPLOG(ERROR) << "Could not read " << file_name;
+    delete [] *symbol_data;
+    return false;
+  }
+  return true;
+#else
+  int fd = open(file_name.c_str(), O_RDONLY);
+  void* mapping = MAP_FAILED;
+  if (fd != -1) {
+    mapping = mmap(NULL, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+  }
+  if (mapping == MAP_FAILED) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not map " << file_name <<
+        ", error " << error_code << ": " << error_string;
+    return false;
+  }
+
+  *symbol_data = static_cast<char*>(mapping);
+  *symbol_data_size = buf.st_size;
+  return true;
+#endif
+}
+
+bool SourceLineResolverBase::MapSymbolFileForParsing(
+    const string& file_name,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+#ifdef _WIN32
+  return ReadSymbolFile(file_name, symbol_data, symbol_data_size);
+#else
+  int fd = open(file_name.c_str(), O_RDONLY);
+  struct stat buf;
+  if (fd == -1 || fstat(fd, &buf) == -1) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not open " << file_name <<
+        ", error " << error_code << ": " << error_string;
+    if (fd != -1)
+      close(fd);
+    return false;
+  }
+
+  // Reserve zeroed memory for the file and its null terminator, then map
+  // the file over the start of it.  Mapping the file alone wouldn't do, as
+  // the terminator's page lies past the end of the file when the file's
+  // size is a multiple of the page size.
+  size_t file_size = buf.st_size;
+  void* mapping = mmap(NULL, file_size + 1, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping != MAP_FAILED && file_size > 0 &&
+      mmap(mapping, file_size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    munmap(mapping, file_size + 1);
+    mapping = MAP_FAILED;
+  }
+  if (mapping == MAP_FAILED) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not map " << file_name <<
+        ", error " << error_code << ": " << error_string;
+    close(fd);
+    return false;
+  }
+  close(fd);
+
+  *symbol_data = static_cast<char*>(mapping);
+  *symbol_data_size = file_size + 1;
+  return true;
+#endif
+}
+
+bool SourceLineResolverBase::CopySymbolFileToHugePages(
+    const string& file_name,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+#ifdef _WIN32
+  return MapSymbolFile(file_name, symbol_data, symbol_data_size);
+#else
+  int fd = open(file_name.c_str(), O_RDONLY);
+  struct stat buf;
+  if (fd == -1 || fstat(fd, &buf) == -1) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not open " << file_name <<
+        ", error " << error_code << ": " << error_string;
+    if (fd != -1)
+      close(fd);
+    return false;
+  }
+  if (buf.st_size == 0) {
+    BPLOG(ERROR) << file_name << " is empty";
+    close(fd);
+    return false;
+  }
+
+  // Reserve a huge page more than the file needs, and trim the reservation
+  // to a copy that starts on a huge page boundary, so that the copy is all
+  // UnmapSymbolFile() has to release.  Transparent huge pages are used
+  // only for aligned ranges of a mapping.
+  static const size_t kHugePageSize = 2 << 20;
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t file_size = buf.st_size;
+  size_t copy_size = (file_size + page_size - 1) & ~(page_size - 1);
+  size_t reserved_size = copy_size + kHugePageSize;
+  void* reservation = mmap(NULL, reserved_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reservation == MAP_FAILED) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not reserve memory for " << file_name <<
+        ", error " << error_code << ": " << error_string;
+    close(fd);
+    return false;
+  }
+  char* reserved = static_cast<char*>(reservation);
+  char* copy = reinterpret_cast<char*>(
+      (reinterpret_cast<uintptr_t>(reserved) + kHugePageSize - 1) &
+      ~static_cast<uintptr_t>(kHugePageSize - 1));
+  if (copy > reserved)
+    munmap(reserved, copy - reserved);
+  if (reserved + reserved_size > copy + copy_size)
+    munmap(copy + copy_size, reserved + reserved_size - (copy + copy_size));
+#ifdef MADV_HUGEPAGE
+  // Only a hint: without transparent huge page support, the copy is made
+  // in ordinary pages.
+  madvise(copy, copy_size, MADV_HUGEPAGE);
+#endif
+
+  size_t copied = 0;
+  while (copied < file_size) {
+    ssize_t n = read(fd, copy + copied, file_size - copied);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      string error_string;
+      int error_code = ErrnoString(&error_string);
+      BPLOG(ERROR) << "Could not read " << file_name <<
+          ", error " << error_code << ": " << error_string;
+      munmap(copy, copy_size);
+      close(fd);
+      return false;
+    }
+    copied += n;
+  }
+  close(fd);
+
+  *symbol_data = copy;
+  *symbol_data_size = file_size;
+  return true;
+#endif
+}
+
+void SourceLineResolverBase::UnmapSymbolFile(char* symbol_data,
+                                             size_t symbol_data_size) {
+#ifdef _WIN32
+  delete [] symbol_data;
+#else
+  munmap(symbol_data, symbol_data_size);
+#endif
+}
+
 bool SourceLineResolverBase::LoadModule(const CodeModule* module,
                                         const string& map_file) {
   if (module == NULL)
     return false;
 
   // Make sure we don't already have a module with the given name.
-  if (modules_->find(module->code_file()) != modules_->end()) {
+  if (IsLoaded(module->code_file())) {
     BPLOG(INFO) << "Symbols for module " << module->code_file()
                 << " already loaded";
     return false;
@@ -172,29 +592,20 @@ bool SourceLineResolverBase::LoadModule(const CodeModule* module,
               << "module = " << module->code_file()
               << ", memory_buffer_size = " << memory_buffer_size;
 
-  bool load_result = LoadModuleUsingMemoryBuffer(module, memory_buffer,
-                                                 memory_buffer_size);
-
-  if (load_result && !ShouldDeleteMemoryBufferAfterLoadModule()) {
-    // memory_buffer has to stay alive as long as the module.
-    memory_buffers_->insert(make_pair(module->code_file(), memory_buffer));
-  } else {
-    delete [] memory_buffer;
-  }
-
-  return load_result;
+  return LoadModuleFromBuffer(module, memory_buffer, memory_buffer_size,
+                              BUFFER_ALLOCATED);
 }
 
 bool SourceLineResolverBase::LoadModuleUsingMapBuffer(
     const CodeModule* module, const string& map_buffer) {
+  if (module == NULL)
+    return false;
   BPLOG(INFO) << "SourceLineResolverBase::LoadModuleUsingMapBuffer(module = "
               << module->code_file()
               << ", map_buffer.size() = " << map_buffer.size() << ")";
-  if (module == NULL)
-    return false;
 
   // Make sure we don't already have a module with the given name.
-  if (modules_->find(module->code_file()) != modules_->end()) {
+  if (IsLoaded(module->code_file())) {
     BPLOG(INFO) << "Symbols for module " << module->code_file()
                 << " already loaded";
     return false;
@@ -211,55 +622,89 @@ bool SourceLineResolverBase::LoadModuleUsingMapBuffer(
   memcpy(memory_buffer, map_buffer.c_str(), map_buffer.size());
   memory_buffer[map_buffer.size()] = '\0';
 
-  bool load_result = LoadModuleUsingMemoryBuffer(module, memory_buffer,
-                                                 memory_buffer_size);
-
-  if (load_result && !ShouldDeleteMemoryBufferAfterLoadModule()) {
-    // memory_buffer has to stay alive as long as the module.
-    memory_buffers_->insert(make_pair(module->code_file(), memory_buffer));
-  } else {
-    delete [] memory_buffer;
-  }
-
-  return load_result;
+  return LoadModuleFromBuffer(module, memory_buffer, memory_buffer_size,
+                              BUFFER_ALLOCATED);
 }
 
 bool SourceLineResolverBase::LoadModuleUsingMemoryBuffer(
     const CodeModule* module,
     char* memory_buffer,
     size_t memory_buffer_size) {
-  if (!module)
-    return false;
+  return LoadModuleFromBuffer(module, memory_buffer, memory_buffer_size,
+                              BUFFER_BORROWED);
+}
 
-  // Make sure we don't already have a module with the given name.
-  if (modules_->find(module->code_file()) != modules_->end()) {
-    BPLOG(INFO) << "Symbols for module " << module->code_file()
-                << " already loaded";
+bool SourceLineResolverBase::LoadModuleFromBuffer(
+    const CodeModule* module,
+    char* memory_buffer,
+    size_t memory_buffer_size,
+    BufferOwnership ownership) {
+  if (!module) {
+    ReleaseBuffer(memory_buffer, memory_buffer_size, ownership);
+    return false;
+  }
+  const string& code_file = module->code_file();
+
+  // Make sure we don't already have a module with the given name, once any
+  // other thread loading it is done.
+  lock_->BeginLoad(code_file);
+  if (IsLoaded(code_file)) {
+    lock_->EndLoad(code_file);
+    BPLOG(INFO) << "Symbols for module " << code_file << " already loaded";
+    ReleaseBuffer(memory_buffer, memory_buffer_size, ownership);
     return false;
   }
 
-  BPLOG(INFO) << "Loading symbols for module " << module->code_file()
+  BPLOG(INFO) << "Loading symbols for module " << code_file
               << " from memory buffer, size: " << memory_buffer_size;
 
-  Module* basic_module = module_factory_->CreateModule(module->code_file());
+  Module* basic_module = module_factory_->CreateModule(code_file);
 
   // Ownership of memory is NOT transfered to Module::LoadMapFromMemory().
   if (!basic_module->LoadMapFromMemory(memory_buffer, memory_buffer_size)) {
     BPLOG(ERROR) << "Too many error while parsing symbol data for module "
-                 << module->code_file();
+                 << code_file;
     // Returning false from here would be an indication that the symbols for
     // this module are missing which would be wrong.  Intentionally fall through
     // and add the module to both the modules_ and the corrupt_modules_ lists.
     assert(basic_module->IsCorrupt());
   }
 
-  modules_->insert(make_pair(module->code_file(), basic_module));
-  if (basic_module->IsCorrupt()) {
-    corrupt_modules_->insert(module->code_file());
+  // memory_buffer has to stay alive as long as the module, unless the
+  // module copied everything out of it.
+  bool keep_buffer = ownership != BUFFER_BORROWED &&
+                     !ShouldDeleteMemoryBufferAfterLoadModule();
+  {
+    ModuleTableLock::Writer writer(lock_);
+    modules_->insert(make_pair(code_file, basic_module));
+    if (basic_module->IsCorrupt()) {
+      corrupt_modules_->insert(code_file);
+    }
+    if (keep_buffer && ownership == BUFFER_MAPPED) {
+      mapped_buffers_->insert(
+          make_pair(code_file, make_pair(memory_buffer, memory_buffer_size)));
+    } else if (keep_buffer) {
+      memory_buffers_->insert(make_pair(code_file, memory_buffer));
+    }
+    module_cache_->Add(code_file, memory_buffer_size);
+    EvictModules(code_file);
   }
+  lock_->EndLoad(code_file);
+
+  if (!keep_buffer)
+    ReleaseBuffer(memory_buffer, memory_buffer_size, ownership);
   return true;
 }
 
+void SourceLineResolverBase::ReleaseBuffer(char* memory_buffer,
+                                           size_t memory_buffer_size,
+                                           BufferOwnership ownership) {
+  if (ownership == BUFFER_ALLOCATED)
+    delete [] memory_buffer;
+  else if (ownership == BUFFER_MAPPED)
+    UnmapSymbolFile(memory_buffer, memory_buffer_size);
+}
+
 bool SourceLineResolverBase::ShouldDeleteMemoryBufferAfterLoadModule() {
   return true;
 }
@@ -268,7 +713,14 @@ void SourceLineResolverBase::UnloadModule(const CodeModule* code_module) {
   if (!code_module)
     return;
 
-  ModuleMap::iterator mod_iter = modules_->find(code_module->code_file());
+  ModuleTableLock::Writer writer(lock_);
+  RemoveModule(code_module->code_file());
+}
+
+void SourceLineResolverBase::RemoveModule(const string& code_file) {
+  module_cache_->Remove(code_file);
+
+  ModuleMap::iterator mod_iter = modules_->find(code_file);
   if (mod_iter != modules_->end()) {
     Module* symbol_module = mod_iter->second;
     delete symbol_module;
@@ -276,27 +728,81 @@ void SourceLineResolverBase::UnloadModule(const CodeModule* code_module) {
     modules_->erase(mod_iter);
   }
 
-  if (ShouldDeleteMemoryBufferAfterLoadModule()) {
-    // No-op.  Because we never store any memory buffers.
-  } else {
-    // There may be a buffer stored locally, we need to find and delete it.
-    MemoryMap::iterator iter = memory_buffers_->find(code_module->code_file());
-    if (iter != memory_buffers_->end()) {
-      delete [] iter->second;
-      memory_buffers_->erase(iter);
-    }
+  // There may be a buffer stored locally, we need to find and release it.
+  MemoryMap::iterator iter = memory_buffers_->find(code_file);
+  if (iter != memory_buffers_->end()) {
+    delete [] iter->second;
+    memory_buffers_->erase(iter);
   }
+  MappedMemoryMap::iterator mapped = mapped_buffers_->find(code_file);
+  if (mapped != mapped_buffers_->end()) {
+    UnmapSymbolFile(mapped->second.first, mapped->second.second);
+    mapped_buffers_->erase(mapped);
+  }
+}
+
+bool SourceLineResolverBase::IsLoaded(const string& code_file) {
+  ModuleTableLock::Reader reader(lock_);
+  return modules_->find(code_file) != modules_->end();
 }
 
 bool SourceLineResolverBase::HasModule(const CodeModule* module) {
   if (!module)
     return false;
-  return modules_->find(module->code_file()) != modules_->end();
+  ModuleTableLock::Reader reader(lock_);
+  if (modules_->find(module->code_file()) == modules_->end()) {
+    ++reader.shard()->misses;
+    return false;
+  }
+  ++reader.shard()->hits;
+  module_cache_->Touch(module->code_file());
+  return true;
+}
+
+void SourceLineResolverBase::SetModuleCacheBudget(uint64_t budget_bytes) {
+  ModuleTableLock::Writer writer(lock_);
+  module_cache_->budget_ = budget_bytes;
+  EvictModules(string());
+}
+
+bool SourceLineResolverBase::PinModule(const CodeModule* module) {
+  if (!module)
+    return false;
+  ModuleTableLock::Reader reader(lock_);
+  return module_cache_->Pin(module->code_file());
+}
+
+void SourceLineResolverBase::UnpinModule(const CodeModule* module) {
+  if (!module)
+    return;
+  ModuleTableLock::Reader reader(lock_);
+  module_cache_->Unpin(module->code_file());
+}
+
+SourceLineResolverBase::ModuleCacheStats
+SourceLineResolverBase::GetModuleCacheStats() const {
+  ModuleTableLock::Writer writer(lock_);
+  ModuleCacheStats stats = module_cache_->stats_;
+  for (int i = 0; i < lock_->num_shards(); ++i) {
+    stats.hits += lock_->shard(i)->hits;
+    stats.misses += lock_->shard(i)->misses;
+  }
+  return stats;
+}
+
+void SourceLineResolverBase::EvictModules(const string& keep) {
+  string code_file;
+  while (module_cache_->NextEviction(keep, &code_file)) {
+    BPLOG(INFO) << "Evicting symbols for module " << code_file;
+    RemoveModule(code_file);
+    ++module_cache_->stats_.evictions;
+  }
 }
 
 bool SourceLineResolverBase::IsModuleCorrupt(const CodeModule* module) {
   if (!module)
     return false;
+  ModuleTableLock::Reader reader(lock_);
   return corrupt_modules_->find(module->code_file()) != corrupt_modules_->end();
 }
 
@@ -304,18 +810,47 @@ void SourceLineResolverBase::FillSourceLineInfo(
     StackFrame* frame,
     std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
   if (frame->module) {
+    ModuleTableLock::Reader reader(lock_);
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
+      module_cache_->Touch(it->first);
       it->second->LookupAddress(frame, inlined_frames);
     }
   }
 }
 
+bool SourceLineResolverBase::GetModuleFootprint(const CodeModule* module,
+                                                SymbolFootprint* footprint) {
+  *footprint = SymbolFootprint();
+  if (!module)
+    return false;
+  ModuleTableLock::Reader reader(lock_);
+  ModuleMap::const_iterator it = modules_->find(module->code_file());
+  if (it == modules_->end())
+    return false;
+  it->second->GetFootprint(footprint);
+  return true;
+}
+
+void SourceLineResolverBase::VisitModule(const CodeModule* code_module,
+                                         ModuleVisitor* visitor) {
+  if (code_module) {
+    ModuleTableLock::Reader reader(lock_);
+    ModuleMap::const_iterator it = modules_->find(code_module->code_file());
+    if (it != modules_->end()) {
+      module_cache_->Touch(it->first);
+      visitor->Visit(it->second);
+    }
+  }
+}
+
 WindowsFrameInfo* SourceLineResolverBase::FindWindowsFrameInfo(
     const StackFrame* frame) {
   if (frame->module) {
+    ModuleTableLock::Reader reader(lock_);
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
+      module_cache_->Touch(it->first);
       return it->second->FindWindowsFrameInfo(frame);
     }
   }
@@ -325,14 +860,20 @@ WindowsFrameInfo* SourceLineResolverBase::FindWindowsFrameInfo(
 CFIFrameInfo* SourceLineResolverBase::FindCFIFrameInfo(
     const StackFrame* frame) {
   if (frame->module) {
+    ModuleTableLock::Reader reader(lock_);
     ModuleMap::const_iterator it = modules_->find(frame->module->code_file());
     if (it != modules_->end()) {
+      module_cache_->Touch(it->first);
       return it->second->FindCFIFrameInfo(frame);
     }
   }
   return NULL;
 }
 
+bool SourceLineResolverBase::IsThreadSafe() {
+  return lock_->enabled();
+}
+
 bool SourceLineResolverBase::CompareString::operator()(
     const string& s1, const string& s2) const {
   return strcmp(s1.c_str(), s2.c_str()) < 0;
@@ -50,6 +50,7 @@
 #include "google_breakpad/processor/stack_frame.h"
 #include "processor/cfi_frame_info.h"
 #include "processor/linked_ptr.h"
+#include "processor/postfix_program.h"
 #include "processor/range_map.h"
 #include "processor/windows_frame_info.h"
 
@@ -70,16 +71,20 @@ class SourceLineResolverBase::AutoFileCloser {
   FILE* file_;
 };
 
+// The names in InlineOrigin, Function and PublicSymbol are not owned: a
+// BasicSourceLineResolver module points them into its StringPool, and a
+// FastSourceLineResolver module into its serialized data.
+
 struct SourceLineResolverBase::InlineOrigin {
-  InlineOrigin() {}
-  InlineOrigin(bool has_file_id, int32_t source_file_id, const string& name)
+  InlineOrigin() : name(NULL) {}
+  InlineOrigin(bool has_file_id, int32_t source_file_id, const char* name)
       : has_file_id(has_file_id),
         source_file_id(source_file_id),
         name(name) {}
   // If it's old format, source file id is set, otherwise not useful.
   bool has_file_id;
   int32_t source_file_id;
-  string name;
+  const char* name;
 };
 
 struct SourceLineResolverBase::Inline {
@@ -122,8 +127,8 @@ struct SourceLineResolverBase::Line {
 };
 
 struct SourceLineResolverBase::Function {
-  Function() { }
-  Function(const string& function_name,
+  Function() : name(NULL) { }
+  Function(const char* function_name,
            MemAddr function_address,
            MemAddr code_size,
            int set_parameter_size,
@@ -131,7 +136,7 @@ struct SourceLineResolverBase::Function {
       : name(function_name), address(function_address), size(code_size),
         parameter_size(set_parameter_size), is_multiple(is_multiple) { }
 
-  string name;
+  const char* name;
   MemAddr address;
   MemAddr size;
 
@@ -143,8 +148,8 @@ struct SourceLineResolverBase::Function {
 };
 
 struct SourceLineResolverBase::PublicSymbol {
-  PublicSymbol() { }
-  PublicSymbol(const string& set_name,
+  PublicSymbol() : name(NULL) { }
+  PublicSymbol(const char* set_name,
                MemAddr set_address,
                int set_parameter_size,
                bool is_multiple)
@@ -153,7 +158,7 @@ struct SourceLineResolverBase::PublicSymbol {
         parameter_size(set_parameter_size),
         is_multiple(is_multiple) {}
 
-  string name;
+  const char* name;
   MemAddr address;
 
   // If the public symbol is used as a function entry point, parameter_size
@@ -200,9 +205,19 @@ class SourceLineResolverBase::Module {
   // is not available, return NULL. The caller takes ownership of any
   // returned CFIFrameInfo object.
   virtual CFIFrameInfo* FindCFIFrameInfo(const StackFrame* frame) const = 0;
+
+  // Sets |footprint| to what the loaded symbols take up in memory.
+  virtual void GetFootprint(SymbolFootprint* footprint) const = 0;
  protected:
   virtual bool ParseCFIRuleSet(const string& rule_set,
                                CFIFrameInfo* frame_info) const;
+
+  // The rule sets FindCFIFrameInfo has already built.
+  mutable CFIFrameInfoCache cfi_frame_info_cache_;
+
+  // The programs compiled from the program strings of the STACK WIN
+  // records FindWindowsFrameInfo has returned, keyed by record.
+  mutable PostfixProgramCache windows_program_cache_;
 };
 
 }  // namespace google_breakpad
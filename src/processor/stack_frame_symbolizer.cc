@@ -36,6 +36,10 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "common/scoped_ptr.h"
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/code_modules.h"
@@ -43,15 +47,23 @@
 #include "google_breakpad/processor/stack_frame.h"
 #include "google_breakpad/processor/symbol_supplier.h"
 #include "google_breakpad/processor/system_info.h"
+#include "processor/frame_symbol_cache.h"
+#include "processor/hot_module_set.h"
 #include "processor/linked_ptr.h"
 #include "processor/logging.h"
+#include "processor/processor_metrics.h"
+#include "processor/symbol_load_cache.h"
 
 namespace google_breakpad {
 
 StackFrameSymbolizer::StackFrameSymbolizer(
     SymbolSupplier* supplier,
     SourceLineResolverInterface* resolver) : supplier_(supplier),
-                                             resolver_(resolver) { }
+                                             resolver_(resolver),
+                                             load_cache_(NULL),
+                                             metrics_(NULL),
+                                             frame_symbol_cache_(NULL),
+                                             hot_modules_(NULL) { }
 
 StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FillSourceLineInfo(
     const CodeModules* modules,
@@ -59,6 +71,39 @@ StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FillSourceLineInfo(
     const SystemInfo* system_info,
     StackFrame* frame,
     std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+  SymbolizerResult result =
+      FindModuleSymbols(modules, unloaded_modules, system_info, frame);
+  if (result != kNoError)
+    return result;
+  return FillLoadedSourceLineInfo(frame, inlined_frames);
+}
+
+StackFrameSymbolizer::SymbolizerResult
+StackFrameSymbolizer::LoadSymbolsForFrame(const CodeModules* modules,
+                                          const CodeModules* unloaded_modules,
+                                          const SystemInfo* system_info,
+                                          StackFrame* frame) {
+  SymbolizerResult result =
+      FindModuleSymbols(modules, unloaded_modules, system_info, frame);
+  if (result == kNoError && resolver_->IsModuleCorrupt(frame->module))
+    return kWarningCorruptSymbols;
+  return result;
+}
+
+StackFrameSymbolizer::SymbolizerResult
+StackFrameSymbolizer::FillModuleSourceLineInfo(
+    StackFrame* frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+  if (!frame->module || !resolver_ || !resolver_->HasModule(frame->module))
+    return kError;
+  return FillLoadedSourceLineInfo(frame, inlined_frames);
+}
+
+StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FindModuleSymbols(
+    const CodeModules* modules,
+    const CodeModules* unloaded_modules,
+    const SystemInfo* system_info,
+    StackFrame* frame) {
   assert(frame);
 
   const CodeModule* module = NULL;
@@ -71,76 +116,296 @@ StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FillSourceLineInfo(
 
   if (!module) return kError;
   frame->module = module;
+  SymbolizerResult result = LoadModuleSymbols(module, system_info);
+  if (result == kNoError && hot_modules_)
+    hot_modules_->Record(module);
+  return result;
+}
 
+StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::LoadModuleSymbols(
+    const CodeModule* module,
+    const SystemInfo* system_info) {
   if (!resolver_) return kError;  // no resolver.
   // If module is known to have missing symbol file, return.
+  if (IsMissingSymbols(module)) {
+    return kError;
+  }
+
+  // If module is already loaded, there is nothing more to do.
+  if (resolver_->HasModule(module))
+    return kNoError;
+
+  // Module needs to fetch symbol file. First check to see if supplier exists.
+  if (!supplier_) {
+    return kError;
+  }
+
+  // Symbols are fetched and loaded one module at a time, so the supplier
+  // need not be thread-safe.  Another thread walking through the same
+  // module may have settled it while this one waited for the lock.
+  std::unique_lock<std::mutex> lock(mutex_);
   if (no_symbol_modules_.find(module->code_file()) !=
       no_symbol_modules_.end()) {
     return kError;
   }
+  if (!resolver_->HasModule(module)) {
+    SymbolizerResult result = FetchSymbols(module, system_info);
+    if (result != kNoError)
+      return result;
+  }
+  return kNoError;
+}
 
-  // If module is already loaded, go ahead to fill source line info and return.
-  if (resolver_->HasModule(frame->module)) {
-    resolver_->FillSourceLineInfo(frame, inlined_frames);
-    return resolver_->IsModuleCorrupt(frame->module) ?
-        kWarningCorruptSymbols : kNoError;
+WindowsFrameInfo* StackFrameSymbolizer::FindWindowsFrameInfo(
+    const StackFrame* frame) {
+  if (!resolver_)
+    return NULL;
+  // Only what is found with the module loaded is worth remembering.
+  if (!frame_symbol_cache_ || !frame->module ||
+      !resolver_->HasModule(frame->module)) {
+    return resolver_->FindWindowsFrameInfo(frame);
   }
+  WindowsFrameInfo* windows_frame_info;
+  if (frame_symbol_cache_->FindWindowsFrameInfo(*frame, &windows_frame_info))
+    return windows_frame_info;
+  windows_frame_info = resolver_->FindWindowsFrameInfo(frame);
+  frame_symbol_cache_->InsertWindowsFrameInfo(*frame, windows_frame_info);
+  return windows_frame_info;
+}
 
-  // Module needs to fetch symbol file. First check to see if supplier exists.
-  if (!supplier_) {
+CFIFrameInfo* StackFrameSymbolizer::FindCFIFrameInfo(
+    const StackFrame* frame) {
+  if (!resolver_)
+    return NULL;
+  if (!frame_symbol_cache_ || !frame->module ||
+      !resolver_->HasModule(frame->module)) {
+    return resolver_->FindCFIFrameInfo(frame);
+  }
+  CFIFrameInfo* cfi_frame_info;
+  if (frame_symbol_cache_->FindCFIFrameInfo(*frame, &cfi_frame_info))
+    return cfi_frame_info;
+  cfi_frame_info = resolver_->FindCFIFrameInfo(frame);
+  frame_symbol_cache_->InsertCFIFrameInfo(*frame, cfi_frame_info);
+  return cfi_frame_info;
+}
+
+void StackFrameSymbolizer::PrefetchSymbols(const CodeModules* modules,
+                                           const SystemInfo* system_info,
+                                           int threads) {
+  if (!modules)
+    return;
+  std::vector<const CodeModule*> module_list;
+  for (unsigned int i = 0; i < modules->module_count(); ++i)
+    module_list.push_back(modules->GetModuleAtIndex(i));
+  PrefetchModuleSymbols(module_list, system_info, threads);
+}
+
+void StackFrameSymbolizer::PrefetchModuleSymbols(
+    const std::vector<const CodeModule*>& modules,
+    const SystemInfo* system_info,
+    int threads) {
+  if (!resolver_ || !supplier_)
+    return;
+
+  // The modules to fetch, once each by code_file, which is how both the
+  // resolver and no_symbol_modules_ know them.
+  std::vector<const CodeModule*> pending;
+  std::set<string> pending_files;
+  for (size_t i = 0; i < modules.size(); ++i) {
+    const CodeModule* module = modules[i];
+    if (!module || resolver_->HasModule(module) || IsMissingSymbols(module) ||
+        !pending_files.insert(module->code_file()).second) {
+      continue;
+    }
+    pending.push_back(module);
+  }
+
+  std::atomic<size_t> next_module(0);
+  bool fetch_unlocked = supplier_->IsThreadSafe();
+  bool load_unlocked = fetch_unlocked && resolver_->IsThreadSafe();
+  auto prefetch = [&]() {
+    size_t i;
+    while ((i = next_module++) < pending.size()) {
+      const CodeModule* module = pending[i];
+      string symbol_file;
+      char* symbol_data = NULL;
+      size_t symbol_data_size;
+      std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+      auto fetch = [&]() {
+        if (!fetch_unlocked)
+          lock.lock();
+        SymbolSupplier::SymbolResult symbol_result;
+        {
+          ProcessorMetrics::ScopedTimer timer(metrics_,
+                                              ProcessorMetrics::SYMBOL_FETCH);
+          symbol_result = supplier_->GetCStringSymbolData(
+              module, system_info, &symbol_file, &symbol_data,
+              &symbol_data_size);
+        }
+        if (fetch_unlocked && !load_unlocked)
+          lock.lock();
+        if (LoadSymbols(module, symbol_result, symbol_data,
+                        symbol_data_size) == kError) {
+          if (!lock.owns_lock())
+            lock.lock();
+          no_symbol_modules_.insert(module->code_file());
+        }
+        return symbol_result;
+      };
+      if (!load_cache_) {
+        fetch();
+        continue;
+      }
+      // A module another symbolizer found to be missing is remembered here
+      // too; one it loaded into another resolver is left for the walk.
+      bool loaded_here;
+      if (load_cache_->Load(module, fetch, &loaded_here) ==
+              SymbolSupplier::NOT_FOUND && !loaded_here) {
+        if (!lock.owns_lock())
+          lock.lock();
+        no_symbol_modules_.insert(module->code_file());
+      }
+    }
+  };
+
+  size_t thread_count = fetch_unlocked ?
+      std::min(static_cast<size_t>(std::max(threads, 1)), pending.size()) : 1;
+  std::vector<std::thread> fetchers;
+  for (size_t i = 1; i < thread_count; ++i)
+    fetchers.push_back(std::thread(prefetch));
+  prefetch();
+  for (size_t i = 0; i < fetchers.size(); ++i)
+    fetchers[i].join();
+}
+
+bool StackFrameSymbolizer::IsThreadSafe() {
+  return !resolver_ || resolver_->IsThreadSafe();
+}
+
+bool StackFrameSymbolizer::IsMissingSymbols(const CodeModule* module) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (no_symbol_modules_.find(module->code_file()) !=
+        no_symbol_modules_.end()) {
+      return true;
+    }
+  }
+  return load_cache_ && load_cache_->IsMissingSymbols(module);
+}
+
+StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::FetchSymbols(
+    const CodeModule* module,
+    const SystemInfo* system_info) {
+  SymbolizerResult result = kError;
+  auto fetch = [&]() {
+    string symbol_file;
+    char* symbol_data = NULL;
+    size_t symbol_data_size;
+    SymbolSupplier::SymbolResult symbol_result;
+    {
+      ProcessorMetrics::ScopedTimer timer(metrics_,
+                                          ProcessorMetrics::SYMBOL_FETCH);
+      symbol_result =
+          supplier_->GetCStringSymbolData(module, system_info, &symbol_file,
+                                          &symbol_data, &symbol_data_size);
+    }
+    result = LoadSymbols(module, symbol_result, symbol_data,
+                         symbol_data_size);
+    if (result == kError)
+      no_symbol_modules_.insert(module->code_file());
+    return symbol_result;
+  };
+  if (!load_cache_) {
+    fetch();
+    return result;
+  }
+
+  bool loaded_here;
+  SymbolSupplier::SymbolResult symbol_result =
+      load_cache_->Load(module, fetch, &loaded_here);
+  if (loaded_here)
+    return result;
+  if (symbol_result == SymbolSupplier::NOT_FOUND) {
+    no_symbol_modules_.insert(module->code_file());
     return kError;
   }
+  // Another symbolizer loaded the module.  If it shares this resolver
+  // that's as good as loading it here; otherwise this one still needs its
+  // own copy.
+  if (resolver_->HasModule(module))
+    return kNoError;
+  fetch();
+  return result;
+}
 
-  // Start fetching symbol from supplier.
-  string symbol_file;
-  char* symbol_data = NULL;
-  size_t symbol_data_size;
-  SymbolSupplier::SymbolResult symbol_result = supplier_->GetCStringSymbolData(
-      module, system_info, &symbol_file, &symbol_data, &symbol_data_size);
+StackFrameSymbolizer::SymbolizerResult
+StackFrameSymbolizer::FillLoadedSourceLineInfo(
+    StackFrame* frame,
+    std::deque<std::unique_ptr<StackFrame>>* inlined_frames) {
+  bool corrupt;
+  if (frame_symbol_cache_ &&
+      frame_symbol_cache_->FindSourceLineInfo(frame, inlined_frames,
+                                              &corrupt)) {
+    return corrupt ? kWarningCorruptSymbols : kNoError;
+  }
+  // The cache keeps all of a frame's inlined frames or none, so it can
+  // only take what the resolver finds when it adds to an empty deque.
+  bool cacheable = frame_symbol_cache_ && inlined_frames &&
+      inlined_frames->empty();
+  resolver_->FillSourceLineInfo(frame, inlined_frames);
+  corrupt = resolver_->IsModuleCorrupt(frame->module);
+  if (cacheable)
+    frame_symbol_cache_->InsertSourceLineInfo(*frame, *inlined_frames, corrupt);
+  return corrupt ? kWarningCorruptSymbols : kNoError;
+}
 
+StackFrameSymbolizer::SymbolizerResult StackFrameSymbolizer::LoadSymbols(
+    const CodeModule* module,
+    SymbolSupplier::SymbolResult symbol_result,
+    char* symbol_data,
+    size_t symbol_data_size) {
   switch (symbol_result) {
     case SymbolSupplier::FOUND: {
-      bool load_success = resolver_->LoadModuleUsingMemoryBuffer(
-          frame->module,
-          symbol_data,
-          symbol_data_size);
+      if (metrics_)
+        metrics_->Add(ProcessorMetrics::SYMBOLS_FOUND);
+      // A resolver shared between threads may have had the module loaded
+      // by another thread meanwhile, which is as good as loading it here.
+      bool load_success;
+      {
+        ProcessorMetrics::ScopedTimer timer(metrics_,
+                                            ProcessorMetrics::MODULE_LOAD);
+        load_success = resolver_->LoadModuleUsingMemoryBuffer(
+            module,
+            symbol_data,
+            symbol_data_size) || resolver_->HasModule(module);
+      }
       if (resolver_->ShouldDeleteMemoryBufferAfterLoadModule()) {
         supplier_->FreeSymbolData(module);
       }
 
-      if (load_success) {
-        resolver_->FillSourceLineInfo(frame, inlined_frames);
-        return resolver_->IsModuleCorrupt(frame->module) ?
-            kWarningCorruptSymbols : kNoError;
-      } else {
+      if (!load_success) {
         BPLOG(ERROR) << "Failed to load symbol file in resolver.";
-        no_symbol_modules_.insert(module->code_file());
+        if (metrics_)
+          metrics_->Add(ProcessorMetrics::SYMBOLS_NOT_LOADED);
         return kError;
       }
+      return kNoError;
     }
 
     case SymbolSupplier::NOT_FOUND:
-      no_symbol_modules_.insert(module->code_file());
+      if (metrics_)
+        metrics_->Add(ProcessorMetrics::SYMBOLS_NOT_FOUND);
       return kError;
 
     case SymbolSupplier::INTERRUPT:
+      if (metrics_)
+        metrics_->Add(ProcessorMetrics::SYMBOLS_INTERRUPTED);
       return kInterrupt;
 
     default:
       BPLOG(ERROR) << "Unknown SymbolResult enum: " << symbol_result;
       return kError;
   }
-  return kError;
-}
-
-WindowsFrameInfo* StackFrameSymbolizer::FindWindowsFrameInfo(
-    const StackFrame* frame) {
-  return resolver_ ? resolver_->FindWindowsFrameInfo(frame) : NULL;
-}
-
-CFIFrameInfo* StackFrameSymbolizer::FindCFIFrameInfo(
-    const StackFrame* frame) {
-  return resolver_ ? resolver_->FindCFIFrameInfo(frame) : NULL;
 }
 
 }  // namespace google_breakpad
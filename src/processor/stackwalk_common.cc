@@ -112,29 +112,31 @@ static string StripSeparator(const string& original) {
   return result;
 }
 
-// PrintStackContents prints the stack contents of the current frame to stdout.
-static void PrintStackContents(const string& indent,
-                               const StackFrame* frame,
-                               const StackFrame* prev_frame,
-                               const string& cpu,
-                               const MemoryRegion* memory,
-                               const CodeModules* modules,
-                               SourceLineResolverInterface* resolver) {
-  // Find stack range.
-  int word_length = 0;
-  uint64_t stack_begin = 0, stack_end = 0;
+// GetStackRange finds the range of stack memory [|*stack_begin|,
+// |*stack_end|) spanned by |frame|, bounded by |prev_frame|'s stack pointer,
+// and the word size of |cpu|.  Returns false if the CPU is not supported or
+// either stack pointer is unavailable.
+static bool GetStackRange(const StackFrame* frame,
+                          const StackFrame* prev_frame,
+                          const string& cpu,
+                          int* word_length,
+                          uint64_t* stack_begin,
+                          uint64_t* stack_end) {
+  *word_length = 0;
+  *stack_begin = 0;
+  *stack_end = 0;
   if (cpu == "x86") {
-    word_length = 4;
+    *word_length = 4;
     const StackFrameX86* frame_x86 = static_cast<const StackFrameX86*>(frame);
     const StackFrameX86* prev_frame_x86 =
         static_cast<const StackFrameX86*>(prev_frame);
     if ((frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_ESP) &&
         (prev_frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_ESP)) {
-      stack_begin = frame_x86->context.esp;
-      stack_end = prev_frame_x86->context.esp;
+      *stack_begin = frame_x86->context.esp;
+      *stack_end = prev_frame_x86->context.esp;
     }
   } else if (cpu == "amd64") {
-    word_length = 8;
+    *word_length = 8;
     const StackFrameAMD64* frame_amd64 =
         static_cast<const StackFrameAMD64*>(frame);
     const StackFrameAMD64* prev_frame_amd64 =
@@ -142,21 +144,21 @@ static void PrintStackContents(const string& indent,
     if ((frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RSP) &&
         (prev_frame_amd64->context_validity &
          StackFrameAMD64::CONTEXT_VALID_RSP)) {
-      stack_begin = frame_amd64->context.rsp;
-      stack_end = prev_frame_amd64->context.rsp;
+      *stack_begin = frame_amd64->context.rsp;
+      *stack_end = prev_frame_amd64->context.rsp;
     }
   } else if (cpu == "arm") {
-    word_length = 4;
+    *word_length = 4;
     const StackFrameARM* frame_arm = static_cast<const StackFrameARM*>(frame);
     const StackFrameARM* prev_frame_arm =
         static_cast<const StackFrameARM*>(prev_frame);
     if ((frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_SP) &&
         (prev_frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_SP)) {
-      stack_begin = frame_arm->context.iregs[13];
-      stack_end = prev_frame_arm->context.iregs[13];
+      *stack_begin = frame_arm->context.iregs[13];
+      *stack_end = prev_frame_arm->context.iregs[13];
     }
   } else if (cpu == "arm64") {
-    word_length = 8;
+    *word_length = 8;
     const StackFrameARM64* frame_arm64 =
         static_cast<const StackFrameARM64*>(frame);
     const StackFrameARM64* prev_frame_arm64 =
@@ -164,13 +166,34 @@ static void PrintStackContents(const string& indent,
     if ((frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_SP) &&
         (prev_frame_arm64->context_validity &
          StackFrameARM64::CONTEXT_VALID_SP)) {
-      stack_begin = frame_arm64->context.iregs[31];
-      stack_end = prev_frame_arm64->context.iregs[31];
+      *stack_begin = frame_arm64->context.iregs[31];
+      *stack_end = prev_frame_arm64->context.iregs[31];
     }
   }
-  if (!word_length || !stack_begin || !stack_end)
+  return *word_length && *stack_begin && *stack_end;
+}
+
+// PrintStackContents prints the stack contents of the current frame to stdout.
+static void PrintStackContents(const string& indent,
+                               const StackFrame* frame,
+                               const StackFrame* prev_frame,
+                               const string& cpu,
+                               const MemoryRegion* memory,
+                               const CodeModules* modules,
+                               SourceLineResolverInterface* resolver) {
+  // Find stack range.
+  int word_length = 0;
+  uint64_t stack_begin = 0, stack_end = 0;
+  if (!GetStackRange(frame, prev_frame, cpu, &word_length, &stack_begin,
+                     &stack_end))
     return;
 
+  // Read the stack directly where the memory region allows it.
+  size_t span_length = 0;
+  const uint8_t* span = stack_end > stack_begin ?
+      memory->GetMemorySpan(stack_begin, stack_end - stack_begin,
+                            &span_length) : NULL;
+
   // Print stack contents.
   printf("\n%sStack contents:", indent.c_str());
   for(uint64_t address = stack_begin; address < stack_end; ) {
@@ -185,8 +208,16 @@ static void PrintStackContents(const string& indent,
     string data_as_string;
     for (int i = 0; i < kBytesPerRow; ++i, ++address) {
       uint8_t value = 0;
-      if (address < stack_end &&
-          memory->GetMemoryAtAddress(address, &value)) {
+      bool readable = false;
+      if (address < stack_end) {
+        if (address - stack_begin < span_length) {
+          value = span[address - stack_begin];
+          readable = true;
+        } else {
+          readable = memory->GetMemoryAtAddress(address, &value);
+        }
+      }
+      if (readable) {
         printf(" %02x", value);
         data_as_string.push_back(isprint(value) ? value : '.');
       } else {
@@ -200,20 +231,41 @@ static void PrintStackContents(const string& indent,
 
   // Try to find instruction pointers from stack.
   printf("\n%sPossible instruction pointers:\n", indent.c_str());
+  // Words are read a block at a time; any the block couldn't hold are read
+  // one at a time.
+  static const size_t kWordsPerBlock = 256;
+  uint32_t block32[kWordsPerBlock];
+  uint64_t block64[kWordsPerBlock];
+  size_t block_index = kWordsPerBlock;
+  size_t block_read = 0;
   for (uint64_t address = stack_begin; address < stack_end;
        address += word_length) {
     StackFrame pointee_frame;
 
+    if (block_index == kWordsPerBlock) {
+      block_read = word_length == 4 ?
+          memory->GetMemoryAtAddresses(address, block32, kWordsPerBlock) :
+          memory->GetMemoryAtAddresses(address, block64, kWordsPerBlock);
+      block_index = 0;
+    }
+
     // Read a word (possible instruction pointer) from stack.
     if (word_length == 4) {
       uint32_t data32 = 0;
-      memory->GetMemoryAtAddress(address, &data32);
+      if (block_index < block_read)
+        data32 = block32[block_index];
+      else
+        memory->GetMemoryAtAddress(address, &data32);
       pointee_frame.instruction = data32;
     } else {
       uint64_t data64 = 0;
-      memory->GetMemoryAtAddress(address, &data64);
+      if (block_index < block_read)
+        data64 = block64[block_index];
+      else
+        memory->GetMemoryAtAddress(address, &data64);
       pointee_frame.instruction = data64;
     }
+    ++block_index;
     pointee_frame.module =
         modules->GetModuleForAddress(pointee_frame.instruction);
 
@@ -246,6 +298,322 @@ static void PrintStackContents(const string& indent,
   printf("\n");
 }
 
+// A register of a stack frame, and whether it is printed 64 bits wide.
+struct FrameRegister {
+  const char* name;
+  uint64_t value;
+  bool is_64bit;
+};
+
+static void AddRegister(vector<FrameRegister>* registers,
+                        const char* name, uint32_t value) {
+  FrameRegister frame_register = { name, value, false };
+  registers->push_back(frame_register);
+}
+
+static void AddRegister64(vector<FrameRegister>* registers,
+                          const char* name, uint64_t value) {
+  FrameRegister frame_register = { name, value, true };
+  registers->push_back(frame_register);
+}
+
+// GetFrameRegisters appends the registers of |frame| that are relevant and
+// known to |registers|, if |cpu| is a recognized CPU name, in the order in
+// which they are printed.
+static void GetFrameRegisters(const StackFrame* frame,
+                              const string& cpu,
+                              vector<FrameRegister>* registers) {
+  if (cpu == "x86") {
+    const StackFrameX86* frame_x86 =
+        reinterpret_cast<const StackFrameX86*>(frame);
+
+    if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EIP)
+      AddRegister(registers, "eip", frame_x86->context.eip);
+    if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_ESP)
+      AddRegister(registers, "esp", frame_x86->context.esp);
+    if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EBP)
+      AddRegister(registers, "ebp", frame_x86->context.ebp);
+    if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EBX)
+      AddRegister(registers, "ebx", frame_x86->context.ebx);
+    if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_ESI)
+      AddRegister(registers, "esi", frame_x86->context.esi);
+    if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EDI)
+      AddRegister(registers, "edi", frame_x86->context.edi);
+    if (frame_x86->context_validity == StackFrameX86::CONTEXT_VALID_ALL) {
+      AddRegister(registers, "eax", frame_x86->context.eax);
+      AddRegister(registers, "ecx", frame_x86->context.ecx);
+      AddRegister(registers, "edx", frame_x86->context.edx);
+      AddRegister(registers, "efl", frame_x86->context.eflags);
+    }
+  } else if (cpu == "ppc") {
+    const StackFramePPC* frame_ppc =
+        reinterpret_cast<const StackFramePPC*>(frame);
+
+    if (frame_ppc->context_validity & StackFramePPC::CONTEXT_VALID_SRR0)
+      AddRegister(registers, "srr0", frame_ppc->context.srr0);
+    if (frame_ppc->context_validity & StackFramePPC::CONTEXT_VALID_GPR1)
+      AddRegister(registers, "r1", frame_ppc->context.gpr[1]);
+  } else if (cpu == "amd64") {
+    const StackFrameAMD64* frame_amd64 =
+        reinterpret_cast<const StackFrameAMD64*>(frame);
+
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RAX)
+      AddRegister64(registers, "rax", frame_amd64->context.rax);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RDX)
+      AddRegister64(registers, "rdx", frame_amd64->context.rdx);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RCX)
+      AddRegister64(registers, "rcx", frame_amd64->context.rcx);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RBX)
+      AddRegister64(registers, "rbx", frame_amd64->context.rbx);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RSI)
+      AddRegister64(registers, "rsi", frame_amd64->context.rsi);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RDI)
+      AddRegister64(registers, "rdi", frame_amd64->context.rdi);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RBP)
+      AddRegister64(registers, "rbp", frame_amd64->context.rbp);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RSP)
+      AddRegister64(registers, "rsp", frame_amd64->context.rsp);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R8)
+      AddRegister64(registers, "r8", frame_amd64->context.r8);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R9)
+      AddRegister64(registers, "r9", frame_amd64->context.r9);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R10)
+      AddRegister64(registers, "r10", frame_amd64->context.r10);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R11)
+      AddRegister64(registers, "r11", frame_amd64->context.r11);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R12)
+      AddRegister64(registers, "r12", frame_amd64->context.r12);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R13)
+      AddRegister64(registers, "r13", frame_amd64->context.r13);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R14)
+      AddRegister64(registers, "r14", frame_amd64->context.r14);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R15)
+      AddRegister64(registers, "r15", frame_amd64->context.r15);
+    if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RIP)
+      AddRegister64(registers, "rip", frame_amd64->context.rip);
+  } else if (cpu == "sparc") {
+    const StackFrameSPARC* frame_sparc =
+        reinterpret_cast<const StackFrameSPARC*>(frame);
+
+    if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_SP)
+      AddRegister(registers, "sp", frame_sparc->context.g_r[14]);
+    if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_FP)
+      AddRegister(registers, "fp", frame_sparc->context.g_r[30]);
+    if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_PC)
+      AddRegister(registers, "pc", frame_sparc->context.pc);
+  } else if (cpu == "arm") {
+    const StackFrameARM* frame_arm =
+        reinterpret_cast<const StackFrameARM*>(frame);
+
+    // Argument registers (caller-saves), which will likely only be valid
+    // for the youngest frame.
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R0)
+      AddRegister(registers, "r0", frame_arm->context.iregs[0]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R1)
+      AddRegister(registers, "r1", frame_arm->context.iregs[1]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R2)
+      AddRegister(registers, "r2", frame_arm->context.iregs[2]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R3)
+      AddRegister(registers, "r3", frame_arm->context.iregs[3]);
+
+    // General-purpose callee-saves registers.
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R4)
+      AddRegister(registers, "r4", frame_arm->context.iregs[4]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R5)
+      AddRegister(registers, "r5", frame_arm->context.iregs[5]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R6)
+      AddRegister(registers, "r6", frame_arm->context.iregs[6]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R7)
+      AddRegister(registers, "r7", frame_arm->context.iregs[7]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R8)
+      AddRegister(registers, "r8", frame_arm->context.iregs[8]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R9)
+      AddRegister(registers, "r9", frame_arm->context.iregs[9]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R10)
+      AddRegister(registers, "r10", frame_arm->context.iregs[10]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R12)
+      AddRegister(registers, "r12", frame_arm->context.iregs[12]);
+
+    // Registers with a dedicated or conventional purpose.
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_FP)
+      AddRegister(registers, "fp", frame_arm->context.iregs[11]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_SP)
+      AddRegister(registers, "sp", frame_arm->context.iregs[13]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_LR)
+      AddRegister(registers, "lr", frame_arm->context.iregs[14]);
+    if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_PC)
+      AddRegister(registers, "pc", frame_arm->context.iregs[15]);
+  } else if (cpu == "arm64") {
+    const StackFrameARM64* frame_arm64 =
+        reinterpret_cast<const StackFrameARM64*>(frame);
+
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X0) {
+      AddRegister64(registers, "x0", frame_arm64->context.iregs[0]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X1) {
+      AddRegister64(registers, "x1", frame_arm64->context.iregs[1]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X2) {
+      AddRegister64(registers, "x2", frame_arm64->context.iregs[2]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X3) {
+      AddRegister64(registers, "x3", frame_arm64->context.iregs[3]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X4) {
+      AddRegister64(registers, "x4", frame_arm64->context.iregs[4]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X5) {
+      AddRegister64(registers, "x5", frame_arm64->context.iregs[5]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X6) {
+      AddRegister64(registers, "x6", frame_arm64->context.iregs[6]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X7) {
+      AddRegister64(registers, "x7", frame_arm64->context.iregs[7]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X8) {
+      AddRegister64(registers, "x8", frame_arm64->context.iregs[8]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X9) {
+      AddRegister64(registers, "x9", frame_arm64->context.iregs[9]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X10) {
+      AddRegister64(registers, "x10", frame_arm64->context.iregs[10]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X11) {
+      AddRegister64(registers, "x11", frame_arm64->context.iregs[11]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X12) {
+      AddRegister64(registers, "x12", frame_arm64->context.iregs[12]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X13) {
+      AddRegister64(registers, "x13", frame_arm64->context.iregs[13]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X14) {
+      AddRegister64(registers, "x14", frame_arm64->context.iregs[14]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X15) {
+      AddRegister64(registers, "x15", frame_arm64->context.iregs[15]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X16) {
+      AddRegister64(registers, "x16", frame_arm64->context.iregs[16]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X17) {
+      AddRegister64(registers, "x17", frame_arm64->context.iregs[17]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X18) {
+      AddRegister64(registers, "x18", frame_arm64->context.iregs[18]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X19) {
+      AddRegister64(registers, "x19", frame_arm64->context.iregs[19]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X20) {
+      AddRegister64(registers, "x20", frame_arm64->context.iregs[20]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X21) {
+      AddRegister64(registers, "x21", frame_arm64->context.iregs[21]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X22) {
+      AddRegister64(registers, "x22", frame_arm64->context.iregs[22]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X23) {
+      AddRegister64(registers, "x23", frame_arm64->context.iregs[23]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X24) {
+      AddRegister64(registers, "x24", frame_arm64->context.iregs[24]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X25) {
+      AddRegister64(registers, "x25", frame_arm64->context.iregs[25]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X26) {
+      AddRegister64(registers, "x26", frame_arm64->context.iregs[26]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X27) {
+      AddRegister64(registers, "x27", frame_arm64->context.iregs[27]);
+    }
+    if (frame_arm64->context_validity &
+        StackFrameARM64::CONTEXT_VALID_X28) {
+      AddRegister64(registers, "x28", frame_arm64->context.iregs[28]);
+    }
+
+    // Registers with a dedicated or conventional purpose.
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_FP) {
+      AddRegister64(registers, "fp", frame_arm64->context.iregs[29]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_LR) {
+      AddRegister64(registers, "lr", frame_arm64->context.iregs[30]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_SP) {
+      AddRegister64(registers, "sp", frame_arm64->context.iregs[31]);
+    }
+    if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_PC) {
+      AddRegister64(registers, "pc", frame_arm64->context.iregs[32]);
+    }
+  } else if ((cpu == "mips") || (cpu == "mips64")) {
+    const StackFrameMIPS* frame_mips =
+        reinterpret_cast<const StackFrameMIPS*>(frame);
+
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_GP)
+      AddRegister64(registers, "gp",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_GP]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_SP)
+      AddRegister64(registers, "sp",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_SP]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_FP)
+      AddRegister64(registers, "fp",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_FP]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_RA)
+      AddRegister64(registers, "ra",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_RA]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_PC)
+      AddRegister64(registers, "pc", frame_mips->context.epc);
+
+    // Save registers s0-s7
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S0)
+      AddRegister64(registers, "s0",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S0]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S1)
+      AddRegister64(registers, "s1",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S1]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S2)
+      AddRegister64(registers, "s2",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S2]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S3)
+      AddRegister64(registers, "s3",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S3]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S4)
+      AddRegister64(registers, "s4",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S4]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S5)
+      AddRegister64(registers, "s5",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S5]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S6)
+      AddRegister64(registers, "s6",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S6]);
+    if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S7)
+      AddRegister64(registers, "s7",
+                    frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S7]);
+  }
+}
+
 // PrintStack prints the call stack in |stack| to stdout, in a reasonably
 // useful form.  Module, function, and source file names are displayed if
 // they are available.  The code offset to the base code address of the
@@ -295,348 +663,18 @@ static void PrintStack(const CallStack* stack,
 
     // Inlined frames don't have registers info.
     if (frame->trust != StackFrameAMD64::FRAME_TRUST_INLINE) {
+      vector<FrameRegister> registers;
+      GetFrameRegisters(frame, cpu, &registers);
       int sequence = 0;
-      if (cpu == "x86") {
-        const StackFrameX86* frame_x86 =
-            reinterpret_cast<const StackFrameX86*>(frame);
-
-        if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EIP)
-          sequence = PrintRegister("eip", frame_x86->context.eip, sequence);
-        if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_ESP)
-          sequence = PrintRegister("esp", frame_x86->context.esp, sequence);
-        if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EBP)
-          sequence = PrintRegister("ebp", frame_x86->context.ebp, sequence);
-        if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EBX)
-          sequence = PrintRegister("ebx", frame_x86->context.ebx, sequence);
-        if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_ESI)
-          sequence = PrintRegister("esi", frame_x86->context.esi, sequence);
-        if (frame_x86->context_validity & StackFrameX86::CONTEXT_VALID_EDI)
-          sequence = PrintRegister("edi", frame_x86->context.edi, sequence);
-        if (frame_x86->context_validity == StackFrameX86::CONTEXT_VALID_ALL) {
-          sequence = PrintRegister("eax", frame_x86->context.eax, sequence);
-          sequence = PrintRegister("ecx", frame_x86->context.ecx, sequence);
-          sequence = PrintRegister("edx", frame_x86->context.edx, sequence);
-          sequence = PrintRegister("efl", frame_x86->context.eflags, sequence);
-        }
-      } else if (cpu == "ppc") {
-        const StackFramePPC* frame_ppc =
-            reinterpret_cast<const StackFramePPC*>(frame);
-
-        if (frame_ppc->context_validity & StackFramePPC::CONTEXT_VALID_SRR0)
-          sequence = PrintRegister("srr0", frame_ppc->context.srr0, sequence);
-        if (frame_ppc->context_validity & StackFramePPC::CONTEXT_VALID_GPR1)
-          sequence = PrintRegister("r1", frame_ppc->context.gpr[1], sequence);
-      } else if (cpu == "amd64") {
-        const StackFrameAMD64* frame_amd64 =
-            reinterpret_cast<const StackFrameAMD64*>(frame);
-
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RAX)
-          sequence = PrintRegister64("rax", frame_amd64->context.rax, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RDX)
-          sequence = PrintRegister64("rdx", frame_amd64->context.rdx, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RCX)
-          sequence = PrintRegister64("rcx", frame_amd64->context.rcx, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RBX)
-          sequence = PrintRegister64("rbx", frame_amd64->context.rbx, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RSI)
-          sequence = PrintRegister64("rsi", frame_amd64->context.rsi, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RDI)
-          sequence = PrintRegister64("rdi", frame_amd64->context.rdi, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RBP)
-          sequence = PrintRegister64("rbp", frame_amd64->context.rbp, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RSP)
-          sequence = PrintRegister64("rsp", frame_amd64->context.rsp, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R8)
-          sequence = PrintRegister64("r8", frame_amd64->context.r8, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R9)
-          sequence = PrintRegister64("r9", frame_amd64->context.r9, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R10)
-          sequence = PrintRegister64("r10", frame_amd64->context.r10, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R11)
-          sequence = PrintRegister64("r11", frame_amd64->context.r11, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R12)
-          sequence = PrintRegister64("r12", frame_amd64->context.r12, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R13)
-          sequence = PrintRegister64("r13", frame_amd64->context.r13, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R14)
-          sequence = PrintRegister64("r14", frame_amd64->context.r14, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_R15)
-          sequence = PrintRegister64("r15", frame_amd64->context.r15, sequence);
-        if (frame_amd64->context_validity & StackFrameAMD64::CONTEXT_VALID_RIP)
-          sequence = PrintRegister64("rip", frame_amd64->context.rip, sequence);
-      } else if (cpu == "sparc") {
-        const StackFrameSPARC* frame_sparc =
-            reinterpret_cast<const StackFrameSPARC*>(frame);
-
-        if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_SP)
-          sequence =
-              PrintRegister("sp", frame_sparc->context.g_r[14], sequence);
-        if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_FP)
-          sequence =
-              PrintRegister("fp", frame_sparc->context.g_r[30], sequence);
-        if (frame_sparc->context_validity & StackFrameSPARC::CONTEXT_VALID_PC)
-          sequence = PrintRegister("pc", frame_sparc->context.pc, sequence);
-      } else if (cpu == "arm") {
-        const StackFrameARM* frame_arm =
-            reinterpret_cast<const StackFrameARM*>(frame);
-
-        // Argument registers (caller-saves), which will likely only be valid
-        // for the youngest frame.
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R0)
-          sequence = PrintRegister("r0", frame_arm->context.iregs[0], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R1)
-          sequence = PrintRegister("r1", frame_arm->context.iregs[1], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R2)
-          sequence = PrintRegister("r2", frame_arm->context.iregs[2], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R3)
-          sequence = PrintRegister("r3", frame_arm->context.iregs[3], sequence);
-
-        // General-purpose callee-saves registers.
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R4)
-          sequence = PrintRegister("r4", frame_arm->context.iregs[4], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R5)
-          sequence = PrintRegister("r5", frame_arm->context.iregs[5], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R6)
-          sequence = PrintRegister("r6", frame_arm->context.iregs[6], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R7)
-          sequence = PrintRegister("r7", frame_arm->context.iregs[7], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R8)
-          sequence = PrintRegister("r8", frame_arm->context.iregs[8], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R9)
-          sequence = PrintRegister("r9", frame_arm->context.iregs[9], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R10)
-          sequence =
-              PrintRegister("r10", frame_arm->context.iregs[10], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_R12)
-          sequence =
-              PrintRegister("r12", frame_arm->context.iregs[12], sequence);
-
-        // Registers with a dedicated or conventional purpose.
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_FP)
-          sequence =
-              PrintRegister("fp", frame_arm->context.iregs[11], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_SP)
-          sequence =
-              PrintRegister("sp", frame_arm->context.iregs[13], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_LR)
-          sequence =
-              PrintRegister("lr", frame_arm->context.iregs[14], sequence);
-        if (frame_arm->context_validity & StackFrameARM::CONTEXT_VALID_PC)
-          sequence =
-              PrintRegister("pc", frame_arm->context.iregs[15], sequence);
-      } else if (cpu == "arm64") {
-        const StackFrameARM64* frame_arm64 =
-            reinterpret_cast<const StackFrameARM64*>(frame);
-
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X0) {
-          sequence =
-              PrintRegister64("x0", frame_arm64->context.iregs[0], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X1) {
-          sequence =
-              PrintRegister64("x1", frame_arm64->context.iregs[1], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X2) {
-          sequence =
-              PrintRegister64("x2", frame_arm64->context.iregs[2], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X3) {
-          sequence =
-              PrintRegister64("x3", frame_arm64->context.iregs[3], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X4) {
-          sequence =
-              PrintRegister64("x4", frame_arm64->context.iregs[4], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X5) {
-          sequence =
-              PrintRegister64("x5", frame_arm64->context.iregs[5], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X6) {
-          sequence =
-              PrintRegister64("x6", frame_arm64->context.iregs[6], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X7) {
-          sequence =
-              PrintRegister64("x7", frame_arm64->context.iregs[7], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X8) {
-          sequence =
-              PrintRegister64("x8", frame_arm64->context.iregs[8], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_X9) {
-          sequence =
-              PrintRegister64("x9", frame_arm64->context.iregs[9], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X10) {
-          sequence =
-              PrintRegister64("x10", frame_arm64->context.iregs[10], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X11) {
-          sequence =
-              PrintRegister64("x11", frame_arm64->context.iregs[11], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X12) {
-          sequence =
-              PrintRegister64("x12", frame_arm64->context.iregs[12], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X13) {
-          sequence =
-              PrintRegister64("x13", frame_arm64->context.iregs[13], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X14) {
-          sequence =
-              PrintRegister64("x14", frame_arm64->context.iregs[14], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X15) {
-          sequence =
-              PrintRegister64("x15", frame_arm64->context.iregs[15], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X16) {
-          sequence =
-              PrintRegister64("x16", frame_arm64->context.iregs[16], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X17) {
-          sequence =
-              PrintRegister64("x17", frame_arm64->context.iregs[17], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X18) {
-          sequence =
-              PrintRegister64("x18", frame_arm64->context.iregs[18], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X19) {
-          sequence =
-              PrintRegister64("x19", frame_arm64->context.iregs[19], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X20) {
-          sequence =
-              PrintRegister64("x20", frame_arm64->context.iregs[20], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X21) {
-          sequence =
-              PrintRegister64("x21", frame_arm64->context.iregs[21], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X22) {
-          sequence =
-              PrintRegister64("x22", frame_arm64->context.iregs[22], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X23) {
-          sequence =
-              PrintRegister64("x23", frame_arm64->context.iregs[23], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X24) {
-          sequence =
-              PrintRegister64("x24", frame_arm64->context.iregs[24], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X25) {
-          sequence =
-              PrintRegister64("x25", frame_arm64->context.iregs[25], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X26) {
-          sequence =
-              PrintRegister64("x26", frame_arm64->context.iregs[26], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X27) {
-          sequence =
-              PrintRegister64("x27", frame_arm64->context.iregs[27], sequence);
-        }
-        if (frame_arm64->context_validity &
-            StackFrameARM64::CONTEXT_VALID_X28) {
-          sequence =
-              PrintRegister64("x28", frame_arm64->context.iregs[28], sequence);
-        }
-
-        // Registers with a dedicated or conventional purpose.
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_FP) {
-          sequence =
-              PrintRegister64("fp", frame_arm64->context.iregs[29], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_LR) {
-          sequence =
-              PrintRegister64("lr", frame_arm64->context.iregs[30], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_SP) {
-          sequence =
-              PrintRegister64("sp", frame_arm64->context.iregs[31], sequence);
-        }
-        if (frame_arm64->context_validity & StackFrameARM64::CONTEXT_VALID_PC) {
-          sequence =
-              PrintRegister64("pc", frame_arm64->context.iregs[32], sequence);
+      for (size_t i = 0; i < registers.size(); ++i) {
+        if (registers[i].is_64bit) {
+          sequence = PrintRegister64(registers[i].name, registers[i].value,
+                                     sequence);
+        } else {
+          sequence = PrintRegister(registers[i].name,
+                                   static_cast<uint32_t>(registers[i].value),
+                                   sequence);
         }
-      } else if ((cpu == "mips") || (cpu == "mips64")) {
-        const StackFrameMIPS* frame_mips =
-            reinterpret_cast<const StackFrameMIPS*>(frame);
-
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_GP)
-          sequence = PrintRegister64(
-              "gp", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_GP],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_SP)
-          sequence = PrintRegister64(
-              "sp", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_SP],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_FP)
-          sequence = PrintRegister64(
-              "fp", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_FP],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_RA)
-          sequence = PrintRegister64(
-              "ra", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_RA],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_PC)
-          sequence = PrintRegister64("pc", frame_mips->context.epc, sequence);
-
-        // Save registers s0-s7
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S0)
-          sequence = PrintRegister64(
-              "s0", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S0],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S1)
-          sequence = PrintRegister64(
-              "s1", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S1],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S2)
-          sequence = PrintRegister64(
-              "s2", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S2],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S3)
-          sequence = PrintRegister64(
-              "s3", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S3],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S4)
-          sequence = PrintRegister64(
-              "s4", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S4],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S5)
-          sequence = PrintRegister64(
-              "s5", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S5],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S6)
-          sequence = PrintRegister64(
-              "s6", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S6],
-              sequence);
-        if (frame_mips->context_validity & StackFrameMIPS::CONTEXT_VALID_S7)
-          sequence = PrintRegister64(
-              "s7", frame_mips->context.iregs[MD_CONTEXT_MIPS_REG_S7],
-              sequence);
       }
     }
     printf("\n    Found by: %s\n", frame->trust_description().c_str());
@@ -650,62 +688,63 @@ static void PrintStack(const CallStack* stack,
   }
 }
 
-// PrintStackMachineReadable prints the call stack in |stack| to stdout,
+// PrintStackMachineReadable prints the call stack in |stack| to |out|,
 // in the following machine readable pipe-delimited text format:
 // thread number|frame number|module|function|source file|line|offset
 //
 // Module, function, source file, and source line may all be empty
 // depending on availability.  The code offset follows the same rules as
 // PrintStack above.
-static void PrintStackMachineReadable(int thread_num, const CallStack* stack) {
+static void PrintStackMachineReadable(int thread_num, const CallStack* stack,
+                                      FILE* out) {
   int frame_count = stack->frames()->size();
   for (int frame_index = 0; frame_index < frame_count; ++frame_index) {
     const StackFrame* frame = stack->frames()->at(frame_index);
-    printf("%d%c%d%c", thread_num, kOutputSeparator, frame_index,
-           kOutputSeparator);
+    fprintf(out, "%d%c%d%c", thread_num, kOutputSeparator, frame_index,
+            kOutputSeparator);
 
     uint64_t instruction_address = frame->ReturnAddress();
 
     if (frame->module) {
       assert(!frame->module->code_file().empty());
-      printf("%s", StripSeparator(PathnameStripper::File(
-                     frame->module->code_file())).c_str());
+      fprintf(out, "%s", StripSeparator(PathnameStripper::File(
+                      frame->module->code_file())).c_str());
       if (!frame->function_name.empty()) {
-        printf("%c%s", kOutputSeparator,
-               StripSeparator(frame->function_name).c_str());
+        fprintf(out, "%c%s", kOutputSeparator,
+                StripSeparator(frame->function_name).c_str());
         if (!frame->source_file_name.empty()) {
-          printf("%c%s%c%d%c0x%" PRIx64,
-                 kOutputSeparator,
-                 StripSeparator(frame->source_file_name).c_str(),
-                 kOutputSeparator,
-                 frame->source_line,
-                 kOutputSeparator,
-                 instruction_address - frame->source_line_base);
+          fprintf(out, "%c%s%c%d%c0x%" PRIx64,
+                  kOutputSeparator,
+                  StripSeparator(frame->source_file_name).c_str(),
+                  kOutputSeparator,
+                  frame->source_line,
+                  kOutputSeparator,
+                  instruction_address - frame->source_line_base);
         } else {
-          printf("%c%c%c0x%" PRIx64,
-                 kOutputSeparator,  // empty source file
-                 kOutputSeparator,  // empty source line
-                 kOutputSeparator,
-                 instruction_address - frame->function_base);
+          fprintf(out, "%c%c%c0x%" PRIx64,
+                  kOutputSeparator,  // empty source file
+                  kOutputSeparator,  // empty source line
+                  kOutputSeparator,
+                  instruction_address - frame->function_base);
         }
       } else {
-        printf("%c%c%c%c0x%" PRIx64,
-               kOutputSeparator,  // empty function name
-               kOutputSeparator,  // empty source file
-               kOutputSeparator,  // empty source line
-               kOutputSeparator,
-               instruction_address - frame->module->base_address());
+        fprintf(out, "%c%c%c%c0x%" PRIx64,
+                kOutputSeparator,  // empty function name
+                kOutputSeparator,  // empty source file
+                kOutputSeparator,  // empty source line
+                kOutputSeparator,
+                instruction_address - frame->module->base_address());
       }
     } else {
       // the printf before this prints a trailing separator for module name
-      printf("%c%c%c%c0x%" PRIx64,
-             kOutputSeparator,  // empty function name
-             kOutputSeparator,  // empty source file
-             kOutputSeparator,  // empty source line
-             kOutputSeparator,
-             instruction_address);
+      fprintf(out, "%c%c%c%c0x%" PRIx64,
+              kOutputSeparator,  // empty function name
+              kOutputSeparator,  // empty source file
+              kOutputSeparator,  // empty source line
+              kOutputSeparator,
+              instruction_address);
     }
-    printf("\n");
+    fprintf(out, "\n");
   }
 }
 
@@ -782,12 +821,13 @@ static void PrintModules(
   }
 }
 
-// PrintModulesMachineReadable outputs a list of loaded modules,
+// PrintModulesMachineReadable outputs a list of loaded modules to |out|,
 // one per line, in the following machine-readable pipe-delimited
 // text format:
 // Module|{Module Filename}|{Version}|{Debug Filename}|{Debug Identifier}|
 // {Base Address}|{Max Address}|{Main}
-static void PrintModulesMachineReadable(const CodeModules* modules) {
+static void PrintModulesMachineReadable(const CodeModules* modules,
+                                        FILE* out) {
   if (!modules)
     return;
 
@@ -803,21 +843,350 @@ static void PrintModulesMachineReadable(const CodeModules* modules) {
        ++module_sequence) {
     const CodeModule* module = modules->GetModuleAtSequence(module_sequence);
     uint64_t base_address = module->base_address();
-    printf("Module%c%s%c%s%c%s%c%s%c0x%08" PRIx64 "%c0x%08" PRIx64 "%c%d\n",
-           kOutputSeparator,
-           StripSeparator(PathnameStripper::File(module->code_file())).c_str(),
-           kOutputSeparator, StripSeparator(module->version()).c_str(),
-           kOutputSeparator,
-           StripSeparator(PathnameStripper::File(module->debug_file())).c_str(),
-           kOutputSeparator,
-           StripSeparator(module->debug_identifier()).c_str(),
-           kOutputSeparator, base_address,
-           kOutputSeparator, base_address + module->size() - 1,
-           kOutputSeparator,
-           main_module != NULL && base_address == main_address ? 1 : 0);
+    fprintf(out,
+            "Module%c%s%c%s%c%s%c%s%c0x%08" PRIx64 "%c0x%08" PRIx64 "%c%d\n",
+            kOutputSeparator,
+            StripSeparator(PathnameStripper::File(module->code_file())).c_str(),
+            kOutputSeparator, StripSeparator(module->version()).c_str(),
+            kOutputSeparator,
+            StripSeparator(
+                PathnameStripper::File(module->debug_file())).c_str(),
+            kOutputSeparator,
+            StripSeparator(module->debug_identifier()).c_str(),
+            kOutputSeparator, base_address,
+            kOutputSeparator, base_address + module->size() - 1,
+            kOutputSeparator,
+            main_module != NULL && base_address == main_address ? 1 : 0);
   }
 }
 
+// JSONWriter builds a JSON document in a single string buffer, which the
+// caller reserves up front and writes out in one call, rather than
+// formatting each value to the output stream.  Commas are inserted between
+// members and elements as they're added.
+class JSONWriter {
+ public:
+  explicit JSONWriter(size_t reserve) : need_comma_(false) {
+    buffer_.reserve(reserve);
+  }
+
+  void BeginObject() {
+    BeginValue();
+    buffer_.push_back('{');
+    need_comma_ = false;
+  }
+  void EndObject() {
+    buffer_.push_back('}');
+    need_comma_ = true;
+  }
+  void BeginArray() {
+    BeginValue();
+    buffer_.push_back('[');
+    need_comma_ = false;
+  }
+  void EndArray() {
+    buffer_.push_back(']');
+    need_comma_ = true;
+  }
+
+  // Starts an object member named |key|, which must not need escaping.
+  void Key(const char* key) {
+    if (need_comma_)
+      buffer_.push_back(',');
+    buffer_.push_back('"');
+    buffer_.append(key);
+    buffer_.append("\":", 2);
+    need_comma_ = false;
+  }
+
+  void String(const string& value) {
+    BeginValue();
+    AppendEscaped(value);
+    need_comma_ = true;
+  }
+
+  void Int(int64_t value) {
+    BeginValue();
+    uint64_t magnitude = value;
+    if (value < 0) {
+      buffer_.push_back('-');
+      magnitude = -magnitude;
+    }
+    char digits[20];
+    int count = 0;
+    do {
+      digits[count++] = '0' + magnitude % 10;
+      magnitude /= 10;
+    } while (magnitude);
+    while (count)
+      buffer_.push_back(digits[--count]);
+    need_comma_ = true;
+  }
+
+  void Bool(bool value) {
+    BeginValue();
+    buffer_.append(value ? "true" : "false");
+    need_comma_ = true;
+  }
+
+  // Adds |value| as a string of |width| hex digits with a 0x prefix.
+  // Addresses are written as strings because JSON numbers can't hold
+  // 64-bit values exactly.
+  void Hex(uint64_t value, int width) {
+    BeginValue();
+    char hex[2 + 16];
+    int count = 0;
+    do {
+      hex[count++] = kHexDigits[value & 0xf];
+      value >>= 4;
+    } while (value || count < width);
+    buffer_.append("\"0x", 3);
+    while (count)
+      buffer_.push_back(hex[--count]);
+    buffer_.push_back('"');
+    need_comma_ = true;
+  }
+
+  // Adds the |length| bytes at |data| as a string of hex digit pairs.
+  void HexBytes(const uint8_t* data, size_t length) {
+    BeginValue();
+    buffer_.push_back('"');
+    size_t offset = buffer_.size();
+    buffer_.resize(offset + length * 2);
+    for (size_t i = 0; i < length; ++i) {
+      buffer_[offset + i * 2] = kHexDigits[data[i] >> 4];
+      buffer_[offset + i * 2 + 1] = kHexDigits[data[i] & 0xf];
+    }
+    buffer_.push_back('"');
+    need_comma_ = true;
+  }
+
+  const string& buffer() const { return buffer_; }
+
+ private:
+  void BeginValue() {
+    if (need_comma_)
+      buffer_.push_back(',');
+  }
+
+  // Appends |value| quoted, copying each run of characters that don't need
+  // escaping at once.  Bytes outside ASCII are copied as they are, on the
+  // assumption that they're UTF-8.
+  void AppendEscaped(const string& value) {
+    buffer_.push_back('"');
+    const char* run = value.data();
+    const char* end = run + value.size();
+    for (const char* c = run; c != end; ++c) {
+      unsigned char ch = *c;
+      if (ch >= 0x20 && ch != '"' && ch != '\\')
+        continue;
+      buffer_.append(run, c - run);
+      run = c + 1;
+      buffer_.push_back('\\');
+      switch (ch) {
+        case '"':  buffer_.push_back('"'); break;
+        case '\\': buffer_.push_back('\\'); break;
+        case '\n': buffer_.push_back('n'); break;
+        case '\r': buffer_.push_back('r'); break;
+        case '\t': buffer_.push_back('t'); break;
+        default:
+          buffer_.append("u00", 3);
+          buffer_.push_back(kHexDigits[ch >> 4]);
+          buffer_.push_back(kHexDigits[ch & 0xf]);
+          break;
+      }
+    }
+    buffer_.append(run, end - run);
+    buffer_.push_back('"');
+  }
+
+  static const char kHexDigits[];
+
+  string buffer_;
+  bool need_comma_;
+};
+
+const char JSONWriter::kHexDigits[] = "0123456789abcdef";
+
+// EstimateJSONSize guesses how large the JSON for |process_state| will be,
+// so that the buffer generally needs to be allocated only once.
+static size_t EstimateJSONSize(const ProcessState& process_state,
+                               bool output_registers,
+                               bool output_stack_contents) {
+  const size_t kBytesPerFrame = 256;
+  const size_t kBytesPerRegisters = 32 * 26;
+  const size_t kBytesPerModule = 384;
+  const size_t kBytesPerStackContents = 2048;
+  size_t frame_count = 0;
+  for (const CallStack* stack : *process_state.threads())
+    frame_count += stack->frames()->size();
+  size_t per_frame = kBytesPerFrame;
+  if (output_registers)
+    per_frame += kBytesPerRegisters;
+  if (output_stack_contents)
+    per_frame += kBytesPerStackContents;
+  size_t module_count = process_state.modules() ?
+      process_state.modules()->module_count() : 0;
+  return 1024 + frame_count * per_frame + module_count * kBytesPerModule;
+}
+
+// WriteStackContentsJSON adds the stack memory between |frame| and
+// |prev_frame| as a "stack" member: its start address, its size, and its
+// contents in hex, up to the first byte that couldn't be read.
+static void WriteStackContentsJSON(const StackFrame* frame,
+                                   const StackFrame* prev_frame,
+                                   const string& cpu,
+                                   const MemoryRegion* memory,
+                                   JSONWriter* writer) {
+  int word_length = 0;
+  uint64_t stack_begin = 0, stack_end = 0;
+  if (!memory ||
+      !GetStackRange(frame, prev_frame, cpu, &word_length, &stack_begin,
+                     &stack_end) ||
+      stack_end <= stack_begin)
+    return;
+
+  uint64_t stack_size = stack_end - stack_begin;
+  size_t span_length = 0;
+  const uint8_t* span =
+      memory->GetMemorySpan(stack_begin, stack_size, &span_length);
+  vector<uint8_t> copied;
+  if (!span || span_length < stack_size) {
+    // Fall back to reading a byte at a time past what the span covers.
+    copied.reserve(stack_size);
+    if (span)
+      copied.assign(span, span + span_length);
+    for (uint64_t address = stack_begin + copied.size(); address < stack_end;
+         ++address) {
+      uint8_t value;
+      if (!memory->GetMemoryAtAddress(address, &value))
+        break;
+      copied.push_back(value);
+    }
+    span = copied.empty() ? NULL : &copied[0];
+    span_length = copied.size();
+  }
+
+  writer->Key("stack");
+  writer->BeginObject();
+  writer->Key("address");
+  writer->Hex(stack_begin, word_length * 2);
+  writer->Key("size");
+  writer->Int(stack_size);
+  writer->Key("data");
+  writer->HexBytes(span, span_length);
+  writer->EndObject();
+}
+
+// WriteStackJSON adds the frames of |stack| as a "frames" array.  The
+// offset members follow the same rules as PrintStack.
+static void WriteStackJSON(const CallStack* stack,
+                           const string& cpu,
+                           bool output_registers,
+                           bool output_stack_contents,
+                           const MemoryRegion* memory,
+                           JSONWriter* writer) {
+  vector<FrameRegister> registers;
+  int frame_count = stack->frames()->size();
+  writer->Key("frames");
+  writer->BeginArray();
+  for (int frame_index = 0; frame_index < frame_count; ++frame_index) {
+    const StackFrame* frame = stack->frames()->at(frame_index);
+    uint64_t instruction_address = frame->ReturnAddress();
+    writer->BeginObject();
+    writer->Key("frame");
+    writer->Int(frame_index);
+    writer->Key("instruction");
+    writer->Hex(frame->instruction, 0);
+    if (frame->module) {
+      writer->Key("module");
+      writer->String(PathnameStripper::File(frame->module->code_file()));
+      writer->Key("module_offset");
+      writer->Hex(instruction_address - frame->module->base_address(), 0);
+      if (!frame->function_name.empty()) {
+        writer->Key("function");
+        writer->String(frame->function_name);
+        writer->Key("function_offset");
+        writer->Hex(instruction_address - frame->function_base, 0);
+        if (!frame->source_file_name.empty()) {
+          writer->Key("file");
+          writer->String(frame->source_file_name);
+          writer->Key("line");
+          writer->Int(frame->source_line);
+          writer->Key("line_offset");
+          writer->Hex(instruction_address - frame->source_line_base, 0);
+        }
+      }
+    }
+    writer->Key("trust");
+    writer->String(frame->trust_description());
+
+    // Inlined frames don't have registers info.
+    if (output_registers &&
+        frame->trust != StackFrameAMD64::FRAME_TRUST_INLINE) {
+      registers.clear();
+      GetFrameRegisters(frame, cpu, &registers);
+      writer->Key("registers");
+      writer->BeginObject();
+      for (size_t i = 0; i < registers.size(); ++i) {
+        writer->Key(registers[i].name);
+        writer->Hex(registers[i].value, registers[i].is_64bit ? 16 : 8);
+      }
+      writer->EndObject();
+    }
+
+    if (output_stack_contents && frame_index + 1 < frame_count) {
+      WriteStackContentsJSON(frame, stack->frames()->at(frame_index + 1), cpu,
+                             memory, writer);
+    }
+    writer->EndObject();
+  }
+  writer->EndArray();
+}
+
+// WriteModulesJSON adds the loaded |modules| as a "modules" array.
+static void WriteModulesJSON(
+    const CodeModules* modules,
+    const vector<const CodeModule*>* modules_without_symbols,
+    const vector<const CodeModule*>* modules_with_corrupt_symbols,
+    JSONWriter* writer) {
+  writer->Key("modules");
+  writer->BeginArray();
+  if (modules) {
+    const CodeModule* main_module = modules->GetMainModule();
+    unsigned int module_count = modules->module_count();
+    for (unsigned int module_sequence = 0;
+         module_sequence < module_count;
+         ++module_sequence) {
+      const CodeModule* module = modules->GetModuleAtSequence(module_sequence);
+      writer->BeginObject();
+      writer->Key("base_address");
+      writer->Hex(module->base_address(), 8);
+      writer->Key("end_address");
+      writer->Hex(module->base_address() + module->size() - 1, 8);
+      writer->Key("filename");
+      writer->String(PathnameStripper::File(module->code_file()));
+      writer->Key("code_id");
+      writer->String(module->code_identifier());
+      writer->Key("version");
+      writer->String(module->version());
+      writer->Key("debug_file");
+      writer->String(PathnameStripper::File(module->debug_file()));
+      writer->Key("debug_id");
+      writer->String(module->debug_identifier());
+      writer->Key("main");
+      writer->Bool(main_module &&
+                   module->base_address() == main_module->base_address());
+      writer->Key("missing_symbols");
+      writer->Bool(ContainsModule(modules_without_symbols, module));
+      writer->Key("corrupt_symbols");
+      writer->Bool(ContainsModule(modules_with_corrupt_symbols, module));
+      writer->EndObject();
+    }
+  }
+  writer->EndArray();
+}
+
 }  // namespace
 
 void PrintProcessState(const ProcessState& process_state,
@@ -915,64 +1284,70 @@ void PrintProcessState(const ProcessState& process_state,
 }
 
 void PrintProcessStateMachineReadable(const ProcessState& process_state) {
+  PrintProcessStateMachineReadable(process_state, stdout);
+}
+
+void PrintProcessStateMachineReadable(const ProcessState& process_state,
+                                      FILE* out) {
   // Print OS and CPU information.
   // OS|{OS Name}|{OS Version}
   // CPU|{CPU Name}|{CPU Info}|{Number of CPUs}
   // GPU|{GPU version}|{GPU vendor}|{GPU renderer}
-  printf("OS%c%s%c%s\n", kOutputSeparator,
-         StripSeparator(process_state.system_info()->os).c_str(),
-         kOutputSeparator,
-         StripSeparator(process_state.system_info()->os_version).c_str());
-  printf("CPU%c%s%c%s%c%d\n", kOutputSeparator,
-         StripSeparator(process_state.system_info()->cpu).c_str(),
-         kOutputSeparator,
-         // this may be empty
-         StripSeparator(process_state.system_info()->cpu_info).c_str(),
-         kOutputSeparator,
-         process_state.system_info()->cpu_count);
-  printf("GPU%c%s%c%s%c%s\n", kOutputSeparator,
-         StripSeparator(process_state.system_info()->gl_version).c_str(),
-         kOutputSeparator,
-         StripSeparator(process_state.system_info()->gl_vendor).c_str(),
-         kOutputSeparator,
-         StripSeparator(process_state.system_info()->gl_renderer).c_str());
+  fprintf(out, "OS%c%s%c%s\n", kOutputSeparator,
+          StripSeparator(process_state.system_info()->os).c_str(),
+          kOutputSeparator,
+          StripSeparator(process_state.system_info()->os_version).c_str());
+  fprintf(out, "CPU%c%s%c%s%c%d\n", kOutputSeparator,
+          StripSeparator(process_state.system_info()->cpu).c_str(),
+          kOutputSeparator,
+          // this may be empty
+          StripSeparator(process_state.system_info()->cpu_info).c_str(),
+          kOutputSeparator,
+          process_state.system_info()->cpu_count);
+  fprintf(out, "GPU%c%s%c%s%c%s\n", kOutputSeparator,
+          StripSeparator(process_state.system_info()->gl_version).c_str(),
+          kOutputSeparator,
+          StripSeparator(process_state.system_info()->gl_vendor).c_str(),
+          kOutputSeparator,
+          StripSeparator(process_state.system_info()->gl_renderer).c_str());
 
   int requesting_thread = process_state.requesting_thread();
 
   // Print crash information.
   // Crash|{Crash Reason}|{Crash Address}|{Crashed Thread}
-  printf("Crash%c", kOutputSeparator);
+  fprintf(out, "Crash%c", kOutputSeparator);
   if (process_state.crashed()) {
-    printf("%s%c0x%" PRIx64 "%c",
-           StripSeparator(process_state.crash_reason()).c_str(),
-           kOutputSeparator, process_state.crash_address(), kOutputSeparator);
+    fprintf(out, "%s%c0x%" PRIx64 "%c",
+            StripSeparator(process_state.crash_reason()).c_str(),
+            kOutputSeparator, process_state.crash_address(), kOutputSeparator);
   } else {
     // print assertion info, if available, in place of crash reason,
     // instead of the unhelpful "No crash"
     string assertion = process_state.assertion();
     if (!assertion.empty()) {
-      printf("%s%c%c", StripSeparator(assertion).c_str(),
-             kOutputSeparator, kOutputSeparator);
+      fprintf(out, "%s%c%c", StripSeparator(assertion).c_str(),
+              kOutputSeparator, kOutputSeparator);
     } else {
-      printf("No crash%c%c", kOutputSeparator, kOutputSeparator);
+      fprintf(out, "No crash%c%c", kOutputSeparator, kOutputSeparator);
     }
   }
 
   if (requesting_thread != -1) {
-    printf("%d\n", requesting_thread);
+    fprintf(out, "%d\n", requesting_thread);
   } else {
-    printf("\n");
+    fprintf(out, "\n");
   }
 
-  PrintModulesMachineReadable(process_state.modules());
+  PrintModulesMachineReadable(process_state.modules(), out);
 
   // blank line to indicate start of threads
-  printf("\n");
+  fprintf(out, "\n");
 
   // If the thread that requested the dump is known, print it first.
   if (requesting_thread != -1) {
     PrintStackMachineReadable(requesting_thread,
-                              process_state.threads()->at(requesting_thread));
+                              process_state.threads()->at(requesting_thread),
+                              out);
   }
 
   // Print all of the threads in the dump.
@@ -981,9 +1356,91 @@ void PrintProcessStateMachineReadable(const ProcessState& process_state) {
     if (thread_index != requesting_thread) {
       // Don't print the crash thread again, it was already printed.
       PrintStackMachineReadable(thread_index,
-                                process_state.threads()->at(thread_index));
+                                process_state.threads()->at(thread_index),
+                                out);
     }
   }
 }
 
+void PrintProcessStateJSON(const ProcessState& process_state,
+                           bool output_stack_contents,
+                           bool output_registers,
+                           bool output_requesting_thread_only,
+                           FILE* out) {
+  const SystemInfo* system_info = process_state.system_info();
+  const string& cpu = system_info->cpu;
+  JSONWriter writer(EstimateJSONSize(process_state, output_registers,
+                                     output_stack_contents));
+  writer.BeginObject();
+
+  writer.Key("system_info");
+  writer.BeginObject();
+  writer.Key("os");
+  writer.String(system_info->os);
+  writer.Key("os_version");
+  writer.String(system_info->os_version);
+  writer.Key("cpu_arch");
+  writer.String(cpu);
+  writer.Key("cpu_info");
+  writer.String(system_info->cpu_info);
+  writer.Key("cpu_count");
+  writer.Int(system_info->cpu_count);
+  writer.Key("gpu_version");
+  writer.String(system_info->gl_version);
+  writer.Key("gpu_vendor");
+  writer.String(system_info->gl_vendor);
+  writer.Key("gpu_renderer");
+  writer.String(system_info->gl_renderer);
+  writer.EndObject();
+
+  writer.Key("crashed");
+  writer.Bool(process_state.crashed());
+  if (process_state.crashed()) {
+    writer.Key("crash_reason");
+    writer.String(process_state.crash_reason());
+    writer.Key("crash_address");
+    writer.Hex(process_state.crash_address(), 0);
+  }
+  if (!process_state.assertion().empty()) {
+    writer.Key("assertion");
+    writer.String(process_state.assertion());
+  }
+  writer.Key("time_date_stamp");
+  writer.Int(process_state.time_date_stamp());
+  writer.Key("process_create_time");
+  writer.Int(process_state.process_create_time());
+
+  int requesting_thread = process_state.requesting_thread();
+  if (requesting_thread != -1) {
+    writer.Key("requesting_thread");
+    writer.Int(requesting_thread);
+  }
+
+  writer.Key("threads");
+  writer.BeginArray();
+  int thread_count = process_state.threads()->size();
+  for (int thread_index = 0; thread_index < thread_count; ++thread_index) {
+    if (output_requesting_thread_only && thread_index != requesting_thread)
+      continue;
+    writer.BeginObject();
+    writer.Key("thread");
+    writer.Int(thread_index);
+    WriteStackJSON(process_state.threads()->at(thread_index), cpu,
+                   output_registers, output_stack_contents,
+                   process_state.thread_memory_regions()->at(thread_index),
+                   &writer);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  WriteModulesJSON(process_state.modules(),
+                   process_state.modules_without_symbols(),
+                   process_state.modules_with_corrupt_symbols(), &writer);
+  writer.EndObject();
+
+  const string& buffer = writer.buffer();
+  fwrite(buffer.data(), 1, buffer.size(), out);
+  fputc('\n', out);
+}
+
 }  // namespace google_breakpad
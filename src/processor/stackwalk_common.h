@@ -34,17 +34,30 @@
 #ifndef PROCESSOR_STACKWALK_COMMON_H__
 #define PROCESSOR_STACKWALK_COMMON_H__
 
+#include <stdio.h>
+
 namespace google_breakpad {
 
 class ProcessState;
 class SourceLineResolverInterface;
 
 void PrintProcessStateMachineReadable(const ProcessState& process_state);
+void PrintProcessStateMachineReadable(const ProcessState& process_state,
+                                      FILE* out);
 void PrintProcessState(const ProcessState& process_state,
                        bool output_stack_contents,
                        bool output_requesting_thread_only,
                        SourceLineResolverInterface* resolver);
 
+// Prints |process_state| to |out| as a single JSON object, built in one
+// buffer and written at once.  Register values and stack contents are
+// included only if |output_registers| and |output_stack_contents| are set.
+void PrintProcessStateJSON(const ProcessState& process_state,
+                           bool output_stack_contents,
+                           bool output_registers,
+                           bool output_requesting_thread_only,
+                           FILE* out);
+
 }  // namespace google_breakpad
 
 #endif  // PROCESSOR_STACKWALK_COMMON_H__
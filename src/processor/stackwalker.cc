@@ -37,7 +37,16 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+
 #include "common/scoped_ptr.h"
+#include "common/trace_probes.h"
 #include "google_breakpad/processor/call_stack.h"
 #include "google_breakpad/processor/code_module.h"
 #include "google_breakpad/processor/code_modules.h"
@@ -45,8 +54,10 @@
 #include "google_breakpad/processor/stack_frame.h"
 #include "google_breakpad/processor/stack_frame_symbolizer.h"
 #include "google_breakpad/processor/system_info.h"
+#include "processor/frame_arena.h"
 #include "processor/linked_ptr.h"
 #include "processor/logging.h"
+#include "processor/pathname_stripper.h"
 #include "processor/stackwalker_ppc.h"
 #include "processor/stackwalker_ppc64.h"
 #include "processor/stackwalker_sparc.h"
@@ -69,6 +80,10 @@ uint32_t Stackwalker::max_frames_ = 1 << 20;  // 1M
 bool Stackwalker::max_frames_set_ = false;
 
 uint32_t Stackwalker::max_frames_scanned_ = 1 << 14;  // 16k
+uint32_t Stackwalker::max_consecutive_frames_scanned_ =
+    std::numeric_limits<uint32_t>::max();
+uint64_t Stackwalker::max_words_scanned_ =
+    std::numeric_limits<uint64_t>::max();
 
 Stackwalker::Stackwalker(const SystemInfo* system_info,
                          MemoryRegion* memory,
@@ -78,7 +93,17 @@ Stackwalker::Stackwalker(const SystemInfo* system_info,
       memory_(memory),
       modules_(modules),
       unloaded_modules_(NULL),
-      frame_symbolizer_(frame_symbolizer) {
+      frame_symbolizer_(frame_symbolizer),
+      module_ranges_computed_(false),
+      cancellation_token_(NULL),
+      defer_symbolization_(false),
+      frame_pointer_modules_(NULL),
+      words_scanned_(0),
+      window_region_(NULL),
+      window_(NULL),
+      window_base_(0),
+      window_size_(0),
+      window_direct_(false) {
   assert(frame_symbolizer_);
 }
 
@@ -127,8 +152,10 @@ bool Stackwalker::Walk(
   // no more.
 
   // Keep track of the number of scanned or otherwise dubious frames seen
-  // so far, as the caller may have set a limit.
+  // so far, and in a row, as the caller may have set limits on both.
   uint32_t scanned_frames = 0;
+  uint32_t consecutive_scanned_frames = 0;
+  words_scanned_ = 0;
 
   // Take ownership of the pointer returned by GetContextFrame.
   scoped_ptr<StackFrame> frame(GetContextFrame());
@@ -139,11 +166,26 @@ bool Stackwalker::Walk(
     // context frame (above) or a caller frame (below).
 
     std::deque<std::unique_ptr<StackFrame>> inlined_frames;
-    // Resolve the module information, if a module map was provided.
-    StackFrameSymbolizer::SymbolizerResult symbolizer_result =
-        frame_symbolizer_->FillSourceLineInfo(modules_, unloaded_modules_,
-                                              system_info_,
-                                              frame.get(), &inlined_frames);
+    // Resolve the module information, if a module map was provided.  A
+    // frame whose caller is found by frame pointer needs no symbols to
+    // walk through, so if symbolizing can wait, only its module is found.
+    StackFrameSymbolizer::SymbolizerResult symbolizer_result;
+    if (defer_symbolization_ && frame_pointer_modules_ &&
+        frame_symbolizer_->HasImplementation()) {
+      frame->module = GetModuleForAddress(frame->instruction);
+    }
+    if (defer_symbolization_ && PrefersFramePointer(frame.get())) {
+      symbolizer_result = StackFrameSymbolizer::kNoError;
+    } else if (defer_symbolization_) {
+      symbolizer_result =
+          frame_symbolizer_->LoadSymbolsForFrame(modules_, unloaded_modules_,
+                                                 system_info_, frame.get());
+    } else {
+      symbolizer_result =
+          frame_symbolizer_->FillSourceLineInfo(modules_, unloaded_modules_,
+                                                system_info_, frame.get(),
+                                                &inlined_frames);
+    }
     switch (symbolizer_result) {
       case StackFrameSymbolizer::kInterrupt:
         BPLOG(INFO) << "Stack walk is interrupted.";
@@ -170,18 +212,24 @@ bool Stackwalker::Walk(
        case StackFrame::FRAME_TRUST_SCAN:
        case StackFrame::FRAME_TRUST_CFI_SCAN:
          scanned_frames++;
+         consecutive_scanned_frames++;
          break;
       default:
+        consecutive_scanned_frames = 0;
         break;
     }
     // Add all nested inlined frames belonging to this frame from the innermost
     // frame to the outermost frame.
     while (!inlined_frames.empty()) {
+      BREAKPAD_PROBE2(stackwalk_frame, inlined_frames.front()->instruction,
+                      static_cast<int>(inlined_frames.front()->trust));
       stack->frames_.push_back(inlined_frames.front().release());
       inlined_frames.pop_front();
     }
     // Add the frame to the call stack.  Relinquish the ownership claim
     // over the frame, because the stack now owns it.
+    BREAKPAD_PROBE2(stackwalk_frame, frame->instruction,
+                    static_cast<int>(frame->trust));
     stack->frames_.push_back(frame.release());
     if (stack->frames_.size() > max_frames_) {
       // Only emit an error message in the case where the limit
@@ -190,15 +238,117 @@ bool Stackwalker::Walk(
         BPLOG(ERROR) << "The stack is over " << max_frames_ << " frames.";
       break;
     }
+    if (IsCancelled()) {
+      BPLOG(INFO) << "Stack walk cancelled after " << stack->frames_.size()
+                  << " frames.";
+      break;
+    }
 
     // Get the next frame and take ownership.
-    bool stack_scan_allowed = scanned_frames < max_frames_scanned_;
+    bool stack_scan_allowed =
+        scanned_frames < max_frames_scanned_ &&
+        consecutive_scanned_frames < max_consecutive_frames_scanned_;
     frame.reset(GetCallerFrame(stack, stack_scan_allowed));
   }
 
   return true;
 }
 
+// static
+void Stackwalker::SymbolizeStacks(CallStack* const* stacks,
+                                  size_t count,
+                                  StackFrameSymbolizer* frame_symbolizer,
+                                  const SystemInfo* system_info,
+                                  int threads) {
+  // Every frame of every stack, in order, with the inlined frames
+  // symbolizing it finds.
+  struct WalkedFrame {
+    StackFrame* frame;
+    vector<StackFrame*> inlined_frames;
+  };
+  vector<WalkedFrame> walked;
+  for (size_t i = 0; i < count; ++i) {
+    const vector<StackFrame*>& frames = stacks[i]->frames_;
+    for (size_t j = 0; j < frames.size(); ++j) {
+      WalkedFrame walked_frame;
+      walked_frame.frame = frames[j];
+      walked.push_back(walked_frame);
+    }
+  }
+
+  // The frames that have a module, by module and then by address.
+  vector<size_t> order;
+  for (size_t i = 0; i < walked.size(); ++i) {
+    if (walked[i].frame->module)
+      order.push_back(i);
+  }
+  std::less<const CodeModule*> module_less;
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    const StackFrame* frame_a = walked[a].frame;
+    const StackFrame* frame_b = walked[b].frame;
+    if (frame_a->module != frame_b->module)
+      return module_less(frame_a->module, frame_b->module);
+    return frame_a->instruction < frame_b->instruction;
+  });
+  vector<size_t> module_starts;
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (i == 0 || walked[order[i]].frame->module !=
+                      walked[order[i - 1]].frame->module) {
+      module_starts.push_back(i);
+    }
+  }
+  module_starts.push_back(order.size());
+
+  // The inlined frames come from the caller's frame arena, if it has one,
+  // whichever thread finds them.
+  FrameArena* frame_arena = FrameArena::Current();
+  std::atomic<size_t> next_module(0);
+  auto symbolize_modules = [&]() {
+    ScopedFrameArena scoped_frame_arena(frame_arena);
+    size_t module;
+    while ((module = next_module++) + 1 < module_starts.size()) {
+      frame_symbolizer->LoadModuleSymbols(
+          walked[order[module_starts[module]]].frame->module, system_info);
+      for (size_t i = module_starts[module]; i < module_starts[module + 1];
+           ++i) {
+        WalkedFrame* walked_frame = &walked[order[i]];
+        std::deque<std::unique_ptr<StackFrame>> inlined_frames;
+        frame_symbolizer->FillModuleSourceLineInfo(walked_frame->frame,
+                                                   &inlined_frames);
+        for (size_t j = 0; j < inlined_frames.size(); ++j) {
+          walked_frame->inlined_frames.push_back(
+              inlined_frames[j].release());
+        }
+      }
+    }
+  };
+  size_t module_count = module_starts.size() - 1;
+  size_t thread_count = frame_symbolizer->IsThreadSafe() ?
+      std::min(static_cast<size_t>(std::max(threads, 1)), module_count) : 1;
+  vector<std::thread> workers;
+  for (size_t i = 1; i < thread_count; ++i)
+    workers.push_back(std::thread(symbolize_modules));
+  symbolize_modules();
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+
+  // Put each frame's inlined frames before it, from the innermost to the
+  // outermost, as Walk() does.
+  size_t next_walked = 0;
+  for (size_t i = 0; i < count; ++i) {
+    vector<StackFrame*>* frames = &stacks[i]->frames_;
+    vector<StackFrame*> symbolized;
+    for (size_t j = 0; j < frames->size(); ++j, ++next_walked) {
+      const vector<StackFrame*>& inlined_frames =
+          walked[next_walked].inlined_frames;
+      symbolized.insert(symbolized.end(), inlined_frames.begin(),
+                        inlined_frames.end());
+      symbolized.push_back(walked[next_walked].frame);
+    }
+    frames->swap(symbolized);
+  }
+}
+
 // static
 Stackwalker* Stackwalker::StackwalkerForCPU(
     const SystemInfo* system_info,
@@ -308,6 +458,111 @@ bool Stackwalker::TerminateWalk(uint64_t caller_ip,
   return false;
 }
 
+const Stackwalker::ModuleRanges& Stackwalker::GetModuleRanges() {
+  if (module_ranges_computed_)
+    return module_ranges_;
+  module_ranges_computed_ = true;
+  if (!modules_)
+    return module_ranges_;
+
+  ModuleRanges ranges;
+  for (unsigned int i = 0; i < modules_->module_count(); ++i) {
+    const CodeModule* module = modules_->GetModuleAtIndex(i);
+    if (!module || module->size() == 0)
+      continue;
+    uint64_t start = module->base_address();
+    uint64_t end = start + module->size();
+    if (end < start)
+      end = std::numeric_limits<uint64_t>::max();
+    ranges.push_back(std::make_pair(start, end));
+  }
+  std::sort(ranges.begin(), ranges.end());
+
+  // Merge overlapping and adjacent ranges.
+  for (ModuleRanges::const_iterator it = ranges.begin(); it != ranges.end();
+       ++it) {
+    if (!module_ranges_.empty() && it->first <= module_ranges_.back().second) {
+      if (it->second > module_ranges_.back().second)
+        module_ranges_.back().second = it->second;
+    } else {
+      module_ranges_.push_back(*it);
+    }
+  }
+  return module_ranges_;
+}
+
+bool Stackwalker::AddressInModuleRanges(uint64_t address) const {
+  // Find the first range starting after address; the one before it is the
+  // only one that can contain address.
+  ModuleRanges::const_iterator it =
+      std::upper_bound(module_ranges_.begin(), module_ranges_.end(),
+                       std::make_pair(address,
+                                      std::numeric_limits<uint64_t>::max()));
+  if (it == module_ranges_.begin())
+    return false;
+  --it;
+  return address < it->second;
+}
+
+const uint8_t* Stackwalker::MoveStackWindow(uint64_t address,
+                                            size_t size) const {
+  // A region read from a minidump by page only reads the pages a window
+  // covers, so it takes in no more than this at a time.
+  static const uint64_t kWindowBytes = 64 * 1024;
+
+  if (window_region_ != memory_) {
+    window_region_ = memory_;
+    window_ = NULL;
+    window_base_ = 0;
+    window_size_ = 0;
+    window_direct_ = memory_ && !memory_->IsByteSwapped();
+  }
+  if (!window_direct_)
+    return NULL;
+  const uint64_t base = memory_->GetBase();
+  if (address < base || address - base >= memory_->GetSize())
+    return NULL;
+
+  uint64_t start = address & ~(kWindowBytes - 1);
+  if (start < base)
+    start = base;
+  size_t length = 0;
+  const uint8_t* span = memory_->GetMemorySpan(start, kWindowBytes, &length);
+  if (!span) {
+    window_direct_ = false;
+    return NULL;
+  }
+  window_ = span;
+  window_base_ = start;
+  window_size_ = length;
+  const uint64_t offset = address - start;
+  if (offset >= length || length - offset < size)
+    return NULL;
+  return span + offset;
+}
+
+const CodeModule* Stackwalker::GetModuleForAddress(uint64_t address) const {
+  const CodeModule* module =
+      modules_ ? modules_->GetModuleForAddress(address) : NULL;
+  if (!module && unloaded_modules_)
+    module = unloaded_modules_->GetModuleForAddress(address);
+  return module;
+}
+
+bool Stackwalker::PrefersFramePointer(const StackFrame* frame) const {
+  return frame_pointer_modules_ && SupportsFramePointerFirst() &&
+      frame->trust != StackFrame::FRAME_TRUST_CONTEXT && frame->module &&
+      frame_pointer_modules_->count(
+          PathnameStripper::File(frame->module->code_file())) != 0;
+}
+
+CFIFrameInfo* Stackwalker::FindCFIFrameInfo(StackFrame* frame) {
+  // Walk() skips loading the symbols of exactly these frames' modules.
+  if (defer_symbolization_ && PrefersFramePointer(frame))
+    frame_symbolizer_->LoadModuleSymbols(frame->module, system_info_);
+  return frame_symbolizer_->FindCFIFrameInfo(frame);
+}
+
 bool Stackwalker::InstructionAddressSeemsValid(uint64_t address) const {
   StackFrame frame;
   frame.instruction = address;
@@ -56,39 +56,39 @@ StackwalkerAMD64::cfi_register_map_[] = {
   // unchanged if the CFI doesn't mention them --- clearly wrong for $rip
   // and $rsp.
   { "$rax", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_RAX, &MDRawContextAMD64::rax },
+    StackFrameAMD64::CONTEXT_VALID_RAX, &StackFrameAMD64::Registers::rax },
   { "$rdx", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_RDX, &MDRawContextAMD64::rdx },
+    StackFrameAMD64::CONTEXT_VALID_RDX, &StackFrameAMD64::Registers::rdx },
   { "$rcx", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_RCX, &MDRawContextAMD64::rcx },
+    StackFrameAMD64::CONTEXT_VALID_RCX, &StackFrameAMD64::Registers::rcx },
   { "$rbx", NULL, true,
-    StackFrameAMD64::CONTEXT_VALID_RBX, &MDRawContextAMD64::rbx },
+    StackFrameAMD64::CONTEXT_VALID_RBX, &StackFrameAMD64::Registers::rbx },
   { "$rsi", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_RSI, &MDRawContextAMD64::rsi },
+    StackFrameAMD64::CONTEXT_VALID_RSI, &StackFrameAMD64::Registers::rsi },
   { "$rdi", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_RDI, &MDRawContextAMD64::rdi },
+    StackFrameAMD64::CONTEXT_VALID_RDI, &StackFrameAMD64::Registers::rdi },
   { "$rbp", NULL, true,
-    StackFrameAMD64::CONTEXT_VALID_RBP, &MDRawContextAMD64::rbp },
+    StackFrameAMD64::CONTEXT_VALID_RBP, &StackFrameAMD64::Registers::rbp },
   { "$rsp", ".cfa", false,
-    StackFrameAMD64::CONTEXT_VALID_RSP, &MDRawContextAMD64::rsp },
+    StackFrameAMD64::CONTEXT_VALID_RSP, &StackFrameAMD64::Registers::rsp },
   { "$r8", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_R8,  &MDRawContextAMD64::r8 },
+    StackFrameAMD64::CONTEXT_VALID_R8,  &StackFrameAMD64::Registers::r8 },
   { "$r9", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_R9,  &MDRawContextAMD64::r9 },
+    StackFrameAMD64::CONTEXT_VALID_R9,  &StackFrameAMD64::Registers::r9 },
   { "$r10", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_R10, &MDRawContextAMD64::r10 },
+    StackFrameAMD64::CONTEXT_VALID_R10, &StackFrameAMD64::Registers::r10 },
   { "$r11", NULL, false,
-    StackFrameAMD64::CONTEXT_VALID_R11, &MDRawContextAMD64::r11 },
+    StackFrameAMD64::CONTEXT_VALID_R11, &StackFrameAMD64::Registers::r11 },
   { "$r12", NULL, true,
-    StackFrameAMD64::CONTEXT_VALID_R12, &MDRawContextAMD64::r12 },
+    StackFrameAMD64::CONTEXT_VALID_R12, &StackFrameAMD64::Registers::r12 },
   { "$r13", NULL, true,
-    StackFrameAMD64::CONTEXT_VALID_R13, &MDRawContextAMD64::r13 },
+    StackFrameAMD64::CONTEXT_VALID_R13, &StackFrameAMD64::Registers::r13 },
   { "$r14", NULL, true,
-    StackFrameAMD64::CONTEXT_VALID_R14, &MDRawContextAMD64::r14 },
+    StackFrameAMD64::CONTEXT_VALID_R14, &StackFrameAMD64::Registers::r14 },
   { "$r15", NULL, true,
-    StackFrameAMD64::CONTEXT_VALID_R15, &MDRawContextAMD64::r15 },
+    StackFrameAMD64::CONTEXT_VALID_R15, &StackFrameAMD64::Registers::r15 },
   { "$rip", ".ra", false,
-    StackFrameAMD64::CONTEXT_VALID_RIP, &MDRawContextAMD64::rip },
+    StackFrameAMD64::CONTEXT_VALID_RIP, &StackFrameAMD64::Registers::rip },
 };
 
 StackwalkerAMD64::StackwalkerAMD64(const SystemInfo* system_info,
@@ -118,6 +118,7 @@ StackFrame* StackwalkerAMD64::GetContextFrame() {
   // The instruction pointer is stored directly in a register, so pull it
   // straight out of the CPU context structure.
   frame->context = *context_;
+  frame->raw_context.reset(new MDRawContextAMD64(*context_));
   frame->context_validity = StackFrameAMD64::CONTEXT_VALID_ALL;
   frame->trust = StackFrame::FRAME_TRUST_CONTEXT;
   frame->instruction = frame->context.rip;
@@ -185,8 +186,8 @@ StackFrameAMD64* StackwalkerAMD64::GetCallerByFramePointerRecovery(
   }
 
   uint64_t caller_rip, caller_rbp;
-  if (memory_->GetMemoryAtAddress(last_rbp + 8, &caller_rip) &&
-      memory_->GetMemoryAtAddress(last_rbp, &caller_rbp)) {
+  if (GetStackMemory(last_rbp + 8, &caller_rip) &&
+      GetStackMemory(last_rbp, &caller_rbp)) {
     uint64_t caller_rsp = last_rbp + 16;
 
     // If the recovered rip is not a canonical address it can't be
@@ -202,7 +203,7 @@ StackFrameAMD64* StackwalkerAMD64::GetCallerByFramePointerRecovery(
 
     // Sanity check that resulting rbp is still inside stack memory.
     uint64_t unused;
-    if (!memory_->GetMemoryAtAddress(caller_rbp, &unused)) {
+    if (!GetStackMemory(caller_rbp, &unused)) {
       return NULL;
     }
 
@@ -255,7 +256,7 @@ StackFrameAMD64* StackwalkerAMD64::GetCallerByStackScan(
     // that the caller's %rbp is saved there.
     if (caller_rip_address - 8 == last_frame->context.rbp) {
       uint64_t caller_rbp = 0;
-      if (memory_->GetMemoryAtAddress(last_frame->context.rbp, &caller_rbp) &&
+      if (GetStackMemory(last_frame->context.rbp, &caller_rbp) &&
           caller_rbp > caller_rip_address) {
         frame->context.rbp = caller_rbp;
         frame->context_validity |= StackFrameAMD64::CONTEXT_VALID_RBP;
@@ -282,14 +283,21 @@ StackFrame* StackwalkerAMD64::GetCallerFrame(const CallStack* stack,
   StackFrameAMD64* last_frame = static_cast<StackFrameAMD64*>(frames.back());
   scoped_ptr<StackFrameAMD64> new_frame;
 
+  // In modules built with frame pointers, trust the frame pointer chain
+  // first, which needs no symbols.
+  bool frame_pointer_first = PrefersFramePointer(last_frame);
+  if (frame_pointer_first)
+    new_frame.reset(GetCallerByFramePointerRecovery(frames));
+
   // If we have DWARF CFI information, use it.
-  scoped_ptr<CFIFrameInfo> cfi_frame_info(
-      frame_symbolizer_->FindCFIFrameInfo(last_frame));
-  if (cfi_frame_info.get())
-    new_frame.reset(GetCallerByCFIFrameInfo(frames, cfi_frame_info.get()));
+  if (!new_frame.get()) {
+    scoped_ptr<CFIFrameInfo> cfi_frame_info(FindCFIFrameInfo(last_frame));
+    if (cfi_frame_info.get())
+      new_frame.reset(GetCallerByCFIFrameInfo(frames, cfi_frame_info.get()));
+  }
 
   // If CFI was not available or failed, try using frame pointer recovery.
-  if (!new_frame.get()) {
+  if (!new_frame.get() && !frame_pointer_first) {
     new_frame.reset(GetCallerByFramePointerRecovery(frames));
   }
 
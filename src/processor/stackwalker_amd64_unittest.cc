@@ -32,6 +32,7 @@
 // stackwalker_amd64_unittest.cc: Unit tests for StackwalkerAMD64 class.
 
 #include <string.h>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -59,6 +60,7 @@ using google_breakpad::SystemInfo;
 using google_breakpad::test_assembler::kLittleEndian;
 using google_breakpad::test_assembler::Label;
 using google_breakpad::test_assembler::Section;
+using std::set;
 using std::vector;
 using testing::_;
 using testing::AnyNumber;
@@ -169,7 +171,8 @@ TEST_F(SanityCheck, NoResolver) {
   StackFrameAMD64 *frame = static_cast<StackFrameAMD64*>(frames->at(0));
   // Check that the values from the original raw context made it
   // through to the context in the stack frame.
-  EXPECT_EQ(0, memcmp(&raw_context, &frame->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame->raw_context.get(),
+                      sizeof(raw_context)));
 }
 
 TEST_F(GetContextFrame, Simple) {
@@ -195,7 +198,8 @@ TEST_F(GetContextFrame, Simple) {
   StackFrameAMD64 *frame = static_cast<StackFrameAMD64*>(frames->at(0));
   // Check that the values from the original raw context made it
   // through to the context in the stack frame.
-  EXPECT_EQ(0, memcmp(&raw_context, &frame->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame->raw_context.get(),
+                      sizeof(raw_context)));
 }
 
 // The stackwalker should be able to produce the context frame even
@@ -219,7 +223,8 @@ TEST_F(GetContextFrame, NoStackMemory) {
   StackFrameAMD64 *frame = static_cast<StackFrameAMD64*>(frames->at(0));
   // Check that the values from the original raw context made it
   // through to the context in the stack frame.
-  EXPECT_EQ(0, memcmp(&raw_context, &frame->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame->raw_context.get(),
+                      sizeof(raw_context)));
 }
 
 class GetCallerFrame: public StackwalkerAMD64Fixture, public Test { };
@@ -282,10 +287,12 @@ TEST_F(GetCallerFrame, ScanWithoutSymbols) {
   StackFrameAMD64 *frame0 = static_cast<StackFrameAMD64*>(frames->at(0));
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameAMD64::CONTEXT_VALID_ALL, frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
 
   StackFrameAMD64 *frame1 = static_cast<StackFrameAMD64*>(frames->at(1));
   EXPECT_EQ(StackFrame::FRAME_TRUST_SCAN, frame1->trust);
+  EXPECT_FALSE(frame1->raw_context);
   ASSERT_EQ((StackFrameAMD64::CONTEXT_VALID_RIP |
              StackFrameAMD64::CONTEXT_VALID_RSP |
              StackFrameAMD64::CONTEXT_VALID_RBP),
@@ -543,7 +550,8 @@ TEST_F(GetCallerFrame, FramePointerNotAligned) {
   StackFrameAMD64 *frame0 = static_cast<StackFrameAMD64*>(frames->at(0));
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameAMD64::CONTEXT_VALID_ALL, frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
 
   StackFrameAMD64 *frame1 = static_cast<StackFrameAMD64*>(frames->at(1));
   EXPECT_EQ(StackFrame::FRAME_TRUST_SCAN, frame1->trust);
@@ -593,7 +601,8 @@ TEST_F(GetCallerFrame, NonCanonicalInstructionPointerFromFramePointer) {
   StackFrameAMD64 *frame0 = static_cast<StackFrameAMD64*>(frames->at(0));
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameAMD64::CONTEXT_VALID_ALL, frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
 
   StackFrameAMD64 *frame1 = static_cast<StackFrameAMD64*>(frames->at(1));
   EXPECT_EQ(StackFrame::FRAME_TRUST_SCAN, frame1->trust);
@@ -663,7 +672,8 @@ TEST_F(GetCallerFrame, ScanningNotAllowed) {
   StackFrameAMD64 *frame0 = static_cast<StackFrameAMD64*>(frames->at(0));
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameAMD64::CONTEXT_VALID_ALL, frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
 }
 
 TEST_F(GetCallerFrame, CallerPushedRBP) {
@@ -932,3 +942,109 @@ TEST_F(CFI, At4006) {
   raw_context.r13 = 0x00007400c0005510ULL; // return address
   CheckWalk();
 }
+
+// module2 is built with frame pointers, and its CFI and its frame pointer
+// chain disagree on who called it, so that tests can tell which the
+// walker followed.
+struct FramePointerFirstFixture: public StackwalkerAMD64Fixture {
+  FramePointerFirstFixture() {
+    SetModuleSymbols(&module1,
+                     "FUNC 100 100 0 context_function\n"
+                     "STACK CFI INIT 100 100 .cfa: $rsp 8 + .ra: .cfa 8 - ^\n"
+                     "FUNC 200 200 0 caller_function\n");
+    SetModuleSymbols(&module2,
+                     "FUNC 400 100 0 frame_pointer_function\n"
+                     "STACK CFI INIT 400 100 .cfa: $rsp 16 + "
+                     ".ra: .cfa 8 - ^\n");
+    frame_pointer_modules.insert("module2");
+
+    Label frame1_rbp, frame2_rbp;
+    stack_section.start() = 0x8000000080000000ULL;
+    stack_section
+      .D64(0x00007500b0000480ULL)  // return address into module2
+      .D64(0)                      // garbage
+      .D64(0x00007400c0000280ULL)  // return address, by CFI
+      .Append(16, 0)
+      .Mark(&frame1_rbp)
+      .D64(frame2_rbp)             // caller's %rbp
+      .D64(0x00007400c0000380ULL)  // return address, by frame pointer
+      .Append(16, 0)
+      .Mark(&frame2_rbp)
+      .D64(0)
+      .D64(0);
+    RegionFromSection();
+    raw_context.rip = 0x00007400c0000120ULL;
+    raw_context.rsp = stack_section.start().Value();
+    raw_context.rbp = frame1_rbp.Value();
+  }
+
+  // Walk the stack, by frame pointer first through module2 if
+  // |frame_pointer_first|, with symbolization deferred if |defer|, and
+  // expect |frame_count| frames.
+  void Walk(StackFrameSymbolizer* frame_symbolizer, bool frame_pointer_first,
+            bool defer, size_t frame_count) {
+    StackwalkerAMD64 walker(&system_info, &raw_context, &stack_region,
+                            &modules, frame_symbolizer);
+    if (frame_pointer_first)
+      walker.set_frame_pointer_modules(&frame_pointer_modules);
+    walker.set_defer_symbolization(defer);
+    vector<const CodeModule*> modules_without_symbols;
+    vector<const CodeModule*> modules_with_corrupt_symbols;
+    ASSERT_TRUE(walker.Walk(&call_stack, &modules_without_symbols,
+                            &modules_with_corrupt_symbols));
+    EXPECT_EQ(0U, modules_without_symbols.size());
+    frames = call_stack.frames();
+    ASSERT_EQ(frame_count, frames->size());
+    EXPECT_EQ(&module2, frames->at(1)->module);
+  }
+
+  set<string> frame_pointer_modules;
+};
+
+class FramePointerFirst: public FramePointerFirstFixture, public Test { };
+
+TEST_F(FramePointerFirst, CFIByDefault) {
+  StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+  Walk(&frame_symbolizer, false, false, 4);
+  EXPECT_EQ(StackFrame::FRAME_TRUST_CFI, frames->at(2)->trust);
+  EXPECT_EQ(0x00007400c0000280ULL, frames->at(2)->instruction + 1);
+  // The frame pointer, left alone by the CFI, leads on from there.
+  EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frames->at(3)->trust);
+}
+
+TEST_F(FramePointerFirst, FramePointer) {
+  StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+  Walk(&frame_symbolizer, true, false, 3);
+  EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frames->at(2)->trust);
+  EXPECT_EQ(0x00007400c0000380ULL, frames->at(2)->instruction + 1);
+  EXPECT_EQ("frame_pointer_function", frames->at(1)->function_name);
+}
+
+// With symbolization deferred, module2's symbols aren't loaded until the
+// frames are symbolized.
+TEST_F(FramePointerFirst, SymbolsLoadedToSymbolize) {
+  StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+  Walk(&frame_symbolizer, true, true, 3);
+  EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frames->at(2)->trust);
+  EXPECT_TRUE(resolver.HasModule(&module1));
+  EXPECT_FALSE(resolver.HasModule(&module2));
+
+  CallStack* stacks[] = { &call_stack };
+  Stackwalker::SymbolizeStacks(stacks, 1, &frame_symbolizer, &system_info, 1);
+  EXPECT_TRUE(resolver.HasModule(&module2));
+  EXPECT_EQ("context_function", frames->at(0)->function_name);
+  EXPECT_EQ("frame_pointer_function", frames->at(1)->function_name);
+  EXPECT_EQ("caller_function", frames->at(2)->function_name);
+}
+
+// If the frame pointer chain is broken, CFI is still used, loading the
+// symbols it needs.
+TEST_F(FramePointerFirst, CFIWhenFramePointerFails) {
+  raw_context.rbp = 0x8000000080000003ULL;  // not aligned
+  StackFrameSymbolizer frame_symbolizer(&supplier, &resolver);
+  // The frame pointer's return address is then found by scanning.
+  Walk(&frame_symbolizer, true, true, 4);
+  EXPECT_TRUE(resolver.HasModule(&module2));
+  EXPECT_EQ(StackFrame::FRAME_TRUST_CFI, frames->at(2)->trust);
+  EXPECT_EQ(0x00007400c0000280ULL, frames->at(2)->instruction + 1);
+}
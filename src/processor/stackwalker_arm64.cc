@@ -89,6 +89,7 @@ StackFrame* StackwalkerARM64::GetContextFrame() {
   // The instruction pointer is stored directly in a register (x32), so pull it
   // straight out of the CPU context structure.
   frame->context = *context_;
+  frame->raw_context.reset(new MDRawContextARM64(*context_));
   frame->context_validity = context_frame_validity_;
   frame->trust = StackFrame::FRAME_TRUST_CONTEXT;
   frame->instruction = frame->context.iregs[MD_CONTEXT_ARM64_REG_PC];
@@ -111,29 +112,35 @@ StackFrameARM64* StackwalkerARM64::GetCallerByCFIFrameInfo(
     "pc",  NULL
   };
 
-  // Populate a dictionary with the valid register values in last_frame.
-  CFIFrameInfo::RegisterValueMap<uint64_t> callee_registers;
-  for (int i = 0; register_names[i]; i++) {
+  static const size_t register_count =
+      sizeof(register_names) / sizeof(register_names[0]) - 1;
+
+  // Populate an array with the valid register values in last_frame,
+  // numbered by their position in register_names.
+  RegisterValueArray<uint64_t> callee_registers;
+  for (size_t i = 0; i < register_count; i++) {
     if (last_frame->context_validity & StackFrameARM64::RegisterValidFlag(i))
-      callee_registers[register_names[i]] = last_frame->context.iregs[i];
+      callee_registers.Set(i, last_frame->context.iregs[i]);
   }
 
   // Use the STACK CFI data to recover the caller's register values.
-  CFIFrameInfo::RegisterValueMap<uint64_t> caller_registers;
-  if (!cfi_frame_info->FindCallerRegs(callee_registers, *memory_,
-                                      &caller_registers)) {
+  RegisterValueArray<uint64_t> caller_registers;
+  uint64_t caller_ra, caller_cfa;
+  if (!cfi_frame_info->FindCallerRegs(register_names, register_count,
+                                      callee_registers, *memory_,
+                                      &caller_registers, &caller_ra,
+                                      &caller_cfa)) {
     return NULL;
   }
   // Construct a new stack frame given the values the CFI recovered.
   scoped_ptr<StackFrameARM64> frame(new StackFrameARM64());
-  for (int i = 0; register_names[i]; i++) {
-    CFIFrameInfo::RegisterValueMap<uint64_t>::iterator entry =
-      caller_registers.find(register_names[i]);
-    if (entry != caller_registers.end()) {
+  for (size_t i = 0; i < register_count; i++) {
+    uint64_t value;
+    if (caller_registers.Get(i, &value)) {
       // We recovered the value of this register; fill the context with the
       // value from caller_registers.
       frame->context_validity |= StackFrameARM64::RegisterValidFlag(i);
-      frame->context.iregs[i] = entry->second;
+      frame->context.iregs[i] = value;
     } else if (19 <= i && i <= 29 && (last_frame->context_validity &
                                       StackFrameARM64::RegisterValidFlag(i))) {
       // If the STACK CFI data doesn't mention some callee-saves register, and
@@ -147,21 +154,13 @@ StackFrameARM64* StackwalkerARM64::GetCallerByCFIFrameInfo(
   }
   // If the CFI doesn't recover the PC explicitly, then use .ra.
   if (!(frame->context_validity & StackFrameARM64::CONTEXT_VALID_PC)) {
-    CFIFrameInfo::RegisterValueMap<uint64_t>::iterator entry =
-      caller_registers.find(".ra");
-    if (entry != caller_registers.end()) {
-      frame->context_validity |= StackFrameARM64::CONTEXT_VALID_PC;
-      frame->context.iregs[MD_CONTEXT_ARM64_REG_PC] = entry->second;
-    }
+    frame->context_validity |= StackFrameARM64::CONTEXT_VALID_PC;
+    frame->context.iregs[MD_CONTEXT_ARM64_REG_PC] = caller_ra;
   }
   // If the CFI doesn't recover the SP explicitly, then use .cfa.
   if (!(frame->context_validity & StackFrameARM64::CONTEXT_VALID_SP)) {
-    CFIFrameInfo::RegisterValueMap<uint64_t>::iterator entry =
-      caller_registers.find(".cfa");
-    if (entry != caller_registers.end()) {
-      frame->context_validity |= StackFrameARM64::CONTEXT_VALID_SP;
-      frame->context.iregs[MD_CONTEXT_ARM64_REG_SP] = entry->second;
-    }
+    frame->context_validity |= StackFrameARM64::CONTEXT_VALID_SP;
+    frame->context.iregs[MD_CONTEXT_ARM64_REG_SP] = caller_cfa;
   }
 
   // If we didn't recover the PC and the SP, then the frame isn't very useful.
@@ -215,14 +214,14 @@ StackFrameARM64* StackwalkerARM64::GetCallerByFramePointer(
   uint64_t last_fp = last_frame->context.iregs[MD_CONTEXT_ARM64_REG_FP];
 
   uint64_t caller_fp = 0;
-  if (last_fp && !memory_->GetMemoryAtAddress(last_fp, &caller_fp)) {
+  if (last_fp && !GetStackMemory(last_fp, &caller_fp)) {
     BPLOG(ERROR) << "Unable to read caller_fp from last_fp: 0x"
                  << std::hex << last_fp;
     return NULL;
   }
 
   uint64_t caller_lr = 0;
-  if (last_fp && !memory_->GetMemoryAtAddress(last_fp + 8, &caller_lr)) {
+  if (last_fp && !GetStackMemory(last_fp + 8, &caller_lr)) {
     BPLOG(ERROR) << "Unable to read caller_lr from last_fp + 8: 0x"
                  << std::hex << (last_fp + 8);
     return NULL;
@@ -267,7 +266,7 @@ void StackwalkerARM64::CorrectRegLRByFramePointer(
       last_last_frame->context.iregs[MD_CONTEXT_ARM64_REG_FP];
 
   uint64_t last_fp = 0;
-  if (last_last_fp && !memory_->GetMemoryAtAddress(last_last_fp, &last_fp)) {
+  if (last_last_fp && !GetStackMemory(last_last_fp, &last_fp)) {
     BPLOG(ERROR) << "Unable to read last_fp from last_last_fp: 0x"
                  << std::hex << last_last_fp;
     return;
@@ -277,7 +276,7 @@ void StackwalkerARM64::CorrectRegLRByFramePointer(
     return;
 
   uint64_t last_lr = 0;
-  if (last_last_fp && !memory_->GetMemoryAtAddress(last_last_fp + 8, &last_lr)) {
+  if (last_last_fp && !GetStackMemory(last_last_fp + 8, &last_lr)) {
     BPLOG(ERROR) << "Unable to read last_lr from (last_last_fp + 8): 0x"
                  << std::hex << (last_last_fp + 8);
     return;
@@ -298,14 +297,21 @@ StackFrame* StackwalkerARM64::GetCallerFrame(const CallStack* stack,
   StackFrameARM64* last_frame = static_cast<StackFrameARM64*>(frames.back());
   scoped_ptr<StackFrameARM64> frame;
 
+  // In modules built with frame pointers, trust the frame pointer chain
+  // first, which needs no symbols.
+  bool frame_pointer_first = PrefersFramePointer(last_frame);
+  if (frame_pointer_first)
+    frame.reset(GetCallerByFramePointer(frames));
+
   // See if there is DWARF call frame information covering this address.
-  scoped_ptr<CFIFrameInfo> cfi_frame_info(
-      frame_symbolizer_->FindCFIFrameInfo(last_frame));
-  if (cfi_frame_info.get())
-    frame.reset(GetCallerByCFIFrameInfo(frames, cfi_frame_info.get()));
+  if (!frame.get()) {
+    scoped_ptr<CFIFrameInfo> cfi_frame_info(FindCFIFrameInfo(last_frame));
+    if (cfi_frame_info.get())
+      frame.reset(GetCallerByCFIFrameInfo(frames, cfi_frame_info.get()));
+  }
 
   // If CFI failed, or there wasn't CFI available, fall back to frame pointer.
-  if (!frame.get())
+  if (!frame.get() && !frame_pointer_first)
     frame.reset(GetCallerByFramePointer(frames));
 
   // If everything failed, fall back to stack scanning.
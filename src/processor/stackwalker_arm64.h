@@ -75,6 +75,7 @@ class StackwalkerARM64 : public Stackwalker {
   virtual StackFrame* GetContextFrame();
   virtual StackFrame* GetCallerFrame(const CallStack* stack,
                                      bool stack_scan_allowed);
+  virtual bool SupportsFramePointerFirst() const { return true; }
 
   // Use cfi_frame_info (derived from STACK CFI records) to construct
   // the frame that called frames.back(). The caller takes ownership
@@ -162,7 +162,8 @@ TEST_F(SanityCheck, NoResolver) {
   StackFrameARM64 *frame = static_cast<StackFrameARM64*>(frames->at(0));
   // Check that the values from the original raw context made it
   // through to the context in the stack frame.
-  EXPECT_EQ(0, memcmp(&raw_context, &frame->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame->raw_context.get(),
+                      sizeof(raw_context)));
 }
 
 class GetContextFrame: public StackwalkerARM64Fixture, public Test { };
@@ -184,7 +185,8 @@ TEST_F(GetContextFrame, NoStackMemory) {
   StackFrameARM64 *frame = static_cast<StackFrameARM64*>(frames->at(0));
   // Check that the values from the original raw context made it
   // through to the context in the stack frame.
-  EXPECT_EQ(0, memcmp(&raw_context, &frame->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame->raw_context.get(),
+                      sizeof(raw_context)));
 }
 
 class GetCallerFrame: public StackwalkerARM64Fixture, public Test { };
@@ -241,10 +243,12 @@ TEST_F(GetCallerFrame, ScanWithoutSymbols) {
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameARM64::CONTEXT_VALID_ALL,
             frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
 
   StackFrameARM64 *frame1 = static_cast<StackFrameARM64*>(frames->at(1));
   EXPECT_EQ(StackFrame::FRAME_TRUST_SCAN, frame1->trust);
+  EXPECT_FALSE(frame1->raw_context);
   ASSERT_EQ((StackFrameARM64::CONTEXT_VALID_PC |
              StackFrameARM64::CONTEXT_VALID_SP),
             frame1->context_validity);
@@ -311,7 +315,8 @@ TEST_F(GetCallerFrame, ScanWithFunctionSymbols) {
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameARM64::CONTEXT_VALID_ALL,
             frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
   EXPECT_EQ("monotreme", frame0->function_name);
   EXPECT_EQ(0x40000100ULL, frame0->function_base);
 
@@ -380,7 +385,8 @@ TEST_F(GetCallerFrame, ScanFirstFrame) {
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameARM64::CONTEXT_VALID_ALL,
             frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
 
   StackFrameARM64 *frame1 = static_cast<StackFrameARM64*>(frames->at(1));
   EXPECT_EQ(StackFrame::FRAME_TRUST_SCAN, frame1->trust);
@@ -444,7 +450,8 @@ TEST_F(GetCallerFrame, ScanningNotAllowed) {
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameARM64::CONTEXT_VALID_ALL,
             frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
 }
 
 class GetFramesByFramePointer: public StackwalkerARM64Fixture, public Test { };
@@ -507,7 +514,8 @@ TEST_F(GetFramesByFramePointer, OnlyFramePointer) {
   EXPECT_EQ(StackFrame::FRAME_TRUST_CONTEXT, frame0->trust);
   ASSERT_EQ(StackFrameARM64::CONTEXT_VALID_ALL,
             frame0->context_validity);
-  EXPECT_EQ(0, memcmp(&raw_context, &frame0->context, sizeof(raw_context)));
+  EXPECT_EQ(0, memcmp(&raw_context, frame0->raw_context.get(),
+                      sizeof(raw_context)));
 
   StackFrameARM64 *frame1 = static_cast<StackFrameARM64*>(frames->at(1));
   EXPECT_EQ(StackFrame::FRAME_TRUST_FP, frame1->trust);
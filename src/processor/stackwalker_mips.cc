@@ -103,6 +103,9 @@ static const char* const kRegisterNames[] = {
   // TODO(gordanac): add float point save registers
 };
 
+static const size_t kRegisterCount =
+    sizeof(kRegisterNames) / sizeof(kRegisterNames[0]) - 1;
+
 StackFrameMIPS* StackwalkerMIPS::GetCallerByCFIFrameInfo(
     const vector<StackFrame*>& frames,
     CFIFrameInfo* cfi_frame_info) {
@@ -111,45 +114,35 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByCFIFrameInfo(
   if (context_->context_flags & MD_CONTEXT_MIPS) {
     uint32_t pc = 0;
 
-    // Populate a dictionary with the valid register values in last_frame.
-    CFIFrameInfo::RegisterValueMap<uint32_t> callee_registers;
+    // Populate an array with the register values in last_frame, numbered
+    // by their position in kRegisterNames.
+    RegisterValueArray<uint32_t> callee_registers;
     // Use the STACK CFI data to recover the caller's register values.
-    CFIFrameInfo::RegisterValueMap<uint32_t> caller_registers;
+    RegisterValueArray<uint32_t> caller_registers;
+    uint32_t caller_ra, caller_cfa;
 
-    for (int i = 0; kRegisterNames[i]; ++i) {
-      caller_registers[kRegisterNames[i]] = last_frame->context.iregs[i];
-      callee_registers[kRegisterNames[i]] = last_frame->context.iregs[i];
-    }
+    for (size_t i = 0; i < kRegisterCount; ++i)
+      callee_registers.Set(i, last_frame->context.iregs[i]);
 
-    if (!cfi_frame_info->FindCallerRegs(callee_registers, *memory_,
-        &caller_registers))  {
+    if (!cfi_frame_info->FindCallerRegs(kRegisterNames, kRegisterCount,
+                                        callee_registers, *memory_,
+                                        &caller_registers, &caller_ra,
+                                        &caller_cfa))  {
       return NULL;
     }
 
-    CFIFrameInfo::RegisterValueMap<uint32_t>::const_iterator entry =
-        caller_registers.find(".cfa");
-
-    if (entry != caller_registers.end()) {
-      caller_registers["$sp"] = entry->second;
-    }
-
-    entry = caller_registers.find(".ra");
-    if (entry != caller_registers.end()) {
-      caller_registers["$ra"] = entry->second;
-      pc = entry->second - 2 * sizeof(pc);
-    }
-    caller_registers["$pc"] = pc;
+    caller_registers.Set(MD_CONTEXT_MIPS_REG_SP, caller_cfa);
+    caller_registers.Set(MD_CONTEXT_MIPS_REG_RA, caller_ra);
+    pc = caller_ra - 2 * sizeof(pc);
     // Construct a new stack frame given the values the CFI recovered.
     scoped_ptr<StackFrameMIPS> frame(new StackFrameMIPS());
 
-    for (int i = 0; kRegisterNames[i]; ++i) {
-      CFIFrameInfo::RegisterValueMap<uint32_t>::const_iterator caller_entry =
-          caller_registers.find(kRegisterNames[i]);
-
-      if (caller_entry != caller_registers.end()) {
+    for (size_t i = 0; i < kRegisterCount; ++i) {
+      uint32_t value;
+      if (caller_registers.Get(i, &value)) {
         // The value of this register is recovered; fill the context with the
         // value from caller_registers.
-        frame->context.iregs[i] = caller_entry->second;
+        frame->context.iregs[i] = value;
         frame->context_validity |= StackFrameMIPS::RegisterValidFlag(i);
       } else if (((i >= INDEX_MIPS_REG_S0 && i <= INDEX_MIPS_REG_S7) ||
           (i > INDEX_MIPS_REG_GP && i < INDEX_MIPS_REG_RA)) &&
@@ -165,11 +158,11 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByCFIFrameInfo(
       }
     }
 
-    frame->context.epc = caller_registers["$pc"];
-    frame->instruction = caller_registers["$pc"];
+    frame->context.epc = pc;
+    frame->instruction = pc;
     frame->context_validity |= StackFrameMIPS::CONTEXT_VALID_PC;
 
-    frame->context.iregs[MD_CONTEXT_MIPS_REG_RA] = caller_registers["$ra"];
+    frame->context.iregs[MD_CONTEXT_MIPS_REG_RA] = caller_ra;
     frame->context_validity |= StackFrameMIPS::CONTEXT_VALID_RA;
 
     frame->trust = StackFrame::FRAME_TRUST_CFI;
@@ -178,45 +171,35 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByCFIFrameInfo(
   } else {
     uint64_t pc = 0;
 
-    // Populate a dictionary with the valid register values in last_frame.
-    CFIFrameInfo::RegisterValueMap<uint64_t> callee_registers;
+    // Populate an array with the register values in last_frame, numbered
+    // by their position in kRegisterNames.
+    RegisterValueArray<uint64_t> callee_registers;
     // Use the STACK CFI data to recover the caller's register values.
-    CFIFrameInfo::RegisterValueMap<uint64_t> caller_registers;
+    RegisterValueArray<uint64_t> caller_registers;
+    uint64_t caller_ra, caller_cfa;
 
-    for (int i = 0; kRegisterNames[i]; ++i) {
-      caller_registers[kRegisterNames[i]] = last_frame->context.iregs[i];
-      callee_registers[kRegisterNames[i]] = last_frame->context.iregs[i];
-    }
+    for (size_t i = 0; i < kRegisterCount; ++i)
+      callee_registers.Set(i, last_frame->context.iregs[i]);
 
-    if (!cfi_frame_info->FindCallerRegs(callee_registers, *memory_,
-        &caller_registers))  {
+    if (!cfi_frame_info->FindCallerRegs(kRegisterNames, kRegisterCount,
+                                        callee_registers, *memory_,
+                                        &caller_registers, &caller_ra,
+                                        &caller_cfa))  {
       return NULL;
     }
 
-    CFIFrameInfo::RegisterValueMap<uint64_t>::const_iterator entry =
-        caller_registers.find(".cfa");
-
-    if (entry != caller_registers.end()) {
-      caller_registers["$sp"] = entry->second;
-    }
-
-    entry = caller_registers.find(".ra");
-    if (entry != caller_registers.end()) {
-      caller_registers["$ra"] = entry->second;
-      pc = entry->second - 2 * sizeof(pc);
-    }
-    caller_registers["$pc"] = pc;
+    caller_registers.Set(MD_CONTEXT_MIPS_REG_SP, caller_cfa);
+    caller_registers.Set(MD_CONTEXT_MIPS_REG_RA, caller_ra);
+    pc = caller_ra - 2 * sizeof(pc);
     // Construct a new stack frame given the values the CFI recovered.
     scoped_ptr<StackFrameMIPS> frame(new StackFrameMIPS());
 
-    for (int i = 0; kRegisterNames[i]; ++i) {
-      CFIFrameInfo::RegisterValueMap<uint64_t>::const_iterator caller_entry =
-          caller_registers.find(kRegisterNames[i]);
-
-      if (caller_entry != caller_registers.end()) {
+    for (size_t i = 0; i < kRegisterCount; ++i) {
+      uint64_t value;
+      if (caller_registers.Get(i, &value)) {
         // The value of this register is recovered; fill the context with the
         // value from caller_registers.
-        frame->context.iregs[i] = caller_entry->second;
+        frame->context.iregs[i] = value;
         frame->context_validity |= StackFrameMIPS::RegisterValidFlag(i);
       } else if (((i >= INDEX_MIPS_REG_S0 && i <= INDEX_MIPS_REG_S7) ||
           (i >= INDEX_MIPS_REG_GP && i < INDEX_MIPS_REG_RA)) &&
@@ -232,11 +215,11 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByCFIFrameInfo(
       }
     }
 
-    frame->context.epc = caller_registers["$pc"];
-    frame->instruction = caller_registers["$pc"];
+    frame->context.epc = pc;
+    frame->instruction = pc;
     frame->context_validity |= StackFrameMIPS::CONTEXT_VALID_PC;
 
-    frame->context.iregs[MD_CONTEXT_MIPS_REG_RA] = caller_registers["$ra"];
+    frame->context.iregs[MD_CONTEXT_MIPS_REG_RA] = caller_ra;
     frame->context_validity |= StackFrameMIPS::CONTEXT_VALID_RA;
 
     frame->trust = StackFrame::FRAME_TRUST_CFI;
@@ -325,8 +308,7 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByStackScan(
         return NULL;
       }
       // Get $fp stored in the stack frame.
-      if (!memory_->GetMemoryAtAddress(caller_sp - sizeof(caller_pc),
-          &caller_fp)) {
+      if (!GetStackMemory(caller_sp - sizeof(caller_pc), &caller_fp)) {
         BPLOG(INFO) << " GetMemoryAtAddress for fp failed " ;
         return NULL;
       }
@@ -391,8 +373,7 @@ StackFrameMIPS* StackwalkerMIPS::GetCallerByStackScan(
         return NULL;
       }
       // Get $fp stored in the stack frame.
-      if (!memory_->GetMemoryAtAddress(caller_sp - sizeof(caller_pc),
-          &caller_fp)) {
+      if (!GetStackMemory(caller_sp - sizeof(caller_pc), &caller_fp)) {
         BPLOG(INFO) << " GetMemoryAtAddress for fp failed " ;
         return NULL;
       }
@@ -105,8 +105,7 @@ StackFrame* StackwalkerPPC::GetCallerFrame(const CallStack* stack,
   // Anything else is an error, or an indication that we've reached the
   // end of the stack.
   uint32_t stack_pointer;
-  if (!memory_->GetMemoryAtAddress(last_frame->context.gpr[1],
-                                   &stack_pointer) ||
+  if (!GetStackMemory(last_frame->context.gpr[1], &stack_pointer) ||
       stack_pointer <= last_frame->context.gpr[1]) {
     return NULL;
   }
@@ -117,7 +116,7 @@ StackFrame* StackwalkerPPC::GetCallerFrame(const CallStack* stack,
   // so check for them here and return false (end of stack) when they're
   // hit to avoid having a phantom frame.
   uint32_t instruction;
-  if (!memory_->GetMemoryAtAddress(stack_pointer + 8, &instruction) ||
+  if (!GetStackMemory(stack_pointer + 8, &instruction) ||
       instruction <= 1) {
     return NULL;
   }
@@ -96,8 +96,7 @@ StackFrame* StackwalkerPPC64::GetCallerFrame(const CallStack* stack,
   // Anything else is an error, or an indication that we've reached the
   // end of the stack.
   uint64_t stack_pointer;
-  if (!memory_->GetMemoryAtAddress(last_frame->context.gpr[1],
-                                   &stack_pointer) ||
+  if (!GetStackMemory(last_frame->context.gpr[1], &stack_pointer) ||
       stack_pointer <= last_frame->context.gpr[1]) {
     return NULL;
   }
@@ -108,7 +107,7 @@ StackFrame* StackwalkerPPC64::GetCallerFrame(const CallStack* stack,
   // so check for them here and return false (end of stack) when they're
   // hit to avoid having a phantom frame.
   uint64_t instruction;
-  if (!memory_->GetMemoryAtAddress(stack_pointer + 16, &instruction) ||
+  if (!GetStackMemory(stack_pointer + 16, &instruction) ||
       instruction <= 1) {
     return NULL;
   }
@@ -100,14 +100,14 @@ StackFrame* StackwalkerSPARC::GetCallerFrame(const CallStack* stack,
   }
 
   uint32_t instruction;
-  if (!memory_->GetMemoryAtAddress(stack_pointer + 60,
-                     &instruction) || instruction <= 1) {
+  if (!GetStackMemory(stack_pointer + 60, &instruction) ||
+      instruction <= 1) {
     return NULL;
   }
 
   uint32_t stack_base;
-  if (!memory_->GetMemoryAtAddress(stack_pointer + 56,
-                     &stack_base) || stack_base <= 1) {
+  if (!GetStackMemory(stack_pointer + 56, &stack_base) ||
+      stack_base <= 1) {
     return NULL;
   }
 
@@ -38,6 +38,8 @@
 
 #include <assert.h>
 #include <stdlib.h>
+
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -77,6 +79,22 @@ class MockMemoryRegion: public google_breakpad::MemoryRegion {
   bool GetMemoryAtAddress(uint64_t address, uint64_t* value) const {
     return GetMemoryLittleEndian(address, value);
   }
+  const uint8_t* GetMemorySpan(uint64_t address, size_t length,
+                               size_t* span_length) const {
+    *span_length = 0;
+    if (length == 0 || address < base_address_ ||
+        address - base_address_ >= contents_.size())
+      return NULL;
+    size_t offset = address - base_address_;
+    *span_length = std::min(length, contents_.size() - offset);
+    return reinterpret_cast<const uint8_t*>(contents_.data()) + offset;
+  }
+  // The contents are little-endian, so a big-endian host sees them
+  // swapped.
+  bool IsByteSwapped() const {
+    const uint16_t one = 1;
+    return *reinterpret_cast<const uint8_t*>(&one) != 1;
+  }
   void Print() const {
     assert(false);
   }
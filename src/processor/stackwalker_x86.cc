@@ -44,6 +44,7 @@
 #include "google_breakpad/processor/stack_frame_cpu.h"
 #include "processor/logging.h"
 #include "processor/postfix_evaluator-inl.h"
+#include "processor/postfix_program-inl.h"
 #include "processor/stackwalker_x86.h"
 #include "processor/windows_frame_info.h"
 #include "processor/cfi_frame_info.h"
@@ -266,6 +267,8 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
   // scanned for these values. The results of program string evaluation
   // will be used to determine whether to scan for better values.
   string program_string;
+  // program_string compiled, if it is available; otherwise NULL.
+  const PostfixProgram* program = NULL;
   bool recover_ebp = true;
 
   trust = StackFrame::FRAME_TRUST_CFI;
@@ -276,6 +279,7 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     // parameters.  In some cases, particularly with program strings that use
     // .raSearchStart, the stack may need to be scanned afterward.
     program_string = last_frame_info->program_string;
+    program = last_frame_info->program.get();
   } else if (last_frame_info->allocates_base_pointer) {
     // The function corresponding to the last frame doesn't use the frame
     // pointer for conventional purposes, but it does allocate a new
@@ -312,9 +316,12 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     // %eip_new = *(%esp_old + callee_params + saved_regs + locals)
     // %ebp_new = *(%esp_old + callee_params + saved_regs - 8)
     // %esp_new = %esp_old + callee_params + saved_regs + locals + 4
-    program_string = "$eip .raSearchStart ^ = "
+    static const PostfixProgram kRecoverEbpProgram(
+        "$eip .raSearchStart ^ = "
         "$ebp $esp .cbCalleeParams + .cbSavedRegs + 8 - ^ = "
-        "$esp .raSearchStart 4 + =";
+        "$esp .raSearchStart 4 + =");
+    program = &kRecoverEbpProgram;
+    program_string = program->expression();
   } else {
     // The function corresponding to the last frame doesn't use %ebp at
     // all.  The callee frame is located relative to %esp.
@@ -341,10 +348,18 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
     // %esp_new = %esp_old + callee_params + saved_regs + locals + 4
     // %ebp_new = %ebp_old
     // %ebx_new = %ebx_old  // If available.
-    program_string = "$eip .raSearchStart ^ = "
-                     "$esp .raSearchStart 4 + =";
+    static const PostfixProgram kNoEbpProgram(
+        "$eip .raSearchStart ^ = "
+        "$esp .raSearchStart 4 + =");
+    static const PostfixProgram kNoEbpKeepEbxProgram(
+        "$eip .raSearchStart ^ = "
+        "$esp .raSearchStart 4 + = "
+        "$ebx $ebx =");
     if (last_frame->context_validity & StackFrameX86::CONTEXT_VALID_EBX)
-      program_string += " $ebx $ebx =";
+      program = &kNoEbpKeepEbxProgram;
+    else
+      program = &kNoEbpProgram;
+    program_string = program->expression();
     recover_ebp = false;
   }
 
@@ -370,11 +385,17 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
   dictionary[".raSearch"] = raSearchStart;
 
   // Now crank it out, making sure that the program string set at least the
-  // two required variables.
-  PostfixEvaluator<uint32_t> evaluator =
-      PostfixEvaluator<uint32_t>(&dictionary, memory_);
+  // two required variables.  Use the compiled program if there is one.
   PostfixEvaluator<uint32_t>::DictionaryValidityType dictionary_validity;
-  if (!evaluator.Evaluate(program_string, &dictionary_validity) ||
+  bool evaluated;
+  if (program) {
+    evaluated = program->Evaluate(&dictionary, memory_, &dictionary_validity);
+  } else {
+    PostfixEvaluator<uint32_t> evaluator =
+        PostfixEvaluator<uint32_t>(&dictionary, memory_);
+    evaluated = evaluator.Evaluate(program_string, &dictionary_validity);
+  }
+  if (!evaluated ||
       dictionary_validity.find("$eip") == dictionary_validity.end() ||
       dictionary_validity.find("$esp") == dictionary_validity.end()) {
     // Program string evaluation failed. It may be that %eip is not somewhere
@@ -460,7 +481,7 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
         (trust != StackFrame::FRAME_TRUST_CFI && ebp <= raSearchStart + offset);
 
       uint32_t value;  // throwaway variable to check pointer validity
-      if (has_skipped_frames || !memory_->GetMemoryAtAddress(ebp, &value)) {
+      if (has_skipped_frames || !GetStackMemory(ebp, &value)) {
         int fp_search_bytes = last_frame_info->saved_register_size + offset;
         uint32_t location_end = last_frame->context.esp +
                                  last_frame_callee_parameter_size;
@@ -468,10 +489,10 @@ StackFrameX86* StackwalkerX86::GetCallerByWindowsFrameInfo(
         for (uint32_t location = location_end + fp_search_bytes;
              location >= location_end;
              location -= 4) {
-          if (!memory_->GetMemoryAtAddress(location, &ebp))
+          if (!GetStackMemory(location, &ebp))
             break;
 
-          if (memory_->GetMemoryAtAddress(ebp, &value)) {
+          if (GetStackMemory(ebp, &value)) {
             // The candidate value is a pointer to the same memory region
             // (the stack).  Prefer it as a recovered %ebp result.
             dictionary["$ebp"] = ebp;
@@ -571,8 +592,8 @@ StackFrameX86* StackwalkerX86::GetCallerByEBPAtBase(
 
   uint32_t caller_eip, caller_esp, caller_ebp;
 
-  if (memory_->GetMemoryAtAddress(last_ebp + 4, &caller_eip) &&
-      memory_->GetMemoryAtAddress(last_ebp, &caller_ebp)) {
+  if (GetStackMemory(last_ebp + 4, &caller_eip) &&
+      GetStackMemory(last_ebp, &caller_ebp)) {
     caller_esp = last_ebp + 8;
     trust = StackFrame::FRAME_TRUST_FP;
   } else {
@@ -598,7 +619,7 @@ StackFrameX86* StackwalkerX86::GetCallerByEBPAtBase(
     // A valid caller %ebp must be greater than the address where it is stored
     // and the gap between the two adjacent frames should be reasonable.
     uint32_t restored_ebp_chain = caller_esp - 8;
-    if (!memory_->GetMemoryAtAddress(restored_ebp_chain, &caller_ebp) ||
+    if (!GetStackMemory(restored_ebp_chain, &caller_ebp) ||
         caller_ebp <= restored_ebp_chain ||
         caller_ebp - restored_ebp_chain > kMaxReasonableGapBetweenFrames) {
       // The restored %ebp chain doesn't appear to be valid.
@@ -62,6 +62,13 @@ class StaticAddressMap {
   bool Retrieve(const AddressType& address,
                 const EntryType*& entry, AddressType* entry_address) const;
 
+  // Calls |visitor| with a pointer to each entry stored, in address order.
+  template<typename Visitor>
+  void VisitEntries(Visitor visitor) const {
+    for (MapConstIterator it = map_.begin(); it != map_.end(); ++it)
+      visitor(it.GetValuePtr());
+  }
+
  private:
   friend class ModuleComparer;
   // Convenience types.
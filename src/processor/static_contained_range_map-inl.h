@@ -38,6 +38,7 @@
 #define PROCESSOR_STATIC_CONTAINED_RANGE_MAP_INL_H__
 
 #include "processor/static_contained_range_map.h"
+#include "processor/flat_contained_range_map-inl.h"
 #include "processor/logging.h"
 
 namespace google_breakpad {
@@ -104,6 +105,29 @@ bool StaticContainedRangeMap<AddressType, EntryType>::RetrieveRanges(
   return true;
 }
 
+template<typename AddressType, typename EntryType>
+void StaticContainedRangeMap<AddressType, EntryType>::Flatten(
+    FlatContainedRangeMap<AddressType, EntryType>* flat) const {
+  flat->Clear();
+  FlattenChildren(flat, FlatContainedRangeMap<AddressType,
+                                              EntryType>::kNoParent);
+  flat->ShrinkToFit();
+}
+
+template<typename AddressType, typename EntryType>
+void StaticContainedRangeMap<AddressType, EntryType>::FlattenChildren(
+    FlatContainedRangeMap<AddressType, EntryType>* flat,
+    int32_t parent) const {
+  for (MapConstIterator iterator = map_.begin(); iterator != map_.end();
+       ++iterator) {
+    StaticContainedRangeMap child_map(
+        reinterpret_cast<const char*>(iterator.GetValuePtr()));
+    int32_t index = flat->AddRange(child_map.base_, iterator.GetKey(), parent,
+                                   child_map.entry_ptr_);
+    child_map.FlattenChildren(flat, index);
+  }
+}
+
 }  // namespace google_breakpad
 
 #endif  // PROCESSOR_STATIC_CONTAINED_RANGE_MAP_INL_H__
@@ -43,6 +43,7 @@
 #define PROCESSOR_STATIC_CONTAINED_RANGE_MAP_H__
 
 #include <vector>
+#include "processor/flat_contained_range_map.h"
 #include "processor/static_map-inl.h"
 
 namespace google_breakpad {
@@ -65,6 +66,11 @@ class StaticContainedRangeMap {
   bool RetrieveRanges(const AddressType& address,
                       std::vector<const EntryType*>& entry) const;
 
+  // Replaces the ranges in |flat| with this map's descendant ranges, for
+  // faster lookups (see flat_contained_range_map.h).  |flat| points into
+  // the serialized data.
+  void Flatten(FlatContainedRangeMap<AddressType, EntryType>* flat) const;
+
  private:
   friend class ModuleComparer;
   // AddressToRangeMap stores pointers.  This makes reparenting simpler in
@@ -74,6 +80,11 @@ class StaticContainedRangeMap {
   StaticMap<AddressType, StaticContainedRangeMap> AddressToRangeMap;
   typedef typename AddressToRangeMap::const_iterator MapConstIterator;
 
+  // Adds this map's descendant ranges to |flat|, as children of the range
+  // at |parent|.
+  void FlattenChildren(FlatContainedRangeMap<AddressType, EntryType>* flat,
+                       int32_t parent) const;
+
   // The base address of this range.  The high address does not need to
   // be stored, because it is used as the key to an object in its parent's
   // map, and all ContainedRangeMaps except for the root range are contained
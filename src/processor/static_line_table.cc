@@ -0,0 +1,251 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// static_line_table.cc: StaticLineTable implementation.
+//
+// See static_line_table.h for documentation.
+
+#include "processor/static_line_table.h"
+
+#include <string.h>
+
+namespace google_breakpad {
+
+namespace {
+
+uint64_t ZigZag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+size_t VarintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+char* WriteVarint(uint64_t value, char* dest) {
+  while (value >= 0x80) {
+    *dest++ = static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  *dest++ = static_cast<char>(value);
+  return dest;
+}
+
+const char* ReadVarint(const char* raw, uint64_t* value) {
+  *value = 0;
+  int shift = 0;
+  uint8_t byte;
+  do {
+    byte = static_cast<uint8_t>(*raw++);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while ((byte & 0x80) && shift < 64);
+  return raw;
+}
+
+// The four fields of |row|, relative to |previous|, in the order they are
+// encoded.
+void RowFields(const StaticLineTable::Row& previous,
+               const StaticLineTable::Row& row,
+               uint64_t fields[4]) {
+  uint64_t previous_end = previous.address + previous.size;
+  fields[0] = ZigZag(static_cast<int64_t>(row.address - previous_end));
+  fields[1] = row.size;
+  fields[2] = ZigZag(static_cast<int64_t>(row.line) - previous.line);
+  fields[3] = ZigZag(static_cast<int64_t>(row.source_file_id) -
+                     previous.source_file_id);
+}
+
+// The row a block's first row is encoded relative to.
+StaticLineTable::Row BlockStart(const StaticLineTable::Row& first) {
+  StaticLineTable::Row start = first;
+  start.size = 0;
+  return start;
+}
+
+}  // namespace
+
+StaticLineTable::StaticLineTable(const char* memory) {
+  memcpy(&row_count_, memory, sizeof(row_count_));
+  memcpy(&block_count_, memory + sizeof(row_count_), sizeof(block_count_));
+  index_ = memory + sizeof(row_count_) + sizeof(block_count_);
+  rows_ = index_ + block_count_ * kIndexEntrySize;
+}
+
+size_t StaticLineTable::SizeOf(const std::vector<Row>& rows) {
+  size_t num_blocks = (rows.size() + kRowsPerBlock - 1) / kRowsPerBlock;
+  size_t size = sizeof(uint32_t) * 2 + num_blocks * kIndexEntrySize;
+  Row previous;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (i % kRowsPerBlock == 0)
+      previous = BlockStart(rows[i]);
+    uint64_t fields[4];
+    RowFields(previous, rows[i], fields);
+    for (int j = 0; j < 4; ++j)
+      size += VarintSize(fields[j]);
+    previous = rows[i];
+  }
+  return size;
+}
+
+char* StaticLineTable::Write(const std::vector<Row>& rows, char* dest) {
+  uint32_t row_count = rows.size();
+  uint32_t block_count = (row_count + kRowsPerBlock - 1) / kRowsPerBlock;
+  memcpy(dest, &row_count, sizeof(row_count));
+  dest += sizeof(row_count);
+  memcpy(dest, &block_count, sizeof(block_count));
+  dest += sizeof(block_count);
+
+  char* index = dest;
+  char* row_data = index + block_count * kIndexEntrySize;
+  dest = row_data;
+  Row previous;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const Row& row = rows[i];
+    if (i % kRowsPerBlock == 0) {
+      uint32_t offset = dest - row_data;
+      memcpy(index, &row.address, sizeof(row.address));
+      index += sizeof(row.address);
+      memcpy(index, &offset, sizeof(offset));
+      index += sizeof(offset);
+      memcpy(index, &row.source_file_id, sizeof(row.source_file_id));
+      index += sizeof(row.source_file_id);
+      memcpy(index, &row.line, sizeof(row.line));
+      index += sizeof(row.line);
+      previous = BlockStart(row);
+    }
+    uint64_t fields[4];
+    RowFields(previous, row, fields);
+    for (int j = 0; j < 4; ++j)
+      dest = WriteVarint(fields[j], dest);
+    previous = row;
+  }
+  return dest;
+}
+
+bool StaticLineTable::Retrieve(uint64_t address, Row* row) const {
+  if (block_count_ == 0)
+    return false;
+
+  // Find the last block whose first row starts at or below address.
+  uint32_t low = 0;
+  uint32_t high = block_count_;
+  while (high - low > 1) {
+    uint32_t middle = low + (high - low) / 2;
+    uint64_t middle_address;
+    memcpy(&middle_address, index_ + middle * kIndexEntrySize,
+           sizeof(middle_address));
+    if (middle_address <= address)
+      low = middle;
+    else
+      high = middle;
+  }
+
+  Row first;
+  const char* raw = rows_ + ReadIndexEntry(low, &first);
+  if (first.address > address)
+    return false;
+
+  Row previous = BlockStart(first);
+  Row found;
+  uint32_t end = low * kRowsPerBlock + kRowsPerBlock;
+  if (end > row_count_)
+    end = row_count_;
+  for (uint32_t i = low * kRowsPerBlock; i < end; ++i) {
+    Row current;
+    raw = ReadRow(raw, previous, &current);
+    if (current.address > address)
+      break;
+    found = current;
+    previous = current;
+  }
+
+  if (address - found.address >= found.size)
+    return false;
+  *row = found;
+  return true;
+}
+
+void StaticLineTable::ReadAll(std::vector<Row>* rows) const {
+  rows->clear();
+  rows->reserve(row_count_);
+  for (uint32_t block = 0; block < block_count_; ++block) {
+    Row first;
+    const char* raw = rows_ + ReadIndexEntry(block, &first);
+    Row previous = BlockStart(first);
+    uint32_t end = block * kRowsPerBlock + kRowsPerBlock;
+    if (end > row_count_)
+      end = row_count_;
+    for (uint32_t i = block * kRowsPerBlock; i < end; ++i) {
+      Row current;
+      raw = ReadRow(raw, previous, &current);
+      rows->push_back(current);
+      previous = current;
+    }
+  }
+}
+
+uint32_t StaticLineTable::ReadIndexEntry(uint32_t block, Row* row) const {
+  const char* raw = index_ + block * kIndexEntrySize;
+  uint32_t offset;
+  memcpy(&row->address, raw, sizeof(row->address));
+  raw += sizeof(row->address);
+  memcpy(&offset, raw, sizeof(offset));
+  raw += sizeof(offset);
+  memcpy(&row->source_file_id, raw, sizeof(row->source_file_id));
+  raw += sizeof(row->source_file_id);
+  memcpy(&row->line, raw, sizeof(row->line));
+  row->size = 0;
+  return offset;
+}
+
+const char* StaticLineTable::ReadRow(const char* raw, const Row& previous,
+                                     Row* row) {
+  uint64_t fields[4];
+  for (int j = 0; j < 4; ++j)
+    raw = ReadVarint(raw, &fields[j]);
+  row->address = previous.address + previous.size +
+                 static_cast<uint64_t>(UnZigZag(fields[0]));
+  row->size = fields[1];
+  row->line = static_cast<int32_t>(previous.line + UnZigZag(fields[2]));
+  row->source_file_id =
+      static_cast<int32_t>(previous.source_file_id + UnZigZag(fields[3]));
+  return raw;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,125 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// static_line_table.h: StaticLineTable.
+//
+// StaticLineTable reads the LINE records of one function from serialized
+// symbol data, in a compact encoding written by LineTableSerializer.  It
+// fills the role StaticRangeMap<MemAddr, Line> would, taking a fraction of
+// the space.
+//
+// The rows are split into blocks of kRowsPerBlock rows.  An index holding
+// the first row of each block in full comes first, followed by the rows
+// themselves.  Each row is stored as unsigned LEB128 varints, relative to
+// the row before it in the same block:
+//   the gap between the end of the previous row and this row's address,
+//     zigzag-encoded since ranges may overlap or be out of order
+//   the size of this row's range
+//   the difference between this row's line number and the previous one's,
+//     zigzag-encoded
+//   the difference between this row's source file id and the previous one's,
+//     zigzag-encoded
+// The first row of a block is encoded relative to the block's index entry,
+// as if a row of size zero preceded it there.  A lookup binary-searches the
+// index and decodes at most one block.
+//
+// Memory layout:
+//   uint32_t row count
+//   uint32_t block count
+//   for each block: uint64_t address, uint32_t offset of its first row from
+//     the start of the row data, int32_t source file id, int32_t line
+//   row data
+
+#ifndef PROCESSOR_STATIC_LINE_TABLE_H__
+#define PROCESSOR_STATIC_LINE_TABLE_H__
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+class StaticLineTable {
+ public:
+  // One LINE record.
+  struct Row {
+    Row() : address(0), size(0), source_file_id(0), line(0) {}
+    uint64_t address;
+    uint64_t size;
+    int32_t source_file_id;
+    int32_t line;
+  };
+
+  static const uint32_t kRowsPerBlock = 16;
+
+  StaticLineTable() : row_count_(0), block_count_(0), index_(NULL),
+                      rows_(NULL) {}
+  explicit StaticLineTable(const char* memory);
+
+  // Returns the number of bytes needed to encode |rows|, which must be
+  // sorted by address.
+  static size_t SizeOf(const std::vector<Row>& rows);
+
+  // Encodes |rows| at |dest| and returns the address following the final
+  // byte written.  The caller must have allocated SizeOf(rows) bytes.
+  static char* Write(const std::vector<Row>& rows, char* dest);
+
+  // Locates the row whose range encompasses |address|, the last one
+  // starting at or below it.  Returns false if there is no such row.
+  bool Retrieve(uint64_t address, Row* row) const;
+
+  // Decodes every row into |rows|, in address order.
+  void ReadAll(std::vector<Row>* rows) const;
+
+  uint32_t row_count() const { return row_count_; }
+
+ private:
+  // Size of an index entry.
+  static const size_t kIndexEntrySize = 20;
+
+  // Reads index entry |block| into |row|, and returns the offset of the
+  // block's first row.
+  uint32_t ReadIndexEntry(uint32_t block, Row* row) const;
+
+  // Decodes the row at |raw| relative to |previous|, the row before it or
+  // the block's index entry, into |row|, and returns the address following
+  // it.
+  static const char* ReadRow(const char* raw, const Row& previous, Row* row);
+
+  uint32_t row_count_;
+  uint32_t block_count_;
+  const char* index_;
+  const char* rows_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_STATIC_LINE_TABLE_H__
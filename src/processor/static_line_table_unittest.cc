@@ -0,0 +1,153 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// static_line_table_unittest.cc: Unit tests for StaticLineTable.
+
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/scoped_ptr.h"
+#include "processor/static_line_table.h"
+
+namespace {
+
+using google_breakpad::StaticLineTable;
+using google_breakpad::scoped_array;
+using std::vector;
+
+typedef StaticLineTable::Row Row;
+
+Row MakeRow(uint64_t address, uint64_t size, int32_t file, int32_t line) {
+  Row row;
+  row.address = address;
+  row.size = size;
+  row.source_file_id = file;
+  row.line = line;
+  return row;
+}
+
+class TestStaticLineTable : public ::testing::Test {
+ protected:
+  // Encodes rows_ into data_ and reads it back into table_.
+  void Encode() {
+    size_ = StaticLineTable::SizeOf(rows_);
+    data_.reset(new char[size_]);
+    char* end = StaticLineTable::Write(rows_, data_.get());
+    ASSERT_EQ(data_.get() + size_, end);
+    table_ = StaticLineTable(data_.get());
+  }
+
+  vector<Row> rows_;
+  size_t size_;
+  scoped_array<char> data_;
+  StaticLineTable table_;
+};
+
+TEST_F(TestStaticLineTable, Empty) {
+  Encode();
+  EXPECT_EQ(0U, table_.row_count());
+  Row row;
+  EXPECT_FALSE(table_.Retrieve(0, &row));
+  EXPECT_FALSE(table_.Retrieve(0x8, &row));
+  vector<Row> rows;
+  table_.ReadAll(&rows);
+  EXPECT_TRUE(rows.empty());
+}
+
+TEST_F(TestStaticLineTable, RetrieveAcrossBlocks) {
+  // Mostly contiguous rows spanning several blocks, with gaps, lines going
+  // backwards and files changing.
+  uint64_t address = 0x401000;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 7 == 0)
+      address += 0x10;
+    uint64_t size = 1 + i % 5;
+    rows_.push_back(MakeRow(address, size, i / 30, 50 + (i % 9) * 3 - i));
+    address += size;
+  }
+  Encode();
+  EXPECT_EQ(100U, table_.row_count());
+  // Far smaller than the 24 bytes each row takes in a StaticRangeMap.
+  EXPECT_LT(size_, rows_.size() * 8);
+
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    for (uint64_t offset = 0; offset < rows_[i].size; ++offset) {
+      Row row;
+      ASSERT_TRUE(table_.Retrieve(rows_[i].address + offset, &row));
+      EXPECT_EQ(rows_[i].address, row.address);
+      EXPECT_EQ(rows_[i].size, row.size);
+      EXPECT_EQ(rows_[i].source_file_id, row.source_file_id);
+      EXPECT_EQ(rows_[i].line, row.line);
+    }
+  }
+
+  // Addresses before, between and after the rows.
+  Row row;
+  EXPECT_FALSE(table_.Retrieve(0x401000, &row));
+  EXPECT_FALSE(table_.Retrieve(rows_[7].address - 1, &row));
+  EXPECT_FALSE(table_.Retrieve(address, &row));
+  EXPECT_FALSE(table_.Retrieve(~0ULL, &row));
+
+  vector<Row> rows;
+  table_.ReadAll(&rows);
+  ASSERT_EQ(rows_.size(), rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    EXPECT_EQ(rows_[i].address, rows[i].address);
+    EXPECT_EQ(rows_[i].size, rows[i].size);
+    EXPECT_EQ(rows_[i].source_file_id, rows[i].source_file_id);
+    EXPECT_EQ(rows_[i].line, rows[i].line);
+  }
+}
+
+TEST_F(TestStaticLineTable, ExtremeValues) {
+  rows_.push_back(MakeRow(0, 1, 0, 0));
+  rows_.push_back(MakeRow(0x10, 0x7fffffff, INT32_MAX, INT32_MIN));
+  rows_.push_back(MakeRow(0xfffffffffffff000ULL, 0x1000, INT32_MIN,
+                          INT32_MAX));
+  Encode();
+
+  Row row;
+  ASSERT_TRUE(table_.Retrieve(0, &row));
+  EXPECT_EQ(0, row.line);
+  ASSERT_TRUE(table_.Retrieve(0x10 + 0x7ffffffeULL, &row));
+  EXPECT_EQ(INT32_MAX, row.source_file_id);
+  EXPECT_EQ(INT32_MIN, row.line);
+  ASSERT_TRUE(table_.Retrieve(~0ULL, &row));
+  EXPECT_EQ(0xfffffffffffff000ULL, row.address);
+  EXPECT_EQ(INT32_MIN, row.source_file_id);
+  EXPECT_EQ(INT32_MAX, row.line);
+  EXPECT_FALSE(table_.Retrieve(0x8, &row));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -38,6 +38,7 @@
 
 #include "processor/static_map.h"
 #include "processor/static_map_iterator-inl.h"
+#include "processor/static_map_search_index-inl.h"
 #include "processor/logging.h"
 
 namespace google_breakpad {
@@ -46,20 +47,35 @@ template<typename Key, typename Value, typename Compare>
 StaticMap<Key, Value, Compare>::StaticMap(const char* raw_data)
     : raw_data_(raw_data),
       compare_() {
-  // First 4 Bytes store the number of nodes.
-  num_nodes_ = *(reinterpret_cast<const uint32_t*>(raw_data_));
+  // First 4 Bytes store the number of nodes, and whether there is an index.
+  uint32_t header = *(reinterpret_cast<const uint32_t*>(raw_data_));
+  typedef StaticMapSearchIndex<Key> SearchIndex;
+  num_nodes_ = header & ~SearchIndex::kIndexFlag;
+  has_search_index_ = (header & SearchIndex::kIndexFlag) != 0;
 
   offsets_ = reinterpret_cast<const uint32_t*>(
       raw_data_ + sizeof(num_nodes_));
 
   keys_ = reinterpret_cast<const Key*>(
       raw_data_ + (1 + num_nodes_) * sizeof(uint32_t));
+
+  if (has_search_index_) {
+    search_index_ = SearchIndex(
+        reinterpret_cast<const char*>(keys_ + num_nodes_), num_nodes_);
+  }
 }
 
-// find(), lower_bound() and upper_bound() implement binary search algorithm.
+// find(), lower_bound() and upper_bound() implement binary search algorithm,
+// or search the index if there is one.
 template<typename Key, typename Value, typename Compare>
 StaticMapIterator<Key, Value, Compare>
 StaticMap<Key, Value, Compare>::find(const Key& key) const {
+  if (has_search_index_) {
+    int index = search_index_.LowerBound(key, compare_);
+    if (index < num_nodes_ && compare_(key, GetKeyAtIndex(index)) == 0)
+      return IteratorAtIndex(index);
+    return this->end();
+  }
   int begin = 0;
   int end = num_nodes_;
   int middle;
@@ -81,6 +97,8 @@ StaticMap<Key, Value, Compare>::find(const Key& key) const {
 template<typename Key, typename Value, typename Compare>
 StaticMapIterator<Key, Value, Compare>
 StaticMap<Key, Value, Compare>::lower_bound(const Key& key) const {
+  if (has_search_index_)
+    return IteratorAtIndex(search_index_.LowerBound(key, compare_));
   int begin = 0;
   int end = num_nodes_;
   int middle;
@@ -102,6 +120,12 @@ StaticMap<Key, Value, Compare>::lower_bound(const Key& key) const {
 template<typename Key, typename Value, typename Compare>
 StaticMapIterator<Key, Value, Compare>
 StaticMap<Key, Value, Compare>::upper_bound(const Key& key) const {
+  if (has_search_index_) {
+    int index = search_index_.LowerBound(key, compare_);
+    if (index < num_nodes_ && compare_(key, GetKeyAtIndex(index)) == 0)
+      ++index;
+    return IteratorAtIndex(index);
+  }
   int begin = 0;
   int end = num_nodes_;
   int middle;
@@ -124,8 +148,7 @@ template<typename Key, typename Value, typename Compare>
 bool StaticMap<Key, Value, Compare>::ValidateInMemoryStructure() const {
   // check the number of nodes is non-negative:
   if (!raw_data_) return false;
-  int32_t num_nodes = *(reinterpret_cast<const int32_t*>(raw_data_));
-  if (num_nodes < 0) {
+  if (num_nodes_ < 0) {
     BPLOG(INFO) << "StaticMap check failed: negative number of nodes";
     return false;
   }
@@ -134,6 +157,8 @@ bool StaticMap<Key, Value, Compare>::ValidateInMemoryStructure() const {
   if (num_nodes_) {
     uint64_t first_offset = sizeof(int32_t) * (num_nodes_ + 1)
                            + sizeof(Key) * num_nodes_;
+    if (has_search_index_)
+      first_offset += StaticMapSearchIndex<Key>::SizeOf(num_nodes_);
     // Num_nodes_ is too large.
     if (first_offset > 0xffffffffUL) {
       BPLOG(INFO) << "StaticMap check failed: size exceeds limit";
@@ -158,6 +183,8 @@ bool StaticMap<Key, Value, Compare>::ValidateInMemoryStructure() const {
       return false;
     }
   }
+  if (has_search_index_ && !search_index_.Validate(keys_))
+    return false;
   return true;
 }
 
@@ -52,6 +52,9 @@
 // ...
 // (? bytes): nodeN's mapped_value
 //
+// If the high bit of the number of nodes is set, a search index follows the
+// key array; see static_map_search_index.h.
+//
 // REQUIREMENT: Key type MUST be primitive type or pointers so that:
 // X = sizeof(typename Key);
 //
@@ -65,6 +68,7 @@
 #define PROCESSOR_STATIC_MAP_H__
 
 #include "processor/static_map_iterator-inl.h"
+#include "processor/static_map_search_index.h"
 
 namespace google_breakpad {
 
@@ -88,6 +92,8 @@ class StaticMap {
   StaticMap() : raw_data_(0),
                 num_nodes_(0),
                 offsets_(0),
+                keys_(0),
+                has_search_index_(false),
                 compare_() { }
 
   explicit StaticMap(const char* raw_data);
@@ -136,6 +142,10 @@ class StaticMap {
   // keys_[i] = key of i_th node
   const Key* keys_;
 
+  // Set if the map has a search index.
+  bool has_search_index_;
+  StaticMapSearchIndex<Key> search_index_;
+
   Compare compare_;
 };
 
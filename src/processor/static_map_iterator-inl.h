@@ -36,6 +36,7 @@
 #define PROCESSOR_STATIC_MAP_ITERATOR_INL_H__
 
 #include "processor/static_map_iterator.h"
+#include "processor/static_map_search_index.h"
 
 #include "processor/logging.h"
 
@@ -47,7 +48,8 @@ StaticMapIterator<Key, Value, Compare>::StaticMapIterator(const char* base,
       index_(index), base_(base) {
   // See static_map.h for documentation on
   // bytes format of serialized StaticMap data.
-  num_nodes_ = *(reinterpret_cast<const int32_t*>(base_));
+  num_nodes_ = *(reinterpret_cast<const uint32_t*>(base_)) &
+               ~StaticMapSearchIndex<Key>::kIndexFlag;
   offsets_ = reinterpret_cast<const uint32_t*>(base_ + sizeof(num_nodes_));
   keys_ = reinterpret_cast<const Key*>(
       base_ + (1 + num_nodes_) * sizeof(num_nodes_));
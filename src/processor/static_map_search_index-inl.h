@@ -0,0 +1,126 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// static_map_search_index-inl.h: StaticMapSearchIndex implementation.
+//
+// See static_map_search_index.h for documentation.
+
+#ifndef PROCESSOR_STATIC_MAP_SEARCH_INDEX_INL_H__
+#define PROCESSOR_STATIC_MAP_SEARCH_INDEX_INL_H__
+
+#include "processor/static_map_search_index.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+template<typename Key>
+StaticMapSearchIndex<Key>::StaticMapSearchIndex(const char* raw_index,
+                                                int32_t num_nodes)
+    : num_nodes_(num_nodes),
+      keys_(reinterpret_cast<const Key*>(raw_index)),
+      positions_(reinterpret_cast<const uint32_t*>(
+          raw_index + (num_nodes + 1) * sizeof(Key))) {
+}
+
+template<typename Key>
+char* StaticMapSearchIndex<Key>::Write(const char* sorted_keys,
+                                       uint32_t num_nodes,
+                                       char* dest) {
+  std::vector<uint32_t> positions(num_nodes + 1, 0);
+  uint32_t next_position = 0;
+  AssignPositions(1, num_nodes, &next_position, &positions[0]);
+
+  memset(dest, 0, sizeof(Key));
+  for (uint32_t node = 1; node <= num_nodes; ++node) {
+    memcpy(dest + node * sizeof(Key),
+           sorted_keys + positions[node] * sizeof(Key), sizeof(Key));
+  }
+  dest += (num_nodes + 1) * sizeof(Key);
+  memcpy(dest, &positions[0], (num_nodes + 1) * sizeof(uint32_t));
+  return dest + (num_nodes + 1) * sizeof(uint32_t);
+}
+
+template<typename Key>
+template<typename Compare>
+int32_t StaticMapSearchIndex<Key>::LowerBound(const Key& key,
+                                              const Compare& compare) const {
+  uint32_t node = 1;
+  const uint32_t num_nodes = static_cast<uint32_t>(num_nodes_);
+  while (node <= num_nodes) {
+#if defined(__GNUC__)
+    __builtin_prefetch(keys_ + static_cast<size_t>(node) * kPrefetchDistance);
+#endif
+    // Go right past keys less than |key|.
+    node = 2 * node + (compare(keys_[node], key) < 0 ? 1 : 0);
+  }
+  // The answer is the last node we went left from: drop the trailing right
+  // turns, then the final left turn.
+  while (node & 1)
+    node >>= 1;
+  node >>= 1;
+  return node == 0 ? num_nodes_ : static_cast<int32_t>(positions_[node]);
+}
+
+template<typename Key>
+bool StaticMapSearchIndex<Key>::Validate(const Key* sorted_keys) const {
+  const uint32_t num_nodes = static_cast<uint32_t>(num_nodes_);
+  std::vector<uint32_t> positions(num_nodes + 1, 0);
+  uint32_t next_position = 0;
+  AssignPositions(1, num_nodes, &next_position, &positions[0]);
+  for (uint32_t node = 1; node <= num_nodes; ++node) {
+    if (positions_[node] != positions[node] ||
+        memcmp(&keys_[node], &sorted_keys[positions[node]], sizeof(Key))) {
+      BPLOG(INFO) << "StaticMap check failed: search index doesn't match keys";
+      return false;
+    }
+  }
+  return true;
+}
+
+// static
+template<typename Key>
+void StaticMapSearchIndex<Key>::AssignPositions(uint32_t node,
+                                                uint32_t num_nodes,
+                                                uint32_t* next_position,
+                                                uint32_t* positions) {
+  if (node > num_nodes)
+    return;
+  AssignPositions(2 * node, num_nodes, next_position, positions);
+  positions[node] = (*next_position)++;
+  AssignPositions(2 * node + 1, num_nodes, next_position, positions);
+}
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_STATIC_MAP_SEARCH_INDEX_INL_H__
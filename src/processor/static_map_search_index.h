@@ -0,0 +1,115 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// static_map_search_index.h: StaticMapSearchIndex.
+//
+// StaticMapSearchIndex is an optional part of a serialized StaticMap that
+// replaces binary search over the sorted key array with a search over a
+// copy of the keys in Eytzinger (breadth-first) order.  The first levels
+// of the implicit tree share a few cache lines, and since the children of
+// a node sit next to each other, the nodes several levels below the
+// current one can be prefetched while it is compared.  On large
+// memory-mapped maps this turns most of the cache and TLB misses of a
+// binary search into prefetch hits.
+//
+// A map carries an index if the high bit of its node count is set.  The
+// index is then placed between the key array and the value array:
+//
+// (X bytes): padding, so that the tree starts at slot 1
+// (X bytes): key of tree node 1
+// ...
+// (X bytes): key of tree node N
+// uint32 (4 bytes): padding
+// uint32 (4 bytes): position of tree node 1 in the sorted key array
+// ...
+// uint32 (4 bytes): position of tree node N in the sorted key array
+//
+// Node k of the tree has children 2k and 2k+1, and an in-order walk of the
+// tree visits the keys in sorted order.
+
+#ifndef PROCESSOR_STATIC_MAP_SEARCH_INDEX_H__
+#define PROCESSOR_STATIC_MAP_SEARCH_INDEX_H__
+
+#include <stddef.h>
+
+#include "google_breakpad/common/breakpad_types.h"
+
+namespace google_breakpad {
+
+template<typename Key>
+class StaticMapSearchIndex {
+ public:
+  // Set in a serialized map's node count if the map has an index.
+  static const uint32_t kIndexFlag = 0x80000000;
+
+  // Serializers only build an index for maps with at least this many nodes;
+  // smaller maps fit in a few cache lines anyway.
+  static const uint32_t kMinIndexedNodes = 128;
+
+  StaticMapSearchIndex() : num_nodes_(0), keys_(NULL), positions_(NULL) { }
+
+  // |raw_index| points at an index for a map with |num_nodes| nodes.
+  StaticMapSearchIndex(const char* raw_index, int32_t num_nodes);
+
+  // Returns the size of the index for a map with |num_nodes| nodes.
+  static size_t SizeOf(uint32_t num_nodes) {
+    return (num_nodes + 1) * (sizeof(Key) + sizeof(uint32_t));
+  }
+
+  // Writes the index for the |num_nodes| keys in the array at |sorted_keys|
+  // to |dest|, and returns the address after the final byte written.
+  static char* Write(const char* sorted_keys, uint32_t num_nodes, char* dest);
+
+  // Returns the position in the sorted key array of the first key not less
+  // than |key|, or the number of nodes if there is none.  |compare| is a
+  // three-way comparison like StaticMap's.
+  template<typename Compare>
+  int32_t LowerBound(const Key& key, const Compare& compare) const;
+
+  // Checks that the index matches the sorted key array at |sorted_keys|.
+  bool Validate(const Key* sorted_keys) const;
+
+ private:
+  // How many nodes ahead to prefetch: the descendants of a node four levels
+  // down are 16 consecutive keys, three levels down 8.
+  static const uint32_t kPrefetchDistance = sizeof(Key) <= 4 ? 16 : 8;
+
+  // Fills in |positions| for the subtree rooted at |node|, numbering its
+  // keys from *|next_position|.
+  static void AssignPositions(uint32_t node, uint32_t num_nodes,
+                              uint32_t* next_position, uint32_t* positions);
+
+  int32_t num_nodes_;
+  const Key* keys_;
+  const uint32_t* positions_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_STATIC_MAP_SEARCH_INDEX_H__
@@ -31,10 +31,13 @@
 //
 // Author: Siyang Xie (lambxsy@google.com)
 
+#include <algorithm>
 #include <climits>
 #include <map>
+#include <vector>
 
 #include "breakpad_googletest_includes.h"
+#include "processor/map_serializers-inl.h"
 #include "processor/static_map-inl.h"
 
 
@@ -379,6 +382,72 @@ TEST_F(TestValidMap, Test1000RandomElements) {
   LookupTester(test_case);
 }
 
+// Compares the result of a StaticMap lookup with that of a std::map one.
+static void CheckLookupResult(const StdMap& std_map, const TestMap& test_map,
+                              StdMap::const_iterator expected,
+                              TestMap::const_iterator actual) {
+  if (expected == std_map.end()) {
+    ASSERT_TRUE(actual == test_map.end());
+  } else {
+    ASSERT_FALSE(actual == test_map.end());
+    ASSERT_EQ(expected->first, actual.GetKey());
+    ASSERT_EQ(expected->second, *actual.GetValuePtr());
+  }
+}
+
+// Maps written with a search index should be found valid and answer every
+// lookup the way a plain binary search does.
+TEST(TestSearchIndex, TestLookups) {
+  const unsigned int kSizes[] = { 0, 1, 127, 128, 129, 1000, 5000 };
+  for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); ++i) {
+    StdMap std_map;
+    while (std_map.size() < kSizes[i])
+      std_map.insert(std::make_pair(rand() - RAND_MAX / 2, rand()));
+
+    google_breakpad::StdMapSerializer<KeyType, ValueType> serializer;
+    serializer.set_build_search_index(true);
+    unsigned int size;
+    char* data = serializer.Serialize(std_map, &size);
+    ASSERT_EQ(serializer.SizeOf(std_map), size);
+    TestMap test_map(data);
+    uint32_t header = *reinterpret_cast<uint32_t*>(data);
+    ASSERT_EQ(kSizes[i] >= 128, (header & 0x80000000) != 0);
+    ASSERT_TRUE(test_map.ValidateInMemoryStructure());
+    ASSERT_EQ(std_map.size(), test_map.size());
+
+    std::vector<KeyType> keys;
+    keys.push_back(INT_MIN);
+    keys.push_back(INT_MAX);
+    for (StdMap::const_iterator iter = std_map.begin();
+         iter != std_map.end(); ++iter) {
+      keys.push_back(iter->first);
+      keys.push_back(iter->first + 1);
+      keys.push_back(iter->first - 1);
+    }
+    for (int j = 0; j < 1000; ++j)
+      keys.push_back(rand() - RAND_MAX / 2);
+
+    for (size_t j = 0; j < keys.size(); ++j) {
+      CheckLookupResult(std_map, test_map, std_map.find(keys[j]),
+                        test_map.find(keys[j]));
+      CheckLookupResult(std_map, test_map, std_map.lower_bound(keys[j]),
+                        test_map.lower_bound(keys[j]));
+      CheckLookupResult(std_map, test_map, std_map.upper_bound(keys[j]),
+                        test_map.upper_bound(keys[j]));
+    }
+
+    if (header & 0x80000000) {
+      // Swap two entries of the index.
+      uint32_t* positions = reinterpret_cast<uint32_t*>(
+          data + (1 + kSizes[i]) * sizeof(uint32_t) +
+          kSizes[i] * sizeof(KeyType) + (kSizes[i] + 1) * sizeof(KeyType));
+      std::swap(positions[1], positions[2]);
+      ASSERT_FALSE(TestMap(data).ValidateInMemoryStructure());
+    }
+    delete [] data;
+  }
+}
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
 
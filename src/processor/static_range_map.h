@@ -81,6 +81,14 @@ class StaticRangeMap {
   // Returns the number of ranges stored in the RangeMap.
   inline int GetCount() const { return map_.size(); }
 
+  // Calls |visitor| with a pointer to the entry of each range stored, in
+  // address order.
+  template<typename Visitor>
+  void VisitEntries(Visitor visitor) const {
+    for (MapConstIterator it = map_.begin(); it != map_.end(); ++it)
+      visitor(it.GetValuePtr()->entryptr());
+  }
+
  private:
   friend class ModuleComparer;
   class Range {
@@ -0,0 +1,87 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// string_pool.cc: StringPool implementation.
+//
+// See string_pool.h for documentation.
+
+#include "processor/string_pool.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <utility>
+
+namespace google_breakpad {
+
+StringPool::~StringPool() {
+  for (StringMap::iterator it = strings_.begin(); it != strings_.end(); ++it)
+    delete [] it->first;
+}
+
+const char* StringPool::Intern(const char* str) {
+  StringMap::iterator it = strings_.find(str);
+  if (it != strings_.end()) {
+    ++it->second;
+    return it->first;
+  }
+
+  size_t size = strlen(str) + 1;
+  char* copy = new char[size];
+  memcpy(copy, str, size);
+  strings_.insert(std::make_pair(copy, 1));
+  bytes_ += size;
+  return copy;
+}
+
+void StringPool::Release(const char* str) {
+  StringMap::iterator it = strings_.find(str);
+  if (it == strings_.end() || --it->second > 0)
+    return;
+  const char* copy = it->first;
+  bytes_ -= strlen(copy) + 1;
+  strings_.erase(it);
+  delete [] copy;
+}
+
+size_t StringPool::Hash::operator()(const char* str) const {
+  // 64-bit FNV-1a, truncated to size_t.
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (; *str; ++str) {
+    hash ^= static_cast<unsigned char>(*str);
+    hash *= 0x100000001b3ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+bool StringPool::Equal::operator()(const char* a, const char* b) const {
+  return strcmp(a, b) == 0;
+}
+
+}  // namespace google_breakpad
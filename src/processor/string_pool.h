@@ -0,0 +1,85 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// string_pool.h: StringPool, a reference-counted string interning table.
+//
+// The modules loaded into a BasicSourceLineResolver share a StringPool, so
+// that a function name, inline origin name or source file path that many
+// modules contain is held only once.  Each string is freed when the last
+// module that interned it is unloaded.
+//
+// StringPool is not thread-safe.
+
+#ifndef PROCESSOR_STRING_POOL_H__
+#define PROCESSOR_STRING_POOL_H__
+
+#include <stddef.h>
+
+#include <unordered_map>
+
+namespace google_breakpad {
+
+class StringPool {
+ public:
+  StringPool() : bytes_(0) {}
+  ~StringPool();
+
+  // Returns the pool's copy of |str|, adding a reference to it.  The copy
+  // stays valid until each reference is dropped with Release().
+  const char* Intern(const char* str);
+
+  // Drops a reference to |str|, which must have been returned by Intern().
+  void Release(const char* str);
+
+  // The number of distinct strings held, and their total size in bytes,
+  // including terminators.
+  size_t size() const { return strings_.size(); }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  struct Hash {
+    size_t operator()(const char* str) const;
+  };
+  struct Equal {
+    bool operator()(const char* a, const char* b) const;
+  };
+
+  // Each pooled string, mapped to its reference count.
+  typedef std::unordered_map<const char*, size_t, Hash, Equal> StringMap;
+  StringMap strings_;
+  size_t bytes_;
+
+  // Disallow copy constructor and assignment operator.
+  StringPool(const StringPool&);
+  void operator=(const StringPool&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_STRING_POOL_H__
@@ -0,0 +1,90 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// string_pool_unittest.cc: Unit tests for StringPool.
+
+#include <string.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "processor/string_pool.h"
+
+namespace {
+
+using google_breakpad::StringPool;
+
+TEST(StringPoolTest, SharesEqualStrings) {
+  StringPool pool;
+  std::string first("std::vector<int>::push_back(int const&)");
+  std::string second(first);
+  const char* a = pool.Intern(first.c_str());
+  const char* b = pool.Intern(second.c_str());
+  EXPECT_EQ(a, b);
+  EXPECT_NE(first.c_str(), a);
+  EXPECT_STREQ(first.c_str(), a);
+  EXPECT_EQ(1U, pool.size());
+  EXPECT_EQ(first.size() + 1, pool.bytes());
+
+  const char* c = pool.Intern("main");
+  EXPECT_NE(a, c);
+  EXPECT_EQ(2U, pool.size());
+  EXPECT_EQ(first.size() + 1 + 5, pool.bytes());
+}
+
+TEST(StringPoolTest, FreesUnreferencedStrings) {
+  StringPool pool;
+  const char* a = pool.Intern("file.cc");
+  pool.Intern("file.cc");
+  const char* empty = pool.Intern("");
+  EXPECT_STREQ("", empty);
+  EXPECT_EQ(2U, pool.size());
+
+  pool.Release(a);
+  EXPECT_EQ(2U, pool.size());
+  EXPECT_STREQ("file.cc", a);
+  pool.Release(a);
+  EXPECT_EQ(1U, pool.size());
+  EXPECT_EQ(1U, pool.bytes());
+  pool.Release(empty);
+  EXPECT_EQ(0U, pool.size());
+  EXPECT_EQ(0U, pool.bytes());
+
+  // Interning again after the last release makes a new copy.
+  const char* b = pool.Intern("file.cc");
+  EXPECT_STREQ("file.cc", b);
+  EXPECT_EQ(1U, pool.size());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
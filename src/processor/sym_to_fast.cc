@@ -0,0 +1,127 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// sym_to_fast.cc: Convert a text symbol file, as written by dump_syms, into
+// the serialized format that FastSourceLineResolver memory-maps at load time,
+// or check an existing serialized file.
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "common/path_helper.h"
+#include "common/scoped_ptr.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/source_line_resolver_base.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+
+namespace {
+
+using google_breakpad::ModuleSerializer;
+using google_breakpad::scoped_array;
+using google_breakpad::SourceLineResolverBase;
+
+static void Usage(int argc, char* argv[], bool error) {
+  FILE* fp = error ? stderr : stdout;
+
+  fprintf(fp,
+          "Usage: %s [-i] <symbol-file> <output-file>\n"
+          "       %s -c <serialized-file>\n"
+          "Convert a symbol file into the format loaded by\n"
+          "FastSourceLineResolver, or check a converted file.\n"
+          "\n"
+          "Options:\n"
+          "  -c         Check the version and checksum of <serialized-file>\n"
+          "  -h         Usage\n"
+          "  -i         Add search indexes to large address maps\n",
+          google_breakpad::BaseName(argv[0]).c_str(),
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+static bool CheckSerializedFile(const string& path) {
+  char* data;
+  size_t size;
+  if (!SourceLineResolverBase::ReadSymbolFile(path, &data, &size))
+    return false;
+  scoped_array<char> buffer(data);
+  return ModuleSerializer::VerifySerializedData(buffer.get(), size);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  BPLOG_INIT(&argc, &argv);
+
+  bool check = false;
+  bool build_search_index = false;
+  int ch;
+  while ((ch = getopt(argc, argv, "chi")) != -1) {
+    switch (ch) {
+      case 'c':
+        check = true;
+        break;
+      case 'i':
+        build_search_index = true;
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        return 0;
+      default:
+        Usage(argc, argv, true);
+        return 1;
+    }
+  }
+
+  if (check) {
+    if (argc - optind != 1) {
+      Usage(argc, argv, true);
+      return 1;
+    }
+    if (!CheckSerializedFile(argv[optind])) {
+      fprintf(stderr, "%s: %s is not a valid serialized symbol file\n",
+              argv[0], argv[optind]);
+      return 1;
+    }
+    return 0;
+  }
+
+  if (argc - optind != 2) {
+    Usage(argc, argv, true);
+    return 1;
+  }
+  ModuleSerializer serializer;
+  serializer.set_build_search_index(build_search_index);
+  if (!serializer.ConvertSymbolFile(argv[optind], argv[optind + 1])) {
+    fprintf(stderr, "%s: Failed to convert %s\n", argv[0], argv[optind]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,561 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_compactor.cc: Implement google_breakpad::SymbolCompactor.
+// See symbol_compactor.h for details.
+
+#include "processor/symbol_compactor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+#include "common/module.h"
+#include "common/scoped_ptr.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+#include "processor/cfi_frame_info.h"
+#include "processor/logging.h"
+#include "processor/module_comparer.h"
+#include "processor/number_parser.h"
+#include "processor/range_map-inl.h"
+#include "processor/tokenize.h"
+#include "processor/windows_frame_info.h"
+
+namespace google_breakpad {
+
+namespace {
+
+typedef SymbolCompactor::MemAddr MemAddr;
+
+// Collects the rules CFIRuleParser reports into a Module::RuleMap, a later
+// rule for a register replacing an earlier one, as in CFIFrameInfo.
+class RuleMapHandler : public CFIRuleParser::Handler {
+ public:
+  explicit RuleMapHandler(Module::RuleMap* rules) : rules_(rules) { }
+
+  void CFARule(const string& expression) { (*rules_)[".cfa"] = expression; }
+  void RARule(const string& expression) { (*rules_)[".ra"] = expression; }
+  void RegisterRule(const string& name, const string& expression) {
+    (*rules_)[name] = expression;
+  }
+
+ private:
+  Module::RuleMap* rules_;
+};
+
+// Add the rules of RULE_SET to RULES.  Return false if RULE_SET doesn't
+// parse, leaving RULES with the rules reported before the error, as
+// BasicSourceLineResolver applies them.
+bool ParseRuleSet(const char* rule_set, Module::RuleMap* rules) {
+  RuleMapHandler handler(rules);
+  CFIRuleParser parser(&handler);
+  return parser.Parse(rule_set);
+}
+
+struct ParsedLine {
+  MemAddr address;
+  MemAddr size;
+  long number;
+  long file_id;
+};
+
+struct ParsedInline {
+  long nest_level;
+  long call_site_line;
+  bool has_call_site_file_id;
+  long call_site_file_id;
+  long origin_id;
+  vector<std::pair<MemAddr, MemAddr>> ranges;
+};
+
+// A FUNC record with the lines and inlines following it that
+// BasicSourceLineResolver stores.
+struct ParsedFunction {
+  ParsedFunction(const char* name, MemAddr address, MemAddr size,
+                 long parameter_size, bool is_multiple)
+      : name(name), address(address), size(size),
+        parameter_size(parameter_size), is_multiple(is_multiple),
+        last_nest_level(0) { }
+
+  const char* name;
+  MemAddr address;
+  MemAddr size;
+  long parameter_size;
+  bool is_multiple;
+  RangeMap<MemAddr, ParsedLine> line_map;
+  vector<ParsedLine> lines;
+  vector<ParsedInline> inlines;
+  // As in BasicSourceLineResolver::Function::AppendInline.
+  long last_nest_level;
+};
+
+struct ParsedPublic {
+  const char* name;
+  long parameter_size;
+  bool is_multiple;
+};
+
+// Return true if no lookup can ever find the PUBLIC record at ADDRESS,
+// the next being at NEXT, if HAS_NEXT: BasicSourceLineResolver only uses
+// a PUBLIC record for addresses outside every function, and only while
+// no function starts between it and the address.
+bool IsPublicShadowed(const RangeMap<MemAddr, int>& functions,
+                      MemAddr address, bool has_next, MemAddr next) {
+  int index;
+  MemAddr base, size;
+  if (!functions.RetrieveNearestRange(address, &index, &base, NULL, &size))
+    return false;
+  if (base == address)
+    return true;
+  if (address - base >= size)
+    return false;
+  // The function ends within the address space, as StoreRange checks.
+  MemAddr end = base + size;
+  if (end == 0 || (has_next && next <= end))
+    return true;
+  MemAddr next_base;
+  return functions.RetrieveRange(end, &index, &next_base, NULL, NULL) &&
+      next_base == end;
+}
+
+// Return true if the two frames SymbolCompactor::Verify compares agree.
+bool SameFrame(const StackFrame& a, const StackFrame& b) {
+  return a.function_name == b.function_name &&
+      a.function_base == b.function_base &&
+      a.source_file_name == b.source_file_name &&
+      a.source_line == b.source_line;
+}
+
+}  // namespace
+
+bool SymbolCompactor::Compact(const string& symbol_data, string* compacted) {
+  addresses_.clear();
+  vector<char> buffer(symbol_data.begin(), symbol_data.end());
+  buffer.push_back('\0');
+
+  string os, architecture, id, name;
+  bool has_module = false;
+  vector<string> info_records;
+  vector<string> verbatim_records;
+  std::map<long, const char*> files;
+  std::map<long, const char*> inline_origins;
+  vector<std::unique_ptr<ParsedFunction>> functions;
+  RangeMap<MemAddr, int> function_map;
+  std::unique_ptr<ParsedFunction> rejected_function;
+  ParsedFunction* function = NULL;
+  std::map<MemAddr, ParsedPublic> publics;
+  // The STACK CFI INIT records stored, and the STACK CFI records by
+  // address, a later one replacing an earlier one.
+  vector<std::pair<MemAddr, MemAddr>> cfi_ranges;
+  vector<Module::RuleMap> cfi_initial_rules;
+  RangeMap<MemAddr, int> cfi_map;
+  std::map<MemAddr, const char*> cfi_delta_rules;
+
+  // Split the records the way BasicSourceLineResolver::Module::ParseRecords
+  // does, and keep what it would store.
+  char* save_ptr;
+  for (char* record = strtok_r(buffer.data(), "\r\n", &save_ptr);
+       record != NULL; record = strtok_r(NULL, "\r\n", &save_ptr)) {
+    if (strncmp(record, "FILE ", 5) == 0) {
+      long index;
+      char* filename;
+      if (SymbolParseHelper::ParseFile(record, &index, &filename))
+        files.emplace(index, filename);
+    } else if (strncmp(record, "STACK ", 6) == 0) {
+      const char* platform = record + 6;
+      platform += strspn(platform, " ");
+      if (strncmp(platform, "CFI", 3) != 0 ||
+          (platform[3] != ' ' && platform[3] != '\0')) {
+        verbatim_records.push_back(record);
+        continue;
+      }
+      char* cursor;
+      strtok_r(record + 6, " \r\n", &cursor);
+      char* init_or_address = strtok_r(NULL, " \r\n", &cursor);
+      if (!init_or_address)
+        continue;
+      if (strcmp(init_or_address, "INIT") == 0) {
+        char* address_field = strtok_r(NULL, " \r\n", &cursor);
+        char* size_field = address_field ?
+            strtok_r(NULL, " \r\n", &cursor) : NULL;
+        char* rules = size_field ? strtok_r(NULL, "\r\n", &cursor) : NULL;
+        if (!rules)
+          continue;
+        MemAddr address;
+        MemAddr size;
+        if (!ParseHexField(address_field, &address) ||
+            !ParseHexField(size_field, &size)) {
+          continue;
+        }
+        addresses_.push_back(address);
+        addresses_.push_back(address + size);
+        if (!cfi_map.StoreRange(address, size, cfi_ranges.size()))
+          continue;
+        cfi_ranges.push_back(std::make_pair(address, size));
+        cfi_initial_rules.push_back(Module::RuleMap());
+        // Lookups in a range whose rules don't parse find nothing, as if
+        // it weren't there, but it still keeps out the later records it
+        // overlaps: leave its rules empty so that it isn't written.
+        if (!ParseRuleSet(rules, &cfi_initial_rules.back()))
+          cfi_initial_rules.back().clear();
+      } else {
+        char* rules = strtok_r(NULL, "\r\n", &cursor);
+        if (!rules)
+          continue;
+        MemAddr address;
+        if (!ParseHexField(init_or_address, &address))
+          continue;
+        addresses_.push_back(address);
+        cfi_delta_rules[address] = rules;
+      }
+    } else if (strncmp(record, "FUNC ", 5) == 0) {
+      bool is_multiple;
+      uint64_t address;
+      uint64_t size;
+      long parameter_size;
+      char* function_name;
+      function = NULL;
+      if (!SymbolParseHelper::ParseFunction(record, &is_multiple, &address,
+                                            &size, &parameter_size,
+                                            &function_name)) {
+        continue;
+      }
+      addresses_.push_back(address);
+      addresses_.push_back(address + size);
+      std::unique_ptr<ParsedFunction> parsed(
+          new ParsedFunction(function_name, address, size, parameter_size,
+                             is_multiple));
+      function = parsed.get();
+      // The lines of a function that can't be stored are still parsed;
+      // keep them to one side.
+      if (*function_name != '\0' &&
+          function_map.StoreRange(address, size, functions.size())) {
+        functions.push_back(std::move(parsed));
+      } else {
+        rejected_function = std::move(parsed);
+      }
+    } else if (strncmp(record, "PUBLIC ", 7) == 0) {
+      function = NULL;
+      bool is_multiple;
+      uint64_t address;
+      long parameter_size;
+      char* public_name;
+      if (SymbolParseHelper::ParsePublicSymbol(record, &is_multiple, &address,
+                                               &parameter_size,
+                                               &public_name) &&
+          address != 0) {
+        addresses_.push_back(address);
+        ParsedPublic parsed = { public_name, parameter_size, is_multiple };
+        publics.emplace(address, parsed);
+      }
+    } else if (strncmp(record, "MODULE ", 7) == 0) {
+      vector<char*> tokens;
+      if (!has_module && Tokenize(record + 7, " ", 4, &tokens)) {
+        os = tokens[0];
+        architecture = tokens[1];
+        id = tokens[2];
+        name = tokens[3];
+        has_module = true;
+      }
+    } else if (strncmp(record, "INFO ", 5) == 0) {
+      info_records.push_back(record);
+    } else if (strncmp(record, "INLINE ", 7) == 0) {
+      ParsedInline in;
+      if (!function ||
+          !SymbolParseHelper::ParseInline(record, &in.has_call_site_file_id,
+                                          &in.nest_level, &in.call_site_line,
+                                          &in.call_site_file_id,
+                                          &in.origin_id, &in.ranges)) {
+        continue;
+      }
+      for (const std::pair<MemAddr, MemAddr>& range : in.ranges) {
+        addresses_.push_back(range.first);
+        addresses_.push_back(range.first + range.second);
+      }
+      if (in.nest_level > function->last_nest_level + 1)
+        continue;
+      function->last_nest_level = in.nest_level;
+      function->inlines.push_back(std::move(in));
+    } else if (strncmp(record, "INLINE_ORIGIN ", 14) == 0) {
+      bool has_file_id;
+      long origin_id;
+      long file_id;
+      char* origin_name;
+      if (SymbolParseHelper::ParseInlineOrigin(record, &has_file_id,
+                                               &origin_id, &file_id,
+                                               &origin_name)) {
+        inline_origins.emplace(origin_id, origin_name);
+      }
+    } else if (function) {
+      ParsedLine line;
+      if (SymbolParseHelper::ParseLine(record, &line.address, &line.size,
+                                       &line.number, &line.file_id)) {
+        addresses_.push_back(line.address);
+        addresses_.push_back(line.address + line.size);
+        if (function->line_map.StoreRange(line.address, line.size, line))
+          function->lines.push_back(line);
+      }
+    }
+  }
+  if (!has_module)
+    return false;
+
+  Module module(name, os, architecture, id);
+  std::map<long, Module::File*> module_files;
+  for (const auto& file : files)
+    module_files[file.first] = module.FindFile(file.second);
+  auto find_file = [&](long file_id) -> Module::File* {
+    std::map<long, Module::File*>::const_iterator it =
+        module_files.find(file_id);
+    return it == module_files.end() ? NULL : it->second;
+  };
+  // Inline origins are keyed by their ids; those of undefined origins are
+  // looked up under the name BasicSourceLineResolver gives them.
+  const uint64_t kUndefinedOrigin = ~static_cast<uint64_t>(0);
+  auto find_origin = [&](long origin_id) {
+    std::map<long, const char*>::const_iterator it =
+        inline_origins.find(origin_id);
+    uint64_t offset = it == inline_origins.end() ?
+        kUndefinedOrigin : static_cast<uint64_t>(origin_id);
+    module.inline_origin_map.SetReference(offset, offset);
+    return module.inline_origin_map.GetOrCreateInlineOrigin(
+        offset, module.AddStringToPool(it == inline_origins.end() ?
+                                       "<name omitted>" : it->second));
+  };
+
+  for (const std::unique_ptr<ParsedFunction>& parsed : functions) {
+    Module::Function* module_function = new Module::Function(
+        module.AddStringToPool(parsed->name), parsed->address);
+    module_function->ranges.push_back(
+        Module::Range(parsed->address, parsed->size));
+    module_function->parameter_size = parsed->parameter_size;
+    module_function->is_multiple = parsed->is_multiple;
+
+    // Only the part of a line within its function can be looked up.
+    std::sort(parsed->lines.begin(), parsed->lines.end(),
+              [](const ParsedLine& a, const ParsedLine& b) {
+                return a.address < b.address;
+              });
+    for (const ParsedLine& line : parsed->lines) {
+      Module::File* file = find_file(line.file_id);
+      MemAddr address = line.address;
+      MemAddr size = line.size;
+      if (address < parsed->address) {
+        if (size <= parsed->address - address)
+          continue;
+        size -= parsed->address - address;
+        address = parsed->address;
+      }
+      if (!file || address - parsed->address >= parsed->size)
+        continue;
+      vector<Module::Line>& lines = module_function->lines;
+      if (!lines.empty() && lines.back().file == file &&
+          lines.back().number == line.number &&
+          lines.back().address + lines.back().size == address) {
+        lines.back().size += size;
+        continue;
+      }
+      Module::Line module_line = { address, size, file,
+                                   static_cast<int>(line.number) };
+      lines.push_back(module_line);
+    }
+
+    // Rebuild the tree of inlines Module keeps from their nesting levels;
+    // it lists them in the same order.
+    vector<Module::Inline*> open_inlines;
+    for (const ParsedInline& in : parsed->inlines) {
+      vector<Module::Range> ranges;
+      for (const std::pair<MemAddr, MemAddr>& range : in.ranges)
+        ranges.push_back(Module::Range(range.first, range.second));
+      std::unique_ptr<Module::Inline> module_inline(new Module::Inline(
+          find_origin(in.origin_id), ranges, in.call_site_line, -1,
+          in.nest_level, vector<std::unique_ptr<Module::Inline>>()));
+      if (in.has_call_site_file_id)
+        module_inline->call_site_file = find_file(in.call_site_file_id);
+      while (!open_inlines.empty() &&
+             open_inlines.back()->inline_nest_level >= in.nest_level) {
+        open_inlines.pop_back();
+      }
+      Module::Inline* added = module_inline.get();
+      if (!open_inlines.empty() &&
+          open_inlines.back()->inline_nest_level == in.nest_level - 1) {
+        open_inlines.back()->child_inlines.push_back(
+            std::move(module_inline));
+      } else {
+        module_function->inlines.push_back(std::move(module_inline));
+      }
+      open_inlines.push_back(added);
+    }
+    module.AddFunction(module_function);
+  }
+
+  // Add the externs after the functions, so that AddFunction leaves them
+  // alone.
+  for (std::map<MemAddr, ParsedPublic>::const_iterator it = publics.begin();
+       it != publics.end(); ++it) {
+    std::map<MemAddr, ParsedPublic>::const_iterator next = it;
+    ++next;
+    if (IsPublicShadowed(function_map, it->first, next != publics.end(),
+                         next == publics.end() ? 0 : next->first)) {
+      continue;
+    }
+    Module::Extern* ext = new Module::Extern(it->first);
+    ext->name = it->second.name;
+    ext->parameter_size = it->second.parameter_size;
+    ext->is_multiple = it->second.is_multiple;
+    module.AddExtern(ext);
+  }
+
+  // Give each range its STACK CFI records, applying them in order to find
+  // those rules that change nothing.
+  vector<size_t> cfi_order(cfi_ranges.size());
+  for (size_t i = 0; i < cfi_order.size(); ++i)
+    cfi_order[i] = i;
+  std::sort(cfi_order.begin(), cfi_order.end(), [&](size_t a, size_t b) {
+    return cfi_ranges[a].first < cfi_ranges[b].first;
+  });
+  for (size_t i : cfi_order) {
+    if (cfi_initial_rules[i].empty())
+      continue;
+    Module::StackFrameEntry* entry = new Module::StackFrameEntry();
+    entry->address = cfi_ranges[i].first;
+    entry->size = cfi_ranges[i].second;
+    entry->initial_rules = cfi_initial_rules[i];
+    Module::RuleMap rules = entry->initial_rules;
+    for (std::map<MemAddr, const char*>::const_iterator delta =
+             cfi_delta_rules.lower_bound(entry->address);
+         delta != cfi_delta_rules.end() &&
+             delta->first - entry->address < entry->size;
+         ++delta) {
+      Module::RuleMap changes;
+      ParseRuleSet(delta->second, &changes);
+      for (const auto& rule : changes) {
+        Module::RuleString& current = rules[rule.first];
+        if (current != rule.second) {
+          current = rule.second;
+          entry->rule_changes[delta->first][rule.first] = rule.second;
+        }
+      }
+    }
+    module.AddStackFrameEntry(entry);
+  }
+
+  std::ostringstream stream;
+  if (!module.Write(stream, ALL_SYMBOL_DATA))
+    return false;
+  string written = stream.str();
+  // The INFO records follow the MODULE record.
+  size_t header_end = written.find('\n') + 1;
+  compacted->assign(written, 0, header_end);
+  for (const string& record : info_records)
+    compacted->append(record).push_back('\n');
+  compacted->append(written, header_end, string::npos);
+  for (const string& record : verbatim_records)
+    compacted->append(record).push_back('\n');
+  return true;
+}
+
+bool SymbolCompactor::Verify(const string& symbol_data,
+                             const string& compacted) {
+  ModuleComparer comparer;
+  if (!comparer.Compare(compacted)) {
+    BPLOG(ERROR) << "Compacted symbols load differently into "
+                    "BasicSourceLineResolver and FastSourceLineResolver";
+    return false;
+  }
+
+  BasicCodeModule code_module(0, ~static_cast<uint64_t>(0), "module", "", "",
+                              "", "");
+  BasicSourceLineResolver original_resolver;
+  BasicSourceLineResolver compacted_resolver;
+  if (!original_resolver.LoadModuleUsingMapBuffer(&code_module,
+                                                  symbol_data) ||
+      !compacted_resolver.LoadModuleUsingMapBuffer(&code_module, compacted)) {
+    BPLOG(ERROR) << "Couldn't load symbols to compare";
+    return false;
+  }
+
+  std::sort(addresses_.begin(), addresses_.end());
+  addresses_.erase(std::unique(addresses_.begin(), addresses_.end()),
+                   addresses_.end());
+  for (MemAddr address : addresses_) {
+    StackFrame original_frame;
+    StackFrame compacted_frame;
+    original_frame.instruction = compacted_frame.instruction = address;
+    original_frame.module = compacted_frame.module = &code_module;
+    std::deque<std::unique_ptr<StackFrame>> original_inlines;
+    std::deque<std::unique_ptr<StackFrame>> compacted_inlines;
+    original_resolver.FillSourceLineInfo(&original_frame, &original_inlines);
+    compacted_resolver.FillSourceLineInfo(&compacted_frame,
+                                          &compacted_inlines);
+    bool same = SameFrame(original_frame, compacted_frame) &&
+        original_inlines.size() == compacted_inlines.size();
+    for (size_t i = 0; same && i < original_inlines.size(); ++i)
+      same = SameFrame(*original_inlines[i], *compacted_inlines[i]);
+
+    scoped_ptr<WindowsFrameInfo> original_windows(
+        original_resolver.FindWindowsFrameInfo(&original_frame));
+    scoped_ptr<WindowsFrameInfo> compacted_windows(
+        compacted_resolver.FindWindowsFrameInfo(&compacted_frame));
+    if (same && original_windows.get() && compacted_windows.get()) {
+      same = original_windows->valid == compacted_windows->valid &&
+          original_windows->parameter_size ==
+              compacted_windows->parameter_size;
+    } else if (same) {
+      same = !original_windows.get() && !compacted_windows.get();
+    }
+
+    scoped_ptr<CFIFrameInfo> original_cfi(
+        original_resolver.FindCFIFrameInfo(&original_frame));
+    scoped_ptr<CFIFrameInfo> compacted_cfi(
+        compacted_resolver.FindCFIFrameInfo(&compacted_frame));
+    if (same && original_cfi.get() && compacted_cfi.get()) {
+      same = original_cfi->Serialize() == compacted_cfi->Serialize();
+    } else if (same) {
+      same = !original_cfi.get() && !compacted_cfi.get();
+    }
+
+    if (!same) {
+      BPLOG(ERROR) << "Compacted symbols differ at address "
+                   << HexString(address);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace google_breakpad
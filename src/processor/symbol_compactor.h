@@ -0,0 +1,92 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_compactor.h: SymbolCompactor rewrites a text symbol file in
+// canonical form, without the records that can't change what
+// BasicSourceLineResolver looks up in it.
+
+#ifndef PROCESSOR_SYMBOL_COMPACTOR_H__
+#define PROCESSOR_SYMBOL_COMPACTOR_H__
+
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/source_line_resolver_interface.h"
+
+namespace google_breakpad {
+
+// SymbolCompactor reads a symbol file with SymbolParseHelper, keeping the
+// records as BasicSourceLineResolver would, into a Module, and writes it
+// back with Module::Write.  On the way it:
+//
+// - leaves out records the resolver would reject or never consult: FUNC
+//   records overlapping earlier ones, with their lines; lines outside
+//   their function, overlapping an earlier line, or citing an undefined
+//   file; duplicate PUBLIC records and those at address zero; STACK CFI
+//   INIT records overlapping earlier ones or whose rules don't parse; and
+//   STACK CFI records outside every STACK CFI INIT record's range;
+// - drops FILE and INLINE_ORIGIN records nothing cites, and renumbers the
+//   rest;
+// - drops PUBLIC records a FUNC record always takes precedence over:
+//   those at the start of a function, and those within one that another
+//   PUBLIC record or function follows before it ends;
+// - merges adjacent lines of a function with the same file and line
+//   number; and
+// - drops the rules of STACK CFI records that restate the rule already in
+//   force, and the records left empty.
+//
+// Looking up any address in the result gives the same function, source
+// file, line, inlined frames, parameter size and CFI rules as in the
+// original; only StackFrame::source_line_base may move back to the start
+// of a merged line.  STACK WIN and INFO records are kept verbatim.
+class SymbolCompactor {
+ public:
+  typedef SourceLineResolverInterface::MemAddr MemAddr;
+
+  // Compact SYMBOL_DATA, the contents of a symbol file, into *COMPACTED.
+  // Return false if SYMBOL_DATA has no MODULE record.
+  bool Compact(const string& symbol_data, string* compacted);
+
+  // Return true if COMPACTED, which Compact made of SYMBOL_DATA, loads the
+  // same way into BasicSourceLineResolver and FastSourceLineResolver, as
+  // ModuleComparer checks, and if every address at which a record of
+  // SYMBOL_DATA begins or ends looks up the same in both files.  Log the
+  // first difference found.
+  bool Verify(const string& symbol_data, const string& compacted);
+
+ private:
+  // The addresses at which the records of the last symbol file compacted
+  // begin or end, unsorted.
+  std::vector<MemAddr> addresses_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SYMBOL_COMPACTOR_H__
@@ -0,0 +1,177 @@
+// Copyright (c) 2026 Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_compactor_unittest.cc: Unit tests for SymbolCompactor.
+
+#include <stdlib.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/using_std_string.h"
+#include "processor/symbol_compactor.h"
+
+namespace {
+
+using google_breakpad::SymbolCompactor;
+
+TEST(SymbolCompactorTest, NoModule) {
+  SymbolCompactor compactor;
+  string compacted;
+  EXPECT_FALSE(compactor.Compact("FUNC 1000 10 0 f\n", &compacted));
+}
+
+TEST(SymbolCompactorTest, RedundantRecords) {
+  const string symbols =
+      "MODULE Linux x86_64 0123456789ABCDEF0123456789ABCDEF0 m\n"
+      "INFO CODE_ID 0123456789ABCDEF\n"
+      "FILE 0 a.cc\n"
+      "FILE 1 unused.cc\n"
+      "FILE 2 b.cc\n"
+      "FUNC 1000 20 0 f\n"
+      "1000 8 10 0\n"
+      "1008 8 10 0\n"
+      "1010 10 11 2\n"
+      "FUNC 1010 10 0 overlaps_f\n"
+      "1010 10 12 0\n"
+      "FUNC 2000 10 4 g\n"
+      "1ff0 18 20 0\n"
+      "2008 20 21 0\n"
+      "PUBLIC 1000 0 at_f\n"
+      "PUBLIC 1004 0 shadowed_by_f\n"
+      "PUBLIC 1018 0 falls_past_f\n"
+      "PUBLIC 3000 0 p\n"
+      "PUBLIC 3000 0 duplicate_p\n"
+      "PUBLIC 0 0 at_zero\n"
+      "STACK CFI INIT 1000 20 .cfa: $rsp 8 + .ra: .cfa -8 + ^\n"
+      "STACK CFI 1004 .cfa: $rsp 16 +\n"
+      "STACK CFI 1008 .cfa: $rsp 16 + .ra: .cfa -8 + ^\n"
+      "STACK CFI 100c .cfa: $rsp 8 +\n"
+      "STACK CFI 4000 .cfa: $rsp 32 +\n"
+      "STACK WIN 4 1000 20 0 0 0 0 0 0 1 $eip 4 + ^ =\n";
+  SymbolCompactor compactor;
+  string compacted;
+  ASSERT_TRUE(compactor.Compact(symbols, &compacted));
+  EXPECT_EQ("MODULE Linux x86_64 0123456789ABCDEF0123456789ABCDEF0 m\n"
+            "INFO CODE_ID 0123456789ABCDEF\n"
+            "FILE 0 a.cc\n"
+            "FILE 1 b.cc\n"
+            "FUNC 1000 20 0 f\n"
+            "1000 10 10 0\n"
+            "1010 10 11 1\n"
+            "FUNC 2000 10 4 g\n"
+            "2000 8 20 0\n"
+            "2008 20 21 0\n"
+            "PUBLIC 1018 0 falls_past_f\n"
+            "PUBLIC 3000 0 p\n"
+            "STACK CFI INIT 1000 20 .cfa: $rsp 8 + .ra: .cfa -8 + ^\n"
+            "STACK CFI 1004 .cfa: $rsp 16 +\n"
+            "STACK CFI 100c .cfa: $rsp 8 +\n"
+            "STACK WIN 4 1000 20 0 0 0 0 0 0 1 $eip 4 + ^ =\n",
+            compacted);
+  EXPECT_TRUE(compactor.Verify(symbols, compacted));
+}
+
+TEST(SymbolCompactorTest, Inlines) {
+  const string symbols =
+      "MODULE Linux x86_64 0123456789ABCDEF0123456789ABCDEF0 m\n"
+      "FILE 0 a.cc\n"
+      "INLINE_ORIGIN 0 unused\n"
+      "INLINE_ORIGIN 1 inner\n"
+      "INLINE_ORIGIN 2 outer\n"
+      "FUNC 1000 40 0 f\n"
+      "INLINE 0 5 0 2 1000 20\n"
+      "INLINE 1 6 0 1 1008 8\n"
+      "INLINE 3 7 0 1 1010 4\n"
+      "INLINE 0 8 0 9 1030 8\n"
+      "1000 40 1 0\n";
+  SymbolCompactor compactor;
+  string compacted;
+  ASSERT_TRUE(compactor.Compact(symbols, &compacted));
+  EXPECT_EQ("MODULE Linux x86_64 0123456789ABCDEF0123456789ABCDEF0 m\n"
+            "FILE 0 a.cc\n"
+            "INLINE_ORIGIN 0 <name omitted>\n"
+            "INLINE_ORIGIN 1 inner\n"
+            "INLINE_ORIGIN 2 outer\n"
+            "FUNC 1000 40 0 f\n"
+            "INLINE 0 5 0 2 1000 20\n"
+            "INLINE 1 6 0 1 1008 8\n"
+            "INLINE 0 8 0 0 1030 8\n"
+            "1000 40 1 0\n",
+            compacted);
+  EXPECT_TRUE(compactor.Verify(symbols, compacted));
+}
+
+TEST(SymbolCompactorTest, VerifyFindsDifferences) {
+  const string symbols =
+      "MODULE Linux x86_64 0123456789ABCDEF0123456789ABCDEF0 m\n"
+      "FILE 0 a.cc\n"
+      "FUNC 1000 20 0 f\n"
+      "1000 20 10 0\n";
+  SymbolCompactor compactor;
+  string compacted;
+  ASSERT_TRUE(compactor.Compact(symbols, &compacted));
+  EXPECT_TRUE(compactor.Verify(symbols, compacted));
+  string changed = compacted;
+  changed.replace(changed.find("1000 20 10 0"), 12, "1000 20 11 0");
+  EXPECT_FALSE(compactor.Verify(symbols, changed));
+}
+
+TEST(SymbolCompactorTest, TestData) {
+  const string testdata_dir =
+      string(getenv("srcdir") ? getenv("srcdir") : ".") +
+      "/src/processor/testdata/symbols/";
+  const char* const kSymbolFiles[] = {
+    "kernel32.pdb/BCE8785C57B44245A669896B6A19B9542/kernel32.sym",
+    "ld-2.13.so/C32AD7E235EA6112E02A5B9D6219C4850/ld-2.13.so.sym",
+    "libgcc_s.so.1/18B180F90887D8F8B5C35D185444AF4C0/libgcc_s.so.1.sym",
+    "linux_inline/BBA6FA10B8AAB33D00000000000000000/linux_inline.new.sym",
+    "null_read_av/7B7D1968FF0D47AE4366E9C3A7E1B6750/null_read_av.sym",
+    "overflow/B0E1FC01EF48E39CAF5C881D2DF0C3840/overflow.sym",
+    "test_app.pdb/5A9832E5287241C1838ED98914E9B7FF1/test_app.sym",
+  };
+  for (const char* symbol_file : kSymbolFiles) {
+    SCOPED_TRACE(symbol_file);
+    std::ifstream file(testdata_dir + symbol_file);
+    ASSERT_TRUE(file.good());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const string symbols = contents.str();
+
+    SymbolCompactor compactor;
+    string compacted;
+    ASSERT_TRUE(compactor.Compact(symbols, &compacted));
+    EXPECT_LE(compacted.size(), symbols.size());
+    EXPECT_TRUE(compactor.Verify(symbols, compacted));
+  }
+}
+
+}  // namespace
@@ -0,0 +1,479 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_file_index.cc: A summary of a text symbol file, kept in a small
+// file beside it.
+//
+// See symbol_file_index.h for documentation.
+
+#include "processor/symbol_file_index.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <vector>
+
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+const char* const kRecordKindNames[] = {
+  "FILE", "INLINE_ORIGIN", "FUNC", "LINE", "INLINE", "PUBLIC",
+  "STACK_CFI_INIT", "STACK_CFI", "STACK_WIN"
+};
+
+const char* const kSectionNames[] = {
+  "FILE", "INLINE_ORIGIN", "FUNC", "PUBLIC", "STACK"
+};
+
+// Returns true if the |length| bytes at |line| begin with |prefix|.
+bool StartsWith(const char* line, size_t length, const char* prefix) {
+  size_t prefix_length = strlen(prefix);
+  return length >= prefix_length && memcmp(line, prefix, prefix_length) == 0;
+}
+
+bool IsHexDigit(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+         (c >= 'A' && c <= 'F');
+}
+
+// Reads the hexadecimal number at |*position|, before |end|, into |value|
+// and advances |*position| past it and any spaces following it.  Returns
+// false if there is no number there.
+bool ReadHex(const char** position, const char* end, uint64_t* value) {
+  const char* p = *position;
+  *value = 0;
+  while (p < end && IsHexDigit(*p)) {
+    char c = *p++;
+    int digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+    *value = (*value << 4) | digit;
+  }
+  if (p == *position)
+    return false;
+  while (p < end && *p == ' ')
+    ++p;
+  *position = p;
+  return true;
+}
+
+// Splits the |length| bytes at |line| into |count| fields separated by
+// single spaces, the last of which takes up the rest of the line, and
+// returns true if there are at least |count| - 1 separators.  The last
+// field may be empty if |last_optional| is true.
+bool SplitFields(const char* line, size_t length, size_t count,
+                 bool last_optional, string* fields) {
+  const char* end = line + length;
+  for (size_t i = 0; i + 1 < count; ++i) {
+    const char* space = static_cast<const char*>(
+        memchr(line, ' ', end - line));
+    if (!space) {
+      if (last_optional && i + 2 == count) {
+        fields[i].assign(line, end);
+        fields[i + 1].clear();
+        return true;
+      }
+      return false;
+    }
+    fields[i].assign(line, space);
+    line = space + 1;
+  }
+  fields[count - 1].assign(line, end);
+  return true;
+}
+
+// Returns true if |field| can be written in a line of an index file.
+bool IsWritable(const string& field) {
+  return field.find_first_of("\r\n") == string::npos;
+}
+
+}  // namespace
+
+SymbolFileIndex::SymbolFileIndex() {
+  Clear();
+}
+
+// static
+const char* SymbolFileIndex::RecordKindName(RecordKind kind) {
+  return kRecordKindNames[kind];
+}
+
+// static
+const char* SymbolFileIndex::SectionName(Section section) {
+  return kSectionNames[section];
+}
+
+// static
+string SymbolFileIndex::SidecarPath(const string& symbol_file) {
+  return symbol_file + ".idx";
+}
+
+void SymbolFileIndex::Clear() {
+  os_.clear();
+  cpu_.clear();
+  debug_identifier_.clear();
+  debug_file_.clear();
+  code_identifier_.clear();
+  code_file_.clear();
+  symbol_file_size_ = 0;
+  for (int i = 0; i < RECORD_KIND_COUNT; ++i)
+    counts_[i] = 0;
+  has_span_ = false;
+  span_low_ = 0;
+  span_high_ = 0;
+  for (int i = 0; i < SECTION_COUNT; ++i)
+    sections_[i] = SectionRange();
+}
+
+bool SymbolFileIndex::Build(const char* data, size_t size) {
+  Clear();
+  symbol_file_size_ = size;
+
+  // Where each section begins and ends, with begin > end while it has no
+  // records.
+  uint64_t begins[SECTION_COUNT];
+  uint64_t ends[SECTION_COUNT];
+  for (int i = 0; i < SECTION_COUNT; ++i) {
+    begins[i] = size;
+    ends[i] = 0;
+  }
+  bool in_function = false;
+  bool has_module = false;
+
+  const char* end = data + size;
+  for (const char* line = data; line < end; ) {
+    const char* newline = static_cast<const char*>(
+        memchr(line, '\n', end - line));
+    const char* next = newline ? newline + 1 : end;
+    size_t length = (newline ? newline : end) - line;
+    if (length > 0 && line[length - 1] == '\r')
+      --length;
+    uint64_t offset = line - data;
+
+    if (!has_module) {
+      string fields[4];
+      if (length == 0) {
+        line = next;
+        continue;
+      }
+      if (!StartsWith(line, length, "MODULE ") ||
+          !SplitFields(line + 7, length - 7, 4, false, fields)) {
+        Clear();
+        return false;
+      }
+      os_ = fields[0];
+      cpu_ = fields[1];
+      debug_identifier_ = fields[2];
+      debug_file_ = fields[3];
+      has_module = true;
+      line = next;
+      continue;
+    }
+
+    int section = -1;
+    if (StartsWith(line, length, "FILE ")) {
+      ++counts_[FILE_RECORD];
+      section = FILE_SECTION;
+      in_function = false;
+    } else if (StartsWith(line, length, "INLINE_ORIGIN ")) {
+      ++counts_[INLINE_ORIGIN_RECORD];
+      section = INLINE_ORIGIN_SECTION;
+      in_function = false;
+    } else if (StartsWith(line, length, "FUNC ") ||
+               StartsWith(line, length, "PUBLIC ")) {
+      bool function = line[0] == 'F';
+      ++counts_[function ? FUNC_RECORD : PUBLIC_RECORD];
+      section = function ? FUNC_SECTION : PUBLIC_SECTION;
+      in_function = function;
+      const char* p = line + (function ? 5 : 7);
+      const char* line_end = line + length;
+      if (StartsWith(p, line_end - p, "m "))
+        p += 2;
+      uint64_t address, extent = 1;
+      if (ReadHex(&p, line_end, &address) &&
+          (!function || ReadHex(&p, line_end, &extent))) {
+        uint64_t high = address + (extent ? extent : 1);
+        if (!has_span_ || address < span_low_)
+          span_low_ = address;
+        if (!has_span_ || high > span_high_)
+          span_high_ = high;
+        has_span_ = true;
+      }
+    } else if (StartsWith(line, length, "STACK ")) {
+      if (StartsWith(line, length, "STACK CFI INIT "))
+        ++counts_[STACK_CFI_INIT_RECORD];
+      else if (StartsWith(line, length, "STACK CFI "))
+        ++counts_[STACK_CFI_RECORD];
+      else if (StartsWith(line, length, "STACK WIN "))
+        ++counts_[STACK_WIN_RECORD];
+      section = STACK_SECTION;
+      in_function = false;
+    } else if (in_function && StartsWith(line, length, "INLINE ")) {
+      ++counts_[INLINE_RECORD];
+      section = FUNC_SECTION;
+    } else if (in_function && length > 0 && IsHexDigit(line[0])) {
+      ++counts_[LINE_RECORD];
+      section = FUNC_SECTION;
+    } else if (StartsWith(line, length, "INFO CODE_ID ")) {
+      string fields[2];
+      SplitFields(line + 13, length - 13, 2, true, fields);
+      code_identifier_ = fields[0];
+      code_file_ = fields[1];
+    }
+    if (section >= 0) {
+      if (begins[section] > offset)
+        begins[section] = offset;
+      ends[section] = next - data;
+    }
+    line = next;
+  }
+
+  if (!has_module) {
+    Clear();
+    return false;
+  }
+  for (int i = 0; i < SECTION_COUNT; ++i) {
+    if (begins[i] < ends[i]) {
+      sections_[i].offset = begins[i];
+      sections_[i].size = ends[i] - begins[i];
+    }
+  }
+  return true;
+}
+
+bool SymbolFileIndex::BuildFromFile(const string& symbol_file) {
+  int fd = open(symbol_file.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) != 0 || st.st_size == 0) {
+    BPLOG(ERROR) << "Could not read " << symbol_file;
+    if (fd != -1)
+      close(fd);
+    Clear();
+    return false;
+  }
+  size_t size = st.st_size;
+  void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    BPLOG(ERROR) << "Could not map " << symbol_file << ": " << strerror(errno);
+    Clear();
+    return false;
+  }
+  bool built = Build(static_cast<const char*>(data), size);
+  munmap(data, size);
+  if (!built)
+    BPLOG(ERROR) << symbol_file << " is not a symbol file";
+  return built;
+}
+
+bool SymbolFileIndex::Read(const string& path) {
+  Clear();
+  std::ifstream file(path.c_str());
+  if (!file)
+    return false;
+
+  string line;
+  int version;
+  unsigned long long size;
+  if (!std::getline(file, line) ||
+      sscanf(line.c_str(), "SYMBOL_INDEX %d %llu", &version, &size) != 2 ||
+      version != kVersion) {
+    BPLOG(ERROR) << path << " is not a symbol file index of version "
+                 << kVersion;
+    return false;
+  }
+  symbol_file_size_ = size;
+
+  bool has_module = false;
+  while (std::getline(file, line)) {
+    string fields[4];
+    bool valid = false;
+    if (line.compare(0, 7, "MODULE ") == 0) {
+      valid = SplitFields(line.data() + 7, line.size() - 7, 4, false,
+                          fields);
+      os_ = fields[0];
+      cpu_ = fields[1];
+      debug_identifier_ = fields[2];
+      debug_file_ = fields[3];
+      has_module = valid;
+    } else if (line.compare(0, 13, "INFO CODE_ID ") == 0) {
+      valid = SplitFields(line.data() + 13, line.size() - 13, 2, true,
+                          fields);
+      code_identifier_ = fields[0];
+      code_file_ = fields[1];
+    } else if (line.compare(0, 6, "COUNT ") == 0) {
+      unsigned long long count;
+      valid = SplitFields(line.data() + 6, line.size() - 6, 2, false,
+                          fields) &&
+              sscanf(fields[1].c_str(), "%llu", &count) == 1;
+      for (int i = 0; valid && i <= RECORD_KIND_COUNT; ++i) {
+        if (i == RECORD_KIND_COUNT) {
+          valid = false;
+        } else if (fields[0] == kRecordKindNames[i]) {
+          counts_[i] = count;
+          break;
+        }
+      }
+    } else if (line.compare(0, 5, "SPAN ") == 0) {
+      unsigned long long low = 0, high = 0;
+      valid = sscanf(line.c_str(), "SPAN %llx %llx", &low, &high) == 2;
+      has_span_ = valid;
+      span_low_ = low;
+      span_high_ = high;
+    } else if (line.compare(0, 8, "SECTION ") == 0) {
+      unsigned long long offset, section_size;
+      valid = SplitFields(line.data() + 8, line.size() - 8, 3, false,
+                          fields) &&
+              sscanf(fields[1].c_str(), "%llu", &offset) == 1 &&
+              sscanf(fields[2].c_str(), "%llu", &section_size) == 1;
+      for (int i = 0; valid && i <= SECTION_COUNT; ++i) {
+        if (i == SECTION_COUNT) {
+          valid = false;
+        } else if (fields[0] == kSectionNames[i]) {
+          sections_[i].offset = offset;
+          sections_[i].size = section_size;
+          break;
+        }
+      }
+    }
+    if (!valid) {
+      BPLOG(ERROR) << "Malformed line in " << path << ": " << line;
+      Clear();
+      return false;
+    }
+  }
+  if (!has_module) {
+    BPLOG(ERROR) << path << " has no MODULE line";
+    Clear();
+    return false;
+  }
+  return true;
+}
+
+bool SymbolFileIndex::Serialize(string* text) const {
+  if (!IsWritable(os_) || !IsWritable(cpu_) ||
+      !IsWritable(debug_identifier_) || !IsWritable(debug_file_) ||
+      !IsWritable(code_identifier_) || !IsWritable(code_file_)) {
+    return false;
+  }
+
+  char buffer[128];
+  snprintf(buffer, sizeof(buffer), "SYMBOL_INDEX %d %llu\n", kVersion,
+           static_cast<unsigned long long>(symbol_file_size_));
+  *text = buffer;
+  *text += "MODULE " + os_ + " " + cpu_ + " " + debug_identifier_ + " " +
+      debug_file_ + "\n";
+  if (!code_identifier_.empty()) {
+    *text += "INFO CODE_ID " + code_identifier_;
+    if (!code_file_.empty())
+      *text += " " + code_file_;
+    *text += "\n";
+  }
+  for (int i = 0; i < RECORD_KIND_COUNT; ++i) {
+    snprintf(buffer, sizeof(buffer), "COUNT %s %llu\n", kRecordKindNames[i],
+             static_cast<unsigned long long>(counts_[i]));
+    *text += buffer;
+  }
+  if (has_span_) {
+    snprintf(buffer, sizeof(buffer), "SPAN %llx %llx\n",
+             static_cast<unsigned long long>(span_low_),
+             static_cast<unsigned long long>(span_high_));
+    *text += buffer;
+  }
+  for (int i = 0; i < SECTION_COUNT; ++i) {
+    snprintf(buffer, sizeof(buffer), "SECTION %s %llu %llu\n",
+             kSectionNames[i],
+             static_cast<unsigned long long>(sections_[i].offset),
+             static_cast<unsigned long long>(sections_[i].size));
+    *text += buffer;
+  }
+  return true;
+}
+
+bool SymbolFileIndex::Write(const string& path) const {
+  string text;
+  if (!Serialize(&text)) {
+    BPLOG(ERROR) << "Could not write " << path << ": a field holds a "
+                 << "line break";
+    return false;
+  }
+
+  // Uniquely named, in case other processes are indexing the same file.
+  string temp_template = path + ".XXXXXX";
+  std::vector<char> temp_name(temp_template.begin(), temp_template.end());
+  temp_name.push_back('\0');
+  int fd = mkstemp(&temp_name[0]);
+  // Readable by everyone, like the symbol file it sits beside.
+  FILE* file = fd == -1 || fchmod(fd, 0644) != 0 ? NULL : fdopen(fd, "w");
+  if (!file) {
+    BPLOG(ERROR) << "Could not create a temporary file for " << path <<
+        ": " << strerror(errno);
+    if (fd != -1) {
+      close(fd);
+      unlink(&temp_name[0]);
+    }
+    return false;
+  }
+  string temp_file(&temp_name[0]);
+  bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+  if (fclose(file) != 0 || !written ||
+      rename(temp_file.c_str(), path.c_str()) != 0) {
+    BPLOG(ERROR) << "Could not write " << path << ": " << strerror(errno);
+    unlink(temp_file.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool SymbolFileIndex::ReadForSymbolFile(const string& symbol_file,
+                                        bool write_sidecar) {
+  string sidecar = SidecarPath(symbol_file);
+  struct stat symbol_stat, sidecar_stat;
+  if (stat(symbol_file.c_str(), &symbol_stat) == 0 &&
+      stat(sidecar.c_str(), &sidecar_stat) == 0 &&
+      sidecar_stat.st_mtime >= symbol_stat.st_mtime && Read(sidecar) &&
+      symbol_file_size_ == static_cast<uint64_t>(symbol_stat.st_size)) {
+    return true;
+  }
+  if (!BuildFromFile(symbol_file))
+    return false;
+  if (write_sidecar)
+    Write(sidecar);
+  return true;
+}
+
+}  // namespace google_breakpad
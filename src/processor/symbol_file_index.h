@@ -0,0 +1,181 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_file_index.h: A summary of a text symbol file, kept in a small
+// file beside it, so that tools indexing a symbol store needn't read each
+// symbol file whole.
+//
+// Indexing a symbol store, for example to ingest it into a symbol server,
+// needs each file's MODULE and INFO CODE_ID records, and perhaps how many
+// records of each kind it holds and which addresses it covers.  Finding
+// that out means reading the whole symbol file.  A SymbolFileIndex holds
+// all of it, along with where each kind of record lies in the file so that
+// a parser can go straight to the records it wants.  Written once, beside
+// the symbol file at SidecarPath(), it can then be read in a single small
+// read.
+//
+// The index file is text, like the symbol file.  It begins with a
+// "SYMBOL_INDEX <version> <symbol file size>" line, followed by the
+// symbol file's MODULE line and INFO CODE_ID line if it had one, a
+// "COUNT <kind> <n>" line for each kind of record, a "SPAN <low> <high>"
+// line giving the range of addresses FUNC and PUBLIC records cover if
+// there are any, and a "SECTION <kind> <offset> <size>" line for each
+// section.
+
+#ifndef PROCESSOR_SYMBOL_FILE_INDEX_H__
+#define PROCESSOR_SYMBOL_FILE_INDEX_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class SymbolFileIndex {
+ public:
+  // The kinds of records counted.
+  enum RecordKind {
+    FILE_RECORD,
+    INLINE_ORIGIN_RECORD,
+    FUNC_RECORD,
+    LINE_RECORD,
+    INLINE_RECORD,
+    PUBLIC_RECORD,
+    STACK_CFI_INIT_RECORD,
+    STACK_CFI_RECORD,
+    STACK_WIN_RECORD,
+    RECORD_KIND_COUNT
+  };
+
+  // The sections of a symbol file, each running from the first record of
+  // its kind to the end of the last.  A FUNC section includes the LINE and
+  // INLINE records following each FUNC record, and a STACK section both
+  // STACK CFI and STACK WIN records.  dump_syms writes the sections one
+  // after another in this order, but in a file written otherwise, records
+  // of other kinds may lie within a section.
+  enum Section {
+    FILE_SECTION,
+    INLINE_ORIGIN_SECTION,
+    FUNC_SECTION,
+    PUBLIC_SECTION,
+    STACK_SECTION,
+    SECTION_COUNT
+  };
+
+  // Where a section lies in the symbol file, in bytes.  Both are 0 if the
+  // file has no records of its kind.
+  struct SectionRange {
+    SectionRange() : offset(0), size(0) {}
+
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  SymbolFileIndex();
+
+  // Returns the name of a kind of record, or of a section, as it appears
+  // in the symbol file and in index files.
+  static const char* RecordKindName(RecordKind kind);
+  static const char* SectionName(Section section);
+
+  // Returns the path of the index file kept beside |symbol_file|.
+  static string SidecarPath(const string& symbol_file);
+
+  // Indexes the |size| bytes of symbol file data at |data|, which needn't
+  // be null-terminated.  Returns false if it doesn't begin with a MODULE
+  // record.
+  bool Build(const char* data, size_t size);
+
+  // Indexes the symbol file at |symbol_file|, reading all of it.  Returns
+  // false if it can't be read or isn't a symbol file.
+  bool BuildFromFile(const string& symbol_file);
+
+  // Reads the index file at |path|.  Returns false, leaving the index
+  // empty, if it can't be read or is malformed.
+  bool Read(const string& path);
+
+  // Sets |text| to the contents of an index file for the index.  Returns
+  // false if a MODULE or INFO CODE_ID field holds a line break.
+  bool Serialize(string* text) const;
+
+  // Writes the index to |path|, by way of a temporary file renamed into
+  // place.  Returns false if it can't be serialized or written.
+  bool Write(const string& path) const;
+
+  // Reads the index kept beside |symbol_file| if there is one that is no
+  // older than the symbol file and was built from a file of its size.
+  // Otherwise indexes the symbol file, and writes the index beside it if
+  // |write_sidecar| is true.  Returns false if neither works.
+  bool ReadForSymbolFile(const string& symbol_file, bool write_sidecar);
+
+  const string& os() const { return os_; }
+  const string& cpu() const { return cpu_; }
+  const string& debug_identifier() const { return debug_identifier_; }
+  const string& debug_file() const { return debug_file_; }
+  // Empty if the symbol file has no INFO CODE_ID record.
+  const string& code_identifier() const { return code_identifier_; }
+  const string& code_file() const { return code_file_; }
+  uint64_t symbol_file_size() const { return symbol_file_size_; }
+  uint64_t count(RecordKind kind) const { return counts_[kind]; }
+  // Whether any FUNC or PUBLIC records give an address, and the lowest
+  // address they give and the address past the highest.
+  bool has_span() const { return has_span_; }
+  uint64_t span_low() const { return span_low_; }
+  uint64_t span_high() const { return span_high_; }
+  const SectionRange& section(Section section) const {
+    return sections_[section];
+  }
+
+ private:
+  // The version written at the head of index files.
+  static const int kVersion = 1;
+
+  // Empties the index.
+  void Clear();
+
+  string os_;
+  string cpu_;
+  string debug_identifier_;
+  string debug_file_;
+  string code_identifier_;
+  string code_file_;
+  uint64_t symbol_file_size_;
+  uint64_t counts_[RECORD_KIND_COUNT];
+  bool has_span_;
+  uint64_t span_low_;
+  uint64_t span_high_;
+  SectionRange sections_[SECTION_COUNT];
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SYMBOL_FILE_INDEX_H__
@@ -0,0 +1,224 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_file_index_unittest.cc: Unit tests for SymbolFileIndex.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/symbol_file_index.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::SymbolFileIndex;
+
+const char kSymbols[] =
+    "MODULE Linux x86_64 0123456789ABCDEF0123456789ABCDEF0 libfoo.so\n"
+    "INFO CODE_ID 89ABCDEF01234567 libfoo.so\n"
+    "FILE 0 foo.cc\n"
+    "FILE 1 bar.cc\n"
+    "INLINE_ORIGIN 0 inlined\n"
+    "FUNC 1000 20 0 foo\n"
+    "1000 10 3 0\n"
+    "1010 10 4 0\n"
+    "INLINE 0 5 0 0 1004 8\n"
+    "FUNC m 2000 10 0 bar\n"
+    "2000 10 8 1\n"
+    "PUBLIC 3000 0 baz\n"
+    "PUBLIC m 800 0 qux\n"
+    "STACK CFI INIT 1000 20 .cfa: $rsp 8 + .ra: .cfa -8 + ^\n"
+    "STACK CFI 1004 .cfa: $rsp 16 +\n"
+    "STACK WIN 4 2000 10 0 0 0 0 0 0 1 $eip 4 + ^ = $esp $ebp 8 + = \n";
+
+// Returns the offset at which |record| begins in kSymbols.
+uint64_t Offset(const char* record) {
+  return string(kSymbols).find(record);
+}
+
+// Writes |contents| to |path|.
+void WriteFile(const string& path, const string& contents) {
+  FILE* file = fopen(path.c_str(), "w");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(contents.size(),
+            fwrite(contents.data(), 1, contents.size(), file));
+  ASSERT_EQ(0, fclose(file));
+}
+
+// Expects |index| to be what Build() makes of kSymbols.
+void ExpectSymbolsIndex(const SymbolFileIndex& index) {
+  EXPECT_EQ("Linux", index.os());
+  EXPECT_EQ("x86_64", index.cpu());
+  EXPECT_EQ("0123456789ABCDEF0123456789ABCDEF0", index.debug_identifier());
+  EXPECT_EQ("libfoo.so", index.debug_file());
+  EXPECT_EQ("89ABCDEF01234567", index.code_identifier());
+  EXPECT_EQ("libfoo.so", index.code_file());
+  EXPECT_EQ(sizeof(kSymbols) - 1, index.symbol_file_size());
+
+  EXPECT_EQ(2U, index.count(SymbolFileIndex::FILE_RECORD));
+  EXPECT_EQ(1U, index.count(SymbolFileIndex::INLINE_ORIGIN_RECORD));
+  EXPECT_EQ(2U, index.count(SymbolFileIndex::FUNC_RECORD));
+  EXPECT_EQ(3U, index.count(SymbolFileIndex::LINE_RECORD));
+  EXPECT_EQ(1U, index.count(SymbolFileIndex::INLINE_RECORD));
+  EXPECT_EQ(2U, index.count(SymbolFileIndex::PUBLIC_RECORD));
+  EXPECT_EQ(1U, index.count(SymbolFileIndex::STACK_CFI_INIT_RECORD));
+  EXPECT_EQ(1U, index.count(SymbolFileIndex::STACK_CFI_RECORD));
+  EXPECT_EQ(1U, index.count(SymbolFileIndex::STACK_WIN_RECORD));
+
+  EXPECT_TRUE(index.has_span());
+  EXPECT_EQ(0x800U, index.span_low());
+  EXPECT_EQ(0x3001U, index.span_high());
+
+  const struct {
+    SymbolFileIndex::Section section;
+    const char* first;
+    const char* next;
+  } kSections[] = {
+    { SymbolFileIndex::FILE_SECTION, "FILE 0", "INLINE_ORIGIN" },
+    { SymbolFileIndex::INLINE_ORIGIN_SECTION, "INLINE_ORIGIN", "FUNC 1000" },
+    { SymbolFileIndex::FUNC_SECTION, "FUNC 1000", "PUBLIC 3000" },
+    { SymbolFileIndex::PUBLIC_SECTION, "PUBLIC 3000", "STACK CFI INIT" },
+  };
+  for (size_t i = 0; i < sizeof(kSections) / sizeof(kSections[0]); ++i) {
+    const SymbolFileIndex::SectionRange& range =
+        index.section(kSections[i].section);
+    EXPECT_EQ(Offset(kSections[i].first), range.offset) << i;
+    EXPECT_EQ(Offset(kSections[i].next) - Offset(kSections[i].first),
+              range.size) << i;
+  }
+  const SymbolFileIndex::SectionRange& stack =
+      index.section(SymbolFileIndex::STACK_SECTION);
+  EXPECT_EQ(Offset("STACK CFI INIT"), stack.offset);
+  EXPECT_EQ(sizeof(kSymbols) - 1, stack.offset + stack.size);
+}
+
+TEST(SymbolFileIndexTest, Build) {
+  SymbolFileIndex index;
+  ASSERT_TRUE(index.Build(kSymbols, sizeof(kSymbols) - 1));
+  ExpectSymbolsIndex(index);
+}
+
+TEST(SymbolFileIndexTest, BuildWithoutOptionalRecords) {
+  const char kMinimal[] = "\nMODULE mac arm64 ABCDEF0 My Framework\r\n";
+  SymbolFileIndex index;
+  ASSERT_TRUE(index.Build(kMinimal, sizeof(kMinimal) - 1));
+  EXPECT_EQ("mac", index.os());
+  EXPECT_EQ("My Framework", index.debug_file());
+  EXPECT_EQ("", index.code_identifier());
+  EXPECT_FALSE(index.has_span());
+  for (int i = 0; i < SymbolFileIndex::SECTION_COUNT; ++i) {
+    EXPECT_EQ(0U, index.section(
+        static_cast<SymbolFileIndex::Section>(i)).size);
+  }
+}
+
+TEST(SymbolFileIndexTest, BuildRejectsOtherFiles) {
+  SymbolFileIndex index;
+  const char kNoModule[] = "FUNC 1000 10 0 foo\n";
+  EXPECT_FALSE(index.Build(kNoModule, sizeof(kNoModule) - 1));
+  const char kShortModule[] = "MODULE Linux x86_64\n";
+  EXPECT_FALSE(index.Build(kShortModule, sizeof(kShortModule) - 1));
+  EXPECT_FALSE(index.Build("", 0));
+  EXPECT_EQ("", index.os());
+}
+
+TEST(SymbolFileIndexTest, WriteAndRead) {
+  AutoTempDir temp_dir;
+  string path = temp_dir.path() + "/index";
+  SymbolFileIndex index;
+  ASSERT_TRUE(index.Build(kSymbols, sizeof(kSymbols) - 1));
+  ASSERT_TRUE(index.Write(path));
+
+  SymbolFileIndex read_index;
+  ASSERT_TRUE(read_index.Read(path));
+  ExpectSymbolsIndex(read_index);
+  string text, read_text;
+  ASSERT_TRUE(index.Serialize(&text));
+  ASSERT_TRUE(read_index.Serialize(&read_text));
+  EXPECT_EQ(text, read_text);
+
+  WriteFile(path, text + "COUNT BOGUS 1\n");
+  EXPECT_FALSE(read_index.Read(path));
+  EXPECT_EQ("", read_index.os());
+  WriteFile(path, "SYMBOL_INDEX 999 10\n" + text.substr(text.find('\n') + 1));
+  EXPECT_FALSE(read_index.Read(path));
+  EXPECT_FALSE(read_index.Read(temp_dir.path() + "/missing"));
+}
+
+TEST(SymbolFileIndexTest, ReadForSymbolFile) {
+  AutoTempDir temp_dir;
+  string symbol_file = temp_dir.path() + "/libfoo.so.sym";
+  string sidecar = SymbolFileIndex::SidecarPath(symbol_file);
+  WriteFile(symbol_file, kSymbols);
+
+  // Without a sidecar, the symbol file is indexed, and the index is
+  // written beside it if asked for.
+  SymbolFileIndex index;
+  ASSERT_TRUE(index.ReadForSymbolFile(symbol_file, false));
+  ExpectSymbolsIndex(index);
+  struct stat st;
+  EXPECT_NE(0, stat(sidecar.c_str(), &st));
+  ASSERT_TRUE(index.ReadForSymbolFile(symbol_file, true));
+  ASSERT_EQ(0, stat(sidecar.c_str(), &st));
+
+  // An up-to-date sidecar is read instead of the symbol file.
+  string text;
+  ASSERT_TRUE(index.Serialize(&text));
+  size_t os = text.find("Linux");
+  WriteFile(sidecar, text.replace(os, 5, "Other"));
+  ASSERT_TRUE(index.ReadForSymbolFile(symbol_file, false));
+  EXPECT_EQ("Other", index.os());
+
+  // One for a symbol file of another size is not.
+  WriteFile(symbol_file, string(kSymbols) + "PUBLIC 4000 0 more\n");
+  ASSERT_TRUE(index.ReadForSymbolFile(symbol_file, true));
+  EXPECT_EQ("Linux", index.os());
+  EXPECT_EQ(3U, index.count(SymbolFileIndex::PUBLIC_RECORD));
+
+  // Nor is one older than the symbol file.
+  WriteFile(sidecar, text);
+  struct utimbuf times;
+  times.actime = times.modtime = 1;
+  ASSERT_EQ(0, utime(sidecar.c_str(), &times));
+  WriteFile(symbol_file, kSymbols);
+  ASSERT_TRUE(index.ReadForSymbolFile(symbol_file, false));
+  EXPECT_EQ("Linux", index.os());
+
+  EXPECT_FALSE(index.ReadForSymbolFile(temp_dir.path() + "/missing.sym",
+                                       true));
+}
+
+}  // namespace
@@ -0,0 +1,117 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_load_cache.cc: Single-flight symbol loads shared by the
+// StackFrameSymbolizers of a process.
+//
+// See symbol_load_cache.h for documentation.
+
+#include "processor/symbol_load_cache.h"
+
+#include "google_breakpad/processor/code_module.h"
+
+namespace google_breakpad {
+
+const int SymbolLoadCache::kDefaultMissingSymbolsTTLSeconds;
+
+SymbolSupplier::SymbolResult SymbolLoadCache::Load(
+    const CodeModule* module,
+    const std::function<SymbolSupplier::SymbolResult()>& load,
+    bool* loaded_here) {
+  string key = ModuleKey(module);
+  *loaded_here = false;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    if (IsMissingSymbolsLocked(key))
+      return SymbolSupplier::NOT_FOUND;
+
+    std::map<string, std::shared_future<SymbolSupplier::SymbolResult> >::
+        iterator in_flight = loads_.find(key);
+    if (in_flight == loads_.end())
+      break;
+
+    std::shared_future<SymbolSupplier::SymbolResult> result =
+        in_flight->second;
+    lock.unlock();
+    SymbolSupplier::SymbolResult symbol_result = result.get();
+    if (symbol_result != SymbolSupplier::INTERRUPT)
+      return symbol_result;
+    // The load that was under way gave up, perhaps on its own deadline, so
+    // take it over.
+    lock.lock();
+  }
+
+  std::promise<SymbolSupplier::SymbolResult> promise;
+  loads_[key] = promise.get_future().share();
+  lock.unlock();
+
+  SymbolSupplier::SymbolResult symbol_result = load();
+  *loaded_here = true;
+
+  lock.lock();
+  if (symbol_result == SymbolSupplier::NOT_FOUND &&
+      missing_symbols_ttl_ > std::chrono::steady_clock::duration::zero()) {
+    missing_symbols_[key] =
+        std::chrono::steady_clock::now() + missing_symbols_ttl_;
+  }
+  loads_.erase(key);
+  lock.unlock();
+  promise.set_value(symbol_result);
+  return symbol_result;
+}
+
+bool SymbolLoadCache::IsMissingSymbols(const CodeModule* module) {
+  string key = ModuleKey(module);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return IsMissingSymbolsLocked(key);
+}
+
+void SymbolLoadCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  missing_symbols_.clear();
+}
+
+// static
+string SymbolLoadCache::ModuleKey(const CodeModule* module) {
+  return module->code_file() + '\n' + module->debug_file() + '\n' +
+      module->debug_identifier();
+}
+
+bool SymbolLoadCache::IsMissingSymbolsLocked(const string& key) {
+  std::map<string, std::chrono::steady_clock::time_point>::iterator missing =
+      missing_symbols_.find(key);
+  if (missing == missing_symbols_.end())
+    return false;
+  if (std::chrono::steady_clock::now() < missing->second)
+    return true;
+  missing_symbols_.erase(missing);
+  return false;
+}
+
+}  // namespace google_breakpad
@@ -0,0 +1,116 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_load_cache.h: Single-flight symbol loads shared by the
+// StackFrameSymbolizers of a process.
+//
+// When several workers process minidumps at once, each with its own
+// StackFrameSymbolizer, they tend to need the same modules at the same
+// time.  A SymbolLoadCache shared by their symbolizers lets only one of
+// them fetch and load a given module at a time; the others wait for its
+// result rather than racing it to the supplier.  Modules whose symbols
+// weren't found are remembered for a while, so that every minidump naming
+// the same missing module doesn't ask the supplier again.
+//
+// Modules are identified by code_file, debug_file and debug_identifier,
+// so different builds of one library are loaded separately.
+
+#ifndef PROCESSOR_SYMBOL_LOAD_CACHE_H__
+#define PROCESSOR_SYMBOL_LOAD_CACHE_H__
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/symbol_supplier.h"
+
+namespace google_breakpad {
+
+class CodeModule;
+
+class SymbolLoadCache {
+ public:
+  // How long a module whose symbols weren't found is remembered, unless
+  // the cache is created with another lifetime.
+  static const int kDefaultMissingSymbolsTTLSeconds = 300;
+
+  SymbolLoadCache()
+      : missing_symbols_ttl_(
+            std::chrono::seconds(kDefaultMissingSymbolsTTLSeconds)) {}
+
+  // Creates a cache that remembers modules whose symbols weren't found for
+  // |missing_symbols_ttl|.  A zero lifetime remembers them only as long as
+  // it takes to hand the result to the loads waiting for it.
+  explicit SymbolLoadCache(
+      std::chrono::steady_clock::duration missing_symbols_ttl)
+      : missing_symbols_ttl_(missing_symbols_ttl) {}
+
+  // Loads the symbols for |module| by calling |load|, which returns the
+  // supplier's result, unless the load is already settled or under way.
+  // If another thread is running a load for the same module, waits for it
+  // and returns its result instead; if that load was interrupted, this one
+  // is tried in its place.  A module recently found to be missing its
+  // symbols returns NOT_FOUND without calling |load|.  Sets |*loaded_here|
+  // to whether |load| was called by this thread.
+  SymbolSupplier::SymbolResult Load(
+      const CodeModule* module,
+      const std::function<SymbolSupplier::SymbolResult()>& load,
+      bool* loaded_here);
+
+  // Returns true if |module| was recently found to be missing its symbols.
+  bool IsMissingSymbols(const CodeModule* module);
+
+  // Forgets the modules found to be missing their symbols.
+  void Clear();
+
+ private:
+  static string ModuleKey(const CodeModule* module);
+
+  // Returns true if |key| is in missing_symbols_ and hasn't expired,
+  // dropping it if it has.  Must be called with mutex_ held.
+  bool IsMissingSymbolsLocked(const string& key);
+
+  std::chrono::steady_clock::duration missing_symbols_ttl_;
+
+  // The loads under way, and when each module known to be missing its
+  // symbols should be forgotten, keyed by ModuleKey(), and the mutex
+  // guarding them.
+  std::map<string, std::shared_future<SymbolSupplier::SymbolResult> >
+      loads_;
+  std::map<string, std::chrono::steady_clock::time_point> missing_symbols_;
+  std::mutex mutex_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SYMBOL_LOAD_CACHE_H__
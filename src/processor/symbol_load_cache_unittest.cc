@@ -0,0 +1,237 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_load_cache_unittest.cc: Unit tests for SymbolLoadCache.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "processor/basic_code_module.h"
+#include "processor/symbol_load_cache.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::SymbolLoadCache;
+using google_breakpad::SymbolSupplier;
+
+class SymbolLoadCacheTest : public ::testing::Test {
+ public:
+  SymbolLoadCacheTest()
+      : module_(0x1000, 0x1000, "libfoo.so", "code", "libfoo.so", "DEBUG1",
+                "1.0"),
+        other_build_(0x1000, 0x1000, "libfoo.so", "code", "libfoo.so",
+                     "DEBUG2", "1.0"),
+        loads_(0) {}
+
+  // Returns a load that counts its calls and returns |result|.
+  std::function<SymbolSupplier::SymbolResult()> CountingLoad(
+      SymbolSupplier::SymbolResult result) {
+    return [this, result]() {
+      ++loads_;
+      return result;
+    };
+  }
+
+  BasicCodeModule module_;
+  BasicCodeModule other_build_;
+  std::atomic<int> loads_;
+};
+
+TEST_F(SymbolLoadCacheTest, RemembersMissingSymbols) {
+  SymbolLoadCache cache;
+  bool loaded_here = false;
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            cache.Load(&module_, CountingLoad(SymbolSupplier::NOT_FOUND),
+                       &loaded_here));
+  EXPECT_TRUE(loaded_here);
+  EXPECT_TRUE(cache.IsMissingSymbols(&module_));
+  EXPECT_FALSE(cache.IsMissingSymbols(&other_build_));
+
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            cache.Load(&module_, CountingLoad(SymbolSupplier::FOUND),
+                       &loaded_here));
+  EXPECT_FALSE(loaded_here);
+  EXPECT_EQ(1, loads_);
+
+  cache.Clear();
+  EXPECT_FALSE(cache.IsMissingSymbols(&module_));
+  EXPECT_EQ(SymbolSupplier::FOUND,
+            cache.Load(&module_, CountingLoad(SymbolSupplier::FOUND),
+                       &loaded_here));
+  EXPECT_TRUE(loaded_here);
+  EXPECT_EQ(2, loads_);
+}
+
+TEST_F(SymbolLoadCacheTest, MissingSymbolsExpire) {
+  SymbolLoadCache cache(std::chrono::milliseconds(10));
+  bool loaded_here = false;
+  cache.Load(&module_, CountingLoad(SymbolSupplier::NOT_FOUND), &loaded_here);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(cache.IsMissingSymbols(&module_));
+  cache.Load(&module_, CountingLoad(SymbolSupplier::NOT_FOUND), &loaded_here);
+  EXPECT_TRUE(loaded_here);
+  EXPECT_EQ(2, loads_);
+}
+
+TEST_F(SymbolLoadCacheTest, ZeroLifetimeForgetsMissingSymbols) {
+  SymbolLoadCache cache(std::chrono::seconds(0));
+  bool loaded_here = false;
+  cache.Load(&module_, CountingLoad(SymbolSupplier::NOT_FOUND), &loaded_here);
+  EXPECT_FALSE(cache.IsMissingSymbols(&module_));
+  cache.Load(&module_, CountingLoad(SymbolSupplier::NOT_FOUND), &loaded_here);
+  EXPECT_TRUE(loaded_here);
+  EXPECT_EQ(2, loads_);
+}
+
+TEST_F(SymbolLoadCacheTest, FoundSymbolsAreLeftToTheResolver) {
+  // The resolver remembers modules that loaded, so the cache doesn't.
+  SymbolLoadCache cache;
+  bool loaded_here = false;
+  cache.Load(&module_, CountingLoad(SymbolSupplier::FOUND), &loaded_here);
+  cache.Load(&module_, CountingLoad(SymbolSupplier::FOUND), &loaded_here);
+  EXPECT_TRUE(loaded_here);
+  EXPECT_EQ(2, loads_);
+  EXPECT_FALSE(cache.IsMissingSymbols(&module_));
+}
+
+// Runs a load of module_ that blocks until released on one thread, and
+// |followers| more loads of it on others, and returns their results.
+class BlockedLoad {
+ public:
+  BlockedLoad(SymbolLoadCache* cache, const BasicCodeModule* module,
+              SymbolSupplier::SymbolResult first_result)
+      : cache_(cache), module_(module), first_result_(first_result),
+        started_(false), released_(false), loads_(0) {}
+
+  void Run(int followers, std::vector<SymbolSupplier::SymbolResult>* results,
+           std::vector<bool>* loaded_here) {
+    results->assign(followers + 1, SymbolSupplier::INTERRUPT);
+    loaded_here->assign(followers + 1, false);
+    auto first_load = [this]() {
+      ++loads_;
+      std::unique_lock<std::mutex> lock(mutex_);
+      started_ = true;
+      changed_.notify_all();
+      while (!released_)
+        changed_.wait(lock);
+      return first_result_;
+    };
+    auto later_load = [this]() {
+      ++loads_;
+      return SymbolSupplier::FOUND;
+    };
+
+    bool first_loaded_here = false;
+    std::thread first([&]() {
+      (*results)[0] = cache_->Load(module_, first_load, &first_loaded_here);
+    });
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!started_)
+        changed_.wait(lock);
+    }
+
+    std::atomic<int> waiting(0);
+    std::vector<std::thread> threads;
+    std::unique_ptr<bool[]> follower_loaded_here(new bool[followers]);
+    for (int i = 0; i < followers; ++i) {
+      threads.push_back(std::thread([&, i]() {
+        ++waiting;
+        (*results)[i + 1] = cache_->Load(module_, later_load,
+                                         &follower_loaded_here[i]);
+      }));
+    }
+    while (waiting < followers)
+      std::this_thread::yield();
+    // Give the followers time to start waiting on the first load.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      released_ = true;
+      changed_.notify_all();
+    }
+    first.join();
+    for (size_t i = 0; i < threads.size(); ++i)
+      threads[i].join();
+    (*loaded_here)[0] = first_loaded_here;
+    for (int i = 0; i < followers; ++i)
+      (*loaded_here)[i + 1] = follower_loaded_here[i];
+  }
+
+  int loads() const { return loads_; }
+
+ private:
+  SymbolLoadCache* cache_;
+  const BasicCodeModule* module_;
+  SymbolSupplier::SymbolResult first_result_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  bool started_;
+  bool released_;
+  std::atomic<int> loads_;
+};
+
+TEST_F(SymbolLoadCacheTest, ConcurrentLoadsWaitForTheFirst) {
+  SymbolLoadCache cache;
+  BlockedLoad blocked(&cache, &module_, SymbolSupplier::NOT_FOUND);
+  std::vector<SymbolSupplier::SymbolResult> results;
+  std::vector<bool> loaded_here;
+  blocked.Run(4, &results, &loaded_here);
+  EXPECT_EQ(1, blocked.loads());
+  EXPECT_TRUE(loaded_here[0]);
+  for (size_t i = 0; i < results.size(); ++i)
+    EXPECT_EQ(SymbolSupplier::NOT_FOUND, results[i]) << i;
+  for (size_t i = 1; i < loaded_here.size(); ++i)
+    EXPECT_FALSE(loaded_here[i]) << i;
+}
+
+TEST_F(SymbolLoadCacheTest, InterruptedLoadIsTakenOver) {
+  SymbolLoadCache cache;
+  BlockedLoad blocked(&cache, &module_, SymbolSupplier::INTERRUPT);
+  std::vector<SymbolSupplier::SymbolResult> results;
+  std::vector<bool> loaded_here;
+  blocked.Run(1, &results, &loaded_here);
+  EXPECT_EQ(2, blocked.loads());
+  EXPECT_EQ(SymbolSupplier::INTERRUPT, results[0]);
+  EXPECT_EQ(SymbolSupplier::FOUND, results[1]);
+  EXPECT_TRUE(loaded_here[1]);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_path_cache.cc: Remembers which symbol files exist, for the
+// SimpleSymbolSupplier family.
+//
+// See symbol_path_cache.h for documentation.
+
+#include "processor/symbol_path_cache.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "processor/logging.h"
+
+namespace google_breakpad {
+
+namespace {
+
+// Sets |names| to the names of the entries in |directory| other than . and
+// .., and returns true, or returns false if it can't be read.
+bool ListDirectory(const string& directory, std::vector<string>* names) {
+  names->clear();
+  DIR* dir = opendir(directory.c_str());
+  if (!dir)
+    return false;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    string name = entry->d_name;
+    if (name != "." && name != "..")
+      names->push_back(name);
+  }
+  closedir(dir);
+  return true;
+}
+
+}  // namespace
+
+const int SymbolPathCache::kDefaultTTLSeconds;
+
+bool SymbolPathCache::FileExists(const string& path) {
+  std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool exists;
+    if (LookUpIndexLocked(path, now, &exists))
+      return exists;
+    std::map<string, Answer>::iterator answer = answers_.find(path);
+    if (answer != answers_.end()) {
+      if (now < answer->second.expiry)
+        return answer->second.exists;
+      answers_.erase(answer);
+    }
+  }
+
+  // Don't hold the lock across the file system's round trip.
+  struct stat sb;
+  Answer answer;
+  answer.exists = stat(path.c_str(), &sb) == 0;
+  answer.expiry = now + ttl_;
+  if (ttl_ > std::chrono::steady_clock::duration::zero()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    answers_[path] = answer;
+  }
+  return answer.exists;
+}
+
+bool SymbolPathCache::IndexRoot(const string& root) {
+  // Symbol files are at <root>/<debug file>/<identifier>/<name>.sym.
+  Index index;
+  std::vector<string> debug_files;
+  if (!ListDirectory(root, &debug_files)) {
+    BPLOG(ERROR) << "Could not list symbol path " << root;
+    return false;
+  }
+  std::vector<string> identifiers;
+  std::vector<string> names;
+  for (size_t i = 0; i < debug_files.size(); ++i) {
+    string debug_file_path = root + "/" + debug_files[i];
+    if (!ListDirectory(debug_file_path, &identifiers))
+      continue;
+    for (size_t j = 0; j < identifiers.size(); ++j) {
+      string identifier_path = debug_file_path + "/" + identifiers[j];
+      if (!ListDirectory(identifier_path, &names))
+        continue;
+      for (size_t k = 0; k < names.size(); ++k)
+        index.files.insert(identifier_path + "/" + names[k]);
+    }
+  }
+  index.expiry = std::chrono::steady_clock::now() + ttl_;
+  BPLOG(INFO) << "Indexed " << index.files.size() << " symbol files in "
+              << root;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Index& entry = indexes_[root];
+  entry.files.swap(index.files);
+  entry.expiry = index.expiry;
+  return true;
+}
+
+void SymbolPathCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  answers_.clear();
+  indexes_.clear();
+}
+
+bool SymbolPathCache::LookUpIndexLocked(
+    const string& path,
+    std::chrono::steady_clock::time_point now,
+    bool* exists) {
+  std::map<string, Index>::iterator index = indexes_.begin();
+  while (index != indexes_.end()) {
+    const string& root = index->first;
+    if (path.size() <= root.size() ||
+        path.compare(0, root.size(), root) != 0 ||
+        path[root.size()] != '/') {
+      ++index;
+      continue;
+    }
+    if (now >= index->second.expiry) {
+      indexes_.erase(index++);
+      continue;
+    }
+    *exists = index->second.files.count(path) != 0;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace google_breakpad
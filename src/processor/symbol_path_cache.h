@@ -0,0 +1,112 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_path_cache.h: Remembers which symbol files exist, for the
+// SimpleSymbolSupplier family.
+//
+// SimpleSymbolSupplier looks for each module's symbol file by checking for
+// it beneath each of its root paths in turn.  The same modules, including
+// system libraries that never have symbols, turn up in minidump after
+// minidump, and when the roots are on a network file system every check is
+// a round trip.  A SymbolPathCache remembers the answers, found or not, for
+// a while, and may be shared by the suppliers of a process.
+//
+// A root may also be indexed: its symbol files are listed once, and paths
+// beneath it are then looked up in the listing instead of the file system
+// until the listing is as old as the cache's lifetime.
+
+#ifndef PROCESSOR_SYMBOL_PATH_CACHE_H__
+#define PROCESSOR_SYMBOL_PATH_CACHE_H__
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "common/using_std_string.h"
+
+namespace google_breakpad {
+
+class SymbolPathCache {
+ public:
+  // How long an answer is remembered, unless the cache is created with
+  // another lifetime.
+  static const int kDefaultTTLSeconds = 300;
+
+  SymbolPathCache()
+      : ttl_(std::chrono::seconds(kDefaultTTLSeconds)) {}
+
+  // Creates a cache that remembers answers and listings for |ttl|.
+  explicit SymbolPathCache(std::chrono::steady_clock::duration ttl)
+      : ttl_(ttl) {}
+
+  // Returns true if there is a file at |path|, from an indexed root's
+  // listing or an answer remembered from earlier if there is one, and
+  // otherwise from the file system, remembering the answer.
+  bool FileExists(const string& path);
+
+  // Lists the symbol files beneath |root|, laid out as
+  // SimpleSymbolSupplier expects, replacing any earlier listing of it.
+  // Returns false if |root| couldn't be read.
+  bool IndexRoot(const string& root);
+
+  // Forgets all answers and listings.
+  void Clear();
+
+ private:
+  // A remembered answer, or a root's listing, and when it expires.
+  struct Answer {
+    bool exists;
+    std::chrono::steady_clock::time_point expiry;
+  };
+  struct Index {
+    std::set<string> files;
+    std::chrono::steady_clock::time_point expiry;
+  };
+
+  // Sets |exists| from the listing of the root |path| lies beneath, and
+  // returns true, if there is an unexpired one, dropping expired ones.
+  // Must be called with mutex_ held.
+  bool LookUpIndexLocked(const string& path,
+                         std::chrono::steady_clock::time_point now,
+                         bool* exists);
+
+  std::chrono::steady_clock::duration ttl_;
+
+  // Remembered answers keyed by path, listings keyed by root, and the
+  // mutex guarding them.
+  std::map<string, Answer> answers_;
+  std::map<string, Index> indexes_;
+  std::mutex mutex_;
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_SYMBOL_PATH_CACHE_H__
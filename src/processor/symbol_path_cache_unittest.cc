@@ -0,0 +1,153 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symbol_path_cache_unittest.cc: Unit tests for SymbolPathCache.
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "processor/basic_code_module.h"
+#include "processor/simple_symbol_supplier.h"
+#include "processor/symbol_path_cache.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::SymbolPathCache;
+
+class SymbolPathCacheTest : public ::testing::Test {
+ public:
+  void SetUp() {
+    root_ = temp_dir_.path() + "/symbols";
+    directory_ = root_ + "/libfoo.so/DEBUG1";
+    ASSERT_EQ(0, mkdir(root_.c_str(), 0755));
+    ASSERT_EQ(0, mkdir((root_ + "/libfoo.so").c_str(), 0755));
+    ASSERT_EQ(0, mkdir(directory_.c_str(), 0755));
+    present_ = directory_ + "/libfoo.so.sym";
+    absent_ = directory_ + "/libbar.so.sym";
+    ASSERT_TRUE(WriteFile(present_));
+  }
+
+  static bool WriteFile(const string& path) {
+    FILE* f = fopen(path.c_str(), "w");
+    return f && fputs("MODULE Linux x86 DEBUG1 libfoo.so\n", f) >= 0 &&
+        fclose(f) == 0;
+  }
+
+  AutoTempDir temp_dir_;
+  string root_;
+  string directory_;
+  string present_;
+  string absent_;
+};
+
+TEST_F(SymbolPathCacheTest, RemembersAnswers) {
+  SymbolPathCache cache;
+  EXPECT_TRUE(cache.FileExists(present_));
+  EXPECT_FALSE(cache.FileExists(absent_));
+
+  // Changes to the file system go unnoticed until the answers expire.
+  ASSERT_EQ(0, unlink(present_.c_str()));
+  ASSERT_TRUE(WriteFile(absent_));
+  EXPECT_TRUE(cache.FileExists(present_));
+  EXPECT_FALSE(cache.FileExists(absent_));
+
+  cache.Clear();
+  EXPECT_FALSE(cache.FileExists(present_));
+  EXPECT_TRUE(cache.FileExists(absent_));
+}
+
+TEST_F(SymbolPathCacheTest, ZeroLifetimeRemembersNothing) {
+  SymbolPathCache cache(std::chrono::steady_clock::duration::zero());
+  EXPECT_TRUE(cache.FileExists(present_));
+  ASSERT_EQ(0, unlink(present_.c_str()));
+  EXPECT_FALSE(cache.FileExists(present_));
+}
+
+TEST_F(SymbolPathCacheTest, AnswersFromIndex) {
+  SymbolPathCache cache;
+  ASSERT_TRUE(cache.IndexRoot(root_));
+
+  // Paths beneath the root are looked up in the listing, not the file
+  // system.
+  ASSERT_EQ(0, unlink(present_.c_str()));
+  ASSERT_TRUE(WriteFile(absent_));
+  EXPECT_TRUE(cache.FileExists(present_));
+  EXPECT_FALSE(cache.FileExists(absent_));
+
+  // Others aren't.
+  string outside = temp_dir_.path() + "/symbols2/libfoo.so.sym";
+  EXPECT_FALSE(cache.FileExists(outside));
+
+  // Indexing again picks up the changes.
+  ASSERT_TRUE(cache.IndexRoot(root_));
+  EXPECT_FALSE(cache.FileExists(present_));
+  EXPECT_TRUE(cache.FileExists(absent_));
+
+  EXPECT_FALSE(cache.IndexRoot(temp_dir_.path() + "/missing"));
+}
+
+TEST_F(SymbolPathCacheTest, ExpiredIndexFallsBack) {
+  SymbolPathCache cache(std::chrono::steady_clock::duration::zero());
+  ASSERT_TRUE(cache.IndexRoot(root_));
+  ASSERT_EQ(0, unlink(present_.c_str()));
+  EXPECT_FALSE(cache.FileExists(present_));
+}
+
+TEST_F(SymbolPathCacheTest, SupplierUsesCache) {
+  google_breakpad::BasicCodeModule module(0x1000, 0x1000, "libfoo.so", "",
+                                          "libfoo.so", "DEBUG1", "");
+  google_breakpad::SimpleSymbolSupplier supplier(root_);
+  SymbolPathCache cache;
+  supplier.set_path_cache(&cache);
+  string symbol_file;
+  ASSERT_EQ(google_breakpad::SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module, NULL, &symbol_file));
+  EXPECT_EQ(present_, symbol_file);
+
+  // Once remembered, the file is found without asking the file system
+  // again, even though it has gone.
+  ASSERT_EQ(0, unlink(present_.c_str()));
+  ASSERT_EQ(google_breakpad::SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module, NULL, &symbol_file));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
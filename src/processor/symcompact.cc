@@ -0,0 +1,127 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symcompact.cc: Rewrite a text symbol file, as written by dump_syms, in
+// canonical form without the records that can't affect symbolication.
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+#include "common/path_helper.h"
+#include "common/scoped_ptr.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/source_line_resolver_base.h"
+#include "processor/logging.h"
+#include "processor/symbol_compactor.h"
+
+namespace {
+
+using google_breakpad::scoped_array;
+using google_breakpad::SourceLineResolverBase;
+using google_breakpad::SymbolCompactor;
+
+static void Usage(int argc, char* argv[], bool error) {
+  FILE* fp = error ? stderr : stdout;
+
+  fprintf(fp,
+          "Usage: %s [-v] <symbol-file> <output-file>\n"
+          "Rewrite a symbol file without redundant records: PUBLIC records\n"
+          "FUNC records take precedence over, adjacent lines with the same\n"
+          "line number, STACK CFI rules already in force, and records the\n"
+          "processor would reject.\n"
+          "\n"
+          "Options:\n"
+          "  -h         Usage\n"
+          "  -v         Check that every address looks up the same way in\n"
+          "             the output as in the input\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  BPLOG_INIT(&argc, &argv);
+
+  bool verify = false;
+  int ch;
+  while ((ch = getopt(argc, argv, "hv")) != -1) {
+    switch (ch) {
+      case 'v':
+        verify = true;
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        return 0;
+      default:
+        Usage(argc, argv, true);
+        return 1;
+    }
+  }
+
+  if (argc - optind != 2) {
+    Usage(argc, argv, true);
+    return 1;
+  }
+  const char* input = argv[optind];
+  const char* output = argv[optind + 1];
+
+  char* data;
+  size_t size;
+  if (!SourceLineResolverBase::ReadSymbolFile(input, &data, &size)) {
+    fprintf(stderr, "%s: Failed to read %s\n", argv[0], input);
+    return 1;
+  }
+  scoped_array<char> buffer(data);
+  // ReadSymbolFile counts the NUL it terminates the data with.
+  string symbol_data(data, size - 1);
+
+  SymbolCompactor compactor;
+  string compacted;
+  if (!compactor.Compact(symbol_data, &compacted)) {
+    fprintf(stderr, "%s: %s is not a symbol file\n", argv[0], input);
+    return 1;
+  }
+  if (verify && !compactor.Verify(symbol_data, compacted)) {
+    fprintf(stderr, "%s: Compacting %s changed its symbols\n", argv[0],
+            input);
+    return 1;
+  }
+
+  std::ofstream stream(output, std::ios::out | std::ios::binary);
+  stream.write(compacted.data(), compacted.size());
+  stream.close();
+  if (!stream.good()) {
+    fprintf(stderr, "%s: Failed to write %s\n", argv[0], output);
+    return 1;
+  }
+  return 0;
+}
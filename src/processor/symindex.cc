@@ -0,0 +1,117 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symindex.cc: Index text symbol files, writing a summary of each beside
+// it for tools that index a symbol store (see symbol_file_index.h).
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "processor/logging.h"
+#include "processor/symbol_file_index.h"
+
+namespace {
+
+using google_breakpad::SymbolFileIndex;
+
+static void Usage(int argc, char* argv[], bool error) {
+  FILE* fp = error ? stderr : stdout;
+
+  fprintf(fp,
+          "Usage: %s [-f] [-p] <symbol-file> ...\n"
+          "Index each symbol file, writing its MODULE and INFO CODE_ID\n"
+          "records, record counts, address span and section offsets to\n"
+          "<symbol-file>.idx, unless an up-to-date index is already there.\n"
+          "\n"
+          "Options:\n"
+          "  -f         Index every symbol file, even those with an\n"
+          "             up-to-date index\n"
+          "  -h         Usage\n"
+          "  -p         Print each index to stdout rather than writing it\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  BPLOG_INIT(&argc, &argv);
+
+  bool force = false;
+  bool print = false;
+  int ch;
+  while ((ch = getopt(argc, argv, "fhp")) != -1) {
+    switch (ch) {
+      case 'f':
+        force = true;
+        break;
+      case 'p':
+        print = true;
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        return 0;
+      default:
+        Usage(argc, argv, true);
+        return 1;
+    }
+  }
+
+  if (optind == argc) {
+    Usage(argc, argv, true);
+    return 1;
+  }
+
+  int status = 0;
+  for (int i = optind; i < argc; ++i) {
+    const string symbol_file = argv[i];
+    SymbolFileIndex index;
+    bool indexed;
+    if (force) {
+      indexed = index.BuildFromFile(symbol_file) &&
+          (print || index.Write(SymbolFileIndex::SidecarPath(symbol_file)));
+    } else {
+      indexed = index.ReadForSymbolFile(symbol_file, !print);
+    }
+    string text;
+    if (indexed && print) {
+      indexed = index.Serialize(&text);
+      fwrite(text.data(), 1, text.size(), stdout);
+    }
+    if (!indexed) {
+      fprintf(stderr, "%s: Failed to index %s\n", argv[0],
+              symbol_file.c_str());
+      status = 1;
+    }
+  }
+  return status;
+}
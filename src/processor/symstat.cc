@@ -0,0 +1,146 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// symstat.cc: Report how much memory the records of a text symbol file take
+// up once loaded, and how much they would take up in the serialized format
+// FastSourceLineResolver loads.
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "common/path_helper.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/basic_source_line_resolver.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "processor/basic_code_module.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+
+namespace {
+
+using google_breakpad::BasicCodeModule;
+using google_breakpad::BasicSourceLineResolver;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::ModuleSerializer;
+using google_breakpad::SourceLineResolverBase;
+
+typedef SourceLineResolverBase::SymbolFootprint SymbolFootprint;
+
+static void Usage(int argc, char* argv[], bool error) {
+  FILE* fp = error ? stderr : stdout;
+
+  fprintf(fp,
+          "Usage: %s [-i] <symbol-file>\n"
+          "Report the memory the records of a symbol file take up when\n"
+          "loaded by BasicSourceLineResolver, and when converted for\n"
+          "FastSourceLineResolver.\n"
+          "\n"
+          "Options:\n"
+          "  -h         Usage\n"
+          "  -i         Add search indexes to large address maps in the\n"
+          "             converted symbols\n",
+          google_breakpad::BaseName(argv[0]).c_str());
+}
+
+static void PrintRow(const char* kind, uint64_t basic, uint64_t basic_total,
+                     uint64_t fast, uint64_t fast_total) {
+  printf("%-20s %12" PRIu64 " %5.1f%% %12" PRIu64 " %5.1f%%\n", kind,
+         basic, basic_total ? 100.0 * basic / basic_total : 0.0,
+         fast, fast_total ? 100.0 * fast / fast_total : 0.0);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  BPLOG_INIT(&argc, &argv);
+
+  bool build_search_index = false;
+  int ch;
+  while ((ch = getopt(argc, argv, "hi")) != -1) {
+    switch (ch) {
+      case 'i':
+        build_search_index = true;
+        break;
+      case 'h':
+        Usage(argc, argv, false);
+        return 0;
+      default:
+        Usage(argc, argv, true);
+        return 1;
+    }
+  }
+
+  if (argc - optind != 1) {
+    Usage(argc, argv, true);
+    return 1;
+  }
+  const string symbol_file = argv[optind];
+
+  BasicCodeModule module(0, 0, symbol_file, "", "", "", "");
+  BasicSourceLineResolver basic_resolver;
+  if (!basic_resolver.LoadModule(&module, symbol_file)) {
+    fprintf(stderr, "%s: Failed to load %s\n", argv[0], symbol_file.c_str());
+    return 1;
+  }
+  FastSourceLineResolver fast_resolver;
+  ModuleSerializer serializer;
+  serializer.set_build_search_index(build_search_index);
+  if (!serializer.ConvertOneModule(symbol_file, &basic_resolver,
+                                   &fast_resolver)) {
+    fprintf(stderr, "%s: Failed to convert %s\n", argv[0],
+            symbol_file.c_str());
+    return 1;
+  }
+
+  SymbolFootprint basic, fast;
+  if (!basic_resolver.GetModuleFootprint(&module, &basic) ||
+      !fast_resolver.GetModuleFootprint(&module, &fast)) {
+    fprintf(stderr, "%s: %s didn't stay loaded\n", argv[0],
+            symbol_file.c_str());
+    return 1;
+  }
+
+  const uint64_t basic_total = basic.total();
+  const uint64_t fast_total = fast.total();
+  printf("%-20s %19s %19s\n", "", "basic", "fast");
+  PrintRow("functions", basic.functions, basic_total,
+           fast.functions, fast_total);
+  PrintRow("lines", basic.lines, basic_total, fast.lines, fast_total);
+  PrintRow("inlines", basic.inlines, basic_total, fast.inlines, fast_total);
+  PrintRow("public symbols", basic.public_symbols, basic_total,
+           fast.public_symbols, fast_total);
+  PrintRow("windows frame info", basic.windows_frame_info, basic_total,
+           fast.windows_frame_info, fast_total);
+  PrintRow("cfi", basic.cfi, basic_total, fast.cfi, fast_total);
+  PrintRow("strings", basic.strings, basic_total, fast.strings, fast_total);
+  PrintRow("total", basic_total, basic_total, fast_total, fast_total);
+  return 0;
+}
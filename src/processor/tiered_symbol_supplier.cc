@@ -0,0 +1,574 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// tiered_symbol_supplier.cc: A SimpleSymbolSupplier that looks for symbols
+// in memory, then in a local cache, then in the symbol paths, and then on
+// a remote symbol server.
+//
+// See tiered_symbol_supplier.h for documentation.
+
+#include "processor/tiered_symbol_supplier.h"
+
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "google_breakpad/common/breakpad_types.h"
+#include "google_breakpad/processor/code_module.h"
+#include "google_breakpad/processor/source_line_resolver_base.h"
+#include "processor/logging.h"
+#include "processor/module_serializer.h"
+
+namespace google_breakpad {
+
+class TieredSymbolSupplier::Blob {
+ public:
+  // Takes ownership of |data|, which was allocated with new[] if |mapped|
+  // is false and mapped with SourceLineResolverBase::MapSymbolFile() if it
+  // is true.
+  Blob(char* data, size_t size, bool mapped)
+      : data_(data), size_(size), mapped_(mapped) {}
+
+  ~Blob() {
+    if (mapped_)
+      SourceLineResolverBase::UnmapSymbolFile(data_, size_);
+    else
+      delete[] data_;
+  }
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  char* data_;
+  size_t size_;
+  bool mapped_;
+
+  Blob(const Blob&);
+  void operator=(const Blob&);
+};
+
+namespace {
+
+// Cache files are trimmed to this fraction of the cache's size, so that
+// the cache directory isn't listed again on every write once it is full.
+const double kTrimmedCacheFraction = 0.9;
+
+// Creates each missing directory on the way to and including path.
+bool MakeDirectories(const string& path) {
+  size_t slash = path.find('/', 1);
+  while (true) {
+    string directory = path.substr(0, slash);
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+      return false;
+    if (slash == string::npos)
+      return true;
+    slash = path.find('/', slash + 1);
+  }
+}
+
+struct CacheFile {
+  time_t mtime;
+  uint64_t size;
+  string path;
+
+  bool operator<(const CacheFile& other) const {
+    return mtime < other.mtime;
+  }
+};
+
+// Appends the .fast files beneath |directory| to |files|.
+void ListCacheFiles(const string& directory, std::vector<CacheFile>* files) {
+  DIR* dir = opendir(directory.c_str());
+  if (!dir)
+    return;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    string name = entry->d_name;
+    if (name == "." || name == "..")
+      continue;
+    string path = directory + "/" + name;
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0)
+      continue;
+    if (S_ISDIR(sb.st_mode)) {
+      ListCacheFiles(path, files);
+    } else if (name.size() > 5 &&
+               name.compare(name.size() - 5, 5, ".fast") == 0) {
+      CacheFile file;
+      file.mtime = sb.st_mtime;
+      file.size = sb.st_size;
+      file.path = path;
+      files->push_back(file);
+    }
+  }
+  closedir(dir);
+}
+
+uint64_t MicrosecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+const size_t TieredSymbolSupplier::kDefaultMemoryCacheBytes;
+const uint64_t TieredSymbolSupplier::kDefaultDiskCacheBytes;
+
+TieredSymbolSupplier::TieredSymbolSupplier(const vector<string>& paths,
+                                           const string& cache_path,
+                                           Fetcher* fetcher)
+    : SimpleSymbolSupplier(paths),
+      cache_path_(cache_path),
+      fetcher_(fetcher),
+      has_paths_(!paths.empty()),
+      memory_cache_bytes_(kDefaultMemoryCacheBytes),
+      disk_cache_bytes_(kDefaultDiskCacheBytes),
+      memory_bytes_(0),
+      disk_bytes_counted_(false),
+      disk_bytes_(0) {
+  for (int i = 0; i < TIER_COUNT; ++i) {
+    counters_[i].hits = 0;
+    counters_[i].misses = 0;
+    counters_[i].failures = 0;
+    counters_[i].waits = 0;
+    counters_[i].evictions = 0;
+    counters_[i].bytes = 0;
+    counters_[i].microseconds = 0;
+  }
+}
+
+TieredSymbolSupplier::~TieredSymbolSupplier() {}
+
+SymbolSupplier::SymbolResult TieredSymbolSupplier::GetSymbolFile(
+    const CodeModule* module, const SystemInfo* system_info,
+    string* symbol_file) {
+  BPLOG_IF(ERROR, !symbol_file) << "TieredSymbolSupplier::GetSymbolFile "
+                                   "requires |symbol_file|";
+  assert(symbol_file);
+  symbol_file->clear();
+
+  Entry entry;
+  SymbolResult s = Find(module, system_info, &entry);
+  if (s == FOUND)
+    *symbol_file = entry.symbol_file;
+  return s;
+}
+
+SymbolSupplier::SymbolResult TieredSymbolSupplier::GetSymbolFile(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    string* symbol_data) {
+  assert(symbol_data);
+  symbol_data->clear();
+
+  Entry entry;
+  SymbolResult s = Find(module, system_info, &entry);
+  if (s == FOUND) {
+    if (symbol_file)
+      *symbol_file = entry.symbol_file;
+    symbol_data->assign(entry.blob->data(), entry.blob->size());
+  }
+  return s;
+}
+
+SymbolSupplier::SymbolResult TieredSymbolSupplier::GetCStringSymbolData(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    string* symbol_file,
+    char** symbol_data,
+    size_t* symbol_data_size) {
+  assert(symbol_data);
+  assert(symbol_data_size);
+
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    map<string, Entry>::iterator it = handed_out_.find(module->code_file());
+    if (it != handed_out_.end())
+      entry = it->second;
+  }
+  if (!entry.blob) {
+    SymbolResult s = Find(module, system_info, &entry);
+    if (s != FOUND)
+      return s;
+    // Another thread may have handed the module out meanwhile; keep only
+    // one, since a resolver may already be using it.
+    std::lock_guard<std::mutex> guard(mutex_);
+    Entry& handed_out = handed_out_[module->code_file()];
+    if (handed_out.blob)
+      entry = handed_out;
+    else
+      handed_out = entry;
+  }
+
+  if (symbol_file)
+    *symbol_file = entry.symbol_file;
+  *symbol_data = entry.blob->data();
+  *symbol_data_size = entry.blob->size();
+  return FOUND;
+}
+
+void TieredSymbolSupplier::FreeSymbolData(const CodeModule* module) {
+  if (!module)
+    return;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  handed_out_.erase(module->code_file());
+}
+
+TieredSymbolSupplier::TierStats TieredSymbolSupplier::GetTierStats(
+    Tier tier) const {
+  const TierCounters& counters = counters_[tier];
+  TierStats stats;
+  stats.hits = counters.hits.load(std::memory_order_relaxed);
+  stats.misses = counters.misses.load(std::memory_order_relaxed);
+  stats.failures = counters.failures.load(std::memory_order_relaxed);
+  stats.waits = counters.waits.load(std::memory_order_relaxed);
+  stats.evictions = counters.evictions.load(std::memory_order_relaxed);
+  stats.bytes = counters.bytes.load(std::memory_order_relaxed);
+  stats.microseconds = counters.microseconds.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void TieredSymbolSupplier::PrintStats(FILE* out) const {
+  fprintf(out, "%-20s %10s %10s %10s %10s %10s %14s %12s\n",
+          "symbol_tier", "hits", "misses", "failures", "waits", "evictions",
+          "bytes", "total_ms");
+  for (int i = 0; i < TIER_COUNT; ++i) {
+    Tier tier = static_cast<Tier>(i);
+    TierStats stats = GetTierStats(tier);
+    fprintf(out, "%-20s %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+            " %10" PRIu64 " %10" PRIu64 " %14" PRIu64 " %12.1f\n",
+            TierName(tier), stats.hits, stats.misses, stats.failures,
+            stats.waits, stats.evictions, stats.bytes,
+            stats.microseconds / 1000.0);
+  }
+}
+
+// static
+const char* TieredSymbolSupplier::TierName(Tier tier) {
+  switch (tier) {
+    case TIER_MEMORY: return "memory";
+    case TIER_DISK: return "disk";
+    case TIER_LOCAL: return "local";
+    case TIER_REMOTE: return "remote";
+    case TIER_COUNT: break;
+  }
+  return "unknown";
+}
+
+SymbolSupplier::SymbolResult TieredSymbolSupplier::Find(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    Entry* entry) {
+  string relative_path;
+  if (!GetRelativeSymbolPath(module, &relative_path))
+    return NOT_FOUND;
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
+  map<string, MemoryEntry>::iterator in_memory = memory_.find(relative_path);
+  if (in_memory != memory_.end()) {
+    memory_lru_.splice(memory_lru_.begin(), memory_lru_,
+                       in_memory->second.lru_position);
+    *entry = in_memory->second.entry;
+    lock.unlock();
+    Count(TIER_MEMORY, &TierCounters::hits);
+    Count(TIER_MEMORY, &TierCounters::microseconds, MicrosecondsSince(start));
+    return FOUND;
+  }
+  Count(TIER_MEMORY, &TierCounters::misses);
+
+  map<string, std::shared_future<Lookup> >::iterator in_flight =
+      lookups_.find(relative_path);
+  if (in_flight != lookups_.end()) {
+    std::shared_future<Lookup> lookup = in_flight->second;
+    lock.unlock();
+    Count(TIER_MEMORY, &TierCounters::waits);
+    const Lookup& result = lookup.get();
+    Count(TIER_MEMORY, &TierCounters::microseconds, MicrosecondsSince(start));
+    if (result.result == FOUND)
+      *entry = result.entry;
+    return result.result;
+  }
+
+  std::promise<Lookup> promise;
+  lookups_[relative_path] = promise.get_future().share();
+  lock.unlock();
+  Count(TIER_MEMORY, &TierCounters::microseconds, MicrosecondsSince(start));
+
+  Lookup lookup;
+  lookup.result = FindBeneathMemory(module, system_info, relative_path,
+                                    &lookup.entry);
+
+  lock.lock();
+  if (lookup.result == FOUND)
+    KeepInMemoryLocked(relative_path, lookup.entry);
+  lookups_.erase(relative_path);
+  lock.unlock();
+  if (lookup.result == FOUND)
+    *entry = lookup.entry;
+  SymbolResult result = lookup.result;
+  promise.set_value(lookup);
+  return result;
+}
+
+SymbolSupplier::SymbolResult TieredSymbolSupplier::FindBeneathMemory(
+    const CodeModule* module,
+    const SystemInfo* system_info,
+    const string& relative_path,
+    Entry* entry) {
+  string cache_file;
+  if (!cache_path_.empty()) {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    cache_file = cache_path_ + "/" + relative_path + ".fast";
+    bool hit = ReadCacheFile(cache_file, &entry->blob);
+    Count(TIER_DISK, hit ? &TierCounters::hits : &TierCounters::misses);
+    Count(TIER_DISK, &TierCounters::microseconds, MicrosecondsSince(start));
+    if (hit) {
+      entry->symbol_file = cache_file;
+      return FOUND;
+    }
+  }
+
+  string symbol_file;
+  string symbol_text;
+  SymbolResult s = NOT_FOUND;
+  Tier source = TIER_LOCAL;
+  if (has_paths_) {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    // Not GetSymbolFile() with symbol data, which would call back into
+    // this class's GetSymbolFile().
+    s = SimpleSymbolSupplier::GetSymbolFile(module, system_info,
+                                            &symbol_file);
+    if (s == FOUND) {
+      char* data;
+      size_t size;
+      if (SourceLineResolverBase::ReadSymbolFile(symbol_file, &data, &size)) {
+        symbol_text.assign(data, size - 1);
+        delete[] data;
+      } else {
+        s = INTERRUPT;
+      }
+    }
+    Count(TIER_LOCAL, s == FOUND ? &TierCounters::hits :
+                      s == NOT_FOUND ? &TierCounters::misses :
+                      &TierCounters::failures);
+    if (s == FOUND)
+      Count(TIER_LOCAL, &TierCounters::bytes, symbol_text.size());
+    Count(TIER_LOCAL, &TierCounters::microseconds, MicrosecondsSince(start));
+  }
+  if (s == NOT_FOUND && fetcher_) {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    source = TIER_REMOTE;
+    symbol_file = relative_path + ".sym";
+    s = fetcher_->Fetch(symbol_file, &symbol_text);
+    Count(TIER_REMOTE, s == FOUND ? &TierCounters::hits :
+                       s == NOT_FOUND ? &TierCounters::misses :
+                       &TierCounters::failures);
+    if (s == FOUND)
+      Count(TIER_REMOTE, &TierCounters::bytes, symbol_text.size());
+    Count(TIER_REMOTE, &TierCounters::microseconds, MicrosecondsSince(start));
+  }
+  if (s != FOUND)
+    return s;
+
+  // Serialized symbols are meant for large symbol sets, where the search
+  // indexes pay for themselves.
+  ModuleSerializer serializer;
+  serializer.set_build_search_index(true);
+  unsigned int size;
+  char* data = serializer.SerializeSymbolFileData(symbol_text, &size);
+  if (!data) {
+    BPLOG(ERROR) << "Could not serialize " << symbol_file;
+    Count(source, &TierCounters::failures);
+    return NOT_FOUND;
+  }
+  entry->blob.reset(new Blob(data, size, false));
+  entry->symbol_file = symbol_file;
+
+  if (!cache_path_.empty()) {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    if (WriteCacheFile(cache_file, *entry->blob))
+      entry->symbol_file = cache_file;
+    else
+      Count(TIER_DISK, &TierCounters::failures);
+    Count(TIER_DISK, &TierCounters::microseconds, MicrosecondsSince(start));
+  }
+  return FOUND;
+}
+
+void TieredSymbolSupplier::KeepInMemoryLocked(const string& relative_path,
+                                              const Entry& entry) {
+  size_t size = entry.blob->size();
+  if (size > memory_cache_bytes_)
+    return;
+  while (memory_bytes_ + size > memory_cache_bytes_) {
+    map<string, MemoryEntry>::iterator oldest =
+        memory_.find(memory_lru_.back());
+    memory_bytes_ -= oldest->second.entry.blob->size();
+    memory_.erase(oldest);
+    memory_lru_.pop_back();
+    Count(TIER_MEMORY, &TierCounters::evictions);
+  }
+  memory_lru_.push_front(relative_path);
+  MemoryEntry& memory_entry = memory_[relative_path];
+  memory_entry.entry = entry;
+  memory_entry.lru_position = memory_lru_.begin();
+  memory_bytes_ += size;
+  counters_[TIER_MEMORY].bytes.store(memory_bytes_,
+                                     std::memory_order_relaxed);
+}
+
+bool TieredSymbolSupplier::ReadCacheFile(const string& path,
+                                         std::shared_ptr<Blob>* blob) {
+  struct stat sb;
+  char* data;
+  size_t size;
+  if (stat(path.c_str(), &sb) != 0 ||
+      !SourceLineResolverBase::MapSymbolFile(path, &data, &size)) {
+    return false;
+  }
+  if (!ModuleSerializer::CheckSerializedHeader(data, size)) {
+    // Written by a different version of the serialized format; it is
+    // replaced once the symbols are found elsewhere.
+    SourceLineResolverBase::UnmapSymbolFile(data, size);
+    return false;
+  }
+  blob->reset(new Blob(data, size, true));
+  // The cache is trimmed by modification time, so mark the file used.
+  utimes(path.c_str(), NULL);
+  return true;
+}
+
+bool TieredSymbolSupplier::WriteCacheFile(const string& path,
+                                          const Blob& blob) {
+  string directory = path.substr(0, path.rfind('/'));
+  if (!MakeDirectories(directory)) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not create " << directory <<
+        ", error " << error_code << ": " << error_string;
+    return false;
+  }
+
+  // Write into a uniquely named file next to path, so that other processes
+  // only ever see a complete file under its final name.
+  string temp_template = path + ".XXXXXX";
+  std::vector<char> temp_name(temp_template.begin(), temp_template.end());
+  temp_name.push_back('\0');
+  int fd = mkstemp(&temp_name[0]);
+  if (fd == -1) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not create a temporary file in " << directory <<
+        ", error " << error_code << ": " << error_string;
+    return false;
+  }
+  // mkstemp only grants access to the owner, but the cache may be shared.
+  fchmod(fd, 0644);
+  string temp_file(&temp_name[0]);
+  const char* data = blob.data();
+  size_t remaining = blob.size();
+  while (remaining > 0) {
+    ssize_t written = write(fd, data, remaining);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      break;
+    data += written;
+    remaining -= written;
+  }
+  if (close(fd) != 0 || remaining > 0 ||
+      rename(temp_file.c_str(), path.c_str()) != 0) {
+    string error_string;
+    int error_code = ErrnoString(&error_string);
+    BPLOG(ERROR) << "Could not write " << path <<
+        ", error " << error_code << ": " << error_string;
+    unlink(temp_file.c_str());
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(disk_mutex_);
+  if (!disk_bytes_counted_) {
+    // The file just written is among those listed.
+    std::vector<CacheFile> files;
+    ListCacheFiles(cache_path_, &files);
+    disk_bytes_ = 0;
+    for (size_t i = 0; i < files.size(); ++i)
+      disk_bytes_ += files[i].size;
+    disk_bytes_counted_ = true;
+  } else {
+    disk_bytes_ += blob.size();
+  }
+  if (disk_cache_bytes_ && disk_bytes_ > disk_cache_bytes_)
+    TrimCacheLocked();
+  counters_[TIER_DISK].bytes.store(disk_bytes_, std::memory_order_relaxed);
+  return true;
+}
+
+void TieredSymbolSupplier::TrimCacheLocked() {
+  // List the cache again, since other processes may share it.
+  std::vector<CacheFile> files;
+  ListCacheFiles(cache_path_, &files);
+  std::sort(files.begin(), files.end());
+  disk_bytes_ = 0;
+  for (size_t i = 0; i < files.size(); ++i)
+    disk_bytes_ += files[i].size;
+
+  uint64_t target = static_cast<uint64_t>(disk_cache_bytes_ *
+                                          kTrimmedCacheFraction);
+  for (size_t i = 0; i < files.size() && disk_bytes_ > target; ++i) {
+    // A mapping of a removed file stays valid, so symbols handed out from
+    // it are unaffected.
+    if (unlink(files[i].path.c_str()) != 0)
+      continue;
+    disk_bytes_ -= files[i].size;
+    Count(TIER_DISK, &TierCounters::evictions);
+  }
+}
+
+}  // namespace google_breakpad
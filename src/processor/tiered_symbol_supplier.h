@@ -0,0 +1,280 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// tiered_symbol_supplier.h: A SimpleSymbolSupplier that looks for symbols
+// in memory, then in a local cache, then in the symbol paths, and then on
+// a remote symbol server.
+//
+// TieredSymbolSupplier serves symbols in the serialized format loaded by
+// FastSourceLineResolver, from the first of these tiers that has them:
+//
+//  - Memory: the serialized symbols of the modules looked up most
+//    recently, up to a number of bytes.
+//  - Disk: a cache directory laid out like CachingSymbolSupplier's, with
+//    a .fast file per module, up to a number of bytes.  Files are read by
+//    memory-mapping them, and the least recently used are removed when
+//    the cache grows too large.  Several processes may share the cache.
+//  - Local: text symbol files beneath the symbol paths, found as
+//    SimpleSymbolSupplier finds them.
+//  - Remote: text symbol files fetched by a Fetcher, by their path
+//    relative to a symbol path, such as from an HTTP server or an S3
+//    bucket laid out like a symbol path (see libcurl_symbol_fetcher.h).
+//
+// Symbols found in the local or remote tier are serialized, written to the
+// disk cache and kept in memory; symbols found on disk are kept in memory.
+// Each tier may be left out: the disk tier without a cache path, the local
+// tier without symbol paths, and the remote tier without a fetcher.
+//
+// A TieredSymbolSupplier may be shared by threads that share a
+// thread-safe FastSourceLineResolver.  Different modules are fetched at
+// once, but a module asked for by several threads at once is looked up
+// only once, the others waiting for its result.  Each tier counts what it
+// answers and how long it takes; see GetTierStats().
+//
+//   LibcurlSymbolFetcher fetcher("https://symbols.example.com");
+//   TieredSymbolSupplier supplier(paths, "/var/cache/symbols", &fetcher);
+//   FastSourceLineResolver resolver(true);
+//   MinidumpProcessor processor(&supplier, &resolver);
+//
+// The supplier must outlive the resolver, and the fetcher the supplier.
+
+#ifndef PROCESSOR_TIERED_SYMBOL_SUPPLIER_H__
+#define PROCESSOR_TIERED_SYMBOL_SUPPLIER_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/using_std_string.h"
+#include "processor/simple_symbol_supplier.h"
+
+namespace google_breakpad {
+
+class TieredSymbolSupplier : public SimpleSymbolSupplier {
+ public:
+  // Fetches text symbol files from a remote store.
+  class Fetcher {
+   public:
+    virtual ~Fetcher() {}
+
+    // Places the symbol file at |path|, relative to the root of the store
+    // and laid out as beneath a symbol path, in |*contents|.  Returns
+    // FOUND, NOT_FOUND if the store doesn't have it, or INTERRUPT if the
+    // store couldn't be reached.  May be called from several threads at
+    // once.
+    virtual SymbolResult Fetch(const string& path, string* contents) = 0;
+  };
+
+  enum Tier {
+    TIER_MEMORY,
+    TIER_DISK,
+    TIER_LOCAL,
+    TIER_REMOTE,
+    TIER_COUNT
+  };
+
+  struct TierStats {
+    // Lookups the tier answered, and lookups it passed on to the next.
+    uint64_t hits;
+    uint64_t misses;
+    // Lookups that failed in the tier, rather than finding nothing: remote
+    // fetches that were interrupted, and symbols that couldn't be read,
+    // serialized or written to the disk cache.
+    uint64_t failures;
+    // Lookups that waited for another thread's lookup of the same module
+    // rather than making their own; counted against the memory tier.
+    uint64_t waits;
+    // Modules dropped to keep the tier under its size.
+    uint64_t evictions;
+    // Bytes of serialized symbols the memory or disk tier holds, as far as
+    // this supplier knows; bytes of text symbols the local or remote tier
+    // has supplied.
+    uint64_t bytes;
+    // Time spent looking in the tier.
+    uint64_t microseconds;
+  };
+
+  static const size_t kDefaultMemoryCacheBytes = 256 << 20;
+  static const uint64_t kDefaultDiskCacheBytes = 16ULL << 30;
+
+  // Creates a new TieredSymbolSupplier with the tiers described above.
+  // |cache_path| may be empty and |fetcher| NULL.
+  TieredSymbolSupplier(const vector<string>& paths,
+                       const string& cache_path,
+                       Fetcher* fetcher);
+
+  virtual ~TieredSymbolSupplier();
+
+  // Keep up to |bytes| of serialized symbols in memory, 0 to keep none.
+  // Symbols handed out by GetCStringSymbolData() and not yet freed are
+  // kept regardless.
+  void set_memory_cache_bytes(size_t bytes) { memory_cache_bytes_ = bytes; }
+
+  // Keep up to |bytes| of serialized symbol files in the cache directory,
+  // or any amount if 0.  Files written by other processes sharing the
+  // cache count too.
+  void set_disk_cache_bytes(uint64_t bytes) { disk_cache_bytes_ = bytes; }
+
+  // Returns the path to the module's file in the disk cache, or, without
+  // a cache path, to the symbol file it was serialized from: its path
+  // beneath a symbol path, or relative to the remote store's root.
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file);
+
+  virtual SymbolResult GetSymbolFile(const CodeModule* module,
+                                     const SystemInfo* system_info,
+                                     string* symbol_file,
+                                     string* symbol_data);
+
+  // Hands out the serialized symbols for the module, which stay alive
+  // until FreeSymbolData() is called for the module or the supplier is
+  // destroyed.  Asking again for a module not yet freed returns the same
+  // data.
+  virtual SymbolResult GetCStringSymbolData(const CodeModule* module,
+                                            const SystemInfo* system_info,
+                                            string* symbol_file,
+                                            char** symbol_data,
+                                            size_t* symbol_data_size);
+
+  virtual void FreeSymbolData(const CodeModule* module);
+
+  TierStats GetTierStats(Tier tier) const;
+
+  // Writes a line of stats per tier to |out|.
+  void PrintStats(FILE* out) const;
+
+  static const char* TierName(Tier tier);
+
+ private:
+  // Serialized symbols, either on the heap or mapped from the disk cache.
+  class Blob;
+
+  struct Entry {
+    std::shared_ptr<Blob> blob;
+    string symbol_file;
+  };
+
+  // The result of a lookup beneath the memory tier, which threads waiting
+  // for it share.
+  struct Lookup {
+    Lookup() : result(NOT_FOUND) {}
+    SymbolResult result;
+    Entry entry;
+  };
+
+  struct TierCounters {
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> failures;
+    std::atomic<uint64_t> waits;
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> microseconds;
+  };
+
+  struct MemoryEntry {
+    Entry entry;
+    std::list<string>::iterator lru_position;
+  };
+
+  // Sets |*entry| to the module's symbols from the first tier that has
+  // them.
+  SymbolResult Find(const CodeModule* module,
+                    const SystemInfo* system_info,
+                    Entry* entry);
+
+  // Looks for the symbols at |relative_path| in the tiers beneath memory.
+  SymbolResult FindBeneathMemory(const CodeModule* module,
+                                 const SystemInfo* system_info,
+                                 const string& relative_path,
+                                 Entry* entry);
+
+  // Keeps |entry| in memory under |relative_path|, dropping the least
+  // recently used entries to make room.  Must be called with mutex_ held.
+  void KeepInMemoryLocked(const string& relative_path, const Entry& entry);
+
+  // Maps the cache file at |path| if it holds serialized symbols of the
+  // current version, and marks it used.
+  bool ReadCacheFile(const string& path, std::shared_ptr<Blob>* blob);
+
+  // Writes |blob| to the cache file at |path|, then removes the least
+  // recently used files if the cache has grown too large.
+  bool WriteCacheFile(const string& path, const Blob& blob);
+
+  // Removes cache files, least recently used first, until the cache is
+  // well under disk_cache_bytes_.  Must be called with disk_mutex_ held.
+  void TrimCacheLocked();
+
+  void Count(Tier tier, std::atomic<uint64_t> TierCounters::*counter,
+             uint64_t count = 1) {
+    (counters_[tier].*counter).fetch_add(count, std::memory_order_relaxed);
+  }
+
+  string cache_path_;
+  Fetcher* fetcher_;
+  bool has_paths_;
+  size_t memory_cache_bytes_;
+  uint64_t disk_cache_bytes_;
+
+  TierCounters counters_[TIER_COUNT];
+
+  // The memory tier, keyed by relative symbol path, with those paths from
+  // most to least recently used and the bytes they hold; the lookups
+  // under way beneath it; and the symbols handed out, keyed by module
+  // code_file.  All guarded by mutex_.
+  map<string, MemoryEntry> memory_;
+  std::list<string> memory_lru_;
+  size_t memory_bytes_;
+  map<string, std::shared_future<Lookup> > lookups_;
+  map<string, Entry> handed_out_;
+  std::mutex mutex_;
+
+  // The bytes in the cache directory, if they have been counted yet, and
+  // the mutex guarding them and the writing of cache files.
+  bool disk_bytes_counted_;
+  uint64_t disk_bytes_;
+  std::mutex disk_mutex_;
+
+  // Disallow copy constructor and assignment operator.
+  TieredSymbolSupplier(const TieredSymbolSupplier&);
+  void operator=(const TieredSymbolSupplier&);
+};
+
+}  // namespace google_breakpad
+
+#endif  // PROCESSOR_TIERED_SYMBOL_SUPPLIER_H__
@@ -0,0 +1,323 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// tiered_symbol_supplier_unittest.cc: Unit tests for TieredSymbolSupplier.
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "breakpad_googletest_includes.h"
+#include "common/tests/auto_tempdir.h"
+#include "common/using_std_string.h"
+#include "google_breakpad/processor/fast_source_line_resolver.h"
+#include "google_breakpad/processor/stack_frame.h"
+#include "processor/basic_code_module.h"
+#include "processor/tiered_symbol_supplier.h"
+
+namespace {
+
+using google_breakpad::AutoTempDir;
+using google_breakpad::BasicCodeModule;
+using google_breakpad::FastSourceLineResolver;
+using google_breakpad::SourceLineResolverBase;
+using google_breakpad::StackFrame;
+using google_breakpad::SymbolSupplier;
+using google_breakpad::TieredSymbolSupplier;
+
+// Serves the same symbol file at every path in |present|, after |delay|.
+class FakeFetcher : public TieredSymbolSupplier::Fetcher {
+ public:
+  explicit FakeFetcher(const string& contents)
+      : contents_(contents), fetches_(0), delay_(0),
+        result_(SymbolSupplier::FOUND) {}
+
+  virtual SymbolSupplier::SymbolResult Fetch(const string& path,
+                                             string* contents) {
+    ++fetches_;
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_));
+    if (result_ != SymbolSupplier::FOUND)
+      return result_;
+    if (present_.find(path) == present_.end())
+      return SymbolSupplier::NOT_FOUND;
+    *contents = contents_;
+    return SymbolSupplier::FOUND;
+  }
+
+  string contents_;
+  std::map<string, bool> present_;
+  std::atomic<int> fetches_;
+  int delay_;
+  SymbolSupplier::SymbolResult result_;
+};
+
+string ReadTestData(const string& name) {
+  string path = string(getenv("srcdir") ? getenv("srcdir") : ".") +
+                "/src/processor/testdata/" + name;
+  char* data;
+  size_t size;
+  if (!SourceLineResolverBase::ReadSymbolFile(path, &data, &size))
+    return string();
+  string contents(data, size - 1);
+  delete [] data;
+  return contents;
+}
+
+bool WriteFile(const string& path, const string& contents) {
+  FILE* f = fopen(path.c_str(), "wb");
+  bool ok = f && fwrite(contents.data(), 1, contents.size(), f) ==
+      contents.size();
+  if (f)
+    ok = fclose(f) == 0 && ok;
+  return ok;
+}
+
+class TieredSymbolSupplierTest : public ::testing::Test {
+ public:
+  TieredSymbolSupplierTest()
+      : module_(0x1000, 0xb000, "module1.dll", "", "module1.pdb",
+                "ABCDEF0123456789ABCDEF01234567891", ""),
+        other_module_(0x1000, 0xb000, "other.dll", "", "other.pdb",
+                      "ABCDEF0123456789ABCDEF01234567891", ""),
+        cache_path_(temp_dir_.path() + "/cache"),
+        remote_path_("module1.pdb/ABCDEF0123456789ABCDEF01234567891/"
+                     "module1.sym"),
+        cache_file_(cache_path_ +
+                    "/module1.pdb/ABCDEF0123456789ABCDEF01234567891/"
+                    "module1.fast"),
+        fetcher_(ReadTestData("module1.out")) {
+    fetcher_.present_[remote_path_] = true;
+    fetcher_.present_["other.pdb/ABCDEF0123456789ABCDEF01234567891/"
+                      "other.sym"] = true;
+  }
+
+  // Loads the module from supplier into a new resolver and checks that it
+  // resolves an address.
+  void CheckLoad(TieredSymbolSupplier* supplier, BasicCodeModule* module) {
+    string symbol_file;
+    char* symbol_data = NULL;
+    size_t symbol_data_size = 0;
+    ASSERT_EQ(SymbolSupplier::FOUND,
+              supplier->GetCStringSymbolData(module, NULL, &symbol_file,
+                                             &symbol_data,
+                                             &symbol_data_size));
+
+    FastSourceLineResolver resolver;
+    ASSERT_TRUE(resolver.LoadModuleUsingMemoryBuffer(module, symbol_data,
+                                                     symbol_data_size));
+    StackFrame frame;
+    frame.instruction = 0x2000;
+    frame.module = module;
+    resolver.FillSourceLineInfo(&frame, NULL);
+    EXPECT_EQ("Function1_1", frame.function_name);
+    EXPECT_EQ(44, frame.source_line);
+    resolver.UnloadModule(module);
+    supplier->FreeSymbolData(module);
+  }
+
+  AutoTempDir temp_dir_;
+  BasicCodeModule module_;
+  BasicCodeModule other_module_;
+  std::vector<string> no_paths_;
+  string cache_path_;
+  string remote_path_;
+  string cache_file_;
+  FakeFetcher fetcher_;
+};
+
+TEST_F(TieredSymbolSupplierTest, RemoteSymbolsAreCachedInMemoryAndOnDisk) {
+  {
+    TieredSymbolSupplier supplier(no_paths_, cache_path_, &fetcher_);
+    CheckLoad(&supplier, &module_);
+    EXPECT_EQ(1, fetcher_.fetches_);
+    EXPECT_EQ(1U, supplier.GetTierStats(TieredSymbolSupplier::TIER_REMOTE)
+                      .hits);
+    EXPECT_EQ(fetcher_.contents_.size(),
+              supplier.GetTierStats(TieredSymbolSupplier::TIER_REMOTE)
+                  .bytes);
+    struct stat sb;
+    ASSERT_EQ(0, stat(cache_file_.c_str(), &sb));
+
+    // Asking again is answered from memory.
+    string symbol_file;
+    ASSERT_EQ(SymbolSupplier::FOUND,
+              supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+    EXPECT_EQ(cache_file_, symbol_file);
+    EXPECT_EQ(1, fetcher_.fetches_);
+    EXPECT_EQ(1U, supplier.GetTierStats(TieredSymbolSupplier::TIER_MEMORY)
+                      .hits);
+  }
+
+  // A new supplier finds the module in the disk cache.
+  TieredSymbolSupplier supplier(no_paths_, cache_path_, &fetcher_);
+  CheckLoad(&supplier, &module_);
+  EXPECT_EQ(1, fetcher_.fetches_);
+  EXPECT_EQ(1U, supplier.GetTierStats(TieredSymbolSupplier::TIER_DISK).hits);
+}
+
+TEST_F(TieredSymbolSupplierTest, LocalSymbolsComeBeforeRemote) {
+  string directory = temp_dir_.path() + "/symbols";
+  ASSERT_EQ(0, mkdir(directory.c_str(), 0755));
+  ASSERT_EQ(0, mkdir((directory + "/module1.pdb").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((directory + "/module1.pdb/"
+                      "ABCDEF0123456789ABCDEF01234567891").c_str(), 0755));
+  ASSERT_TRUE(WriteFile(directory + "/" + remote_path_, fetcher_.contents_));
+
+  std::vector<string> paths(1, directory);
+  TieredSymbolSupplier supplier(paths, "", &fetcher_);
+  string symbol_file;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  EXPECT_EQ(directory + "/" + remote_path_, symbol_file);
+  EXPECT_EQ(0, fetcher_.fetches_);
+  EXPECT_EQ(1U, supplier.GetTierStats(TieredSymbolSupplier::TIER_LOCAL).hits);
+
+  // Modules missing locally are fetched.
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&other_module_, NULL, &symbol_file));
+  EXPECT_EQ("other.pdb/ABCDEF0123456789ABCDEF01234567891/other.sym",
+            symbol_file);
+  EXPECT_EQ(1, fetcher_.fetches_);
+  EXPECT_EQ(1U,
+            supplier.GetTierStats(TieredSymbolSupplier::TIER_LOCAL).misses);
+}
+
+TEST_F(TieredSymbolSupplierTest, MissingAndInterrupted) {
+  BasicCodeModule missing(0x1000, 0xb000, "missing.dll", "", "missing.pdb",
+                          "ABCDEF0123456789ABCDEF01234567891", "");
+  TieredSymbolSupplier supplier(no_paths_, cache_path_, &fetcher_);
+  string symbol_file;
+  EXPECT_EQ(SymbolSupplier::NOT_FOUND,
+            supplier.GetSymbolFile(&missing, NULL, &symbol_file));
+  EXPECT_TRUE(symbol_file.empty());
+  EXPECT_EQ(1U,
+            supplier.GetTierStats(TieredSymbolSupplier::TIER_REMOTE).misses);
+
+  // An interrupted fetch isn't remembered, so the module is fetched again.
+  fetcher_.result_ = SymbolSupplier::INTERRUPT;
+  EXPECT_EQ(SymbolSupplier::INTERRUPT,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  EXPECT_EQ(1U,
+            supplier.GetTierStats(TieredSymbolSupplier::TIER_REMOTE)
+                .failures);
+  fetcher_.result_ = SymbolSupplier::FOUND;
+  EXPECT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  EXPECT_EQ(3, fetcher_.fetches_);
+}
+
+TEST_F(TieredSymbolSupplierTest, ConcurrentLookupsFetchOnce) {
+  fetcher_.delay_ = 100;
+  TieredSymbolSupplier supplier(no_paths_, cache_path_, &fetcher_);
+  std::atomic<int> found(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([&]() {
+      string symbol_file;
+      if (supplier.GetSymbolFile(&module_, NULL, &symbol_file) ==
+          SymbolSupplier::FOUND) {
+        ++found;
+      }
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  EXPECT_EQ(8, found);
+  EXPECT_EQ(1, fetcher_.fetches_);
+  TieredSymbolSupplier::TierStats memory =
+      supplier.GetTierStats(TieredSymbolSupplier::TIER_MEMORY);
+  EXPECT_EQ(7U, memory.hits + memory.waits);
+}
+
+TEST_F(TieredSymbolSupplierTest, MemoryTierEvicts) {
+  TieredSymbolSupplier supplier(no_paths_, cache_path_, &fetcher_);
+  string symbol_file;
+  string symbol_data;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file,
+                                   &symbol_data));
+  // Room for one module only.
+  supplier.set_memory_cache_bytes(symbol_data.size());
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&other_module_, NULL, &symbol_file));
+  EXPECT_EQ(1U,
+            supplier.GetTierStats(TieredSymbolSupplier::TIER_MEMORY)
+                .evictions);
+
+  // The evicted module is read back from disk.
+  CheckLoad(&supplier, &module_);
+  EXPECT_EQ(2, fetcher_.fetches_);
+  EXPECT_EQ(1U, supplier.GetTierStats(TieredSymbolSupplier::TIER_DISK).hits);
+}
+
+TEST_F(TieredSymbolSupplierTest, DiskTierEvictsLeastRecentlyUsed) {
+  TieredSymbolSupplier supplier(no_paths_, cache_path_, &fetcher_);
+  supplier.set_memory_cache_bytes(0);
+  string symbol_file;
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  struct stat sb;
+  ASSERT_EQ(0, stat(cache_file_.c_str(), &sb));
+  // Make the first file the older, and leave room for only one.
+  struct timeval times[2];
+  times[0].tv_sec = times[1].tv_sec = sb.st_mtime - 3600;
+  times[0].tv_usec = times[1].tv_usec = 0;
+  ASSERT_EQ(0, utimes(cache_file_.c_str(), times));
+  supplier.set_disk_cache_bytes(sb.st_size * 3 / 2);
+
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&other_module_, NULL, &symbol_file));
+  struct stat other_sb;
+  ASSERT_EQ(0, stat(symbol_file.c_str(), &other_sb));
+  EXPECT_NE(0, stat(cache_file_.c_str(), &sb));
+  TieredSymbolSupplier::TierStats disk =
+      supplier.GetTierStats(TieredSymbolSupplier::TIER_DISK);
+  EXPECT_EQ(1U, disk.evictions);
+  EXPECT_EQ(static_cast<uint64_t>(other_sb.st_size), disk.bytes);
+
+  // The evicted module is fetched again.
+  ASSERT_EQ(SymbolSupplier::FOUND,
+            supplier.GetSymbolFile(&module_, NULL, &symbol_file));
+  EXPECT_EQ(3, fetcher_.fetches_);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "common/using_std_string.h"
+#include "processor/tokenize.h"
 
 namespace google_breakpad {
 
@@ -46,8 +47,25 @@ bool Tokenize(char* line,
               const char* separators,
               int max_tokens,
               vector<char*>* tokens) {
-  tokens->clear();
-  tokens->reserve(max_tokens);
+  if (max_tokens <= 0) {
+    tokens->clear();
+    return max_tokens == 0;
+  }
+
+  tokens->resize(max_tokens);
+  int num_tokens = 0;
+  bool result = Tokenize(line, separators, max_tokens, &(*tokens)[0],
+                         &num_tokens);
+  tokens->resize(num_tokens);
+  return result;
+}
+
+bool Tokenize(char* line,
+              const char* separators,
+              int max_tokens,
+              char** tokens,
+              int* num_tokens) {
+  *num_tokens = 0;
 
   int remaining = max_tokens;
 
@@ -56,17 +74,17 @@ bool Tokenize(char* line,
   char* save_ptr;
   char* token = strtok_r(line, separators, &save_ptr);
   while (token && --remaining > 0) {
-    tokens->push_back(token);
+    tokens[(*num_tokens)++] = token;
     if (remaining > 1)
       token = strtok_r(NULL, separators, &save_ptr);
   }
 
   // If there's anything left, just add it as a single token.
   if (remaining == 0 && (token = strtok_r(NULL, "\r\n", &save_ptr))) {
-    tokens->push_back(token);
+    tokens[(*num_tokens)++] = token;
   }
 
-  return tokens->size() == static_cast<unsigned int>(max_tokens);
+  return *num_tokens == max_tokens;
 }
 
 void StringToVector(const string& str, vector<char>& vec) {
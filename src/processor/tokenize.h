@@ -54,6 +54,18 @@ bool Tokenize(char* line,
               const char* separators,
               int max_tokens,
               std::vector<char*>* tokens);
+
+// Like Tokenize above, but stores the tokens in the caller-provided |tokens|
+// array, which must have room for |max_tokens| entries (at least one), and
+// sets |*num_tokens| to the number of tokens found.  This variant never
+// allocates, which matters when it is called once per line of a large symbol
+// file.
+bool Tokenize(char* line,
+              const char* separators,
+              int max_tokens,
+              char** tokens,
+              int* num_tokens);
+
 // For convenience, since you need a char* to pass to Tokenize.
 // You can call StringToVector on a string, and use &vec[0].
 void StringToVector(const string& str, std::vector<char>& vec);
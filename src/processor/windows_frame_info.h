@@ -41,12 +41,14 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 #include "processor/logging.h"
+#include "processor/postfix_program.h"
 #include "processor/tokenize.h"
 
 namespace google_breakpad {
@@ -171,6 +173,7 @@ struct WindowsFrameInfo {
     max_stack_size = that.max_stack_size;
     allocates_base_pointer = that.allocates_base_pointer;
     program_string = that.program_string;
+    program = that.program;
   }
 
   // Clears the WindowsFrameInfo object so that users will see it as though
@@ -179,6 +182,7 @@ struct WindowsFrameInfo {
     type_ = STACK_INFO_UNKNOWN;
     valid = VALID_NONE;
     program_string.erase();
+    program.reset();
   }
 
   StackInfoTypes type_;
@@ -201,6 +205,10 @@ struct WindowsFrameInfo {
   // If program_string is empty, use allocates_base_pointer.
   bool allocates_base_pointer;
   string program_string;
+
+  // program_string compiled for evaluation, if the resolver that found
+  // this frame info provided it; otherwise NULL.  See postfix_program.h.
+  std::shared_ptr<const PostfixProgram> program;
 };
 
 }  // namespace google_breakpad
@@ -29,34 +29,36 @@
 
 // core_handler.cc: A tool to handle coredumps on Linux
 
+#include <errno.h>
 #include <pwd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <syslog.h>
 #include <unistd.h>
 #include <sstream>
+#include <vector>
 
 #include "client/linux/minidump_writer/linux_core_dumper.h"
 #include "client/linux/minidump_writer/minidump_writer.h"
+#include "common/linux/elf_core_dump.h"
 #include "common/path_helper.h"
-#include "common/scoped_ptr.h"
 
 namespace {
 
 using google_breakpad::AppMemoryList;
+using google_breakpad::ElfCoreDump;
 using google_breakpad::LinuxCoreDumper;
 using google_breakpad::MappingList;
-using google_breakpad::scoped_array;
 
-// Size of the core dump to read in order to access all the threads
-// descriptions.
-//
-// The first section is the note0 section which contains the thread states. On
-// x86-64 a typical thread description take about 1432B. Reading 1 MB allows
-// several hundreds of threads.
-const int core_read_size = 1024 * 1024;
+// Upper bound on the part of the core dump read from stdin.  Only the ELF
+// header, the program headers and the PT_NOTE segments, which hold the
+// thread states, are read; memory is taken from /proc/<pid>/mem.  On
+// x86-64 a typical thread description takes about 1432B, so this allows
+// tens of thousands of threads.
+const size_t kMaxCoreReadSize = 64 * 1024 * 1024;
 
 void ShowUsage(const char* argv0) {
   fprintf(stderr, "Usage: %s <process id> <minidump file>\n\n",
@@ -80,26 +82,67 @@ bool WriteMinidumpFromCore(const char* filename,
                                         &dumper);
 }
 
-bool HandleCrash(pid_t pid, const char* procfs_dir, const char* md_filename) {
-  int r = 0;
-  scoped_array<char> buf(new char[core_read_size]);
-  while (r != core_read_size) {
-    int ret = read(STDIN_FILENO, &buf[r], core_read_size - r);
-    if (ret == 0) {
-      break;
-    } else if (ret == -1) {
+// Grows buf to size bytes, reading the new bytes from stdin.  Returns
+// false if stdin ends first or on a read error.
+bool ReadCoreTo(std::vector<char>* buf, size_t size) {
+  size_t r = buf->size();
+  if (size <= r)
+    return true;
+  if (size > kMaxCoreReadSize)
+    return false;
+  buf->resize(size);
+  while (r != size) {
+    ssize_t ret = read(STDIN_FILENO, &(*buf)[r], size - r);
+    if (ret == 0 || (ret == -1 && errno != EINTR)) {
+      buf->resize(r);
       return false;
     }
-    r += ret;
+    if (ret > 0)
+      r += ret;
+  }
+  return true;
+}
+
+// Reads the core dump piped on stdin up to the end of its last PT_NOTE
+// segment.  The kernel writes the notes before any PT_LOAD contents, so
+// the rest of the core, which may be many gigabytes, is never buffered.
+bool ReadCoreNotes(std::vector<char>* buf) {
+  if (!ReadCoreTo(buf, sizeof(ElfCoreDump::Ehdr)))
+    return false;
+  ElfCoreDump::Ehdr header;
+  memcpy(&header, &(*buf)[0], sizeof(header));
+  if (header.e_phentsize != sizeof(ElfCoreDump::Phdr))
+    return false;
+  size_t phdr_end = header.e_phoff +
+      static_cast<size_t>(header.e_phnum) * sizeof(ElfCoreDump::Phdr);
+  if (!ReadCoreTo(buf, phdr_end))
+    return false;
+
+  size_t notes_end = phdr_end;
+  for (unsigned i = 0; i < header.e_phnum; ++i) {
+    ElfCoreDump::Phdr program;
+    memcpy(&program, &(*buf)[header.e_phoff + i * sizeof(program)],
+           sizeof(program));
+    if (program.p_type == PT_NOTE &&
+        program.p_offset + program.p_filesz > notes_end) {
+      notes_end = program.p_offset + program.p_filesz;
+    }
   }
+  return ReadCoreTo(buf, notes_end);
+}
+
+bool HandleCrash(pid_t pid, const char* procfs_dir, const char* md_filename) {
+  std::vector<char> buf;
+  if (!ReadCoreNotes(&buf))
+    return false;
 
   int fd = memfd_create("core_file", MFD_CLOEXEC);
   if (fd == -1) {
     return false;
   }
 
-  int w = write(fd, &buf[0], r);
-  if (w != r) {
+  ssize_t w = write(fd, &buf[0], buf.size());
+  if (w != static_cast<ssize_t>(buf.size())) {
     close(fd);
     return false;
   }
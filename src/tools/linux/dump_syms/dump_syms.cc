@@ -27,36 +27,273 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <errno.h>
 #include <paths.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "common/fast_module_writer.h"
+#include "common/linux/debuginfod_client.h"
 #include "common/linux/dump_symbols.h"
+#include "common/module.h"
 #include "common/path_helper.h"
 
+using google_breakpad::FastModuleWriter;
+using google_breakpad::Module;
+using google_breakpad::ReadSymbolData;
 using google_breakpad::WriteSymbolFile;
 using google_breakpad::WriteSymbolFileHeader;
 
+namespace {
+
+// A binary listed in a batch manifest.
+struct BatchEntry {
+  string binary;
+  // The directories in which to look for the binary's debug file.
+  std::vector<string> debug_dirs;
+  // The binary's size, by which the batch is ordered.
+  off_t size;
+  // Once the binary has been dumped, the MODULE name and identifier, and
+  // the path of the symbol file relative to the output directory.  Empty
+  // if the binary couldn't be dumped.
+  string name;
+  string identifier;
+  string sym_path;
+};
+
+// Read the batch manifest at PATH into ENTRIES.  Each line names a binary,
+// followed by any directories in which to look for its debug file, all
+// separated by tabs; empty lines and lines starting with '#' are ignored.
+// Return false if the manifest can't be read.
+bool ReadManifest(const char* path, std::vector<BatchEntry>* entries) {
+  std::ifstream manifest(path);
+  if (!manifest) {
+    fprintf(stderr, "Failed to open manifest %s: %s\n", path,
+            strerror(errno));
+    return false;
+  }
+  string line;
+  while (std::getline(manifest, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    BatchEntry entry;
+    size_t start = 0;
+    size_t tab;
+    do {
+      tab = line.find('\t', start);
+      string field = line.substr(start, tab - start);
+      start = tab + 1;
+      if (field.empty())
+        continue;
+      if (entry.binary.empty())
+        entry.binary = field;
+      else
+        entry.debug_dirs.push_back(field);
+    } while (tab != string::npos);
+    if (entry.binary.empty())
+      continue;
+    struct stat info;
+    entry.size = stat(entry.binary.c_str(), &info) == 0 ? info.st_size : 0;
+    entries->push_back(entry);
+  }
+  return !manifest.bad();
+}
+
+// Create the directory PATH and any of its parents that don't exist.
+// Return false if one can't be created.
+bool MakeDirectories(const string& path) {
+  for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+    string directory = path.substr(0, slash);
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+      fprintf(stderr, "Failed to create directory %s: %s\n",
+              directory.c_str(), strerror(errno));
+      return false;
+    }
+    if (slash == string::npos)
+      return true;
+  }
+}
+
+// Dump ENTRY's binary to OUTPUT_DIR/<name>/<identifier>/<name>.sym, the
+// layout symbol stores and SimpleSymbolSupplier expect, filling in the
+// rest of ENTRY.  Return false if the binary can't be dumped.
+bool DumpBatchEntry(const string& output_dir, const char* obj_os,
+                    const google_breakpad::DumpOptions& options,
+                    int entry_index, BatchEntry* entry) {
+  Module* read_module;
+  if (!ReadSymbolData(entry->binary, entry->binary, obj_os,
+                      entry->debug_dirs, options, &read_module)) {
+    return false;
+  }
+  std::unique_ptr<Module> module(read_module);
+  string directory = module->name() + "/" + module->identifier();
+  string sym_path = directory + "/" + module->name() + ".sym";
+  if (!MakeDirectories(output_dir + "/" + directory))
+    return false;
+  // The same binary may be listed twice; write to a file of this entry's
+  // own and rename it into place, so that neither dump sees the other's
+  // half-written file.
+  string final_path = output_dir + "/" + sym_path;
+  string temporary_path = final_path + ".tmp" + std::to_string(entry_index);
+  {
+    std::ofstream sym_stream(temporary_path.c_str());
+    if (!sym_stream ||
+        !module->Write(sym_stream, options.symbol_data,
+                       options.dwarf_threads)) {
+      fprintf(stderr, "Failed to write %s\n", temporary_path.c_str());
+      unlink(temporary_path.c_str());
+      return false;
+    }
+  }
+  if (rename(temporary_path.c_str(), final_path.c_str()) != 0) {
+    fprintf(stderr, "Failed to rename %s to %s: %s\n",
+            temporary_path.c_str(), final_path.c_str(), strerror(errno));
+    unlink(temporary_path.c_str());
+    return false;
+  }
+  entry->name = module->name();
+  entry->identifier = module->identifier();
+  entry->sym_path = sym_path;
+  return true;
+}
+
+// Dump each binary listed in the manifest at MANIFEST_PATH into
+// OUTPUT_DIR on WORKERS threads, and write OUTPUT_DIR/index, listing the
+// binary, MODULE name and identifier, and symbol file of each binary
+// dumped, separated by tabs, in manifest order.  The largest binaries are
+// started first, so that no large one is left running on its own when
+// the rest are done.  If DEBUGINFOD isn't NULL, the debug files of the
+// binaries without debugging information of their own are fetched ahead
+// of the dumps, in the same order, while the first binaries are dumped.
+// Report the binaries that couldn't be dumped to SAVED_STDERR.  Return
+// the process's exit status.
+int DumpBatch(const char* manifest_path, const string& output_dir,
+              int workers, const char* obj_os,
+              const google_breakpad::DumpOptions& options,
+              google_breakpad::DebuginfodClient* debuginfod,
+              FILE* saved_stderr) {
+  std::vector<BatchEntry> entries;
+  if (!ReadManifest(manifest_path, &entries)) {
+    fprintf(saved_stderr, "Failed to read manifest %s\n", manifest_path);
+    return 1;
+  }
+  if (!MakeDirectories(output_dir)) {
+    fprintf(saved_stderr, "Failed to create %s\n", output_dir.c_str());
+    return 1;
+  }
+
+  std::vector<size_t> order(entries.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return entries[a].size > entries[b].size;
+  });
+  if (debuginfod) {
+    std::vector<string> build_ids;
+    string build_id;
+    for (size_t i = 0; i < order.size(); ++i) {
+      if (google_breakpad::NeedsDebugFile(entries[order[i]].binary,
+                                          &build_id)) {
+        build_ids.push_back(build_id);
+      }
+    }
+    debuginfod->Prefetch(build_ids, workers);
+  }
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  auto dump_entries = [&]() {
+    size_t i;
+    while ((i = next++) < order.size()) {
+      BatchEntry* entry = &entries[order[i]];
+      if (!DumpBatchEntry(output_dir, obj_os, options, order[i], entry)) {
+        fprintf(saved_stderr, "Failed to write symbol file for %s.\n",
+                entry->binary.c_str());
+        failed = true;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < workers && static_cast<size_t>(i) < order.size(); ++i)
+    threads.push_back(std::thread(dump_entries));
+  dump_entries();
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  string index_path = output_dir + "/index";
+  std::ofstream index(index_path.c_str());
+  for (const BatchEntry& entry : entries) {
+    if (!entry.sym_path.empty()) {
+      index << entry.binary << '\t' << entry.name << '\t'
+            << entry.identifier << '\t' << entry.sym_path << '\n';
+    }
+  }
+  index.close();
+  if (!index) {
+    fprintf(saved_stderr, "Failed to write %s\n", index_path.c_str());
+    return 1;
+  }
+  return failed ? 1 : 0;
+}
+
+}  // namespace
+
 int usage(const char* self) {
   fprintf(stderr,
           "Usage: %s [OPTION] <binary-with-debugging-info> "
-          "[directories-for-debug-file]\n\n",
+          "[directories-for-debug-file]\n"
+          "       %s [OPTION] -b <manifest> <output-directory>\n\n",
+          google_breakpad::BaseName(self).c_str(),
           google_breakpad::BaseName(self).c_str());
   fprintf(stderr, "Options:\n");
   fprintf(stderr, "  -i:         Output module header information only.\n");
   fprintf(stderr, "  -c          Do not generate CFI section\n");
   fprintf(stderr, "  -d          Generate INLINE/INLINE_ORIGIN records\n");
+  fprintf(stderr, "  -l          Do not generate LINE records, and find "
+                                 "functions through\n"
+                  "              .debug_names where there is one\n");
+  fprintf(stderr, "  -f          Write the symbols in the serialized form "
+                                 "FastSourceLineResolver\n"
+                  "              loads, as sym_to_fast would convert them\n");
+  fprintf(stderr, "  -x          Append an index of where each function's "
+                                 "records lie, so\n"
+                  "              that they can be fetched by byte range\n");
   fprintf(stderr, "  -r          Do not handle inter-compilation "
                                  "unit references\n");
   fprintf(stderr, "  -v          Print all warnings to stderr\n");
+  fprintf(stderr, "  -j <n>      Read DWARF debugging and call frame "
+                                 "information, and write the\n"
+                  "              symbol file, on <n> threads\n");
+  fprintf(stderr, "  -m <n>      Spill lines of functions to disk "
+                                 "every <n> functions\n");
+  fprintf(stderr, "  -C <dir>    Cache the functions read from each "
+                                 "compilation unit in <dir>\n");
+  fprintf(stderr, "  -D <dir>    Fetch the debug files of binaries without "
+                                 "debugging information\n"
+                  "              from the servers listed in DEBUGINFOD_URLS, "
+                                 "caching them in <dir>\n");
   fprintf(stderr, "  -n <name>   Use specified name for name of the object\n");
   fprintf(stderr, "  -o <os>     Use specified name for the "
                                  "operating system\n");
+  fprintf(stderr, "  -b <file>   Dump each binary listed in <file>, one per "
+                                 "line, followed by\n"
+                  "              its debug file directories, all separated "
+                                 "by tabs, to a\n"
+                  "              symbol store in <output-directory>, with an "
+                                 "index\n");
+  fprintf(stderr, "  -w <n>      Dump <n> binaries at once with -b "
+                                 "(default: one per CPU)\n");
   return 1;
 }
 
@@ -64,12 +301,21 @@ int main(int argc, char** argv) {
   if (argc < 2)
     return usage(argv[0]);
   bool header_only = false;
+  bool fast = false;
   bool cfi = true;
   bool handle_inlines = false;
+  bool functions_only = false;
+  bool address_index = false;
   bool handle_inter_cu_refs = true;
   bool log_to_stderr = false;
+  int dwarf_threads = 1;
+  size_t max_functions_in_memory = 0;
+  std::string cu_cache_directory;
+  std::string debuginfod_cache_directory;
   std::string obj_name;
   const char* obj_os = "Linux";
+  const char* manifest = NULL;
+  int workers = std::max(1u, std::thread::hardware_concurrency());
   int arg_index = 1;
   while (arg_index < argc && strlen(argv[arg_index]) > 0 &&
          argv[arg_index][0] == '-') {
@@ -79,10 +325,48 @@ int main(int argc, char** argv) {
       cfi = false;
     } else if (strcmp("-d", argv[arg_index]) == 0) {
       handle_inlines = true;
+    } else if (strcmp("-l", argv[arg_index]) == 0) {
+      functions_only = true;
+    } else if (strcmp("-f", argv[arg_index]) == 0) {
+      fast = true;
+    } else if (strcmp("-x", argv[arg_index]) == 0) {
+      address_index = true;
     } else if (strcmp("-r", argv[arg_index]) == 0) {
       handle_inter_cu_refs = false;
     } else if (strcmp("-v", argv[arg_index]) == 0) {
       log_to_stderr = true;
+    } else if (strcmp("-j", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -j\n");
+        return usage(argv[0]);
+      }
+      dwarf_threads = atoi(argv[arg_index + 1]);
+      if (dwarf_threads < 1) {
+        fprintf(stderr, "Invalid argument to -j: %s\n", argv[arg_index + 1]);
+        return usage(argv[0]);
+      }
+      ++arg_index;
+    } else if (strcmp("-m", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -m\n");
+        return usage(argv[0]);
+      }
+      max_functions_in_memory = strtoul(argv[arg_index + 1], NULL, 10);
+      ++arg_index;
+    } else if (strcmp("-C", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -C\n");
+        return usage(argv[0]);
+      }
+      cu_cache_directory = argv[arg_index + 1];
+      ++arg_index;
+    } else if (strcmp("-D", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -D\n");
+        return usage(argv[0]);
+      }
+      debuginfod_cache_directory = argv[arg_index + 1];
+      ++arg_index;
     } else if (strcmp("-n", argv[arg_index]) == 0) {
       if (arg_index + 1 >= argc) {
         fprintf(stderr, "Missing argument to -n\n");
@@ -97,6 +381,24 @@ int main(int argc, char** argv) {
       }
       obj_os = argv[arg_index + 1];
       ++arg_index;
+    } else if (strcmp("-b", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -b\n");
+        return usage(argv[0]);
+      }
+      manifest = argv[arg_index + 1];
+      ++arg_index;
+    } else if (strcmp("-w", argv[arg_index]) == 0) {
+      if (arg_index + 1 >= argc) {
+        fprintf(stderr, "Missing argument to -w\n");
+        return usage(argv[0]);
+      }
+      workers = atoi(argv[arg_index + 1]);
+      if (workers < 1) {
+        fprintf(stderr, "Invalid argument to -w: %s\n", argv[arg_index + 1]);
+        return usage(argv[0]);
+      }
+      ++arg_index;
     } else {
       printf("2.4 %s\n", argv[arg_index]);
       return usage(argv[0]);
@@ -105,6 +407,24 @@ int main(int argc, char** argv) {
   }
   if (arg_index == argc)
     return usage(argv[0]);
+  if (manifest && (header_only || !obj_name.empty() ||
+                   arg_index + 1 != argc)) {
+    fprintf(stderr, "-b takes a single output directory, and can't be "
+                    "used with -i or -n\n");
+    return usage(argv[0]);
+  }
+  if (fast && (header_only || manifest)) {
+    fprintf(stderr, "-f can't be used with -i or -b\n");
+    return usage(argv[0]);
+  }
+  if (functions_only && handle_inlines) {
+    fprintf(stderr, "-l can't be used with -d\n");
+    return usage(argv[0]);
+  }
+  if (address_index && (header_only || fast)) {
+    fprintf(stderr, "-x can't be used with -i or -f\n");
+    return usage(argv[0]);
+  }
   // Save stderr so it can be used below.
   FILE* saved_stderr = fdopen(dup(fileno(stderr)), "w");
   if (!log_to_stderr) {
@@ -125,15 +445,46 @@ int main(int argc, char** argv) {
   if (obj_name.empty())
     obj_name = binary;
 
+  SymbolData symbol_data = (handle_inlines ? INLINES : NO_DATA) |
+                           (cfi ? CFI : NO_DATA) |
+                           (address_index ? ADDRESS_INDEX : NO_DATA) |
+                           SYMBOLS_AND_FILES;
+  google_breakpad::DumpOptions options(symbol_data, handle_inter_cu_refs);
+  options.functions_only = functions_only;
+  options.dwarf_threads = dwarf_threads;
+  options.max_functions_in_memory = max_functions_in_memory;
+  options.cu_cache_directory = cu_cache_directory;
+  std::unique_ptr<google_breakpad::DebuginfodClient> debuginfod;
+  if (!debuginfod_cache_directory.empty()) {
+    const char* urls = getenv("DEBUGINFOD_URLS");
+    debuginfod.reset(new google_breakpad::DebuginfodClient(
+        google_breakpad::DebuginfodClient::SplitServerURLs(urls ? urls : ""),
+        debuginfod_cache_directory));
+    options.debug_file_fetcher = debuginfod.get();
+  }
+  if (manifest) {
+    return DumpBatch(manifest, argv[arg_index], workers, obj_os, options,
+                     debuginfod.get(), saved_stderr);
+  }
+
   if (header_only) {
     if (!WriteSymbolFileHeader(binary, obj_name, obj_os, std::cout)) {
       fprintf(saved_stderr, "Failed to process file.\n");
       return 1;
     }
+  } else if (fast) {
+    Module* read_module;
+    if (!ReadSymbolData(binary, obj_name, obj_os, debug_dirs, options,
+                        &read_module)) {
+      fprintf(saved_stderr, "Failed to read symbol data.\n");
+      return 1;
+    }
+    std::unique_ptr<Module> module(read_module);
+    if (!FastModuleWriter(module.get()).Write(std::cout, symbol_data)) {
+      fprintf(saved_stderr, "Failed to write symbol file.\n");
+      return 1;
+    }
   } else {
-    SymbolData symbol_data = (handle_inlines ? INLINES : NO_DATA) |
-                             (cfi ? CFI : NO_DATA) | SYMBOLS_AND_FILES;
-    google_breakpad::DumpOptions options(symbol_data, handle_inter_cu_refs);
     if (!WriteSymbolFile(binary, obj_name, obj_os, debug_dirs, options,
                          std::cout)) {
       fprintf(saved_stderr, "Failed to write symbol file.\n");
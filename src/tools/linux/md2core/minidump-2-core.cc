@@ -33,6 +33,7 @@
 
 #include <elf.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <link.h>
 #include <stdio.h>
@@ -48,7 +49,6 @@
 #include "common/linux/memory_mapped_file.h"
 #include "common/minidump_type_helper.h"
 #include "common/path_helper.h"
-#include "common/scoped_ptr.h"
 #include "common/using_std_string.h"
 #include "google_breakpad/common/breakpad_types.h"
 #include "google_breakpad/common/minidump_format.h"
@@ -217,6 +217,65 @@ writea(int fd, const void* idata, size_t length) {
   return true;
 }
 
+// Writes the core image to a file descriptor.  Runs of zeros, such as the
+// padding around the memory we have data for, are skipped with lseek when
+// the output is a regular file, leaving holes in a sparse file.  They are
+// written out when the output is a pipe.
+class CoreFileWriter {
+ public:
+  explicit CoreFileWriter(int fd)
+      : fd_(fd),
+        seekable_(lseek(fd, 0, SEEK_CUR) != -1 &&
+                  !(fcntl(fd, F_GETFL) & O_APPEND)),
+        pending_zeros_(0) {
+  }
+
+  bool Write(const void* data, size_t length) {
+    return FlushZeros() && writea(fd_, data, length);
+  }
+
+  void WriteZeros(size_t length) {
+    pending_zeros_ += length;
+  }
+
+  // Writes out any trailing zeros.  Must be called after the last Write.
+  bool Finish() {
+    if (!seekable_ || pending_zeros_ == 0)
+      return FlushZeros();
+    off_t end = lseek(fd_, 0, SEEK_CUR);
+    if (end == -1)
+      return false;
+    end += pending_zeros_;
+    pending_zeros_ = 0;
+    return ftruncate(fd_, end) == 0 && lseek(fd_, end, SEEK_SET) == end;
+  }
+
+ private:
+  bool FlushZeros() {
+    if (pending_zeros_ == 0)
+      return true;
+    if (seekable_) {
+      if (lseek(fd_, pending_zeros_, SEEK_CUR) == -1)
+        return false;
+      pending_zeros_ = 0;
+      return true;
+    }
+    static const uint8_t kZeros[4096] = { 0 };
+    while (pending_zeros_ > 0) {
+      size_t length = pending_zeros_ < sizeof(kZeros) ? pending_zeros_
+                                                       : sizeof(kZeros);
+      if (!writea(fd_, kZeros, length))
+        return false;
+      pending_zeros_ -= length;
+    }
+    return true;
+  }
+
+  int fd_;
+  bool seekable_;
+  size_t pending_zeros_;
+};
+
 /* Dynamically determines the byte sex of the system. Returns non-zero
  * for big-endian machines.
  */
@@ -290,14 +349,28 @@ struct CrashedProcess {
       : permissions(0xFFFFFFFF),
         start_address(0),
         end_address(0),
-        offset(0) {
+        offset(0),
+        data(NULL),
+        data_offset(0),
+        data_length(0) {
+    }
+
+    // The number of bytes this mapping occupies in the core: the pages
+    // covering data, which are zero outside of it.
+    size_t file_size() const {
+      return (data_offset + data_length + 4095) & ~static_cast<size_t>(4095);
     }
 
     uint32_t permissions;
     uint64_t start_address, end_address, offset;
     // The name we write out to the core.
     string filename;
-    string data;
+    // The memory contents we write out to the core, if any.  They start
+    // data_offset bytes into the first page of the mapping, and point
+    // into the mapped minidump or into CrashedProcess, so nothing is
+    // copied until the core is written.
+    const uint8_t* data;
+    size_t data_offset, data_length;
   };
   std::map<uint64_t, Mapping> mappings;
 
@@ -340,6 +413,8 @@ struct CrashedProcess {
   std::map<uintptr_t, Signature> signatures;
 
   string dynamic_data;
+  // The link map that AugmentMappings synthesizes for the core.
+  string link_map_data;
   MDRawDebug debug;
   std::vector<MDRawLinkMap> link_map;
 };
@@ -915,9 +990,24 @@ ParseExceptionStream(const Options& options, CrashedProcess* crashinfo,
   crashinfo->fatal_signal = (int) exp->exception_record.exception_code;
 }
 
-static bool
-WriteThread(const Options& options, const CrashedProcess::Thread& thread,
-            int fatal_signal) {
+// Appends a note to the PT_NOTE section being built in notes.  name is
+// padded to 8 bytes.
+static void
+AddNote(string* notes, uint32_t type, const char* name, const void* desc,
+        size_t descsz) {
+  Nhdr nhdr;
+  memset(&nhdr, 0, sizeof(nhdr));
+  nhdr.n_namesz = 5;
+  nhdr.n_descsz = descsz;
+  nhdr.n_type = type;
+  notes->append(reinterpret_cast<const char*>(&nhdr), sizeof(nhdr));
+  notes->append(name, 8);
+  notes->append(static_cast<const char*>(desc), descsz);
+}
+
+static void
+AddThreadNotes(string* notes, const CrashedProcess::Thread& thread,
+               int fatal_signal) {
   struct prstatus pr;
   memset(&pr, 0, sizeof(pr));
 
@@ -930,38 +1020,17 @@ WriteThread(const Options& options, const CrashedProcess::Thread& thread,
   memcpy(&pr.pr_reg, &thread.regs, sizeof(user_regs_struct));
 #endif
 
-  Nhdr nhdr;
-  memset(&nhdr, 0, sizeof(nhdr));
-  nhdr.n_namesz = 5;
-  nhdr.n_descsz = sizeof(struct prstatus);
-  nhdr.n_type = NT_PRSTATUS;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd, &pr, sizeof(struct prstatus))) {
-    return false;
-  }
+  AddNote(notes, NT_PRSTATUS, "CORE\0\0\0\0", &pr, sizeof(struct prstatus));
 
 #if defined(__i386__) || defined(__x86_64__)
-  nhdr.n_descsz = sizeof(user_fpregs_struct);
-  nhdr.n_type = NT_FPREGSET;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd, &thread.fpregs, sizeof(user_fpregs_struct))) {
-    return false;
-  }
+  AddNote(notes, NT_FPREGSET, "CORE\0\0\0\0", &thread.fpregs,
+          sizeof(user_fpregs_struct));
 #endif
 
 #if defined(__i386__)
-  nhdr.n_descsz = sizeof(user_fpxregs_struct);
-  nhdr.n_type = NT_PRXFPREG;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "LINUX\0\0\0", 8) ||
-      !writea(options.out_fd, &thread.fpxregs, sizeof(user_fpxregs_struct))) {
-    return false;
-  }
+  AddNote(notes, NT_PRXFPREG, "LINUX\0\0\0", &thread.fpxregs,
+          sizeof(user_fpxregs_struct));
 #endif
-
-  return true;
 }
 
 static void
@@ -1017,9 +1086,11 @@ ParseModuleStream(const Options& options, CrashedProcess* crashinfo,
   }
 }
 
+// Adds length bytes of data at addr to the mappings, splitting the mapping
+// that contains addr if needed.  data must outlive crashinfo.
 static void
-AddDataToMapping(CrashedProcess* crashinfo, const string& data,
-                 uintptr_t addr) {
+AddDataToMapping(CrashedProcess* crashinfo, const uint8_t* data,
+                 size_t length, uintptr_t addr) {
   for (std::map<uint64_t, CrashedProcess::Mapping>::iterator
          iter = crashinfo->mappings.begin();
        iter != crashinfo->mappings.end();
@@ -1049,8 +1120,9 @@ AddDataToMapping(CrashedProcess* crashinfo, const string& data,
       // file. But it is OK if the mapping itself extends past the end of
       // the data.
       mapping.start_address = addr & ~4095;
-      mapping.data.assign(addr & 4095, 0).append(data);
-      mapping.data.append(-mapping.data.size() & 4095, 0);
+      mapping.data = data;
+      mapping.data_offset = addr & 4095;
+      mapping.data_length = length;
       crashinfo->mappings[mapping.start_address] = mapping;
       return;
     }
@@ -1060,9 +1132,10 @@ AddDataToMapping(CrashedProcess* crashinfo, const string& data,
   mapping.permissions = PF_R | PF_W;
   mapping.start_address = addr & ~4095;
   mapping.end_address =
-    (addr + data.size() + 4095) & ~4095;
-  mapping.data.assign(addr & 4095, 0).append(data);
-  mapping.data.append(-mapping.data.size() & 4095, 0);
+    (addr + length + 4095) & ~4095;
+  mapping.data = data;
+  mapping.data_offset = addr & 4095;
+  mapping.data_length = length;
   crashinfo->mappings[mapping.start_address] = mapping;
 }
 
@@ -1073,8 +1146,7 @@ AugmentMappings(const Options& options, CrashedProcess* crashinfo,
   // Then adjust the mapping to include the stack dump.
   for (unsigned i = 0; i < crashinfo->threads.size(); ++i) {
     const CrashedProcess::Thread& thread = crashinfo->threads[i];
-    AddDataToMapping(crashinfo,
-                     string((char*)thread.stack, thread.stack_length),
+    AddDataToMapping(crashinfo, thread.stack, thread.stack_length,
                      thread.stack_addr);
   }
 
@@ -1082,7 +1154,7 @@ AugmentMappings(const Options& options, CrashedProcess* crashinfo,
   // the beginning of the address space, as this area should always be
   // available.
   static const uintptr_t start_addr = 4096;
-  string data;
+  string& data = crashinfo->link_map_data;
   struct r_debug debug = { 0 };
   debug.r_version = crashinfo->debug.version;
   debug.r_brk = (ElfW(Addr))crashinfo->debug.brk;
@@ -1167,7 +1239,8 @@ AugmentMappings(const Options& options, CrashedProcess* crashinfo,
     data.append(filename);
     data.append(8 - (filename.size() & 7), 0);
   }
-  AddDataToMapping(crashinfo, data, start_addr);
+  AddDataToMapping(crashinfo, reinterpret_cast<const uint8_t*>(data.data()),
+                   data.size(), start_addr);
 
   // Map the page containing the _DYNAMIC array
   if (!crashinfo->dynamic_data.empty()) {
@@ -1193,7 +1266,10 @@ AugmentMappings(const Options& options, CrashedProcess* crashinfo,
         goto no_dt_debug;
       }
     }
-    AddDataToMapping(crashinfo, crashinfo->dynamic_data,
+    AddDataToMapping(crashinfo,
+                     reinterpret_cast<const uint8_t*>(
+                         crashinfo->dynamic_data.data()),
+                     crashinfo->dynamic_data.size(),
                      (uintptr_t)crashinfo->debug.dynamic);
   }
 }
@@ -1287,12 +1363,34 @@ main(int argc, const char* argv[]) {
 
   AugmentMappings(options, &crashinfo, dump);
 
+  // Build the PT_NOTE section first, so that its size is known when the
+  // program headers are written.
+  string notes;
+  AddNote(&notes, NT_PRPSINFO, "CORE\0\0\0\0", &crashinfo.prps,
+          sizeof(prpsinfo));
+  AddNote(&notes, NT_AUXV, "CORE\0\0\0\0", crashinfo.auxv,
+          crashinfo.auxv_length);
+
+  for (unsigned i = 0; i < crashinfo.threads.size(); ++i) {
+    if (crashinfo.threads[i].tid == crashinfo.crashing_tid) {
+      AddThreadNotes(&notes, crashinfo.threads[i], crashinfo.fatal_signal);
+      break;
+    }
+  }
+
+  for (unsigned i = 0; i < crashinfo.threads.size(); ++i) {
+    if (crashinfo.threads[i].tid != crashinfo.crashing_tid)
+      AddThreadNotes(&notes, crashinfo.threads[i], 0);
+  }
+
   // Write the ELF header. The file will look like:
   //   ELF header
   //   Phdr for the PT_NOTE
-  //   Phdr for each of the thread stacks
+  //   Phdr for each of the memory mappings
   //   PT_NOTE
-  //   each of the thread stacks
+  //   the contents of each mapping we have data for
+  // Everything up to the end of the PT_NOTE is built in one buffer; the
+  // mapping contents are then written straight from the minidump.
   Ehdr ehdr;
   memset(&ehdr, 0, sizeof(Ehdr));
   ehdr.e_ident[0] = ELFMAG0;
@@ -1311,34 +1409,23 @@ main(int argc, const char* argv[]) {
   ehdr.e_phnum    = 1 +                         // PT_NOTE
                     crashinfo.mappings.size();  // memory mappings
   ehdr.e_shentsize= sizeof(Shdr);
-  if (!writea(options.out_fd, &ehdr, sizeof(Ehdr)))
-    return 1;
 
   size_t offset = sizeof(Ehdr) + ehdr.e_phnum * sizeof(Phdr);
-  size_t filesz = sizeof(Nhdr) + 8 + sizeof(prpsinfo) +
-                  // sizeof(Nhdr) + 8 + sizeof(user) +
-                  sizeof(Nhdr) + 8 + crashinfo.auxv_length +
-                  crashinfo.threads.size() * (
-                    (sizeof(Nhdr) + 8 + sizeof(prstatus))
-#if defined(__i386__) || defined(__x86_64__)
-                   + sizeof(Nhdr) + 8 + sizeof(user_fpregs_struct)
-#endif
-#if defined(__i386__)
-                   + sizeof(Nhdr) + 8 + sizeof(user_fpxregs_struct)
-#endif
-                    );
+  string headers;
+  headers.reserve(offset + notes.size());
+  headers.append(reinterpret_cast<const char*>(&ehdr), sizeof(Ehdr));
 
   Phdr phdr;
   memset(&phdr, 0, sizeof(Phdr));
   phdr.p_type = PT_NOTE;
   phdr.p_offset = offset;
-  phdr.p_filesz = filesz;
-  if (!writea(options.out_fd, &phdr, sizeof(phdr)))
-    return 1;
+  phdr.p_filesz = notes.size();
+  headers.append(reinterpret_cast<const char*>(&phdr), sizeof(phdr));
 
   phdr.p_type = PT_LOAD;
   phdr.p_align = 4096;
-  size_t note_align = phdr.p_align - ((offset+filesz) % phdr.p_align);
+  offset += notes.size();
+  size_t note_align = phdr.p_align - (offset % phdr.p_align);
   if (note_align == phdr.p_align)
     note_align = 0;
   offset += note_align;
@@ -1357,66 +1444,37 @@ main(int argc, const char* argv[]) {
     }
     phdr.p_vaddr = mapping.start_address;
     phdr.p_memsz = mapping.end_address - mapping.start_address;
-    if (mapping.data.size()) {
-      offset += filesz;
-      filesz = mapping.data.size();
-      phdr.p_filesz = mapping.data.size();
+    phdr.p_filesz = mapping.file_size();
+    if (phdr.p_filesz) {
       phdr.p_offset = offset;
+      offset += phdr.p_filesz;
     } else {
-      phdr.p_filesz = 0;
       phdr.p_offset = 0;
     }
-    if (!writea(options.out_fd, &phdr, sizeof(phdr)))
-      return 1;
-  }
-
-  Nhdr nhdr;
-  memset(&nhdr, 0, sizeof(nhdr));
-  nhdr.n_namesz = 5;
-  nhdr.n_descsz = sizeof(prpsinfo);
-  nhdr.n_type = NT_PRPSINFO;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd, &crashinfo.prps, sizeof(prpsinfo))) {
-    return 1;
+    headers.append(reinterpret_cast<const char*>(&phdr), sizeof(phdr));
   }
+  headers.append(notes);
 
-  nhdr.n_descsz = crashinfo.auxv_length;
-  nhdr.n_type = NT_AUXV;
-  if (!writea(options.out_fd, &nhdr, sizeof(nhdr)) ||
-      !writea(options.out_fd, "CORE\0\0\0\0", 8) ||
-      !writea(options.out_fd, crashinfo.auxv, crashinfo.auxv_length)) {
+  CoreFileWriter writer(options.out_fd);
+  if (!writer.Write(headers.data(), headers.size()))
     return 1;
-  }
-
-  for (unsigned i = 0; i < crashinfo.threads.size(); ++i) {
-    if (crashinfo.threads[i].tid == crashinfo.crashing_tid) {
-      WriteThread(options, crashinfo.threads[i], crashinfo.fatal_signal);
-      break;
-    }
-  }
-
-  for (unsigned i = 0; i < crashinfo.threads.size(); ++i) {
-    if (crashinfo.threads[i].tid != crashinfo.crashing_tid)
-      WriteThread(options, crashinfo.threads[i], 0);
-  }
-
-  if (note_align) {
-    google_breakpad::scoped_array<char> scratch(new char[note_align]);
-    memset(scratch.get(), 0, note_align);
-    if (!writea(options.out_fd, scratch.get(), note_align))
-      return 1;
-  }
+  writer.WriteZeros(note_align);
 
   for (std::map<uint64_t, CrashedProcess::Mapping>::const_iterator iter =
          crashinfo.mappings.begin();
        iter != crashinfo.mappings.end(); ++iter) {
     const CrashedProcess::Mapping& mapping = iter->second;
-    if (mapping.data.size()) {
-      if (!writea(options.out_fd, mapping.data.c_str(), mapping.data.size()))
+    size_t file_size = mapping.file_size();
+    if (file_size) {
+      writer.WriteZeros(mapping.data_offset);
+      if (!writer.Write(mapping.data, mapping.data_length))
         return 1;
+      writer.WriteZeros(
+          file_size - mapping.data_offset - mapping.data_length);
     }
   }
+  if (!writer.Finish())
+    return 1;
 
   if (options.out_fd != STDOUT_FILENO) {
     close(options.out_fd);
@@ -27,28 +27,156 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-// pid2md.cc: An utility to generate a minidump from a running process
+// pid2md.cc: An utility to generate a minidump from a running process,
+// or from each of several running processes.
 
+#include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <vector>
+
+#include "client/linux/minidump_writer/cpu_info_cache.h"
+#include "client/linux/minidump_writer/file_id_cache.h"
 #include "client/linux/minidump_writer/minidump_writer.h"
 #include "common/path_helper.h"
 
+namespace {
+
+// How many module identifiers are kept across the dumps of several
+// processes. The processes of one service map mostly the same files.
+const size_t kFileIdCacheCapacity = 4096;
+
+// Work shared by the threads dumping several processes.
+struct FleetState {
+  const char* directory;
+  const std::vector<pid_t>* pids;
+  // The index of the next pid to dump, claimed with an atomic add.
+  volatile long next;
+  // How many dumps failed.
+  volatile long failures;
+};
+
+void* DumpThread(void* arg) {
+  FleetState* state = static_cast<FleetState*>(arg);
+  for (;;) {
+    const size_t index =
+        static_cast<size_t>(__sync_fetch_and_add(&state->next, 1));
+    if (index >= state->pids->size())
+      break;
+    const pid_t pid = (*state->pids)[index];
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%d.dmp", state->directory, pid);
+    // Each dump attaches to, reads and detaches from its process on this
+    // thread, as ptrace requires.
+    if (!google_breakpad::WriteMinidump(path, pid, pid)) {
+      fprintf(stderr, "Unable to generate minidump for process %d.\n", pid);
+      __sync_fetch_and_add(&state->failures, 1);
+    }
+  }
+  return NULL;
+}
+
+// Dumps each of |pids| to <directory>/<pid>.dmp, |jobs| at a time.
+// Returns the number of dumps that failed.
+long DumpProcesses(const char* directory, const std::vector<pid_t>& pids,
+                   int jobs) {
+  // Every dump would otherwise read /proc/cpuinfo and hash the same
+  // shared libraries again.
+  static google_breakpad::CpuInfoCache cpu_info_cache;
+  if (cpu_info_cache.Capture(true))
+    google_breakpad::CpuInfoCache::SetProcessCache(&cpu_info_cache);
+  static google_breakpad::FileIdCache file_id_cache(kFileIdCacheCapacity);
+  google_breakpad::FileIdCache::SetProcessCache(&file_id_cache);
+
+  FleetState state;
+  state.directory = directory;
+  state.pids = &pids;
+  state.next = 0;
+  state.failures = 0;
+
+  if (static_cast<size_t>(jobs) > pids.size())
+    jobs = static_cast<int>(pids.size());
+  std::vector<pthread_t> threads;
+  for (int i = 0; i < jobs; ++i) {
+    pthread_t thread;
+    const int error = pthread_create(&thread, NULL, DumpThread, &state);
+    if (error != 0) {
+      fprintf(stderr, "Unable to start a dump thread: %s\n", strerror(error));
+      break;
+    }
+    threads.push_back(thread);
+  }
+  // With no thread started, dump on this one.
+  if (threads.empty())
+    DumpThread(&state);
+  for (size_t i = 0; i < threads.size(); ++i)
+    pthread_join(threads[i], NULL);
+
+  return state.failures;
+}
+
+void Usage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s <process id> <minidump file>\n"
+          "       %s -o <directory> [-j <jobs>] <process id>...\n\n",
+          google_breakpad::BaseName(argv0).c_str(),
+          google_breakpad::BaseName(argv0).c_str());
+  fprintf(stderr,
+          "A tool to generate a minidump from a running process. The process "
+          "resumes its\nactivity once the operation is completed. Permission "
+          "to trace the process is\nrequired.\n\n"
+          "With -o, each process listed is dumped to <directory>/<pid>.dmp, "
+          "up to <jobs>\n(default 8) at a time.\n");
+}
+
+}  // namespace
+
 int main(int argc, char* argv[]) {
-  if (argc != 3) {
-    fprintf(stderr, "Usage: %s <process id> <minidump file>\n\n",
-            google_breakpad::BaseName(argv[0]).c_str());
-    fprintf(stderr,
-            "A tool to generate a minidump from a running process. The process "
-            "resumes its\nactivity once the operation is completed. Permission "
-            "to trace the process is\nrequired.\n");
+  const char* directory = NULL;
+  int jobs = 8;
+  int ch;
+  while ((ch = getopt(argc, argv, "o:j:")) != -1) {
+    switch (ch) {
+      case 'o':
+        directory = optarg;
+        break;
+      case 'j':
+        jobs = atoi(optarg);
+        break;
+      default:
+        Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  if (directory) {
+    if (optind >= argc || jobs < 1) {
+      Usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    std::vector<pid_t> pids;
+    for (int i = optind; i < argc; ++i)
+      pids.push_back(atoi(argv[i]));
+    const long failures = DumpProcesses(directory, pids, jobs);
+    if (failures != 0) {
+      fprintf(stderr, "Unable to generate %ld of %zu minidumps.\n", failures,
+              pids.size());
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if (argc - optind != 2) {
+    Usage(argv[0]);
     return EXIT_FAILURE;
   }
 
-  pid_t process_id = atoi(argv[1]);
-  const char* minidump_file = argv[2];
+  pid_t process_id = atoi(argv[optind]);
+  const char* minidump_file = argv[optind + 1];
 
   if (!google_breakpad::WriteMinidump(minidump_file, process_id, process_id)) {
     fprintf(stderr, "Unable to generate minidump.\n");
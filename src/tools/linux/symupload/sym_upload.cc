@@ -66,18 +66,21 @@ static void StrToUpper(std::string* str) {
 static void
 Usage(int argc, const char *argv[]) {
   fprintf(stderr, "Submit symbol information.\n");
-  fprintf(stderr, "Usage: %s [options...] <symbol-file> <upload-URL>\n",
+  fprintf(stderr, "Usage: %s [options...] <symbol-file>... <upload-URL>\n",
           google_breakpad::BaseName(argv[0]).c_str());
   fprintf(stderr, "Options:\n");
   fprintf(stderr,
           "<symbol-file> should be created by using the dump_syms "
           "tool.\n");
   fprintf(stderr, "<upload-URL> is the destination for the upload\n");
+  fprintf(stderr, "Several Breakpad symbol files may be given; a line is "
+      "printed for each once it is done.\n");
   fprintf(stderr, "-p:\t <protocol> One of ['sym-upload-v1',"
     " 'sym-upload-v2'], defaults to 'sym-upload-v1'.\n");
   fprintf(stderr, "-v:\t Version information (e.g., 1.2.3.4)\n");
   fprintf(stderr, "-x:\t <host[:port]> Use HTTP proxy on given port\n");
   fprintf(stderr, "-u:\t <user[:password]> Set proxy user and password\n");
+  fprintf(stderr, "-j:\t <jobs> Upload up to <jobs> symbol files at once\n");
   fprintf(stderr, "-h:\t Usage\n");
   fprintf(stderr, "-?:\t Usage\n");
   fprintf(stderr, "\n");
@@ -108,6 +111,9 @@ Usage(int argc, const char *argv[]) {
   fprintf(stderr, "    %s -p sym-upload-v2 -k mysecret123! -t elf "
       "-c app -i 11111111BBBB3333DDDD555555555555F "
       "path/to/symbol_file http://myuploadserver\n", argv[0]);
+  fprintf(stderr, "    [Upload many files, 8 at once]\n");
+  fprintf(stderr, "    %s -p sym-upload-v2 -k mysecret123! -j 8 "
+      "path/to/*.sym http://myuploadserver\n", argv[0]);
 }
 
 //=============================================================================
@@ -115,7 +121,7 @@ static void
 SetupOptions(int argc, const char *argv[], Options *options) {
   extern int optind, optopt;
   int ch;
-  constexpr char flag_pattern[] = "u:v:x:p:k:t:c:i:hf?";
+  constexpr char flag_pattern[] = "u:v:x:p:k:t:c:i:j:hf?";
 
   while ((ch = getopt(argc, (char * const*)argv, flag_pattern)) != -1) {
     switch (ch) {
@@ -166,6 +172,14 @@ SetupOptions(int argc, const char *argv[], Options *options) {
       case 'f':
         options->force = true;
         break;
+      case 'j':
+        options->jobs = atoi(optarg);
+        if (options->jobs < 1) {
+          fprintf(stderr, "Invalid job count '%s'\n", optarg);
+          Usage(argc, argv);
+          exit(1);
+        }
+        break;
 
       default:
         fprintf(stderr, "Invalid option '%c'\n", ch);
@@ -174,7 +188,7 @@ SetupOptions(int argc, const char *argv[], Options *options) {
     }
   }
 
-  if ((argc - optind) != 2) {
+  if ((argc - optind) < 2) {
     fprintf(stderr, "%s: Missing symbols file and/or upload-URL\n", argv[0]);
     Usage(argc, argv);
     exit(1);
@@ -201,8 +215,20 @@ SetupOptions(int argc, const char *argv[], Options *options) {
     exit(1);
   }
 
-  options->symbolsPath = argv[optind];
-  options->uploadURLStr = argv[optind + 1];
+  int symbol_file_count = argc - optind - 1;
+  if (!is_breakpad_upload && symbol_file_count > 1) {
+    fprintf(stderr, "%s: Only one symbol file may be uploaded with -t.\n",
+        argv[0]);
+    Usage(argc, argv);
+    exit(1);
+  }
+
+  if (symbol_file_count == 1) {
+    options->symbolsPath = argv[optind];
+  } else {
+    options->symbolsPaths.assign(argv + optind, argv + argc - 1);
+  }
+  options->uploadURLStr = argv[argc - 1];
 }
 
 //=============================================================================
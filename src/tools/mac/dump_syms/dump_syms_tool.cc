@@ -36,28 +36,35 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include "common/mac/dump_syms.h"
 #include "common/mac/arch_utilities.h"
 #include "common/mac/macho_utilities.h"
-#include "common/scoped_ptr.h"
 
 using google_breakpad::DumpSymbols;
 using google_breakpad::Module;
-using google_breakpad::scoped_ptr;
 using std::vector;
 
 struct Options {
   Options()
-      : srcPath(), dsymPath(), arch(), header_only(false),
-        cfi(true), handle_inter_cu_refs(true), handle_inlines(false) {}
+      : srcPath(), dsymPath(), sharedCacheOutputDir(), archs(),
+        header_only(false), batch(false), cfi(true),
+        handle_inter_cu_refs(true), handle_inlines(false) {}
 
   string srcPath;
   string dsymPath;
-  const NXArchInfo *arch;
+  // If not empty, srcPath is a dyld shared cache, and the symbol file of
+  // each image it holds is written to this directory.
+  string sharedCacheOutputDir;
+  // The architectures to dump, in the order given; if empty, dump the
+  // file's only architecture, or the native one.
+  vector<const NXArchInfo*> archs;
   bool header_only;
+  bool batch;
   bool cfi;
   bool handle_inter_cu_refs;
   bool handle_inlines;
@@ -107,10 +114,77 @@ static void CopyCFIDataBetweenModules(Module* to_module,
   }
 }
 
-static bool Start(const Options& options) {
-  SymbolData symbol_data =
-      (options.handle_inlines ? INLINES : NO_DATA) |
+// Find the object file of each architecture in |archs| in the file
+// |dump_symbols| has read, |path|, and append it to |object_files|.  If one
+// is missing, report it with the architectures the file does have, and
+// return false.
+static bool FindObjectFiles(DumpSymbols& dump_symbols, const string& path,
+                            const vector<const NXArchInfo*>& archs,
+                            vector<const SuperFatArch*>* object_files) {
+  for (const NXArchInfo* arch : archs) {
+    const SuperFatArch* object_file =
+        dump_symbols.FindObjectFile(arch->cputype, arch->cpusubtype);
+    if (object_file) {
+      object_files->push_back(object_file);
+      continue;
+    }
+    fprintf(stderr, "%s: no architecture '%s' is present in file.\n",
+            path.c_str(), arch->name);
+    size_t available_size;
+    const SuperFatArch *available =
+      dump_symbols.AvailableArchitectures(&available_size);
+    if (available_size == 1)
+      fprintf(stderr, "the file's architecture is: ");
+    else
+      fprintf(stderr, "architectures present in the file are:\n");
+    for (size_t i = 0; i < available_size; i++) {
+      const SuperFatArch *arch = &available[i];
+      const NXArchInfo *arch_info =
+        google_breakpad::BreakpadGetArchInfoFromCpuType(
+            arch->cputype, arch->cpusubtype);
+      if (arch_info)
+        fprintf(stderr, "%s (%s)\n", arch_info->name, arch_info->description);
+      else
+        fprintf(stderr, "unrecognized cpu type 0x%x, subtype 0x%x\n",
+                arch->cputype, arch->cpusubtype);
+    }
+    return false;
+  }
+  return true;
+}
+
+// Read the debugging information of each architecture in |archs| from the
+// file |dump_symbols| has read, |path|, into |modules|, in the same order;
+// if |archs| is empty, read the architecture the dumper selects by default.
+// Several architectures are read at once, on threads of their own.
+static bool ReadModules(DumpSymbols& dump_symbols, const string& path,
+                        const vector<const NXArchInfo*>& archs,
+                        vector<std::unique_ptr<Module>>* modules) {
+  vector<Module*> read_modules;
+  if (archs.empty()) {
+    Module* module = NULL;
+    if (!dump_symbols.ReadSymbolData(&module))
+      return false;
+    read_modules.push_back(module);
+  } else {
+    vector<const SuperFatArch*> object_files;
+    if (!FindObjectFiles(dump_symbols, path, archs, &object_files) ||
+        !dump_symbols.ReadSymbolData(object_files, &read_modules)) {
+      return false;
+    }
+  }
+  for (Module* module : read_modules)
+    modules->push_back(std::unique_ptr<Module>(module));
+  return true;
+}
+
+static SymbolData SymbolDataFor(const Options& options) {
+  return (options.handle_inlines ? INLINES : NO_DATA) |
       (options.cfi ? CFI : NO_DATA) | SYMBOLS_AND_FILES;
+}
+
+static bool Start(const Options& options) {
+  SymbolData symbol_data = SymbolDataFor(options);
   DumpSymbols dump_symbols(symbol_data, options.handle_inter_cu_refs);
 
   // For x86_64 binaries, the CFI data is in the __TEXT,__eh_frame of the
@@ -129,41 +203,27 @@ static bool Start(const Options& options) {
   if (!dump_symbols.Read(primary_file))
     return false;
 
-  if (options.arch) {
-    if (!dump_symbols.SetArchitecture(options.arch->cputype,
-                                      options.arch->cpusubtype)) {
-      fprintf(stderr, "%s: no architecture '%s' is present in file.\n",
-              primary_file.c_str(), options.arch->name);
-      size_t available_size;
-      const SuperFatArch *available =
-        dump_symbols.AvailableArchitectures(&available_size);
-      if (available_size == 1)
-        fprintf(stderr, "the file's architecture is: ");
-      else
-        fprintf(stderr, "architectures present in the file are:\n");
-      for (size_t i = 0; i < available_size; i++) {
-        const SuperFatArch *arch = &available[i];
-        const NXArchInfo *arch_info =
-          google_breakpad::BreakpadGetArchInfoFromCpuType(
-              arch->cputype, arch->cpusubtype);
-        if (arch_info)
-          fprintf(stderr, "%s (%s)\n", arch_info->name, arch_info->description);
-        else
-          fprintf(stderr, "unrecognized cpu type 0x%x, subtype 0x%x\n",
-                  arch->cputype, arch->cpusubtype);
-      }
+  if (options.header_only) {
+    if (options.archs.empty())
+      return dump_symbols.WriteSymbolFileHeader(std::cout);
+    vector<const SuperFatArch*> object_files;
+    if (!FindObjectFiles(dump_symbols, primary_file, options.archs,
+                         &object_files)) {
       return false;
     }
+    for (const SuperFatArch* object_file : object_files) {
+      dump_symbols.SetArchitecture(object_file->cputype,
+                                   object_file->cpusubtype);
+      if (!dump_symbols.WriteSymbolFileHeader(std::cout))
+        return false;
+    }
+    return true;
   }
 
-  if (options.header_only)
-    return dump_symbols.WriteSymbolFileHeader(std::cout);
-
-  // Read the primary file into a Breakpad Module.
-  Module* module = NULL;
-  if (!dump_symbols.ReadSymbolData(&module))
+  // Read the primary file into Breakpad Modules, one per architecture.
+  vector<std::unique_ptr<Module>> modules;
+  if (!ReadModules(dump_symbols, primary_file, options.archs, &modules))
     return false;
-  scoped_ptr<Module> scoped_module(module);
 
   // If this is a split module, read the secondary Mach-O file, from which the
   // CFI data will be extracted.
@@ -171,25 +231,86 @@ static bool Start(const Options& options) {
     if (!dump_symbols.Read(options.srcPath))
       return false;
 
-    Module* cfi_module = NULL;
-    if (!dump_symbols.ReadSymbolData(&cfi_module))
-      return false;
-    scoped_ptr<Module> scoped_cfi_module(cfi_module);
-
-    // Ensure that the modules are for the same debug code file.
-    if (cfi_module->name() != module->name() ||
-        cfi_module->os() != module->os() ||
-        cfi_module->architecture() != module->architecture() ||
-        cfi_module->identifier() != module->identifier()) {
-      fprintf(stderr, "Cannot generate a symbol file from split sources that do"
-                      " not match.\n");
+    vector<std::unique_ptr<Module>> cfi_modules;
+    if (!ReadModules(dump_symbols, options.srcPath, options.archs,
+                     &cfi_modules)) {
       return false;
     }
 
-    CopyCFIDataBetweenModules(module, cfi_module);
+    for (size_t i = 0; i < modules.size(); ++i) {
+      Module* module = modules[i].get();
+      const Module* cfi_module = cfi_modules[i].get();
+      // Ensure that the modules are for the same debug code file.
+      if (cfi_module->name() != module->name() ||
+          cfi_module->os() != module->os() ||
+          cfi_module->architecture() != module->architecture() ||
+          cfi_module->identifier() != module->identifier()) {
+        fprintf(stderr, "Cannot generate a symbol file from split sources that"
+                        " do not match.\n");
+        return false;
+      }
+
+      CopyCFIDataBetweenModules(module, cfi_module);
+    }
+  }
+
+  for (const std::unique_ptr<Module>& module : modules) {
+    if (!module->Write(std::cout, symbol_data))
+      return false;
   }
+  return true;
+}
 
-  return module->Write(std::cout, symbol_data);
+// Dump the requests read from standard input, one to a line: an
+// architecture, a tab, a Mach-O file, a tab, and the path to write the
+// symbol file to. Each is answered on standard output by a line, "ok" or
+// "failed", once its symbol file is written, so that one process can dump
+// many files in turn without starting for each. A file named by
+// consecutive requests is only read once.
+static bool StartBatch(const Options& options) {
+  SymbolData symbol_data = SymbolDataFor(options);
+  DumpSymbols dump_symbols(symbol_data, options.handle_inter_cu_refs);
+  string read_path;
+  string line;
+  while (std::getline(std::cin, line)) {
+    const size_t tab = line.find('\t');
+    const size_t second_tab =
+        tab == string::npos ? string::npos : line.find('\t', tab + 1);
+    if (second_tab == string::npos) {
+      fprintf(stderr, "Malformed request: %s\n", line.c_str());
+      std::cout << "failed" << std::endl;
+      continue;
+    }
+    const string arch_name = line.substr(0, tab);
+    const string path = line.substr(tab + 1, second_tab - tab - 1);
+    const string output_path = line.substr(second_tab + 1);
+
+    bool ok = false;
+    const NXArchInfo* arch_info =
+        google_breakpad::BreakpadGetArchInfoFromName(arch_name.c_str());
+    if (!arch_info) {
+      fprintf(stderr, "%s: Invalid architecture: %s\n", path.c_str(),
+              arch_name.c_str());
+    }
+    if (arch_info && path != read_path) {
+      read_path.clear();
+      if (dump_symbols.Read(path))
+        read_path = path;
+    }
+    vector<std::unique_ptr<Module>> modules;
+    if (arch_info && path == read_path &&
+        ReadModules(dump_symbols, path,
+                    vector<const NXArchInfo*>(1, arch_info), &modules)) {
+      std::ofstream output(output_path.c_str());
+      ok = output && modules[0]->Write(output, symbol_data);
+      output.close();
+      ok = ok && !output.fail();
+    }
+    if (!ok)
+      unlink(output_path.c_str());
+    std::cout << (ok ? "ok" : "failed") << std::endl;
+  }
+  return true;
 }
 
 //=============================================================================
@@ -197,9 +318,20 @@ static void Usage(int argc, const char *argv[]) {
   fprintf(stderr, "Output a Breakpad symbol file from a Mach-o file.\n");
   fprintf(stderr, "Usage: %s [-a ARCHITECTURE] [-c] [-g dSYM path] "
                   "<Mach-o file>\n", argv[0]);
+  fprintf(stderr, "       %s -b [-c] [-r] [-d]\n", argv[0]);
+  fprintf(stderr, "       %s -s DIRECTORY [-c] [-r] [-d] "
+                  "<dyld shared cache>\n", argv[0]);
   fprintf(stderr, "\t-i: Output module header information only.\n");
+  fprintf(stderr, "\t-s: The Mach-o file is a dyld shared cache; write the\n");
+  fprintf(stderr, "\t    symbol file of each image it holds to this\n");
+  fprintf(stderr, "\t    directory\n");
+  fprintf(stderr, "\t-b: Batch mode: dump each request read from stdin,\n");
+  fprintf(stderr, "\t    a line of <arch> TAB <Mach-o file> TAB <output>,\n");
+  fprintf(stderr, "\t    and answer each with a line, ok or failed\n");
   fprintf(stderr, "\t-a: Architecture type [default: native, or whatever is\n");
   fprintf(stderr, "\t    in the file, if it contains only one architecture]\n");
+  fprintf(stderr, "\t    Repeat to dump several architectures at once;\n");
+  fprintf(stderr, "\t    their symbol files are written in turn\n");
   fprintf(stderr, "\t-g: Debug symbol file (dSYM) to dump in addition to the "
                   "Mach-o file\n");
   fprintf(stderr, "\t-c: Do not generate CFI section\n");
@@ -209,12 +341,56 @@ static void Usage(int argc, const char *argv[]) {
   fprintf(stderr, "\t-?: Usage\n");
 }
 
+// Dump each image in the dyld shared cache |options.srcPath| to a symbol
+// file of its own in |options.sharedCacheOutputDir|, named after the
+// image's path with its slashes turned to underscores: for example,
+// usr_lib_libSystem.B.dylib.sym. The images are read
+// in place in the cache, several at once, rather than extracted first.
+static bool StartSharedCache(const Options& options) {
+  SymbolData symbol_data = SymbolDataFor(options);
+  DumpSymbols dump_symbols(symbol_data, options.handle_inter_cu_refs);
+  if (!dump_symbols.Read(options.srcPath))
+    return false;
+
+  typedef google_breakpad::mach_o::SharedCacheReader::Image Image;
+  const vector<Image>& images = dump_symbols.SharedCacheImages();
+  if (images.empty()) {
+    fprintf(stderr, "%s: not a dyld shared cache, or holds no images\n",
+            options.srcPath.c_str());
+    return false;
+  }
+  vector<const Image*> image_pointers;
+  for (const Image& image : images)
+    image_pointers.push_back(&image);
+  vector<Module*> read_modules;
+  bool result =
+      dump_symbols.ReadSharedCacheSymbolData(image_pointers, &read_modules);
+
+  for (size_t i = 0; i < read_modules.size(); ++i) {
+    std::unique_ptr<Module> module(read_modules[i]);
+    if (!module)
+      continue;
+    string name = images[i].path;
+    if (!name.empty() && name[0] == '/')
+      name.erase(0, 1);
+    std::replace(name.begin(), name.end(), '/', '_');
+    const string output_path =
+        options.sharedCacheOutputDir + "/" + name + ".sym";
+    std::ofstream output(output_path.c_str());
+    if (!output || !module->Write(output, symbol_data)) {
+      fprintf(stderr, "Unable to write %s\n", output_path.c_str());
+      result = false;
+    }
+  }
+  return result;
+}
+
 //=============================================================================
 static void SetupOptions(int argc, const char *argv[], Options *options) {
   extern int optind;
   signed char ch;
 
-  while ((ch = getopt(argc, (char * const*)argv, "ia:g:crd?h")) != -1) {
+  while ((ch = getopt(argc, (char * const*)argv, "ia:bg:s:crd?h")) != -1) {
     switch (ch) {
       case 'i':
         options->header_only = true;
@@ -227,12 +403,18 @@ static void SetupOptions(int argc, const char *argv[], Options *options) {
           Usage(argc, argv);
           exit(1);
         }
-        options->arch = arch_info;
+        options->archs.push_back(arch_info);
         break;
       }
+      case 'b':
+        options->batch = true;
+        break;
       case 'g':
         options->dsymPath = optarg;
         break;
+      case 's':
+        options->sharedCacheOutputDir = optarg;
+        break;
       case 'c':
         options->cfi = false;
         break;
@@ -250,12 +432,32 @@ static void SetupOptions(int argc, const char *argv[], Options *options) {
     }
   }
 
+  if (options->batch) {
+    if (argc != optind || options->header_only || !options->archs.empty() ||
+        !options->dsymPath.empty()) {
+      fprintf(stderr, "Batch mode takes its files and architectures from "
+                      "stdin\n");
+      Usage(argc, argv);
+      exit(1);
+    }
+    return;
+  }
+
   if ((argc - optind) != 1) {
     fprintf(stderr, "Must specify Mach-o file\n");
     Usage(argc, argv);
     exit(1);
   }
 
+  if (!options->sharedCacheOutputDir.empty() &&
+      (options->header_only || !options->archs.empty() ||
+       !options->dsymPath.empty())) {
+    fprintf(stderr, "A dyld shared cache is dumped whole, for its own "
+                    "architecture\n");
+    Usage(argc, argv);
+    exit(1);
+  }
+
   options->srcPath = argv[optind];
 }
 
@@ -265,7 +467,12 @@ int main (int argc, const char * argv[]) {
   bool result;
 
   SetupOptions(argc, argv, &options);
-  result = Start(options);
+  if (options.batch)
+    result = StartBatch(options);
+  else if (!options.sharedCacheOutputDir.empty())
+    result = StartSharedCache(options);
+  else
+    result = Start(options);
 
   return !result;
 }
@@ -33,7 +33,8 @@ Tool upload_system_symbols generates and uploads Breakpad symbol files for OS X
 
 This tool shells out to the dump_syms and symupload Breakpad tools. In its default mode, this
 will find all dynamic libraries on the system, run dump_syms to create the Breakpad symbol files,
-and then upload them to Google's crash infrastructure.
+and then upload them to Google's crash infrastructure. Each dump worker keeps one dump_syms
+running in batch mode (-b) and sends it the libraries to dump one after another.
 
 The tool can also be used to only dump libraries or upload from a directory. See -help for more
 information.
@@ -43,6 +44,7 @@ Both i386 and x86_64 architectures will be dumped and uploaded.
 package main
 
 import (
+	"bufio"
 	"debug/macho"
 	"flag"
 	"fmt"
@@ -223,8 +225,8 @@ type DumpQueue struct {
 }
 
 type dumpRequest struct {
-	path string
-	arch string
+	path  string
+	archs []string
 }
 
 // StartDumpQueue creates a new worker pool to find all the Mach-O libraries in
@@ -244,11 +246,11 @@ func StartDumpQueue(root, dumpPath string, uq *UploadQueue) *DumpQueue {
 }
 
 // DumpSymbols enqueues the filepath to have its symbols dumped in the specified
-// architecture.
-func (dq *DumpQueue) DumpSymbols(filepath string, arch string) {
+// architectures.
+func (dq *DumpQueue) DumpSymbols(filepath string, archs []string) {
 	dq.queue <- dumpRequest{
-		path: filepath,
-		arch: arch,
+		path:  filepath,
+		archs: archs,
 	}
 }
 
@@ -263,29 +265,50 @@ func (dq *DumpQueue) done() {
 	close(dq.queue)
 }
 
+// worker runs one dump_syms in batch mode for all of its requests, rather than
+// one process per library and architecture. The architectures of a library go
+// to the same dump_syms in turn, so it reads the library only once.
 func (dq *DumpQueue) worker() {
 	dumpSyms := path.Join(*breakpadTools, "dump_syms")
 
+	cmd := exec.Command(dumpSyms, "-b")
+	cmd.Stderr = os.Stderr
+	requests, err := cmd.StdinPipe()
+	if err != nil {
+		log.Fatalf("Error creating dump_syms input: %v", err)
+	}
+	stdout, err := cmd.StdoutPipe()
+	if err != nil {
+		log.Fatalf("Error creating dump_syms output: %v", err)
+	}
+	if err := cmd.Start(); err != nil {
+		log.Fatalf("Error starting dump_syms: %v", err)
+	}
+	answers := bufio.NewScanner(stdout)
+
 	for req := range dq.queue {
 		filebase := path.Join(dq.dumpPath, strings.Replace(req.path, "/", "_", -1))
-		symfile := fmt.Sprintf("%s_%s.sym", filebase, req.arch)
-		f, err := os.Create(symfile)
-		if err != nil {
-			log.Fatalf("Error creating symbol file: %v", err)
-		}
-
-		cmd := exec.Command(dumpSyms, "-a", req.arch, req.path)
-		cmd.Stdout = f
-		err = cmd.Run()
-		f.Close()
+		for _, arch := range req.archs {
+			symfile := fmt.Sprintf("%s_%s.sym", filebase, arch)
+			if _, err := fmt.Fprintf(requests, "%s\t%s\t%s\n", arch, req.path, symfile); err != nil {
+				log.Fatalf("Error sending request to dump_syms: %v", err)
+			}
+			if !answers.Scan() {
+				log.Fatalf("dump_syms exited while dumping %s (%s): %v", req.path, arch, answers.Err())
+			}
 
-		if err != nil {
-			os.Remove(symfile)
-			log.Printf("Error running dump_syms(%s, %s): %v\n", req.arch, req.path, err)
-		} else if dq.uq != nil {
-			dq.uq.Upload(symfile)
+			if answers.Text() != "ok" {
+				log.Printf("Error running dump_syms(%s, %s)\n", arch, req.path)
+			} else if dq.uq != nil {
+				dq.uq.Upload(symfile)
+			}
 		}
 	}
+
+	requests.Close()
+	if err := cmd.Wait(); err != nil {
+		log.Printf("Error running dump_syms: %v\n", err)
+	}
 }
 
 // uploadFromDirectory handles the upload-only case and merely uploads all files in
@@ -393,11 +416,12 @@ func (fq *findQueue) worker() {
 			continue
 		}
 
+		var archs []string
 		fatFile, err := macho.NewFatFile(f)
 		if err == nil {
 			// The file is fat, so dump its architectures.
 			for _, fatArch := range fatFile.Arches {
-				fq.dumpMachOFile(fp, fatArch.File)
+				archs = fq.appendDumpArch(archs, fatArch.File)
 			}
 			fatFile.Close()
 		} else if err == macho.ErrNotFat {
@@ -407,26 +431,33 @@ func (fq *findQueue) worker() {
 				log.Printf("%s: %v", fp, err)
 				continue
 			}
-			fq.dumpMachOFile(fp, thinFile)
+			archs = fq.appendDumpArch(archs, thinFile)
 			thinFile.Close()
 		} else {
 			f.Close()
 		}
+
+		if len(archs) > 0 {
+			fq.dq.DumpSymbols(fp, archs)
+		}
 	}
 }
 
-func (fq *findQueue) dumpMachOFile(fp string, image *macho.File) {
+// appendDumpArch appends the architecture of image to archs if it is one to
+// dump.
+func (fq *findQueue) appendDumpArch(archs []string, image *macho.File) []string {
 	if image.Type != MachODylib && image.Type != MachOBundle && image.Type != MachODylinker {
-		return
+		return archs
 	}
 
 	arch := getArchStringFromHeader(image.FileHeader)
 	if arch == "" {
 		// Don't know about this architecture type.
-		return
+		return archs
 	}
 
 	if (*dumpArchitecture != "" && *dumpArchitecture == arch) || *dumpArchitecture == "" {
-		fq.dq.DumpSymbols(fp, arch)
+		archs = append(archs, arch)
 	}
+	return archs
 }
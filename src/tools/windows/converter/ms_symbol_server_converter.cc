@@ -40,6 +40,7 @@
 
 #include <cassert>
 #include <cstdio>
+#include <mutex>
 
 #include "tools/windows/converter/ms_symbol_server_converter.h"
 #include "common/windows/pdb_source_line_writer.h"
@@ -56,6 +57,10 @@
 
 namespace {
 
+// All DbgHelp functions are single-threaded; calls to them from different
+// threads must not overlap.
+std::mutex dbghelp_mutex;
+
 std::wstring GetExeDirectory() {
   wchar_t directory[MAX_PATH];
 
@@ -287,6 +292,8 @@ MSSymbolServerConverter::LocateFile(const string& debug_or_code_file,
     return LOCATE_FAILURE;
   }
 
+  // Held until symsrv has been cleaned up, when this returns.
+  std::lock_guard<std::mutex> dbghelp_lock(dbghelp_mutex);
   HANDLE process = GetCurrentProcess();  // CloseHandle is not needed.
   AutoSymSrv symsrv;
   if (!symsrv.Initialize(process,
@@ -60,6 +60,11 @@
 // included with the same versions of Debugging Tools for Windows, available at
 // http://www.microsoft.com/whdc/devtools/debugging/ .
 //
+// MSSymbolServerConverter objects may be used on several threads at once.
+// DbgHelp is single-threaded, so the symbol server lookups they make through
+// it take turns, but conversions run concurrently with each other and with
+// lookups.
+//
 // Author: Mark Mentovai
 
 #ifndef TOOLS_WINDOWS_MS_SYMBOL_SERVER_CONVERTER_H_
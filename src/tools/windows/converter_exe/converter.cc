@@ -31,12 +31,21 @@
 #pragma comment(lib, "diaguids.lib")
 #pragma comment(lib, "imagehlp.lib")
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
 #include <ctime>
+#include <deque>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <regex>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "tools/windows/converter_exe/escaping.h"
@@ -52,6 +61,7 @@ using strings::WebSafeBase64Escape;
 namespace {
 
 using std::map;
+using std::set;
 using std::string;
 using std::vector;
 using std::wstring;
@@ -288,10 +298,65 @@ static bool SafeToMakeExternalRequest(const MissingSymbolInfo& missing_info,
   return true;
 }
 
+// A queue of work items handed from one stage of the conversion pipeline
+// to the threads of the next.  Pop waits for an item, and returns false
+// once the queue is closed and empty.
+template <typename T>
+class WorkQueue {
+ public:
+  WorkQueue() : closed_(false) {}
+
+  void Push(const T& item) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      items_.push_back(item);
+    }
+    ready_.notify_one();
+  }
+
+  // No more items will be pushed.
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    ready_.notify_all();
+  }
+
+  bool Pop(T* item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (items_.empty()) {
+      return false;
+    }
+    *item = items_.front();
+    items_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<T> items_;
+  bool closed_;
+
+  // DISABLE_COPY_AND_ASSIGN
+  WorkQueue(const WorkQueue&);
+  WorkQueue& operator=(const WorkQueue&);
+};
+
+// A converted symbol file waiting to be uploaded.
+struct PendingUpload {
+  MissingSymbolInfo missing_info;
+  string converted_file;
+};
+
 // Converter options derived from command line parameters.
 struct ConverterOptions {
   ConverterOptions()
-      : report_fetch_failures(true) {
+      : report_fetch_failures(true),
+        conversion_threads(1),
+        upload_threads(1) {
   }
 
   ~ConverterOptions() {
@@ -336,6 +401,11 @@ struct ConverterOptions {
   // Owned and cleaned up by this struct.
   std::regex blacklist_regex;
 
+  // The number of threads locating and converting symbol files, and the
+  // number uploading the converted files.
+  int conversion_threads;
+  int upload_threads;
+
  private:
   // DISABLE_COPY_AND_ASSIGN
   ConverterOptions(const ConverterOptions&);
@@ -347,13 +417,14 @@ struct ConverterOptions {
 // |options.*_msss_servers| arguments.  "Full" servers are those that will be
 // queried for all symbol files; "No-EXE" servers will only be queried for
 // modules whose missing symbol data indicates are not main program executables.
-// Results will be sent to the |options.upload_symbols_url| on success or
-// |options.fetch_symbol_failure_url| on failure, and the local cache will be
-// stored at |options.local_cache_path|.  Because nothing can be done even in
-// the event of a failure, this function returns no value, although it
-// may result in error messages being printed.
+// On success, the converted file is queued on |uploads|, to be sent to the
+// |options.upload_symbols_url|; on failure, |options.fetch_symbol_failure_url|
+// is told.  The local cache will be stored at |options.local_cache_path|.
+// Because nothing can be done even in the event of a failure, this function
+// returns no value, although it may result in error messages being printed.
 static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
-                                     const ConverterOptions& options) {
+                                     const ConverterOptions& options,
+                                     WorkQueue<PendingUpload>* uploads) {
   string time_string = CurrentDateAndTime();
   FprintfFlush(stdout, "converter: %s: attempting %s %s %s\n",
                time_string.c_str(),
@@ -408,18 +479,7 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
     switch (located) {
       case MSSymbolServerConverter::LOCATE_SUCCESS:
         FprintfFlush(stderr, "LocateResult = LOCATE_SUCCESS\n");
-        // Upload it.  Don't bother checking the return value.  If this
-        // succeeds, it should disappear from the missing symbol list.
-        // If it fails, something will print an error message indicating
-        // the cause of the failure, and the item will remain on the
-        // missing symbol list.
-        UploadSymbolFile(options.upload_symbols_url, missing_info,
-                         converted_file);
-        remove(converted_file.c_str());
-
-        // Note: this does leave some directories behind that could be
-        // cleaned up.  The directories inside options.local_cache_path for
-        // debug_file/debug_identifier can be removed at this point.
+        // The file is uploaded below, with those found externally.
         break;
 
       case MSSymbolServerConverter::LOCATE_NOT_FOUND:
@@ -488,21 +548,16 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
   // external request (if performed above), or on the result from the
   // previous internal lookup.
   switch (located) {
-    case MSSymbolServerConverter::LOCATE_SUCCESS:
+    case MSSymbolServerConverter::LOCATE_SUCCESS: {
       FprintfFlush(stderr, "LocateResult = LOCATE_SUCCESS\n");
-      // Upload it.  Don't bother checking the return value.  If this
-      // succeeds, it should disappear from the missing symbol list.
-      // If it fails, something will print an error message indicating
-      // the cause of the failure, and the item will remain on the
-      // missing symbol list.
-      UploadSymbolFile(options.upload_symbols_url, missing_info,
-                       converted_file);
-      remove(converted_file.c_str());
-
-      // Note: this does leave some directories behind that could be
-      // cleaned up.  The directories inside options.local_cache_path for
-      // debug_file/debug_identifier can be removed at this point.
+      // Hand it to the upload threads, so that this thread can go on to
+      // the next file.
+      PendingUpload upload;
+      upload.missing_info = missing_info;
+      upload.converted_file = converted_file;
+      uploads->Push(upload);
       break;
+    }
 
     case MSSymbolServerConverter::LOCATE_NOT_FOUND:
       // The symbol file definitively didn't exist.  Inform the server.
@@ -559,6 +614,51 @@ static void ConvertMissingSymbolFile(const MissingSymbolInfo& missing_info,
 }
 
 
+// UploadConvertedFiles uploads the files queued on |uploads| until it is
+// closed and empty.  It runs on each upload thread.
+static void UploadConvertedFiles(const ConverterOptions& options,
+                                 WorkQueue<PendingUpload>* uploads) {
+  PendingUpload upload;
+  while (uploads->Pop(&upload)) {
+    // Don't bother checking the return value.  If this succeeds, the file
+    // should disappear from the missing symbol list.  If it fails,
+    // something will print an error message indicating the cause of the
+    // failure, and the item will remain on the missing symbol list.
+    UploadSymbolFile(options.upload_symbols_url, upload.missing_info,
+                     upload.converted_file);
+    remove(upload.converted_file.c_str());
+
+    // Note: this does leave some directories behind that could be
+    // cleaned up.  The directories inside options.local_cache_path for
+    // debug_file/debug_identifier can be removed at this point.
+  }
+}
+
+// ConvertQueuedSymbolFiles calls ConvertMissingSymbolFile for each entry
+// queued on |missing| until it is closed and empty.  It runs on each
+// conversion thread.
+static void ConvertQueuedSymbolFiles(const ConverterOptions& options,
+                                     WorkQueue<MissingSymbolInfo>* missing,
+                                     WorkQueue<PendingUpload>* uploads) {
+  MissingSymbolInfo missing_info;
+  while (missing->Pop(&missing_info)) {
+    ConvertMissingSymbolFile(missing_info, options, uploads);
+  }
+}
+
+// Returns the key under which |missing_info| is looked up to drop repeated
+// requests for the same symbol file.  Windows file names are
+// case-insensitive, and identifiers are hexadecimal.
+static string MissingSymbolKey(const MissingSymbolInfo& missing_info) {
+  string debug_file = missing_info.debug_file;
+  std::transform(debug_file.begin(), debug_file.end(), debug_file.begin(),
+                 ::tolower);
+  string debug_identifier = missing_info.debug_identifier;
+  std::transform(debug_identifier.begin(), debug_identifier.end(),
+                 debug_identifier.begin(), ::toupper);
+  return debug_file + "|" + debug_identifier;
+}
+
 // Reads the contents of file |file_name| and populates |contents|.
 // Returns true on success.
 static bool ReadFile(string file_name, string* contents) {
@@ -577,7 +677,10 @@ static bool ReadFile(string file_name, string* contents) {
 
 // ConvertMissingSymbolsList obtains a missing symbol list from
 // |options.missing_symbols_url| or |options.missing_symbols_file| and calls
-// ConvertMissingSymbolFile for each missing symbol file in the list.
+// ConvertMissingSymbolFile for each missing symbol file in the list, once
+// for each distinct file.  |options.conversion_threads| threads locate and
+// convert the files, and |options.upload_threads| threads upload them, so
+// that downloads, conversions and uploads overlap.
 static bool ConvertMissingSymbolsList(const ConverterOptions& options) {
   // Set param to indicate requesting for encoded response.
   map<wstring, wstring> parameters;
@@ -600,6 +703,22 @@ static bool ConvertMissingSymbolsList(const ConverterOptions& options) {
 
   FprintfFlush(stderr, "Found %d missing symbol files in list.\n",
                missing_symbol_lines.size() - 1);  // last line is empty.
+
+  WorkQueue<MissingSymbolInfo> missing;
+  WorkQueue<PendingUpload> uploads;
+  vector<std::thread> conversion_threads;
+  for (int i = 0; i < options.conversion_threads; ++i) {
+    conversion_threads.push_back(std::thread(ConvertQueuedSymbolFiles,
+                                             std::cref(options), &missing,
+                                             &uploads));
+  }
+  vector<std::thread> upload_threads;
+  for (int i = 0; i < options.upload_threads; ++i) {
+    upload_threads.push_back(std::thread(UploadConvertedFiles,
+                                         std::cref(options), &uploads));
+  }
+
+  set<string> seen;
   int convert_attempts = 0;
   for (vector<string>::const_iterator iterator = missing_symbol_lines.begin();
        iterator != missing_symbol_lines.end();
@@ -630,8 +749,27 @@ static bool ConvertMissingSymbolsList(const ConverterOptions& options) {
       continue;
     }
 
+    // Files are often listed more than once, for each version of the
+    // module they were missing for.
+    if (!seen.insert(MissingSymbolKey(missing_info)).second) {
+      FprintfFlush(stderr, "Skipping repeated request for %s %s\n",
+                   missing_info.debug_file.c_str(),
+                   missing_info.debug_identifier.c_str());
+      continue;
+    }
+
     ++convert_attempts;
-    ConvertMissingSymbolFile(missing_info, options);
+    missing.Push(missing_info);
+  }
+
+  // Let the conversions finish, then the uploads of the converted files.
+  missing.Close();
+  for (size_t i = 0; i < conversion_threads.size(); ++i) {
+    conversion_threads[i].join();
+  }
+  uploads.Close();
+  for (size_t i = 0; i < upload_threads.size(); ++i) {
+    upload_threads[i].join();
   }
 
   // Say something reassuring, since ConvertMissingSymbolFile was never called
@@ -661,6 +799,10 @@ static int usage(const char* program_name) {
       "    -t  <fetch_failure_url>    URL to report symbol fetch failure\n"
       "    -b  <regex>                Regex used to blacklist files to\n"
       "                               prevent external symbol requests\n"
+      "    -w  <threads>              Threads locating and converting\n"
+      "                               symbol files (default 1)\n"
+      "    -u  <threads>              Threads uploading converted symbol\n"
+      "                               files (default 1)\n"
       " Note that any server specified by -f or -n that starts with \\filer\n"
       " will be treated as internal, and all others as external.\n",
       program_name);
@@ -751,6 +893,16 @@ int main(int argc, char** argv) {
       }
     } else if (option == "-b") {
       blacklist_regex_str = value;
+    } else if (option == "-w" || option == "-u") {
+      int threads = atoi(value.c_str());
+      if (threads < 1) {
+        return usage(argv[0]);
+      }
+      if (option == "-w") {
+        options.conversion_threads = threads;
+      } else {
+        options.upload_threads = threads;
+      }
     } else {
       return usage(argv[0]);
     }
@@ -0,0 +1,199 @@
+// Copyright (c) 2026, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// dump_syms_pdb_tool.cc: Command line tool that uses the PDBReader class
+// to write a Breakpad symbol file for a PDB file on hosts without DIA.
+// Given the x86_64 image the PDB file describes too, it writes STACK CFI
+// records from the image's unwind tables, with PEUnwindReader.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/module.h"
+#include "common/path_helper.h"
+#include "common/windows/pdb_reader.h"
+#include "common/windows/pe_unwind_reader.h"
+
+using google_breakpad::Module;
+using google_breakpad::PDBReader;
+using google_breakpad::PEUnwindReader;
+using std::string;
+using std::vector;
+
+namespace {
+
+struct Options {
+  Options() : pdb_path(), image_path(), header_only(false),
+              stack_records(true) {}
+
+  string pdb_path;
+  string image_path;
+  bool header_only;
+  bool stack_records;
+};
+
+//=============================================================================
+void Usage(int argc, const char* argv[]) {
+  fprintf(stderr, "Output a Breakpad symbol file from a PDB file.\n");
+  fprintf(stderr, "Usage: %s [-i] [-c] <PDB file> [<image file>]\n",
+          argv[0]);
+  fprintf(stderr, "\t-i: Output module header information only.\n");
+  fprintf(stderr, "\t-c: Do not generate STACK WIN or STACK CFI records\n");
+  fprintf(stderr, "\tThe x86_64 EXE or DLL file the PDB file describes, if "
+                  "given, provides STACK CFI records.\n");
+  fprintf(stderr, "\t-h: Usage\n");
+  fprintf(stderr, "\t-?: Usage\n");
+}
+
+//=============================================================================
+void SetupOptions(int argc, const char* argv[], Options* options) {
+  signed char ch;
+
+  while ((ch = getopt(argc, (char * const*)argv, "ic?h")) != -1) {
+    switch (ch) {
+      case 'i':
+        options->header_only = true;
+        break;
+      case 'c':
+        options->stack_records = false;
+        break;
+      case '?':
+      case 'h':
+        Usage(argc, argv);
+        exit(0);
+        break;
+    }
+  }
+
+  if ((argc - optind) != 1 && (argc - optind) != 2) {
+    fprintf(stderr, "Must specify PDB file\n");
+    Usage(argc, argv);
+    exit(1);
+  }
+
+  options->pdb_path = argv[optind];
+  if ((argc - optind) == 2)
+    options->image_path = argv[optind + 1];
+}
+
+//=============================================================================
+// Map the file at PATH, setting *CONTENTS and *SIZE to its contents.
+bool MapFile(const string& path, void** contents, size_t* size) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    fprintf(stderr, "%s: could not read file\n", path.c_str());
+    close(fd);
+    return false;
+  }
+  *size = st.st_size;
+  *contents = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (*contents == MAP_FAILED) {
+    fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+//=============================================================================
+// Write STACK CFI records for the x86_64 image at PATH.
+bool WriteImageFrameData(const string& path) {
+  void* contents;
+  size_t size;
+  if (!MapFile(path, &contents, &size))
+    return false;
+  PEUnwindReader reader;
+  vector<Module::StackFrameEntry> entries;
+  bool result = reader.Read(static_cast<const uint8_t*>(contents), size) &&
+      reader.ReadStackFrameEntries(&entries) &&
+      PEUnwindReader::WriteStackCFIRecords(entries, std::cout);
+  munmap(contents, size);
+  return result;
+}
+
+//=============================================================================
+bool Start(const Options& options) {
+  void* contents;
+  size_t size;
+  if (!MapFile(options.pdb_path, &contents, &size))
+    return false;
+
+  bool result = false;
+  PDBReader reader;
+  if (reader.Read(static_cast<const uint8_t*>(contents), size)) {
+    // Like PDBSourceLineWriter, name the module after the PDB file.
+    Module module(google_breakpad::BaseName(options.pdb_path), "windows",
+                  reader.cpu(), reader.DebugIdentifier());
+    if (options.header_only) {
+      result = module.Write(std::cout, NO_DATA);
+      std::cout.flush();
+    } else if (reader.ReadSymbols(&module) &&
+               module.Write(std::cout, ALL_SYMBOL_DATA)) {
+      // x86_64 code is unwound with the image's own unwind tables, which a
+      // PDB doesn't hold.
+      vector<PDBReader::FrameData> frame_data;
+      if (!options.stack_records) {
+        result = true;
+      } else if (reader.cpu() == "x86") {
+        result = reader.ReadFrameData(&frame_data) &&
+            PDBReader::WriteStackWinRecords(frame_data, std::cout);
+      } else {
+        result = options.image_path.empty() ||
+            WriteImageFrameData(options.image_path);
+      }
+      std::cout.flush();
+    }
+  }
+  munmap(contents, size);
+  return result;
+}
+
+}  // namespace
+
+//=============================================================================
+int main(int argc, const char* argv[]) {
+  Options options;
+  SetupOptions(argc, argv, &options);
+  return !Start(options);
+}
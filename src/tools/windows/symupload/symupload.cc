@@ -47,9 +47,15 @@
 #include <dbghelp.h>
 #include <wininet.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "common/windows/string_utils-inl.h"
@@ -159,12 +165,29 @@ static bool DumpSymbolsToTempFile(const wchar_t* file,
   return writer.GetModuleInfo(pdb_info);
 }
 
+// Writes the symbol data from the given exe/dll file to |symbol_data|, and
+// information about the pdb to |pdb_info|, without going through a file.
+static bool DumpSymbolsToString(const wchar_t* file,
+                                string* symbol_data,
+                                PDBModuleInfo* pdb_info) {
+  google_breakpad::PDBSourceLineWriter writer;
+  // As above, EXE_FILE gets the name and version of the exe/dll too.
+  if (!writer.Open(file, PDBSourceLineWriter::EXE_FILE)) {
+    return false;
+  }
+
+  return writer.WriteSymbols(symbol_data) && writer.GetModuleInfo(pdb_info);
+}
+
+// Uploads |symbol_data|, the symbol file for |debug_file| and |debug_id|,
+// through the sym-upload-v2 protocol.  Messages name |debug_file|, since
+// several modules may be uploading at once.
 static bool DoSymUploadV2(
     const wchar_t* api_url,
     const wchar_t* api_key,
     const wstring& debug_file,
     const wstring& debug_id,
-    const wstring& symbol_file,
+    const string& symbol_data,
     bool force) {
   wstring url(api_url);
   wstring key(api_key);
@@ -176,12 +199,13 @@ static bool DoSymUploadV2(
       debug_file,
       debug_id);
     if (symbolStatus == SymbolStatus::Found) {
-      wprintf(L"Symbol file already exists, upload aborted."
-        L" Use \"-f\" to overwrite.\n");
+      wprintf(L"%s: Symbol file already exists, upload aborted."
+        L" Use \"-f\" to overwrite.\n", debug_file.c_str());
       return true;
     }
     else if (symbolStatus == SymbolStatus::Unknown) {
-      wprintf(L"Failed to get check for existing symbol.\n");
+      wprintf(L"%s: Failed to get check for existing symbol.\n",
+        debug_file.c_str());
       return false;
     }
   }
@@ -191,7 +215,7 @@ static bool DoSymUploadV2(
       url,
       key,
       &uploadUrlResponse)) {
-    wprintf(L"Failed to create upload URL.\n");
+    wprintf(L"%s: Failed to create upload URL.\n", debug_file.c_str());
     return false;
   }
 
@@ -201,25 +225,27 @@ static bool DoSymUploadV2(
   int response_code;
   bool success = HTTPUpload::SendPutRequest(
     signed_url,
-    symbol_file,
+    debug_file + L".sym",
+    symbol_data,
     /* timeout = */ NULL,
     &response,
     &response_code);
   if (!success) {
-    wprintf(L"Failed to send symbol file.\n");
-    wprintf(L"Response code: %ld\n", response_code);
-    wprintf(L"Response:\n");
-    wprintf(L"%s\n", response.c_str());
+    wprintf(L"%s: Failed to send symbol file.\n"
+      L"Response code: %ld\n"
+      L"Response:\n"
+      L"%s\n", debug_file.c_str(), response_code, response.c_str());
     return false;
   }
   else if (response_code == 0) {
-    wprintf(L"Failed to send symbol file: No response code\n");
+    wprintf(L"%s: Failed to send symbol file: No response code\n",
+      debug_file.c_str());
     return false;
   }
   else if (response_code != 200) {
-    wprintf(L"Failed to send symbol file: Response code %ld\n", response_code);
-    wprintf(L"Response:\n");
-    wprintf(L"%s\n", response.c_str());
+    wprintf(L"%s: Failed to send symbol file: Response code %ld\n"
+      L"Response:\n"
+      L"%s\n", debug_file.c_str(), response_code, response.c_str());
     return false;
   }
 
@@ -231,20 +257,164 @@ static bool DoSymUploadV2(
       debug_file,
       debug_id);
   if (completeUploadResult == CompleteUploadResult::Error) {
-    wprintf(L"Failed to complete upload.\n");
+    wprintf(L"%s: Failed to complete upload.\n", debug_file.c_str());
     return false;
   }
   else if (completeUploadResult == CompleteUploadResult::DuplicateData) {
-    wprintf(L"Uploaded file checksum matched existing file checksum,"
-      L" no change necessary.\n");
+    wprintf(L"%s: Uploaded file checksum matched existing file checksum,"
+      L" no change necessary.\n", debug_file.c_str());
   }
   else {
-    wprintf(L"Successfully sent the symbol file.\n");
+    wprintf(L"%s: Successfully sent the symbol file.\n", debug_file.c_str());
   }
 
   return true;
 }
 
+namespace {
+
+// A module whose symbols have been dumped, waiting to be uploaded.
+struct DumpedModule {
+  wstring code_file;
+  wstring file_version;
+  PDBModuleInfo pdb_info;
+  string symbol_data;
+};
+
+// Hands dumped modules from the dump threads to the upload threads.  Push
+// waits while |capacity| modules are already waiting, so that dumping
+// can't get arbitrarily far ahead of the network with whole symbol files
+// held in memory.  Pop waits for a module, and returns false once the
+// queue is closed and empty.
+class DumpedModuleQueue {
+ public:
+  explicit DumpedModuleQueue(size_t capacity)
+      : capacity_(capacity), closed_(false) {}
+
+  void Push(DumpedModule&& module) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_full_.wait(lock, [this] { return modules_.size() < capacity_; });
+      modules_.push_back(std::move(module));
+    }
+    not_empty_.notify_one();
+  }
+
+  // No more modules will be pushed.
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    not_empty_.notify_all();
+  }
+
+  bool Pop(DumpedModule* module) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this] { return closed_ || !modules_.empty(); });
+      if (modules_.empty()) {
+        return false;
+      }
+      *module = std::move(modules_.front());
+      modules_.pop_front();
+    }
+    not_full_.notify_one();
+    return true;
+  }
+
+ private:
+  const size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<DumpedModule> modules_;
+  bool closed_;
+
+  // DISABLE_COPY_AND_ASSIGN
+  DumpedModuleQueue(const DumpedModuleQueue&);
+  DumpedModuleQueue& operator=(const DumpedModuleQueue&);
+};
+
+}  // namespace
+
+// Dumps each of |modules| with |dump_threads| threads, and uploads them
+// through the sym-upload-v2 protocol with |upload_threads| threads, so that
+// conversions and uploads overlap.  Symbol files are only held in memory.
+// Returns true if every module was uploaded.
+static bool SymUploadV2Modules(const vector<const wchar_t*>& modules,
+                               const wchar_t* api_url,
+                               const wchar_t* api_key,
+                               bool force,
+                               int dump_threads,
+                               int upload_threads) {
+  std::atomic<size_t> next_module(0);
+  std::atomic<bool> success(true);
+  DumpedModuleQueue dumped(upload_threads);
+
+  auto dump = [&]() {
+    size_t i;
+    while ((i = next_module++) < modules.size()) {
+      const wchar_t* module = modules[i];
+      DumpedModule dumped_module;
+      if (!DumpSymbolsToString(module, &dumped_module.symbol_data,
+                               &dumped_module.pdb_info)) {
+        fwprintf(stderr, L"Could not get symbol data from %s\n", module);
+        success = false;
+        continue;
+      }
+
+      dumped_module.code_file =
+          WindowsStringUtils::GetBaseName(wstring(module));
+      // Don't make a missing version a hard error.  Issue a warning, and let
+      // the server decide whether to reject files without versions.
+      if (!GetFileVersionString(module, &dumped_module.file_version)) {
+        fwprintf(stderr, L"Warning: Could not get file version for %s\n",
+                 module);
+      }
+      dumped.Push(std::move(dumped_module));
+    }
+  };
+
+  auto upload = [&]() {
+    DumpedModule dumped_module;
+    while (dumped.Pop(&dumped_module)) {
+      const PDBModuleInfo& pdb_info = dumped_module.pdb_info;
+      if (!DoSymUploadV2(api_url, api_key, pdb_info.debug_file,
+                         pdb_info.debug_identifier, dumped_module.symbol_data,
+                         force)) {
+        success = false;
+        continue;
+      }
+      wprintf(L"Uploaded breakpad symbols for windows-%s/%s/%s (%s %s)\n",
+              pdb_info.cpu.c_str(), pdb_info.debug_file.c_str(),
+              pdb_info.debug_identifier.c_str(),
+              dumped_module.code_file.c_str(),
+              dumped_module.file_version.c_str());
+    }
+  };
+
+  vector<std::thread> dumpers;
+  for (int i = 0; i < dump_threads; ++i) {
+    dumpers.push_back(std::thread(dump));
+  }
+  vector<std::thread> uploaders;
+  for (int i = 0; i < upload_threads; ++i) {
+    uploaders.push_back(std::thread(upload));
+  }
+
+  // Let the dumps finish, then the uploads of the dumped modules.
+  for (size_t i = 0; i < dumpers.size(); ++i) {
+    dumpers[i].join();
+  }
+  dumped.Close();
+  for (size_t i = 0; i < uploaders.size(); ++i) {
+    uploaders[i].join();
+  }
+
+  return success;
+}
+
 __declspec(noreturn) void printUsageAndExit() {
   wprintf(L"Usage:\n\n"
           L"    symupload [--timeout NN] [--product product_name] ^\n"
@@ -259,13 +429,17 @@ __declspec(noreturn) void printUsageAndExit() {
           L"        chrome.dll http://no.free.symbol.server.for.you\n");
   wprintf(L"\n");
   wprintf(L"sym-upload-v2 usage:\n"
-          L"    symupload -p [-f] <file.exe|file.dll> <API-URL> <API-key>\n");
+          L"    symupload -p [-f] [-w threads] [-u threads] ^\n"
+          L"              <file.exe|file.dll> [...<file.exe|file.dll>] ^\n"
+          L"              <API-URL> <API-key>\n");
   wprintf(L"\n");
   wprintf(L"sym_upload_v2 Options:\n");
   wprintf(L"    <API-URL> is the sym_upload_v2 API URL.\n");
   wprintf(L"    <API-key> is a secret used to authenticate with the API.\n");
   wprintf(L"    -p:\t Use sym_upload_v2 protocol.\n");
   wprintf(L"    -f:\t Force symbol upload if already exists.\n");
+  wprintf(L"    -w:\t Threads dumping symbols (default 1).\n");
+  wprintf(L"    -u:\t Threads uploading dumped symbols (default 1).\n");
 
   exit(0);
 }
@@ -277,8 +451,8 @@ int wmain(int argc, wchar_t* argv[]) {
   int currentarg = 1;
   bool use_sym_upload_v2 = false;
   bool force = false;
-  const wchar_t* api_url = nullptr;
-  const wchar_t* api_key = nullptr;
+  int dump_threads = 1;
+  int upload_threads = 1;
   while (argc > currentarg + 1) {
     if (!wcscmp(L"--timeout", argv[currentarg])) {
       timeout = _wtoi(argv[currentarg + 1]);
@@ -300,9 +474,32 @@ int wmain(int argc, wchar_t* argv[]) {
       ++currentarg;
       continue;
     }
+    if (!wcscmp(L"-w", argv[currentarg]) || !wcscmp(L"-u", argv[currentarg])) {
+      int threads = _wtoi(argv[currentarg + 1]);
+      if (threads < 1) {
+        printUsageAndExit();
+      }
+      if (!wcscmp(L"-w", argv[currentarg])) {
+        dump_threads = threads;
+      } else {
+        upload_threads = threads;
+      }
+      currentarg += 2;
+      continue;
+    }
     break;
   }
 
+  if (use_sym_upload_v2) {
+    // Every argument but the last two, the API URL and key, is a module.
+    if (argc < currentarg + 3) {
+      printUsageAndExit();
+    }
+    vector<const wchar_t*> modules(argv + currentarg, argv + argc - 2);
+    return SymUploadV2Modules(modules, argv[argc - 2], argv[argc - 1], force,
+                              dump_threads, upload_threads) ? 0 : 1;
+  }
+
   if (argc >= currentarg + 2)
     module = argv[currentarg++];
   else
@@ -325,60 +522,43 @@ int wmain(int argc, wchar_t* argv[]) {
 
   bool success = true;
 
-  if (use_sym_upload_v2) {
-    if (argc >= currentarg + 2) {
-      api_url = argv[currentarg++];
-      api_key = argv[currentarg++];
-
-      success = DoSymUploadV2(
-        api_url,
-        api_key,
-        pdb_info.debug_file,
-        pdb_info.debug_identifier,
-        symbol_file,
-        force);
-    } else {
-      printUsageAndExit();
-    }
-  } else {
-    map<wstring, wstring> parameters;
-    parameters[L"code_file"] = code_file;
-    parameters[L"debug_file"] = pdb_info.debug_file;
-    parameters[L"debug_identifier"] = pdb_info.debug_identifier;
-    parameters[L"os"] = L"windows";  // This version of symupload is Windows-only
-    parameters[L"cpu"] = pdb_info.cpu;
-
-    map<wstring, wstring> files;
-    files[L"symbol_file"] = symbol_file;
-
-    if (!file_version.empty()) {
-      parameters[L"version"] = file_version;
-    }
+  map<wstring, wstring> parameters;
+  parameters[L"code_file"] = code_file;
+  parameters[L"debug_file"] = pdb_info.debug_file;
+  parameters[L"debug_identifier"] = pdb_info.debug_identifier;
+  parameters[L"os"] = L"windows";  // This version of symupload is Windows-only
+  parameters[L"cpu"] = pdb_info.cpu;
 
-    // Don't make a missing product name a hard error.  Issue a warning and let
-    // the server decide whether to reject files without product name.
-    if (product) {
-      parameters[L"product"] = product;
-    }
-    else {
-      fwprintf(
-        stderr,
-        L"Warning: No product name (flag --product) was specified for %s\n",
-        module);
-    }
+  map<wstring, wstring> files;
+  files[L"symbol_file"] = symbol_file;
 
-    while (currentarg < argc) {
-      int response_code;
-      if (!HTTPUpload::SendMultipartPostRequest(argv[currentarg], parameters, files,
-          timeout == -1 ? NULL : &timeout,
-          nullptr, &response_code)) {
-        success = false;
-        fwprintf(stderr,
-          L"Symbol file upload to %s failed. Response code = %ld\n",
-          argv[currentarg], response_code);
-      }
-      currentarg++;
+  if (!file_version.empty()) {
+    parameters[L"version"] = file_version;
+  }
+
+  // Don't make a missing product name a hard error.  Issue a warning and let
+  // the server decide whether to reject files without product name.
+  if (product) {
+    parameters[L"product"] = product;
+  }
+  else {
+    fwprintf(
+      stderr,
+      L"Warning: No product name (flag --product) was specified for %s\n",
+      module);
+  }
+
+  while (currentarg < argc) {
+    int response_code;
+    if (!HTTPUpload::SendMultipartPostRequest(argv[currentarg], parameters, files,
+        timeout == -1 ? NULL : &timeout,
+        nullptr, &response_code)) {
+      success = false;
+      fwprintf(stderr,
+        L"Symbol file upload to %s failed. Response code = %ld\n",
+        argv[currentarg], response_code);
     }
+    currentarg++;
   }
 
   _wunlink(symbol_file.c_str());